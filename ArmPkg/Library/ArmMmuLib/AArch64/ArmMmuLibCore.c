@@ -146,6 +146,57 @@ IsTableEntry (
   return (Entry & TT_TYPE_MASK) == TT_TYPE_TABLE_ENTRY;
 }
 
+/**
+  Check whether a page table can be replaced by a single block entry in its
+  parent table, i.e., whether all its entries are block or page entries that
+  map a contiguous and suitably aligned output range with identical
+  attributes.
+
+  @param[in]  PageTable   The page table to check.
+  @param[in]  Level       The translation level of PageTable.
+  @param[out] BlockEntry  The block entry that can replace PageTable.
+
+  @retval TRUE   PageTable can be replaced by BlockEntry.
+  @retval FALSE  PageTable must be kept.
+**/
+STATIC
+BOOLEAN
+IsTableMergeable (
+  IN  UINT64  *PageTable,
+  IN  UINTN   Level,
+  OUT UINT64  *BlockEntry
+  )
+{
+  UINTN   Index;
+  UINTN   EntryShift;
+  UINT64  Address;
+  UINT64  Attributes;
+
+  if (!IsBlockEntry (PageTable[0], Level)) {
+    return FALSE;
+  }
+
+  EntryShift = 64 - ((Level + 1) * BITS_PER_LEVEL + MIN_T0SZ);
+  Address    = PageTable[0] & TT_ADDRESS_MASK_BLOCK_ENTRY;
+  Attributes = PageTable[0] & TT_ATTRIBUTES_MASK;
+
+  if ((Address & ((TT_ENTRY_COUNT << EntryShift) - 1)) != 0) {
+    return FALSE;
+  }
+
+  for (Index = 1; Index < TT_ENTRY_COUNT; Index++) {
+    if (!IsBlockEntry (PageTable[Index], Level) ||
+        (PageTable[Index] & TT_ATTRIBUTES_MASK) != Attributes ||
+        (PageTable[Index] & TT_ADDRESS_MASK_BLOCK_ENTRY) !=
+          Address + ((UINT64)Index << EntryShift)) {
+      return FALSE;
+    }
+  }
+
+  *BlockEntry = Address | Attributes | TT_TYPE_BLOCK_ENTRY;
+  return TRUE;
+}
+
 STATIC
 EFI_STATUS
 UpdateRegionMappingRecursive (
@@ -257,6 +308,18 @@ UpdateRegionMappingRecursive (
         EntryValue = (UINTN)TranslationTable | TT_TYPE_TABLE_ENTRY;
         ReplaceTableEntry (Entry, EntryValue, RegionStart,
           IsBlockEntry (*Entry, Level));
+      } else if (Level > 0 &&
+                 IsTableMergeable (TranslationTable, Level + 1, &EntryValue)) {
+        //
+        // The attributes of all entries of the next level table have
+        // converged, e.g., because a protection that split a block has been
+        // lifted again, so fold them back into a single block entry. The
+        // live replacement only invalidates the TLB entry of RegionStart, so
+        // drop all other stale translations at the smaller size as well.
+        //
+        ReplaceTableEntry (Entry, EntryValue, RegionStart, TRUE);
+        ArmInvalidateTlb ();
+        FreePages (TranslationTable, 1);
       }
     } else {
       EntryValue = (*Entry & AttributeClearMask) | AttributeSetMask;
@@ -232,6 +232,45 @@ NorFlashWriteSingleWord (
   return Status;
 }
 
+/**
+ * Compare a block with the data about to be written to it.
+ *
+ * Erasing is by far the slowest NOR operation, and a programming operation can
+ * only clear bits. A block that already holds the data is left alone, and a
+ * block where the data only clears bits is programmed without being erased.
+ **/
+NOR_FLASH_BLOCK_UPDATE
+NorFlashCompareBlock (
+  IN NOR_FLASH_INSTANCE     *Instance,
+  IN UINTN                  BlockAddress,
+  IN UINT32                 *DataBuffer,
+  IN UINT32                 BlockSizeInWords
+  )
+{
+  NOR_FLASH_BLOCK_UPDATE  Update;
+  UINT32                  WordIndex;
+  UINT32                  FlashData;
+
+  Update = NorFlashBlockUnchanged;
+
+  // Put the device into Read Array mode
+  SEND_NOR_COMMAND (Instance->DeviceBaseAddress, 0, P30_CMD_READ_ARRAY);
+
+  for (WordIndex = 0; WordIndex < BlockSizeInWords; WordIndex++) {
+    FlashData = MmioRead32 (BlockAddress + WordIndex * 4);
+    if (FlashData == DataBuffer[WordIndex]) {
+      continue;
+    }
+    if ((FlashData & DataBuffer[WordIndex]) != DataBuffer[WordIndex]) {
+      // A bit has to go from 0 to 1, only an erase can do that
+      return NorFlashBlockEraseAndProgram;
+    }
+    Update = NorFlashBlockProgramOnly;
+  }
+
+  return Update;
+}
+
 /*
  * Writes data to the NOR Flash using the Buffered Programming method.
  *
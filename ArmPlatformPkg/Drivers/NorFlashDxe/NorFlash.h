@@ -116,6 +116,15 @@
 
 typedef struct _NOR_FLASH_INSTANCE                NOR_FLASH_INSTANCE;
 
+//
+// What has to be done to a block to make it hold new data
+//
+typedef enum {
+  NorFlashBlockUnchanged,         // The block already holds the data
+  NorFlashBlockProgramOnly,       // The data only clears bits, no erase needed
+  NorFlashBlockEraseAndProgram
+} NOR_FLASH_BLOCK_UPDATE;
+
 #pragma pack (1)
 typedef struct {
   VENDOR_DEVICE_PATH                  Vendor;
@@ -414,6 +423,14 @@ NorFlashWriteSingleWord (
   IN UINT32                 WriteData
   );
 
+NOR_FLASH_BLOCK_UPDATE
+NorFlashCompareBlock (
+  IN NOR_FLASH_INSTANCE     *Instance,
+  IN UINTN                  BlockAddress,
+  IN UINT32                 *DataBuffer,
+  IN UINT32                 BlockSizeInWords
+  );
+
 VOID
 EFIAPI
 NorFlashVirtualNotifyEvent (
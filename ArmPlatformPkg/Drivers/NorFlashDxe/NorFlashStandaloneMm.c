@@ -197,6 +197,8 @@ NorFlashWriteFullBlock (
   UINTN         BlockAddress;
   UINTN         BuffersInBlock;
   UINTN         RemainingWords;
+  UINT32        CurrentData;
+  NOR_FLASH_BLOCK_UPDATE  Update;
   UINTN         Cnt;
 
   Status = EFI_SUCCESS;
@@ -207,12 +209,25 @@ NorFlashWriteFullBlock (
   // Start writing from the first address at the start of the block
   WordAddress = BlockAddress;
 
-  Status = NorFlashUnlockAndEraseSingleBlock (Instance, BlockAddress);
-  if (EFI_ERROR(Status)) {
-    DEBUG((DEBUG_ERROR, "WriteSingleBlock: ERROR - Failed to Unlock and Erase the single block at 0x%X\n", BlockAddress));
+  Update = NorFlashCompareBlock (Instance, BlockAddress, DataBuffer, BlockSizeInWords);
+  if (Update == NorFlashBlockUnchanged) {
     goto EXIT;
   }
 
+  if (Update == NorFlashBlockEraseAndProgram) {
+    Status = NorFlashUnlockAndEraseSingleBlock (Instance, BlockAddress);
+    if (EFI_ERROR(Status)) {
+      DEBUG((DEBUG_ERROR, "WriteSingleBlock: ERROR - Failed to Unlock and Erase the single block at 0x%X\n", BlockAddress));
+      goto EXIT;
+    }
+  } else {
+    Status = NorFlashUnlockSingleBlockIfNecessary (Instance, BlockAddress);
+    if (EFI_ERROR(Status)) {
+      DEBUG((DEBUG_ERROR, "WriteSingleBlock: ERROR - Failed to Unlock the single block at 0x%X\n", BlockAddress));
+      goto EXIT;
+    }
+  }
+
   // To speed up the programming operation, NOR Flash is programmed using the Buffered Programming method.
 
   // Check that the address starts at a 32-word boundary, i.e. last 7 bits must be zero
@@ -227,9 +242,15 @@ NorFlashWriteFullBlock (
          BufferIndex < BuffersInBlock;
          BufferIndex++, WordAddress += P30_MAX_BUFFER_SIZE_IN_BYTES, DataBuffer += P30_MAX_BUFFER_SIZE_IN_WORDS
       ) {
-      // Check the buffer to see if it contains any data (not set all 1s).
+      // Check the buffer to see if it contains any data (not set all 1s), or
+      // when the block was not erased, any data not already in the flash.
       for (Cnt = 0; Cnt < P30_MAX_BUFFER_SIZE_IN_WORDS; Cnt++) {
-        if (~DataBuffer[Cnt] != 0 ) {
+        if (Update == NorFlashBlockProgramOnly) {
+          CurrentData = MmioRead32 (WordAddress + Cnt * 4);
+        } else {
+          CurrentData = MAX_UINT32;
+        }
+        if (DataBuffer[Cnt] != CurrentData) {
           // Some data found, write the buffer.
           Status = NorFlashWriteBuffer (Instance, WordAddress, P30_MAX_BUFFER_SIZE_IN_BYTES,
                                         DataBuffer);
@@ -47,6 +47,7 @@ EFI_GUID  mFileGuidArray [MAX_NUMBER_OF_FILES_IN_FV];
 EFI_GUID  mZeroGuid                           = {0x0, 0x0, 0x0, {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0}};
 EFI_GUID  mDefaultCapsuleGuid                 = {0x3B6686BD, 0x0D76, 0x4030, { 0xB7, 0x0E, 0xB5, 0x51, 0x9E, 0x2F, 0xC5, 0xA0 }};
 EFI_GUID  mEfiFfsSectionAlignmentPaddingGuid  = EFI_FFS_SECTION_ALIGNMENT_PADDING_GUID;
+EFI_GUID  mFvFileDirectoryGuid                = EDKII_FV_FILE_DIRECTORY_GUID;
 
 CHAR8      *mFvbAttributeName[] = {
   EFI_FVB2_READ_DISABLED_CAP_STRING,
@@ -1016,6 +1017,142 @@ Returns:
   return EFI_SUCCESS;
 }
 
+STATIC
+int
+CompareFvFileDirectoryEntry (
+  CONST VOID  *Entry1,
+  CONST VOID  *Entry2
+  )
+/*++
+
+Routine Description:
+
+  qsort() callback that orders the FV file directory entries by the bytes of
+  the file name, and then by the file offset.
+
+Arguments:
+
+  Entry1          The first EDKII_FV_FILE_DIRECTORY_ENTRY.
+  Entry2          The second EDKII_FV_FILE_DIRECTORY_ENTRY.
+
+Returns:
+
+  <0, 0 or >0 as required by qsort().
+
+--*/
+{
+  CONST EDKII_FV_FILE_DIRECTORY_ENTRY *Left;
+  CONST EDKII_FV_FILE_DIRECTORY_ENTRY *Right;
+  int                                 Result;
+
+  Left   = (CONST EDKII_FV_FILE_DIRECTORY_ENTRY *) Entry1;
+  Right  = (CONST EDKII_FV_FILE_DIRECTORY_ENTRY *) Entry2;
+  Result = memcmp (&Left->Name, &Right->Name, sizeof (EFI_GUID));
+  if (Result != 0) {
+    return Result;
+  }
+  if (Left->Offset != Right->Offset) {
+    return (Left->Offset < Right->Offset) ? -1 : 1;
+  }
+  return 0;
+}
+
+STATIC
+EFI_STATUS
+UpdateFvFileDirectory (
+  IN OUT MEMORY_FILE          *FvImage
+  )
+/*++
+
+Routine Description:
+
+  Fill the FV file directory reserved in the FV extension header, if any,
+  with the names and offsets of all the files in the FV except the pad files.
+  The extension header is carried by a pad file with a fixed checksum, so it
+  can be updated after all the files have been placed.
+
+Arguments:
+
+  FvImage         The memory image of the FV, with all its files added.
+
+Returns:
+
+  EFI_SUCCESS              The directory is updated, or there is none.
+  EFI_ABORTED              The reserved directory is too small.
+
+--*/
+{
+  EFI_FIRMWARE_VOLUME_HEADER      *FvHeader;
+  EFI_FIRMWARE_VOLUME_EXT_HEADER  *ExtHeader;
+  EFI_FIRMWARE_VOLUME_EXT_ENTRY   *ExtEntry;
+  EDKII_FV_FILE_DIRECTORY         *Directory;
+  EDKII_FV_FILE_DIRECTORY_ENTRY   *Entry;
+  EFI_FFS_FILE_HEADER             *FfsFile;
+  UINT32                          Capacity;
+  UINT32                          Count;
+  UINT32                          Offset;
+  EFI_STATUS                      Status;
+
+  FvHeader = (EFI_FIRMWARE_VOLUME_HEADER *) FvImage->FileImage;
+  if (FvHeader->ExtHeaderOffset == 0) {
+    return EFI_SUCCESS;
+  }
+
+  //
+  // Look for the directory entry reserved by the build tools.
+  //
+  Directory = NULL;
+  ExtHeader = (EFI_FIRMWARE_VOLUME_EXT_HEADER *) ((UINT8 *) FvHeader + FvHeader->ExtHeaderOffset);
+  for (Offset = sizeof (EFI_FIRMWARE_VOLUME_EXT_HEADER); Offset + sizeof (EFI_FIRMWARE_VOLUME_EXT_ENTRY) <= ExtHeader->ExtHeaderSize;) {
+    ExtEntry = (EFI_FIRMWARE_VOLUME_EXT_ENTRY *) ((UINT8 *) ExtHeader + Offset);
+    if (ExtEntry->ExtEntrySize < sizeof (EFI_FIRMWARE_VOLUME_EXT_ENTRY) ||
+        Offset + ExtEntry->ExtEntrySize > ExtHeader->ExtHeaderSize) {
+      break;
+    }
+    if (ExtEntry->ExtEntryType == EFI_FV_EXT_TYPE_GUID_TYPE &&
+        ExtEntry->ExtEntrySize >= sizeof (EDKII_FV_FILE_DIRECTORY) &&
+        CompareGuid (&((EDKII_FV_FILE_DIRECTORY *) ExtEntry)->FormatType, &mFvFileDirectoryGuid) == 0) {
+      Directory = (EDKII_FV_FILE_DIRECTORY *) ExtEntry;
+      break;
+    }
+    Offset += ExtEntry->ExtEntrySize;
+  }
+  if (Directory == NULL) {
+    return EFI_SUCCESS;
+  }
+
+  Capacity = (Directory->Hdr.ExtEntrySize - sizeof (EDKII_FV_FILE_DIRECTORY)) / sizeof (EDKII_FV_FILE_DIRECTORY_ENTRY);
+  Entry    = (EDKII_FV_FILE_DIRECTORY_ENTRY *) (Directory + 1);
+  Count    = 0;
+
+  InitializeFvLib (FvImage->FileImage, (UINT32) ((UINTN) FvImage->Eof - (UINTN) FvImage->FileImage));
+  for (Status = GetNextFile (NULL, &FfsFile);
+       !EFI_ERROR (Status) && FfsFile != NULL;
+       Status = GetNextFile (FfsFile, &FfsFile)) {
+    if (FfsFile->Type == EFI_FV_FILETYPE_FFS_PAD) {
+      continue;
+    }
+    if (Count == Capacity) {
+      Error (NULL, 0, 3000, "Invalid", "FV file directory has room for %u files only.", (unsigned) Capacity);
+      return EFI_ABORTED;
+    }
+    memcpy (&Entry[Count].Name, &FfsFile->Name, sizeof (EFI_GUID));
+    Entry[Count].Offset = (UINT32) ((UINTN) FfsFile - (UINTN) FvImage->FileImage);
+    Count++;
+  }
+
+  qsort (Entry, Count, sizeof (EDKII_FV_FILE_DIRECTORY_ENTRY), CompareFvFileDirectoryEntry);
+  Directory->FileCount = Count;
+
+  //
+  // Keep the unused slots out of the directory.
+  //
+  memset (&Entry[Count], 0, (Capacity - Count) * sizeof (EDKII_FV_FILE_DIRECTORY_ENTRY));
+
+  DebugMsg (NULL, 0, 9, "Update FV file directory", "%u files", (unsigned) Count);
+  return EFI_SUCCESS;
+}
+
 STATIC
 BOOLEAN
 AdjustInternalFfsPadding (
@@ -2954,6 +3091,14 @@ Returns:
     }
   }
 
+  //
+  // Fill the FV file directory now that the offsets of all the files are known.
+  //
+  Status = UpdateFvFileDirectory (&FvImageMemoryFile);
+  if (EFI_ERROR (Status)) {
+    goto Finish;
+  }
+
   if (mArm) {
     Status = UpdateArmResetVectorIfNeeded (&FvImageMemoryFile, &mFvDataInfo);
     if (EFI_ERROR (Status)) {
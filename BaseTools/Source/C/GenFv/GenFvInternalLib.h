@@ -21,6 +21,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Common/PiFirmwareFile.h>
 #include <Common/PiFirmwareVolume.h>
 #include <Guid/PiFirmwareFileSystem.h>
+#include <Guid/FvFileDirectory.h>
 #include <IndustryStandard/PeImage.h>
 
 #include "CommonLib.h"
@@ -1094,6 +1094,11 @@ WriteRelocations32 (
     }
   }
 
+  //
+  // Emit the fixups held back by --compactrelocs.
+  //
+  CoffFlushFixups ();
+
   //
   // Pad by adding empty entries.
   //
@@ -1574,6 +1574,11 @@ WriteRelocations64 (
     //
     EmitGOTRelocations();
   }
+  //
+  // Emit the fixups held back by --compactrelocs.
+  //
+  CoffFlushFixups ();
+
   //
   // Pad by adding empty entries.
   //
@@ -41,6 +41,19 @@ UINT8 *mCoffFile = NULL;
 EFI_IMAGE_BASE_RELOCATION *mCoffBaseRel;
 UINT16                    *mCoffEntryRel;
 
+//
+// Fixups held back by CoffAddFixup() with --compactrelocs, until
+// CoffFlushFixups() emits them sorted by offset.
+//
+typedef struct {
+  UINT32 Offset;
+  UINT8  Type;
+} COFF_PENDING_FIXUP;
+
+STATIC COFF_PENDING_FIXUP *mCoffPendingFixups;
+STATIC UINT32             mCoffNumPendingFixups;
+STATIC UINT32             mCoffMaxPendingFixups;
+
 //
 // Current offset in coff file.
 //
@@ -73,8 +86,9 @@ CoffAddFixupEntry(
   mCoffOffset += 2;
 }
 
+STATIC
 VOID
-CoffAddFixup(
+CoffEmitFixup(
   UINT32 Offset,
   UINT8  Type
   )
@@ -84,8 +98,11 @@ CoffAddFixup(
     if (mCoffBaseRel != NULL) {
       //
       // Add a null entry (is it required ?)
+      // It is not, so compact relocations skip it.
       //
-      CoffAddFixupEntry (0);
+      if (!mCompactRelocations) {
+        CoffAddFixupEntry (0);
+      }
 
       //
       // Pad for alignment.
@@ -121,6 +138,89 @@ CoffAddFixup(
   CoffAddFixupEntry((UINT16) ((Type << 12) | (Offset & 0xfff)));
 }
 
+VOID
+CoffAddFixup(
+  UINT32 Offset,
+  UINT8  Type
+  )
+{
+  if (!mCompactRelocations) {
+    CoffEmitFixup (Offset, Type);
+    return;
+  }
+
+  if (mCoffNumPendingFixups == mCoffMaxPendingFixups) {
+    mCoffMaxPendingFixups = (mCoffMaxPendingFixups == 0) ? 0x400 : 2 * mCoffMaxPendingFixups;
+    mCoffPendingFixups = realloc (
+      mCoffPendingFixups,
+      mCoffMaxPendingFixups * sizeof (COFF_PENDING_FIXUP)
+      );
+    if (mCoffPendingFixups == NULL) {
+      Error (NULL, 0, 4001, "Resource", "memory cannot be allocated!");
+    }
+    assert (mCoffPendingFixups != NULL);
+  }
+
+  mCoffPendingFixups[mCoffNumPendingFixups].Offset = Offset;
+  mCoffPendingFixups[mCoffNumPendingFixups].Type   = Type;
+  mCoffNumPendingFixups++;
+}
+
+STATIC
+int
+CoffPendingFixupComparator (
+  const void* lhs,
+  const void* rhs
+  )
+{
+  const COFF_PENDING_FIXUP *Left;
+  const COFF_PENDING_FIXUP *Right;
+
+  Left  = (const COFF_PENDING_FIXUP *) lhs;
+  Right = (const COFF_PENDING_FIXUP *) rhs;
+  if (Left->Offset != Right->Offset) {
+    return (Left->Offset < Right->Offset) ? -1 : 1;
+  }
+  return (int) Left->Type - (int) Right->Type;
+}
+
+VOID
+CoffFlushFixups(
+  VOID
+  )
+{
+  UINT32 Index;
+
+  if (mCoffPendingFixups == NULL) {
+    return;
+  }
+
+  //
+  // Sorted fixups need exactly one block per page. The same fixup may be
+  // reported twice, e.g. by a section relocation and by a GOT entry, so
+  // only the first one is kept.
+  //
+  qsort (
+    mCoffPendingFixups,
+    mCoffNumPendingFixups,
+    sizeof (COFF_PENDING_FIXUP),
+    CoffPendingFixupComparator
+    );
+  for (Index = 0; Index < mCoffNumPendingFixups; Index++) {
+    if (Index > 0 &&
+        mCoffPendingFixups[Index].Offset == mCoffPendingFixups[Index - 1].Offset &&
+        mCoffPendingFixups[Index].Type == mCoffPendingFixups[Index - 1].Type) {
+      continue;
+    }
+    CoffEmitFixup (mCoffPendingFixups[Index].Offset, mCoffPendingFixups[Index].Type);
+  }
+
+  free (mCoffPendingFixups);
+  mCoffPendingFixups    = NULL;
+  mCoffNumPendingFixups = 0;
+  mCoffMaxPendingFixups = 0;
+}
+
 VOID
 CreateSectionHeader (
   const CHAR8 *Name,
@@ -24,6 +24,7 @@ extern UINT8  *mCoffFile;
 extern UINT32 mTableOffset;
 extern UINT32 mOutImageType;
 extern UINT32 mFileBufferSize;
+extern BOOLEAN mCompactRelocations;
 
 //
 // Common EFI specific data.
@@ -69,6 +70,11 @@ CoffAddFixupEntry (
   UINT16 Val
   );
 
+VOID
+CoffFlushFixups (
+  VOID
+  );
+
 
 VOID
 CreateSectionHeader (
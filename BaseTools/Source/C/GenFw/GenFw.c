@@ -87,6 +87,7 @@ UINT32 mImageTimeStamp = 0;
 UINT32 mImageSize = 0;
 UINT32 mOutImageType = FW_DUMMY_IMAGE;
 BOOLEAN mIsConvertXip = FALSE;
+BOOLEAN mCompactRelocations = FALSE;
 
 
 STATIC
@@ -248,6 +249,11 @@ Returns:
   fprintf (stdout, "  --keepzeropending     Don't strip zero pending of .reloc.\n\
                         This option can be used together with -e or -t.\n\
                         It doesn't work for other options.\n");
+  fprintf (stdout, "  --compactrelocs       Sort the base relocations converted from an ELF\n\
+                        image by address, and emit a single block per 4K page\n\
+                        without padding entries beyond the 32-bit alignment.\n\
+                        This option can be used together with -e or -t.\n\
+                        It doesn't work for other options.\n");
   fprintf (stdout, "  -r, --replace         Overwrite the input file with the output content.\n\
                         If more input files are specified,\n\
                         the last input file will be as the output file.\n");
@@ -1304,6 +1310,13 @@ Returns:
       continue;
     }
 
+    if (stricmp (argv[0], "--compactrelocs") == 0) {
+      mCompactRelocations = TRUE;
+      argc --;
+      argv ++;
+      continue;
+    }
+
     if ((stricmp (argv[0], "-m") == 0) || (stricmp (argv[0], "--mcifile") == 0)) {
       mOutImageType = FW_MCI_IMAGE;
       argc --;
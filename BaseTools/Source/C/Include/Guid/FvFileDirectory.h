@@ -0,0 +1,36 @@
+/** @file
+  Definitions of the FV file directory, an EFI_FV_EXT_TYPE_GUID_TYPE entry of
+  the FV extension header that lists the FFS files sorted by name.
+
+  This must be kept in sync with MdeModulePkg/Include/Guid/FvFileDirectory.h.
+
+  Copyright (c) 2021, EDK II contributors. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef __EDKII_FV_FILE_DIRECTORY_GUID_H__
+#define __EDKII_FV_FILE_DIRECTORY_GUID_H__
+
+#define EDKII_FV_FILE_DIRECTORY_GUID \
+  { \
+    0x5a6b2c1e, 0x3f47, 0x4d8b, { 0x9e, 0x21, 0x7c, 0x4a, 0xd0, 0x93, 0xb6, 0x58 } \
+  }
+
+#pragma pack(1)
+
+typedef struct {
+  EFI_GUID    Name;
+  UINT32      Offset;
+} EDKII_FV_FILE_DIRECTORY_ENTRY;
+
+typedef struct {
+  EFI_FIRMWARE_VOLUME_EXT_ENTRY    Hdr;
+  EFI_GUID                         FormatType;
+  UINT32                           FileCount;
+  // EDKII_FV_FILE_DIRECTORY_ENTRY Entry[FileCount];
+} EDKII_FV_FILE_DIRECTORY;
+
+#pragma pack()
+
+#endif
@@ -25,6 +25,13 @@
 #include "CommonLib.h"
 #include "ParseInf.h"
 
+#ifdef _WIN32
+#include "Sdk/C/Threads.h"
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
 #define LZMA_HEADER_SIZE (LZMA_PROPS_SIZE + 8)
 
 typedef enum {
@@ -41,9 +48,19 @@ const char *kInvalidParamValMessage = "Invalid parameter value";
 
 static BoolInt mQuietMode = False;
 static CONVERTER_TYPE mConType = NoConverter;
+static BoolInt mChunked = False;
 
 UINT64 mDictionarySize = 28;
 UINT64 mCompressionMode = 2;
+UINT64 mBlockSize = 1024;
+UINT64 mThreadNumber = 0;
+
+//
+// Layout of the chunked format, see LZMA_CHUNKED_HEADER in
+// MdeModulePkg/Include/Guid/LzmaDecompress.h.
+//
+#define LZMA_CHUNKED_SIGNATURE    0x4B435A4C  // 'L', 'Z', 'C', 'K'
+#define LZMA_CHUNKED_HEADER_SIZE  16
 
 #define UTILITY_NAME "LzmaCompress"
 #define UTILITY_MAJOR_VERSION 0
@@ -60,6 +77,10 @@ void PrintHelp(char *buffer)
              "  -d: decode file\n"
              "  -o FileName, --output FileName: specify the output filename\n"
              "  --f86: enable converter for x86 code\n"
+             "  --chunked: compress the input as independent blocks that can be decoded in parallel\n"
+             "  --block-size Size: set the uncompressed size of a block in KB, default: 1024 (1MB)\n"
+             "  --threads Number: set the number of threads encoding the blocks of --chunked,\n"
+             "                    default: 0 (the number of processors)\n"
              "  -v, --verbose: increase output messages\n"
              "  -q, --quiet: reduce output messages\n"
              "  --debug [0-9]: set debug level\n"
@@ -174,6 +195,334 @@ Done:
   return res;
 }
 
+static void SetUInt32(Byte *buffer, UInt32 value)
+{
+  buffer[0] = (Byte)value;
+  buffer[1] = (Byte)(value >> 8);
+  buffer[2] = (Byte)(value >> 16);
+  buffer[3] = (Byte)(value >> 24);
+}
+
+static UInt32 GetUInt32(const Byte *buffer)
+{
+  return (UInt32)buffer[0] | ((UInt32)buffer[1] << 8) |
+         ((UInt32)buffer[2] << 16) | ((UInt32)buffer[3] << 24);
+}
+
+//
+// The blocks of the chunked format are independent, so they are encoded by
+// several threads. Block N is encoded in slot N of the output buffer, and the
+// slots are packed once all the blocks are done, so the output does not depend
+// on the number of threads.
+//
+typedef struct {
+  const Byte          *inBuffer;
+  size_t              inSize;
+  size_t              blockSize;
+  size_t              blockCount;
+  Byte                *slots;
+  size_t              slotSize;
+  size_t              *slotLength;
+  const CLzmaEncProps *props;
+} CHUNKED_ENCODER;
+
+typedef struct {
+  CHUNKED_ENCODER     *encoder;
+  size_t              first;
+  size_t              step;
+  SRes                res;
+} CHUNKED_WORKER;
+
+static void EncodeBlocks(CHUNKED_WORKER *worker)
+{
+  CHUNKED_ENCODER *encoder = worker->encoder;
+  size_t index;
+
+  worker->res = SZ_OK;
+  for (index = worker->first; index < encoder->blockCount; index += worker->step) {
+    size_t blockStart = index * encoder->blockSize;
+    size_t blockLength = encoder->inSize - blockStart < encoder->blockSize ? encoder->inSize - blockStart : encoder->blockSize;
+    size_t outSizeProcessed = encoder->slotSize - LZMA_HEADER_SIZE;
+    size_t outPropsSize = LZMA_PROPS_SIZE;
+    Byte *block = encoder->slots + index * encoder->slotSize;
+    int i;
+
+    for (i = 0; i < 8; i++)
+      block[i + LZMA_PROPS_SIZE] = (Byte)((UInt64)blockLength >> (8 * i));
+
+    worker->res = LzmaEncode(block + LZMA_HEADER_SIZE, &outSizeProcessed,
+        encoder->inBuffer + blockStart, blockLength,
+        encoder->props, block, &outPropsSize, 0,
+        NULL, &g_Alloc, &g_Alloc);
+    if (worker->res != SZ_OK)
+      return;
+
+    encoder->slotLength[index] = LZMA_HEADER_SIZE + outSizeProcessed;
+  }
+}
+
+#ifdef _WIN32
+static THREAD_FUNC_DECL EncodeBlocksThread(void *param)
+{
+  EncodeBlocks((CHUNKED_WORKER *)param);
+  return 0;
+}
+#else
+static void *EncodeBlocksThread(void *param)
+{
+  EncodeBlocks((CHUNKED_WORKER *)param);
+  return NULL;
+}
+#endif
+
+static size_t GetProcessorCount(void)
+{
+#ifdef _WIN32
+  SYSTEM_INFO info;
+
+  GetSystemInfo(&info);
+  return info.dwNumberOfProcessors > 0 ? (size_t)info.dwNumberOfProcessors : 1;
+#else
+  long count = sysconf(_SC_NPROCESSORS_ONLN);
+
+  return count > 0 ? (size_t)count : 1;
+#endif
+}
+
+static SRes RunEncodeBlocks(CHUNKED_ENCODER *encoder)
+{
+  size_t threadCount = (size_t)mThreadNumber;
+  size_t created;
+  size_t index;
+  CHUNKED_WORKER *workers;
+  SRes res;
+#ifdef _WIN32
+  CThread *threads;
+#else
+  pthread_t *threads;
+#endif
+
+  if (threadCount == 0)
+    threadCount = GetProcessorCount();
+  if (threadCount > encoder->blockCount)
+    threadCount = encoder->blockCount;
+
+  workers = (CHUNKED_WORKER *)MyAlloc(threadCount * sizeof(CHUNKED_WORKER));
+  threads = MyAlloc(threadCount * sizeof(*threads));
+  if (workers == 0 || threads == 0) {
+    MyFree(threads);
+    MyFree(workers);
+    return SZ_ERROR_MEM;
+  }
+
+  for (index = 0; index < threadCount; index++) {
+    workers[index].encoder = encoder;
+    workers[index].first = index;
+    workers[index].step = threadCount;
+    workers[index].res = SZ_OK;
+  }
+
+  //
+  // Worker 0 runs on this thread, and so do the workers whose thread can not
+  // be created.
+  //
+  for (created = 1; created < threadCount; created++) {
+#ifdef _WIN32
+    if (Thread_Create(&threads[created], EncodeBlocksThread, &workers[created]) != 0)
+      break;
+#else
+    if (pthread_create(&threads[created], NULL, EncodeBlocksThread, &workers[created]) != 0)
+      break;
+#endif
+  }
+  for (index = created; index < threadCount; index++) {
+    EncodeBlocks(&workers[index]);
+  }
+  EncodeBlocks(&workers[0]);
+
+  res = SZ_OK;
+  for (index = 1; index < created; index++) {
+#ifdef _WIN32
+    Thread_Wait(&threads[index]);
+    Thread_Close(&threads[index]);
+#else
+    pthread_join(threads[index], NULL);
+#endif
+  }
+  for (index = 0; index < threadCount; index++) {
+    if (workers[index].res != SZ_OK) {
+      res = workers[index].res;
+      break;
+    }
+  }
+
+  MyFree(threads);
+  MyFree(workers);
+  return res;
+}
+
+static SRes EncodeChunked(ISeqOutStream *outStream, ISeqInStream *inStream, UInt64 fileSize, CLzmaEncProps *props)
+{
+  SRes res;
+  size_t inSize = (size_t)fileSize;
+  size_t blockSize = (size_t)mBlockSize * 1024;
+  size_t blockCount;
+  size_t tableSize;
+  size_t slotSize;
+  size_t outPos;
+  size_t index;
+  Byte *inBuffer = 0;
+  Byte *outBuffer = 0;
+  size_t *slotLength = 0;
+  CHUNKED_ENCODER encoder;
+
+  if (inSize == 0)
+    return SZ_ERROR_INPUT_EOF;
+  if (fileSize > 0xFFFFFFFF)
+    return SZ_ERROR_PARAM;
+
+  blockCount = (inSize + blockSize - 1) / blockSize;
+  tableSize = LZMA_CHUNKED_HEADER_SIZE + blockCount * 4;
+
+  inBuffer = (Byte *)MyAlloc(inSize);
+  if (inBuffer == 0)
+    return SZ_ERROR_MEM;
+
+  if (SeqInStream_Read(inStream, inBuffer, inSize) != SZ_OK) {
+    res = SZ_ERROR_READ;
+    goto Done;
+  }
+
+  // same 105% + 64KB margin as Encode(), for every block
+  slotSize = LZMA_HEADER_SIZE + blockSize / 20 * 21 + (1 << 16);
+  outBuffer = (Byte *)MyAlloc(tableSize + blockCount * slotSize);
+  slotLength = (size_t *)MyAlloc(blockCount * sizeof(size_t));
+  if (outBuffer == 0 || slotLength == 0) {
+    res = SZ_ERROR_MEM;
+    goto Done;
+  }
+
+  SetUInt32(outBuffer, LZMA_CHUNKED_SIGNATURE);
+  SetUInt32(outBuffer + 4, (UInt32)blockSize);
+  SetUInt32(outBuffer + 8, (UInt32)blockCount);
+  SetUInt32(outBuffer + 12, (UInt32)inSize);
+
+  // a dictionary larger than a block only costs memory
+  props->reduceSize = blockSize;
+
+  encoder.inBuffer = inBuffer;
+  encoder.inSize = inSize;
+  encoder.blockSize = blockSize;
+  encoder.blockCount = blockCount;
+  encoder.slots = outBuffer + tableSize;
+  encoder.slotSize = slotSize;
+  encoder.slotLength = slotLength;
+  encoder.props = props;
+
+  res = RunEncodeBlocks(&encoder);
+  if (res != SZ_OK)
+    goto Done;
+
+  //
+  // Pack the slots behind the offset table. A block never moves up, so the
+  // blocks not moved yet are never overwritten.
+  //
+  outPos = tableSize;
+  for (index = 0; index < blockCount; index++) {
+    if (outPos > 0xFFFFFFFF) {
+      res = SZ_ERROR_PARAM;
+      goto Done;
+    }
+    SetUInt32(outBuffer + LZMA_CHUNKED_HEADER_SIZE + index * 4, (UInt32)outPos);
+    memmove(outBuffer + outPos, encoder.slots + index * slotSize, slotLength[index]);
+    outPos += slotLength[index];
+  }
+
+  if (outStream->Write(outStream, outBuffer, outPos) != outPos)
+    res = SZ_ERROR_WRITE;
+
+Done:
+  MyFree(slotLength);
+  MyFree(outBuffer);
+  MyFree(inBuffer);
+
+  return res;
+}
+
+static SRes DecodeChunked(ISeqOutStream *outStream, ISeqInStream *inStream, UInt64 fileSize)
+{
+  SRes res;
+  size_t inSize = (size_t)fileSize;
+  size_t blockSize;
+  size_t blockCount;
+  size_t outSize;
+  size_t index;
+  Byte *inBuffer = 0;
+  Byte *outBuffer = 0;
+
+  if (inSize < LZMA_CHUNKED_HEADER_SIZE)
+    return SZ_ERROR_INPUT_EOF;
+
+  inBuffer = (Byte *)MyAlloc(inSize);
+  if (inBuffer == 0)
+    return SZ_ERROR_MEM;
+
+  if (SeqInStream_Read(inStream, inBuffer, inSize) != SZ_OK) {
+    res = SZ_ERROR_READ;
+    goto Done;
+  }
+
+  blockSize = GetUInt32(inBuffer + 4);
+  blockCount = GetUInt32(inBuffer + 8);
+  outSize = GetUInt32(inBuffer + 12);
+  if (GetUInt32(inBuffer) != LZMA_CHUNKED_SIGNATURE || blockSize == 0 ||
+      blockCount != (outSize + blockSize - 1) / blockSize ||
+      LZMA_CHUNKED_HEADER_SIZE + blockCount * 4 > inSize) {
+    res = SZ_ERROR_DATA;
+    goto Done;
+  }
+
+  if (outSize == 0) {
+    res = SZ_OK;
+    goto Done;
+  }
+
+  outBuffer = (Byte *)MyAlloc(outSize);
+  if (outBuffer == 0) {
+    res = SZ_ERROR_MEM;
+    goto Done;
+  }
+
+  for (index = 0; index < blockCount; index++) {
+    size_t start = GetUInt32(inBuffer + LZMA_CHUNKED_HEADER_SIZE + index * 4);
+    size_t end = index + 1 < blockCount ? GetUInt32(inBuffer + LZMA_CHUNKED_HEADER_SIZE + (index + 1) * 4) : inSize;
+    size_t blockStart = index * blockSize;
+    size_t blockLength = outSize - blockStart < blockSize ? outSize - blockStart : blockSize;
+    size_t inSizePure;
+    ELzmaStatus status;
+
+    if (end > inSize || end < start || end - start < LZMA_HEADER_SIZE) {
+      res = SZ_ERROR_DATA;
+      goto Done;
+    }
+
+    inSizePure = end - start - LZMA_HEADER_SIZE;
+    res = LzmaDecode(outBuffer + blockStart, &blockLength, inBuffer + start + LZMA_HEADER_SIZE, &inSizePure,
+        inBuffer + start, LZMA_PROPS_SIZE, LZMA_FINISH_END, &status, &g_Alloc);
+    if (res != SZ_OK)
+      goto Done;
+  }
+
+  if (outStream->Write(outStream, outBuffer, outSize) != outSize)
+    res = SZ_ERROR_WRITE;
+
+Done:
+  MyFree(outBuffer);
+  MyFree(inBuffer);
+
+  return res;
+}
+
 static SRes Decode(ISeqOutStream *outStream, ISeqInStream *inStream, UInt64 fileSize)
 {
   SRes res;
@@ -272,6 +621,26 @@ int main2(int numArgs, const char *args[], char *rs)
       modeWasSet = True;
     } else if (strcmp(args[param], "--f86") == 0) {
       mConType = X86Converter;
+    } else if (strcmp(args[param], "--chunked") == 0) {
+      mChunked = True;
+    } else if (strcmp(args[param], "--block-size") == 0) {
+      if (numArgs < (param + 2)) {
+        return PrintUserError(rs);
+      }
+      AsciiStringToUint64(args[param + 1],FALSE,&mBlockSize);
+      if ((mBlockSize == 0) || (mBlockSize > 0x3FFFFF)) {
+        return PrintError(rs, kInvalidParamValMessage);
+      }
+      param++;
+    } else if (strcmp(args[param], "--threads") == 0) {
+      if (numArgs < (param + 2)) {
+        return PrintUserError(rs);
+      }
+      AsciiStringToUint64(args[param + 1],FALSE,&mThreadNumber);
+      if (mThreadNumber > 256) {
+        return PrintError(rs, kInvalidParamValMessage);
+      }
+      param++;
     } else if (strcmp(args[param], "-o") == 0 ||
                strcmp(args[param], "--output") == 0) {
       if (numArgs < (param + 2)) {
@@ -342,6 +711,14 @@ int main2(int numArgs, const char *args[], char *rs)
     return PrintUserError(rs);
   }
 
+  if (mChunked && (mConType != NoConverter)) {
+    //
+    // The converter state runs across the whole image, which would tie the
+    // blocks back together.
+    //
+    return PrintError(rs, "--chunked can not be combined with --f86");
+  }
+
   {
     size_t t4 = sizeof(UInt32);
     size_t t8 = sizeof(UInt64);
@@ -364,14 +741,22 @@ int main2(int numArgs, const char *args[], char *rs)
     if (!mQuietMode) {
       printf("Encoding\n");
     }
-    res = Encode(&outStream.vt, &inStream.vt, fileSize, &props);
+    if (mChunked) {
+      res = EncodeChunked(&outStream.vt, &inStream.vt, fileSize, &props);
+    } else {
+      res = Encode(&outStream.vt, &inStream.vt, fileSize, &props);
+    }
   }
   else
   {
     if (!mQuietMode) {
       printf("Decoding\n");
     }
-    res = Decode(&outStream.vt, &inStream.vt, fileSize);
+    if (mChunked) {
+      res = DecodeChunked(&outStream.vt, &inStream.vt, fileSize);
+    } else {
+      res = Decode(&outStream.vt, &inStream.vt, fileSize);
+    }
   }
 
   File_Close(&outStream.file);
@@ -0,0 +1,219 @@
+/** @file
+  Zstandard Compress/Decompress tool (ZstdCompress)
+
+  Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "zstd/lib/zstd.h"
+
+#define UTILITY_NAME "ZstdCompress"
+#define UTILITY_MAJOR_VERSION 0
+#define UTILITY_MINOR_VERSION 1
+
+//
+// Firmware decoders allocate the whole output buffer up front, so a large
+// window costs nothing at decode time.
+//
+#define DEFAULT_LEVEL 19
+
+static void PrintHelp(void)
+{
+  printf(
+      "\n" UTILITY_NAME " - Copyright (c) 2020, Intel Corporation. All rights reserved.\n"
+      "Based on Zstandard %s\n"
+      "\nUsage:  ZstdCompress -e|-d [options] <inputFile>\n"
+             "  -e: encode file\n"
+             "  -d: decode file\n"
+             "  -o FileName, --output FileName: specify the output filename\n"
+             "  -q Level: set compression level [1, %d], default: %d\n"
+             "  -v, --verbose: increase output messages\n"
+             "  --debug [0-9]: set debug level\n"
+             "  --version: display the program version and exit\n"
+             "  -h, --help: display this help text\n",
+      ZSTD_versionString(), ZSTD_maxCLevel(), DEFAULT_LEVEL
+      );
+}
+
+static int PrintError(const char *message)
+{
+  fprintf(stderr, "\n" UTILITY_NAME ": error: %s\n", message);
+  return 1;
+}
+
+static unsigned char *ReadInput(const char *fileName, size_t *size)
+{
+  FILE *file;
+  long length;
+  unsigned char *buffer;
+
+  file = fopen(fileName, "rb");
+  if (file == NULL)
+    return NULL;
+
+  buffer = NULL;
+  if (fseek(file, 0, SEEK_END) == 0 && (length = ftell(file)) >= 0 && fseek(file, 0, SEEK_SET) == 0) {
+    // one extra byte so that an empty file still gets a buffer
+    buffer = (unsigned char *)malloc((size_t)length + 1);
+    if (buffer != NULL && fread(buffer, 1, (size_t)length, file) != (size_t)length) {
+      free(buffer);
+      buffer = NULL;
+    }
+    *size = (size_t)length;
+  }
+
+  fclose(file);
+  return buffer;
+}
+
+static int WriteOutput(const char *fileName, const void *buffer, size_t size)
+{
+  FILE *file;
+  int res;
+
+  file = fopen(fileName, "wb");
+  if (file == NULL)
+    return PrintError("Can not open output file");
+
+  res = (fwrite(buffer, 1, size, file) == size) ? 0 : PrintError("Can not write output file");
+  fclose(file);
+  return res;
+}
+
+static int Encode(const char *outputFile, const unsigned char *in, size_t inSize, int level)
+{
+  ZSTD_CCtx *cctx;
+  void *out;
+  size_t outSize;
+  int res;
+
+  cctx = ZSTD_createCCtx();
+  outSize = ZSTD_compressBound(inSize);
+  out = malloc(outSize);
+  if (cctx == NULL || out == NULL) {
+    ZSTD_freeCCtx(cctx);
+    free(out);
+    return PrintError("Can not allocate memory");
+  }
+
+  //
+  // The firmware decoder sizes its output buffer from the frame header,
+  // so the content size must always be recorded. A checksum is not needed,
+  // the FFS file is already protected.
+  //
+  ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, level);
+  ZSTD_CCtx_setParameter(cctx, ZSTD_c_contentSizeFlag, 1);
+  ZSTD_CCtx_setParameter(cctx, ZSTD_c_checksumFlag, 0);
+  outSize = ZSTD_compress2(cctx, out, outSize, in, inSize);
+  if (ZSTD_isError(outSize)) {
+    res = PrintError(ZSTD_getErrorName(outSize));
+  } else {
+    res = WriteOutput(outputFile, out, outSize);
+  }
+
+  ZSTD_freeCCtx(cctx);
+  free(out);
+  return res;
+}
+
+static int Decode(const char *outputFile, const unsigned char *in, size_t inSize)
+{
+  unsigned long long contentSize;
+  void *out;
+  size_t outSize;
+  int res;
+
+  contentSize = ZSTD_getFrameContentSize(in, inSize);
+  if (contentSize == ZSTD_CONTENTSIZE_ERROR || contentSize == ZSTD_CONTENTSIZE_UNKNOWN) {
+    return PrintError("Data error");
+  }
+
+  out = malloc((size_t)contentSize + 1);
+  if (out == NULL)
+    return PrintError("Can not allocate memory");
+
+  outSize = ZSTD_decompress(out, (size_t)contentSize, in, inSize);
+  if (ZSTD_isError(outSize)) {
+    res = PrintError(ZSTD_getErrorName(outSize));
+  } else {
+    res = WriteOutput(outputFile, out, outSize);
+  }
+
+  free(out);
+  return res;
+}
+
+int main(int numArgs, const char *args[])
+{
+  int encodeMode = 0;
+  int modeWasSet = 0;
+  int level = DEFAULT_LEVEL;
+  int verbose = 0;
+  const char *inputFile = NULL;
+  const char *outputFile = "file.tmp";
+  unsigned char *in;
+  size_t inSize;
+  int param;
+  int res;
+
+  if (numArgs == 1) {
+    PrintHelp();
+    return 0;
+  }
+
+  for (param = 1; param < numArgs; param++) {
+    if (strcmp(args[param], "-e") == 0 || strcmp(args[param], "-d") == 0) {
+      encodeMode = (args[param][1] == 'e');
+      modeWasSet = 1;
+    } else if (strcmp(args[param], "-o") == 0 || strcmp(args[param], "--output") == 0) {
+      if (numArgs < (param + 2))
+        return PrintError("Incorrect command");
+      outputFile = args[++param];
+    } else if (strcmp(args[param], "-q") == 0) {
+      if (numArgs < (param + 2))
+        return PrintError("Incorrect command");
+      level = atoi(args[++param]);
+      if (level < 1 || level > ZSTD_maxCLevel())
+        return PrintError("Invalid parameter value");
+    } else if (strcmp(args[param], "--debug") == 0) {
+      if (numArgs < (param + 2))
+        return PrintError("Incorrect command");
+      //
+      // For now we silently ignore this parameter to achieve command line
+      // parameter compatibility with other build tools.
+      //
+      param++;
+    } else if (strcmp(args[param], "-v") == 0 || strcmp(args[param], "--verbose") == 0) {
+      verbose = 1;
+    } else if (strcmp(args[param], "-h") == 0 || strcmp(args[param], "--help") == 0) {
+      PrintHelp();
+      return 0;
+    } else if (strcmp(args[param], "--version") == 0) {
+      printf("%s Version %d.%d\n", UTILITY_NAME, UTILITY_MAJOR_VERSION, UTILITY_MINOR_VERSION);
+      return 0;
+    } else if (inputFile == NULL) {
+      inputFile = args[param];
+    } else {
+      return PrintError("Incorrect command");
+    }
+  }
+
+  if (inputFile == NULL || !modeWasSet)
+    return PrintError("Incorrect command");
+
+  in = ReadInput(inputFile, &inSize);
+  if (in == NULL)
+    return PrintError("Can not read input file");
+
+  if (verbose)
+    printf("%s %s\n", encodeMode ? "Encoding" : "Decoding", inputFile);
+
+  res = encodeMode ? Encode(outputFile, in, inSize, level) : Decode(outputFile, in, inSize);
+  free(in);
+  return res;
+}
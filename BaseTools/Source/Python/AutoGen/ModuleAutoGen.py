@@ -1916,7 +1916,7 @@ class ModuleAutoGen(AutoGen):
             with open(LongFilePath(str(File)), 'rb') as f:
                 Content = f.read()
             m.update(Content)
-            FileList.append((str(File), hashlib.md5(Content).hexdigest()))
+            FileList.append((GetCacheRelPath(File), hashlib.md5(Content).hexdigest()))
 
         HashChainFile = path.join(self.BuildDir, self.Name + ".autogen.hashchain." + m.hexdigest())
         GlobalData.gCMakeHashFile[(self.MetaFile.Path, self.Arch)] = HashChainFile
@@ -1976,7 +1976,7 @@ class ModuleAutoGen(AutoGen):
             with open(LongFilePath(File), 'rb') as f:
                 Content = f.read()
             m.update(Content)
-            FileList.append((File, hashlib.md5(Content).hexdigest()))
+            FileList.append((GetCacheRelPath(File), hashlib.md5(Content).hexdigest()))
 
         HashChainFile = path.join(self.BuildDir, self.Name + ".hashchain." + m.hexdigest())
         GlobalData.gModuleHashFile[(self.MetaFile.Path, self.Arch)] = HashChainFile
@@ -2005,8 +2005,8 @@ class ModuleAutoGen(AutoGen):
         # Add Platform level hash
         HashFile = GlobalData.gPlatformHashFile
         if path.exists(LongFilePath(HashFile)):
-            FileList.append(HashFile)
-            m.update(HashFile.encode('utf-8'))
+            FileList.append(GetCacheRelPath(HashFile))
+            m.update(GetCacheRelPath(HashFile).encode('utf-8'))
         else:
             EdkLogger.quiet("[cache warning]: No Platform HashFile: %s" % HashFile)
 
@@ -2018,8 +2018,8 @@ class ModuleAutoGen(AutoGen):
                     continue
                 HashFile = GlobalData.gPackageHashFile[(Pkg.PackageName, Pkg.Arch)]
                 if path.exists(LongFilePath(HashFile)):
-                    FileList.append(HashFile)
-                    m.update(HashFile.encode('utf-8'))
+                    FileList.append(GetCacheRelPath(HashFile))
+                    m.update(GetCacheRelPath(HashFile).encode('utf-8'))
                 else:
                     EdkLogger.quiet("[cache warning]:No Package HashFile: %s" % HashFile)
 
@@ -2032,8 +2032,8 @@ class ModuleAutoGen(AutoGen):
         else:
             EdkLogger.quiet("[cache error]:No ModuleHashFile for module: %s[%s]" % (self.MetaFile.Path, self.Arch))
         if path.exists(LongFilePath(HashFile)):
-            FileList.append(HashFile)
-            m.update(HashFile.encode('utf-8'))
+            FileList.append(GetCacheRelPath(HashFile))
+            m.update(GetCacheRelPath(HashFile).encode('utf-8'))
         else:
             EdkLogger.quiet("[cache warning]:No Module HashFile: %s" % HashFile)
 
@@ -2046,8 +2046,8 @@ class ModuleAutoGen(AutoGen):
                 else:
                     EdkLogger.quiet("[cache error]:No ModuleHashFile for lib: %s[%s]" % (Lib.MetaFile.Path, Lib.Arch))
                 if path.exists(LongFilePath(HashFile)):
-                    FileList.append(HashFile)
-                    m.update(HashFile.encode('utf-8'))
+                    FileList.append(GetCacheRelPath(HashFile))
+                    m.update(GetCacheRelPath(HashFile).encode('utf-8'))
                 else:
                     EdkLogger.quiet("[cache warning]:No Lib HashFile: %s" % HashFile)
 
@@ -2072,8 +2072,8 @@ class ModuleAutoGen(AutoGen):
         # Add AutoGen hash
         HashFile = GlobalData.gCMakeHashFile[(self.MetaFile.Path, self.Arch)]
         if path.exists(LongFilePath(HashFile)):
-            FileList.append(HashFile)
-            m.update(HashFile.encode('utf-8'))
+            FileList.append(GetCacheRelPath(HashFile))
+            m.update(GetCacheRelPath(HashFile).encode('utf-8'))
         else:
             EdkLogger.quiet("[cache warning]:No AutoGen HashFile: %s" % HashFile)
 
@@ -2083,8 +2083,8 @@ class ModuleAutoGen(AutoGen):
         else:
             EdkLogger.quiet("[cache error]:No ModuleHashFile for module: %s[%s]" % (self.MetaFile.Path, self.Arch))
         if path.exists(LongFilePath(HashFile)):
-            FileList.append(HashFile)
-            m.update(HashFile.encode('utf-8'))
+            FileList.append(GetCacheRelPath(HashFile))
+            m.update(GetCacheRelPath(HashFile).encode('utf-8'))
         else:
             EdkLogger.quiet("[cache warning]:No Module HashFile: %s" % HashFile)
 
@@ -2096,8 +2096,8 @@ class ModuleAutoGen(AutoGen):
                 else:
                     EdkLogger.quiet("[cache error]:No ModuleHashFile for lib: %s[%s]" % (Lib.MetaFile.Path, Lib.Arch))
                 if path.exists(LongFilePath(HashFile)):
-                    FileList.append(HashFile)
-                    m.update(HashFile.encode('utf-8'))
+                    FileList.append(GetCacheRelPath(HashFile))
+                    m.update(GetCacheRelPath(HashFile).encode('utf-8'))
                 else:
                     EdkLogger.quiet("[cache warning]:No Lib HashFile: %s" % HashFile)
 
@@ -2115,7 +2115,7 @@ class ModuleAutoGen(AutoGen):
         # all hashchain files content
         HashStr = HashChainFile.split('.')[-1]
         if len(HashStr) != 32:
-            EdkLogger.quiet("[cache error]: wrong format HashChainFile:%s" % (File))
+            EdkLogger.quiet("[cache error]: wrong format HashChainFile:%s" % (HashChainFile))
             return False
 
         try:
@@ -2128,6 +2128,7 @@ class ModuleAutoGen(AutoGen):
         # Print the different file info
         # print(HashChainFile)
         for idx, (SrcFile, SrcHash) in enumerate (HashChainList):
+            SrcFile = GetCacheAbsPath(SrcFile)
             if SrcFile in GlobalData.gFileHashDict:
                 DestHash = GlobalData.gFileHashDict[SrcFile]
             else:
@@ -2216,13 +2217,16 @@ class ModuleAutoGen(AutoGen):
                 elif HashChainStatus == True:
                     continue
                 # Convert to path start with cache source dir
-                RelativePath = os.path.relpath(HashChainFile, self.WorkspaceDir)
+                if path.isabs(HashChainFile):
+                    RelativePath = os.path.relpath(HashChainFile, self.WorkspaceDir)
+                else:
+                    RelativePath = path.normpath(HashChainFile)
                 NewFilePath = os.path.join(GlobalData.gBinCacheSource, RelativePath)
                 if self.CheckHashChainFile(NewFilePath):
                     GlobalData.gHashChainStatus[HashChainFile] = True
                     # Save the module self HashFile for GenPreMakefileHashList later usage
                     if self.Name + ".hashchain." in HashChainFile:
-                        GlobalData.gModuleHashFile[(self.MetaFile.Path, self.Arch)] = HashChainFile
+                        GlobalData.gModuleHashFile[(self.MetaFile.Path, self.Arch)] = GetCacheAbsPath(HashChainFile)
                 else:
                     GlobalData.gHashChainStatus[HashChainFile] = False
                     HashMiss = True
@@ -2317,11 +2321,11 @@ class ModuleAutoGen(AutoGen):
                     break
                 elif HashChainStatus == True:
                     continue
-                if self.CheckHashChainFile(HashChainFile):
+                if self.CheckHashChainFile(GetCacheAbsPath(HashChainFile)):
                     GlobalData.gHashChainStatus[HashChainFile] = True
                     # Save the module self HashFile for GenPreMakefileHashList later usage
                     if self.Name + ".hashchain." in HashChainFile:
-                        GlobalData.gModuleHashFile[(self.MetaFile.Path, self.Arch)] = HashChainFile
+                        GlobalData.gModuleHashFile[(self.MetaFile.Path, self.Arch)] = GetCacheAbsPath(HashChainFile)
                 else:
                     GlobalData.gHashChainStatus[HashChainFile] = False
                     HashMiss = True
@@ -2376,7 +2380,10 @@ class ModuleAutoGen(AutoGen):
                 elif HashChainStatus == True:
                     continue
                 # Convert to path start with cache source dir
-                RelativePath = os.path.relpath(HashChainFile, self.WorkspaceDir)
+                if path.isabs(HashChainFile):
+                    RelativePath = os.path.relpath(HashChainFile, self.WorkspaceDir)
+                else:
+                    RelativePath = path.normpath(HashChainFile)
                 NewFilePath = os.path.join(GlobalData.gBinCacheSource, RelativePath)
                 if self.CheckHashChainFile(NewFilePath):
                     GlobalData.gHashChainStatus[HashChainFile] = True
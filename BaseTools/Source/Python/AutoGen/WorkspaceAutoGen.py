@@ -578,7 +578,7 @@ class WorkspaceAutoGen(AutoGen):
                 Content = f.read()
                 f.close()
                 m.update(Content)
-                FileList.append((str(file), hashlib.md5(Content).hexdigest()))
+                FileList.append((GetCacheRelPath(file), hashlib.md5(Content).hexdigest()))
 
             HashDir = path.join(self.BuildDir, "Hash_Platform")
             HashFile = path.join(HashDir, 'Platform.hash.' + m.hexdigest())
@@ -625,7 +625,7 @@ class WorkspaceAutoGen(AutoGen):
         Content = f.read()
         f.close()
         m.update(Content)
-        FileList.append((str(Pkg.MetaFile.Path), hashlib.md5(Content).hexdigest()))
+        FileList.append((GetCacheRelPath(Pkg.MetaFile.Path), hashlib.md5(Content).hexdigest()))
         # Get include files hash value
         if Pkg.Includes:
             for inc in sorted(Pkg.Includes, key=lambda x: str(x)):
@@ -636,7 +636,7 @@ class WorkspaceAutoGen(AutoGen):
                         Content = f.read()
                         f.close()
                         m.update(Content)
-                        FileList.append((str(File_Path), hashlib.md5(Content).hexdigest()))
+                        FileList.append((GetCacheRelPath(File_Path), hashlib.md5(Content).hexdigest()))
         GlobalData.gPackageHash[Pkg.PackageName] = m.hexdigest()
 
         HashDir = PkgDir
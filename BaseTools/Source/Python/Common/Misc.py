@@ -580,6 +580,35 @@ def CopyFileOnChange(SrcFile, Dst, FileLock=None):
 
     return True
 
+## Convert a file path to the form recorded in the build cache
+#
+# The hash chain files and the hash file lists are copied to the binary cache
+# and used by the builds of other workspaces, so the files in WORKSPACE or
+# PACKAGES_PATH are recorded with their relative path.
+#
+#   @param      File      The absolute path of the file
+#
+#   @retval     str       The relative path with '/' separators, or File itself
+#                         if it is not in the workspace
+#
+def GetCacheRelPath(File):
+    File = str(File)
+    RelPath = mws.relpath(File, GlobalData.gWorkspace)
+    if os.path.isabs(RelPath):
+        return File
+    return RelPath.replace(os.sep, '/')
+
+## Convert a file path recorded in the build cache to an absolute path
+#
+#   @param      File      The path returned by GetCacheRelPath()
+#
+#   @retval     str       The absolute path of the file in the current workspace
+#
+def GetCacheAbsPath(File):
+    if os.path.isabs(File):
+        return File
+    return mws.join(GlobalData.gWorkspace, os.path.normpath(File))
+
 ## Retrieve and cache the real path name in file system
 #
 #   @param      Root    The root directory of path relative to
@@ -2101,7 +2101,8 @@ class FdfParser:
             if not (self._GetBlockStatement(FvObj) or self._GetFvBaseAddress(FvObj) or
                 self._GetFvForceRebase(FvObj) or self._GetFvAlignment(FvObj) or
                 self._GetFvAttributes(FvObj) or self._GetFvNameGuid(FvObj) or
-                self._GetFvExtEntryStatement(FvObj) or self._GetFvNameString(FvObj)):
+                self._GetFvExtEntryStatement(FvObj) or self._GetFvNameString(FvObj) or
+                self._GetFvFileOrder(FvObj)):
                 break
 
         if FvObj.FvNameString == 'TRUE' and not FvObj.FvNameGuid:
@@ -2200,6 +2201,29 @@ class FdfParser:
 
         return True
 
+    ## _GetFvFileOrder() method
+    #
+    #   Get the file that lists the boot load order of the modules in the FV
+    #
+    #   @param  self        The object pointer
+    #   @param  Obj         for whom FvFileOrder is got
+    #   @retval True        Successfully find a FvFileOrder statement
+    #   @retval False       Not able to find a FvFileOrder statement
+    #
+    def _GetFvFileOrder(self, Obj):
+        if not self._IsKeyword("FvFileOrder"):
+            return False
+
+        if not self._IsToken(TAB_EQUAL_SPLIT):
+            raise Warning.ExpectedEquals(self.FileName, self.CurrentLineNumber)
+
+        if not self._GetNextToken():
+            raise Warning.Expected("FvFileOrder file name", self.FileName, self.CurrentLineNumber)
+
+        Obj.FvFileOrder = self._Token
+
+        return True
+
 
     ## _GetFvAttributes() method
     #
@@ -2219,7 +2243,8 @@ class FdfParser:
                            "WRITE_DISABLED_CAP", "WRITE_STATUS", "READ_ENABLED_CAP", \
                            "READ_DISABLED_CAP", "READ_STATUS", "READ_LOCK_CAP", \
                            "READ_LOCK_STATUS", "WRITE_LOCK_CAP", "WRITE_LOCK_STATUS", \
-                           "WRITE_POLICY_RELIABLE", "WEAK_ALIGNMENT", "FvUsedSizeEnable"}:
+                           "WRITE_POLICY_RELIABLE", "WEAK_ALIGNMENT", "FvUsedSizeEnable", \
+                           "FvFileDirectoryEnable"}:
                 self._UndoToken()
                 return False
 
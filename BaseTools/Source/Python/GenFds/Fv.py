@@ -22,6 +22,7 @@ from Common.LongFilePathSupport import OpenLongFilePath as open
 from Common.DataType import *
 
 FV_UI_EXT_ENTY_GUID = 'A67DF1FA-8DE8-4E98-AF09-4BDF2EFFBC7C'
+FV_FILE_DIRECTORY_GUID = '5A6B2C1E-3F47-4D8B-9E21-7C4AD093B658'
 
 ## generate FV
 #
@@ -53,8 +54,10 @@ class FV (object):
         self.CapsuleName = None
         self.FvBaseAddress = None
         self.FvForceRebase = None
+        self.FvFileOrder = None
         self.FvRegionInFD = None
         self.UsedSizeEnable = False
+        self.FileDirectoryEnable = False
         self.FvExtEntryTypeValue = []
         self.FvExtEntryType = []
         self.FvExtEntryData = []
@@ -94,7 +97,7 @@ class FV (object):
                                 GenFdsGlobalVariable.ErrorLogger("Capsule %s in FD region can't contain a FV %s in FD region." % (self.CapsuleName, self.UiFvName.upper()))
         if not Flag:
             GenFdsGlobalVariable.InfLogger( "\nGenerating %s FV" %self.UiFvName)
-        GenFdsGlobalVariable.LargeFileInFvFlags.append(False)
+        GenFdsGlobalVariable.ThreadData.LargeFileInFvFlags.append(False)
         FFSGuid = None
 
         if self.FvBaseAddress is not None:
@@ -118,6 +121,7 @@ class FV (object):
                                             TAB_LINE_BREAK)
 
         # Process Modules in FfsList
+        FfsFiles = []
         for FfsFile in self.FfsList:
             if Flag:
                 if isinstance(FfsFile, FfsFileStatement.FileStatement):
@@ -125,6 +129,12 @@ class FV (object):
             if GenFdsGlobalVariable.EnableGenfdsMultiThread and GenFdsGlobalVariable.ModuleFile and GenFdsGlobalVariable.ModuleFile.Path.find(os.path.normpath(FfsFile.InfFileName)) == -1:
                 continue
             FileName = FfsFile.GenFfs(MacroDict, FvParentAddr=BaseAddress, IsMakefile=Flag, FvName=self.UiFvName)
+            FfsFiles.append((FfsFile, FileName))
+
+        if self.FvFileOrder is not None and not Flag:
+            FfsFiles = self._SortByFileOrder(FfsFiles)
+
+        for FfsFile, FileName in FfsFiles:
             FfsFileList.append(FileName)
             if not Flag:
                 self.FvInfFile.append("EFI_FILE_NAME = " + \
@@ -152,7 +162,7 @@ class FV (object):
             OrigFvInfo = None
             if os.path.exists (FvInfoFileName):
                 OrigFvInfo = open(FvInfoFileName, 'r').read()
-            if GenFdsGlobalVariable.LargeFileInFvFlags[-1]:
+            if GenFdsGlobalVariable.ThreadData.LargeFileInFvFlags[-1]:
                 FFSGuid = GenFdsGlobalVariable.EFI_FIRMWARE_FILE_SYSTEM3_GUID
             GenFdsGlobalVariable.GenerateFirmwareVolume(
                                     FvOutputFile,
@@ -184,7 +194,7 @@ class FV (object):
                     for FfsFile in self.FfsList:
                         FileName = FfsFile.GenFfs(MacroDict, FvChildAddr, BaseAddress, IsMakefile=Flag, FvName=self.UiFvName)
 
-                    if GenFdsGlobalVariable.LargeFileInFvFlags[-1]:
+                    if GenFdsGlobalVariable.ThreadData.LargeFileInFvFlags[-1]:
                         FFSGuid = GenFdsGlobalVariable.EFI_FIRMWARE_FILE_SYSTEM3_GUID;
                     #Update GenFv again
                     GenFdsGlobalVariable.GenerateFirmwareVolume(
@@ -226,13 +236,47 @@ class FV (object):
                         self.FvAlignment = str (FvAlignmentValue)
                     FvFileObj.close()
                     GenFdsGlobalVariable.ImageBinDict[self.UiFvName.upper() + 'fv'] = FvOutputFile
-                    GenFdsGlobalVariable.LargeFileInFvFlags.pop()
+                    GenFdsGlobalVariable.ThreadData.LargeFileInFvFlags.pop()
                 else:
                     GenFdsGlobalVariable.ErrorLogger("Invalid FV file %s." % self.UiFvName)
             else:
                 GenFdsGlobalVariable.ErrorLogger("Failed to generate %s FV file." %self.UiFvName)
         return FvOutputFile
 
+    ## _SortByFileOrder()
+    #
+    #   Sort the FFS files of the FV by the FvFileOrder file, which lists the
+    #   modules in the order they are loaded during boot, e.g. as recorded by
+    #   DxeCorePerformanceLib. Each line names a module by its FILE_GUID or
+    #   BASE_NAME; '#' starts a comment. Listed files are placed first, in the
+    #   listed order; the others follow in FDF order.
+    #
+    #   @param  self        The object pointer
+    #   @param  FfsFiles    List of (FFS statement, FFS file name) tuples
+    #   @retval list        The sorted list
+    #
+    def _SortByFileOrder(self, FfsFiles):
+        OrderFileName = GenFdsGlobalVariable.ReplaceWorkspaceMacro(self.FvFileOrder)
+        if not os.path.isfile(OrderFileName):
+            GenFdsGlobalVariable.InfLogger("FvFileOrder file %s of FV %s not found, keeping the FDF order" % (OrderFileName, self.UiFvName))
+            return FfsFiles
+
+        Rank = {}
+        with open(OrderFileName, 'r') as OrderFile:
+            for Line in OrderFile:
+                Tokens = Line.split('#', 1)[0].split()
+                if Tokens and Tokens[0].upper() not in Rank:
+                    Rank[Tokens[0].upper()] = len(Rank)
+
+        def FileRank(Item):
+            Index, (FfsFile, _) = Item
+            for Name in (getattr(FfsFile, 'ModuleGuid', None), getattr(FfsFile, 'NameGuid', None), getattr(FfsFile, 'BaseName', None)):
+                if Name and Name.upper() in Rank:
+                    return (0, Rank[Name.upper()], Index)
+            return (1, 0, Index)
+
+        return [Item for _, Item in sorted(enumerate(FfsFiles), key=FileRank)]
+
     ## _GetBlockSize()
     #
     #   Calculate FV's block size
@@ -328,6 +372,10 @@ class FV (object):
                     if self.FvAttributeDict[FvAttribute].upper() in ('TRUE', '1'):
                         self.UsedSizeEnable = True
                     continue
+                if FvAttribute == "FvFileDirectoryEnable":
+                    if self.FvAttributeDict[FvAttribute].upper() in ('TRUE', '1'):
+                        self.FileDirectoryEnable = True
+                    continue
                 self.FvInfFile.append("EFI_"            + \
                                           FvAttribute       + \
                                           ' = '             + \
@@ -343,7 +391,7 @@ class FV (object):
         # Generate FV extension header file
         #
         if not self.FvNameGuid:
-            if len(self.FvExtEntryType) > 0 or self.UsedSizeEnable:
+            if len(self.FvExtEntryType) > 0 or self.UsedSizeEnable or self.FileDirectoryEnable:
                 GenFdsGlobalVariable.ErrorLogger("FV Extension Header Entries declared for %s with no FvNameGuid declaration." % (self.UiFvName))
         else:
             TotalSize = 16 + 4
@@ -358,6 +406,29 @@ class FV (object):
                 # } EFI_FIRMWARE_VOLUME_EXT_ENTRY_USED_SIZE_TYPE;
                 Buffer += pack('HHL', 8, 3, 0)
 
+            if self.FileDirectoryEnable:
+                #
+                # Reserve the FV file directory, GenFv fills it once all the
+                # files are placed. There is at most one FFS file per Apriori
+                # section and per FILE or INF statement.
+                #
+                # Layout:
+                #   EFI_FIRMWARE_VOLUME_EXT_ENTRY: size 4
+                #   GUID: size 16
+                #   FileCount: size 4
+                #   (Name GUID, Offset) entries: 20 bytes each
+                #
+                FileCount = len(self.AprioriSectionList) + len(self.FfsList)
+                DirectorySize = 16 + 4 + 4 + 20 * FileCount
+                if DirectorySize >= 0x10000:
+                    GenFdsGlobalVariable.ErrorLogger("The FV file directory of %s exceeds 0x10000 bytes." % (self.UiFvName))
+                TotalSize += DirectorySize
+                Guid = FV_FILE_DIRECTORY_GUID.split('-')
+                Buffer += (pack('HH', DirectorySize, 0x0002)
+                           + PackGUID(Guid)
+                           + pack('=L', 0)
+                           + bytes(20 * FileCount))
+
             if self.FvNameString == 'TRUE':
                 #
                 # Create EXT entry for FV UI name
@@ -18,6 +18,8 @@ from glob import glob
 from struct import unpack
 from linecache import getlines
 from io import BytesIO
+import threading
+import multiprocessing
 
 import Common.LongFilePathOs as os
 from Common.TargetTxtClassObject import TargetTxtDict
@@ -35,6 +37,7 @@ from Workspace.WorkspaceDatabase import WorkspaceDatabase
 from .FdfParser import FdfParser, Warning
 from .GenFdsGlobalVariable import GenFdsGlobalVariable
 from .FfsFileStatement import FileStatement
+from .FvImageSection import FvImageSection
 import Common.DataType as DataType
 from struct import Struct
 
@@ -94,8 +97,9 @@ def resetFdsGlobalVariable():
     GenFdsGlobalVariable.CopyList   = []
     GenFdsGlobalVariable.ModuleFile = ''
     GenFdsGlobalVariable.EnableGenfdsMultiThread = True
+    GenFdsGlobalVariable.ThreadNumber = 1
 
-    GenFdsGlobalVariable.LargeFileInFvFlags = []
+    GenFdsGlobalVariable.ThreadData.LargeFileInFvFlags = []
     GenFdsGlobalVariable.EFI_FIRMWARE_FILE_SYSTEM3_GUID = '5473C07A-3DCB-4dca-BD6F-1E9689E7349A'
     GenFdsGlobalVariable.LARGE_FILE_SIZE = 0x1000000
 
@@ -142,6 +146,13 @@ def GenFdsApi(FdsCommandDict, WorkSpaceDataBase=None):
                 GenFdsGlobalVariable.EnableGenfdsMultiThread = True
             else:
                 GenFdsGlobalVariable.EnableGenfdsMultiThread = False
+            if FdsCommandDict.get("ThreadNumber"):
+                GenFdsGlobalVariable.ThreadNumber = FdsCommandDict.get("ThreadNumber")
+            else:
+                try:
+                    GenFdsGlobalVariable.ThreadNumber = multiprocessing.cpu_count()
+                except (ImportError, NotImplementedError):
+                    GenFdsGlobalVariable.ThreadNumber = 1
         os.chdir(GenFdsGlobalVariable.WorkSpaceDir)
 
         # set multiple workspace
@@ -407,6 +418,7 @@ def OptionsToCommandDict(Options):
     FdsCommandDict["debug"] = Options.debug
     FdsCommandDict["Workspace"] = Options.Workspace
     FdsCommandDict["GenfdsMultiThread"] = not Options.NoGenfdsMultiThread
+    FdsCommandDict["ThreadNumber"] = Options.ThreadNumber
     FdsCommandDict["fdf_file"] = [PathClass(Options.filename)] if Options.filename else []
     FdsCommandDict["build_target"] = Options.BuildTarget
     FdsCommandDict["toolchain_tag"] = Options.ToolChain
@@ -465,6 +477,7 @@ def myOptionParser():
     Parser.add_option("--pcd", action="append", dest="OptionPcd", help="Set PCD value by command line. Format: \"PcdName=Value\" ")
     Parser.add_option("--genfds-multi-thread", action="store_true", dest="GenfdsMultiThread", default=True, help="Enable GenFds multi thread to generate ffs file.")
     Parser.add_option("--no-genfds-multi-thread", action="store_true", dest="NoGenfdsMultiThread", default=False, help="Disable GenFds multi thread to generate ffs file.")
+    Parser.add_option("-n", action="callback", type="int", dest="ThreadNumber", callback=SingleCheckCallback, help="Build the nested FV images with multi-threads. Zero or none means the number of processors.")
 
     Options, _ = Parser.parse_args()
     return Options
@@ -506,6 +519,7 @@ class GenFds(object):
                 FdObj.GenFd()
                 return
         elif GenFds.OnlyGenerateThisFd is None and GenFds.OnlyGenerateThisFv is None:
+            GenFds.GenNestedFvs()
             for FdObj in GenFdsGlobalVariable.FdfParser.Profile.FdDict.values():
                 FdObj.GenFd()
 
@@ -534,6 +548,132 @@ class GenFds(object):
                 for OptRomObj in GenFdsGlobalVariable.FdfParser.Profile.OptRomDict.values():
                     OptRomObj.AddToBuffer(None)
 
+    ## _GetNestedFvNames()
+    #
+    #   @param  SectionList         The sections of a FFS file
+    #   @param  FvNames             Returns the names of the FVs in FV image sections
+    #   @param  FixedFvNames        Returns the names of the FVs in FV image sections
+    #                               generated at a given base address
+    #
+    @staticmethod
+    def _GetNestedFvNames(SectionList, FvNames, FixedFvNames):
+        for SectionObj in SectionList:
+            if isinstance(SectionObj, FvImageSection):
+                if SectionObj.FvName:
+                    FvNames.add(SectionObj.FvName.upper())
+                    if SectionObj.FvAddr:
+                        FixedFvNames.add(SectionObj.FvName.upper())
+            elif hasattr(SectionObj, 'SectionList'):
+                GenFds._GetNestedFvNames(SectionObj.SectionList, FvNames, FixedFvNames)
+
+    ## _GenFvInThread()
+    #
+    #   @param  FvObj               The FV to generate
+    #   @param  ErrorList           Returns the exception raised by the generation
+    #
+    @staticmethod
+    def _GenFvInThread(FvObj, ErrorList):
+        try:
+            Buffer = BytesIO()
+            FvObj.AddToBuffer(Buffer)
+            Buffer.close()
+        except BaseException as X:
+            ErrorList.append(X)
+
+    ## GenNestedFvs()
+    #
+    #   Generate the FVs nested in FFS files with multiple threads, before the
+    #   FDs and the FVs containing them are generated.
+    #
+    #   Most of the time of GenFds is spent in GenFv, GenSec and the GUIDed
+    #   section tools, which run as external processes, so the threads run
+    #   concurrently. The FVs are generated in waves so that a FV starts after
+    #   all the FVs nested into it. The FVs of a wave have no FFS file in common,
+    #   because the FFS output directories are shared. A nested FV is then found
+    #   in ImageBinDict by the FV containing it.
+    #
+    #   The FVs generated at a base address are left to the serial generation,
+    #   and so are all the FVs when the FDF defines macros in FD, FV or FILE
+    #   statements, as a nested FV inherits the macros of its container.
+    #
+    @staticmethod
+    def GenNestedFvs():
+        if not GenFdsGlobalVariable.EnableGenfdsMultiThread or GenFdsGlobalVariable.ThreadNumber <= 1:
+            return
+
+        Profile = GenFdsGlobalVariable.FdfParser.Profile
+        for FdObj in Profile.FdDict.values():
+            if FdObj.DefineVarDict:
+                return
+
+        NestedFvDict = {}
+        FfsKeyDict = {}
+        FixedFvNames = set()
+        for FvName, FvObj in Profile.FvDict.items():
+            if FvObj.DefineVarDict:
+                return
+            NestedFvNames = set()
+            FfsKeys = set()
+            for FfsFile in FvObj.FfsList:
+                if isinstance(FfsFile, FileStatement):
+                    if FfsFile.DefineVarDict:
+                        return
+                    FfsKeys.add(str(FfsFile.NameGuid).upper())
+                    if FfsFile.FvName:
+                        NestedFvNames.add(FfsFile.FvName.upper())
+                    GenFds._GetNestedFvNames(FfsFile.SectionList, NestedFvNames, FixedFvNames)
+                else:
+                    FfsKeys.add(os.path.normcase(os.path.normpath(FfsFile.InfFileName)))
+            NestedFvDict[FvName] = NestedFvNames
+            FfsKeyDict[FvName] = FfsKeys
+
+        #
+        # Only the FVs nested in FFS files and built without base address are candidates,
+        # and only when all the FVs nested into them are candidates as well.
+        #
+        PendingFvNames = set()
+        for NestedFvNames in NestedFvDict.values():
+            PendingFvNames.update(NestedFvNames)
+        for FvName in list(PendingFvNames):
+            FvObj = Profile.FvDict.get(FvName)
+            if FvObj is None or FvName in FixedFvNames or FvObj.BaseAddress or FvObj.FvBaseAddress or FvObj.CapsuleName:
+                PendingFvNames.discard(FvName)
+        Changed = True
+        while Changed:
+            Changed = False
+            for FvName in list(PendingFvNames):
+                if not NestedFvDict[FvName] <= PendingFvNames:
+                    PendingFvNames.discard(FvName)
+                    Changed = True
+
+        DoneFvNames = set()
+        while PendingFvNames:
+            FvNames = []
+            FfsKeys = set()
+            for FvName in sorted(PendingFvNames):
+                if len(FvNames) == GenFdsGlobalVariable.ThreadNumber:
+                    break
+                if NestedFvDict[FvName] <= DoneFvNames and not FfsKeyDict[FvName] & FfsKeys:
+                    FvNames.append(FvName)
+                    FfsKeys.update(FfsKeyDict[FvName])
+            if not FvNames:
+                break
+
+            GenFdsGlobalVariable.VerboseLogger("\n Generate nested FV images %s in parallel" % ", ".join(FvNames))
+            ErrorList = []
+            ThreadList = []
+            for FvName in FvNames:
+                FvThread = threading.Thread(target=GenFds._GenFvInThread, args=(Profile.FvDict[FvName], ErrorList))
+                FvThread.start()
+                ThreadList.append(FvThread)
+            for FvThread in ThreadList:
+                FvThread.join()
+            if ErrorList:
+                raise ErrorList[0]
+
+            DoneFvNames.update(FvNames)
+            PendingFvNames.difference_update(FvNames)
+
     @staticmethod
     def GenFfsMakefile(OutputDir, FdfParserObject, WorkSpace, ArchList, GlobalData):
         GenFdsGlobalVariable.SetEnv(FdfParserObject, WorkSpace, ArchList, GlobalData)
@@ -14,6 +14,7 @@ from __future__ import absolute_import
 
 import Common.LongFilePathOs as os
 import sys
+import threading
 from sys import stdout
 from subprocess import PIPE,Popen
 from struct import Struct
@@ -33,6 +34,24 @@ from Common.MultipleWorkspace import MultipleWorkspace as mws
 import Common.GlobalData as GlobalData
 from Common.BuildToolError import *
 
+## Per thread state of the FV generation
+#
+# The FVs nested in FFS files may be generated in worker threads, so the
+# state kept while an FV is generated is per thread.
+#
+class FvGenThreadData(threading.local):
+    def __init__(self):
+        #
+        # The list whose element are flags to indicate if large FFS or SECTION files exist in FV.
+        # At the beginning of each generation of FV, false flag is appended to the list,
+        # after the call to GenerateSection returns, check the size of the output file,
+        # if it is greater than 0xFFFFFF, the tail flag in list is set to true,
+        # and EFI_FIRMWARE_FILE_SYSTEM3_GUID is passed to C GenFv.
+        # At the end of generation of FV, pop the flag.
+        # List is used as a stack to handle nested FV generation.
+        #
+        self.LargeFileInFvFlags = []
+
 ## Global variables
 #
 #
@@ -72,17 +91,10 @@ class GenFdsGlobalVariable:
     CopyList   = []
     ModuleFile = ''
     EnableGenfdsMultiThread = True
+    # The number of worker threads generating the nested FVs
+    ThreadNumber = 1
 
-    #
-    # The list whose element are flags to indicate if large FFS or SECTION files exist in FV.
-    # At the beginning of each generation of FV, false flag is appended to the list,
-    # after the call to GenerateSection returns, check the size of the output file,
-    # if it is greater than 0xFFFFFF, the tail flag in list is set to true,
-    # and EFI_FIRMWARE_FILE_SYSTEM3_GUID is passed to C GenFv.
-    # At the end of generation of FV, pop the flag.
-    # List is used as a stack to handle nested FV generation.
-    #
-    LargeFileInFvFlags = []
+    ThreadData = FvGenThreadData()
     EFI_FIRMWARE_FILE_SYSTEM3_GUID = '5473C07A-3DCB-4dca-BD6F-1E9689E7349A'
     LARGE_FILE_SIZE = 0x1000000
 
@@ -517,8 +529,8 @@ class GenFdsGlobalVariable:
                 GenFdsGlobalVariable.DebugLogger(EdkLogger.DEBUG_5, "%s needs update because of newer %s" % (Output, Input))
                 GenFdsGlobalVariable.CallExternalTool(Cmd, "Failed to generate section")
                 if (os.path.getsize(Output) >= GenFdsGlobalVariable.LARGE_FILE_SIZE and
-                    GenFdsGlobalVariable.LargeFileInFvFlags):
-                    GenFdsGlobalVariable.LargeFileInFvFlags[-1] = True
+                    GenFdsGlobalVariable.ThreadData.LargeFileInFvFlags):
+                    GenFdsGlobalVariable.ThreadData.LargeFileInFvFlags[-1] = True
 
     @staticmethod
     def GetAlignment (AlignString):
@@ -28,7 +28,7 @@ from Common.Expression import *
 from CommonDataClass.Exceptions import *
 from Common.LongFilePathSupport import OpenLongFilePath as open
 from collections import defaultdict
-from .MetaFileTable import MetaFileStorage
+from .MetaFileTable import MetaFileStorage, MetaFileParseCache
 from .MetaFileCommentParser import CheckInfComment
 from Common.DataType import TAB_COMMENT_EDK_START, TAB_COMMENT_EDK_END
 
@@ -255,10 +255,13 @@ class MetaFileParser(object):
         if not self._Finished:
             if self._RawTable.IsIntegrity():
                 self._Finished = True
+            elif MetaFileParseCache.Restore(self._RawTable):
+                self._Finished = True
             else:
                 self._Table = self._RawTable
                 self._PostProcessed = False
                 self.Start()
+                MetaFileParseCache.Store(self._RawTable)
     ## Data parser for the common format in different type of file
     #
     #   The common format in the meatfile is like
@@ -9,9 +9,16 @@
 # Import Modules
 #
 from __future__ import absolute_import
+import os
+import sys
 import uuid
+import atexit
+import pickle
+import multiprocessing
+from hashlib import md5
 
 import Common.EdkLogger as EdkLogger
+import Common.GlobalData as GlobalData
 from Common.BuildToolError import FORMAT_INVALID
 
 from CommonDataClass.DataClass import MODEL_FILE_DSC, MODEL_FILE_DEC, MODEL_FILE_INF, \
@@ -428,3 +435,166 @@ class MetaFileStorage(object):
             Class._ObjectCache[key] = reval
         return reval
 
+
+## Persistent cache of the parsed content of INF and DEC files
+#
+# The raw table of an INF or DEC file only depends on the content of that file,
+# so it can be reused by the next build invocation as long as the file has not
+# changed. DSC files are not cached, since their content also depends on
+# macros, conditional directives and included files.
+#
+# The cache is kept next to the build database, in Conf/.cache, and is keyed by
+# file path. An entry is reused if the size and the time stamp of the file are
+# unchanged, or else if the MD5 digest of its content is unchanged.
+#
+class MetaFileParseCache(object):
+    # bump when the layout of the table rows changes
+    _VERSION_ = 1
+    _FILE_NAME_ = 'MetaFileParse.cache'
+    # rows of a table are numbered from FileId * _ID_RANGE_
+    _ID_RANGE_ = 10**8
+
+    _Entries = None
+    _Modified = False
+
+    @classmethod
+    def _CachePath(Class):
+        CacheDir = os.path.dirname(GlobalData.gDatabasePath)
+        if not os.path.isabs(CacheDir) or not os.path.isdir(CacheDir):
+            return None
+        return os.path.join(CacheDir, Class._FILE_NAME_)
+
+    ## Tables produced by another version of the tools must not be reused
+    @classmethod
+    def _ToolStamp(Class):
+        Stamp = [Class._VERSION_, sys.version]
+        Dir = os.path.dirname(os.path.abspath(__file__))
+        for Name in ('MetaFileParser.py', 'MetaFileTable.py'):
+            try:
+                Stamp.append(os.path.getmtime(os.path.join(Dir, Name)))
+            except OSError:
+                pass
+        return tuple(Stamp)
+
+    @staticmethod
+    def _Enabled(Table):
+        if not isinstance(Table, (ModuleTable, PackageTable)):
+            return False
+        # usage information in comments is checked while parsing
+        if GlobalData.gOptions and GlobalData.gOptions.CheckUsage:
+            return False
+        return True
+
+    @staticmethod
+    def _Stat(MetaFile):
+        Stat = os.stat(MetaFile.Path)
+        return (Stat.st_size, Stat.st_mtime)
+
+    @staticmethod
+    def _Digest(MetaFile):
+        with open(MetaFile.Path, 'rb') as File:
+            return md5(File.read()).hexdigest()
+
+    @classmethod
+    def _Load(Class):
+        Class._Entries = {}
+        Path = Class._CachePath()
+        if Path is None or not os.path.exists(Path):
+            return
+        try:
+            with open(Path, 'rb') as File:
+                Stamp, Entries = pickle.load(File)
+            if Stamp == Class._ToolStamp():
+                Class._Entries = Entries
+        except Exception as Exc:
+            EdkLogger.debug(EdkLogger.DEBUG_5, str(Exc))
+
+    @classmethod
+    def _SetModified(Class):
+        if not Class._Modified:
+            atexit.register(Class.Save)
+        Class._Modified = True
+
+    ## Move the row IDs of a cached table to the ID range of the new table
+    @classmethod
+    def _Rebase(Class, Row, Base, Delta):
+        Row = list(Row)
+        # ID and BelongsToItem columns
+        for Index in (0, 7):
+            if Base <= Row[Index] < Base + Class._ID_RANGE_:
+                Row[Index] += Delta
+        return Row
+
+    ## Fill an empty table from the cache
+    #
+    #   @param      Table       The raw table of an INF or DEC file
+    #
+    #   @retval     True        The table was restored and is complete
+    #   @retval     False       The file must be parsed
+    #
+    @classmethod
+    def Restore(Class, Table):
+        if not Class._Enabled(Table):
+            return False
+        if Class._Entries is None:
+            Class._Load()
+        Entry = Class._Entries.get(Table.MetaFile.Path)
+        if Entry is None:
+            return False
+        try:
+            Stat = Class._Stat(Table.MetaFile)
+            if Stat != Entry['Stat']:
+                if Class._Digest(Table.MetaFile) != Entry['Digest']:
+                    return False
+                Entry['Stat'] = Stat
+                Class._SetModified()
+        except (OSError, IOError):
+            return False
+
+        Base = Entry['Base']
+        Delta = Table.FileId * Class._ID_RANGE_ - Base
+        Table.CurrentContent = [Class._Rebase(Row, Base, Delta) for Row in Entry['Rows']]
+        return Table.IsIntegrity()
+
+    ## Record a table that has just been parsed
+    #
+    #   @param      Table       The raw table of an INF or DEC file
+    #
+    @classmethod
+    def Store(Class, Table):
+        if not Class._Enabled(Table) or not Table.IsIntegrity():
+            return
+        if Class._Entries is None:
+            Class._Load()
+        try:
+            Stat = Class._Stat(Table.MetaFile)
+            Digest = Class._Digest(Table.MetaFile)
+        except (OSError, IOError):
+            return
+        Class._Entries[Table.MetaFile.Path] = {
+            'Stat'   : Stat,
+            'Digest' : Digest,
+            'Base'   : Table.FileId * Class._ID_RANGE_,
+            'Rows'   : [list(Row) for Row in Table.CurrentContent],
+        }
+        Class._SetModified()
+
+    ## Write the cache back to disk, called at exit
+    @classmethod
+    def Save(Class):
+        if not Class._Modified:
+            return
+        # only the main build process writes the cache
+        if multiprocessing.current_process().name != 'MainProcess':
+            return
+        Path = Class._CachePath()
+        if Path is None:
+            return
+        TempPath = '%s.%d' % (Path, os.getpid())
+        try:
+            with open(TempPath, 'wb') as File:
+                pickle.dump((Class._ToolStamp(), Class._Entries), File, pickle.HIGHEST_PROTOCOL)
+            os.replace(TempPath, Path)
+        except Exception as Exc:
+            EdkLogger.debug(EdkLogger.DEBUG_5, str(Exc))
+        Class._Modified = False
@@ -9,6 +9,61 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include "InternalCryptLib.h"
 #include <openssl/sha.h>
 
+/**
+  Digests the input data into an OpenSSL SHA-256 context, processing the
+  whole blocks with processor SHA-256 instructions when they are available.
+
+  @param[in, out]  Context   Pointer to the OpenSSL SHA-256 context.
+  @param[in]       Data      Pointer to the buffer containing the data to be hashed.
+  @param[in]       DataSize  Size of Data buffer in bytes.
+
+  @retval TRUE   SHA-256 data digest succeeded.
+  @retval FALSE  SHA-256 data digest failed.
+
+**/
+STATIC
+BOOLEAN
+Sha256UpdateContext (
+  IN OUT  SHA256_CTX  *Context,
+  IN      CONST UINT8 *Data,
+  IN      UINTN       DataSize
+  )
+{
+  UINTN  Length;
+  UINTN  BlockCount;
+
+  if (DataSize >= SHA256_CBLOCK) {
+    //
+    // Let OpenSSL complete the block buffered in the context first.
+    //
+    if (Context->num != 0) {
+      Length = SHA256_CBLOCK - Context->num;
+      if (SHA256_Update (Context, Data, Length) == 0) {
+        return FALSE;
+      }
+      Data     += Length;
+      DataSize -= Length;
+    }
+
+    BlockCount = DataSize / SHA256_CBLOCK;
+    if ((BlockCount != 0) && InternalSha256AccelTransform (Context->h, Data, BlockCount)) {
+      //
+      // Account for the processed bits the same way SHA256_Update() does.
+      //
+      Length = BlockCount * SHA256_CBLOCK;
+      if ((SHA_LONG) (Context->Nl + ((SHA_LONG) Length << 3)) < Context->Nl) {
+        Context->Nh++;
+      }
+      Context->Nl += (SHA_LONG) Length << 3;
+      Context->Nh += (SHA_LONG) RShiftU64 (Length, 29);
+      Data        += Length;
+      DataSize    -= Length;
+    }
+  }
+
+  return (BOOLEAN) (SHA256_Update (Context, Data, DataSize));
+}
+
 /**
   Retrieves the size, in bytes, of the context buffer required for SHA-256 hash operations.
 
@@ -133,7 +188,7 @@ Sha256Update (
   //
   // OpenSSL SHA-256 Hash Update
   //
-  return (BOOLEAN) (SHA256_Update ((SHA256_CTX *) Sha256Context, Data, DataSize));
+  return Sha256UpdateContext ((SHA256_CTX *) Sha256Context, Data, DataSize);
 }
 
 /**
@@ -202,6 +257,8 @@ Sha256HashAll (
   OUT  UINT8       *HashValue
   )
 {
+  SHA256_CTX  Context;
+
   //
   // Check input parameters.
   //
@@ -215,9 +272,11 @@ Sha256HashAll (
   //
   // OpenSSL SHA-256 Hash Computation.
   //
-  if (SHA256 (Data, DataSize, HashValue) == NULL) {
+  if ((SHA256_Init (&Context) == 0) ||
+      !Sha256UpdateContext (&Context, Data, DataSize) ||
+      (SHA256_Final (HashValue, &Context) == 0)) {
     return FALSE;
-  } else {
-    return TRUE;
   }
+
+  return TRUE;
 }
@@ -0,0 +1,30 @@
+/** @file
+  SHA-256 block transform with processor instructions - NULL instance for
+  architectures without a fast path.
+
+Copyright (c) 2021, EDK II contributors. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "InternalCryptLib.h"
+
+/**
+  Process whole SHA-256 blocks with processor instructions, if available.
+
+  @param[in, out]  State       The eight SHA-256 working variables.
+  @param[in]       Data        Pointer to the data blocks.
+  @param[in]       BlockCount  Number of 64-byte blocks in Data.
+
+  @retval FALSE  No processor instructions are used. State is unchanged.
+
+**/
+BOOLEAN
+InternalSha256AccelTransform (
+  IN OUT UINT32       *State,
+  IN     CONST UINT8  *Data,
+  IN     UINTN        BlockCount
+  )
+{
+  return FALSE;
+}
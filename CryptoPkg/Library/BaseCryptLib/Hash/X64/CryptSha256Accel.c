@@ -0,0 +1,78 @@
+/** @file
+  SHA-256 block transform using the Intel SHA extensions when the processor
+  supports them.
+
+Copyright (c) 2021, EDK II contributors. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "InternalCryptLib.h"
+#include <Register/Intel/Cpuid.h>
+
+/**
+  Process 64-byte blocks of data with the SHA-NI instructions.
+
+  @param[in, out]  State       The eight SHA-256 working variables.
+  @param[in]       Data        Pointer to the data blocks.
+  @param[in]       BlockCount  Number of 64-byte blocks in Data.
+
+**/
+VOID
+EFIAPI
+Sha256NiTransform (
+  IN OUT UINT32       *State,
+  IN     CONST UINT8  *Data,
+  IN     UINTN        BlockCount
+  );
+
+/**
+  Process whole SHA-256 blocks with processor instructions, if available.
+
+  The processor is checked on every call, so the result does not depend on
+  any writable global data and this works in PEI before memory is installed.
+
+  @param[in, out]  State       The eight SHA-256 working variables.
+  @param[in]       Data        Pointer to the data blocks.
+  @param[in]       BlockCount  Number of 64-byte blocks in Data.
+
+  @retval TRUE   The blocks are processed and State is updated.
+  @retval FALSE  The processor has no SHA-256 instructions. State is unchanged.
+
+**/
+BOOLEAN
+InternalSha256AccelTransform (
+  IN OUT UINT32       *State,
+  IN     CONST UINT8  *Data,
+  IN     UINTN        BlockCount
+  )
+{
+  UINT32                                       MaxLeaf;
+  CPUID_VERSION_INFO_ECX                       VersionInfoEcx;
+  CPUID_STRUCTURED_EXTENDED_FEATURE_FLAGS_EBX  ExtendedFeatureEbx;
+
+  AsmCpuid (CPUID_SIGNATURE, &MaxLeaf, NULL, NULL, NULL);
+  if (MaxLeaf < CPUID_STRUCTURED_EXTENDED_FEATURE_FLAGS) {
+    return FALSE;
+  }
+
+  AsmCpuid (CPUID_VERSION_INFO, NULL, NULL, &VersionInfoEcx.Uint32, NULL);
+  if ((VersionInfoEcx.Bits.SSSE3 == 0) || (VersionInfoEcx.Bits.SSE4_1 == 0)) {
+    return FALSE;
+  }
+
+  AsmCpuidEx (
+    CPUID_STRUCTURED_EXTENDED_FEATURE_FLAGS,
+    CPUID_STRUCTURED_EXTENDED_FEATURE_FLAGS_SUB_LEAF_INFO,
+    NULL,
+    &ExtendedFeatureEbx.Uint32,
+    NULL,
+    NULL
+    );
+  if (ExtendedFeatureEbx.Bits.SHA == 0) {
+    return FALSE;
+  }
+
+  Sha256NiTransform (State, Data, BlockCount);
+  return TRUE;
+}
@@ -59,4 +59,22 @@ WrapPkcs7Data (
   OUT UINTN        *WrapDataSize
   );
 
+/**
+  Process whole SHA-256 blocks with processor instructions, if available.
+
+  @param[in, out]  State       The eight SHA-256 working variables.
+  @param[in]       Data        Pointer to the data blocks.
+  @param[in]       BlockCount  Number of 64-byte blocks in Data.
+
+  @retval TRUE   The blocks are processed and State is updated.
+  @retval FALSE  No processor instructions are available. State is unchanged.
+
+**/
+BOOLEAN
+InternalSha256AccelTransform (
+  IN OUT UINT32       *State,
+  IN     CONST UINT8  *Data,
+  IN     UINTN        BlockCount
+  );
+
 #endif
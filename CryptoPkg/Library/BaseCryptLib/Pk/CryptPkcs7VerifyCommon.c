@@ -864,12 +864,16 @@ Pkcs7Verify (
   // For generic PKCS#7 handling, InData may be NULL if the content is present
   // in PKCS#7 structure. So ignore NULL checking here.
   //
-  DataBio = BIO_new (BIO_s_mem ());
-  if (DataBio == NULL) {
+  // Wrap InData in a read-only memory BIO rather than writing it into a new
+  // one, so that large payloads (such as authenticated variable data) are
+  // hashed in place instead of being copied first.
+  //
+  if (DataLength == 0) {
     goto _Exit;
   }
 
-  if (BIO_write (DataBio, InData, (int) DataLength) <= 0) {
+  DataBio = BIO_new_mem_buf (InData, (int) DataLength);
+  if (DataBio == NULL) {
     goto _Exit;
   }
 
@@ -13,6 +13,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #undef _WIN64
 
 #include <Library/BaseCryptLib.h>
+#include <Library/BaseLib.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/DebugLib.h>
 #include <Library/MemoryAllocationLib.h>
@@ -37,5 +38,39 @@ typedef struct {
   BIO                             *OutBio;
 } TLS_CONNECTION;
 
+//
+// Number of TLS sessions kept for resumption, and the maximum length of the
+// host name they are filed under.
+//
+#define TLS_SESSION_CACHE_SIZE      8
+#define TLS_SESSION_CACHE_KEY_SIZE  256
+
+typedef struct {
+  //
+  // Host name or IP address literal the session was verified against.
+  //
+  CHAR8                           Key[TLS_SESSION_CACHE_KEY_SIZE];
+  //
+  // Resumable session (session ID or ticket), one reference held.
+  //
+  SSL_SESSION                     *Session;
+  //
+  // Last time the entry was stored or looked up, for replacement.
+  //
+  UINTN                           Stamp;
+} TLS_SESSION_CACHE_ENTRY;
+
+/**
+  Look up the session cache for the host the TLS connection was set to
+  verify, and offer the cached session to the server if one is found.
+
+  @param[in]  Ssl         Pointer to the SSL object, not yet connected.
+
+**/
+VOID
+TlsSessionCacheResume (
+  IN     SSL                      *Ssl
+  );
+
 #endif
 
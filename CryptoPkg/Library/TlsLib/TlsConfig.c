@@ -550,7 +550,16 @@ TlsSetVerifyHost (
     ParamStatus = X509_VERIFY_PARAM_set1_host (VerifyParam, HostName, 0);
   }
 
-  return (ParamStatus == 1) ? EFI_SUCCESS : EFI_ABORTED;
+  if (ParamStatus != 1) {
+    return EFI_ABORTED;
+  }
+
+  //
+  // Now the peer is known, try to resume an earlier session with it.
+  //
+  TlsSessionCacheResume (TlsConn->Ssl);
+
+  return EFI_SUCCESS;
 }
 
 /**
@@ -9,6 +9,183 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #include "InternalTlsLib.h"
 
+//
+// Sessions of earlier connections, shared by all the TLS objects so that
+// another connection to the same host can skip the full handshake.
+//
+STATIC TLS_SESSION_CACHE_ENTRY  mTlsSessionCache[TLS_SESSION_CACHE_SIZE];
+STATIC UINTN                    mTlsSessionCacheStamp;
+
+/**
+  Build the session cache key of a TLS connection from the host name or IP
+  address it is set to verify.
+
+  @param[in]   Ssl        Pointer to the SSL object.
+  @param[out]  Key        Buffer of TLS_SESSION_CACHE_KEY_SIZE bytes to
+                          receive the key.
+
+  @retval  TRUE           The key was built.
+  @retval  FALSE          No host is set, or its name is too long.
+
+**/
+STATIC
+BOOLEAN
+TlsSessionCacheGetKey (
+  IN     SSL                      *Ssl,
+     OUT CHAR8                    *Key
+  )
+{
+  X509_VERIFY_PARAM  *VerifyParam;
+  CONST CHAR8        *HostName;
+  CHAR8              *IpAddress;
+  RETURN_STATUS      Status;
+
+  VerifyParam = SSL_get0_param (Ssl);
+  if (VerifyParam == NULL) {
+    return FALSE;
+  }
+
+  HostName = X509_VERIFY_PARAM_get0_host (VerifyParam, 0);
+  if (HostName != NULL) {
+    Status = AsciiStrCpyS (Key, TLS_SESSION_CACHE_KEY_SIZE, HostName);
+    return (BOOLEAN) !RETURN_ERROR (Status);
+  }
+
+  IpAddress = X509_VERIFY_PARAM_get1_ip_asc (VerifyParam);
+  if (IpAddress == NULL) {
+    return FALSE;
+  }
+
+  Status = AsciiStrCpyS (Key, TLS_SESSION_CACHE_KEY_SIZE, IpAddress);
+  OPENSSL_free (IpAddress);
+
+  return (BOOLEAN) !RETURN_ERROR (Status);
+}
+
+/**
+  OpenSSL callback invoked when the server hands out a new session, either
+  at the end of a full handshake or through a session ticket.
+
+  Only sessions whose server certificate was verified are cached, so that
+  the resumption, which skips the certificate check, cannot bypass it.
+
+  @param[in]  Ssl         Pointer to the SSL object.
+  @param[in]  Session     The new session.
+
+  @retval  1              The cache keeps the reference on Session.
+  @retval  0              Session was not cached.
+
+**/
+STATIC
+int
+TlsSessionCacheNewSession (
+  IN     SSL                      *Ssl,
+  IN     SSL_SESSION              *Session
+  )
+{
+  TLS_SESSION_CACHE_ENTRY  *Entry;
+  CHAR8                    Key[TLS_SESSION_CACHE_KEY_SIZE];
+  UINTN                    Index;
+
+  if (((SSL_get_verify_mode (Ssl) & SSL_VERIFY_PEER) == 0) ||
+      (SSL_get_verify_result (Ssl) != X509_V_OK) ||
+      !TlsSessionCacheGetKey (Ssl, Key)) {
+    return 0;
+  }
+
+  //
+  // A newer session for the host replaces the older one; otherwise take a
+  // free entry, or the one unused for the longest time.
+  //
+  Entry = &mTlsSessionCache[0];
+  for (Index = 0; Index < TLS_SESSION_CACHE_SIZE; Index++) {
+    if ((mTlsSessionCache[Index].Session != NULL) &&
+        (AsciiStrCmp (mTlsSessionCache[Index].Key, Key) == 0)) {
+      Entry = &mTlsSessionCache[Index];
+      break;
+    }
+
+    if ((Entry->Session != NULL) &&
+        ((mTlsSessionCache[Index].Session == NULL) ||
+         (mTlsSessionCache[Index].Stamp < Entry->Stamp))) {
+      Entry = &mTlsSessionCache[Index];
+    }
+  }
+
+  if (Entry->Session != NULL) {
+    SSL_SESSION_free (Entry->Session);
+  }
+
+  CopyMem (Entry->Key, Key, sizeof (Key));
+  Entry->Session = Session;
+  Entry->Stamp   = ++mTlsSessionCacheStamp;
+
+  return 1;
+}
+
+/**
+  Look up the session cache for the host the TLS connection was set to
+  verify, and offer the cached session to the server if one is found.
+
+  @param[in]  Ssl         Pointer to the SSL object, not yet connected.
+
+**/
+VOID
+TlsSessionCacheResume (
+  IN     SSL                      *Ssl
+  )
+{
+  CHAR8                    Key[TLS_SESSION_CACHE_KEY_SIZE];
+  UINTN                    Index;
+
+  if (!TlsSessionCacheGetKey (Ssl, Key)) {
+    return;
+  }
+
+  for (Index = 0; Index < TLS_SESSION_CACHE_SIZE; Index++) {
+    if ((mTlsSessionCache[Index].Session == NULL) ||
+        (AsciiStrCmp (mTlsSessionCache[Index].Key, Key) != 0)) {
+      continue;
+    }
+
+    if (!SSL_SESSION_is_resumable (mTlsSessionCache[Index].Session)) {
+      SSL_SESSION_free (mTlsSessionCache[Index].Session);
+      mTlsSessionCache[Index].Session = NULL;
+      return;
+    }
+
+    //
+    // If the server declines the session, the handshake just falls back to
+    // a full one.
+    //
+    if (SSL_set_session (Ssl, mTlsSessionCache[Index].Session) == 1) {
+      mTlsSessionCache[Index].Stamp = ++mTlsSessionCacheStamp;
+    }
+
+    return;
+  }
+}
+
+/**
+  Release all the cached TLS sessions.
+
+**/
+STATIC
+VOID
+TlsSessionCacheFlush (
+  VOID
+  )
+{
+  UINTN                    Index;
+
+  for (Index = 0; Index < TLS_SESSION_CACHE_SIZE; Index++) {
+    if (mTlsSessionCache[Index].Session != NULL) {
+      SSL_SESSION_free (mTlsSessionCache[Index].Session);
+      mTlsSessionCache[Index].Session = NULL;
+    }
+  }
+}
+
 /**
   Initializes the OpenSSL library.
 
@@ -63,6 +240,7 @@ TlsCtxFree (
   }
 
   if (TlsCtx != NULL) {
+    TlsSessionCacheFlush ();
     SSL_CTX_free ((SSL_CTX *) (TlsCtx));
   }
 }
@@ -106,6 +284,13 @@ TlsCtxNew (
   //
   SSL_CTX_set_min_proto_version (TlsCtx, ProtoVersion);
 
+  //
+  // Hand every new client session to the TLS session cache, which lets a
+  // later connection to the same host resume it by session ID or ticket.
+  //
+  SSL_CTX_set_session_cache_mode (TlsCtx, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+  SSL_CTX_sess_set_new_cb (TlsCtx, TlsSessionCacheNewSession);
+
   return (VOID *) TlsCtx;
 }
 
@@ -141,6 +141,72 @@ error_handler:
   return ContinueEnum;
 }
 
+/** Serialize a tree whose size is known to a buffer.
+
+  The ACPI DSDT/SSDT header is serialized from the root node, then the
+  AML blob is serialized from the rest of the tree, in a single walk.
+
+  @param  [in]  RootNode    Pointer to a root node.
+  @param  [in]  Buffer      Buffer to write the DSDT/SSDT table to.
+  @param  [in]  TableSize   Size needed to serialize the DSDT/SSDT table,
+                            as validated by AmlSerializeTree ().
+                            Buffer must be at least this size.
+
+  @retval EFI_SUCCESS             The function completed successfully.
+  @retval EFI_INVALID_PARAMETER   Invalid parameter.
+  @retval EFI_BUFFER_TOO_SMALL    No space left in the buffer.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+AmlSerializeTreeToBuffer (
+  IN      AML_ROOT_NODE   * RootNode,
+  IN      UINT8           * Buffer,
+  IN      UINT32            TableSize
+  )
+{
+  EFI_STATUS    Status;
+  AML_STREAM    FStream;
+
+  // Initialize the stream to the TableSize that is needed.
+  Status = AmlStreamInit (
+             &FStream,
+             Buffer,
+             TableSize,
+             EAmlStreamDirectionForward
+             );
+  if (EFI_ERROR (Status)) {
+    ASSERT (0);
+    return Status;
+  }
+
+  // Serialize the header.
+  Status = AmlStreamWrite (
+             &FStream,
+             (UINT8*)RootNode->SdtHeader,
+             sizeof (EFI_ACPI_DESCRIPTION_HEADER)
+             );
+  if (EFI_ERROR (Status)) {
+    ASSERT (0);
+    return Status;
+  }
+
+  Status = EFI_SUCCESS;
+  AmlEnumTree (
+    (AML_NODE_HEADER*)RootNode,
+    AmlSerializeNodeCallback,
+    (VOID*)&FStream,
+    &Status
+    );
+  if (EFI_ERROR (Status)) {
+    ASSERT (0);
+    return Status;
+  }
+
+  // Update the checksum.
+  return AcpiPlatformChecksum ((EFI_ACPI_DESCRIPTION_HEADER*)Buffer);
+}
+
 /** Serialize a tree to create an ACPI DSDT/SSDT table.
 
   If:
@@ -175,7 +241,6 @@ AmlSerializeTree (
   )
 {
   EFI_STATUS    Status;
-  AML_STREAM    FStream;
   UINT32        TableSize;
 
   if (!IS_AML_ROOT_NODE (RootNode) ||
@@ -206,48 +271,12 @@ AmlSerializeTree (
   }
 
   // Buffer is not big enough, or NULL.
-  if ((TableSize < *BufferSize) || (Buffer == NULL)) {
+  if ((*BufferSize < TableSize) || (Buffer == NULL)) {
     *BufferSize = TableSize;
     return EFI_SUCCESS;
   }
 
-  // Initialize the stream to the TableSize that is needed.
-  Status = AmlStreamInit (
-             &FStream,
-             Buffer,
-             TableSize,
-             EAmlStreamDirectionForward
-             );
-  if (EFI_ERROR (Status)) {
-    ASSERT (0);
-    return Status;
-  }
-
-  // Serialize the header.
-  Status = AmlStreamWrite (
-             &FStream,
-             (UINT8*)RootNode->SdtHeader,
-             sizeof (EFI_ACPI_DESCRIPTION_HEADER)
-             );
-  if (EFI_ERROR (Status)) {
-    ASSERT (0);
-    return Status;
-  }
-
-  Status = EFI_SUCCESS;
-  AmlEnumTree (
-    (AML_NODE_HEADER*)RootNode,
-    AmlSerializeNodeCallback,
-    (VOID*)&FStream,
-    &Status
-    );
-  if (EFI_ERROR (Status)) {
-    ASSERT (0);
-    return Status;
-  }
-
-  // Update the checksum.
-  return AcpiPlatformChecksum ((EFI_ACPI_DESCRIPTION_HEADER*)Buffer);
+  return AmlSerializeTreeToBuffer (RootNode, Buffer, TableSize);
 }
 
 /** Serialize an AML definition block.
@@ -306,11 +335,13 @@ AmlSerializeDefinitionBlock (
     return EFI_OUT_OF_RESOURCES;
   }
 
-  // Serialize the tree to a SSDT table.
-  Status = AmlSerializeTree (
+  // Serialize the tree to a SSDT table. The size has just been computed
+  // and checked against the SDT header, so do not walk the tree again
+  // to compute it.
+  Status = AmlSerializeTreeToBuffer (
              RootNode,
              TableBuffer,
-             &TableSize
+             TableSize
              );
   if (EFI_ERROR (Status)) {
     FreePool (TableBuffer);
@@ -295,6 +295,35 @@ AmlDetachNode (
   return AmlRemoveNodeFromVarArgList (Node);
 }
 
+/** Attach a detached Node to the tail of the variable list of
+    arguments of the ParentNode.
+
+  This is the counterpart of AmlDetachNode (). Together with
+  AmlCloneTree (), it allows to build many similar objects from a
+  template: parse the template once, then for each instance clone the
+  object, update its fields (e.g. with AmlDeviceOpUpdateName () and
+  AmlNameOpUpdateInteger ()) and attach the clone. This avoids
+  re-generating each object node by node.
+
+  @param  [in]  ParentNode  Pointer to the parent node.
+                            Must be a root or an object node.
+  @param  [in]  NewNode     Pointer to the node to attach.
+                            Must be a data node or an object node,
+                            and must not be attached to a tree.
+
+  @retval EFI_SUCCESS             The function completed successfully.
+  @retval EFI_INVALID_PARAMETER   Invalid parameter.
+**/
+EFI_STATUS
+EFIAPI
+AmlAttachNode (
+  IN  AML_NODE_HEADER   * ParentNode,
+  IN  AML_NODE_HEADER   * NewNode
+  )
+{
+  return AmlVarListAddTail (ParentNode, NewNode);
+}
+
 /** Add the NewNode to the head of the variable list of arguments
     of the ParentNode.
 
@@ -80,6 +80,7 @@ typedef struct {
   VOID                        *Parameter;
   VOID                        *StateLock;
   VOID                        *ProcedureLock;
+  VOID                        *ProcedureCond;
   PROCESSOR_STATE             State;
   EFI_EVENT                   CheckThisAPEvent;
 } PROCESSOR_DATA_BLOCK;
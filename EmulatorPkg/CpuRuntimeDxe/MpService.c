@@ -72,6 +72,7 @@ SetApProcedure (
   gThread->MutexLock (Processor->ProcedureLock);
   Processor->Parameter  = ProcedureArgument;
   Processor->Procedure  = Procedure;
+  gThread->CondSignal (Processor->ProcedureCond);
   gThread->MutexUnlock (Processor->ProcedureLock);
 }
 
@@ -1214,6 +1215,7 @@ FillInProcessorInformation (
   gMPSystem.ProcessorData[ProcessorNumber].Parameter        = NULL;
   gMPSystem.ProcessorData[ProcessorNumber].StateLock        = gThread->MutexInit ();
   gMPSystem.ProcessorData[ProcessorNumber].ProcedureLock    = gThread->MutexInit ();
+  gMPSystem.ProcessorData[ProcessorNumber].ProcedureCond    = gThread->CondInit ();
 
   return EFI_SUCCESS;
 }
@@ -1236,9 +1238,13 @@ CpuDriverApIdolLoop (
 
   while (TRUE) {
     //
-    // Make a local copy on the stack to be extra safe
+    // Sleep on the host until SetApProcedure() hands us work, then make a
+    // local copy on the stack to be extra safe
     //
     gThread->MutexLock (ProcessorData->ProcedureLock);
+    while (ProcessorData->Procedure == NULL) {
+      gThread->CondWait (ProcessorData->ProcedureCond, ProcessorData->ProcedureLock);
+    }
     Procedure = ProcessorData->Procedure;
     Parameter = ProcessorData->Parameter;
     gThread->MutexUnlock (ProcessorData->ProcedureLock);
@@ -1258,10 +1264,6 @@ CpuDriverApIdolLoop (
       ProcessorData->State = CPU_STATE_FINISHED;
       gThread->MutexUnlock (ProcessorData->StateLock);
     }
-
-    // Poll 5 times a seconds, 200ms
-    // Don't want to burn too many system resources doing nothing.
-    gEmuThunk->Sleep (200 * 1000);
   }
 
   return 0;
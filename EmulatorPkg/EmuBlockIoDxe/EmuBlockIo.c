@@ -8,6 +8,53 @@ bbe
 #include "EmuBlockIo.h"
 
 
+/**
+  Signal the events of the non-blocking requests completed by the host.
+
+  @param[in]  Event    The poll timer event.
+  @param[in]  Context  The EMU_BLOCK_IO_PRIVATE of the device.
+
+**/
+VOID
+EFIAPI
+EmuBlockIoPollNotify (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  EMU_BLOCK_IO_PRIVATE    *Private;
+  EFI_BLOCK_IO2_TOKEN     *Token;
+
+  Private = Context;
+
+  while (!EFI_ERROR (Private->Io->Poll (Private->Io, &Token))) {
+    gBS->SignalEvent (Token->Event);
+  }
+}
+
+
+/**
+  Signal the event of a non-blocking request that the host completed before
+  returning, when the host does not report completions through Poll().
+
+  @param[in]  Private  The device.
+  @param[in]  Token    The token of the request.
+  @param[in]  Status   The status returned by the host.
+
+**/
+VOID
+EmuBlockIo2Complete (
+  IN EMU_BLOCK_IO_PRIVATE     *Private,
+  IN EFI_BLOCK_IO2_TOKEN      *Token,
+  IN EFI_STATUS               Status
+  )
+{
+  if (!EFI_ERROR (Status) && (Token != NULL) && (Token->Event != NULL) && (Private->Io->Poll == NULL)) {
+    gBS->SignalEvent (Token->Event);
+  }
+}
+
+
 /**
   Reset the block device hardware.
 
@@ -95,6 +142,7 @@ EmuBlockIo2ReadBlocksEx (
   OldTpl = gBS->RaiseTPL (TPL_CALLBACK);
 
   Status = Private->Io->ReadBlocks (Private->Io, MediaId, LBA, Token, BufferSize, Buffer);
+  EmuBlockIo2Complete (Private, Token, Status);
 
   gBS->RestoreTPL (OldTpl);
   return Status;
@@ -152,6 +200,7 @@ EmuBlockIo2WriteBlocksEx (
   OldTpl = gBS->RaiseTPL (TPL_CALLBACK);
 
   Status = Private->Io->WriteBlocks (Private->Io, MediaId, LBA, Token, BufferSize, Buffer);
+  EmuBlockIo2Complete (Private, Token, Status);
 
   gBS->RestoreTPL (OldTpl);
   return Status;
@@ -197,6 +246,7 @@ EmuBlockIo2Flush (
   OldTpl = gBS->RaiseTPL (TPL_CALLBACK);
 
   Status = Private->Io->FlushBlocks (Private->Io, Token);
+  EmuBlockIo2Complete (Private, Token, Status);
 
   gBS->RestoreTPL (OldTpl);
   return Status;
@@ -549,12 +599,31 @@ EmuBlockIoDriverBindingStart (
   Private->BlockIo2.FlushBlocksEx = EmuBlockIo2Flush;
 
   Private->ControllerNameTable = NULL;
+  Private->PollEvent           = NULL;
 
   Status = Private->Io->CreateMapping (Private->Io, &Private->Media);
   if (EFI_ERROR (Status)) {
     goto Done;
   }
 
+  if (Private->Io->Poll != NULL) {
+    Status = gBS->CreateEvent (
+                    EVT_TIMER | EVT_NOTIFY_SIGNAL,
+                    TPL_CALLBACK,
+                    EmuBlockIoPollNotify,
+                    Private,
+                    &Private->PollEvent
+                    );
+    if (EFI_ERROR (Status)) {
+      goto Done;
+    }
+
+    Status = gBS->SetTimer (Private->PollEvent, TimerPeriodic, EMU_BLOCK_IO_POLL_INTERVAL);
+    if (EFI_ERROR (Status)) {
+      goto Done;
+    }
+  }
+
   AddUnicodeString2 (
     "eng",
     gEmuBlockIoComponentName.SupportedLanguages,
@@ -585,6 +654,10 @@ Done:
         FreeUnicodeStringTable (Private->ControllerNameTable);
       }
 
+      if (Private->PollEvent != NULL) {
+        gBS->CloseEvent (Private->PollEvent);
+      }
+
       gBS->FreePool (Private);
 
     }
@@ -664,6 +737,15 @@ EmuBlockIoDriverBindingStop (
                   NULL
                   );
   if (!EFI_ERROR (Status)) {
+    if (Private->PollEvent != NULL) {
+      //
+      // Wait for the requests in progress and signal their events.
+      //
+      Private->Io->FlushBlocks (Private->Io, NULL);
+      EmuBlockIoPollNotify (Private->PollEvent, Private);
+      gBS->CloseEvent (Private->PollEvent);
+    }
+
     Status = gBS->CloseProtocol (
                     Handle,
                     &gEmuIoThunkProtocolGuid,
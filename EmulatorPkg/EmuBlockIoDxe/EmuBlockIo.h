@@ -56,8 +56,19 @@ typedef struct {
 
   EFI_UNICODE_STRING_TABLE    *ControllerNameTable;
 
+  //
+  // Periodic timer collecting the non-blocking requests completed by the
+  // host, NULL if the host completes requests before returning.
+  //
+  EFI_EVENT                   PollEvent;
+
 } EMU_BLOCK_IO_PRIVATE;
 
+//
+// Interval of the poll timer, in 100 ns units.
+//
+#define EMU_BLOCK_IO_POLL_INTERVAL  10000
+
 #define EMU_BLOCK_IO_PRIVATE_DATA_FROM_THIS(a) \
          CR(a, EMU_BLOCK_IO_PRIVATE, BlockIo, EMU_BLOCK_IO_PRIVATE_SIGNATURE)
 
@@ -166,6 +166,28 @@ EFI_STATUS
   IN     EFI_BLOCK_IO_MEDIA       *Media
   );
 
+/**
+  Return a non-blocking request that has completed.
+
+  The host cannot signal EFI events, so every request with a Token->Event that
+  was accepted by ReadBlocks, WriteBlocks or FlushBlocks is returned once by
+  this function after it completes, with its TransactionStatus filled in. The
+  caller then signals Token->Event.
+
+  @param[in]   This     Indicates a pointer to the calling context.
+  @param[out]  Token    The token of the completed request.
+
+  @retval EFI_SUCCESS    A completed request was returned in Token.
+  @retval EFI_NOT_READY  No request has completed since the last call.
+
+**/
+typedef
+EFI_STATUS
+(EFIAPI *EMU_BLOCK_POLL) (
+  IN     EMU_BLOCK_IO_PROTOCOL    *This,
+     OUT EFI_BLOCK_IO2_TOKEN      **Token
+  );
+
 
 ///
 ///  The Block I/O2 protocol defines an extension to the Block I/O protocol which
@@ -178,6 +200,11 @@ struct _EMU_BLOCK_IO_PROTOCOL  {
   EMU_BLOCK_WRITE           WriteBlocks;
   EMU_BLOCK_FLUSH           FlushBlocks;
   EMU_BLOCK_CREATE_MAPPING  CreateMapping;
+  ///
+  /// NULL if the host completes every request before returning; the caller
+  /// then signals Token->Event itself.
+  ///
+  EMU_BLOCK_POLL            Poll;
 };
 
 extern EFI_GUID gEmuBlockIoProtocolGuid;
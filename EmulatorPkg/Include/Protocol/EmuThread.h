@@ -80,6 +80,39 @@ UINTN
   );
 
 
+typedef
+VOID *
+(EFIAPI *THREAD_THUNK_COND_INIT) (
+  IN VOID
+  );
+
+
+typedef
+UINTN
+(EFIAPI *THREAD_THUNK_COND_DESTROY) (
+  IN VOID *Cond
+  );
+
+
+//
+// Mutex must be held by the caller. It is released while waiting and
+// held again on return.
+//
+typedef
+UINTN
+(EFIAPI *THREAD_THUNK_COND_WAIT) (
+  IN VOID *Cond,
+  IN VOID *Mutex
+  );
+
+
+typedef
+UINTN
+(EFIAPI *THREAD_THUNK_COND_SIGNAL) (
+  IN VOID *Cond
+  );
+
+
 struct _EMU_THREAD_THUNK_PROTOCOL {
   THREAD_THUNK_MUTEX_LOCK       MutexLock;
   THREAD_THUNK_MUTEX_UNLOCK     MutexUnlock;
@@ -89,6 +122,10 @@ struct _EMU_THREAD_THUNK_PROTOCOL {
   THREAD_THUNK_CREATE_THREAD    CreateThread;
   THREAD_THUNK_EXIT_THREAD      ExitThread;
   THREAD_THUNK_SELF             Self;
+  THREAD_THUNK_COND_INIT        CondInit;
+  THREAD_THUNK_COND_DESTROY     CondDestroy;
+  THREAD_THUNK_COND_WAIT        CondWait;
+  THREAD_THUNK_COND_SIGNAL      CondSignal;
 };
 
 extern EFI_GUID gEmuThreadThunkProtocolGuid;
@@ -5,8 +5,28 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 **/
 
+#ifndef __APPLE__
+//
+// For O_DIRECT.
+//
+#define _GNU_SOURCE
+#endif
+
 #include "Host.h"
 
+//
+// A non-blocking request, from the time it is queued until Poll() returns it.
+//
+typedef struct _EMU_BLOCK_IO_REQUEST EMU_BLOCK_IO_REQUEST;
+struct _EMU_BLOCK_IO_REQUEST {
+  EMU_BLOCK_IO_REQUEST        *Next;
+  EFI_BLOCK_IO2_TOKEN         *Token;
+  struct aiocb                Aiocb;
+  BOOLEAN                     Write;
+  BOOLEAN                     Done;
+  EFI_STATUS                  Status;
+};
+
 #define EMU_BLOCK_IO_PRIVATE_SIGNATURE SIGNATURE_32 ('E', 'M', 'b', 'k')
 typedef struct {
   UINTN                       Signature;
@@ -21,6 +41,7 @@ typedef struct {
 
   BOOLEAN                     RemovableMedia;
   BOOLEAN                     WriteProtected;
+  BOOLEAN                     DirectIo;
 
   UINT64                      NumberOfBlocks;
   UINT32                      BlockSize;
@@ -28,6 +49,8 @@ typedef struct {
   EMU_BLOCK_IO_PROTOCOL       EmuBlockIo;
   EFI_BLOCK_IO_MEDIA          *Media;
 
+  EMU_BLOCK_IO_REQUEST        *Requests;
+
 } EMU_BLOCK_IO_PRIVATE;
 
 #define EMU_BLOCK_IO_PRIVATE_DATA_FROM_THIS(a) \
@@ -101,6 +124,12 @@ EmuBlockIoOpenDevice (
     goto Done;
   }
 
+#if __APPLE__
+  if (Private->DirectIo) {
+    fcntl (Private->fd, F_NOCACHE, 1);
+  }
+#endif
+
   if (!Private->Media->MediaPresent) {
     //
     // BugBug: try to emulate if a CD appears - notify drivers to check it out
@@ -166,6 +195,13 @@ EmuBlockIoOpenDevice (
     }
   }
 
+  //
+  // Direct I/O bypasses the host page cache and needs block aligned buffers.
+  //
+  if (Private->DirectIo) {
+    Private->Media->IoAlign = Private->Media->BlockSize;
+  }
+
   DEBUG ((EFI_D_INIT, "%HEmuOpenBlock: opened %a%N\n", Private->Filename));
   Status = EFI_SUCCESS;
 
@@ -271,8 +307,6 @@ EmuBlockIoReadWriteCommon (
   EFI_STATUS  Status;
   UINTN       BlockSize;
   UINT64      LastBlock;
-  INT64       DistanceToMove;
-  UINT64      DistanceMoved;
 
   if (Private->fd < 0) {
     Status = EmuBlockIoOpenDevice (Private);
@@ -313,21 +347,174 @@ EmuBlockIoReadWriteCommon (
     DEBUG ((EFI_D_INIT, "ReadBlocks: Attempted to read off end of device\n"));
     return EFI_INVALID_PARAMETER;
   }
-  //
-  // Seek to End of File
-  //
-  DistanceToMove = MultU64x32 (Lba, BlockSize);
-  Status = SetFilePointer64 (Private, DistanceToMove, &DistanceMoved, SEEK_SET);
 
-  if (EFI_ERROR (Status)) {
-    DEBUG ((EFI_D_INIT, "WriteBlocks: SetFilePointer failed\n"));
-    return EmuBlockIoError (Private);
+  return EFI_SUCCESS;
+}
+
+
+/**
+  Append a request to the list of requests returned by EmuBlockIoPoll().
+
+  @param[in]  Private   The block device.
+  @param[in]  Request   The request to append.
+
+**/
+VOID
+EmuBlockIoAppendRequest (
+  IN  EMU_BLOCK_IO_PRIVATE        *Private,
+  IN  EMU_BLOCK_IO_REQUEST        *Request
+  )
+{
+  EMU_BLOCK_IO_REQUEST  **Link;
+
+  for (Link = &Private->Requests; *Link != NULL; Link = &(*Link)->Next) {
+  }
+
+  Request->Next = NULL;
+  *Link         = Request;
+}
+
+
+/**
+  Start a non-blocking read or write with POSIX AIO.
+
+  If the host cannot queue one more request, the transfer is done at once and
+  only its completion is reported through EmuBlockIoPoll().
+
+  @param[in]  Private     The block device.
+  @param[in]  Token       The token of the request.
+  @param[in]  Offset      The offset of the transfer on the device.
+  @param[in]  BufferSize  The size of the transfer.
+  @param[in]  Buffer      The buffer of the transfer.
+  @param[in]  Write       TRUE for a write, FALSE for a read.
+
+  @retval EFI_SUCCESS           The request was queued.
+  @retval EFI_OUT_OF_RESOURCES  The request could not be allocated.
+  @retval others                The request could not be started.
+
+**/
+EFI_STATUS
+EmuBlockIoQueueRequest (
+  IN  EMU_BLOCK_IO_PRIVATE        *Private,
+  IN  EFI_BLOCK_IO2_TOKEN         *Token,
+  IN  UINT64                      Offset,
+  IN  UINTN                       BufferSize,
+  IN  VOID                        *Buffer,
+  IN  BOOLEAN                     Write
+  )
+{
+  EMU_BLOCK_IO_REQUEST  *Request;
+  ssize_t               len;
+  int                   Result;
+
+  Request = calloc (1, sizeof (EMU_BLOCK_IO_REQUEST));
+  if (Request == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Request->Token                          = Token;
+  Request->Write                          = Write;
+  Request->Aiocb.aio_fildes               = Private->fd;
+  Request->Aiocb.aio_offset               = Offset;
+  Request->Aiocb.aio_buf                  = Buffer;
+  Request->Aiocb.aio_nbytes               = BufferSize;
+  Request->Aiocb.aio_sigevent.sigev_notify = SIGEV_NONE;
+
+  Result = Write ? aio_write (&Request->Aiocb) : aio_read (&Request->Aiocb);
+  if (Result != 0) {
+    if ((errno != EAGAIN) && (errno != ENOSYS)) {
+      free (Request);
+      return EmuBlockIoError (Private);
+    }
+
+    if (Write) {
+      len = pwrite (Private->fd, Buffer, BufferSize, Offset);
+    } else {
+      len = pread (Private->fd, Buffer, BufferSize, Offset);
+    }
+
+    Request->Done   = TRUE;
+    Request->Status = (len == BufferSize) ? EFI_SUCCESS : EmuBlockIoError (Private);
   }
 
+  EmuBlockIoAppendRequest (Private, Request);
   return EFI_SUCCESS;
 }
 
 
+/**
+  Collect the result of a non-blocking request.
+
+  @param[in]  Private   The block device.
+  @param[in]  Request   The request.
+  @param[in]  Wait      TRUE to wait for the request to complete.
+
+  @retval TRUE   The request is complete and Request->Status is valid.
+  @retval FALSE  The request is still in progress.
+
+**/
+BOOLEAN
+EmuBlockIoCompleteRequest (
+  IN  EMU_BLOCK_IO_PRIVATE        *Private,
+  IN  EMU_BLOCK_IO_REQUEST        *Request,
+  IN  BOOLEAN                     Wait
+  )
+{
+  const struct aiocb  *List[1];
+  ssize_t             len;
+  int                 Error;
+
+  if (Request->Done) {
+    return TRUE;
+  }
+
+  List[0] = &Request->Aiocb;
+  for (Error = aio_error (&Request->Aiocb); Error == EINPROGRESS; Error = aio_error (&Request->Aiocb)) {
+    if (!Wait) {
+      return FALSE;
+    }
+    aio_suspend (List, 1, NULL);
+  }
+
+  len           = aio_return (&Request->Aiocb);
+  Request->Done = TRUE;
+
+  if ((Error == 0) && (len == Request->Aiocb.aio_nbytes)) {
+    Private->Media->MediaPresent = TRUE;
+    if (Request->Write) {
+      Private->Media->ReadOnly = FALSE;
+    }
+    Request->Status = EFI_SUCCESS;
+  } else if (Error == ECANCELED) {
+    Request->Status = EFI_ABORTED;
+  } else {
+    errno           = (Error != 0) ? Error : EIO;
+    Request->Status = EmuBlockIoError (Private);
+  }
+
+  return TRUE;
+}
+
+
+/**
+  Wait for all the non-blocking requests in progress to complete.
+
+  @param[in]  Private   The block device.
+
+**/
+VOID
+EmuBlockIoWaitRequests (
+  IN  EMU_BLOCK_IO_PRIVATE        *Private
+  )
+{
+  EMU_BLOCK_IO_REQUEST  *Request;
+
+  for (Request = Private->Requests; Request != NULL; Request = Request->Next) {
+    EmuBlockIoCompleteRequest (Private, Request, TRUE);
+  }
+}
+
+
 /**
   Read BufferSize bytes from Lba into Buffer.
 
@@ -374,36 +561,32 @@ EmuBlockIoReadBlocks (
   EFI_STATUS              Status;
   EMU_BLOCK_IO_PRIVATE    *Private;
   ssize_t                 len;
+  UINT64                  Offset;
 
   Private = EMU_BLOCK_IO_PRIVATE_DATA_FROM_THIS (This);
 
   Status  = EmuBlockIoReadWriteCommon (Private, MediaId, LBA, BufferSize, Buffer, "UnixReadBlocks");
   if (EFI_ERROR (Status)) {
-    goto Done;
+    return Status;
   }
 
-  len = read (Private->fd, Buffer, BufferSize);
+  Offset = MultU64x32 (LBA, Private->Media->BlockSize);
+
+  if ((Token != NULL) && (Token->Event != NULL)) {
+    return EmuBlockIoQueueRequest (Private, Token, Offset, BufferSize, Buffer, FALSE);
+  }
+
+  len = pread (Private->fd, Buffer, BufferSize, Offset);
   if (len != BufferSize) {
     DEBUG ((EFI_D_INIT, "ReadBlocks: ReadFile failed.\n"));
-    Status = EmuBlockIoError (Private);
-    goto Done;
+    return EmuBlockIoError (Private);
   }
 
   //
   // If we read then media is present.
   //
   Private->Media->MediaPresent = TRUE;
-  Status = EFI_SUCCESS;
-
-Done:
-  if (Token != NULL) {
-    if (Token->Event != NULL) {
-      // Caller is responsible for signaling EFI Event
-      Token->TransactionStatus = Status;
-      return EFI_SUCCESS;
-    }
-  }
-  return Status;
+  return EFI_SUCCESS;
 }
 
 
@@ -451,20 +634,26 @@ EmuBlockIoWriteBlocks (
   EMU_BLOCK_IO_PRIVATE    *Private;
   ssize_t                 len;
   EFI_STATUS              Status;
+  UINT64                  Offset;
 
 
   Private = EMU_BLOCK_IO_PRIVATE_DATA_FROM_THIS (This);
 
   Status  = EmuBlockIoReadWriteCommon (Private, MediaId, LBA, BufferSize, Buffer, "UnixWriteBlocks");
   if (EFI_ERROR (Status)) {
-    goto Done;
+    return Status;
   }
 
-  len = write (Private->fd, Buffer, BufferSize);
+  Offset = MultU64x32 (LBA, Private->Media->BlockSize);
+
+  if ((Token != NULL) && (Token->Event != NULL)) {
+    return EmuBlockIoQueueRequest (Private, Token, Offset, BufferSize, Buffer, TRUE);
+  }
+
+  len = pwrite (Private->fd, Buffer, BufferSize, Offset);
   if (len != BufferSize) {
     DEBUG ((EFI_D_INIT, "ReadBlocks: WriteFile failed.\n"));
-    Status = EmuBlockIoError (Private);
-    goto Done;
+    return EmuBlockIoError (Private);
   }
 
   //
@@ -472,18 +661,7 @@ EmuBlockIoWriteBlocks (
   //
   Private->Media->MediaPresent = TRUE;
   Private->Media->ReadOnly     = FALSE;
-  Status = EFI_SUCCESS;
-
-Done:
-  if (Token != NULL) {
-    if (Token->Event != NULL) {
-      // Caller is responsible for signaling EFI Event
-      Token->TransactionStatus = Status;
-      return EFI_SUCCESS;
-    }
-  }
-
-  return Status;
+  return EFI_SUCCESS;
 }
 
 
@@ -516,9 +694,15 @@ EmuBlockIoFlushBlocks (
   )
 {
   EMU_BLOCK_IO_PRIVATE *Private;
+  EMU_BLOCK_IO_REQUEST *Request;
 
   Private = EMU_BLOCK_IO_PRIVATE_DATA_FROM_THIS (This);
 
+  //
+  // The writes in progress are part of what has to be flushed.
+  //
+  EmuBlockIoWaitRequests (Private);
+
   if (Private->fd >= 0) {
     fsync (Private->fd);
 #if __APPLE__
@@ -529,9 +713,15 @@ EmuBlockIoFlushBlocks (
 
   if (Token != NULL) {
     if (Token->Event != NULL) {
-      // Caller is responsible for signaling EFI Event
-      Token->TransactionStatus = EFI_SUCCESS;
-      return EFI_SUCCESS;
+      Request = calloc (1, sizeof (EMU_BLOCK_IO_REQUEST));
+      if (Request == NULL) {
+        return EFI_OUT_OF_RESOURCES;
+      }
+
+      Request->Token  = Token;
+      Request->Done   = TRUE;
+      Request->Status = EFI_SUCCESS;
+      EmuBlockIoAppendRequest (Private, Request);
     }
   }
 
@@ -539,6 +729,43 @@ EmuBlockIoFlushBlocks (
 }
 
 
+/**
+  Return a non-blocking request that has completed.
+
+  @param[in]   This     Indicates a pointer to the calling context.
+  @param[out]  Token    The token of the completed request.
+
+  @retval EFI_SUCCESS    A completed request was returned in Token.
+  @retval EFI_NOT_READY  No request has completed since the last call.
+
+**/
+EFI_STATUS
+EmuBlockIoPoll (
+  IN     EMU_BLOCK_IO_PROTOCOL    *This,
+     OUT EFI_BLOCK_IO2_TOKEN      **Token
+  )
+{
+  EMU_BLOCK_IO_PRIVATE  *Private;
+  EMU_BLOCK_IO_REQUEST  **Link;
+  EMU_BLOCK_IO_REQUEST  *Request;
+
+  Private = EMU_BLOCK_IO_PRIVATE_DATA_FROM_THIS (This);
+
+  for (Link = &Private->Requests; *Link != NULL; Link = &(*Link)->Next) {
+    Request = *Link;
+    if (EmuBlockIoCompleteRequest (Private, Request, FALSE)) {
+      *Link = Request->Next;
+      Request->Token->TransactionStatus = Request->Status;
+      *Token = Request->Token;
+      free (Request);
+      return EFI_SUCCESS;
+    }
+  }
+
+  return EFI_NOT_READY;
+}
+
+
 /**
   Reset the block device hardware.
 
@@ -563,6 +790,14 @@ EmuBlockIoReset (
   Private = EMU_BLOCK_IO_PRIVATE_DATA_FROM_THIS (This);
 
   if (Private->fd >= 0) {
+    //
+    // The requests in progress are reported as aborted by EmuBlockIoPoll().
+    //
+    if (Private->Requests != NULL) {
+      aio_cancel (Private->fd, NULL);
+      EmuBlockIoWaitRequests (Private);
+    }
+
     close (Private->fd);
     Private->fd = -1;
   }
@@ -600,7 +835,8 @@ EMU_BLOCK_IO_PROTOCOL gEmuBlockIoProtocol = {
   GasketEmuBlockIoReadBlocks,
   GasketEmuBlockIoWriteBlocks,
   GasketEmuBlockIoFlushBlocks,
-  GasketEmuBlockIoCreateMapping
+  GasketEmuBlockIoCreateMapping,
+  GasketEmuBlockIoPoll
 };
 
 EFI_STATUS
@@ -630,6 +866,8 @@ EmuBlockIoThunkOpen (
   CopyMem (&Private->EmuBlockIo, &gEmuBlockIoProtocol, sizeof (gEmuBlockIoProtocol));
   Private->fd        = -1;
   Private->BlockSize = 512;
+  Private->DirectIo  = FALSE;
+  Private->Requests  = NULL;
 
   Private->Filename = StdDupUnicodeToAscii (This->ConfigString);
   if (Private->Filename == NULL) {
@@ -648,6 +886,9 @@ EmuBlockIoThunkOpen (
       if (*Str == 'O' || *Str == 'W') {
         Private->WriteProtected  = (BOOLEAN) (*Str == 'O');
       }
+      if (*Str == 'D') {
+        Private->DirectIo = TRUE;
+      }
       if (*Str == ':') {
         Private->BlockSize = strtol (++Str, NULL, 0);
         break;
@@ -656,6 +897,11 @@ EmuBlockIoThunkOpen (
   }
 
   Private->Mode = Private->WriteProtected ? O_RDONLY : O_RDWR;
+#ifdef O_DIRECT
+  if (Private->DirectIo) {
+    Private->Mode |= O_DIRECT;
+  }
+#endif
 
   This->Interface = &Private->EmuBlockIo;
   This->Private   = Private;
@@ -669,6 +915,7 @@ EmuBlockIoThunkClose (
   )
 {
   EMU_BLOCK_IO_PRIVATE  *Private;
+  EMU_BLOCK_IO_REQUEST  *Request;
 
   if (!CompareGuid (This->Protocol, &gEmuBlockIoProtocolGuid)) {
     return EFI_UNSUPPORTED;
@@ -677,6 +924,12 @@ EmuBlockIoThunkClose (
   Private = This->Private;
 
   if (This->Private != NULL) {
+    EmuBlockIoReset (&Private->EmuBlockIo, FALSE);
+    while (Private->Requests != NULL) {
+      Request           = Private->Requests;
+      Private->Requests = Request->Next;
+      free (Request);
+    }
     if (Private->Filename != NULL) {
       free (Private->Filename);
     }
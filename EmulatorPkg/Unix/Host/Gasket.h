@@ -343,6 +343,31 @@ GasketPthreadSelf (
   VOID
   );
 
+VOID *
+EFIAPI
+GasketPthreadCondInit (
+  IN VOID
+  );
+
+UINTN
+EFIAPI
+GasketPthreadCondDestroy (
+  IN VOID *Cond
+  );
+
+UINTN
+EFIAPI
+GasketPthreadCondWait (
+  IN VOID *Cond,
+  IN VOID *Mutex
+  );
+
+UINTN
+EFIAPI
+GasketPthreadCondSignal (
+  IN VOID *Cond
+  );
+
 EFI_STATUS
 EFIAPI
 GasketPthreadOpen (
@@ -496,6 +521,13 @@ GasketEmuBlockIoCreateMapping (
   IN     EFI_BLOCK_IO_MEDIA       *Media
   );
 
+EFI_STATUS
+EFIAPI
+GasketEmuBlockIoPoll (
+  IN     EMU_BLOCK_IO_PROTOCOL    *This,
+     OUT EFI_BLOCK_IO2_TOKEN      **Token
+  );
+
 EFI_STATUS
 EFIAPI
 GasketBlockIoThunkOpen (
@@ -48,6 +48,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <stdlib.h>
 #include <sys/ioctl.h>
 #include <sys/statvfs.h>
+#include <aio.h>
 
 #include <sys/socket.h>
 #include <netdb.h>
@@ -230,6 +230,25 @@ PosixSystemTimeToEfiTime (
 }
 
 
+/**
+  Return the EFI_FILE_INFO of an open file, or of an entry of an open
+  directory.
+
+  The open file is looked up through its host descriptor, and a directory
+  entry relative to the directory descriptor, so that the host does not walk
+  the full path again for every call.
+
+  @param  PrivateFile  The open file or directory.
+  @param  FileName     NULL for PrivateFile itself, else the name of an entry
+                       of the PrivateFile directory.
+  @param  BufferSize   On input size of buffer, on output amount of data in buffer.
+  @param  Buffer       The buffer to return data.
+
+  @retval EFI_SUCCESS           Data was returned.
+  @retval EFI_BUFFER_TOO_SMALL  Buffer was too small; required size returned in BufferSize.
+  @retval EFI_DEVICE_ERROR      The file could not be found on the host.
+
+**/
 EFI_STATUS
 UnixSimpleFileSystemFileInfo (
   EMU_EFI_FILE_PRIVATE            *PrivateFile,
@@ -247,6 +266,7 @@ UnixSimpleFileSystemFileInfo (
   CHAR8                       *TempPointer;
   CHAR16                      *BufferFileName;
   struct stat                 buf;
+  int                         Res;
 
   if (FileName != NULL) {
     RealFileName = FileName;
@@ -273,7 +293,18 @@ UnixSimpleFileSystemFileInfo (
     *BufferSize = ResultSize;
     return EFI_BUFFER_TOO_SMALL;
   }
-  if (stat (FileName == NULL ? PrivateFile->FileName : FileName, &buf) < 0) {
+
+  if (FileName != NULL) {
+    Res = fstatat (dirfd (PrivateFile->Dir), FileName, &buf, 0);
+  } else if (PrivateFile->fd >= 0) {
+    Res = fstat (PrivateFile->fd, &buf);
+  } else if (PrivateFile->Dir != NULL) {
+    Res = fstat (dirfd (PrivateFile->Dir), &buf);
+  } else {
+    Res = stat (PrivateFile->FileName, &buf);
+  }
+
+  if (Res < 0) {
     return EFI_DEVICE_ERROR;
   }
 
@@ -527,13 +558,6 @@ OpenRoot:
     } else {
       NewPrivateFile->IsDirectoryPath = FALSE;
     }
-  } else {
-    res = stat (NewPrivateFile->FileName, &finfo);
-    if (res == 0 && S_ISDIR(finfo.st_mode)) {
-      NewPrivateFile->IsDirectoryPath = TRUE;
-    } else {
-      NewPrivateFile->IsDirectoryPath = FALSE;
-    }
   }
 
   if (OpenMode & EFI_FILE_MODE_WRITE) {
@@ -542,6 +566,31 @@ OpenRoot:
     NewPrivateFile->IsOpenedByRead = TRUE;
   }
 
+  if (!(OpenMode & EFI_FILE_MODE_CREATE)) {
+    //
+    // Open the name first and find out from the descriptor whether it is a
+    // directory, rather than looking the path up twice.
+    //
+    NewPrivateFile->IsDirectoryPath = FALSE;
+    NewPrivateFile->fd = open (
+                          NewPrivateFile->FileName,
+                          NewPrivateFile->IsOpenedByRead ? O_RDONLY : O_RDWR
+                          );
+    if (NewPrivateFile->fd >= 0) {
+      res = fstat (NewPrivateFile->fd, &finfo);
+      if (res == 0 && S_ISDIR(finfo.st_mode)) {
+        NewPrivateFile->IsDirectoryPath = TRUE;
+        NewPrivateFile->Dir = fdopendir (NewPrivateFile->fd);
+        if (NewPrivateFile->Dir == NULL) {
+          close (NewPrivateFile->fd);
+        }
+        NewPrivateFile->fd = -1;
+      }
+    } else if (errno == EISDIR) {
+      NewPrivateFile->IsDirectoryPath = TRUE;
+    }
+  }
+
   Status = EFI_SUCCESS;
 
   //
@@ -561,7 +610,9 @@ OpenRoot:
       }
     }
 
-    NewPrivateFile->Dir = opendir (NewPrivateFile->FileName);
+    if (NewPrivateFile->Dir == NULL) {
+      NewPrivateFile->Dir = opendir (NewPrivateFile->FileName);
+    }
     if (NewPrivateFile->Dir == NULL) {
       if (errno == EACCES) {
         Status = EFI_ACCESS_DENIED;
@@ -576,11 +627,13 @@ OpenRoot:
     //
     // deal with file
     //
-    NewPrivateFile->fd = open (
-                          NewPrivateFile->FileName,
-                          ((OpenMode & EFI_FILE_MODE_CREATE) ? O_CREAT : 0) | (NewPrivateFile->IsOpenedByRead ? O_RDONLY : O_RDWR),
-                          0666
-                          );
+    if (OpenMode & EFI_FILE_MODE_CREATE) {
+      NewPrivateFile->fd = open (
+                            NewPrivateFile->FileName,
+                            O_CREAT | (NewPrivateFile->IsOpenedByRead ? O_RDONLY : O_RDWR),
+                            0666
+                            );
+    }
     if (NewPrivateFile->fd < 0) {
       if (errno == ENOENT) {
         Status = EFI_NOT_FOUND;
@@ -748,12 +801,11 @@ PosixFileRead (
 {
   EMU_EFI_FILE_PRIVATE    *PrivateFile;
   EFI_STATUS              Status;
-  int                     Res;
+  ssize_t                 Res;
+  UINTN                   Length;
   UINTN                   Size;
   UINTN                   NameSize;
   UINTN                   ResultSize;
-  CHAR8                   *FullFileName;
-  UINTN                   FullFileNameSize;
 
   PrivateFile = EMU_EFI_FILE_PRIVATE_DATA_FROM_THIS (This);
 
@@ -763,12 +815,25 @@ PosixFileRead (
       goto Done;
     }
 
-    Res = read (PrivateFile->fd, Buffer, *BufferSize);
-    if (Res < 0) {
-      Status = EFI_DEVICE_ERROR;
-      goto Done;
+    //
+    // A single read() may return less than asked for on large requests, so
+    // keep reading until the buffer is full or the end of file is reached.
+    //
+    for (Length = 0; Length < *BufferSize; Length += Res) {
+      Res = read (PrivateFile->fd, (UINT8 *) Buffer + Length, *BufferSize - Length);
+      if (Res < 0) {
+        if (errno == EINTR) {
+          Res = 0;
+          continue;
+        }
+        Status = EFI_DEVICE_ERROR;
+        goto Done;
+      }
+      if (Res == 0) {
+        break;
+      }
     }
-    *BufferSize = Res;
+    *BufferSize = Length;
     Status = EFI_SUCCESS;
     goto Done;
   }
@@ -803,23 +868,12 @@ PosixFileRead (
 
   *BufferSize = ResultSize;
 
-  FullFileNameSize = AsciiStrLen(PrivateFile->FileName) + 1 + NameSize;
-  FullFileName = malloc (FullFileNameSize);
-  if (FullFileName == NULL) {
-    Status = EFI_OUT_OF_RESOURCES;
-    goto Done;
-  }
-
-  AsciiStrCpyS (FullFileName, FullFileNameSize, PrivateFile->FileName);
-  AsciiStrCatS (FullFileName, FullFileNameSize, "/");
-  AsciiStrCatS (FullFileName, FullFileNameSize, PrivateFile->Dirent->d_name);
   Status = UnixSimpleFileSystemFileInfo (
             PrivateFile,
-            FullFileName,
+            PrivateFile->Dirent->d_name,
             BufferSize,
             Buffer
             );
-  free (FullFileName);
 
   PrivateFile->Dirent = NULL;
 
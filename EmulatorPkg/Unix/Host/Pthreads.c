@@ -74,6 +74,73 @@ PthreadMutexDestroy (
   return -1;
 }
 
+
+VOID *
+PthreadCondInit (
+  IN VOID
+  )
+{
+  pthread_cond_t  *Cond;
+  int             err;
+
+  Cond = malloc (sizeof (pthread_cond_t));
+  if (Cond == NULL) {
+    return NULL;
+  }
+
+  err = pthread_cond_init (Cond, NULL);
+  if (err == 0) {
+    return Cond;
+  }
+
+  free (Cond);
+  return NULL;
+}
+
+
+UINTN
+PthreadCondDestroy (
+  IN VOID *Cond
+  )
+{
+  UINTN  Status;
+
+  if (Cond != NULL) {
+    Status = pthread_cond_destroy ((pthread_cond_t *)Cond);
+    free (Cond);
+    return Status;
+  }
+
+  return -1;
+}
+
+
+UINTN
+PthreadCondWait (
+  IN VOID *Cond,
+  IN VOID *Mutex
+  )
+{
+  if ((Cond != NULL) && (Mutex != NULL)) {
+    return pthread_cond_wait ((pthread_cond_t *)Cond, (pthread_mutex_t *)Mutex);
+  }
+
+  return -1;
+}
+
+
+UINTN
+PthreadCondSignal (
+  IN VOID *Cond
+  )
+{
+  if (Cond != NULL) {
+    return pthread_cond_signal ((pthread_cond_t *)Cond);
+  }
+
+  return -1;
+}
+
 // Can't store this data on PthreadCreate stack so we need a global
 typedef struct {
   pthread_mutex_t             Mutex;
@@ -182,7 +249,11 @@ EMU_THREAD_THUNK_PROTOCOL gPthreadThunk = {
   GasketPthreadMutexDestroy,
   GasketPthreadCreate,
   GasketPthreadExit,
-  GasketPthreadSelf
+  GasketPthreadSelf,
+  GasketPthreadCondInit,
+  GasketPthreadCondDestroy,
+  GasketPthreadCondWait,
+  GasketPthreadCondSignal
 };
 
 
@@ -37,9 +37,49 @@ FatFreeODir (
     FatFreeDirEnt (DirEnt);
   }
 
+  FatFreeHashTable (ODir);
   FreePool (ODir);
 }
 
+/**
+
+  Get the memory held by a directory structure, including its directory entries.
+
+  @param  ODir                  - The directory.
+
+  @return The size in bytes.
+
+**/
+STATIC
+UINTN
+FatODirSize (
+  IN FAT_ODIR    *ODir
+  )
+{
+  return sizeof (FAT_ODIR) + 2 * ODir->HashTableSize * sizeof (FAT_DIRENT *) + ODir->DirEntSize;
+}
+
+/**
+
+  Remove a directory structure from the directory cache of the volume.
+
+  @param  Volume                - FAT file system volume.
+  @param  ODir                  - The cached directory.
+
+**/
+STATIC
+VOID
+FatRemoveODirFromCache (
+  IN FAT_VOLUME  *Volume,
+  IN FAT_ODIR    *ODir
+  )
+{
+  RemoveEntryList (&ODir->DirCacheLink);
+  RemoveEntryList (&ODir->DirCacheHashLink);
+  Volume->DirCacheCount--;
+  Volume->DirCacheSize -= FatODirSize (ODir);
+}
+
 /**
 
   Allocate the directory structure.
@@ -57,6 +97,10 @@ FatAllocateODir (
 
   ODir = AllocateZeroPool (sizeof (FAT_ODIR));
   if (ODir != NULL) {
+    if (EFI_ERROR (FatInitializeHashTable (ODir))) {
+      FreePool (ODir);
+      return NULL;
+    }
     //
     // Initialize the directory entry list
     //
@@ -83,29 +127,33 @@ FatDiscardODir (
 {
   FAT_ODIR    *ODir;
   FAT_VOLUME  *Volume;
+  FAT_ODIR    *Victim;
 
   Volume  = OFile->Volume;
   ODir    = OFile->ODir;
-  if (!OFile->DirEnt->Invalid) {
+  if (!OFile->DirEnt->Invalid && FatODirSize (ODir) <= FAT_MAX_DIR_CACHE_SIZE) {
     //
     // If OFile does not represent a deleted file, then we will cache the directory
     // We use OFile's first cluster as the directory's tag
     //
     ODir->DirCacheTag = OFile->FileCluster;
     InsertHeadList (&Volume->DirCacheList, &ODir->DirCacheLink);
-    if (Volume->DirCacheCount == FAT_MAX_DIR_CACHE_COUNT) {
-      //
-      // Replace the least recent used directory
-      //
-      ODir = ODIR_FROM_DIRCACHELINK (Volume->DirCacheList.BackLink);
-      RemoveEntryList (&ODir->DirCacheLink);
-    } else {
-      //
-      // No need to find a replace
-      //
-      Volume->DirCacheCount++;
-      ODir = NULL;
+    InsertHeadList (
+      &Volume->DirCacheHashTable[ODir->DirCacheTag & (FAT_DIR_CACHE_HASH_SIZE - 1)],
+      &ODir->DirCacheHashLink
+      );
+    Volume->DirCacheCount++;
+    Volume->DirCacheSize += FatODirSize (ODir);
+    //
+    // Replace the least recent used directories until the cache fits
+    //
+    while (Volume->DirCacheSize > FAT_MAX_DIR_CACHE_SIZE) {
+      Victim = ODIR_FROM_DIRCACHELINK (Volume->DirCacheList.BackLink);
+      FatRemoveODirFromCache (Volume, Victim);
+      FatFreeODir (Victim);
     }
+
+    ODir = NULL;
   }
   //
   // Release ODir Structure
@@ -135,18 +183,19 @@ FatRequestODir (
   FAT_ODIR        *ODir;
   FAT_ODIR        *CurrentODir;
   LIST_ENTRY      *CurrentODirLink;
+  LIST_ENTRY      *Head;
 
   Volume      = OFile->Volume;
   ODir        = NULL;
   DirCacheTag = OFile->FileCluster;
-  for (CurrentODirLink  = Volume->DirCacheList.ForwardLink;
-       CurrentODirLink != &Volume->DirCacheList;
+  Head        = &Volume->DirCacheHashTable[DirCacheTag & (FAT_DIR_CACHE_HASH_SIZE - 1)];
+  for (CurrentODirLink  = Head->ForwardLink;
+       CurrentODirLink != Head;
        CurrentODirLink  = CurrentODirLink->ForwardLink
       ) {
-    CurrentODir = ODIR_FROM_DIRCACHELINK (CurrentODirLink);
+    CurrentODir = ODIR_FROM_DIRCACHEHASHLINK (CurrentODirLink);
     if (CurrentODir->DirCacheTag == DirCacheTag) {
-      RemoveEntryList (&CurrentODir->DirCacheLink);
-      Volume->DirCacheCount--;
+      FatRemoveODirFromCache (Volume, CurrentODir);
       ODir = CurrentODir;
       break;
     }
@@ -177,8 +226,7 @@ FatCleanupODirCache (
   FAT_ODIR  *ODir;
   while (Volume->DirCacheCount > 0) {
     ODir = ODIR_FROM_DIRCACHELINK (Volume->DirCacheList.BackLink);
-    RemoveEntryList (&ODir->DirCacheLink);
+    FatRemoveODirFromCache (Volume, ODir);
     FatFreeODir (ODir);
-    Volume->DirCacheCount--;
   }
 }
@@ -8,6 +8,120 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #include "Fat.h"
 
+/**
+
+  Get the memory address of the cache page described by CacheTag.
+
+  @param  DiskCache             - The disk cache the tag belongs to.
+  @param  CacheTag              - The Cache Tag for the cache page.
+
+  @return The address of the cache page.
+
+**/
+STATIC
+UINT8 *
+FatCachePageAddress (
+  IN DISK_CACHE         *DiskCache,
+  IN CACHE_TAG          *CacheTag
+  )
+{
+  return DiskCache->CacheBase + ((UINTN) (CacheTag - DiskCache->CacheTag) << DiskCache->PageAlignment);
+}
+
+/**
+
+  Find the valid cache page holding PageNo.
+
+  @param  DiskCache             - The disk cache to search.
+  @param  PageNo                - PageNo to match with the cache.
+
+  @return The Cache Tag of the page, or NULL if the page is not cached.
+
+**/
+STATIC
+CACHE_TAG *
+FatLookupCacheTag (
+  IN DISK_CACHE         *DiskCache,
+  IN UINTN              PageNo
+  )
+{
+  LIST_ENTRY  *Head;
+  LIST_ENTRY  *Link;
+  CACHE_TAG   *CacheTag;
+
+  Head = &DiskCache->HashTable[PageNo & (DiskCache->PageCount - 1)];
+  for (Link = Head->ForwardLink; Link != Head; Link = Link->ForwardLink) {
+    CacheTag = CACHE_TAG_FROM_HASHLINK (Link);
+    if (CacheTag->PageNo == PageNo) {
+      return CacheTag;
+    }
+  }
+
+  return NULL;
+}
+
+/**
+
+  Mark the cache page as the most recently used one.
+
+  @param  DiskCache             - The disk cache the tag belongs to.
+  @param  CacheTag              - The Cache Tag for the cache page.
+
+**/
+STATIC
+VOID
+FatTouchCacheTag (
+  IN DISK_CACHE         *DiskCache,
+  IN CACHE_TAG          *CacheTag
+  )
+{
+  RemoveEntryList (&CacheTag->LruLink);
+  InsertHeadList (&DiskCache->LruList, &CacheTag->LruLink);
+}
+
+/**
+
+  Make the cache page valid for the page number in CacheTag->PageNo.
+
+  @param  DiskCache             - The disk cache the tag belongs to.
+  @param  CacheTag              - The Cache Tag for the cache page.
+
+**/
+STATIC
+VOID
+FatInsertCacheTag (
+  IN DISK_CACHE         *DiskCache,
+  IN CACHE_TAG          *CacheTag
+  )
+{
+  ASSERT (CacheTag->RealSize > 0);
+  InsertHeadList (&DiskCache->HashTable[CacheTag->PageNo & (DiskCache->PageCount - 1)], &CacheTag->HashLink);
+  FatTouchCacheTag (DiskCache, CacheTag);
+}
+
+/**
+
+  Invalidate the cache page, and make it the first candidate for replacement.
+
+  @param  DiskCache             - The disk cache the tag belongs to.
+  @param  CacheTag              - The Cache Tag for the cache page.
+
+**/
+STATIC
+VOID
+FatDiscardCacheTag (
+  IN DISK_CACHE         *DiskCache,
+  IN CACHE_TAG          *CacheTag
+  )
+{
+  ASSERT (CacheTag->RealSize > 0);
+  CacheTag->RealSize = 0;
+  CacheTag->Dirty    = FALSE;
+  RemoveEntryList (&CacheTag->HashLink);
+  RemoveEntryList (&CacheTag->LruLink);
+  InsertTailList (&DiskCache->LruList, &CacheTag->LruLink);
+}
+
 /**
 
   This function is used by the Data Cache.
@@ -37,44 +151,55 @@ FatFlushDataCacheRange (
   OUT UINT8              *Buffer
   )
 {
-  UINTN       PageNo;
-  UINTN       GroupNo;
-  UINTN       GroupMask;
+  UINTN       Index;
+  UINTN       Count;
   UINTN       PageSize;
   UINT8       PageAlignment;
+  BOOLEAN     ScanTags;
   DISK_CACHE  *DiskCache;
   CACHE_TAG   *CacheTag;
-  UINT8       *BaseAddress;
 
   DiskCache     = &Volume->DiskCache[CacheData];
-  BaseAddress   = DiskCache->CacheBase;
-  GroupMask     = DiskCache->GroupMask;
   PageAlignment = DiskCache->PageAlignment;
   PageSize      = (UINTN)1 << PageAlignment;
 
-  for (PageNo = StartPageNo; PageNo < EndPageNo; PageNo++) {
-    GroupNo   = PageNo & GroupMask;
-    CacheTag  = &DiskCache->CacheTag[GroupNo];
-    if (CacheTag->RealSize > 0 && CacheTag->PageNo == PageNo) {
+  //
+  // Large ranges are cheaper to check by scanning every cache tag once
+  // than by probing the hash table for each page of the range.
+  //
+  ScanTags = (BOOLEAN) (EndPageNo - StartPageNo > DiskCache->PageCount);
+  Count    = ScanTags ? DiskCache->PageCount : EndPageNo - StartPageNo;
+  for (Index = 0; Index < Count; Index++) {
+    if (ScanTags) {
+      CacheTag = &DiskCache->CacheTag[Index];
+      if (CacheTag->RealSize == 0 || CacheTag->PageNo < StartPageNo || CacheTag->PageNo >= EndPageNo) {
+        continue;
+      }
+    } else {
+      CacheTag = FatLookupCacheTag (DiskCache, StartPageNo + Index);
+      if (CacheTag == NULL) {
+        continue;
+      }
+    }
+
+    //
+    // When reading data form disk directly, if some dirty data
+    // in cache is in this rang, this data in the Buffer need to
+    // be updated with the cache's dirty data.
+    //
+    if (IoMode == ReadDisk) {
+      if (CacheTag->Dirty) {
+        CopyMem (
+          Buffer + ((CacheTag->PageNo - StartPageNo) << PageAlignment),
+          FatCachePageAddress (DiskCache, CacheTag),
+          PageSize
+          );
+      }
+    } else {
       //
-      // When reading data form disk directly, if some dirty data
-      // in cache is in this rang, this data in the Buffer need to
-      // be updated with the cache's dirty data.
+      // Make all valid entries in this range invalid.
       //
-      if (IoMode == ReadDisk) {
-        if (CacheTag->Dirty) {
-          CopyMem (
-            Buffer + ((PageNo - StartPageNo) << PageAlignment),
-            BaseAddress + (GroupNo << PageAlignment),
-            PageSize
-            );
-        }
-      } else {
-        //
-        // Make all valid entries in this range invalid.
-        //
-        CacheTag->RealSize = 0;
-      }
+      FatDiscardCacheTag (DiskCache, CacheTag);
     }
   }
 }
@@ -104,7 +229,6 @@ FatExchangeCachePage (
   )
 {
   EFI_STATUS  Status;
-  UINTN       GroupNo;
   UINTN       PageNo;
   UINTN       WriteCount;
   UINTN       RealSize;
@@ -116,9 +240,8 @@ FatExchangeCachePage (
 
   DiskCache     = &Volume->DiskCache[DataType];
   PageNo        = CacheTag->PageNo;
-  GroupNo       = PageNo & DiskCache->GroupMask;
   PageAlignment = DiskCache->PageAlignment;
-  PageAddress   = DiskCache->CacheBase + (GroupNo << PageAlignment);
+  PageAddress   = FatCachePageAddress (DiskCache, CacheTag);
   EntryPos      = DiskCache->BaseAddress + LShiftU64 (PageNo, PageAlignment);
   RealSize      = CacheTag->RealSize;
   if (IoMode == ReadDisk) {
@@ -152,6 +275,194 @@ FatExchangeCachePage (
   return EFI_SUCCESS;
 }
 
+/**
+
+  Write the dirty cache page described by CacheTag back to the disk, together
+  with the dirty pages adjacent to it on the disk, in as few writes as the
+  staging buffer allows.
+
+  With a Task, the staging buffer is allocated for the write and released
+  when the subtask completes. The FAT cache is written page by page in that
+  case, since each page is written once per FAT.
+
+  @param  Volume                - FAT file system volume.
+  @param  DataType              - Indicate the cache type.
+  @param  CacheTag              - A dirty cache page.
+  @param  Backward              - Also merge the dirty pages preceding CacheTag.
+  @param  Task                    point to task instance.
+
+  @retval EFI_SUCCESS           - The pages are written back.
+  @return Others                - An error occurred when writing the pages.
+
+**/
+STATIC
+EFI_STATUS
+FatWriteBackCachePages (
+  IN FAT_VOLUME         *Volume,
+  IN CACHE_DATA_TYPE    DataType,
+  IN CACHE_TAG          *CacheTag,
+  IN BOOLEAN            Backward,
+  IN FAT_TASK           *Task
+  )
+{
+  EFI_STATUS  Status;
+  DISK_CACHE  *DiskCache;
+  CACHE_TAG   *First;
+  CACHE_TAG   *Tag;
+  FAT_SUBTASK *Subtask;
+  UINT8       *Buffer;
+  UINT64      EntryPos;
+  UINTN       PageSize;
+  UINTN       MaxCount;
+  UINTN       Count;
+  UINTN       Index;
+  UINTN       WriteSize;
+  UINTN       WriteCount;
+  UINT8       PageAlignment;
+
+  DiskCache     = &Volume->DiskCache[DataType];
+  PageAlignment = DiskCache->PageAlignment;
+  PageSize      = (UINTN)1 << PageAlignment;
+  MaxCount      = FAT_WRITEBACK_BUFFER_SIZE >> PageAlignment;
+  if (DiskCache->WriteBackBase == NULL || (Task != NULL && DataType == CacheFat)) {
+    MaxCount = 1;
+  }
+
+  //
+  // Find the first page of the run. Only the last page of the cache range
+  // may be partial, so every page before CacheTag is a full one.
+  //
+  First = CacheTag;
+  Count = 1;
+  while (Backward && Count < MaxCount && First->PageNo > 0) {
+    Tag = FatLookupCacheTag (DiskCache, First->PageNo - 1);
+    if (Tag == NULL || !Tag->Dirty) {
+      break;
+    }
+
+    First = Tag;
+    Count++;
+  }
+
+  //
+  // Extend the run forward while the pages are dirty and full
+  //
+  Tag = CacheTag;
+  while (Count < MaxCount && Tag->RealSize == PageSize) {
+    Tag = FatLookupCacheTag (DiskCache, Tag->PageNo + 1);
+    if (Tag == NULL || !Tag->Dirty) {
+      break;
+    }
+
+    Count++;
+  }
+
+  if (Count == 1) {
+    return FatExchangeCachePage (Volume, DataType, WriteDisk, CacheTag, Task);
+  }
+
+  Buffer = DiskCache->WriteBackBase;
+  if (Task != NULL) {
+    Buffer = AllocatePool (Count << PageAlignment);
+    if (Buffer == NULL) {
+      return FatExchangeCachePage (Volume, DataType, WriteDisk, CacheTag, Task);
+    }
+  }
+
+  //
+  // Gather the run into the staging buffer
+  //
+  WriteSize = 0;
+  Tag       = First;
+  for (Index = 0; Index < Count; Index++) {
+    if (Index > 0) {
+      Tag = FatLookupCacheTag (DiskCache, First->PageNo + Index);
+    }
+
+    ASSERT (Tag != NULL && Tag->Dirty);
+    CopyMem (Buffer + WriteSize, FatCachePageAddress (DiskCache, Tag), Tag->RealSize);
+    WriteSize += Tag->RealSize;
+  }
+
+  EntryPos   = DiskCache->BaseAddress + LShiftU64 (First->PageNo, PageAlignment);
+  WriteCount = (DataType == CacheFat) ? Volume->NumFats : 1;
+  do {
+    //
+    // Only fat table writing will execute more than once
+    //
+    Status = FatDiskIo (Volume, WriteDisk, EntryPos, WriteSize, Buffer, Task);
+    if (EFI_ERROR (Status)) {
+      if (Task != NULL) {
+        FreePool (Buffer);
+      }
+
+      return Status;
+    }
+
+    EntryPos += Volume->FatSize;
+  } while (--WriteCount > 0);
+
+  if (Task != NULL) {
+    //
+    // The subtask just queued owns the staging buffer
+    //
+    Subtask             = CR (Task->Subtasks.BackLink, FAT_SUBTASK, Link, FAT_SUBTASK_SIGNATURE);
+    Subtask->FreeBuffer = TRUE;
+  }
+
+  for (Index = 0; Index < Count; Index++) {
+    Tag        = FatLookupCacheTag (DiskCache, First->PageNo + Index);
+    Tag->Dirty = FALSE;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+
+  Take the least recently used cache page for reuse, writing it back
+  to the disk first if it is dirty.
+
+  @param  Volume                - FAT file system volume.
+  @param  CacheDataType         - The cache type: CACHE_FAT or CACHE_DATA.
+  @param  CacheTag              - The Cache Tag of the free cache page.
+
+  @retval EFI_SUCCESS           - A free cache page was found.
+  @return other                 - An error occurred when writing back the page.
+
+**/
+STATIC
+EFI_STATUS
+FatGetFreeCacheTag (
+  IN  FAT_VOLUME         *Volume,
+  IN  CACHE_DATA_TYPE    CacheDataType,
+  OUT CACHE_TAG          **CacheTag
+  )
+{
+  EFI_STATUS  Status;
+  DISK_CACHE  *DiskCache;
+  CACHE_TAG   *Victim;
+
+  DiskCache = &Volume->DiskCache[CacheDataType];
+  Victim    = CACHE_TAG_FROM_LRULINK (GetPreviousNode (&DiskCache->LruList, &DiskCache->LruList));
+  if (Victim->RealSize > 0) {
+    //
+    // Write dirty cache page back to disk, with its dirty neighbours
+    //
+    if (Victim->Dirty) {
+      Status = FatWriteBackCachePages (Volume, CacheDataType, Victim, TRUE, NULL);
+      if (EFI_ERROR (Status)) {
+        return Status;
+      }
+    }
+
+    FatDiscardCacheTag (DiskCache, Victim);
+  }
+
+  *CacheTag = Victim;
+  return EFI_SUCCESS;
+}
+
 /**
 
   Get one cache page by specified PageNo.
@@ -168,39 +479,44 @@ FatExchangeCachePage (
 STATIC
 EFI_STATUS
 FatGetCachePage (
-  IN FAT_VOLUME         *Volume,
-  IN CACHE_DATA_TYPE    CacheDataType,
-  IN UINTN              PageNo,
-  IN CACHE_TAG          *CacheTag
+  IN  FAT_VOLUME         *Volume,
+  IN  CACHE_DATA_TYPE    CacheDataType,
+  IN  UINTN              PageNo,
+  OUT CACHE_TAG          **CacheTag
   )
 {
   EFI_STATUS  Status;
-  UINTN       OldPageNo;
+  DISK_CACHE  *DiskCache;
+  CACHE_TAG   *Tag;
 
-  OldPageNo = CacheTag->PageNo;
-  if (CacheTag->RealSize > 0 && OldPageNo == PageNo) {
+  DiskCache = &Volume->DiskCache[CacheDataType];
+  Tag       = FatLookupCacheTag (DiskCache, PageNo);
+  if (Tag != NULL) {
     //
     // Cache Hit occurred
     //
+    FatTouchCacheTag (DiskCache, Tag);
+    *CacheTag = Tag;
     return EFI_SUCCESS;
   }
 
-  //
-  // Write dirty cache page back to disk
-  //
-  if (CacheTag->RealSize > 0 && CacheTag->Dirty) {
-    Status = FatExchangeCachePage (Volume, CacheDataType, WriteDisk, CacheTag, NULL);
-    if (EFI_ERROR (Status)) {
-      return Status;
-    }
+  Status = FatGetFreeCacheTag (Volume, CacheDataType, &Tag);
+  if (EFI_ERROR (Status)) {
+    return Status;
   }
   //
   // Load new data from disk;
   //
-  CacheTag->PageNo  = PageNo;
-  Status            = FatExchangeCachePage (Volume, CacheDataType, ReadDisk, CacheTag, NULL);
+  Tag->PageNo = PageNo;
+  Status      = FatExchangeCachePage (Volume, CacheDataType, ReadDisk, Tag, NULL);
+  if (EFI_ERROR (Status)) {
+    Tag->RealSize = 0;
+    return Status;
+  }
 
-  return Status;
+  FatInsertCacheTag (DiskCache, Tag);
+  *CacheTag = Tag;
+  return EFI_SUCCESS;
 }
 
 /**
@@ -237,14 +553,11 @@ FatAccessUnalignedCachePage (
   VOID        *Destination;
   DISK_CACHE  *DiskCache;
   CACHE_TAG   *CacheTag;
-  UINTN       GroupNo;
 
   DiskCache = &Volume->DiskCache[CacheDataType];
-  GroupNo   = PageNo & DiskCache->GroupMask;
-  CacheTag  = &DiskCache->CacheTag[GroupNo];
-  Status    = FatGetCachePage (Volume, CacheDataType, PageNo, CacheTag);
+  Status    = FatGetCachePage (Volume, CacheDataType, PageNo, &CacheTag);
   if (!EFI_ERROR (Status)) {
-    Source      = DiskCache->CacheBase + (GroupNo << DiskCache->PageAlignment) + Offset;
+    Source      = FatCachePageAddress (DiskCache, CacheTag) + Offset;
     Destination = Buffer;
     if (IoMode != ReadDisk) {
       CacheTag->Dirty   = TRUE;
@@ -377,10 +690,106 @@ FatAccessCache (
   return Status;
 }
 
+/**
+
+  Prefetch the data area range [Offset, Offset + Length) into the data cache
+  with a single disk read. Pages already present in the cache are left alone.
+  Readahead is only a hint, so failures are not reported to the caller.
+
+  @param  Volume                - FAT file system volume.
+  @param  Offset                - The starting byte offset on the disk.
+  @param  Length                - The number of bytes to prefetch.
+
+**/
+VOID
+FatReadAheadCache (
+  IN FAT_VOLUME         *Volume,
+  IN UINT64             Offset,
+  IN UINTN              Length
+  )
+{
+  EFI_STATUS  Status;
+  DISK_CACHE  *DiskCache;
+  CACHE_TAG   *CacheTag;
+  UINT64      EntryPos;
+  UINTN       PageNo;
+  UINTN       EndPageNo;
+  UINTN       PageCount;
+  UINTN       Index;
+  UINTN       ReadSize;
+  UINTN       PageSize;
+  UINT8       PageAlignment;
+
+  DiskCache = &Volume->DiskCache[CacheData];
+  if (DiskCache->ReadAheadBase == NULL || Length == 0 ||
+      Offset < DiskCache->BaseAddress || Offset >= DiskCache->LimitAddress) {
+    return;
+  }
+
+  PageAlignment = DiskCache->PageAlignment;
+  PageSize      = (UINTN)1 << PageAlignment;
+  EntryPos      = Offset - DiskCache->BaseAddress;
+  PageNo        = (UINTN) RShiftU64 (EntryPos, PageAlignment);
+  EndPageNo     = (UINTN) RShiftU64 (EntryPos + Length + PageSize - 1, PageAlignment);
+
+  //
+  // Skip the pages which are already cached, then read up to the next cached
+  // page. Never let readahead take over more than half of the cache.
+  //
+  while (PageNo < EndPageNo && FatLookupCacheTag (DiskCache, PageNo) != NULL) {
+    PageNo++;
+  }
+
+  PageCount = MIN (EndPageNo - PageNo, MIN (FAT_READAHEAD_MAX_PAGES, DiskCache->PageCount / 2));
+  for (Index = 1; Index < PageCount; Index++) {
+    if (FatLookupCacheTag (DiskCache, PageNo + Index) != NULL) {
+      break;
+    }
+  }
+
+  PageCount = MIN (PageCount, Index);
+  if (PageCount == 0) {
+    return;
+  }
+
+  EntryPos = DiskCache->BaseAddress + LShiftU64 (PageNo, PageAlignment);
+  ReadSize = PageCount << PageAlignment;
+  if (DiskCache->LimitAddress - EntryPos < ReadSize) {
+    ReadSize = (UINTN) (DiskCache->LimitAddress - EntryPos);
+  }
+
+  Status = FatDiskIo (Volume, ReadDisk, EntryPos, ReadSize, DiskCache->ReadAheadBase, NULL);
+  if (EFI_ERROR (Status)) {
+    return;
+  }
+
+  for (Index = 0; Index < PageCount && (Index << PageAlignment) < ReadSize; Index++) {
+    Status = FatGetFreeCacheTag (Volume, CacheData, &CacheTag);
+    if (EFI_ERROR (Status)) {
+      return;
+    }
+
+    CacheTag->PageNo   = PageNo + Index;
+    CacheTag->RealSize = MIN (PageSize, ReadSize - (Index << PageAlignment));
+    CacheTag->Dirty    = FALSE;
+    CopyMem (
+      FatCachePageAddress (DiskCache, CacheTag),
+      DiskCache->ReadAheadBase + (Index << PageAlignment),
+      CacheTag->RealSize
+      );
+    FatInsertCacheTag (DiskCache, CacheTag);
+  }
+}
+
 /**
 
   Flush all the dirty cache back, include the FAT cache and the Data cache.
 
+  The dirty pages of each cache are written in ascending disk order, with
+  adjacent pages merged into one write. The data cache is written before
+  the FAT cache, so the FAT never references clusters whose contents have
+  not reached the disk yet.
+
   @param  Volume                - FAT file system volume.
   @param  Task                    point to task instance.
 
@@ -396,29 +805,38 @@ FatVolumeFlushCache (
 {
   EFI_STATUS      Status;
   CACHE_DATA_TYPE CacheDataType;
-  UINTN           GroupIndex;
-  UINTN           GroupMask;
+  UINTN           Pass;
+  UINTN           Index;
   DISK_CACHE      *DiskCache;
   CACHE_TAG       *CacheTag;
+  CACHE_TAG       *Lowest;
 
-  for (CacheDataType = (CACHE_DATA_TYPE) 0; CacheDataType < CacheMaxType; CacheDataType++) {
-    DiskCache = &Volume->DiskCache[CacheDataType];
+  for (Pass = 0; Pass < CacheMaxType; Pass++) {
+    CacheDataType = (Pass == 0) ? CacheData : CacheFat;
+    DiskCache     = &Volume->DiskCache[CacheDataType];
     if (DiskCache->Dirty) {
       //
-      // Data cache or fat cache is dirty, write the dirty data back
+      // Data cache or fat cache is dirty, write the dirty data back,
+      // starting with the lowest dirty page each time
       //
-      GroupMask = DiskCache->GroupMask;
-      for (GroupIndex = 0; GroupIndex <= GroupMask; GroupIndex++) {
-        CacheTag = &DiskCache->CacheTag[GroupIndex];
-        if (CacheTag->RealSize > 0 && CacheTag->Dirty) {
-          //
-          // Write back all Dirty Data Cache Page to disk
-          //
-          Status = FatExchangeCachePage (Volume, CacheDataType, WriteDisk, CacheTag, Task);
-          if (EFI_ERROR (Status)) {
-            return Status;
+      for (;;) {
+        Lowest = NULL;
+        for (Index = 0; Index < DiskCache->PageCount; Index++) {
+          CacheTag = &DiskCache->CacheTag[Index];
+          if (CacheTag->RealSize > 0 && CacheTag->Dirty &&
+              (Lowest == NULL || CacheTag->PageNo < Lowest->PageNo)) {
+            Lowest = CacheTag;
           }
         }
+
+        if (Lowest == NULL) {
+          break;
+        }
+
+        Status = FatWriteBackCachePages (Volume, CacheDataType, Lowest, FALSE, Task);
+        if (EFI_ERROR (Status)) {
+          return Status;
+        }
       }
 
       DiskCache->Dirty = FALSE;
@@ -431,10 +849,109 @@ FatVolumeFlushCache (
   return Status;
 }
 
+/**
+
+  Compute the amount of free memory in the system memory map.
+
+  @return The number of bytes of EfiConventionalMemory, or 0 if the memory map
+          could not be retrieved.
+
+**/
+STATIC
+UINT64
+FatGetFreeMemorySize (
+  VOID
+  )
+{
+  EFI_STATUS            Status;
+  EFI_MEMORY_DESCRIPTOR *MemoryMap;
+  EFI_MEMORY_DESCRIPTOR *Entry;
+  EFI_MEMORY_DESCRIPTOR *MapEnd;
+  UINTN                 MapSize;
+  UINTN                 MapKey;
+  UINTN                 DescriptorSize;
+  UINT32                DescriptorVersion;
+  UINT64                FreePages;
+
+  MapSize   = 0;
+  MemoryMap = NULL;
+  Status    = gBS->GetMemoryMap (&MapSize, MemoryMap, &MapKey, &DescriptorSize, &DescriptorVersion);
+  while (Status == EFI_BUFFER_TOO_SMALL) {
+    //
+    // Leave room for the descriptors that our own allocation may add
+    //
+    MapSize  += 2 * DescriptorSize;
+    MemoryMap = AllocatePool (MapSize);
+    if (MemoryMap == NULL) {
+      return 0;
+    }
+
+    Status = gBS->GetMemoryMap (&MapSize, MemoryMap, &MapKey, &DescriptorSize, &DescriptorVersion);
+    if (EFI_ERROR (Status)) {
+      FreePool (MemoryMap);
+      MemoryMap = NULL;
+    }
+  }
+
+  if (MemoryMap == NULL) {
+    return 0;
+  }
+
+  FreePages = 0;
+  MapEnd    = (EFI_MEMORY_DESCRIPTOR *) ((UINT8 *) MemoryMap + MapSize);
+  for (Entry = MemoryMap; Entry < MapEnd; Entry = NEXT_MEMORY_DESCRIPTOR (Entry, DescriptorSize)) {
+    if (Entry->Type == EfiConventionalMemory) {
+      FreePages += Entry->NumberOfPages;
+    }
+  }
+
+  FreePool (MemoryMap);
+  return LShiftU64 (FreePages, EFI_PAGE_SHIFT);
+}
+
+/**
+
+  Set up the cache tags, hash buckets and LRU list of one disk cache.
+
+  @param  DiskCache             - The disk cache to initialize.
+  @param  PageCount             - The number of cache pages, a power of 2.
+  @param  CacheTag              - The array of PageCount cache tags.
+  @param  HashTable             - The array of PageCount hash buckets.
+
+**/
+STATIC
+VOID
+FatInitializeCacheTags (
+  IN DISK_CACHE         *DiskCache,
+  IN UINTN              PageCount,
+  IN CACHE_TAG          *CacheTag,
+  IN LIST_ENTRY         *HashTable
+  )
+{
+  UINTN Index;
+
+  ASSERT ((PageCount & (PageCount - 1)) == 0);
+
+  DiskCache->PageCount = PageCount;
+  DiskCache->CacheTag  = CacheTag;
+  DiskCache->HashTable = HashTable;
+  InitializeListHead (&DiskCache->LruList);
+  for (Index = 0; Index < PageCount; Index++) {
+    InitializeListHead (&HashTable[Index]);
+    CacheTag[Index].PageNo   = 0;
+    CacheTag[Index].RealSize = 0;
+    CacheTag[Index].Dirty    = FALSE;
+    InsertTailList (&DiskCache->LruList, &CacheTag[Index].LruLink);
+  }
+}
+
 /**
 
   Initialize the disk cache according to Volume's FatType.
 
+  The data cache is sized against the free memory of the system, between
+  FAT_DATACACHE_GROUP_COUNT and FAT_DATACACHE_MAX_PAGE_COUNT pages.
+
   @param  Volume                - FAT file system volume.
 
   @retval EFI_SUCCESS           - The disk cache is successfully initialized.
@@ -448,9 +965,16 @@ FatInitializeDiskCache (
 {
   DISK_CACHE  *DiskCache;
   UINTN       FatCacheGroupCount;
+  UINTN       DataCachePageCount;
   UINTN       DataCacheSize;
   UINTN       FatCacheSize;
+  UINTN       ReadAheadSize;
+  UINTN       WriteBackSize;
+  UINTN       TagCount;
+  UINT64      MemoryBudget;
   UINT8       *CacheBuffer;
+  CACHE_TAG   *CacheTag;
+  LIST_ENTRY  *HashTable;
 
   DiskCache = Volume->DiskCache;
   //
@@ -466,24 +990,64 @@ FatInitializeDiskCache (
     DiskCache[CacheData].PageAlignment = FAT_DATACACHE_PAGE_MAX_ALIGNMENT;
   }
 
-  DiskCache[CacheData].GroupMask     = FAT_DATACACHE_GROUP_COUNT - 1;
+  //
+  // Grow the data cache while it fits in the memory budget
+  //
+  DataCachePageCount = FAT_DATACACHE_GROUP_COUNT;
+  MemoryBudget       = RShiftU64 (FatGetFreeMemorySize (), FAT_DATACACHE_MEMORY_SHIFT);
+  while (DataCachePageCount < FAT_DATACACHE_MAX_PAGE_COUNT &&
+         LShiftU64 (DataCachePageCount * 2, DiskCache[CacheData].PageAlignment) <= MemoryBudget) {
+    DataCachePageCount *= 2;
+  }
+
   DiskCache[CacheData].BaseAddress   = Volume->RootPos;
   DiskCache[CacheData].LimitAddress  = Volume->VolumeSize;
-  DiskCache[CacheFat].GroupMask      = FatCacheGroupCount - 1;
   DiskCache[CacheFat].BaseAddress    = Volume->FatPos;
   DiskCache[CacheFat].LimitAddress   = Volume->FatPos + Volume->FatSize;
   FatCacheSize                        = FatCacheGroupCount << DiskCache[CacheFat].PageAlignment;
-  DataCacheSize                       = FAT_DATACACHE_GROUP_COUNT << DiskCache[CacheData].PageAlignment;
+  ReadAheadSize                       = FAT_READAHEAD_MAX_PAGES << DiskCache[CacheData].PageAlignment;
+  WriteBackSize                       = FAT_WRITEBACK_BUFFER_SIZE;
   //
-  // Allocate the Fat Cache buffer
+  // Allocate the cache pages, the readahead and write back buffers, and the cache tags with
+  // their hash buckets in one buffer. Fall back to the minimum data cache
+  // size if memory is short.
   //
-  CacheBuffer = AllocateZeroPool (FatCacheSize + DataCacheSize);
-  if (CacheBuffer == NULL) {
-    return EFI_OUT_OF_RESOURCES;
+  for (;;) {
+    DataCacheSize = DataCachePageCount << DiskCache[CacheData].PageAlignment;
+    TagCount      = FatCacheGroupCount + DataCachePageCount;
+    CacheBuffer   = AllocatePool (
+                      FatCacheSize + DataCacheSize + ReadAheadSize + WriteBackSize +
+                      TagCount * (sizeof (CACHE_TAG) + sizeof (LIST_ENTRY))
+                      );
+    if (CacheBuffer != NULL) {
+      break;
+    }
+
+    if (DataCachePageCount == FAT_DATACACHE_GROUP_COUNT) {
+      return EFI_OUT_OF_RESOURCES;
+    }
+
+    DataCachePageCount = FAT_DATACACHE_GROUP_COUNT;
   }
 
-  Volume->CacheBuffer             = CacheBuffer;
-  DiskCache[CacheFat].CacheBase  = CacheBuffer;
-  DiskCache[CacheData].CacheBase = CacheBuffer + FatCacheSize;
+  Volume->CacheBuffer                 = CacheBuffer;
+  DiskCache[CacheFat].CacheBase      = CacheBuffer;
+  DiskCache[CacheFat].ReadAheadBase  = NULL;
+  DiskCache[CacheData].CacheBase     = CacheBuffer + FatCacheSize;
+  DiskCache[CacheData].ReadAheadBase = CacheBuffer + FatCacheSize + DataCacheSize;
+  DiskCache[CacheFat].WriteBackBase  = CacheBuffer + FatCacheSize + DataCacheSize + ReadAheadSize;
+  DiskCache[CacheData].WriteBackBase = DiskCache[CacheFat].WriteBackBase;
+
+  CacheTag  = (CACHE_TAG *) (CacheBuffer + FatCacheSize + DataCacheSize + ReadAheadSize + WriteBackSize);
+  HashTable = (LIST_ENTRY *) (CacheTag + TagCount);
+  FatInitializeCacheTags (&DiskCache[CacheFat], FatCacheGroupCount, CacheTag, HashTable);
+  FatInitializeCacheTags (
+    &DiskCache[CacheData],
+    DataCachePageCount,
+    CacheTag + FatCacheGroupCount,
+    HashTable + FatCacheGroupCount
+    );
+
+  DEBUG ((EFI_D_INFO, "FatInitializeDiskCache: %Lu data cache pages\n", (UINT64) DataCachePageCount));
   return EFI_SUCCESS;
 }
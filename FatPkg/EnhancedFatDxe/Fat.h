@@ -17,6 +17,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Protocol/BlockIo.h>
 #include <Protocol/DiskIo.h>
 #include <Protocol/DiskIo2.h>
+#include <Protocol/FileBulkRead.h>
 #include <Protocol/SimpleFileSystem.h>
 #include <Protocol/UnicodeCollation.h>
 
@@ -52,8 +53,10 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #define VOLUME_FROM_ROOT_DIRENT(a)   CR (a, FAT_VOLUME, RootDirEnt, FAT_VOLUME_SIGNATURE)
 
 #define VOLUME_FROM_VOL_INTERFACE(a) CR (a, FAT_VOLUME, VolumeInterface, FAT_VOLUME_SIGNATURE);
+#define VOLUME_FROM_BULK_READ(a)     CR (a, FAT_VOLUME, BulkReadInterface, FAT_VOLUME_SIGNATURE)
 
 #define ODIR_FROM_DIRCACHELINK(a)    CR (a, FAT_ODIR, DirCacheLink, FAT_ODIR_SIGNATURE)
+#define ODIR_FROM_DIRCACHEHASHLINK(a) CR (a, FAT_ODIR, DirCacheHashLink, FAT_ODIR_SIGNATURE)
 
 #define OFILE_FROM_CHECKLINK(a)      CR (a, FAT_OFILE, CheckLink, FAT_OFILE_SIGNATURE)
 
@@ -84,6 +87,27 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #define FAT_FATCACHE_GROUP_MIN_COUNT      1
 #define FAT_FATCACHE_GROUP_MAX_COUNT      16
 
+//
+// The data cache grows from FAT_DATACACHE_GROUP_COUNT pages up to
+// FAT_DATACACHE_MAX_PAGE_COUNT pages, using at most 1/(2^FAT_DATACACHE_MEMORY_SHIFT)
+// of the free memory present when the volume is mounted.
+//
+#define FAT_DATACACHE_MAX_PAGE_COUNT      256
+#define FAT_DATACACHE_MEMORY_SHIFT        8
+
+//
+// Sequential reads are prefetched into the data cache with a window that
+// starts at FAT_READAHEAD_MIN_PAGES and doubles up to FAT_READAHEAD_MAX_PAGES
+//
+#define FAT_READAHEAD_MIN_PAGES           2
+#define FAT_READAHEAD_MAX_PAGES           32
+
+//
+// Dirty cache pages adjacent on the disk are written back together through
+// a staging buffer of FAT_WRITEBACK_BUFFER_SIZE bytes
+//
+#define FAT_WRITEBACK_BUFFER_SIZE         SIZE_1MB
+
 //
 // Used in 8.3 generation algorithm
 //
@@ -104,7 +128,11 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #define LC_ISO_639_2_ENTRY_SIZE 3
 #define MAX_LANG_CODE_SIZE      100
 
-#define FAT_MAX_DIR_CACHE_COUNT 8
+//
+// The directory cache is bounded by the memory held by the cached directories
+//
+#define FAT_MAX_DIR_CACHE_SIZE  SIZE_8MB
+#define FAT_DIR_CACHE_HASH_SIZE 0x40
 #define FAT_MAX_DIRENTRY_COUNT  0xFFFF
 typedef CHAR8                   LC_ISO_639_2;
 
@@ -144,26 +172,39 @@ typedef enum {
 // Disk cache tag
 //
 typedef struct {
-  UINTN   PageNo;
-  UINTN   RealSize;
-  BOOLEAN Dirty;
+  UINTN       PageNo;
+  UINTN       RealSize;
+  BOOLEAN     Dirty;
+  LIST_ENTRY  LruLink;                // Link in DISK_CACHE.LruList
+  LIST_ENTRY  HashLink;               // Link in DISK_CACHE.HashTable, when RealSize > 0
 } CACHE_TAG;
 
+#define CACHE_TAG_FROM_LRULINK(a)   BASE_CR (a, CACHE_TAG, LruLink)
+#define CACHE_TAG_FROM_HASHLINK(a)  BASE_CR (a, CACHE_TAG, HashLink)
+
 typedef struct {
-  UINT64    BaseAddress;
-  UINT64    LimitAddress;
-  UINT8     *CacheBase;
-  BOOLEAN   Dirty;
-  UINT8     PageAlignment;
-  UINTN     GroupMask;
-  CACHE_TAG CacheTag[FAT_DATACACHE_GROUP_COUNT];
+  UINT64      BaseAddress;
+  UINT64      LimitAddress;
+  UINT8       *CacheBase;
+  BOOLEAN     Dirty;
+  UINT8       PageAlignment;
+  UINTN       PageCount;              // Number of cache pages, a power of 2
+  CACHE_TAG   *CacheTag;              // Array of PageCount tags
+  LIST_ENTRY  *HashTable;             // PageCount buckets indexed by PageNo
+  LIST_ENTRY  LruList;                // Most recently used page first
+  UINT8       *ReadAheadBase;         // Staging buffer for readahead, data cache only
+  UINT8       *WriteBackBase;         // Staging buffer for coalesced write back, shared by both caches
 } DISK_CACHE;
 
 //
 // Hash table size
 //
-#define HASH_TABLE_SIZE  0x400
-#define HASH_TABLE_MASK  (HASH_TABLE_SIZE - 1)
+//
+// The name hash tables of a directory start small and double in size when
+// there are more entries than buckets
+//
+#define HASH_TABLE_MIN_SIZE  0x20
+#define HASH_TABLE_MAX_SIZE  0x10000
 
 //
 // The directory entry for opened directory
@@ -195,9 +236,13 @@ struct _FAT_ODIR {
   LIST_ENTRY          ChildList;              // List of all directory entries
   BOOLEAN             EndOfDir;               // Indicate whether we have reached the end of the directory
   LIST_ENTRY          DirCacheLink;           // Linked in Volume->DirCacheList when discarded
+  LIST_ENTRY          DirCacheHashLink;       // Linked in Volume->DirCacheHashTable when discarded
   UINTN               DirCacheTag;            // The identification of the directory when in directory cache
-  FAT_DIRENT          *LongNameHashTable[HASH_TABLE_SIZE];
-  FAT_DIRENT          *ShortNameHashTable[HASH_TABLE_SIZE];
+  UINTN               HashTableSize;          // Number of buckets in each hash table, a power of 2
+  UINTN               HashEntryCount;         // Number of directory entries in the hash tables
+  UINTN               DirEntSize;             // Memory held by the directory entries in the hash tables
+  FAT_DIRENT          **LongNameHashTable;
+  FAT_DIRENT          **ShortNameHashTable;
 };
 
 typedef struct {
@@ -226,9 +271,32 @@ typedef struct {
   UINT64              Offset;
   VOID                *Buffer;
   UINTN               BufferSize;
+  BOOLEAN             FreeBuffer;             // Buffer is pool memory owned by the subtask
   LIST_ENTRY          Link;
 } FAT_SUBTASK;
 
+//
+// FAT_EXTENT - A run of contiguous clusters in the cluster chain of a file
+//
+typedef struct {
+  UINTN               FileCluster;  // Index of the first cluster within the file
+  UINTN               Cluster;      // First cluster on the disk
+  UINTN               Length;       // Number of clusters in the run
+} FAT_EXTENT;
+
+#define FAT_EXTENT_MIN_COUNT  16
+
+//
+// Free cluster bitmap, one bit per cluster, set when the cluster is free
+//
+#define FAT_FREE_BITMAP_SIZE(MaxCluster)  (((MaxCluster) + 2 + 7) / 8)
+#define FAT_FREE_BITMAP_TEST(Bitmap, Index) \
+  (((Bitmap)[(Index) >> 3] & (1 << ((Index) & 7))) != 0)
+#define FAT_FREE_BITMAP_SET(Bitmap, Index) \
+  ((Bitmap)[(Index) >> 3] |= (UINT8) (1 << ((Index) & 7)))
+#define FAT_FREE_BITMAP_CLEAR(Bitmap, Index) \
+  ((Bitmap)[(Index) >> 3] &= (UINT8) ~(1 << ((Index) & 7)))
+
 //
 // FAT_OFILE - Each opened file
 //
@@ -272,6 +340,22 @@ struct _FAT_OFILE {
   UINT64              PosDisk;  // on the disk
   UINTN               PosRem;   // remaining in this disk run
   //
+  // Sequential read detection for the data cache readahead
+  //
+  UINTN               ReadAheadPos;   // File position expected by a sequential read
+  UINTN               ReadAheadEnd;   // End of the range already prefetched
+  UINTN               ReadAheadPages; // Current readahead window in cache pages
+  //
+  // Map of the cluster chain, built lazily by FatOFilePosition.
+  // Extents cover the first ExtentClusters clusters of the file, and the
+  // chain ends after them if ExtentEnd is set.
+  //
+  FAT_EXTENT          *Extents;
+  UINTN               ExtentCount;
+  UINTN               ExtentMax;
+  UINTN               ExtentClusters;
+  BOOLEAN             ExtentEnd;
+  //
   // The opened parent, full path length and currently opened child files
   //
   FAT_OFILE           *Parent;
@@ -303,6 +387,7 @@ struct _FAT_VOLUME {
   BOOLEAN                         DiskError;
 
   EFI_SIMPLE_FILE_SYSTEM_PROTOCOL VolumeInterface;
+  EDKII_FILE_BULK_READ_PROTOCOL   BulkReadInterface;
 
   //
   // If opened, the parent handle and BlockIo interface
@@ -335,6 +420,7 @@ struct _FAT_VOLUME {
   FAT_INFO_SECTOR                 FatInfoSector;  // Free cluster info
   UINTN                           FreeInfoPos;    // Pos with the free cluster info
   BOOLEAN                         FreeInfoValid;  // If free cluster info is valid
+  UINT8                           *FreeBitmap;    // Free cluster bitmap, built on first allocation
   //
   // Unpacked Fat BPB info
   //
@@ -368,7 +454,9 @@ struct _FAT_VOLUME {
   // Directory cache List
   //
   LIST_ENTRY                      DirCacheList;
+  LIST_ENTRY                      DirCacheHashTable[FAT_DIR_CACHE_HASH_SIZE];
   UINTN                           DirCacheCount;
+  UINTN                           DirCacheSize;   // Memory held by the cached directories
 
   //
   // Disk Cache for this volume
@@ -711,6 +799,30 @@ FatInitializeDiskCache (
   IN FAT_VOLUME              *Volume
   );
 
+/**
+
+  Read the whole contents of an open file into the caller's buffer.
+
+  @param  This                  - The EDKII_FILE_BULK_READ_PROTOCOL instance of the volume.
+  @param  File                  - The handle of the file.
+  @param  BufferSize            - Size of Buffer on input, bytes read on output.
+  @param  Buffer                - Buffer receiving the file contents.
+
+  @retval EFI_SUCCESS           - The file was read successfully.
+  @retval EFI_BUFFER_TOO_SMALL  - Buffer is smaller than the file.
+  @retval EFI_INVALID_PARAMETER - File does not belong to this volume or is a directory.
+  @return other                 - An error occurred when reading the file.
+
+**/
+EFI_STATUS
+EFIAPI
+FatBulkReadFile (
+  IN     EDKII_FILE_BULK_READ_PROTOCOL  *This,
+  IN     EFI_FILE_PROTOCOL              *File,
+  IN OUT UINTN                          *BufferSize,
+     OUT VOID                           *Buffer
+  );
+
 /**
 
   Read BufferSize bytes from the position of Offset into Buffer,
@@ -751,6 +863,24 @@ FatAccessCache (
   IN     FAT_TASK            *Task
   );
 
+/**
+
+  Prefetch the data area range [Offset, Offset + Length) into the data cache
+  with a single disk read. Pages already present in the cache are left alone.
+  Readahead is only a hint, so failures are not reported to the caller.
+
+  @param  Volume                - FAT file system volume.
+  @param  Offset                - The starting byte offset on the disk.
+  @param  Length                - The number of bytes to prefetch.
+
+**/
+VOID
+FatReadAheadCache (
+  IN FAT_VOLUME              *Volume,
+  IN UINT64                  Offset,
+  IN UINTN                   Length
+  );
+
 /**
 
   Flush all the dirty cache back, include the FAT cache and the Data cache.
@@ -946,6 +1076,18 @@ FatOFilePosition (
   IN UINTN                PosLimit
   );
 
+/**
+
+  Discard the cluster chain map of the open file.
+
+  @param  OFile                 - The open file.
+
+**/
+VOID
+FatResetExtentMap (
+  IN FAT_OFILE            *OFile
+  );
+
 /**
 
   Update the free cluster info of FatInfoSector of the volume.
@@ -1791,6 +1933,33 @@ FatShortNameHashSearch (
   IN CHAR8              *ShortNameString
   );
 
+/**
+
+  Allocate the hash tables of a newly created directory.
+
+  @param  ODir                  - The directory.
+
+  @retval EFI_SUCCESS           - The hash tables are allocated.
+  @retval EFI_OUT_OF_RESOURCES  - Not enough memory.
+
+**/
+EFI_STATUS
+FatInitializeHashTable (
+  IN FAT_ODIR           *ODir
+  );
+
+/**
+
+  Free the hash tables of a directory.
+
+  @param  ODir                  - The directory.
+
+**/
+VOID
+FatFreeHashTable (
+  IN FAT_ODIR           *ODir
+  );
+
 /**
 
   Insert directory entry to hash table.
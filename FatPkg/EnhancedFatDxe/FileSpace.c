@@ -157,13 +157,23 @@ FatSetFatEntry (
   OriginalVal = FatGetFatEntry (Volume, Index);
   if (Value == FAT_CLUSTER_FREE && OriginalVal != FAT_CLUSTER_FREE) {
     Volume->FatInfoSector.FreeInfo.ClusterCount += 1;
-    if (Index < Volume->FatInfoSector.FreeInfo.NextCluster) {
+    if (Volume->FreeBitmap != NULL) {
+      //
+      // The allocator is next-fit once the bitmap exists, so a freed cluster
+      // does not pull the search position back
+      //
+      FAT_FREE_BITMAP_SET (Volume->FreeBitmap, Index);
+    } else if (Index < Volume->FatInfoSector.FreeInfo.NextCluster) {
       Volume->FatInfoSector.FreeInfo.NextCluster = (UINT32) Index;
     }
   } else if (Value != FAT_CLUSTER_FREE && OriginalVal == FAT_CLUSTER_FREE) {
     if (Volume->FatInfoSector.FreeInfo.ClusterCount != 0) {
       Volume->FatInfoSector.FreeInfo.ClusterCount -= 1;
     }
+
+    if (Volume->FreeBitmap != NULL) {
+      FAT_FREE_BITMAP_CLEAR (Volume->FreeBitmap, Index);
+    }
   }
   //
   // Make sure the entry is in memory
@@ -256,6 +266,147 @@ FatFreeClusters (
   return EFI_SUCCESS;
 }
 
+/**
+
+  Build the free cluster bitmap of the volume with a single pass over the FAT.
+  The free cluster count is recomputed along the way.
+
+  @param  Volume                - FAT file system volume.
+
+  @retval EFI_SUCCESS           - The bitmap is built, or was already present.
+  @retval EFI_OUT_OF_RESOURCES  - Can not allocate the bitmap.
+  @retval EFI_DEVICE_ERROR      - An error occurred when reading the FAT.
+
+**/
+STATIC
+EFI_STATUS
+FatBuildFreeBitmap (
+  IN FAT_VOLUME   *Volume
+  )
+{
+  UINT8   *Bitmap;
+  UINTN   Index;
+  UINTN   FreeCount;
+  UINTN   FirstFree;
+
+  if (Volume->FreeBitmap != NULL) {
+    return EFI_SUCCESS;
+  }
+
+  Bitmap = AllocateZeroPool (FAT_FREE_BITMAP_SIZE (Volume->MaxCluster));
+  if (Bitmap == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  FreeCount = 0;
+  FirstFree = Volume->MaxCluster + 2;
+  for (Index = FAT_MIN_CLUSTER; Index <= Volume->MaxCluster + 1; Index++) {
+    if (Volume->DiskError) {
+      FreePool (Bitmap);
+      return EFI_DEVICE_ERROR;
+    }
+
+    if (FatGetFatEntry (Volume, Index) == FAT_CLUSTER_FREE) {
+      FAT_FREE_BITMAP_SET (Bitmap, Index);
+      FirstFree = MIN (FirstFree, Index);
+      FreeCount++;
+    }
+  }
+
+  Volume->FreeBitmap                          = Bitmap;
+  Volume->FreeInfoValid                       = TRUE;
+  Volume->FatInfoSector.FreeInfo.ClusterCount = (UINT32) FreeCount;
+  if (Volume->FatInfoSector.FreeInfo.NextCluster < FAT_MIN_CLUSTER ||
+      Volume->FatInfoSector.FreeInfo.NextCluster > Volume->MaxCluster + 1) {
+    Volume->FatInfoSector.FreeInfo.NextCluster = (UINT32) FirstFree;
+  }
+
+  Volume->FatInfoSector.Signature          = FAT_INFO_SIGNATURE;
+  Volume->FatInfoSector.InfoBeginSignature = FAT_INFO_BEGIN_SIGNATURE;
+  Volume->FatInfoSector.InfoEndSignature   = FAT_INFO_END_SIGNATURE;
+  return EFI_SUCCESS;
+}
+
+/**
+
+  Search the free cluster bitmap for a run of free clusters, starting at Start
+  and wrapping around at the end of the volume. The first run that is at least
+  Wanted clusters long is returned; otherwise the longest run seen.
+
+  @param  Volume                - FAT file system volume.
+  @param  Start                 - The cluster to start searching from.
+  @param  Wanted                - The number of clusters wanted.
+  @param  RunLength             - The length of the run found.
+
+  @return The first cluster of the run, or FAT_CLUSTER_LAST if the volume is full.
+
+**/
+STATIC
+UINTN
+FatFindFreeRun (
+  IN  FAT_VOLUME  *Volume,
+  IN  UINTN       Start,
+  IN  UINTN       Wanted,
+  OUT UINTN       *RunLength
+  )
+{
+  UINT8   *Bitmap;
+  UINTN   Index;
+  UINTN   Scanned;
+  UINTN   Current;
+  UINTN   CurrentLength;
+  UINTN   Best;
+  UINTN   BestLength;
+
+  Bitmap        = Volume->FreeBitmap;
+  Best          = (UINTN) FAT_CLUSTER_LAST;
+  BestLength    = 0;
+  Current       = 0;
+  CurrentLength = 0;
+  Index         = Start;
+
+  for (Scanned = 0; Scanned < Volume->MaxCluster;) {
+    if (Index > Volume->MaxCluster + 1) {
+      //
+      // Wrap around, a run does not continue across the end of the volume
+      //
+      Index         = FAT_MIN_CLUSTER;
+      CurrentLength = 0;
+    }
+    //
+    // Skip fully allocated bytes of the bitmap at once
+    //
+    if (CurrentLength == 0 && (Index & 7) == 0 && Bitmap[Index >> 3] == 0) {
+      Index   += 8;
+      Scanned += 8;
+      continue;
+    }
+
+    if (FAT_FREE_BITMAP_TEST (Bitmap, Index)) {
+      if (CurrentLength == 0) {
+        Current = Index;
+      }
+
+      CurrentLength++;
+      if (CurrentLength > BestLength) {
+        Best       = Current;
+        BestLength = CurrentLength;
+        if (BestLength >= Wanted) {
+          break;
+        }
+      }
+    } else {
+      CurrentLength = 0;
+    }
+
+    Index++;
+    Scanned++;
+  }
+
+  *RunLength = BestLength;
+  return Best;
+}
+
 /**
 
   Allocate a free cluster and return the cluster index.
@@ -310,6 +461,68 @@ FatAllocateCluster (
   return Cluster;
 }
 
+/**
+
+  Allocate a run of contiguous free clusters. The run is placed right after
+  Hint when that cluster is free, so that a growing file stays contiguous;
+  otherwise the search continues from where the last allocation ended.
+
+  The clusters are not marked as used in the FAT, the caller must do it before
+  allocating again.
+
+  @param  Volume                - FAT file system volume.
+  @param  Hint                  - The preferred first cluster of the run, or 0.
+  @param  Wanted                - The number of clusters wanted.
+  @param  RunLength             - The number of clusters allocated, which may be
+                                  less than Wanted.
+
+  @return The first cluster of the run, or FAT_CLUSTER_LAST if the volume is full.
+
+**/
+STATIC
+UINTN
+FatAllocateClusters (
+  IN  FAT_VOLUME  *Volume,
+  IN  UINTN       Hint,
+  IN  UINTN       Wanted,
+  OUT UINTN       *RunLength
+  )
+{
+  UINTN Start;
+  UINTN Cluster;
+
+  if (Volume->DiskError) {
+    return (UINTN) FAT_CLUSTER_LAST;
+  }
+
+  if (EFI_ERROR (FatBuildFreeBitmap (Volume))) {
+    //
+    // Fall back to scanning the FAT one cluster at a time
+    //
+    *RunLength = 1;
+    return FatAllocateCluster (Volume);
+  }
+
+  if (Hint >= FAT_MIN_CLUSTER && Hint <= Volume->MaxCluster + 1 &&
+      FAT_FREE_BITMAP_TEST (Volume->FreeBitmap, Hint)) {
+    Start = Hint;
+  } else {
+    Start = Volume->FatInfoSector.FreeInfo.NextCluster;
+    if (Start < FAT_MIN_CLUSTER || Start > Volume->MaxCluster + 1) {
+      Start = FAT_MIN_CLUSTER;
+    }
+  }
+
+  Cluster = FatFindFreeRun (Volume, Start, Wanted, RunLength);
+  if (FAT_END_OF_FAT_CHAIN (Cluster)) {
+    return Cluster;
+  }
+
+  *RunLength = MIN (*RunLength, Wanted);
+  Volume->FatInfoSector.FreeInfo.NextCluster = (UINT32) (Cluster + *RunLength);
+  return Cluster;
+}
+
 /**
 
   Count the number of clusters given a size.
@@ -403,6 +616,7 @@ FatShrinkEof (
   OFile->FileCurrentCluster = OFile->FileCluster;
   OFile->FileLastCluster    = LastCluster;
   OFile->Dirty              = TRUE;
+  FatResetExtentMap (OFile);
   //
   // Free the remaining cluster chain
   //
@@ -436,6 +650,8 @@ FatGrowEof (
   UINTN       LastCluster;
   UINTN       NewCluster;
   UINTN       ClusterCount;
+  UINTN       RunLength;
+  UINTN       Index;
 
   //
   // For FAT file system, the max file is 4GB.
@@ -487,12 +703,19 @@ FatGrowEof (
 
     }
     //
-    // Loop until we've allocated enough space
+    // Loop until we've allocated enough space. The clusters are appended
+    // to the chain, so the extent map stays valid up to its end.
     //
-    LastCluster = OFile->FileLastCluster;
+    LastCluster       = OFile->FileLastCluster;
+    OFile->ExtentEnd  = FALSE;
 
     while (CurSize < NewSize) {
-      NewCluster = FatAllocateCluster (Volume);
+      NewCluster = FatAllocateClusters (
+                     Volume,
+                     (LastCluster != 0) ? LastCluster + 1 : 0,
+                     NewSize - CurSize,
+                     &RunLength
+                     );
       if (FAT_END_OF_FAT_CHAIN (NewCluster)) {
         if (LastCluster != FAT_CLUSTER_FREE) {
           FatSetFatEntry (Volume, LastCluster, (UINTN) FAT_CLUSTER_LAST);
@@ -503,7 +726,8 @@ FatGrowEof (
         goto Done;
       }
 
-      if (NewCluster < FAT_MIN_CLUSTER || NewCluster > Volume->MaxCluster + 1) {
+      if (NewCluster < FAT_MIN_CLUSTER || RunLength == 0 ||
+          NewCluster + RunLength - 1 > Volume->MaxCluster + 1) {
         Status = EFI_VOLUME_CORRUPTED;
         goto Done;
       }
@@ -515,20 +739,23 @@ FatGrowEof (
         OFile->FileCurrentCluster = NewCluster;
       }
 
-      LastCluster = NewCluster;
-      CurSize += 1;
-
       //
-      // Terminate the cluster list
+      // Chain the run together and terminate the cluster list
       //
-      // Note that we must do this EVERY time we allocate a cluster, because
-      // FatAllocateCluster scans the FAT looking for a free cluster and
-      // "LastCluster" is no longer free!  Usually, FatAllocateCluster will
+      // Note that we must do this EVERY time we allocate clusters, because
+      // the allocator looks for free clusters and the clusters of the run
+      // are not marked as used until now.  Usually, the next allocation will
       // start looking with the cluster after "LastCluster"; however, when
-      // there is only one free cluster left, it will find "LastCluster"
-      // a second time.  There are other, less predictable scenarios
-      // where this could happen, as well.
+      // the FAT is scanned one cluster at a time and there is only one free
+      // cluster left, it will find "LastCluster" a second time.
       //
+      for (Index = 1; Index < RunLength; Index++) {
+        FatSetFatEntry (Volume, NewCluster + Index - 1, NewCluster + Index);
+      }
+
+      LastCluster = NewCluster + RunLength - 1;
+      CurSize    += RunLength;
+
       FatSetFatEntry (Volume, LastCluster, (UINTN) FAT_CLUSTER_LAST);
       OFile->FileLastCluster = LastCluster;
     }
@@ -543,6 +770,179 @@ Done:
   return Status;
 }
 
+/**
+
+  Discard the cluster chain map of the open file.
+
+  @param  OFile                 - The open file.
+
+**/
+VOID
+FatResetExtentMap (
+  IN FAT_OFILE            *OFile
+  )
+{
+  OFile->ExtentCount    = 0;
+  OFile->ExtentClusters = 0;
+  OFile->ExtentEnd      = FALSE;
+}
+
+/**
+
+  Append a new run starting at Cluster to the cluster chain map of the open file.
+
+  @param  OFile                 - The open file.
+  @param  Cluster               - The first cluster of the run.
+
+  @retval EFI_SUCCESS           - The run is appended.
+  @retval EFI_OUT_OF_RESOURCES  - Can not grow the map.
+
+**/
+STATIC
+EFI_STATUS
+FatAppendExtent (
+  IN FAT_OFILE            *OFile,
+  IN UINTN                Cluster
+  )
+{
+  FAT_EXTENT  *Extents;
+  UINTN       ExtentMax;
+
+  if (OFile->ExtentCount == OFile->ExtentMax) {
+    ExtentMax = MAX (OFile->ExtentMax * 2, FAT_EXTENT_MIN_COUNT);
+    Extents   = ReallocatePool (
+                  OFile->ExtentMax * sizeof (FAT_EXTENT),
+                  ExtentMax * sizeof (FAT_EXTENT),
+                  OFile->Extents
+                  );
+    if (Extents == NULL) {
+      return EFI_OUT_OF_RESOURCES;
+    }
+
+    OFile->Extents   = Extents;
+    OFile->ExtentMax = ExtentMax;
+  }
+
+  OFile->Extents[OFile->ExtentCount].FileCluster = OFile->ExtentClusters;
+  OFile->Extents[OFile->ExtentCount].Cluster     = Cluster;
+  OFile->Extents[OFile->ExtentCount].Length      = 1;
+  OFile->ExtentCount++;
+  OFile->ExtentClusters++;
+  return EFI_SUCCESS;
+}
+
+/**
+
+  Find the disk cluster holding the ClusterIndex'th cluster of the open file, and the
+  number of contiguous clusters from there. The cluster chain map is extended by walking
+  the FAT as far as needed, contiguous runs being collapsed into single extents.
+
+  @param  OFile                 - The open file.
+  @param  ClusterIndex          - The cluster index within the file.
+  @param  ClusterLimit          - The last cluster index the current access may reach.
+  @param  Cluster               - The disk cluster.
+  @param  RunLength             - The number of contiguous clusters starting at Cluster.
+
+  @retval EFI_SUCCESS           - The cluster is found.
+  @retval EFI_OUT_OF_RESOURCES  - Can not grow the map.
+  @retval EFI_VOLUME_CORRUPTED  - Cluster chain corrupt.
+
+**/
+STATIC
+EFI_STATUS
+FatLookupExtent (
+  IN  FAT_OFILE           *OFile,
+  IN  UINTN               ClusterIndex,
+  IN  UINTN               ClusterLimit,
+  OUT UINTN               *Cluster,
+  OUT UINTN               *RunLength
+  )
+{
+  FAT_VOLUME  *Volume;
+  FAT_EXTENT  *Last;
+  FAT_EXTENT  *Extent;
+  UINTN       Next;
+  UINTN       Low;
+  UINTN       High;
+  UINTN       Mid;
+  EFI_STATUS  Status;
+
+  Volume = OFile->Volume;
+
+  if (OFile->ExtentCount == 0) {
+    if (OFile->FileCluster < FAT_MIN_CLUSTER || OFile->FileCluster > Volume->MaxCluster + 1) {
+      return EFI_VOLUME_CORRUPTED;
+    }
+
+    Status = FatAppendExtent (OFile, OFile->FileCluster);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+  }
+
+  //
+  // Walk the chain until the extent holding ClusterIndex is either complete,
+  // or long enough for the current access
+  //
+  for (;;) {
+    Last = &OFile->Extents[OFile->ExtentCount - 1];
+    if (OFile->ExtentClusters > ClusterIndex &&
+        (Last->FileCluster > ClusterIndex || OFile->ExtentClusters > ClusterLimit)) {
+      break;
+    }
+
+    if (OFile->ExtentEnd) {
+      if (OFile->ExtentClusters > ClusterIndex) {
+        break;
+      }
+
+      return EFI_VOLUME_CORRUPTED;
+    }
+
+    Next = FatGetFatEntry (Volume, Last->Cluster + Last->Length - 1);
+    if (FAT_END_OF_FAT_CHAIN (Next)) {
+      OFile->ExtentEnd = TRUE;
+      continue;
+    }
+
+    if (Next < FAT_MIN_CLUSTER || Next > Volume->MaxCluster + 1 ||
+        OFile->ExtentClusters > Volume->MaxCluster) {
+      DEBUG ((EFI_D_INIT | EFI_D_ERROR, "FatLookupExtent: cluster chain corrupt\n"));
+      return EFI_VOLUME_CORRUPTED;
+    }
+
+    if (Next == Last->Cluster + Last->Length) {
+      Last->Length++;
+      OFile->ExtentClusters++;
+    } else {
+      Status = FatAppendExtent (OFile, Next);
+      if (EFI_ERROR (Status)) {
+        return Status;
+      }
+    }
+  }
+
+  //
+  // Binary search for the last extent starting at or before ClusterIndex
+  //
+  Low  = 0;
+  High = OFile->ExtentCount;
+  while (Low + 1 < High) {
+    Mid = (Low + High) / 2;
+    if (OFile->Extents[Mid].FileCluster <= ClusterIndex) {
+      Low = Mid;
+    } else {
+      High = Mid;
+    }
+  }
+
+  Extent = &OFile->Extents[Low];
+  ASSERT (ClusterIndex - Extent->FileCluster < Extent->Length);
+  *Cluster   = Extent->Cluster + (ClusterIndex - Extent->FileCluster);
+  *RunLength = Extent->FileCluster + Extent->Length - ClusterIndex;
+  return EFI_SUCCESS;
+}
+
 /**
 
   Seek OFile to requested position, and calculate the number of
@@ -568,6 +968,8 @@ FatOFilePosition (
   UINTN       Cluster;
   UINTN       StartPos;
   UINTN       Run;
+  UINTN       RunLength;
+  EFI_STATUS  Status;
 
   Volume      = OFile->Volume;
   ClusterSize = Volume->ClusterSize;
@@ -582,6 +984,37 @@ FatOFilePosition (
     OFile->PosDisk  = Volume->RootPos + Position;
     Run             = OFile->FileSize - Position;
   } else {
+    //
+    // Look the position up in the cluster chain map
+    //
+    StartPos  = Position & ~(ClusterSize - 1);
+    Status    = FatLookupExtent (
+                  OFile,
+                  Position >> Volume->ClusterAlignment,
+                  (Position >> Volume->ClusterAlignment) + (PosLimit >> Volume->ClusterAlignment) + 1,
+                  &Cluster,
+                  &RunLength
+                  );
+    if (!EFI_ERROR (Status)) {
+      OFile->PosDisk            = Volume->FirstClusterPos +
+                                  LShiftU64 (Cluster - FAT_MIN_CLUSTER, Volume->ClusterAlignment) +
+                                  Position - StartPos;
+      OFile->FileCurrentCluster = Cluster;
+      OFile->Position           = StartPos;
+
+      Run = StartPos + ClusterSize - Position;
+      if (RunLength > 1) {
+        Run += (UINTN) MIN (LShiftU64 (RunLength - 1, Volume->ClusterAlignment), PosLimit);
+      }
+
+      OFile->PosRem = Run;
+      return EFI_SUCCESS;
+    }
+
+    if (Status != EFI_OUT_OF_RESOURCES) {
+      return Status;
+    }
+
     //
     // Run the file's cluster chain to find the current position
     // If possible, run from the current cluster rather than
@@ -723,6 +1156,12 @@ FatComputeFreeInfo (
   // If we don't have valid info, compute it now
   //
   if (!Volume->FreeInfoValid) {
+    //
+    // Building the free cluster bitmap counts the free clusters as well
+    //
+    if (!EFI_ERROR (FatBuildFreeBitmap (Volume))) {
+      return;
+    }
 
     Volume->FreeInfoValid                        = TRUE;
     Volume->FatInfoSector.FreeInfo.ClusterCount  = 0;
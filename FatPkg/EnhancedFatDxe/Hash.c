@@ -14,7 +14,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
   @param  LongNameString        - The long name string to be hashed.
 
-  @return HashValue.
+  @return HashValue, to be masked with the size of the hash table.
 
 **/
 STATIC
@@ -33,7 +33,7 @@ FatHashLongName (
     );
   FatStrUpr (UpCasedLongFileName);
   gBS->CalculateCrc32 (UpCasedLongFileName, StrSize (UpCasedLongFileName), &HashValue);
-  return (HashValue & HASH_TABLE_MASK);
+  return HashValue;
 }
 
 /**
@@ -42,7 +42,7 @@ FatHashLongName (
 
   @param  ShortNameString       - The short name string to be hashed.
 
-  @return HashValue
+  @return HashValue, to be masked with the size of the hash table.
 
 **/
 STATIC
@@ -53,7 +53,124 @@ FatHashShortName (
 {
   UINT32  HashValue;
   gBS->CalculateCrc32 (ShortNameString, FAT_NAME_LEN, &HashValue);
-  return (HashValue & HASH_TABLE_MASK);
+  return HashValue;
+}
+
+/**
+
+  Allocate the long name and short name hash tables with TableSize buckets each.
+  Both tables share one allocation.
+
+  @param  TableSize             - The number of buckets in each table.
+
+  @return The long name table, followed by the short name table, or NULL.
+
+**/
+STATIC
+FAT_DIRENT **
+FatAllocateHashTable (
+  IN UINTN          TableSize
+  )
+{
+  return AllocateZeroPool (2 * TableSize * sizeof (FAT_DIRENT *));
+}
+
+/**
+
+  Double the size of the hash tables of the directory and rehash its entries.
+  The old tables are kept if there is not enough memory.
+
+  @param  ODir                  - The directory.
+
+**/
+STATIC
+VOID
+FatGrowHashTable (
+  IN FAT_ODIR       *ODir
+  )
+{
+  FAT_DIRENT  **LongNameHashTable;
+  FAT_DIRENT  **ShortNameHashTable;
+  FAT_DIRENT  *DirEnt;
+  UINTN       TableSize;
+  UINTN       Index;
+  UINT32      HashTableIndex;
+
+  TableSize         = ODir->HashTableSize * 2;
+  LongNameHashTable = FatAllocateHashTable (TableSize);
+  if (LongNameHashTable == NULL) {
+    return;
+  }
+
+  ShortNameHashTable = LongNameHashTable + TableSize;
+  for (Index = 0; Index < ODir->HashTableSize; Index++) {
+    while (ODir->ShortNameHashTable[Index] != NULL) {
+      DirEnt                            = ODir->ShortNameHashTable[Index];
+      ODir->ShortNameHashTable[Index]   = DirEnt->ShortNameForwardLink;
+      HashTableIndex                    = FatHashShortName (DirEnt->Entry.FileName) & (TableSize - 1);
+      DirEnt->ShortNameForwardLink      = ShortNameHashTable[HashTableIndex];
+      ShortNameHashTable[HashTableIndex] = DirEnt;
+    }
+
+    while (ODir->LongNameHashTable[Index] != NULL) {
+      DirEnt                            = ODir->LongNameHashTable[Index];
+      ODir->LongNameHashTable[Index]    = DirEnt->LongNameForwardLink;
+      HashTableIndex                    = FatHashLongName (DirEnt->FileString) & (TableSize - 1);
+      DirEnt->LongNameForwardLink       = LongNameHashTable[HashTableIndex];
+      LongNameHashTable[HashTableIndex] = DirEnt;
+    }
+  }
+
+  FatFreeHashTable (ODir);
+  ODir->LongNameHashTable   = LongNameHashTable;
+  ODir->ShortNameHashTable  = ShortNameHashTable;
+  ODir->HashTableSize       = TableSize;
+}
+
+/**
+
+  Allocate the hash tables of a newly created directory.
+
+  @param  ODir                  - The directory.
+
+  @retval EFI_SUCCESS           - The hash tables are allocated.
+  @retval EFI_OUT_OF_RESOURCES  - Not enough memory.
+
+**/
+EFI_STATUS
+FatInitializeHashTable (
+  IN FAT_ODIR       *ODir
+  )
+{
+  ODir->LongNameHashTable = FatAllocateHashTable (HASH_TABLE_MIN_SIZE);
+  if (ODir->LongNameHashTable == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  ODir->ShortNameHashTable  = ODir->LongNameHashTable + HASH_TABLE_MIN_SIZE;
+  ODir->HashTableSize       = HASH_TABLE_MIN_SIZE;
+  ODir->HashEntryCount      = 0;
+  ODir->DirEntSize          = 0;
+  return EFI_SUCCESS;
+}
+
+/**
+
+  Free the hash tables of a directory.
+
+  @param  ODir                  - The directory.
+
+**/
+VOID
+FatFreeHashTable (
+  IN FAT_ODIR       *ODir
+  )
+{
+  if (ODir->LongNameHashTable != NULL) {
+    FreePool (ODir->LongNameHashTable);
+    ODir->LongNameHashTable   = NULL;
+    ODir->ShortNameHashTable  = NULL;
+  }
 }
 
 /**
@@ -73,7 +190,7 @@ FatLongNameHashSearch (
   )
 {
   FAT_DIRENT  **PreviousHashNode;
-  for (PreviousHashNode   = &ODir->LongNameHashTable[FatHashLongName (LongNameString)];
+  for (PreviousHashNode   = &ODir->LongNameHashTable[FatHashLongName (LongNameString) & (ODir->HashTableSize - 1)];
        *PreviousHashNode != NULL;
        PreviousHashNode   = &(*PreviousHashNode)->LongNameForwardLink
       ) {
@@ -102,7 +219,7 @@ FatShortNameHashSearch (
   )
 {
   FAT_DIRENT  **PreviousHashNode;
-  for (PreviousHashNode   = &ODir->ShortNameHashTable[FatHashShortName (ShortNameString)];
+  for (PreviousHashNode   = &ODir->ShortNameHashTable[FatHashShortName (ShortNameString) & (ODir->HashTableSize - 1)];
        *PreviousHashNode != NULL;
        PreviousHashNode   = &(*PreviousHashNode)->ShortNameForwardLink
       ) {
@@ -134,17 +251,23 @@ FatInsertToHashTable (
   //
   // Insert hash table index for short name
   //
-  HashTableIndex                = FatHashShortName (DirEnt->Entry.FileName);
+  HashTableIndex                = FatHashShortName (DirEnt->Entry.FileName) & (ODir->HashTableSize - 1);
   HashTable                     = ODir->ShortNameHashTable;
   DirEnt->ShortNameForwardLink  = HashTable[HashTableIndex];
   HashTable[HashTableIndex]     = DirEnt;
   //
   // Insert hash table index for long name
   //
-  HashTableIndex                = FatHashLongName (DirEnt->FileString);
+  HashTableIndex                = FatHashLongName (DirEnt->FileString) & (ODir->HashTableSize - 1);
   HashTable                     = ODir->LongNameHashTable;
   DirEnt->LongNameForwardLink   = HashTable[HashTableIndex];
   HashTable[HashTableIndex]     = DirEnt;
+
+  ODir->HashEntryCount++;
+  ODir->DirEntSize += sizeof (FAT_DIRENT) + StrSize (DirEnt->FileString);
+  if (ODir->HashEntryCount > ODir->HashTableSize && ODir->HashTableSize < HASH_TABLE_MAX_SIZE) {
+    FatGrowHashTable (ODir);
+  }
 }
 
 /**
@@ -163,4 +286,7 @@ FatDeleteFromHashTable (
 {
   *FatShortNameHashSearch (ODir, DirEnt->Entry.FileName) = DirEnt->ShortNameForwardLink;
   *FatLongNameHashSearch (ODir, DirEnt->FileString)      = DirEnt->LongNameForwardLink;
+
+  ODir->HashEntryCount--;
+  ODir->DirEntSize -= sizeof (FAT_DIRENT) + StrSize (DirEnt->FileString);
 }
@@ -33,6 +33,7 @@ FatAllocateVolume (
 {
   EFI_STATUS  Status;
   FAT_VOLUME  *Volume;
+  UINTN       Index;
 
   //
   // Allocate a volume structure
@@ -54,8 +55,13 @@ FatAllocateVolume (
   Volume->ReadOnly                    = BlockIo->Media->ReadOnly;
   Volume->VolumeInterface.Revision    = EFI_SIMPLE_FILE_SYSTEM_PROTOCOL_REVISION;
   Volume->VolumeInterface.OpenVolume  = FatOpenVolume;
+  Volume->BulkReadInterface.Revision  = EDKII_FILE_BULK_READ_PROTOCOL_REVISION;
+  Volume->BulkReadInterface.ReadFile  = FatBulkReadFile;
   InitializeListHead (&Volume->CheckRef);
   InitializeListHead (&Volume->DirCacheList);
+  for (Index = 0; Index < FAT_DIR_CACHE_HASH_SIZE; Index++) {
+    InitializeListHead (&Volume->DirCacheHashTable[Index]);
+  }
   //
   // Initialize Root Directory entry
   //
@@ -82,6 +88,8 @@ FatAllocateVolume (
                   &Volume->Handle,
                   &gEfiSimpleFileSystemProtocolGuid,
                   &Volume->VolumeInterface,
+                  &gEdkiiFileBulkReadProtocolGuid,
+                  &Volume->BulkReadInterface,
                   NULL
                   );
   if (EFI_ERROR (Status)) {
@@ -127,6 +135,8 @@ FatAbandonVolume (
                     Volume->Handle,
                     &gEfiSimpleFileSystemProtocolGuid,
                     &Volume->VolumeInterface,
+                    &gEdkiiFileBulkReadProtocolGuid,
+                    &Volume->BulkReadInterface,
                     NULL
                     );
     if (EFI_ERROR (Status)) {
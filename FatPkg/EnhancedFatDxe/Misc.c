@@ -100,6 +100,9 @@ FatDestroySubtask (
   LIST_ENTRY          *Link;
 
   gBS->CloseEvent (Subtask->DiskIo2Token.Event);
+  if (Subtask->FreeBuffer) {
+    FreePool (Subtask->Buffer);
+  }
 
   Link = RemoveEntryList (&Subtask->Link);
   FreePool (Subtask);
@@ -465,6 +468,12 @@ FatFreeVolume (
     FreePool (Volume->CacheBuffer);
   }
   //
+  // Free the free cluster bitmap
+  //
+  if (Volume->FreeBitmap != NULL) {
+    FreePool (Volume->FreeBitmap);
+  }
+  //
   // Free directory cache
   //
   FatCleanupODirCache (Volume);
@@ -361,6 +361,82 @@ FatRead (
   return FatIFileAccess (FHand, ReadData, BufferSize, Buffer, NULL);
 }
 
+/**
+
+  Read the whole contents of an open file into the caller's buffer.
+
+  The file is read with a single FatAccessOFile () call, so every run of
+  contiguous clusters reaches the disk as one request, straight into Buffer.
+  The file position of File is not changed.
+
+  @param  This                  - The EDKII_FILE_BULK_READ_PROTOCOL instance of the volume.
+  @param  File                  - The handle of the file.
+  @param  BufferSize            - Size of Buffer on input, bytes read on output.
+  @param  Buffer                - Buffer receiving the file contents.
+
+  @retval EFI_SUCCESS           - The file was read successfully.
+  @retval EFI_BUFFER_TOO_SMALL  - Buffer is smaller than the file.
+  @retval EFI_INVALID_PARAMETER - File does not belong to this volume or is a directory.
+  @return other                 - An error occurred when reading the file.
+
+**/
+EFI_STATUS
+EFIAPI
+FatBulkReadFile (
+  IN     EDKII_FILE_BULK_READ_PROTOCOL  *This,
+  IN     EFI_FILE_PROTOCOL              *File,
+  IN OUT UINTN                          *BufferSize,
+     OUT VOID                           *Buffer
+  )
+{
+  EFI_STATUS  Status;
+  FAT_IFILE   *IFile;
+  FAT_OFILE   *OFile;
+  FAT_VOLUME  *Volume;
+
+  if (File == NULL || BufferSize == NULL || (Buffer == NULL && *BufferSize != 0)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  //
+  // Only files opened on this driver can be read
+  //
+  if (File->Read != FatRead) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Volume = VOLUME_FROM_BULK_READ (This);
+  IFile  = IFILE_FROM_FHAND (File);
+  OFile  = IFile->OFile;
+  if (OFile->Volume != Volume || OFile->ODir != NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (OFile->Error == EFI_NOT_FOUND) {
+    return EFI_DEVICE_ERROR;
+  }
+
+  FatWaitNonblockingTask (IFile);
+  FatAcquireLock ();
+
+  Status = OFile->Error;
+  if (!EFI_ERROR (Status)) {
+    if (*BufferSize < OFile->FileSize) {
+      *BufferSize = OFile->FileSize;
+      Status      = EFI_BUFFER_TOO_SMALL;
+    } else {
+      *BufferSize = OFile->FileSize;
+      Status      = FatAccessOFile (OFile, ReadData, 0, BufferSize, Buffer, NULL);
+      if (EFI_ERROR (Status)) {
+        Status = FatCleanupVolume (Volume, OFile, Status, NULL);
+      }
+    }
+  }
+
+  FatReleaseLock ();
+  return Status;
+}
+
 /**
 
   Get the file info.
@@ -435,6 +511,71 @@ FatWriteEx (
   return FatIFileAccess (FHand, WriteData, &Token->BufferSize, Token->Buffer, Token);
 }
 
+/**
+
+  Track sequential reads of the OFile. When a file is read sequentially in pieces
+  smaller than a data cache page, prefetch the data following the current position
+  into the data cache. The readahead window doubles on each sequential read, and
+  is reset by any non-sequential access.
+
+  @param  OFile                 - The open file.
+  @param  StartPosition         - The position where the read started.
+  @param  EndPosition           - The position where the read ended.
+
+**/
+STATIC
+VOID
+FatOFileReadAhead (
+  IN FAT_OFILE          *OFile,
+  IN UINTN              StartPosition,
+  IN UINTN              EndPosition
+  )
+{
+  FAT_VOLUME  *Volume;
+  UINTN       PageSize;
+  UINTN       Length;
+  EFI_STATUS  Status;
+
+  Volume   = OFile->Volume;
+  PageSize = (UINTN)1 << Volume->DiskCache[CacheData].PageAlignment;
+
+  if (StartPosition != OFile->ReadAheadPos) {
+    OFile->ReadAheadPos   = EndPosition;
+    OFile->ReadAheadEnd   = EndPosition;
+    OFile->ReadAheadPages = 0;
+    return;
+  }
+
+  OFile->ReadAheadPos = EndPosition;
+  //
+  // Reads of a page or more go to the disk directly, and there is nothing
+  // to prefetch past the end of file or while the window is still ahead.
+  //
+  if (EndPosition - StartPosition >= PageSize || EndPosition >= OFile->FileSize ||
+      EndPosition + PageSize <= OFile->ReadAheadEnd) {
+    return;
+  }
+
+  if (OFile->ReadAheadPages == 0) {
+    OFile->ReadAheadPages = FAT_READAHEAD_MIN_PAGES;
+  } else if (OFile->ReadAheadPages < FAT_READAHEAD_MAX_PAGES) {
+    OFile->ReadAheadPages *= 2;
+  }
+
+  Length = MIN (OFile->ReadAheadPages * PageSize, OFile->FileSize - EndPosition);
+  Status = FatOFilePosition (OFile, EndPosition, Length);
+  if (EFI_ERROR (Status)) {
+    return;
+  }
+
+  //
+  // Only the current run of contiguous clusters can be read in one request
+  //
+  Length = MIN (Length, OFile->PosRem);
+  FatReadAheadCache (Volume, OFile->PosDisk, Length);
+  OFile->ReadAheadEnd = EndPosition + Length;
+}
+
 /**
 
   This function reads data from a file or writes data to a file.
@@ -507,6 +648,12 @@ FatAccessOFile (
     ASSERT (Position <= OFile->FileSize);
   }
   //
+  // Prefetch ahead of synchronous sequential reads
+  //
+  if (!EFI_ERROR (Status) && IoMode == ReadData && Task == NULL) {
+    FatOFileReadAhead (OFile, Position - (*DataBufferSize - BufferSize), Position);
+  }
+  //
   // Update the number of bytes accessed
   //
   *DataBufferSize -= BufferSize;
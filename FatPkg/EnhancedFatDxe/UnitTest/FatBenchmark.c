@@ -0,0 +1,592 @@
+/** @file
+  Host-based micro-benchmarks for EnhancedFatDxe.
+
+  The driver is run over a RAM disk formatted as FAT16. Each benchmark checks
+  the results of the file operations it times, and prints one line of the
+  form
+
+    FATBENCH {"name":"<Name>","operations":<N>,"microseconds":<T>,"diskreads":<R>,"diskwrites":<W>}
+
+  so that the results can be collected by scripts and compared across
+  changes to, for instance, DiskCache.c, Hash.c or FileSpace.c. The times are
+  processor times, which are the relevant ones since the disk is in memory.
+
+  Copyright (c) 2021, EDK II contributors. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <time.h>
+
+#include "FatHostServices.h"
+#include <Library/PrintLib.h>
+#include <Library/UnitTestLib.h>
+
+#define UNIT_TEST_NAME        "EnhancedFatDxe Benchmarks"
+#define UNIT_TEST_VERSION     "1.0"
+
+//
+// Geometry of the FAT16 RAM disk: 32MB, 512-byte sectors, 2KB clusters.
+//
+#define BENCH_DISK_SIZE             SIZE_32MB
+#define BENCH_SECTOR_SIZE           512
+#define BENCH_SECTORS_PER_CLUSTER   4
+#define BENCH_ROOT_ENTRIES          512
+#define BENCH_SECTORS_PER_FAT       64
+
+//
+// Benchmark sizes, chosen so that the whole suite runs in a few seconds.
+//
+#define BENCH_DIRECTORY_FILES       1024
+#define BENCH_LOOKUPS               8192
+#define BENCH_FILE_SIZE             SIZE_8MB
+#define BENCH_IO_SIZE               SIZE_64KB
+#define BENCH_CHURN_FILES           1024
+#define BENCH_FLUSHES               512
+
+typedef struct {
+  FAT_HOST_RAM_DISK   *RamDisk;
+  EFI_FILE_PROTOCOL   *Root;
+  UINT8               *Buffer;
+} BENCH_CONTEXT;
+
+typedef struct {
+  clock_t   Start;
+  UINTN     DiskReads;
+  UINTN     DiskWrites;
+} BENCH_TIMER;
+
+STATIC BENCH_CONTEXT  mBench;
+
+/**
+  Write a FAT16 file system with an empty root directory to the RAM disk.
+
+  @param[in]  RamDisk   The RAM disk to format.
+**/
+STATIC
+VOID
+FormatRamDisk (
+  IN FAT_HOST_RAM_DISK  *RamDisk
+  )
+{
+  FAT_BOOT_SECTOR  *BootSector;
+  UINT16           *Fat;
+  UINTN            Index;
+
+  ZeroMem (RamDisk->Data, (UINTN)RamDisk->Size);
+
+  BootSector = (FAT_BOOT_SECTOR *)RamDisk->Data;
+  BootSector->FatBsb.Ia32Jump[0]       = 0xEB;
+  BootSector->FatBsb.Ia32Jump[1]       = 0x3C;
+  BootSector->FatBsb.Ia32Jump[2]       = 0x90;
+  CopyMem (BootSector->FatBsb.OemId, "EDK2    ", 8);
+  BootSector->FatBsb.SectorSize        = BENCH_SECTOR_SIZE;
+  BootSector->FatBsb.SectorsPerCluster = BENCH_SECTORS_PER_CLUSTER;
+  BootSector->FatBsb.ReservedSectors   = 1;
+  BootSector->FatBsb.NumFats           = 2;
+  BootSector->FatBsb.RootEntries       = BENCH_ROOT_ENTRIES;
+  BootSector->FatBsb.Media             = 0xF8;
+  BootSector->FatBsb.SectorsPerFat     = BENCH_SECTORS_PER_FAT;
+  BootSector->FatBsb.LargeSectors      = (UINT32)(RamDisk->Size / BENCH_SECTOR_SIZE);
+  BootSector->FatBse.FatBse.Signature  = 0x29;
+  CopyMem (BootSector->FatBse.FatBse.FatLabel, "NO NAME    ", 11);
+  CopyMem (BootSector->FatBse.FatBse.SystemId, "FAT16   ", 8);
+  RamDisk->Data[510] = 0x55;
+  RamDisk->Data[511] = 0xAA;
+
+  //
+  // The first two FAT entries hold the media byte and the clean flags.
+  //
+  for (Index = 0; Index < 2; Index++) {
+    Fat    = (UINT16 *)(RamDisk->Data + (1 + Index * BENCH_SECTORS_PER_FAT) * BENCH_SECTOR_SIZE);
+    Fat[0] = 0xFFF8;
+    Fat[1] = 0xFFFF;
+  }
+}
+
+/**
+  Start timing a benchmark.
+
+  @param[out] Timer   The timer to start.
+**/
+STATIC
+VOID
+StartTimer (
+  OUT BENCH_TIMER  *Timer
+  )
+{
+  Timer->DiskReads  = mBench.RamDisk->ReadCount;
+  Timer->DiskWrites = mBench.RamDisk->WriteCount;
+  Timer->Start      = clock ();
+}
+
+/**
+  Stop timing a benchmark and print its machine-readable result line.
+
+  @param[in]  Timer       The timer started by StartTimer().
+  @param[in]  Name        The name of the benchmark.
+  @param[in]  Operations  The number of operations timed.
+**/
+STATIC
+VOID
+StopTimer (
+  IN CONST BENCH_TIMER  *Timer,
+  IN CONST CHAR8        *Name,
+  IN UINTN              Operations
+  )
+{
+  clock_t  End;
+
+  End = clock ();
+  printf (
+    "FATBENCH {\"name\":\"%s\",\"operations\":%llu,\"microseconds\":%llu,"
+    "\"diskreads\":%llu,\"diskwrites\":%llu}\n",
+    Name,
+    (unsigned long long)Operations,
+    (unsigned long long)(End - Timer->Start) * 1000000ULL / CLOCKS_PER_SEC,
+    (unsigned long long)(mBench.RamDisk->ReadCount - Timer->DiskReads),
+    (unsigned long long)(mBench.RamDisk->WriteCount - Timer->DiskWrites)
+    );
+}
+
+/**
+  Format a fresh RAM disk and mount it with the driver.
+
+  @param[in]  Context   Unused.
+
+  @retval UNIT_TEST_PASSED                      The file system is mounted.
+  @retval UNIT_TEST_ERROR_PREREQUISITE_NOT_MET  The file system could not be
+                                                mounted.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+MountRamDisk (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EFI_STATUS                       Status;
+  EFI_SIMPLE_FILE_SYSTEM_PROTOCOL  *SimpleFileSystem;
+
+  FatHostInitializeServices ();
+
+  mBench.RamDisk = FatHostCreateRamDisk (BENCH_DISK_SIZE, BENCH_SECTOR_SIZE);
+  mBench.Buffer  = AllocatePool (BENCH_IO_SIZE);
+  if (mBench.RamDisk == NULL || mBench.Buffer == NULL) {
+    return UNIT_TEST_ERROR_PREREQUISITE_NOT_MET;
+  }
+  FormatRamDisk (mBench.RamDisk);
+
+  Status = FatAllocateVolume (
+             (EFI_HANDLE)mBench.RamDisk,
+             &mBench.RamDisk->DiskIo,
+             NULL,
+             &mBench.RamDisk->BlockIo
+             );
+  if (EFI_ERROR (Status)) {
+    return UNIT_TEST_ERROR_PREREQUISITE_NOT_MET;
+  }
+
+  SimpleFileSystem = FatHostGetSimpleFileSystem ();
+  Status = SimpleFileSystem->OpenVolume (SimpleFileSystem, &mBench.Root);
+  if (EFI_ERROR (Status)) {
+    return UNIT_TEST_ERROR_PREREQUISITE_NOT_MET;
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Unmount the RAM disk and free it.
+
+  @param[in]  Context   Unused.
+**/
+STATIC
+VOID
+EFIAPI
+UnmountRamDisk (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EFI_SIMPLE_FILE_SYSTEM_PROTOCOL  *SimpleFileSystem;
+  FAT_VOLUME                       *Volume;
+
+  if (mBench.Root != NULL) {
+    mBench.Root->Close (mBench.Root);
+  }
+
+  SimpleFileSystem = FatHostGetSimpleFileSystem ();
+  if (SimpleFileSystem != NULL) {
+    Volume = VOLUME_FROM_VOL_INTERFACE (SimpleFileSystem);
+    FatAbandonVolume (Volume);
+  }
+
+  if (mBench.RamDisk != NULL) {
+    FatHostFreeRamDisk (mBench.RamDisk);
+  }
+  if (mBench.Buffer != NULL) {
+    FreePool (mBench.Buffer);
+  }
+  ZeroMem (&mBench, sizeof (mBench));
+}
+
+/**
+  Create, or open, a file or directory.
+
+  @param[in]  Parent      The directory to open the file in.
+  @param[in]  Name        The name of the file.
+  @param[in]  Attributes  EFI_FILE_DIRECTORY to create a directory.
+  @param[out] File        The opened file.
+
+  @return The status returned by EFI_FILE_PROTOCOL.Open().
+**/
+STATIC
+EFI_STATUS
+CreateFile (
+  IN  EFI_FILE_PROTOCOL  *Parent,
+  IN  CHAR16             *Name,
+  IN  UINT64             Attributes,
+  OUT EFI_FILE_PROTOCOL  **File
+  )
+{
+  return Parent->Open (
+                   Parent,
+                   File,
+                   Name,
+                   EFI_FILE_MODE_CREATE | EFI_FILE_MODE_READ | EFI_FILE_MODE_WRITE,
+                   Attributes
+                   );
+}
+
+/**
+  Fill the I/O buffer with a pattern depending on the file offset.
+
+  @param[in]  Offset  The file offset of the buffer.
+**/
+STATIC
+VOID
+FillBuffer (
+  IN UINT64  Offset
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < BENCH_IO_SIZE; Index += sizeof (UINT64)) {
+    *(UINT64 *)(mBench.Buffer + Index) = Offset + Index;
+  }
+}
+
+/**
+  Create many files with long names in one directory, then open them by name
+  in a pseudo-random order.
+
+  @param[in]  Context   Unused.
+
+  @retval UNIT_TEST_PASSED              All the files were created and found.
+  @retval UNIT_TEST_ERROR_TEST_FAILED   A file operation failed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+LargeDirectoryLookup (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EFI_STATUS         Status;
+  EFI_FILE_PROTOCOL  *Directory;
+  EFI_FILE_PROTOCOL  *File;
+  CHAR16             Name[64];
+  BENCH_TIMER        Timer;
+  UINTN              Index;
+  UINT32             Random;
+
+  Status = CreateFile (mBench.Root, L"LargeDirectory", EFI_FILE_DIRECTORY, &Directory);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+
+  StartTimer (&Timer);
+  for (Index = 0; Index < BENCH_DIRECTORY_FILES; Index++) {
+    UnicodeSPrint (Name, sizeof (Name), L"Benchmark file number %04u.txt", Index);
+    Status = CreateFile (Directory, Name, 0, &File);
+    UT_ASSERT_NOT_EFI_ERROR (Status);
+    File->Close (File);
+  }
+  StopTimer (&Timer, "CreateInLargeDirectory", BENCH_DIRECTORY_FILES);
+
+  Random = 1;
+  StartTimer (&Timer);
+  for (Index = 0; Index < BENCH_LOOKUPS; Index++) {
+    Random = Random * 1103515245 + 12345;
+    UnicodeSPrint (Name, sizeof (Name), L"BENCHMARK FILE NUMBER %04u.TXT",
+      (Random >> 16) % BENCH_DIRECTORY_FILES);
+    Status = Directory->Open (Directory, &File, Name, EFI_FILE_MODE_READ, 0);
+    UT_ASSERT_NOT_EFI_ERROR (Status);
+    File->Close (File);
+  }
+  StopTimer (&Timer, "OpenInLargeDirectory", BENCH_LOOKUPS);
+
+  StartTimer (&Timer);
+  for (Index = 0; Index < BENCH_LOOKUPS; Index++) {
+    UnicodeSPrint (Name, sizeof (Name), L"Missing file number %04u.txt", Index);
+    Status = Directory->Open (Directory, &File, Name, EFI_FILE_MODE_READ, 0);
+    UT_ASSERT_STATUS_EQUAL (Status, EFI_NOT_FOUND);
+  }
+  StopTimer (&Timer, "MissInLargeDirectory", BENCH_LOOKUPS);
+
+  Directory->Close (Directory);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Write a large file sequentially, flush it, then read it back and check its
+  contents.
+
+  @param[in]  Context   Unused.
+
+  @retval UNIT_TEST_PASSED              The file was written and read back.
+  @retval UNIT_TEST_ERROR_TEST_FAILED   A file operation failed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+SequentialReadWrite (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EFI_STATUS         Status;
+  EFI_FILE_PROTOCOL  *File;
+  BENCH_TIMER        Timer;
+  UINT64             Offset;
+  UINTN              Size;
+
+  Status = CreateFile (mBench.Root, L"Sequential.bin", 0, &File);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+
+  StartTimer (&Timer);
+  for (Offset = 0; Offset < BENCH_FILE_SIZE; Offset += BENCH_IO_SIZE) {
+    FillBuffer (Offset);
+    Size   = BENCH_IO_SIZE;
+    Status = File->Write (File, &Size, mBench.Buffer);
+    UT_ASSERT_NOT_EFI_ERROR (Status);
+    UT_ASSERT_EQUAL (Size, BENCH_IO_SIZE);
+  }
+  Status = File->Flush (File);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+  StopTimer (&Timer, "SequentialWrite", BENCH_FILE_SIZE / BENCH_IO_SIZE);
+
+  Status = File->SetPosition (File, 0);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+
+  StartTimer (&Timer);
+  for (Offset = 0; Offset < BENCH_FILE_SIZE; Offset += BENCH_IO_SIZE) {
+    Size   = BENCH_IO_SIZE;
+    Status = File->Read (File, &Size, mBench.Buffer);
+    UT_ASSERT_NOT_EFI_ERROR (Status);
+    UT_ASSERT_EQUAL (Size, BENCH_IO_SIZE);
+    UT_ASSERT_EQUAL (*(UINT64 *)mBench.Buffer, Offset);
+    UT_ASSERT_EQUAL (*(UINT64 *)(mBench.Buffer + BENCH_IO_SIZE - sizeof (UINT64)),
+      Offset + BENCH_IO_SIZE - sizeof (UINT64));
+  }
+  StopTimer (&Timer, "SequentialRead", BENCH_FILE_SIZE / BENCH_IO_SIZE);
+
+  Status = File->Delete (File);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Repeatedly create a small file, write it, close it and delete it again.
+
+  @param[in]  Context   Unused.
+
+  @retval UNIT_TEST_PASSED              All the files were created and deleted.
+  @retval UNIT_TEST_ERROR_TEST_FAILED   A file operation failed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+CreateDeleteChurn (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EFI_STATUS         Status;
+  EFI_FILE_PROTOCOL  *Directory;
+  EFI_FILE_PROTOCOL  *File;
+  CHAR16             Name[64];
+  BENCH_TIMER        Timer;
+  UINTN              Index;
+  UINTN              Size;
+
+  Status = CreateFile (mBench.Root, L"Churn", EFI_FILE_DIRECTORY, &Directory);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+
+  FillBuffer (0);
+  StartTimer (&Timer);
+  for (Index = 0; Index < BENCH_CHURN_FILES; Index++) {
+    UnicodeSPrint (Name, sizeof (Name), L"Temporary file %u.tmp", Index);
+    Status = CreateFile (Directory, Name, 0, &File);
+    UT_ASSERT_NOT_EFI_ERROR (Status);
+
+    Size   = SIZE_4KB;
+    Status = File->Write (File, &Size, mBench.Buffer);
+    UT_ASSERT_NOT_EFI_ERROR (Status);
+
+    Status = File->Delete (File);
+    UT_ASSERT_NOT_EFI_ERROR (Status);
+  }
+  StopTimer (&Timer, "CreateDeleteChurn", BENCH_CHURN_FILES);
+
+  Status = Directory->Open (Directory, &File, L"Temporary file 0.tmp", EFI_FILE_MODE_READ, 0);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_NOT_FOUND);
+
+  Directory->Close (Directory);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Append small records to a file, flushing it after each one.
+
+  @param[in]  Context   Unused.
+
+  @retval UNIT_TEST_PASSED              All the records were written.
+  @retval UNIT_TEST_ERROR_TEST_FAILED   A file operation failed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+AppendAndFlush (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EFI_STATUS         Status;
+  EFI_FILE_PROTOCOL  *File;
+  EFI_FILE_INFO      *Info;
+  UINTN              InfoSize;
+  BENCH_TIMER        Timer;
+  UINTN              Index;
+  UINTN              Size;
+
+  Status = CreateFile (mBench.Root, L"Journal.log", 0, &File);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+
+  FillBuffer (0);
+  StartTimer (&Timer);
+  for (Index = 0; Index < BENCH_FLUSHES; Index++) {
+    Size   = 128;
+    Status = File->Write (File, &Size, mBench.Buffer);
+    UT_ASSERT_NOT_EFI_ERROR (Status);
+
+    Status = File->Flush (File);
+    UT_ASSERT_NOT_EFI_ERROR (Status);
+  }
+  StopTimer (&Timer, "AppendAndFlush", BENCH_FLUSHES);
+
+  InfoSize = BENCH_IO_SIZE;
+  Info     = (EFI_FILE_INFO *)mBench.Buffer;
+  Status   = File->GetInfo (File, &gEfiFileInfoGuid, &InfoSize, Info);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+  UT_ASSERT_EQUAL (Info->FileSize, BENCH_FLUSHES * 128);
+
+  File->Close (File);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Main entry point to this unit test application.
+
+  Sets up and runs the test suites.
+**/
+VOID
+EFIAPI
+UnitTestMain (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      BenchmarkSuite;
+
+  Framework = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_NAME, UNIT_TEST_VERSION));
+
+  //
+  // Start setting up the test framework for running the tests.
+  //
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_NAME, gEfiCallerBaseName, UNIT_TEST_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  Status = CreateUnitTestSuite (
+             &BenchmarkSuite, Framework,
+             "EnhancedFatDxe Benchmarks", "FatPkg.EnhancedFatDxe.Benchmark", NULL, NULL
+             );
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for BenchmarkSuite\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+  AddTestCase (
+    BenchmarkSuite,
+    "Create and open files in a large directory", "LargeDirectoryLookup",
+    LargeDirectoryLookup, MountRamDisk, UnmountRamDisk, NULL
+    );
+  AddTestCase (
+    BenchmarkSuite,
+    "Write and read a large file sequentially", "SequentialReadWrite",
+    SequentialReadWrite, MountRamDisk, UnmountRamDisk, NULL
+    );
+  AddTestCase (
+    BenchmarkSuite,
+    "Create and delete small files", "CreateDeleteChurn",
+    CreateDeleteChurn, MountRamDisk, UnmountRamDisk, NULL
+    );
+  AddTestCase (
+    BenchmarkSuite,
+    "Append to a file and flush it", "AppendAndFlush",
+    AppendAndFlush, MountRamDisk, UnmountRamDisk, NULL
+    );
+
+  //
+  // Execute the tests.
+  //
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  if (Framework != NULL) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  return;
+}
+
+///
+/// Avoid ECC error for function name that starts with lower case letter
+///
+#define Main main
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+
+  @param[in] Argc  Number of arguments
+  @param[in] Argv  Array of pointers to arguments
+
+  @retval 0      Success
+  @retval other  Error
+**/
+INT32
+Main (
+  IN INT32  Argc,
+  IN CHAR8  *Argv[]
+  )
+{
+  UnitTestMain ();
+  return 0;
+}
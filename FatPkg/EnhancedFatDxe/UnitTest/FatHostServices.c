@@ -0,0 +1,586 @@
+/** @file
+  Host implementations of the firmware services used by EnhancedFatDxe.
+
+  Only the services the driver calls on its file system paths are
+  implemented. Events are not supported, so the driver only sees the
+  synchronous EFI_DISK_IO_PROTOCOL of the RAM disk.
+
+  Copyright (c) 2021, EDK II contributors. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "FatHostServices.h"
+
+EFI_BOOT_SERVICES     *gBS;
+EFI_RUNTIME_SERVICES  *gRT;
+
+//
+// Defined in UnicodeCollation.c.
+//
+extern EFI_UNICODE_COLLATION_PROTOCOL  *mUnicodeCollationInterface;
+
+STATIC EFI_BOOT_SERVICES                mHostBootServices;
+STATIC EFI_RUNTIME_SERVICES             mHostRuntimeServices;
+STATIC EFI_SIMPLE_FILE_SYSTEM_PROTOCOL  *mHostSimpleFileSystem;
+STATIC EFI_TPL                          mHostTpl = TPL_APPLICATION;
+
+//
+// Characters other than letters that are valid in short file names.
+//
+STATIC CONST CHAR16  mHostFatChars[] = L"0123456789\\._^$~!#%&-{}()@'`";
+
+//
+// Boot services.
+//
+
+STATIC
+EFI_STATUS
+EFIAPI
+HostCalculateCrc32 (
+  IN  VOID    *Data,
+  IN  UINTN   DataSize,
+  OUT UINT32  *Crc32
+  )
+{
+  *Crc32 = CalculateCrc32 (Data, DataSize);
+  return EFI_SUCCESS;
+}
+
+STATIC
+EFI_STATUS
+EFIAPI
+HostGetMemoryMap (
+  IN OUT UINTN                  *MemoryMapSize,
+  OUT    EFI_MEMORY_DESCRIPTOR  *MemoryMap,
+  OUT    UINTN                  *MapKey,
+  OUT    UINTN                  *DescriptorSize,
+  OUT    UINT32                 *DescriptorVersion
+  )
+{
+  return EFI_UNSUPPORTED;
+}
+
+STATIC
+EFI_STATUS
+EFIAPI
+HostInstallMultipleProtocolInterfaces (
+  IN OUT EFI_HANDLE  *Handle,
+  ...
+  )
+{
+  VA_LIST   Args;
+  EFI_GUID  *Protocol;
+  VOID      *Interface;
+
+  VA_START (Args, Handle);
+  for (Protocol = VA_ARG (Args, EFI_GUID *);
+       Protocol != NULL;
+       Protocol = VA_ARG (Args, EFI_GUID *)) {
+    Interface = VA_ARG (Args, VOID *);
+    if (CompareGuid (Protocol, &gEfiSimpleFileSystemProtocolGuid)) {
+      mHostSimpleFileSystem = Interface;
+    }
+  }
+  VA_END (Args);
+
+  return EFI_SUCCESS;
+}
+
+STATIC
+EFI_STATUS
+EFIAPI
+HostUninstallMultipleProtocolInterfaces (
+  IN EFI_HANDLE  Handle,
+  ...
+  )
+{
+  mHostSimpleFileSystem = NULL;
+  return EFI_SUCCESS;
+}
+
+STATIC
+EFI_STATUS
+EFIAPI
+HostCreateEvent (
+  IN  UINT32            Type,
+  IN  EFI_TPL           NotifyTpl,
+  IN  EFI_EVENT_NOTIFY  NotifyFunction,
+  IN  VOID              *NotifyContext,
+  OUT EFI_EVENT         *Event
+  )
+{
+  return EFI_UNSUPPORTED;
+}
+
+STATIC
+EFI_STATUS
+EFIAPI
+HostEvent (
+  IN EFI_EVENT  Event
+  )
+{
+  return EFI_INVALID_PARAMETER;
+}
+
+STATIC
+EFI_STATUS
+EFIAPI
+HostLocateHandleBuffer (
+  IN     EFI_LOCATE_SEARCH_TYPE  SearchType,
+  IN     EFI_GUID                *Protocol,
+  IN     VOID                    *SearchKey,
+  OUT    UINTN                   *NoHandles,
+  OUT    EFI_HANDLE              **Buffer
+  )
+{
+  return EFI_NOT_FOUND;
+}
+
+//
+// Runtime services.
+//
+
+STATIC
+EFI_STATUS
+EFIAPI
+HostGetTime (
+  OUT EFI_TIME               *Time,
+  OUT EFI_TIME_CAPABILITIES  *Capabilities
+  )
+{
+  ZeroMem (Time, sizeof (*Time));
+  Time->Year     = 2021;
+  Time->Month    = 1;
+  Time->Day      = 1;
+  Time->TimeZone = EFI_UNSPECIFIED_TIMEZONE;
+  return EFI_SUCCESS;
+}
+
+//
+// UefiLib services.
+//
+
+EFI_TPL
+EFIAPI
+EfiGetCurrentTpl (
+  VOID
+  )
+{
+  return mHostTpl;
+}
+
+VOID
+EFIAPI
+EfiAcquireLock (
+  IN EFI_LOCK  *Lock
+  )
+{
+  ASSERT (Lock->Lock == EfiLockReleased);
+  Lock->OwnerTpl = mHostTpl;
+  mHostTpl       = Lock->Tpl;
+  Lock->Lock     = EfiLockAcquired;
+}
+
+EFI_STATUS
+EFIAPI
+EfiAcquireLockOrFail (
+  IN EFI_LOCK  *Lock
+  )
+{
+  if (Lock->Lock == EfiLockAcquired) {
+    return EFI_ACCESS_DENIED;
+  }
+  EfiAcquireLock (Lock);
+  return EFI_SUCCESS;
+}
+
+VOID
+EFIAPI
+EfiReleaseLock (
+  IN EFI_LOCK  *Lock
+  )
+{
+  ASSERT (Lock->Lock == EfiLockAcquired);
+  Lock->Lock = EfiLockReleased;
+  mHostTpl   = Lock->OwnerTpl;
+}
+
+EFI_STATUS
+EFIAPI
+GetEfiGlobalVariable2 (
+  IN CONST CHAR16  *Name,
+  OUT VOID         **Value,
+  OUT UINTN        *Size OPTIONAL
+  )
+{
+  *Value = NULL;
+  return EFI_NOT_FOUND;
+}
+
+CHAR8 *
+EFIAPI
+GetBestLanguage (
+  IN CONST CHAR8  *SupportedLanguages,
+  IN UINTN        Iso639Language,
+  ...
+  )
+{
+  return NULL;
+}
+
+//
+// Unicode Collation protocol, for English only.
+//
+
+STATIC
+CHAR16
+HostToUpper (
+  IN CHAR16  Char
+  )
+{
+  return (Char >= L'a' && Char <= L'z') ? (CHAR16)(Char - L'a' + L'A') : Char;
+}
+
+STATIC
+BOOLEAN
+HostIsFatChar (
+  IN CHAR16  Char
+  )
+{
+  CONST CHAR16  *Valid;
+
+  if (Char >= L'A' && Char <= L'Z') {
+    return TRUE;
+  }
+  for (Valid = mHostFatChars; *Valid != 0; Valid++) {
+    if (*Valid == Char) {
+      return TRUE;
+    }
+  }
+  return FALSE;
+}
+
+STATIC
+INTN
+EFIAPI
+HostStriColl (
+  IN EFI_UNICODE_COLLATION_PROTOCOL  *This,
+  IN CHAR16                          *Str1,
+  IN CHAR16                          *Str2
+  )
+{
+  while (*Str1 != 0 && HostToUpper (*Str1) == HostToUpper (*Str2)) {
+    Str1++;
+    Str2++;
+  }
+  return HostToUpper (*Str1) - HostToUpper (*Str2);
+}
+
+STATIC
+VOID
+EFIAPI
+HostStrLwr (
+  IN     EFI_UNICODE_COLLATION_PROTOCOL  *This,
+  IN OUT CHAR16                          *Str
+  )
+{
+  for (; *Str != 0; Str++) {
+    if (*Str >= L'A' && *Str <= L'Z') {
+      *Str = (CHAR16)(*Str - L'A' + L'a');
+    }
+  }
+}
+
+STATIC
+VOID
+EFIAPI
+HostStrUpr (
+  IN     EFI_UNICODE_COLLATION_PROTOCOL  *This,
+  IN OUT CHAR16                          *Str
+  )
+{
+  for (; *Str != 0; Str++) {
+    *Str = HostToUpper (*Str);
+  }
+}
+
+STATIC
+VOID
+EFIAPI
+HostFatToStr (
+  IN  EFI_UNICODE_COLLATION_PROTOCOL  *This,
+  IN  UINTN                           FatSize,
+  IN  CHAR8                           *Fat,
+  OUT CHAR16                          *String
+  )
+{
+  while (*Fat != 0 && FatSize != 0) {
+    *String++ = *Fat++;
+    FatSize--;
+  }
+  *String = 0;
+}
+
+STATIC
+BOOLEAN
+EFIAPI
+HostStrToFat (
+  IN  EFI_UNICODE_COLLATION_PROTOCOL  *This,
+  IN  CHAR16                          *String,
+  IN  UINTN                           FatSize,
+  OUT CHAR8                           *Fat
+  )
+{
+  BOOLEAN  SpecialCharExist;
+  CHAR16   Char;
+
+  SpecialCharExist = FALSE;
+  for (; *String != 0 && FatSize != 0; String++) {
+    if (*String == L'.' || *String == L' ') {
+      continue;
+    }
+
+    Char = HostToUpper (*String);
+    if (HostIsFatChar (Char)) {
+      *Fat = (CHAR8)Char;
+    } else {
+      *Fat             = '_';
+      SpecialCharExist = TRUE;
+    }
+    Fat++;
+    FatSize--;
+  }
+  return SpecialCharExist;
+}
+
+STATIC EFI_UNICODE_COLLATION_PROTOCOL  mHostUnicodeCollation = {
+  HostStriColl,
+  NULL,
+  HostStrLwr,
+  HostStrUpr,
+  HostFatToStr,
+  HostStrToFat,
+  "en"
+};
+
+//
+// RAM disk.
+//
+
+STATIC
+EFI_STATUS
+EFIAPI
+RamDiskReset (
+  IN EFI_BLOCK_IO_PROTOCOL  *This,
+  IN BOOLEAN                ExtendedVerification
+  )
+{
+  return EFI_SUCCESS;
+}
+
+STATIC
+EFI_STATUS
+RamDiskAccess (
+  IN     FAT_HOST_RAM_DISK  *RamDisk,
+  IN     BOOLEAN            Write,
+  IN     UINT32             MediaId,
+  IN     UINT64             Offset,
+  IN     UINTN              BufferSize,
+  IN OUT VOID               *Buffer
+  )
+{
+  if (MediaId != RamDisk->Media.MediaId) {
+    return EFI_MEDIA_CHANGED;
+  }
+  if (Offset > RamDisk->Size || BufferSize > RamDisk->Size - Offset) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (Write) {
+    CopyMem (RamDisk->Data + Offset, Buffer, BufferSize);
+    RamDisk->WriteCount++;
+  } else {
+    CopyMem (Buffer, RamDisk->Data + Offset, BufferSize);
+    RamDisk->ReadCount++;
+  }
+  return EFI_SUCCESS;
+}
+
+STATIC
+EFI_STATUS
+EFIAPI
+RamDiskReadBlocks (
+  IN  EFI_BLOCK_IO_PROTOCOL  *This,
+  IN  UINT32                 MediaId,
+  IN  EFI_LBA                Lba,
+  IN  UINTN                  BufferSize,
+  OUT VOID                   *Buffer
+  )
+{
+  FAT_HOST_RAM_DISK  *RamDisk;
+
+  RamDisk = BASE_CR (This, FAT_HOST_RAM_DISK, BlockIo);
+  if (BufferSize % RamDisk->Media.BlockSize != 0) {
+    return EFI_BAD_BUFFER_SIZE;
+  }
+  return RamDiskAccess (RamDisk, FALSE, MediaId,
+           MultU64x32 (Lba, RamDisk->Media.BlockSize), BufferSize, Buffer);
+}
+
+STATIC
+EFI_STATUS
+EFIAPI
+RamDiskWriteBlocks (
+  IN EFI_BLOCK_IO_PROTOCOL  *This,
+  IN UINT32                 MediaId,
+  IN EFI_LBA                Lba,
+  IN UINTN                  BufferSize,
+  IN VOID                   *Buffer
+  )
+{
+  FAT_HOST_RAM_DISK  *RamDisk;
+
+  RamDisk = BASE_CR (This, FAT_HOST_RAM_DISK, BlockIo);
+  if (BufferSize % RamDisk->Media.BlockSize != 0) {
+    return EFI_BAD_BUFFER_SIZE;
+  }
+  return RamDiskAccess (RamDisk, TRUE, MediaId,
+           MultU64x32 (Lba, RamDisk->Media.BlockSize), BufferSize, Buffer);
+}
+
+STATIC
+EFI_STATUS
+EFIAPI
+RamDiskFlushBlocks (
+  IN EFI_BLOCK_IO_PROTOCOL  *This
+  )
+{
+  return EFI_SUCCESS;
+}
+
+STATIC
+EFI_STATUS
+EFIAPI
+RamDiskReadDisk (
+  IN  EFI_DISK_IO_PROTOCOL  *This,
+  IN  UINT32                MediaId,
+  IN  UINT64                Offset,
+  IN  UINTN                 BufferSize,
+  OUT VOID                  *Buffer
+  )
+{
+  return RamDiskAccess (BASE_CR (This, FAT_HOST_RAM_DISK, DiskIo), FALSE,
+           MediaId, Offset, BufferSize, Buffer);
+}
+
+STATIC
+EFI_STATUS
+EFIAPI
+RamDiskWriteDisk (
+  IN EFI_DISK_IO_PROTOCOL  *This,
+  IN UINT32                MediaId,
+  IN UINT64                Offset,
+  IN UINTN                 BufferSize,
+  IN VOID                  *Buffer
+  )
+{
+  return RamDiskAccess (BASE_CR (This, FAT_HOST_RAM_DISK, DiskIo), TRUE,
+           MediaId, Offset, BufferSize, Buffer);
+}
+
+/**
+  Set up gBS, gRT and the Unicode Collation protocol used by the driver.
+**/
+VOID
+FatHostInitializeServices (
+  VOID
+  )
+{
+  mHostBootServices.CalculateCrc32                      = HostCalculateCrc32;
+  mHostBootServices.GetMemoryMap                        = HostGetMemoryMap;
+  mHostBootServices.InstallMultipleProtocolInterfaces   = HostInstallMultipleProtocolInterfaces;
+  mHostBootServices.UninstallMultipleProtocolInterfaces = HostUninstallMultipleProtocolInterfaces;
+  mHostBootServices.CreateEvent                         = HostCreateEvent;
+  mHostBootServices.SignalEvent                         = HostEvent;
+  mHostBootServices.CloseEvent                          = HostEvent;
+  mHostBootServices.LocateHandleBuffer                  = HostLocateHandleBuffer;
+  mHostRuntimeServices.GetTime                          = HostGetTime;
+
+  gBS                        = &mHostBootServices;
+  gRT                        = &mHostRuntimeServices;
+  mUnicodeCollationInterface = &mHostUnicodeCollation;
+}
+
+/**
+  Create a zeroed RAM disk.
+
+  @param[in]  Size        The size of the disk in bytes, a multiple of
+                          BlockSize.
+  @param[in]  BlockSize   The block size of the disk.
+
+  @return The new RAM disk, or NULL if it could not be allocated.
+**/
+FAT_HOST_RAM_DISK *
+FatHostCreateRamDisk (
+  IN UINT64  Size,
+  IN UINT32  BlockSize
+  )
+{
+  FAT_HOST_RAM_DISK  *RamDisk;
+
+  RamDisk = AllocateZeroPool (sizeof (*RamDisk));
+  if (RamDisk == NULL) {
+    return NULL;
+  }
+
+  RamDisk->Data = AllocateZeroPool ((UINTN)Size);
+  if (RamDisk->Data == NULL) {
+    FreePool (RamDisk);
+    return NULL;
+  }
+
+  RamDisk->Size                  = Size;
+  RamDisk->Media.MediaId         = 1;
+  RamDisk->Media.MediaPresent    = TRUE;
+  RamDisk->Media.BlockSize       = BlockSize;
+  RamDisk->Media.LastBlock       = DivU64x32 (Size, BlockSize) - 1;
+  RamDisk->BlockIo.Revision      = EFI_BLOCK_IO_PROTOCOL_REVISION;
+  RamDisk->BlockIo.Media         = &RamDisk->Media;
+  RamDisk->BlockIo.Reset         = RamDiskReset;
+  RamDisk->BlockIo.ReadBlocks    = RamDiskReadBlocks;
+  RamDisk->BlockIo.WriteBlocks   = RamDiskWriteBlocks;
+  RamDisk->BlockIo.FlushBlocks   = RamDiskFlushBlocks;
+  RamDisk->DiskIo.Revision       = EFI_DISK_IO_PROTOCOL_REVISION;
+  RamDisk->DiskIo.ReadDisk       = RamDiskReadDisk;
+  RamDisk->DiskIo.WriteDisk      = RamDiskWriteDisk;
+  return RamDisk;
+}
+
+/**
+  Free a RAM disk created by FatHostCreateRamDisk().
+
+  @param[in]  RamDisk     The RAM disk to free.
+**/
+VOID
+FatHostFreeRamDisk (
+  IN FAT_HOST_RAM_DISK  *RamDisk
+  )
+{
+  FreePool (RamDisk->Data);
+  FreePool (RamDisk);
+}
+
+/**
+  Return the EFI_SIMPLE_FILE_SYSTEM_PROTOCOL most recently installed by the
+  driver, for instance by FatAllocateVolume().
+
+  @return The protocol interface, or NULL if none has been installed.
+**/
+EFI_SIMPLE_FILE_SYSTEM_PROTOCOL *
+FatHostGetSimpleFileSystem (
+  VOID
+  )
+{
+  return mHostSimpleFileSystem;
+}
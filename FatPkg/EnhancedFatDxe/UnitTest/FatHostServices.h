@@ -0,0 +1,72 @@
+/** @file
+  Host implementations of the firmware services used by EnhancedFatDxe, so
+  that the driver can run in a host-based unit test over a RAM disk.
+
+  Copyright (c) 2021, EDK II contributors. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef _FAT_HOST_SERVICES_H_
+#define _FAT_HOST_SERVICES_H_
+
+#include "../Fat.h"
+
+///
+/// A RAM disk that produces EFI_BLOCK_IO_PROTOCOL and EFI_DISK_IO_PROTOCOL.
+///
+typedef struct {
+  EFI_BLOCK_IO_PROTOCOL   BlockIo;
+  EFI_BLOCK_IO_MEDIA      Media;
+  EFI_DISK_IO_PROTOCOL    DiskIo;
+  UINT8                   *Data;
+  UINT64                  Size;
+  UINTN                   ReadCount;
+  UINTN                   WriteCount;
+} FAT_HOST_RAM_DISK;
+
+/**
+  Set up gBS, gRT and the Unicode Collation protocol used by the driver.
+**/
+VOID
+FatHostInitializeServices (
+  VOID
+  );
+
+/**
+  Create a zeroed RAM disk.
+
+  @param[in]  Size        The size of the disk in bytes, a multiple of
+                          BlockSize.
+  @param[in]  BlockSize   The block size of the disk.
+
+  @return The new RAM disk, or NULL if it could not be allocated.
+**/
+FAT_HOST_RAM_DISK *
+FatHostCreateRamDisk (
+  IN UINT64  Size,
+  IN UINT32  BlockSize
+  );
+
+/**
+  Free a RAM disk created by FatHostCreateRamDisk().
+
+  @param[in]  RamDisk     The RAM disk to free.
+**/
+VOID
+FatHostFreeRamDisk (
+  IN FAT_HOST_RAM_DISK  *RamDisk
+  );
+
+/**
+  Return the EFI_SIMPLE_FILE_SYSTEM_PROTOCOL most recently installed by the
+  driver, for instance by FatAllocateVolume().
+
+  @return The protocol interface, or NULL if none has been installed.
+**/
+EFI_SIMPLE_FILE_SYSTEM_PROTOCOL *
+FatHostGetSimpleFileSystem (
+  VOID
+  );
+
+#endif
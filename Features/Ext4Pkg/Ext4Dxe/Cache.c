@@ -0,0 +1,519 @@
+/** @file
+  Inode and directory entry caches of the ext4 driver.
+
+  Copyright (c) 2021, EDK II contributors. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "Ext4Dxe.h"
+
+/**
+  Return the size of the inodes the driver allocates for a volume.
+
+  @param[in]  Partition   The volume.
+
+  @return The size in bytes.
+
+**/
+STATIC
+UINTN
+Ext4InodeAllocationSize (
+  IN EXT4_PARTITION  *Partition
+  )
+{
+  return MAX (Partition->InodeSize, sizeof (EXT4_INODE));
+}
+
+/**
+  Get the memory held by a cached inode, including its block map.
+
+  @param[in]  Partition   The volume.
+  @param[in]  Cached      The cached inode.
+
+  @return The size in bytes.
+
+**/
+STATIC
+UINTN
+Ext4CachedInodeSize (
+  IN EXT4_PARTITION     *Partition,
+  IN EXT4_CACHED_INODE  *Cached
+  )
+{
+  return sizeof (EXT4_CACHED_INODE) + Ext4InodeAllocationSize (Partition) +
+         Cached->BlockMap.Capacity * sizeof (EXT4_BLOCK_RUN);
+}
+
+/**
+  Get the memory held by a cached directory entry.
+
+  @param[in]  Cached      The cached directory entry.
+
+  @return The size in bytes.
+
+**/
+STATIC
+UINTN
+Ext4CachedDentrySize (
+  IN EXT4_CACHED_DENTRY  *Cached
+  )
+{
+  return sizeof (EXT4_CACHED_DENTRY) + Cached->NameLength;
+}
+
+/**
+  Remove an inode from the inode cache of a volume and free it.
+
+  @param[in]  Partition   The volume.
+  @param[in]  Cached      The cached inode.
+
+**/
+STATIC
+VOID
+Ext4FreeCachedInode (
+  IN EXT4_PARTITION     *Partition,
+  IN EXT4_CACHED_INODE  *Cached
+  )
+{
+  RemoveEntryList (&Cached->LruLink);
+  RemoveEntryList (&Cached->HashLink);
+  Partition->InodeCacheSize -= Ext4CachedInodeSize (Partition, Cached);
+
+  if (Cached->BlockMap.Runs != NULL) {
+    FreePool (Cached->BlockMap.Runs);
+  }
+
+  FreePool (Cached->Inode);
+  Cached->Signature = 0;
+  FreePool (Cached);
+}
+
+/**
+  Remove a directory entry from the directory entry cache of a volume and
+  free it.
+
+  @param[in]  Partition   The volume.
+  @param[in]  Cached      The cached directory entry.
+
+**/
+STATIC
+VOID
+Ext4FreeCachedDentry (
+  IN EXT4_PARTITION      *Partition,
+  IN EXT4_CACHED_DENTRY  *Cached
+  )
+{
+  RemoveEntryList (&Cached->LruLink);
+  RemoveEntryList (&Cached->HashLink);
+  Partition->DentryCacheSize -= Ext4CachedDentrySize (Cached);
+  Cached->Signature           = 0;
+  FreePool (Cached);
+}
+
+/**
+  Replace the least recently used inodes until the inode cache fits.
+
+  @param[in]  Partition   The volume.
+
+**/
+STATIC
+VOID
+Ext4TrimInodeCache (
+  IN EXT4_PARTITION  *Partition
+  )
+{
+  while (Partition->InodeCacheSize > EXT4_MAX_INODE_CACHE_SIZE) {
+    Ext4FreeCachedInode (
+      Partition,
+      EXT4_CACHED_INODE_FROM_LRU_LINK (Partition->InodeCacheList.BackLink)
+      );
+  }
+}
+
+/**
+  Find an inode in the inode cache of a volume, and make it the most
+  recently used one.
+
+  @param[in]  Partition   The volume.
+  @param[in]  InodeNum    The inode number.
+
+  @return The cached inode, or NULL if the inode is not cached.
+
+**/
+STATIC
+EXT4_CACHED_INODE *
+Ext4FindCachedInode (
+  IN EXT4_PARTITION  *Partition,
+  IN UINT32          InodeNum
+  )
+{
+  LIST_ENTRY         *Head;
+  LIST_ENTRY         *Link;
+  EXT4_CACHED_INODE  *Cached;
+
+  Head = &Partition->InodeCacheHashTable[InodeNum & (EXT4_INODE_CACHE_HASH_SIZE - 1)];
+  for (Link = Head->ForwardLink; Link != Head; Link = Link->ForwardLink) {
+    Cached = EXT4_CACHED_INODE_FROM_HASH_LINK (Link);
+    if (Cached->InodeNum == InodeNum) {
+      RemoveEntryList (&Cached->LruLink);
+      InsertHeadList (&Partition->InodeCacheList, &Cached->LruLink);
+      return Cached;
+    }
+  }
+
+  return NULL;
+}
+
+/**
+  Hash a name of a directory.
+
+  @param[in]  ParentInodeNum  The inode number of the directory.
+  @param[in]  Name            The name, in UTF-8.
+  @param[in]  NameLength      The length of Name in bytes.
+
+  @return The hash of the name.
+
+**/
+STATIC
+UINT32
+Ext4DentryHash (
+  IN UINT32       ParentInodeNum,
+  IN CONST CHAR8  *Name,
+  IN UINTN        NameLength
+  )
+{
+  UINT32  Hash;
+  UINTN   Index;
+
+  //
+  // FNV-1a
+  //
+  Hash = 0x811C9DC5 ^ ParentInodeNum;
+  for (Index = 0; Index < NameLength; Index++) {
+    Hash = (Hash ^ (UINT8)Name[Index]) * 0x01000193;
+  }
+
+  return Hash;
+}
+
+/**
+  Initialize the inode and directory entry caches of a volume.
+
+  @param[in]  Partition   The volume.
+
+**/
+VOID
+Ext4InitCaches (
+  IN EXT4_PARTITION  *Partition
+  )
+{
+  UINTN  Index;
+
+  InitializeListHead (&Partition->InodeCacheList);
+  for (Index = 0; Index < EXT4_INODE_CACHE_HASH_SIZE; Index++) {
+    InitializeListHead (&Partition->InodeCacheHashTable[Index]);
+  }
+
+  InitializeListHead (&Partition->DentryCacheList);
+  for (Index = 0; Index < EXT4_DENTRY_CACHE_HASH_SIZE; Index++) {
+    InitializeListHead (&Partition->DentryCacheHashTable[Index]);
+  }
+
+  Partition->InodeCacheSize  = 0;
+  Partition->DentryCacheSize = 0;
+}
+
+/**
+  Free all the entries of the inode and directory entry caches of a volume.
+
+  @param[in]  Partition   The volume.
+
+**/
+VOID
+Ext4CleanupCaches (
+  IN EXT4_PARTITION  *Partition
+  )
+{
+  while (!IsListEmpty (&Partition->InodeCacheList)) {
+    Ext4FreeCachedInode (
+      Partition,
+      EXT4_CACHED_INODE_FROM_LRU_LINK (Partition->InodeCacheList.BackLink)
+      );
+  }
+
+  while (!IsListEmpty (&Partition->DentryCacheList)) {
+    Ext4FreeCachedDentry (
+      Partition,
+      EXT4_CACHED_DENTRY_FROM_LRU_LINK (Partition->DentryCacheList.BackLink)
+      );
+  }
+
+  ASSERT (Partition->InodeCacheSize == 0);
+  ASSERT (Partition->DentryCacheSize == 0);
+}
+
+/**
+  Look an inode up in the inode cache of a volume.
+
+  @param[in]  Partition          The volume.
+  @param[in]  InodeNum           The inode number.
+  @param[out] Inode              A copy of the cached inode, to be freed with
+                                 FreePool().
+
+  @retval EFI_SUCCESS            The inode was found in the cache.
+  @retval EFI_NOT_FOUND          The inode is not cached.
+  @retval EFI_OUT_OF_RESOURCES   The copy could not be allocated.
+
+**/
+EFI_STATUS
+Ext4LookupInodeCache (
+  IN  EXT4_PARTITION  *Partition,
+  IN  UINT32          InodeNum,
+  OUT EXT4_INODE      **Inode
+  )
+{
+  EXT4_CACHED_INODE  *Cached;
+
+  Cached = Ext4FindCachedInode (Partition, InodeNum);
+  if (Cached == NULL) {
+    return EFI_NOT_FOUND;
+  }
+
+  *Inode = AllocateCopyPool (Ext4InodeAllocationSize (Partition), Cached->Inode);
+  if (*Inode == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Add an inode just read from the volume to its inode cache. The cache keeps
+  its own copy of the inode.
+
+  @param[in]  Partition   The volume.
+  @param[in]  InodeNum    The inode number.
+  @param[in]  Inode       The inode.
+
+**/
+VOID
+Ext4InsertInodeCache (
+  IN EXT4_PARTITION  *Partition,
+  IN UINT32          InodeNum,
+  IN EXT4_INODE      *Inode
+  )
+{
+  EXT4_CACHED_INODE  *Cached;
+
+  if (Ext4FindCachedInode (Partition, InodeNum) != NULL) {
+    return;
+  }
+
+  //
+  // The cache is an optimization: silently skip it when memory is short.
+  //
+  Cached = AllocateZeroPool (sizeof (EXT4_CACHED_INODE));
+  if (Cached == NULL) {
+    return;
+  }
+
+  Cached->Inode = AllocateCopyPool (Ext4InodeAllocationSize (Partition), Inode);
+  if (Cached->Inode == NULL) {
+    FreePool (Cached);
+    return;
+  }
+
+  Cached->Signature = EXT4_CACHED_INODE_SIGNATURE;
+  Cached->InodeNum  = InodeNum;
+  InsertHeadList (&Partition->InodeCacheList, &Cached->LruLink);
+  InsertHeadList (
+    &Partition->InodeCacheHashTable[InodeNum & (EXT4_INODE_CACHE_HASH_SIZE - 1)],
+    &Cached->HashLink
+    );
+  Partition->InodeCacheSize += Ext4CachedInodeSize (Partition, Cached);
+  Ext4TrimInodeCache (Partition);
+}
+
+/**
+  Move the cached block map of the inode of a file, if any, to the file.
+
+  @param[in, out] File    The file, whose block map is not valid.
+
+  @retval TRUE            The file got the block map of its inode.
+  @retval FALSE           The inode has no cached block map.
+
+**/
+BOOLEAN
+Ext4TakeCachedBlockMap (
+  IN OUT EXT4_FILE  *File
+  )
+{
+  EXT4_PARTITION     *Partition;
+  EXT4_CACHED_INODE  *Cached;
+
+  ASSERT (!File->BlockMapValid);
+
+  Partition = File->Partition;
+  Cached    = Ext4FindCachedInode (Partition, File->InodeNum);
+  if ((Cached == NULL) || !Cached->BlockMapValid) {
+    return FALSE;
+  }
+
+  Partition->InodeCacheSize -= Ext4CachedInodeSize (Partition, Cached);
+  CopyMem (&File->BlockMap, &Cached->BlockMap, sizeof (EXT4_BLOCK_MAP));
+  ZeroMem (&Cached->BlockMap, sizeof (EXT4_BLOCK_MAP));
+  Cached->BlockMapValid      = FALSE;
+  Partition->InodeCacheSize += Ext4CachedInodeSize (Partition, Cached);
+
+  File->BlockMapValid = TRUE;
+  return TRUE;
+}
+
+/**
+  Move the block map of a file being closed to the inode cache, so that
+  files opening the same inode do not decode it again.
+
+  @param[in, out] File    The file, whose block map is valid.
+
+  @retval TRUE            The block map now belongs to the cache.
+  @retval FALSE           The block map was not cached and still belongs to
+                          File.
+
+**/
+BOOLEAN
+Ext4CacheBlockMap (
+  IN OUT EXT4_FILE  *File
+  )
+{
+  EXT4_PARTITION     *Partition;
+  EXT4_CACHED_INODE  *Cached;
+
+  ASSERT (File->BlockMapValid);
+
+  Partition = File->Partition;
+  Cached    = Ext4FindCachedInode (Partition, File->InodeNum);
+  if ((Cached == NULL) || Cached->BlockMapValid) {
+    return FALSE;
+  }
+
+  //
+  // A block map that would flush the whole cache is not worth keeping.
+  //
+  if (File->BlockMap.Capacity * sizeof (EXT4_BLOCK_RUN) > EXT4_MAX_INODE_CACHE_SIZE / 4) {
+    return FALSE;
+  }
+
+  Partition->InodeCacheSize -= Ext4CachedInodeSize (Partition, Cached);
+  CopyMem (&Cached->BlockMap, &File->BlockMap, sizeof (EXT4_BLOCK_MAP));
+  Cached->BlockMapValid      = TRUE;
+  Partition->InodeCacheSize += Ext4CachedInodeSize (Partition, Cached);
+
+  ZeroMem (&File->BlockMap, sizeof (EXT4_BLOCK_MAP));
+  File->BlockMapValid = FALSE;
+
+  Ext4TrimInodeCache (Partition);
+  return TRUE;
+}
+
+/**
+  Look a name up in the directory entry cache of a volume.
+
+  @param[in]  Partition       The volume.
+  @param[in]  ParentInodeNum  The inode number of the directory.
+  @param[in]  Name            The name, in UTF-8.
+  @param[in]  NameLength      The length of Name in bytes.
+  @param[out] InodeNum        The inode number of the entry, or 0 if the
+                              directory has no entry called Name.
+
+  @retval TRUE                The result of the lookup is cached.
+  @retval FALSE               The name must be looked up in the directory.
+
+**/
+BOOLEAN
+Ext4LookupDentryCache (
+  IN  EXT4_PARTITION  *Partition,
+  IN  UINT32          ParentInodeNum,
+  IN  CONST CHAR8     *Name,
+  IN  UINTN           NameLength,
+  OUT UINT32          *InodeNum
+  )
+{
+  UINT32              Hash;
+  LIST_ENTRY          *Head;
+  LIST_ENTRY          *Link;
+  EXT4_CACHED_DENTRY  *Cached;
+
+  Hash = Ext4DentryHash (ParentInodeNum, Name, NameLength);
+  Head = &Partition->DentryCacheHashTable[Hash & (EXT4_DENTRY_CACHE_HASH_SIZE - 1)];
+  for (Link = Head->ForwardLink; Link != Head; Link = Link->ForwardLink) {
+    Cached = EXT4_CACHED_DENTRY_FROM_HASH_LINK (Link);
+    if ((Cached->NameHash == Hash) &&
+        (Cached->ParentInodeNum == ParentInodeNum) &&
+        (Cached->NameLength == NameLength) &&
+        (CompareMem (Cached->Name, Name, NameLength) == 0))
+    {
+      RemoveEntryList (&Cached->LruLink);
+      InsertHeadList (&Partition->DentryCacheList, &Cached->LruLink);
+      *InodeNum = Cached->InodeNum;
+      return TRUE;
+    }
+  }
+
+  return FALSE;
+}
+
+/**
+  Add the result of looking a name up in a directory to the directory entry
+  cache of a volume.
+
+  @param[in]  Partition       The volume.
+  @param[in]  ParentInodeNum  The inode number of the directory.
+  @param[in]  Name            The name, in UTF-8.
+  @param[in]  NameLength      The length of Name in bytes.
+  @param[in]  InodeNum        The inode number of the entry, or 0 if the
+                              directory has no entry called Name.
+
+**/
+VOID
+Ext4InsertDentryCache (
+  IN EXT4_PARTITION  *Partition,
+  IN UINT32          ParentInodeNum,
+  IN CONST CHAR8     *Name,
+  IN UINTN           NameLength,
+  IN UINT32          InodeNum
+  )
+{
+  EXT4_CACHED_DENTRY  *Cached;
+
+  ASSERT (NameLength <= EXT4_NAME_MAX);
+
+  Cached = AllocatePool (sizeof (EXT4_CACHED_DENTRY) + NameLength);
+  if (Cached == NULL) {
+    return;
+  }
+
+  Cached->Signature      = EXT4_CACHED_DENTRY_SIGNATURE;
+  Cached->ParentInodeNum = ParentInodeNum;
+  Cached->NameHash       = Ext4DentryHash (ParentInodeNum, Name, NameLength);
+  Cached->InodeNum       = InodeNum;
+  Cached->NameLength     = (UINT8)NameLength;
+  CopyMem (Cached->Name, Name, NameLength);
+
+  InsertHeadList (&Partition->DentryCacheList, &Cached->LruLink);
+  InsertHeadList (
+    &Partition->DentryCacheHashTable[Cached->NameHash & (EXT4_DENTRY_CACHE_HASH_SIZE - 1)],
+    &Cached->HashLink
+    );
+  Partition->DentryCacheSize += Ext4CachedDentrySize (Cached);
+
+  //
+  // Replace the least recently used entries until the cache fits
+  //
+  while (Partition->DentryCacheSize > EXT4_MAX_DENTRY_CACHE_SIZE) {
+    Ext4FreeCachedDentry (
+      Partition,
+      EXT4_CACHED_DENTRY_FROM_LRU_LINK (Partition->DentryCacheList.BackLink)
+      );
+  }
+}
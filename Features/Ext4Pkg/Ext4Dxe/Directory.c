@@ -0,0 +1,738 @@
+/** @file
+  Directory handling of the ext4 driver.
+
+  Copyright (c) 2021, EDK II contributors. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "Ext4Dxe.h"
+
+#define EXT4_REPLACEMENT_CHARACTER  0xFFFD
+
+//
+// A level of an htree lookup: a node of the index and the entry followed.
+//
+typedef struct {
+  UINT8            *Block;
+  EXT4_DX_ENTRY    *Entries;
+  UINT16           Count;
+  UINT16           At;
+} EXT4_DX_FRAME;
+
+/**
+  Convert a UTF-8 string to a UCS-2 string.
+
+  Invalid sequences and characters outside of the Basic Multilingual Plane
+  are replaced with U+FFFD.
+
+  @param[in]  Utf8          The UTF-8 string.
+  @param[in]  Utf8Length    The length of Utf8 in bytes.
+  @param[out] Ucs2          The buffer receiving the null-terminated UCS-2
+                            string, at least Utf8Length + 1 characters.
+
+  @return The number of characters stored in Ucs2, excluding the terminator.
+
+**/
+UINTN
+Ext4Utf8ToUcs2 (
+  IN  CONST CHAR8  *Utf8,
+  IN  UINTN        Utf8Length,
+  OUT CHAR16       *Ucs2
+  )
+{
+  CONST UINT8  *Byte;
+  CONST UINT8  *End;
+  UINTN        Count;
+  UINTN        Trailing;
+  UINT32       Character;
+  UINT32       Minimum;
+
+  Byte  = (CONST UINT8 *)Utf8;
+  End   = Byte + Utf8Length;
+  Count = 0;
+
+  while (Byte < End) {
+    if (*Byte < 0x80) {
+      Ucs2[Count++] = *Byte++;
+      continue;
+    }
+
+    if ((*Byte & 0xE0) == 0xC0) {
+      Character = *Byte & 0x1F;
+      Trailing  = 1;
+      Minimum   = 0x80;
+    } else if ((*Byte & 0xF0) == 0xE0) {
+      Character = *Byte & 0x0F;
+      Trailing  = 2;
+      Minimum   = 0x800;
+    } else if ((*Byte & 0xF8) == 0xF0) {
+      Character = *Byte & 0x07;
+      Trailing  = 3;
+      Minimum   = 0x10000;
+    } else {
+      Ucs2[Count++] = EXT4_REPLACEMENT_CHARACTER;
+      Byte++;
+      continue;
+    }
+
+    Byte++;
+    while ((Trailing > 0) && (Byte < End) && ((*Byte & 0xC0) == 0x80)) {
+      Character = (Character << 6) | (*Byte & 0x3F);
+      Trailing--;
+      Byte++;
+    }
+
+    if ((Trailing > 0) || (Character < Minimum) || (Character > 0xFFFF) ||
+        ((Character >= 0xD800) && (Character <= 0xDFFF)))
+    {
+      Character = EXT4_REPLACEMENT_CHARACTER;
+    }
+
+    Ucs2[Count++] = (CHAR16)Character;
+  }
+
+  Ucs2[Count] = L'\0';
+  return Count;
+}
+
+/**
+  Convert a null-terminated UCS-2 string to UTF-8.
+
+  @param[in]  Ucs2          The UCS-2 string.
+  @param[out] Utf8          The buffer receiving the UTF-8 string, not
+                            null-terminated.
+  @param[in]  Utf8Size      The size of Utf8 in bytes.
+
+  @return The length of the UTF-8 string in bytes, or MAX_UINTN if Utf8 is
+          too small or Ucs2 holds unpaired surrogates.
+
+**/
+UINTN
+Ext4Ucs2ToUtf8 (
+  IN  CONST CHAR16  *Ucs2,
+  OUT CHAR8         *Utf8,
+  IN  UINTN         Utf8Size
+  )
+{
+  UINTN   Length;
+  CHAR16  Character;
+
+  Length = 0;
+  for ( ; *Ucs2 != L'\0'; Ucs2++) {
+    Character = *Ucs2;
+    if ((Character >= 0xD800) && (Character <= 0xDFFF)) {
+      return MAX_UINTN;
+    }
+
+    if (Character < 0x80) {
+      if (Utf8Size - Length < 1) {
+        return MAX_UINTN;
+      }
+
+      Utf8[Length++] = (CHAR8)Character;
+    } else if (Character < 0x800) {
+      if (Utf8Size - Length < 2) {
+        return MAX_UINTN;
+      }
+
+      Utf8[Length++] = (CHAR8)(0xC0 | (Character >> 6));
+      Utf8[Length++] = (CHAR8)(0x80 | (Character & 0x3F));
+    } else {
+      if (Utf8Size - Length < 3) {
+        return MAX_UINTN;
+      }
+
+      Utf8[Length++] = (CHAR8)(0xE0 | (Character >> 12));
+      Utf8[Length++] = (CHAR8)(0x80 | ((Character >> 6) & 0x3F));
+      Utf8[Length++] = (CHAR8)(0x80 | (Character & 0x3F));
+    }
+  }
+
+  return Length;
+}
+
+/**
+  Check a directory entry and return its record length.
+
+  @param[in]  Partition   The volume.
+  @param[in]  Block       The directory block.
+  @param[in]  Offset      The offset of the entry in Block.
+  @param[out] RecordLength  The distance to the next entry.
+
+  @retval TRUE            The entry is valid.
+  @retval FALSE           The entry is corrupted.
+
+**/
+STATIC
+BOOLEAN
+Ext4CheckDirEntry (
+  IN  EXT4_PARTITION  *Partition,
+  IN  UINT8           *Block,
+  IN  UINT32          Offset,
+  OUT UINT32          *RecordLength
+  )
+{
+  EXT4_DIR_ENTRY  *Entry;
+  UINT32          Length;
+
+  if (Offset + EXT4_DIR_ENTRY_MIN_SIZE > Partition->BlockSize) {
+    return FALSE;
+  }
+
+  Entry  = (EXT4_DIR_ENTRY *)(Block + Offset);
+  Length = Entry->rec_len;
+  if ((Partition->BlockSize > EXT4_DIR_ENTRY_MAX_REC_LEN) &&
+      ((Length == EXT4_DIR_ENTRY_MAX_REC_LEN) || (Length == 0)))
+  {
+    Length = Partition->BlockSize;
+  }
+
+  if ((Length < EXT4_DIR_ENTRY_MIN_SIZE) || ((Length % 4) != 0) ||
+      (Offset + Length > Partition->BlockSize) ||
+      (EXT4_DIR_ENTRY_MIN_SIZE + (UINT32)Entry->name_len > Length))
+  {
+    return FALSE;
+  }
+
+  *RecordLength = Length;
+  return TRUE;
+}
+
+/**
+  Read a block of a directory.
+
+  @param[in]  Dir                The directory.
+  @param[in]  FileBlock          The block of the directory.
+  @param[out] Buffer             The buffer receiving the block.
+
+  @retval EFI_SUCCESS            The block was read.
+  @retval EFI_VOLUME_CORRUPTED   FileBlock is beyond the end of Dir.
+  @return others                 An error occurred reading the volume.
+
+**/
+STATIC
+EFI_STATUS
+Ext4ReadDirBlock (
+  IN  EXT4_FILE  *Dir,
+  IN  UINT64     FileBlock,
+  OUT UINT8      *Buffer
+  )
+{
+  UINT64  Offset;
+
+  Offset = Ext4BlockToByteOffset (Dir->Partition, FileBlock);
+  if ((Offset >= Dir->Size) || (Dir->Partition->BlockSize > Dir->Size - Offset)) {
+    return EFI_VOLUME_CORRUPTED;
+  }
+
+  return Ext4ReadFileData (Dir, Offset, Dir->Partition->BlockSize, Buffer);
+}
+
+/**
+  Search a directory block for a name.
+
+  @param[in]  Partition          The volume.
+  @param[in]  Block              The directory block.
+  @param[in]  Name               The name.
+  @param[in]  NameLength         The length of Name in bytes.
+  @param[out] InodeNum           The inode number of the entry.
+
+  @retval EFI_SUCCESS            The entry was found.
+  @retval EFI_NOT_FOUND          Block has no entry called Name.
+  @retval EFI_VOLUME_CORRUPTED   Block is not a valid directory block.
+
+**/
+STATIC
+EFI_STATUS
+Ext4SearchDirBlock (
+  IN  EXT4_PARTITION  *Partition,
+  IN  UINT8           *Block,
+  IN  CONST CHAR8     *Name,
+  IN  UINTN           NameLength,
+  OUT UINT32          *InodeNum
+  )
+{
+  EXT4_DIR_ENTRY  *Entry;
+  UINT32          Offset;
+  UINT32          RecordLength;
+
+  for (Offset = 0; Offset < Partition->BlockSize; Offset += RecordLength) {
+    if (!Ext4CheckDirEntry (Partition, Block, Offset, &RecordLength)) {
+      return EFI_VOLUME_CORRUPTED;
+    }
+
+    Entry = (EXT4_DIR_ENTRY *)(Block + Offset);
+    if ((Entry->inode != 0) && (Entry->name_len == NameLength) &&
+        (CompareMem (Entry->name, Name, NameLength) == 0))
+    {
+      *InodeNum = Entry->inode;
+      return EFI_SUCCESS;
+    }
+  }
+
+  return EFI_NOT_FOUND;
+}
+
+/**
+  Look a name up by scanning the blocks of a directory in order.
+
+  @param[in]  Dir                The directory.
+  @param[in]  Name               The name.
+  @param[in]  NameLength         The length of Name in bytes.
+  @param[in]  MaxBlocks          The number of blocks to scan at most.
+  @param[in]  Buffer             A block sized buffer.
+  @param[out] InodeNum           The inode number of the entry.
+
+  @retval EFI_SUCCESS            The entry was found.
+  @retval EFI_NOT_FOUND          Dir has no entry called Name.
+  @retval EFI_VOLUME_CORRUPTED   The directory is invalid.
+  @return others                 An error occurred reading the volume.
+
+**/
+STATIC
+EFI_STATUS
+Ext4LinearLookup (
+  IN  EXT4_FILE    *Dir,
+  IN  CONST CHAR8  *Name,
+  IN  UINTN        NameLength,
+  IN  UINT64       MaxBlocks,
+  IN  UINT8        *Buffer,
+  OUT UINT32       *InodeNum
+  )
+{
+  EFI_STATUS  Status;
+  UINT64      Blocks;
+  UINT64      FileBlock;
+
+  Blocks = RShiftU64 (Dir->Size, Dir->Partition->BlockLogSize);
+  if (Blocks > MaxBlocks) {
+    Blocks = MaxBlocks;
+  }
+
+  for (FileBlock = 0; FileBlock < Blocks; FileBlock++) {
+    Status = Ext4ReadDirBlock (Dir, FileBlock, Buffer);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+
+    Status = Ext4SearchDirBlock (Dir->Partition, Buffer, Name, NameLength, InodeNum);
+    if (Status != EFI_NOT_FOUND) {
+      return Status;
+    }
+  }
+
+  return EFI_NOT_FOUND;
+}
+
+/**
+  Read a node of an htree index into a frame and check its entry count.
+
+  @param[in]      Dir            The directory.
+  @param[in]      FileBlock      The block of the node, or MAX_UINT64 if the
+                                 frame already holds the node.
+  @param[in]      EntriesOffset  The offset of the entries in the node.
+  @param[in, out] Frame          The frame, with a block sized buffer.
+
+  @retval EFI_SUCCESS            The node was read.
+  @retval EFI_UNSUPPORTED        The node is inconsistent.
+  @return others                 An error occurred reading the volume.
+
+**/
+STATIC
+EFI_STATUS
+Ext4ReadDxNode (
+  IN     EXT4_FILE      *Dir,
+  IN     UINT64         FileBlock,
+  IN     UINT32         EntriesOffset,
+  IN OUT EXT4_DX_FRAME  *Frame
+  )
+{
+  EFI_STATUS           Status;
+  EXT4_DX_COUNT_LIMIT  *CountLimit;
+
+  if (FileBlock != MAX_UINT64) {
+    Status = Ext4ReadDirBlock (Dir, FileBlock, Frame->Block);
+    if (EFI_ERROR (Status)) {
+      return (Status == EFI_VOLUME_CORRUPTED) ? EFI_UNSUPPORTED : Status;
+    }
+  }
+
+  CountLimit = (EXT4_DX_COUNT_LIMIT *)(Frame->Block + EntriesOffset);
+  if ((CountLimit->limit != (Dir->Partition->BlockSize - EntriesOffset) / sizeof (EXT4_DX_ENTRY)) ||
+      (CountLimit->count == 0) || (CountLimit->count > CountLimit->limit))
+  {
+    return EFI_UNSUPPORTED;
+  }
+
+  Frame->Entries = (EXT4_DX_ENTRY *)CountLimit;
+  Frame->Count   = CountLimit->count;
+  Frame->At      = 0;
+  return EFI_SUCCESS;
+}
+
+/**
+  Look a name up through the htree index of a directory.
+
+  The index maps ranges of name hashes to leaf blocks. The leaf covering the
+  hash of Name is searched first; when a run of equal hashes continues in the
+  next leaf, marked by the low bit of the next hash in the index, that leaf is
+  searched too.
+
+  @param[in]  Dir                The directory.
+  @param[in]  Name               The name.
+  @param[in]  NameLength         The length of Name in bytes.
+  @param[in]  Buffer             A block sized buffer.
+  @param[out] InodeNum           The inode number of the entry.
+
+  @retval EFI_SUCCESS            The entry was found.
+  @retval EFI_NOT_FOUND          Dir has no entry called Name.
+  @retval EFI_UNSUPPORTED        The index is inconsistent or uses an unknown
+                                 hash; the directory must be scanned.
+  @retval EFI_VOLUME_CORRUPTED   A leaf block is invalid.
+  @return others                 An error occurred reading the volume.
+
+**/
+STATIC
+EFI_STATUS
+Ext4HtreeLookup (
+  IN  EXT4_FILE    *Dir,
+  IN  CONST CHAR8  *Name,
+  IN  UINTN        NameLength,
+  IN  UINT8        *Buffer,
+  OUT UINT32       *InodeNum
+  )
+{
+  EFI_STATUS         Status;
+  EXT4_PARTITION     *Partition;
+  EXT4_DX_FRAME      Frames[EXT4_HTREE_MAX_LEVELS_LARGEDIR];
+  EXT4_DX_ROOT_INFO  *Info;
+  UINT8              HashVersion;
+  UINT32             Hash;
+  UINT32             Levels;
+  UINT32             MaxLevels;
+  UINT32             Level;
+  UINT16             Low;
+  UINT16             High;
+  UINT16             Middle;
+
+  Partition = Dir->Partition;
+  ZeroMem (Frames, sizeof (Frames));
+
+  MaxLevels = EXT4_HTREE_MAX_LEVELS;
+  if ((Partition->FeaturesIncompat & EXT4_FEATURE_INCOMPAT_LARGEDIR) != 0) {
+    MaxLevels = EXT4_HTREE_MAX_LEVELS_LARGEDIR;
+  }
+
+  for (Level = 0; Level < MaxLevels; Level++) {
+    Frames[Level].Block = AllocatePool (Partition->BlockSize);
+    if (Frames[Level].Block == NULL) {
+      Status = EFI_OUT_OF_RESOURCES;
+      goto Exit;
+    }
+  }
+
+  Status = Ext4ReadDirBlock (Dir, 0, Frames[0].Block);
+  if (EFI_ERROR (Status)) {
+    goto Exit;
+  }
+
+  Info = (EXT4_DX_ROOT_INFO *)(Frames[0].Block + EXT4_DX_ROOT_ENTRIES_OFFSET);
+  if ((Info->reserved_zero != 0) || (Info->info_length < sizeof (EXT4_DX_ROOT_INFO)) ||
+      (Info->indirect_levels >= MaxLevels) ||
+      (EXT4_DX_ROOT_ENTRIES_OFFSET + Info->info_length + sizeof (EXT4_DX_ENTRY) > Partition->BlockSize))
+  {
+    Status = EFI_UNSUPPORTED;
+    goto Exit;
+  }
+
+  HashVersion = Info->hash_version;
+  if (HashVersion > EXT4_DX_HASH_TEA) {
+    Status = EFI_UNSUPPORTED;
+    goto Exit;
+  }
+
+  HashVersion = (UINT8)(HashVersion + Partition->HashVersionOffset);
+  Status      = Ext4DirHash (Partition, HashVersion, Name, NameLength, &Hash);
+  if (EFI_ERROR (Status)) {
+    goto Exit;
+  }
+
+  Levels = Info->indirect_levels;
+  Status = Ext4ReadDxNode (Dir, MAX_UINT64, EXT4_DX_ROOT_ENTRIES_OFFSET + Info->info_length, &Frames[0]);
+  if (EFI_ERROR (Status)) {
+    goto Exit;
+  }
+
+  //
+  // Descend to the leaf covering Hash. The first entry of each node has no
+  // hash and covers everything below the second one.
+  //
+  for (Level = 0; ; Level++) {
+    Low  = 1;
+    High = Frames[Level].Count;
+    while (Low < High) {
+      Middle = Low + (High - Low) / 2;
+      if (Frames[Level].Entries[Middle].hash > Hash) {
+        High = Middle;
+      } else {
+        Low = Middle + 1;
+      }
+    }
+
+    Frames[Level].At = Low - 1;
+    if (Level == Levels) {
+      break;
+    }
+
+    Status = Ext4ReadDxNode (
+               Dir,
+               Frames[Level].Entries[Frames[Level].At].block & EXT4_DX_BLOCK_MASK,
+               EXT4_DX_NODE_ENTRIES_OFFSET,
+               &Frames[Level + 1]
+               );
+    if (EFI_ERROR (Status)) {
+      goto Exit;
+    }
+  }
+
+  while (TRUE) {
+    Status = Ext4ReadDirBlock (
+               Dir,
+               Frames[Levels].Entries[Frames[Levels].At].block & EXT4_DX_BLOCK_MASK,
+               Buffer
+               );
+    if (EFI_ERROR (Status)) {
+      goto Exit;
+    }
+
+    Status = Ext4SearchDirBlock (Partition, Buffer, Name, NameLength, InodeNum);
+    if (Status != EFI_NOT_FOUND) {
+      goto Exit;
+    }
+
+    //
+    // Move to the next leaf, if the hashes of Hash continue there.
+    //
+    Level = Levels + 1;
+    do {
+      Level--;
+      if (Frames[Level].At + 1 < Frames[Level].Count) {
+        break;
+      }
+    } while (Level > 0);
+
+    if (Frames[Level].At + 1 >= Frames[Level].Count) {
+      Status = EFI_NOT_FOUND;
+      goto Exit;
+    }
+
+    Frames[Level].At++;
+    if ((Frames[Level].Entries[Frames[Level].At].hash & ~(UINT32)1) != Hash) {
+      Status = EFI_NOT_FOUND;
+      goto Exit;
+    }
+
+    for ( ; Level < Levels; Level++) {
+      Status = Ext4ReadDxNode (
+                 Dir,
+                 Frames[Level].Entries[Frames[Level].At].block & EXT4_DX_BLOCK_MASK,
+                 EXT4_DX_NODE_ENTRIES_OFFSET,
+                 &Frames[Level + 1]
+                 );
+      if (EFI_ERROR (Status)) {
+        goto Exit;
+      }
+    }
+  }
+
+Exit:
+  for (Level = 0; Level < MaxLevels; Level++) {
+    if (Frames[Level].Block != NULL) {
+      FreePool (Frames[Level].Block);
+    }
+  }
+
+  return Status;
+}
+
+/**
+  Look a name up in a directory.
+
+  Directories with an htree index are searched through the index. A linear
+  scan is used for other directories, and for indexed directories whose
+  index is inconsistent or uses an unknown hash. Results, including names
+  that do not exist, are kept in the directory entry cache of the volume.
+
+  @param[in]  Dir                The directory.
+  @param[in]  Name               The name, in UTF-8.
+  @param[in]  NameLength         The length of Name in bytes.
+  @param[out] InodeNum           The inode number of the entry.
+
+  @retval EFI_SUCCESS            The entry was found.
+  @retval EFI_NOT_FOUND          Dir has no entry called Name.
+  @retval EFI_VOLUME_CORRUPTED   The directory is invalid.
+  @return others                 An error occurred reading the volume.
+
+**/
+EFI_STATUS
+Ext4LookupDirEntry (
+  IN  EXT4_FILE    *Dir,
+  IN  CONST CHAR8  *Name,
+  IN  UINTN        NameLength,
+  OUT UINT32       *InodeNum
+  )
+{
+  EFI_STATUS  Status;
+  UINT8       *Buffer;
+
+  if ((NameLength == 0) || (NameLength > EXT4_NAME_MAX)) {
+    return EFI_NOT_FOUND;
+  }
+
+  if (Ext4LookupDentryCache (Dir->Partition, Dir->InodeNum, Name, NameLength, InodeNum)) {
+    return (*InodeNum != 0) ? EFI_SUCCESS : EFI_NOT_FOUND;
+  }
+
+  Buffer = AllocatePool (Dir->Partition->BlockSize);
+  if (Buffer == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  if ((NameLength <= 2) && (CompareMem (Name, "..", NameLength) == 0)) {
+    //
+    // "." and ".." are the first entries of the first block, and are not
+    // part of the htree index.
+    //
+    Status = Ext4LinearLookup (Dir, Name, NameLength, 1, Buffer, InodeNum);
+  } else if (((Dir->Inode->i_flags & EXT4_INDEX_FL) != 0) &&
+             ((Dir->Partition->FeaturesCompat & EXT4_FEATURE_COMPAT_DIR_INDEX) != 0) &&
+             ((Dir->Inode->i_flags & EXT4_CASEFOLD_FL) == 0))
+  {
+    Status = Ext4HtreeLookup (Dir, Name, NameLength, Buffer, InodeNum);
+    if (Status == EFI_UNSUPPORTED) {
+      DEBUG ((DEBUG_WARN, "%a: scanning indexed directory %u\n", __FUNCTION__, Dir->InodeNum));
+      Status = Ext4LinearLookup (Dir, Name, NameLength, MAX_UINT64, Buffer, InodeNum);
+    }
+  } else {
+    Status = Ext4LinearLookup (Dir, Name, NameLength, MAX_UINT64, Buffer, InodeNum);
+  }
+
+  FreePool (Buffer);
+
+  if (Status == EFI_SUCCESS) {
+    Ext4InsertDentryCache (Dir->Partition, Dir->InodeNum, Name, NameLength, *InodeNum);
+  } else if (Status == EFI_NOT_FOUND) {
+    Ext4InsertDentryCache (Dir->Partition, Dir->InodeNum, Name, NameLength, 0);
+  }
+
+  return Status;
+}
+
+/**
+  Read the EFI_FILE_INFO of the next entry of an open directory and advance
+  its position.
+
+  @param[in, out] Dir            The directory.
+  @param[in, out] BufferSize     On input, the size of Buffer. On output, the
+                                 size of the EFI_FILE_INFO, or 0 at the end of
+                                 the directory.
+  @param[out]     Buffer         The buffer receiving the EFI_FILE_INFO.
+
+  @retval EFI_SUCCESS            The entry was returned, or the end of the
+                                 directory was reached.
+  @retval EFI_BUFFER_TOO_SMALL   Buffer is too small. The position is not
+                                 changed.
+  @retval EFI_VOLUME_CORRUPTED   The directory is invalid.
+  @return others                 An error occurred reading the volume.
+
+**/
+EFI_STATUS
+Ext4ReadDir (
+  IN OUT EXT4_FILE  *Dir,
+  IN OUT UINTN      *BufferSize,
+  OUT    VOID       *Buffer
+  )
+{
+  EFI_STATUS      Status;
+  EXT4_PARTITION  *Partition;
+  EXT4_DIR_ENTRY  *Entry;
+  EXT4_INODE      *Inode;
+  EFI_FILE_INFO   *Info;
+  CHAR16          Name[EXT4_NAME_MAX + 1];
+  UINTN           NameChars;
+  UINTN           InfoSize;
+  UINT64          FileBlock;
+  UINT32          Offset;
+  UINT32          RecordLength;
+
+  Partition = Dir->Partition;
+
+  if (Dir->DirBlock == NULL) {
+    Dir->DirBlock = AllocatePool (Partition->BlockSize);
+    if (Dir->DirBlock == NULL) {
+      return EFI_OUT_OF_RESOURCES;
+    }
+
+    Dir->DirBlockNumber = MAX_UINT64;
+  }
+
+  while (Dir->Position < Dir->Size) {
+    FileBlock = RShiftU64 (Dir->Position, Partition->BlockLogSize);
+    Offset    = (UINT32)Dir->Position & (Partition->BlockSize - 1);
+
+    if (Dir->DirBlockNumber != FileBlock) {
+      Dir->DirBlockNumber = MAX_UINT64;
+      Status              = Ext4ReadDirBlock (Dir, FileBlock, Dir->DirBlock);
+      if (EFI_ERROR (Status)) {
+        return Status;
+      }
+
+      Dir->DirBlockNumber = FileBlock;
+    }
+
+    if (!Ext4CheckDirEntry (Partition, Dir->DirBlock, Offset, &RecordLength)) {
+      return EFI_VOLUME_CORRUPTED;
+    }
+
+    Entry = (EXT4_DIR_ENTRY *)(Dir->DirBlock + Offset);
+
+    //
+    // Skip unused entries, the nodes of an htree index, and "." and ".." in
+    // the root directory, which UEFI does not expect.
+    //
+    if ((Entry->inode == 0) ||
+        ((Dir->InodeNum == EXT4_ROOT_INODE_NR) && (Entry->name_len <= 2) &&
+         (CompareMem (Entry->name, "..", Entry->name_len) == 0)))
+    {
+      Dir->Position += RecordLength;
+      continue;
+    }
+
+    NameChars = Ext4Utf8ToUcs2 (Entry->name, Entry->name_len, Name);
+    InfoSize  = SIZE_OF_EFI_FILE_INFO + (NameChars + 1) * sizeof (CHAR16);
+    if (*BufferSize < InfoSize) {
+      *BufferSize = InfoSize;
+      return EFI_BUFFER_TOO_SMALL;
+    }
+
+    Status = Ext4ReadInode (Partition, Entry->inode, &Inode);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+
+    Info = Buffer;
+    ZeroMem (Info, SIZE_OF_EFI_FILE_INFO);
+    Info->Size = InfoSize;
+    Ext4InodeToFileInfo (Partition, Inode, Info);
+    CopyMem (Info->FileName, Name, (NameChars + 1) * sizeof (CHAR16));
+    FreePool (Inode);
+
+    *BufferSize    = InfoSize;
+    Dir->Position += RecordLength;
+    return EFI_SUCCESS;
+  }
+
+  *BufferSize = 0;
+  return EFI_SUCCESS;
+}
@@ -0,0 +1,300 @@
+/** @file
+  Disk access helpers of the ext4 driver.
+
+  Copyright (c) 2021, EDK II contributors. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "Ext4Dxe.h"
+
+/**
+  Read bytes from the volume.
+
+  @param[in]  Partition   The volume.
+  @param[in]  Offset      The byte offset on the volume.
+  @param[in]  Length      The number of bytes to read.
+  @param[out] Buffer      The buffer receiving the data.
+
+  @retval EFI_SUCCESS     The data was read.
+  @return others          The error returned by EFI_DISK_IO_PROTOCOL.
+
+**/
+EFI_STATUS
+Ext4ReadDiskIo (
+  IN  EXT4_PARTITION  *Partition,
+  IN  UINT64          Offset,
+  IN  UINTN           Length,
+  OUT VOID            *Buffer
+  )
+{
+  return Partition->DiskIo->ReadDisk (
+                              Partition->DiskIo,
+                              Partition->BlockIo->Media->MediaId,
+                              Offset,
+                              Length,
+                              Buffer
+                              );
+}
+
+/**
+  Create the events of the EFI_DISK_IO2_PROTOCOL requests of a volume.
+  Nothing is done if the disk does not produce EFI_DISK_IO2_PROTOCOL.
+
+  @param[in]  Partition   The volume.
+
+  @retval EFI_SUCCESS     The events were created.
+  @return others          An event could not be created.
+
+**/
+EFI_STATUS
+Ext4InitDiskReads (
+  IN EXT4_PARTITION  *Partition
+  )
+{
+  EFI_STATUS  Status;
+  UINTN       Index;
+
+  if (Partition->DiskIo2 == NULL) {
+    return EFI_SUCCESS;
+  }
+
+  for (Index = 0; Index < EXT4_MAX_READS_IN_FLIGHT; Index++) {
+    //
+    // Plain events, polled with CheckEvent() from TPL_CALLBACK.
+    //
+    Status = gBS->CreateEvent (0, TPL_CALLBACK, NULL, NULL, &Partition->ReadTokens[Index].Event);
+    if (EFI_ERROR (Status)) {
+      Ext4FreeDiskReads (Partition);
+      return Status;
+    }
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Close the events created by Ext4InitDiskReads().
+
+  @param[in]  Partition   The volume.
+
+**/
+VOID
+Ext4FreeDiskReads (
+  IN EXT4_PARTITION  *Partition
+  )
+{
+  UINTN  Index;
+
+  ASSERT (Partition->ReadsInFlight == 0);
+
+  for (Index = 0; Index < EXT4_MAX_READS_IN_FLIGHT; Index++) {
+    if (Partition->ReadTokens[Index].Event != NULL) {
+      gBS->CloseEvent (Partition->ReadTokens[Index].Event);
+      Partition->ReadTokens[Index].Event = NULL;
+    }
+  }
+}
+
+/**
+  Wait for the oldest outstanding EFI_DISK_IO2_PROTOCOL read of a volume.
+
+  @param[in]  Partition   The volume, with at least one read in flight.
+
+  @return The status of the read.
+
+**/
+STATIC
+EFI_STATUS
+Ext4WaitOldestDiskRead (
+  IN EXT4_PARTITION  *Partition
+  )
+{
+  EFI_DISK_IO2_TOKEN  *Token;
+
+  ASSERT (Partition->ReadsInFlight > 0);
+
+  Token = &Partition->ReadTokens[Partition->FirstRead];
+  while (gBS->CheckEvent (Token->Event) == EFI_NOT_READY) {
+  }
+
+  Partition->FirstRead = (Partition->FirstRead + 1) % EXT4_MAX_READS_IN_FLIGHT;
+  Partition->ReadsInFlight--;
+  return Token->TransactionStatus;
+}
+
+/**
+  Start reading bytes from the volume.
+
+  With EFI_DISK_IO2_PROTOCOL, the read is queued and Buffer must not be
+  used before Ext4WaitDiskReads() returns; up to EXT4_MAX_READS_IN_FLIGHT
+  reads are outstanding, and the oldest one is waited for when all are.
+  Without it, the data is read before returning.
+
+  @param[in]  Partition   The volume.
+  @param[in]  Offset      The byte offset on the volume.
+  @param[in]  Length      The number of bytes to read.
+  @param[out] Buffer      The buffer receiving the data.
+
+  @retval EFI_SUCCESS     The read was started.
+  @return others          The read, or an earlier one, failed.
+
+**/
+EFI_STATUS
+Ext4QueueDiskRead (
+  IN  EXT4_PARTITION  *Partition,
+  IN  UINT64          Offset,
+  IN  UINTN           Length,
+  OUT VOID            *Buffer
+  )
+{
+  EFI_STATUS          Status;
+  EFI_DISK_IO2_TOKEN  *Token;
+
+  if (Partition->DiskIo2 == NULL) {
+    return Ext4ReadDiskIo (Partition, Offset, Length, Buffer);
+  }
+
+  if (Partition->ReadsInFlight == EXT4_MAX_READS_IN_FLIGHT) {
+    Status = Ext4WaitOldestDiskRead (Partition);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+  }
+
+  Token  = &Partition->ReadTokens[(Partition->FirstRead + Partition->ReadsInFlight) % EXT4_MAX_READS_IN_FLIGHT];
+  Status = Partition->DiskIo2->ReadDiskEx (
+                                 Partition->DiskIo2,
+                                 Partition->BlockIo->Media->MediaId,
+                                 Offset,
+                                 Token,
+                                 Length,
+                                 Buffer
+                                 );
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Partition->ReadsInFlight++;
+  return EFI_SUCCESS;
+}
+
+/**
+  Wait for all the reads started by Ext4QueueDiskRead() to complete.
+
+  @param[in]  Partition   The volume.
+
+  @retval EFI_SUCCESS     All the reads succeeded.
+  @return others          The error of a failed read.
+
+**/
+EFI_STATUS
+Ext4WaitDiskReads (
+  IN EXT4_PARTITION  *Partition
+  )
+{
+  EFI_STATUS  Status;
+  EFI_STATUS  ReadStatus;
+
+  Status = EFI_SUCCESS;
+  while (Partition->ReadsInFlight > 0) {
+    ReadStatus = Ext4WaitOldestDiskRead (Partition);
+    if (!EFI_ERROR (Status)) {
+      Status = ReadStatus;
+    }
+  }
+
+  return Status;
+}
+
+/**
+  Return the byte offset on the volume of a block.
+
+  @param[in]  Partition   The volume.
+  @param[in]  Block       The block number.
+
+  @return The byte offset of Block.
+
+**/
+UINT64
+Ext4BlockToByteOffset (
+  IN EXT4_PARTITION  *Partition,
+  IN UINT64          Block
+  )
+{
+  return LShiftU64 (Block, Partition->BlockLogSize);
+}
+
+/**
+  Read whole blocks from the volume.
+
+  @param[in]  Partition   The volume.
+  @param[in]  Block       The first block to read.
+  @param[in]  Count       The number of blocks to read.
+  @param[out] Buffer      The buffer receiving the data.
+
+  @retval EFI_SUCCESS            The blocks were read.
+  @retval EFI_VOLUME_CORRUPTED   The blocks lie outside of the volume.
+  @return others                 The error returned by EFI_DISK_IO_PROTOCOL.
+
+**/
+EFI_STATUS
+Ext4ReadBlocks (
+  IN  EXT4_PARTITION  *Partition,
+  IN  UINT64          Block,
+  IN  UINTN           Count,
+  OUT VOID            *Buffer
+  )
+{
+  if ((Block >= Partition->NumberBlocks) ||
+      (Count > Partition->NumberBlocks - Block) ||
+      (Count > (MAX_UINTN >> Partition->BlockLogSize)))
+  {
+    return EFI_VOLUME_CORRUPTED;
+  }
+
+  return Ext4ReadDiskIo (
+           Partition,
+           Ext4BlockToByteOffset (Partition, Block),
+           Count << Partition->BlockLogSize,
+           Buffer
+           );
+}
+
+/**
+  Allocate a buffer and read whole blocks of the volume into it.
+
+  @param[in]  Partition   The volume.
+  @param[in]  Block       The first block to read.
+  @param[in]  Count       The number of blocks to read.
+
+  @return The buffer, to be freed with FreePool(), or NULL on error.
+
+**/
+VOID *
+Ext4AllocAndReadBlocks (
+  IN EXT4_PARTITION  *Partition,
+  IN UINT64          Block,
+  IN UINTN           Count
+  )
+{
+  VOID        *Buffer;
+  EFI_STATUS  Status;
+
+  if (Count > (MAX_UINTN >> Partition->BlockLogSize)) {
+    return NULL;
+  }
+
+  Buffer = AllocatePool (Count << Partition->BlockLogSize);
+  if (Buffer == NULL) {
+    return NULL;
+  }
+
+  Status = Ext4ReadBlocks (Partition, Block, Count, Buffer);
+  if (EFI_ERROR (Status)) {
+    FreePool (Buffer);
+    return NULL;
+  }
+
+  return Buffer;
+}
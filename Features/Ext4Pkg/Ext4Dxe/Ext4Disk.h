@@ -0,0 +1,353 @@
+/** @file
+  On-disk structures of the ext4 file system.
+
+  Field names follow the Linux kernel definitions in fs/ext4/ext4.h, so that
+  they can be cross-referenced with the ext4 disk layout documentation. All
+  fields are little endian.
+
+  Copyright (c) 2021, EDK II contributors. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef _EXT4_DISK_H_
+#define _EXT4_DISK_H_
+
+#include <Uefi.h>
+
+//
+// The superblock is always 1024 bytes long and starts 1024 bytes into the
+// partition, whatever the block size.
+//
+#define EXT4_SUPERBLOCK_OFFSET  1024U
+#define EXT4_SUPERBLOCK_SIZE    1024U
+
+#define EXT4_SIGNATURE  0xEF53U
+
+#define EXT4_MIN_BLOCK_LOG_SIZE  10
+#define EXT4_MAX_BLOCK_LOG_SIZE  16
+
+#define EXT4_GOOD_OLD_REV             0
+#define EXT4_DYNAMIC_REV              1
+#define EXT4_GOOD_OLD_INODE_SIZE      128U
+#define EXT4_GOOD_OLD_DESC_SIZE       32U
+#define EXT4_64BIT_MIN_DESC_SIZE      64U
+
+#define EXT4_ROOT_INODE_NR  2
+
+#define EXT4_VOLUME_NAME_SIZE  16
+
+//
+// s_feature_compat
+//
+#define EXT4_FEATURE_COMPAT_DIR_INDEX      0x0020
+#define EXT4_FEATURE_COMPAT_SPARSE_SUPER2  0x0200
+
+//
+// s_feature_ro_compat
+//
+#define EXT4_FEATURE_RO_COMPAT_SPARSE_SUPER  0x0001
+#define EXT4_FEATURE_RO_COMPAT_HUGE_FILE     0x0008
+
+//
+// s_feature_incompat
+//
+#define EXT4_FEATURE_INCOMPAT_COMPRESSION  0x00001
+#define EXT4_FEATURE_INCOMPAT_FILETYPE     0x00002
+#define EXT4_FEATURE_INCOMPAT_RECOVER      0x00004
+#define EXT4_FEATURE_INCOMPAT_JOURNAL_DEV  0x00008
+#define EXT4_FEATURE_INCOMPAT_META_BG      0x00010
+#define EXT4_FEATURE_INCOMPAT_EXTENTS      0x00040
+#define EXT4_FEATURE_INCOMPAT_64BIT        0x00080
+#define EXT4_FEATURE_INCOMPAT_MMP          0x00100
+#define EXT4_FEATURE_INCOMPAT_FLEX_BG      0x00200
+#define EXT4_FEATURE_INCOMPAT_EA_INODE     0x00400
+#define EXT4_FEATURE_INCOMPAT_DIRDATA      0x01000
+#define EXT4_FEATURE_INCOMPAT_CSUM_SEED    0x02000
+#define EXT4_FEATURE_INCOMPAT_LARGEDIR     0x04000
+#define EXT4_FEATURE_INCOMPAT_INLINE_DATA  0x08000
+#define EXT4_FEATURE_INCOMPAT_ENCRYPT      0x10000
+#define EXT4_FEATURE_INCOMPAT_CASEFOLD     0x20000
+
+//
+// The incompatible features this driver can read. Files that use inline data
+// or encryption are refused individually.
+//
+#define EXT4_FEATURE_INCOMPAT_SUPPORTED \
+  (EXT4_FEATURE_INCOMPAT_FILETYPE | EXT4_FEATURE_INCOMPAT_RECOVER | \
+   EXT4_FEATURE_INCOMPAT_META_BG | EXT4_FEATURE_INCOMPAT_EXTENTS | \
+   EXT4_FEATURE_INCOMPAT_64BIT | EXT4_FEATURE_INCOMPAT_MMP | \
+   EXT4_FEATURE_INCOMPAT_FLEX_BG | EXT4_FEATURE_INCOMPAT_EA_INODE | \
+   EXT4_FEATURE_INCOMPAT_CSUM_SEED | EXT4_FEATURE_INCOMPAT_LARGEDIR | \
+   EXT4_FEATURE_INCOMPAT_INLINE_DATA | EXT4_FEATURE_INCOMPAT_ENCRYPT | \
+   EXT4_FEATURE_INCOMPAT_CASEFOLD)
+
+//
+// s_flags
+//
+#define EXT4_FLAGS_SIGNED_HASH    0x0001
+#define EXT4_FLAGS_UNSIGNED_HASH  0x0002
+
+typedef struct {
+  UINT32    s_inodes_count;
+  UINT32    s_blocks_count_lo;
+  UINT32    s_r_blocks_count_lo;
+  UINT32    s_free_blocks_count_lo;
+  UINT32    s_free_inodes_count;
+  UINT32    s_first_data_block;
+  UINT32    s_log_block_size;
+  UINT32    s_log_cluster_size;
+  UINT32    s_blocks_per_group;
+  UINT32    s_clusters_per_group;
+  UINT32    s_inodes_per_group;
+  UINT32    s_mtime;
+  UINT32    s_wtime;
+  UINT16    s_mnt_count;
+  UINT16    s_max_mnt_count;
+  UINT16    s_magic;
+  UINT16    s_state;
+  UINT16    s_errors;
+  UINT16    s_minor_rev_level;
+  UINT32    s_lastcheck;
+  UINT32    s_checkinterval;
+  UINT32    s_creator_os;
+  UINT32    s_rev_level;
+  UINT16    s_def_resuid;
+  UINT16    s_def_resgid;
+  //
+  // EXT4_DYNAMIC_REV superblocks only.
+  //
+  UINT32    s_first_ino;
+  UINT16    s_inode_size;
+  UINT16    s_block_group_nr;
+  UINT32    s_feature_compat;
+  UINT32    s_feature_incompat;
+  UINT32    s_feature_ro_compat;
+  UINT8     s_uuid[16];
+  CHAR8     s_volume_name[EXT4_VOLUME_NAME_SIZE];
+  CHAR8     s_last_mounted[64];
+  UINT32    s_algorithm_usage_bitmap;
+  UINT8     s_prealloc_blocks;
+  UINT8     s_prealloc_dir_blocks;
+  UINT16    s_reserved_gdt_blocks;
+  UINT8     s_journal_uuid[16];
+  UINT32    s_journal_inum;
+  UINT32    s_journal_dev;
+  UINT32    s_last_orphan;
+  UINT32    s_hash_seed[4];
+  UINT8     s_def_hash_version;
+  UINT8     s_jnl_backup_type;
+  UINT16    s_desc_size;
+  UINT32    s_default_mount_opts;
+  UINT32    s_first_meta_bg;
+  UINT32    s_mkfs_time;
+  UINT32    s_jnl_blocks[17];
+  UINT32    s_blocks_count_hi;
+  UINT32    s_r_blocks_count_hi;
+  UINT32    s_free_blocks_count_hi;
+  UINT16    s_min_extra_isize;
+  UINT16    s_want_extra_isize;
+  UINT32    s_flags;
+  UINT8     s_reserved1[232];
+  UINT32    s_backup_bgs[2];
+  UINT8     s_reserved2[28];
+  UINT32    s_checksum_seed;
+  UINT8     s_reserved3[392];
+  UINT32    s_checksum;
+} EXT4_SUPERBLOCK;
+
+STATIC_ASSERT (sizeof (EXT4_SUPERBLOCK) == EXT4_SUPERBLOCK_SIZE, "EXT4_SUPERBLOCK is not 1024 bytes");
+
+//
+// Block group descriptor. The fields after bg_checksum only exist if the
+// 64BIT feature is set and s_desc_size is at least 64.
+//
+typedef struct {
+  UINT32    bg_block_bitmap_lo;
+  UINT32    bg_inode_bitmap_lo;
+  UINT32    bg_inode_table_lo;
+  UINT16    bg_free_blocks_count_lo;
+  UINT16    bg_free_inodes_count_lo;
+  UINT16    bg_used_dirs_count_lo;
+  UINT16    bg_flags;
+  UINT32    bg_exclude_bitmap_lo;
+  UINT16    bg_block_bitmap_csum_lo;
+  UINT16    bg_inode_bitmap_csum_lo;
+  UINT16    bg_itable_unused_lo;
+  UINT16    bg_checksum;
+  UINT32    bg_block_bitmap_hi;
+  UINT32    bg_inode_bitmap_hi;
+  UINT32    bg_inode_table_hi;
+  UINT16    bg_free_blocks_count_hi;
+  UINT16    bg_free_inodes_count_hi;
+  UINT16    bg_used_dirs_count_hi;
+  UINT16    bg_itable_unused_hi;
+  UINT32    bg_exclude_bitmap_hi;
+  UINT16    bg_block_bitmap_csum_hi;
+  UINT16    bg_inode_bitmap_csum_hi;
+  UINT32    bg_reserved;
+} EXT4_BLOCK_GROUP_DESC;
+
+//
+// i_mode file types
+//
+#define EXT4_INODE_TYPE_MASK     0xF000
+#define EXT4_INODE_TYPE_DIR      0x4000
+#define EXT4_INODE_TYPE_REGFILE  0x8000
+#define EXT4_INODE_TYPE_SYMLINK  0xA000
+
+//
+// i_flags
+//
+#define EXT4_ENCRYPT_FL      0x00000800
+#define EXT4_INDEX_FL        0x00001000
+#define EXT4_HUGE_FILE_FL    0x00040000
+#define EXT4_EXTENTS_FL      0x00080000
+#define EXT4_INLINE_DATA_FL  0x10000000
+#define EXT4_CASEFOLD_FL     0x40000000
+
+#define EXT4_N_BLOCKS    15
+#define EXT4_NDIR_BLOCKS 12
+#define EXT4_IND_BLOCK   12
+#define EXT4_DIND_BLOCK  13
+#define EXT4_TIND_BLOCK  14
+
+//
+// Inode. The fields after i_osd2 only exist if the inode size is larger than
+// EXT4_GOOD_OLD_INODE_SIZE, and only up to EXT4_GOOD_OLD_INODE_SIZE +
+// i_extra_isize.
+//
+typedef struct {
+  UINT16    i_mode;
+  UINT16    i_uid;
+  UINT32    i_size_lo;
+  UINT32    i_atime;
+  UINT32    i_ctime;
+  UINT32    i_mtime;
+  UINT32    i_dtime;
+  UINT16    i_gid;
+  UINT16    i_links_count;
+  UINT32    i_blocks_lo;
+  UINT32    i_flags;
+  UINT32    i_version;
+  UINT32    i_block[EXT4_N_BLOCKS];
+  UINT32    i_generation;
+  UINT32    i_file_acl_lo;
+  UINT32    i_size_high;
+  UINT32    i_obso_faddr;
+  UINT16    l_i_blocks_high;
+  UINT16    l_i_file_acl_high;
+  UINT16    l_i_uid_high;
+  UINT16    l_i_gid_high;
+  UINT16    l_i_checksum_lo;
+  UINT16    l_i_reserved;
+  UINT16    i_extra_isize;
+  UINT16    i_checksum_hi;
+  UINT32    i_ctime_extra;
+  UINT32    i_mtime_extra;
+  UINT32    i_atime_extra;
+  UINT32    i_crtime;
+  UINT32    i_crtime_extra;
+  UINT32    i_version_hi;
+  UINT32    i_projid;
+} EXT4_INODE;
+
+//
+// The extent tree. i_block of an inode with EXT4_EXTENTS_FL, and every node
+// block of the tree, start with an EXT4_EXTENT_HEADER followed by eh_entries
+// EXT4_EXTENT_INDEX (eh_depth > 0) or EXT4_EXTENT (eh_depth == 0) entries,
+// sorted by the first logical block they map.
+//
+#define EXT4_EXTENT_HEADER_MAGIC  0xF30A
+#define EXT4_EXTENT_TREE_MAX_DEPTH  5
+
+//
+// An ee_len above EXT4_EXTENT_MAX_INIT_LEN marks an unwritten extent of
+// ee_len - EXT4_EXTENT_MAX_INIT_LEN blocks, which reads as zeros.
+//
+#define EXT4_EXTENT_MAX_INIT_LEN  32768
+
+typedef struct {
+  UINT16    eh_magic;
+  UINT16    eh_entries;
+  UINT16    eh_max;
+  UINT16    eh_depth;
+  UINT32    eh_generation;
+} EXT4_EXTENT_HEADER;
+
+typedef struct {
+  UINT32    ei_block;
+  UINT32    ei_leaf_lo;
+  UINT16    ei_leaf_hi;
+  UINT16    ei_unused;
+} EXT4_EXTENT_INDEX;
+
+typedef struct {
+  UINT32    ee_block;
+  UINT16    ee_len;
+  UINT16    ee_start_hi;
+  UINT32    ee_start_lo;
+} EXT4_EXTENT;
+
+//
+// Directory entries. rec_len is the distance to the next entry; with 64KB
+// blocks, EXT4_DIR_ENTRY_MAX_REC_LEN and 0 both stand for a whole block.
+//
+#define EXT4_NAME_MAX                 255
+#define EXT4_DIR_ENTRY_MIN_SIZE       8
+#define EXT4_DIR_ENTRY_MAX_REC_LEN    65535
+
+#define EXT4_FT_UNKNOWN   0
+#define EXT4_FT_REG_FILE  1
+#define EXT4_FT_DIR       2
+#define EXT4_FT_SYMLINK   7
+
+typedef struct {
+  UINT32    inode;
+  UINT16    rec_len;
+  UINT8     name_len;
+  UINT8     file_type;
+  CHAR8     name[EXT4_NAME_MAX];
+} EXT4_DIR_ENTRY;
+
+//
+// Hashed (htree) directories. Block 0 of a directory with EXT4_INDEX_FL holds
+// the "." and ".." entries, an EXT4_DX_ROOT_INFO and the first level of
+// EXT4_DX_ENTRY entries; the first entry has no hash and holds an
+// EXT4_DX_COUNT_LIMIT in its place. Interior nodes hold an empty directory
+// entry spanning the block followed by entries in the same format. Entry
+// blocks are logical blocks of the directory.
+//
+#define EXT4_DX_ROOT_ENTRIES_OFFSET  (2 * 12)
+#define EXT4_DX_NODE_ENTRIES_OFFSET  EXT4_DIR_ENTRY_MIN_SIZE
+#define EXT4_DX_BLOCK_MASK           0x0FFFFFFF
+
+#define EXT4_HTREE_MAX_LEVELS           2
+#define EXT4_HTREE_MAX_LEVELS_LARGEDIR  3
+
+#define EXT4_DX_HASH_LEGACY             0
+#define EXT4_DX_HASH_HALF_MD4           1
+#define EXT4_DX_HASH_TEA                2
+#define EXT4_DX_HASH_LEGACY_UNSIGNED    3
+#define EXT4_DX_HASH_HALF_MD4_UNSIGNED  4
+#define EXT4_DX_HASH_TEA_UNSIGNED       5
+
+typedef struct {
+  UINT32    reserved_zero;
+  UINT8     hash_version;
+  UINT8     info_length;
+  UINT8     indirect_levels;
+  UINT8     unused_flags;
+} EXT4_DX_ROOT_INFO;
+
+typedef struct {
+  UINT16    limit;
+  UINT16    count;
+} EXT4_DX_COUNT_LIMIT;
+
+typedef struct {
+  UINT32    hash;
+  UINT32    block;
+} EXT4_DX_ENTRY;
+
+#endif
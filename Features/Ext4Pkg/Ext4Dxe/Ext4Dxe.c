@@ -0,0 +1,443 @@
+/** @file
+  Driver binding, component name and entry point of the read-only ext4 file
+  system driver.
+
+  Copyright (c) 2021, EDK II contributors. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "Ext4Dxe.h"
+
+GLOBAL_REMOVE_IF_UNREFERENCED EFI_UNICODE_STRING_TABLE  mExt4DriverNameTable[] = {
+  {
+    "eng;en",
+    L"Ext4 File System Driver"
+  },
+  {
+    NULL,
+    NULL
+  }
+};
+
+GLOBAL_REMOVE_IF_UNREFERENCED EFI_UNICODE_STRING_TABLE  mExt4ControllerNameTable[] = {
+  {
+    "eng;en",
+    L"Ext4 File System"
+  },
+  {
+    NULL,
+    NULL
+  }
+};
+
+/**
+  Retrieve a Unicode string that is the user readable name of the driver.
+
+  @param[in]  This              A pointer to the EFI_COMPONENT_NAME2_PROTOCOL
+                                or EFI_COMPONENT_NAME_PROTOCOL instance.
+  @param[in]  Language          A pointer to a Null-terminated ASCII string
+                                array indicating the language.
+  @param[out] DriverName        A pointer to the Unicode string to return.
+
+  @retval EFI_SUCCESS           The Unicode string for the Driver specified by
+                                This and the language specified by Language was
+                                returned in DriverName.
+  @retval EFI_INVALID_PARAMETER Language or DriverName is NULL.
+  @retval EFI_UNSUPPORTED       The driver specified by This does not support
+                                the language specified by Language.
+
+**/
+EFI_STATUS
+EFIAPI
+Ext4ComponentNameGetDriverName (
+  IN  EFI_COMPONENT_NAME_PROTOCOL  *This,
+  IN  CHAR8                        *Language,
+  OUT CHAR16                       **DriverName
+  )
+{
+  return LookupUnicodeString2 (
+           Language,
+           This->SupportedLanguages,
+           mExt4DriverNameTable,
+           DriverName,
+           (BOOLEAN)(This == &gExt4ComponentName)
+           );
+}
+
+/**
+  Retrieve a Unicode string that is the user readable name of the controller
+  that is being managed by the driver.
+
+  @param[in]  This              A pointer to the EFI_COMPONENT_NAME2_PROTOCOL
+                                or EFI_COMPONENT_NAME_PROTOCOL instance.
+  @param[in]  ControllerHandle  The handle of a controller that the driver
+                                specified by This is managing.
+  @param[in]  ChildHandle       The handle of the child controller to retrieve
+                                the name of. This driver has no children.
+  @param[in]  Language          A pointer to a Null-terminated ASCII string
+                                array indicating the language.
+  @param[out] ControllerName    A pointer to the Unicode string to return.
+
+  @retval EFI_SUCCESS           The Unicode string for the controller was
+                                returned in ControllerName.
+  @retval EFI_INVALID_PARAMETER Language or ControllerName is NULL.
+  @retval EFI_UNSUPPORTED       The driver specified by This is not currently
+                                managing ControllerHandle, ChildHandle is not
+                                NULL, or the language is not supported.
+
+**/
+EFI_STATUS
+EFIAPI
+Ext4ComponentNameGetControllerName (
+  IN  EFI_COMPONENT_NAME_PROTOCOL  *This,
+  IN  EFI_HANDLE                   ControllerHandle,
+  IN  EFI_HANDLE                   ChildHandle        OPTIONAL,
+  IN  CHAR8                        *Language,
+  OUT CHAR16                       **ControllerName
+  )
+{
+  EFI_STATUS  Status;
+
+  if (ChildHandle != NULL) {
+    return EFI_UNSUPPORTED;
+  }
+
+  Status = EfiTestManagedDevice (
+             ControllerHandle,
+             gExt4DriverBinding.DriverBindingHandle,
+             &gEfiDiskIoProtocolGuid
+             );
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  return LookupUnicodeString2 (
+           Language,
+           This->SupportedLanguages,
+           mExt4ControllerNameTable,
+           ControllerName,
+           (BOOLEAN)(This == &gExt4ComponentName)
+           );
+}
+
+GLOBAL_REMOVE_IF_UNREFERENCED EFI_COMPONENT_NAME_PROTOCOL  gExt4ComponentName = {
+  Ext4ComponentNameGetDriverName,
+  Ext4ComponentNameGetControllerName,
+  "eng"
+};
+
+GLOBAL_REMOVE_IF_UNREFERENCED EFI_COMPONENT_NAME2_PROTOCOL  gExt4ComponentName2 = {
+  (EFI_COMPONENT_NAME2_GET_DRIVER_NAME)Ext4ComponentNameGetDriverName,
+  (EFI_COMPONENT_NAME2_GET_CONTROLLER_NAME)Ext4ComponentNameGetControllerName,
+  "en"
+};
+
+/**
+  Test to see if this driver can add a file system to ControllerHandle.
+  ControllerHandle must support both Disk IO and Block IO protocols.
+
+  @param[in]  This                  Protocol instance pointer.
+  @param[in]  ControllerHandle      Handle of device to test.
+  @param[in]  RemainingDevicePath   Not used.
+
+  @retval EFI_SUCCESS               This driver supports this device.
+  @retval EFI_ALREADY_STARTED       This driver is already running on this
+                                    device.
+  @return other                     This driver does not support this device.
+
+**/
+EFI_STATUS
+EFIAPI
+Ext4DriverBindingSupported (
+  IN EFI_DRIVER_BINDING_PROTOCOL  *This,
+  IN EFI_HANDLE                   ControllerHandle,
+  IN EFI_DEVICE_PATH_PROTOCOL     *RemainingDevicePath
+  )
+{
+  EFI_STATUS            Status;
+  EFI_DISK_IO_PROTOCOL  *DiskIo;
+
+  Status = gBS->OpenProtocol (
+                  ControllerHandle,
+                  &gEfiDiskIoProtocolGuid,
+                  (VOID **)&DiskIo,
+                  This->DriverBindingHandle,
+                  ControllerHandle,
+                  EFI_OPEN_PROTOCOL_BY_DRIVER
+                  );
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  gBS->CloseProtocol (
+         ControllerHandle,
+         &gEfiDiskIoProtocolGuid,
+         This->DriverBindingHandle,
+         ControllerHandle
+         );
+
+  return gBS->OpenProtocol (
+                ControllerHandle,
+                &gEfiBlockIoProtocolGuid,
+                NULL,
+                This->DriverBindingHandle,
+                ControllerHandle,
+                EFI_OPEN_PROTOCOL_TEST_PROTOCOL
+                );
+}
+
+/**
+  Start this driver on ControllerHandle by opening its Block IO and Disk IO
+  protocols, and add a Simple File System protocol to ControllerHandle if the
+  media holds an ext4 file system.
+
+  @param[in]  This                  Protocol instance pointer.
+  @param[in]  ControllerHandle      Handle of device to bind driver to.
+  @param[in]  RemainingDevicePath   Not used.
+
+  @retval EFI_SUCCESS               This driver is added to ControllerHandle.
+  @retval EFI_OUT_OF_RESOURCES      Can not allocate the memory.
+  @return other                     This driver does not support this device.
+
+**/
+EFI_STATUS
+EFIAPI
+Ext4DriverBindingStart (
+  IN EFI_DRIVER_BINDING_PROTOCOL  *This,
+  IN EFI_HANDLE                   ControllerHandle,
+  IN EFI_DEVICE_PATH_PROTOCOL     *RemainingDevicePath
+  )
+{
+  EFI_STATUS             Status;
+  EFI_BLOCK_IO_PROTOCOL  *BlockIo;
+  EFI_DISK_IO_PROTOCOL   *DiskIo;
+  EFI_DISK_IO2_PROTOCOL  *DiskIo2;
+
+  Status = gBS->OpenProtocol (
+                  ControllerHandle,
+                  &gEfiBlockIoProtocolGuid,
+                  (VOID **)&BlockIo,
+                  This->DriverBindingHandle,
+                  ControllerHandle,
+                  EFI_OPEN_PROTOCOL_GET_PROTOCOL
+                  );
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Status = gBS->OpenProtocol (
+                  ControllerHandle,
+                  &gEfiDiskIoProtocolGuid,
+                  (VOID **)&DiskIo,
+                  This->DriverBindingHandle,
+                  ControllerHandle,
+                  EFI_OPEN_PROTOCOL_BY_DRIVER
+                  );
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Status = gBS->OpenProtocol (
+                  ControllerHandle,
+                  &gEfiDiskIo2ProtocolGuid,
+                  (VOID **)&DiskIo2,
+                  This->DriverBindingHandle,
+                  ControllerHandle,
+                  EFI_OPEN_PROTOCOL_BY_DRIVER
+                  );
+  if (EFI_ERROR (Status)) {
+    DiskIo2 = NULL;
+  }
+
+  Status = Ext4OpenPartition (ControllerHandle, DiskIo, DiskIo2, BlockIo);
+  if (EFI_ERROR (Status)) {
+    gBS->CloseProtocol (
+           ControllerHandle,
+           &gEfiDiskIoProtocolGuid,
+           This->DriverBindingHandle,
+           ControllerHandle
+           );
+    if (DiskIo2 != NULL) {
+      gBS->CloseProtocol (
+             ControllerHandle,
+             &gEfiDiskIo2ProtocolGuid,
+             This->DriverBindingHandle,
+             ControllerHandle
+             );
+    }
+  }
+
+  return Status;
+}
+
+/**
+  Stop this driver on ControllerHandle.
+
+  @param[in]  This                  Protocol instance pointer.
+  @param[in]  ControllerHandle      Handle of device to stop driver on.
+  @param[in]  NumberOfChildren      Not used.
+  @param[in]  ChildHandleBuffer     Not used.
+
+  @retval EFI_SUCCESS               This driver is removed from
+                                    ControllerHandle.
+  @retval EFI_ACCESS_DENIED         Files are still open on the volume.
+  @return other                     This driver was not removed from this
+                                    device.
+
+**/
+EFI_STATUS
+EFIAPI
+Ext4DriverBindingStop (
+  IN EFI_DRIVER_BINDING_PROTOCOL  *This,
+  IN EFI_HANDLE                   ControllerHandle,
+  IN UINTN                        NumberOfChildren,
+  IN EFI_HANDLE                   *ChildHandleBuffer OPTIONAL
+  )
+{
+  EFI_STATUS                       Status;
+  EFI_SIMPLE_FILE_SYSTEM_PROTOCOL  *SimpleFs;
+  EXT4_PARTITION                   *Partition;
+  EFI_TPL                          OldTpl;
+
+  Status = gBS->OpenProtocol (
+                  ControllerHandle,
+                  &gEfiSimpleFileSystemProtocolGuid,
+                  (VOID **)&SimpleFs,
+                  This->DriverBindingHandle,
+                  ControllerHandle,
+                  EFI_OPEN_PROTOCOL_GET_PROTOCOL
+                  );
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Partition = EXT4_PARTITION_FROM_SIMPLE_FS (SimpleFs);
+
+  OldTpl = gBS->RaiseTPL (TPL_CALLBACK);
+  Status = Ext4UnmountAndFreePartition (Partition);
+  gBS->RestoreTPL (OldTpl);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  gBS->CloseProtocol (
+         ControllerHandle,
+         &gEfiDiskIoProtocolGuid,
+         This->DriverBindingHandle,
+         ControllerHandle
+         );
+  gBS->CloseProtocol (
+         ControllerHandle,
+         &gEfiDiskIo2ProtocolGuid,
+         This->DriverBindingHandle,
+         ControllerHandle
+         );
+
+  return EFI_SUCCESS;
+}
+
+EFI_DRIVER_BINDING_PROTOCOL  gExt4DriverBinding = {
+  Ext4DriverBindingSupported,
+  Ext4DriverBindingStart,
+  Ext4DriverBindingStop,
+  0x10,
+  NULL,
+  NULL
+};
+
+/**
+  Register Driver Binding protocol for this driver.
+
+  @param[in]  ImageHandle   Handle for the image of this driver.
+  @param[in]  SystemTable   Pointer to the EFI System Table.
+
+  @retval EFI_SUCCESS       Driver loaded.
+  @return other             Driver not loaded.
+
+**/
+EFI_STATUS
+EFIAPI
+Ext4EntryPoint (
+  IN EFI_HANDLE        ImageHandle,
+  IN EFI_SYSTEM_TABLE  *SystemTable
+  )
+{
+  EFI_STATUS  Status;
+
+  Status = EfiLibInstallDriverBindingComponentName2 (
+             ImageHandle,
+             SystemTable,
+             &gExt4DriverBinding,
+             ImageHandle,
+             &gExt4ComponentName,
+             &gExt4ComponentName2
+             );
+  ASSERT_EFI_ERROR (Status);
+
+  return Status;
+}
+
+/**
+  Unload function for this image. Disconnect the driver from every device
+  and uninstall its protocols.
+
+  @param[in]  ImageHandle   Handle for the image of this driver.
+
+  @retval EFI_SUCCESS       Driver unloaded successfully.
+  @return other             Driver can not be unloaded.
+
+**/
+EFI_STATUS
+EFIAPI
+Ext4Unload (
+  IN EFI_HANDLE  ImageHandle
+  )
+{
+  EFI_STATUS  Status;
+  EFI_HANDLE  *DeviceHandleBuffer;
+  UINTN       DeviceHandleCount;
+  UINTN       Index;
+
+  Status = gBS->LocateHandleBuffer (
+                  AllHandles,
+                  NULL,
+                  NULL,
+                  &DeviceHandleCount,
+                  &DeviceHandleBuffer
+                  );
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  for (Index = 0; Index < DeviceHandleCount; Index++) {
+    Status = EfiTestManagedDevice (DeviceHandleBuffer[Index], ImageHandle, &gEfiDiskIoProtocolGuid);
+    if (!EFI_ERROR (Status)) {
+      Status = gBS->DisconnectController (
+                      DeviceHandleBuffer[Index],
+                      ImageHandle,
+                      NULL
+                      );
+      if (EFI_ERROR (Status)) {
+        break;
+      }
+    }
+  }
+
+  FreePool (DeviceHandleBuffer);
+
+  if (Index != DeviceHandleCount) {
+    return Status;
+  }
+
+  return gBS->UninstallMultipleProtocolInterfaces (
+                ImageHandle,
+                &gEfiDriverBindingProtocolGuid,
+                &gExt4DriverBinding,
+                &gEfiComponentNameProtocolGuid,
+                &gExt4ComponentName,
+                &gEfiComponentName2ProtocolGuid,
+                &gExt4ComponentName2,
+                NULL
+                );
+}
@@ -0,0 +1,1084 @@
+/** @file
+  Main header file of the read-only ext4 file system driver.
+
+  Copyright (c) 2021, EDK II contributors. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef _EXT4_DXE_H_
+#define _EXT4_DXE_H_
+
+#include <Uefi.h>
+
+#include <Guid/FileInfo.h>
+#include <Guid/FileSystemInfo.h>
+#include <Guid/FileSystemVolumeLabelInfo.h>
+#include <Protocol/BlockIo.h>
+#include <Protocol/DiskIo.h>
+#include <Protocol/DiskIo2.h>
+#include <Protocol/FileBulkRead.h>
+#include <Protocol/SimpleFileSystem.h>
+
+#include <Library/DebugLib.h>
+#include <Library/UefiLib.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/UefiDriverEntryPoint.h>
+#include <Library/UefiBootServicesTableLib.h>
+
+#include "Ext4Disk.h"
+
+#define EXT4_PARTITION_SIGNATURE      SIGNATURE_32 ('e', 'x', 't', 'p')
+#define EXT4_FILE_SIGNATURE           SIGNATURE_32 ('e', 'x', 't', 'f')
+#define EXT4_CACHED_INODE_SIGNATURE   SIGNATURE_32 ('e', 'x', 't', 'i')
+#define EXT4_CACHED_DENTRY_SIGNATURE  SIGNATURE_32 ('e', 'x', 't', 'd')
+
+#define EXT4_PARTITION_FROM_SIMPLE_FS(a)  CR (a, EXT4_PARTITION, Interface, EXT4_PARTITION_SIGNATURE)
+#define EXT4_PARTITION_FROM_BULK_READ(a)  CR (a, EXT4_PARTITION, BulkRead, EXT4_PARTITION_SIGNATURE)
+#define EXT4_FILE_FROM_THIS(a)            CR (a, EXT4_FILE, Protocol, EXT4_FILE_SIGNATURE)
+#define EXT4_FILE_FROM_OPEN_FILES_LINK(a) CR (a, EXT4_FILE, OpenFilesLink, EXT4_FILE_SIGNATURE)
+
+#define EXT4_CACHED_INODE_FROM_LRU_LINK(a)    CR (a, EXT4_CACHED_INODE, LruLink, EXT4_CACHED_INODE_SIGNATURE)
+#define EXT4_CACHED_INODE_FROM_HASH_LINK(a)   CR (a, EXT4_CACHED_INODE, HashLink, EXT4_CACHED_INODE_SIGNATURE)
+#define EXT4_CACHED_DENTRY_FROM_LRU_LINK(a)   CR (a, EXT4_CACHED_DENTRY, LruLink, EXT4_CACHED_DENTRY_SIGNATURE)
+#define EXT4_CACHED_DENTRY_FROM_HASH_LINK(a)  CR (a, EXT4_CACHED_DENTRY, HashLink, EXT4_CACHED_DENTRY_SIGNATURE)
+
+//
+// The number of symbolic links followed while opening a single path.
+//
+#define EXT4_MAX_SYMLINK_DEPTH  8
+
+//
+// The longest path, in bytes of UTF-8, that Open() walks, symbolic link
+// targets included.
+//
+#define EXT4_MAX_PATH_LENGTH  4096
+
+//
+// The number of EFI_DISK_IO2_PROTOCOL reads a volume keeps in flight while
+// reading the runs of a file.
+//
+#define EXT4_MAX_READS_IN_FLIGHT  8
+
+//
+// The readahead window of a file starts at EXT4_MIN_READAHEAD bytes and
+// doubles on each sequential read, up to EXT4_MAX_READAHEAD bytes.
+//
+#define EXT4_MIN_READAHEAD  SIZE_32KB
+#define EXT4_MAX_READAHEAD  SIZE_1MB
+
+//
+// The inode and directory entry caches of a volume. Like the directory cache
+// of FatPkg, each is a hash table plus a least recently used list, and the
+// least recently used entries are dropped once the memory held by the cache
+// exceeds its maximum size.
+//
+#define EXT4_INODE_CACHE_HASH_SIZE   0x40
+#define EXT4_DENTRY_CACHE_HASH_SIZE  0x100
+#define EXT4_MAX_INODE_CACHE_SIZE    SIZE_512KB
+#define EXT4_MAX_DENTRY_CACHE_SIZE   SIZE_256KB
+
+//
+// A run of physically contiguous blocks of a file, decoded from the extent
+// tree or from the indirect block map of its inode.
+//
+typedef struct {
+  UINT64     FileBlock;
+  UINT64     DiskBlock;
+  UINT32     Length;
+  //
+  // The run belongs to an unwritten extent and reads as zeros.
+  //
+  BOOLEAN    Unwritten;
+} EXT4_BLOCK_RUN;
+
+//
+// The runs of a file, sorted by FileBlock and non-overlapping. Blocks not
+// covered by a run are holes.
+//
+typedef struct {
+  UINTN             Count;
+  UINTN             Capacity;
+  EXT4_BLOCK_RUN    *Runs;
+} EXT4_BLOCK_MAP;
+
+//
+// An inode in the inode cache of a volume, with the block map of the file
+// once one was built. The block map is handed to the next EXT4_FILE opening
+// the inode, and given back when that file is closed.
+//
+typedef struct {
+  UINT32            Signature;
+  LIST_ENTRY        LruLink;
+  LIST_ENTRY        HashLink;
+  UINT32            InodeNum;
+  EXT4_INODE        *Inode;
+  BOOLEAN           BlockMapValid;
+  EXT4_BLOCK_MAP    BlockMap;
+} EXT4_CACHED_INODE;
+
+//
+// The result of looking a name up in a directory. InodeNum is 0 if the
+// directory has no entry of that name.
+//
+typedef struct {
+  UINT32        Signature;
+  LIST_ENTRY    LruLink;
+  LIST_ENTRY    HashLink;
+  UINT32        ParentInodeNum;
+  UINT32        NameHash;
+  UINT32        InodeNum;
+  UINT8         NameLength;
+  CHAR8         Name[1];
+} EXT4_CACHED_DENTRY;
+
+typedef struct {
+  UINT32                             Signature;
+  EFI_SIMPLE_FILE_SYSTEM_PROTOCOL    Interface;
+  EDKII_FILE_BULK_READ_PROTOCOL      BulkRead;
+  EFI_HANDLE                         Handle;
+
+  EFI_BLOCK_IO_PROTOCOL              *BlockIo;
+  EFI_DISK_IO_PROTOCOL               *DiskIo;
+  EFI_DISK_IO2_PROTOCOL              *DiskIo2;
+
+  EXT4_SUPERBLOCK                    SuperBlock;
+  UINT32                             FeaturesCompat;
+  UINT32                             FeaturesIncompat;
+  UINT32                             FeaturesRoCompat;
+  UINT32                             BlockSize;
+  UINTN                              BlockLogSize;
+  UINT64                             NumberBlocks;
+  UINT32                             NumberGroups;
+  UINT32                             DescSize;
+  UINT32                             DescPerBlock;
+  UINT32                             InodeSize;
+  UINT8                              HashVersionOffset;
+
+  //
+  // The block group descriptor cache: the first block of the inode table of
+  // each group, or 0 if the descriptor block of the group has not been read
+  // yet. Descriptor blocks are read on demand and decoded as a whole.
+  //
+  UINT64                             *InodeTables;
+
+  //
+  // The EFI_DISK_IO2_PROTOCOL requests of the volume, used as a ring:
+  // ReadsInFlight requests starting at index FirstRead are outstanding.
+  // Only set up when the disk produces EFI_DISK_IO2_PROTOCOL.
+  //
+  EFI_DISK_IO2_TOKEN                 ReadTokens[EXT4_MAX_READS_IN_FLIGHT];
+  UINTN                              FirstRead;
+  UINTN                              ReadsInFlight;
+
+  //
+  // The inode and directory entry caches, shared by all the files of the
+  // volume. The LRU lists are ordered from the most recently used entry.
+  //
+  LIST_ENTRY                         InodeCacheList;
+  LIST_ENTRY                         InodeCacheHashTable[EXT4_INODE_CACHE_HASH_SIZE];
+  UINTN                              InodeCacheSize;
+  LIST_ENTRY                         DentryCacheList;
+  LIST_ENTRY                         DentryCacheHashTable[EXT4_DENTRY_CACHE_HASH_SIZE];
+  UINTN                              DentryCacheSize;
+
+  //
+  // The EXT4_FILE instances open on the volume.
+  //
+  LIST_ENTRY                         OpenFiles;
+} EXT4_PARTITION;
+
+typedef struct {
+  UINT32               Signature;
+  EFI_FILE_PROTOCOL    Protocol;
+  EXT4_PARTITION       *Partition;
+  LIST_ENTRY           OpenFilesLink;
+
+  UINT32               InodeNum;
+  EXT4_INODE           *Inode;
+  UINT64               Size;
+  UINT64               Position;
+  UINT64               OpenMode;
+  CHAR16               *FileName;
+
+  //
+  // The decoded block map of the inode, built on the first read and kept
+  // until the file is closed.
+  //
+  BOOLEAN              BlockMapValid;
+  EXT4_BLOCK_MAP       BlockMap;
+
+  //
+  // The directory block read last by Ext4ReadDir(), so that listing a
+  // directory reads each of its blocks once.
+  //
+  UINT8                *DirBlock;
+  UINT64               DirBlockNumber;
+
+  //
+  // The readahead buffer of the file, holding ReadAheadLength bytes of data
+  // from ReadAheadOffset. ReadAheadWindow is the number of bytes the next
+  // sequential read fetches, and NextReadOffset the position at which a read
+  // is sequential.
+  //
+  UINT8                *ReadAhead;
+  UINT64               ReadAheadOffset;
+  UINTN                ReadAheadLength;
+  UINTN                ReadAheadWindow;
+  UINT64               NextReadOffset;
+} EXT4_FILE;
+
+//
+// Global Variables
+//
+extern EFI_DRIVER_BINDING_PROTOCOL   gExt4DriverBinding;
+extern EFI_COMPONENT_NAME_PROTOCOL   gExt4ComponentName;
+extern EFI_COMPONENT_NAME2_PROTOCOL  gExt4ComponentName2;
+extern EFI_FILE_PROTOCOL             gExt4FileProtocolTemplate;
+
+//
+// DiskUtil.c
+//
+
+/**
+  Read bytes from the volume.
+
+  @param[in]  Partition   The volume.
+  @param[in]  Offset      The byte offset on the volume.
+  @param[in]  Length      The number of bytes to read.
+  @param[out] Buffer      The buffer receiving the data.
+
+  @retval EFI_SUCCESS     The data was read.
+  @return others          The error returned by EFI_DISK_IO_PROTOCOL.
+
+**/
+EFI_STATUS
+Ext4ReadDiskIo (
+  IN  EXT4_PARTITION  *Partition,
+  IN  UINT64          Offset,
+  IN  UINTN           Length,
+  OUT VOID            *Buffer
+  );
+
+/**
+  Create the events of the EFI_DISK_IO2_PROTOCOL requests of a volume.
+  Nothing is done if the disk does not produce EFI_DISK_IO2_PROTOCOL.
+
+  @param[in]  Partition   The volume.
+
+  @retval EFI_SUCCESS     The events were created.
+  @return others          An event could not be created.
+
+**/
+EFI_STATUS
+Ext4InitDiskReads (
+  IN EXT4_PARTITION  *Partition
+  );
+
+/**
+  Close the events created by Ext4InitDiskReads().
+
+  @param[in]  Partition   The volume.
+
+**/
+VOID
+Ext4FreeDiskReads (
+  IN EXT4_PARTITION  *Partition
+  );
+
+/**
+  Start reading bytes from the volume.
+
+  With EFI_DISK_IO2_PROTOCOL, the read is queued and Buffer must not be
+  used before Ext4WaitDiskReads() returns; up to EXT4_MAX_READS_IN_FLIGHT
+  reads are outstanding, and the oldest one is waited for when all are.
+  Without it, the data is read before returning.
+
+  @param[in]  Partition   The volume.
+  @param[in]  Offset      The byte offset on the volume.
+  @param[in]  Length      The number of bytes to read.
+  @param[out] Buffer      The buffer receiving the data.
+
+  @retval EFI_SUCCESS     The read was started.
+  @return others          The read, or an earlier one, failed.
+
+**/
+EFI_STATUS
+Ext4QueueDiskRead (
+  IN  EXT4_PARTITION  *Partition,
+  IN  UINT64          Offset,
+  IN  UINTN           Length,
+  OUT VOID            *Buffer
+  );
+
+/**
+  Wait for all the reads started by Ext4QueueDiskRead() to complete.
+
+  @param[in]  Partition   The volume.
+
+  @retval EFI_SUCCESS     All the reads succeeded.
+  @return others          The error of a failed read.
+
+**/
+EFI_STATUS
+Ext4WaitDiskReads (
+  IN EXT4_PARTITION  *Partition
+  );
+
+/**
+  Read whole blocks from the volume.
+
+  @param[in]  Partition   The volume.
+  @param[in]  Block       The first block to read.
+  @param[in]  Count       The number of blocks to read.
+  @param[out] Buffer      The buffer receiving the data.
+
+  @retval EFI_SUCCESS            The blocks were read.
+  @retval EFI_VOLUME_CORRUPTED   The blocks lie outside of the volume.
+  @return others                 The error returned by EFI_DISK_IO_PROTOCOL.
+
+**/
+EFI_STATUS
+Ext4ReadBlocks (
+  IN  EXT4_PARTITION  *Partition,
+  IN  UINT64          Block,
+  IN  UINTN           Count,
+  OUT VOID            *Buffer
+  );
+
+/**
+  Allocate a buffer and read whole blocks of the volume into it.
+
+  @param[in]  Partition   The volume.
+  @param[in]  Block       The first block to read.
+  @param[in]  Count       The number of blocks to read.
+
+  @return The buffer, to be freed with FreePool(), or NULL on error.
+
+**/
+VOID *
+Ext4AllocAndReadBlocks (
+  IN EXT4_PARTITION  *Partition,
+  IN UINT64          Block,
+  IN UINTN           Count
+  );
+
+/**
+  Return the byte offset on the volume of a block.
+
+  @param[in]  Partition   The volume.
+  @param[in]  Block       The block number.
+
+  @return The byte offset of Block.
+
+**/
+UINT64
+Ext4BlockToByteOffset (
+  IN EXT4_PARTITION  *Partition,
+  IN UINT64          Block
+  );
+
+//
+// Superblock.c
+//
+
+/**
+  Read and validate the superblock of a volume and initialize the volume
+  geometry and the block group descriptor cache.
+
+  @param[in, out] Partition     The volume, with BlockIo and DiskIo set.
+
+  @retval EFI_SUCCESS           The volume holds a supported ext2/3/4 file
+                                system.
+  @retval EFI_UNSUPPORTED       The volume does not hold an ext2/3/4 file
+                                system, or uses features this driver cannot
+                                read.
+  @retval EFI_OUT_OF_RESOURCES  The group descriptor cache could not be
+                                allocated.
+  @return others                An error occurred reading the volume.
+
+**/
+EFI_STATUS
+Ext4OpenSuperblock (
+  IN OUT EXT4_PARTITION  *Partition
+  );
+
+/**
+  Return the first block of the inode table of a block group, reading its
+  group descriptor block on a cache miss.
+
+  @param[in]  Partition          The volume.
+  @param[in]  Group              The block group.
+  @param[out] InodeTable         The first block of the inode table.
+
+  @retval EFI_SUCCESS            InodeTable was returned.
+  @retval EFI_VOLUME_CORRUPTED   Group or its descriptor is invalid.
+  @return others                 An error occurred reading the volume.
+
+**/
+EFI_STATUS
+Ext4GetInodeTable (
+  IN  EXT4_PARTITION  *Partition,
+  IN  UINT32          Group,
+  OUT UINT64          *InodeTable
+  );
+
+//
+// Inode.c
+//
+
+/**
+  Read an inode from the volume, or from its inode cache.
+
+  @param[in]  Partition          The volume.
+  @param[in]  InodeNum           The inode number.
+  @param[out] Inode              The inode, at least sizeof (EXT4_INODE)
+                                 bytes, to be freed with FreePool().
+
+  @retval EFI_SUCCESS            The inode was read.
+  @retval EFI_VOLUME_CORRUPTED   InodeNum is out of range.
+  @retval EFI_OUT_OF_RESOURCES   The inode could not be allocated.
+  @return others                 An error occurred reading the volume.
+
+**/
+EFI_STATUS
+Ext4ReadInode (
+  IN  EXT4_PARTITION  *Partition,
+  IN  UINT32          InodeNum,
+  OUT EXT4_INODE      **Inode
+  );
+
+/**
+  Return the size in bytes of the data of an inode.
+
+  @param[in]  Inode   The inode.
+
+  @return The size of the inode data.
+
+**/
+UINT64
+Ext4InodeSize (
+  IN EXT4_INODE  *Inode
+  );
+
+/**
+  Return the number of bytes the volume allocates to an inode.
+
+  @param[in]  Partition   The volume.
+  @param[in]  Inode       The inode.
+
+  @return The physical size of the inode.
+
+**/
+UINT64
+Ext4InodePhysicalSize (
+  IN EXT4_PARTITION  *Partition,
+  IN EXT4_INODE      *Inode
+  );
+
+/**
+  Check whether an inode is a directory.
+
+  @param[in]  Inode   The inode.
+
+  @retval TRUE        The inode is a directory.
+  @retval FALSE       The inode is not a directory.
+
+**/
+BOOLEAN
+Ext4InodeIsDir (
+  IN EXT4_INODE  *Inode
+  );
+
+/**
+  Check whether an inode is a symbolic link.
+
+  @param[in]  Inode   The inode.
+
+  @retval TRUE        The inode is a symbolic link.
+  @retval FALSE       The inode is not a symbolic link.
+
+**/
+BOOLEAN
+Ext4InodeIsSymlink (
+  IN EXT4_INODE  *Inode
+  );
+
+/**
+  Fill in the sizes, times and attributes of an EFI_FILE_INFO from an inode.
+
+  @param[in]  Partition   The volume.
+  @param[in]  Inode       The inode.
+  @param[out] Info        The EFI_FILE_INFO to fill in, except for Size and
+                          FileName.
+
+**/
+VOID
+Ext4InodeToFileInfo (
+  IN  EXT4_PARTITION  *Partition,
+  IN  EXT4_INODE      *Inode,
+  OUT EFI_FILE_INFO   *Info
+  );
+
+/**
+  Read data from an open file, whatever its position.
+
+  @param[in]  File               The file.
+  @param[in]  Offset             The byte offset in the file.
+  @param[in]  Length             The number of bytes to read. Offset + Length
+                                 must not be beyond the end of the file.
+  @param[out] Buffer             The buffer receiving the data.
+
+  @retval EFI_SUCCESS            The data was read.
+  @retval EFI_UNSUPPORTED        The file data is stored in a format this
+                                 driver cannot read.
+  @retval EFI_VOLUME_CORRUPTED   The block map of the file is invalid.
+  @return others                 An error occurred reading the volume.
+
+**/
+EFI_STATUS
+Ext4ReadFileData (
+  IN  EXT4_FILE  *File,
+  IN  UINT64     Offset,
+  IN  UINTN      Length,
+  OUT VOID       *Buffer
+  );
+
+/**
+  Read data from an open file through its readahead buffer.
+
+  Sequential reads smaller than the readahead window fetch a whole window
+  into the readahead buffer of the file, and the window grows with each
+  sequential read; other reads go straight to Ext4ReadFileData().
+
+  @param[in]  File               The file.
+  @param[in]  Offset             The byte offset in the file.
+  @param[in]  Length             The number of bytes to read. Offset + Length
+                                 must not be beyond the end of the file.
+  @param[out] Buffer             The buffer receiving the data.
+
+  @retval EFI_SUCCESS            The data was read.
+  @return others                 The error returned by Ext4ReadFileData().
+
+**/
+EFI_STATUS
+Ext4ReadFileDataAhead (
+  IN  EXT4_FILE  *File,
+  IN  UINT64     Offset,
+  IN  UINTN      Length,
+  OUT VOID       *Buffer
+  );
+
+//
+// Extents.c
+//
+
+/**
+  Decode the extent tree or the indirect block map of a file into its
+  block map.
+
+  @param[in, out] File           The file.
+
+  @retval EFI_SUCCESS            File->BlockMap is valid.
+  @retval EFI_VOLUME_CORRUPTED   The extent tree or block map is invalid.
+  @retval EFI_OUT_OF_RESOURCES   The block map could not be allocated.
+  @return others                 An error occurred reading the volume.
+
+**/
+EFI_STATUS
+Ext4BuildBlockMap (
+  IN OUT EXT4_FILE  *File
+  );
+
+/**
+  Free the block map of a file.
+
+  @param[in, out] File    The file.
+
+**/
+VOID
+Ext4FreeBlockMap (
+  IN OUT EXT4_FILE  *File
+  );
+
+/**
+  Find the run of a block map that maps a file block.
+
+  @param[in]  Map         The block map.
+  @param[in]  FileBlock   The file block.
+  @param[out] Next        If no run maps FileBlock, the first run after it,
+                          or NULL if there is none. Optional.
+
+  @return The run mapping FileBlock, or NULL if FileBlock is in a hole.
+
+**/
+EXT4_BLOCK_RUN *
+Ext4LookupBlockRun (
+  IN  EXT4_BLOCK_MAP  *Map,
+  IN  UINT64          FileBlock,
+  OUT EXT4_BLOCK_RUN  **Next OPTIONAL
+  );
+
+//
+// Hash.c
+//
+
+/**
+  Compute the htree hash of a directory entry name.
+
+  @param[in]  Partition     The volume, providing the hash seed.
+  @param[in]  HashVersion   One of the EXT4_DX_HASH_* algorithms.
+  @param[in]  Name          The name, in UTF-8.
+  @param[in]  NameLength    The length of Name in bytes.
+  @param[out] Hash          The major hash of Name.
+
+  @retval EFI_SUCCESS       Hash was computed.
+  @retval EFI_UNSUPPORTED   HashVersion is unknown.
+
+**/
+EFI_STATUS
+Ext4DirHash (
+  IN  EXT4_PARTITION  *Partition,
+  IN  UINT8           HashVersion,
+  IN  CONST CHAR8     *Name,
+  IN  UINTN           NameLength,
+  OUT UINT32          *Hash
+  );
+
+//
+// Directory.c
+//
+
+/**
+  Look a name up in a directory.
+
+  Directories with an htree index are searched through the index. A linear
+  scan is used for other directories, and for indexed directories whose
+  index is inconsistent or uses an unknown hash. Results, including names
+  that do not exist, are kept in the directory entry cache of the volume.
+
+  @param[in]  Dir                The directory.
+  @param[in]  Name               The name, in UTF-8.
+  @param[in]  NameLength         The length of Name in bytes.
+  @param[out] InodeNum           The inode number of the entry.
+
+  @retval EFI_SUCCESS            The entry was found.
+  @retval EFI_NOT_FOUND          Dir has no entry called Name.
+  @retval EFI_VOLUME_CORRUPTED   The directory is invalid.
+  @return others                 An error occurred reading the volume.
+
+**/
+EFI_STATUS
+Ext4LookupDirEntry (
+  IN  EXT4_FILE    *Dir,
+  IN  CONST CHAR8  *Name,
+  IN  UINTN        NameLength,
+  OUT UINT32       *InodeNum
+  );
+
+/**
+  Read the EFI_FILE_INFO of the next entry of an open directory and advance
+  its position.
+
+  @param[in, out] Dir            The directory.
+  @param[in, out] BufferSize     On input, the size of Buffer. On output, the
+                                 size of the EFI_FILE_INFO, or 0 at the end of
+                                 the directory.
+  @param[out]     Buffer         The buffer receiving the EFI_FILE_INFO.
+
+  @retval EFI_SUCCESS            The entry was returned, or the end of the
+                                 directory was reached.
+  @retval EFI_BUFFER_TOO_SMALL   Buffer is too small. The position is not
+                                 changed.
+  @retval EFI_VOLUME_CORRUPTED   The directory is invalid.
+  @return others                 An error occurred reading the volume.
+
+**/
+EFI_STATUS
+Ext4ReadDir (
+  IN OUT EXT4_FILE  *Dir,
+  IN OUT UINTN      *BufferSize,
+  OUT    VOID       *Buffer
+  );
+
+/**
+  Convert a UTF-8 string to a UCS-2 string.
+
+  Invalid sequences and characters outside of the Basic Multilingual Plane
+  are replaced with U+FFFD.
+
+  @param[in]  Utf8          The UTF-8 string.
+  @param[in]  Utf8Length    The length of Utf8 in bytes.
+  @param[out] Ucs2          The buffer receiving the null-terminated UCS-2
+                            string, at least Utf8Length + 1 characters.
+
+  @return The number of characters stored in Ucs2, excluding the terminator.
+
+**/
+UINTN
+Ext4Utf8ToUcs2 (
+  IN  CONST CHAR8  *Utf8,
+  IN  UINTN        Utf8Length,
+  OUT CHAR16       *Ucs2
+  );
+
+/**
+  Convert a null-terminated UCS-2 string to UTF-8.
+
+  @param[in]  Ucs2          The UCS-2 string.
+  @param[out] Utf8          The buffer receiving the UTF-8 string, not
+                            null-terminated.
+  @param[in]  Utf8Size      The size of Utf8 in bytes.
+
+  @return The length of the UTF-8 string in bytes, or MAX_UINTN if Utf8 is
+          too small or Ucs2 holds unpaired surrogates.
+
+**/
+UINTN
+Ext4Ucs2ToUtf8 (
+  IN  CONST CHAR16  *Ucs2,
+  OUT CHAR8         *Utf8,
+  IN  UINTN         Utf8Size
+  );
+
+//
+// File.c
+//
+
+/**
+  Create an EXT4_FILE for an inode of a volume.
+
+  @param[in]  Partition          The volume.
+  @param[in]  InodeNum           The inode number.
+  @param[in]  Inode              The inode, owned by the file on success.
+  @param[in]  FileName           The name returned in EFI_FILE_INFO.
+  @param[out] File               The new file.
+
+  @retval EFI_SUCCESS            The file was created.
+  @retval EFI_OUT_OF_RESOURCES   The file could not be allocated.
+
+**/
+EFI_STATUS
+Ext4CreateFile (
+  IN  EXT4_PARTITION  *Partition,
+  IN  UINT32          InodeNum,
+  IN  EXT4_INODE      *Inode,
+  IN  CONST CHAR16    *FileName,
+  OUT EXT4_FILE       **File
+  );
+
+/**
+  Close an EXT4_FILE and free its resources.
+
+  @param[in]  File    The file.
+
+**/
+VOID
+Ext4FreeFile (
+  IN EXT4_FILE  *File
+  );
+
+EFI_STATUS
+EFIAPI
+Ext4Open (
+  IN  EFI_FILE_PROTOCOL  *This,
+  OUT EFI_FILE_PROTOCOL  **NewHandle,
+  IN  CHAR16             *FileName,
+  IN  UINT64             OpenMode,
+  IN  UINT64             Attributes
+  );
+
+EFI_STATUS
+EFIAPI
+Ext4OpenEx (
+  IN     EFI_FILE_PROTOCOL  *This,
+  OUT    EFI_FILE_PROTOCOL  **NewHandle,
+  IN     CHAR16             *FileName,
+  IN     UINT64             OpenMode,
+  IN     UINT64             Attributes,
+  IN OUT EFI_FILE_IO_TOKEN  *Token
+  );
+
+EFI_STATUS
+EFIAPI
+Ext4Close (
+  IN EFI_FILE_PROTOCOL  *This
+  );
+
+EFI_STATUS
+EFIAPI
+Ext4Delete (
+  IN EFI_FILE_PROTOCOL  *This
+  );
+
+EFI_STATUS
+EFIAPI
+Ext4Read (
+  IN     EFI_FILE_PROTOCOL  *This,
+  IN OUT UINTN              *BufferSize,
+  OUT    VOID               *Buffer
+  );
+
+EFI_STATUS
+EFIAPI
+Ext4ReadEx (
+  IN     EFI_FILE_PROTOCOL  *This,
+  IN OUT EFI_FILE_IO_TOKEN  *Token
+  );
+
+EFI_STATUS
+EFIAPI
+Ext4Write (
+  IN     EFI_FILE_PROTOCOL  *This,
+  IN OUT UINTN              *BufferSize,
+  IN     VOID               *Buffer
+  );
+
+EFI_STATUS
+EFIAPI
+Ext4WriteEx (
+  IN     EFI_FILE_PROTOCOL  *This,
+  IN OUT EFI_FILE_IO_TOKEN  *Token
+  );
+
+EFI_STATUS
+EFIAPI
+Ext4GetPosition (
+  IN  EFI_FILE_PROTOCOL  *This,
+  OUT UINT64             *Position
+  );
+
+EFI_STATUS
+EFIAPI
+Ext4SetPosition (
+  IN EFI_FILE_PROTOCOL  *This,
+  IN UINT64             Position
+  );
+
+EFI_STATUS
+EFIAPI
+Ext4GetInfo (
+  IN     EFI_FILE_PROTOCOL  *This,
+  IN     EFI_GUID           *InformationType,
+  IN OUT UINTN              *BufferSize,
+  OUT    VOID               *Buffer
+  );
+
+EFI_STATUS
+EFIAPI
+Ext4SetInfo (
+  IN EFI_FILE_PROTOCOL  *This,
+  IN EFI_GUID           *InformationType,
+  IN UINTN              BufferSize,
+  IN VOID               *Buffer
+  );
+
+EFI_STATUS
+EFIAPI
+Ext4Flush (
+  IN EFI_FILE_PROTOCOL  *This
+  );
+
+EFI_STATUS
+EFIAPI
+Ext4FlushEx (
+  IN     EFI_FILE_PROTOCOL  *This,
+  IN OUT EFI_FILE_IO_TOKEN  *Token
+  );
+
+EFI_STATUS
+EFIAPI
+Ext4BulkReadFile (
+  IN     EDKII_FILE_BULK_READ_PROTOCOL  *This,
+  IN     EFI_FILE_PROTOCOL              *File,
+  IN OUT UINTN                          *BufferSize,
+  OUT    VOID                           *Buffer
+  );
+
+//
+// Partition.c
+//
+
+/**
+  Mount the ext4 file system of a disk and install EFI_SIMPLE_FILE_SYSTEM_PROTOCOL
+  and EDKII_FILE_BULK_READ_PROTOCOL on its handle.
+
+  @param[in]  Handle          The handle of the disk.
+  @param[in]  DiskIo          The EFI_DISK_IO_PROTOCOL of the disk.
+  @param[in]  DiskIo2         The EFI_DISK_IO2_PROTOCOL of the disk, or NULL.
+  @param[in]  BlockIo         The EFI_BLOCK_IO_PROTOCOL of the disk.
+
+  @retval EFI_SUCCESS         The file system was mounted.
+  @return others              The disk does not hold a supported file system,
+                              or an error occurred.
+
+**/
+EFI_STATUS
+Ext4OpenPartition (
+  IN EFI_HANDLE             Handle,
+  IN EFI_DISK_IO_PROTOCOL   *DiskIo,
+  IN EFI_DISK_IO2_PROTOCOL  *DiskIo2 OPTIONAL,
+  IN EFI_BLOCK_IO_PROTOCOL  *BlockIo
+  );
+
+/**
+  Unmount a volume and uninstall its protocols.
+
+  @param[in]  Partition       The volume.
+
+  @retval EFI_SUCCESS         The volume was unmounted.
+  @retval EFI_ACCESS_DENIED   Files are still open on the volume.
+  @return others              The protocols could not be uninstalled.
+
+**/
+EFI_STATUS
+Ext4UnmountAndFreePartition (
+  IN EXT4_PARTITION  *Partition
+  );
+
+EFI_STATUS
+EFIAPI
+Ext4OpenVolume (
+  IN  EFI_SIMPLE_FILE_SYSTEM_PROTOCOL  *This,
+  OUT EFI_FILE_PROTOCOL                **Root
+  );
+
+//
+// Cache.c
+//
+
+/**
+  Initialize the inode and directory entry caches of a volume.
+
+  @param[in]  Partition   The volume.
+
+**/
+VOID
+Ext4InitCaches (
+  IN EXT4_PARTITION  *Partition
+  );
+
+/**
+  Free all the entries of the inode and directory entry caches of a volume.
+
+  @param[in]  Partition   The volume.
+
+**/
+VOID
+Ext4CleanupCaches (
+  IN EXT4_PARTITION  *Partition
+  );
+
+/**
+  Look an inode up in the inode cache of a volume.
+
+  @param[in]  Partition          The volume.
+  @param[in]  InodeNum           The inode number.
+  @param[out] Inode              A copy of the cached inode, to be freed with
+                                 FreePool().
+
+  @retval EFI_SUCCESS            The inode was found in the cache.
+  @retval EFI_NOT_FOUND          The inode is not cached.
+  @retval EFI_OUT_OF_RESOURCES   The copy could not be allocated.
+
+**/
+EFI_STATUS
+Ext4LookupInodeCache (
+  IN  EXT4_PARTITION  *Partition,
+  IN  UINT32          InodeNum,
+  OUT EXT4_INODE      **Inode
+  );
+
+/**
+  Add an inode just read from the volume to its inode cache. The cache keeps
+  its own copy of the inode.
+
+  @param[in]  Partition   The volume.
+  @param[in]  InodeNum    The inode number.
+  @param[in]  Inode       The inode.
+
+**/
+VOID
+Ext4InsertInodeCache (
+  IN EXT4_PARTITION  *Partition,
+  IN UINT32          InodeNum,
+  IN EXT4_INODE      *Inode
+  );
+
+/**
+  Move the cached block map of the inode of a file, if any, to the file.
+
+  @param[in, out] File    The file, whose block map is not valid.
+
+  @retval TRUE            The file got the block map of its inode.
+  @retval FALSE           The inode has no cached block map.
+
+**/
+BOOLEAN
+Ext4TakeCachedBlockMap (
+  IN OUT EXT4_FILE  *File
+  );
+
+/**
+  Move the block map of a file being closed to the inode cache, so that
+  files opening the same inode do not decode it again.
+
+  @param[in, out] File    The file, whose block map is valid.
+
+  @retval TRUE            The block map now belongs to the cache.
+  @retval FALSE           The block map was not cached and still belongs to
+                          File.
+
+**/
+BOOLEAN
+Ext4CacheBlockMap (
+  IN OUT EXT4_FILE  *File
+  );
+
+/**
+  Look a name up in the directory entry cache of a volume.
+
+  @param[in]  Partition       The volume.
+  @param[in]  ParentInodeNum  The inode number of the directory.
+  @param[in]  Name            The name, in UTF-8.
+  @param[in]  NameLength      The length of Name in bytes.
+  @param[out] InodeNum        The inode number of the entry, or 0 if the
+                              directory has no entry called Name.
+
+  @retval TRUE                The result of the lookup is cached.
+  @retval FALSE               The name must be looked up in the directory.
+
+**/
+BOOLEAN
+Ext4LookupDentryCache (
+  IN  EXT4_PARTITION  *Partition,
+  IN  UINT32          ParentInodeNum,
+  IN  CONST CHAR8     *Name,
+  IN  UINTN           NameLength,
+  OUT UINT32          *InodeNum
+  );
+
+/**
+  Add the result of looking a name up in a directory to the directory entry
+  cache of a volume.
+
+  @param[in]  Partition       The volume.
+  @param[in]  ParentInodeNum  The inode number of the directory.
+  @param[in]  Name            The name, in UTF-8.
+  @param[in]  NameLength      The length of Name in bytes.
+  @param[in]  InodeNum        The inode number of the entry, or 0 if the
+                              directory has no entry called Name.
+
+**/
+VOID
+Ext4InsertDentryCache (
+  IN EXT4_PARTITION  *Partition,
+  IN UINT32          ParentInodeNum,
+  IN CONST CHAR8     *Name,
+  IN UINTN           NameLength,
+  IN UINT32          InodeNum
+  );
+
+#endif
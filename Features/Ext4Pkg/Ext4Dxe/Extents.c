@@ -0,0 +1,432 @@
+/** @file
+  Block map decoding of the ext4 driver.
+
+  The extent tree, or the indirect block map of files without extents, is
+  decoded once per open file into a sorted array of physically contiguous
+  runs. Reads then find the run of a file block with a binary search instead
+  of walking the tree, and transfer each run with a single disk request.
+
+  Copyright (c) 2021, EDK II contributors. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "Ext4Dxe.h"
+
+#define EXT4_BLOCK_MAP_INITIAL_CAPACITY  8
+
+/**
+  Append a run to a block map, merging it with the last run if they are
+  contiguous.
+
+  @param[in]      Partition      The volume.
+  @param[in, out] Map            The block map.
+  @param[in]      FileBlock      The first file block of the run.
+  @param[in]      DiskBlock      The first disk block of the run.
+  @param[in]      Length         The number of blocks of the run.
+  @param[in]      Unwritten      The run reads as zeros.
+
+  @retval EFI_SUCCESS            The run was appended.
+  @retval EFI_VOLUME_CORRUPTED   The run overlaps the previous run or lies
+                                 outside of the volume.
+  @retval EFI_OUT_OF_RESOURCES   The block map could not be grown.
+
+**/
+STATIC
+EFI_STATUS
+Ext4AppendBlockRun (
+  IN     EXT4_PARTITION  *Partition,
+  IN OUT EXT4_BLOCK_MAP  *Map,
+  IN     UINT64          FileBlock,
+  IN     UINT64          DiskBlock,
+  IN     UINT32          Length,
+  IN     BOOLEAN         Unwritten
+  )
+{
+  EXT4_BLOCK_RUN  *Last;
+  EXT4_BLOCK_RUN  *Runs;
+  UINTN           Capacity;
+
+  if ((Length == 0) || (DiskBlock >= Partition->NumberBlocks) ||
+      (Length > Partition->NumberBlocks - DiskBlock))
+  {
+    return EFI_VOLUME_CORRUPTED;
+  }
+
+  if (Map->Count > 0) {
+    Last = &Map->Runs[Map->Count - 1];
+    if (FileBlock < Last->FileBlock + Last->Length) {
+      return EFI_VOLUME_CORRUPTED;
+    }
+
+    if ((FileBlock == Last->FileBlock + Last->Length) &&
+        (DiskBlock == Last->DiskBlock + Last->Length) &&
+        (Unwritten == Last->Unwritten) &&
+        (Length <= MAX_UINT32 - Last->Length))
+    {
+      Last->Length += Length;
+      return EFI_SUCCESS;
+    }
+  }
+
+  if (Map->Count == Map->Capacity) {
+    Capacity = (Map->Capacity == 0) ? EXT4_BLOCK_MAP_INITIAL_CAPACITY : Map->Capacity * 2;
+    Runs     = ReallocatePool (
+                 Map->Capacity * sizeof (EXT4_BLOCK_RUN),
+                 Capacity * sizeof (EXT4_BLOCK_RUN),
+                 Map->Runs
+                 );
+    if (Runs == NULL) {
+      return EFI_OUT_OF_RESOURCES;
+    }
+
+    Map->Runs     = Runs;
+    Map->Capacity = Capacity;
+  }
+
+  Map->Runs[Map->Count].FileBlock = FileBlock;
+  Map->Runs[Map->Count].DiskBlock = DiskBlock;
+  Map->Runs[Map->Count].Length    = Length;
+  Map->Runs[Map->Count].Unwritten = Unwritten;
+  Map->Count++;
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Decode a node of an extent tree and its children.
+
+  @param[in, out] File           The file.
+  @param[in]      Header         The extent header of the node.
+  @param[in]      NodeSize       The size of the node in bytes.
+  @param[in]      Depth          The depth the node is expected to have, or
+                                 MAX_UINT16 for the root.
+
+  @retval EFI_SUCCESS            The node was decoded.
+  @retval EFI_VOLUME_CORRUPTED   The node is invalid.
+  @retval EFI_OUT_OF_RESOURCES   The block map could not be grown.
+  @return others                 An error occurred reading the volume.
+
+**/
+STATIC
+EFI_STATUS
+Ext4DecodeExtentNode (
+  IN OUT EXT4_FILE           *File,
+  IN     EXT4_EXTENT_HEADER  *Header,
+  IN     UINTN               NodeSize,
+  IN     UINT16              Depth
+  )
+{
+  EFI_STATUS          Status;
+  EXT4_PARTITION      *Partition;
+  EXT4_EXTENT_INDEX   *Index;
+  EXT4_EXTENT         *Extent;
+  EXT4_EXTENT_HEADER  *Child;
+  UINT64              Block;
+  UINT32              Length;
+  BOOLEAN             Unwritten;
+  UINTN               Entry;
+
+  Partition = File->Partition;
+
+  if ((Header->eh_magic != EXT4_EXTENT_HEADER_MAGIC) ||
+      (Header->eh_entries > Header->eh_max) ||
+      (sizeof (EXT4_EXTENT_HEADER) + Header->eh_max * sizeof (EXT4_EXTENT) > NodeSize) ||
+      (Header->eh_depth > EXT4_EXTENT_TREE_MAX_DEPTH) ||
+      ((Depth != MAX_UINT16) && (Header->eh_depth != Depth)))
+  {
+    return EFI_VOLUME_CORRUPTED;
+  }
+
+  if (Header->eh_depth == 0) {
+    Extent = (EXT4_EXTENT *)(Header + 1);
+    for (Entry = 0; Entry < Header->eh_entries; Entry++, Extent++) {
+      Length    = Extent->ee_len;
+      Unwritten = FALSE;
+      if (Length > EXT4_EXTENT_MAX_INIT_LEN) {
+        Length   -= EXT4_EXTENT_MAX_INIT_LEN;
+        Unwritten = TRUE;
+      }
+
+      Status = Ext4AppendBlockRun (
+                 Partition,
+                 &File->BlockMap,
+                 Extent->ee_block,
+                 LShiftU64 (Extent->ee_start_hi, 32) | Extent->ee_start_lo,
+                 Length,
+                 Unwritten
+                 );
+      if (EFI_ERROR (Status)) {
+        return Status;
+      }
+    }
+
+    return EFI_SUCCESS;
+  }
+
+  Child = AllocatePool (Partition->BlockSize);
+  if (Child == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Status = EFI_SUCCESS;
+  Index  = (EXT4_EXTENT_INDEX *)(Header + 1);
+  for (Entry = 0; Entry < Header->eh_entries; Entry++, Index++) {
+    Block  = LShiftU64 (Index->ei_leaf_hi, 32) | Index->ei_leaf_lo;
+    Status = Ext4ReadBlocks (Partition, Block, 1, Child);
+    if (EFI_ERROR (Status)) {
+      break;
+    }
+
+    Status = Ext4DecodeExtentNode (File, Child, Partition->BlockSize, Header->eh_depth - 1);
+    if (EFI_ERROR (Status)) {
+      break;
+    }
+  }
+
+  FreePool (Child);
+  return Status;
+}
+
+/**
+  Decode a block of the indirect block map.
+
+  @param[in, out] File           The file.
+  @param[in]      Block          The disk block of the indirect block.
+  @param[in]      Level          1 for an indirect block, 2 for a doubly
+                                 indirect block, 3 for a triply indirect block.
+  @param[in, out] FileBlock      On input, the first file block mapped by
+                                 Block. On output, the first file block after
+                                 the ones it maps.
+  @param[in]      EndBlock       The file block at which to stop decoding.
+
+  @retval EFI_SUCCESS            The indirect block was decoded.
+  @retval EFI_VOLUME_CORRUPTED   The block map is invalid.
+  @retval EFI_OUT_OF_RESOURCES   The block map could not be grown.
+  @return others                 An error occurred reading the volume.
+
+**/
+STATIC
+EFI_STATUS
+Ext4DecodeIndirectBlock (
+  IN OUT EXT4_FILE  *File,
+  IN     UINT32     Block,
+  IN     UINTN      Level,
+  IN OUT UINT64     *FileBlock,
+  IN     UINT64     EndBlock
+  )
+{
+  EFI_STATUS      Status;
+  EXT4_PARTITION  *Partition;
+  UINT32          *Pointers;
+  UINT32          PointersPerBlock;
+  UINT64          Span;
+  UINTN           Index;
+
+  Partition        = File->Partition;
+  PointersPerBlock = Partition->BlockSize / sizeof (UINT32);
+  Span             = 1;
+  for (Index = 1; Index < Level; Index++) {
+    Span = MultU64x32 (Span, PointersPerBlock);
+  }
+
+  if (Block == 0) {
+    //
+    // A hole spanning the whole subtree.
+    //
+    *FileBlock += MultU64x32 (Span, PointersPerBlock);
+    return EFI_SUCCESS;
+  }
+
+  Pointers = Ext4AllocAndReadBlocks (Partition, Block, 1);
+  if (Pointers == NULL) {
+    return EFI_DEVICE_ERROR;
+  }
+
+  Status = EFI_SUCCESS;
+  for (Index = 0; (Index < PointersPerBlock) && (*FileBlock < EndBlock); Index++) {
+    if (Level == 1) {
+      if (Pointers[Index] != 0) {
+        Status = Ext4AppendBlockRun (Partition, &File->BlockMap, *FileBlock, Pointers[Index], 1, FALSE);
+      }
+
+      (*FileBlock)++;
+    } else {
+      Status = Ext4DecodeIndirectBlock (File, Pointers[Index], Level - 1, FileBlock, EndBlock);
+    }
+
+    if (EFI_ERROR (Status)) {
+      break;
+    }
+  }
+
+  FreePool (Pointers);
+  return Status;
+}
+
+/**
+  Decode the indirect block map of a file without extents.
+
+  @param[in, out] File           The file.
+
+  @retval EFI_SUCCESS            The block map was decoded.
+  @retval EFI_VOLUME_CORRUPTED   The block map is invalid.
+  @retval EFI_OUT_OF_RESOURCES   The block map could not be grown.
+  @return others                 An error occurred reading the volume.
+
+**/
+STATIC
+EFI_STATUS
+Ext4DecodeBlockMap (
+  IN OUT EXT4_FILE  *File
+  )
+{
+  EFI_STATUS      Status;
+  EXT4_PARTITION  *Partition;
+  UINT32          *Pointers;
+  UINT64          FileBlock;
+  UINT64          EndBlock;
+  UINTN           Index;
+
+  Partition = File->Partition;
+  Pointers  = File->Inode->i_block;
+
+  //
+  // Only decode the blocks below the end of the file, which is all a read
+  // can reach.
+  //
+  EndBlock = RShiftU64 (File->Size + Partition->BlockSize - 1, Partition->BlockLogSize);
+
+  for (FileBlock = 0; (FileBlock < EXT4_NDIR_BLOCKS) && (FileBlock < EndBlock); FileBlock++) {
+    if (Pointers[FileBlock] != 0) {
+      Status = Ext4AppendBlockRun (Partition, &File->BlockMap, FileBlock, Pointers[FileBlock], 1, FALSE);
+      if (EFI_ERROR (Status)) {
+        return Status;
+      }
+    }
+  }
+
+  FileBlock = EXT4_NDIR_BLOCKS;
+  for (Index = EXT4_IND_BLOCK; (Index <= EXT4_TIND_BLOCK) && (FileBlock < EndBlock); Index++) {
+    Status = Ext4DecodeIndirectBlock (
+               File,
+               Pointers[Index],
+               Index - EXT4_IND_BLOCK + 1,
+               &FileBlock,
+               EndBlock
+               );
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Decode the extent tree or the indirect block map of a file into its
+  block map.
+
+  @param[in, out] File           The file.
+
+  @retval EFI_SUCCESS            File->BlockMap is valid.
+  @retval EFI_VOLUME_CORRUPTED   The extent tree or block map is invalid.
+  @retval EFI_OUT_OF_RESOURCES   The block map could not be allocated.
+  @return others                 An error occurred reading the volume.
+
+**/
+EFI_STATUS
+Ext4BuildBlockMap (
+  IN OUT EXT4_FILE  *File
+  )
+{
+  EFI_STATUS  Status;
+
+  ASSERT (!File->BlockMapValid);
+
+  if ((File->Inode->i_flags & EXT4_EXTENTS_FL) != 0) {
+    Status = Ext4DecodeExtentNode (
+               File,
+               (EXT4_EXTENT_HEADER *)File->Inode->i_block,
+               sizeof (File->Inode->i_block),
+               MAX_UINT16
+               );
+  } else {
+    Status = Ext4DecodeBlockMap (File);
+  }
+
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "%a: inode %u: %r\n", __FUNCTION__, File->InodeNum, Status));
+    Ext4FreeBlockMap (File);
+    return Status;
+  }
+
+  File->BlockMapValid = TRUE;
+  return EFI_SUCCESS;
+}
+
+/**
+  Free the block map of a file.
+
+  @param[in, out] File    The file.
+
+**/
+VOID
+Ext4FreeBlockMap (
+  IN OUT EXT4_FILE  *File
+  )
+{
+  if (File->BlockMap.Runs != NULL) {
+    FreePool (File->BlockMap.Runs);
+  }
+
+  ZeroMem (&File->BlockMap, sizeof (File->BlockMap));
+  File->BlockMapValid = FALSE;
+}
+
+/**
+  Find the run of a block map that maps a file block.
+
+  @param[in]  Map         The block map.
+  @param[in]  FileBlock   The file block.
+  @param[out] Next        If no run maps FileBlock, the first run after it,
+                          or NULL if there is none. Optional.
+
+  @return The run mapping FileBlock, or NULL if FileBlock is in a hole.
+
+**/
+EXT4_BLOCK_RUN *
+Ext4LookupBlockRun (
+  IN  EXT4_BLOCK_MAP  *Map,
+  IN  UINT64          FileBlock,
+  OUT EXT4_BLOCK_RUN  **Next OPTIONAL
+  )
+{
+  UINTN  Low;
+  UINTN  High;
+  UINTN  Middle;
+
+  //
+  // Find the first run starting after FileBlock.
+  //
+  Low  = 0;
+  High = Map->Count;
+  while (Low < High) {
+    Middle = Low + (High - Low) / 2;
+    if (Map->Runs[Middle].FileBlock <= FileBlock) {
+      Low = Middle + 1;
+    } else {
+      High = Middle;
+    }
+  }
+
+  if (Next != NULL) {
+    *Next = (Low < Map->Count) ? &Map->Runs[Low] : NULL;
+  }
+
+  if ((Low > 0) && (FileBlock < Map->Runs[Low - 1].FileBlock + Map->Runs[Low - 1].Length)) {
+    return &Map->Runs[Low - 1];
+  }
+
+  return NULL;
+}
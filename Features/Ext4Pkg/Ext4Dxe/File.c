@@ -0,0 +1,991 @@
+/** @file
+  EFI_FILE_PROTOCOL implementation of the ext4 driver.
+
+  Copyright (c) 2021, EDK II contributors. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "Ext4Dxe.h"
+
+EFI_FILE_PROTOCOL  gExt4FileProtocolTemplate = {
+  EFI_FILE_PROTOCOL_REVISION2,
+  Ext4Open,
+  Ext4Close,
+  Ext4Delete,
+  Ext4Read,
+  Ext4Write,
+  Ext4GetPosition,
+  Ext4SetPosition,
+  Ext4GetInfo,
+  Ext4SetInfo,
+  Ext4Flush,
+  Ext4OpenEx,
+  Ext4ReadEx,
+  Ext4WriteEx,
+  Ext4FlushEx
+};
+
+/**
+  Create an EXT4_FILE for an inode of a volume.
+
+  @param[in]  Partition          The volume.
+  @param[in]  InodeNum           The inode number.
+  @param[in]  Inode              The inode, owned by the file on success.
+  @param[in]  FileName           The name returned in EFI_FILE_INFO.
+  @param[out] File               The new file.
+
+  @retval EFI_SUCCESS            The file was created.
+  @retval EFI_OUT_OF_RESOURCES   The file could not be allocated.
+
+**/
+EFI_STATUS
+Ext4CreateFile (
+  IN  EXT4_PARTITION  *Partition,
+  IN  UINT32          InodeNum,
+  IN  EXT4_INODE      *Inode,
+  IN  CONST CHAR16    *FileName,
+  OUT EXT4_FILE       **File
+  )
+{
+  EXT4_FILE  *NewFile;
+
+  NewFile = AllocateZeroPool (sizeof (EXT4_FILE));
+  if (NewFile == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  NewFile->FileName = AllocateCopyPool (StrSize (FileName), FileName);
+  if (NewFile->FileName == NULL) {
+    FreePool (NewFile);
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  NewFile->Signature = EXT4_FILE_SIGNATURE;
+  CopyMem (&NewFile->Protocol, &gExt4FileProtocolTemplate, sizeof (EFI_FILE_PROTOCOL));
+  NewFile->Partition = Partition;
+  NewFile->InodeNum  = InodeNum;
+  NewFile->Inode     = Inode;
+  NewFile->Size      = Ext4InodeSize (Inode);
+  NewFile->OpenMode  = EFI_FILE_MODE_READ;
+  InsertTailList (&Partition->OpenFiles, &NewFile->OpenFilesLink);
+
+  *File = NewFile;
+  return EFI_SUCCESS;
+}
+
+/**
+  Close an EXT4_FILE and free its resources.
+
+  @param[in]  File    The file.
+
+**/
+VOID
+Ext4FreeFile (
+  IN EXT4_FILE  *File
+  )
+{
+  RemoveEntryList (&File->OpenFilesLink);
+  if (!File->BlockMapValid || !Ext4CacheBlockMap (File)) {
+    Ext4FreeBlockMap (File);
+  }
+  if (File->DirBlock != NULL) {
+    FreePool (File->DirBlock);
+  }
+
+  if (File->ReadAhead != NULL) {
+    FreePool (File->ReadAhead);
+  }
+
+  FreePool (File->Inode);
+  FreePool (File->FileName);
+  File->Signature = 0;
+  FreePool (File);
+}
+
+/**
+  Open an inode of a volume as an EXT4_FILE.
+
+  @param[in]  Partition          The volume.
+  @param[in]  InodeNum           The inode number.
+  @param[in]  FileName           The name returned in EFI_FILE_INFO.
+  @param[out] File               The new file.
+
+  @retval EFI_SUCCESS            The file was opened.
+  @return others                 The inode could not be read, or the file
+                                 could not be allocated.
+
+**/
+STATIC
+EFI_STATUS
+Ext4OpenInode (
+  IN  EXT4_PARTITION  *Partition,
+  IN  UINT32          InodeNum,
+  IN  CONST CHAR16    *FileName,
+  OUT EXT4_FILE       **File
+  )
+{
+  EFI_STATUS  Status;
+  EXT4_INODE  *Inode;
+
+  Status = Ext4ReadInode (Partition, InodeNum, &Inode);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Status = Ext4CreateFile (Partition, InodeNum, Inode, FileName, File);
+  if (EFI_ERROR (Status)) {
+    FreePool (Inode);
+  }
+
+  return Status;
+}
+
+/**
+  Read the target of a symbolic link.
+
+  @param[in]  Link               The symbolic link.
+  @param[out] Target             The buffer receiving the target.
+  @param[in]  TargetSize         The size of Target in bytes.
+  @param[out] TargetLength       The length of the target in bytes.
+
+  @retval EFI_SUCCESS            The target was read.
+  @retval EFI_ACCESS_DENIED      The target is too long.
+  @return others                 An error occurred reading the link.
+
+**/
+STATIC
+EFI_STATUS
+Ext4ReadSymlink (
+  IN  EXT4_FILE  *Link,
+  OUT CHAR8      *Target,
+  IN  UINTN      TargetSize,
+  OUT UINTN      *TargetLength
+  )
+{
+  if ((Link->Size == 0) || (Link->Size > TargetSize)) {
+    return EFI_ACCESS_DENIED;
+  }
+
+  *TargetLength = (UINTN)Link->Size;
+
+  //
+  // Short targets are stored in i_block, whatever the inode flags say.
+  //
+  if (Link->Size < sizeof (Link->Inode->i_block)) {
+    CopyMem (Target, Link->Inode->i_block, *TargetLength);
+    return EFI_SUCCESS;
+  }
+
+  return Ext4ReadFileData (Link, 0, *TargetLength, Target);
+}
+
+/**
+  Walk a path from a directory, following symbolic links.
+
+  @param[in]      Start          The file to start from for relative paths.
+  @param[in, out] Path           The path in UTF-8, with '/' separators, in a
+                                 buffer of EXT4_MAX_PATH_LENGTH bytes. The
+                                 buffer is used as scratch space.
+  @param[in]      PathLength     The length of Path in bytes.
+  @param[out]     File           The file at the end of the path.
+
+  @retval EFI_SUCCESS            The file was opened.
+  @retval EFI_NOT_FOUND          A component of the path does not exist, or is
+                                 not a directory.
+  @retval EFI_ACCESS_DENIED      Too many symbolic links were followed, or the
+                                 resulting path is too long.
+  @return others                 An error occurred reading the volume.
+
+**/
+STATIC
+EFI_STATUS
+Ext4WalkPath (
+  IN     EXT4_FILE  *Start,
+  IN OUT CHAR8      *Path,
+  IN     UINTN      PathLength,
+  OUT    EXT4_FILE  **File
+  )
+{
+  EFI_STATUS      Status;
+  EXT4_PARTITION  *Partition;
+  EXT4_FILE       *Dir;
+  EXT4_FILE       *Child;
+  CHAR8           *Target;
+  UINTN           TargetLength;
+  UINTN           Position;
+  UINTN           End;
+  UINTN           Links;
+  UINT32          InodeNum;
+  CHAR16          Name[EXT4_NAME_MAX + 1];
+
+  Partition = Start->Partition;
+  Links     = 0;
+  Position  = 0;
+
+  Target = AllocatePool (EXT4_MAX_PATH_LENGTH);
+  if (Target == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  if ((PathLength > 0) && (Path[0] == '/')) {
+    Status = Ext4OpenInode (Partition, EXT4_ROOT_INODE_NR, L"", &Dir);
+  } else {
+    Status = Ext4OpenInode (Partition, Start->InodeNum, Start->FileName, &Dir);
+  }
+
+  if (EFI_ERROR (Status)) {
+    FreePool (Target);
+    return Status;
+  }
+
+  while (TRUE) {
+    while ((Position < PathLength) && (Path[Position] == '/')) {
+      Position++;
+    }
+
+    if (Position == PathLength) {
+      break;
+    }
+
+    for (End = Position; (End < PathLength) && (Path[End] != '/'); End++) {
+    }
+
+    if ((End - Position == 1) && (Path[Position] == '.')) {
+      Position = End;
+      continue;
+    }
+
+    if (!Ext4InodeIsDir (Dir->Inode)) {
+      Status = EFI_NOT_FOUND;
+      break;
+    }
+
+    Status = Ext4LookupDirEntry (Dir, Path + Position, End - Position, &InodeNum);
+    if (EFI_ERROR (Status)) {
+      break;
+    }
+
+    Ext4Utf8ToUcs2 (Path + Position, End - Position, Name);
+    Status = Ext4OpenInode (Partition, InodeNum, Name, &Child);
+    if (EFI_ERROR (Status)) {
+      break;
+    }
+
+    Position = End;
+
+    if (!Ext4InodeIsSymlink (Child->Inode)) {
+      Ext4FreeFile (Dir);
+      Dir = Child;
+      continue;
+    }
+
+    //
+    // Replace the link with its target in the rest of the path, and go on
+    // from the root for absolute targets.
+    //
+    if (++Links > EXT4_MAX_SYMLINK_DEPTH) {
+      Ext4FreeFile (Child);
+      Status = EFI_ACCESS_DENIED;
+      break;
+    }
+
+    Status = Ext4ReadSymlink (Child, Target, EXT4_MAX_PATH_LENGTH, &TargetLength);
+    Ext4FreeFile (Child);
+    if (EFI_ERROR (Status)) {
+      break;
+    }
+
+    if (TargetLength + 1 + (PathLength - Position) > EXT4_MAX_PATH_LENGTH) {
+      Status = EFI_ACCESS_DENIED;
+      break;
+    }
+
+    CopyMem (Path + TargetLength + 1, Path + Position, PathLength - Position);
+    CopyMem (Path, Target, TargetLength);
+    Path[TargetLength] = '/';
+    PathLength         = TargetLength + 1 + (PathLength - Position);
+    Position           = 0;
+
+    if (Path[0] == '/') {
+      Ext4FreeFile (Dir);
+      Status = Ext4OpenInode (Partition, EXT4_ROOT_INODE_NR, L"", &Dir);
+      if (EFI_ERROR (Status)) {
+        Dir = NULL;
+        break;
+      }
+    }
+  }
+
+  FreePool (Target);
+
+  if (EFI_ERROR (Status)) {
+    if (Dir != NULL) {
+      Ext4FreeFile (Dir);
+    }
+
+    return Status;
+  }
+
+  *File = Dir;
+  return EFI_SUCCESS;
+}
+
+/**
+  Open a file relative to another one.
+
+  @param[in]  File               The file to open from.
+  @param[out] NewFile            The opened file.
+  @param[in]  FileName           The path to open.
+  @param[in]  OpenMode           The open mode.
+
+  @retval EFI_SUCCESS            The file was opened.
+  @retval EFI_WRITE_PROTECTED    OpenMode asks for write access.
+  @retval EFI_INVALID_PARAMETER  OpenMode is invalid.
+  @retval EFI_NOT_FOUND          The file does not exist.
+  @return others                 The file could not be opened.
+
+**/
+STATIC
+EFI_STATUS
+Ext4OpenWorker (
+  IN  EXT4_FILE  *File,
+  OUT EXT4_FILE  **NewFile,
+  IN  CHAR16     *FileName,
+  IN  UINT64     OpenMode
+  )
+{
+  EFI_STATUS  Status;
+  CHAR8       *Path;
+  UINTN       PathLength;
+  UINTN       Index;
+
+  switch (OpenMode) {
+    case EFI_FILE_MODE_READ:
+      break;
+
+    case EFI_FILE_MODE_READ | EFI_FILE_MODE_WRITE:
+    case EFI_FILE_MODE_READ | EFI_FILE_MODE_WRITE | EFI_FILE_MODE_CREATE:
+      return EFI_WRITE_PROTECTED;
+
+    default:
+      return EFI_INVALID_PARAMETER;
+  }
+
+  Path = AllocatePool (EXT4_MAX_PATH_LENGTH);
+  if (Path == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  PathLength = Ext4Ucs2ToUtf8 (FileName, Path, EXT4_MAX_PATH_LENGTH);
+  if (PathLength == MAX_UINTN) {
+    FreePool (Path);
+    return EFI_NOT_FOUND;
+  }
+
+  for (Index = 0; Index < PathLength; Index++) {
+    if (Path[Index] == '\\') {
+      Path[Index] = '/';
+    }
+  }
+
+  Status = Ext4WalkPath (File, Path, PathLength, NewFile);
+  FreePool (Path);
+  return Status;
+}
+
+/**
+  Opens a new file relative to the source file's location.
+
+  @param[in]  This        The EFI_FILE_PROTOCOL instance that is the file
+                          handle to the source location.
+  @param[out] NewHandle   A pointer to the location to return the opened
+                          handle for the new file.
+  @param[in]  FileName    The Null-terminated string of the name of the file
+                          to be opened.
+  @param[in]  OpenMode    The mode to open the file with.
+  @param[in]  Attributes  Only valid for EFI_FILE_MODE_CREATE, which this
+                          driver does not support.
+
+  @retval EFI_SUCCESS            The file was opened.
+  @retval EFI_NOT_FOUND          The specified file could not be found on the
+                                 device.
+  @retval EFI_VOLUME_CORRUPTED   The file system structures are corrupted.
+  @retval EFI_WRITE_PROTECTED    An attempt was made to open the file for
+                                 writing.
+  @retval EFI_INVALID_PARAMETER  A parameter is invalid.
+
+**/
+EFI_STATUS
+EFIAPI
+Ext4Open (
+  IN  EFI_FILE_PROTOCOL  *This,
+  OUT EFI_FILE_PROTOCOL  **NewHandle,
+  IN  CHAR16             *FileName,
+  IN  UINT64             OpenMode,
+  IN  UINT64             Attributes
+  )
+{
+  EFI_STATUS  Status;
+  EXT4_FILE   *NewFile;
+  EFI_TPL     OldTpl;
+
+  if ((This == NULL) || (NewHandle == NULL) || (FileName == NULL)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  OldTpl = gBS->RaiseTPL (TPL_CALLBACK);
+  Status = Ext4OpenWorker (EXT4_FILE_FROM_THIS (This), &NewFile, FileName, OpenMode);
+  gBS->RestoreTPL (OldTpl);
+
+  if (!EFI_ERROR (Status)) {
+    *NewHandle = &NewFile->Protocol;
+  }
+
+  return Status;
+}
+
+/**
+  Opens a new file relative to the source directory's location, and signals
+  the token event once the file is open.
+
+  @param[in]      This        The EFI_FILE_PROTOCOL instance that is the file
+                              handle to the source location.
+  @param[out]     NewHandle   A pointer to the location to return the opened
+                              handle for the new file.
+  @param[in]      FileName    The Null-terminated string of the name of the
+                              file to be opened.
+  @param[in]      OpenMode    The mode to open the file with.
+  @param[in]      Attributes  Only valid for EFI_FILE_MODE_CREATE.
+  @param[in, out] Token       The token associated with the request.
+
+  @retval EFI_SUCCESS            The request was completed; Token->Status
+                                 holds its result.
+  @retval EFI_INVALID_PARAMETER  Token is NULL.
+
+**/
+EFI_STATUS
+EFIAPI
+Ext4OpenEx (
+  IN     EFI_FILE_PROTOCOL  *This,
+  OUT    EFI_FILE_PROTOCOL  **NewHandle,
+  IN     CHAR16             *FileName,
+  IN     UINT64             OpenMode,
+  IN     UINT64             Attributes,
+  IN OUT EFI_FILE_IO_TOKEN  *Token
+  )
+{
+  if (Token == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Token->Status = Ext4Open (This, NewHandle, FileName, OpenMode, Attributes);
+  gBS->SignalEvent (Token->Event);
+  return EFI_SUCCESS;
+}
+
+/**
+  Closes a specified file handle.
+
+  @param[in]  This    A pointer to the EFI_FILE_PROTOCOL instance that is the
+                      file handle to close.
+
+  @retval EFI_SUCCESS The file was closed.
+
+**/
+EFI_STATUS
+EFIAPI
+Ext4Close (
+  IN EFI_FILE_PROTOCOL  *This
+  )
+{
+  EFI_TPL  OldTpl;
+
+  OldTpl = gBS->RaiseTPL (TPL_CALLBACK);
+  Ext4FreeFile (EXT4_FILE_FROM_THIS (This));
+  gBS->RestoreTPL (OldTpl);
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Closes and deletes a file. The volume is read-only, so the file is only
+  closed.
+
+  @param[in]  This    A pointer to the EFI_FILE_PROTOCOL instance that is the
+                      handle to the file to delete.
+
+  @retval EFI_WARN_DELETE_FAILURE  The handle was closed, but the file was
+                                   not deleted.
+
+**/
+EFI_STATUS
+EFIAPI
+Ext4Delete (
+  IN EFI_FILE_PROTOCOL  *This
+  )
+{
+  Ext4Close (This);
+  return EFI_WARN_DELETE_FAILURE;
+}
+
+/**
+  Reads data from a file, or the next entry of a directory.
+
+  @param[in]      This        A pointer to the EFI_FILE_PROTOCOL instance
+                              that is the file handle to read data from.
+  @param[in, out] BufferSize  On input, the size of the Buffer. On output, the
+                              amount of data returned in Buffer.
+  @param[out]     Buffer      The buffer into which the data is read.
+
+  @retval EFI_SUCCESS            Data was read.
+  @retval EFI_DEVICE_ERROR       The position of a file is beyond its end.
+  @retval EFI_VOLUME_CORRUPTED   The file system structures are corrupted.
+  @retval EFI_BUFFER_TOO_SMALL   The BufferSize is too small to read the
+                                 current directory entry. BufferSize has been
+                                 updated with the size needed to complete the
+                                 request.
+
+**/
+EFI_STATUS
+EFIAPI
+Ext4Read (
+  IN     EFI_FILE_PROTOCOL  *This,
+  IN OUT UINTN              *BufferSize,
+  OUT    VOID               *Buffer
+  )
+{
+  EFI_STATUS  Status;
+  EXT4_FILE   *File;
+  EFI_TPL     OldTpl;
+  UINT64      Remaining;
+  UINTN       Length;
+
+  File   = EXT4_FILE_FROM_THIS (This);
+  OldTpl = gBS->RaiseTPL (TPL_CALLBACK);
+
+  if (Ext4InodeIsDir (File->Inode)) {
+    Status = Ext4ReadDir (File, BufferSize, Buffer);
+  } else if (File->Position > File->Size) {
+    Status = EFI_DEVICE_ERROR;
+  } else {
+    Remaining = File->Size - File->Position;
+    Length    = (Remaining < *BufferSize) ? (UINTN)Remaining : *BufferSize;
+    Status    = Ext4ReadFileDataAhead (File, File->Position, Length, Buffer);
+    if (!EFI_ERROR (Status)) {
+      File->Position += Length;
+      *BufferSize     = Length;
+    }
+  }
+
+  gBS->RestoreTPL (OldTpl);
+  return Status;
+}
+
+/**
+  Reads data from a file, and signals the token event once done.
+
+  @param[in]      This    A pointer to the EFI_FILE_PROTOCOL instance that is
+                          the file handle to read data from.
+  @param[in, out] Token   The token associated with the request.
+
+  @retval EFI_SUCCESS            The request was completed; Token->Status
+                                 holds its result.
+  @retval EFI_INVALID_PARAMETER  Token is NULL.
+
+**/
+EFI_STATUS
+EFIAPI
+Ext4ReadEx (
+  IN     EFI_FILE_PROTOCOL  *This,
+  IN OUT EFI_FILE_IO_TOKEN  *Token
+  )
+{
+  if (Token == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Token->Status = Ext4Read (This, &Token->BufferSize, Token->Buffer);
+  gBS->SignalEvent (Token->Event);
+  return EFI_SUCCESS;
+}
+
+/**
+  Writes data to a file. All files of the volume are opened read-only.
+
+  @param[in]      This        A pointer to the EFI_FILE_PROTOCOL instance.
+  @param[in, out] BufferSize  Set to 0, as no data is written.
+  @param[in]      Buffer      The buffer of data to write.
+
+  @retval EFI_UNSUPPORTED     Writes to open directory files are not
+                              supported.
+  @retval EFI_ACCESS_DENIED   The file was opened read only.
+
+**/
+EFI_STATUS
+EFIAPI
+Ext4Write (
+  IN     EFI_FILE_PROTOCOL  *This,
+  IN OUT UINTN              *BufferSize,
+  IN     VOID               *Buffer
+  )
+{
+  EXT4_FILE  *File;
+
+  File        = EXT4_FILE_FROM_THIS (This);
+  *BufferSize = 0;
+  if (Ext4InodeIsDir (File->Inode)) {
+    return EFI_UNSUPPORTED;
+  }
+
+  return EFI_ACCESS_DENIED;
+}
+
+/**
+  Writes data to a file, and signals the token event once done.
+
+  @param[in]      This    A pointer to the EFI_FILE_PROTOCOL instance.
+  @param[in, out] Token   The token associated with the request.
+
+  @retval EFI_SUCCESS            The request was completed; Token->Status
+                                 holds its result.
+  @retval EFI_INVALID_PARAMETER  Token is NULL.
+
+**/
+EFI_STATUS
+EFIAPI
+Ext4WriteEx (
+  IN     EFI_FILE_PROTOCOL  *This,
+  IN OUT EFI_FILE_IO_TOKEN  *Token
+  )
+{
+  if (Token == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Token->Status = Ext4Write (This, &Token->BufferSize, Token->Buffer);
+  gBS->SignalEvent (Token->Event);
+  return EFI_SUCCESS;
+}
+
+/**
+  Returns a file's current position.
+
+  @param[in]  This      A pointer to the EFI_FILE_PROTOCOL instance.
+  @param[out] Position  The address to return the file's current position
+                        value.
+
+  @retval EFI_SUCCESS       The position was returned.
+  @retval EFI_UNSUPPORTED   The request is not valid on open directories.
+
+**/
+EFI_STATUS
+EFIAPI
+Ext4GetPosition (
+  IN  EFI_FILE_PROTOCOL  *This,
+  OUT UINT64             *Position
+  )
+{
+  EXT4_FILE  *File;
+
+  File = EXT4_FILE_FROM_THIS (This);
+  if (Ext4InodeIsDir (File->Inode)) {
+    return EFI_UNSUPPORTED;
+  }
+
+  *Position = File->Position;
+  return EFI_SUCCESS;
+}
+
+/**
+  Sets a file's current position. Directories can only be rewound.
+
+  @param[in]  This      A pointer to the EFI_FILE_PROTOCOL instance.
+  @param[in]  Position  The byte position from the start of the file, or
+                        0xFFFFFFFFFFFFFFFF for the end of the file.
+
+  @retval EFI_SUCCESS       The position was set.
+  @retval EFI_UNSUPPORTED   The seek request for nonzero is not valid on open
+                            directories.
+
+**/
+EFI_STATUS
+EFIAPI
+Ext4SetPosition (
+  IN EFI_FILE_PROTOCOL  *This,
+  IN UINT64             Position
+  )
+{
+  EXT4_FILE  *File;
+
+  File = EXT4_FILE_FROM_THIS (This);
+  if (Ext4InodeIsDir (File->Inode)) {
+    if (Position != 0) {
+      return EFI_UNSUPPORTED;
+    }
+  } else if (Position == MAX_UINT64) {
+    Position = File->Size;
+  }
+
+  File->Position = Position;
+  return EFI_SUCCESS;
+}
+
+/**
+  Return the label of a volume.
+
+  @param[in]  Partition   The volume.
+  @param[out] Label       The buffer receiving the label, at least
+                          EXT4_VOLUME_NAME_SIZE + 1 characters.
+
+  @return The size of the label in bytes, including the terminator.
+
+**/
+STATIC
+UINTN
+Ext4GetVolumeLabel (
+  IN  EXT4_PARTITION  *Partition,
+  OUT CHAR16          *Label
+  )
+{
+  UINTN  Length;
+
+  Length = AsciiStrnLenS (Partition->SuperBlock.s_volume_name, EXT4_VOLUME_NAME_SIZE);
+  return (Ext4Utf8ToUcs2 (Partition->SuperBlock.s_volume_name, Length, Label) + 1) * sizeof (CHAR16);
+}
+
+/**
+  Returns information about a file or its volume.
+
+  @param[in]      This             A pointer to the EFI_FILE_PROTOCOL instance.
+  @param[in]      InformationType  The type identifier of the information
+                                   being requested.
+  @param[in, out] BufferSize       On input, the size of Buffer. On output,
+                                   the amount of data returned in Buffer.
+  @param[out]     Buffer           A pointer to the data buffer to return.
+
+  @retval EFI_SUCCESS            The information was returned.
+  @retval EFI_UNSUPPORTED        The InformationType is not known.
+  @retval EFI_BUFFER_TOO_SMALL   The BufferSize is too small to read the
+                                 information. BufferSize has been updated
+                                 with the size needed to complete the request.
+
+**/
+EFI_STATUS
+EFIAPI
+Ext4GetInfo (
+  IN     EFI_FILE_PROTOCOL  *This,
+  IN     EFI_GUID           *InformationType,
+  IN OUT UINTN              *BufferSize,
+  OUT    VOID               *Buffer
+  )
+{
+  EXT4_FILE             *File;
+  EXT4_PARTITION        *Partition;
+  EFI_FILE_INFO         *Info;
+  EFI_FILE_SYSTEM_INFO  *FsInfo;
+  CHAR16                Label[EXT4_VOLUME_NAME_SIZE + 1];
+  UINTN                 LabelSize;
+  UINTN                 Size;
+  UINT64                FreeBlocks;
+
+  File      = EXT4_FILE_FROM_THIS (This);
+  Partition = File->Partition;
+
+  if (CompareGuid (InformationType, &gEfiFileInfoGuid)) {
+    Size = SIZE_OF_EFI_FILE_INFO + StrSize (File->FileName);
+    if (*BufferSize < Size) {
+      *BufferSize = Size;
+      return EFI_BUFFER_TOO_SMALL;
+    }
+
+    Info = Buffer;
+    ZeroMem (Info, SIZE_OF_EFI_FILE_INFO);
+    Info->Size = Size;
+    Ext4InodeToFileInfo (Partition, File->Inode, Info);
+    StrCpyS (Info->FileName, (*BufferSize - SIZE_OF_EFI_FILE_INFO) / sizeof (CHAR16), File->FileName);
+    *BufferSize = Size;
+    return EFI_SUCCESS;
+  }
+
+  if (CompareGuid (InformationType, &gEfiFileSystemInfoGuid)) {
+    LabelSize = Ext4GetVolumeLabel (Partition, Label);
+    Size      = SIZE_OF_EFI_FILE_SYSTEM_INFO + LabelSize;
+    if (*BufferSize < Size) {
+      *BufferSize = Size;
+      return EFI_BUFFER_TOO_SMALL;
+    }
+
+    FreeBlocks = Partition->SuperBlock.s_free_blocks_count_lo;
+    if ((Partition->FeaturesIncompat & EXT4_FEATURE_INCOMPAT_64BIT) != 0) {
+      FreeBlocks |= LShiftU64 (Partition->SuperBlock.s_free_blocks_count_hi, 32);
+    }
+
+    FsInfo             = Buffer;
+    FsInfo->Size       = Size;
+    FsInfo->ReadOnly   = TRUE;
+    FsInfo->VolumeSize = Ext4BlockToByteOffset (Partition, Partition->NumberBlocks);
+    FsInfo->FreeSpace  = Ext4BlockToByteOffset (Partition, FreeBlocks);
+    FsInfo->BlockSize  = Partition->BlockSize;
+    CopyMem (FsInfo->VolumeLabel, Label, LabelSize);
+    *BufferSize = Size;
+    return EFI_SUCCESS;
+  }
+
+  if (CompareGuid (InformationType, &gEfiFileSystemVolumeLabelInfoIdGuid)) {
+    LabelSize = Ext4GetVolumeLabel (Partition, Label);
+    Size      = SIZE_OF_EFI_FILE_SYSTEM_VOLUME_LABEL + LabelSize;
+    if (*BufferSize < Size) {
+      *BufferSize = Size;
+      return EFI_BUFFER_TOO_SMALL;
+    }
+
+    CopyMem (((EFI_FILE_SYSTEM_VOLUME_LABEL *)Buffer)->VolumeLabel, Label, LabelSize);
+    *BufferSize = Size;
+    return EFI_SUCCESS;
+  }
+
+  return EFI_UNSUPPORTED;
+}
+
+/**
+  Sets information about a file. The volume is read-only.
+
+  @param[in]  This             A pointer to the EFI_FILE_PROTOCOL instance.
+  @param[in]  InformationType  The type identifier for the information being
+                               set.
+  @param[in]  BufferSize       The size, in bytes, of Buffer.
+  @param[in]  Buffer           A pointer to the data buffer to write.
+
+  @retval EFI_WRITE_PROTECTED  The media is read-only.
+
+**/
+EFI_STATUS
+EFIAPI
+Ext4SetInfo (
+  IN EFI_FILE_PROTOCOL  *This,
+  IN EFI_GUID           *InformationType,
+  IN UINTN              BufferSize,
+  IN VOID               *Buffer
+  )
+{
+  return EFI_WRITE_PROTECTED;
+}
+
+/**
+  Flushes all modified data associated with a file to a device. All files of
+  the volume are opened read-only.
+
+  @param[in]  This    A pointer to the EFI_FILE_PROTOCOL instance.
+
+  @retval EFI_ACCESS_DENIED   The file was opened read-only.
+
+**/
+EFI_STATUS
+EFIAPI
+Ext4Flush (
+  IN EFI_FILE_PROTOCOL  *This
+  )
+{
+  return EFI_ACCESS_DENIED;
+}
+
+/**
+  Flushes all modified data associated with a file to a device, and signals
+  the token event once done.
+
+  @param[in]      This    A pointer to the EFI_FILE_PROTOCOL instance.
+  @param[in, out] Token   The token associated with the request.
+
+  @retval EFI_SUCCESS            The request was completed; Token->Status
+                                 holds its result.
+  @retval EFI_INVALID_PARAMETER  Token is NULL.
+
+**/
+EFI_STATUS
+EFIAPI
+Ext4FlushEx (
+  IN     EFI_FILE_PROTOCOL  *This,
+  IN OUT EFI_FILE_IO_TOKEN  *Token
+  )
+{
+  if (Token == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Token->Status = Ext4Flush (This);
+  gBS->SignalEvent (Token->Event);
+  return EFI_SUCCESS;
+}
+
+/**
+  Read the whole contents of an open file into a caller provided buffer.
+
+  The file is read through its decoded block map, one DiskIo request per
+  physically contiguous run straight into Buffer. The file position of File
+  is not changed.
+
+  @param[in]      This        The EDKII_FILE_BULK_READ_PROTOCOL instance of
+                              the volume.
+  @param[in]      File        The file handle.
+  @param[in, out] BufferSize  On input size of buffer, on output amount of
+                              data in buffer, or the size of the file if the
+                              buffer is too small.
+  @param[out]     Buffer      The buffer in which data is read.
+
+  @retval EFI_SUCCESS            The file was read.
+  @retval EFI_BUFFER_TOO_SMALL   BufferSize is too small. BufferSize contains
+                                 required size.
+  @retval EFI_INVALID_PARAMETER  File is not a regular file of this volume.
+  @retval EFI_DEVICE_ERROR       The device reported an error.
+  @retval EFI_VOLUME_CORRUPTED   The file system structures are corrupted.
+
+**/
+EFI_STATUS
+EFIAPI
+Ext4BulkReadFile (
+  IN     EDKII_FILE_BULK_READ_PROTOCOL  *This,
+  IN     EFI_FILE_PROTOCOL              *File,
+  IN OUT UINTN                          *BufferSize,
+  OUT    VOID                           *Buffer
+  )
+{
+  EFI_STATUS      Status;
+  EXT4_PARTITION  *Partition;
+  EXT4_FILE       *Ext4File;
+  EFI_TPL         OldTpl;
+
+  if ((This == NULL) || (File == NULL) || (BufferSize == NULL) ||
+      ((*BufferSize != 0) && (Buffer == NULL)))
+  {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  //
+  // Only files opened on this driver can be read.
+  //
+  if (File->Read != Ext4Read) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Partition = EXT4_PARTITION_FROM_BULK_READ (This);
+  Ext4File  = EXT4_FILE_FROM_THIS (File);
+  if ((Ext4File->Partition != Partition) || Ext4InodeIsDir (Ext4File->Inode)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (*BufferSize < Ext4File->Size) {
+    *BufferSize = (UINTN)Ext4File->Size;
+    return EFI_BUFFER_TOO_SMALL;
+  }
+
+  OldTpl = gBS->RaiseTPL (TPL_CALLBACK);
+  Status = Ext4ReadFileData (Ext4File, 0, (UINTN)Ext4File->Size, Buffer);
+  gBS->RestoreTPL (OldTpl);
+
+  if (!EFI_ERROR (Status)) {
+    *BufferSize = (UINTN)Ext4File->Size;
+  }
+
+  return Status;
+}
@@ -0,0 +1,323 @@
+/** @file
+  Directory index hash functions of the ext4 driver.
+
+  These follow the algorithms of fs/ext4/hash.c in Linux: the legacy hash,
+  half MD4 and TEA, each in a signed and an unsigned character variant. The
+  variant is selected by the EXT4_FLAGS_*_HASH flags of the superblock.
+
+  Copyright (c) 2021, EDK II contributors. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "Ext4Dxe.h"
+
+//
+// The major hash value reserved for the end of a directory.
+//
+#define EXT4_HTREE_EOF_32BIT  0x7FFFFFFF
+
+#define EXT4_TEA_DELTA  0x9E3779B9
+
+#define EXT4_MD4_K1  0
+#define EXT4_MD4_K2  0x5A827999
+#define EXT4_MD4_K3  0x6ED9EBA1
+
+#define EXT4_MD4_F(x, y, z)  ((z) ^ ((x) & ((y) ^ (z))))
+#define EXT4_MD4_G(x, y, z)  (((x) & (y)) + (((x) ^ (y)) & (z)))
+#define EXT4_MD4_H(x, y, z)  ((x) ^ (y) ^ (z))
+
+#define EXT4_MD4_ROUND(f, a, b, c, d, x, s) \
+  do { \
+    (a) += f ((b), (c), (d)) + (x); \
+    (a)  = (((a) << (s)) | ((a) >> (32 - (s)))); \
+  } while (FALSE)
+
+/**
+  The TEA block cipher, used as a hash.
+
+  @param[in, out] Buffer    The hash state.
+  @param[in]      Data      Four words of input.
+
+**/
+STATIC
+VOID
+Ext4TeaTransform (
+  IN OUT UINT32        Buffer[4],
+  IN     CONST UINT32  Data[4]
+  )
+{
+  UINT32  Sum;
+  UINT32  B0;
+  UINT32  B1;
+  UINTN   Round;
+
+  Sum = 0;
+  B0  = Buffer[0];
+  B1  = Buffer[1];
+
+  for (Round = 0; Round < 16; Round++) {
+    Sum += EXT4_TEA_DELTA;
+    B0  += ((B1 << 4) + Data[0]) ^ (B1 + Sum) ^ ((B1 >> 5) + Data[1]);
+    B1  += ((B0 << 4) + Data[2]) ^ (B0 + Sum) ^ ((B0 >> 5) + Data[3]);
+  }
+
+  Buffer[0] += B0;
+  Buffer[1] += B1;
+}
+
+/**
+  The MD4 compression function, reduced to 24 rounds.
+
+  @param[in, out] Buffer    The hash state.
+  @param[in]      Data      Eight words of input.
+
+**/
+STATIC
+VOID
+Ext4HalfMd4Transform (
+  IN OUT UINT32        Buffer[4],
+  IN     CONST UINT32  Data[8]
+  )
+{
+  UINT32  A;
+  UINT32  B;
+  UINT32  C;
+  UINT32  D;
+
+  A = Buffer[0];
+  B = Buffer[1];
+  C = Buffer[2];
+  D = Buffer[3];
+
+  EXT4_MD4_ROUND (EXT4_MD4_F, A, B, C, D, Data[0] + EXT4_MD4_K1, 3);
+  EXT4_MD4_ROUND (EXT4_MD4_F, D, A, B, C, Data[1] + EXT4_MD4_K1, 7);
+  EXT4_MD4_ROUND (EXT4_MD4_F, C, D, A, B, Data[2] + EXT4_MD4_K1, 11);
+  EXT4_MD4_ROUND (EXT4_MD4_F, B, C, D, A, Data[3] + EXT4_MD4_K1, 19);
+  EXT4_MD4_ROUND (EXT4_MD4_F, A, B, C, D, Data[4] + EXT4_MD4_K1, 3);
+  EXT4_MD4_ROUND (EXT4_MD4_F, D, A, B, C, Data[5] + EXT4_MD4_K1, 7);
+  EXT4_MD4_ROUND (EXT4_MD4_F, C, D, A, B, Data[6] + EXT4_MD4_K1, 11);
+  EXT4_MD4_ROUND (EXT4_MD4_F, B, C, D, A, Data[7] + EXT4_MD4_K1, 19);
+
+  EXT4_MD4_ROUND (EXT4_MD4_G, A, B, C, D, Data[1] + EXT4_MD4_K2, 3);
+  EXT4_MD4_ROUND (EXT4_MD4_G, D, A, B, C, Data[3] + EXT4_MD4_K2, 5);
+  EXT4_MD4_ROUND (EXT4_MD4_G, C, D, A, B, Data[5] + EXT4_MD4_K2, 9);
+  EXT4_MD4_ROUND (EXT4_MD4_G, B, C, D, A, Data[7] + EXT4_MD4_K2, 13);
+  EXT4_MD4_ROUND (EXT4_MD4_G, A, B, C, D, Data[0] + EXT4_MD4_K2, 3);
+  EXT4_MD4_ROUND (EXT4_MD4_G, D, A, B, C, Data[2] + EXT4_MD4_K2, 5);
+  EXT4_MD4_ROUND (EXT4_MD4_G, C, D, A, B, Data[4] + EXT4_MD4_K2, 9);
+  EXT4_MD4_ROUND (EXT4_MD4_G, B, C, D, A, Data[6] + EXT4_MD4_K2, 13);
+
+  EXT4_MD4_ROUND (EXT4_MD4_H, A, B, C, D, Data[3] + EXT4_MD4_K3, 3);
+  EXT4_MD4_ROUND (EXT4_MD4_H, D, A, B, C, Data[7] + EXT4_MD4_K3, 9);
+  EXT4_MD4_ROUND (EXT4_MD4_H, C, D, A, B, Data[2] + EXT4_MD4_K3, 11);
+  EXT4_MD4_ROUND (EXT4_MD4_H, B, C, D, A, Data[6] + EXT4_MD4_K3, 15);
+  EXT4_MD4_ROUND (EXT4_MD4_H, A, B, C, D, Data[1] + EXT4_MD4_K3, 3);
+  EXT4_MD4_ROUND (EXT4_MD4_H, D, A, B, C, Data[5] + EXT4_MD4_K3, 9);
+  EXT4_MD4_ROUND (EXT4_MD4_H, C, D, A, B, Data[0] + EXT4_MD4_K3, 11);
+  EXT4_MD4_ROUND (EXT4_MD4_H, B, C, D, A, Data[4] + EXT4_MD4_K3, 15);
+
+  Buffer[0] += A;
+  Buffer[1] += B;
+  Buffer[2] += C;
+  Buffer[3] += D;
+}
+
+/**
+  Return a character of a name as an integer, sign extended for the signed
+  hash variants.
+
+  @param[in]  Character   The character.
+  @param[in]  Unsigned    Use the unsigned variant.
+
+  @return The character as a 32-bit value.
+
+**/
+STATIC
+UINT32
+Ext4HashChar (
+  IN CHAR8    Character,
+  IN BOOLEAN  Unsigned
+  )
+{
+  if (Unsigned) {
+    return (UINT8)Character;
+  }
+
+  return (UINT32)(INT32)(INT8)Character;
+}
+
+/**
+  The legacy directory hash of ext3.
+
+  @param[in]  Name          The name.
+  @param[in]  NameLength    The length of Name in bytes.
+  @param[in]  Unsigned      Use the unsigned variant.
+
+  @return The hash of Name.
+
+**/
+STATIC
+UINT32
+Ext4LegacyHash (
+  IN CONST CHAR8  *Name,
+  IN UINTN        NameLength,
+  IN BOOLEAN      Unsigned
+  )
+{
+  UINT32  Hash;
+  UINT32  Hash0;
+  UINT32  Hash1;
+
+  Hash0 = 0x12A3FE2D;
+  Hash1 = 0x37ABE8F9;
+
+  while (NameLength-- > 0) {
+    Hash = Hash1 + (Hash0 ^ (Ext4HashChar (*Name++, Unsigned) * 7152373));
+    if ((Hash & BIT31) != 0) {
+      Hash -= 0x7FFFFFFF;
+    }
+
+    Hash1 = Hash0;
+    Hash0 = Hash;
+  }
+
+  return Hash0 << 1;
+}
+
+/**
+  Pack up to Count * 4 bytes of a name into words of hash input, padding
+  with a value derived from the length of the name.
+
+  @param[in]  Name          The remaining part of the name.
+  @param[in]  NameLength    The length of the remaining part in bytes.
+  @param[out] Buffer        The Count words of hash input.
+  @param[in]  Count         The number of words to fill.
+  @param[in]  Unsigned      Use the unsigned variant.
+
+**/
+STATIC
+VOID
+Ext4StrToHashBuf (
+  IN  CONST CHAR8  *Name,
+  IN  UINTN        NameLength,
+  OUT UINT32       *Buffer,
+  IN  INTN         Count,
+  IN  BOOLEAN      Unsigned
+  )
+{
+  UINT32  Pad;
+  UINT32  Value;
+  UINTN   Index;
+
+  Pad  = (UINT32)NameLength | ((UINT32)NameLength << 8);
+  Pad |= Pad << 16;
+
+  Value = Pad;
+  if (NameLength > (UINTN)Count * 4) {
+    NameLength = (UINTN)Count * 4;
+  }
+
+  for (Index = 0; Index < NameLength; Index++) {
+    Value = Ext4HashChar (Name[Index], Unsigned) + (Value << 8);
+    if ((Index % 4) == 3) {
+      *Buffer++ = Value;
+      Value     = Pad;
+      Count--;
+    }
+  }
+
+  if (--Count >= 0) {
+    *Buffer++ = Value;
+  }
+
+  while (--Count >= 0) {
+    *Buffer++ = Pad;
+  }
+}
+
+/**
+  Compute the htree hash of a directory entry name.
+
+  @param[in]  Partition     The volume, providing the hash seed.
+  @param[in]  HashVersion   One of the EXT4_DX_HASH_* algorithms.
+  @param[in]  Name          The name, in UTF-8.
+  @param[in]  NameLength    The length of Name in bytes.
+  @param[out] Hash          The major hash of Name.
+
+  @retval EFI_SUCCESS       Hash was computed.
+  @retval EFI_UNSUPPORTED   HashVersion is unknown.
+
+**/
+EFI_STATUS
+Ext4DirHash (
+  IN  EXT4_PARTITION  *Partition,
+  IN  UINT8           HashVersion,
+  IN  CONST CHAR8     *Name,
+  IN  UINTN           NameLength,
+  OUT UINT32          *Hash
+  )
+{
+  UINT32   Buffer[4];
+  UINT32   Input[8];
+  UINT32   *Seed;
+  BOOLEAN  Unsigned;
+  INTN     Remaining;
+
+  //
+  // Use the seed of the superblock, unless it is all zeros.
+  //
+  Seed = Partition->SuperBlock.s_hash_seed;
+  if ((Seed[0] | Seed[1] | Seed[2] | Seed[3]) != 0) {
+    CopyMem (Buffer, Seed, sizeof (Buffer));
+  } else {
+    Buffer[0] = 0x67452301;
+    Buffer[1] = 0xEFCDAB89;
+    Buffer[2] = 0x98BADCFE;
+    Buffer[3] = 0x10325476;
+  }
+
+  Unsigned  = (BOOLEAN)(HashVersion >= EXT4_DX_HASH_LEGACY_UNSIGNED);
+  Remaining = (INTN)NameLength;
+
+  switch (HashVersion) {
+    case EXT4_DX_HASH_LEGACY:
+    case EXT4_DX_HASH_LEGACY_UNSIGNED:
+      *Hash = Ext4LegacyHash (Name, NameLength, Unsigned);
+      break;
+
+    case EXT4_DX_HASH_HALF_MD4:
+    case EXT4_DX_HASH_HALF_MD4_UNSIGNED:
+      while (Remaining > 0) {
+        Ext4StrToHashBuf (Name, (UINTN)Remaining, Input, 8, Unsigned);
+        Ext4HalfMd4Transform (Buffer, Input);
+        Remaining -= 32;
+        Name      += 32;
+      }
+
+      *Hash = Buffer[1];
+      break;
+
+    case EXT4_DX_HASH_TEA:
+    case EXT4_DX_HASH_TEA_UNSIGNED:
+      while (Remaining > 0) {
+        Ext4StrToHashBuf (Name, (UINTN)Remaining, Input, 4, Unsigned);
+        Ext4TeaTransform (Buffer, Input);
+        Remaining -= 16;
+        Name      += 16;
+      }
+
+      *Hash = Buffer[0];
+      break;
+
+    default:
+      return EFI_UNSUPPORTED;
+  }
+
+  *Hash &= ~(UINT32)1;
+  if (*Hash == (EXT4_HTREE_EOF_32BIT << 1)) {
+    *Hash = (EXT4_HTREE_EOF_32BIT - 1) << 1;
+  }
+
+  return EFI_SUCCESS;
+}
@@ -0,0 +1,531 @@
+/** @file
+  Inode handling of the ext4 driver.
+
+  Copyright (c) 2021, EDK II contributors. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "Ext4Dxe.h"
+
+#define EXT4_SECONDS_PER_DAY  86400
+
+//
+// Check whether an optional field of the large inode format is present in
+// an inode.
+//
+#define EXT4_INODE_HAS_FIELD(Partition, Inode, Field) \
+  (((Partition)->InodeSize > EXT4_GOOD_OLD_INODE_SIZE) && \
+   (EXT4_GOOD_OLD_INODE_SIZE + (Inode)->i_extra_isize >= \
+    OFFSET_OF (EXT4_INODE, Field) + sizeof ((Inode)->Field)))
+
+/**
+  Read an inode from the volume, or from its inode cache.
+
+  @param[in]  Partition          The volume.
+  @param[in]  InodeNum           The inode number.
+  @param[out] Inode              The inode, at least sizeof (EXT4_INODE)
+                                 bytes, to be freed with FreePool().
+
+  @retval EFI_SUCCESS            The inode was read.
+  @retval EFI_VOLUME_CORRUPTED   InodeNum is out of range.
+  @retval EFI_OUT_OF_RESOURCES   The inode could not be allocated.
+  @return others                 An error occurred reading the volume.
+
+**/
+EFI_STATUS
+Ext4ReadInode (
+  IN  EXT4_PARTITION  *Partition,
+  IN  UINT32          InodeNum,
+  OUT EXT4_INODE      **Inode
+  )
+{
+  EFI_STATUS  Status;
+  UINT32      Group;
+  UINT32      Index;
+  UINT64      InodeTable;
+  EXT4_INODE  *Buffer;
+
+  if ((InodeNum == 0) || (InodeNum > Partition->SuperBlock.s_inodes_count)) {
+    return EFI_VOLUME_CORRUPTED;
+  }
+
+  Status = Ext4LookupInodeCache (Partition, InodeNum, Inode);
+  if (Status != EFI_NOT_FOUND) {
+    return Status;
+  }
+
+  Group = (InodeNum - 1) / Partition->SuperBlock.s_inodes_per_group;
+  Index = (InodeNum - 1) % Partition->SuperBlock.s_inodes_per_group;
+
+  Status = Ext4GetInodeTable (Partition, Group, &InodeTable);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Buffer = AllocateZeroPool (MAX (Partition->InodeSize, sizeof (EXT4_INODE)));
+  if (Buffer == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Status = Ext4ReadDiskIo (
+             Partition,
+             Ext4BlockToByteOffset (Partition, InodeTable) + MultU64x32 (Index, Partition->InodeSize),
+             Partition->InodeSize,
+             Buffer
+             );
+  if (EFI_ERROR (Status)) {
+    FreePool (Buffer);
+    return Status;
+  }
+
+  //
+  // Ignore extra fields that do not fit in the inode.
+  //
+  if ((Partition->InodeSize == EXT4_GOOD_OLD_INODE_SIZE) ||
+      (EXT4_GOOD_OLD_INODE_SIZE + Buffer->i_extra_isize > Partition->InodeSize))
+  {
+    Buffer->i_extra_isize = 0;
+  }
+
+  Ext4InsertInodeCache (Partition, InodeNum, Buffer);
+  *Inode = Buffer;
+  return EFI_SUCCESS;
+}
+
+/**
+  Return the size in bytes of the data of an inode.
+
+  @param[in]  Inode   The inode.
+
+  @return The size of the inode data.
+
+**/
+UINT64
+Ext4InodeSize (
+  IN EXT4_INODE  *Inode
+  )
+{
+  return LShiftU64 (Inode->i_size_high, 32) | Inode->i_size_lo;
+}
+
+/**
+  Return the number of bytes the volume allocates to an inode.
+
+  @param[in]  Partition   The volume.
+  @param[in]  Inode       The inode.
+
+  @return The physical size of the inode.
+
+**/
+UINT64
+Ext4InodePhysicalSize (
+  IN EXT4_PARTITION  *Partition,
+  IN EXT4_INODE      *Inode
+  )
+{
+  UINT64  Blocks;
+
+  Blocks = Inode->i_blocks_lo;
+  if ((Partition->FeaturesRoCompat & EXT4_FEATURE_RO_COMPAT_HUGE_FILE) != 0) {
+    Blocks |= LShiftU64 (Inode->l_i_blocks_high, 32);
+    if ((Inode->i_flags & EXT4_HUGE_FILE_FL) != 0) {
+      return LShiftU64 (Blocks, Partition->BlockLogSize);
+    }
+  }
+
+  return MultU64x32 (Blocks, 512);
+}
+
+/**
+  Check whether an inode is a directory.
+
+  @param[in]  Inode   The inode.
+
+  @retval TRUE        The inode is a directory.
+  @retval FALSE       The inode is not a directory.
+
+**/
+BOOLEAN
+Ext4InodeIsDir (
+  IN EXT4_INODE  *Inode
+  )
+{
+  return (BOOLEAN)((Inode->i_mode & EXT4_INODE_TYPE_MASK) == EXT4_INODE_TYPE_DIR);
+}
+
+/**
+  Check whether an inode is a symbolic link.
+
+  @param[in]  Inode   The inode.
+
+  @retval TRUE        The inode is a symbolic link.
+  @retval FALSE       The inode is not a symbolic link.
+
+**/
+BOOLEAN
+Ext4InodeIsSymlink (
+  IN EXT4_INODE  *Inode
+  )
+{
+  return (BOOLEAN)((Inode->i_mode & EXT4_INODE_TYPE_MASK) == EXT4_INODE_TYPE_SYMLINK);
+}
+
+/**
+  Convert an ext4 timestamp to an EFI_TIME.
+
+  @param[in]  Seconds       The low 32 bits of the seconds since the Unix
+                            epoch, as a signed number.
+  @param[in]  Extra         The matching *_extra field: the epoch extension in
+                            bits 0-1 and the nanoseconds in bits 2-31.
+  @param[in]  HasExtra      Extra is present in the inode.
+  @param[out] Time          The EFI_TIME.
+
+**/
+STATIC
+VOID
+Ext4ConvertTime (
+  IN  UINT32    Seconds,
+  IN  UINT32    Extra,
+  IN  BOOLEAN   HasExtra,
+  OUT EFI_TIME  *Time
+  )
+{
+  INT64   Total;
+  INT64   Days;
+  UINT32  SecondOfDay;
+  INT64   Era;
+  UINT32  DayOfEra;
+  UINT32  YearOfEra;
+  UINT32  DayOfYear;
+  UINT32  MonthIndex;
+  INT64   Year;
+
+  ZeroMem (Time, sizeof (EFI_TIME));
+
+  Total = (INT32)Seconds;
+  if (HasExtra) {
+    Total += (INT64)LShiftU64 (Extra & 3, 32);
+    Time->Nanosecond = Extra >> 2;
+  }
+
+  //
+  // Split the time into days and seconds, rounding towards minus infinity.
+  //
+  if (Total >= 0) {
+    Days = (INT64)DivU64x32Remainder ((UINT64)Total, EXT4_SECONDS_PER_DAY, &SecondOfDay);
+  } else {
+    Days = -(INT64)DivU64x32Remainder ((UINT64)-Total, EXT4_SECONDS_PER_DAY, &SecondOfDay);
+    if (SecondOfDay != 0) {
+      Days--;
+      SecondOfDay = EXT4_SECONDS_PER_DAY - SecondOfDay;
+    }
+  }
+
+  Time->Hour   = (UINT8)(SecondOfDay / 3600);
+  Time->Minute = (UINT8)((SecondOfDay % 3600) / 60);
+  Time->Second = (UINT8)(SecondOfDay % 60);
+
+  //
+  // Convert the days since 1970-01-01 to a civil date, using eras of 400
+  // years that start on March 1st.
+  //
+  Days += 719468;
+  if (Days >= 0) {
+    Era = (INT64)DivU64x32 ((UINT64)Days, 146097);
+  } else {
+    Era = -(INT64)DivU64x32 ((UINT64)(-Days + 146096), 146097);
+  }
+
+  DayOfEra   = (UINT32)(Days - (INT64)MultU64x32 ((UINT64)Era, 146097));
+  YearOfEra  = (DayOfEra - DayOfEra / 1460 + DayOfEra / 36524 - DayOfEra / 146096) / 365;
+  DayOfYear  = DayOfEra - (365 * YearOfEra + YearOfEra / 4 - YearOfEra / 100);
+  MonthIndex = (5 * DayOfYear + 2) / 153;
+  Year       = (INT64)MultU64x32 ((UINT64)Era, 400) + YearOfEra;
+
+  Time->Day   = (UINT8)(DayOfYear - (153 * MonthIndex + 2) / 5 + 1);
+  Time->Month = (UINT8)(MonthIndex < 10 ? MonthIndex + 3 : MonthIndex - 9);
+  if (Time->Month <= 2) {
+    Year++;
+  }
+
+  //
+  // EFI_TIME cannot hold years before 1900 or after 9999.
+  //
+  if (Year < 1900) {
+    ZeroMem (Time, sizeof (EFI_TIME));
+    Time->Year  = 1900;
+    Time->Month = 1;
+    Time->Day   = 1;
+  } else if (Year > 9999) {
+    Time->Year = 9999;
+  } else {
+    Time->Year = (UINT16)Year;
+  }
+
+  Time->TimeZone = EFI_UNSPECIFIED_TIMEZONE;
+}
+
+/**
+  Fill in the sizes, times and attributes of an EFI_FILE_INFO from an inode.
+
+  @param[in]  Partition   The volume.
+  @param[in]  Inode       The inode.
+  @param[out] Info        The EFI_FILE_INFO to fill in, except for Size and
+                          FileName.
+
+**/
+VOID
+Ext4InodeToFileInfo (
+  IN  EXT4_PARTITION  *Partition,
+  IN  EXT4_INODE      *Inode,
+  OUT EFI_FILE_INFO   *Info
+  )
+{
+  Info->FileSize     = Ext4InodeSize (Inode);
+  Info->PhysicalSize = Ext4InodePhysicalSize (Partition, Inode);
+
+  Ext4ConvertTime (
+    Inode->i_atime,
+    Inode->i_atime_extra,
+    EXT4_INODE_HAS_FIELD (Partition, Inode, i_atime_extra),
+    &Info->LastAccessTime
+    );
+  Ext4ConvertTime (
+    Inode->i_mtime,
+    Inode->i_mtime_extra,
+    EXT4_INODE_HAS_FIELD (Partition, Inode, i_mtime_extra),
+    &Info->ModificationTime
+    );
+  if (EXT4_INODE_HAS_FIELD (Partition, Inode, i_crtime)) {
+    Ext4ConvertTime (
+      Inode->i_crtime,
+      Inode->i_crtime_extra,
+      EXT4_INODE_HAS_FIELD (Partition, Inode, i_crtime_extra),
+      &Info->CreateTime
+      );
+  } else {
+    //
+    // Inodes without a creation time report the inode change time instead.
+    //
+    Ext4ConvertTime (
+      Inode->i_ctime,
+      Inode->i_ctime_extra,
+      EXT4_INODE_HAS_FIELD (Partition, Inode, i_ctime_extra),
+      &Info->CreateTime
+      );
+  }
+
+  Info->Attribute = EFI_FILE_READ_ONLY;
+  if (Ext4InodeIsDir (Inode)) {
+    Info->Attribute |= EFI_FILE_DIRECTORY;
+  }
+}
+
+/**
+  Read data from an open file, whatever its position.
+
+  Each physically contiguous run of the file is read with a single disk
+  request, straight into Buffer. With EFI_DISK_IO2_PROTOCOL, the requests
+  of several runs are in flight at once.
+
+  @param[in]  File               The file.
+  @param[in]  Offset             The byte offset in the file.
+  @param[in]  Length             The number of bytes to read. Offset + Length
+                                 must not be beyond the end of the file.
+  @param[out] Buffer             The buffer receiving the data.
+
+  @retval EFI_SUCCESS            The data was read.
+  @retval EFI_UNSUPPORTED        The file data is stored in a format this
+                                 driver cannot read.
+  @retval EFI_VOLUME_CORRUPTED   The block map of the file is invalid.
+  @return others                 An error occurred reading the volume.
+
+**/
+EFI_STATUS
+Ext4ReadFileData (
+  IN  EXT4_FILE  *File,
+  IN  UINT64     Offset,
+  IN  UINTN      Length,
+  OUT VOID       *Buffer
+  )
+{
+  EFI_STATUS      Status;
+  EXT4_PARTITION  *Partition;
+  EXT4_BLOCK_RUN  *Run;
+  EXT4_BLOCK_RUN  *Next;
+  UINT8           *Destination;
+  UINT64          FileBlock;
+  UINT32          BlockOffset;
+  UINT64          RunEnd;
+  UINT64          Chunk;
+  EFI_STATUS      ReadStatus;
+
+  Partition   = File->Partition;
+  Status      = EFI_SUCCESS;
+  Destination = Buffer;
+
+  ASSERT (Offset + Length <= File->Size);
+
+  if ((File->Inode->i_flags & EXT4_ENCRYPT_FL) != 0) {
+    return EFI_UNSUPPORTED;
+  }
+
+  if ((File->Inode->i_flags & EXT4_INLINE_DATA_FL) != 0) {
+    //
+    // Only the part of the inline data stored in i_block is supported; the
+    // rest lives in the system.data extended attribute.
+    //
+    if (File->Size > sizeof (File->Inode->i_block)) {
+      return EFI_UNSUPPORTED;
+    }
+
+    CopyMem (Destination, (UINT8 *)File->Inode->i_block + Offset, Length);
+    return EFI_SUCCESS;
+  }
+
+  if (!File->BlockMapValid && !Ext4TakeCachedBlockMap (File)) {
+    Status = Ext4BuildBlockMap (File);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+  }
+
+  while (Length > 0) {
+    FileBlock   = RShiftU64 (Offset, Partition->BlockLogSize);
+    BlockOffset = (UINT32)Offset & (Partition->BlockSize - 1);
+
+    Run = Ext4LookupBlockRun (&File->BlockMap, FileBlock, &Next);
+    if (Run != NULL) {
+      RunEnd = Run->FileBlock + Run->Length;
+    } else if (Next != NULL) {
+      RunEnd = Next->FileBlock;
+    } else {
+      RunEnd = RShiftU64 (MAX_UINT64, Partition->BlockLogSize);
+    }
+
+    Chunk = Ext4BlockToByteOffset (Partition, RunEnd - FileBlock) - BlockOffset;
+    if (Chunk > Length) {
+      Chunk = Length;
+    }
+
+    if ((Run == NULL) || Run->Unwritten) {
+      ZeroMem (Destination, (UINTN)Chunk);
+    } else {
+      Status = Ext4QueueDiskRead (
+                 Partition,
+                 Ext4BlockToByteOffset (Partition, Run->DiskBlock + (FileBlock - Run->FileBlock)) + BlockOffset,
+                 (UINTN)Chunk,
+                 Destination
+                 );
+      if (EFI_ERROR (Status)) {
+        break;
+      }
+    }
+
+    Destination += Chunk;
+    Offset      += Chunk;
+    Length      -= (UINTN)Chunk;
+  }
+
+  //
+  // Buffer belongs to the caller again only once every queued read is done.
+  //
+  ReadStatus = Ext4WaitDiskReads (Partition);
+  if (!EFI_ERROR (Status)) {
+    Status = ReadStatus;
+  }
+
+  return Status;
+}
+
+/**
+  Read data from an open file through its readahead buffer.
+
+  Sequential reads smaller than the readahead window fetch a whole window
+  into the readahead buffer of the file, and the window grows with each
+  sequential read; other reads go straight to Ext4ReadFileData().
+
+  @param[in]  File               The file.
+  @param[in]  Offset             The byte offset in the file.
+  @param[in]  Length             The number of bytes to read. Offset + Length
+                                 must not be beyond the end of the file.
+  @param[out] Buffer             The buffer receiving the data.
+
+  @retval EFI_SUCCESS            The data was read.
+  @return others                 The error returned by Ext4ReadFileData().
+
+**/
+EFI_STATUS
+Ext4ReadFileDataAhead (
+  IN  EXT4_FILE  *File,
+  IN  UINT64     Offset,
+  IN  UINTN      Length,
+  OUT VOID       *Buffer
+  )
+{
+  EFI_STATUS  Status;
+  UINT8       *Destination;
+  UINTN       Chunk;
+  UINT64      Remaining;
+  BOOLEAN     Sequential;
+
+  Destination = Buffer;
+
+  Sequential = (BOOLEAN)(Offset == File->NextReadOffset);
+  if (Sequential && (File->ReadAheadWindow != 0)) {
+    File->ReadAheadWindow = MIN (File->ReadAheadWindow * 2, EXT4_MAX_READAHEAD);
+  } else {
+    File->ReadAheadWindow = EXT4_MIN_READAHEAD;
+  }
+
+  File->NextReadOffset = Offset + Length;
+
+  //
+  // Copy what the readahead buffer already holds.
+  //
+  if ((File->ReadAheadLength > 0) &&
+      (Offset >= File->ReadAheadOffset) &&
+      (Offset - File->ReadAheadOffset < File->ReadAheadLength))
+  {
+    Chunk = File->ReadAheadLength - (UINTN)(Offset - File->ReadAheadOffset);
+    Chunk = MIN (Chunk, Length);
+    CopyMem (Destination, File->ReadAhead + (UINTN)(Offset - File->ReadAheadOffset), Chunk);
+    Destination += Chunk;
+    Offset      += Chunk;
+    Length      -= Chunk;
+  }
+
+  if (Length == 0) {
+    return EFI_SUCCESS;
+  }
+
+  //
+  // Random reads, and reads at least as large as the window, go straight to
+  // the caller buffer.
+  //
+  if (!Sequential || (Length >= File->ReadAheadWindow)) {
+    return Ext4ReadFileData (File, Offset, Length, Destination);
+  }
+
+  if (File->ReadAhead == NULL) {
+    File->ReadAhead = AllocatePool (EXT4_MAX_READAHEAD);
+    if (File->ReadAhead == NULL) {
+      return Ext4ReadFileData (File, Offset, Length, Destination);
+    }
+  }
+
+  Remaining = File->Size - Offset;
+  Chunk     = (Remaining < File->ReadAheadWindow) ? (UINTN)Remaining : File->ReadAheadWindow;
+
+  File->ReadAheadLength = 0;
+  Status                = Ext4ReadFileData (File, Offset, Chunk, File->ReadAhead);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  File->ReadAheadOffset = Offset;
+  File->ReadAheadLength = Chunk;
+  CopyMem (Destination, File->ReadAhead, Length);
+  return EFI_SUCCESS;
+}
@@ -0,0 +1,182 @@
+/** @file
+  Mounting and unmounting of ext4 volumes.
+
+  Copyright (c) 2021, EDK II contributors. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "Ext4Dxe.h"
+
+/**
+  Mount the ext4 file system of a disk and install EFI_SIMPLE_FILE_SYSTEM_PROTOCOL
+  and EDKII_FILE_BULK_READ_PROTOCOL on its handle.
+
+  @param[in]  Handle          The handle of the disk.
+  @param[in]  DiskIo          The EFI_DISK_IO_PROTOCOL of the disk.
+  @param[in]  DiskIo2         The EFI_DISK_IO2_PROTOCOL of the disk, or NULL.
+  @param[in]  BlockIo         The EFI_BLOCK_IO_PROTOCOL of the disk.
+
+  @retval EFI_SUCCESS         The file system was mounted.
+  @return others              The disk does not hold a supported file system,
+                              or an error occurred.
+
+**/
+EFI_STATUS
+Ext4OpenPartition (
+  IN EFI_HANDLE             Handle,
+  IN EFI_DISK_IO_PROTOCOL   *DiskIo,
+  IN EFI_DISK_IO2_PROTOCOL  *DiskIo2 OPTIONAL,
+  IN EFI_BLOCK_IO_PROTOCOL  *BlockIo
+  )
+{
+  EFI_STATUS      Status;
+  EXT4_PARTITION  *Partition;
+
+  Partition = AllocateZeroPool (sizeof (EXT4_PARTITION));
+  if (Partition == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Partition->Signature = EXT4_PARTITION_SIGNATURE;
+  Partition->Handle    = Handle;
+  Partition->DiskIo    = DiskIo;
+  Partition->DiskIo2   = DiskIo2;
+  Partition->BlockIo   = BlockIo;
+  InitializeListHead (&Partition->OpenFiles);
+  Ext4InitCaches (Partition);
+
+  Status = Ext4OpenSuperblock (Partition);
+  if (EFI_ERROR (Status)) {
+    goto Error;
+  }
+
+  Status = Ext4InitDiskReads (Partition);
+  if (EFI_ERROR (Status)) {
+    goto Error;
+  }
+
+  Partition->Interface.Revision   = EFI_SIMPLE_FILE_SYSTEM_PROTOCOL_REVISION;
+  Partition->Interface.OpenVolume = Ext4OpenVolume;
+  Partition->BulkRead.Revision    = EDKII_FILE_BULK_READ_PROTOCOL_REVISION;
+  Partition->BulkRead.ReadFile    = Ext4BulkReadFile;
+
+  Status = gBS->InstallMultipleProtocolInterfaces (
+                  &Partition->Handle,
+                  &gEfiSimpleFileSystemProtocolGuid,
+                  &Partition->Interface,
+                  &gEdkiiFileBulkReadProtocolGuid,
+                  &Partition->BulkRead,
+                  NULL
+                  );
+  if (EFI_ERROR (Status)) {
+    goto Error;
+  }
+
+  return EFI_SUCCESS;
+
+Error:
+  Ext4CleanupCaches (Partition);
+  Ext4FreeDiskReads (Partition);
+  if (Partition->InodeTables != NULL) {
+    FreePool (Partition->InodeTables);
+  }
+
+  FreePool (Partition);
+  return Status;
+}
+
+/**
+  Unmount a volume and uninstall its protocols.
+
+  @param[in]  Partition       The volume.
+
+  @retval EFI_SUCCESS         The volume was unmounted.
+  @retval EFI_ACCESS_DENIED   Files are still open on the volume.
+  @return others              The protocols could not be uninstalled.
+
+**/
+EFI_STATUS
+Ext4UnmountAndFreePartition (
+  IN EXT4_PARTITION  *Partition
+  )
+{
+  EFI_STATUS  Status;
+
+  if (!IsListEmpty (&Partition->OpenFiles)) {
+    return EFI_ACCESS_DENIED;
+  }
+
+  Status = gBS->UninstallMultipleProtocolInterfaces (
+                  Partition->Handle,
+                  &gEfiSimpleFileSystemProtocolGuid,
+                  &Partition->Interface,
+                  &gEdkiiFileBulkReadProtocolGuid,
+                  &Partition->BulkRead,
+                  NULL
+                  );
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Ext4CleanupCaches (Partition);
+  Ext4FreeDiskReads (Partition);
+  FreePool (Partition->InodeTables);
+  Partition->Signature = 0;
+  FreePool (Partition);
+  return EFI_SUCCESS;
+}
+
+/**
+  Open the root directory of a volume.
+
+  @param[in]  This                A pointer to the volume to open the root
+                                  directory of.
+  @param[out] Root                A pointer to the location to return the
+                                  opened file handle for the root directory.
+
+  @retval EFI_SUCCESS             The root directory was opened.
+  @retval EFI_VOLUME_CORRUPTED    The root inode is not a directory.
+  @retval EFI_OUT_OF_RESOURCES    The file handle could not be allocated.
+  @return others                  An error occurred reading the volume.
+
+**/
+EFI_STATUS
+EFIAPI
+Ext4OpenVolume (
+  IN  EFI_SIMPLE_FILE_SYSTEM_PROTOCOL  *This,
+  OUT EFI_FILE_PROTOCOL                **Root
+  )
+{
+  EFI_STATUS      Status;
+  EXT4_PARTITION  *Partition;
+  EXT4_INODE      *Inode;
+  EXT4_FILE       *File;
+  EFI_TPL         OldTpl;
+
+  Partition = EXT4_PARTITION_FROM_SIMPLE_FS (This);
+  OldTpl    = gBS->RaiseTPL (TPL_CALLBACK);
+
+  Status = Ext4ReadInode (Partition, EXT4_ROOT_INODE_NR, &Inode);
+  if (EFI_ERROR (Status)) {
+    goto Exit;
+  }
+
+  if (!Ext4InodeIsDir (Inode)) {
+    FreePool (Inode);
+    Status = EFI_VOLUME_CORRUPTED;
+    goto Exit;
+  }
+
+  Status = Ext4CreateFile (Partition, EXT4_ROOT_INODE_NR, Inode, L"", &File);
+  if (EFI_ERROR (Status)) {
+    FreePool (Inode);
+    goto Exit;
+  }
+
+  *Root = &File->Protocol;
+
+Exit:
+  gBS->RestoreTPL (OldTpl);
+  return Status;
+}
@@ -0,0 +1,366 @@
+/** @file
+  Superblock and block group descriptor handling of the ext4 driver.
+
+  Copyright (c) 2021, EDK II contributors. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "Ext4Dxe.h"
+
+/**
+  Check whether a number is a power of another.
+
+  @param[in]  Number  The number to check.
+  @param[in]  Base    The base.
+
+  @retval TRUE        Number is a power of Base.
+  @retval FALSE       Number is not a power of Base.
+
+**/
+STATIC
+BOOLEAN
+Ext4IsPowerOf (
+  IN UINT32  Number,
+  IN UINT32  Base
+  )
+{
+  while ((Number > 1) && ((Number % Base) == 0)) {
+    Number /= Base;
+  }
+
+  return (BOOLEAN)(Number == 1);
+}
+
+/**
+  Check whether a block group holds a backup of the superblock and of the
+  group descriptors.
+
+  @param[in]  Partition   The volume.
+  @param[in]  Group       The block group.
+
+  @retval TRUE            Group starts with a superblock.
+  @retval FALSE           Group does not start with a superblock.
+
+**/
+STATIC
+BOOLEAN
+Ext4GroupHasSuperblock (
+  IN EXT4_PARTITION  *Partition,
+  IN UINT32          Group
+  )
+{
+  if (Group == 0) {
+    return TRUE;
+  }
+
+  if ((Partition->FeaturesCompat & EXT4_FEATURE_COMPAT_SPARSE_SUPER2) != 0) {
+    return (BOOLEAN)((Group == Partition->SuperBlock.s_backup_bgs[0]) ||
+                     (Group == Partition->SuperBlock.s_backup_bgs[1]));
+  }
+
+  if ((Group == 1) || ((Partition->FeaturesRoCompat & EXT4_FEATURE_RO_COMPAT_SPARSE_SUPER) == 0)) {
+    return TRUE;
+  }
+
+  if ((Group & 1) == 0) {
+    return FALSE;
+  }
+
+  return (BOOLEAN)(Ext4IsPowerOf (Group, 3) || Ext4IsPowerOf (Group, 5) || Ext4IsPowerOf (Group, 7));
+}
+
+/**
+  Return the block holding a block of group descriptors.
+
+  Without META_BG, the descriptors follow the superblock of group 0. With
+  META_BG, each block of descriptors from s_first_meta_bg on is stored in
+  the first group it describes, after the backup superblock if that group
+  has one.
+
+  @param[in]  Partition     The volume.
+  @param[in]  Index         The index of the block of descriptors.
+
+  @return The block holding the descriptors.
+
+**/
+STATIC
+UINT64
+Ext4DescriptorBlock (
+  IN EXT4_PARTITION  *Partition,
+  IN UINT32          Index
+  )
+{
+  EXT4_SUPERBLOCK  *Sb;
+  UINT32           Group;
+  UINT64           Block;
+
+  Sb = &Partition->SuperBlock;
+
+  if (((Partition->FeaturesIncompat & EXT4_FEATURE_INCOMPAT_META_BG) == 0) ||
+      (Index < Sb->s_first_meta_bg))
+  {
+    return (UINT64)Sb->s_first_data_block + 1 + Index;
+  }
+
+  Group = Index * Partition->DescPerBlock;
+  Block = MultU64x32 (Group, Sb->s_blocks_per_group) + Sb->s_first_data_block;
+  if (Ext4GroupHasSuperblock (Partition, Group)) {
+    Block++;
+  }
+
+  //
+  // With 1KiB blocks, block 0 holds the boot sector and the superblock lives
+  // in block 1, even if s_first_data_block says otherwise.
+  //
+  if ((Partition->BlockSize == 1024) && (Index == 0) && (Sb->s_first_data_block == 0)) {
+    Block++;
+  }
+
+  return Block;
+}
+
+/**
+  Read and validate the superblock of a volume and initialize the volume
+  geometry and the block group descriptor cache.
+
+  @param[in, out] Partition     The volume, with BlockIo and DiskIo set.
+
+  @retval EFI_SUCCESS           The volume holds a supported ext2/3/4 file
+                                system.
+  @retval EFI_UNSUPPORTED       The volume does not hold an ext2/3/4 file
+                                system, or uses features this driver cannot
+                                read.
+  @retval EFI_OUT_OF_RESOURCES  The group descriptor cache could not be
+                                allocated.
+  @return others                An error occurred reading the volume.
+
+**/
+EFI_STATUS
+Ext4OpenSuperblock (
+  IN OUT EXT4_PARTITION  *Partition
+  )
+{
+  EFI_STATUS          Status;
+  EXT4_SUPERBLOCK     *Sb;
+  EFI_BLOCK_IO_MEDIA  *Media;
+  UINT64              DataBlocks;
+  UINT64              NumberGroups;
+  UINT64              DiskSize;
+  UINT32              Remainder;
+
+  Sb = &Partition->SuperBlock;
+
+  Status = Ext4ReadDiskIo (Partition, EXT4_SUPERBLOCK_OFFSET, sizeof (EXT4_SUPERBLOCK), Sb);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  if (Sb->s_magic != EXT4_SIGNATURE) {
+    return EFI_UNSUPPORTED;
+  }
+
+  if ((Sb->s_rev_level != EXT4_GOOD_OLD_REV) && (Sb->s_rev_level != EXT4_DYNAMIC_REV)) {
+    return EFI_UNSUPPORTED;
+  }
+
+  if (Sb->s_log_block_size > EXT4_MAX_BLOCK_LOG_SIZE - EXT4_MIN_BLOCK_LOG_SIZE) {
+    return EFI_UNSUPPORTED;
+  }
+
+  Partition->BlockLogSize = EXT4_MIN_BLOCK_LOG_SIZE + Sb->s_log_block_size;
+  Partition->BlockSize    = 1U << Partition->BlockLogSize;
+
+  if (Sb->s_rev_level == EXT4_GOOD_OLD_REV) {
+    Partition->FeaturesCompat   = 0;
+    Partition->FeaturesIncompat = 0;
+    Partition->FeaturesRoCompat = 0;
+    Partition->InodeSize        = EXT4_GOOD_OLD_INODE_SIZE;
+  } else {
+    Partition->FeaturesCompat   = Sb->s_feature_compat;
+    Partition->FeaturesIncompat = Sb->s_feature_incompat;
+    Partition->FeaturesRoCompat = Sb->s_feature_ro_compat;
+    Partition->InodeSize        = Sb->s_inode_size;
+  }
+
+  if ((Partition->FeaturesIncompat & ~EXT4_FEATURE_INCOMPAT_SUPPORTED) != 0) {
+    DEBUG ((
+      DEBUG_WARN,
+      "%a: unsupported incompatible features 0x%x\n",
+      __FUNCTION__,
+      Partition->FeaturesIncompat & ~EXT4_FEATURE_INCOMPAT_SUPPORTED
+      ));
+    return EFI_UNSUPPORTED;
+  }
+
+  if ((Partition->FeaturesIncompat & EXT4_FEATURE_INCOMPAT_RECOVER) != 0) {
+    //
+    // The journal is not replayed, so recently written metadata may not be
+    // visible yet.
+    //
+    DEBUG ((DEBUG_WARN, "%a: the journal needs recovery\n", __FUNCTION__));
+  }
+
+  if ((Partition->InodeSize < EXT4_GOOD_OLD_INODE_SIZE) ||
+      (Partition->InodeSize > Partition->BlockSize) ||
+      ((Partition->InodeSize & (Partition->InodeSize - 1)) != 0))
+  {
+    return EFI_UNSUPPORTED;
+  }
+
+  if ((Sb->s_blocks_per_group == 0) || (Sb->s_inodes_per_group == 0) ||
+      (Sb->s_inodes_count == 0))
+  {
+    return EFI_UNSUPPORTED;
+  }
+
+  Partition->NumberBlocks = Sb->s_blocks_count_lo;
+  if ((Partition->FeaturesIncompat & EXT4_FEATURE_INCOMPAT_64BIT) != 0) {
+    Partition->NumberBlocks |= LShiftU64 (Sb->s_blocks_count_hi, 32);
+    Partition->DescSize      = Sb->s_desc_size;
+    if ((Partition->DescSize < EXT4_64BIT_MIN_DESC_SIZE) ||
+        (Partition->DescSize > Partition->BlockSize) ||
+        ((Partition->DescSize & (Partition->DescSize - 1)) != 0))
+    {
+      return EFI_UNSUPPORTED;
+    }
+  } else {
+    Partition->DescSize = EXT4_GOOD_OLD_DESC_SIZE;
+  }
+
+  Partition->DescPerBlock = Partition->BlockSize / Partition->DescSize;
+
+  if (Sb->s_first_data_block >= Partition->NumberBlocks) {
+    return EFI_UNSUPPORTED;
+  }
+
+  //
+  // Refuse volumes larger than the partition, as Linux does.
+  //
+  Media    = Partition->BlockIo->Media;
+  DiskSize = MultU64x32 (Media->LastBlock + 1, Media->BlockSize);
+  if (Partition->NumberBlocks > RShiftU64 (DiskSize, Partition->BlockLogSize)) {
+    DEBUG ((DEBUG_WARN, "%a: the file system is larger than the partition\n", __FUNCTION__));
+    return EFI_UNSUPPORTED;
+  }
+
+  DataBlocks   = Partition->NumberBlocks - Sb->s_first_data_block;
+  NumberGroups = DivU64x32Remainder (DataBlocks, Sb->s_blocks_per_group, &Remainder);
+  if (Remainder != 0) {
+    NumberGroups++;
+  }
+
+  if ((NumberGroups > MAX_UINT32 / Partition->DescSize) ||
+      (Sb->s_inodes_count > MultU64x32 (NumberGroups, Sb->s_inodes_per_group)))
+  {
+    return EFI_UNSUPPORTED;
+  }
+
+  Partition->NumberGroups = (UINT32)NumberGroups;
+
+  if ((Sb->s_flags & EXT4_FLAGS_UNSIGNED_HASH) != 0) {
+    Partition->HashVersionOffset = EXT4_DX_HASH_LEGACY_UNSIGNED;
+  } else {
+    Partition->HashVersionOffset = 0;
+  }
+
+  Partition->InodeTables = AllocateZeroPool (Partition->NumberGroups * sizeof (UINT64));
+  if (Partition->InodeTables == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  DEBUG ((
+    DEBUG_INFO,
+    "%a: %Lu blocks of %u bytes, %u groups, features 0x%x/0x%x/0x%x\n",
+    __FUNCTION__,
+    Partition->NumberBlocks,
+    Partition->BlockSize,
+    Partition->NumberGroups,
+    Partition->FeaturesCompat,
+    Partition->FeaturesIncompat,
+    Partition->FeaturesRoCompat
+    ));
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Return the first block of the inode table of a block group, reading its
+  group descriptor block on a cache miss.
+
+  @param[in]  Partition          The volume.
+  @param[in]  Group              The block group.
+  @param[out] InodeTable         The first block of the inode table.
+
+  @retval EFI_SUCCESS            InodeTable was returned.
+  @retval EFI_VOLUME_CORRUPTED   Group or its descriptor is invalid.
+  @return others                 An error occurred reading the volume.
+
+**/
+EFI_STATUS
+Ext4GetInodeTable (
+  IN  EXT4_PARTITION  *Partition,
+  IN  UINT32          Group,
+  OUT UINT64          *InodeTable
+  )
+{
+  EFI_STATUS             Status;
+  UINT32                 Index;
+  UINT32                 FirstGroup;
+  UINT32                 Entry;
+  UINT8                  *Buffer;
+  EXT4_BLOCK_GROUP_DESC  *Desc;
+  UINT64                 Table;
+
+  if (Group >= Partition->NumberGroups) {
+    return EFI_VOLUME_CORRUPTED;
+  }
+
+  if (Partition->InodeTables[Group] == 0) {
+    //
+    // Decode the whole block of descriptors, as the neighbouring groups
+    // are likely to be needed next.
+    //
+    Index  = Group / Partition->DescPerBlock;
+    Buffer = AllocatePool (Partition->BlockSize);
+    if (Buffer == NULL) {
+      return EFI_OUT_OF_RESOURCES;
+    }
+
+    Status = Ext4ReadBlocks (Partition, Ext4DescriptorBlock (Partition, Index), 1, Buffer);
+    if (EFI_ERROR (Status)) {
+      FreePool (Buffer);
+      return Status;
+    }
+
+    FirstGroup = Index * Partition->DescPerBlock;
+    for (Entry = 0;
+         (Entry < Partition->DescPerBlock) && (FirstGroup + Entry < Partition->NumberGroups);
+         Entry++)
+    {
+      Desc  = (EXT4_BLOCK_GROUP_DESC *)(Buffer + Entry * Partition->DescSize);
+      Table = Desc->bg_inode_table_lo;
+      if (Partition->DescSize >= EXT4_64BIT_MIN_DESC_SIZE) {
+        Table |= LShiftU64 (Desc->bg_inode_table_hi, 32);
+      }
+
+      //
+      // Leave invalid descriptors out of the cache, so that they are
+      // reported whenever they are used.
+      //
+      if ((Table != 0) && (Table < Partition->NumberBlocks)) {
+        Partition->InodeTables[FirstGroup + Entry] = Table;
+      }
+    }
+
+    FreePool (Buffer);
+
+    if (Partition->InodeTables[Group] == 0) {
+      DEBUG ((DEBUG_ERROR, "%a: invalid descriptor for group %u\n", __FUNCTION__, Group));
+      return EFI_VOLUME_CORRUPTED;
+    }
+  }
+
+  *InodeTable = Partition->InodeTables[Group];
+  return EFI_SUCCESS;
+}
@@ -579,6 +579,8 @@ DumpSmiHandler(
   UINTN                              Index;
   SMM_CORE_IMAGE_DATABASE_STRUCTURE  *ImageStruct;
   CHAR8                              *NameString;
+  SMI_HANDLER_PROFILE_LATENCY        *Latency;
+  UINTN                              Bucket;
 
   SmiStruct = (VOID *)mSmiHandlerProfileDatabase;
   while ((UINTN)SmiStruct < (UINTN)mSmiHandlerProfileDatabase + mSmiHandlerProfileDatabaseSize) {
@@ -612,6 +614,21 @@ DumpSmiHandler(
           Print(L"         <RVA>0x%x</RVA>\n", (UINTN) (SmiHandlerStruct->CallerAddr - ImageStruct->ImageBase));
         }
         Print(L"      </Caller>\n", SmiHandlerStruct->Handler);
+        if ((SmiStruct->Header.Revision >= 0x0002) && (SmiHandlerStruct->LatencyOffset != 0)) {
+          Latency = (VOID *)((UINTN)SmiHandlerStruct + SmiHandlerStruct->LatencyOffset);
+          Print(L"      <Latency Count=\"%ld\" TotalTimeNs=\"%ld\" MaxTimeNs=\"%ld\">\n", Latency->Count, Latency->TotalTime, Latency->MaxTime);
+          for (Bucket = 0; Bucket < SMI_HANDLER_PROFILE_LATENCY_BUCKETS; Bucket++) {
+            if (Latency->Histogram[Bucket] == 0) {
+              continue;
+            }
+            if (Bucket == SMI_HANDLER_PROFILE_LATENCY_BUCKETS - 1) {
+              Print(L"         <Histogram MinTimeUs=\"%d\" Count=\"%d\"/>\n", (UINT32)1 << (Bucket - 1), Latency->Histogram[Bucket]);
+            } else {
+              Print(L"         <Histogram MaxTimeUs=\"%d\" Count=\"%d\"/>\n", (UINT32)1 << Bucket, Latency->Histogram[Bucket]);
+            }
+          }
+          Print(L"      </Latency>\n");
+        }
         SmiHandlerStruct = (VOID *)((UINTN)SmiHandlerStruct + SmiHandlerStruct->Length);
         Print(L"    </SmiHandler>\n");
       }
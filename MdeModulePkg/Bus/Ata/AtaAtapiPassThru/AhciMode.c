@@ -1127,6 +1127,21 @@ AhciDmaTransfer (
     return EFI_INVALID_PARAMETER;
   }
 
+  if ((Task != NULL) && (Task->QueueDepth != 0)) {
+    return AhciQueuedDmaTransfer (
+             Instance,
+             AhciRegisters,
+             Port,
+             Read,
+             AtaCommandBlock,
+             AtaStatusBlock,
+             MemoryAddr,
+             DataCount,
+             Timeout,
+             Task
+             );
+  }
+
   //
   // DMA buffer allocation. Needs to be done only once for both sync and async
   // DMA transfers irrespective of number of retries.
@@ -1484,28 +1499,25 @@ AhciStopCommand (
 }
 
 /**
-  Start command for give slot on specific port.
+  Start the command engine of giving port without issuing a command.
 
   @param  PciIo              The PCI IO protocol instance.
   @param  Port               The number of port.
-  @param  CommandSlot        The number of Command Slot.
   @param  Timeout            The timeout value of start, uses 100ns as a unit.
 
-  @retval EFI_DEVICE_ERROR   The command start unsuccessfully.
+  @retval EFI_DEVICE_ERROR   The command engine start unsuccessfully.
   @retval EFI_TIMEOUT        The operation is time out.
-  @retval EFI_SUCCESS        The command start successfully.
+  @retval EFI_SUCCESS        The command engine start successfully.
 
 **/
 EFI_STATUS
 EFIAPI
-AhciStartCommand (
+AhciStartCommandEngine (
   IN  EFI_PCI_IO_PROTOCOL       *PciIo,
   IN  UINT8                     Port,
-  IN  UINT8                     CommandSlot,
   IN  UINT64                    Timeout
   )
 {
-  UINT32     CmdSlotBit;
   EFI_STATUS Status;
   UINT32     PortStatus;
   UINT32     StartCmd;
@@ -1518,8 +1530,6 @@ AhciStartCommand (
   //
   Capability = AhciReadReg(PciIo, EFI_AHCI_CAPABILITY_OFFSET);
 
-  CmdSlotBit = (UINT32) (1 << CommandSlot);
-
   AhciClearPortStatus (
     PciIo,
     Port
@@ -1566,6 +1576,42 @@ AhciStartCommand (
   Offset = EFI_AHCI_PORT_START + Port * EFI_AHCI_PORT_REG_WIDTH + EFI_AHCI_PORT_CMD;
   AhciOrReg (PciIo, Offset, EFI_AHCI_PORT_CMD_ST | StartCmd);
 
+  return EFI_SUCCESS;
+}
+
+/**
+  Start command for give slot on specific port.
+
+  @param  PciIo              The PCI IO protocol instance.
+  @param  Port               The number of port.
+  @param  CommandSlot        The number of Command Slot.
+  @param  Timeout            The timeout value of start, uses 100ns as a unit.
+
+  @retval EFI_DEVICE_ERROR   The command start unsuccessfully.
+  @retval EFI_TIMEOUT        The operation is time out.
+  @retval EFI_SUCCESS        The command start successfully.
+
+**/
+EFI_STATUS
+EFIAPI
+AhciStartCommand (
+  IN  EFI_PCI_IO_PROTOCOL       *PciIo,
+  IN  UINT8                     Port,
+  IN  UINT8                     CommandSlot,
+  IN  UINT64                    Timeout
+  )
+{
+  UINT32     CmdSlotBit;
+  EFI_STATUS Status;
+  UINT32     Offset;
+
+  CmdSlotBit = (UINT32) (1 << CommandSlot);
+
+  Status = AhciStartCommandEngine (PciIo, Port, Timeout);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
   //
   // Setting the command
   //
@@ -2116,6 +2162,80 @@ AhciPacketCommandExecute (
   return Status;
 }
 
+/**
+  Allocate the per-slot command tables used by native command queuing.
+
+  NcqCommandSlots is left 0 if the HBA does not support native command queuing
+  or the tables can not be allocated.
+
+  @param  PciIo               The PCI IO protocol instance.
+  @param  AhciRegisters       The pointer to the EFI_AHCI_REGISTERS.
+  @param  Capability          The value of the HBA capabilities register.
+
+**/
+VOID
+AhciCreateQueuedCommandTables (
+  IN     EFI_PCI_IO_PROTOCOL    *PciIo,
+  IN OUT EFI_AHCI_REGISTERS     *AhciRegisters,
+  IN     UINT32                 Capability
+  )
+{
+  EFI_STATUS            Status;
+  UINTN                 Bytes;
+  VOID                  *Buffer;
+  UINT8                 MaxCommandSlotNumber;
+  UINT64                MaxNcqCommandTableSize;
+  EFI_PHYSICAL_ADDRESS  AhciNcqCommandTablePciAddr;
+
+  AhciRegisters->NcqCommandSlots = 0;
+  if ((Capability & EFI_AHCI_CAP_SNCQ) == 0) {
+    return;
+  }
+
+  MaxCommandSlotNumber   = (UINT8) (((Capability & 0x1F00) >> 8) + 1);
+  MaxNcqCommandTableSize = MaxCommandSlotNumber * sizeof (EFI_AHCI_NCQ_COMMAND_TABLE);
+
+  Buffer = NULL;
+  Status = PciIo->AllocateBuffer (
+                    PciIo,
+                    AllocateAnyPages,
+                    EfiBootServicesData,
+                    EFI_SIZE_TO_PAGES ((UINTN) MaxNcqCommandTableSize),
+                    &Buffer,
+                    0
+                    );
+  if (EFI_ERROR (Status)) {
+    return;
+  }
+
+  ZeroMem (Buffer, (UINTN) MaxNcqCommandTableSize);
+
+  Bytes  = (UINTN) MaxNcqCommandTableSize;
+  Status = PciIo->Map (
+                    PciIo,
+                    EfiPciIoOperationBusMasterCommonBuffer,
+                    Buffer,
+                    &Bytes,
+                    &AhciNcqCommandTablePciAddr,
+                    &AhciRegisters->MapNcqCommandTable
+                    );
+  if (EFI_ERROR (Status) || (Bytes != MaxNcqCommandTableSize)) {
+    PciIo->FreeBuffer (PciIo, EFI_SIZE_TO_PAGES ((UINTN) MaxNcqCommandTableSize), Buffer);
+    return;
+  }
+
+  if (((Capability & EFI_AHCI_CAP_S64A) == 0) && (AhciNcqCommandTablePciAddr > 0x100000000ULL)) {
+    PciIo->Unmap (PciIo, AhciRegisters->MapNcqCommandTable);
+    PciIo->FreeBuffer (PciIo, EFI_SIZE_TO_PAGES ((UINTN) MaxNcqCommandTableSize), Buffer);
+    return;
+  }
+
+  AhciRegisters->AhciNcqCommandTable        = Buffer;
+  AhciRegisters->AhciNcqCommandTablePciAddr = (EFI_AHCI_NCQ_COMMAND_TABLE *)(UINTN)AhciNcqCommandTablePciAddr;
+  AhciRegisters->MaxNcqCommandTableSize     = MaxNcqCommandTableSize;
+  AhciRegisters->NcqCommandSlots            = MaxCommandSlotNumber;
+}
+
 /**
   Allocate transfer-related data struct which is used at AHCI mode.
 
@@ -2323,6 +2443,12 @@ AhciCreateTransferDescriptor (
   }
   AhciRegisters->AhciCommandTablePciAddr = (EFI_AHCI_COMMAND_TABLE *)(UINTN)AhciCommandTablePciAddr;
 
+  //
+  // Native command queuing is optional, go on without it if its command tables
+  // can not be allocated.
+  //
+  AhciCreateQueuedCommandTables (PciIo, AhciRegisters, Capability);
+
   return EFI_SUCCESS;
   //
   // Map error or unable to map the whole CmdList buffer into a contiguous region.
@@ -2425,6 +2551,378 @@ AhciReadLogExt (
            );
 }
 
+/**
+  Build the command list entry and the per-slot command table of a queued command.
+
+  @param    AhciRegisters         The pointer to the EFI_AHCI_REGISTERS.
+  @param    CommandFis            The control fis will be used for the transfer.
+  @param    CommandList           The command list will be used for the transfer.
+  @param    CommandSlotNumber     The command slot will be used for the transfer.
+  @param    DataPhysicalAddr      The data buffer pci bus master address.
+  @param    DataLength            The data count to be transferred.
+
+**/
+VOID
+AhciBuildQueuedCommand (
+  IN     EFI_AHCI_REGISTERS         *AhciRegisters,
+  IN     EFI_AHCI_COMMAND_FIS       *CommandFis,
+  IN     EFI_AHCI_COMMAND_LIST      *CommandList,
+  IN     UINT8                      CommandSlotNumber,
+  IN     EFI_PHYSICAL_ADDRESS       DataPhysicalAddr,
+  IN     UINT32                     DataLength
+  )
+{
+  EFI_AHCI_NCQ_COMMAND_TABLE  *CommandTable;
+  UINT32                      PrdtNumber;
+  UINT32                      PrdtIndex;
+  UINTN                       RemainedData;
+  UINT64                      MemAddr;
+  DATA_64                     Data64;
+
+  PrdtNumber = (UINT32)DivU64x32 (((UINT64)DataLength + EFI_AHCI_MAX_DATA_PER_PRDT - 1), EFI_AHCI_MAX_DATA_PER_PRDT);
+  ASSERT (PrdtNumber <= EFI_AHCI_NCQ_MAX_PRDT_NUMBER);
+
+  CommandTable = &AhciRegisters->AhciNcqCommandTable[CommandSlotNumber];
+  ZeroMem (CommandTable, sizeof (EFI_AHCI_NCQ_COMMAND_TABLE));
+  CopyMem (&CommandTable->CommandFis, CommandFis, sizeof (EFI_AHCI_COMMAND_FIS));
+
+  RemainedData = (UINTN) DataLength;
+  MemAddr      = DataPhysicalAddr;
+  CommandList->AhciCmdPrdtl = PrdtNumber;
+
+  for (PrdtIndex = 0; PrdtIndex < PrdtNumber; PrdtIndex++) {
+    if (RemainedData < EFI_AHCI_MAX_DATA_PER_PRDT) {
+      CommandTable->PrdtTable[PrdtIndex].AhciPrdtDbc = (UINT32)RemainedData - 1;
+    } else {
+      CommandTable->PrdtTable[PrdtIndex].AhciPrdtDbc = EFI_AHCI_MAX_DATA_PER_PRDT - 1;
+    }
+
+    Data64.Uint64 = MemAddr;
+    CommandTable->PrdtTable[PrdtIndex].AhciPrdtDba  = Data64.Uint32.Lower32;
+    CommandTable->PrdtTable[PrdtIndex].AhciPrdtDbau = Data64.Uint32.Upper32;
+    RemainedData -= EFI_AHCI_MAX_DATA_PER_PRDT;
+    MemAddr      += EFI_AHCI_MAX_DATA_PER_PRDT;
+  }
+
+  if (PrdtNumber > 0) {
+    CommandTable->PrdtTable[PrdtNumber - 1].AhciPrdtIoc = 1;
+  }
+
+  CopyMem (&AhciRegisters->AhciCmdList[CommandSlotNumber], CommandList, sizeof (EFI_AHCI_COMMAND_LIST));
+
+  Data64.Uint64 = (UINT64)(UINTN) &AhciRegisters->AhciNcqCommandTablePciAddr[CommandSlotNumber];
+  AhciRegisters->AhciCmdList[CommandSlotNumber].AhciCmdCtba  = Data64.Uint32.Lower32;
+  AhciRegisters->AhciCmdList[CommandSlotNumber].AhciCmdCtbau = Data64.Uint32.Upper32;
+  AhciRegisters->AhciCmdList[CommandSlotNumber].AhciCmdPmp   = 0;
+}
+
+/**
+  Abort all the outstanding queued commands of a port.
+
+  Stopping the command engine clears PxSACT and PxCI. The device stays in the
+  error state until the NCQ command error log is read, so the log is read to
+  bring the device back before the next command.
+
+  @param  Instance            The ATA_ATAPI_PASS_THRU_INSTANCE protocol instance.
+  @param  Port                The number of port.
+
+**/
+VOID
+EFIAPI
+AhciAbortQueuedCommands (
+  IN ATA_ATAPI_PASS_THRU_INSTANCE  *Instance,
+  IN UINT8                         Port
+  )
+{
+  EFI_PCI_IO_PROTOCOL           *PciIo;
+  LIST_ENTRY                    *Entry;
+  ATA_NONBLOCK_TASK             *Task;
+  UINT8                         LogBuffer[512];
+  EFI_STATUS                    Status;
+
+  PciIo = Instance->PciIo;
+
+  AhciStopCommand (PciIo, Port, ATA_ATAPI_TIMEOUT);
+  AhciRecoverPortError (PciIo, Port);
+  AhciDisableFisReceive (PciIo, Port, ATA_ATAPI_TIMEOUT);
+
+  //
+  // Every started queued command has lost its slot, so release the slots and
+  // the data buffer mappings.
+  //
+  for (Entry = GetFirstNode (&Instance->NonBlockingTaskList);
+       !IsNull (&Instance->NonBlockingTaskList, Entry);
+       Entry = GetNextNode (&Instance->NonBlockingTaskList, Entry)) {
+    Task = ATA_NON_BLOCK_TASK_FROM_ENTRY (Entry);
+    if ((Task->QueueDepth != 0) && Task->IsStart) {
+      PciIo->Unmap (PciIo, Task->Map);
+      Task->Map     = NULL;
+      Task->IsStart = FALSE;
+    }
+  }
+  Instance->NcqSlotsInUse = 0;
+
+  Status = AhciReadLogExt (
+             PciIo,
+             &Instance->AhciRegisters,
+             Port,
+             0,
+             LogBuffer,
+             0x10,
+             0
+             );
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed to read the NCQ command error log of port %d: %r\n", Port, Status));
+  }
+}
+
+/**
+  Start or check a queued DMA data transfer on specific port.
+
+  The first call assigns a command slot and issues the command as READ FPDMA
+  QUEUED or WRITE FPDMA QUEUED. The following calls check whether the device has
+  completed the command. Completions may happen in any order.
+
+  @param[in]       Instance            The ATA_ATAPI_PASS_THRU_INSTANCE protocol instance.
+  @param[in]       AhciRegisters       The pointer to the EFI_AHCI_REGISTERS.
+  @param[in]       Port                The number of port.
+  @param[in]       Read                The transfer direction.
+  @param[in]       AtaCommandBlock     The EFI_ATA_COMMAND_BLOCK data.
+  @param[in, out]  AtaStatusBlock      The EFI_ATA_STATUS_BLOCK data.
+  @param[in, out]  MemoryAddr          The pointer to the data buffer.
+  @param[in]       DataCount           The data count to be transferred.
+  @param[in]       Timeout             The timeout value of start, uses 100ns as a unit.
+  @param[in]       Task                Pointer to the ATA_NONBLOCK_TASK of the command.
+
+  @retval EFI_NOT_READY       The command is not started yet or not completed.
+  @retval EFI_DEVICE_ERROR    The DMA data transfer abort with error occurs.
+  @retval EFI_TIMEOUT         The operation is time out.
+  @retval EFI_BAD_BUFFER_SIZE The data buffer could not be mapped.
+  @retval EFI_SUCCESS         The DMA data transfer executes successfully.
+
+**/
+EFI_STATUS
+EFIAPI
+AhciQueuedDmaTransfer (
+  IN     ATA_ATAPI_PASS_THRU_INSTANCE *Instance,
+  IN     EFI_AHCI_REGISTERS           *AhciRegisters,
+  IN     UINT8                        Port,
+  IN     BOOLEAN                      Read,
+  IN     EFI_ATA_COMMAND_BLOCK        *AtaCommandBlock,
+  IN OUT EFI_ATA_STATUS_BLOCK         *AtaStatusBlock,
+  IN OUT VOID                         *MemoryAddr,
+  IN     UINT32                       DataCount,
+  IN     UINT64                       Timeout,
+  IN     ATA_NONBLOCK_TASK            *Task
+  )
+{
+  EFI_STATUS                    Status;
+  EFI_PHYSICAL_ADDRESS          PhyAddr;
+  UINTN                         MapLength;
+  EFI_PCI_IO_PROTOCOL_OPERATION Flag;
+  EFI_AHCI_COMMAND_FIS          CFis;
+  EFI_AHCI_COMMAND_LIST         CmdList;
+  EFI_PCI_IO_PROTOCOL           *PciIo;
+  UINT8                         Slot;
+  UINT32                        SlotBit;
+  UINT32                        Offset;
+  UINT32                        PortInterrupt;
+  UINT32                        Outstanding;
+
+  PciIo = Instance->PciIo;
+
+  if (!Task->IsStart) {
+    //
+    // All the ports share one command list, so queued commands of another port
+    // have to complete first.
+    //
+    if ((Instance->NcqSlotsInUse != 0) && (Instance->NcqPort != Port)) {
+      return EFI_NOT_READY;
+    }
+
+    for (Slot = 0; Slot < Task->QueueDepth; Slot++) {
+      if ((Instance->NcqSlotsInUse & (1 << Slot)) == 0) {
+        break;
+      }
+    }
+    if (Slot == Task->QueueDepth) {
+      return EFI_NOT_READY;
+    }
+    SlotBit = (UINT32) (1 << Slot);
+
+    if (Read) {
+      Flag = EfiPciIoOperationBusMasterWrite;
+    } else {
+      Flag = EfiPciIoOperationBusMasterRead;
+    }
+
+    MapLength = DataCount;
+    Status = PciIo->Map (
+                      PciIo,
+                      Flag,
+                      MemoryAddr,
+                      &MapLength,
+                      &PhyAddr,
+                      &Task->Map
+                      );
+    if (EFI_ERROR (Status) || (DataCount != MapLength)) {
+      return EFI_BAD_BUFFER_SIZE;
+    }
+
+    //
+    // READ/WRITE FPDMA QUEUED carry the sector count in the features registers
+    // and the command tag in the sector count register.
+    //
+    AhciBuildCommandFis (&CFis, AtaCommandBlock);
+    CFis.AhciCFisCmd         = Read ? ATA_CMD_READ_FPDMA_QUEUED : ATA_CMD_WRITE_FPDMA_QUEUED;
+    CFis.AhciCFisFeature     = AtaCommandBlock->AtaSectorCount;
+    CFis.AhciCFisFeatureExp  = AtaCommandBlock->AtaSectorCountExp;
+    CFis.AhciCFisSecCount    = (UINT8) (Slot << 3);
+    CFis.AhciCFisSecCountExp = 0;
+    CFis.AhciCFisDevHead     = BIT6;
+
+    ZeroMem (&CmdList, sizeof (EFI_AHCI_COMMAND_LIST));
+    CmdList.AhciCmdCfl = EFI_AHCI_FIS_REGISTER_H2D_LENGTH / 4;
+    CmdList.AhciCmdW   = Read ? 0 : 1;
+
+    AhciBuildQueuedCommand (AhciRegisters, &CFis, &CmdList, Slot, PhyAddr, DataCount);
+
+    if (Instance->NcqSlotsInUse == 0) {
+      ZeroMem (&AhciRegisters->AhciRFis[Port], sizeof (EFI_AHCI_RECEIVED_FIS));
+      Offset = EFI_AHCI_PORT_START + Port * EFI_AHCI_PORT_REG_WIDTH + EFI_AHCI_PORT_CMD;
+      AhciAndReg (PciIo, Offset, (UINT32)~(EFI_AHCI_PORT_CMD_DLAE | EFI_AHCI_PORT_CMD_ATAPI));
+
+      Status = AhciStartCommandEngine (PciIo, Port, Timeout);
+      if (EFI_ERROR (Status)) {
+        PciIo->Unmap (PciIo, Task->Map);
+        Task->Map = NULL;
+        return Status;
+      }
+      Instance->NcqPort = Port;
+    }
+
+    DEBUG ((DEBUG_VERBOSE, "Starting queued DMA command on slot %d:\n", Slot));
+    AhciPrintCommandBlock (AtaCommandBlock, DEBUG_VERBOSE);
+
+    Instance->NcqSlotsInUse |= SlotBit;
+    Task->CommandSlot        = Slot;
+    Task->IsStart            = TRUE;
+
+    //
+    // PxSACT and PxCI are write-one-to-set, writing the slot bit alone leaves
+    // the other outstanding commands untouched.
+    //
+    Offset = EFI_AHCI_PORT_START + Port * EFI_AHCI_PORT_REG_WIDTH + EFI_AHCI_PORT_SACT;
+    AhciWriteReg (PciIo, Offset, SlotBit);
+    Offset = EFI_AHCI_PORT_START + Port * EFI_AHCI_PORT_REG_WIDTH + EFI_AHCI_PORT_CI;
+    AhciWriteReg (PciIo, Offset, SlotBit);
+
+    return EFI_NOT_READY;
+  }
+
+  Slot    = Task->CommandSlot;
+  SlotBit = (UINT32) (1 << Slot);
+
+  //
+  // The device clears the slot bit of PxSACT when it completes the command,
+  // which may happen before or after the commands queued ahead of it.
+  //
+  Offset      = EFI_AHCI_PORT_START + Port * EFI_AHCI_PORT_REG_WIDTH + EFI_AHCI_PORT_SACT;
+  Outstanding = AhciReadReg (PciIo, Offset);
+  Offset      = EFI_AHCI_PORT_START + Port * EFI_AHCI_PORT_REG_WIDTH + EFI_AHCI_PORT_CI;
+  Outstanding |= AhciReadReg (PciIo, Offset);
+
+  if ((Outstanding & SlotBit) == 0) {
+    PciIo->Unmap (PciIo, Task->Map);
+    Task->Map = NULL;
+
+    Instance->NcqSlotsInUse &= ~SlotBit;
+    if (Instance->NcqSlotsInUse == 0) {
+      AhciStopCommand (PciIo, Port, Timeout);
+      AhciDisableFisReceive (PciIo, Port, Timeout);
+    }
+
+    AhciDumpPortStatus (PciIo, AhciRegisters, Port, AtaStatusBlock);
+    AhciPrintStatusBlock (AtaStatusBlock, DEBUG_VERBOSE);
+    return EFI_SUCCESS;
+  }
+
+  Offset        = EFI_AHCI_PORT_START + Port * EFI_AHCI_PORT_REG_WIDTH + EFI_AHCI_PORT_IS;
+  PortInterrupt = AhciReadReg (PciIo, Offset);
+  if ((PortInterrupt & EFI_AHCI_PORT_IS_ERROR_MASK) != 0) {
+    Status = EFI_DEVICE_ERROR;
+  } else if (Task->InfiniteWait || (Task->RetryTimes != 0)) {
+    Task->RetryTimes--;
+    return EFI_NOT_READY;
+  } else {
+    Status = EFI_TIMEOUT;
+  }
+
+  DEBUG ((DEBUG_ERROR, "Queued DMA command on slot %d failed: %r\n", Slot, Status));
+  AhciPrintCommandBlock (AtaCommandBlock, DEBUG_ERROR);
+  AhciDumpPortStatus (PciIo, AhciRegisters, Port, AtaStatusBlock);
+  AhciPrintStatusBlock (AtaStatusBlock, DEBUG_ERROR);
+
+  AhciAbortQueuedCommands (Instance, Port);
+  return Status;
+}
+
+/**
+  Get the queue depth a non-blocking ATA command may be issued with.
+
+  A non-blocking READ DMA EXT or WRITE DMA EXT command to a hard disk that
+  supports native command queuing is issued as READ FPDMA QUEUED or WRITE FPDMA
+  QUEUED, so that several of them can be outstanding on the device at once.
+
+  @param[in]  Instance    The ATA_ATAPI_PASS_THRU_INSTANCE protocol instance.
+  @param[in]  DeviceInfo  The device the command is sent to.
+  @param[in]  Packet      The ATA command packet.
+
+  @return The number of command slots the command may use, or 0 if the command
+          can not be queued.
+
+**/
+UINT8
+EFIAPI
+AhciGetQueueDepth (
+  IN ATA_ATAPI_PASS_THRU_INSTANCE      *Instance,
+  IN EFI_ATA_DEVICE_INFO               *DeviceInfo,
+  IN EFI_ATA_PASS_THRU_COMMAND_PACKET  *Packet
+  )
+{
+  ATA_IDENTIFY_DATA  *IdentifyData;
+  UINT8              QueueDepth;
+
+  if ((Instance->Mode != EfiAtaAhciMode) || (Instance->AhciRegisters.NcqCommandSlots == 0)) {
+    return 0;
+  }
+
+  //
+  // Queuing commands behind a port multiplier needs FIS-based switching, which
+  // is not supported.
+  //
+  if ((DeviceInfo->Type != EfiIdeHarddisk) || (DeviceInfo->PortMultiplier != 0xFFFF) ||
+      (DeviceInfo->IdentifyData == NULL)) {
+    return 0;
+  }
+
+  if (!((Packet->Protocol == EFI_ATA_PASS_THRU_PROTOCOL_UDMA_DATA_IN) &&
+        (Packet->Acb->AtaCommand == ATA_CMD_READ_DMA_EXT)) &&
+      !((Packet->Protocol == EFI_ATA_PASS_THRU_PROTOCOL_UDMA_DATA_OUT) &&
+        (Packet->Acb->AtaCommand == ATA_CMD_WRITE_DMA_EXT))) {
+    return 0;
+  }
+
+  IdentifyData = &DeviceInfo->IdentifyData->AtaData;
+  if ((IdentifyData->serial_ata_capabilities == 0xFFFF) ||
+      ((IdentifyData->serial_ata_capabilities & BIT8) == 0)) {
+    return 0;
+  }
+
+  QueueDepth = (UINT8) ((IdentifyData->queue_depth & 0x1F) + 1);
+  return MIN (QueueDepth, Instance->AhciRegisters.NcqCommandSlots);
+}
+
 /**
   Enable DEVSLP of the disk if supported.
 
@@ -13,6 +13,7 @@
 #define EFI_AHCI_CAPABILITY_OFFSET             0x0000
 #define   EFI_AHCI_CAP_SAM                     BIT18
 #define   EFI_AHCI_CAP_SSS                     BIT27
+#define   EFI_AHCI_CAP_SNCQ                    BIT30
 #define   EFI_AHCI_CAP_S64A                    BIT31
 #define EFI_AHCI_GHC_OFFSET                    0x0004
 #define   EFI_AHCI_GHC_RESET                   BIT0
@@ -284,6 +285,20 @@ typedef struct {
   EFI_AHCI_COMMAND_PRDT     PrdtTable[65535];     // The scatter/gather list for data transfer
 } EFI_AHCI_COMMAND_TABLE;
 
+//
+// Command table used by a queued command. Each command slot in use by native
+// command queuing needs its own table, so the scatter/gather list is kept short.
+// 64 entries of 4MB cover the largest transfer of a 48-bit command.
+//
+#define EFI_AHCI_NCQ_MAX_PRDT_NUMBER           64
+
+typedef struct {
+  EFI_AHCI_COMMAND_FIS      CommandFis;       // A software constructed FIS.
+  EFI_AHCI_ATAPI_COMMAND    AtapiCmd;         // 12 or 16 bytes ATAPI cmd.
+  UINT8                     Reserved[0x30];
+  EFI_AHCI_COMMAND_PRDT     PrdtTable[EFI_AHCI_NCQ_MAX_PRDT_NUMBER];
+} EFI_AHCI_NCQ_COMMAND_TABLE;
+
 //
 // Received FIS structure
 //
@@ -323,6 +338,15 @@ typedef struct {
   VOID                      *MapRFis;
   VOID                      *MapCmdList;
   VOID                      *MapCommandTable;
+  //
+  // Per-slot command tables for native command queuing. NcqCommandSlots is 0
+  // if the HBA does not support it or the tables could not be allocated.
+  //
+  EFI_AHCI_NCQ_COMMAND_TABLE  *AhciNcqCommandTable;
+  EFI_AHCI_NCQ_COMMAND_TABLE  *AhciNcqCommandTablePciAddr;
+  UINT64                      MaxNcqCommandTableSize;
+  VOID                        *MapNcqCommandTable;
+  UINT8                       NcqCommandSlots;
 } EFI_AHCI_REGISTERS;
 
 /**
@@ -372,6 +396,26 @@ AhciStartCommand (
   IN  UINT64                    Timeout
   );
 
+/**
+  Start the command engine of giving port without issuing a command.
+
+  @param  PciIo              The PCI IO protocol instance.
+  @param  Port               The number of port.
+  @param  Timeout            The timeout value of start, uses 100ns as a unit.
+
+  @retval EFI_DEVICE_ERROR   The command engine start unsuccessfully.
+  @retval EFI_TIMEOUT        The operation is time out.
+  @retval EFI_SUCCESS        The command engine start successfully.
+
+**/
+EFI_STATUS
+EFIAPI
+AhciStartCommandEngine (
+  IN  EFI_PCI_IO_PROTOCOL       *PciIo,
+  IN  UINT8                     Port,
+  IN  UINT64                    Timeout
+  );
+
 /**
   Stop command running for giving port
 
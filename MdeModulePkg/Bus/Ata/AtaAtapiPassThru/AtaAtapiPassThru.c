@@ -276,6 +276,9 @@ AtaPassThruPassThruExecute (
       }
       break;
     case EfiAtaAhciMode :
+      if (Task == NULL) {
+        AhciWaitQueuedCommands (Instance);
+      }
       if (PortMultiplierPort == 0xFFFF) {
         //
         // If there is no port multiplier, PortMultiplierPort will be 0xFFFF
@@ -406,13 +409,20 @@ AsyncNonBlockingTransferRoutine (
   //
   // Get the Tasks from the Tasks List and execute it, until there is
   // no task in the list or the device is busy with task (EFI_NOT_READY).
+  // Queued commands may complete in any order, so the tasks following a
+  // queued command are executed as well.
   //
-  while (TRUE) {
-    if (!IsListEmpty (EntryHeader)) {
-      Entry = GetFirstNode (EntryHeader);
-      Task  = ATA_NON_BLOCK_TASK_FROM_ENTRY (Entry);
-    } else {
-      return;
+  Entry = GetFirstNode (EntryHeader);
+  while (!IsNull (EntryHeader, Entry)) {
+    Task  = ATA_NON_BLOCK_TASK_FROM_ENTRY (Entry);
+    Entry = GetNextNode (EntryHeader, Entry);
+
+    //
+    // A command that is not queued can not start before all the queued
+    // commands have completed.
+    //
+    if ((Task->QueueDepth == 0) && (Instance->NcqSlotsInUse != 0)) {
+      break;
     }
 
     Status = AtaPassThruPassThruExecute (
@@ -437,6 +447,9 @@ AsyncNonBlockingTransferRoutine (
     // is not finished yet. Otherwise the operation is successful.
     //
     if (Status == EFI_NOT_READY) {
+      if (Task->QueueDepth != 0) {
+        continue;
+      }
       break;
     } else {
       RemoveEntryList (&Task->Link);
@@ -446,6 +459,41 @@ AsyncNonBlockingTransferRoutine (
   }
 }
 
+/**
+  Complete all the outstanding queued commands.
+
+  A command that is not queued can not be issued while queued commands are
+  still outstanding on the shared AHCI command list.
+
+  @param[in]  Instance  A pointer to the ATA_ATAPI_PASS_THRU_INSTANCE instance.
+
+**/
+VOID
+EFIAPI
+AhciWaitQueuedCommands (
+  IN ATA_ATAPI_PASS_THRU_INSTANCE      *Instance
+  )
+{
+  EFI_TPL  OldTpl;
+
+  if (Instance->NcqSlotsInUse == 0) {
+    return;
+  }
+
+  //
+  // Delay 100us to simulate the blocking time out checking.
+  //
+  OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+  while (Instance->NcqSlotsInUse != 0) {
+    AsyncNonBlockingTransferRoutine (NULL, Instance);
+    //
+    // Stall for 100us.
+    //
+    MicroSecondDelay (100);
+  }
+  gBS->RestoreTPL (OldTpl);
+}
+
 /**
   The Entry Point of module.
 
@@ -917,6 +965,9 @@ AtaAtapiPassThruStop (
     gBS->CloseEvent (Instance->TimerEvent);
     Instance->TimerEvent = NULL;
   }
+  if ((Instance->Mode == EfiAtaAhciMode) && (Instance->NcqSlotsInUse != 0)) {
+    AhciAbortQueuedCommands (Instance, Instance->NcqPort);
+  }
   DestroyAsynTaskList (Instance, FALSE);
   //
   // Free allocated resource
@@ -941,6 +992,17 @@ AtaAtapiPassThruStop (
   //
   if (Instance->Mode == EfiAtaAhciMode) {
     AhciRegisters = &Instance->AhciRegisters;
+    if (AhciRegisters->AhciNcqCommandTable != NULL) {
+      PciIo->Unmap (
+               PciIo,
+               AhciRegisters->MapNcqCommandTable
+               );
+      PciIo->FreeBuffer (
+               PciIo,
+               EFI_SIZE_TO_PAGES ((UINTN) AhciRegisters->MaxNcqCommandTableSize),
+               AhciRegisters->AhciNcqCommandTable
+               );
+    }
     PciIo->Unmap (
              PciIo,
              AhciRegisters->MapCommandTable
@@ -1372,6 +1434,7 @@ AtaPassThruPassThru (
     Task->Packet         = Packet;
     Task->Event          = Event;
     Task->IsStart        = FALSE;
+    Task->QueueDepth     = AhciGetQueueDepth (Instance, DeviceInfo, Packet);
     Task->RetryTimes     = DivU64x32(Packet->Timeout, 1000) + 1;
     if (Packet->Timeout == 0) {
       Task->InfiniteWait = TRUE;
@@ -2088,6 +2151,7 @@ ExtScsiPassThruPassThru (
         //
         PortMultiplier = 0;
       }
+      AhciWaitQueuedCommands (Instance);
       Status = AhciPacketCommandExecute (Instance->PciIo, &Instance->AhciRegisters, Port, PortMultiplier, Packet);
       break;
     default :
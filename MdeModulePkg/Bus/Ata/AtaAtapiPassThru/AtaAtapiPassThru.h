@@ -118,6 +118,12 @@ typedef struct {
   //
   EFI_EVENT                         TimerEvent;
   LIST_ENTRY                        NonBlockingTaskList;
+  //
+  // Native command queuing state in AHCI mode. Only one port at a time may have
+  // queued commands outstanding, as all the ports share a single command list.
+  //
+  UINT32                            NcqSlotsInUse;
+  UINT8                             NcqPort;
 } ATA_ATAPI_PASS_THRU_INSTANCE;
 
 //
@@ -138,6 +144,8 @@ struct _ATA_NONBLOCK_TASK {
   VOID                              *TableMap;       // Pointer to PRD table map.
   EFI_ATA_DMA_PRD                   *MapBaseAddress; //  Pointer to range Base address for Map.
   UINTN                             PageCount;       //  The page numbers used by PCIO freebuffer.
+  UINT8                             QueueDepth;      //  Non-zero if the task is issued as a queued command.
+  UINT8                             CommandSlot;     //  The command slot used by a started queued command.
 };
 
 //
@@ -535,6 +543,21 @@ AsyncNonBlockingTransferRoutine (
   VOID*      Context
   );
 
+/**
+  Complete all the outstanding queued commands.
+
+  A command that is not queued can not be issued while queued commands are
+  still outstanding on the shared AHCI command list.
+
+  @param[in]  Instance  A pointer to the ATA_ATAPI_PASS_THRU_INSTANCE instance.
+
+**/
+VOID
+EFIAPI
+AhciWaitQueuedCommands (
+  IN ATA_ATAPI_PASS_THRU_INSTANCE      *Instance
+  );
+
 /**
   Sends an ATA command to an ATA device that is attached to the ATA controller. This function
   supports both blocking I/O and non-blocking I/O. The blocking I/O functionality is required,
@@ -1149,6 +1172,87 @@ AhciDmaTransfer (
   IN     ATA_NONBLOCK_TASK            *Task
   );
 
+/**
+  Start or check a queued DMA data transfer on specific port.
+
+  The first call assigns a command slot and issues the command as READ FPDMA
+  QUEUED or WRITE FPDMA QUEUED. The following calls check whether the device has
+  completed the command. Completions may happen in any order.
+
+  @param[in]       Instance            The ATA_ATAPI_PASS_THRU_INSTANCE protocol instance.
+  @param[in]       AhciRegisters       The pointer to the EFI_AHCI_REGISTERS.
+  @param[in]       Port                The number of port.
+  @param[in]       Read                The transfer direction.
+  @param[in]       AtaCommandBlock     The EFI_ATA_COMMAND_BLOCK data.
+  @param[in, out]  AtaStatusBlock      The EFI_ATA_STATUS_BLOCK data.
+  @param[in, out]  MemoryAddr          The pointer to the data buffer.
+  @param[in]       DataCount           The data count to be transferred.
+  @param[in]       Timeout             The timeout value of start, uses 100ns as a unit.
+  @param[in]       Task                Pointer to the ATA_NONBLOCK_TASK of the command.
+
+  @retval EFI_NOT_READY       The command is not started yet or not completed.
+  @retval EFI_DEVICE_ERROR    The DMA data transfer abort with error occurs.
+  @retval EFI_TIMEOUT         The operation is time out.
+  @retval EFI_BAD_BUFFER_SIZE The data buffer could not be mapped.
+  @retval EFI_SUCCESS         The DMA data transfer executes successfully.
+
+**/
+EFI_STATUS
+EFIAPI
+AhciQueuedDmaTransfer (
+  IN     ATA_ATAPI_PASS_THRU_INSTANCE *Instance,
+  IN     EFI_AHCI_REGISTERS           *AhciRegisters,
+  IN     UINT8                        Port,
+  IN     BOOLEAN                      Read,
+  IN     EFI_ATA_COMMAND_BLOCK        *AtaCommandBlock,
+  IN OUT EFI_ATA_STATUS_BLOCK         *AtaStatusBlock,
+  IN OUT VOID                         *MemoryAddr,
+  IN     UINT32                       DataCount,
+  IN     UINT64                       Timeout,
+  IN     ATA_NONBLOCK_TASK            *Task
+  );
+
+/**
+  Abort all the outstanding queued commands of a port.
+
+  Stopping the command engine clears PxSACT and PxCI. The device stays in the
+  error state until the NCQ command error log is read, so the log is read to
+  bring the device back before the next command.
+
+  @param  Instance            The ATA_ATAPI_PASS_THRU_INSTANCE protocol instance.
+  @param  Port                The number of port.
+
+**/
+VOID
+EFIAPI
+AhciAbortQueuedCommands (
+  IN ATA_ATAPI_PASS_THRU_INSTANCE  *Instance,
+  IN UINT8                         Port
+  );
+
+/**
+  Get the queue depth a non-blocking ATA command may be issued with.
+
+  A non-blocking READ DMA EXT or WRITE DMA EXT command to a hard disk that
+  supports native command queuing is issued as READ FPDMA QUEUED or WRITE FPDMA
+  QUEUED, so that several of them can be outstanding on the device at once.
+
+  @param[in]  Instance    The ATA_ATAPI_PASS_THRU_INSTANCE protocol instance.
+  @param[in]  DeviceInfo  The device the command is sent to.
+  @param[in]  Packet      The ATA command packet.
+
+  @return The number of command slots the command may use, or 0 if the command
+          can not be queued.
+
+**/
+UINT8
+EFIAPI
+AhciGetQueueDepth (
+  IN ATA_ATAPI_PASS_THRU_INSTANCE      *Instance,
+  IN EFI_ATA_DEVICE_INFO               *DeviceInfo,
+  IN EFI_ATA_PASS_THRU_COMMAND_PACKET  *Packet
+  );
+
 /**
   Start a PIO data transfer on specific port.
 
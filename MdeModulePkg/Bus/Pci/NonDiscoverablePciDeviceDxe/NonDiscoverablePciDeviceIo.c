@@ -20,6 +20,7 @@ typedef struct {
   VOID                            *HostAddress;
   EFI_PCI_IO_PROTOCOL_OPERATION   Operation;
   UINTN                           NumberOfBytes;
+  BOOLEAN                         Uncached;
 } NON_DISCOVERABLE_PCI_DEVICE_MAP_INFO;
 
 /**
@@ -1165,6 +1166,7 @@ NonCoherentPciIoMap (
   MapInfo->HostAddress = HostAddress;
   MapInfo->Operation = Operation;
   MapInfo->NumberOfBytes = *NumberOfBytes;
+  MapInfo->Uncached = FALSE;
 
   Dev = NON_DISCOVERABLE_PCI_DEVICE_FROM_PCI_IO(This);
 
@@ -1199,6 +1201,8 @@ NonCoherentPciIoMap (
       if (EFI_ERROR (Status) ||
           (GcdDescriptor.Attributes & (EFI_MEMORY_WB|EFI_MEMORY_WT)) != 0) {
         Bounce = TRUE;
+      } else {
+        MapInfo->Uncached = TRUE;
       }
       break;
 
@@ -1237,9 +1241,13 @@ NonCoherentPciIoMap (
     // - for bus master write, we don't want any stale dirty cachelines that
     //   may be written back unexpectedly, and clobber the data written to
     //   main memory by the device.
+    // If the host address refers to an uncached mapping, there is nothing in
+    // the caches for this range, and walking it line by line is wasted time.
     //
-    mCpu->FlushDataCache (mCpu, (EFI_PHYSICAL_ADDRESS)(UINTN)HostAddress,
-            *NumberOfBytes, EfiCpuFlushTypeWriteBack);
+    if (!MapInfo->Uncached) {
+      mCpu->FlushDataCache (mCpu, (EFI_PHYSICAL_ADDRESS)(UINTN)HostAddress,
+              *NumberOfBytes, EfiCpuFlushTypeWriteBack);
+    }
   }
 
   *Mapping = MapInfo;
@@ -1291,9 +1299,10 @@ NonCoherentPciIoUnmap (
     //
     // We are *not* using a bounce buffer: if this is a bus master write,
     // we have to invalidate the caches so the CPU will see the uncached
-    // data written by the device.
+    // data written by the device, unless the mapping is uncached.
     //
-    if (MapInfo->Operation == EfiPciIoOperationBusMasterWrite) {
+    if (MapInfo->Operation == EfiPciIoOperationBusMasterWrite &&
+        !MapInfo->Uncached) {
       mCpu->FlushDataCache (mCpu,
               (EFI_PHYSICAL_ADDRESS)(UINTN)MapInfo->HostAddress,
               MapInfo->NumberOfBytes, EfiCpuFlushTypeInvalidate);
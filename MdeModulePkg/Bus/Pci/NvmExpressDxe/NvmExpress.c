@@ -336,31 +336,16 @@ DiscoverAllNamespaces (
   IN NVME_CONTROLLER_PRIVATE_DATA       *Private
   )
 {
-  EFI_STATUS                            Status;
   UINT32                                NamespaceId;
-  EFI_NVM_EXPRESS_PASS_THRU_PROTOCOL    *Passthru;
-
-  NamespaceId   = 0xFFFFFFFF;
-  Passthru      = &Private->Passthru;
-
-  while (TRUE) {
-    Status = Passthru->GetNextNamespace (
-                         Passthru,
-                         (UINT32 *)&NamespaceId
-                         );
 
-    if (EFI_ERROR (Status)) {
-      break;
-    }
-
-    Status = EnumerateNvmeDevNamespace (
-               Private,
-               NamespaceId
-               );
-
-    if (EFI_ERROR(Status)) {
-      continue;
-    }
+  //
+  // Walk the namespace IDs directly rather than through GetNextNamespace():
+  // the latter issues its own Identify Namespace command for every ID, which
+  // EnumerateNvmeDevNamespace() would then repeat. Namespaces that fail to
+  // enumerate are skipped.
+  //
+  for (NamespaceId = 1; NamespaceId <= Private->ControllerData->Nn; NamespaceId++) {
+    EnumerateNvmeDevNamespace (Private, NamespaceId);
   }
 
   return EFI_SUCCESS;
@@ -648,15 +633,13 @@ ProcessAsyncTaskList (
         if (AsyncRequest->MapMeta != NULL) {
           PciIo->Unmap (PciIo, AsyncRequest->MapMeta);
         }
-        if (AsyncRequest->MapPrpList != NULL) {
-          PciIo->Unmap (PciIo, AsyncRequest->MapPrpList);
-        }
         if (AsyncRequest->PrpListHost != NULL) {
-          PciIo->FreeBuffer (
-                   PciIo,
-                   AsyncRequest->PrpListNo,
-                   AsyncRequest->PrpListHost
-                   );
+          NvmeFreePrpList (
+            Private,
+            AsyncRequest->PrpListHost,
+            AsyncRequest->PrpListNo,
+            AsyncRequest->MapPrpList
+            );
         }
 
         RemoveEntryList (Link);
@@ -958,13 +941,15 @@ NvmExpressDriverBindingStart (
     // 5th 4kB boundary is the start of I/O submission queue #2.
     // 6th 4kB boundary is the start of I/O completion queue #2.
     //
-    // Allocate 6 pages of memory, then map it for bus master read and write.
+    // They are followed by the PRP list pool.
+    //
+    // Allocate the pages, then map them for bus master read and write.
     //
     Status = PciIo->AllocateBuffer (
                       PciIo,
                       AllocateAnyPages,
                       EfiBootServicesData,
-                      6,
+                      NVME_BUFFER_PAGES,
                       (VOID**)&Private->Buffer,
                       0
                       );
@@ -972,7 +957,7 @@ NvmExpressDriverBindingStart (
       goto Exit;
     }
 
-    Bytes = EFI_PAGES_TO_SIZE (6);
+    Bytes = EFI_PAGES_TO_SIZE (NVME_BUFFER_PAGES);
     Status = PciIo->Map (
                       PciIo,
                       EfiPciIoOperationBusMasterCommonBuffer,
@@ -982,7 +967,7 @@ NvmExpressDriverBindingStart (
                       &Private->Mapping
                       );
 
-    if (EFI_ERROR (Status) || (Bytes != EFI_PAGES_TO_SIZE (6))) {
+    if (EFI_ERROR (Status) || (Bytes != EFI_PAGES_TO_SIZE (NVME_BUFFER_PAGES))) {
       goto Exit;
     }
 
@@ -1008,6 +993,16 @@ NvmExpressDriverBindingStart (
       goto Exit;
     }
 
+    //
+    // One entry of the asynchronous I/O submission queue is always kept free
+    // to tell a full queue from an empty one.
+    //
+    Private->BlockingQueueDepth = MIN (
+                                    PcdGet32 (PcdNvmeBlockingQueueDepth),
+                                    (UINT32) MIN (NVME_ASYNC_CSQ_SIZE, Private->Cap.Mqes)
+                                    );
+    DEBUG ((EFI_D_INFO, "NvmExpressDriverBindingStart: blocking I/O queue depth %d\n", Private->BlockingQueueDepth));
+
     //
     // Start the asynchronous I/O completion monitor
     //
@@ -1093,7 +1088,7 @@ Exit:
   }
 
   if ((Private != NULL) && (Private->Buffer != NULL)) {
-    PciIo->FreeBuffer (PciIo, 6, Private->Buffer);
+    PciIo->FreeBuffer (PciIo, NVME_BUFFER_PAGES, Private->Buffer);
   }
 
   if ((Private != NULL) && (Private->ControllerData != NULL)) {
@@ -1216,7 +1211,7 @@ NvmExpressDriverBindingStop (
       }
 
       if (Private->Buffer != NULL) {
-        Private->PciIo->FreeBuffer (Private->PciIo, 6, Private->Buffer);
+        Private->PciIo->FreeBuffer (Private->PciIo, NVME_BUFFER_PAGES, Private->Buffer);
       }
 
       FreePool (Private->ControllerData);
@@ -40,6 +40,7 @@
 #include <Library/UefiBootServicesTableLib.h>
 #include <Library/UefiDriverEntryPoint.h>
 #include <Library/ReportStatusCodeLib.h>
+#include <Library/PcdLib.h>
 
 typedef struct _NVME_CONTROLLER_PRIVATE_DATA NVME_CONTROLLER_PRIVATE_DATA;
 typedef struct _NVME_DEVICE_PRIVATE_DATA     NVME_DEVICE_PRIVATE_DATA;
@@ -75,6 +76,15 @@ extern EFI_DRIVER_SUPPORTED_EFI_VERSION_PROTOCOL  gNvmExpressDriverSupportedEfiV
 
 #define NVME_MAX_QUEUES                           3     // Number of queues supported by the driver
 
+//
+// The controller's common buffer holds the six queue pages followed by a pool
+// of pages handed out as PRP lists, so that most commands need no PRP list
+// allocation and mapping of their own. The pool is tracked in a UINT64 bitmap.
+//
+#define NVME_QUEUE_BUFFER_PAGES                   6
+#define NVME_PRP_LIST_POOL_PAGES                  64
+#define NVME_BUFFER_PAGES                         (NVME_QUEUE_BUFFER_PAGES + NVME_PRP_LIST_POOL_PAGES)
+
 #define NVME_CONTROLLER_ID                        0
 
 //
@@ -123,10 +133,16 @@ struct _NVME_CONTROLLER_PRIVATE_DATA {
   // 4th 4kB boundary is the start of I/O completion queue #1.
   // 5th 4kB boundary is the start of I/O submission queue #2.
   // 6th 4kB boundary is the start of I/O completion queue #2.
+  // The remaining NVME_PRP_LIST_POOL_PAGES pages are the PRP list pool.
   //
   UINT8                               *Buffer;
   UINT8                               *BufferPciAddr;
 
+  //
+  // Set bits are PRP list pool pages in use.
+  //
+  UINT64                              PrpListPoolBitmap;
+
   //
   // Pointers to 4kB aligned submission & completion queues.
   //
@@ -155,6 +171,13 @@ struct _NVME_CONTROLLER_PRIVATE_DATA {
   //
   NVME_CAP                            Cap;
 
+  //
+  // Maximum number of commands a blocking read/write keeps outstanding on
+  // the asynchronous I/O queue, derived from PcdNvmeBlockingQueueDepth and
+  // the controller capabilities.
+  //
+  UINT32                              BlockingQueueDepth;
+
   VOID                                *Mapping;
 
   //
@@ -722,6 +745,54 @@ NvmeDumpStatus (
   IN NVME_CQ             *Cq
   );
 
+/**
+  Call back function when the timer event is signaled.
+
+  @param[in]  Event     The Event this notify function registered to.
+  @param[in]  Context   Pointer to the context data registered to the
+                        Event.
+
+**/
+VOID
+EFIAPI
+ProcessAsyncTaskList (
+  IN EFI_EVENT                    Event,
+  IN VOID*                        Context
+  );
+
+/**
+  Release the PRP lists created by NvmeCreatePrpList().
+
+  @param[in] Private        The pointer to the NVME_CONTROLLER_PRIVATE_DATA
+                            data structure.
+  @param[in] PrpListHost    The host base address of the PRP lists.
+  @param[in] PrpListNo      The number of PRP lists.
+  @param[in] Mapping        The mapping value returned by NvmeCreatePrpList().
+
+**/
+VOID
+NvmeFreePrpList (
+  IN NVME_CONTROLLER_PRIVATE_DATA    *Private,
+  IN VOID                            *PrpListHost,
+  IN UINTN                           PrpListNo,
+  IN VOID                            *Mapping
+  );
+
+/**
+  Aborts the asynchronous PassThru requests.
+
+  @param[in] Private        The pointer to the NVME_CONTROLLER_PRIVATE_DATA
+                            data structure.
+
+  @retval EFI_SUCCESS       The asynchronous PassThru requests have been aborted.
+  @return EFI_DEVICE_ERROR  Fail to abort all the asynchronous PassThru requests.
+
+**/
+EFI_STATUS
+AbortAsyncPassThruTasks (
+  IN NVME_CONTROLLER_PRIVATE_DATA    *Private
+  );
+
 /**
   Register the shutdown notification through the ResetNotification protocol.
 
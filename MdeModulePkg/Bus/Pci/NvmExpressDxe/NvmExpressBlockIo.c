@@ -141,6 +141,202 @@ WriteSectors (
   return Status;
 }
 
+//
+// Per command state of a blocking read or write which keeps several commands
+// outstanding on the asynchronous I/O queue.
+//
+typedef struct {
+  EFI_NVM_EXPRESS_PASS_THRU_COMMAND_PACKET CommandPacket;
+  EFI_NVM_EXPRESS_COMMAND                  Command;
+  EFI_NVM_EXPRESS_COMPLETION               Completion;
+  EFI_EVENT                                Event;
+  BOOLEAN                                  Busy;
+} NVME_QUEUED_COMMAND;
+
+/**
+  Read or write some blocks by keeping up to Private->BlockingQueueDepth
+  commands of at most MaxTransferBlocks blocks outstanding on the asynchronous
+  I/O queue, and wait for all of them to complete.
+
+  The completions are reaped by calling ProcessAsyncTaskList() directly, so
+  they do not depend on the periodic timer and the current TPL.
+
+  @param  Device                 The pointer to the NVME_DEVICE_PRIVATE_DATA data structure.
+  @param  IsRead                 Indicates it is a read or write operation.
+  @param  Buffer                 The data buffer.
+  @param  Lba                    The start block number.
+  @param  Blocks                 Total block number to be transferred.
+  @param  MaxTransferBlocks      Maximum block number of one command.
+
+  @retval EFI_SUCCESS            Datum are transferred.
+  @retval EFI_OUT_OF_RESOURCES   No enough resource to track the commands.
+  @retval Others                 Fail to transfer all the datum.
+
+**/
+EFI_STATUS
+NvmeQueuedReadWrite (
+  IN NVME_DEVICE_PRIVATE_DATA           *Device,
+  IN BOOLEAN                            IsRead,
+  IN VOID                               *Buffer,
+  IN UINT64                             Lba,
+  IN UINTN                              Blocks,
+  IN UINT32                             MaxTransferBlocks
+  )
+{
+  NVME_CONTROLLER_PRIVATE_DATA     *Private;
+  NVME_QUEUED_COMMAND              *Queue;
+  NVME_QUEUED_COMMAND              *Cmd;
+  NVME_CQ                          *Completion;
+  EFI_EVENT                        TimerEvent;
+  EFI_STATUS                       Status;
+  EFI_STATUS                       CommandStatus;
+  EFI_TPL                          OldTpl;
+  UINT32                           BlockSize;
+  UINT32                           Depth;
+  UINT32                           Index;
+  UINT32                           Outstanding;
+  UINT32                           Count;
+
+  Private    = Device->Controller;
+  BlockSize  = Device->Media.BlockSize;
+  Depth      = Private->BlockingQueueDepth;
+  TimerEvent = NULL;
+
+  Queue = AllocateZeroPool (Depth * sizeof (NVME_QUEUED_COMMAND));
+  if (Queue == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Status = gBS->CreateEvent (EVT_TIMER, TPL_CALLBACK, NULL, NULL, &TimerEvent);
+  for (Index = 0; (Index < Depth) && !EFI_ERROR (Status); Index++) {
+    Status = gBS->CreateEvent (0, TPL_CALLBACK, NULL, NULL, &Queue[Index].Event);
+  }
+  if (EFI_ERROR (Status)) {
+    goto EXIT;
+  }
+
+  Status      = EFI_SUCCESS;
+  Outstanding = 0;
+  gBS->SetTimer (TimerEvent, TimerRelative, NVME_GENERIC_TIMEOUT);
+
+  while ((Outstanding > 0) || ((Blocks > 0) && !EFI_ERROR (Status))) {
+    OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+
+    //
+    // Fill the free slots, then reap whatever the controller has completed.
+    //
+    for (Index = 0; (Index < Depth) && (Blocks > 0) && !EFI_ERROR (Status); Index++) {
+      Cmd = &Queue[Index];
+      if (Cmd->Busy) {
+        continue;
+      }
+
+      Count = (UINT32) MIN (Blocks, MaxTransferBlocks);
+
+      ZeroMem (&Cmd->CommandPacket, sizeof (EFI_NVM_EXPRESS_PASS_THRU_COMMAND_PACKET));
+      ZeroMem (&Cmd->Command, sizeof (EFI_NVM_EXPRESS_COMMAND));
+      ZeroMem (&Cmd->Completion, sizeof (EFI_NVM_EXPRESS_COMPLETION));
+
+      Cmd->CommandPacket.NvmeCmd        = &Cmd->Command;
+      Cmd->CommandPacket.NvmeCompletion = &Cmd->Completion;
+      Cmd->CommandPacket.TransferBuffer = Buffer;
+      Cmd->CommandPacket.TransferLength = Count * BlockSize;
+      Cmd->CommandPacket.CommandTimeout = NVME_GENERIC_TIMEOUT;
+      Cmd->CommandPacket.QueueType      = NVME_IO_QUEUE;
+
+      Cmd->Command.Cdw0.Opcode = IsRead ? NVME_IO_READ_OPC : NVME_IO_WRITE_OPC;
+      Cmd->Command.Nsid        = Device->NamespaceId;
+      Cmd->Command.Cdw10       = (UINT32)Lba;
+      Cmd->Command.Cdw11       = (UINT32)RShiftU64 (Lba, 32);
+      Cmd->Command.Cdw12       = (Count - 1) & 0xFFFF;
+      if (!IsRead) {
+        //
+        // Set Force Unit Access bit (bit 30) to use write-through behaviour
+        //
+        Cmd->Command.Cdw12    |= BIT30;
+      }
+      Cmd->Command.Flags       = CDW10_VALID | CDW11_VALID | CDW12_VALID;
+
+      CommandStatus = Private->Passthru.PassThru (
+                                         &Private->Passthru,
+                                         Device->NamespaceId,
+                                         &Cmd->CommandPacket,
+                                         Cmd->Event
+                                         );
+      if (CommandStatus == EFI_NOT_READY) {
+        //
+        // The submission queue is shared with BlockIo2 requests; retry once
+        // some entries have completed.
+        //
+        break;
+      } else if (EFI_ERROR (CommandStatus)) {
+        Status = CommandStatus;
+        break;
+      }
+
+      Cmd->Busy = TRUE;
+      Outstanding++;
+      Blocks -= Count;
+      Lba    += Count;
+      Buffer  = (VOID *)((UINT8 *)Buffer + Count * BlockSize);
+    }
+
+    ProcessAsyncTaskList (Private->TimerEvent, Private);
+
+    gBS->RestoreTPL (OldTpl);
+
+    for (Index = 0; Index < Depth; Index++) {
+      Cmd = &Queue[Index];
+      if (!Cmd->Busy || EFI_ERROR (gBS->CheckEvent (Cmd->Event))) {
+        continue;
+      }
+
+      Cmd->Busy = FALSE;
+      Outstanding--;
+      gBS->SetTimer (TimerEvent, TimerRelative, NVME_GENERIC_TIMEOUT);
+
+      Completion = (NVME_CQ *) &Cmd->Completion;
+      if (((Completion->Sct != 0) || (Completion->Sc != 0)) && !EFI_ERROR (Status)) {
+        Status = EFI_DEVICE_ERROR;
+        DEBUG_CODE_BEGIN();
+          NvmeDumpStatus (Completion);
+        DEBUG_CODE_END();
+      }
+    }
+
+    if ((Outstanding > 0) && !EFI_ERROR (gBS->CheckEvent (TimerEvent))) {
+      //
+      // No progress within the command timeout. Reset the controller to abort
+      // the outstanding commands, the same way NvmExpressPassThru() does.
+      //
+      DEBUG ((DEBUG_ERROR, "%a: Timeout occurs for an NVMe command.\n", __FUNCTION__));
+      gBS->SetTimer (Private->TimerEvent, TimerCancel, 0);
+      CommandStatus = NvmeControllerInit (Private);
+      if (!EFI_ERROR (CommandStatus)) {
+        AbortAsyncPassThruTasks (Private);
+        gBS->SetTimer (Private->TimerEvent, TimerPeriodic, NVME_HC_ASYNC_TIMER);
+        Status = EFI_TIMEOUT;
+      } else {
+        Status = EFI_DEVICE_ERROR;
+      }
+      break;
+    }
+  }
+
+EXIT:
+  for (Index = 0; Index < Depth; Index++) {
+    if (Queue[Index].Event != NULL) {
+      gBS->CloseEvent (Queue[Index].Event);
+    }
+  }
+  if (TimerEvent != NULL) {
+    gBS->CloseEvent (TimerEvent);
+  }
+  FreePool (Queue);
+
+  return Status;
+}
+
 /**
   Read some blocks from the device.
 
@@ -195,6 +391,17 @@ NvmeRead (
     MaxTransferBlocks = 1024;
   }
 
+  //
+  // Keep several commands outstanding when the request spans more than one
+  // maximum data transfer size.
+  //
+  if ((Blocks > MaxTransferBlocks) && (Private->BlockingQueueDepth > 1)) {
+    Status = NvmeQueuedReadWrite (Device, TRUE, Buffer, Lba, Blocks, MaxTransferBlocks);
+    if (Status != EFI_OUT_OF_RESOURCES) {
+      Blocks = 0;
+    }
+  }
+
   while (Blocks > 0) {
     if (Blocks > MaxTransferBlocks) {
       Status = ReadSectors (Device, (UINT64)(UINTN)Buffer, Lba, MaxTransferBlocks);
@@ -273,6 +480,17 @@ NvmeWrite (
     MaxTransferBlocks = 1024;
   }
 
+  //
+  // Keep several commands outstanding when the request spans more than one
+  // maximum data transfer size.
+  //
+  if ((Blocks > MaxTransferBlocks) && (Private->BlockingQueueDepth > 1)) {
+    Status = NvmeQueuedReadWrite (Device, FALSE, Buffer, Lba, Blocks, MaxTransferBlocks);
+    if (Status != EFI_OUT_OF_RESOURCES) {
+      Blocks = 0;
+    }
+  }
+
   while (Blocks > 0) {
     if (Blocks > MaxTransferBlocks) {
       Status = WriteSectors (Device, (UINT64)(UINTN)Buffer, Lba, MaxTransferBlocks);
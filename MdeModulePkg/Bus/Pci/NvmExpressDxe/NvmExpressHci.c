@@ -333,6 +333,22 @@ NvmeDisableController (
     return Status;
   }
 
+  //
+  // Nothing to wait for if the controller is already disabled and idle, as it
+  // is on a cold boot.
+  //
+  if (Cc.En == 0) {
+    Status = ReadNvmeControllerStatus (Private, &Csts);
+    if (EFI_ERROR(Status)) {
+      return Status;
+    }
+
+    if (Csts.Rdy == 0) {
+      DEBUG ((EFI_D_INFO, "NVMe controller is already disabled.\n"));
+      return EFI_SUCCESS;
+    }
+  }
+
   Cc.En = 0;
 
   //
@@ -355,10 +371,9 @@ NvmeDisableController (
   }
 
   for(Index = (Timeout * 500); Index != 0; --Index) {
-    gBS->Stall(1000);
-
     //
-    // Check if the controller is initialized
+    // Check if the controller is disabled before stalling, as the transition
+    // usually completes right away.
     //
     Status = ReadNvmeControllerStatus (Private, &Csts);
 
@@ -369,6 +384,8 @@ NvmeDisableController (
     if (Csts.Rdy == 0) {
       break;
     }
+
+    gBS->Stall(1000);
   }
 
   if (Index == 0) {
@@ -429,8 +446,6 @@ NvmeEnableController (
   }
 
   for(Index = (Timeout * 500); Index != 0; --Index) {
-    gBS->Stall(1000);
-
     //
     // Check if the controller is initialized
     //
@@ -443,6 +458,8 @@ NvmeEnableController (
     if (Csts.Rdy) {
       break;
     }
+
+    gBS->Stall(1000);
   }
 
   if (Index == 0) {
@@ -192,23 +192,74 @@ NvmeDumpStatus (
   }
 }
 
+/**
+  Take a run of pages from the PRP list pool of a controller.
+
+  @param[in]  Private        The pointer to the NVME_CONTROLLER_PRIVATE_DATA
+                             data structure.
+  @param[in]  Pages          The number of pages.
+
+  @return The index of the first page taken, or NVME_PRP_LIST_POOL_PAGES if no
+          run of Pages free pages is available.
+
+**/
+UINTN
+NvmeAllocatePrpListPoolPages (
+  IN NVME_CONTROLLER_PRIVATE_DATA    *Private,
+  IN UINTN                           Pages
+  )
+{
+  UINT64                      Mask;
+  UINTN                       Index;
+  EFI_TPL                     OldTpl;
+
+  if (Pages > NVME_PRP_LIST_POOL_PAGES) {
+    return NVME_PRP_LIST_POOL_PAGES;
+  }
+
+  Mask = (Pages == 64) ? MAX_UINT64 : LShiftU64 (1, Pages) - 1;
+
+  //
+  // Completions release pool pages from the asynchronous timer at TPL_NOTIFY.
+  //
+  OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+  for (Index = 0; Index + Pages <= NVME_PRP_LIST_POOL_PAGES; Index++) {
+    if ((Private->PrpListPoolBitmap & LShiftU64 (Mask, Index)) == 0) {
+      Private->PrpListPoolBitmap |= LShiftU64 (Mask, Index);
+      break;
+    }
+  }
+  gBS->RestoreTPL (OldTpl);
+
+  if (Index + Pages > NVME_PRP_LIST_POOL_PAGES) {
+    return NVME_PRP_LIST_POOL_PAGES;
+  }
+
+  return Index;
+}
+
 /**
   Create PRP lists for data transfer which is larger than 2 memory pages.
   Note here we calcuate the number of required PRP lists and allocate them at one time.
 
-  @param[in]     PciIo               A pointer to the EFI_PCI_IO_PROTOCOL instance.
+  The PRP lists are taken from the PRP list pool of the controller, which is
+  mapped once together with its queues. Only when the pool is exhausted are
+  they allocated and mapped for this transfer alone.
+
+  @param[in]     Private             The pointer to the NVME_CONTROLLER_PRIVATE_DATA data structure.
   @param[in]     PhysicalAddr        The physical base address of data buffer.
   @param[in]     Pages               The number of pages to be transfered.
   @param[out]    PrpListHost         The host base address of PRP lists.
   @param[in,out] PrpListNo           The number of PRP List.
-  @param[out]    Mapping             The mapping value returned from PciIo.Map().
+  @param[out]    Mapping             The mapping value returned from PciIo.Map(), or
+                                     NULL if the PRP lists were taken from the pool.
 
   @retval The pointer to the first PRP List of the PRP lists.
 
 **/
 VOID*
 NvmeCreatePrpList (
-  IN     EFI_PCI_IO_PROTOCOL          *PciIo,
+  IN     NVME_CONTROLLER_PRIVATE_DATA *Private,
   IN     EFI_PHYSICAL_ADDRESS         PhysicalAddr,
   IN     UINTN                        Pages,
      OUT VOID                         **PrpListHost,
@@ -216,6 +267,7 @@ NvmeCreatePrpList (
      OUT VOID                         **Mapping
   )
 {
+  EFI_PCI_IO_PROTOCOL         *PciIo;
   UINTN                       PrpEntryNo;
   UINT64                      PrpListBase;
   UINTN                       PrpListIndex;
@@ -223,8 +275,12 @@ NvmeCreatePrpList (
   UINT64                      Remainder;
   EFI_PHYSICAL_ADDRESS        PrpListPhyAddr;
   UINTN                       Bytes;
+  UINTN                       PoolIndex;
   EFI_STATUS                  Status;
 
+  PciIo    = Private->PciIo;
+  *Mapping = NULL;
+
   //
   // The number of Prp Entry in a memory page.
   //
@@ -244,32 +300,40 @@ NvmeCreatePrpList (
     Remainder = PrpEntryNo - 1;
   }
 
-  Status = PciIo->AllocateBuffer (
-                    PciIo,
-                    AllocateAnyPages,
-                    EfiBootServicesData,
-                    *PrpListNo,
-                    PrpListHost,
-                    0
-                    );
+  Bytes     = EFI_PAGES_TO_SIZE (*PrpListNo);
+  PoolIndex = NvmeAllocatePrpListPoolPages (Private, *PrpListNo);
+  if (PoolIndex < NVME_PRP_LIST_POOL_PAGES) {
+    *PrpListHost   = Private->Buffer +
+                     EFI_PAGES_TO_SIZE (NVME_QUEUE_BUFFER_PAGES + PoolIndex);
+    PrpListPhyAddr = (EFI_PHYSICAL_ADDRESS)(UINTN)(Private->BufferPciAddr +
+                     EFI_PAGES_TO_SIZE (NVME_QUEUE_BUFFER_PAGES + PoolIndex));
+  } else {
+    Status = PciIo->AllocateBuffer (
+                      PciIo,
+                      AllocateAnyPages,
+                      EfiBootServicesData,
+                      *PrpListNo,
+                      PrpListHost,
+                      0
+                      );
 
-  if (EFI_ERROR (Status)) {
-    return NULL;
-  }
+    if (EFI_ERROR (Status)) {
+      return NULL;
+    }
 
-  Bytes = EFI_PAGES_TO_SIZE (*PrpListNo);
-  Status = PciIo->Map (
-                    PciIo,
-                    EfiPciIoOperationBusMasterCommonBuffer,
-                    *PrpListHost,
-                    &Bytes,
-                    &PrpListPhyAddr,
-                    Mapping
-                    );
-
-  if (EFI_ERROR (Status) || (Bytes != EFI_PAGES_TO_SIZE (*PrpListNo))) {
-    DEBUG ((EFI_D_ERROR, "NvmeCreatePrpList: create PrpList failure!\n"));
-    goto EXIT;
+    Status = PciIo->Map (
+                      PciIo,
+                      EfiPciIoOperationBusMasterCommonBuffer,
+                      *PrpListHost,
+                      &Bytes,
+                      &PrpListPhyAddr,
+                      Mapping
+                      );
+
+    if (EFI_ERROR (Status) || (Bytes != EFI_PAGES_TO_SIZE (*PrpListNo))) {
+      DEBUG ((EFI_D_ERROR, "NvmeCreatePrpList: create PrpList failure!\n"));
+      goto EXIT;
+    }
   }
   //
   // Fill all PRP lists except of last one.
@@ -305,10 +369,55 @@ NvmeCreatePrpList (
   return (VOID*)(UINTN)PrpListPhyAddr;
 
 EXIT:
+  if (*Mapping != NULL) {
+    PciIo->Unmap (PciIo, *Mapping);
+    *Mapping = NULL;
+  }
   PciIo->FreeBuffer (PciIo, *PrpListNo, *PrpListHost);
   return NULL;
 }
 
+/**
+  Release the PRP lists created by NvmeCreatePrpList().
+
+  @param[in] Private        The pointer to the NVME_CONTROLLER_PRIVATE_DATA
+                            data structure.
+  @param[in] PrpListHost    The host base address of the PRP lists.
+  @param[in] PrpListNo      The number of PRP lists.
+  @param[in] Mapping        The mapping value returned by NvmeCreatePrpList().
+
+**/
+VOID
+NvmeFreePrpList (
+  IN NVME_CONTROLLER_PRIVATE_DATA    *Private,
+  IN VOID                            *PrpListHost,
+  IN UINTN                           PrpListNo,
+  IN VOID                            *Mapping
+  )
+{
+  UINT8                       *PoolBase;
+  UINTN                       PoolIndex;
+  UINT64                      Mask;
+  EFI_TPL                     OldTpl;
+
+  PoolBase = Private->Buffer + EFI_PAGES_TO_SIZE (NVME_QUEUE_BUFFER_PAGES);
+  if (((UINT8 *)PrpListHost >= PoolBase) &&
+      ((UINT8 *)PrpListHost < PoolBase + EFI_PAGES_TO_SIZE (NVME_PRP_LIST_POOL_PAGES))) {
+    PoolIndex = EFI_SIZE_TO_PAGES ((UINTN)((UINT8 *)PrpListHost - PoolBase));
+    Mask      = (PrpListNo == 64) ? MAX_UINT64 : LShiftU64 (1, PrpListNo) - 1;
+
+    OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+    Private->PrpListPoolBitmap &= ~LShiftU64 (Mask, PoolIndex);
+    gBS->RestoreTPL (OldTpl);
+    return;
+  }
+
+  if (Mapping != NULL) {
+    Private->PciIo->Unmap (Private->PciIo, Mapping);
+  }
+
+  Private->PciIo->FreeBuffer (Private->PciIo, PrpListNo, PrpListHost);
+}
 
 /**
   Aborts the asynchronous PassThru requests.
@@ -375,15 +484,13 @@ AbortAsyncPassThruTasks (
     if (AsyncRequest->MapMeta != NULL) {
       PciIo->Unmap (PciIo, AsyncRequest->MapMeta);
     }
-    if (AsyncRequest->MapPrpList != NULL) {
-      PciIo->Unmap (PciIo, AsyncRequest->MapPrpList);
-    }
     if (AsyncRequest->PrpListHost != NULL) {
-      PciIo->FreeBuffer (
-               PciIo,
-               AsyncRequest->PrpListNo,
-               AsyncRequest->PrpListHost
-               );
+      NvmeFreePrpList (
+        Private,
+        AsyncRequest->PrpListHost,
+        AsyncRequest->PrpListNo,
+        AsyncRequest->MapPrpList
+        );
     }
 
     RemoveEntryList (Link);
@@ -662,7 +769,7 @@ NvmExpressPassThru (
     // Create PrpList for remaining data buffer.
     //
     PhyAddr = (Sq->Prp[0] + EFI_PAGE_SIZE) & ~(EFI_PAGE_SIZE - 1);
-    Prp = NvmeCreatePrpList (PciIo, PhyAddr, EFI_SIZE_TO_PAGES(Offset + Bytes) - 1, &PrpListHost, &PrpListNo, &MapPrpList);
+    Prp = NvmeCreatePrpList (Private, PhyAddr, EFI_SIZE_TO_PAGES(Offset + Bytes) - 1, &PrpListHost, &PrpListNo, &MapPrpList);
     if (Prp == NULL) {
       Status = EFI_OUT_OF_RESOURCES;
       goto EXIT;
@@ -878,15 +985,8 @@ EXIT:
              );
   }
 
-  if (MapPrpList != NULL) {
-    PciIo->Unmap (
-             PciIo,
-             MapPrpList
-             );
-  }
-
   if (Prp != NULL) {
-    PciIo->FreeBuffer (PciIo, PrpListNo, PrpListHost);
+    NvmeFreePrpList (Private, PrpListHost, PrpListNo, MapPrpList);
   }
 
   if (TimerEvent != NULL) {
@@ -51,6 +51,12 @@ typedef struct _PEI_NVME_CONTROLLER_PRIVATE_DATA  PEI_NVME_CONTROLLER_PRIVATE_DA
 #define NVME_CCQ_SIZE                                 63    // Number of I/O completion queue entries, which is 0-based
 #define NVME_PRP_SIZE                                 (8)   // Pages of PRP list
 
+//
+// Largest transfer, in pages, that the PRP list buffers can describe whatever
+// the offset of the data buffer within its first page.
+//
+#define NVME_MAX_TRANSFER_PAGES                       (NVME_PRP_SIZE * (EFI_PAGE_SIZE / sizeof (UINT64) - 1))
+
 #define NVME_MEM_MAX_PAGES                                           \
   (                                                                  \
   1                                         /* ASQ */             +  \
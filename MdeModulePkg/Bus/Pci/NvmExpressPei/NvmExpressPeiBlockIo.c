@@ -107,10 +107,18 @@ NvmeRead (
   BlockSize     = NamespaceInfo->Media.BlockSize;
   OrginalBlocks = Blocks;
 
-  if (Private->ControllerData->Mdts != 0) {
-    MaxTransferBlocks = (1 << (Private->ControllerData->Mdts)) * (1 << (Private->Cap.Mpsmin + 12)) / BlockSize;
-  } else {
-    MaxTransferBlocks = 1024;
+  //
+  // Transfer as much per command as both the PRP list buffers and MDTS allow.
+  // MDTS is in units of the minimum memory page size; 0 means no limit, and
+  // so in effect does any limit beyond 4GB.
+  //
+  MaxTransferBlocks = (UINT32)(EFI_PAGES_TO_SIZE (NVME_MAX_TRANSFER_PAGES) / BlockSize);
+  if ((Private->ControllerData->Mdts != 0) &&
+      (Private->ControllerData->Mdts + Private->Cap.Mpsmin + 12 < 32)) {
+    MaxTransferBlocks = MIN (
+                          MaxTransferBlocks,
+                          (UINT32)(LShiftU64 (1, Private->ControllerData->Mdts + Private->Cap.Mpsmin + 12) / BlockSize)
+                          );
   }
 
   while (Blocks > 0) {
@@ -33,7 +33,7 @@ NvmeCreatePrpList (
   VOID                    *PrpListHost;
   UINTN                   PrpListIndex;
   UINTN                   PrpEntryIndex;
-  UINT64                  Remainder;
+  UINTN                   LastPrpEntryNo;
   EFI_PHYSICAL_ADDRESS    PrpListPhyAddr;
   UINTN                   Bytes;
   UINT8                   *PrpEntry;
@@ -45,19 +45,24 @@ NvmeCreatePrpList (
   PrpEntryNo = EFI_PAGE_SIZE / sizeof (UINT64);
 
   //
-  // Calculate total PrpList number.
+  // Calculate total PrpList number. Every PRP list but the last one gives up
+  // its last entry to the pointer to the next list, so n lists describe
+  // n * (PrpEntryNo - 1) + 1 pages.
   //
-  PrpListNo = (UINTN) DivU64x64Remainder ((UINT64)Pages, (UINT64)PrpEntryNo, &Remainder);
-  if (Remainder != 0) {
-    PrpListNo += 1;
+  if (Pages <= PrpEntryNo) {
+    PrpListNo = 1;
+  } else {
+    PrpListNo = (Pages - 2) / (PrpEntryNo - 1) + 1;
   }
+  LastPrpEntryNo = Pages - (PrpListNo - 1) * (PrpEntryNo - 1);
 
   if (PrpListNo > NVME_PRP_SIZE) {
     DEBUG ((
       DEBUG_ERROR,
-      "%a: The implementation only supports PrpList number up to 4."
+      "%a: The implementation only supports PrpList number up to %d."
       " But %d are needed here.\n",
       __FUNCTION__,
+      NVME_PRP_SIZE,
       PrpListNo
       ));
     return 0;
@@ -96,7 +101,7 @@ NvmeCreatePrpList (
   // Fill last PRP list.
   //
   PrpListBase = (UINTN)PrpListHost + PrpListIndex * EFI_PAGE_SIZE;
-  for (PrpEntryIndex = 0; PrpEntryIndex < ((Remainder != 0) ? Remainder : PrpEntryNo); ++PrpEntryIndex) {
+  for (PrpEntryIndex = 0; PrpEntryIndex < LastPrpEntryNo; ++PrpEntryIndex) {
     PrpEntry = (UINT8 *)(UINTN) (PrpListBase + PrpEntryIndex * sizeof(UINT64));
     CopyMem (PrpEntry, (VOID *)(UINTN) (&PhysicalAddr), sizeof (UINT64));
 
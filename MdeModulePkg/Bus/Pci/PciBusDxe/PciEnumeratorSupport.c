@@ -76,6 +76,64 @@ PciDevicePresent (
   return EFI_NOT_FOUND;
 }
 
+/**
+  Check whether only Device 0 can be present on the secondary bus of a bridge.
+
+  A PCI Express Root Port or Downstream Port has a single link below it and
+  forwards configuration requests to Device 0 only, so probing Device 1 to 31
+  would only collect Unsupported Request completions. With ARI Forwarding
+  enabled, the Device number is part of the Function number and all of them
+  must be probed.
+
+  @param Bridge         Parent bridge instance.
+
+  @retval TRUE          Only Device 0 needs to be probed.
+  @retval FALSE         All the devices need to be probed.
+
+**/
+BOOLEAN
+PciBridgeForwardsDevice0Only (
+  IN PCI_IO_DEVICE                      *Bridge
+  )
+{
+  EFI_STATUS                  Status;
+  PCI_REG_PCIE_CAPABILITY     Capability;
+  UINT32                      DeviceControl2;
+
+  if (!Bridge->IsPciExp) {
+    return FALSE;
+  }
+
+  Status = Bridge->PciIo.Pci.Read (
+                               &Bridge->PciIo,
+                               EfiPciIoWidthUint16,
+                               Bridge->PciExpressCapabilityOffset + OFFSET_OF (PCI_CAPABILITY_PCIEXP, Capability),
+                               1,
+                               &Capability
+                               );
+  if (EFI_ERROR (Status)) {
+    return FALSE;
+  }
+
+  if ((Capability.Bits.DevicePortType != PCIE_DEVICE_PORT_TYPE_ROOT_PORT) &&
+      (Capability.Bits.DevicePortType != PCIE_DEVICE_PORT_TYPE_DOWNSTREAM_PORT)) {
+    return FALSE;
+  }
+
+  Status = Bridge->PciIo.Pci.Read (
+                               &Bridge->PciIo,
+                               EfiPciIoWidthUint32,
+                               Bridge->PciExpressCapabilityOffset + EFI_PCIE_CAPABILITY_DEVICE_CONTROL_2_OFFSET,
+                               1,
+                               &DeviceControl2
+                               );
+  if (EFI_ERROR (Status)) {
+    return FALSE;
+  }
+
+  return (BOOLEAN) ((DeviceControl2 & EFI_PCIE_CAPABILITY_DEVICE_CONTROL_2_ARI_FORWARDING) == 0);
+}
+
 /**
   Collect all the resource information under this root bridge.
 
@@ -108,6 +166,15 @@ PciPciDeviceInfoCollector (
 
   for (Device = 0; Device <= PCI_MAX_DEVICE; Device++) {
 
+    //
+    // Stop after Device 0 behind a PCI Express port. This is checked only
+    // once Device 0 is done, because enumerating an ARI device 0 enables
+    // ARI Forwarding in the port.
+    //
+    if ((Device == 1) && PciBridgeForwardsDevice0Only (Bridge)) {
+      break;
+    }
+
     for (Func = 0; Func <= PCI_MAX_FUNC; Func++) {
 
       //
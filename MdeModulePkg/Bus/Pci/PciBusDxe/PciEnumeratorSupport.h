@@ -31,6 +31,26 @@ PciDevicePresent (
   IN  UINT8                               Func
   );
 
+/**
+  Check whether only Device 0 can be present on the secondary bus of a bridge.
+
+  A PCI Express Root Port or Downstream Port has a single link below it and
+  forwards configuration requests to Device 0 only, so probing Device 1 to 31
+  would only collect Unsupported Request completions. With ARI Forwarding
+  enabled, the Device number is part of the Function number and all of them
+  must be probed.
+
+  @param Bridge         Parent bridge instance.
+
+  @retval TRUE          Only Device 0 needs to be probed.
+  @retval FALSE         All the devices need to be probed.
+
+**/
+BOOLEAN
+PciBridgeForwardsDevice0Only (
+  IN PCI_IO_DEVICE                      *Bridge
+  );
+
 /**
   Collect all the resource information under this root bridge.
 
@@ -109,8 +109,9 @@ EmmcGetOcr (
 
   Refer to EMMC Electrical Standard Spec 5.1 Section 6.4 for details.
 
-  @param[in] PassThru       A pointer to the EFI_SD_MMC_PASS_THRU_PROTOCOL instance.
-  @param[in] Slot           The slot number of the SD card to send the command to.
+  @param[in]  PassThru      A pointer to the EFI_SD_MMC_PASS_THRU_PROTOCOL instance.
+  @param[in]  Slot          The slot number of the SD card to send the command to.
+  @param[out] Cid           The buffer to store the content of the CID register.
 
   @retval EFI_SUCCESS       The operation is done correctly.
   @retval Others            The operation fails.
@@ -118,8 +119,9 @@ EmmcGetOcr (
 **/
 EFI_STATUS
 EmmcGetAllCid (
-  IN EFI_SD_MMC_PASS_THRU_PROTOCOL      *PassThru,
-  IN UINT8                              Slot
+  IN     EFI_SD_MMC_PASS_THRU_PROTOCOL  *PassThru,
+  IN     UINT8                          Slot,
+     OUT EMMC_CID                       *Cid
   )
 {
   EFI_SD_MMC_COMMAND_BLOCK              SdMmcCmdBlk;
@@ -141,6 +143,12 @@ EmmcGetAllCid (
   SdMmcCmdBlk.CommandArgument = 0;
 
   Status = SdMmcPassThruPassThru (PassThru, Slot, &Packet, NULL);
+  if (!EFI_ERROR (Status)) {
+    //
+    // For details, refer to SD Host Controller Simplified Spec 3.0 Table 2-12.
+    //
+    CopyMem (((UINT8*)Cid) + 1, &SdMmcStatusBlk.Resp0, sizeof (EMMC_CID) - 1);
+  }
 
   return Status;
 }
@@ -1009,9 +1017,10 @@ EmmcIsBusTimingSupported (
   will try to select highest bus timing supported by card, controller
   and the driver.
 
-  @param[in] Private    Pointer to controller private data
-  @param[in] SlotIndex  Index of the slot in the controller
-  @param[in] ExtCsd     Pointer to the card's extended CSD
+  @param[in] Private       Pointer to controller private data
+  @param[in] SlotIndex     Index of the slot in the controller
+  @param[in] ExtCsd        Pointer to the card's extended CSD
+  @param[in] MaxBusTiming  Highest bus timing that may be selected
 
   @return  Bus timing value that should be set on link
 **/
@@ -1019,7 +1028,8 @@ SD_MMC_BUS_MODE
 EmmcGetTargetBusTiming (
   IN SD_MMC_HC_PRIVATE_DATA  *Private,
   IN UINT8                    SlotIndex,
-  IN EMMC_EXT_CSD             *ExtCsd
+  IN EMMC_EXT_CSD             *ExtCsd,
+  IN SD_MMC_BUS_MODE          MaxBusTiming
   )
 {
   SD_MMC_BUS_MODE  BusTiming;
@@ -1028,7 +1038,7 @@ EmmcGetTargetBusTiming (
   // We start with highest bus timing that this driver currently supports and
   // return as soon as we find supported timing.
   //
-  BusTiming = SdMmcMmcHs400;
+  BusTiming = MaxBusTiming;
   while (BusTiming > SdMmcMmcLegacy) {
     if (EmmcIsBusTimingSupported (Private, SlotIndex, ExtCsd, BusTiming)) {
       break;
@@ -1185,35 +1195,141 @@ EmmcGetTargetDriverStrength (
 /**
   Get the target settings for the bus mode.
 
-  @param[in]  Private    Pointer to controller private data
-  @param[in]  SlotIndex  Index of the slot in the controller
-  @param[in]  ExtCsd     Pointer to card's extended CSD
-  @param[out] BusMode    Target configuration of the bus
+  @param[in]  Private       Pointer to controller private data
+  @param[in]  SlotIndex     Index of the slot in the controller
+  @param[in]  ExtCsd        Pointer to card's extended CSD
+  @param[in]  MaxBusTiming  Highest bus timing that may be selected
+  @param[out] BusMode       Target configuration of the bus
 **/
 VOID
 EmmcGetTargetBusMode (
   IN SD_MMC_HC_PRIVATE_DATA  *Private,
   IN UINT8                   SlotIndex,
   IN EMMC_EXT_CSD            *ExtCsd,
+  IN SD_MMC_BUS_MODE         MaxBusTiming,
   OUT SD_MMC_BUS_SETTINGS    *BusMode
   )
 {
-  BusMode->BusTiming = EmmcGetTargetBusTiming (Private, SlotIndex, ExtCsd);
+  BusMode->BusTiming = EmmcGetTargetBusTiming (Private, SlotIndex, ExtCsd, MaxBusTiming);
   BusMode->BusWidth = EmmcGetTargetBusWidth (Private, SlotIndex, ExtCsd, BusMode->BusTiming);
   BusMode->ClockFreq = EmmcGetTargetClockFreq (Private, SlotIndex, ExtCsd, BusMode->BusTiming);
   BusMode->DriverStrength = EmmcGetTargetDriverStrength (Private, SlotIndex, ExtCsd, BusMode->BusTiming);
 }
 
+/**
+  Look up the bus timing recorded for an EMMC device by a previous boot.
+
+  @param[in]  Cid           The content of the CID register of the device.
+
+  @return  The highest bus timing known to work with the device on this
+           platform, or SdMmcMmcHs400 if nothing was recorded.
+**/
+SD_MMC_BUS_MODE
+EmmcGetCachedBusTiming (
+  IN EMMC_CID                           *Cid
+  )
+{
+  EFI_STATUS                    Status;
+  EMMC_BUS_MODE_CACHE_ENTRY     Cache[EMMC_BUS_MODE_CACHE_ENTRIES];
+  UINTN                         Size;
+  UINTN                         Index;
+
+  Size   = sizeof (Cache);
+  Status = gRT->GetVariable (
+                  EMMC_BUS_MODE_CACHE_VARIABLE_NAME,
+                  &gEfiCallerIdGuid,
+                  NULL,
+                  &Size,
+                  Cache
+                  );
+  if (EFI_ERROR (Status)) {
+    return SdMmcMmcHs400;
+  }
+
+  for (Index = 0; Index < Size / sizeof (EMMC_BUS_MODE_CACHE_ENTRY); Index++) {
+    if (CompareMem (&Cache[Index].Cid, Cid, sizeof (EMMC_CID)) == 0 &&
+        Cache[Index].BusTiming < SdMmcMmcHs400) {
+      return (SD_MMC_BUS_MODE)Cache[Index].BusTiming;
+    }
+  }
+
+  return SdMmcMmcHs400;
+}
+
+/**
+  Record the highest bus timing that worked with an EMMC device, so the next
+  boot does not have to repeat the switch and tuning attempts that failed.
+
+  @param[in]  Cid           The content of the CID register of the device.
+  @param[in]  BusTiming     The bus timing the device was brought up with.
+**/
+VOID
+EmmcSetCachedBusTiming (
+  IN EMMC_CID                           *Cid,
+  IN SD_MMC_BUS_MODE                    BusTiming
+  )
+{
+  EFI_STATUS                    Status;
+  EMMC_BUS_MODE_CACHE_ENTRY     Cache[EMMC_BUS_MODE_CACHE_ENTRIES];
+  UINTN                         Size;
+  UINTN                         Count;
+  UINTN                         Index;
+
+  Size   = sizeof (Cache);
+  Status = gRT->GetVariable (
+                  EMMC_BUS_MODE_CACHE_VARIABLE_NAME,
+                  &gEfiCallerIdGuid,
+                  NULL,
+                  &Size,
+                  Cache
+                  );
+  Count = EFI_ERROR (Status) ? 0 : Size / sizeof (EMMC_BUS_MODE_CACHE_ENTRY);
+
+  for (Index = 0; Index < Count; Index++) {
+    if (CompareMem (&Cache[Index].Cid, Cid, sizeof (EMMC_CID)) == 0) {
+      break;
+    }
+  }
+
+  if (Index == Count) {
+    if (Count == EMMC_BUS_MODE_CACHE_ENTRIES) {
+      //
+      // Drop the oldest record.
+      //
+      CopyMem (&Cache[0], &Cache[1], sizeof (Cache) - sizeof (Cache[0]));
+      Index = Count - 1;
+    } else {
+      Count++;
+    }
+  } else if (Cache[Index].BusTiming == (UINT8)BusTiming) {
+    return;
+  }
+
+  CopyMem (&Cache[Index].Cid, Cid, sizeof (EMMC_CID));
+  Cache[Index].BusTiming = (UINT8)BusTiming;
+
+  Status = gRT->SetVariable (
+                  EMMC_BUS_MODE_CACHE_VARIABLE_NAME,
+                  &gEfiCallerIdGuid,
+                  EFI_VARIABLE_NON_VOLATILE | EFI_VARIABLE_BOOTSERVICE_ACCESS,
+                  Count * sizeof (EMMC_BUS_MODE_CACHE_ENTRY),
+                  Cache
+                  );
+  DEBUG ((DEBUG_INFO, "EmmcSetCachedBusTiming: record bus timing %d with %r\n", BusTiming, Status));
+}
+
 /**
   Switch the high speed timing according to request.
 
   Refer to EMMC Electrical Standard Spec 5.1 Section 6.6.8 and SD Host Controller
   Simplified Spec 3.0 Figure 2-29 for details.
 
-  @param[in] PciIo          A pointer to the EFI_PCI_IO_PROTOCOL instance.
-  @param[in] PassThru       A pointer to the EFI_SD_MMC_PASS_THRU_PROTOCOL instance.
-  @param[in] Slot           The slot number of the SD card to send the command to.
-  @param[in] Rca            The relative device address to be assigned.
+  @param[in]  PciIo         A pointer to the EFI_PCI_IO_PROTOCOL instance.
+  @param[in]  PassThru      A pointer to the EFI_SD_MMC_PASS_THRU_PROTOCOL instance.
+  @param[in]  Slot          The slot number of the SD card to send the command to.
+  @param[in]  Rca           The relative device address to be assigned.
+  @param[in]  MaxBusTiming  Highest bus timing that may be selected.
+  @param[out] BusTiming     The bus timing that was attempted.
 
   @retval EFI_SUCCESS       The operation is done correctly.
   @retval Others            The operation fails.
@@ -1221,10 +1337,12 @@ EmmcGetTargetBusMode (
 **/
 EFI_STATUS
 EmmcSetBusMode (
-  IN EFI_PCI_IO_PROTOCOL                *PciIo,
-  IN EFI_SD_MMC_PASS_THRU_PROTOCOL      *PassThru,
-  IN UINT8                              Slot,
-  IN UINT16                             Rca
+  IN     EFI_PCI_IO_PROTOCOL            *PciIo,
+  IN     EFI_SD_MMC_PASS_THRU_PROTOCOL  *PassThru,
+  IN     UINT8                          Slot,
+  IN     UINT16                         Rca,
+  IN     SD_MMC_BUS_MODE                MaxBusTiming,
+     OUT SD_MMC_BUS_MODE                *BusTiming
   )
 {
   EFI_STATUS                    Status;
@@ -1233,7 +1351,8 @@ EmmcSetBusMode (
   SD_MMC_BUS_SETTINGS           BusMode;
   SD_MMC_HC_PRIVATE_DATA        *Private;
 
-  Private = SD_MMC_HC_PRIVATE_FROM_THIS (PassThru);
+  Private    = SD_MMC_HC_PRIVATE_FROM_THIS (PassThru);
+  *BusTiming = SdMmcMmcLegacy;
 
   Status = EmmcGetCsd (PassThru, Slot, Rca, &Csd);
   if (EFI_ERROR (Status)) {
@@ -1258,7 +1377,8 @@ EmmcSetBusMode (
     return Status;
   }
 
-  EmmcGetTargetBusMode (Private, Slot, &ExtCsd, &BusMode);
+  EmmcGetTargetBusMode (Private, Slot, &ExtCsd, MaxBusTiming, &BusMode);
+  *BusTiming = BusMode.BusTiming;
 
   DEBUG ((DEBUG_INFO, "EmmcSetBusMode: Target bus mode: timing = %d, width = %d, clock freq = %d, driver strength = %d\n",
                           BusMode.BusTiming, BusMode.BusWidth, BusMode.ClockFreq, BusMode.DriverStrength.Emmc));
@@ -1306,10 +1426,19 @@ EmmcIdentification (
   UINT32                         Ocr;
   UINT16                         Rca;
   UINTN                          Retry;
-
-  PciIo    = Private->PciIo;
-  PassThru = &Private->PassThru;
-
+  EMMC_CID                       Cid;
+  BOOLEAN                        CidValid;
+  BOOLEAN                        FellBack;
+  SD_MMC_BUS_MODE                MaxBusTiming;
+  SD_MMC_BUS_MODE                BusTiming;
+
+  PciIo        = Private->PciIo;
+  PassThru     = &Private->PassThru;
+  CidValid     = FALSE;
+  FellBack     = FALSE;
+  MaxBusTiming = SdMmcMmcHs400;
+
+Identify:
   Status = EmmcReset (PassThru, Slot);
   if (EFI_ERROR (Status)) {
     DEBUG ((DEBUG_VERBOSE, "EmmcIdentification: Executing Cmd0 fails with %r\n", Status));
@@ -1333,11 +1462,16 @@ EmmcIdentification (
     gBS->Stall(10 * 1000);
   } while ((Ocr & BIT31) == 0);
 
-  Status = EmmcGetAllCid (PassThru, Slot);
+  ZeroMem (&Cid, sizeof (Cid));
+  Status = EmmcGetAllCid (PassThru, Slot, &Cid);
   if (EFI_ERROR (Status)) {
     DEBUG ((DEBUG_VERBOSE, "EmmcIdentification: Executing Cmd2 fails with %r\n", Status));
     return Status;
   }
+  if (!CidValid) {
+    MaxBusTiming = EmmcGetCachedBusTiming (&Cid);
+    CidValid     = TRUE;
+  }
   //
   // Slot starts from 0 and valid RCA starts from 1.
   // Here we takes a simple formula to calculate the RCA.
@@ -1356,8 +1490,34 @@ EmmcIdentification (
   DEBUG ((DEBUG_INFO, "EmmcIdentification: Found a EMMC device at slot [%d], RCA [%d]\n", Slot, Rca));
   Private->Slot[Slot].CardType = EmmcCardType;
 
-  Status = EmmcSetBusMode (PciIo, PassThru, Slot, Rca);
+  Status = EmmcSetBusMode (PciIo, PassThru, Slot, Rca, MaxBusTiming, &BusTiming);
+  if (!EFI_ERROR (Status)) {
+    if (FellBack) {
+      EmmcSetCachedBusTiming (&Cid, BusTiming);
+    }
+    return Status;
+  }
 
-  return Status;
+  //
+  // A failed switch or tuning leaves the device and the host in an unknown
+  // state. Start over from reset, capped one bus timing lower, and remember
+  // the timing that finally works so later boots go straight to it.
+  //
+  if (BusTiming == SdMmcMmcLegacy) {
+    return Status;
+  }
+  MaxBusTiming = (SD_MMC_BUS_MODE)(BusTiming - 1);
+  FellBack     = TRUE;
+  DEBUG ((DEBUG_WARN, "EmmcIdentification: bus timing %d fails with %r, retry with %d\n", BusTiming, Status, MaxBusTiming));
+
+  Status = SdMmcHcReset (Private, Slot);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+  Status = SdMmcHcInitHost (Private, Slot);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+  goto Identify;
 }
 
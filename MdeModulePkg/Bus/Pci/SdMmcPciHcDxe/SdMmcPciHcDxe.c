@@ -54,6 +54,7 @@ SD_MMC_HC_PRIVATE_DATA gSdMmcPciHcTemplate = {
   NULL,                             // ConnectEvent
                                     // Queue
   INITIALIZE_LIST_HEAD_VARIABLE (gSdMmcPciHcTemplate.Queue),
+  NULL,                             // Adma3Chain
   {                                 // Slot
     SLOT_INIT_TEMPLATE,
     SLOT_INIT_TEMPLATE,
@@ -164,6 +165,13 @@ ProcessAsyncTaskList (
 
   Private = (SD_MMC_HC_PRIVATE_DATA*)Context;
 
+  //
+  // Chained eMMC transfers at the head of the queue are run through ADMA3.
+  //
+  if (SdMmcProcessAdma3Chain (Private)) {
+    return;
+  }
+
   //
   // Check if the first entry in the async I/O queue is done or not.
   //
@@ -265,6 +273,9 @@ SdMmcPciHcEnumerateDevice (
         // Signal all async task events at the slot with EFI_NO_MEDIA status.
         //
         OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+        if ((Private->Adma3Chain != NULL) && (Private->Adma3Chain->Slot == Slot)) {
+          SdMmcAbortAdma3Chain (Private);
+        }
         for (Link = GetFirstNode (&Private->Queue);
              !IsNull (&Private->Queue, Link);
              Link = NextLink) {
@@ -927,6 +938,7 @@ SdMmcPciHcDriverBindingStop (
   // As the timer is closed, there is no needs to use TPL lock to
   // protect the critical region "queue".
   //
+  SdMmcAbortAdma3Chain (Private);
   for (Link = GetFirstNode (&Private->Queue);
        !IsNull (&Private->Queue, Link);
        Link = NextLink) {
@@ -1405,6 +1417,7 @@ SdMmcPassThruResetDevice (
   //
   OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
 
+  SdMmcAbortAdma3Chain (Private);
   for (Link = GetFirstNode (&Private->Queue);
        !IsNull (&Private->Queue, Link);
        Link = NextLink) {
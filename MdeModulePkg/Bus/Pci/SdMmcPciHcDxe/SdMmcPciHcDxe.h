@@ -20,10 +20,12 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Library/UefiDriverEntryPoint.h>
 #include <Library/DebugLib.h>
 #include <Library/UefiBootServicesTableLib.h>
+#include <Library/UefiRuntimeServicesTableLib.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/MemoryAllocationLib.h>
 #include <Library/UefiLib.h>
 #include <Library/DevicePathLib.h>
+#include <Library/PcdLib.h>
 
 #include <Protocol/DevicePath.h>
 #include <Protocol/PciIo.h>
@@ -87,6 +89,8 @@ typedef struct {
   EDKII_SD_MMC_OPERATING_PARAMETERS  OperatingParameters;
 } SD_MMC_HC_SLOT;
 
+typedef struct _SD_MMC_HC_ADMA3_CHAIN SD_MMC_HC_ADMA3_CHAIN;
+
 typedef struct {
   UINTN                               Signature;
 
@@ -109,6 +113,10 @@ typedef struct {
   //
   EFI_EVENT                           ConnectEvent;
   LIST_ENTRY                          Queue;
+  //
+  // The ADMA3 submission currently owning the head of the async I/O queue.
+  //
+  SD_MMC_HC_ADMA3_CHAIN               *Adma3Chain;
 
   SD_MMC_HC_SLOT                      Slot[SD_MMC_HC_MAX_SLOT];
   SD_MMC_HC_SLOT_CAP                  Capability[SD_MMC_HC_MAX_SLOT];
@@ -129,6 +137,20 @@ typedef struct {
   EDKII_SD_MMC_DRIVER_STRENGTH  DriverStrength;
 } SD_MMC_BUS_SETTINGS;
 
+//
+// Bus timings that had to be lowered for an EMMC device are kept across
+// boots in a variable under gEfiCallerIdGuid, keyed by the device CID.
+//
+#define EMMC_BUS_MODE_CACHE_VARIABLE_NAME  L"EmmcBusMode"
+#define EMMC_BUS_MODE_CACHE_ENTRIES        4
+
+#pragma pack(1)
+typedef struct {
+  EMMC_CID                      Cid;
+  UINT8                         BusTiming;
+} EMMC_BUS_MODE_CACHE_ENTRY;
+#pragma pack()
+
 #define SD_MMC_HC_TRB_SIG             SIGNATURE_32 ('T', 'R', 'B', 'T')
 
 #define SD_MMC_TRB_RETRIES            5
@@ -157,6 +179,7 @@ typedef struct {
   BOOLEAN                             CommandComplete;
   UINT64                              Timeout;
   UINT32                              Retries;
+  BOOLEAN                             Adma3Fallback;
 
   BOOLEAN                             PioModeTransferCompleted;
   UINT32                              PioBlockIndex;
@@ -174,6 +197,30 @@ typedef struct {
 #define SD_MMC_HC_TRB_FROM_THIS(a) \
     CR(a, SD_MMC_HC_TRB, TrbList, SD_MMC_HC_TRB_SIG)
 
+//
+// Maximum number of CMD23/CMD18/CMD25 pairs chained in one ADMA3 submission.
+//
+#define SD_MMC_HC_ADMA3_MAX_CMDS      32
+
+//
+// ADMA3 submission built from consecutive queued TRBs. Each CMD23 TRB is
+// folded into the Auto CMD23 of the data TRB that follows it.
+//
+struct _SD_MMC_HC_ADMA3_CHAIN {
+  UINT8                               Slot;
+  UINT32                              TrbCount;
+  SD_MMC_HC_TRB                       *Trb[SD_MMC_HC_ADMA3_MAX_CMDS * 2];
+
+  VOID                                *Desc;
+  UINT32                              DescPages;
+  EFI_PHYSICAL_ADDRESS                DescPhy;
+  VOID                                *DescMap;
+
+  BOOLEAN                             DmaDone;
+  BOOLEAN                             InfiniteWait;
+  UINT64                              Timeout;
+};
+
 //
 // Task for Non-blocking mode.
 //
@@ -768,6 +815,34 @@ SdMmcWaitTrbResult (
   IN SD_MMC_HC_TRB                    *Trb
   );
 
+/**
+  Start or poll the ADMA3 submission for the head of the async I/O queue.
+
+  @param[in] Private        A pointer to the SD_MMC_HC_PRIVATE_DATA instance.
+
+  @retval TRUE              The head of the queue is owned by an ADMA3
+                            submission and was handled for this tick.
+  @retval FALSE             The head of the queue is to be processed one
+                            TRB at a time.
+
+**/
+BOOLEAN
+SdMmcProcessAdma3Chain (
+  IN SD_MMC_HC_PRIVATE_DATA           *Private
+  );
+
+/**
+  Stop the ADMA3 submission in flight, if any, and release its descriptors.
+  The chained TRBs are left in the async I/O queue for the caller.
+
+  @param[in] Private        A pointer to the SD_MMC_HC_PRIVATE_DATA instance.
+
+**/
+VOID
+SdMmcAbortAdma3Chain (
+  IN SD_MMC_HC_PRIVATE_DATA           *Private
+  );
+
 /**
   Execute EMMC device identification procedure.
 
@@ -70,6 +70,7 @@ DumpCapabilityReg (
   DEBUG ((DEBUG_INFO, "   SDR50 Tuning      %a\n", Capability->TuningSDR50 ? "TRUE" : "FALSE"));
   DEBUG ((DEBUG_INFO, "   Retuning Mode     Mode %d\n", Capability->RetuningMod + 1));
   DEBUG ((DEBUG_INFO, "   Clock Multiplier  M = %d\n", Capability->ClkMultiplier + 1));
+  DEBUG ((DEBUG_INFO, "   ADMA3 Support     %a\n", Capability->Adma3 ? "TRUE" : "FALSE"));
   DEBUG ((DEBUG_INFO, "   HS 400            %a\n", Capability->Hs400 ? "TRUE" : "FALSE"));
   return;
 }
@@ -2836,3 +2837,638 @@ SdMmcWaitTrbResult (
   return EFI_TIMEOUT;
 }
 
+
+/**
+  Check whether the TRB is a plain CMD23 that can be folded into the
+  Auto CMD23 of the data transfer following it.
+
+  @param[in] Trb            The pointer to the SD_MMC_HC_TRB instance.
+
+  @retval TRUE              The TRB can be chained.
+  @retval FALSE             The TRB has to be executed on its own.
+
+**/
+BOOLEAN
+SdMmcIsAdma3SetBlkCntTrb (
+  IN SD_MMC_HC_TRB                    *Trb
+  )
+{
+  EFI_SD_MMC_COMMAND_BLOCK            *CmdBlk;
+
+  CmdBlk = Trb->Packet->SdMmcCmdBlk;
+
+  //
+  // Reliable write, packed and context flags in the upper argument bits
+  // have no Auto CMD23 equivalent.
+  //
+  return (BOOLEAN)(!Trb->Started && !Trb->Adma3Fallback &&
+                   (Trb->Mode == SdMmcNoData) &&
+                   (CmdBlk->CommandIndex == EMMC_SET_BLOCK_COUNT) &&
+                   (CmdBlk->CommandArgument != 0) &&
+                   (CmdBlk->CommandArgument <= MAX_UINT16));
+}
+
+/**
+  Check whether the TRB is an ADMA2 multiple block transfer of the given
+  block count that can be placed in an ADMA3 submission.
+
+  @param[in] Trb            The pointer to the SD_MMC_HC_TRB instance.
+  @param[in] BlockCount     The block count set by the preceding CMD23.
+
+  @retval TRUE              The TRB can be chained.
+  @retval FALSE             The TRB has to be executed on its own.
+
+**/
+BOOLEAN
+SdMmcIsAdma3DataTrb (
+  IN SD_MMC_HC_TRB                    *Trb,
+  IN UINT32                           BlockCount
+  )
+{
+  EFI_SD_MMC_COMMAND_BLOCK            *CmdBlk;
+
+  CmdBlk = Trb->Packet->SdMmcCmdBlk;
+
+  return (BOOLEAN)(!Trb->Started && !Trb->Adma3Fallback &&
+                   ((Trb->Mode == SdMmcAdma32bMode) || (Trb->Mode == SdMmcAdma64bV4Mode)) &&
+                   ((CmdBlk->CommandIndex == EMMC_READ_MULTIPLE_BLOCK) ||
+                    (CmdBlk->CommandIndex == EMMC_WRITE_MULTIPLE_BLOCK)) &&
+                   (CmdBlk->ResponseType == SdMmcResponseTypeR1) &&
+                   (Trb->BlockSize == 0x200) &&
+                   (Trb->DataLen == BlockCount * 0x200));
+}
+
+/**
+  Get the number of ADMA2 descriptor lines built for the TRB.
+
+  @param[in] Trb            The pointer to the SD_MMC_HC_TRB instance.
+
+  @return The number of descriptor lines, including the one marked End.
+
+**/
+UINT32
+SdMmcGetAdmaDescLines (
+  IN SD_MMC_HC_TRB                    *Trb
+  )
+{
+  UINT32                              Lines;
+
+  Lines = 0;
+  if (Trb->Mode == SdMmcAdma32bMode) {
+    while (Trb->Adma32Desc[Lines++].End == 0) {
+    }
+  } else {
+    while (Trb->Adma64V4Desc[Lines++].End == 0) {
+    }
+  }
+
+  return Lines;
+}
+
+/**
+  Fill one ADMA3 command or integrated descriptor line.
+
+  @param[in] Line           The descriptor line to fill.
+  @param[in] Mode           SdMmcAdma32bMode or SdMmcAdma64bV4Mode.
+  @param[in] Act            The Act field of the descriptor line.
+  @param[in] End            Whether this is the last line of the descriptor.
+  @param[in] Int            Whether to raise the DMA interrupt on this line.
+  @param[in] Data           The register value or descriptor address.
+
+**/
+VOID
+SdMmcSetAdma3DescLine (
+  IN VOID                             *Line,
+  IN SD_MMC_HC_TRANSFER_MODE          Mode,
+  IN UINT8                            Act,
+  IN BOOLEAN                          End,
+  IN BOOLEAN                          Int,
+  IN UINT64                           Data
+  )
+{
+  SD_MMC_HC_ADMA3_32_DESC_LINE        *Line32;
+  SD_MMC_HC_ADMA3_64_DESC_LINE        *Line64;
+
+  if (Mode == SdMmcAdma32bMode) {
+    Line32        = (SD_MMC_HC_ADMA3_32_DESC_LINE *)Line;
+    Line32->Valid = 1;
+    Line32->End   = End ? 1 : 0;
+    Line32->Int   = Int ? 1 : 0;
+    Line32->Act   = Act;
+    Line32->Data  = (UINT32)Data;
+  } else {
+    Line64            = (SD_MMC_HC_ADMA3_64_DESC_LINE *)Line;
+    Line64->Valid     = 1;
+    Line64->End       = End ? 1 : 0;
+    Line64->Int       = Int ? 1 : 0;
+    Line64->Act       = Act;
+    Line64->LowerData = (UINT32)Data;
+    Line64->UpperData = (UINT32)RShiftU64 (Data, 32);
+  }
+}
+
+/**
+  Release the descriptors of the ADMA3 submission. The chained TRBs are
+  not touched.
+
+  @param[in] Private        A pointer to the SD_MMC_HC_PRIVATE_DATA instance.
+
+**/
+VOID
+SdMmcFreeAdma3Chain (
+  IN SD_MMC_HC_PRIVATE_DATA           *Private
+  )
+{
+  SD_MMC_HC_ADMA3_CHAIN               *Chain;
+  EFI_PCI_IO_PROTOCOL                 *PciIo;
+
+  Chain = Private->Adma3Chain;
+  if (Chain == NULL) {
+    return;
+  }
+
+  PciIo = Private->PciIo;
+  if (Chain->DescMap != NULL) {
+    PciIo->Unmap (PciIo, Chain->DescMap);
+  }
+  if (Chain->Desc != NULL) {
+    PciIo->FreeBuffer (PciIo, Chain->DescPages, Chain->Desc);
+  }
+  FreePool (Chain);
+  Private->Adma3Chain = NULL;
+}
+
+/**
+  Hand the chained TRBs back to the one TRB at a time path. They are not
+  considered for ADMA3 again.
+
+  @param[in] Private        A pointer to the SD_MMC_HC_PRIVATE_DATA instance.
+
+**/
+VOID
+SdMmcFallbackAdma3Chain (
+  IN SD_MMC_HC_PRIVATE_DATA           *Private
+  )
+{
+  SD_MMC_HC_ADMA3_CHAIN               *Chain;
+  UINT32                              Index;
+
+  Chain = Private->Adma3Chain;
+  for (Index = 0; Index < Chain->TrbCount; Index++) {
+    Chain->Trb[Index]->Started       = FALSE;
+    Chain->Trb[Index]->Adma3Fallback = TRUE;
+  }
+  SdMmcFreeAdma3Chain (Private);
+}
+
+/**
+  Build the ADMA3 command and integrated descriptors for the chained TRBs.
+
+  The table starts with one integrated descriptor line per command, followed
+  by the four command descriptor lines and the ADMA2 descriptor lines of
+  each command.
+
+  @param[in] Private        A pointer to the SD_MMC_HC_PRIVATE_DATA instance.
+
+  @retval EFI_SUCCESS       The descriptors are built.
+  @retval Others            The descriptors could not be built.
+
+**/
+EFI_STATUS
+SdMmcBuildAdma3DescTable (
+  IN SD_MMC_HC_PRIVATE_DATA           *Private
+  )
+{
+  SD_MMC_HC_ADMA3_CHAIN               *Chain;
+  EFI_PCI_IO_PROTOCOL                 *PciIo;
+  SD_MMC_HC_TRB                       *Trb;
+  SD_MMC_HC_TRANSFER_MODE             Mode;
+  EFI_STATUS                          Status;
+  UINT32                              Cmds;
+  UINT32                              Index;
+  UINT32                              Lines;
+  UINT32                              AdmaLines;
+  UINTN                               LineSize;
+  UINTN                               TableSize;
+  UINTN                               Bytes;
+  UINT8                               *IdLine;
+  UINT8                               *Line;
+  UINT16                              Cmd;
+  UINT16                              TransMode;
+
+  Chain = Private->Adma3Chain;
+  PciIo = Private->PciIo;
+  Mode  = Chain->Trb[1]->Mode;
+  Cmds  = Chain->TrbCount / 2;
+
+  if (Mode == SdMmcAdma32bMode) {
+    LineSize = sizeof (SD_MMC_HC_ADMA3_32_DESC_LINE);
+  } else {
+    LineSize = sizeof (SD_MMC_HC_ADMA3_64_DESC_LINE);
+  }
+
+  Lines = Cmds;
+  for (Index = 1; Index < Chain->TrbCount; Index += 2) {
+    Lines += ADMA3_CMD_DESC_LINES + SdMmcGetAdmaDescLines (Chain->Trb[Index]);
+  }
+
+  TableSize        = Lines * LineSize;
+  Chain->DescPages = (UINT32)EFI_SIZE_TO_PAGES (TableSize);
+  Status = PciIo->AllocateBuffer (
+                    PciIo,
+                    AllocateAnyPages,
+                    EfiBootServicesData,
+                    Chain->DescPages,
+                    &Chain->Desc,
+                    0
+                    );
+  if (EFI_ERROR (Status)) {
+    Chain->Desc = NULL;
+    return EFI_OUT_OF_RESOURCES;
+  }
+  ZeroMem (Chain->Desc, TableSize);
+  Bytes  = TableSize;
+  Status = PciIo->Map (
+                    PciIo,
+                    EfiPciIoOperationBusMasterCommonBuffer,
+                    Chain->Desc,
+                    &Bytes,
+                    &Chain->DescPhy,
+                    &Chain->DescMap
+                    );
+  if (EFI_ERROR (Status) || (Bytes != TableSize)) {
+    if (!EFI_ERROR (Status)) {
+      PciIo->Unmap (PciIo, Chain->DescMap);
+    }
+    Chain->DescMap = NULL;
+    return EFI_OUT_OF_RESOURCES;
+  }
+  if ((Mode == SdMmcAdma32bMode) &&
+      ((Chain->DescPhy + TableSize) > 0x100000000ul)) {
+    //
+    // The 32-bit descriptors can't point above 4GB.
+    //
+    return EFI_DEVICE_ERROR;
+  }
+
+  IdLine = (UINT8 *)Chain->Desc;
+  Line   = IdLine + Cmds * LineSize;
+  for (Index = 1; Index < Chain->TrbCount; Index += 2) {
+    Trb = Chain->Trb[Index];
+
+    SdMmcSetAdma3DescLine (
+      IdLine,
+      Mode,
+      ADMA3_ACT_INTEGRATED,
+      (BOOLEAN)(Index == Chain->TrbCount - 1),
+      (BOOLEAN)(Index == Chain->TrbCount - 1),
+      Chain->DescPhy + (Line - (UINT8 *)Chain->Desc)
+      );
+    IdLine += LineSize;
+
+    //
+    // DMA enable, block count enable, Auto CMD23, multiple block,
+    // response error check and response interrupt disable.
+    //
+    TransMode = BIT0 | BIT1 | BIT3 | BIT5 | BIT6 | BIT7;
+    if (Trb->Read) {
+      TransMode |= BIT4;
+    }
+    //
+    // Data present, R1 response with CRC and index check.
+    //
+    Cmd = (UINT16)LShiftU64 (Trb->Packet->SdMmcCmdBlk->CommandIndex, 8);
+    Cmd |= BIT5 | BIT4 | BIT3 | BIT1;
+
+    //
+    // 32-bit block count, block size, argument, transfer mode and command.
+    //
+    SdMmcSetAdma3DescLine (Line, Mode, ADMA3_ACT_CMD, FALSE, FALSE, Trb->DataLen / Trb->BlockSize);
+    Line += LineSize;
+    SdMmcSetAdma3DescLine (Line, Mode, ADMA3_ACT_CMD, FALSE, FALSE, Trb->BlockSize);
+    Line += LineSize;
+    SdMmcSetAdma3DescLine (Line, Mode, ADMA3_ACT_CMD, FALSE, FALSE, Trb->Packet->SdMmcCmdBlk->CommandArgument);
+    Line += LineSize;
+    SdMmcSetAdma3DescLine (Line, Mode, ADMA3_ACT_CMD, TRUE, FALSE, TransMode | LShiftU64 (Cmd, 16));
+    Line += LineSize;
+
+    AdmaLines = SdMmcGetAdmaDescLines (Trb);
+    if (Mode == SdMmcAdma32bMode) {
+      CopyMem (Line, Trb->Adma32Desc, AdmaLines * sizeof (SD_MMC_HC_ADMA_32_DESC_LINE));
+    } else {
+      CopyMem (Line, Trb->Adma64V4Desc, AdmaLines * sizeof (SD_MMC_HC_ADMA_64_V4_DESC_LINE));
+    }
+    Line += AdmaLines * LineSize;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Chain the consecutive CMD23 and CMD18/CMD25 pairs at the head of the async
+  I/O queue into one ADMA3 submission and start it.
+
+  @param[in] Private        A pointer to the SD_MMC_HC_PRIVATE_DATA instance.
+
+  @retval EFI_SUCCESS       The submission is started.
+  @retval EFI_NOT_READY     The head can be chained but the slot is busy.
+  @retval EFI_UNSUPPORTED   The head can't be chained.
+  @retval Others            The submission could not be started.
+
+**/
+EFI_STATUS
+SdMmcStartAdma3Chain (
+  IN SD_MMC_HC_PRIVATE_DATA           *Private
+  )
+{
+  SD_MMC_HC_ADMA3_CHAIN               *Chain;
+  EFI_PCI_IO_PROTOCOL                 *PciIo;
+  LIST_ENTRY                          *Link;
+  LIST_ENTRY                          *Next;
+  SD_MMC_HC_TRB                       *SetBlkCntTrb;
+  SD_MMC_HC_TRB                       *DataTrb;
+  SD_MMC_HC_TRB                       *Trb[SD_MMC_HC_ADMA3_MAX_CMDS * 2];
+  UINT32                              TrbCount;
+  UINT8                               Slot;
+  EFI_STATUS                          Status;
+  UINT16                              IntStatus;
+  UINT8                               HostCtrl1;
+  UINT64                              IdAddr;
+  UINT32                              Index;
+
+  PciIo    = Private->PciIo;
+  TrbCount = 0;
+  Link     = GetFirstNode (&Private->Queue);
+  if (IsNull (&Private->Queue, Link)) {
+    return EFI_UNSUPPORTED;
+  }
+  SetBlkCntTrb = SD_MMC_HC_TRB_FROM_THIS (Link);
+  Slot         = SetBlkCntTrb->Slot;
+  if ((Private->ControllerVersion[Slot] < SD_MMC_HC_CTRL_VER_410) ||
+      (Private->Capability[Slot].Adma3 == 0) ||
+      (Private->Slot[Slot].CardType != EmmcCardType)) {
+    return EFI_UNSUPPORTED;
+  }
+
+  while (!IsNull (&Private->Queue, Link) && (TrbCount < SD_MMC_HC_ADMA3_MAX_CMDS * 2)) {
+    Next = GetNextNode (&Private->Queue, Link);
+    if (IsNull (&Private->Queue, Next)) {
+      break;
+    }
+    SetBlkCntTrb = SD_MMC_HC_TRB_FROM_THIS (Link);
+    DataTrb      = SD_MMC_HC_TRB_FROM_THIS (Next);
+    if ((SetBlkCntTrb->Slot != Slot) || (DataTrb->Slot != Slot) ||
+        !SdMmcIsAdma3SetBlkCntTrb (SetBlkCntTrb) ||
+        !SdMmcIsAdma3DataTrb (DataTrb, SetBlkCntTrb->Packet->SdMmcCmdBlk->CommandArgument) ||
+        ((TrbCount != 0) && (DataTrb->Mode != Trb[1]->Mode))) {
+      break;
+    }
+    Trb[TrbCount++] = SetBlkCntTrb;
+    Trb[TrbCount++] = DataTrb;
+    Link = GetNextNode (&Private->Queue, Next);
+  }
+  if (TrbCount == 0) {
+    return EFI_UNSUPPORTED;
+  }
+
+  //
+  // The data TRB checks both the CMD and the DAT line.
+  //
+  Status = SdMmcCheckTrbEnv (Private, Trb[1]);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Chain = AllocateZeroPool (sizeof (SD_MMC_HC_ADMA3_CHAIN));
+  if (Chain == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+  Chain->Slot         = Slot;
+  Chain->TrbCount     = TrbCount;
+  Chain->InfiniteWait = FALSE;
+  CopyMem (Chain->Trb, Trb, TrbCount * sizeof (SD_MMC_HC_TRB *));
+  for (Index = 1; Index < TrbCount; Index += 2) {
+    if (Trb[Index]->Packet->Timeout == 0) {
+      Chain->InfiniteWait = TRUE;
+    }
+    Chain->Timeout += Trb[Index]->Timeout;
+  }
+  Private->Adma3Chain = Chain;
+
+  Status = SdMmcBuildAdma3DescTable (Private);
+  if (EFI_ERROR (Status)) {
+    goto Error;
+  }
+
+  //
+  // Clear all bits in Error Interrupt Status Register and all bits in
+  // Normal Interrupt Status Register excepts for Card Removal & Card Insertion bits.
+  //
+  IntStatus = 0xFFFF;
+  Status    = SdMmcHcRwMmio (PciIo, Slot, SD_MMC_HC_ERR_INT_STS, FALSE, sizeof (IntStatus), &IntStatus);
+  if (EFI_ERROR (Status)) {
+    goto Error;
+  }
+  IntStatus = 0xFF3F;
+  Status    = SdMmcHcRwMmio (PciIo, Slot, SD_MMC_HC_NOR_INT_STS, FALSE, sizeof (IntStatus), &IntStatus);
+  if (EFI_ERROR (Status)) {
+    goto Error;
+  }
+
+  //
+  // In version 4 mode DMA Select 11b selects ADMA2 or ADMA3, the ADMA3
+  // engine is started by writing the integrated descriptor address.
+  //
+  HostCtrl1 = BIT4|BIT3;
+  Status = SdMmcHcOrMmio (PciIo, Slot, SD_MMC_HC_HOST_CTRL1, sizeof (HostCtrl1), &HostCtrl1);
+  if (EFI_ERROR (Status)) {
+    goto Error;
+  }
+
+  SdMmcHcLedOnOff (PciIo, Slot, TRUE);
+
+  for (Index = 0; Index < TrbCount; Index++) {
+    Trb[Index]->Started = TRUE;
+  }
+
+  IdAddr = Chain->DescPhy;
+  Status = SdMmcHcCheckMmioSet (PciIo, Slot, SD_MMC_HC_HOST_CTRL2, sizeof (UINT16),
+                                SD_MMC_HC_64_ADDR_EN, SD_MMC_HC_64_ADDR_EN);
+  if (!EFI_ERROR (Status)) {
+    Status = SdMmcHcRwMmio (PciIo, Slot, SD_MMC_HC_ADMA3_ID_ADDR, FALSE, sizeof (UINT64), &IdAddr);
+  } else {
+    Status = SdMmcHcRwMmio (PciIo, Slot, SD_MMC_HC_ADMA3_ID_ADDR, FALSE, sizeof (UINT32), &IdAddr);
+  }
+  if (EFI_ERROR (Status)) {
+    goto Error;
+  }
+
+  return EFI_SUCCESS;
+
+Error:
+  SdMmcFallbackAdma3Chain (Private);
+  return Status;
+}
+
+/**
+  Check whether the ADMA3 submission in flight has completed.
+
+  @param[in] Private        A pointer to the SD_MMC_HC_PRIVATE_DATA instance.
+
+  @retval EFI_SUCCESS       All chained commands completed.
+  @retval EFI_NOT_READY     The submission is still running.
+  @retval Others            The submission failed.
+
+**/
+EFI_STATUS
+SdMmcCheckAdma3ChainResult (
+  IN SD_MMC_HC_PRIVATE_DATA           *Private
+  )
+{
+  SD_MMC_HC_ADMA3_CHAIN               *Chain;
+  EFI_STATUS                          Status;
+  UINT16                              IntStatus;
+  UINT16                              Clear;
+
+  Chain  = Private->Adma3Chain;
+  Status = SdMmcHcRwMmio (
+             Private->PciIo,
+             Chain->Slot,
+             SD_MMC_HC_NOR_INT_STS,
+             TRUE,
+             sizeof (IntStatus),
+             &IntStatus
+             );
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Status = SdMmcCheckAndRecoverErrors (Private, Chain->Slot, IntStatus);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  //
+  // Transfer Complete is reported for every chained command, the DMA
+  // interrupt of the last integrated descriptor line marks the end.
+  //
+  Clear = IntStatus & (BIT0 | BIT1 | BIT3);
+  if (Clear != 0) {
+    Status = SdMmcHcRwMmio (
+               Private->PciIo,
+               Chain->Slot,
+               SD_MMC_HC_NOR_INT_STS,
+               FALSE,
+               sizeof (Clear),
+               &Clear
+               );
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+  }
+  if ((IntStatus & BIT3) != 0) {
+    Chain->DmaDone = TRUE;
+  }
+  if (Chain->DmaDone && ((IntStatus & BIT1) != 0)) {
+    return EFI_SUCCESS;
+  }
+
+  return EFI_NOT_READY;
+}
+
+/**
+  Start or poll the ADMA3 submission for the head of the async I/O queue.
+
+  @param[in] Private        A pointer to the SD_MMC_HC_PRIVATE_DATA instance.
+
+  @retval TRUE              The head of the queue is owned by an ADMA3
+                            submission and was handled for this tick.
+  @retval FALSE             The head of the queue is to be processed one
+                            TRB at a time.
+
+**/
+BOOLEAN
+SdMmcProcessAdma3Chain (
+  IN SD_MMC_HC_PRIVATE_DATA           *Private
+  )
+{
+  SD_MMC_HC_ADMA3_CHAIN               *Chain;
+  SD_MMC_HC_TRB                       *Trb;
+  EFI_EVENT                           TrbEvent;
+  EFI_STATUS                          Status;
+  UINT32                              Index;
+
+  if (!FeaturePcdGet (PcdSdMmcAdma3Support)) {
+    return FALSE;
+  }
+
+  if (Private->Adma3Chain == NULL) {
+    //
+    // When the slot is busy the head TRB is left to the normal path, which
+    // accounts its timeout.
+    //
+    Status = SdMmcStartAdma3Chain (Private);
+    if (EFI_ERROR (Status)) {
+      return FALSE;
+    }
+  }
+
+  Chain = Private->Adma3Chain;
+  if (!Private->Slot[Chain->Slot].MediaPresent) {
+    SdMmcAbortAdma3Chain (Private);
+    return FALSE;
+  }
+
+  Status = SdMmcCheckAdma3ChainResult (Private);
+  if (Status == EFI_NOT_READY) {
+    if (Chain->InfiniteWait || (Chain->Timeout-- != 0)) {
+      return TRUE;
+    }
+    DEBUG ((DEBUG_ERROR, "SdMmcProcessAdma3Chain: ADMA3 submission timed out\n"));
+    SdMmcAbortAdma3Chain (Private);
+    return FALSE;
+  }
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "SdMmcProcessAdma3Chain: ADMA3 submission failed with %r\n", Status));
+    SdMmcFallbackAdma3Chain (Private);
+    return FALSE;
+  }
+
+  SdMmcGetResponse (Private, Chain->Trb[Chain->TrbCount - 1]);
+  for (Index = 0; Index < Chain->TrbCount; Index++) {
+    Trb = Chain->Trb[Index];
+    RemoveEntryList (&Trb->TrbList);
+    Trb->Packet->TransactionStatus = EFI_SUCCESS;
+    TrbEvent = Trb->Event;
+    SdMmcFreeTrb (Trb);
+    DEBUG ((DEBUG_VERBOSE, "SdMmcProcessAdma3Chain(): Signal Event %p with %r\n", TrbEvent, EFI_SUCCESS));
+    gBS->SignalEvent (TrbEvent);
+  }
+  SdMmcHcLedOnOff (Private->PciIo, Chain->Slot, FALSE);
+  SdMmcFreeAdma3Chain (Private);
+
+  return TRUE;
+}
+
+/**
+  Stop the ADMA3 submission in flight, if any, and release its descriptors.
+  The chained TRBs are left in the async I/O queue for the caller.
+
+  @param[in] Private        A pointer to the SD_MMC_HC_PRIVATE_DATA instance.
+
+**/
+VOID
+SdMmcAbortAdma3Chain (
+  IN SD_MMC_HC_PRIVATE_DATA           *Private
+  )
+{
+  if (Private->Adma3Chain == NULL) {
+    return;
+  }
+
+  //
+  // Reset the CMD and DAT lines as for a command and a data timeout.
+  //
+  SdMmcSoftwareReset (Private, Private->Adma3Chain->Slot, BIT0 | BIT4);
+  SdMmcFallbackAdma3Chain (Private);
+}
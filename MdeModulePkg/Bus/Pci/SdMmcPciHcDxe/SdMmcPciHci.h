@@ -53,6 +53,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #define SD_MMC_HC_ADMA_ERR_STS        0x54
 #define SD_MMC_HC_ADMA_SYS_ADDR       0x58
 #define SD_MMC_HC_PRESET_VAL          0x60
+#define SD_MMC_HC_ADMA3_ID_ADDR       0x78
 #define SD_MMC_HC_SHARED_BUS_CTRL     0xE0
 #define SD_MMC_HC_SLOT_INT_STS        0xFC
 #define SD_MMC_HC_CTRL_VER            0xFE
@@ -142,6 +143,40 @@ typedef struct {
   UINT32 Reserved1;
 } SD_MMC_HC_ADMA_64_V4_DESC_LINE;
 
+//
+// ADMA3 descriptor lines, refer to SD Host Controller Simplified spec 4.2
+// Section 1.13.5. Command descriptors and integrated descriptors have the
+// same line width as the ADMA2 descriptors they are chained with.
+//
+#define ADMA3_ACT_CMD                  1
+#define ADMA3_ACT_INTEGRATED           7
+
+//
+// Number of command descriptor lines: 32-bit block count, block size and
+// 16-bit block count, argument, transfer mode and command.
+//
+#define ADMA3_CMD_DESC_LINES           4
+
+typedef struct {
+  UINT32 Valid:1;
+  UINT32 End:1;
+  UINT32 Int:1;
+  UINT32 Act:3;
+  UINT32 Reserved:26;
+  UINT32 Data;
+} SD_MMC_HC_ADMA3_32_DESC_LINE;
+
+typedef struct {
+  UINT32 Valid:1;
+  UINT32 End:1;
+  UINT32 Int:1;
+  UINT32 Act:3;
+  UINT32 Reserved:26;
+  UINT32 LowerData;
+  UINT32 UpperData;
+  UINT32 Reserved1;
+} SD_MMC_HC_ADMA3_64_DESC_LINE;
+
 #define SD_MMC_SDMA_BOUNDARY          512 * 1024
 #define SD_MMC_SDMA_ROUND_UP(x, n)    (((x) + n) & ~(n - 1))
 
@@ -184,7 +219,9 @@ typedef struct {
   UINT32   TuningSDR50:1;     // bit 45
   UINT32   RetuningMod:2;     // bit 46:47
   UINT32   ClkMultiplier:8;   // bit 48:55
-  UINT32   Reserved5:7;       // bit 56:62
+  UINT32   Reserved5:3;       // bit 56:58
+  UINT32   Adma3:1;           // bit 59
+  UINT32   Reserved6:3;       // bit 60:62
   UINT32   Hs400:1;           // bit 63
 } SD_MMC_HC_SLOT_CAP;
 
@@ -228,6 +228,7 @@ XhcCreateTransferTrb (
   UINTN                         TotalLen;
   UINTN                         Len;
   UINTN                         TrbNum;
+  UINTN                         TdSize;
   EFI_PCI_IO_PROTOCOL_OPERATION MapOp;
   EFI_PHYSICAL_ADDRESS          PhyAddr;
   VOID                          *Map;
@@ -372,25 +373,38 @@ XhcCreateTransferTrb (
 
     case ED_BULK_OUT:
     case ED_BULK_IN:
+      //
+      // Describe the whole bulk transfer as one scatter-gather TD: the TRBs are
+      // chained, split at 64KB boundaries of the data buffer, and only the last
+      // one interrupts on completion. A short packet ends the TD early and is
+      // still reported thanks to ISP.
+      //
       TotalLen = 0;
       Len      = 0;
       TrbNum   = 0;
       TrbStart = (TRB *)(UINTN)EPRing->RingEnqueue;
       while (TotalLen < Urb->DataLen) {
-        if ((TotalLen + 0x10000) >= Urb->DataLen) {
-          Len = Urb->DataLen - TotalLen;
-        } else {
-          Len = 0x10000;
+        PhyAddr = (EFI_PHYSICAL_ADDRESS)(UINTN) ((UINT8 *) Urb->DataPhy + TotalLen);
+        Len     = XHC_TRB_BUFFER_BOUNDARY - (UINTN) (PhyAddr & (XHC_TRB_BUFFER_BOUNDARY - 1));
+        Len     = MIN (Len, Urb->DataLen - TotalLen);
+        TdSize  = 0;
+        if (Urb->Ep.MaxPacket != 0) {
+          TdSize = (Urb->DataLen - TotalLen - Len + Urb->Ep.MaxPacket - 1) / Urb->Ep.MaxPacket;
         }
+
         TrbStart = (TRB *)(UINTN)EPRing->RingEnqueue;
-        TrbStart->TrbNormal.TRBPtrLo  = XHC_LOW_32BIT((UINT8 *) Urb->DataPhy + TotalLen);
-        TrbStart->TrbNormal.TRBPtrHi  = XHC_HIGH_32BIT((UINT8 *) Urb->DataPhy + TotalLen);
+        TrbStart->TrbNormal.TRBPtrLo  = XHC_LOW_32BIT(PhyAddr);
+        TrbStart->TrbNormal.TRBPtrHi  = XHC_HIGH_32BIT(PhyAddr);
         TrbStart->TrbNormal.Length    = (UINT32) Len;
-        TrbStart->TrbNormal.TDSize    = 0;
+        TrbStart->TrbNormal.TDSize    = (UINT32) MIN (TdSize, XHC_TRB_MAX_TD_SIZE);
         TrbStart->TrbNormal.IntTarget = 0;
         TrbStart->TrbNormal.ISP       = 1;
-        TrbStart->TrbNormal.IOC       = 1;
         TrbStart->TrbNormal.Type      = TRB_TYPE_NORMAL;
+        if (TotalLen + Len < Urb->DataLen) {
+          TrbStart->TrbNormal.CH      = 1;
+        } else {
+          TrbStart->TrbNormal.IOC     = 1;
+        }
         //
         // Update the cycle bit
         //
@@ -1091,11 +1105,13 @@ XhcCheckUrbResult (
   UINT32                  High;
   UINT32                  Low;
   EFI_PHYSICAL_ADDRESS    PhyAddr;
+  TRB_TEMPLATE            *EvtDequeue;
 
   ASSERT ((Xhc != NULL) && (Urb != NULL));
 
-  Status   = EFI_SUCCESS;
-  AsyncUrb = NULL;
+  Status     = EFI_SUCCESS;
+  AsyncUrb   = NULL;
+  EvtDequeue = Xhc->EventRing.EventRingDequeue;
 
   if (Urb->Finished) {
     goto EXIT;
@@ -1192,6 +1208,21 @@ XhcCheckUrbResult (
         }
 
         TRBType = (UINT8) (TRBPtr->Type);
+        if (CheckedUrb->Ep.Type == XHC_BULK_TRANSFER) {
+          //
+          // A bulk URB is a single chained TD which reports only its last TRB,
+          // or the TRB hitting a short packet. The data before that TRB is done,
+          // and the TD ends there.
+          //
+          PhyAddr = (EFI_PHYSICAL_ADDRESS)(((TRANSFER_TRB_NORMAL*)TRBPtr)->TRBPtrLo |
+                                           LShiftU64 ((UINT64) ((TRANSFER_TRB_NORMAL*)TRBPtr)->TRBPtrHi, 32));
+          CheckedUrb->Completed = (UINTN) (PhyAddr - (EFI_PHYSICAL_ADDRESS)(UINTN) CheckedUrb->DataPhy) +
+                                  (((TRANSFER_TRB_NORMAL*)TRBPtr)->Length - EvtTrb->Length);
+          CheckedUrb->Finished  = TRUE;
+          CheckedUrb->EvtTrb    = (TRB_TEMPLATE *)EvtTrb;
+          continue;
+        }
+
         if ((TRBType == TRB_TYPE_DATA_STAGE) ||
             (TRBType == TRB_TYPE_NORMAL) ||
             (TRBType == TRB_TYPE_ISOCH)) {
@@ -1226,6 +1257,14 @@ XhcCheckUrbResult (
 
 EXIT:
 
+  //
+  // Nothing to tell the controller if no event was consumed. This keeps the
+  // register accesses out of the polling loop of a pending transfer.
+  //
+  if (Xhc->EventRing.EventRingDequeue == EvtDequeue) {
+    return Urb->Finished;
+  }
+
   //
   // Advance event ring to last available entry
   //
@@ -1969,6 +2008,10 @@ XhcSyncTrsRing (
     if ((UINT8) TrsTrb->Type == TRB_TYPE_LINK) {
       ASSERT (((LINK_TRB*)TrsTrb)->TC != 0);
       //
+      // A Link TRB inside a TD shall carry the chain bit of the TRB before it.
+      //
+      ((LINK_TRB*)TrsTrb)->CH = ((TRANSFER_TRB_NORMAL*)(TrsTrb - 1))->CH;
+      //
       // set cycle bit in Link TRB as normal
       //
       ((LINK_TRB*)TrsTrb)->CycleBit = TrsRing->RingPCS & BIT0;
@@ -22,6 +22,13 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #define XHC_INT_TRANSFER_ASYNC                0x08
 #define XHC_INT_ONLY_TRANSFER_ASYNC           0x10
 
+//
+// The data buffer of a transfer TRB shall not span a 64KB boundary [XHCI-4.11.7.1].
+// The TD Size field saturates at 31 packets [XHCI-4.11.2.4].
+//
+#define XHC_TRB_BUFFER_BOUNDARY               SIZE_64KB
+#define XHC_TRB_MAX_TD_SIZE                   31
+
 //
 // 6.4.6 TRB Types
 //
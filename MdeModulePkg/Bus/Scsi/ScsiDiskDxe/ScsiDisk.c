@@ -1485,18 +1485,30 @@ ScsiDiskUnmap (
   VOID                             *UnmapParamList;
   EFI_EVENT                        AsyncUnmapEvent;
   EFI_TPL                          OldTpl;
+  UINT64                           MaxBlocksPerCommand;
 
   ScsiIo          = ScsiDiskDevice->ScsiIo;
   MaxLbaCnt       = ScsiDiskDevice->UnmapInfo.MaxLbaCnt;
-  MaxBlkDespCnt   = ScsiDiskDevice->UnmapInfo.MaxBlkDespCnt;
+  MaxBlkDespCnt   = MIN (ScsiDiskDevice->UnmapInfo.MaxBlkDespCnt, SCSI_DISK_UNMAP_MAX_BLOCK_DESCRIPTORS);
   EraseBlkReq     = NULL;
   UnmapParamList  = NULL;
   AsyncUnmapEvent = NULL;
   ReturnStatus    = EFI_SUCCESS;
 
-  if (Blocks / (UINTN) MaxLbaCnt > MaxBlkDespCnt) {
-    ReturnStatus = EFI_DEVICE_ERROR;
-    goto Done;
+  //
+  // A range that does not fit in the block descriptors of one UNMAP command is
+  // split into several commands, each carrying as many descriptors as the
+  // device accepts. The leading commands are blocking, only the last one is
+  // associated with Token.
+  //
+  MaxBlocksPerCommand = MultU64x32 (MaxLbaCnt, MaxBlkDespCnt);
+  while ((UINT64) Blocks > MaxBlocksPerCommand) {
+    Status = ScsiDiskUnmap (ScsiDiskDevice, Lba, (UINTN) MaxBlocksPerCommand, NULL);
+    if (EFI_ERROR (Status)) {
+      return EFI_DEVICE_ERROR;
+    }
+    Lba    += MaxBlocksPerCommand;
+    Blocks -= (UINTN) MaxBlocksPerCommand;
   }
 
   EraseBlkReq = AllocateZeroPool (sizeof (SCSI_ERASEBLK_REQUEST));
@@ -2457,6 +2469,8 @@ ScsiDiskInquiryDevice (
   EFI_SCSI_SUPPORTED_VPD_PAGES_VPD_PAGE *SupportedVpdPages;
   EFI_SCSI_BLOCK_LIMITS_VPD_PAGE        *BlockLimits;
   UINTN                                 PageLength;
+  UINT32                                MaxTransferLength;
+  UINT32                                OptimalTransferLength;
 
   InquiryDataLength = sizeof (EFI_SCSI_INQUIRY_DATA);
   SenseDataLength   = 0;
@@ -2578,6 +2592,26 @@ ScsiDiskInquiryDevice (
               (BlockLimits->OptimalTransferLengthGranularity2 << 8) |
                BlockLimits->OptimalTransferLengthGranularity1;
 
+            //
+            // Transfers are split at the optimal transfer length, as larger
+            // ones may be slower, and must not exceed the maximum one.
+            //
+            MaxTransferLength =
+              (BlockLimits->MaximumTransferLength4 << 24) |
+              (BlockLimits->MaximumTransferLength3 << 16) |
+              (BlockLimits->MaximumTransferLength2 << 8)  |
+              BlockLimits->MaximumTransferLength1;
+            OptimalTransferLength =
+              (BlockLimits->OptimalTransferLength4 << 24) |
+              (BlockLimits->OptimalTransferLength3 << 16) |
+              (BlockLimits->OptimalTransferLength2 << 8)  |
+              BlockLimits->OptimalTransferLength1;
+            if ((OptimalTransferLength != 0) &&
+                ((MaxTransferLength == 0) || (OptimalTransferLength < MaxTransferLength))) {
+              MaxTransferLength = OptimalTransferLength;
+            }
+            ScsiDiskDevice->MaxTransferBlocks = MaxTransferLength;
+
             ScsiDiskDevice->UnmapInfo.MaxLbaCnt =
               (BlockLimits->MaximumUnmapLbaCount4 << 24) |
               (BlockLimits->MaximumUnmapLbaCount3 << 16) |
@@ -3348,6 +3382,90 @@ ParseInquiryData (
   ScsiDiskDevice->BlkIoMedia.RemovableMedia = (BOOLEAN) (!ScsiDiskDevice->FixedDevice);
 }
 
+/**
+  Get the number of blocks a single Read/Write command may transfer.
+
+  @param  ScsiDiskDevice  The pointer of SCSI_DISK_DEV.
+
+  @return The maximum number of blocks per command.
+
+**/
+UINT32
+ScsiDiskGetMaxTransferBlocks (
+  IN   SCSI_DISK_DEV     *ScsiDiskDevice
+  )
+{
+  UINT32              MaxBlock;
+
+  if (!ScsiDiskDevice->Cdb16Byte) {
+    MaxBlock         = 0xFFFF;
+  } else {
+    MaxBlock         = 0xFFFFFFFF;
+  }
+
+  if ((ScsiDiskDevice->MaxTransferBlocks != 0) &&
+      (ScsiDiskDevice->MaxTransferBlocks < MaxBlock)) {
+    MaxBlock = ScsiDiskDevice->MaxTransferBlocks;
+  }
+
+  return MaxBlock;
+}
+
+/**
+  Read sector from SCSI Disk, keeping all the Read commands in flight at once.
+
+  The transfer is submitted through the non-blocking path and the function
+  waits for it to complete. If the SCSI bus does not support non-blocking I/O,
+  every command completes before the next one is submitted.
+
+  @param  ScsiDiskDevice  The pointer of SCSI_DISK_DEV.
+  @param  Buffer          The buffer to fill in the read out data.
+  @param  Lba             Logic block address.
+  @param  NumberOfBlocks  The number of blocks to read.
+
+  @retval EFI_DEVICE_ERROR  Indicates a device error.
+  @retval EFI_SUCCESS       Operation is successful.
+
+**/
+EFI_STATUS
+ScsiDiskPipelinedReadSectors (
+  IN   SCSI_DISK_DEV     *ScsiDiskDevice,
+  OUT  VOID              *Buffer,
+  IN   EFI_LBA           Lba,
+  IN   UINTN             NumberOfBlocks
+  )
+{
+  EFI_BLOCK_IO2_TOKEN Token;
+  EFI_STATUS          Status;
+
+  Status = gBS->CreateEvent (0, TPL_NOTIFY, NULL, NULL, &Token.Event);
+  if (EFI_ERROR (Status)) {
+    return EFI_DEVICE_ERROR;
+  }
+
+  Token.TransactionStatus = EFI_SUCCESS;
+  Status = ScsiDiskAsyncReadSectors (
+             ScsiDiskDevice,
+             Buffer,
+             Lba,
+             NumberOfBlocks,
+             &Token
+             );
+  if (!EFI_ERROR (Status)) {
+    //
+    // The Read commands complete in the notification functions of their events,
+    // the last one signals the token event.
+    //
+    while (gBS->CheckEvent (Token.Event) == EFI_NOT_READY) {
+    }
+    Status = Token.TransactionStatus;
+  }
+
+  gBS->CloseEvent (Token.Event);
+
+  return EFI_ERROR (Status) ? EFI_DEVICE_ERROR : EFI_SUCCESS;
+}
+
 /**
   Read sector from SCSI Disk.
 
@@ -3389,10 +3507,19 @@ ScsiDiskReadSectors (
   //
   // limit the data bytes that can be transferred by one Read(10) or Read(16) Command
   //
-  if (!ScsiDiskDevice->Cdb16Byte) {
-    MaxBlock         = 0xFFFF;
-  } else {
-    MaxBlock         = 0xFFFFFFFF;
+  MaxBlock = ScsiDiskGetMaxTransferBlocks (ScsiDiskDevice);
+
+  //
+  // A transfer that needs several Read commands is first tried with all of
+  // them in flight at once. If that fails, the commands are retried one after
+  // another, lowering the transfer length as needed.
+  //
+  if (NumberOfBlocks > MaxBlock) {
+    Status = ScsiDiskPipelinedReadSectors (ScsiDiskDevice, Buffer, Lba, NumberOfBlocks);
+    if (!EFI_ERROR (Status)) {
+      return EFI_SUCCESS;
+    }
+    DEBUG ((DEBUG_WARN, "ScsiDiskReadSectors: pipelined read failed, retrying sequentially\n"));
   }
 
   PtrBuffer = Buffer;
@@ -3554,11 +3681,7 @@ ScsiDiskWriteSectors (
   //
   // limit the data bytes that can be transferred by one Read(10) or Read(16) Command
   //
-  if (!ScsiDiskDevice->Cdb16Byte) {
-    MaxBlock         = 0xFFFF;
-  } else {
-    MaxBlock         = 0xFFFFFFFF;
-  }
+  MaxBlock = ScsiDiskGetMaxTransferBlocks (ScsiDiskDevice);
 
   PtrBuffer = Buffer;
 
@@ -3737,11 +3860,7 @@ ScsiDiskAsyncReadSectors (
   // Limit the data bytes that can be transferred by one Read(10) or Read(16)
   // Command
   //
-  if (!ScsiDiskDevice->Cdb16Byte) {
-    MaxBlock         = 0xFFFF;
-  } else {
-    MaxBlock         = 0xFFFFFFFF;
-  }
+  MaxBlock = ScsiDiskGetMaxTransferBlocks (ScsiDiskDevice);
 
   PtrBuffer = Buffer;
 
@@ -3856,8 +3975,10 @@ ScsiDiskAsyncReadSectors (
         //
         // There are previous SCSI commands still running, EFI_SUCCESS should
         // be returned to make sure that the caller does not free resources
-        // still using by these SCSI commands.
+        // still using by these SCSI commands. The blocks that could not be
+        // submitted are reported through the token.
         //
+        Token->TransactionStatus = EFI_DEVICE_ERROR;
         Status = EFI_SUCCESS;
         goto Done;
       }
@@ -3954,11 +4075,7 @@ ScsiDiskAsyncWriteSectors (
   // Limit the data bytes that can be transferred by one Read(10) or Read(16)
   // Command
   //
-  if (!ScsiDiskDevice->Cdb16Byte) {
-    MaxBlock         = 0xFFFF;
-  } else {
-    MaxBlock         = 0xFFFFFFFF;
-  }
+  MaxBlock = ScsiDiskGetMaxTransferBlocks (ScsiDiskDevice);
 
   PtrBuffer = Buffer;
 
@@ -4073,8 +4190,10 @@ ScsiDiskAsyncWriteSectors (
         //
         // There are previous SCSI commands still running, EFI_SUCCESS should
         // be returned to make sure that the caller does not free resources
-        // still using by these SCSI commands.
+        // still using by these SCSI commands. The blocks that could not be
+        // submitted are reported through the token.
         //
+        Token->TransactionStatus = EFI_DEVICE_ERROR;
         Status = EFI_SUCCESS;
         goto Done;
       }
@@ -43,6 +43,13 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #define UFS_WLUN_RPMB 0xC4
 
+//
+// The UNMAP parameter list length is a 16-bit field, which limits the number
+// of block descriptors a single UNMAP command can carry.
+//
+#define SCSI_DISK_UNMAP_MAX_BLOCK_DESCRIPTORS \
+  ((MAX_UINT16 - sizeof (EFI_SCSI_DISK_UNMAP_PARAM_LIST_HEADER)) / sizeof (EFI_SCSI_DISK_UNMAP_BLOCK_DESP))
+
 typedef struct {
   UINT32                    MaxLbaCnt;
   UINT32                    MaxBlkDespCnt;
@@ -88,6 +95,12 @@ typedef struct {
   SCSI_UNMAP_PARAM_INFO     UnmapInfo;
   BOOLEAN                   BlockLimitsVpdSupported;
 
+  //
+  // The number of blocks a single Read/Write command transfers at most, as
+  // reported by the Block Limits VPD page. 0 means not reported.
+  //
+  UINT32                    MaxTransferBlocks;
+
   //
   // The flag indicates if 16-byte command can be used
   //
@@ -1098,6 +1111,43 @@ ScsiDiskWriteSectors (
   IN  UINTN             NumberOfBlocks
   );
 
+/**
+  Get the number of blocks a single Read/Write command may transfer.
+
+  @param  ScsiDiskDevice  The pointer of SCSI_DISK_DEV.
+
+  @return The maximum number of blocks per command.
+
+**/
+UINT32
+ScsiDiskGetMaxTransferBlocks (
+  IN   SCSI_DISK_DEV     *ScsiDiskDevice
+  );
+
+/**
+  Read sector from SCSI Disk, keeping all the Read commands in flight at once.
+
+  The transfer is submitted through the non-blocking path and the function
+  waits for it to complete. If the SCSI bus does not support non-blocking I/O,
+  every command completes before the next one is submitted.
+
+  @param  ScsiDiskDevice  The pointer of SCSI_DISK_DEV.
+  @param  Buffer          The buffer to fill in the read out data.
+  @param  Lba             Logic block address.
+  @param  NumberOfBlocks  The number of blocks to read.
+
+  @retval EFI_DEVICE_ERROR  Indicates a device error.
+  @retval EFI_SUCCESS       Operation is successful.
+
+**/
+EFI_STATUS
+ScsiDiskPipelinedReadSectors (
+  IN   SCSI_DISK_DEV     *ScsiDiskDevice,
+  OUT  VOID              *Buffer,
+  IN   EFI_LBA           Lba,
+  IN   UINTN             NumberOfBlocks
+  );
+
 /**
   Asynchronously read sector from SCSI Disk.
 
@@ -24,6 +24,7 @@ AsyncIoCallback (
   )
 {
   EMMC_REQUEST                *Request;
+  EMMC_PARTITION              *Partition;
   EFI_STATUS                  Status;
 
   Status = gBS->CloseEvent (Event);
@@ -31,7 +32,8 @@ AsyncIoCallback (
     return;
   }
 
-  Request = (EMMC_REQUEST *) Context;
+  Request   = (EMMC_REQUEST *) Context;
+  Partition = Request->Partition;
 
   DEBUG_CODE_BEGIN ();
     DEBUG ((EFI_D_INFO, "Emmc Async Request: CmdIndex[%d] Arg[%08x] %r\n",
@@ -50,6 +52,13 @@ AsyncIoCallback (
   }
 
   FreePool (Request);
+
+  //
+  // The partition went idle, send out the writes held back meanwhile.
+  //
+  if (IsListEmpty (&Partition->Queue)) {
+    EmmcFlushPackedWrites (Partition);
+  }
 }
 
 /**
@@ -333,6 +342,7 @@ EmmcSetExtCsd (
   }
 
   SetExtCsdReq->Signature = EMMC_REQUEST_SIGNATURE;
+  SetExtCsdReq->Partition = Partition;
   OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
   InsertTailList (&Partition->Queue, &SetExtCsdReq->Link);
   gBS->RestoreTPL (OldTpl);
@@ -403,7 +413,8 @@ Error:
   Set the number of blocks for a block read/write cmd through sync or async I/O request.
 
   @param[in]  Partition         A pointer to the EMMC_PARTITION instance.
-  @param[in]  BlockNum          The number of blocks for transfer.
+  @param[in]  BlockNum          The number of blocks for transfer, optionally ORed with
+                                EMMC_PACKED_CMD for a packed write command.
   @param[in]  Token             A pointer to the token associated with the transaction.
   @param[in]  IsEnd             A boolean to show whether it's the last cmd in a series of cmds.
                                 This parameter is only meaningful in async I/O request.
@@ -416,7 +427,7 @@ Error:
 EFI_STATUS
 EmmcSetBlkCount (
   IN  EMMC_PARTITION            *Partition,
-  IN  UINT16                    BlockNum,
+  IN  UINT32                    BlockNum,
   IN  EFI_BLOCK_IO2_TOKEN       *Token,
   IN  BOOLEAN                   IsEnd
   )
@@ -439,6 +450,7 @@ EmmcSetBlkCount (
   }
 
   SetBlkCntReq->Signature = EMMC_REQUEST_SIGNATURE;
+  SetBlkCntReq->Partition = Partition;
   OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
   InsertTailList (&Partition->Queue, &SetBlkCntReq->Link);
   gBS->RestoreTPL (OldTpl);
@@ -556,6 +568,7 @@ EmmcProtocolInOut (
   }
 
   ProtocolReq->Signature = EMMC_REQUEST_SIGNATURE;
+  ProtocolReq->Partition = Partition;
   OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
   InsertTailList (&Partition->Queue, &ProtocolReq->Link);
   gBS->RestoreTPL (OldTpl);
@@ -682,6 +695,7 @@ EmmcRwMultiBlocks (
   }
 
   RwMultiBlkReq->Signature = EMMC_REQUEST_SIGNATURE;
+  RwMultiBlkReq->Partition = Partition;
   OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
   InsertTailList (&Partition->Queue, &RwMultiBlkReq->Link);
   gBS->RestoreTPL (OldTpl);
@@ -768,6 +782,298 @@ Error:
   return Status;
 }
 
+/**
+  Nonblocking I/O callback function of a packed write command. Complete the
+  tokens of all the writes it carried.
+
+  @param[in]  Event     The Event this notify function registered to.
+  @param[in]  Context   Pointer to the EMMC_PACKED_WRITE instance.
+
+**/
+VOID
+EFIAPI
+EmmcPackedWriteCallback (
+  IN EFI_EVENT                Event,
+  IN VOID                     *Context
+  )
+{
+  EMMC_PACKED_WRITE           *Packed;
+  EMMC_PACKED_ENTRY           *Entry;
+  LIST_ENTRY                  *Link;
+
+  if (Event != NULL) {
+    gBS->CloseEvent (Event);
+  }
+
+  Packed = (EMMC_PACKED_WRITE *) Context;
+
+  DEBUG ((DEBUG_BLKIO, "EmmcPackedWrite(): %r\n", Packed->Token.TransactionStatus));
+
+  while (!IsListEmpty (&Packed->Entries)) {
+    Link  = GetFirstNode (&Packed->Entries);
+    Entry = EMMC_PACKED_ENTRY_FROM_LINK (Link);
+    RemoveEntryList (Link);
+
+    Entry->Token->TransactionStatus = Packed->Token.TransactionStatus;
+    gBS->SignalEvent (Entry->Token->Event);
+    FreePool (Entry);
+  }
+
+  if (Packed->Buffer != NULL) {
+    FreePool (Packed->Buffer);
+  }
+  FreePool (Packed);
+}
+
+/**
+  Hold back an asynchronous write so that it can be sent together with other
+  writes in one packed write command.
+
+  A write is only held back while the partition still has requests in flight,
+  and AsyncIoCallback() flushes the held writes once the partition goes idle,
+  so no write waits longer than the requests already queued ahead of it.
+
+  @param[in]  Partition         A pointer to the EMMC_PARTITION instance.
+  @param[in]  Lba               The starting logical block address to be written.
+  @param[in]  Buffer            A pointer to the source buffer for the data.
+  @param[in]  BufferSize        Size of Buffer, must be a multiple of device block size.
+  @param[in]  Token             A pointer to the token associated with the transaction.
+
+  @retval TRUE                  The write was held back and Token will be signaled
+                                once the packed write command completes.
+  @retval FALSE                 The write must be sent on its own.
+
+**/
+BOOLEAN
+EmmcQueuePackedWrite (
+  IN  EMMC_PARTITION            *Partition,
+  IN  EFI_LBA                   Lba,
+  IN  VOID                      *Buffer,
+  IN  UINTN                     BufferSize,
+  IN  EFI_BLOCK_IO2_TOKEN       *Token
+  )
+{
+  EMMC_DEVICE                   *Device;
+  EMMC_PACKED_ENTRY             *Entry;
+  UINTN                         BlockSize;
+  UINTN                         BlockNum;
+  UINT32                        MaxEntries;
+  BOOLEAN                       Full;
+  EFI_TPL                       OldTpl;
+
+  if ((Token == NULL) || (Token->Event == NULL)) {
+    return FALSE;
+  }
+
+  Device    = Partition->Device;
+  BlockSize = Partition->BlockMedia.BlockSize;
+  BlockNum  = BufferSize / BlockSize;
+
+  //
+  // The header block limits the number of entries as well.
+  //
+  MaxEntries = MIN (Device->ExtCsd.MaxPackedWrites, (UINT32)(BlockSize / 8) - 1);
+  if ((MaxEntries < 2) || (BlockNum > EMMC_PACKED_MAX_ENTRY_BLOCKS)) {
+    return FALSE;
+  }
+
+  if ((Device->ExtCsd.PartitionConfig & 0x7) != Partition->PartitionType) {
+    return FALSE;
+  }
+
+  Entry = AllocateZeroPool (sizeof (EMMC_PACKED_ENTRY));
+  if (Entry == NULL) {
+    return FALSE;
+  }
+
+  Entry->Signature  = EMMC_PACKED_ENTRY_SIGNATURE;
+  Entry->Lba        = Lba;
+  Entry->Buffer     = Buffer;
+  Entry->BufferSize = BufferSize;
+  Entry->Token      = Token;
+
+  OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+  if (IsListEmpty (&Partition->Queue) ||
+      (Partition->PackedBlocks + BlockNum > EMMC_PACKED_MAX_BLOCKS)) {
+    gBS->RestoreTPL (OldTpl);
+    FreePool (Entry);
+    return FALSE;
+  }
+
+  InsertTailList (&Partition->PackedQueue, &Entry->Link);
+  Partition->PackedCount++;
+  Partition->PackedBlocks += BlockNum;
+  Full = (BOOLEAN)(Partition->PackedCount >= MaxEntries);
+  gBS->RestoreTPL (OldTpl);
+
+  if (Full) {
+    EmmcFlushPackedWrites (Partition);
+  }
+
+  return TRUE;
+}
+
+/**
+  Send the writes held back on a partition as one packed write command.
+
+  Refer to EMMC Electrical Standard Spec 5.1 Section 6.6.29 for details.
+
+  @param[in]  Partition         A pointer to the EMMC_PARTITION instance.
+
+**/
+VOID
+EmmcFlushPackedWrites (
+  IN  EMMC_PARTITION            *Partition
+  )
+{
+  EFI_STATUS                    Status;
+  EMMC_PACKED_WRITE             *Packed;
+  EMMC_PACKED_ENTRY             *Entry;
+  EMMC_PACKED_ENTRY             *First;
+  LIST_ENTRY                    *Link;
+  UINT32                        *Header;
+  UINT8                         *Data;
+  UINTN                         BlockSize;
+  UINTN                         BlockNum;
+  UINT32                        Count;
+  UINT32                        Index;
+  EFI_TPL                       OldTpl;
+
+  if (IsListEmpty (&Partition->PackedQueue)) {
+    return;
+  }
+
+  Packed = AllocateZeroPool (sizeof (EMMC_PACKED_WRITE));
+  if (Packed == NULL) {
+    return;
+  }
+
+  OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+  if (IsListEmpty (&Partition->PackedQueue)) {
+    gBS->RestoreTPL (OldTpl);
+    FreePool (Packed);
+    return;
+  }
+
+  //
+  // Take over the held writes; new ones may be held back again meanwhile.
+  //
+  InitializeListHead (&Packed->Entries);
+  while (!IsListEmpty (&Partition->PackedQueue)) {
+    Link = GetFirstNode (&Partition->PackedQueue);
+    RemoveEntryList (Link);
+    InsertTailList (&Packed->Entries, Link);
+  }
+  Count    = Partition->PackedCount;
+  BlockNum = Partition->PackedBlocks;
+  Partition->PackedCount  = 0;
+  Partition->PackedBlocks = 0;
+  gBS->RestoreTPL (OldTpl);
+
+  BlockSize = Partition->BlockMedia.BlockSize;
+  First     = EMMC_PACKED_ENTRY_FROM_LINK (GetFirstNode (&Packed->Entries));
+
+  Packed->Token.TransactionStatus = EFI_SUCCESS;
+  Status = gBS->CreateEvent (
+                  EVT_NOTIFY_SIGNAL,
+                  TPL_NOTIFY,
+                  EmmcPackedWriteCallback,
+                  Packed,
+                  &Packed->Token.Event
+                  );
+  if (EFI_ERROR (Status)) {
+    Packed->Token.TransactionStatus = Status;
+    EmmcPackedWriteCallback (NULL, Packed);
+    return;
+  }
+
+  if (Count == 1) {
+    //
+    // Nothing to pack, send the single write as is.
+    //
+    BlockNum = First->BufferSize / BlockSize;
+    Status   = EmmcSetBlkCount (Partition, (UINT16)BlockNum, &Packed->Token, FALSE);
+    if (!EFI_ERROR (Status)) {
+      Status = EmmcRwMultiBlocks (Partition, First->Lba, First->Buffer, First->BufferSize, FALSE, &Packed->Token, TRUE);
+    }
+  } else {
+    //
+    // The data is preceded by a header block listing the CMD23 and CMD25
+    // arguments of each write.
+    //
+    Packed->Buffer = AllocateZeroPool ((BlockNum + 1) * BlockSize);
+    if (Packed->Buffer == NULL) {
+      Status = EFI_OUT_OF_RESOURCES;
+    } else {
+      Header    = (UINT32 *) Packed->Buffer;
+      Header[0] = EMMC_PACKED_HEADER_VERSION | (EMMC_PACKED_HEADER_WRITE << 8) | (Count << 16);
+      Data      = (UINT8 *) Packed->Buffer + BlockSize;
+      Index     = 1;
+      for (Link = GetFirstNode (&Packed->Entries);
+           !IsNull (&Packed->Entries, Link);
+           Link = GetNextNode (&Packed->Entries, Link)) {
+        Entry = EMMC_PACKED_ENTRY_FROM_LINK (Link);
+        Header[Index * 2] = (UINT32)(Entry->BufferSize / BlockSize);
+        if (Partition->Device->SectorAddressing) {
+          Header[Index * 2 + 1] = (UINT32)Entry->Lba;
+        } else {
+          Header[Index * 2 + 1] = (UINT32)MultU64x32 (Entry->Lba, (UINT32)BlockSize);
+        }
+        CopyMem (Data, Entry->Buffer, Entry->BufferSize);
+        Data += Entry->BufferSize;
+        Index++;
+      }
+
+      Status = EmmcSetBlkCount (Partition, EMMC_PACKED_CMD | (UINT32)(BlockNum + 1), &Packed->Token, FALSE);
+      if (!EFI_ERROR (Status)) {
+        Status = EmmcRwMultiBlocks (Partition, First->Lba, Packed->Buffer, (BlockNum + 1) * BlockSize, FALSE, &Packed->Token, TRUE);
+      }
+    }
+  }
+
+  DEBUG ((DEBUG_BLKIO,
+    "EmmcPackedWrite(): Part %d Lba 0x%lx Entries %d BlkNo 0x%x with %r\n",
+    Partition->PartitionType, First->Lba, Count, BlockNum, Status));
+
+  if (EFI_ERROR (Status)) {
+    //
+    // Nothing signals the token of the packed write now, complete the writes here.
+    //
+    Packed->Token.TransactionStatus = Status;
+    gBS->SignalEvent (Packed->Token.Event);
+  }
+}
+
+/**
+  Complete the writes held back on a partition with EFI_ABORTED.
+
+  @param[in]  Partition         A pointer to the EMMC_PARTITION instance.
+
+**/
+VOID
+EmmcAbortPackedWrites (
+  IN  EMMC_PARTITION            *Partition
+  )
+{
+  EMMC_PACKED_ENTRY             *Entry;
+  LIST_ENTRY                    *Link;
+  EFI_TPL                       OldTpl;
+
+  OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+  while (!IsListEmpty (&Partition->PackedQueue)) {
+    Link  = GetFirstNode (&Partition->PackedQueue);
+    Entry = EMMC_PACKED_ENTRY_FROM_LINK (Link);
+    RemoveEntryList (Link);
+
+    Entry->Token->TransactionStatus = EFI_ABORTED;
+    gBS->SignalEvent (Entry->Token->Event);
+    FreePool (Entry);
+  }
+  Partition->PackedCount  = 0;
+  Partition->PackedBlocks = 0;
+  gBS->RestoreTPL (OldTpl);
+}
+
 /**
   This function transfers data from/to EMMC device.
 
@@ -812,6 +1118,7 @@ EmmcReadWrite (
   UINTN                                 Remaining;
   UINT32                                MaxBlock;
   BOOLEAN                               LastRw;
+  UINTN                                 Index;
 
   Status = EFI_SUCCESS;
   Device = Partition->Device;
@@ -860,10 +1167,21 @@ EmmcReadWrite (
     Token->TransactionStatus = EFI_SUCCESS;
   }
   //
+  // Small asynchronous writes issued while the partition is busy are sent
+  // together later. Anything else goes after the writes held back so far.
+  //
+  if (!IsRead && EmmcQueuePackedWrite (Partition, Lba, Buffer, BufferSize, Token)) {
+    return EFI_SUCCESS;
+  }
+  EmmcFlushPackedWrites (Partition);
+  //
   // Check if needs to switch partition access.
   //
   PartitionConfig = Device->ExtCsd.PartitionConfig;
   if ((PartitionConfig & 0x7) != Partition->PartitionType) {
+    for (Index = 0; Index < EMMC_MAX_PARTITIONS; Index++) {
+      EmmcFlushPackedWrites (&Device->Partition[Index]);
+    }
     PartitionConfig &= (UINT8)~0x7;
     PartitionConfig |= Partition->PartitionType;
     Status = EmmcSetExtCsd (Partition, OFFSET_OF (EMMC_EXT_CSD, PartitionConfig), PartitionConfig, Token, FALSE);
@@ -1034,9 +1352,8 @@ EmmcFlushBlocks (
   IN  EFI_BLOCK_IO_PROTOCOL   *This
   )
 {
-  //
-  // return directly
-  //
+  EmmcFlushPackedWrites (EMMC_PARTITION_DATA_FROM_BLKIO (This));
+
   return EFI_SUCCESS;
 }
 
@@ -1066,6 +1383,8 @@ EmmcResetEx (
 
   Partition = EMMC_PARTITION_DATA_FROM_BLKIO2 (This);
 
+  EmmcAbortPackedWrites (Partition);
+
   OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
   for (Link = GetFirstNode (&Partition->Queue);
        !IsNull (&Partition->Queue, Link);
@@ -1195,6 +1514,8 @@ EmmcFlushBlocksEx (
   IN OUT EFI_BLOCK_IO2_TOKEN     *Token
   )
 {
+  EmmcFlushPackedWrites (EMMC_PARTITION_DATA_FROM_BLKIO2 (This));
+
   //
   // Signal event and return directly.
   //
@@ -1303,6 +1624,7 @@ EmmcSecurityProtocolInOut (
   UINTN                            Remaining;
   UINT32                           MaxBlock;
   UINT8                            PartitionConfig;
+  UINTN                            Index;
 
   Status    = EFI_SUCCESS;
   Partition = EMMC_PARTITION_DATA_FROM_SSP (This);
@@ -1348,6 +1670,9 @@ EmmcSecurityProtocolInOut (
   //
   PartitionConfig = Device->ExtCsd.PartitionConfig;
   if ((PartitionConfig & 0x7) != Partition->PartitionType) {
+    for (Index = 0; Index < EMMC_MAX_PARTITIONS; Index++) {
+      EmmcFlushPackedWrites (&Device->Partition[Index]);
+    }
     PartitionConfig &= (UINT8)~0x7;
     PartitionConfig |= Partition->PartitionType;
     Status = EmmcSetExtCsd (Partition, OFFSET_OF (EMMC_EXT_CSD, PartitionConfig), PartitionConfig, NULL, FALSE);
@@ -1626,6 +1951,7 @@ EmmcEraseBlockStart (
   }
 
   EraseBlockStart->Signature = EMMC_REQUEST_SIGNATURE;
+  EraseBlockStart->Partition = Partition;
   OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
   InsertTailList (&Partition->Queue, &EraseBlockStart->Link);
   gBS->RestoreTPL (OldTpl);
@@ -1733,6 +2059,7 @@ EmmcEraseBlockEnd (
   }
 
   EraseBlockEnd->Signature = EMMC_REQUEST_SIGNATURE;
+  EraseBlockEnd->Partition = Partition;
   OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
   InsertTailList (&Partition->Queue, &EraseBlockEnd->Link);
   gBS->RestoreTPL (OldTpl);
@@ -1838,6 +2165,7 @@ EmmcEraseBlock (
   }
 
   EraseBlock->Signature = EMMC_REQUEST_SIGNATURE;
+  EraseBlock->Partition = Partition;
   OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
   InsertTailList (&Partition->Queue, &EraseBlock->Link);
   gBS->RestoreTPL (OldTpl);
@@ -1995,6 +2323,7 @@ EmmcEraseBlocks (
   UINT8                                 PartitionConfig;
   EMMC_PARTITION                        *Partition;
   EMMC_DEVICE                           *Device;
+  UINTN                                 Index;
 
   Status    = EFI_SUCCESS;
   Partition = EMMC_PARTITION_DATA_FROM_ERASEBLK (This);
@@ -2029,11 +2358,19 @@ EmmcEraseBlocks (
   FirstLba = Lba;
   LastLba  = Lba + BlockNum - 1;
 
+  //
+  // Erase after the writes held back so far.
+  //
+  EmmcFlushPackedWrites (Partition);
+
   //
   // Check if needs to switch partition access.
   //
   PartitionConfig = Device->ExtCsd.PartitionConfig;
   if ((PartitionConfig & 0x7) != Partition->PartitionType) {
+    for (Index = 0; Index < EMMC_MAX_PARTITIONS; Index++) {
+      EmmcFlushPackedWrites (&Device->Partition[Index]);
+    }
     PartitionConfig &= (UINT8)~0x7;
     PartitionConfig |= Partition->PartitionType;
     Status = EmmcSetExtCsd (Partition, OFFSET_OF (EMMC_EXT_CSD, PartitionConfig), PartitionConfig, (EFI_BLOCK_IO2_TOKEN*)Token, FALSE);
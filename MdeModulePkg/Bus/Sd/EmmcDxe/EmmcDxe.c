@@ -328,6 +328,7 @@ DiscoverAllPartitions (
     CopyMem (Partition, &mEmmcPartitionTemplate, sizeof (EMMC_PARTITION));
     Partition->Device             = Device;
     InitializeListHead (&Partition->Queue);
+    InitializeListHead (&Partition->PackedQueue);
     Partition->BlockIo.Media      = &Partition->BlockMedia;
     Partition->BlockIo2.Media     = &Partition->BlockMedia;
     Partition->PartitionType      = Index;
@@ -1071,6 +1072,8 @@ EmmcDxeDriverBindingStop (
       Partition = EMMC_PARTITION_DATA_FROM_BLKIO2 (BlockIo2);
     }
 
+    EmmcAbortPackedWrites (Partition);
+
     for (Link = GetFirstNode (&Partition->Queue);
          !IsNull (&Partition->Queue, Link);
          Link = NextLink) {
@@ -68,6 +68,7 @@ extern EFI_COMPONENT_NAME2_PROTOCOL     gEmmcDxeComponentName2;
 
 #define EMMC_REQUEST_SIGNATURE           SIGNATURE_32 ('E', 'm', 'R', 'e')
 
+typedef struct _EMMC_PARTITION           EMMC_PARTITION;
 typedef struct _EMMC_DEVICE              EMMC_DEVICE;
 typedef struct _EMMC_DRIVER_PRIVATE_DATA EMMC_DRIVER_PRIVATE_DATA;
 
@@ -86,12 +87,57 @@ typedef struct {
 
   EFI_BLOCK_IO2_TOKEN                   *Token;
   EFI_EVENT                             Event;
+
+  EMMC_PARTITION                        *Partition;
 } EMMC_REQUEST;
 
 #define EMMC_REQUEST_FROM_LINK(a) \
     CR(a, EMMC_REQUEST, Link, EMMC_REQUEST_SIGNATURE)
 
+//
+// Packed write command, refer to EMMC Electrical Standard Spec 5.1 Section 6.6.29.
+// The header block holds one 8-byte entry per write, after an 8-byte preamble.
+//
+#define EMMC_PACKED_CMD                  BIT30
+#define EMMC_PACKED_HEADER_VERSION       0x01
+#define EMMC_PACKED_HEADER_WRITE         0x02
+//
+// Writes larger than EMMC_PACKED_MAX_ENTRY_BLOCKS are never held back, and a
+// packed command carries at most EMMC_PACKED_MAX_BLOCKS data blocks.
+//
+#define EMMC_PACKED_MAX_ENTRY_BLOCKS     128
+#define EMMC_PACKED_MAX_BLOCKS           2048
+
+#define EMMC_PACKED_ENTRY_SIGNATURE      SIGNATURE_32 ('E', 'm', 'P', 'e')
+
+//
+// Asynchronous write held back to be sent in a packed write command.
+//
 typedef struct {
+  UINT32                                Signature;
+  LIST_ENTRY                            Link;
+
+  EFI_LBA                               Lba;
+  VOID                                  *Buffer;
+  UINTN                                 BufferSize;
+
+  EFI_BLOCK_IO2_TOKEN                   *Token;
+} EMMC_PACKED_ENTRY;
+
+#define EMMC_PACKED_ENTRY_FROM_LINK(a) \
+    CR(a, EMMC_PACKED_ENTRY, Link, EMMC_PACKED_ENTRY_SIGNATURE)
+
+//
+// Packed write command in flight. Token tracks the CMD23/CMD25 pair and its
+// event completes the tokens of all the entries.
+//
+typedef struct {
+  LIST_ENTRY                            Entries;
+  VOID                                  *Buffer;
+  EFI_BLOCK_IO2_TOKEN                   Token;
+} EMMC_PACKED_WRITE;
+
+struct _EMMC_PARTITION {
   UINT32                                Signature;
   BOOLEAN                               Enable;
   EMMC_PARTITION_TYPE                   PartitionType;
@@ -105,9 +151,15 @@ typedef struct {
   EFI_DISK_INFO_PROTOCOL                DiskInfo;
 
   LIST_ENTRY                            Queue;
+  //
+  // Writes held back while Queue is busy, see EmmcQueuePackedWrite().
+  //
+  LIST_ENTRY                            PackedQueue;
+  UINT32                                PackedCount;
+  UINTN                                 PackedBlocks;
 
   EMMC_DEVICE                           *Device;
-} EMMC_PARTITION;
+} ;
 
 //
 // Up to 6 slots per EMMC PCI host controller
@@ -497,5 +549,27 @@ EmmcGetExtCsd (
      OUT EMMC_EXT_CSD           *ExtCsd
   );
 
+/**
+  Send the writes held back on a partition as one packed write command.
+
+  @param[in]  Partition         A pointer to the EMMC_PARTITION instance.
+
+**/
+VOID
+EmmcFlushPackedWrites (
+  IN     EMMC_PARTITION         *Partition
+  );
+
+/**
+  Complete the writes held back on a partition with EFI_ABORTED.
+
+  @param[in]  Partition         A pointer to the EMMC_PARTITION instance.
+
+**/
+VOID
+EmmcAbortPackedWrites (
+  IN     EMMC_PARTITION         *Partition
+  );
+
 #endif
 
@@ -11,6 +11,8 @@
 
 #include <Uefi.h>
 
+#include <IndustryStandard/Scsi.h>
+
 #include <Protocol/ScsiPassThruExt.h>
 #include <Protocol/UfsDeviceConfig.h>
 #include <Protocol/UfsHostController.h>
@@ -100,6 +102,21 @@ typedef struct {
 #define UFS_PASS_THRU_TRANS_REQ_FROM_THIS(a) \
     CR(a, UFS_PASS_THRU_TRANS_REQ, TransferList, UFS_PASS_THRU_TRANS_REQ_SIG)
 
+//
+// Blocking READ/WRITE requests of at least twice the minimum length are split
+// over up to UFS_MAX_SPLIT_REQS slots of the transfer request list.
+//
+#define UFS_MAX_SPLIT_REQS            8
+#define UFS_SPLIT_MIN_TRANSFER_LEN    SIZE_128KB
+
+typedef struct {
+  EFI_EXT_SCSI_PASS_THRU_SCSI_REQUEST_PACKET    Packet;
+  UINT8                                         Cdb[16];
+  UINT8                                         SenseData[18];
+  UINT32                                        Length;
+  UFS_PASS_THRU_TRANS_REQ                       *TransReq;
+} UFS_PASS_THRU_SPLIT_REQ;
+
 #define UFS_TIMEOUT                   EFI_TIMER_PERIOD_SECONDS(3)
 #define UFS_HC_ASYNC_TIMER            EFI_TIMER_PERIOD_MILLISECONDS(1)
 
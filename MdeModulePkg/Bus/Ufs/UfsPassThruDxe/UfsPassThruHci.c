@@ -704,6 +704,53 @@ UfsCreateNopCommandDesc (
   return EFI_SUCCESS;
 }
 
+/**
+  Get the slots in transfer list of a UFS device that are neither being executed
+  nor owned by a pending async transfer request.
+
+  @param[in]  Private       The pointer to the UFS_PASS_THRU_PRIVATE_DATA data structure.
+  @param[out] SlotMap       The bitmap of available slots.
+
+  @retval EFI_SUCCESS       The available slots were retrieved successfully.
+  @retval Others            Failed to read the doorbell register.
+
+**/
+EFI_STATUS
+UfsGetAvailableSlotsInTrl (
+  IN     UFS_PASS_THRU_PRIVATE_DATA   *Private,
+     OUT UINT32                       *SlotMap
+  )
+{
+  UINT32                   Data;
+  EFI_STATUS               Status;
+  EFI_TPL                  OldTpl;
+  LIST_ENTRY               *Entry;
+  UFS_PASS_THRU_TRANS_REQ  *TransReq;
+
+  Status = UfsMmioRead32 (Private, UFS_HC_UTRLDBR_OFFSET, &Data);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  //
+  // A finished async request keeps its slot until ProcessAsyncTaskList()
+  // has read back the response.
+  //
+  OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+  BASE_LIST_FOR_EACH (Entry, &Private->Queue) {
+    TransReq = UFS_PASS_THRU_TRANS_REQ_FROM_THIS (Entry);
+    Data    |= BIT0 << TransReq->Slot;
+  }
+  gBS->RestoreTPL (OldTpl);
+
+  if (Private->Nutrs < 32) {
+    Data |= ~((BIT0 << Private->Nutrs) - 1);
+  }
+  *SlotMap = ~Data;
+
+  return EFI_SUCCESS;
+}
+
 /**
   Find out available slot in transfer list of a UFS device.
 
@@ -722,12 +769,12 @@ UfsFindAvailableSlotInTrl (
 {
   UINT8            Nutrs;
   UINT8            Index;
-  UINT32           Data;
+  UINT32           SlotMap;
   EFI_STATUS       Status;
 
   ASSERT ((Private != NULL) && (Slot != NULL));
 
-  Status  = UfsMmioRead32 (Private, UFS_HC_UTRLDBR_OFFSET, &Data);
+  Status  = UfsGetAvailableSlotsInTrl (Private, &SlotMap);
   if (EFI_ERROR (Status)) {
     return Status;
   }
@@ -735,7 +782,7 @@ UfsFindAvailableSlotInTrl (
   Nutrs   = (UINT8)((Private->UfsHcInfo.Capabilities & UFS_HC_CAP_NUTRS) + 1);
 
   for (Index = 0; Index < Nutrs; Index++) {
-    if ((Data & (BIT0 << Index)) == 0) {
+    if ((SlotMap & (BIT0 << Index)) != 0) {
       *Slot = Index;
       return EFI_SUCCESS;
     }
@@ -746,16 +793,16 @@ UfsFindAvailableSlotInTrl (
 
 
 /**
-  Start specified slot in transfer list of a UFS device.
+  Start specified slots in transfer list of a UFS device with a single doorbell write.
 
   @param[in]  Private       The pointer to the UFS_PASS_THRU_PRIVATE_DATA data structure.
-  @param[in]  Slot          The slot to be started.
+  @param[in]  SlotMap       The bitmap of slots to be started.
 
 **/
 EFI_STATUS
-UfsStartExecCmd (
+UfsStartExecCmds (
   IN  UFS_PASS_THRU_PRIVATE_DATA   *Private,
-  IN  UINT8                        Slot
+  IN  UINT32                       SlotMap
   )
 {
   UINT32        Data;
@@ -773,7 +820,7 @@ UfsStartExecCmd (
     }
   }
 
-  Status = UfsMmioWrite32 (Private, UFS_HC_UTRLDBR_OFFSET, BIT0 << Slot);
+  Status = UfsMmioWrite32 (Private, UFS_HC_UTRLDBR_OFFSET, SlotMap);
   if (EFI_ERROR (Status)) {
     return Status;
   }
@@ -781,6 +828,22 @@ UfsStartExecCmd (
   return EFI_SUCCESS;
 }
 
+/**
+  Start specified slot in transfer list of a UFS device.
+
+  @param[in]  Private       The pointer to the UFS_PASS_THRU_PRIVATE_DATA data structure.
+  @param[in]  Slot          The slot to be started.
+
+**/
+EFI_STATUS
+UfsStartExecCmd (
+  IN  UFS_PASS_THRU_PRIVATE_DATA   *Private,
+  IN  UINT8                        Slot
+  )
+{
+  return UfsStartExecCmds (Private, BIT0 << Slot);
+}
+
 /**
   Stop specified slot in transfer list of a UFS device.
 
@@ -1452,6 +1515,335 @@ UfsPrepareDataTransferBuffer (
   return EFI_SUCCESS;
 }
 
+/**
+  Get the result of a completed SCSI transfer request. The sense data, target status
+  and transfer length of the request packet are updated from the response UPIU.
+
+  @param[in] TransReq       Pointer to the completed transfer request.
+
+  @retval EFI_SUCCESS       The command was executed by the device.
+  @retval EFI_DEVICE_ERROR  The command failed.
+
+**/
+EFI_STATUS
+UfsGetScsiCmdResult (
+  IN UFS_PASS_THRU_TRANS_REQ  *TransReq
+  )
+{
+  EFI_EXT_SCSI_PASS_THRU_SCSI_REQUEST_PACKET  *Packet;
+  UTP_RESPONSE_UPIU                           *Response;
+  UINT16                                      SenseDataLen;
+  UINT32                                      ResTranCount;
+
+  Packet = TransReq->Packet;
+
+  //
+  // Get sense data if exists
+  //
+  Response     = (UTP_RESPONSE_UPIU*)((UINT8*)TransReq->CmdDescHost + TransReq->Trd->RuO * sizeof (UINT32));
+  ASSERT (Response != NULL);
+  SenseDataLen = Response->SenseDataLen;
+  SwapLittleEndianToBigEndian ((UINT8*)&SenseDataLen, sizeof (UINT16));
+
+  if ((Packet->SenseDataLength != 0) && (Packet->SenseData != NULL)) {
+    //
+    // Make sure the hardware device does not return more data than expected.
+    //
+    if (SenseDataLen <= Packet->SenseDataLength) {
+      CopyMem (Packet->SenseData, Response->SenseData, SenseDataLen);
+      Packet->SenseDataLength = (UINT8)SenseDataLen;
+    } else {
+      Packet->SenseDataLength = 0;
+    }
+  }
+
+  //
+  // Check the transfer request result.
+  //
+  Packet->TargetStatus = Response->Status;
+  if (Response->Response != 0) {
+    DEBUG ((DEBUG_ERROR, "UfsExecScsiCmds() fails with Target Failure\n"));
+    return EFI_DEVICE_ERROR;
+  }
+
+  if (TransReq->Trd->Ocs != 0) {
+    return EFI_DEVICE_ERROR;
+  }
+
+  if ((Response->Flags & BIT5) == BIT5) {
+    ResTranCount = Response->ResTranCount;
+    SwapLittleEndianToBigEndian ((UINT8*)&ResTranCount, sizeof (UINT32));
+    if (Packet->DataDirection == EFI_EXT_SCSI_DATA_DIRECTION_READ) {
+      Packet->InTransferLength -= ResTranCount;
+    } else {
+      Packet->OutTransferLength -= ResTranCount;
+    }
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Release a SCSI transfer request and the resources of its slot.
+
+  @param[in] Private        Pointer to the UFS_PASS_THRU_PRIVATE_DATA
+  @param[in] TransReq       Pointer to the transfer request
+
+**/
+VOID
+UfsFreeScsiTransReq (
+  IN UFS_PASS_THRU_PRIVATE_DATA  *Private,
+  IN UFS_PASS_THRU_TRANS_REQ     *TransReq
+  )
+{
+  EDKII_UFS_HOST_CONTROLLER_PROTOCOL  *UfsHc;
+
+  UfsHc = Private->UfsHostController;
+
+  UfsStopExecCmd (Private, TransReq->Slot);
+
+  UfsReconcileDataTransferBuffer (Private, TransReq);
+
+  if (TransReq->CmdDescMapping != NULL) {
+    UfsHc->Unmap (UfsHc, TransReq->CmdDescMapping);
+  }
+  if (TransReq->CmdDescHost != NULL) {
+    UfsHc->FreeBuffer (UfsHc, EFI_SIZE_TO_PAGES (TransReq->CmdDescSize), TransReq->CmdDescHost);
+  }
+  FreePool (TransReq);
+}
+
+/**
+  Sends a blocking READ or WRITE SCSI Request Packet as several requests over
+  consecutive LBA ranges, each in its own slot of the transfer request list, so
+  the device works on them concurrently.
+
+  @param[in]      Private       The pointer to the UFS_PASS_THRU_PRIVATE_DATA data structure.
+  @param[in]      Lun           The LUN of the UFS device to send the SCSI Request Packet.
+  @param[in, out] Packet        A pointer to the SCSI Request Packet to send to a specified Lun of the
+                                UFS device.
+
+  @retval EFI_SUCCESS           The SCSI Request Packet was sent by the host.
+  @retval EFI_UNSUPPORTED       The SCSI Request Packet is not worth splitting or not enough
+                                slots are available. Nothing was sent.
+  @retval EFI_DEVICE_ERROR      A device error occurred while attempting to send the SCSI Request
+                                Packet.
+  @retval EFI_OUT_OF_RESOURCES  The resource for transfer is not available.
+  @retval EFI_TIMEOUT           A timeout occurred while waiting for the SCSI Request Packet to execute.
+
+**/
+EFI_STATUS
+UfsExecSplitScsiCmds (
+  IN     UFS_PASS_THRU_PRIVATE_DATA                  *Private,
+  IN     UINT8                                       Lun,
+  IN OUT EFI_EXT_SCSI_PASS_THRU_SCSI_REQUEST_PACKET  *Packet
+  )
+{
+  EFI_STATUS                           Status;
+  EFI_STATUS                           ReqStatus;
+  EDKII_UFS_HOST_CONTROLLER_PROTOCOL   *UfsHc;
+  UFS_PASS_THRU_SPLIT_REQ              *SplitReq;
+  UFS_PASS_THRU_SPLIT_REQ              *Req;
+  UFS_PASS_THRU_TRANS_REQ              *TransReq;
+  UINT8                                *Cdb;
+  UINT8                                *DataBuffer;
+  BOOLEAN                              Read;
+  BOOLEAN                              Cdb16;
+  UINT64                               Lba;
+  UINT32                               Blocks;
+  UINT32                               ReqBlocks;
+  UINT32                               BlockSize;
+  UINT32                               TransferLen;
+  UINT32                               Transferred;
+  UINT32                               ReqLength;
+  UINT32                               SlotMap;
+  UINT32                               StartMap;
+  UINT8                                Slots[UFS_MAX_SPLIT_REQS];
+  UINT32                               Count;
+  UINT32                               Index;
+
+  Cdb = Packet->Cdb;
+  switch (Cdb[0]) {
+    case EFI_SCSI_OP_READ10:
+    case EFI_SCSI_OP_WRITE10:
+      Lba    = SwapBytes32 (ReadUnaligned32 ((UINT32 *)&Cdb[2]));
+      Blocks = SwapBytes16 (ReadUnaligned16 ((UINT16 *)&Cdb[7]));
+      Cdb16  = FALSE;
+      break;
+
+    case EFI_SCSI_OP_READ16:
+    case EFI_SCSI_OP_WRITE16:
+      Lba    = SwapBytes64 (ReadUnaligned64 ((UINT64 *)&Cdb[2]));
+      Blocks = SwapBytes32 (ReadUnaligned32 ((UINT32 *)&Cdb[10]));
+      Cdb16  = TRUE;
+      break;
+
+    default:
+      return EFI_UNSUPPORTED;
+  }
+
+  if (Packet->DataDirection == EFI_EXT_SCSI_DATA_DIRECTION_READ) {
+    Read        = TRUE;
+    TransferLen = Packet->InTransferLength;
+    DataBuffer  = Packet->InDataBuffer;
+  } else if (Packet->DataDirection == EFI_EXT_SCSI_DATA_DIRECTION_WRITE) {
+    Read        = FALSE;
+    TransferLen = Packet->OutTransferLength;
+    DataBuffer  = Packet->OutDataBuffer;
+  } else {
+    return EFI_UNSUPPORTED;
+  }
+
+  if ((Blocks == 0) || (TransferLen % Blocks != 0) ||
+      (TransferLen < 2 * UFS_SPLIT_MIN_TRANSFER_LEN)) {
+    return EFI_UNSUPPORTED;
+  }
+  BlockSize = TransferLen / Blocks;
+
+  //
+  // Use as many free slots as the transfer length allows, leaving the request
+  // on a single slot when fewer than two are free.
+  //
+  Status = UfsGetAvailableSlotsInTrl (Private, &SlotMap);
+  if (EFI_ERROR (Status)) {
+    return EFI_UNSUPPORTED;
+  }
+  Count = 0;
+  for (Index = 0; Index < Private->Nutrs; Index++) {
+    if ((Count == UFS_MAX_SPLIT_REQS) || (Count == TransferLen / UFS_SPLIT_MIN_TRANSFER_LEN)) {
+      break;
+    }
+    if ((SlotMap & (BIT0 << Index)) != 0) {
+      Slots[Count++] = (UINT8)Index;
+    }
+  }
+  if (Count < 2) {
+    return EFI_UNSUPPORTED;
+  }
+
+  SplitReq = AllocateZeroPool (Count * sizeof (UFS_PASS_THRU_SPLIT_REQ));
+  if (SplitReq == NULL) {
+    return EFI_UNSUPPORTED;
+  }
+
+  UfsHc    = Private->UfsHostController;
+  StartMap = 0;
+  Status   = EFI_SUCCESS;
+  for (Index = 0; Index < Count; Index++) {
+    Req       = &SplitReq[Index];
+    ReqBlocks = Blocks / Count + ((Index < Blocks % Count) ? 1 : 0);
+    Req->Length = ReqBlocks * BlockSize;
+
+    CopyMem (&Req->Packet, Packet, sizeof (Req->Packet));
+    CopyMem (Req->Cdb, Packet->Cdb, MIN (Packet->CdbLength, sizeof (Req->Cdb)));
+    if (Cdb16) {
+      WriteUnaligned64 ((UINT64 *)&Req->Cdb[2], SwapBytes64 (Lba));
+      WriteUnaligned32 ((UINT32 *)&Req->Cdb[10], SwapBytes32 (ReqBlocks));
+    } else {
+      WriteUnaligned32 ((UINT32 *)&Req->Cdb[2], SwapBytes32 ((UINT32)Lba));
+      WriteUnaligned16 ((UINT16 *)&Req->Cdb[7], SwapBytes16 ((UINT16)ReqBlocks));
+    }
+    Req->Packet.Cdb             = Req->Cdb;
+    Req->Packet.SenseData       = Req->SenseData;
+    Req->Packet.SenseDataLength = sizeof (Req->SenseData);
+    if (Read) {
+      Req->Packet.InDataBuffer     = DataBuffer;
+      Req->Packet.InTransferLength = Req->Length;
+    } else {
+      Req->Packet.OutDataBuffer     = DataBuffer;
+      Req->Packet.OutTransferLength = Req->Length;
+    }
+    Lba        += ReqBlocks;
+    DataBuffer += Req->Length;
+
+    TransReq = AllocateZeroPool (sizeof (UFS_PASS_THRU_TRANS_REQ));
+    if (TransReq == NULL) {
+      Status = EFI_OUT_OF_RESOURCES;
+      goto Exit;
+    }
+    TransReq->Signature     = UFS_PASS_THRU_TRANS_REQ_SIG;
+    TransReq->TimeoutRemain = Packet->Timeout;
+    TransReq->Packet        = &Req->Packet;
+    TransReq->Slot          = Slots[Index];
+    TransReq->Trd           = ((UTP_TRD*)Private->UtpTrlBase) + TransReq->Slot;
+    Req->TransReq           = TransReq;
+
+    Status = UfsCreateScsiCommandDesc (
+               Private,
+               Lun,
+               &Req->Packet,
+               TransReq->Trd,
+               &TransReq->CmdDescHost,
+               &TransReq->CmdDescMapping
+               );
+    if (EFI_ERROR (Status)) {
+      goto Exit;
+    }
+
+    TransReq->CmdDescSize = TransReq->Trd->PrdtO * sizeof (UINT32) + TransReq->Trd->PrdtL * sizeof (UTP_TR_PRD);
+
+    Status = UfsPrepareDataTransferBuffer (Private, TransReq);
+    if (EFI_ERROR (Status)) {
+      goto Exit;
+    }
+
+    StartMap |= BIT0 << TransReq->Slot;
+  }
+
+  //
+  // Ring the doorbell of all slots at once and wait for all of them.
+  //
+  UfsStartExecCmds (Private, StartMap);
+
+  Status = UfsWaitMemSet (Private, UFS_HC_UTRLDBR_OFFSET, StartMap, 0, Packet->Timeout);
+  if (EFI_ERROR (Status)) {
+    goto Exit;
+  }
+
+  //
+  // Report the first request that did not complete in full, and only count the
+  // data up to it as transferred.
+  //
+  Transferred = 0;
+  for (Index = 0; Index < Count; Index++) {
+    Req       = &SplitReq[Index];
+    ReqStatus = UfsGetScsiCmdResult (Req->TransReq);
+    ReqLength = Read ? Req->Packet.InTransferLength : Req->Packet.OutTransferLength;
+    Transferred += ReqLength;
+    if (EFI_ERROR (ReqStatus) ||
+        (Req->Packet.TargetStatus != EFI_EXT_SCSI_STATUS_TARGET_GOOD) ||
+        (ReqLength != Req->Length) ||
+        (Index == Count - 1)) {
+      Status               = ReqStatus;
+      Packet->TargetStatus = Req->Packet.TargetStatus;
+      if ((Packet->SenseData != NULL) && (Req->Packet.SenseDataLength <= Packet->SenseDataLength)) {
+        CopyMem (Packet->SenseData, Req->SenseData, Req->Packet.SenseDataLength);
+        Packet->SenseDataLength = Req->Packet.SenseDataLength;
+      } else {
+        Packet->SenseDataLength = 0;
+      }
+      break;
+    }
+  }
+  if (Read) {
+    Packet->InTransferLength = Transferred;
+  } else {
+    Packet->OutTransferLength = Transferred;
+  }
+
+Exit:
+  UfsHc->Flush (UfsHc);
+
+  for (Index = 0; Index < Count; Index++) {
+    if (SplitReq[Index].TransReq != NULL) {
+      UfsFreeScsiTransReq (Private, SplitReq[Index].TransReq);
+    }
+  }
+  FreePool (SplitReq);
+
+  return Status;
+}
+
 /**
   Sends a UFS-supported SCSI Request Packet to a UFS device that is attached to the UFS host controller.
 
@@ -1485,13 +1877,20 @@ UfsExecScsiCmds (
   )
 {
   EFI_STATUS                           Status;
-  UTP_RESPONSE_UPIU                    *Response;
-  UINT16                               SenseDataLen;
-  UINT32                               ResTranCount;
   EFI_TPL                              OldTpl;
   UFS_PASS_THRU_TRANS_REQ              *TransReq;
   EDKII_UFS_HOST_CONTROLLER_PROTOCOL   *UfsHc;
 
+  //
+  // Large blocking reads and writes are spread over several slots.
+  //
+  if (Event == NULL) {
+    Status = UfsExecSplitScsiCmds (Private, Lun, Packet);
+    if (Status != EFI_UNSUPPORTED) {
+      return Status;
+    }
+  }
+
   TransReq = AllocateZeroPool (sizeof (UFS_PASS_THRU_TRANS_REQ));
   if (TransReq == NULL) {
     return EFI_OUT_OF_RESOURCES;
@@ -1564,53 +1963,7 @@ UfsExecScsiCmds (
     goto Exit;
   }
 
-  //
-  // Get sense data if exists
-  //
-  Response     = (UTP_RESPONSE_UPIU*)((UINT8*)TransReq->CmdDescHost + TransReq->Trd->RuO * sizeof (UINT32));
-  ASSERT (Response != NULL);
-  SenseDataLen = Response->SenseDataLen;
-  SwapLittleEndianToBigEndian ((UINT8*)&SenseDataLen, sizeof (UINT16));
-
-  if ((Packet->SenseDataLength != 0) && (Packet->SenseData != NULL)) {
-    //
-    // Make sure the hardware device does not return more data than expected.
-    //
-    if (SenseDataLen <= Packet->SenseDataLength) {
-      CopyMem (Packet->SenseData, Response->SenseData, SenseDataLen);
-      Packet->SenseDataLength = (UINT8)SenseDataLen;
-    } else {
-      Packet->SenseDataLength = 0;
-    }
-  }
-
-  //
-  // Check the transfer request result.
-  //
-  Packet->TargetStatus = Response->Status;
-  if (Response->Response != 0) {
-    DEBUG ((DEBUG_ERROR, "UfsExecScsiCmds() fails with Target Failure\n"));
-    Status = EFI_DEVICE_ERROR;
-    goto Exit;
-  }
-
-  if (TransReq->Trd->Ocs == 0) {
-    if (Packet->DataDirection == EFI_EXT_SCSI_DATA_DIRECTION_READ) {
-      if ((Response->Flags & BIT5) == BIT5) {
-        ResTranCount = Response->ResTranCount;
-        SwapLittleEndianToBigEndian ((UINT8*)&ResTranCount, sizeof (UINT32));
-        Packet->InTransferLength -= ResTranCount;
-      }
-    } else {
-      if ((Response->Flags & BIT5) == BIT5) {
-        ResTranCount = Response->ResTranCount;
-        SwapLittleEndianToBigEndian ((UINT8*)&ResTranCount, sizeof (UINT32));
-        Packet->OutTransferLength -= ResTranCount;
-      }
-    }
-  } else {
-    Status = EFI_DEVICE_ERROR;
-  }
+  Status = UfsGetScsiCmdResult (TransReq);
 
 Exit:
   UfsHc->Flush (UfsHc);
@@ -653,6 +653,7 @@ UsbFindChild (
   @param  HubIf                 The HUB that has the device connected.
   @param  Port                  The port index of the hub (started with zero).
   @param  ResetIsNeeded         The boolean to control whether skip the reset of the port.
+  @param  Debounced             TRUE if the caller already waited for the connection to be stable.
 
   @retval EFI_SUCCESS           The device is enumerated (added or removed).
   @retval EFI_OUT_OF_RESOURCES  Failed to allocate resource for the device.
@@ -663,7 +664,8 @@ EFI_STATUS
 UsbEnumerateNewDev (
   IN USB_INTERFACE        *HubIf,
   IN UINT8                Port,
-  IN BOOLEAN              ResetIsNeeded
+  IN BOOLEAN              ResetIsNeeded,
+  IN BOOLEAN              Debounced
   )
 {
   USB_BUS                 *Bus;
@@ -680,7 +682,9 @@ UsbEnumerateNewDev (
   HubApi  = HubIf->HubApi;
   Address = Bus->MaxDevices;
 
-  gBS->Stall (USB_WAIT_PORT_STABLE_STALL);
+  if (!Debounced) {
+    gBS->Stall (USB_WAIT_PORT_STABLE_STALL);
+  }
 
   //
   // Hub resets the device for at least 10 milliseconds.
@@ -876,6 +880,8 @@ ON_ERROR:
 
   @param  HubIf                 The HUB that has the device connected.
   @param  Port                  The port index of the hub (started with zero).
+  @param  Debounced             TRUE if the caller already waited for a new
+                                connection on the port to be stable.
 
   @retval EFI_SUCCESS           The device is enumerated (added or removed).
   @retval EFI_OUT_OF_RESOURCES  Failed to allocate resource for the device.
@@ -885,7 +891,8 @@ ON_ERROR:
 EFI_STATUS
 UsbEnumeratePort (
   IN USB_INTERFACE        *HubIf,
-  IN UINT8                Port
+  IN UINT8                Port,
+  IN BOOLEAN              Debounced
   )
 {
   USB_HUB_API             *HubApi;
@@ -979,9 +986,9 @@ UsbEnumeratePort (
     //
     DEBUG (( EFI_D_INFO, "UsbEnumeratePort: new device connected at port %d\n", Port));
     if (USB_BIT_IS_SET (PortState.PortChangeStatus, USB_PORT_STAT_C_RESET)) {
-      Status = UsbEnumerateNewDev (HubIf, Port, FALSE);
+      Status = UsbEnumerateNewDev (HubIf, Port, FALSE, Debounced);
     } else {
-      Status = UsbEnumerateNewDev (HubIf, Port, TRUE);
+      Status = UsbEnumerateNewDev (HubIf, Port, TRUE, Debounced);
     }
 
   } else {
@@ -993,6 +1000,64 @@ UsbEnumeratePort (
 }
 
 
+/**
+  Wait once for the new connections on the hub ports to be stable.
+
+  A newly connected device needs USB_WAIT_PORT_STABLE_STALL to settle before
+  its port is reset. Waiting once for all the ports with a new connection,
+  instead of once per port, keeps the enumeration of a hub with several
+  devices attached close to the time of a single device. The port resets and
+  the rest of the enumeration stay serialized, because every device answers
+  at the default address after its port is reset.
+
+  @param  HubIf                 The HUB interface.
+  @param  ChangeMap             The port change bitmap of the hub (port
+                                index starts with 1), NULL for all ports.
+  @param  Debounced             On return, TRUE for the ports (index started
+                                with zero) whose new connection is stable.
+
+**/
+VOID
+UsbDebounceNewConnections (
+  IN  USB_INTERFACE       *HubIf,
+  IN  UINT8               *ChangeMap,    OPTIONAL
+  OUT BOOLEAN             *Debounced
+  )
+{
+  USB_HUB_API             *HubApi;
+  EFI_USB_PORT_STATUS     PortState;
+  EFI_STATUS              Status;
+  BOOLEAN                 NeedStall;
+  UINT8                   Byte;
+  UINT8                   Bit;
+  UINT8                   Index;
+
+  HubApi    = HubIf->HubApi;
+  NeedStall = FALSE;
+  Byte      = 0;
+  Bit       = 1;
+
+  for (Index = 0; Index < HubIf->NumOfPort; Index++) {
+    Debounced[Index] = FALSE;
+
+    if ((ChangeMap == NULL) || USB_BIT_IS_SET (ChangeMap[Byte], USB_BIT (Bit))) {
+      Status = HubApi->GetPortStatus (HubIf, Index, &PortState);
+      if (!EFI_ERROR (Status) &&
+          ((PortState.PortChangeStatus & (USB_PORT_STAT_C_CONNECTION | USB_PORT_STAT_C_ENABLE | USB_PORT_STAT_C_OVERCURRENT | USB_PORT_STAT_C_RESET)) != 0) &&
+          USB_BIT_IS_SET (PortState.PortStatus, USB_PORT_STAT_CONNECTION)) {
+        Debounced[Index] = TRUE;
+        NeedStall        = TRUE;
+      }
+    }
+
+    USB_NEXT_BIT (Byte, Bit);
+  }
+
+  if (NeedStall) {
+    gBS->Stall (USB_WAIT_PORT_STABLE_STALL);
+  }
+}
+
 /**
   Enumerate all the changed hub ports.
 
@@ -1012,6 +1077,7 @@ UsbHubEnumeration (
   UINT8                   Bit;
   UINT8                   Index;
   USB_DEVICE              *Child;
+  BOOLEAN                 Debounced[MAX_UINT8 + 1];
 
   ASSERT (Context != NULL);
 
@@ -1029,6 +1095,8 @@ UsbHubEnumeration (
     return ;
   }
 
+  UsbDebounceNewConnections (HubIf, HubIf->ChangeMap, Debounced);
+
   //
   // HUB starts its port index with 1.
   //
@@ -1037,7 +1105,7 @@ UsbHubEnumeration (
 
   for (Index = 0; Index < HubIf->NumOfPort; Index++) {
     if (USB_BIT_IS_SET (HubIf->ChangeMap[Byte], USB_BIT (Bit))) {
-      UsbEnumeratePort (HubIf, Index);
+      UsbEnumeratePort (HubIf, Index, Debounced[Index]);
     }
 
     USB_NEXT_BIT (Byte, Bit);
@@ -1068,6 +1136,7 @@ UsbRootHubEnumeration (
   USB_INTERFACE           *RootHub;
   UINT8                   Index;
   USB_DEVICE              *Child;
+  BOOLEAN                 Debounced[MAX_UINT8 + 1];
 
   RootHub = (USB_INTERFACE *) Context;
 
@@ -1077,7 +1146,11 @@ UsbRootHubEnumeration (
       DEBUG (( EFI_D_INFO, "UsbEnumeratePort: The device disconnect fails at port %d from root hub %p, try again\n", Index, RootHub));
       UsbRemoveDevice (Child);
     }
+  }
 
-    UsbEnumeratePort (RootHub, Index);
+  UsbDebounceNewConnections (RootHub, NULL, Debounced);
+
+  for (Index = 0; Index < RootHub->NumOfPort; Index++) {
+    UsbEnumeratePort (RootHub, Index, Debounced[Index]);
   }
 }
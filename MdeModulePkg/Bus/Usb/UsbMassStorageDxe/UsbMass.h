@@ -25,6 +25,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Library/UefiLib.h>
 #include <Library/MemoryAllocationLib.h>
 #include <Library/DevicePathLib.h>
+#include <Library/PcdLib.h>
 
 typedef struct _USB_MASS_TRANSPORT USB_MASS_TRANSPORT;
 typedef struct _USB_MASS_DEVICE    USB_MASS_DEVICE;
@@ -182,6 +183,8 @@ struct _USB_MASS_DEVICE {
   EFI_DISK_INFO_PROTOCOL    DiskInfo;
   USB_BOOT_INQUIRY_DATA     InquiryData;
   BOOLEAN                   Cdb16Byte;
+  UINT32                    MaxCarrySize;      ///< Max bytes of one READ/WRITE command
+  UINT32                    MaxTransferLength; ///< Max blocks of one READ/WRITE command, 0 if no limit
 };
 
 #endif
@@ -393,6 +393,154 @@ UsbBootInquiry (
   return Status;
 }
 
+/**
+  Execute INQUIRY Command to retrieve the Block Limits VPD page, and record
+  the MAXIMUM TRANSFER LENGTH of the device.
+
+  Many USB flash disks fail or even hang on VPD requests, so the command is
+  only sent to devices claiming SPC-3 compliance. The MaxTransferLength field
+  of the device is left unchanged if the page can't be retrieved.
+
+  @param  UsbMass                The device to inquire.
+
+  @retval EFI_SUCCESS            The Block Limits VPD page is retrieved.
+  @retval EFI_UNSUPPORTED        The device doesn't claim SPC-3 compliance.
+  @retval Others                 INQUIRY Command is not executed successfully.
+
+**/
+EFI_STATUS
+UsbBootInquiryBlockLimits (
+  IN USB_MASS_DEVICE            *UsbMass
+  )
+{
+  UINT8                          InquiryCmd[6];
+  EFI_SCSI_BLOCK_LIMITS_VPD_PAGE BlockLimits;
+  EFI_STATUS                     Status;
+
+  //
+  // The version field is the 3rd byte of the standard inquiry data.
+  //
+  if (UsbMass->InquiryData.Reserved0[0] < USB_BOOT_INQUIRY_VERSION_SPC3) {
+    return EFI_UNSUPPORTED;
+  }
+
+  ZeroMem (InquiryCmd, sizeof (InquiryCmd));
+  ZeroMem (&BlockLimits, sizeof (BlockLimits));
+
+  InquiryCmd[0] = EFI_SCSI_OP_INQUIRY;
+  InquiryCmd[1] = (UINT8) (USB_BOOT_LUN (UsbMass->Lun) | BIT0);
+  InquiryCmd[2] = EFI_SCSI_PAGE_CODE_BLOCK_LIMITS_VPD;
+  WriteUnaligned16 ((UINT16 *) &InquiryCmd[3], SwapBytes16 ((UINT16) sizeof (BlockLimits)));
+
+  //
+  // Don't retry, a device that doesn't know the page is not worth insisting on.
+  //
+  Status = UsbBootExecCmd (
+             UsbMass,
+             InquiryCmd,
+             (UINT8) sizeof (InquiryCmd),
+             EfiUsbDataIn,
+             &BlockLimits,
+             sizeof (BlockLimits),
+             USB_BOOT_GENERAL_CMD_TIMEOUT
+             );
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  if (BlockLimits.PageCode != EFI_SCSI_PAGE_CODE_BLOCK_LIMITS_VPD) {
+    return EFI_DEVICE_ERROR;
+  }
+
+  UsbMass->MaxTransferLength = (BlockLimits.MaximumTransferLength4 << 24) |
+                               (BlockLimits.MaximumTransferLength3 << 16) |
+                               (BlockLimits.MaximumTransferLength2 << 8)  |
+                               BlockLimits.MaximumTransferLength1;
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Decide how many bytes one READ/WRITE command may carry.
+
+  The 64KB default is kept for CBI devices and devices slower than SuperSpeed,
+  which are known to choke on larger requests. SuperSpeed Bulk-Only devices use
+  PcdUsbMassMaxTransferSize, further limited by the Block Limits VPD page.
+
+  @param  UsbMass                The device to configure.
+
+**/
+VOID
+UsbBootInitCarrySize (
+  IN USB_MASS_DEVICE            *UsbMass
+  )
+{
+  EFI_USB_INTERFACE_DESCRIPTOR  Interface;
+  EFI_USB_ENDPOINT_DESCRIPTOR   EndPoint;
+  EFI_STATUS                    Status;
+  UINT8                         Index;
+
+  if ((UsbMass->Transport->Protocol != USB_MASS_STORE_BOT) ||
+      (PcdGet32 (PcdUsbMassMaxTransferSize) <= USB_BOOT_MAX_CARRY_SIZE)) {
+    return;
+  }
+
+  Status = UsbMass->UsbIo->UsbGetInterfaceDescriptor (UsbMass->UsbIo, &Interface);
+  if (EFI_ERROR (Status)) {
+    return;
+  }
+
+  for (Index = 0; Index < Interface.NumEndpoints; Index++) {
+    Status = UsbMass->UsbIo->UsbGetEndpointDescriptor (UsbMass->UsbIo, Index, &EndPoint);
+    if (EFI_ERROR (Status) || (USB_IS_BULK_ENDPOINT (EndPoint.Attributes) == FALSE)) {
+      continue;
+    }
+
+    if (EndPoint.MaxPacketSize < USB_BOOT_SS_BULK_MAX_PACKET) {
+      return;
+    }
+  }
+
+  UsbMass->MaxCarrySize = PcdGet32 (PcdUsbMassMaxTransferSize);
+
+  if ((UsbMass->Pdt == USB_PDT_DIRECT_ACCESS) &&
+      (Interface.InterfaceSubClass == USB_MASS_STORE_SCSI)) {
+    Status = UsbBootInquiryBlockLimits (UsbMass);
+    DEBUG ((DEBUG_INFO, "UsbBootInitCarrySize: UsbBootInquiryBlockLimits (%r)\n", Status));
+  }
+
+  DEBUG ((
+    DEBUG_INFO, "UsbBootInitCarrySize: MaxCarrySize 0x%x, MaxTransferLength 0x%x\n",
+    UsbMass->MaxCarrySize, UsbMass->MaxTransferLength
+    ));
+}
+
+/**
+  Get the number of blocks one READ/WRITE command may carry.
+
+  @param  UsbMass                The device to access.
+  @param  BlockSize              The block size of the media.
+
+  @return The number of blocks, at least one.
+
+**/
+UINT32
+UsbBootGetCountMax (
+  IN USB_MASS_DEVICE            *UsbMass,
+  IN UINT32                     BlockSize
+  )
+{
+  UINT32                        CountMax;
+
+  CountMax = MAX (UsbMass->MaxCarrySize, USB_BOOT_MAX_CARRY_SIZE) / BlockSize;
+
+  if ((UsbMass->MaxTransferLength != 0) && (CountMax > UsbMass->MaxTransferLength)) {
+    CountMax = UsbMass->MaxTransferLength;
+  }
+
+  return MAX (CountMax, 1);
+}
+
 /**
   Execute READ CAPACITY 16 bytes command to request information regarding
   the capacity of the installed medium of the device.
@@ -629,6 +777,9 @@ UsbBootGetParams (
 
   Media  = &(UsbMass->BlockIoMedia);
 
+  UsbMass->MaxCarrySize      = USB_BOOT_MAX_CARRY_SIZE;
+  UsbMass->MaxTransferLength = 0;
+
   Status = UsbBootInquiry (UsbMass);
   if (EFI_ERROR (Status)) {
     DEBUG ((EFI_D_ERROR, "UsbBootGetParams: UsbBootInquiry (%r)\n", Status));
@@ -662,6 +813,8 @@ UsbBootGetParams (
     Media->BlockSize        = 0x0800;
   }
 
+  UsbBootInitCarrySize (UsbMass);
+
   Status = UsbBootDetectMedia (UsbMass);
 
   return Status;
@@ -823,7 +976,7 @@ UsbBootReadWriteBlocks (
   UINT32                     Timeout;
 
   BlockSize = UsbMass->BlockIoMedia.BlockSize;
-  CountMax  = USB_BOOT_MAX_CARRY_SIZE / BlockSize;
+  CountMax  = UsbBootGetCountMax (UsbMass, BlockSize);
   Status    = EFI_SUCCESS;
 
   while (TotalBlock > 0) {
@@ -906,7 +1059,7 @@ UsbBootReadWriteBlocks16 (
   UINT32                    Timeout;
 
   BlockSize = UsbMass->BlockIoMedia.BlockSize;
-  CountMax  = USB_BOOT_MAX_CARRY_SIZE / BlockSize;
+  CountMax  = UsbBootGetCountMax (UsbMass, BlockSize);
   Status    = EFI_SUCCESS;
 
   while (TotalBlock > 0) {
@@ -63,6 +63,16 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 //
 #define USB_BOOT_MAX_CARRY_SIZE         SIZE_64KB
 
+//
+// Max packet size of a SuperSpeed bulk endpoint, refers to specification[USB30-9.6.6]
+//
+#define USB_BOOT_SS_BULK_MAX_PACKET     1024
+
+//
+// Lowest INQUIRY version that is expected to support the Block Limits VPD page (SPC-3)
+//
+#define USB_BOOT_INQUIRY_VERSION_SPC3   0x05
+
 //
 // Retry mass command times, set by experience
 //
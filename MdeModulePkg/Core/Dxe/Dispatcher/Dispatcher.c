@@ -454,15 +454,34 @@ CoreDispatcher (
       // skip the LoadImage
       //
       if (DriverEntry->ImageHandle == NULL && !DriverEntry->IsFvImage) {
+        //
+        // Decode the images of the next drivers on the application processors
+        //
+        if (FeaturePcdGet (PcdDxeParallelImageDecode) && !DriverEntry->ImageDecoded) {
+          CoreDecodeScheduledImages (DriverEntry);
+        }
+
         DEBUG ((DEBUG_INFO, "Loading driver %g\n", &DriverEntry->FileName));
-        Status = CoreLoadImage (
-                        FALSE,
-                        gDxeCoreImageHandle,
-                        DriverEntry->FvFileDevicePath,
-                        NULL,
-                        0,
-                        &DriverEntry->ImageHandle
-                        );
+        if (DriverEntry->ImageBuffer != NULL) {
+          Status = CoreLoadImageFromFvBuffer (
+                     gDxeCoreImageHandle,
+                     DriverEntry->FvFileDevicePath,
+                     DriverEntry->ImageBuffer,
+                     DriverEntry->ImageBufferSize,
+                     0,
+                     &DriverEntry->ImageHandle
+                     );
+          CoreFreeDriverImageBuffer (DriverEntry);
+        } else {
+          Status = CoreLoadImage (
+                          FALSE,
+                          gDxeCoreImageHandle,
+                          DriverEntry->FvFileDevicePath,
+                          NULL,
+                          0,
+                          &DriverEntry->ImageHandle
+                          );
+        }
 
         //
         // Update the driver state to reflect that it's been loaded
@@ -0,0 +1,446 @@
+/** @file
+  Decode the PE32 images of scheduled DXE drivers on the application
+  processors.
+
+  Before the dispatcher loads a scheduled driver it may read the FFS files of
+  the next drivers on the mScheduledQueue, and hand the decompression of their
+  compressed or GUIDed encapsulation sections to the application processors
+  through the MP Services Protocol. The boot processor helps with the work and
+  then loads and starts the drivers in order from the decoded PE32 images.
+
+  Only sections that cannot carry an authentication status are decoded this
+  way, so LoadImage () sees the same authentication status as when it reads
+  the image from the firmware volume itself. The job procedure runs on the
+  application processors and must not use any boot service.
+
+Copyright (c) 2021, EDK II contributors. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "DxeMain.h"
+
+//
+// Maximum number of drivers decoded in one batch.
+//
+#define IMAGE_DECODE_BATCH_SIZE   32
+
+typedef struct {
+  EFI_CORE_DRIVER_ENTRY           *DriverEntry;
+  ///
+  /// The FFS file data read from the firmware volume
+  ///
+  VOID                            *File;
+  ///
+  /// The encapsulation section to decode
+  ///
+  EFI_COMMON_SECTION_HEADER       *Section;
+  VOID                            *Source;
+  UINT32                          SourceSize;
+  BOOLEAN                         Guided;
+  VOID                            *Destination;
+  VOID                            *Output;
+  UINT32                          OutputSize;
+  VOID                            *Scratch;
+  EFI_STATUS                      Status;
+} IMAGE_DECODE_JOB;
+
+typedef struct {
+  IMAGE_DECODE_JOB                *Jobs;
+  UINT32                          JobCount;
+  volatile UINT32                 NextJob;
+} IMAGE_DECODE_CONTEXT;
+
+extern LIST_ENTRY  mScheduledQueue;
+
+/**
+  Find the first section of the specified type in a section stream.
+
+  @param  Stream                The section stream.
+  @param  StreamSize            The size in bytes of the section stream.
+  @param  SectionType           The type of section to find.
+
+  @return The header of the section, or NULL if it is not in the stream.
+
+**/
+STATIC
+EFI_COMMON_SECTION_HEADER *
+CoreFindSectionInStream (
+  IN VOID                 *Stream,
+  IN UINTN                StreamSize,
+  IN EFI_SECTION_TYPE     SectionType
+  )
+{
+  EFI_COMMON_SECTION_HEADER  *Section;
+  UINTN                      Offset;
+  UINTN                      Size;
+
+  Offset = 0;
+  while (Offset + sizeof (EFI_COMMON_SECTION_HEADER) <= StreamSize) {
+    Section = (EFI_COMMON_SECTION_HEADER *)((UINT8 *)Stream + Offset);
+    if (IS_SECTION2 (Section)) {
+      if (Offset + sizeof (EFI_COMMON_SECTION_HEADER2) > StreamSize) {
+        break;
+      }
+      Size = SECTION2_SIZE (Section);
+    } else {
+      Size = SECTION_SIZE (Section);
+    }
+    if (Size < sizeof (EFI_COMMON_SECTION_HEADER) || Size > StreamSize - Offset) {
+      break;
+    }
+
+    if (Section->Type == SectionType) {
+      return Section;
+    }
+
+    Offset += ALIGN_VALUE (Size, 4);
+  }
+
+  return NULL;
+}
+
+/**
+  Return the data and the data size of a section.
+
+  @param  Section               The header of the section.
+  @param  DataSize              Return the size in bytes of the section data.
+
+  @return The section data.
+
+**/
+STATIC
+VOID *
+CoreGetSectionData (
+  IN  EFI_COMMON_SECTION_HEADER  *Section,
+  OUT UINT32                     *DataSize
+  )
+{
+  if (IS_SECTION2 (Section)) {
+    *DataSize = SECTION2_SIZE (Section) - sizeof (EFI_COMMON_SECTION_HEADER2);
+    return (UINT8 *)Section + sizeof (EFI_COMMON_SECTION_HEADER2);
+  }
+  *DataSize = SECTION_SIZE (Section) - sizeof (EFI_COMMON_SECTION_HEADER);
+  return (UINT8 *)Section + sizeof (EFI_COMMON_SECTION_HEADER);
+}
+
+/**
+  Read the FFS file of a scheduled driver and set up the decode job of its
+  encapsulated PE32 image.
+
+  @param  Job                   The job to set up. Job->DriverEntry is set.
+
+  @retval EFI_SUCCESS           The job is ready to run.
+  @retval EFI_UNSUPPORTED       The image of the driver is not decoded ahead.
+  @retval EFI_OUT_OF_RESOURCES  No enough buffer to allocate.
+
+**/
+STATIC
+EFI_STATUS
+CorePrepareImageDecodeJob (
+  IN OUT IMAGE_DECODE_JOB  *Job
+  )
+{
+  EFI_STATUS                 Status;
+  EFI_CORE_DRIVER_ENTRY      *DriverEntry;
+  UINTN                      FileSize;
+  EFI_FV_FILETYPE            FileType;
+  EFI_FV_FILE_ATTRIBUTES     FileAttributes;
+  UINT32                     AuthenticationStatus;
+  EFI_COMMON_SECTION_HEADER  *Section;
+  UINT16                     SectionAttribute;
+  UINT8                      CompressionType;
+  UINT32                     OutputSize;
+  UINT32                     ScratchSize;
+
+  DriverEntry = Job->DriverEntry;
+  Job->File   = NULL;
+  FileSize    = 0;
+  Status = DriverEntry->Fv->ReadFile (
+                              DriverEntry->Fv,
+                              &DriverEntry->FileName,
+                              &Job->File,
+                              &FileSize,
+                              &FileType,
+                              &FileAttributes,
+                              &AuthenticationStatus
+                              );
+  if (EFI_ERROR (Status)) {
+    Job->File = NULL;
+    return EFI_UNSUPPORTED;
+  }
+
+  Status = EFI_UNSUPPORTED;
+  if (AuthenticationStatus != 0 ||
+      CoreFindSectionInStream (Job->File, FileSize, EFI_SECTION_PE32) != NULL ||
+      CoreFindSectionInStream (Job->File, FileSize, EFI_SECTION_TE) != NULL) {
+    //
+    // The image is either plain already or carries authentication status.
+    //
+    goto Done;
+  }
+
+  Section = CoreFindSectionInStream (Job->File, FileSize, EFI_SECTION_COMPRESSION);
+  if (Section != NULL) {
+    if (IS_SECTION2 (Section)) {
+      CompressionType = ((EFI_COMPRESSION_SECTION2 *)Section)->CompressionType;
+      Job->Source     = (EFI_COMPRESSION_SECTION2 *)Section + 1;
+      Job->SourceSize = SECTION2_SIZE (Section) - sizeof (EFI_COMPRESSION_SECTION2);
+    } else {
+      CompressionType = ((EFI_COMPRESSION_SECTION *)Section)->CompressionType;
+      Job->Source     = (EFI_COMPRESSION_SECTION *)Section + 1;
+      Job->SourceSize = SECTION_SIZE (Section) - sizeof (EFI_COMPRESSION_SECTION);
+    }
+    if (CompressionType != EFI_STANDARD_COMPRESSION) {
+      goto Done;
+    }
+    Status = UefiDecompressGetInfo (Job->Source, Job->SourceSize, &OutputSize, &ScratchSize);
+    Job->Guided = FALSE;
+  } else {
+    Section = CoreFindSectionInStream (Job->File, FileSize, EFI_SECTION_GUID_DEFINED);
+    if (Section == NULL) {
+      goto Done;
+    }
+    if (IS_SECTION2 (Section)) {
+      SectionAttribute = ((EFI_GUID_DEFINED_SECTION2 *)Section)->Attributes;
+    } else {
+      SectionAttribute = ((EFI_GUID_DEFINED_SECTION *)Section)->Attributes;
+    }
+    if ((SectionAttribute & EFI_GUIDED_SECTION_PROCESSING_REQUIRED) == 0 ||
+        (SectionAttribute & EFI_GUIDED_SECTION_AUTH_STATUS_VALID) != 0) {
+      goto Done;
+    }
+    Status = ExtractGuidedSectionGetInfo (Section, &OutputSize, &ScratchSize, &SectionAttribute);
+    Job->Guided = TRUE;
+  }
+  if (EFI_ERROR (Status) || OutputSize == 0) {
+    Status = EFI_UNSUPPORTED;
+    goto Done;
+  }
+
+  Job->Section     = Section;
+  Job->Destination = AllocatePool (OutputSize);
+  Job->Scratch     = (ScratchSize != 0) ? AllocatePool (ScratchSize) : NULL;
+  if (Job->Destination == NULL || (ScratchSize != 0 && Job->Scratch == NULL)) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto Done;
+  }
+  Job->Output     = Job->Destination;
+  Job->OutputSize = OutputSize;
+  Job->Status     = EFI_NOT_STARTED;
+  return EFI_SUCCESS;
+
+Done:
+  if (Job->Destination != NULL) {
+    CoreFreePool (Job->Destination);
+    Job->Destination = NULL;
+  }
+  if (Job->Scratch != NULL) {
+    CoreFreePool (Job->Scratch);
+    Job->Scratch = NULL;
+  }
+  CoreFreePool (Job->File);
+  Job->File = NULL;
+  return Status;
+}
+
+/**
+  Run decode jobs until there are none left. This is run on the application
+  processors and the boot processor in parallel.
+
+  @param  Buffer                The IMAGE_DECODE_CONTEXT of the batch.
+
+**/
+STATIC
+VOID
+EFIAPI
+CoreRunImageDecodeJobs (
+  IN OUT VOID  *Buffer
+  )
+{
+  IMAGE_DECODE_CONTEXT       *Context;
+  IMAGE_DECODE_JOB           *Job;
+  UINT32                     Index;
+  UINT32                     AuthenticationStatus;
+
+  Context = (IMAGE_DECODE_CONTEXT *)Buffer;
+  for (;;) {
+    Index = InterlockedIncrement (&Context->NextJob) - 1;
+    if (Index >= Context->JobCount) {
+      break;
+    }
+
+    Job = &Context->Jobs[Index];
+    if (Job->Guided) {
+      AuthenticationStatus = 0;
+      Job->Status = ExtractGuidedSectionDecode (
+                      Job->Section,
+                      &Job->Output,
+                      Job->Scratch,
+                      &AuthenticationStatus
+                      );
+      if (!EFI_ERROR (Job->Status) && AuthenticationStatus != 0) {
+        Job->Status = EFI_UNSUPPORTED;
+      }
+    } else {
+      Job->Status = UefiDecompress (Job->Source, Job->Destination, Job->Scratch);
+    }
+  }
+}
+
+/**
+  Free the decoded image of a driver, if any.
+
+  @param  DriverEntry           The driver entry.
+
+**/
+VOID
+CoreFreeDriverImageBuffer (
+  IN EFI_CORE_DRIVER_ENTRY  *DriverEntry
+  )
+{
+  if (DriverEntry->ImageFile != NULL) {
+    CoreFreePool (DriverEntry->ImageFile);
+  }
+  if (DriverEntry->ImageData != NULL) {
+    CoreFreePool (DriverEntry->ImageData);
+  }
+  DriverEntry->ImageFile       = NULL;
+  DriverEntry->ImageData       = NULL;
+  DriverEntry->ImageBuffer     = NULL;
+  DriverEntry->ImageBufferSize = 0;
+}
+
+/**
+  Decode the PE32 images of the drivers at the head of the mScheduledQueue on
+  the application processors.
+
+  For every driver that gets a decoded image, DriverEntry->ImageBuffer and
+  DriverEntry->ImageBufferSize are set. Drivers that are not decoded ahead are
+  loaded from the firmware volume as before.
+
+  @param  FirstEntry            The first scheduled driver of the batch.
+
+**/
+VOID
+CoreDecodeScheduledImages (
+  IN EFI_CORE_DRIVER_ENTRY  *FirstEntry
+  )
+{
+  EFI_STATUS                 Status;
+  EFI_MP_SERVICES_PROTOCOL   *MpServices;
+  UINTN                      NumberOfProcessors;
+  UINTN                      NumberOfEnabledProcessors;
+  IMAGE_DECODE_CONTEXT       Context;
+  IMAGE_DECODE_JOB           *Job;
+  LIST_ENTRY                 *Link;
+  EFI_CORE_DRIVER_ENTRY      *DriverEntry;
+  EFI_COMMON_SECTION_HEADER  *Section;
+  EFI_EVENT                  WaitEvent;
+  UINTN                      EventIndex;
+  UINT32                     Index;
+  UINT32                     ImageSize;
+
+  //
+  // The boot processor waits for the application processors with WaitForEvent ()
+  //
+  if (gEfiCurrentTpl != TPL_APPLICATION) {
+    return;
+  }
+
+  Status = CoreLocateProtocol (&gEfiMpServiceProtocolGuid, NULL, (VOID **)&MpServices);
+  if (EFI_ERROR (Status)) {
+    return;
+  }
+  Status = MpServices->GetNumberOfProcessors (MpServices, &NumberOfProcessors, &NumberOfEnabledProcessors);
+  if (EFI_ERROR (Status) || NumberOfEnabledProcessors < 2) {
+    return;
+  }
+
+  Context.Jobs = AllocateZeroPool (IMAGE_DECODE_BATCH_SIZE * sizeof (IMAGE_DECODE_JOB));
+  if (Context.Jobs == NULL) {
+    return;
+  }
+  Context.JobCount = 0;
+  Context.NextJob  = 0;
+
+  //
+  // Read the FFS files of the batch on the boot processor
+  //
+  for (Link = &FirstEntry->ScheduledLink;
+       Link != &mScheduledQueue && Context.JobCount < IMAGE_DECODE_BATCH_SIZE;
+       Link = Link->ForwardLink) {
+    DriverEntry = CR (Link, EFI_CORE_DRIVER_ENTRY, ScheduledLink, EFI_CORE_DRIVER_ENTRY_SIGNATURE);
+    if (DriverEntry->ImageDecoded || DriverEntry->ImageHandle != NULL || DriverEntry->IsFvImage) {
+      continue;
+    }
+    DriverEntry->ImageDecoded = TRUE;
+
+    Job = &Context.Jobs[Context.JobCount];
+    Job->DriverEntry = DriverEntry;
+    if (!EFI_ERROR (CorePrepareImageDecodeJob (Job))) {
+      Context.JobCount++;
+    } else {
+      ZeroMem (Job, sizeof (IMAGE_DECODE_JOB));
+    }
+  }
+
+  if (Context.JobCount != 0) {
+    //
+    // Run the jobs on all processors. If the application processors cannot
+    // be started, the boot processor runs all of them.
+    //
+    WaitEvent = NULL;
+    Status = CoreCreateEvent (EVT_NOTIFY_WAIT, TPL_CALLBACK, EfiEventEmptyFunction, NULL, &WaitEvent);
+    if (!EFI_ERROR (Status)) {
+      Status = MpServices->StartupAllAPs (
+                             MpServices,
+                             CoreRunImageDecodeJobs,
+                             FALSE,
+                             WaitEvent,
+                             0,
+                             &Context,
+                             NULL
+                             );
+    }
+    CoreRunImageDecodeJobs (&Context);
+    if (!EFI_ERROR (Status)) {
+      CoreWaitForEvent (1, &WaitEvent, &EventIndex);
+    }
+    if (WaitEvent != NULL) {
+      CoreCloseEvent (WaitEvent);
+    }
+  }
+
+  //
+  // Pick the PE32 image out of every decoded section stream
+  //
+  for (Index = 0; Index < Context.JobCount; Index++) {
+    Job = &Context.Jobs[Index];
+    if (Job->Scratch != NULL) {
+      CoreFreePool (Job->Scratch);
+    }
+
+    Section = NULL;
+    if (!EFI_ERROR (Job->Status)) {
+      Section = CoreFindSectionInStream (Job->Output, Job->OutputSize, EFI_SECTION_PE32);
+      if (Section == NULL) {
+        Section = CoreFindSectionInStream (Job->Output, Job->OutputSize, EFI_SECTION_TE);
+      }
+    }
+
+    DriverEntry = Job->DriverEntry;
+    if (Section == NULL) {
+      CoreFreePool (Job->Destination);
+      CoreFreePool (Job->File);
+      continue;
+    }
+
+    DriverEntry->ImageFile       = Job->File;
+    DriverEntry->ImageData       = Job->Destination;
+    DriverEntry->ImageBuffer     = CoreGetSectionData (Section, &ImageSize);
+    DriverEntry->ImageBufferSize = ImageSize;
+  }
+
+  CoreFreePool (Context.Jobs);
+}
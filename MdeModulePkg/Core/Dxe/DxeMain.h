@@ -47,6 +47,8 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Protocol/HiiPackageList.h>
 #include <Protocol/SmmBase2.h>
 #include <Protocol/PeCoffImageEmulator.h>
+#include <Protocol/FileBulkRead.h>
+#include <Protocol/MpService.h>
 #include <Guid/MemoryTypeInformation.h>
 #include <Guid/FirmwareFileSystem2.h>
 #include <Guid/FirmwareFileSystem3.h>
@@ -64,6 +66,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Guid/VectorHandoffTable.h>
 #include <Ppi/VectorHandoffInfo.h>
 #include <Guid/MemoryProfile.h>
+#include <Guid/FvFileDirectory.h>
 
 #include <Library/DxeCoreEntryPoint.h>
 #include <Library/DebugLib.h>
@@ -86,6 +89,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Library/DxeServicesLib.h>
 #include <Library/DebugAgentLib.h>
 #include <Library/CpuExceptionHandlerLib.h>
+#include <Library/SynchronizationLib.h>
 
 
 //
@@ -166,6 +170,12 @@ typedef struct {
   EFI_HANDLE                      ImageHandle;
   BOOLEAN                         IsFvImage;
 
+  BOOLEAN                         ImageDecoded;     // Decoding ahead was attempted
+  VOID                            *ImageFile;       // FFS file the image was decoded from
+  VOID                            *ImageData;       // Decoded section stream
+  VOID                            *ImageBuffer;     // PE32 image within ImageData or ImageFile
+  UINTN                           ImageBufferSize;
+
 } EFI_CORE_DRIVER_ENTRY;
 
 //
@@ -483,6 +493,35 @@ CoreInitializeDispatcher (
   );
 
 
+/**
+  Decode the PE32 images of the drivers at the head of the mScheduledQueue on
+  the application processors.
+
+  For every driver that gets a decoded image, DriverEntry->ImageBuffer and
+  DriverEntry->ImageBufferSize are set. Drivers that are not decoded ahead are
+  loaded from the firmware volume as before.
+
+  @param  FirstEntry            The first scheduled driver of the batch.
+
+**/
+VOID
+CoreDecodeScheduledImages (
+  IN EFI_CORE_DRIVER_ENTRY  *FirstEntry
+  );
+
+
+/**
+  Free the decoded image of a driver, if any.
+
+  @param  DriverEntry           The driver entry.
+
+**/
+VOID
+CoreFreeDriverImageBuffer (
+  IN EFI_CORE_DRIVER_ENTRY  *DriverEntry
+  );
+
+
 /**
   This is the POSTFIX version of the dependency evaluator.  This code does
   not need to handle Before or After, as it is not valid to call this
@@ -1438,6 +1477,34 @@ CoreLoadImage (
   );
 
 
+/**
+  Loads an EFI image that was read from a firmware volume file into memory,
+  and returns a handle to the image. The image is authenticated as an image
+  read from the firmware volume with the specified authentication status.
+
+  @param  ParentImageHandle       The caller's image handle.
+  @param  FilePath                The firmware volume file path of the image.
+  @param  SourceBuffer            The image read from the firmware volume file.
+  @param  SourceSize              The size in bytes of SourceBuffer.
+  @param  AuthenticationStatus    The authentication status of the image.
+  @param  ImageHandle             Pointer to the returned image handle that is
+                                  created when the image is successfully loaded.
+
+  @retval EFI_SUCCESS             The image was loaded into memory.
+  @retval Others                  See CoreLoadImage ().
+
+**/
+EFI_STATUS
+CoreLoadImageFromFvBuffer (
+  IN EFI_HANDLE                 ParentImageHandle,
+  IN EFI_DEVICE_PATH_PROTOCOL   *FilePath,
+  IN VOID                       *SourceBuffer,
+  IN UINTN                      SourceSize,
+  IN UINT32                     AuthenticationStatus,
+  OUT EFI_HANDLE                *ImageHandle
+  );
+
+
 
 /**
   Unloads an image.
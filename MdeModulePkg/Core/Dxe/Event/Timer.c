@@ -10,11 +10,36 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include "DxeMain.h"
 #include "Event.h"
 
+//
+// The timer database is a hierarchical timer wheel. System time is split
+// into ticks of 2^TIMER_WHEEL_TICK_SHIFT 100ns units. Level 0 has one slot
+// per tick for the next TIMER_WHEEL_ROOT_SLOTS ticks, every higher level
+// covers TIMER_WHEEL_LEVEL_SLOTS times the span of the level below. Timers
+// of higher levels are moved down a level when the level below wraps.
+//
+#define TIMER_WHEEL_TICK_SHIFT    16
+#define TIMER_WHEEL_ROOT_BITS     8
+#define TIMER_WHEEL_LEVEL_BITS    6
+#define TIMER_WHEEL_LEVELS        4
+#define TIMER_WHEEL_ROOT_SLOTS    (1 << TIMER_WHEEL_ROOT_BITS)
+#define TIMER_WHEEL_LEVEL_SLOTS   (1 << TIMER_WHEEL_LEVEL_BITS)
+#define TIMER_WHEEL_SLOTS         (TIMER_WHEEL_ROOT_SLOTS + \
+                                   (TIMER_WHEEL_LEVELS - 1) * TIMER_WHEEL_LEVEL_SLOTS)
+#define TIMER_WHEEL_LEVEL_SHIFT(Level) \
+  (TIMER_WHEEL_ROOT_BITS + ((Level) - 1) * TIMER_WHEEL_LEVEL_BITS)
+#define TIMER_WHEEL_SLOT(Level, Tick)  \
+  ((Level) == 0 ? ((UINTN)(Tick) & (TIMER_WHEEL_ROOT_SLOTS - 1)) : \
+   (TIMER_WHEEL_ROOT_SLOTS + ((Level) - 1) * TIMER_WHEEL_LEVEL_SLOTS + \
+    ((UINTN)RShiftU64 ((Tick), TIMER_WHEEL_LEVEL_SHIFT (Level)) & (TIMER_WHEEL_LEVEL_SLOTS - 1))))
+
 //
 // Internal data
 //
 
-LIST_ENTRY       mEfiTimerList = INITIALIZE_LIST_HEAD_VARIABLE (mEfiTimerList);
+LIST_ENTRY       mEfiTimerWheel[TIMER_WHEEL_SLOTS];
+UINT64           mEfiTimerWheelTick = 0;
+UINTN            mEfiTimerCount = 0;
+UINT64           mEfiTimerNextTrigger = MAX_UINT64;
 EFI_LOCK         mEfiTimerLock = EFI_INITIALIZE_LOCK_VARIABLE (TPL_HIGH_LEVEL - 1);
 EFI_EVENT        mEfiCheckTimerEvent = NULL;
 
@@ -24,6 +49,49 @@ UINT64           mEfiSystemTime = 0;
 //
 // Timer functions
 //
+/**
+  Links a timer event into the timer wheel slot of its trigger time, relative
+  to the current wheel tick.
+
+  @param  Event                  Points to the internal structure of timer event
+
+**/
+STATIC
+VOID
+CoreLinkEventTimer (
+  IN IEVENT   *Event
+  )
+{
+  UINT64          Tick;
+  UINT64          Delta;
+  UINTN           Level;
+
+  Tick = RShiftU64 (Event->Timer.TriggerTime, TIMER_WHEEL_TICK_SHIFT);
+  if (Tick < mEfiTimerWheelTick) {
+    Tick = mEfiTimerWheelTick;
+  }
+
+  Delta = Tick - mEfiTimerWheelTick;
+  if (Delta < TIMER_WHEEL_ROOT_SLOTS) {
+    Level = 0;
+  } else {
+    for (Level = 1; Level < TIMER_WHEEL_LEVELS - 1; Level++) {
+      if (Delta < LShiftU64 (1, TIMER_WHEEL_LEVEL_SHIFT (Level + 1))) {
+        break;
+      }
+    }
+    //
+    // Timers beyond the span of the wheel wait in the top level, they are
+    // placed again from their real trigger time when that slot is moved down.
+    //
+    if (Delta >= LShiftU64 (1, TIMER_WHEEL_LEVEL_SHIFT (TIMER_WHEEL_LEVELS))) {
+      Tick = mEfiTimerWheelTick + LShiftU64 (1, TIMER_WHEEL_LEVEL_SHIFT (TIMER_WHEEL_LEVELS)) - 1;
+    }
+  }
+
+  InsertTailList (&mEfiTimerWheel[TIMER_WHEEL_SLOT (Level, Tick)], &Event->Timer.Link);
+}
+
 /**
   Inserts the timer event.
 
@@ -36,29 +104,116 @@ CoreInsertEventTimer (
   IN IEVENT   *Event
   )
 {
-  UINT64          TriggerTime;
-  LIST_ENTRY      *Link;
-  IEVENT          *Event2;
-
   ASSERT_LOCKED (&mEfiTimerLock);
 
+  CoreLinkEventTimer (Event);
+  mEfiTimerCount++;
+
   //
-  // Get the timer's trigger time
+  // Keep a lower bound of the earliest trigger time for CoreTimerTick ()
   //
-  TriggerTime = Event->Timer.TriggerTime;
+  if (Event->Timer.TriggerTime < mEfiTimerNextTrigger) {
+    mEfiTimerNextTrigger = Event->Timer.TriggerTime;
+  }
+}
+
+/**
+  Removes the timer event from the timer database.
+
+  @param  Event                  Points to the internal structure of timer event
+                                 to be removed
+
+**/
+STATIC
+VOID
+CoreRemoveEventTimer (
+  IN IEVENT   *Event
+  )
+{
+  ASSERT_LOCKED (&mEfiTimerLock);
+  ASSERT (mEfiTimerCount > 0);
+
+  RemoveEntryList (&Event->Timer.Link);
+  Event->Timer.Link.ForwardLink = NULL;
+  mEfiTimerCount--;
+}
+
+/**
+  Moves the timers of a slot of a higher level down the wheel.
+
+  @param  Slot                   The timer wheel slot to move down
+
+**/
+STATIC
+VOID
+CoreCascadeTimerSlot (
+  IN UINTN    Slot
+  )
+{
+  LIST_ENTRY      List;
+  IEVENT          *Event;
+
+  if (IsListEmpty (&mEfiTimerWheel[Slot])) {
+    return;
+  }
 
   //
-  // Insert the timer into the timer database in assending sorted order
+  // Detach the slot so that timers moved back into it are not visited again
   //
-  for (Link = mEfiTimerList.ForwardLink; Link != &mEfiTimerList; Link = Link->ForwardLink) {
-    Event2 = CR (Link, IEVENT, Timer.Link, EVENT_SIGNATURE);
+  InsertHeadList (&mEfiTimerWheel[Slot], &List);
+  RemoveEntryList (&mEfiTimerWheel[Slot]);
+  InitializeListHead (&mEfiTimerWheel[Slot]);
 
-    if (Event2->Timer.TriggerTime > TriggerTime) {
-      break;
-    }
+  while (!IsListEmpty (&List)) {
+    Event = CR (List.ForwardLink, IEVENT, Timer.Link, EVENT_SIGNATURE);
+    RemoveEntryList (&Event->Timer.Link);
+    CoreLinkEventTimer (Event);
   }
+}
+
+/**
+  Recomputes the lower bound of the earliest trigger time of the timer wheel.
+
+**/
+STATIC
+VOID
+CoreUpdateNextTimerTrigger (
+  VOID
+  )
+{
+  UINT64          Boundary;
+  UINTN           Index;
+  UINTN           Slot;
+  LIST_ENTRY      *Link;
+  IEVENT          *Event;
 
-  InsertTailList (Link, &Event->Timer.Link);
+  if (mEfiTimerCount == 0) {
+    mEfiTimerNextTrigger = MAX_UINT64;
+    return;
+  }
+
+  //
+  // Timers of the higher levels are never due before level 0 wraps
+  //
+  Boundary = LShiftU64 (
+               (mEfiTimerWheelTick | (TIMER_WHEEL_ROOT_SLOTS - 1)) + 1,
+               TIMER_WHEEL_TICK_SHIFT
+               );
+  mEfiTimerNextTrigger = Boundary;
+
+  for (Index = 0; Index < TIMER_WHEEL_ROOT_SLOTS; Index++) {
+    Slot = TIMER_WHEEL_SLOT (0, mEfiTimerWheelTick + Index);
+    if (IsListEmpty (&mEfiTimerWheel[Slot])) {
+      continue;
+    }
+    for (Link = mEfiTimerWheel[Slot].ForwardLink; Link != &mEfiTimerWheel[Slot]; Link = Link->ForwardLink) {
+      Event = CR (Link, IEVENT, Timer.Link, EVENT_SIGNATURE);
+      if (Event->Timer.TriggerTime < mEfiTimerNextTrigger) {
+        mEfiTimerNextTrigger = Event->Timer.TriggerTime;
+      }
+    }
+    break;
+  }
 }
 
 /**
@@ -82,7 +237,7 @@ CoreCurrentSystemTime (
 }
 
 /**
-  Checks the sorted timer list against the current system time.
+  Checks the timer wheel against the current system time.
   Signals any expired event timer.
 
   @param  CheckEvent             Not used
@@ -97,6 +252,10 @@ CoreCheckTimers (
   )
 {
   UINT64                  SystemTime;
+  UINT64                  Tick;
+  UINTN                   Level;
+  UINTN                   Slot;
+  LIST_ENTRY              List;
   IEVENT                  *Event;
 
   //
@@ -104,53 +263,90 @@ CoreCheckTimers (
   //
   CoreAcquireLock (&mEfiTimerLock);
   SystemTime = CoreCurrentSystemTime ();
+  Tick       = RShiftU64 (SystemTime, TIMER_WHEEL_TICK_SHIFT);
 
-  while (!IsListEmpty (&mEfiTimerList)) {
-    Event = CR (mEfiTimerList.ForwardLink, IEVENT, Timer.Link, EVENT_SIGNATURE);
+  if (mEfiTimerCount == 0 && Tick > mEfiTimerWheelTick) {
+    mEfiTimerWheelTick = Tick;
+  }
 
+  for (; ;) {
     //
-    // If this timer is not expired, then we're done
+    // Detach the level 0 slot of the current tick, periodic timers re-armed
+    // into it are handled by the next check
     //
-    if (Event->Timer.TriggerTime > SystemTime) {
-      break;
+    Slot = TIMER_WHEEL_SLOT (0, mEfiTimerWheelTick);
+    InitializeListHead (&List);
+    if (!IsListEmpty (&mEfiTimerWheel[Slot])) {
+      InsertHeadList (&mEfiTimerWheel[Slot], &List);
+      RemoveEntryList (&mEfiTimerWheel[Slot]);
+      InitializeListHead (&mEfiTimerWheel[Slot]);
     }
 
-    //
-    // Remove this timer from the timer queue
-    //
-
-    RemoveEntryList (&Event->Timer.Link);
-    Event->Timer.Link.ForwardLink = NULL;
+    while (!IsListEmpty (&List)) {
+      Event = CR (List.ForwardLink, IEVENT, Timer.Link, EVENT_SIGNATURE);
+      RemoveEntryList (&Event->Timer.Link);
 
-    //
-    // Signal it
-    //
-    CoreSignalEvent (Event);
+      //
+      // If this timer is not expired, put it back
+      //
+      if (Event->Timer.TriggerTime > SystemTime) {
+        CoreLinkEventTimer (Event);
+        continue;
+      }
 
-    //
-    // If this is a periodic timer, set it
-    //
-    if (Event->Timer.Period != 0) {
       //
-      // Compute the timers new trigger time
+      // Remove this timer from the timer queue
       //
-      Event->Timer.TriggerTime = Event->Timer.TriggerTime + Event->Timer.Period;
+      Event->Timer.Link.ForwardLink = NULL;
+      mEfiTimerCount--;
 
       //
-      // If that's before now, then reset the timer to start from now
+      // Signal it
       //
-      if (Event->Timer.TriggerTime <= SystemTime) {
-        Event->Timer.TriggerTime = SystemTime;
-        CoreSignalEvent (mEfiCheckTimerEvent);
-      }
+      CoreSignalEvent (Event);
 
       //
-      // Add the timer
+      // If this is a periodic timer, set it
       //
-      CoreInsertEventTimer (Event);
+      if (Event->Timer.Period != 0) {
+        //
+        // Compute the timers new trigger time
+        //
+        Event->Timer.TriggerTime = Event->Timer.TriggerTime + Event->Timer.Period;
+
+        //
+        // If that's before now, then reset the timer to start from now
+        //
+        if (Event->Timer.TriggerTime <= SystemTime) {
+          Event->Timer.TriggerTime = SystemTime;
+          CoreSignalEvent (mEfiCheckTimerEvent);
+        }
+
+        //
+        // Add the timer
+        //
+        CoreInsertEventTimer (Event);
+      }
+    }
+
+    if (mEfiTimerWheelTick >= Tick) {
+      break;
+    }
+
+    //
+    // Advance the wheel, moving higher level timers down as levels wrap
+    //
+    mEfiTimerWheelTick++;
+    for (Level = 1; Level < TIMER_WHEEL_LEVELS; Level++) {
+      if ((mEfiTimerWheelTick & (LShiftU64 (1, TIMER_WHEEL_LEVEL_SHIFT (Level)) - 1)) != 0) {
+        break;
+      }
+      CoreCascadeTimerSlot (TIMER_WHEEL_SLOT (Level, mEfiTimerWheelTick));
     }
   }
 
+  CoreUpdateNextTimerTrigger ();
+
   CoreReleaseLock (&mEfiTimerLock);
 }
 
@@ -165,6 +361,11 @@ CoreInitializeTimer (
   )
 {
   EFI_STATUS  Status;
+  UINTN       Index;
+
+  for (Index = 0; Index < TIMER_WHEEL_SLOTS; Index++) {
+    InitializeListHead (&mEfiTimerWheel[Index]);
+  }
 
   Status = CoreCreateEventInternal (
              EVT_NOTIFY_SIGNAL,
@@ -191,8 +392,6 @@ CoreTimerTick (
   IN UINT64   Duration
   )
 {
-  IEVENT          *Event;
-
   //
   // Check runtiem flag in case there are ticks while exiting boot services
   //
@@ -204,15 +403,11 @@ CoreTimerTick (
   mEfiSystemTime += Duration;
 
   //
-  // If the head of the list is expired, fire the timer event
+  // If the earliest timer may be expired, fire the timer event
   // to process it
   //
-  if (!IsListEmpty (&mEfiTimerList)) {
-    Event = CR (mEfiTimerList.ForwardLink, IEVENT, Timer.Link, EVENT_SIGNATURE);
-
-    if (Event->Timer.TriggerTime <= mEfiSystemTime) {
-      CoreSignalEvent (mEfiCheckTimerEvent);
-    }
+  if (mEfiTimerNextTrigger <= mEfiSystemTime) {
+    CoreSignalEvent (mEfiCheckTimerEvent);
   }
 
   CoreReleaseLock (&mEfiSystemTimeLock);
@@ -265,8 +460,7 @@ CoreSetTimer (
   // If the timer is queued to the timer database, remove it
   //
   if (Event->Timer.Link.ForwardLink != NULL) {
-    RemoveEntryList (&Event->Timer.Link);
-    Event->Timer.Link.ForwardLink = NULL;
+    CoreRemoveEventTimer (Event);
   }
 
   Event->Timer.TriggerTime = 0;
@@ -42,7 +42,9 @@ FV_DEVICE mFvDevice = {
   0,
   0,
   FALSE,
-  FALSE
+  FALSE,
+  NULL,
+  0
 };
 
 
@@ -282,6 +284,10 @@ FreeFvDeviceResource (
     FfsFileEntry = (FFS_FILE_LIST_ENTRY *) NextEntry;
   }
 
+  if (FvDevice->FileDirectory != NULL) {
+    CoreFreePool (FvDevice->FileDirectory);
+  }
+
   if (!FvDevice->IsMemoryMapped) {
     //
     // Free the cached FV buffer.
@@ -299,6 +305,189 @@ FreeFvDeviceResource (
 
 
 
+/**
+  Locate the FV file directory in the extension header of a FV.
+
+  The extension header entries are not necessarily aligned, so they are only
+  read with unaligned accesses.
+
+  @param  FwVolHeader           Pointer to the FV header.
+  @param  FileCount             Returns the number of entries of the directory.
+
+  @return Pointer to the first entry of the directory, or NULL if the FV has
+          no directory.
+
+**/
+EDKII_FV_FILE_DIRECTORY_ENTRY *
+GetFvFileDirectory (
+  IN  EFI_FIRMWARE_VOLUME_HEADER  *FwVolHeader,
+  OUT UINT32                      *FileCount
+  )
+{
+  EFI_FIRMWARE_VOLUME_EXT_HEADER  *FwVolExtHeader;
+  EFI_FIRMWARE_VOLUME_EXT_ENTRY   *ExtEntry;
+  EDKII_FV_FILE_DIRECTORY         *Directory;
+  UINT32                          ExtHeaderSize;
+  UINT32                          Offset;
+  UINT16                          EntrySize;
+  UINT32                          Count;
+
+  if ((FwVolHeader->ExtHeaderOffset == 0) ||
+      ((UINT64) FwVolHeader->ExtHeaderOffset + sizeof (EFI_FIRMWARE_VOLUME_EXT_HEADER) > FwVolHeader->FvLength)) {
+    return NULL;
+  }
+
+  FwVolExtHeader = (EFI_FIRMWARE_VOLUME_EXT_HEADER *) ((UINT8 *) FwVolHeader + FwVolHeader->ExtHeaderOffset);
+  ExtHeaderSize  = ReadUnaligned32 (&FwVolExtHeader->ExtHeaderSize);
+  if ((UINT64) FwVolHeader->ExtHeaderOffset + ExtHeaderSize > FwVolHeader->FvLength) {
+    return NULL;
+  }
+
+  for (Offset = sizeof (EFI_FIRMWARE_VOLUME_EXT_HEADER);
+       Offset + sizeof (EFI_FIRMWARE_VOLUME_EXT_ENTRY) <= ExtHeaderSize;
+       Offset += EntrySize) {
+    ExtEntry  = (EFI_FIRMWARE_VOLUME_EXT_ENTRY *) ((UINT8 *) FwVolExtHeader + Offset);
+    EntrySize = ReadUnaligned16 (&ExtEntry->ExtEntrySize);
+    if ((EntrySize < sizeof (EFI_FIRMWARE_VOLUME_EXT_ENTRY)) || (Offset + EntrySize > ExtHeaderSize)) {
+      break;
+    }
+
+    if ((ReadUnaligned16 (&ExtEntry->ExtEntryType) != EFI_FV_EXT_TYPE_GUID_TYPE) ||
+        (EntrySize < sizeof (EDKII_FV_FILE_DIRECTORY))) {
+      continue;
+    }
+
+    Directory = (EDKII_FV_FILE_DIRECTORY *) ExtEntry;
+    if (!CompareGuid (&Directory->FormatType, &gEdkiiFvFileDirectoryGuid)) {
+      continue;
+    }
+
+    Count = ReadUnaligned32 (&Directory->FileCount);
+    if (Count > (EntrySize - sizeof (EDKII_FV_FILE_DIRECTORY)) / sizeof (EDKII_FV_FILE_DIRECTORY_ENTRY)) {
+      return NULL;
+    }
+
+    *FileCount = Count;
+    return (EDKII_FV_FILE_DIRECTORY_ENTRY *) (Directory + 1);
+  }
+
+  return NULL;
+}
+
+/**
+  Build the list of the FFS files of a FV sorted by name from its FV file
+  directory, so that FvReadFile () can binary search it.
+
+  The directory is produced by the build tools and is not covered by any
+  checksum, so it is only used when it lists exactly the non-pad files found
+  while checking the FV. Otherwise FvReadFile () keeps walking the file list.
+
+  @param  FvDevice              A pointer to the checked FvDevice.
+
+**/
+VOID
+BuildFvFileDirectory (
+  IN OUT FV_DEVICE  *FvDevice
+  )
+{
+  EDKII_FV_FILE_DIRECTORY_ENTRY   *Directory;
+  UINT32                          DirectoryCount;
+  FFS_FILE_LIST_ENTRY             **FileEntries;
+  FV_FILE_DIRECTORY_ENTRY         *FileDirectory;
+  FFS_FILE_LIST_ENTRY             *FfsFileEntry;
+  LIST_ENTRY                      *Link;
+  UINTN                           FileCount;
+  UINTN                           Index;
+  UINTN                           Low;
+  UINTN                           High;
+  UINTN                           Middle;
+  UINT32                          Offset;
+  UINT32                          PreviousOffset;
+  INTN                            Order;
+
+  Directory = GetFvFileDirectory ((EFI_FIRMWARE_VOLUME_HEADER *) FvDevice->CachedFv, &DirectoryCount);
+  if ((Directory == NULL) || (DirectoryCount == 0)) {
+    return;
+  }
+
+  FileCount = 0;
+  for (Link = GetFirstNode (&FvDevice->FfsFileListHeader); !IsNull (&FvDevice->FfsFileListHeader, Link); Link = GetNextNode (&FvDevice->FfsFileListHeader, Link)) {
+    if (((FFS_FILE_LIST_ENTRY *) Link)->FfsHeader->Type != EFI_FV_FILETYPE_FFS_PAD) {
+      FileCount++;
+    }
+  }
+  if (FileCount != DirectoryCount) {
+    return;
+  }
+
+  FileEntries   = AllocatePool (FileCount * sizeof (FFS_FILE_LIST_ENTRY *));
+  FileDirectory = AllocatePool (FileCount * sizeof (FV_FILE_DIRECTORY_ENTRY));
+  if ((FileEntries == NULL) || (FileDirectory == NULL)) {
+    goto Done;
+  }
+
+  //
+  // The file list is in the order of the files in the FV, so FileEntries is
+  // sorted by offset.
+  //
+  Index = 0;
+  for (Link = GetFirstNode (&FvDevice->FfsFileListHeader); !IsNull (&FvDevice->FfsFileListHeader, Link); Link = GetNextNode (&FvDevice->FfsFileListHeader, Link)) {
+    if (((FFS_FILE_LIST_ENTRY *) Link)->FfsHeader->Type != EFI_FV_FILETYPE_FFS_PAD) {
+      FileEntries[Index++] = (FFS_FILE_LIST_ENTRY *) Link;
+    }
+  }
+
+  PreviousOffset = 0;
+  for (Index = 0; Index < FileCount; Index++) {
+    //
+    // Any file listed twice would leave another one out, so the entries must
+    // be strictly increasing.
+    //
+    Offset = ReadUnaligned32 (&Directory[Index].Offset);
+    if (Index > 0) {
+      Order = CompareMem (&Directory[Index - 1].Name, &Directory[Index].Name, sizeof (EFI_GUID));
+      if ((Order > 0) || ((Order == 0) && (PreviousOffset >= Offset))) {
+        goto Done;
+      }
+    }
+    PreviousOffset = Offset;
+
+    FfsFileEntry = NULL;
+    Low  = 0;
+    High = FileCount;
+    while (Low < High) {
+      Middle = (Low + High) / 2;
+      if (FileEntries[Middle]->Offset == Offset) {
+        FfsFileEntry = FileEntries[Middle];
+        break;
+      }
+      if (FileEntries[Middle]->Offset < Offset) {
+        Low = Middle + 1;
+      } else {
+        High = Middle;
+      }
+    }
+    if ((FfsFileEntry == NULL) || !CompareGuid (&FfsFileEntry->FfsHeader->Name, &Directory[Index].Name)) {
+      goto Done;
+    }
+
+    CopyGuid (&FileDirectory[Index].Name, &FfsFileEntry->FfsHeader->Name);
+    FileDirectory[Index].FfsFileEntry = FfsFileEntry;
+  }
+
+  FvDevice->FileDirectory      = FileDirectory;
+  FvDevice->FileDirectoryCount = FileCount;
+  FileDirectory                = NULL;
+
+Done:
+  if (FileEntries != NULL) {
+    CoreFreePool (FileEntries);
+  }
+  if (FileDirectory != NULL) {
+    CoreFreePool (FileDirectory);
+  }
+}
+
 /**
   Check if an FV is consistent and allocate cache for it.
 
@@ -535,6 +724,7 @@ FvCheck (
 
       FfsFileEntry->FfsHeader = CacheFfsHeader;
       FfsFileEntry->FileCached = FileCached;
+      FfsFileEntry->Offset = (UINTN) ((UINT8 *) FfsHeader - FvDevice->CachedFv);
       FileCached = FALSE;
       InsertTailList (&FvDevice->FfsFileListHeader, &FfsFileEntry->Link);
     }
@@ -559,6 +749,8 @@ Done:
       FileCached = FALSE;
     }
     FreeFvDeviceResource (FvDevice);
+  } else {
+    BuildFvFileDirectory (FvDevice);
   }
 
   return Status;
@@ -21,8 +21,20 @@ typedef struct {
   EFI_FFS_FILE_HEADER             *FfsHeader;
   UINTN                           StreamHandle;
   BOOLEAN                         FileCached;
+  //
+  // Offset of the FFS file header from the start of the FV.
+  //
+  UINTN                           Offset;
 } FFS_FILE_LIST_ENTRY;
 
+//
+// An FFS file of the FV file directory, see Guid/FvFileDirectory.h.
+//
+typedef struct {
+  EFI_GUID                        Name;
+  FFS_FILE_LIST_ENTRY             *FfsFileEntry;
+} FV_FILE_DIRECTORY_ENTRY;
+
 typedef struct {
   UINTN                                   Signature;
   EFI_FIRMWARE_VOLUME_BLOCK_PROTOCOL      *Fvb;
@@ -41,6 +53,13 @@ typedef struct {
   UINT8                                   ErasePolarity;
   BOOLEAN                                 IsFfs3Fv;
   BOOLEAN                                 IsMemoryMapped;
+
+  //
+  // The non-pad files of FfsFileListHeader sorted by name, built from the FV
+  // file directory. NULL if the FV has no directory that lists these files.
+  //
+  FV_FILE_DIRECTORY_ENTRY                 *FileDirectory;
+  UINTN                                   FileDirectoryCount;
 } FV_DEVICE;
 
 #define FV_DEVICE_FROM_THIS(a) CR(a, FV_DEVICE, Fv, FV2_DEVICE_SIGNATURE)
@@ -226,6 +226,46 @@ FvGetNextFile (
 
 
 
+/**
+  Binary search the FFS files of a FV sorted by name.
+
+  The files with the same name are sorted by offset, so this returns the file
+  a walk of the file list would find first.
+
+  @param  FvDevice              The FV_DEVICE with a FileDirectory.
+  @param  NameGuid              The name of the file to find.
+
+  @return The FfsFileEntry of the file, or NULL if there is no such file.
+
+**/
+FFS_FILE_LIST_ENTRY *
+FindFileInDirectory (
+  IN FV_DEVICE                          *FvDevice,
+  IN CONST EFI_GUID                     *NameGuid
+  )
+{
+  UINTN                                 Low;
+  UINTN                                 High;
+  UINTN                                 Middle;
+
+  Low  = 0;
+  High = FvDevice->FileDirectoryCount;
+  while (Low < High) {
+    Middle = (Low + High) / 2;
+    if (CompareMem (&FvDevice->FileDirectory[Middle].Name, NameGuid, sizeof (EFI_GUID)) < 0) {
+      Low = Middle + 1;
+    } else {
+      High = Middle;
+    }
+  }
+
+  if ((Low < FvDevice->FileDirectoryCount) && CompareGuid (&FvDevice->FileDirectory[Low].Name, NameGuid)) {
+    return FvDevice->FileDirectory[Low].FfsFileEntry;
+  }
+
+  return NULL;
+}
+
 /**
   Locates a file in the firmware volume and
   copies it to the supplied buffer.
@@ -288,6 +328,7 @@ FvReadFile (
   EFI_FFS_FILE_HEADER               *FfsHeader;
   UINTN                             InputBufferSize;
   UINTN                             WholeFileSize;
+  EFI_FV_ATTRIBUTES                 FvAttributes;
 
   if (NameGuid == NULL) {
     return EFI_INVALID_PARAMETER;
@@ -296,25 +337,49 @@ FvReadFile (
   FvDevice = FV_DEVICE_FROM_THIS (This);
 
 
-  //
-  // Keep looking until we find the matching NameGuid.
-  // The Key is really a FfsFileEntry
-  //
   FvDevice->LastKey = 0;
-  do {
-    LocalFoundType = 0;
-    Status = FvGetNextFile (
-              This,
-              &FvDevice->LastKey,
-              &LocalFoundType,
-              &SearchNameGuid,
-              &LocalAttributes,
-              &FileSize
-              );
-    if (EFI_ERROR (Status)) {
+  if (FvDevice->FileDirectory != NULL) {
+    //
+    // Binary search the files sorted by name. The Key is still the FfsFileEntry,
+    // so that FvGetNextFile () may go on from it. As with the walk, a FV that
+    // cannot be read has no file.
+    //
+    Status = FvGetVolumeAttributes (This, &FvAttributes);
+    if (EFI_ERROR (Status) || ((FvAttributes & EFI_FV2_READ_STATUS) == 0)) {
+      return EFI_NOT_FOUND;
+    }
+
+    FvDevice->LastKey = FindFileInDirectory (FvDevice, NameGuid);
+    if (FvDevice->LastKey == NULL) {
       return EFI_NOT_FOUND;
     }
-  } while (!CompareGuid (&SearchNameGuid, NameGuid));
+
+    FfsHeader = FvDevice->LastKey->FfsHeader;
+    if (IS_FFS_FILE2 (FfsHeader)) {
+      FileSize = FFS_FILE2_SIZE (FfsHeader) - sizeof (EFI_FFS_FILE_HEADER2);
+    } else {
+      FileSize = FFS_FILE_SIZE (FfsHeader) - sizeof (EFI_FFS_FILE_HEADER);
+    }
+  } else {
+    //
+    // Keep looking until we find the matching NameGuid.
+    // The Key is really a FfsFileEntry
+    //
+    do {
+      LocalFoundType = 0;
+      Status = FvGetNextFile (
+                This,
+                &FvDevice->LastKey,
+                &LocalFoundType,
+                &SearchNameGuid,
+                &LocalAttributes,
+                &FileSize
+                );
+      if (EFI_ERROR (Status)) {
+        return EFI_NOT_FOUND;
+      }
+    } while (!CompareGuid (&SearchNameGuid, NameGuid));
+  }
 
   //
   // Get a pointer to the header
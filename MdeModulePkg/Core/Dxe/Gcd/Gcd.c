@@ -43,6 +43,14 @@ EFI_LOCK           mGcdIoSpaceLock     = EFI_INITIALIZE_LOCK_VARIABLE (TPL_NOTIF
 LIST_ENTRY         mGcdMemorySpaceMap  = INITIALIZE_LIST_HEAD_VARIABLE (mGcdMemorySpaceMap);
 LIST_ENTRY         mGcdIoSpaceMap      = INITIALIZE_LIST_HEAD_VARIABLE (mGcdIoSpaceMap);
 
+//
+// The last entry found by CoreSearchGcdMapEntry() in each map. The maps are
+// sorted by address, so a search for an address at or above the hint can
+// start its walk there instead of at the head of the list.
+//
+LIST_ENTRY         *mGcdMemorySpaceSearchHint = NULL;
+LIST_ENTRY         *mGcdIoSpaceSearchHint     = NULL;
+
 EFI_GCD_MAP_ENTRY mGcdMemorySpaceMapEntryTemplate = {
   EFI_GCD_MAP_SIGNATURE,
   {
@@ -361,6 +369,27 @@ PageAlignLength (
 // GCD Memory Space Worker Functions
 //
 
+/**
+  Return the search hint that belongs to a GCD map.
+
+  @param  Map                    The GCD memory space map or GCD I/O space map.
+
+  @return Pointer to the search hint of Map.
+
+**/
+LIST_ENTRY **
+CoreGetGcdMapSearchHint (
+  IN LIST_ENTRY  *Map
+  )
+{
+  if (Map == &mGcdMemorySpaceMap) {
+    return &mGcdMemorySpaceSearchHint;
+  }
+  ASSERT (Map == &mGcdIoSpaceMap);
+  return &mGcdIoSpaceSearchHint;
+}
+
+
 /**
   Allocate pool for two entries.
 
@@ -471,6 +500,7 @@ CoreMergeGcdMapEntry (
   LIST_ENTRY         *AdjacentLink;
   EFI_GCD_MAP_ENTRY  *Entry;
   EFI_GCD_MAP_ENTRY  *AdjacentEntry;
+  LIST_ENTRY         **SearchHint;
 
   //
   // Get adjacent entry
@@ -515,6 +545,14 @@ CoreMergeGcdMapEntry (
   } else {
     Entry->BaseAddress = AdjacentEntry->BaseAddress;
   }
+  //
+  // The merged entry now covers the range of the one being freed
+  //
+  SearchHint = CoreGetGcdMapSearchHint (Map);
+  if (*SearchHint == AdjacentLink) {
+    *SearchHint = Link;
+  }
+
   RemoveEntryList (AdjacentLink);
   CoreFreePool (AdjacentEntry);
 
@@ -589,13 +627,26 @@ CoreSearchGcdMapEntry (
 {
   LIST_ENTRY         *Link;
   EFI_GCD_MAP_ENTRY  *Entry;
+  LIST_ENTRY         **SearchHint;
 
   ASSERT (Length != 0);
 
   *StartLink = NULL;
   *EndLink   = NULL;
 
-  Link = Map->ForwardLink;
+  //
+  // Entries are sorted by address and cover the space without holes, so the
+  // walk may start at any entry that begins at or below BaseAddress.
+  //
+  Link       = Map->ForwardLink;
+  SearchHint = CoreGetGcdMapSearchHint (Map);
+  if (*SearchHint != NULL) {
+    Entry = CR (*SearchHint, EFI_GCD_MAP_ENTRY, Link, EFI_GCD_MAP_SIGNATURE);
+    if (Entry->BaseAddress <= BaseAddress) {
+      Link = *SearchHint;
+    }
+  }
+
   while (Link != Map) {
     Entry = CR (Link, EFI_GCD_MAP_ENTRY, Link, EFI_GCD_MAP_SIGNATURE);
     if (BaseAddress >= Entry->BaseAddress && BaseAddress <= Entry->EndAddress) {
@@ -604,7 +655,8 @@ CoreSearchGcdMapEntry (
     if (*StartLink != NULL) {
       if ((BaseAddress + Length - 1) >= Entry->BaseAddress &&
           (BaseAddress + Length - 1) <= Entry->EndAddress     ) {
-        *EndLink = Link;
+        *EndLink    = Link;
+        *SearchHint = *StartLink;
         return EFI_SUCCESS;
       }
     }
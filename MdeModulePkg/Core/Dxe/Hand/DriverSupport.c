@@ -13,6 +13,130 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 //
 // Driver Support Functions
 //
+/**
+  Connect all the drivers to the children of a controller, and then to the
+  children of each of those children, until the whole tree below the
+  controller is connected.
+
+  Each level of the tree is connected one whole level before descending into
+  it, so that drivers that move their long running work, like link training,
+  device spin up or port enumeration, to timer events in their Start() get it
+  started on every sibling before blocking on any single one of them.
+
+  @param  ControllerHandle      The handle of the controller whose children are
+                                to be connected.
+
+  @retval EFI_SUCCESS           The children of ControllerHandle are connected.
+  @retval EFI_INVALID_PARAMETER ControllerHandle is no longer a valid handle.
+  @retval EFI_OUT_OF_RESOURCES  There are not enough resources to collect the
+                                children.
+
+**/
+EFI_STATUS
+CoreConnectChildControllers (
+  IN  EFI_HANDLE                ControllerHandle
+  )
+{
+  EFI_STATUS                           Status;
+  IHANDLE                              *Handle;
+  PROTOCOL_INTERFACE                   *Prot;
+  LIST_ENTRY                           *Link;
+  LIST_ENTRY                           *ProtLink;
+  OPEN_PROTOCOL_DATA                   *OpenData;
+  EFI_HANDLE                           *ChildHandleBuffer;
+  UINTN                                ChildHandleCount;
+  UINTN                                Index;
+
+  Handle = ControllerHandle;
+
+  //
+  // Acquire the protocol lock on the handle database so the child handles can be collected
+  //
+  CoreAcquireProtocolLock ();
+
+  //
+  // Make sure the DriverBindingHandle is valid
+  //
+  Status = CoreValidateHandle (ControllerHandle);
+  if (EFI_ERROR (Status)) {
+    //
+    // Release the protocol lock on the handle database
+    //
+    CoreReleaseProtocolLock ();
+
+    return Status;
+  }
+
+
+  //
+  // Count ControllerHandle's children
+  //
+  for (Link = Handle->Protocols.ForwardLink, ChildHandleCount = 0; Link != &Handle->Protocols; Link = Link->ForwardLink) {
+    Prot = CR(Link, PROTOCOL_INTERFACE, Link, PROTOCOL_INTERFACE_SIGNATURE);
+    for (ProtLink = Prot->OpenList.ForwardLink;
+        ProtLink != &Prot->OpenList;
+        ProtLink = ProtLink->ForwardLink) {
+      OpenData = CR (ProtLink, OPEN_PROTOCOL_DATA, Link, OPEN_PROTOCOL_DATA_SIGNATURE);
+      if ((OpenData->Attributes & EFI_OPEN_PROTOCOL_BY_CHILD_CONTROLLER) != 0) {
+        ChildHandleCount++;
+      }
+    }
+  }
+
+  //
+  // Allocate a handle buffer for ControllerHandle's children
+  //
+  ChildHandleBuffer = AllocatePool (ChildHandleCount * sizeof(EFI_HANDLE));
+  if (ChildHandleBuffer == NULL) {
+    CoreReleaseProtocolLock ();
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  //
+  // Fill in a handle buffer with ControllerHandle's children
+  //
+  for (Link = Handle->Protocols.ForwardLink, ChildHandleCount = 0; Link != &Handle->Protocols; Link = Link->ForwardLink) {
+    Prot = CR(Link, PROTOCOL_INTERFACE, Link, PROTOCOL_INTERFACE_SIGNATURE);
+    for (ProtLink = Prot->OpenList.ForwardLink;
+        ProtLink != &Prot->OpenList;
+        ProtLink = ProtLink->ForwardLink) {
+      OpenData = CR (ProtLink, OPEN_PROTOCOL_DATA, Link, OPEN_PROTOCOL_DATA_SIGNATURE);
+      if ((OpenData->Attributes & EFI_OPEN_PROTOCOL_BY_CHILD_CONTROLLER) != 0) {
+        ChildHandleBuffer[ChildHandleCount] = OpenData->ControllerHandle;
+        ChildHandleCount++;
+      }
+    }
+  }
+
+  //
+  // Release the protocol lock on the handle database
+  //
+  CoreReleaseProtocolLock ();
+
+  //
+  // Connect each child handle one level first, then descend into each of them
+  //
+  for (Index = 0; Index < ChildHandleCount; Index++) {
+    CoreConnectController (
+      ChildHandleBuffer[Index],
+      NULL,
+      NULL,
+      FALSE
+      );
+  }
+
+  for (Index = 0; Index < ChildHandleCount; Index++) {
+    CoreConnectChildControllers (ChildHandleBuffer[Index]);
+  }
+
+  //
+  // Free the handle buffer of ControllerHandle's children
+  //
+  CoreFreePool (ChildHandleBuffer);
+
+  return EFI_SUCCESS;
+}
+
 /**
   Connects one or more drivers to a controller.
 
@@ -50,15 +174,7 @@ CoreConnectController (
 {
   EFI_STATUS                           Status;
   EFI_STATUS                           ReturnStatus;
-  IHANDLE                              *Handle;
-  PROTOCOL_INTERFACE                   *Prot;
-  LIST_ENTRY                           *Link;
-  LIST_ENTRY                           *ProtLink;
-  OPEN_PROTOCOL_DATA                   *OpenData;
   EFI_DEVICE_PATH_PROTOCOL             *AlignedRemainingDevicePath;
-  EFI_HANDLE                           *ChildHandleBuffer;
-  UINTN                                ChildHandleCount;
-  UINTN                                Index;
   UINTN                                HandleFilePathSize;
   UINTN                                RemainingDevicePathSize;
   EFI_DEVICE_PATH_PROTOCOL             *HandleFilePath;
@@ -107,8 +223,6 @@ CoreConnectController (
     }
   }
 
-  Handle = ControllerHandle;
-
   //
   // Make a copy of RemainingDevicePath to guanatee it is aligned
   //
@@ -146,86 +260,10 @@ CoreConnectController (
   // If recursive, then connect all drivers to all of ControllerHandle's children
   //
   if (Recursive) {
-    //
-    // Acquire the protocol lock on the handle database so the child handles can be collected
-    //
-    CoreAcquireProtocolLock ();
-
-    //
-    // Make sure the DriverBindingHandle is valid
-    //
-    Status = CoreValidateHandle (ControllerHandle);
-    if (EFI_ERROR (Status)) {
-      //
-      // Release the protocol lock on the handle database
-      //
-      CoreReleaseProtocolLock ();
-
-      return ReturnStatus;
-    }
-
-
-    //
-    // Count ControllerHandle's children
-    //
-    for (Link = Handle->Protocols.ForwardLink, ChildHandleCount = 0; Link != &Handle->Protocols; Link = Link->ForwardLink) {
-      Prot = CR(Link, PROTOCOL_INTERFACE, Link, PROTOCOL_INTERFACE_SIGNATURE);
-      for (ProtLink = Prot->OpenList.ForwardLink;
-          ProtLink != &Prot->OpenList;
-          ProtLink = ProtLink->ForwardLink) {
-        OpenData = CR (ProtLink, OPEN_PROTOCOL_DATA, Link, OPEN_PROTOCOL_DATA_SIGNATURE);
-        if ((OpenData->Attributes & EFI_OPEN_PROTOCOL_BY_CHILD_CONTROLLER) != 0) {
-          ChildHandleCount++;
-        }
-      }
-    }
-
-    //
-    // Allocate a handle buffer for ControllerHandle's children
-    //
-    ChildHandleBuffer = AllocatePool (ChildHandleCount * sizeof(EFI_HANDLE));
-    if (ChildHandleBuffer == NULL) {
-      CoreReleaseProtocolLock ();
-      return EFI_OUT_OF_RESOURCES;
-    }
-
-    //
-    // Fill in a handle buffer with ControllerHandle's children
-    //
-    for (Link = Handle->Protocols.ForwardLink, ChildHandleCount = 0; Link != &Handle->Protocols; Link = Link->ForwardLink) {
-      Prot = CR(Link, PROTOCOL_INTERFACE, Link, PROTOCOL_INTERFACE_SIGNATURE);
-      for (ProtLink = Prot->OpenList.ForwardLink;
-          ProtLink != &Prot->OpenList;
-          ProtLink = ProtLink->ForwardLink) {
-        OpenData = CR (ProtLink, OPEN_PROTOCOL_DATA, Link, OPEN_PROTOCOL_DATA_SIGNATURE);
-        if ((OpenData->Attributes & EFI_OPEN_PROTOCOL_BY_CHILD_CONTROLLER) != 0) {
-          ChildHandleBuffer[ChildHandleCount] = OpenData->ControllerHandle;
-          ChildHandleCount++;
-        }
-      }
-    }
-
-    //
-    // Release the protocol lock on the handle database
-    //
-    CoreReleaseProtocolLock ();
-
-    //
-    // Recursively connect each child handle
-    //
-    for (Index = 0; Index < ChildHandleCount; Index++) {
-      CoreConnectController (
-        ChildHandleBuffer[Index],
-        NULL,
-        NULL,
-        TRUE
-        );
+    Status = CoreConnectChildControllers (ControllerHandle);
+    if (Status == EFI_OUT_OF_RESOURCES) {
+      return Status;
     }
-
-    //
-    // Free the handle buffer of ControllerHandle's children
-    //
-    CoreFreePool (ChildHandleBuffer);
   }
 
   return ReturnStatus;
@@ -11,12 +11,15 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 
 //
-// mProtocolDatabase     - A list of all protocols in the system.  (simple list for now)
+// mProtocolDatabase     - A list of all protocols in the system.
+// mProtocolHashTable    - The protocols in mProtocolDatabase, indexed by GUID
 // gHandleList           - A list of all the handles in the system
 // gProtocolDatabaseLock - Lock to protect the mProtocolDatabase
 // gHandleDatabaseKey    -  The Key to show that the handle has been created/modified
 //
 LIST_ENTRY      mProtocolDatabase     = INITIALIZE_LIST_HEAD_VARIABLE (mProtocolDatabase);
+LIST_ENTRY      mProtocolHashTable[PROTOCOL_HASH_SIZE];
+BOOLEAN         mProtocolHashTableInitialized = FALSE;
 LIST_ENTRY      gHandleList           = INITIALIZE_LIST_HEAD_VARIABLE (gHandleList);
 EFI_LOCK        gProtocolDatabaseLock = EFI_INITIALIZE_LOCK_VARIABLE (TPL_NOTIFY);
 UINT64          gHandleDatabaseKey    = 0;
@@ -84,6 +87,41 @@ CoreValidateHandle (
 
 
 
+/**
+  Compute the protocol database index bucket of a protocol GUID.
+
+  @param  Protocol               The ID of the protocol
+
+  @return The bucket of mProtocolHashTable the protocol entry is linked on
+
+**/
+STATIC
+LIST_ENTRY *
+CoreProtocolHashBucket (
+  IN EFI_GUID   *Protocol
+  )
+{
+  UINT32      Hash;
+  UINTN       Index;
+
+  if (!mProtocolHashTableInitialized) {
+    for (Index = 0; Index < PROTOCOL_HASH_SIZE; Index++) {
+      InitializeListHead (&mProtocolHashTable[Index]);
+    }
+    mProtocolHashTableInitialized = TRUE;
+  }
+
+  Hash = ReadUnaligned32 ((UINT32 *)Protocol)                   ^
+         ReadUnaligned32 ((UINT32 *)Protocol + 1)               ^
+         ReadUnaligned32 ((UINT32 *)Protocol + 2)               ^
+         ReadUnaligned32 ((UINT32 *)Protocol + 3);
+  Hash ^= Hash >> 16;
+  Hash ^= Hash >> 8;
+
+  return &mProtocolHashTable[Hash & (PROTOCOL_HASH_SIZE - 1)];
+}
+
+
 /**
   Finds the protocol entry for the requested protocol.
   The gProtocolDatabaseLock must be owned
@@ -101,21 +139,23 @@ CoreFindProtocolEntry (
   )
 {
   LIST_ENTRY          *Link;
+  LIST_ENTRY          *Bucket;
   PROTOCOL_ENTRY      *Item;
   PROTOCOL_ENTRY      *ProtEntry;
 
   ASSERT_LOCKED(&gProtocolDatabaseLock);
 
   //
-  // Search the database for the matching GUID
+  // Search the database index for the matching GUID
   //
 
   ProtEntry = NULL;
-  for (Link = mProtocolDatabase.ForwardLink;
-       Link != &mProtocolDatabase;
+  Bucket    = CoreProtocolHashBucket (Protocol);
+  for (Link = Bucket->ForwardLink;
+       Link != Bucket;
        Link = Link->ForwardLink) {
 
-    Item = CR(Link, PROTOCOL_ENTRY, AllEntries, PROTOCOL_ENTRY_SIGNATURE);
+    Item = CR(Link, PROTOCOL_ENTRY, HashLink, PROTOCOL_ENTRY_SIGNATURE);
     if (CompareGuid (&Item->ProtocolID, Protocol)) {
 
       //
@@ -142,11 +182,13 @@ CoreFindProtocolEntry (
       CopyGuid ((VOID *)&ProtEntry->ProtocolID, Protocol);
       InitializeListHead (&ProtEntry->Protocols);
       InitializeListHead (&ProtEntry->Notify);
+      ProtEntry->InterfaceCount = 0;
 
       //
       // Add it to protocol database
       //
       InsertTailList (&mProtocolDatabase, &ProtEntry->AllEntries);
+      InsertTailList (Bucket, &ProtEntry->HashLink);
     }
   }
 
@@ -465,6 +507,7 @@ CoreInstallProtocolInterfaceNotify (
   // protocol entry
   //
   InsertTailList (&ProtEntry->Protocols, &Prot->ByProtocol);
+  ProtEntry->InterfaceCount++;
 
   //
   // Notify the notification list for this protocol
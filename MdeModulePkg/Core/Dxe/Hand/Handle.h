@@ -39,14 +39,23 @@ typedef struct {
   UINTN               Signature;
   /// Link Entry inserted to mProtocolDatabase
   LIST_ENTRY          AllEntries;
+  /// Link Entry inserted to the mProtocolHashTable bucket of ProtocolID
+  LIST_ENTRY          HashLink;
   /// ID of the protocol
   EFI_GUID            ProtocolID;
   /// All protocol interfaces
   LIST_ENTRY          Protocols;
+  /// Number of protocol interfaces on Protocols
+  UINTN               InterfaceCount;
   /// Registerd notification handlers
   LIST_ENTRY          Notify;
 } PROTOCOL_ENTRY;
 
+///
+/// Number of buckets of the protocol database GUID index, a power of 2
+///
+#define PROTOCOL_HASH_SIZE              0x40
+
 
 #define PROTOCOL_INTERFACE_SIGNATURE  SIGNATURE_32('p','i','f','c')
 
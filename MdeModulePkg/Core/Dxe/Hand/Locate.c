@@ -645,6 +645,7 @@ CoreLocateHandleBuffer (
 {
   EFI_STATUS          Status;
   UINTN               BufferSize;
+  PROTOCOL_ENTRY      *ProtEntry;
 
   if (NumberHandles == NULL) {
     return EFI_INVALID_PARAMETER;
@@ -657,6 +658,54 @@ CoreLocateHandleBuffer (
   BufferSize = 0;
   *NumberHandles = 0;
   *Buffer = NULL;
+
+  //
+  // For a search by protocol the number of matching handles is known up
+  // front, so the buffer can be allocated and filled in one pass.
+  //
+  if (SearchType == ByProtocol && Protocol != NULL) {
+    CoreAcquireProtocolLock ();
+    ProtEntry = CoreFindProtocolEntry (Protocol, FALSE);
+    if (ProtEntry != NULL) {
+      BufferSize = ProtEntry->InterfaceCount * sizeof (EFI_HANDLE);
+    }
+    CoreReleaseProtocolLock ();
+
+    if (BufferSize != 0) {
+      *Buffer = AllocatePool (BufferSize);
+      if (*Buffer == NULL) {
+        return EFI_OUT_OF_RESOURCES;
+      }
+
+      Status = CoreLocateHandle (
+                 SearchType,
+                 Protocol,
+                 SearchKey,
+                 &BufferSize,
+                 *Buffer
+                 );
+      if (Status != EFI_BUFFER_TOO_SMALL) {
+        *NumberHandles = BufferSize / sizeof(EFI_HANDLE);
+        if (EFI_ERROR(Status)) {
+          CoreFreePool (*Buffer);
+          *Buffer = NULL;
+          *NumberHandles = 0;
+          if (Status != EFI_INVALID_PARAMETER) {
+            Status = EFI_NOT_FOUND;
+          }
+        }
+        return Status;
+      }
+
+      //
+      // The database changed in between, size it again below.
+      //
+      CoreFreePool (*Buffer);
+      *Buffer = NULL;
+      BufferSize = 0;
+    }
+  }
+
   Status = CoreLocateHandle (
              SearchType,
              Protocol,
@@ -79,6 +79,8 @@ CoreRemoveInterfaceFromProtocol (
     // Remove the protocol interface entry
     //
     RemoveEntryList (&Prot->ByProtocol);
+    ASSERT (ProtEntry->InterfaceCount > 0);
+    ProtEntry->InterfaceCount--;
   }
 
   return Prot;
@@ -249,6 +251,7 @@ CoreReinstallProtocolInterface (
   // protocol entry
   //
   InsertTailList (&ProtEntry->Protocols, &Prot->ByProtocol);
+  ProtEntry->InterfaceCount++;
 
   //
   // Update the Key to show that the handle has been created/modified
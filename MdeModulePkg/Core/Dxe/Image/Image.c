@@ -1061,6 +1061,148 @@ CoreUnloadAndCloseImage (
 }
 
 
+/**
+  Read a whole image file from a simple file system volume that publishes the
+  EDKII File Bulk Read Protocol.
+
+  The file is read with a single ReadFile() call into page aligned memory, so
+  the file system driver can transfer it extent by extent without going through
+  an intermediate pool buffer.
+
+  @param  DeviceHandle            The handle of the simple file system volume.
+  @param  FilePath                The remaining file path nodes on DeviceHandle.
+  @param  FHand                   The image file handle to fill in.
+
+  @retval EFI_SUCCESS             The file was read into FHand->Source.
+  @retval EFI_UNSUPPORTED         The volume does not support bulk reads, or the
+                                  file path is not made of file path nodes.
+  @retval EFI_OUT_OF_RESOURCES    No enough resource to read the file.
+  @retval Others                  The file could not be opened or read.
+
+**/
+STATIC
+EFI_STATUS
+CoreReadImageFileBulk (
+  IN     EFI_HANDLE                DeviceHandle,
+  IN     EFI_DEVICE_PATH_PROTOCOL  *FilePath,
+  IN OUT IMAGE_FILE_HANDLE         *FHand
+  )
+{
+  EFI_STATUS                       Status;
+  EDKII_FILE_BULK_READ_PROTOCOL    *BulkRead;
+  EFI_SIMPLE_FILE_SYSTEM_PROTOCOL  *Volume;
+  EFI_FILE_HANDLE                  FileHandle;
+  EFI_FILE_HANDLE                  LastHandle;
+  EFI_DEVICE_PATH_PROTOCOL         *TempDevicePathNode;
+  EFI_DEVICE_PATH_PROTOCOL         *DevicePathNode;
+  EFI_FILE_INFO                    *FileInfo;
+  UINTN                            FileInfoSize;
+  EFI_PHYSICAL_ADDRESS             Buffer;
+  UINTN                            Pages;
+  UINTN                            BufferSize;
+
+  Status = CoreHandleProtocol (DeviceHandle, &gEdkiiFileBulkReadProtocolGuid, (VOID **)&BulkRead);
+  if (EFI_ERROR (Status)) {
+    return EFI_UNSUPPORTED;
+  }
+  Status = CoreHandleProtocol (DeviceHandle, &gEfiSimpleFileSystemProtocolGuid, (VOID **)&Volume);
+  if (EFI_ERROR (Status)) {
+    return EFI_UNSUPPORTED;
+  }
+
+  //
+  // Duplicate the device path to avoid the access to unaligned device path node.
+  //
+  TempDevicePathNode = DuplicateDevicePath (FilePath);
+  if (TempDevicePathNode == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  FileInfo   = NULL;
+  FileHandle = NULL;
+  Status = Volume->OpenVolume (Volume, &FileHandle);
+  if (EFI_ERROR (Status)) {
+    FileHandle = NULL;
+    goto Done;
+  }
+
+  //
+  // Open each MEDIA_FILEPATH_DP node in turn, closing the previous one.
+  //
+  DevicePathNode = TempDevicePathNode;
+  while (!IsDevicePathEnd (DevicePathNode)) {
+    if (DevicePathType (DevicePathNode) != MEDIA_DEVICE_PATH ||
+        DevicePathSubType (DevicePathNode) != MEDIA_FILEPATH_DP) {
+      Status = EFI_UNSUPPORTED;
+      goto Done;
+    }
+
+    LastHandle = FileHandle;
+    FileHandle = NULL;
+    Status = LastHandle->Open (
+                           LastHandle,
+                           &FileHandle,
+                           ((FILEPATH_DEVICE_PATH *) DevicePathNode)->PathName,
+                           EFI_FILE_MODE_READ,
+                           0
+                           );
+    LastHandle->Close (LastHandle);
+    if (EFI_ERROR (Status)) {
+      FileHandle = NULL;
+      goto Done;
+    }
+
+    DevicePathNode = NextDevicePathNode (DevicePathNode);
+  }
+
+  FileInfoSize = 0;
+  Status = FileHandle->GetInfo (FileHandle, &gEfiFileInfoGuid, &FileInfoSize, NULL);
+  if (Status == EFI_BUFFER_TOO_SMALL) {
+    FileInfo = AllocatePool (FileInfoSize);
+    if (FileInfo == NULL) {
+      Status = EFI_OUT_OF_RESOURCES;
+    } else {
+      Status = FileHandle->GetInfo (FileHandle, &gEfiFileInfoGuid, &FileInfoSize, FileInfo);
+    }
+  }
+  if (EFI_ERROR (Status)) {
+    goto Done;
+  }
+  if ((FileInfo->Attribute & EFI_FILE_DIRECTORY) != 0 ||
+      FileInfo->FileSize == 0 || FileInfo->FileSize > MAX_UINTN - EFI_PAGE_MASK) {
+    Status = EFI_UNSUPPORTED;
+    goto Done;
+  }
+
+  BufferSize = (UINTN)FileInfo->FileSize;
+  Pages      = EFI_SIZE_TO_PAGES (BufferSize);
+  Status = CoreAllocatePages (AllocateAnyPages, EfiBootServicesData, Pages, &Buffer);
+  if (EFI_ERROR (Status)) {
+    goto Done;
+  }
+
+  Status = BulkRead->ReadFile (BulkRead, FileHandle, &BufferSize, (VOID *)(UINTN)Buffer);
+  if (EFI_ERROR (Status)) {
+    CoreFreePages (Buffer, Pages);
+    goto Done;
+  }
+
+  FHand->Source      = (VOID *)(UINTN)Buffer;
+  FHand->SourceSize  = BufferSize;
+  FHand->SourcePages = Pages;
+
+Done:
+  if (FileInfo != NULL) {
+    CoreFreePool (FileInfo);
+  }
+  if (FileHandle != NULL) {
+    FileHandle->Close (FileHandle);
+  }
+  CoreFreePool (TempDevicePathNode);
+  return Status;
+}
+
+
 /**
   Loads an EFI image into memory and returns a handle to the image.
 
@@ -1085,6 +1227,9 @@ CoreUnloadAndCloseImage (
   @param  EntryPoint              A pointer to the entry point
   @param  Attribute               The bit mask of attributes to set for the load
                                   PE image
+  @param  FvAuthenticationStatus  If not NULL, SourceBuffer was read from the
+                                  firmware volume file FilePath with this
+                                  authentication status.
 
   @retval EFI_SUCCESS             The image was loaded into memory.
   @retval EFI_NOT_FOUND           The FilePath was not found.
@@ -1116,7 +1261,8 @@ CoreLoadImageCommon (
   IN OUT UINTN                         *NumberOfPages      OPTIONAL,
   OUT EFI_HANDLE                       *ImageHandle,
   OUT EFI_PHYSICAL_ADDRESS             *EntryPoint         OPTIONAL,
-  IN  UINT32                           Attribute
+  IN  UINT32                           Attribute,
+  IN  UINT32                           *FvAuthenticationStatus OPTIONAL
   )
 {
   LOADED_IMAGE_PRIVATE_DATA  *Image;
@@ -1178,6 +1324,10 @@ CoreLoadImageCommon (
     } else {
       Status = EFI_LOAD_ERROR;
     }
+    if (FvAuthenticationStatus != NULL) {
+      ImageIsFromFv        = TRUE;
+      AuthenticationStatus = *FvAuthenticationStatus;
+    }
   } else {
     if (FilePath == NULL) {
       return EFI_INVALID_PARAMETER;
@@ -1209,18 +1359,30 @@ CoreLoadImageCommon (
       }
     }
 
+    //
+    // A file on a volume that supports bulk reads is read straight into
+    // page aligned memory.
+    //
+    if (!ImageIsFromFv && !ImageIsFromLoadFile && !EFI_ERROR (Status)) {
+      CoreReadImageFileBulk (DeviceHandle, HandleFilePath, &FHand);
+    }
+
     //
     // Get the source file buffer by its device path.
     //
-    FHand.Source = GetFileBufferByFilePath (
-                      BootPolicy,
-                      FilePath,
-                      &FHand.SourceSize,
-                      &AuthenticationStatus
-                      );
+    if (FHand.Source != NULL) {
+      Status = EFI_SUCCESS;
+    } else {
+      FHand.Source = GetFileBufferByFilePath (
+                        BootPolicy,
+                        FilePath,
+                        &FHand.SourceSize,
+                        &AuthenticationStatus
+                        );
+    }
     if (FHand.Source == NULL) {
       Status = EFI_NOT_FOUND;
-    } else {
+    } else if (FHand.SourcePages == 0) {
       FHand.FreeBuffer = TRUE;
       if (ImageIsFromLoadFile) {
         //
@@ -1428,6 +1590,8 @@ Done:
   //
   if (FHand.FreeBuffer) {
     CoreFreePool (FHand.Source);
+  } else if (FHand.SourcePages != 0) {
+    CoreFreePages ((EFI_PHYSICAL_ADDRESS)(UINTN)FHand.Source, FHand.SourcePages);
   }
   if (OriginalFilePath != InputFilePath) {
     CoreFreePool (OriginalFilePath);
@@ -1518,7 +1682,8 @@ CoreLoadImage (
              NULL,
              ImageHandle,
              NULL,
-             EFI_LOAD_PE_IMAGE_ATTRIBUTE_RUNTIME_REGISTRATION | EFI_LOAD_PE_IMAGE_ATTRIBUTE_DEBUG_IMAGE_INFO_TABLE_REGISTRATION
+             EFI_LOAD_PE_IMAGE_ATTRIBUTE_RUNTIME_REGISTRATION | EFI_LOAD_PE_IMAGE_ATTRIBUTE_DEBUG_IMAGE_INFO_TABLE_REGISTRATION,
+             NULL
              );
 
   Handle = NULL;
@@ -1534,6 +1699,62 @@ CoreLoadImage (
   return Status;
 }
 
+/**
+  Loads an EFI image that was read from a firmware volume file into memory,
+  and returns a handle to the image. The image is authenticated as an image
+  read from the firmware volume with the specified authentication status.
+
+  @param  ParentImageHandle       The caller's image handle.
+  @param  FilePath                The firmware volume file path of the image.
+  @param  SourceBuffer            The image read from the firmware volume file.
+  @param  SourceSize              The size in bytes of SourceBuffer.
+  @param  AuthenticationStatus    The authentication status of the image.
+  @param  ImageHandle             Pointer to the returned image handle that is
+                                  created when the image is successfully loaded.
+
+  @retval EFI_SUCCESS             The image was loaded into memory.
+  @retval Others                  See CoreLoadImage ().
+
+**/
+EFI_STATUS
+CoreLoadImageFromFvBuffer (
+  IN EFI_HANDLE                 ParentImageHandle,
+  IN EFI_DEVICE_PATH_PROTOCOL   *FilePath,
+  IN VOID                       *SourceBuffer,
+  IN UINTN                      SourceSize,
+  IN UINT32                     AuthenticationStatus,
+  OUT EFI_HANDLE                *ImageHandle
+  )
+{
+  EFI_STATUS    Status;
+  EFI_HANDLE    Handle;
+
+  PERF_LOAD_IMAGE_BEGIN (NULL);
+
+  Status = CoreLoadImageCommon (
+             FALSE,
+             ParentImageHandle,
+             FilePath,
+             SourceBuffer,
+             SourceSize,
+             (EFI_PHYSICAL_ADDRESS) (UINTN) NULL,
+             NULL,
+             ImageHandle,
+             NULL,
+             EFI_LOAD_PE_IMAGE_ATTRIBUTE_RUNTIME_REGISTRATION | EFI_LOAD_PE_IMAGE_ATTRIBUTE_DEBUG_IMAGE_INFO_TABLE_REGISTRATION,
+             &AuthenticationStatus
+             );
+
+  Handle = NULL;
+  if (!EFI_ERROR (Status)) {
+    Handle = *ImageHandle;
+  }
+
+  PERF_LOAD_IMAGE_END (Handle);
+
+  return Status;
+}
+
 /**
   Transfer control to a loaded image's entry point.
 
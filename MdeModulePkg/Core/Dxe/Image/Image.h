@@ -19,6 +19,7 @@ typedef struct {
   BOOLEAN             FreeBuffer;
   VOID                *Source;
   UINTN               SourceSize;
+  UINTN               SourcePages;
 } IMAGE_FILE_HANDLE;
 
 #endif
@@ -38,6 +38,20 @@ GLOBAL_REMOVE_IF_UNREFERENCED UINTN mLevelShift[GUARDED_HEAP_MAP_TABLE_DEPTH]
 GLOBAL_REMOVE_IF_UNREFERENCED UINTN mLevelMask[GUARDED_HEAP_MAP_TABLE_DEPTH]
                                     = GUARDED_HEAP_MAP_TABLE_DEPTH_MASKS;
 
+//
+// Number of allocations of each size class to leave unguarded before the
+// next guarded one, for page ([0]) and pool ([1]) allocations, in sampling
+// guard mode.
+//
+GLOBAL_REMOVE_IF_UNREFERENCED UINT32 mGuardSampleCountdown[2][GUARD_SAMPLE_SIZE_CLASSES];
+
+//
+// State of the pseudo random generator spreading the sampled allocations.
+// The fixed seed makes the guarded allocations the same from boot to boot,
+// as long as the allocation sequence is.
+//
+GLOBAL_REMOVE_IF_UNREFERENCED UINT32 mGuardSampleSeed = 0x2545F491;
+
 //
 // Used for promoting freed but not used pages.
 //
@@ -673,6 +687,71 @@ IsHeapGuardEnabled (
   return IsMemoryTypeToGuard (EfiMaxMemoryType, AllocateAnyPages, GuardType);
 }
 
+/**
+  Check to see if an allocation whose type is to be guarded is sampled to be
+  guarded, according to PcdHeapGuardPageSampleRate or
+  PcdHeapGuardPoolSampleRate.
+
+  With a rate N greater than 1, allocations of each size class are guarded
+  one in N on average, at random intervals, so that allocations of one size
+  cannot all be missed by a regular allocation pattern. The first allocation
+  of each size class is always guarded.
+
+  Allocations can nest through callbacks at a higher TPL. This can only make
+  the sampling less precise, so no lock is taken.
+
+  @param[in]  PageOrPool      GUARD_HEAP_TYPE_PAGE or GUARD_HEAP_TYPE_POOL.
+  @param[in]  Size            Size of the allocation in bytes.
+
+  @return TRUE  The allocation should be guarded.
+  @return FALSE The allocation should not be guarded.
+**/
+BOOLEAN
+IsAllocationSampledToGuard (
+  IN UINT8                  PageOrPool,
+  IN UINT64                 Size
+  )
+{
+  UINT32    Rate;
+  UINT32    *Countdown;
+  INTN      SizeClass;
+
+  if (PageOrPool == GUARD_HEAP_TYPE_POOL) {
+    Rate      = PcdGet32 (PcdHeapGuardPoolSampleRate);
+    Countdown = mGuardSampleCountdown[1];
+  } else {
+    Rate      = PcdGet32 (PcdHeapGuardPageSampleRate);
+    Countdown = mGuardSampleCountdown[0];
+  }
+
+  if (Rate <= 1) {
+    return TRUE;
+  }
+
+  SizeClass = HighBitSet64 (Size | 1);
+  if (SizeClass >= GUARD_SAMPLE_SIZE_CLASSES) {
+    SizeClass = GUARD_SAMPLE_SIZE_CLASSES - 1;
+  }
+
+  if (Countdown[SizeClass] != 0) {
+    Countdown[SizeClass]--;
+    return FALSE;
+  }
+
+  //
+  // Skip 0 to 2 * (N - 1) allocations before the next guarded one, which is
+  // N - 1 on average.
+  //
+  mGuardSampleSeed ^= mGuardSampleSeed << 13;
+  mGuardSampleSeed ^= mGuardSampleSeed >> 17;
+  mGuardSampleSeed ^= mGuardSampleSeed << 5;
+  Countdown[SizeClass] = (UINT32)RShiftU64 (
+                                   MultU64x32 (2 * (UINT64)Rate - 1, mGuardSampleSeed),
+                                   32
+                                   );
+  return TRUE;
+}
+
 /**
   Set head Guard and tail Guard for the given memory range.
 
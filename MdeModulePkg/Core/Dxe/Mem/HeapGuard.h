@@ -163,6 +163,12 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 //
 #define HEAP_GUARD_DEBUG_LEVEL  (DEBUG_POOL|DEBUG_PAGE)
 
+//
+// Number of size classes sampled separately by the sampling guard mode. The
+// size class of an allocation is the highest bit set in its size.
+//
+#define GUARD_SAMPLE_SIZE_CLASSES   32
+
 typedef struct {
   UINT32                TailMark;
   UINT32                HeadMark;
@@ -319,6 +325,23 @@ IsPageTypeToGuard (
   IN EFI_ALLOCATE_TYPE      AllocateType
   );
 
+/**
+  Check to see if an allocation whose type is to be guarded is sampled to be
+  guarded, according to PcdHeapGuardPageSampleRate or
+  PcdHeapGuardPoolSampleRate.
+
+  @param[in]  PageOrPool      GUARD_HEAP_TYPE_PAGE or GUARD_HEAP_TYPE_POOL.
+  @param[in]  Size            Size of the allocation in bytes.
+
+  @return TRUE  The allocation should be guarded.
+  @return FALSE The allocation should not be guarded.
+**/
+BOOLEAN
+IsAllocationSampledToGuard (
+  IN UINT8                  PageOrPool,
+  IN UINT64                 Size
+  );
+
 /**
   Check to see if the page at the given address is guarded or not.
 
@@ -43,6 +43,11 @@ UINTN         mFreeMapStack = 0;
 /// This list maintain the free memory map list
 ///
 LIST_ENTRY   mFreeMemoryMapEntryList = INITIALIZE_LIST_HEAD_VARIABLE (mFreeMemoryMapEntryList);
+///
+/// The descriptor most recently chosen by CoreFindFreePagesI() or found by
+/// CoreFindMemoryMapEntry(). It is cleared whenever a descriptor leaves gMemoryMap.
+///
+MEMORY_MAP   *mMemoryMapLookupHint = NULL;
 BOOLEAN      mMemoryTypeInformationInitialized = FALSE;
 
 EFI_MEMORY_TYPE_STATISTICS mMemoryTypeStatistics[EfiMaxMemoryType + 1] = {
@@ -134,6 +139,7 @@ RemoveMemoryMapEntry (
 {
   RemoveEntryList (&Entry->Link);
   Entry->Link.ForwardLink = NULL;
+  mMemoryMapLookupHint = NULL;
 
   if (Entry->FromPages) {
     //
@@ -358,6 +364,7 @@ CoreFreeMemoryMapStack (
       //
       RemoveEntryList (&mMapStack[mMapDepth].Link);
       mMapStack[mMapDepth].Link.ForwardLink = NULL;
+      mMemoryMapLookupHint = NULL;
 
       CopyMem (Entry , &mMapStack[mMapDepth], sizeof (MEMORY_MAP));
       Entry->FromPages = TRUE;
@@ -386,6 +393,43 @@ CoreFreeMemoryMapStack (
   mFreeMapStack -= 1;
 }
 
+/**
+  Internal function.  Finds the descriptor in gMemoryMap that covers an address.
+
+  The descriptor handed out by the last free page search is checked first, as
+  an allocation converts exactly the range CoreFindFreePagesI() just picked.
+
+  @param  Address                The address to look up.
+
+  @return The descriptor that covers Address, or NULL if none does.
+
+**/
+MEMORY_MAP *
+CoreFindMemoryMapEntry (
+  IN EFI_PHYSICAL_ADDRESS  Address
+  )
+{
+  LIST_ENTRY      *Link;
+  MEMORY_MAP      *Entry;
+
+  ASSERT_LOCKED (&gMemoryLock);
+
+  Entry = mMemoryMapLookupHint;
+  if (Entry != NULL && Entry->Start <= Address && Entry->End > Address) {
+    return Entry;
+  }
+
+  for (Link = gMemoryMap.ForwardLink; Link != &gMemoryMap; Link = Link->ForwardLink) {
+    Entry = CR (Link, MEMORY_MAP, Link, MEMORY_MAP_SIGNATURE);
+    if (Entry->Start <= Address && Entry->End > Address) {
+      mMemoryMapLookupHint = Entry;
+      return Entry;
+    }
+  }
+
+  return NULL;
+}
+
 /**
   Find untested but initialized memory regions in GCD map and convert them to be DXE allocatable.
 
@@ -736,7 +780,6 @@ CoreConvertPagesEx (
   UINT64          RangeEnd;
   UINT64          Attribute;
   EFI_MEMORY_TYPE MemType;
-  LIST_ENTRY      *Link;
   MEMORY_MAP      *Entry;
 
   Entry = NULL;
@@ -762,15 +805,8 @@ CoreConvertPagesEx (
     //
     // Find the entry that the covers the range
     //
-    for (Link = gMemoryMap.ForwardLink; Link != &gMemoryMap; Link = Link->ForwardLink) {
-      Entry = CR (Link, MEMORY_MAP, Link, MEMORY_MAP_SIGNATURE);
-
-      if (Entry->Start <= Start && Entry->End > Start) {
-        break;
-      }
-    }
-
-    if (Link == &gMemoryMap) {
+    Entry = CoreFindMemoryMapEntry (Start);
+    if (Entry == NULL) {
       DEBUG ((DEBUG_ERROR | DEBUG_PAGE, "ConvertPages: failed to find range %lx - %lx\n", Start, End));
       return EFI_NOT_FOUND;
     }
@@ -1134,6 +1170,7 @@ CoreFindFreePagesI (
         }
 
         Target = DescEnd;
+        mMemoryMapLookupHint = Entry;
       }
     }
   }
@@ -1437,7 +1474,9 @@ CoreAllocatePages (
   EFI_STATUS  Status;
   BOOLEAN     NeedGuard;
 
-  NeedGuard = IsPageTypeToGuard (MemoryType, Type) && !mOnGuarding;
+  NeedGuard = IsPageTypeToGuard (MemoryType, Type) && !mOnGuarding &&
+              IsAllocationSampledToGuard (GUARD_HEAP_TYPE_PAGE,
+                                          EFI_PAGES_TO_SIZE (NumberOfPages));
   Status = CoreInternalAllocatePages (Type, MemoryType, NumberOfPages, Memory,
                                       NeedGuard);
   if (!EFI_ERROR (Status)) {
@@ -1477,7 +1516,6 @@ CoreInternalFreePages (
   )
 {
   EFI_STATUS      Status;
-  LIST_ENTRY      *Link;
   MEMORY_MAP      *Entry;
   UINTN           Alignment;
   BOOLEAN         IsGuarded;
@@ -1491,14 +1529,8 @@ CoreInternalFreePages (
   // Find the entry that the covers the range
   //
   IsGuarded = FALSE;
-  Entry = NULL;
-  for (Link = gMemoryMap.ForwardLink; Link != &gMemoryMap; Link = Link->ForwardLink) {
-    Entry = CR(Link, MEMORY_MAP, Link, MEMORY_MAP_SIGNATURE);
-    if (Entry->Start <= Memory && Entry->End > Memory) {
-        break;
-    }
-  }
-  if (Link == &gMemoryMap) {
+  Entry = CoreFindMemoryMapEntry (Memory);
+  if (Entry == NULL) {
     Status = EFI_NOT_FOUND;
     goto Done;
   }
@@ -13,6 +13,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 STATIC EFI_LOCK mPoolMemoryLock = EFI_INITIALIZE_LOCK_VARIABLE (TPL_NOTIFY);
 
 #define POOL_FREE_SIGNATURE   SIGNATURE_32('p','f','r','0')
+#define POOL_MAGAZINE_SIGNATURE   SIGNATURE_32('p','m','g','0')
 typedef struct {
   UINT32          Signature;
   UINT32          Index;
@@ -60,6 +61,24 @@ STATIC CONST UINT16 mPoolSizeTable[] = {
 
 #define MAX_POOL_SIZE     (MAX_ADDRESS - POOL_OVERHEAD)
 
+//
+// Every entry of mPoolSizeTable is a multiple of 128 bytes, so the size class
+// of a request is looked up by its size in 128 byte units.
+//
+#define POOL_SIZE_UNIT_SHIFT  7
+#define POOL_SIZE_UNIT        (1 << POOL_SIZE_UNIT_SHIFT)
+#define MAX_POOL_SIZE_UNITS   (29824 >> POOL_SIZE_UNIT_SHIFT)
+
+STATIC UINT8 mPoolIndexTable[MAX_POOL_SIZE_UNITS + 1];
+
+//
+// Number of recently freed blocks each size class keeps aside per memory type,
+// and number of pages carved in one go when a size class runs dry. Both are
+// only used for memory types allocated at DEFAULT_PAGE_ALLOCATION_GRANULARITY.
+//
+#define POOL_MAGAZINE_DEPTH   8
+#define POOL_REFILL_GRANULES  4
+
 //
 // Globals
 //
@@ -71,6 +90,8 @@ typedef struct {
     EFI_MEMORY_TYPE  MemoryType;
     LIST_ENTRY       FreeList[MAX_POOL_LIST];
     LIST_ENTRY       Link;
+    UINTN            MagazineCount[MAX_POOL_LIST];
+    POOL_FREE        *Magazine[MAX_POOL_LIST][POOL_MAGAZINE_DEPTH];
 } POOL;
 
 //
@@ -97,14 +118,78 @@ GetPoolIndexFromSize (
   UINTN   Size
   )
 {
-  UINTN   Index;
+  if (Size > LIST_TO_SIZE (MAX_POOL_LIST - 1)) {
+    return MAX_POOL_LIST;
+  }
+  return mPoolIndexTable[(Size + POOL_SIZE_UNIT - 1) >> POOL_SIZE_UNIT_SHIFT];
+}
+
+/**
+  Check whether the pool of the specified memory type keeps magazines of
+  recently freed blocks.
+
+  Only the memory types below EfiMaxMemoryType carved at the default page
+  allocation granularity do, so OS/OEM specific pools can still be released
+  once empty, and no runtime memory is held back.
+
+  @param  MemoryType            The memory type of the pool.
+
+  @retval TRUE                  The pool uses magazines.
+  @retval FALSE                 The pool does not use magazines.
+
+**/
+STATIC
+BOOLEAN
+IsPoolMagazineType (
+  IN EFI_MEMORY_TYPE  MemoryType
+  )
+{
+  return (BOOLEAN)((UINT32)MemoryType < EfiMaxMemoryType &&
+                   MemoryType != EfiACPIReclaimMemory   &&
+                   MemoryType != EfiACPIMemoryNVS       &&
+                   MemoryType != EfiRuntimeServicesCode &&
+                   MemoryType != EfiRuntimeServicesData);
+}
+
+/**
+  Carve a block of pool memory into free blocks of decreasing size classes
+  and put them onto the free lists of the pool.
 
-  for (Index = 0; Index < MAX_POOL_LIST; Index++) {
-    if (mPoolSizeTable [Index] >= Size) {
-      return Index;
+  @param  Pool          The pool to put the free blocks onto.
+  @param  NewPage       The start of the block.
+  @param  Offset        The offset in the block to start carving at.
+  @param  MaxOffset     The size of the block.
+  @param  Index         The largest size class to carve.
+
+**/
+STATIC
+VOID
+CarvePoolBlock (
+  IN POOL   *Pool,
+  IN CHAR8  *NewPage,
+  IN UINTN  Offset,
+  IN UINTN  MaxOffset,
+  IN UINTN  Index
+  )
+{
+  POOL_FREE   *Free;
+  UINTN       FSize;
+
+  while (Offset < MaxOffset) {
+    ASSERT (Index < MAX_POOL_LIST);
+    FSize = LIST_TO_SIZE(Index);
+
+    while (Offset + FSize <= MaxOffset) {
+      Free = (POOL_FREE *) &NewPage[Offset];
+      Free->Signature = POOL_FREE_SIGNATURE;
+      Free->Index     = (UINT32)Index;
+      InsertHeadList (&Pool->FreeList[Index], &Free->Link);
+      Offset += FSize;
     }
+    Index -= 1;
   }
-  return MAX_POOL_LIST;
+
+  ASSERT (Offset == MaxOffset);
 }
 
 /**
@@ -118,6 +203,7 @@ CoreInitializePool (
 {
   UINTN  Type;
   UINTN  Index;
+  UINTN  Unit;
 
   for (Type=0; Type < EfiMaxMemoryType; Type++) {
     mPoolHead[Type].Signature  = 0;
@@ -125,8 +211,22 @@ CoreInitializePool (
     mPoolHead[Type].MemoryType = (EFI_MEMORY_TYPE) Type;
     for (Index=0; Index < MAX_POOL_LIST; Index++) {
       InitializeListHead (&mPoolHead[Type].FreeList[Index]);
+      mPoolHead[Type].MagazineCount[Index] = 0;
     }
   }
+
+  //
+  // Build the size class lookup table
+  //
+  ASSERT ((LIST_TO_SIZE (MAX_POOL_LIST - 1) >> POOL_SIZE_UNIT_SHIFT) == MAX_POOL_SIZE_UNITS);
+  Index = 0;
+  for (Unit = 0; Unit <= MAX_POOL_SIZE_UNITS; Unit++) {
+    while ((UINTN)LIST_TO_SIZE (Index) < (Unit << POOL_SIZE_UNIT_SHIFT)) {
+      Index++;
+    }
+    ASSERT ((LIST_TO_SIZE (Index) & (POOL_SIZE_UNIT - 1)) == 0);
+    mPoolIndexTable[Unit] = (UINT8)Index;
+  }
 }
 
 
@@ -175,6 +275,7 @@ LookupPoolHead (
     Pool->MemoryType = MemoryType;
     for (Index=0; Index < MAX_POOL_LIST; Index++) {
       InitializeListHead (&Pool->FreeList[Index]);
+      Pool->MagazineCount[Index] = 0;
     }
 
     InsertHeadList (&mPoolHeadList, &Pool->Link);
@@ -235,7 +336,8 @@ CoreInternalAllocatePool (
     return EFI_OUT_OF_RESOURCES;
   }
 
-  NeedGuard = IsPoolTypeToGuard (PoolType) && !mOnGuarding;
+  NeedGuard = IsPoolTypeToGuard (PoolType) && !mOnGuarding &&
+              IsAllocationSampledToGuard (GUARD_HEAP_TYPE_POOL, Size);
 
   //
   // Acquire the memory lock and make the allocation
@@ -357,10 +459,10 @@ CoreAllocatePoolI (
   CHAR8       *NewPage;
   VOID        *Buffer;
   UINTN       Index;
-  UINTN       FSize;
   UINTN       Offset, MaxOffset;
   UINTN       NoPages;
   UINTN       Granularity;
+  UINTN       Granules;
   BOOLEAN     HasPoolTail;
   BOOLEAN     PageAsPool;
 
@@ -416,6 +518,17 @@ CoreAllocatePoolI (
     goto Done;
   }
 
+  //
+  // Serve the request from the blocks recently freed to this size class
+  //
+  if (Pool->MagazineCount[Index] != 0) {
+    Pool->MagazineCount[Index]--;
+    Free = Pool->Magazine[Index][Pool->MagazineCount[Index]];
+    ASSERT (Free->Signature == POOL_MAGAZINE_SIGNATURE);
+    Head = (POOL_HEAD *) Free;
+    goto Done;
+  }
+
   //
   // If there's no free pool in the proper list size, go get some more pages
   //
@@ -438,14 +551,25 @@ CoreAllocatePoolI (
     }
 
     //
-    // Get another page
+    // Get more pages. Pools using magazines refill several granules at once,
+    // each of them is carved and can be released on its own.
     //
-    NewPage = CoreAllocatePoolPagesI (PoolType, EFI_SIZE_TO_PAGES (Granularity),
-                                      Granularity, NeedGuard);
+    Granules = IsPoolMagazineType (PoolType) ? POOL_REFILL_GRANULES : 1;
+    NewPage  = CoreAllocatePoolPagesI (PoolType, EFI_SIZE_TO_PAGES (Granularity) * Granules,
+                                       Granularity, NeedGuard);
+    if (NewPage == NULL && Granules > 1) {
+      Granules = 1;
+      NewPage  = CoreAllocatePoolPagesI (PoolType, EFI_SIZE_TO_PAGES (Granularity),
+                                         Granularity, NeedGuard);
+    }
     if (NewPage == NULL) {
       goto Done;
     }
 
+    while (--Granules > 0) {
+      CarvePoolBlock (Pool, NewPage + Granules * Granularity, 0, Granularity, Index - 1);
+    }
+
     //
     // Serve the allocation request from the head of the allocated block
     //
@@ -455,22 +579,7 @@ Carve:
     //
     // Carve up remaining space into free pool blocks
     //
-    Index--;
-    while (Offset < MaxOffset) {
-      ASSERT (Index < MAX_POOL_LIST);
-      FSize = LIST_TO_SIZE(Index);
-
-      while (Offset + FSize <= MaxOffset) {
-        Free = (POOL_FREE *) &NewPage[Offset];
-        Free->Signature = POOL_FREE_SIGNATURE;
-        Free->Index     = (UINT32)Index;
-        InsertHeadList (&Pool->FreeList[Index], &Free->Link);
-        Offset += FSize;
-      }
-      Index -= 1;
-    }
-
-    ASSERT (Offset == MaxOffset);
+    CarvePoolBlock (Pool, NewPage, Offset, MaxOffset, Index - 1);
     goto Done;
   }
 
@@ -782,6 +891,18 @@ CoreFreePoolI (
         );
     }
 
+  } else if (IsPoolMagazineType (Pool->MemoryType) &&
+             Pool->MagazineCount[Index] < POOL_MAGAZINE_DEPTH) {
+
+    //
+    // Keep the pool entry aside for the next allocation of the same size
+    //
+    Free = (POOL_FREE *) Head;
+    Free->Signature = POOL_MAGAZINE_SIGNATURE;
+    Free->Index     = (UINT32)Index;
+    Pool->Magazine[Index][Pool->MagazineCount[Index]] = Free;
+    Pool->MagazineCount[Index]++;
+
   } else {
 
     //
@@ -27,6 +27,12 @@
   3) A support protocol is not found, and the data is not available to be read
      without it.  This results in EFI_PROTOCOL_ERROR.
 
+  Streams produced by decompression or by a GUIDed extraction protocol are kept
+  so later searches of the same file (a different section type or instance) do
+  not decode them again.  When PcdDxeSectionStreamCacheSize is not zero, the
+  total size of those streams is bounded: the least recently searched stream is
+  released, and decoded again if it is searched later.
+
 Copyright (c) 2006 - 2018, Intel Corporation. All rights reserved.<BR>
 SPDX-License-Identifier: BSD-2-Clause-Patent
 
@@ -65,8 +71,23 @@ typedef struct {
   // when the required GUIDed extraction protocol becomes available.
   //
   EFI_EVENT                   Event;
+  //
+  // Children whose encapsulated stream was decoded are linked on
+  // mDecodedStreamList in least recently used order while the stream exists.
+  // DecodedSize is the size of the decoded stream, or 0 if it is not linked.
+  //
+  LIST_ENTRY                  DecodedLink;
+  UINTN                       DecodedSize;
+  //
+  // TRUE if the decoded stream was released and has to be decoded again
+  // before this child is searched.
+  //
+  BOOLEAN                     Evicted;
 } CORE_SECTION_CHILD_NODE;
 
+#define CHILD_SECTION_NODE_FROM_DECODED_LINK(Node) \
+  CR (Node, CORE_SECTION_CHILD_NODE, DecodedLink, CORE_SECTION_CHILD_SIGNATURE)
+
 #define CORE_SECTION_STREAM_SIGNATURE SIGNATURE_32('S','X','S','S')
 #define STREAM_NODE_FROM_LINK(Node) \
   CR (Node, CORE_SECTION_STREAM_NODE, Link, CORE_SECTION_STREAM_SIGNATURE)
@@ -191,6 +212,13 @@ CustomGuidedSectionExtract (
 //
 LIST_ENTRY mStreamRoot = INITIALIZE_LIST_HEAD_VARIABLE (mStreamRoot);
 
+//
+// Children with a decoded stream, least recently searched first, and the
+// total size of their decoded streams.
+//
+LIST_ENTRY mDecodedStreamList = INITIALIZE_LIST_HEAD_VARIABLE (mDecodedStreamList);
+UINTN      mDecodedStreamSize = 0;
+
 EFI_HANDLE mSectionExtractionHandle = NULL;
 
 EFI_GUIDED_SECTION_EXTRACTION_PROTOCOL mCustomGuidedSectionExtractionProtocol = {
@@ -533,6 +561,86 @@ VerifyGuidedSectionGuid (
   return FALSE;
 }
 
+/**
+  Worker function.  Records that a child's encapsulated stream was decoded.
+
+  @param  Node                   Indicates the child whose stream was decoded.
+  @param  Size                   Size in bytes of the decoded stream.
+
+**/
+VOID
+CacheDecodedStream (
+  IN CORE_SECTION_CHILD_NODE                   *Node,
+  IN UINTN                                     Size
+  )
+{
+  if (Size == 0) {
+    return;
+  }
+
+  Node->DecodedSize = Size;
+  InsertTailList (&mDecodedStreamList, &Node->DecodedLink);
+  mDecodedStreamSize += Size;
+}
+
+/**
+  Worker function.  Forgets a child's decoded stream, if it has one.
+
+  @param  Node                   Indicates the child.
+
+**/
+VOID
+UncacheDecodedStream (
+  IN CORE_SECTION_CHILD_NODE                   *Node
+  )
+{
+  if (Node->DecodedSize == 0) {
+    return;
+  }
+
+  RemoveEntryList (&Node->DecodedLink);
+  ASSERT (mDecodedStreamSize >= Node->DecodedSize);
+  mDecodedStreamSize -= Node->DecodedSize;
+  Node->DecodedSize = 0;
+}
+
+/**
+  Worker function.  Releases the least recently searched decoded streams until
+  their total size is within PcdDxeSectionStreamCacheSize.
+
+  The most recently searched stream is always kept, so a single stream larger
+  than the limit is not decoded again on every search.  This must only be
+  called when no search is in progress, since the released streams, and all
+  streams nested in them, are freed.
+
+**/
+VOID
+TrimDecodedStreamCache (
+  VOID
+  )
+{
+  UINTN                                        Limit;
+  CORE_SECTION_CHILD_NODE                      *Node;
+  UINTN                                        StreamHandle;
+
+  Limit = PcdGet32 (PcdDxeSectionStreamCacheSize);
+  if (Limit == 0) {
+    return;
+  }
+
+  while (mDecodedStreamSize > Limit &&
+         mDecodedStreamList.ForwardLink != mDecodedStreamList.BackLink) {
+    Node = CHILD_SECTION_NODE_FROM_DECODED_LINK (GetFirstNode (&mDecodedStreamList));
+    DEBUG ((DEBUG_INFO, "SectionExtraction: release decoded stream of %d bytes\n", Node->DecodedSize));
+
+    UncacheDecodedStream (Node);
+    StreamHandle = Node->EncapsulatedStreamHandle;
+    Node->EncapsulatedStreamHandle = NULL_STREAM_HANDLE;
+    Node->Evicted = TRUE;
+    CloseSectionStream (StreamHandle, TRUE);
+  }
+}
+
 /**
   RPN callback function. Initializes the section stream
   when GUIDED_SECTION_EXTRACTION_PROTOCOL is installed.
@@ -599,6 +707,9 @@ NotifyGuidedExtraction (
              &Context->ChildNode->EncapsulatedStreamHandle
              );
   ASSERT_EFI_ERROR (Status);
+  if (!EFI_ERROR (Status)) {
+    CacheDecodedStream (Context->ChildNode, NewStreamBufferSize);
+  }
 
   //
   //  Close the event when done.
@@ -642,31 +753,27 @@ CreateGuidedExtractionRpnEvent (
 }
 
 /**
-  Worker function.  Constructor for new child nodes.
+  Worker function.  Produces the stream encapsulated by a child section.
 
-  @param  Stream                 Indicates the section stream in which to add the
-                                 child.
-  @param  ChildOffset            Indicates the offset in Stream that is the
-                                 beginning of the child section.
-  @param  ChildNode              Indicates the Callee allocated and initialized
+  This is done when the child is created, and again when a child whose
+  decoded stream was evicted from the decoded stream cache is searched.
+
+  @param  Stream                 Indicates the section stream that contains the
                                  child.
+  @param  Node                   Indicates the child whose encapsulated stream
+                                 is produced.
 
-  @retval EFI_SUCCESS            Child node was found and returned.
-                                 EFI_OUT_OF_RESOURCES- Memory allocation failed.
-  @retval EFI_PROTOCOL_ERROR     Encapsulation sections produce new stream
-                                 handles when the child node is created.  If the
-                                 section type is GUID defined, and the extraction
-                                 GUID does not exist, and producing the stream
-                                 requires the GUID, then a protocol error is
-                                 generated and no child is produced. Values
-                                 returned by OpenSectionStreamEx.
+  @retval EFI_SUCCESS            The stream was produced, or the child is a leaf.
+  @retval EFI_OUT_OF_RESOURCES   Memory allocation failed.
+  @retval EFI_NOT_FOUND          The compression section header is truncated.
+  @retval EFI_PROTOCOL_ERROR     The GUIDed section extraction protocol failed.
+                                 Values returned by OpenSectionStreamEx.
 
 **/
 EFI_STATUS
-CreateChildNode (
+OpenEncapsulatedStream (
   IN     CORE_SECTION_STREAM_NODE              *Stream,
-  IN     UINT32                                ChildOffset,
-  OUT    CORE_SECTION_CHILD_NODE               **ChildNode
+  IN OUT CORE_SECTION_CHILD_NODE               *Node
   )
 {
   EFI_STATUS                                   Status;
@@ -686,43 +793,15 @@ CreateChildNode (
   UINT8                                        CompressionType;
   UINT16                                       GuidedSectionAttributes;
 
-  CORE_SECTION_CHILD_NODE                      *Node;
-
-  SectionHeader = (EFI_COMMON_SECTION_HEADER *) (Stream->StreamBuffer + ChildOffset);
-
-  //
-  // Allocate a new node
-  //
-  *ChildNode = AllocateZeroPool (sizeof (CORE_SECTION_CHILD_NODE));
-  Node = *ChildNode;
-  if (Node == NULL) {
-    return EFI_OUT_OF_RESOURCES;
-  }
+  SectionHeader = (EFI_COMMON_SECTION_HEADER *) (Stream->StreamBuffer + Node->OffsetInStream);
+  Node->Evicted = FALSE;
 
-  //
-  // Now initialize it
-  //
-  Node->Signature = CORE_SECTION_CHILD_SIGNATURE;
-  Node->Type = SectionHeader->Type;
-  if (IS_SECTION2 (SectionHeader)) {
-    Node->Size = SECTION2_SIZE (SectionHeader);
-  } else {
-    Node->Size = SECTION_SIZE (SectionHeader);
-  }
-  Node->OffsetInStream = ChildOffset;
-  Node->EncapsulatedStreamHandle = NULL_STREAM_HANDLE;
-  Node->EncapsulationGuid = NULL;
-
-  //
-  // If it's an encapsulating section, then create the new section stream also
-  //
   switch (Node->Type) {
     case EFI_SECTION_COMPRESSION:
       //
       // Get the CompressionSectionHeader
       //
       if (Node->Size < sizeof (EFI_COMPRESSION_SECTION)) {
-        CoreFreePool (Node);
         return EFI_NOT_FOUND;
       }
 
@@ -747,7 +826,6 @@ CreateChildNode (
         NewStreamBufferSize = UncompressedLength;
         NewStreamBuffer = AllocatePool (NewStreamBufferSize);
         if (NewStreamBuffer == NULL) {
-          CoreFreePool (Node);
           return EFI_OUT_OF_RESOURCES;
         }
 
@@ -776,7 +854,6 @@ CreateChildNode (
                                  &ScratchSize
                                  );
           if (EFI_ERROR (Status) || (NewStreamBufferSize != UncompressedLength)) {
-            CoreFreePool (Node);
             CoreFreePool (NewStreamBuffer);
             if (!EFI_ERROR (Status)) {
               Status = EFI_BAD_BUFFER_SIZE;
@@ -786,7 +863,6 @@ CreateChildNode (
 
           ScratchBuffer = AllocatePool (ScratchSize);
           if (ScratchBuffer == NULL) {
-            CoreFreePool (Node);
             CoreFreePool (NewStreamBuffer);
             return EFI_OUT_OF_RESOURCES;
           }
@@ -802,7 +878,6 @@ CreateChildNode (
                                  );
           CoreFreePool (ScratchBuffer);
           if (EFI_ERROR (Status)) {
-            CoreFreePool (Node);
             CoreFreePool (NewStreamBuffer);
             return Status;
           }
@@ -820,10 +895,10 @@ CreateChildNode (
                  &Node->EncapsulatedStreamHandle
                  );
       if (EFI_ERROR (Status)) {
-        CoreFreePool (Node);
         CoreFreePool (NewStreamBuffer);
         return Status;
       }
+      CacheDecodedStream (Node, NewStreamBufferSize);
       break;
 
     case EFI_SECTION_GUID_DEFINED:
@@ -848,7 +923,6 @@ CreateChildNode (
                                      &AuthenticationStatus
                                      );
         if (EFI_ERROR (Status)) {
-          CoreFreePool (*ChildNode);
           return EFI_PROTOCOL_ERROR;
         }
 
@@ -877,10 +951,10 @@ CreateChildNode (
                    &Node->EncapsulatedStreamHandle
                    );
         if (EFI_ERROR (Status)) {
-          CoreFreePool (*ChildNode);
           CoreFreePool (NewStreamBuffer);
           return Status;
         }
+        CacheDecodedStream (Node, NewStreamBufferSize);
       } else {
         //
         // There's no GUIDed section extraction protocol available.
@@ -919,7 +993,6 @@ CreateChildNode (
                        );
           }
           if (EFI_ERROR (Status)) {
-            CoreFreePool (Node);
             return Status;
           }
         }
@@ -935,6 +1008,75 @@ CreateChildNode (
       break;
   }
 
+  return EFI_SUCCESS;
+}
+
+/**
+  Worker function.  Constructor for new child nodes.
+
+  @param  Stream                 Indicates the section stream in which to add the
+                                 child.
+  @param  ChildOffset            Indicates the offset in Stream that is the
+                                 beginning of the child section.
+  @param  ChildNode              Indicates the Callee allocated and initialized
+                                 child.
+
+  @retval EFI_SUCCESS            Child node was found and returned.
+                                 EFI_OUT_OF_RESOURCES- Memory allocation failed.
+  @retval EFI_PROTOCOL_ERROR     Encapsulation sections produce new stream
+                                 handles when the child node is created.  If the
+                                 section type is GUID defined, and the extraction
+                                 GUID does not exist, and producing the stream
+                                 requires the GUID, then a protocol error is
+                                 generated and no child is produced. Values
+                                 returned by OpenSectionStreamEx.
+
+**/
+EFI_STATUS
+CreateChildNode (
+  IN     CORE_SECTION_STREAM_NODE              *Stream,
+  IN     UINT32                                ChildOffset,
+  OUT    CORE_SECTION_CHILD_NODE               **ChildNode
+  )
+{
+  EFI_STATUS                                   Status;
+  EFI_COMMON_SECTION_HEADER                    *SectionHeader;
+  CORE_SECTION_CHILD_NODE                      *Node;
+
+  SectionHeader = (EFI_COMMON_SECTION_HEADER *) (Stream->StreamBuffer + ChildOffset);
+
+  //
+  // Allocate a new node
+  //
+  *ChildNode = AllocateZeroPool (sizeof (CORE_SECTION_CHILD_NODE));
+  Node = *ChildNode;
+  if (Node == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  //
+  // Now initialize it
+  //
+  Node->Signature = CORE_SECTION_CHILD_SIGNATURE;
+  Node->Type = SectionHeader->Type;
+  if (IS_SECTION2 (SectionHeader)) {
+    Node->Size = SECTION2_SIZE (SectionHeader);
+  } else {
+    Node->Size = SECTION_SIZE (SectionHeader);
+  }
+  Node->OffsetInStream = ChildOffset;
+  Node->EncapsulatedStreamHandle = NULL_STREAM_HANDLE;
+  Node->EncapsulationGuid = NULL;
+
+  //
+  // If it's an encapsulating section, then create the new section stream also
+  //
+  Status = OpenEncapsulatedStream (Stream, Node);
+  if (EFI_ERROR (Status)) {
+    CoreFreePool (Node);
+    return Status;
+  }
+
   //
   // Last, add the new child node to the stream
   //
@@ -1055,6 +1197,16 @@ FindChildNode (
     //
     ASSERT (*SectionInstance > 0);
 
+    if (CurrentChildNode->Evicted) {
+      //
+      // The decoded stream of this child was released, decode it again.
+      //
+      Status = OpenEncapsulatedStream (SourceStream, CurrentChildNode);
+      if (EFI_ERROR (Status)) {
+        return Status;
+      }
+    }
+
     if (CurrentChildNode->EncapsulatedStreamHandle != NULL_STREAM_HANDLE) {
       //
       // If the current node is an encapsulating node, recurse into it...
@@ -1069,6 +1221,15 @@ FindChildNode (
                 &RecursedFoundStream,
                 AuthenticationStatus
                 );
+      if (CurrentChildNode->DecodedSize != 0) {
+        //
+        // Mark the decoded stream as the most recently searched one.  This is
+        // done after the recursion so that an outer stream is always more
+        // recent than the streams nested in it, and those are released first.
+        //
+        RemoveEntryList (&CurrentChildNode->DecodedLink);
+        InsertTailList (&mDecodedStreamList, &CurrentChildNode->DecodedLink);
+      }
       if (*SectionInstance == 0) {
         //
         // The recursive FindChildNode() call decreased (*SectionInstance) to
@@ -1350,6 +1511,10 @@ GetSection (
   *BufferSize = SectionSize;
 
 GetSection_Done:
+  //
+  // The section has been copied out, so the decoded streams can be trimmed.
+  //
+  TrimDecodedStreamCache ();
   CoreRestoreTpl (OldTpl);
 
   return Status;
@@ -1372,6 +1537,7 @@ FreeChildNode (
   // Remove the child from it's list
   //
   RemoveEntryList (&ChildNode->Link);
+  UncacheDecodedStream (ChildNode);
 
   if (ChildNode->EncapsulatedStreamHandle != NULL_STREAM_HANDLE) {
     //
@@ -1160,6 +1160,8 @@ MigrateSecModulesInFv (
   @param FvIndex          The firmware volume index to migrate.
   @param OrgFvHandle      The handle to the firmware volume in temporary memory.
   @param FvHandle         The handle to the firmware volume in permanent memory.
+  @param RawDataFvHandle  The handle to the unmodified copy of the firmware volume
+                          in permanent memory the PEIM images are read from.
 
   @retval   EFI_SUCCESS           The PEIMs in the FV were migrated successfully
   @retval   EFI_INVALID_PARAMETER The Private pointer is NULL or FvCount is invalid.
@@ -1171,12 +1173,14 @@ MigratePeimsInFv (
   IN PEI_CORE_INSTANCE    *Private,
   IN  UINTN               FvIndex,
   IN  UINTN               OrgFvHandle,
-  IN  UINTN               FvHandle
+  IN  UINTN               FvHandle,
+  IN  UINTN               RawDataFvHandle
   )
 {
   EFI_STATUS              Status;
   volatile UINTN          FileIndex;
   EFI_PEI_FILE_HANDLE     MigratedFileHandle;
+  EFI_PEI_FILE_HANDLE     RawDataFileHandle;
   EFI_PEI_FILE_HANDLE     FileHandle;
 
   if (Private == NULL || FvIndex >= Private->FvCount) {
@@ -1189,9 +1193,14 @@ MigratePeimsInFv (
         FileHandle = Private->Fv[FvIndex].FvFileHandles[FileIndex];
 
         MigratedFileHandle = (EFI_PEI_FILE_HANDLE) ((UINTN) FileHandle - OrgFvHandle + FvHandle);
+        RawDataFileHandle  = (EFI_PEI_FILE_HANDLE) ((UINTN) FileHandle - OrgFvHandle + RawDataFvHandle);
 
+        //
+        // Read the image from the raw copy in permanent memory rather than
+        // from the original FV, which may be in slow flash.
+        //
         DEBUG ((DEBUG_VERBOSE, "    Migrating FileHandle %2d ", FileIndex));
-        Status = MigratePeim (FileHandle, MigratedFileHandle);
+        Status = MigratePeim (RawDataFileHandle, MigratedFileHandle);
         DEBUG ((DEBUG_VERBOSE, "\n"));
         ASSERT_EFI_ERROR (Status);
 
@@ -1336,7 +1345,13 @@ EvacuateTempRam (
           Private->Fv[FvChildIndex].FvHandle = (EFI_PEI_FV_HANDLE) MigratedChildFvHeader;
           DEBUG ((DEBUG_VERBOSE, "    Child migrated FV header at 0x%x.\n", (UINTN) MigratedChildFvHeader));
 
-          Status =  MigratePeimsInFv (Private, FvChildIndex, (UINTN) ChildFvHeader, (UINTN) MigratedChildFvHeader);
+          Status =  MigratePeimsInFv (
+                      Private,
+                      FvChildIndex,
+                      (UINTN) ChildFvHeader,
+                      (UINTN) MigratedChildFvHeader,
+                      (UINTN) RawDataFvHeader + ChildFvOffset
+                      );
           ASSERT_EFI_ERROR (Status);
 
           ConvertPpiPointersFv (
@@ -1358,7 +1373,7 @@ EvacuateTempRam (
       Private->Fv[FvIndex].FvHeader = MigratedFvHeader;
       Private->Fv[FvIndex].FvHandle = (EFI_PEI_FV_HANDLE) MigratedFvHeader;
 
-      Status = MigratePeimsInFv (Private, FvIndex, (UINTN) FvHeader, (UINTN) MigratedFvHeader);
+      Status = MigratePeimsInFv (Private, FvIndex, (UINTN) FvHeader, (UINTN) MigratedFvHeader, (UINTN) RawDataFvHeader);
       ASSERT_EFI_ERROR (Status);
 
       ConvertPpiPointersFv (
@@ -242,6 +242,350 @@ FileHandleToVolume (
   return NULL;
 }
 
+/**
+  Locate the FV file directory in the extension header of a FV.
+
+  The extension header entries are not necessarily aligned, so they are only
+  read with unaligned accesses.
+
+  @param FwVolHeader     Pointer to the FV header.
+  @param FileCount       Returns the number of entries of the directory.
+
+  @return Pointer to the first entry of the directory, or NULL if the FV has
+          no directory.
+
+**/
+EDKII_FV_FILE_DIRECTORY_ENTRY *
+GetFvFileDirectory (
+  IN  EFI_FIRMWARE_VOLUME_HEADER        *FwVolHeader,
+  OUT UINT32                            *FileCount
+  )
+{
+  EFI_FIRMWARE_VOLUME_EXT_HEADER        *FwVolExtHeader;
+  EFI_FIRMWARE_VOLUME_EXT_ENTRY         *ExtEntry;
+  EDKII_FV_FILE_DIRECTORY               *Directory;
+  UINT32                                ExtHeaderSize;
+  UINT32                                Offset;
+  UINT16                                EntrySize;
+  UINT32                                Count;
+
+  if ((FwVolHeader->ExtHeaderOffset == 0) ||
+      ((UINT64) FwVolHeader->ExtHeaderOffset + sizeof (EFI_FIRMWARE_VOLUME_EXT_HEADER) > FwVolHeader->FvLength)) {
+    return NULL;
+  }
+
+  FwVolExtHeader = (EFI_FIRMWARE_VOLUME_EXT_HEADER *) ((UINT8 *) FwVolHeader + FwVolHeader->ExtHeaderOffset);
+  ExtHeaderSize  = ReadUnaligned32 (&FwVolExtHeader->ExtHeaderSize);
+  if ((UINT64) FwVolHeader->ExtHeaderOffset + ExtHeaderSize > FwVolHeader->FvLength) {
+    return NULL;
+  }
+
+  for (Offset = sizeof (EFI_FIRMWARE_VOLUME_EXT_HEADER);
+       Offset + sizeof (EFI_FIRMWARE_VOLUME_EXT_ENTRY) <= ExtHeaderSize;
+       Offset += EntrySize) {
+    ExtEntry  = (EFI_FIRMWARE_VOLUME_EXT_ENTRY *) ((UINT8 *) FwVolExtHeader + Offset);
+    EntrySize = ReadUnaligned16 (&ExtEntry->ExtEntrySize);
+    if ((EntrySize < sizeof (EFI_FIRMWARE_VOLUME_EXT_ENTRY)) || (Offset + EntrySize > ExtHeaderSize)) {
+      break;
+    }
+
+    if ((ReadUnaligned16 (&ExtEntry->ExtEntryType) != EFI_FV_EXT_TYPE_GUID_TYPE) ||
+        (EntrySize < sizeof (EDKII_FV_FILE_DIRECTORY))) {
+      continue;
+    }
+
+    Directory = (EDKII_FV_FILE_DIRECTORY *) ExtEntry;
+    if (!CompareGuid (&Directory->FormatType, &gEdkiiFvFileDirectoryGuid)) {
+      continue;
+    }
+
+    Count = ReadUnaligned32 (&Directory->FileCount);
+    if (Count > (EntrySize - sizeof (EDKII_FV_FILE_DIRECTORY)) / sizeof (EDKII_FV_FILE_DIRECTORY_ENTRY)) {
+      return NULL;
+    }
+
+    *FileCount = Count;
+    return (EDKII_FV_FILE_DIRECTORY_ENTRY *) (Directory + 1);
+  }
+
+  return NULL;
+}
+
+/**
+  Search the FFS file index of a FV for the file at a given offset.
+
+  @param CoreFvHandle    Pointer to the PEI_CORE_FV_HANDLE of the indexed FV.
+  @param FileOffset      Offset of the FFS file header from the start of the FV.
+
+  @return Pointer to the index entry of the file, or NULL if no indexed file
+          starts at FileOffset.
+
+**/
+PEI_CORE_FV_FILE_INDEX_ENTRY *
+FindFileIndexEntryByOffset (
+  IN PEI_CORE_FV_HANDLE                 *CoreFvHandle,
+  IN UINTN                              FileOffset
+  )
+{
+  UINTN                                 Low;
+  UINTN                                 High;
+  UINTN                                 Middle;
+
+  Low  = 0;
+  High = CoreFvHandle->FileCount;
+  while (Low < High) {
+    Middle = (Low + High) / 2;
+    if (CoreFvHandle->FileIndex[Middle].Offset == FileOffset) {
+      return &CoreFvHandle->FileIndex[Middle];
+    }
+    if (CoreFvHandle->FileIndex[Middle].Offset < FileOffset) {
+      Low = Middle + 1;
+    } else {
+      High = Middle;
+    }
+  }
+
+  return NULL;
+}
+
+/**
+  Check that the FV file directory of an indexed FV lists exactly the files of
+  its FFS file index, sorted by name, so that name searches can use it.
+
+  The directory is produced by the build tools and is not covered by any
+  checksum, so it is only trusted once it matches the files that have been
+  verified while building the index.
+
+  @param CoreFvHandle    Pointer to the PEI_CORE_FV_HANDLE of the indexed FV.
+
+**/
+VOID
+ValidateFvFileDirectory (
+  IN OUT PEI_CORE_FV_HANDLE             *CoreFvHandle
+  )
+{
+  EDKII_FV_FILE_DIRECTORY_ENTRY         *Directory;
+  PEI_CORE_FV_FILE_INDEX_ENTRY          *Entry;
+  UINT32                                DirectoryCount;
+  UINT32                                Index;
+  UINT32                                Offset;
+  UINT32                                PreviousOffset;
+  INTN                                  Order;
+
+  CoreFvHandle->FileDirectoryOffset = 0;
+
+  Directory = GetFvFileDirectory ((EFI_FIRMWARE_VOLUME_HEADER *) CoreFvHandle->FvHandle, &DirectoryCount);
+  if ((Directory == NULL) || (DirectoryCount != CoreFvHandle->FileCount)) {
+    return;
+  }
+
+  PreviousOffset = 0;
+  for (Index = 0; Index < DirectoryCount; Index++) {
+    //
+    // Any file listed twice would leave another one out, so the entries must
+    // be strictly increasing.
+    //
+    Offset = ReadUnaligned32 (&Directory[Index].Offset);
+    if (Index > 0) {
+      Order = CompareMem (&Directory[Index - 1].Name, &Directory[Index].Name, sizeof (EFI_GUID));
+      if ((Order > 0) || ((Order == 0) && (PreviousOffset >= Offset))) {
+        return;
+      }
+    }
+    PreviousOffset = Offset;
+
+    Entry = FindFileIndexEntryByOffset (CoreFvHandle, Offset);
+    if ((Entry == NULL) || !CompareGuid (&Entry->Name, &Directory[Index].Name)) {
+      return;
+    }
+  }
+
+  CoreFvHandle->FileDirectoryOffset = (UINT32) ((UINT8 *) Directory - (UINT8 *) CoreFvHandle->FvHandle);
+}
+
+/**
+  Search the FFS file index of a FV for the first matching file, with the
+  same semantics as FindFileEx ().
+
+  @param CoreFvHandle    Pointer to the PEI_CORE_FV_HANDLE of the indexed FV.
+  @param FileName        File name
+  @param SearchType      Filter to find only files of this type.
+                         Type EFI_FV_FILETYPE_ALL causes no filtering to be done.
+  @param FileHandle      This parameter must point to a valid FFS volume.
+  @param AprioriFile     Pointer to AprioriFile image in this FV if has
+
+  @return EFI_NOT_FOUND  No files matching the search criteria were found
+  @retval EFI_SUCCESS    Success to search given file
+
+**/
+EFI_STATUS
+FindFileInIndex (
+  IN        PEI_CORE_FV_HANDLE       *CoreFvHandle,
+  IN  CONST EFI_GUID                 *FileName,   OPTIONAL
+  IN        EFI_FV_FILETYPE          SearchType,
+  IN OUT    EFI_PEI_FILE_HANDLE      *FileHandle,
+  IN OUT    EFI_PEI_FILE_HANDLE      *AprioriFile  OPTIONAL
+  )
+{
+  EFI_FFS_FILE_HEADER                   **FileHeader;
+  PEI_CORE_FV_FILE_INDEX_ENTRY          *Entry;
+  EDKII_FV_FILE_DIRECTORY_ENTRY         *Directory;
+  UINTN                                 Index;
+  UINTN                                 Low;
+  UINTN                                 High;
+  UINTN                                 Middle;
+  UINTN                                 FileOffset;
+
+  FileHeader = (EFI_FFS_FILE_HEADER **)FileHandle;
+
+  //
+  // Name searches binary search the FV file directory when there is one. The
+  // entries with the same name are sorted by offset, so the first one is the
+  // file the linear search would return.
+  //
+  if ((FileName != NULL) && (CoreFvHandle->FileDirectoryOffset != 0)) {
+    Directory = (EDKII_FV_FILE_DIRECTORY_ENTRY *) ((UINT8 *) CoreFvHandle->FvHandle + CoreFvHandle->FileDirectoryOffset);
+    Low  = 0;
+    High = CoreFvHandle->FileCount;
+    while (Low < High) {
+      Middle = (Low + High) / 2;
+      if (CompareMem (&Directory[Middle].Name, FileName, sizeof (EFI_GUID)) < 0) {
+        Low = Middle + 1;
+      } else {
+        High = Middle;
+      }
+    }
+
+    if ((Low < CoreFvHandle->FileCount) && CompareGuid (&Directory[Low].Name, FileName)) {
+      *FileHeader = (EFI_FFS_FILE_HEADER *) ((UINT8 *) CoreFvHandle->FvHandle + ReadUnaligned32 (&Directory[Low].Offset));
+      return EFI_SUCCESS;
+    }
+
+    *FileHeader = NULL;
+    return EFI_NOT_FOUND;
+  }
+
+  //
+  // If FileHeader is not specified (NULL) or FileName is not NULL,
+  // start with the first file in the firmware volume.  Otherwise,
+  // start from the first indexed file after FileHeader.
+  //
+  Low = 0;
+  if ((*FileHeader != NULL) && (FileName == NULL)) {
+    FileOffset = (UINTN) ((UINT8 *) *FileHeader - (UINT8 *) CoreFvHandle->FvHandle);
+    High = CoreFvHandle->FileCount;
+    while (Low < High) {
+      Middle = (Low + High) / 2;
+      if (CoreFvHandle->FileIndex[Middle].Offset <= FileOffset) {
+        Low = Middle + 1;
+      } else {
+        High = Middle;
+      }
+    }
+  }
+
+  for (Index = Low; Index < CoreFvHandle->FileCount; Index++) {
+    Entry = &CoreFvHandle->FileIndex[Index];
+    if (FileName != NULL) {
+      if (CompareGuid (&Entry->Name, FileName)) {
+        break;
+      }
+    } else if (SearchType == PEI_CORE_INTERNAL_FFS_FILE_DISPATCH_TYPE) {
+      if ((Entry->Type == EFI_FV_FILETYPE_PEIM) ||
+          (Entry->Type == EFI_FV_FILETYPE_COMBINED_PEIM_DRIVER) ||
+          (Entry->Type == EFI_FV_FILETYPE_FIRMWARE_VOLUME_IMAGE)) {
+        break;
+      } else if (AprioriFile != NULL) {
+        if (Entry->Type == EFI_FV_FILETYPE_FREEFORM) {
+          if (CompareGuid (&Entry->Name, &gPeiAprioriFileNameGuid)) {
+            *AprioriFile = (EFI_PEI_FILE_HANDLE) ((UINT8 *) CoreFvHandle->FvHandle + Entry->Offset);
+          }
+        }
+      }
+    } else if ((SearchType == Entry->Type) || (SearchType == EFI_FV_FILETYPE_ALL)) {
+      break;
+    }
+  }
+
+  if (Index == CoreFvHandle->FileCount) {
+    *FileHeader = NULL;
+    return EFI_NOT_FOUND;
+  }
+
+  *FileHeader = (EFI_FFS_FILE_HEADER *) ((UINT8 *) CoreFvHandle->FvHandle + CoreFvHandle->FileIndex[Index].Offset);
+  return EFI_SUCCESS;
+}
+
+/**
+  Build the FFS file index of a FV that is handled by the build-in
+  EFI_PEI_FIRMWARE_VOLUME_PPI, so that later FindFileEx () calls on it don't
+  need to walk and verify the FFS file headers again.
+
+  The index holds every file FindFileEx () returns for EFI_FV_FILETYPE_ALL,
+  that is all valid files except pad files. The walk stops at the first
+  corrupted file, as any later FindFileEx () walk would.
+
+  @param CoreFvHandle    Pointer to the PEI_CORE_FV_HANDLE of the FV.
+
+**/
+VOID
+BuildFvFileIndex (
+  IN OUT PEI_CORE_FV_HANDLE         *CoreFvHandle
+  )
+{
+  EFI_PEI_FILE_HANDLE           FileHandle;
+  PEI_CORE_FV_FILE_INDEX_ENTRY  *FileIndex;
+  UINTN                         FileCount;
+  UINTN                         Index;
+
+  //
+  // Only the build-in FV PPIs search files with FindFileEx ().
+  //
+  if ((CoreFvHandle->FvPpi != &mPeiFfs2FwVol.Fv) && (CoreFvHandle->FvPpi != &mPeiFfs3FwVol.Fv)) {
+    return;
+  }
+  if (CoreFvHandle->FileIndex != NULL) {
+    return;
+  }
+
+  FileCount  = 0;
+  FileHandle = NULL;
+  while (!EFI_ERROR (FindFileEx (CoreFvHandle->FvHandle, NULL, EFI_FV_FILETYPE_ALL, &FileHandle, NULL))) {
+    FileCount++;
+  }
+  if (FileCount == 0) {
+    return;
+  }
+
+  FileIndex = AllocatePool (sizeof (PEI_CORE_FV_FILE_INDEX_ENTRY) * FileCount);
+  if (FileIndex == NULL) {
+    //
+    // Without the index FindFileEx () keeps walking the FV.
+    //
+    return;
+  }
+
+  FileHandle = NULL;
+  for (Index = 0; Index < FileCount; Index++) {
+    FindFileEx (CoreFvHandle->FvHandle, NULL, EFI_FV_FILETYPE_ALL, &FileHandle, NULL);
+    ASSERT (FileHandle != NULL);
+    CopyGuid (&FileIndex[Index].Name, &((EFI_FFS_FILE_HEADER *) FileHandle)->Name);
+    FileIndex[Index].Offset = (UINT32) ((UINT8 *) FileHandle - (UINT8 *) CoreFvHandle->FvHandle);
+    FileIndex[Index].Type   = ((EFI_FFS_FILE_HEADER *) FileHandle)->Type;
+  }
+
+  CoreFvHandle->FileCount = FileCount;
+  CoreFvHandle->FileIndex = FileIndex;
+  ValidateFvFileDirectory (CoreFvHandle);
+  DEBUG ((
+    DEBUG_INFO,
+    "Indexed 0x%x FFS files in FV %p%a\n",
+    FileCount,
+    CoreFvHandle->FvHandle,
+    (CoreFvHandle->FileDirectoryOffset != 0) ? " with file directory" : ""
+    ));
+}
+
 /**
   Given the input file pointer, search for the first matching file in the
   FFS volume as defined by SearchType. The search starts from FileHeader inside
@@ -282,6 +626,15 @@ FindFileEx (
   UINT8                                 FileState;
   UINT8                                 DataCheckSum;
   BOOLEAN                               IsFfs3Fv;
+  PEI_CORE_FV_HANDLE                    *CoreFvHandle;
+
+  //
+  // Use the FFS file index built when the FV was installed, if there is one.
+  //
+  CoreFvHandle = FvHandleToCoreHandle (FvHandle);
+  if ((CoreFvHandle != NULL) && (CoreFvHandle->FileIndex != NULL)) {
+    return FindFileInIndex (CoreFvHandle, FileName, SearchType, FileHandle, AprioriFile);
+  }
 
   //
   // Convert the handle of FV to FV header for memory-mapped firmware volume
@@ -518,6 +871,8 @@ PeiInitializeFv (
     ));
   PrivateData->FvCount ++;
 
+  BuildFvFileIndex (&PrivateData->Fv[PrivateData->FvCount - 1]);
+
   //
   // Post a call-back for the FvInfoPPI and FvInfo2PPI services to expose
   // additional FVs to PeiCore.
@@ -660,6 +1015,8 @@ FirmwareVolumeInfoPpiNotifyCallback (
       ));
     PrivateData->FvCount ++;
 
+    BuildFvFileIndex (&PrivateData->Fv[CurFvCount]);
+
     //
     // Scan and process the new discovered FV for EFI_FV_FILETYPE_FIRMWARE_VOLUME_IMAGE
     //
@@ -2185,6 +2542,82 @@ PeiReinitializeFv (
   }
 }
 
+/**
+  Get the address to read a PE/COFF image from when it is shadowed into
+  permanent memory.
+
+  When PcdPeiCoreShadowPrefetch is TRUE, the first image shadowed out of a FV
+  that is not in permanent memory yet copies the whole FV into permanent memory
+  in one sequential read, and all images of the FV are then read from that copy.
+
+  @param PrivateData     Pointer to PEI_CORE_INSTANCE.
+  @param FileHandle      Pointer to the FFS file header of the image.
+  @param Pe32Data        Pointer to the PE/COFF image in the FV.
+
+  @return Pointer to the image in the prefetched copy of the FV, or Pe32Data
+          if the FV has not been prefetched.
+
+**/
+VOID *
+PeiGetPrefetchedImage (
+  IN PEI_CORE_INSTANCE            *PrivateData,
+  IN EFI_PEI_FILE_HANDLE          FileHandle,
+  IN VOID                         *Pe32Data
+  )
+{
+  EFI_STATUS                  Status;
+  PEI_CORE_FV_HANDLE          *CoreFvHandle;
+  EFI_FIRMWARE_VOLUME_HEADER  *FvHeader;
+  EFI_PHYSICAL_ADDRESS        Buffer;
+
+  if (!FeaturePcdGet (PcdPeiCoreShadowPrefetch) || !PrivateData->PeiMemoryInstalled) {
+    return Pe32Data;
+  }
+
+  CoreFvHandle = FileHandleToVolume (FileHandle);
+  if (CoreFvHandle == NULL) {
+    return Pe32Data;
+  }
+
+  //
+  // The image may come from an encapsulation section decoded out of the FV.
+  //
+  FvHeader = CoreFvHandle->FvHeader;
+  if (((UINTN) Pe32Data <= (UINTN) FvHeader) ||
+      ((UINT64) (UINTN) Pe32Data >= (UINT64) (UINTN) FvHeader + FvHeader->FvLength)) {
+    return Pe32Data;
+  }
+
+  if (!CoreFvHandle->PrefetchTried) {
+    CoreFvHandle->PrefetchTried = TRUE;
+
+    //
+    // Only prefetch FVs that are not in permanent memory yet, and keep the
+    // memory reserved for S3 resume for the PEIMs.
+    //
+    if ((PrivateData->HobList.HandoffInformationTable->BootMode != BOOT_ON_S3_RESUME) &&
+        !(((EFI_PHYSICAL_ADDRESS) (UINTN) FvHeader >= PrivateData->PhysicalMemoryBegin) &&
+          (((EFI_PHYSICAL_ADDRESS) (UINTN) FvHeader + (FvHeader->FvLength - 1)) < PrivateData->FreePhysicalMemoryTop))) {
+      Status = PeiServicesAllocatePages (
+                 EfiBootServicesData,
+                 EFI_SIZE_TO_PAGES ((UINTN) FvHeader->FvLength),
+                 &Buffer
+                 );
+      if (!EFI_ERROR (Status)) {
+        CopyMem ((VOID *) (UINTN) Buffer, FvHeader, (UINTN) FvHeader->FvLength);
+        CoreFvHandle->PrefetchedFv = (VOID *) (UINTN) Buffer;
+        DEBUG ((DEBUG_INFO, "Prefetched FV %p to 0x%lx for shadowing\n", FvHeader, Buffer));
+      }
+    }
+  }
+
+  if (CoreFvHandle->PrefetchedFv == NULL) {
+    return Pe32Data;
+  }
+
+  return (UINT8 *) CoreFvHandle->PrefetchedFv + ((UINTN) Pe32Data - (UINTN) FvHeader);
+}
+
 /**
   Report the information for a newly discovered FV in an unknown format.
 
@@ -276,6 +276,19 @@ FvHandleToCoreHandle (
   IN EFI_PEI_FV_HANDLE  FvHandle
   );
 
+/**
+  Build the FFS file index of a FV that is handled by the build-in
+  EFI_PEI_FIRMWARE_VOLUME_PPI, so that later FindFileEx () calls on it don't
+  need to walk and verify the FFS file headers again.
+
+  @param CoreFvHandle    Pointer to the PEI_CORE_FV_HANDLE of the FV.
+
+**/
+VOID
+BuildFvFileIndex (
+  IN OUT PEI_CORE_FV_HANDLE         *CoreFvHandle
+  );
+
 /**
   Given the input file pointer, search for the next matching file in the
   FFS volume as defined by SearchType. The search starts from FileHeader inside
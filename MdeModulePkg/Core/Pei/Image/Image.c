@@ -418,6 +418,14 @@ LoadAndRelocatePeCoffImage (
     }
   }
 
+  //
+  // When the image is copied to a new buffer, read it from the prefetched
+  // copy of its FV instead of scattered reads from the flash part.
+  //
+  if (ImageContext.ImageAddress != (EFI_PHYSICAL_ADDRESS)(UINTN) Pe32Data) {
+    ImageContext.Handle = PeiGetPrefetchedImage (Private, FileHandle, Pe32Data);
+  }
+
   //
   // Load the image to our new buffer
   //
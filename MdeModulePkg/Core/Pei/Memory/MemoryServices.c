@@ -311,28 +311,39 @@ InternalBuildMemoryAllocationHob (
   IN EFI_MEMORY_TYPE            MemoryType
   )
 {
+  PEI_CORE_INSTANCE             *PrivateData;
   EFI_PEI_HOB_POINTERS          Hob;
   EFI_HOB_MEMORY_ALLOCATION     *MemoryAllocationHob;
 
+  PrivateData = PEI_CORE_INSTANCE_FROM_PS_THIS (GetPeiServicesTablePointer ());
+
   //
   // Search unused(freed) memory allocation HOB.
+  // Skip the walk of the HOB list if the memory services have not freed any.
   //
   MemoryAllocationHob = NULL;
-  Hob.Raw = GetFirstHob (EFI_HOB_TYPE_UNUSED);
-  while (Hob.Raw != NULL) {
-    if (Hob.Header->HobLength == sizeof (EFI_HOB_MEMORY_ALLOCATION)) {
-      MemoryAllocationHob = (EFI_HOB_MEMORY_ALLOCATION *) Hob.Raw;
-      break;
+  if (PrivateData->UnusedMemoryAllocationHobCount != 0) {
+    Hob.Raw = GetFirstHob (EFI_HOB_TYPE_UNUSED);
+    while (Hob.Raw != NULL) {
+      if (Hob.Header->HobLength == sizeof (EFI_HOB_MEMORY_ALLOCATION)) {
+        MemoryAllocationHob = (EFI_HOB_MEMORY_ALLOCATION *) Hob.Raw;
+        break;
+      }
+
+      Hob.Raw = GET_NEXT_HOB (Hob);
+      Hob.Raw = GetNextHob (EFI_HOB_TYPE_UNUSED, Hob.Raw);
     }
 
-    Hob.Raw = GET_NEXT_HOB (Hob);
-    Hob.Raw = GetNextHob (EFI_HOB_TYPE_UNUSED, Hob.Raw);
+    if (MemoryAllocationHob == NULL) {
+      PrivateData->UnusedMemoryAllocationHobCount = 0;
+    }
   }
 
   if (MemoryAllocationHob != NULL) {
     //
     // Reuse the unused(freed) memory allocation HOB.
     //
+    PrivateData->UnusedMemoryAllocationHobCount--;
     MemoryAllocationHob->Header.HobType = EFI_HOB_TYPE_MEMORY_ALLOCATION;
     ZeroMem (&(MemoryAllocationHob->AllocDescriptor.Name), sizeof (EFI_GUID));
     MemoryAllocationHob->AllocDescriptor.MemoryBaseAddress = BaseAddress;
@@ -426,7 +437,9 @@ MergeFreeMemoryInMemoryAllocationHob (
   UINT64                        Start;
   UINT64                        End;
   BOOLEAN                       Merged;
+  PEI_CORE_INSTANCE             *PrivateData;
 
+  PrivateData = PEI_CORE_INSTANCE_FROM_PS_THIS (GetPeiServicesTablePointer ());
   Merged = FALSE;
 
   Hob.Raw = GetFirstHob (EFI_HOB_TYPE_MEMORY_ALLOCATION);
@@ -451,6 +464,7 @@ MergeFreeMemoryInMemoryAllocationHob (
             // Mark MemoryHob to be unused(freed).
             //
             MemoryHob->Header.HobType = EFI_HOB_TYPE_UNUSED;
+            PrivateData->UnusedMemoryAllocationHobCount++;
             break;
           } else if (End == MemoryHob2->AllocDescriptor.MemoryBaseAddress) {
             //
@@ -463,6 +477,7 @@ MergeFreeMemoryInMemoryAllocationHob (
             // Mark MemoryHob to be unused(freed).
             //
             MemoryHob->Header.HobType = EFI_HOB_TYPE_UNUSED;
+            PrivateData->UnusedMemoryAllocationHobCount++;
             break;
           }
         }
@@ -742,6 +757,7 @@ FreeMemoryAllocationHob (
     // Mark the memory allocation HOB to be unused(freed).
     //
     MemoryAllocationHobToFree->Header.HobType = EFI_HOB_TYPE_UNUSED;
+    PrivateData->UnusedMemoryAllocationHobCount++;
 
     MemoryAllocationHob = NULL;
     Hob.Raw = GetFirstHob (EFI_HOB_TYPE_MEMORY_ALLOCATION);
@@ -838,12 +854,76 @@ PeiFreePages (
   }
 }
 
+/**
+  Allocate a pool from the current pool arena in permanent memory, starting a
+  new arena of PcdPeiCorePoolArenaPages pages when the current one is too small.
+
+  The arenas are allocated as EfiBootServicesData pages, so each one is handed
+  to DXE as a single memory allocation HOB instead of one memory pool HOB per
+  allocated pool.
+
+  @param PrivateData               Pointer to PeiCore's private data structure.
+  @param Size                      Amount of memory required
+  @param Buffer                    Address of pointer to the buffer
+
+  @retval EFI_SUCCESS              The allocation was successful
+  @retval EFI_OUT_OF_RESOURCES     The pool does not fit in an arena, or no new
+                                   arena could be allocated.
+
+**/
+EFI_STATUS
+AllocatePoolFromArena (
+  IN PEI_CORE_INSTANCE          *PrivateData,
+  IN UINTN                      Size,
+  OUT VOID                      **Buffer
+  )
+{
+  EFI_STATUS                    Status;
+  EFI_PHYSICAL_ADDRESS          Arena;
+  UINTN                         ArenaPages;
+
+  ArenaPages = PcdGet32 (PcdPeiCorePoolArenaPages);
+
+  //
+  // Keep the same 8 bytes alignment as the data of memory pool HOBs.
+  //
+  Size = ALIGN_VALUE (Size, 8);
+  if (Size > PrivateData->PoolArenaRemaining) {
+    //
+    // Leave big pools to their own HOB instead of wasting most of the arena.
+    //
+    if (Size > EFI_PAGES_TO_SIZE (ArenaPages) / 2) {
+      return EFI_OUT_OF_RESOURCES;
+    }
+
+    Status = PeiAllocatePages (
+               (CONST EFI_PEI_SERVICES **) &PrivateData->Ps,
+               EfiBootServicesData,
+               ArenaPages,
+               &Arena
+               );
+    if (EFI_ERROR (Status)) {
+      return EFI_OUT_OF_RESOURCES;
+    }
+
+    PrivateData->PoolArenaFree      = Arena;
+    PrivateData->PoolArenaRemaining = EFI_PAGES_TO_SIZE (ArenaPages);
+  }
+
+  *Buffer = (VOID *) (UINTN) PrivateData->PoolArenaFree;
+  PrivateData->PoolArenaFree      += Size;
+  PrivateData->PoolArenaRemaining -= Size;
+
+  return EFI_SUCCESS;
+}
+
 /**
 
   Pool allocation service. Before permanent memory is discovered, the pool will
   be allocated in the heap in temporary memory. Generally, the size of the heap in temporary
   memory does not exceed 64K, so the biggest pool size could be allocated is
-  64K.
+  64K. After permanent memory is installed, small pools are carved from pool
+  arenas when PcdPeiCorePoolArenaPages is not 0.
 
   @param PeiServices               An indirect pointer to the EFI_PEI_SERVICES table published by the PEI Foundation.
   @param Size                      Amount of memory required
@@ -864,6 +944,7 @@ PeiAllocatePool (
 {
   EFI_STATUS               Status;
   EFI_HOB_MEMORY_POOL      *Hob;
+  PEI_CORE_INSTANCE        *PrivateData;
 
   //
   // If some "post-memory" PEIM wishes to allocate larger pool,
@@ -878,6 +959,18 @@ PeiAllocatePool (
     return EFI_OUT_OF_RESOURCES;
   }
 
+  //
+  // In permanent memory, carve the pool from a pool arena so that the HOB
+  // list does not grow with every allocation.
+  //
+  PrivateData = PEI_CORE_INSTANCE_FROM_PS_THIS (PeiServices);
+  if (PrivateData->PeiMemoryInstalled && (PcdGet32 (PcdPeiCorePoolArenaPages) != 0)) {
+    Status = AllocatePoolFromArena (PrivateData, Size, Buffer);
+    if (!EFI_ERROR (Status)) {
+      return Status;
+    }
+  }
+
   Status = PeiServicesCreateHob (
              EFI_HOB_TYPE_MEMORY_POOL,
              (UINT16)(sizeof (EFI_HOB_MEMORY_POOL) + Size),
@@ -45,6 +45,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Guid/FirmwareFileSystem3.h>
 #include <Guid/AprioriFileName.h>
 #include <Guid/MigratedFvInfo.h>
+#include <Guid/FvFileDirectory.h>
 
 ///
 /// It is an FFS type extension used for PeiFindFileEx. It indicates current
@@ -68,16 +69,31 @@ typedef union {
 #define CALLBACK_NOTIFY_GROWTH_STEP 32
 #define DISPATCH_NOTIFY_GROWTH_STEP 8
 
+///
+/// Number of GUID hash buckets of the PPI database, must be a power of 2.
+///
+#define PPI_HASH_BUCKETS            32
+
 typedef struct {
   UINTN                 CurrentCount;
   UINTN                 MaxCount;
   UINTN                 LastDispatchedCount;
   ///
   /// MaxCount number of entries.
+  /// When PcdPeiCoreHashedPpiDatabase is TRUE, the same buffer holds MaxCount
+  /// UINT16 hash chain links after the pointers, see PPI_HASH_NEXT().
   ///
   PEI_PPI_LIST_POINTERS *PpiPtrs;
+  ///
+  /// First and last PpiPtrs entry of each hash chain, stored as Index + 1.
+  /// 0 marks an empty chain or the end of a chain.
+  ///
+  UINT16                HashHead[PPI_HASH_BUCKETS];
+  UINT16                HashTail[PPI_HASH_BUCKETS];
 } PEI_PPI_LIST;
 
+#define PPI_HASH_NEXT(PpiList)      ((UINT16 *) ((PpiList)->PpiPtrs + (PpiList)->MaxCount))
+
 typedef struct {
   UINTN                 CurrentCount;
   UINTN                 MaxCount;
@@ -131,6 +147,19 @@ typedef struct {
 //
 #define FV_GROWTH_STEP 8
 
+///
+/// One valid, non-pad FFS file of an FV, in the order of the files in the FV.
+///
+typedef struct {
+  EFI_GUID                            Name;
+  ///
+  /// Offset of the FFS file header from the start of the FV, so the entry stays
+  /// valid when the FV is migrated to permanent memory.
+  ///
+  UINT32                              Offset;
+  EFI_FV_FILETYPE                     Type;
+} PEI_CORE_FV_FILE_INDEX_ENTRY;
+
 typedef struct {
   EFI_FIRMWARE_VOLUME_HEADER          *FvHeader;
   EFI_PEI_FIRMWARE_VOLUME_PPI         *FvPpi;
@@ -146,6 +175,23 @@ typedef struct {
   EFI_PEI_FILE_HANDLE                 *FvFileHandles;
   BOOLEAN                             ScanFv;
   UINT32                              AuthenticationStatus;
+  UINTN                               FileCount;
+  //
+  // Pointer to the buffer with the FileCount number of Entries,
+  // NULL if the FV has not been indexed.
+  //
+  PEI_CORE_FV_FILE_INDEX_ENTRY        *FileIndex;
+  //
+  // Offset of the first entry of the FV file directory from the start of the
+  // FV, 0 if the FV has no directory that matches FileIndex.
+  //
+  UINT32                              FileDirectoryOffset;
+  //
+  // Copy of the FV in permanent memory that images are shadowed from,
+  // NULL if the FV has not been prefetched. See PcdPeiCoreShadowPrefetch.
+  //
+  VOID                                *PrefetchedFv;
+  BOOLEAN                             PrefetchTried;
 } PEI_CORE_FV_HANDLE;
 
 typedef struct {
@@ -273,6 +319,16 @@ struct _PEI_CORE_INSTANCE {
   // Information for migrating memory pages allocated in pre-memory phase.
   //
   HOLE_MEMORY_DATA                   MemoryPages;
+  //
+  // Current pool arena in permanent memory, see PcdPeiCorePoolArenaPages.
+  //
+  EFI_PHYSICAL_ADDRESS               PoolArenaFree;
+  UINTN                              PoolArenaRemaining;
+  //
+  // Number of memory allocation HOBs marked unused by the memory services
+  // that may be reused for new memory allocation HOBs.
+  //
+  UINTN                              UnusedMemoryAllocationHobCount;
   PEICORE_FUNCTION_POINTER           ShadowedPeiCore;
   CACHE_SECTION_DATA                 CacheSection;
   //
@@ -2034,4 +2090,27 @@ PeiReinitializeFv (
   IN  PEI_CORE_INSTANCE           *PrivateData
   );
 
+/**
+  Get the address to read a PE/COFF image from when it is shadowed into
+  permanent memory.
+
+  When PcdPeiCoreShadowPrefetch is TRUE, the first image shadowed out of a FV
+  that is not in permanent memory yet copies the whole FV into permanent memory
+  in one sequential read, and all images of the FV are then read from that copy.
+
+  @param PrivateData     Pointer to PEI_CORE_INSTANCE.
+  @param FileHandle      Pointer to the FFS file header of the image.
+  @param Pe32Data        Pointer to the PE/COFF image in the FV.
+
+  @return Pointer to the image in the prefetched copy of the FV, or Pe32Data
+          if the FV has not been prefetched.
+
+**/
+VOID *
+PeiGetPrefetchedImage (
+  IN PEI_CORE_INSTANCE            *PrivateData,
+  IN EFI_PEI_FILE_HANDLE          FileHandle,
+  IN VOID                         *Pe32Data
+  );
+
 #endif
@@ -419,6 +419,78 @@ DumpPpiList (
   DEBUG_CODE_END ();
 }
 
+/**
+  Get the hash bucket of a PPI GUID in the PPI database.
+
+  @param Guid            Pointer to the PPI GUID.
+
+  @return Index of the hash bucket, less than PPI_HASH_BUCKETS.
+
+**/
+UINTN
+PpiHashBucket (
+  IN CONST EFI_GUID  *Guid
+  )
+{
+  UINT32  Hash;
+
+  Hash = ((UINT32 *)Guid)[0] ^ ((UINT32 *)Guid)[1] ^ ((UINT32 *)Guid)[2] ^ ((UINT32 *)Guid)[3];
+  Hash ^= Hash >> 16;
+  Hash ^= Hash >> 8;
+  return Hash & (PPI_HASH_BUCKETS - 1);
+}
+
+/**
+  Append one PPI database entry to the tail of its hash chain.
+
+  Entries are linked in ascending index order, so a chain walk visits the
+  instances of a GUID in the same order as a linear search of PpiPtrs.
+
+  @param PpiListPointer  Pointer to the PPI list of the PPI database.
+  @param Index           Index of the entry in PpiPtrs.
+
+**/
+VOID
+PpiHashLink (
+  IN OUT PEI_PPI_LIST  *PpiListPointer,
+  IN UINTN             Index
+  )
+{
+  UINTN   Bucket;
+  UINT16  *Next;
+
+  Bucket = PpiHashBucket (PpiListPointer->PpiPtrs[Index].Ppi->Guid);
+  Next   = PPI_HASH_NEXT (PpiListPointer);
+
+  Next[Index] = 0;
+  if (PpiListPointer->HashTail[Bucket] == 0) {
+    PpiListPointer->HashHead[Bucket] = (UINT16) (Index + 1);
+  } else {
+    Next[PpiListPointer->HashTail[Bucket] - 1] = (UINT16) (Index + 1);
+  }
+  PpiListPointer->HashTail[Bucket] = (UINT16) (Index + 1);
+}
+
+/**
+  Rebuild all hash chains of the PPI database from PpiPtrs.
+
+  @param PpiListPointer  Pointer to the PPI list of the PPI database.
+
+**/
+VOID
+PpiHashRebuild (
+  IN OUT PEI_PPI_LIST  *PpiListPointer
+  )
+{
+  UINTN  Index;
+
+  ZeroMem (PpiListPointer->HashHead, sizeof (PpiListPointer->HashHead));
+  ZeroMem (PpiListPointer->HashTail, sizeof (PpiListPointer->HashTail));
+  for (Index = 0; Index < PpiListPointer->CurrentCount; Index++) {
+    PpiHashLink (PpiListPointer, Index);
+  }
+}
+
 /**
 
   This function installs an interface in the PEI PPI database by GUID.
@@ -449,6 +521,7 @@ InternalPeiInstallPpi (
   UINTN                 Index;
   UINTN                 LastCount;
   VOID                  *TempPtr;
+  UINTN                 EntrySize;
 
   if (PpiList == NULL) {
     return EFI_INVALID_PARAMETER;
@@ -460,6 +533,14 @@ InternalPeiInstallPpi (
   Index = PpiListPointer->CurrentCount;
   LastCount = Index;
 
+  //
+  // The hash chain links are kept in the PpiPtrs buffer, after the pointers.
+  //
+  EntrySize = sizeof (PEI_PPI_LIST_POINTERS);
+  if (FeaturePcdGet (PcdPeiCoreHashedPpiDatabase)) {
+    EntrySize += sizeof (UINT16);
+  }
+
   //
   // This is loop installs all PPI descriptors in the PpiList.  It is terminated
   // by the EFI_PEI_PPI_DESCRIPTOR_TERMINATE_LIST being set in the last
@@ -483,7 +564,7 @@ InternalPeiInstallPpi (
       // Run out of room, grow the buffer.
       //
       TempPtr = AllocateZeroPool (
-                  sizeof (PEI_PPI_LIST_POINTERS) * (PpiListPointer->MaxCount + PPI_GROWTH_STEP)
+                  EntrySize * (PpiListPointer->MaxCount + PPI_GROWTH_STEP)
                   );
       ASSERT (TempPtr != NULL);
       CopyMem (
@@ -491,6 +572,14 @@ InternalPeiInstallPpi (
         PpiListPointer->PpiPtrs,
         sizeof (PEI_PPI_LIST_POINTERS) * PpiListPointer->MaxCount
         );
+      if (FeaturePcdGet (PcdPeiCoreHashedPpiDatabase)) {
+        ASSERT (PpiListPointer->MaxCount + PPI_GROWTH_STEP < MAX_UINT16);
+        CopyMem (
+          (PEI_PPI_LIST_POINTERS *) TempPtr + PpiListPointer->MaxCount + PPI_GROWTH_STEP,
+          PPI_HASH_NEXT (PpiListPointer),
+          sizeof (UINT16) * PpiListPointer->MaxCount
+          );
+      }
       PpiListPointer->PpiPtrs = TempPtr;
       PpiListPointer->MaxCount = PpiListPointer->MaxCount + PPI_GROWTH_STEP;
     }
@@ -518,6 +607,16 @@ InternalPeiInstallPpi (
     PpiList++;
   }
 
+  //
+  // Link the new PPIs into their hash chains only now that the whole list is
+  // accepted, so a rolled back list never leaves stale links behind.
+  //
+  if (FeaturePcdGet (PcdPeiCoreHashedPpiDatabase)) {
+    for (Index = LastCount; Index < PpiListPointer->CurrentCount; Index++) {
+      PpiHashLink (PpiListPointer, Index);
+    }
+  }
+
   //
   // Process any callback level notifies for newly installed PPIs.
   //
@@ -616,6 +715,13 @@ PeiReInstallPpi (
   DEBUG((EFI_D_INFO, "Reinstall PPI: %g\n", NewPpi->Guid));
   PrivateData->PpiData.PpiList.PpiPtrs[Index].Ppi = (EFI_PEI_PPI_DESCRIPTOR *) NewPpi;
 
+  //
+  // The entry keeps its place in the chain unless the new PPI has another GUID.
+  //
+  if (FeaturePcdGet (PcdPeiCoreHashedPpiDatabase) && !CompareGuid (OldPpi->Guid, NewPpi->Guid)) {
+    PpiHashRebuild (&PrivateData->PpiData.PpiList);
+  }
+
   //
   // Process any callback level notifies for the newly installed PPI.
   //
@@ -658,18 +764,33 @@ PeiLocatePpi (
   )
 {
   PEI_CORE_INSTANCE         *PrivateData;
+  PEI_PPI_LIST              *PpiListPointer;
   UINTN                     Index;
+  UINTN                     Link;
   EFI_GUID                  *CheckGuid;
   EFI_PEI_PPI_DESCRIPTOR    *TempPtr;
 
 
   PrivateData = PEI_CORE_INSTANCE_FROM_PS_THIS(PeiServices);
+  PpiListPointer = &PrivateData->PpiData.PpiList;
 
   //
   // Search the data base for the matching instance of the GUIDed PPI.
+  // With the hashed database only the chain of the GUID's bucket is walked.
   //
-  for (Index = 0; Index < PrivateData->PpiData.PpiList.CurrentCount; Index++) {
-    TempPtr = PrivateData->PpiData.PpiList.PpiPtrs[Index].Ppi;
+  Link = 0;
+  if (FeaturePcdGet (PcdPeiCoreHashedPpiDatabase)) {
+    Link = PpiListPointer->HashHead[PpiHashBucket (Guid)];
+  }
+  for (Index = 0; Index < PpiListPointer->CurrentCount; Index++) {
+    if (FeaturePcdGet (PcdPeiCoreHashedPpiDatabase)) {
+      if (Link == 0) {
+        break;
+      }
+      Index = Link - 1;
+      Link  = PPI_HASH_NEXT (PpiListPointer)[Index];
+    }
+    TempPtr = PpiListPointer->PpiPtrs[Index].Ppi;
     CheckGuid = TempPtr->Guid;
 
     //
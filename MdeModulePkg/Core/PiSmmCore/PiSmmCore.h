@@ -54,6 +54,7 @@
 #include <Library/PerformanceLib.h>
 #include <Library/HobLib.h>
 #include <Library/SmmMemLib.h>
+#include <Library/TimerLib.h>
 
 #include "PiSmmCorePrivateData.h"
 #include "HeapGuard.h"
@@ -74,13 +75,17 @@ typedef struct {
 
 #define SMI_ENTRY_SIGNATURE  SIGNATURE_32('s','m','i','e')
 
- typedef struct {
+ typedef struct _SMI_ENTRY SMI_ENTRY;
+
+ struct _SMI_ENTRY {
   UINTN       Signature;
   LIST_ENTRY  AllEntries;  // All entries
 
   EFI_GUID    HandlerType; // Type of interrupt
   LIST_ENTRY  SmiHandlers; // All handlers
-} SMI_ENTRY;
+
+  SMI_ENTRY   *HashNext;   // Next entry in the same bucket of mSmiEntryHashTable
+};
 
 #define SMI_HANDLER_SIGNATURE  SIGNATURE_32('s','m','i','h')
 
@@ -92,6 +97,7 @@ typedef struct {
   SMI_ENTRY                     *SmiEntry;
   VOID                          *Context;    // for profile
   UINTN                         ContextSize; // for profile
+  SMI_HANDLER_PROFILE_LATENCY   *Latency;    // for profile
 } SMI_HANDLER;
 
 //
@@ -1148,6 +1154,20 @@ SmmCoreInitializeSmiHandlerProfile (
   VOID
   );
 
+/**
+  Record one run of an SMI handler in its run time statistics.
+
+  @param Latency         The run time statistics of the SMI handler.
+  @param StartTicks      The performance counter before the handler ran.
+  @param EndTicks        The performance counter after the handler ran.
+**/
+VOID
+SmiHandlerProfileRecordLatency (
+  IN OUT SMI_HANDLER_PROFILE_LATENCY  *Latency,
+  IN     UINT64                       StartTicks,
+  IN     UINT64                       EndTicks
+  );
+
 /**
   This function is called by SmmChildDispatcher module to report
   a new SMI handler is registered, to SmmCore.
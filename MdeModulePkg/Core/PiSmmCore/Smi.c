@@ -8,8 +8,19 @@
 
 #include "PiSmmCore.h"
 
+//
+// Number of buckets of mSmiEntryHashTable, a power of 2.
+//
+#define SMI_ENTRY_HASH_TABLE_SIZE  64
+
 LIST_ENTRY  mSmiEntryList       = INITIALIZE_LIST_HEAD_VARIABLE (mSmiEntryList);
 
+//
+// The GUID SMI entries of mSmiEntryList, hashed by handler type, so that
+// SmiManage() does not have to walk all the entries on every SMI.
+//
+SMI_ENTRY   *mSmiEntryHashTable[SMI_ENTRY_HASH_TABLE_SIZE];
+
 SMI_ENTRY   mRootSmiEntry = {
   SMI_ENTRY_SIGNATURE,
   INITIALIZE_LIST_HEAD_VARIABLE (mRootSmiEntry.AllEntries),
@@ -17,6 +28,30 @@ SMI_ENTRY   mRootSmiEntry = {
   INITIALIZE_LIST_HEAD_VARIABLE (mRootSmiEntry.SmiHandlers),
 };
 
+/**
+  Returns the bucket of mSmiEntryHashTable for a handler type.
+
+  @param  HandlerType            The type of the interrupt
+
+  @return The index of the bucket.
+
+**/
+UINTN
+SmiEntryHash (
+  IN CONST EFI_GUID  *HandlerType
+  )
+{
+  UINT32  Hash;
+
+  Hash = ReadUnaligned32 ((CONST UINT32 *)HandlerType) ^
+         ReadUnaligned32 ((CONST UINT32 *)HandlerType + 1) ^
+         ReadUnaligned32 ((CONST UINT32 *)HandlerType + 2) ^
+         ReadUnaligned32 ((CONST UINT32 *)HandlerType + 3);
+  Hash ^= Hash >> 16;
+  Hash ^= Hash >> 8;
+  return Hash & (SMI_ENTRY_HASH_TABLE_SIZE - 1);
+}
+
 /**
   Finds the SMI entry for the requested handler type.
 
@@ -33,19 +68,17 @@ SmmCoreFindSmiEntry (
   IN BOOLEAN   Create
   )
 {
-  LIST_ENTRY  *Link;
+  UINTN       Bucket;
   SMI_ENTRY   *Item;
   SMI_ENTRY   *SmiEntry;
 
   //
-  // Search the SMI entry list for the matching GUID
+  // Search the SMI entry hash table for the matching GUID
   //
   SmiEntry = NULL;
-  for (Link = mSmiEntryList.ForwardLink;
-       Link != &mSmiEntryList;
-       Link = Link->ForwardLink) {
-
-    Item = CR (Link, SMI_ENTRY, AllEntries, SMI_ENTRY_SIGNATURE);
+  Bucket   = SmiEntryHash (HandlerType);
+  for (Item = mSmiEntryHashTable[Bucket]; Item != NULL; Item = Item->HashNext) {
+    ASSERT (Item->Signature == SMI_ENTRY_SIGNATURE);
     if (CompareGuid (&Item->HandlerType, HandlerType)) {
       //
       // This is the SMI entry
@@ -73,6 +106,8 @@ SmmCoreFindSmiEntry (
       // Add it to SMI entry list
       //
       InsertTailList (&mSmiEntryList, &SmiEntry->AllEntries);
+      SmiEntry->HashNext          = mSmiEntryHashTable[Bucket];
+      mSmiEntryHashTable[Bucket] = SmiEntry;
     }
   }
   return SmiEntry;
@@ -107,8 +142,10 @@ SmiManage (
   SMI_HANDLER  *SmiHandler;
   BOOLEAN      SuccessReturn;
   EFI_STATUS   Status;
+  UINT64       StartTicks;
 
   Status = EFI_NOT_FOUND;
+  StartTicks = 0;
   SuccessReturn = FALSE;
   if (HandlerType == NULL) {
     //
@@ -132,6 +169,10 @@ SmiManage (
   for (Link = Head->ForwardLink; Link != Head; Link = Link->ForwardLink) {
     SmiHandler = CR (Link, SMI_HANDLER, Link, SMI_HANDLER_SIGNATURE);
 
+    if (SmiHandler->Latency != NULL) {
+      StartTicks = GetPerformanceCounter ();
+    }
+
     Status = SmiHandler->Handler (
                (EFI_HANDLE) SmiHandler,
                Context,
@@ -139,6 +180,10 @@ SmiManage (
                CommBufferSize
                );
 
+    if (SmiHandler->Latency != NULL) {
+      SmiHandlerProfileRecordLatency (SmiHandler->Latency, StartTicks, GetPerformanceCounter ());
+    }
+
     switch (Status) {
     case EFI_INTERRUPT_PENDING:
       //
@@ -229,6 +274,13 @@ SmiHandlerRegister (
   SmiHandler->Handler = Handler;
   SmiHandler->CallerAddr = (UINTN)RETURN_ADDRESS (0);
 
+  if ((PcdGet8 (PcdSmiHandlerProfilePropertyMask) & (BIT0 | BIT1)) == (BIT0 | BIT1)) {
+    //
+    // The run time statistics are optional, go on without them.
+    //
+    SmiHandler->Latency = AllocateZeroPool (sizeof (SMI_HANDLER_PROFILE_LATENCY));
+  }
+
   if (HandlerType == NULL) {
     //
     // This is root SMI handler
@@ -270,6 +322,7 @@ SmiHandlerUnRegister (
 {
   SMI_HANDLER  *SmiHandler;
   SMI_ENTRY    *SmiEntry;
+  SMI_ENTRY    **Link;
   LIST_ENTRY   *EntryLink;
   LIST_ENTRY   *HandlerLink;
 
@@ -311,9 +364,12 @@ SmiHandlerUnRegister (
   SmiEntry = SmiHandler->SmiEntry;
 
   RemoveEntryList (&SmiHandler->Link);
+  if (SmiHandler->Latency != NULL) {
+    FreePool (SmiHandler->Latency);
+  }
   FreePool (SmiHandler);
 
-  if (SmiEntry == NULL) {
+  if ((SmiEntry == NULL) || (SmiEntry == &mRootSmiEntry)) {
     //
     // This is root SMI handler
     //
@@ -325,6 +381,12 @@ SmiHandlerUnRegister (
     // No handler registered for this interrupt now, remove the SMI_ENTRY
     //
     RemoveEntryList (&SmiEntry->AllEntries);
+    for (Link = &mSmiEntryHashTable[SmiEntryHash (&SmiEntry->HandlerType)];
+         *Link != SmiEntry;
+         Link = &(*Link)->HashNext) {
+      ASSERT (*Link != NULL);
+    }
+    *Link = SmiEntry->HashNext;
 
     FreePool (SmiEntry);
   }
@@ -98,6 +98,13 @@ GLOBAL_REMOVE_IF_UNREFERENCED UINTN  mSmmHardwareSmiDatabaseSize;
 
 GLOBAL_REMOVE_IF_UNREFERENCED BOOLEAN  mSmiHandlerProfileRecordingStatus;
 
+//
+// Performance counter properties, read at the first latency record.
+//
+GLOBAL_REMOVE_IF_UNREFERENCED BOOLEAN  mSmiHandlerLatencyCounterReady;
+GLOBAL_REMOVE_IF_UNREFERENCED UINT64   mSmiHandlerLatencyCounterStart;
+GLOBAL_REMOVE_IF_UNREFERENCED UINT64   mSmiHandlerLatencyCounterEnd;
+
 GLOBAL_REMOVE_IF_UNREFERENCED SMI_HANDLER_PROFILE_PROTOCOL  mSmiHandlerProfile = {
   SmiHandlerProfileRegisterHandler,
   SmiHandlerProfileUnregisterHandler,
@@ -561,6 +568,9 @@ GetSmmSmiHandlerSizeOnSmiEntry(
        ListEntry = ListEntry->ForwardLink) {
     SmiHandler = CR(ListEntry, SMI_HANDLER, Link, SMI_HANDLER_SIGNATURE);
     Size += sizeof(SMM_CORE_SMI_HANDLER_STRUCTURE) + GET_OCCUPIED_SIZE (SmiHandler->ContextSize, sizeof (UINT64));
+    if (SmiHandler->Latency != NULL) {
+      Size += sizeof (SMI_HANDLER_PROFILE_LATENCY);
+    }
   }
 
   return Size;
@@ -685,6 +695,7 @@ GetSmmSmiHandlerDataOnSmiEntry(
   LIST_ENTRY                       *ListEntry;
   SMI_HANDLER                      *SmiHandler;
   UINTN                            Size;
+  UINTN                            HandlerSize;
 
   SmiHandlerStruct = Data;
   Size = 0;
@@ -698,11 +709,15 @@ GetSmmSmiHandlerDataOnSmiEntry(
       *Count = 0;
       return 0;
     }
-    if (sizeof(SMM_CORE_SMI_HANDLER_STRUCTURE) + GET_OCCUPIED_SIZE (SmiHandler->ContextSize, sizeof (UINT64)) > MaxSize - Size) {
+    HandlerSize = sizeof(SMM_CORE_SMI_HANDLER_STRUCTURE) + GET_OCCUPIED_SIZE (SmiHandler->ContextSize, sizeof (UINT64));
+    if (SmiHandler->Latency != NULL) {
+      HandlerSize += sizeof (SMI_HANDLER_PROFILE_LATENCY);
+    }
+    if (HandlerSize > MaxSize - Size) {
       *Count = 0;
       return 0;
     }
-    SmiHandlerStruct->Length = (UINT32)(sizeof(SMM_CORE_SMI_HANDLER_STRUCTURE) + GET_OCCUPIED_SIZE (SmiHandler->ContextSize, sizeof (UINT64)));
+    SmiHandlerStruct->Length = (UINT32)HandlerSize;
     SmiHandlerStruct->CallerAddr = (UINTN)SmiHandler->CallerAddr;
     SmiHandlerStruct->Handler = (UINTN)SmiHandler->Handler;
     SmiHandlerStruct->ImageRef = AddressToImageRef((UINTN)SmiHandler->Handler);
@@ -713,7 +728,13 @@ GetSmmSmiHandlerDataOnSmiEntry(
     } else {
       SmiHandlerStruct->ContextBufferOffset = 0;
     }
-    Size += sizeof(SMM_CORE_SMI_HANDLER_STRUCTURE) + GET_OCCUPIED_SIZE (SmiHandler->ContextSize, sizeof (UINT64));
+    if (SmiHandler->Latency != NULL) {
+      SmiHandlerStruct->LatencyOffset = (UINT16)(sizeof(SMM_CORE_SMI_HANDLER_STRUCTURE) + GET_OCCUPIED_SIZE (SmiHandler->ContextSize, sizeof (UINT64)));
+      CopyMem ((UINT8 *)SmiHandlerStruct + SmiHandlerStruct->LatencyOffset, SmiHandler->Latency, sizeof (SMI_HANDLER_PROFILE_LATENCY));
+    } else {
+      SmiHandlerStruct->LatencyOffset = 0;
+    }
+    Size += HandlerSize;
     SmiHandlerStruct = (SMM_CORE_SMI_HANDLER_STRUCTURE *)((UINTN)SmiHandlerStruct + SmiHandlerStruct->Length);
     *Count = *Count + 1;
   }
@@ -891,6 +912,17 @@ SmiHandlerProfileHandlerGetInfo(
   SmiHandlerProfileRecordingStatus = mSmiHandlerProfileRecordingStatus;
   mSmiHandlerProfileRecordingStatus = FALSE;
 
+  if ((PcdGet8 (PcdSmiHandlerProfilePropertyMask) & BIT1) != 0) {
+    //
+    // Take a new snapshot of the SMI handler run time statistics.
+    //
+    FreePool (mSmiHandlerProfileDatabase);
+    BuildSmiHandlerProfileDatabase ();
+    if (mSmiHandlerProfileDatabase == NULL) {
+      mSmiHandlerProfileDatabaseSize = 0;
+    }
+  }
+
   SmiHandlerProfileParameterGetInfo->DataSize = mSmiHandlerProfileDatabaseSize;
   SmiHandlerProfileParameterGetInfo->Header.ReturnStatus = 0;
 
@@ -1332,6 +1364,58 @@ SmiHandlerProfileUnregisterHandler (
   return EFI_SUCCESS;
 }
 
+/**
+  Record one run of an SMI handler in its run time statistics.
+
+  @param Latency         The run time statistics of the SMI handler.
+  @param StartTicks      The performance counter before the handler ran.
+  @param EndTicks        The performance counter after the handler ran.
+**/
+VOID
+SmiHandlerProfileRecordLatency (
+  IN OUT SMI_HANDLER_PROFILE_LATENCY  *Latency,
+  IN     UINT64                       StartTicks,
+  IN     UINT64                       EndTicks
+  )
+{
+  UINT64  Ticks;
+  UINT64  Time;
+  UINTN   Bucket;
+
+  if (!mSmiHandlerLatencyCounterReady) {
+    GetPerformanceCounterProperties (&mSmiHandlerLatencyCounterStart, &mSmiHandlerLatencyCounterEnd);
+    mSmiHandlerLatencyCounterReady = TRUE;
+  }
+
+  //
+  // The performance counter may count down, and may roll over once.
+  //
+  if (mSmiHandlerLatencyCounterEnd < mSmiHandlerLatencyCounterStart) {
+    Ticks = StartTicks - EndTicks;
+    if (StartTicks < EndTicks) {
+      Ticks += mSmiHandlerLatencyCounterStart - mSmiHandlerLatencyCounterEnd;
+    }
+  } else {
+    Ticks = EndTicks - StartTicks;
+    if (EndTicks < StartTicks) {
+      Ticks += mSmiHandlerLatencyCounterEnd - mSmiHandlerLatencyCounterStart;
+    }
+  }
+  Time = GetTimeInNanoSecond (Ticks);
+
+  Bucket = (UINTN)(HighBitSet64 (DivU64x32 (Time, 1000)) + 1);
+  if (Bucket >= SMI_HANDLER_PROFILE_LATENCY_BUCKETS) {
+    Bucket = SMI_HANDLER_PROFILE_LATENCY_BUCKETS - 1;
+  }
+
+  Latency->Count++;
+  Latency->TotalTime += Time;
+  if (Time > Latency->MaxTime) {
+    Latency->MaxTime = Time;
+  }
+  Latency->Histogram[Bucket]++;
+}
+
 /**
   Initialize SmiHandler profile feature.
 **/
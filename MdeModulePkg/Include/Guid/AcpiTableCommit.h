@@ -0,0 +1,22 @@
+/** @file
+  This GUID names the event group that asks the ACPI table driver to checksum
+  and publish the tables it deferred while PcdAcpiTableDeferredPublish is set.
+  Platforms signal it with EfiEventGroupSignal() once a batch of tables has
+  been installed and must be visible to other drivers.
+
+  Copyright (c) 2021, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef __ACPI_TABLE_COMMIT_H__
+#define __ACPI_TABLE_COMMIT_H__
+
+#define EDKII_ACPI_TABLE_COMMIT_GUID \
+  { \
+    0x309b3bb4, 0x5e53, 0x4bc5, {0x8f, 0xfb, 0x65, 0x69, 0xf1, 0x1a, 0x64, 0xd5 } \
+  }
+
+extern EFI_GUID gEdkiiAcpiTableCommitGuid;
+
+#endif
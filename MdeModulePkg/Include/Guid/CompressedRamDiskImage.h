@@ -0,0 +1,79 @@
+/** @file
+  Layout of a compressed RAM disk image.
+
+  A RAM disk registered through EFI_RAM_DISK_PROTOCOL may hold the disk as a
+  compressed image instead of the plain content, when the platform enables
+  PcdRamDiskCompressedImageSupport. The image starts with the header below,
+  followed at HeaderSize by a table holding one entry per ChunkSize bytes of
+  the disk. Every chunk is stored on its own, so that any of them can be read
+  without decompressing the others. Chunks holding only zeros take no space.
+
+  All the fields are little endian.
+
+  Copyright (c) 2021, EDK II contributors. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef __EDKII_COMPRESSED_RAM_DISK_IMAGE_H__
+#define __EDKII_COMPRESSED_RAM_DISK_IMAGE_H__
+
+#define EDKII_COMPRESSED_RAM_DISK_IMAGE_GUID \
+  { \
+    0x444aabe1, 0xb72f, 0x4a1e, { 0xb7, 0x0e, 0x30, 0x67, 0x19, 0x6d, 0x96, 0xdb } \
+  }
+
+///
+/// Chunk types.
+///
+#define EDKII_COMPRESSED_RAM_DISK_CHUNK_ZERO        0   ///< All zeros, no data.
+#define EDKII_COMPRESSED_RAM_DISK_CHUNK_STORED      1   ///< Data stored as is.
+#define EDKII_COMPRESSED_RAM_DISK_CHUNK_UEFI        2   ///< UEFI compressed data.
+
+#pragma pack(1)
+
+typedef struct {
+  ///
+  /// EDKII_COMPRESSED_RAM_DISK_IMAGE_GUID.
+  ///
+  EFI_GUID  Signature;
+  ///
+  /// Size of this header; the chunk table starts at this offset.
+  ///
+  UINT32    HeaderSize;
+  ///
+  /// Number of disk bytes per chunk, a power of two of at least 512. The last
+  /// chunk is shorter when DiskSize is not a multiple of ChunkSize.
+  ///
+  UINT32    ChunkSize;
+  ///
+  /// Size in bytes of the uncompressed disk.
+  ///
+  UINT64    DiskSize;
+  ///
+  /// Number of entries in the chunk table, DiskSize divided by ChunkSize and
+  /// rounded up.
+  ///
+  UINT64    ChunkCount;
+} EDKII_COMPRESSED_RAM_DISK_IMAGE_HEADER;
+
+typedef struct {
+  ///
+  /// Offset of the chunk data from the start of the image.
+  ///
+  UINT64    Offset;
+  ///
+  /// Size in bytes of the chunk data, 0 for EDKII_COMPRESSED_RAM_DISK_CHUNK_ZERO.
+  ///
+  UINT32    Size;
+  ///
+  /// One of the EDKII_COMPRESSED_RAM_DISK_CHUNK_* values.
+  ///
+  UINT32    Type;
+} EDKII_COMPRESSED_RAM_DISK_CHUNK;
+
+#pragma pack()
+
+extern EFI_GUID gEdkiiCompressedRamDiskImageGuid;
+
+#endif
@@ -0,0 +1,124 @@
+/** @file
+  Definitions of the deferred DEBUG() log.
+
+  The log is a header followed by a circular buffer of Size bytes holding
+  variable-length DEFERRED_DEBUG_RECORD structures. It is allocated in
+  reserved memory by the first module that uses DxeDebugLibDeferred and
+  published as an EFI configuration table identified by
+  gEdkiiDeferredDebugLogGuid, so that it can also be read by the OS or by a
+  debugger after boot.
+
+  A record holds the address of the format string, split into the base of
+  the image that contains it and an offset into that image, followed by the
+  arguments in BASE_LIST layout. Arguments that are pointers to data, i.e.
+  strings (%a, %s, %S), GUIDs (%g) and times (%t), are copied into the record
+  after the BASE_LIST arguments; their BASE_LIST slot holds the offset of the
+  copy from the start of the record, or 0 for a NULL pointer. A tool that has
+  the build output of an image can therefore render a record without access
+  to firmware memory, by reading the format string at FormatOffset in the
+  image and parsing the arguments as PrintLib would.
+
+  Writers claim space by atomically advancing Head, and store the record
+  Size last, so a record with a zero Size has not been completed yet. A record
+  that does not fit before the end of the buffer is preceded by a padding
+  record that fills the remainder. Records are rendered and released from
+  Tail; new records are dropped and counted in Dropped if the buffer cannot
+  be drained to make room for them.
+
+  Copyright (c) 2021, EDK II contributors. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef _DEFERRED_DEBUG_LOG_H_
+#define _DEFERRED_DEBUG_LOG_H_
+
+#define EDKII_DEFERRED_DEBUG_LOG_GUID \
+  { \
+    0x7a3e5f0c, 0x2b9d, 0x4c61, { 0x8e, 0x47, 0xd1, 0x96, 0x0a, 0x3b, 0x5c, 0x28 } \
+  }
+
+#define DEFERRED_DEBUG_LOG_SIGNATURE  SIGNATURE_32 ('D', 'D', 'B', 'G')
+#define DEFERRED_DEBUG_LOG_VERSION    1
+
+///
+/// The alignment of records in the log.
+///
+#define DEFERRED_DEBUG_RECORD_ALIGNMENT  8
+
+///
+/// DEFERRED_DEBUG_RECORD.Flags: the record only fills the end of the buffer.
+///
+#define DEFERRED_DEBUG_RECORD_PADDING  BIT0
+
+///
+/// DEFERRED_DEBUG_RECORD.Flags: the pointer-sized BASE_LIST arguments of the
+/// record are 64-bit.
+///
+#define DEFERRED_DEBUG_RECORD_64BIT  BIT1
+
+typedef struct {
+  ///
+  /// The size of the record in bytes, a multiple of
+  /// DEFERRED_DEBUG_RECORD_ALIGNMENT, or 0 if the record is being written.
+  ///
+  volatile UINT16    Size;
+  UINT16             Flags;
+  ///
+  /// The ErrorLevel passed to DEBUG().
+  ///
+  UINT32             ErrorLevel;
+  ///
+  /// The base address of the image the format string belongs to, or 0 if it
+  /// is not known.
+  ///
+  UINT64             ImageBase;
+  ///
+  /// The offset of the format string from ImageBase.
+  ///
+  UINT64             FormatOffset;
+  //
+  // UINT8  Arguments[];
+  //
+} DEFERRED_DEBUG_RECORD;
+
+typedef struct {
+  UINT32             Signature;
+  UINT16             Version;
+  UINT16             Reserved;
+  ///
+  /// The size in bytes of the record buffer following the header, a power of
+  /// two.
+  ///
+  UINT32             Size;
+  ///
+  /// The number of bytes ever claimed by writers. The record at Head modulo
+  /// Size is the next one to be written.
+  ///
+  volatile UINT32    Head;
+  ///
+  /// The number of bytes ever rendered. The records from Tail to Head modulo
+  /// Size have not been rendered yet.
+  ///
+  volatile UINT32    Tail;
+  ///
+  /// The number of records dropped because the buffer was full.
+  ///
+  volatile UINT32    Dropped;
+  ///
+  /// Non-zero while a module is rendering records.
+  ///
+  volatile UINT32    Rendering;
+  UINT32             Reserved2[3];
+} DEFERRED_DEBUG_LOG_HEADER;
+
+///
+/// Return the record at byte count Position in the log Log.
+///
+#define DEFERRED_DEBUG_LOG_RECORD(Log, Position) \
+  ((DEFERRED_DEBUG_RECORD *)((UINT8 *)((DEFERRED_DEBUG_LOG_HEADER *)(Log) + 1) + \
+                             ((Position) & (((DEFERRED_DEBUG_LOG_HEADER *)(Log))->Size - 1))))
+
+extern EFI_GUID  gEdkiiDeferredDebugLogGuid;
+
+#endif
@@ -0,0 +1,51 @@
+/** @file
+  Definitions of the FV file directory.
+
+  The FV file directory is an optional EFI_FV_EXT_TYPE_GUID_TYPE entry of the
+  firmware volume extension header, built by GenFv. It lists the FFS files of
+  the FV, except the pad files, sorted by file name, so that a file can be
+  found by name without walking the whole FV.
+
+  The entries are only 4-byte aligned, so the consumers must use unaligned
+  accesses to read them.
+
+  Copyright (c) 2021, EDK II contributors. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef __EDKII_FV_FILE_DIRECTORY_GUID_H__
+#define __EDKII_FV_FILE_DIRECTORY_GUID_H__
+
+#define EDKII_FV_FILE_DIRECTORY_GUID \
+  { \
+    0x5a6b2c1e, 0x3f47, 0x4d8b, { 0x9e, 0x21, 0x7c, 0x4a, 0xd0, 0x93, 0xb6, 0x58 } \
+  }
+
+#pragma pack(1)
+
+typedef struct {
+  EFI_GUID    Name;     // Name of the FFS file
+  UINT32      Offset;   // Offset of the FFS file header from the start of the FV
+} EDKII_FV_FILE_DIRECTORY_ENTRY;
+
+typedef struct {
+  //
+  // Hdr.ExtEntryType is EFI_FV_EXT_TYPE_GUID_TYPE, and FormatType is
+  // EDKII_FV_FILE_DIRECTORY_GUID.
+  //
+  EFI_FIRMWARE_VOLUME_EXT_ENTRY    Hdr;
+  EFI_GUID                         FormatType;
+  //
+  // Number of the entries that follow, sorted by the byte order of Name,
+  // and then by Offset.
+  //
+  UINT32                           FileCount;
+  // EDKII_FV_FILE_DIRECTORY_ENTRY Entry[FileCount];
+} EDKII_FV_FILE_DIRECTORY;
+
+#pragma pack()
+
+extern EFI_GUID gEdkiiFvFileDirectoryGuid;
+
+#endif // #ifndef __EDKII_FV_FILE_DIRECTORY_GUID_H__
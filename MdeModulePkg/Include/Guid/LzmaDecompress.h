@@ -23,7 +23,35 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #define LZMAF86_CUSTOM_DECOMPRESS_GUID  \
   { 0xD42AE6BD, 0x1352, 0x4bfb, { 0x90, 0x9A, 0xCA, 0x72, 0xA6, 0xEA, 0xE8, 0x89 } }
 
+///
+/// The Global ID used to identify a section of an FFS file of type
+/// EFI_SECTION_GUID_DEFINED, whose contents have been split into blocks that
+/// were compressed independently using LZMA, so that they can be decoded in
+/// any order and on any processor.
+///
+#define LZMA_CHUNKED_CUSTOM_DECOMPRESS_GUID  \
+  { 0x3411FD4E, 0x7E44, 0x4313, { 0xB6, 0x81, 0x40, 0x6C, 0xEF, 0x73, 0x61, 0x9D } }
+
+#define LZMA_CHUNKED_SIGNATURE  SIGNATURE_32 ('L', 'Z', 'C', 'K')
+
+///
+/// Header at the start of the data of an LZMA_CHUNKED_CUSTOM_DECOMPRESS_GUID
+/// section. It is followed by a UINT32 array of BlockCount entries holding the
+/// offset of each compressed block, relative to the start of this header. Each
+/// block is a standard LZMA stream (properties and 64-bit decoded size prefix
+/// included) that extends up to the next block or to the end of the data.
+/// Every block decodes to BlockSize bytes except the last one, which decodes
+/// to the remainder of OriginalSize.
+///
+typedef struct {
+  UINT32    Signature;
+  UINT32    BlockSize;
+  UINT32    BlockCount;
+  UINT32    OriginalSize;
+} LZMA_CHUNKED_HEADER;
+
 extern GUID gLzmaCustomDecompressGuid;
 extern GUID gLzmaF86CustomDecompressGuid;
+extern GUID gLzmaChunkedCustomDecompressGuid;
 
 #endif
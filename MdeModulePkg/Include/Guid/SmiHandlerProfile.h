@@ -42,7 +42,7 @@ typedef struct {
 } SMM_CORE_IMAGE_DATABASE_STRUCTURE;
 
 #define SMM_CORE_SMI_DATABASE_SIGNATURE SIGNATURE_32 ('S','C','S','D')
-#define SMM_CORE_SMI_DATABASE_REVISION  0x0001
+#define SMM_CORE_SMI_DATABASE_REVISION  0x0002
 
 typedef enum {
   SmmCoreSmiHandlerCategoryRootHandler,
@@ -77,15 +77,30 @@ typedef struct {
   UINT64                    SwSmiInputValue;
 } SMI_HANDLER_PROFILE_SW_REGISTER_CONTEXT;
 
+#define SMI_HANDLER_PROFILE_LATENCY_BUCKETS  16
+
+//
+// Run time statistics of a root or GUID SMI handler.
+// Histogram[0] counts the runs shorter than 1us, Histogram[Index] the runs
+// from 2^(Index-1)us to 2^Index us, and the last bucket all the longer runs.
+//
+typedef struct {
+  UINT64                Count;
+  UINT64                TotalTime;   // In nanoseconds
+  UINT64                MaxTime;     // In nanoseconds
+  UINT32                Histogram[SMI_HANDLER_PROFILE_LATENCY_BUCKETS];
+} SMI_HANDLER_PROFILE_LATENCY;
+
 typedef struct {
   UINT32                Length;
   UINT32                ImageRef;
   PHYSICAL_ADDRESS      CallerAddr;
   PHYSICAL_ADDRESS      Handler;
   UINT16                ContextBufferOffset;
-  UINT8                 Reserved[2];
+  UINT16                LatencyOffset;   // Since revision 2, 0 if there is no SMI_HANDLER_PROFILE_LATENCY
   UINT32                ContextBufferSize;
 //UINT8                 ContextBuffer[];
+//SMI_HANDLER_PROFILE_LATENCY Latency;
 } SMM_CORE_SMI_HANDLER_STRUCTURE;
 
 typedef struct {
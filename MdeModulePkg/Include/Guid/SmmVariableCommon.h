@@ -77,6 +77,10 @@ typedef struct {
 // The payload for this function is SMM_VARIABLE_COMMUNICATE_GET_RUNTIME_CACHE_INFO
 //
 #define SMM_VARIABLE_FUNCTION_GET_RUNTIME_CACHE_INFO                14
+//
+// The payload for this function is SMM_VARIABLE_COMMUNICATE_SET_VARIABLE_BATCH.
+//
+#define SMM_VARIABLE_FUNCTION_SET_VARIABLE_BATCH                    15
 
 ///
 /// Size of SMM communicate header, without including the payload.
@@ -99,6 +103,17 @@ typedef struct {
   CHAR16      Name[1];
 } SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE;
 
+///
+/// This structure is used to communicate with SMI handler by SetVariable batches.
+/// Data holds Count SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE records, each one starting
+/// at a UINTN aligned offset from the start of this structure.
+///
+typedef struct {
+  UINTN       Count;
+  UINTN       ProcessedCount;   // Return the number of records set successfully
+  UINT8       Data[1];
+} SMM_VARIABLE_COMMUNICATE_SET_VARIABLE_BATCH;
+
 ///
 /// This structure is used to communicate with SMI handler by GetNextVariableName.
 ///
@@ -0,0 +1,114 @@
+/** @file
+  Definitions of the boot-time trace event ring buffer.
+
+  The buffer is a header, followed by RingCount ring headers, followed by
+  RingCount arrays of RingEntries TRACE_EVENT_RECORD structures. During PEI it
+  is kept in a GUIDed HOB; in DXE it is copied to reserved memory and published
+  as an EFI configuration table, both identified by gEdkiiTraceEventRingGuid.
+
+  Each ring is written without locks: a writer claims a slot by atomically
+  incrementing Head and stores the record at Head modulo RingEntries, so the
+  oldest records are overwritten once a ring is full. Writers pick a ring from
+  the initial local APIC ID of the executing processor, so processors only
+  share a ring when there are more processors than rings.
+
+  Copyright (c) 2021, EDK II contributors. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef _TRACE_EVENT_RING_H_
+#define _TRACE_EVENT_RING_H_
+
+#define EDKII_TRACE_EVENT_RING_GUID \
+  { \
+    0xfe3ccb8b, 0x6ba1, 0x488d, { 0xa4, 0xd0, 0xe5, 0x4e, 0x25, 0x2a, 0x7c, 0xfe } \
+  }
+
+#define TRACE_EVENT_BUFFER_SIGNATURE  SIGNATURE_32 ('T', 'R', 'C', 'E')
+#define TRACE_EVENT_BUFFER_VERSION    1
+
+///
+/// A single trace event.
+///
+typedef struct {
+  ///
+  /// The CPU time-stamp counter on IA32 and X64, or the TimerLib performance
+  /// counter on other architectures, when the event was written.
+  ///
+  UINT64    Timestamp;
+  ///
+  /// The event ID passed to TRACE_EVENT().
+  ///
+  UINT32    Id;
+  ///
+  /// The initial local APIC ID of the processor that wrote the event, or 0 on
+  /// architectures without one.
+  ///
+  UINT32    Cpu;
+  ///
+  /// The two payload words passed to TRACE_EVENT().
+  ///
+  UINT64    Data[2];
+} TRACE_EVENT_RECORD;
+
+///
+/// The per-ring header, padded to a cache line so that processors writing
+/// to different rings do not contend.
+///
+typedef struct {
+  ///
+  /// The number of records ever written to this ring. The valid records are
+  /// the last MIN (Head, RingEntries) ones before Head.
+  ///
+  volatile UINT32    Head;
+  UINT32             Reserved[15];
+} TRACE_EVENT_RING_HEADER;
+
+typedef struct {
+  UINT32    Signature;
+  UINT16    Version;
+  ///
+  /// sizeof (TRACE_EVENT_RECORD).
+  ///
+  UINT16    RecordSize;
+  ///
+  /// The number of rings, a power of two.
+  ///
+  UINT32    RingCount;
+  ///
+  /// The number of records in each ring, a power of two.
+  ///
+  UINT32    RingEntries;
+  ///
+  /// The frequency of TRACE_EVENT_RECORD.Timestamp in Hz, or 0 if it is the
+  /// CPU time-stamp counter and its frequency is not known to firmware.
+  ///
+  UINT64    TimestampFrequency;
+  UINT64    Reserved[5];
+} TRACE_EVENT_BUFFER_HEADER;
+
+///
+/// Return the size in bytes of a trace event buffer.
+///
+#define TRACE_EVENT_BUFFER_SIZE(RingCount, RingEntries) \
+  (sizeof (TRACE_EVENT_BUFFER_HEADER) + \
+   (UINTN)(RingCount) * (sizeof (TRACE_EVENT_RING_HEADER) + \
+                         (UINTN)(RingEntries) * sizeof (TRACE_EVENT_RECORD)))
+
+///
+/// Return the header of ring Ring in the trace event buffer Buffer.
+///
+#define TRACE_EVENT_RING(Buffer, Ring) \
+  ((TRACE_EVENT_RING_HEADER *)((TRACE_EVENT_BUFFER_HEADER *)(Buffer) + 1) + (Ring))
+
+///
+/// Return the first record of ring Ring in the trace event buffer Buffer.
+///
+#define TRACE_EVENT_RING_RECORDS(Buffer, Ring) \
+  ((TRACE_EVENT_RECORD *)TRACE_EVENT_RING (Buffer, ((TRACE_EVENT_BUFFER_HEADER *)(Buffer))->RingCount) + \
+   (UINTN)(Ring) * ((TRACE_EVENT_BUFFER_HEADER *)(Buffer))->RingEntries)
+
+extern EFI_GUID  gEdkiiTraceEventRingGuid;
+
+#endif
@@ -28,6 +28,9 @@ INTN
 /**
   Function to perform a Quick Sort on a buffer of comparable elements.
 
+  The sort runs in O(n log n) in the worst case and does not allocate memory.
+  It is not stable, see PerformMergeSort() for a stable sort.
+
   Each element must be equally sized.
 
   If BufferToSort is NULL, then ASSERT.
@@ -52,6 +55,41 @@ PerformQuickSort (
   IN       SORT_COMPARE         CompareFunction
   );
 
+/**
+  Function to perform a stable Merge Sort on a buffer of comparable elements.
+
+  Elements that compare equal keep their relative order. The caller provides
+  the scratch buffer, no memory is allocated.
+
+  Each element must be equally sized.
+
+  If Count is < 2 , then perform no action.
+  If Size is < 1 , then perform no action.
+
+  @param[in, out] BufferToSort   On call, a Buffer of (possibly sorted) elements;
+                                 on return, a buffer of sorted elements.
+  @param[in]  Count              The number of elements in the buffer to sort.
+  @param[in]  ElementSize        The size of an element in bytes.
+  @param[in]  CompareFunction    The function to call to perform the comparison
+                                 of any two elements.
+  @param[in]  Scratch            A buffer of at least Count * ElementSize bytes.
+  @param[in]  ScratchSize        The size of Scratch in bytes.
+
+  @retval RETURN_SUCCESS            The buffer is sorted.
+  @retval RETURN_INVALID_PARAMETER  BufferToSort, CompareFunction or Scratch is NULL.
+  @retval RETURN_BUFFER_TOO_SMALL   ScratchSize is less than Count * ElementSize.
+**/
+RETURN_STATUS
+EFIAPI
+PerformMergeSort (
+  IN OUT VOID                   *BufferToSort,
+  IN CONST UINTN                Count,
+  IN CONST UINTN                ElementSize,
+  IN       SORT_COMPARE         CompareFunction,
+  IN       VOID                 *Scratch,
+  IN CONST UINTN                ScratchSize
+  );
+
 
 /**
   Function to compare 2 device paths for use as CompareFunction.
@@ -0,0 +1,50 @@
+/** @file
+  Boot-time trace events.
+
+  TRACE_EVENT() stores a fixed-size record with a timestamp, an event ID and
+  two payload words in a per-CPU ring buffer, without taking locks or
+  allocating memory, so that it is cheap enough to stay enabled in release
+  builds. The ring buffer is described in Guid/TraceEventRing.h.
+
+  Copyright (c) 2021, EDK II contributors. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef _TRACE_EVENT_LIB_H_
+#define _TRACE_EVENT_LIB_H_
+
+///
+/// Event IDs from this value upwards are reserved for platform use.
+///
+#define TRACE_EVENT_ID_OEM_BASE  0x80000000
+
+/**
+  Write a trace event.
+
+  The event is dropped if the trace buffer is not available in the current
+  phase.
+
+  @param[in]  Id      The event ID.
+  @param[in]  Data0   The first payload word.
+  @param[in]  Data1   The second payload word.
+**/
+VOID
+EFIAPI
+TraceEventWrite (
+  IN UINT32  Id,
+  IN UINT64  Data0,
+  IN UINT64  Data1
+  );
+
+/**
+  Macro that writes a trace event with two payload words.
+
+  @param  Id      The event ID.
+  @param  Data0   The first payload word.
+  @param  Data1   The second payload word.
+**/
+#define TRACE_EVENT(Id, Data0, Data1) \
+  TraceEventWrite ((UINT32)(Id), (UINT64)(Data0), (UINT64)(Data1))
+
+#endif
@@ -559,6 +559,27 @@ EfiBootManagerConnectAll (
   VOID
   );
 
+/**
+  Connect the default consoles and the devices along the full device path
+  the first boot option in BootOrder was loaded from on the previous boot.
+
+  A platform can call this instead of EfiBootManagerConnectAll() on a fast
+  boot path, and fall back to EfiBootManagerConnectAll() when it fails.
+  After it succeeds, EfiBootManagerBoot() loads a hard drive or file path
+  short-form option from the recorded full device path first. Short-form
+  boot options that cannot be resolved this way still get all the
+  controllers connected when they are booted.
+
+  @retval EFI_SUCCESS            The devices of the previous boot are connected.
+  @retval EFI_NOT_FOUND          No device path was recorded for the first boot
+                                 option, or it can no longer be connected.
+**/
+EFI_STATUS
+EFIAPI
+EfiBootManagerConnectBootHint (
+  VOID
+  );
+
 /**
   This function will create all handles associate with every device
   path node. If the handle associate with one device path node can not
@@ -0,0 +1,71 @@
+/** @file
+  EDK II Block IO Direct Access Protocol.
+
+  A block device whose media is plain memory, such as a RAM disk, may install
+  this protocol next to EFI_BLOCK_IO_PROTOCOL to let consumers read the media
+  through a pointer instead of having it copied into their buffers by
+  ReadBlocks(). Disk IO can then copy a request straight into the caller's
+  buffer whatever its offset and alignment.
+
+  Copyright (c) 2021, EDK II contributors. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef __EDKII_BLOCK_IO_DIRECT_ACCESS_PROTOCOL_H__
+#define __EDKII_BLOCK_IO_DIRECT_ACCESS_PROTOCOL_H__
+
+#define EDKII_BLOCK_IO_DIRECT_ACCESS_PROTOCOL_GUID \
+  { \
+    0xa348d201, 0xed53, 0x4370, { 0xba, 0x9d, 0xfd, 0x0b, 0xe8, 0xa5, 0xdd, 0xa4 } \
+  }
+
+typedef struct _EDKII_BLOCK_IO_DIRECT_ACCESS_PROTOCOL EDKII_BLOCK_IO_DIRECT_ACCESS_PROTOCOL;
+
+#define EDKII_BLOCK_IO_DIRECT_ACCESS_PROTOCOL_REVISION  0x00010000
+
+/**
+  Return the address of the media data starting at a logical block.
+
+  The returned memory must only be read. It stays valid until a write to the
+  device, a media change or the uninstallation of this protocol, so callers
+  must copy what they need before calling any other service.
+
+  @param[in]      This            The EDKII_BLOCK_IO_DIRECT_ACCESS_PROTOCOL
+                                  instance.
+  @param[in]      MediaId         The media ID the request is for.
+  @param[in]      Lba             The starting logical block address.
+  @param[in, out] Length          On input, the number of bytes the caller
+                                  wants to access. On output, the number of
+                                  contiguous bytes available at Address, which
+                                  may be smaller than the input value when the
+                                  request goes past the end of the media.
+  @param[out]     Address         The address of the data at Lba.
+
+  @retval EFI_SUCCESS             Address and Length were returned.
+  @retval EFI_MEDIA_CHANGED       The MediaId is not for the current media.
+  @retval EFI_NO_MEDIA            There is no media in the device.
+  @retval EFI_INVALID_PARAMETER   Lba is past the end of the media, or Length
+                                  or Address is NULL.
+  @retval EFI_UNSUPPORTED         The media cannot be accessed directly at the
+                                  moment; use EFI_BLOCK_IO_PROTOCOL instead.
+
+**/
+typedef
+EFI_STATUS
+(EFIAPI *EDKII_BLOCK_IO_DIRECT_ACCESS_MAP)(
+  IN     EDKII_BLOCK_IO_DIRECT_ACCESS_PROTOCOL  *This,
+  IN     UINT32                                 MediaId,
+  IN     EFI_LBA                                Lba,
+  IN OUT UINTN                                  *Length,
+  OUT    CONST VOID                             **Address
+  );
+
+struct _EDKII_BLOCK_IO_DIRECT_ACCESS_PROTOCOL {
+  UINT64                            Revision;
+  EDKII_BLOCK_IO_DIRECT_ACCESS_MAP  Map;
+};
+
+extern EFI_GUID gEdkiiBlockIoDirectAccessProtocolGuid;
+
+#endif
@@ -0,0 +1,72 @@
+/** @file
+  EDK II File Bulk Read Protocol.
+
+  A file system driver may install this protocol on the handle of its
+  EFI_SIMPLE_FILE_SYSTEM_PROTOCOL instance to let callers read a whole file
+  into their own memory in one call. The driver can then hand the extents
+  of the file to the block layer directly, without splitting the transfer
+  into EFI_FILE_PROTOCOL.Read() chunks or copying it through intermediate
+  buffers.
+
+  Copyright (c) 2021, EDK II contributors. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef __EDKII_FILE_BULK_READ_PROTOCOL_H__
+#define __EDKII_FILE_BULK_READ_PROTOCOL_H__
+
+#include <Protocol/SimpleFileSystem.h>
+
+#define EDKII_FILE_BULK_READ_PROTOCOL_GUID \
+  { \
+    0x4c5e3e63, 0x5195, 0x4e27, { 0xaf, 0x44, 0xee, 0x8c, 0x77, 0x24, 0xc2, 0xdb } \
+  }
+
+typedef struct _EDKII_FILE_BULK_READ_PROTOCOL EDKII_FILE_BULK_READ_PROTOCOL;
+
+#define EDKII_FILE_BULK_READ_PROTOCOL_REVISION  0x00010000
+
+/**
+  Read the whole contents of an open file into a caller provided buffer.
+
+  The file position of File is not changed. Buffer should be page aligned, so
+  that the block layer can transfer into it without bounce buffers; other
+  buffers are accepted but may be slower.
+
+  @param[in]      This            The EDKII_FILE_BULK_READ_PROTOCOL instance.
+  @param[in]      File            A file opened on the file system this
+                                  protocol instance belongs to.
+  @param[in, out] BufferSize      On input, the size of Buffer. On output, the
+                                  number of bytes read, or the size of the file
+                                  if Buffer is too small.
+  @param[out]     Buffer          The buffer receiving the file contents.
+
+  @retval EFI_SUCCESS             The file was read.
+  @retval EFI_BUFFER_TOO_SMALL    Buffer is smaller than the file. BufferSize
+                                  is updated with the size of the file.
+  @retval EFI_INVALID_PARAMETER   File is not a file of this file system, or is
+                                  a directory.
+  @retval EFI_INVALID_PARAMETER   BufferSize is NULL, or Buffer is NULL and
+                                  *BufferSize is not zero.
+  @retval EFI_DEVICE_ERROR        The device reported an error.
+  @retval EFI_MEDIA_CHANGED       The media has changed.
+
+**/
+typedef
+EFI_STATUS
+(EFIAPI *EDKII_FILE_BULK_READ_READ_FILE)(
+  IN     EDKII_FILE_BULK_READ_PROTOCOL  *This,
+  IN     EFI_FILE_PROTOCOL              *File,
+  IN OUT UINTN                          *BufferSize,
+  OUT    VOID                           *Buffer
+  );
+
+struct _EDKII_FILE_BULK_READ_PROTOCOL {
+  UINT64                          Revision;
+  EDKII_FILE_BULK_READ_READ_FILE  ReadFile;
+};
+
+extern EFI_GUID gEdkiiFileBulkReadProtocolGuid;
+
+#endif
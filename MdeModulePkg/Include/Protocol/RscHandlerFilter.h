@@ -0,0 +1,65 @@
+/** @file
+  EDK II Report Status Code Handler Filter Protocol.
+
+  A report status code router may install this protocol next to
+  EFI_RSC_HANDLER_PROTOCOL to let a registered handler restrict the status
+  code types it is called for, so that a slow handler is not invoked for
+  every status code only to discard most of them.
+
+  Copyright (c) 2021, EDK II contributors. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef __EDKII_RSC_HANDLER_FILTER_PROTOCOL_H__
+#define __EDKII_RSC_HANDLER_FILTER_PROTOCOL_H__
+
+#include <Protocol/ReportStatusCodeHandler.h>
+
+#define EDKII_RSC_HANDLER_FILTER_PROTOCOL_GUID \
+  { \
+    0xfa268e88, 0x4863, 0x4b2e, { 0xac, 0x9a, 0x62, 0x44, 0x2d, 0xa3, 0x73, 0x38 } \
+  }
+
+typedef struct _EDKII_RSC_HANDLER_FILTER_PROTOCOL EDKII_RSC_HANDLER_FILTER_PROTOCOL;
+
+///
+/// Return the code type mask bit of a status code type. Code types that do
+/// not fit in the mask are always reported.
+///
+#define EDKII_RSC_CODE_TYPE_BIT(CodeType) \
+  ((UINT32)(((CodeType) & EFI_STATUS_CODE_TYPE_MASK) < 32 ? \
+            (1U << ((CodeType) & EFI_STATUS_CODE_TYPE_MASK)) : 0))
+
+///
+/// A code type mask that reports every status code.
+///
+#define EDKII_RSC_CODE_TYPE_ALL  MAX_UINT32
+
+/**
+  Restrict the status code types a registered handler is called for.
+
+  @param[in]  Callback      A handler registered with
+                            EFI_RSC_HANDLER_PROTOCOL.Register().
+  @param[in]  CodeTypeMask  A set of EDKII_RSC_CODE_TYPE_BIT() bits; the
+                            handler is only called for status codes whose
+                            type bit is set, or whose type has no bit.
+
+  @retval EFI_SUCCESS             The filter was set.
+  @retval EFI_INVALID_PARAMETER   Callback is NULL.
+  @retval EFI_NOT_FOUND           Callback is not registered.
+**/
+typedef
+EFI_STATUS
+(EFIAPI *EDKII_RSC_HANDLER_SET_FILTER)(
+  IN EFI_RSC_HANDLER_CALLBACK  Callback,
+  IN UINT32                    CodeTypeMask
+  );
+
+struct _EDKII_RSC_HANDLER_FILTER_PROTOCOL {
+  EDKII_RSC_HANDLER_SET_FILTER    SetFilter;
+};
+
+extern EFI_GUID  gEdkiiRscHandlerFilterProtocolGuid;
+
+#endif
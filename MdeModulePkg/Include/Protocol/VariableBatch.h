@@ -0,0 +1,73 @@
+/** @file
+  Variable Batch Protocol is related to EDK II-specific implementation of variables
+  and intended for use as a means to set or delete many variables with as few
+  transitions into the variable driver as possible, e.g. through one SMI for all
+  of them when the variable driver runs in SMM.
+
+  Copyright (c) 2021, EDK II contributors. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef __VARIABLE_BATCH_H__
+#define __VARIABLE_BATCH_H__
+
+#define EDKII_VARIABLE_BATCH_PROTOCOL_GUID \
+  { \
+    0x423c27ff, 0x0a78, 0x4616, { 0x87, 0x17, 0xd7, 0xbf, 0x19, 0x8b, 0x1b, 0x04 } \
+  }
+
+typedef struct _EDKII_VARIABLE_BATCH_PROTOCOL  EDKII_VARIABLE_BATCH_PROTOCOL;
+
+///
+/// One SetVariable () request of a batch. The fields have the meaning of the parameters
+/// of the SetVariable () runtime service.
+///
+typedef struct {
+  CHAR16      *VariableName;
+  EFI_GUID    *VendorGuid;
+  UINT32      Attributes;
+  UINTN       DataSize;
+  VOID        *Data;
+} EDKII_VARIABLE_BATCH_ENTRY;
+
+/**
+  Set or delete a batch of variables.
+
+  The entries are applied in order, exactly as if SetVariable () was called for each
+  of them, and the batch stops at the first entry that fails. The batch is not atomic:
+  the entries before the failing one stay applied, ProcessedCount tells how many.
+
+  @param[in]  This            The EDKII_VARIABLE_BATCH_PROTOCOL instance.
+  @param[in]  Count           Number of entries in Entries.
+  @param[in]  Entries         The SetVariable () requests to apply.
+  @param[out] ProcessedCount  Optional, returns the number of entries applied successfully.
+
+  @retval EFI_SUCCESS            All entries were applied.
+  @retval EFI_INVALID_PARAMETER  Entries is NULL while Count is not 0, or an entry has
+                                 parameters SetVariable () rejects or does not fit in the
+                                 communication buffer of the variable driver. No entry
+                                 was applied.
+  @retval Others                 The status SetVariable () returned for the first entry
+                                 that failed.
+**/
+typedef
+EFI_STATUS
+(EFIAPI * EDKII_VARIABLE_BATCH_PROTOCOL_SET_VARIABLES) (
+  IN CONST EDKII_VARIABLE_BATCH_PROTOCOL  *This,
+  IN       UINTN                          Count,
+  IN       EDKII_VARIABLE_BATCH_ENTRY     *Entries,
+  OUT      UINTN                          *ProcessedCount OPTIONAL
+  );
+
+///
+/// Variable Batch Protocol is related to EDK II-specific implementation of variables
+/// and intended for use as a means to set or delete many variables at once.
+///
+struct _EDKII_VARIABLE_BATCH_PROTOCOL {
+  EDKII_VARIABLE_BATCH_PROTOCOL_SET_VARIABLES  SetVariables;
+};
+
+extern EFI_GUID gEdkiiVariableBatchProtocolGuid;
+
+#endif
@@ -644,10 +644,11 @@ SerialPortWrite (
   Result = NumberOfBytes;
   while (NumberOfBytes != 0) {
     //
-    // Wait for the serial port to be ready, to make sure both the transmit FIFO
-    // and shift register empty.
+    // Wait for the transmit FIFO to be empty. The shift register may still be
+    // sending the last byte of the previous burst; it is not waited for, so
+    // that the line does not go idle between two bursts.
     //
-    while ((SerialPortReadRegister (SerialRegisterBase, R_UART_LSR) & (B_UART_LSR_TEMT | B_UART_LSR_TXRDY)) != (B_UART_LSR_TEMT | B_UART_LSR_TXRDY));
+    while ((SerialPortReadRegister (SerialRegisterBase, R_UART_LSR) & B_UART_LSR_TXRDY) == 0);
 
     //
     // Fill then entire Tx FIFO
@@ -10,120 +10,220 @@
 #include <Library/BaseLib.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/DebugLib.h>
-#include <Library/MemoryAllocationLib.h>
 #include <Library/SortLib.h>
 
+//
+// Partitions of at most this many elements are finished with an insertion sort.
+//
+#define SORT_INSERTION_THRESHOLD  16
+
 /**
-  Worker function for QuickSorting.  This function is identical to PerformQuickSort,
-  except that is uses the pre-allocated buffer so the in place sorting does not need to
-  allocate and free buffers constantly.
+  Swap two elements in place, without a temporary element-sized buffer.
 
-  Each element must be equal sized.
+  @param[in, out] Element1       The pointer to the first element.
+  @param[in, out] Element2       The pointer to the second element.
+  @param[in]      ElementSize    Size of an element in bytes.
+**/
+STATIC
+VOID
+SortSwap (
+  IN OUT UINT8                          *Element1,
+  IN OUT UINT8                          *Element2,
+  IN     UINTN                          ElementSize
+  )
+{
+  UINT8       Chunk[32];
+  UINTN       Length;
 
-  if BufferToSort is NULL, then ASSERT.
-  if CompareFunction is NULL, then ASSERT.
-  if Buffer is NULL, then ASSERT.
+  if (Element1 == Element2) {
+    return;
+  }
 
-  if Count is < 2 then perform no action.
-  if Size is < 1 then perform no action.
+  while (ElementSize > 0) {
+    Length = MIN (ElementSize, sizeof (Chunk));
+    CopyMem (Chunk, Element1, Length);
+    CopyMem (Element1, Element2, Length);
+    CopyMem (Element2, Chunk, Length);
+    Element1    += Length;
+    Element2    += Length;
+    ElementSize -= Length;
+  }
+}
 
-  @param[in, out] BufferToSort   on call a Buffer of (possibly sorted) elements
-                                 on return a buffer of sorted elements
-  @param[in] Count               the number of elements in the buffer to sort
-  @param[in] ElementSize         Size of an element in bytes
+/**
+  Stable insertion sort, used for short runs.
+
+  @param[in, out] BufferToSort   On call a Buffer of (possibly sorted) elements;
+                                 on return a buffer of sorted elements.
+  @param[in] Count               The number of elements in the buffer to sort.
+  @param[in] ElementSize         Size of an element in bytes.
   @param[in] CompareFunction     The function to call to perform the comparison
-                                 of any 2 elements
-  @param[in] Buffer              Buffer of size ElementSize for use in swapping
+                                 of any 2 elements.
 **/
+STATIC
 VOID
-EFIAPI
-QuickSortWorker (
-  IN OUT VOID                           *BufferToSort,
-  IN CONST UINTN                        Count,
-  IN CONST UINTN                        ElementSize,
-  IN       SORT_COMPARE                 CompareFunction,
-  IN VOID                               *Buffer
+InsertionSortWorker (
+  IN OUT UINT8                          *BufferToSort,
+  IN     UINTN                          Count,
+  IN     UINTN                          ElementSize,
+  IN     SORT_COMPARE                   CompareFunction
   )
 {
-  VOID        *Pivot;
-  UINTN       LoopCount;
-  UINTN       NextSwapLocation;
-
-  ASSERT(BufferToSort     != NULL);
-  ASSERT(CompareFunction  != NULL);
-  ASSERT(Buffer  != NULL);
-
-  if ( Count < 2
-    || ElementSize  < 1
-   ){
-    return;
+  UINTN       Index;
+  UINT8       *Element;
+
+  for (Index = 1; Index < Count; Index++) {
+    for (Element = BufferToSort + Index * ElementSize;
+         Element > BufferToSort && CompareFunction (Element - ElementSize, Element) > 0;
+         Element -= ElementSize) {
+      SortSwap (Element - ElementSize, Element, ElementSize);
+    }
   }
+}
 
-  NextSwapLocation = 0;
+/**
+  Heap sort, used when the quick sort recursion gets too deep.
 
-  //
-  // pick a pivot (we choose last element)
-  //
-  Pivot = ((UINT8*)BufferToSort+((Count-1)*ElementSize));
+  @param[in, out] BufferToSort   On call a Buffer of (possibly sorted) elements;
+                                 on return a buffer of sorted elements.
+  @param[in] Count               The number of elements in the buffer to sort.
+  @param[in] ElementSize         Size of an element in bytes.
+  @param[in] CompareFunction     The function to call to perform the comparison
+                                 of any 2 elements.
+**/
+STATIC
+VOID
+HeapSortWorker (
+  IN OUT UINT8                          *BufferToSort,
+  IN     UINTN                          Count,
+  IN     UINTN                          ElementSize,
+  IN     SORT_COMPARE                   CompareFunction
+  )
+{
+  UINTN       Start;
+  UINTN       End;
+  UINTN       Root;
+  UINTN       Child;
 
   //
-  // Now get the pivot such that all on "left" are below it
-  // and everything "right" are above it
+  // Build a max-heap, then move its root behind the shrinking heap.
   //
-  for ( LoopCount = 0
-      ; LoopCount < Count -1
-      ; LoopCount++
-     ){
+  for (Start = Count / 2, End = Count; End > 1; ) {
+    if (Start > 0) {
+      Start--;
+    } else {
+      End--;
+      SortSwap (BufferToSort, BufferToSort + End * ElementSize, ElementSize);
+    }
+
+    for (Root = Start; (Child = 2 * Root + 1) < End; Root = Child) {
+      if ((Child + 1 < End) &&
+          (CompareFunction (BufferToSort + Child * ElementSize, BufferToSort + (Child + 1) * ElementSize) < 0)) {
+        Child++;
+      }
+      if (CompareFunction (BufferToSort + Root * ElementSize, BufferToSort + Child * ElementSize) >= 0) {
+        break;
+      }
+      SortSwap (BufferToSort + Root * ElementSize, BufferToSort + Child * ElementSize, ElementSize);
+    }
+  }
+}
+
+/**
+  Introsort worker: quick sort with a median-of-three pivot, falling back to
+  heap sort past DepthLimit levels and to insertion sort for short partitions.
+
+  @param[in, out] BufferToSort   On call a Buffer of (possibly sorted) elements;
+                                 on return a buffer of sorted elements.
+  @param[in] Count               The number of elements in the buffer to sort.
+  @param[in] ElementSize         Size of an element in bytes.
+  @param[in] CompareFunction     The function to call to perform the comparison
+                                 of any 2 elements.
+  @param[in] DepthLimit          The number of partitioning levels left.
+**/
+STATIC
+VOID
+IntroSortWorker (
+  IN OUT UINT8                          *BufferToSort,
+  IN     UINTN                          Count,
+  IN     UINTN                          ElementSize,
+  IN     SORT_COMPARE                   CompareFunction,
+  IN     UINTN                          DepthLimit
+  )
+{
+  UINT8       *Middle;
+  UINT8       *Last;
+  UINTN       Left;
+  UINTN       Right;
+
+  while (Count > SORT_INSERTION_THRESHOLD) {
+    if (DepthLimit == 0) {
+      HeapSortWorker (BufferToSort, Count, ElementSize, CompareFunction);
+      return;
+    }
+    DepthLimit--;
+
     //
-    // if the element is less than the pivot
+    // Order the first, middle and last elements, then move the median to the
+    // front where it stays while partitioning. The last element is then no
+    // less than the pivot and stops the left scan.
     //
-    if (CompareFunction((VOID*)((UINT8*)BufferToSort+((LoopCount)*ElementSize)),Pivot) <= 0){
-      //
-      // swap
-      //
-      CopyMem (Buffer, (UINT8*)BufferToSort+(NextSwapLocation*ElementSize), ElementSize);
-      CopyMem ((UINT8*)BufferToSort+(NextSwapLocation*ElementSize), (UINT8*)BufferToSort+((LoopCount)*ElementSize), ElementSize);
-      CopyMem ((UINT8*)BufferToSort+((LoopCount)*ElementSize), Buffer, ElementSize);
-
-      //
-      // increment NextSwapLocation
-      //
-      NextSwapLocation++;
+    Middle = BufferToSort + (Count / 2) * ElementSize;
+    Last   = BufferToSort + (Count - 1) * ElementSize;
+    if (CompareFunction (Middle, BufferToSort) < 0) {
+      SortSwap (Middle, BufferToSort, ElementSize);
     }
-  }
-  //
-  // swap pivot to it's final position (NextSwapLocaiton)
-  //
-  CopyMem (Buffer, Pivot, ElementSize);
-  CopyMem (Pivot, (UINT8*)BufferToSort+(NextSwapLocation*ElementSize), ElementSize);
-  CopyMem ((UINT8*)BufferToSort+(NextSwapLocation*ElementSize), Buffer, ElementSize);
+    if (CompareFunction (Last, Middle) < 0) {
+      SortSwap (Last, Middle, ElementSize);
+      if (CompareFunction (Middle, BufferToSort) < 0) {
+        SortSwap (Middle, BufferToSort, ElementSize);
+      }
+    }
+    SortSwap (BufferToSort, Middle, ElementSize);
 
-  //
-  // Now recurse on 2 paritial lists.  neither of these will have the 'pivot' element
-  // IE list is sorted left half, pivot element, sorted right half...
-  //
-  if (NextSwapLocation >= 2) {
-    QuickSortWorker(
-      BufferToSort,
-      NextSwapLocation,
-      ElementSize,
-      CompareFunction,
-      Buffer);
-  }
+    //
+    // Hoare partition around the front element. Both scans stop on elements
+    // equal to the pivot so runs of equal keys split evenly.
+    //
+    Left  = 0;
+    Right = Count;
+    while (TRUE) {
+      do {
+        Left++;
+      } while (CompareFunction (BufferToSort + Left * ElementSize, BufferToSort) < 0);
+      do {
+        Right--;
+      } while (CompareFunction (BufferToSort + Right * ElementSize, BufferToSort) > 0);
+      if (Left >= Right) {
+        break;
+      }
+      SortSwap (BufferToSort + Left * ElementSize, BufferToSort + Right * ElementSize, ElementSize);
+    }
+    SortSwap (BufferToSort, BufferToSort + Right * ElementSize, ElementSize);
 
-  if ((Count - NextSwapLocation - 1) >= 2) {
-    QuickSortWorker(
-      (UINT8 *)BufferToSort + (NextSwapLocation+1) * ElementSize,
-      Count - NextSwapLocation - 1,
-      ElementSize,
-      CompareFunction,
-      Buffer);
+    //
+    // Recurse into the smaller side and loop on the larger one, which bounds
+    // the stack depth to log2 (Count).
+    //
+    if (Right < Count - Right - 1) {
+      IntroSortWorker (BufferToSort, Right, ElementSize, CompareFunction, DepthLimit);
+      BufferToSort += (Right + 1) * ElementSize;
+      Count        -= Right + 1;
+    } else {
+      IntroSortWorker (BufferToSort + (Right + 1) * ElementSize, Count - Right - 1, ElementSize, CompareFunction, DepthLimit);
+      Count = Right;
+    }
   }
-  return;
+
+  InsertionSortWorker (BufferToSort, Count, ElementSize, CompareFunction);
 }
+
 /**
   Function to perform a Quick Sort alogrithm on a buffer of comparable elements.
 
+  The sort is an introsort: O(n log n) in the worst case, including already
+  sorted input, and it does not allocate memory. It is not stable.
+
   Each element must be equal sized.
 
   if BufferToSort is NULL, then ASSERT.
@@ -148,23 +248,169 @@ PerformQuickSort (
   IN       SORT_COMPARE                 CompareFunction
   )
 {
-  VOID  *Buffer;
-
   ASSERT(BufferToSort     != NULL);
   ASSERT(CompareFunction  != NULL);
 
-  Buffer = AllocateZeroPool(ElementSize);
-  ASSERT(Buffer != NULL);
+  if ( Count < 2
+    || ElementSize  < 1
+   ){
+    return;
+  }
 
-  QuickSortWorker(
+  IntroSortWorker (
     BufferToSort,
     Count,
     ElementSize,
     CompareFunction,
-    Buffer);
+    2 * (UINTN)HighBitSet64 (Count)
+    );
+}
+
+/**
+  Merge two adjacent sorted runs from Source into Destination, taking from the
+  left run on ties.
+
+  @param[in]  Source             The buffer holding both runs.
+  @param[out] Destination        The buffer receiving the merged run, at the
+                                 same offset as the runs in Source.
+  @param[in]  LeftCount          The number of elements in the left run.
+  @param[in]  RightCount         The number of elements in the right run.
+  @param[in]  ElementSize        Size of an element in bytes.
+  @param[in]  CompareFunction    The function to call to perform the comparison
+                                 of any 2 elements.
+**/
+STATIC
+VOID
+MergeRuns (
+  IN     CONST UINT8                    *Source,
+     OUT UINT8                          *Destination,
+  IN     UINTN                          LeftCount,
+  IN     UINTN                          RightCount,
+  IN     UINTN                          ElementSize,
+  IN     SORT_COMPARE                   CompareFunction
+  )
+{
+  CONST UINT8 *Left;
+  CONST UINT8 *LeftEnd;
+  CONST UINT8 *Right;
+  CONST UINT8 *RightEnd;
+
+  Left     = Source;
+  LeftEnd  = Source + LeftCount * ElementSize;
+  Right    = LeftEnd;
+  RightEnd = Right + RightCount * ElementSize;
+
+  while (Left < LeftEnd && Right < RightEnd) {
+    if (CompareFunction (Left, Right) <= 0) {
+      CopyMem (Destination, Left, ElementSize);
+      Left += ElementSize;
+    } else {
+      CopyMem (Destination, Right, ElementSize);
+      Right += ElementSize;
+    }
+    Destination += ElementSize;
+  }
+  CopyMem (Destination, Left, LeftEnd - Left);
+  Destination += LeftEnd - Left;
+  CopyMem (Destination, Right, RightEnd - Right);
+}
+
+/**
+  Function to perform a stable Merge Sort on a buffer of comparable elements.
+
+  Elements that compare equal keep their relative order. The sort runs bottom-up
+  in O(n log n) and uses the caller's scratch buffer instead of allocating memory.
+
+  Each element must be equal sized.
+
+  @param[in, out] BufferToSort   On call a Buffer of (possibly sorted) elements;
+                                 on return a buffer of sorted elements.
+  @param[in] Count               The number of elements in the buffer to sort.
+  @param[in] ElementSize         Size of an element in bytes.
+  @param[in] CompareFunction     The function to call to perform the comparison
+                                 of any 2 elements.
+  @param[in] Scratch             A buffer of at least Count * ElementSize bytes.
+                                 Its content on return is undefined.
+  @param[in] ScratchSize         The size of Scratch in bytes.
+
+  @retval RETURN_SUCCESS            The buffer is sorted, or Count < 2 or
+                                    ElementSize < 1 and nothing was done.
+  @retval RETURN_INVALID_PARAMETER  BufferToSort, CompareFunction or Scratch
+                                    is NULL.
+  @retval RETURN_BUFFER_TOO_SMALL   ScratchSize is less than Count * ElementSize.
+                                    The buffer is left unchanged.
+**/
+RETURN_STATUS
+EFIAPI
+PerformMergeSort (
+  IN OUT VOID                           *BufferToSort,
+  IN CONST UINTN                        Count,
+  IN CONST UINTN                        ElementSize,
+  IN       SORT_COMPARE                 CompareFunction,
+  IN       VOID                         *Scratch,
+  IN CONST UINTN                        ScratchSize
+  )
+{
+  UINT8       *Source;
+  UINT8       *Destination;
+  UINT8       *Swap;
+  UINTN       Width;
+  UINTN       Start;
+  UINTN       LeftCount;
+  UINTN       RightCount;
+
+  if (BufferToSort == NULL || CompareFunction == NULL || Scratch == NULL) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  if ( Count < 2
+    || ElementSize  < 1
+   ){
+    return RETURN_SUCCESS;
+  }
+
+  if (Count > ScratchSize / ElementSize) {
+    return RETURN_BUFFER_TOO_SMALL;
+  }
+
+  //
+  // Sort short runs in place, then merge runs of doubling width back and
+  // forth between the buffer and the scratch area.
+  //
+  for (Start = 0; Start < Count; Start += SORT_INSERTION_THRESHOLD) {
+    InsertionSortWorker (
+      (UINT8 *)BufferToSort + Start * ElementSize,
+      MIN (SORT_INSERTION_THRESHOLD, Count - Start),
+      ElementSize,
+      CompareFunction
+      );
+  }
+
+  Source      = BufferToSort;
+  Destination = Scratch;
+  for (Width = SORT_INSERTION_THRESHOLD; Width < Count; Width *= 2) {
+    for (Start = 0; Start < Count; Start += 2 * Width) {
+      LeftCount  = MIN (Width, Count - Start);
+      RightCount = MIN (Width, Count - Start - LeftCount);
+      MergeRuns (
+        Source + Start * ElementSize,
+        Destination + Start * ElementSize,
+        LeftCount,
+        RightCount,
+        ElementSize,
+        CompareFunction
+        );
+    }
+    Swap        = Source;
+    Source      = Destination;
+    Destination = Swap;
+  }
+
+  if (Source != BufferToSort) {
+    CopyMem (BufferToSort, Source, Count * ElementSize);
+  }
 
-  FreePool(Buffer);
-  return;
+  return RETURN_SUCCESS;
 }
 
 /**
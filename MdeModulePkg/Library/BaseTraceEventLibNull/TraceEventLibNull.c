@@ -0,0 +1,31 @@
+/** @file
+  Null instance of the trace event library.
+
+  Copyright (c) 2021, EDK II contributors. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Base.h>
+
+#include <Library/TraceEventLib.h>
+
+/**
+  Write a trace event.
+
+  The event is dropped if the trace buffer is not available in the current
+  phase.
+
+  @param[in]  Id      The event ID.
+  @param[in]  Data0   The first payload word.
+  @param[in]  Data1   The second payload word.
+**/
+VOID
+EFIAPI
+TraceEventWrite (
+  IN UINT32  Id,
+  IN UINT64  Data0,
+  IN UINT64  Data1
+  )
+{
+}
@@ -867,11 +867,12 @@ EXIT:
 
 /**
   This routine is called to get all qualified image from file from an given directory
-  in alphabetic order. All the file image is copied to allocated boottime memory.
-  Caller should free these memory
+  in alphabetic order. If ReadImage is TRUE, all the file image is copied to allocated
+  boottime memory. Caller should free these memory
 
   @param[in]  Dir            Directory file handler
   @param[in]  FileAttr       Attribute of file to be red from directory
+  @param[in]  ReadImage      Whether to read the file images into memory
   @param[out] FilePtr        File images Info buffer red from directory
   @param[out] FileNum        File images number red from directory
 
@@ -882,6 +883,7 @@ EFI_STATUS
 GetFileImageInAlphabetFromDir(
   IN EFI_FILE_HANDLE   Dir,
   IN UINT64            FileAttr,
+  IN BOOLEAN           ReadImage,
   OUT IMAGE_INFO       **FilePtr,
   OUT UINTN            *FileNum
   )
@@ -938,6 +940,15 @@ GetFileImageInAlphabetFromDir(
     FileInfoEntry = CR (Link, FILE_INFO_ENTRY, Link, FILE_INFO_SIGNATURE);
     FileInfo      = FileInfoEntry->FileInfo;
 
+    if (!ReadImage) {
+      //
+      // Caller streams the file content itself
+      //
+      TempFilePtrBuf[FileCount].FileInfo = FileInfo;
+      FileCount++;
+      continue;
+    }
+
     Status = Dir->Open(
                     Dir,
                     &FileHandle,
@@ -1105,11 +1116,58 @@ EXIT:
 }
 
 /**
-  This routine is called to get all caspules from file. The capsule file image is
-  copied to BS memory. Caller is responsible to free them.
+  Open the capsule directory on the given file system.
+
+  @param[in]  FsHandle             File system handle
+  @param[out] FileDir              Handle of the opened capsule directory
+
+  @retval EFI_SUCCESS  Succeed to open the capsule directory.
+
+**/
+EFI_STATUS
+OpenCapsuleDirectory (
+  IN  EFI_HANDLE                       FsHandle,
+  OUT EFI_FILE_HANDLE                  *FileDir
+  )
+{
+  EFI_STATUS                       Status;
+  EFI_SIMPLE_FILE_SYSTEM_PROTOCOL  *Fs;
+  EFI_FILE_HANDLE                  RootDir;
+
+  Status = gBS->HandleProtocol(FsHandle, &gEfiSimpleFileSystemProtocolGuid, (VOID **)&Fs);
+  if (EFI_ERROR(Status)) {
+    return Status;
+  }
+
+  Status = Fs->OpenVolume(Fs, &RootDir);
+  if (EFI_ERROR(Status)) {
+    return Status;
+  }
+
+  Status = RootDir->Open(
+                      RootDir,
+                      FileDir,
+                      EFI_CAPSULE_FILE_DIRECTORY,
+                      EFI_FILE_MODE_READ,
+                      0
+                      );
+  if (EFI_ERROR(Status)) {
+    DEBUG((DEBUG_ERROR, "CodLibGetAllCapsuleOnDisk fail to open RootDir!\n"));
+  }
+  RootDir->Close (RootDir);
+
+  return Status;
+}
+
+/**
+  This routine is called to get all caspules from file. If ReadImage is TRUE, the capsule
+  file image is copied to BS memory and the capsule files are removed. Caller is responsible
+  to free them. If ReadImage is FALSE, only the file infos are returned and the caller is
+  responsible to remove the capsule files once it has consumed them.
 
   @param[in]    MaxRetry             Max Connection Retry. Stall 100ms between each connection try to ensure
                                      devices like USB can get enumerated.
+  @param[in]    ReadImage            Whether to read the capsule file images into memory
   @param[out]   CapsulePtr           Copied Capsule file Image Info buffer
   @param[out]   CapsuleNum           CapsuleNumber
   @param[out]   FsHandle             File system handle
@@ -1121,6 +1179,7 @@ EXIT:
 EFI_STATUS
 GetAllCapsuleOnDisk(
   IN  UINTN                            MaxRetry,
+  IN  BOOLEAN                          ReadImage,
   OUT IMAGE_INFO                       **CapsulePtr,
   OUT UINTN                            *CapsuleNum,
   OUT EFI_HANDLE                       *FsHandle,
@@ -1128,8 +1187,6 @@ GetAllCapsuleOnDisk(
   )
 {
   EFI_STATUS                       Status;
-  EFI_SIMPLE_FILE_SYSTEM_PROTOCOL  *Fs;
-  EFI_FILE_HANDLE                  RootDir;
   EFI_FILE_HANDLE                  FileDir;
   UINT16                           *TempOptionNumber;
 
@@ -1141,30 +1198,11 @@ GetAllCapsuleOnDisk(
     return Status;
   }
 
-  Status = gBS->HandleProtocol(*FsHandle, &gEfiSimpleFileSystemProtocolGuid, (VOID **)&Fs);
-  if (EFI_ERROR(Status)) {
-    return Status;
-  }
-
-  Status = Fs->OpenVolume(Fs, &RootDir);
+  Status = OpenCapsuleDirectory (*FsHandle, &FileDir);
   if (EFI_ERROR(Status)) {
     return Status;
   }
 
-  Status = RootDir->Open(
-                      RootDir,
-                      &FileDir,
-                      EFI_CAPSULE_FILE_DIRECTORY,
-                      EFI_FILE_MODE_READ,
-                      0
-                      );
-  if (EFI_ERROR(Status)) {
-    DEBUG((DEBUG_ERROR, "CodLibGetAllCapsuleOnDisk fail to open RootDir!\n"));
-    RootDir->Close (RootDir);
-    return Status;
-  }
-  RootDir->Close (RootDir);
-
   //
   // Only Load files with EFI_FILE_SYSTEM or EFI_FILE_ARCHIVE attribute
   // ignore EFI_FILE_READ_ONLY, EFI_FILE_HIDDEN, EFI_FILE_RESERVED, EFI_FILE_DIRECTORY
@@ -1172,16 +1210,19 @@ GetAllCapsuleOnDisk(
   Status = GetFileImageInAlphabetFromDir(
              FileDir,
              EFI_FILE_SYSTEM | EFI_FILE_ARCHIVE,
+             ReadImage,
              CapsulePtr,
              CapsuleNum
              );
   DEBUG((DEBUG_INFO, "GetFileImageInAlphabetFromDir status %x\n", Status));
 
-  //
-  // Always remove file to avoid deadloop in capsule process
-  //
-  Status = RemoveFileFromDir(FileDir, EFI_FILE_SYSTEM | EFI_FILE_ARCHIVE);
-  DEBUG((DEBUG_INFO, "RemoveFileFromDir status %x\n", Status));
+  if (ReadImage || EFI_ERROR(Status) || *CapsuleNum == 0) {
+    //
+    // Always remove file to avoid deadloop in capsule process
+    //
+    Status = RemoveFileFromDir(FileDir, EFI_FILE_SYSTEM | EFI_FILE_ARCHIVE);
+    DEBUG((DEBUG_INFO, "RemoveFileFromDir status %x\n", Status));
+  }
 
   FileDir->Close (FileDir);
 
@@ -1192,6 +1233,66 @@ GetAllCapsuleOnDisk(
   return Status;
 }
 
+/**
+  Stream a capsule file into the relocation file chunk by chunk, so the capsule
+  image never has to be held in memory as a whole.
+
+  @param[in] Dir               Directory file handler of the capsule file
+  @param[in] FileInfo          File info of the capsule file
+  @param[in] DestFile          Relocation file handler, written at its current position
+  @param[in] ChunkBuffer       Buffer of COD_RELOCATION_CHUNK_SIZE bytes
+
+  @retval EFI_SUCCESS   The whole capsule file is written to DestFile.
+
+**/
+EFI_STATUS
+StreamCapsuleFileToFile (
+  IN EFI_FILE_HANDLE   Dir,
+  IN EFI_FILE_INFO     *FileInfo,
+  IN EFI_FILE_HANDLE   DestFile,
+  IN VOID              *ChunkBuffer
+  )
+{
+  EFI_STATUS       Status;
+  EFI_FILE_HANDLE  FileHandle;
+  UINT64           Remaining;
+  UINTN            ReadSize;
+  UINTN            WriteSize;
+
+  Status = Dir->Open(
+                  Dir,
+                  &FileHandle,
+                  FileInfo->FileName,
+                  EFI_FILE_MODE_READ,
+                  0
+                  );
+  if (EFI_ERROR(Status)) {
+    return Status;
+  }
+
+  Remaining = FileInfo->FileSize;
+  while (Remaining != 0) {
+    ReadSize = (UINTN) MIN (Remaining, COD_RELOCATION_CHUNK_SIZE);
+    WriteSize = ReadSize;
+    Status = FileHandle->Read(FileHandle, &ReadSize, ChunkBuffer);
+    if (EFI_ERROR(Status) || ReadSize != WriteSize) {
+      Status = EFI_DEVICE_ERROR;
+      break;
+    }
+
+    Status = DestFile->Write(DestFile, &WriteSize, ChunkBuffer);
+    if (EFI_ERROR(Status) || WriteSize != ReadSize) {
+      Status = EFI_DEVICE_ERROR;
+      break;
+    }
+
+    Remaining -= ReadSize;
+  }
+
+  FileHandle->Close(FileHandle);
+  return Status;
+}
+
 /**
   Build Gather list for a list of capsule images.
 
@@ -1428,6 +1529,7 @@ RelocateCapsuleToDisk(
   UINT8                           *CapsulePtr;
   EFI_SIMPLE_FILE_SYSTEM_PROTOCOL *Fs;
   EFI_FILE_HANDLE                 RootDir;
+  EFI_FILE_HANDLE                 CapsuleDir;
   EFI_FILE_HANDLE                 TempCodFile;
   UINT64                          TempCodFileSize;
   EFI_DEVICE_PATH                 *TempDevicePath;
@@ -1436,6 +1538,7 @@ RelocateCapsuleToDisk(
   EFI_CAPSULE_HEADER              FileNameCapsuleHeader;
 
   RootDir          = NULL;
+  CapsuleDir       = NULL;
   TempCodFile      = NULL;
   HandleBuffer     = NULL;
   CapsuleDataBuf   = NULL;
@@ -1445,14 +1548,20 @@ RelocateCapsuleToDisk(
   DEBUG ((DEBUG_INFO, "CapsuleOnDisk RelocateCapsule Enter\n"));
 
   //
-  // 1. Load all Capsule On Disks in to memory
+  // 1. Get all Capsule On Disks. The images are not read into memory, they are
+  // streamed into the relocation file below.
   //
-  Status = GetAllCapsuleOnDisk(MaxRetry, &CapsuleOnDiskBuf, &CapsuleOnDiskNum, &Handle, &LoadOptionNumber);
+  Status = GetAllCapsuleOnDisk(MaxRetry, FALSE, &CapsuleOnDiskBuf, &CapsuleOnDiskNum, &Handle, &LoadOptionNumber);
   if (EFI_ERROR(Status) || CapsuleOnDiskNum == 0 || CapsuleOnDiskBuf == NULL) {
     DEBUG ((DEBUG_INFO, "RelocateCapsule: GetAllCapsuleOnDisk Status - 0x%x\n", Status));
     return EFI_NOT_FOUND;
   }
 
+  Status = OpenCapsuleDirectory (Handle, &CapsuleDir);
+  if (EFI_ERROR(Status)) {
+    goto EXIT;
+  }
+
   //
   // 2. Connect platform special device path as relocation device.
   // If no platform special device path specified or the device path is invalid, use the EFI system partition where
@@ -1563,43 +1672,17 @@ RelocateCapsuleToDisk(
     goto EXIT;
   }
 
-  CapsuleDataBuf = AllocatePool((UINTN) TempCodFileSize);
+  //
+  // One chunk buffer is used to stream the capsule images, it must also hold
+  // the total size and the capsule name capsule.
+  //
+  DataSize = MAX (COD_RELOCATION_CHUNK_SIZE, sizeof(UINT64) + sizeof(EFI_CAPSULE_HEADER) + (UINTN) TotalImageNameSize);
+  CapsuleDataBuf = AllocatePool(DataSize);
   if (CapsuleDataBuf == NULL) {
     Status = EFI_OUT_OF_RESOURCES;
     goto EXIT;
   }
 
-  //
-  // First UINT64 reserved for total image size, including capsule name capsule.
-  //
-  *(UINT64 *) CapsuleDataBuf = TotalImageSize + sizeof(EFI_CAPSULE_HEADER) + TotalImageNameSize;
-
-  //
-  // Line up all the Capsule on Disk and write to relocation disk at one time. It could save some time in disk write
-  //
-  for (Index = 0, CapsulePtr = CapsuleDataBuf + sizeof(UINT64); Index < CapsuleOnDiskNum; Index++) {
-    CopyMem(CapsulePtr, CapsuleOnDiskBuf[Index].ImageAddress, (UINTN) CapsuleOnDiskBuf[Index].FileInfo->FileSize);
-    CapsulePtr += CapsuleOnDiskBuf[Index].FileInfo->FileSize;
-  }
-
-  //
-  // Line the capsule header for capsule name capsule.
-  //
-  CopyGuid(&FileNameCapsuleHeader.CapsuleGuid, &gEdkiiCapsuleOnDiskNameGuid);
-  FileNameCapsuleHeader.CapsuleImageSize = (UINT32) TotalImageNameSize + sizeof(EFI_CAPSULE_HEADER);
-  FileNameCapsuleHeader.Flags            = CAPSULE_FLAGS_PERSIST_ACROSS_RESET;
-  FileNameCapsuleHeader.HeaderSize       = sizeof(EFI_CAPSULE_HEADER);
-  CopyMem(CapsulePtr, &FileNameCapsuleHeader, FileNameCapsuleHeader.HeaderSize);
-  CapsulePtr += FileNameCapsuleHeader.HeaderSize;
-
-  //
-  // Line up all the Capsule file names.
-  //
-  for (Index = 0; Index < CapsuleOnDiskNum; Index++) {
-    CopyMem(CapsulePtr, CapsuleOnDiskBuf[Index].FileInfo->FileName, StrSize(CapsuleOnDiskBuf[Index].FileInfo->FileName));
-    CapsulePtr += StrSize(CapsuleOnDiskBuf[Index].FileInfo->FileName);
-  }
-
   //
   // 5. Flash all Capsules on Disk to TempCoD.tmp under RootDir
   //
@@ -1635,20 +1718,65 @@ RelocateCapsuleToDisk(
   }
 
   //
-  // Always write at the begining of TempCap file
+  // Always write at the begining of TempCap file.
+  // First UINT64 reserved for total image size, including capsule name capsule.
   //
-  DataSize = (UINTN) TempCodFileSize;
+  *(UINT64 *) CapsuleDataBuf = TotalImageSize + sizeof(EFI_CAPSULE_HEADER) + TotalImageNameSize;
+  DataSize = sizeof(UINT64);
   Status = TempCodFile->Write(
                           TempCodFile,
                           &DataSize,
                           CapsuleDataBuf
                           );
-  if (EFI_ERROR(Status)) {
+  if (EFI_ERROR(Status) || DataSize != sizeof(UINT64)) {
     DEBUG((DEBUG_ERROR, "RelocateCapsule: Write TemCoD.tmp error. %x\n", Status));
+    Status = EFI_DEVICE_ERROR;
     goto EXIT;
   }
 
-  if (DataSize != TempCodFileSize) {
+  //
+  // Stream all the Capsule on Disk to the relocation file
+  //
+  for (Index = 0; Index < CapsuleOnDiskNum; Index++) {
+    Status = StreamCapsuleFileToFile (
+               CapsuleDir,
+               CapsuleOnDiskBuf[Index].FileInfo,
+               TempCodFile,
+               CapsuleDataBuf
+               );
+    if (EFI_ERROR(Status)) {
+      DEBUG((DEBUG_ERROR, "RelocateCapsule: Stream %s to TemCoD.tmp error. %x\n", CapsuleOnDiskBuf[Index].FileInfo->FileName, Status));
+      goto EXIT;
+    }
+  }
+
+  //
+  // Line the capsule header for capsule name capsule.
+  //
+  CapsulePtr = CapsuleDataBuf;
+  CopyGuid(&FileNameCapsuleHeader.CapsuleGuid, &gEdkiiCapsuleOnDiskNameGuid);
+  FileNameCapsuleHeader.CapsuleImageSize = (UINT32) TotalImageNameSize + sizeof(EFI_CAPSULE_HEADER);
+  FileNameCapsuleHeader.Flags            = CAPSULE_FLAGS_PERSIST_ACROSS_RESET;
+  FileNameCapsuleHeader.HeaderSize       = sizeof(EFI_CAPSULE_HEADER);
+  CopyMem(CapsulePtr, &FileNameCapsuleHeader, FileNameCapsuleHeader.HeaderSize);
+  CapsulePtr += FileNameCapsuleHeader.HeaderSize;
+
+  //
+  // Line up all the Capsule file names.
+  //
+  for (Index = 0; Index < CapsuleOnDiskNum; Index++) {
+    CopyMem(CapsulePtr, CapsuleOnDiskBuf[Index].FileInfo->FileName, StrSize(CapsuleOnDiskBuf[Index].FileInfo->FileName));
+    CapsulePtr += StrSize(CapsuleOnDiskBuf[Index].FileInfo->FileName);
+  }
+
+  DataSize = (UINTN) (CapsulePtr - CapsuleDataBuf);
+  Status = TempCodFile->Write(
+                          TempCodFile,
+                          &DataSize,
+                          CapsuleDataBuf
+                          );
+  if (EFI_ERROR(Status) || DataSize != (UINTN) (CapsulePtr - CapsuleDataBuf)) {
+    DEBUG((DEBUG_ERROR, "RelocateCapsule: Write TemCoD.tmp error. %x\n", Status));
     Status = EFI_DEVICE_ERROR;
     goto EXIT;
   }
@@ -1684,12 +1812,19 @@ EXIT:
     FreePool(CapsuleDataBuf);
   }
 
+  if (CapsuleDir != NULL) {
+    //
+    // Always remove file to avoid deadloop in capsule process
+    //
+    RemoveFileFromDir(CapsuleDir, EFI_FILE_SYSTEM | EFI_FILE_ARCHIVE);
+    CapsuleDir->Close (CapsuleDir);
+  }
+
   if (CapsuleOnDiskBuf != NULL) {
     //
     // Free resources allocated by CodLibGetAllCapsuleOnDisk
     //
     for (Index = 0; Index < CapsuleOnDiskNum; Index++ ) {
-      FreePool(CapsuleOnDiskBuf[Index].ImageAddress);
       FreePool(CapsuleOnDiskBuf[Index].FileInfo);
     }
     FreePool(CapsuleOnDiskBuf);
@@ -1750,7 +1885,7 @@ RelocateCapsuleToRam (
   //
   // 1. Load all Capsule On Disks into memory
   //
-  Status = GetAllCapsuleOnDisk (MaxRetry, &CapsuleOnDiskBuf, &CapsuleOnDiskNum, &Handle, NULL);
+  Status = GetAllCapsuleOnDisk (MaxRetry, TRUE, &CapsuleOnDiskBuf, &CapsuleOnDiskNum, &Handle, NULL);
   if (EFI_ERROR (Status) || CapsuleOnDiskNum == 0 || CapsuleOnDiskBuf == NULL) {
     DEBUG ((DEBUG_ERROR, "GetAllCapsuleOnDisk Status - 0x%x\n", Status));
     return EFI_NOT_FOUND;
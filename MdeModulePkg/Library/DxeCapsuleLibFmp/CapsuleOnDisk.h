@@ -52,6 +52,11 @@
 #define MAX_FILE_NAME_LEN    (MAX_FILE_NAME_SIZE / sizeof(CHAR16))
 #define MAX_FILE_INFO_LEN    (OFFSET_OF(EFI_FILE_INFO, FileName) + MAX_FILE_NAME_LEN)
 
+//
+// Size of the buffer used to stream capsule files into the relocation file.
+//
+#define COD_RELOCATION_CHUNK_SIZE   SIZE_1MB
+
 typedef struct {
   UINTN           Signature;
   LIST_ENTRY      Link;                  ///  Linked list members.
@@ -63,6 +68,7 @@ typedef struct {
 typedef struct {
   //
   // image address.
+  //  if ImageAddress == NULL. means image is not read into memory
   //
   VOID             *ImageAddress;
   //
@@ -0,0 +1,1042 @@
+/** @file
+  DXE Debug library instance that defers formatting of DEBUG() messages.
+
+  DEBUG() stores the error level, the location of the format string and the
+  raw arguments in the deferred debug log, a memory buffer shared by all the
+  modules that use this instance, instead of formatting the message and
+  writing it to the serial port. The messages are formatted and sent to the
+  serial port later, in the order they were recorded:
+    - at ExitBootServices(),
+    - when the module that recorded them is unloaded, as its format strings
+      go away with it,
+    - before an error message or an ASSERT() is printed, and
+    - when the log is full.
+  The log is also published as an EFI configuration table, so that messages
+  can be read from memory by a tool that has the build output of the images.
+
+  If PcdDeferredDebugLogSize is zero, or the log cannot be set up, messages
+  are sent to the serial port immediately, as with BaseDebugLibSerialPort.
+
+  Copyright (c) 2021, EDK II contributors. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Uefi.h>
+
+#include <Guid/DeferredDebugLog.h>
+#include <Protocol/LoadedImage.h>
+
+#include <Library/DebugLib.h>
+#include <Library/BaseLib.h>
+#include <Library/PrintLib.h>
+#include <Library/PcdLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/SerialPortLib.h>
+#include <Library/SynchronizationLib.h>
+#include <Library/DebugPrintErrorLevelLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+
+//
+// Define the maximum debug and assert message length that this library supports
+//
+#define MAX_DEBUG_MESSAGE_LENGTH  0x100
+
+//
+// Define the maximum size of a record, and the maximum number of arguments
+// of a message that can be deferred. Messages that do not fit are printed
+// immediately.
+//
+#define MAX_DEFERRED_DEBUG_RECORD_SIZE  0x200
+#define MAX_DEFERRED_DEBUG_ARGUMENTS    16
+
+//
+// The smallest record buffer that is created.
+//
+#define MIN_DEFERRED_DEBUG_LOG_SIZE  SIZE_4KB
+
+typedef enum {
+  DeferredArgumentInt,      ///< %d, %u, %x, %X
+  DeferredArgumentInt64,    ///< %ld, %lu, %lx, %lX
+  DeferredArgumentUintn,    ///< %p, %c, %r and * widths and precisions
+  DeferredArgumentAscii,    ///< %a
+  DeferredArgumentUnicode,  ///< %s, %S
+  DeferredArgumentGuid,     ///< %g
+  DeferredArgumentTime      ///< %t
+} DEFERRED_ARGUMENT_TYPE;
+
+//
+// VA_LIST can not initialize to NULL for all compiler, so we use this to
+// indicate a null VA_LIST
+//
+VA_LIST                    mVaListNull;
+
+DEFERRED_DEBUG_LOG_HEADER  *mDeferredDebugLog;
+UINT64                     mDeferredDebugImageBase;
+EFI_EVENT                  mDeferredDebugExitBootServicesEvent;
+
+/**
+  List the types of the arguments a format string consumes, in the way
+  PrintLib consumes them.
+
+  @param  Format  A Null-terminated ASCII format string.
+  @param  Types   An array of MAX_DEFERRED_DEBUG_ARGUMENTS elements that
+                  receives the argument types.
+
+  @return The number of arguments, or MAX_UINTN if there are more than
+          MAX_DEFERRED_DEBUG_ARGUMENTS.
+
+**/
+STATIC
+UINTN
+DeferredDebugParseFormat (
+  IN  CONST CHAR8             *Format,
+  OUT DEFERRED_ARGUMENT_TYPE  *Types
+  )
+{
+  UINTN    Count;
+  BOOLEAN  Long;
+  BOOLEAN  Done;
+
+  Count = 0;
+  while (*Format != '\0') {
+    if (*Format++ != '%') {
+      continue;
+    }
+
+    //
+    // Parse the flags, width and precision.
+    //
+    Long = FALSE;
+    for (Done = FALSE; !Done; ) {
+      switch (*Format) {
+      case 'L':
+      case 'l':
+        Long = TRUE;
+        Format++;
+        break;
+      case '*':
+        if (Count == MAX_DEFERRED_DEBUG_ARGUMENTS) {
+          return MAX_UINTN;
+        }
+        Types[Count++] = DeferredArgumentUintn;
+        Format++;
+        break;
+      case '.':
+      case '-':
+      case '+':
+      case ' ':
+      case ',':
+        Format++;
+        break;
+      default:
+        if ((*Format >= '0') && (*Format <= '9')) {
+          Format++;
+        } else {
+          Done = TRUE;
+        }
+        break;
+      }
+    }
+
+    switch (*Format) {
+    case '\0':
+      return Count;
+    case 'd':
+    case 'u':
+    case 'x':
+    case 'X':
+      Types[Count] = Long ? DeferredArgumentInt64 : DeferredArgumentInt;
+      break;
+    case 'p':
+    case 'c':
+    case 'r':
+      Types[Count] = DeferredArgumentUintn;
+      break;
+    case 'a':
+      Types[Count] = DeferredArgumentAscii;
+      break;
+    case 's':
+    case 'S':
+      Types[Count] = DeferredArgumentUnicode;
+      break;
+    case 'g':
+      Types[Count] = DeferredArgumentGuid;
+      break;
+    case 't':
+      Types[Count] = DeferredArgumentTime;
+      break;
+    default:
+      //
+      // %%, or a type without an argument.
+      //
+      Format++;
+      continue;
+    }
+
+    if (Count == MAX_DEFERRED_DEBUG_ARGUMENTS) {
+      return MAX_UINTN;
+    }
+    Count++;
+    Format++;
+  }
+
+  return Count;
+}
+
+/**
+  Copy the data a pointer argument points to into a record.
+
+  @param  Record      The record being built, MAX_DEFERRED_DEBUG_RECORD_SIZE
+                      bytes long.
+  @param  DataOffset  On input, the offset of the free space in Record. On
+                      output, the offset past the copied data.
+  @param  Type        The type of the argument.
+  @param  Pointer     The argument.
+
+  @return The offset of the copy in Record, or 0 if Pointer is NULL or the
+          data does not fit.
+
+**/
+STATIC
+UINTN
+DeferredDebugCopyArgument (
+  IN OUT UINT8                   *Record,
+  IN OUT UINTN                   *DataOffset,
+  IN     DEFERRED_ARGUMENT_TYPE  Type,
+  IN     CONST VOID              *Pointer
+  )
+{
+  UINTN  Offset;
+  UINTN  Length;
+  UINTN  CharSize;
+  UINTN  MaxChars;
+  UINTN  Index;
+
+  if (Pointer == NULL) {
+    return 0;
+  }
+
+  CharSize = (Type == DeferredArgumentAscii) ? sizeof (CHAR8) : sizeof (CHAR16);
+  Offset   = ALIGN_VALUE (*DataOffset, (Type == DeferredArgumentUnicode) ? sizeof (CHAR16) :
+                                       (Type == DeferredArgumentAscii) ? sizeof (CHAR8) : sizeof (UINT64));
+  if (Offset >= MAX_DEFERRED_DEBUG_RECORD_SIZE) {
+    return 0;
+  }
+
+  switch (Type) {
+  case DeferredArgumentGuid:
+  case DeferredArgumentTime:
+    Length = (Type == DeferredArgumentGuid) ? sizeof (GUID) : sizeof (EFI_TIME);
+    if (Length > MAX_DEFERRED_DEBUG_RECORD_SIZE - Offset) {
+      return 0;
+    }
+    CopyMem (Record + Offset, Pointer, Length);
+    break;
+
+  default:
+    //
+    // Copy as much of the string as fits, and terminate it.
+    //
+    MaxChars = (MAX_DEFERRED_DEBUG_RECORD_SIZE - Offset) / CharSize;
+    if (MaxChars < 2) {
+      return 0;
+    }
+    for (Index = 0; Index < MaxChars - 1; Index++) {
+      if (CharSize == sizeof (CHAR8)) {
+        Record[Offset + Index] = ((CONST CHAR8 *)Pointer)[Index];
+        if (Record[Offset + Index] == '\0') {
+          break;
+        }
+      } else {
+        ((CHAR16 *)(Record + Offset))[Index] = ((CONST CHAR16 *)Pointer)[Index];
+        if (((CHAR16 *)(Record + Offset))[Index] == L'\0') {
+          break;
+        }
+      }
+    }
+    if (Index == MaxChars - 1) {
+      ZeroMem (Record + Offset + Index * CharSize, CharSize);
+    }
+    Length = (Index + 1) * CharSize;
+    break;
+  }
+
+  *DataOffset = Offset + Length;
+  return Offset;
+}
+
+/**
+  Build the record of a debug message.
+
+  @param  Record          A buffer of MAX_DEFERRED_DEBUG_RECORD_SIZE bytes that
+                          receives the record, with a Size of zero.
+  @param  ErrorLevel      The error level of the debug message.
+  @param  Format          Format string for the debug message to print.
+  @param  VaListMarker    VA_LIST marker for the variable argument list.
+  @param  BaseListMarker  BASE_LIST marker for the variable argument list.
+
+  @return The size of the record, or 0 if the message cannot be deferred.
+
+**/
+STATIC
+UINTN
+DeferredDebugBuildRecord (
+  OUT DEFERRED_DEBUG_RECORD  *Record,
+  IN  UINTN                  ErrorLevel,
+  IN  CONST CHAR8            *Format,
+  IN  VA_LIST                VaListMarker,
+  IN  BASE_LIST              BaseListMarker
+  )
+{
+  DEFERRED_ARGUMENT_TYPE  Types[MAX_DEFERRED_DEBUG_ARGUMENTS];
+  UINTN                   Count;
+  UINTN                   Index;
+  UINTN                   DataOffset;
+  BASE_LIST               Arguments;
+  CONST VOID              *Pointer;
+
+  Count = DeferredDebugParseFormat (Format, Types);
+  if (Count == MAX_UINTN) {
+    return 0;
+  }
+
+  //
+  // The copied data starts after the BASE_LIST arguments.
+  //
+  DataOffset = sizeof (DEFERRED_DEBUG_RECORD);
+  for (Index = 0; Index < Count; Index++) {
+    if (Types[Index] == DeferredArgumentInt) {
+      DataOffset += _BASE_INT_SIZE_OF (int) * sizeof (UINTN);
+    } else if (Types[Index] == DeferredArgumentInt64) {
+      DataOffset += _BASE_INT_SIZE_OF (INT64) * sizeof (UINTN);
+    } else {
+      DataOffset += sizeof (UINTN);
+    }
+  }
+  if (DataOffset > MAX_DEFERRED_DEBUG_RECORD_SIZE) {
+    return 0;
+  }
+
+  Arguments = (BASE_LIST)(Record + 1);
+  for (Index = 0; Index < Count; Index++) {
+    switch (Types[Index]) {
+    case DeferredArgumentInt:
+      if (BaseListMarker == NULL) {
+        BASE_ARG (Arguments, int) = VA_ARG (VaListMarker, int);
+      } else {
+        BASE_ARG (Arguments, int) = BASE_ARG (BaseListMarker, int);
+      }
+      break;
+    case DeferredArgumentInt64:
+      if (BaseListMarker == NULL) {
+        BASE_ARG (Arguments, INT64) = VA_ARG (VaListMarker, INT64);
+      } else {
+        BASE_ARG (Arguments, INT64) = BASE_ARG (BaseListMarker, INT64);
+      }
+      break;
+    case DeferredArgumentUintn:
+      if (BaseListMarker == NULL) {
+        BASE_ARG (Arguments, UINTN) = VA_ARG (VaListMarker, UINTN);
+      } else {
+        BASE_ARG (Arguments, UINTN) = BASE_ARG (BaseListMarker, UINTN);
+      }
+      break;
+    default:
+      if (BaseListMarker == NULL) {
+        Pointer = VA_ARG (VaListMarker, CONST VOID *);
+      } else {
+        Pointer = BASE_ARG (BaseListMarker, CONST VOID *);
+      }
+      BASE_ARG (Arguments, UINTN) = DeferredDebugCopyArgument ((UINT8 *)Record, &DataOffset, Types[Index], Pointer);
+      break;
+    }
+  }
+
+  Record->Size         = 0;
+  Record->Flags        = (sizeof (UINTN) == sizeof (UINT64)) ? DEFERRED_DEBUG_RECORD_64BIT : 0;
+  Record->ErrorLevel   = (UINT32)ErrorLevel;
+  Record->ImageBase    = mDeferredDebugImageBase;
+  Record->FormatOffset = (UINTN)Format - mDeferredDebugImageBase;
+  return ALIGN_VALUE (DataOffset, DEFERRED_DEBUG_RECORD_ALIGNMENT);
+}
+
+/**
+  Append a record to the deferred debug log.
+
+  @param  Log         The deferred debug log.
+  @param  Record      The record, with a Size of zero.
+  @param  RecordSize  The size of the record.
+
+  @retval TRUE    The record was appended.
+  @retval FALSE   The log is full.
+
+**/
+STATIC
+BOOLEAN
+DeferredDebugAppendRecord (
+  IN DEFERRED_DEBUG_LOG_HEADER  *Log,
+  IN DEFERRED_DEBUG_RECORD      *Record,
+  IN UINTN                      RecordSize
+  )
+{
+  UINT32                 Head;
+  UINT32                 Offset;
+  UINT32                 Padding;
+  DEFERRED_DEBUG_RECORD  *Target;
+
+  do {
+    Head    = Log->Head;
+    Offset  = Head & (Log->Size - 1);
+    Padding = (Offset + RecordSize > Log->Size) ? Log->Size - Offset : 0;
+    if (Head + Padding + (UINT32)RecordSize - Log->Tail > Log->Size) {
+      return FALSE;
+    }
+  } while (InterlockedCompareExchange32 (&Log->Head, Head, Head + Padding + (UINT32)RecordSize) != Head);
+
+  if (Padding != 0) {
+    Target        = DEFERRED_DEBUG_LOG_RECORD (Log, Head);
+    Target->Flags = DEFERRED_DEBUG_RECORD_PADDING;
+    MemoryFence ();
+    Target->Size = (UINT16)Padding;
+  }
+
+  //
+  // Publish the record by storing its size last.
+  //
+  Target = DEFERRED_DEBUG_LOG_RECORD (Log, Head + Padding);
+  CopyMem (
+    (UINT8 *)Target + sizeof (Target->Size),
+    (UINT8 *)Record + sizeof (Record->Size),
+    RecordSize - sizeof (Record->Size)
+    );
+  MemoryFence ();
+  Target->Size = (UINT16)RecordSize;
+  return TRUE;
+}
+
+/**
+  Format a record and send it to the serial port.
+
+  @param  Record  A copy of the record, which is modified.
+
+**/
+STATIC
+VOID
+DeferredDebugPrintRecord (
+  IN OUT DEFERRED_DEBUG_RECORD  *Record
+  )
+{
+  CHAR8                   Buffer[MAX_DEBUG_MESSAGE_LENGTH];
+  DEFERRED_ARGUMENT_TYPE  Types[MAX_DEFERRED_DEBUG_ARGUMENTS];
+  CONST CHAR8             *Format;
+  UINTN                   Count;
+  UINTN                   Index;
+  BASE_LIST               Arguments;
+
+  if (((Record->Flags & DEFERRED_DEBUG_RECORD_64BIT) != 0) != (sizeof (UINTN) == sizeof (UINT64))) {
+    return;
+  }
+
+  Format = (CONST CHAR8 *)(UINTN)(Record->ImageBase + Record->FormatOffset);
+  Count  = DeferredDebugParseFormat (Format, Types);
+  if (Count == MAX_UINTN) {
+    return;
+  }
+
+  //
+  // Turn the offsets of the copied data back into pointers.
+  //
+  Arguments = (BASE_LIST)(Record + 1);
+  for (Index = 0; Index < Count; Index++) {
+    if (Types[Index] == DeferredArgumentInt) {
+      Arguments += _BASE_INT_SIZE_OF (int);
+    } else if (Types[Index] == DeferredArgumentInt64) {
+      Arguments += _BASE_INT_SIZE_OF (INT64);
+    } else {
+      if ((Types[Index] != DeferredArgumentUintn) && (*Arguments != 0)) {
+        *Arguments += (UINTN)Record;
+      }
+      Arguments++;
+    }
+  }
+
+  AsciiBSPrint (Buffer, sizeof (Buffer), Format, (BASE_LIST)(Record + 1));
+  SerialPortWrite ((UINT8 *)Buffer, AsciiStrLen (Buffer));
+}
+
+/**
+  Format all the records in the deferred debug log and send them to the
+  serial port.
+
+  Records that are still being written are left in the log. Nothing is done
+  if another caller is already rendering the log.
+
+  @param  Log   The deferred debug log.
+
+**/
+STATIC
+VOID
+DeferredDebugRender (
+  IN DEFERRED_DEBUG_LOG_HEADER  *Log
+  )
+{
+  UINT64                 RecordBuffer[MAX_DEFERRED_DEBUG_RECORD_SIZE / sizeof (UINT64)];
+  CHAR8                  Buffer[MAX_DEBUG_MESSAGE_LENGTH];
+  DEFERRED_DEBUG_RECORD  *Record;
+  UINT32                 Tail;
+  UINT32                 Dropped;
+  UINT16                 Size;
+
+  if (InterlockedCompareExchange32 (&Log->Rendering, 0, 1) != 0) {
+    return;
+  }
+
+  for (Tail = Log->Tail; Tail != Log->Head; Tail += Size) {
+    Record = DEFERRED_DEBUG_LOG_RECORD (Log, Tail);
+    Size   = Record->Size;
+    if (Size == 0) {
+      break;
+    }
+
+    if (((Record->Flags & DEFERRED_DEBUG_RECORD_PADDING) == 0) && (Size <= sizeof (RecordBuffer))) {
+      CopyMem (RecordBuffer, Record, Size);
+      DeferredDebugPrintRecord ((DEFERRED_DEBUG_RECORD *)RecordBuffer);
+    }
+
+    //
+    // Release the space for writers.
+    //
+    Record->Size = 0;
+    MemoryFence ();
+    Log->Tail = Tail + Size;
+  }
+
+  Dropped = Log->Dropped;
+  if ((Dropped != 0) && (InterlockedCompareExchange32 (&Log->Dropped, Dropped, 0) == Dropped)) {
+    AsciiSPrint (Buffer, sizeof (Buffer), "(%d DEBUG messages dropped)\n", Dropped);
+    SerialPortWrite ((UINT8 *)Buffer, AsciiStrLen (Buffer));
+  }
+
+  Log->Rendering = 0;
+}
+
+/**
+  Render the deferred debug log and stop using it once boot services are
+  gone.
+
+  @param  Event     The ExitBootServices event.
+  @param  Context   Unused.
+
+**/
+STATIC
+VOID
+EFIAPI
+DeferredDebugExitBootServices (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  if (mDeferredDebugLog != NULL) {
+    DeferredDebugRender (mDeferredDebugLog);
+    mDeferredDebugLog = NULL;
+  }
+}
+
+/**
+  Allocate the deferred debug log and install it as a configuration table.
+
+  @return The deferred debug log, or NULL if it could not be created.
+
+**/
+STATIC
+DEFERRED_DEBUG_LOG_HEADER *
+DeferredDebugCreateLog (
+  VOID
+  )
+{
+  DEFERRED_DEBUG_LOG_HEADER  *Log;
+  EFI_PHYSICAL_ADDRESS       Address;
+  UINT32                     Size;
+  UINTN                      Pages;
+  EFI_STATUS                 Status;
+
+  Size  = GetPowerOfTwo32 (MAX (PcdGet32 (PcdDeferredDebugLogSize), MIN_DEFERRED_DEBUG_LOG_SIZE));
+  Pages = EFI_SIZE_TO_PAGES (sizeof (DEFERRED_DEBUG_LOG_HEADER) + Size);
+  Status = gBS->AllocatePages (AllocateAnyPages, EfiReservedMemoryType, Pages, &Address);
+  if (EFI_ERROR (Status)) {
+    return NULL;
+  }
+
+  Log = (DEFERRED_DEBUG_LOG_HEADER *)(UINTN)Address;
+  ZeroMem (Log, EFI_PAGES_TO_SIZE (Pages));
+  Log->Signature = DEFERRED_DEBUG_LOG_SIGNATURE;
+  Log->Version   = DEFERRED_DEBUG_LOG_VERSION;
+  Log->Size      = Size;
+
+  Status = gBS->InstallConfigurationTable (&gEdkiiDeferredDebugLogGuid, Log);
+  if (EFI_ERROR (Status)) {
+    gBS->FreePages (Address, Pages);
+    return NULL;
+  }
+
+  return Log;
+}
+
+/**
+  The constructor function initializes the Serial Port Library, and finds or
+  creates the deferred debug log.
+
+  @param  ImageHandle   The firmware allocated handle for the EFI image.
+  @param  SystemTable   A pointer to the EFI System Table.
+
+  @retval EFI_SUCCESS   The constructor always returns EFI_SUCCESS; messages
+                        are printed immediately if there is no log.
+
+**/
+EFI_STATUS
+EFIAPI
+DxeDebugLibDeferredConstructor (
+  IN EFI_HANDLE        ImageHandle,
+  IN EFI_SYSTEM_TABLE  *SystemTable
+  )
+{
+  DEFERRED_DEBUG_LOG_HEADER  *Log;
+  EFI_LOADED_IMAGE_PROTOCOL  *LoadedImage;
+  UINTN                      Index;
+  EFI_STATUS                 Status;
+
+  SerialPortInitialize ();
+
+  if (PcdGet32 (PcdDeferredDebugLogSize) == 0) {
+    return EFI_SUCCESS;
+  }
+
+  Status = gBS->HandleProtocol (ImageHandle, &gEfiLoadedImageProtocolGuid, (VOID **)&LoadedImage);
+  if (!EFI_ERROR (Status)) {
+    mDeferredDebugImageBase = (UINTN)LoadedImage->ImageBase;
+  }
+
+  Log = NULL;
+  for (Index = 0; Index < SystemTable->NumberOfTableEntries; Index++) {
+    if (CompareGuid (&SystemTable->ConfigurationTable[Index].VendorGuid, &gEdkiiDeferredDebugLogGuid)) {
+      Log = SystemTable->ConfigurationTable[Index].VendorTable;
+      break;
+    }
+  }
+  if (Log == NULL) {
+    Log = DeferredDebugCreateLog ();
+  }
+
+  if ((Log == NULL) || (Log->Signature != DEFERRED_DEBUG_LOG_SIGNATURE) ||
+      (Log->Version != DEFERRED_DEBUG_LOG_VERSION))
+  {
+    return EFI_SUCCESS;
+  }
+
+  Status = gBS->CreateEvent (
+                  EVT_SIGNAL_EXIT_BOOT_SERVICES,
+                  TPL_NOTIFY,
+                  DeferredDebugExitBootServices,
+                  NULL,
+                  &mDeferredDebugExitBootServicesEvent
+                  );
+  if (EFI_ERROR (Status)) {
+    return EFI_SUCCESS;
+  }
+
+  mDeferredDebugLog = Log;
+  return EFI_SUCCESS;
+}
+
+/**
+  Render the deferred debug log before the image, and the format strings its
+  records point to, are unloaded.
+
+  @param  ImageHandle   The firmware allocated handle for the EFI image.
+  @param  SystemTable   A pointer to the EFI System Table.
+
+  @retval EFI_SUCCESS   The destructor always returns EFI_SUCCESS.
+
+**/
+EFI_STATUS
+EFIAPI
+DxeDebugLibDeferredDestructor (
+  IN EFI_HANDLE        ImageHandle,
+  IN EFI_SYSTEM_TABLE  *SystemTable
+  )
+{
+  if (mDeferredDebugLog != NULL) {
+    DeferredDebugRender (mDeferredDebugLog);
+    mDeferredDebugLog = NULL;
+  }
+
+  if (mDeferredDebugExitBootServicesEvent != NULL) {
+    gBS->CloseEvent (mDeferredDebugExitBootServicesEvent);
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Prints a debug message to the debug output device if the specified error level is enabled.
+
+  If any bit in ErrorLevel is also set in DebugPrintErrorLevelLib function
+  GetDebugPrintErrorLevel (), then print the message specified by Format and the
+  associated variable argument list to the debug output device.
+
+  If Format is NULL, then ASSERT().
+
+  @param  ErrorLevel  The error level of the debug message.
+  @param  Format      Format string for the debug message to print.
+  @param  ...         Variable argument list whose contents are accessed
+                      based on the format string specified by Format.
+
+**/
+VOID
+EFIAPI
+DebugPrint (
+  IN  UINTN        ErrorLevel,
+  IN  CONST CHAR8  *Format,
+  ...
+  )
+{
+  VA_LIST  Marker;
+
+  VA_START (Marker, Format);
+  DebugVPrint (ErrorLevel, Format, Marker);
+  VA_END (Marker);
+}
+
+
+/**
+  Prints a debug message to the debug output device if the specified
+  error level is enabled base on Null-terminated format string and a
+  VA_LIST argument list or a BASE_LIST argument list.
+
+  If any bit in ErrorLevel is also set in DebugPrintErrorLevelLib function
+  GetDebugPrintErrorLevel (), then record the message specified by Format and
+  the associated variable argument list in the deferred debug log, or print
+  it to the debug output device if it cannot be deferred.
+
+  If Format is NULL, then ASSERT().
+
+  @param  ErrorLevel      The error level of the debug message.
+  @param  Format          Format string for the debug message to print.
+  @param  VaListMarker    VA_LIST marker for the variable argument list.
+  @param  BaseListMarker  BASE_LIST marker for the variable argument list.
+
+**/
+VOID
+DebugPrintMarker (
+  IN  UINTN         ErrorLevel,
+  IN  CONST CHAR8   *Format,
+  IN  VA_LIST       VaListMarker,
+  IN  BASE_LIST     BaseListMarker
+  )
+{
+  DEFERRED_DEBUG_LOG_HEADER  *Log;
+  UINT64                     Record[MAX_DEFERRED_DEBUG_RECORD_SIZE / sizeof (UINT64)];
+  UINTN                      RecordSize;
+  CHAR8                      Buffer[MAX_DEBUG_MESSAGE_LENGTH];
+
+  //
+  // If Format is NULL, then ASSERT().
+  //
+  ASSERT (Format != NULL);
+
+  //
+  // Check driver debug mask value and global mask
+  //
+  if ((ErrorLevel & GetDebugPrintErrorLevel ()) == 0) {
+    return;
+  }
+
+  Log = mDeferredDebugLog;
+  if (Log != NULL) {
+    //
+    // Error messages are printed right away, after the messages before them,
+    // as the system may not get far enough to render them later.
+    //
+    if ((ErrorLevel & DEBUG_ERROR) == 0) {
+      RecordSize = DeferredDebugBuildRecord ((DEFERRED_DEBUG_RECORD *)Record, ErrorLevel, Format, VaListMarker, BaseListMarker);
+      if (RecordSize != 0) {
+        if (DeferredDebugAppendRecord (Log, (DEFERRED_DEBUG_RECORD *)Record, RecordSize)) {
+          return;
+        }
+
+        //
+        // Make room by rendering the log.
+        //
+        DeferredDebugRender (Log);
+        if (DeferredDebugAppendRecord (Log, (DEFERRED_DEBUG_RECORD *)Record, RecordSize)) {
+          return;
+        }
+
+        InterlockedIncrement (&Log->Dropped);
+        return;
+      }
+    }
+
+    DeferredDebugRender (Log);
+  }
+
+  //
+  // Convert the DEBUG() message to an ASCII String
+  //
+  if (BaseListMarker == NULL) {
+    AsciiVSPrint (Buffer, sizeof (Buffer), Format, VaListMarker);
+  } else {
+    AsciiBSPrint (Buffer, sizeof (Buffer), Format, BaseListMarker);
+  }
+
+  //
+  // Send the print string to a Serial Port
+  //
+  SerialPortWrite ((UINT8 *)Buffer, AsciiStrLen (Buffer));
+}
+
+
+/**
+  Prints a debug message to the debug output device if the specified
+  error level is enabled.
+
+  If any bit in ErrorLevel is also set in DebugPrintErrorLevelLib function
+  GetDebugPrintErrorLevel (), then print the message specified by Format and
+  the associated variable argument list to the debug output device.
+
+  If Format is NULL, then ASSERT().
+
+  @param  ErrorLevel    The error level of the debug message.
+  @param  Format        Format string for the debug message to print.
+  @param  VaListMarker  VA_LIST marker for the variable argument list.
+
+**/
+VOID
+EFIAPI
+DebugVPrint (
+  IN  UINTN         ErrorLevel,
+  IN  CONST CHAR8   *Format,
+  IN  VA_LIST       VaListMarker
+  )
+{
+  DebugPrintMarker (ErrorLevel, Format, VaListMarker, NULL);
+}
+
+
+/**
+  Prints a debug message to the debug output device if the specified
+  error level is enabled.
+  This function use BASE_LIST which would provide a more compatible
+  service than VA_LIST.
+
+  If any bit in ErrorLevel is also set in DebugPrintErrorLevelLib function
+  GetDebugPrintErrorLevel (), then print the message specified by Format and
+  the associated variable argument list to the debug output device.
+
+  If Format is NULL, then ASSERT().
+
+  @param  ErrorLevel      The error level of the debug message.
+  @param  Format          Format string for the debug message to print.
+  @param  BaseListMarker  BASE_LIST marker for the variable argument list.
+
+**/
+VOID
+EFIAPI
+DebugBPrint (
+  IN  UINTN         ErrorLevel,
+  IN  CONST CHAR8   *Format,
+  IN  BASE_LIST     BaseListMarker
+  )
+{
+  DebugPrintMarker (ErrorLevel, Format, mVaListNull, BaseListMarker);
+}
+
+
+/**
+  Prints an assert message containing a filename, line number, and description.
+  This may be followed by a breakpoint or a dead loop.
+
+  Print a message of the form "ASSERT <FileName>(<LineNumber>): <Description>\n"
+  to the debug output device, after the messages in the deferred debug log.
+  If DEBUG_PROPERTY_ASSERT_BREAKPOINT_ENABLED bit of PcdDebugProperyMask is set
+  then CpuBreakpoint() is called. Otherwise, if
+  DEBUG_PROPERTY_ASSERT_DEADLOOP_ENABLED bit of PcdDebugProperyMask is set then
+  CpuDeadLoop() is called.  If neither of these bits are set, then this function
+  returns immediately after the message is printed to the debug output device.
+  DebugAssert() must actively prevent recursion.  If DebugAssert() is called while
+  processing another DebugAssert(), then DebugAssert() must return immediately.
+
+  If FileName is NULL, then a <FileName> string of "(NULL) Filename" is printed.
+  If Description is NULL, then a <Description> string of "(NULL) Description" is printed.
+
+  @param  FileName     The pointer to the name of the source file that generated the assert condition.
+  @param  LineNumber   The line number in the source file that generated the assert condition
+  @param  Description  The pointer to the description of the assert condition.
+
+**/
+VOID
+EFIAPI
+DebugAssert (
+  IN CONST CHAR8  *FileName,
+  IN UINTN        LineNumber,
+  IN CONST CHAR8  *Description
+  )
+{
+  CHAR8  Buffer[MAX_DEBUG_MESSAGE_LENGTH];
+
+  if (mDeferredDebugLog != NULL) {
+    DeferredDebugRender (mDeferredDebugLog);
+  }
+
+  //
+  // Generate the ASSERT() message in Ascii format
+  //
+  AsciiSPrint (Buffer, sizeof (Buffer), "ASSERT [%a] %a(%d): %a\n", gEfiCallerBaseName, FileName, LineNumber, Description);
+
+  //
+  // Send the print string to the Console Output device
+  //
+  SerialPortWrite ((UINT8 *)Buffer, AsciiStrLen (Buffer));
+
+  //
+  // Generate a Breakpoint, DeadLoop, or NOP based on PCD settings
+  //
+  if ((PcdGet8(PcdDebugPropertyMask) & DEBUG_PROPERTY_ASSERT_BREAKPOINT_ENABLED) != 0) {
+    CpuBreakpoint ();
+  } else if ((PcdGet8(PcdDebugPropertyMask) & DEBUG_PROPERTY_ASSERT_DEADLOOP_ENABLED) != 0) {
+    CpuDeadLoop ();
+  }
+}
+
+
+/**
+  Fills a target buffer with PcdDebugClearMemoryValue, and returns the target buffer.
+
+  This function fills Length bytes of Buffer with the value specified by
+  PcdDebugClearMemoryValue, and returns Buffer.
+
+  If Buffer is NULL, then ASSERT().
+  If Length is greater than (MAX_ADDRESS - Buffer + 1), then ASSERT().
+
+  @param   Buffer  The pointer to the target buffer to be filled with PcdDebugClearMemoryValue.
+  @param   Length  The number of bytes in Buffer to fill with zeros PcdDebugClearMemoryValue.
+
+  @return  Buffer  The pointer to the target buffer filled with PcdDebugClearMemoryValue.
+
+**/
+VOID *
+EFIAPI
+DebugClearMemory (
+  OUT VOID  *Buffer,
+  IN UINTN  Length
+  )
+{
+  //
+  // If Buffer is NULL, then ASSERT().
+  //
+  ASSERT (Buffer != NULL);
+
+  //
+  // SetMem() checks for the the ASSERT() condition on Length and returns Buffer
+  //
+  return SetMem (Buffer, Length, PcdGet8(PcdDebugClearMemoryValue));
+}
+
+
+/**
+  Returns TRUE if ASSERT() macros are enabled.
+
+  This function returns TRUE if the DEBUG_PROPERTY_DEBUG_ASSERT_ENABLED bit of
+  PcdDebugProperyMask is set.  Otherwise FALSE is returned.
+
+  @retval  TRUE    The DEBUG_PROPERTY_DEBUG_ASSERT_ENABLED bit of PcdDebugProperyMask is set.
+  @retval  FALSE   The DEBUG_PROPERTY_DEBUG_ASSERT_ENABLED bit of PcdDebugProperyMask is clear.
+
+**/
+BOOLEAN
+EFIAPI
+DebugAssertEnabled (
+  VOID
+  )
+{
+  return (BOOLEAN) ((PcdGet8(PcdDebugPropertyMask) & DEBUG_PROPERTY_DEBUG_ASSERT_ENABLED) != 0);
+}
+
+
+/**
+  Returns TRUE if DEBUG() macros are enabled.
+
+  This function returns TRUE if the DEBUG_PROPERTY_DEBUG_PRINT_ENABLED bit of
+  PcdDebugProperyMask is set.  Otherwise FALSE is returned.
+
+  @retval  TRUE    The DEBUG_PROPERTY_DEBUG_PRINT_ENABLED bit of PcdDebugProperyMask is set.
+  @retval  FALSE   The DEBUG_PROPERTY_DEBUG_PRINT_ENABLED bit of PcdDebugProperyMask is clear.
+
+**/
+BOOLEAN
+EFIAPI
+DebugPrintEnabled (
+  VOID
+  )
+{
+  return (BOOLEAN) ((PcdGet8(PcdDebugPropertyMask) & DEBUG_PROPERTY_DEBUG_PRINT_ENABLED) != 0);
+}
+
+
+/**
+  Returns TRUE if DEBUG_CODE() macros are enabled.
+
+  This function returns TRUE if the DEBUG_PROPERTY_DEBUG_CODE_ENABLED bit of
+  PcdDebugProperyMask is set.  Otherwise FALSE is returned.
+
+  @retval  TRUE    The DEBUG_PROPERTY_DEBUG_CODE_ENABLED bit of PcdDebugProperyMask is set.
+  @retval  FALSE   The DEBUG_PROPERTY_DEBUG_CODE_ENABLED bit of PcdDebugProperyMask is clear.
+
+**/
+BOOLEAN
+EFIAPI
+DebugCodeEnabled (
+  VOID
+  )
+{
+  return (BOOLEAN) ((PcdGet8(PcdDebugPropertyMask) & DEBUG_PROPERTY_DEBUG_CODE_ENABLED) != 0);
+}
+
+
+/**
+  Returns TRUE if DEBUG_CLEAR_MEMORY() macro is enabled.
+
+  This function returns TRUE if the DEBUG_PROPERTY_CLEAR_MEMORY_ENABLED bit of
+  PcdDebugProperyMask is set.  Otherwise FALSE is returned.
+
+  @retval  TRUE    The DEBUG_PROPERTY_CLEAR_MEMORY_ENABLED bit of PcdDebugProperyMask is set.
+  @retval  FALSE   The DEBUG_PROPERTY_CLEAR_MEMORY_ENABLED bit of PcdDebugProperyMask is clear.
+
+**/
+BOOLEAN
+EFIAPI
+DebugClearMemoryEnabled (
+  VOID
+  )
+{
+  return (BOOLEAN) ((PcdGet8(PcdDebugPropertyMask) & DEBUG_PROPERTY_CLEAR_MEMORY_ENABLED) != 0);
+}
+
+/**
+  Returns TRUE if any one of the bit is set both in ErrorLevel and PcdFixedDebugPrintErrorLevel.
+
+  This function compares the bit mask of ErrorLevel and PcdFixedDebugPrintErrorLevel.
+
+  @retval  TRUE    Current ErrorLevel is supported.
+  @retval  FALSE   Current ErrorLevel is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+DebugPrintLevelEnabled (
+  IN  CONST UINTN        ErrorLevel
+  )
+{
+  return (BOOLEAN) ((ErrorLevel & PcdGet32(PcdFixedDebugPrintErrorLevel)) != 0);
+}
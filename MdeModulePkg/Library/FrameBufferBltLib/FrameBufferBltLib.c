@@ -14,6 +14,8 @@
 #include <Library/DebugLib.h>
 #include <Library/FrameBufferBltLib.h>
 
+#include "FrameBufferBltLibInternal.h"
+
 struct FRAME_BUFFER_CONFIGURE {
   UINT32                          PixelsPerScanLine;
   UINT32                          BytesPerPixel;
@@ -406,7 +408,17 @@ FrameBufferBltLibVideoToBltBuffer (
 
     CopyMem (Destination, Source, WidthInBytes);
 
-    if (Configure->PixelFormat != PixelBlueGreenRedReserved8BitPerColor) {
+    if (Configure->PixelFormat == PixelRedGreenBlueReserved8BitPerColor) {
+      //
+      // The scan line is read from the frame buffer in one CopyMem(), then
+      // converted out of the line buffer with the vector kernel.
+      //
+      InternalFrameBufferBltSwapRedBlue (
+        (UINT8 *) BltBuffer + (DstY * Delta) + (DestinationX * sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL)),
+        Configure->LineBuffer,
+        Width
+        );
+    } else if (Configure->PixelFormat != PixelBlueGreenRedReserved8BitPerColor) {
       for (IndexX = 0; IndexX < Width; IndexX++) {
         Blt = (EFI_GRAPHICS_OUTPUT_BLT_PIXEL *)
           ((UINT8 *) BltBuffer + (DstY * Delta) +
@@ -505,6 +517,17 @@ FrameBufferBltLibBufferToVideo (
 
     if (Configure->PixelFormat == PixelBlueGreenRedReserved8BitPerColor) {
       Source = (UINT8 *) BltBuffer + (SrcY * Delta) + SourceX * sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL);
+    } else if (Configure->PixelFormat == PixelRedGreenBlueReserved8BitPerColor) {
+      //
+      // Convert straight into the frame buffer, which the vector kernel
+      // writes with full width stores.
+      //
+      InternalFrameBufferBltSwapRedBlue (
+        Destination,
+        (UINT8 *) BltBuffer + (SrcY * Delta) + SourceX * sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL),
+        Width
+        );
+      continue;
     } else {
       for (IndexX = 0; IndexX < Width; IndexX++) {
         Blt =
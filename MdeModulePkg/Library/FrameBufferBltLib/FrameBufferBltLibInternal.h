@@ -0,0 +1,35 @@
+/** @file
+  Internal functions of FrameBufferBltLib that have architecture specific
+  implementations.
+
+  Copyright (c) 2021, EDK II contributors. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef _FRAME_BUFFER_BLT_LIB_INTERNAL_H_
+#define _FRAME_BUFFER_BLT_LIB_INTERNAL_H_
+
+#include <Uefi/UefiBaseType.h>
+
+/**
+  Convert 32-bit pixels between the EFI_GRAPHICS_OUTPUT_BLT_PIXEL layout and
+  PixelRedGreenBlueReserved8BitPerColor by exchanging their first and third
+  bytes. The reserved byte of each converted pixel is cleared.
+
+  Source and Destination must not overlap.
+
+  @param[out] Destination  The converted pixels.
+  @param[in]  Source       The pixels to convert.
+  @param[in]  Count        The number of pixels to convert.
+
+**/
+VOID
+EFIAPI
+InternalFrameBufferBltSwapRedBlue (
+  OUT VOID        *Destination,
+  IN  CONST VOID  *Source,
+  IN  UINTN       Count
+  );
+
+#endif
@@ -0,0 +1,42 @@
+/** @file
+  Pixel conversion of FrameBufferBltLib for the architectures without a
+  vector implementation.
+
+  Copyright (c) 2021, EDK II contributors. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "FrameBufferBltLibInternal.h"
+
+/**
+  Convert 32-bit pixels between the EFI_GRAPHICS_OUTPUT_BLT_PIXEL layout and
+  PixelRedGreenBlueReserved8BitPerColor by exchanging their first and third
+  bytes. The reserved byte of each converted pixel is cleared.
+
+  Source and Destination must not overlap.
+
+  @param[out] Destination  The converted pixels.
+  @param[in]  Source       The pixels to convert.
+  @param[in]  Count        The number of pixels to convert.
+
+**/
+VOID
+EFIAPI
+InternalFrameBufferBltSwapRedBlue (
+  OUT VOID        *Destination,
+  IN  CONST VOID  *Source,
+  IN  UINTN       Count
+  )
+{
+  UINT32        *Dst;
+  CONST UINT32  *Src;
+  UINT32        Pixel;
+
+  Dst = (UINT32 *) Destination;
+  Src = (CONST UINT32 *) Source;
+  while (Count-- > 0) {
+    Pixel  = *Src++;
+    *Dst++ = ((Pixel & 0xff) << 16) | (Pixel & 0xff00) | ((Pixel >> 16) & 0xff);
+  }
+}
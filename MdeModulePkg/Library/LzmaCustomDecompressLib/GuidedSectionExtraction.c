@@ -176,7 +176,8 @@ LzmaGuidedSectionExtraction (
 
 
 /**
-  Register LzmaDecompress and LzmaDecompressGetInfo handlers with LzmaCustomerDecompressGuid.
+  Register LzmaDecompress and LzmaDecompressGetInfo handlers with LzmaCustomerDecompressGuid,
+  and the chunked variants with LzmaChunkedCustomDecompressGuid.
 
   @retval  RETURN_SUCCESS            Register successfully.
   @retval  RETURN_OUT_OF_RESOURCES   No enough memory to store this handler.
@@ -187,10 +188,21 @@ LzmaDecompressLibConstructor (
   VOID
   )
 {
+  RETURN_STATUS  Status;
+
+  Status = ExtractGuidedSectionRegisterHandlers (
+             &gLzmaCustomDecompressGuid,
+             LzmaGuidedSectionGetInfo,
+             LzmaGuidedSectionExtraction
+             );
+  if (RETURN_ERROR (Status)) {
+    return Status;
+  }
+
   return ExtractGuidedSectionRegisterHandlers (
-          &gLzmaCustomDecompressGuid,
-          LzmaGuidedSectionGetInfo,
-          LzmaGuidedSectionExtraction
-          );
+           &gLzmaChunkedCustomDecompressGuid,
+           LzmaChunkedGuidedSectionGetInfo,
+           LzmaChunkedGuidedSectionExtraction
+           );
 }
 
@@ -0,0 +1,367 @@
+/** @file
+  Decompression of LZMA streams that were split into independently
+  compressed blocks, and the GUIDed section handlers that wrap it.
+
+  Copyright (c) 2009 - 2018, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "LzmaDecompressLibInternal.h"
+#include "Sdk/C/7zTypes.h"
+#include "Sdk/C/LzmaDec.h"
+
+#define LZMA_HEADER_SIZE (LZMA_PROPS_SIZE + 8)
+
+/**
+  Parses and validates the header and block table of a chunked Lzma stream.
+
+  @param  Source      The source buffer containing the compressed data.
+  @param  SourceSize  The size, in bytes, of the source buffer.
+  @param  Context     The context to fill in.
+
+  @retval RETURN_SUCCESS            Context describes the stream.
+  @retval RETURN_INVALID_PARAMETER  The source buffer is not a valid chunked stream.
+**/
+STATIC
+RETURN_STATUS
+LzmaChunkedParse (
+  IN  CONST VOID            *Source,
+  IN  UINTN                 SourceSize,
+  OUT LZMA_CHUNKED_CONTEXT  *Context
+  )
+{
+  CONST LZMA_CHUNKED_HEADER  *Header;
+  UINT64                     TableEnd;
+  UINT32                     Index;
+  UINT32                     Start;
+  UINT32                     End;
+  UINT32                     DecodedSize;
+  UINT32                     ExpectedSize;
+  UINT32                     ScratchSize;
+  RETURN_STATUS              Status;
+
+  if (SourceSize < sizeof (LZMA_CHUNKED_HEADER) || SourceSize > MAX_UINT32) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  Header = (CONST LZMA_CHUNKED_HEADER *) Source;
+  if (Header->Signature != LZMA_CHUNKED_SIGNATURE ||
+      Header->BlockSize == 0 ||
+      Header->BlockCount == 0 ||
+      Header->BlockCount != DivU64x32 ((UINT64) Header->OriginalSize + Header->BlockSize - 1, Header->BlockSize)) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  TableEnd = sizeof (LZMA_CHUNKED_HEADER) + MultU64x32 (Header->BlockCount, sizeof (UINT32));
+  if (TableEnd > SourceSize) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  ZeroMem (Context, sizeof (*Context));
+  Context->Source       = (CONST UINT8 *) Source;
+  Context->SourceSize   = (UINT32) SourceSize;
+  Context->BlockOffset  = (CONST UINT32 *) (Header + 1);
+  Context->BlockCount   = Header->BlockCount;
+  Context->BlockSize    = Header->BlockSize;
+  Context->OriginalSize = Header->OriginalSize;
+  Context->Status       = RETURN_SUCCESS;
+
+  //
+  // Every block header is in the clear, so check that the table is ordered
+  // and that each block really decodes to the size its position implies.
+  // The workers can then write to the destination without further checks.
+  //
+  for (Index = 0; Index < Context->BlockCount; Index++) {
+    Start = Context->BlockOffset[Index];
+    End   = (Index + 1 < Context->BlockCount) ? Context->BlockOffset[Index + 1] : Context->SourceSize;
+    if (Start < TableEnd || End > Context->SourceSize || End < Start || End - Start < LZMA_HEADER_SIZE) {
+      return RETURN_INVALID_PARAMETER;
+    }
+
+    Status = LzmaUefiDecompressGetInfo (Context->Source + Start, End - Start, &DecodedSize, &ScratchSize);
+    if (RETURN_ERROR (Status)) {
+      return RETURN_INVALID_PARAMETER;
+    }
+
+    ExpectedSize = MIN (Context->BlockSize, Context->OriginalSize - Index * Context->BlockSize);
+    if (DecodedSize != ExpectedSize) {
+      return RETURN_INVALID_PARAMETER;
+    }
+
+    Context->BlockScratchSize = MAX (Context->BlockScratchSize, ScratchSize);
+  }
+
+  return RETURN_SUCCESS;
+}
+
+/**
+  Given a chunked Lzma compressed source buffer, this function retrieves the
+  size of the uncompressed buffer and the size of the scratch buffer required
+  to decompress the compressed source buffer.
+
+  Unlike LzmaUefiDecompressGetInfo(), the block table is validated in full
+  because every block header is available without a scratch buffer.
+
+  @param  Source          The source buffer containing the compressed data.
+  @param  SourceSize      The size, in bytes, of the source buffer.
+  @param  DestinationSize A pointer to the size, in bytes, of the uncompressed buffer.
+  @param  ScratchSize     A pointer to the size, in bytes, of the scratch buffer
+                          required by all the processors decoding blocks.
+
+  @retval RETURN_SUCCESS            The sizes were returned.
+  @retval RETURN_INVALID_PARAMETER  The source buffer is not a valid chunked stream.
+**/
+RETURN_STATUS
+EFIAPI
+LzmaChunkedDecompressGetInfo (
+  IN  CONST VOID  *Source,
+  IN  UINT32      SourceSize,
+  OUT UINT32      *DestinationSize,
+  OUT UINT32      *ScratchSize
+  )
+{
+  LZMA_CHUNKED_CONTEXT  Context;
+  RETURN_STATUS         Status;
+
+  Status = LzmaChunkedParse (Source, SourceSize, &Context);
+  if (RETURN_ERROR (Status)) {
+    return Status;
+  }
+
+  *DestinationSize = Context.OriginalSize;
+  *ScratchSize     = Context.BlockScratchSize * LzmaChunkedGetWorkerCount (Context.BlockCount);
+  return RETURN_SUCCESS;
+}
+
+/**
+  Decompresses a chunked Lzma compressed source buffer.
+
+  @param  Source      The source buffer containing the compressed data.
+  @param  SourceSize  The size of source buffer.
+  @param  Destination The destination buffer to store the decompressed data.
+  @param  Scratch     A scratch buffer of the size returned by LzmaChunkedDecompressGetInfo().
+
+  @retval RETURN_SUCCESS            Decompression completed successfully.
+  @retval RETURN_INVALID_PARAMETER  The source buffer is corrupted.
+**/
+RETURN_STATUS
+EFIAPI
+LzmaChunkedDecompress (
+  IN CONST VOID  *Source,
+  IN UINTN       SourceSize,
+  IN OUT VOID    *Destination,
+  IN OUT VOID    *Scratch
+  )
+{
+  LZMA_CHUNKED_CONTEXT  Context;
+  RETURN_STATUS         Status;
+
+  Status = LzmaChunkedParse (Source, SourceSize, &Context);
+  if (RETURN_ERROR (Status)) {
+    return Status;
+  }
+
+  Context.Destination = (UINT8 *) Destination;
+  Context.Scratch     = (UINT8 *) Scratch;
+  Context.WorkerCount = LzmaChunkedGetWorkerCount (Context.BlockCount);
+
+  return LzmaChunkedDecodeBlocks (&Context);
+}
+
+/**
+  Decodes a single block of a chunked Lzma stream into its place in the
+  destination buffer.
+
+  This function may run on an application processor, so it must not call
+  any service other than the decoder itself.
+
+  @param  Context     The decode context.
+  @param  BlockIndex  The index of the block to decode.
+  @param  Scratch     The scratch buffer reserved for the calling processor.
+
+  @retval RETURN_SUCCESS            The block was decoded.
+  @retval RETURN_INVALID_PARAMETER  The block is corrupted.
+**/
+RETURN_STATUS
+LzmaChunkedDecodeBlock (
+  IN LZMA_CHUNKED_CONTEXT  *Context,
+  IN UINT32                BlockIndex,
+  IN VOID                  *Scratch
+  )
+{
+  UINT32  Start;
+  UINT32  End;
+
+  Start = Context->BlockOffset[BlockIndex];
+  End   = (BlockIndex + 1 < Context->BlockCount) ? Context->BlockOffset[BlockIndex + 1] : Context->SourceSize;
+
+  return LzmaUefiDecompress (
+           Context->Source + Start,
+           End - Start,
+           Context->Destination + (UINTN) BlockIndex * Context->BlockSize,
+           Scratch
+           );
+}
+
+/**
+  Examines a GUIDed section and returns the size of the decoded buffer and the
+  size of an scratch buffer required to actually decode the data in a GUIDed section.
+
+  Examines a GUIDed section specified by InputSection.
+  If GUID for InputSection does not match the GUID that this handler supports,
+  then RETURN_UNSUPPORTED is returned.
+  If the required information can not be retrieved from InputSection,
+  then RETURN_INVALID_PARAMETER is returned.
+  If the GUID of InputSection does match the GUID that this handler supports,
+  then the size required to hold the decoded buffer is returned in OututBufferSize,
+  the size of an optional scratch buffer is returned in ScratchSize, and the Attributes field
+  from EFI_GUID_DEFINED_SECTION header of InputSection is returned in SectionAttribute.
+
+  If InputSection is NULL, then ASSERT().
+  If OutputBufferSize is NULL, then ASSERT().
+  If ScratchBufferSize is NULL, then ASSERT().
+  If SectionAttribute is NULL, then ASSERT().
+
+
+  @param[in]  InputSection       A pointer to a GUIDed section of an FFS formatted file.
+  @param[out] OutputBufferSize   A pointer to the size, in bytes, of an output buffer required
+                                 if the buffer specified by InputSection were decoded.
+  @param[out] ScratchBufferSize  A pointer to the size, in bytes, required as scratch space
+                                 if the buffer specified by InputSection were decoded.
+  @param[out] SectionAttribute   A pointer to the attributes of the GUIDed section. See the Attributes
+                                 field of EFI_GUID_DEFINED_SECTION in the PI Specification.
+
+  @retval  RETURN_SUCCESS            The information about InputSection was returned.
+  @retval  RETURN_UNSUPPORTED        The section specified by InputSection does not match the GUID this handler supports.
+  @retval  RETURN_INVALID_PARAMETER  The information can not be retrieved from the section specified by InputSection.
+
+**/
+RETURN_STATUS
+EFIAPI
+LzmaChunkedGuidedSectionGetInfo (
+  IN  CONST VOID  *InputSection,
+  OUT UINT32      *OutputBufferSize,
+  OUT UINT32      *ScratchBufferSize,
+  OUT UINT16      *SectionAttribute
+  )
+{
+  ASSERT (InputSection != NULL);
+  ASSERT (OutputBufferSize != NULL);
+  ASSERT (ScratchBufferSize != NULL);
+  ASSERT (SectionAttribute != NULL);
+
+  if (IS_SECTION2 (InputSection)) {
+    if (!CompareGuid (
+        &gLzmaChunkedCustomDecompressGuid,
+        &(((EFI_GUID_DEFINED_SECTION2 *) InputSection)->SectionDefinitionGuid))) {
+      return RETURN_INVALID_PARAMETER;
+    }
+
+    *SectionAttribute = ((EFI_GUID_DEFINED_SECTION2 *) InputSection)->Attributes;
+
+    return LzmaChunkedDecompressGetInfo (
+             (UINT8 *) InputSection + ((EFI_GUID_DEFINED_SECTION2 *) InputSection)->DataOffset,
+             SECTION2_SIZE (InputSection) - ((EFI_GUID_DEFINED_SECTION2 *) InputSection)->DataOffset,
+             OutputBufferSize,
+             ScratchBufferSize
+             );
+  } else {
+    if (!CompareGuid (
+        &gLzmaChunkedCustomDecompressGuid,
+        &(((EFI_GUID_DEFINED_SECTION *) InputSection)->SectionDefinitionGuid))) {
+      return RETURN_INVALID_PARAMETER;
+    }
+
+    *SectionAttribute = ((EFI_GUID_DEFINED_SECTION *) InputSection)->Attributes;
+
+    return LzmaChunkedDecompressGetInfo (
+             (UINT8 *) InputSection + ((EFI_GUID_DEFINED_SECTION *) InputSection)->DataOffset,
+             SECTION_SIZE (InputSection) - ((EFI_GUID_DEFINED_SECTION *) InputSection)->DataOffset,
+             OutputBufferSize,
+             ScratchBufferSize
+             );
+  }
+}
+
+/**
+  Decompress a chunked LZMA compressed GUIDed section into a caller allocated output buffer.
+
+  Decodes the GUIDed section specified by InputSection.
+  If GUID for InputSection does not match the GUID that this handler supports, then RETURN_UNSUPPORTED is returned.
+  If the data in InputSection can not be decoded, then RETURN_INVALID_PARAMETER is returned.
+  If the GUID of InputSection does match the GUID that this handler supports, then InputSection
+  is decoded into the buffer specified by OutputBuffer and the authentication status of this
+  decode operation is returned in AuthenticationStatus.
+
+  If InputSection is NULL, then ASSERT().
+  If OutputBuffer is NULL, then ASSERT().
+  If ScratchBuffer is NULL and this decode operation requires a scratch buffer, then ASSERT().
+  If AuthenticationStatus is NULL, then ASSERT().
+
+
+  @param[in]  InputSection  A pointer to a GUIDed section of an FFS formatted file.
+  @param[out] OutputBuffer  A pointer to a buffer that contains the result of a decode operation.
+  @param[out] ScratchBuffer A caller allocated buffer that may be required by this function
+                            as a scratch buffer to perform the decode operation.
+  @param[out] AuthenticationStatus
+                            A pointer to the authentication status of the decoded output buffer.
+                            See the definition of authentication status in the EFI_PEI_GUIDED_SECTION_EXTRACTION_PPI
+                            section of the PI Specification. EFI_AUTH_STATUS_PLATFORM_OVERRIDE must
+                            never be set by this handler.
+
+  @retval  RETURN_SUCCESS            The buffer specified by InputSection was decoded.
+  @retval  RETURN_UNSUPPORTED        The section specified by InputSection does not match the GUID this handler supports.
+  @retval  RETURN_INVALID_PARAMETER  The section specified by InputSection can not be decoded.
+
+**/
+RETURN_STATUS
+EFIAPI
+LzmaChunkedGuidedSectionExtraction (
+  IN CONST  VOID    *InputSection,
+  OUT       VOID    **OutputBuffer,
+  OUT       VOID    *ScratchBuffer,        OPTIONAL
+  OUT       UINT32  *AuthenticationStatus
+  )
+{
+  ASSERT (OutputBuffer != NULL);
+  ASSERT (InputSection != NULL);
+
+  if (IS_SECTION2 (InputSection)) {
+    if (!CompareGuid (
+        &gLzmaChunkedCustomDecompressGuid,
+        &(((EFI_GUID_DEFINED_SECTION2 *) InputSection)->SectionDefinitionGuid))) {
+      return RETURN_INVALID_PARAMETER;
+    }
+
+    //
+    // Authentication is set to Zero, which may be ignored.
+    //
+    *AuthenticationStatus = 0;
+
+    return LzmaChunkedDecompress (
+             (UINT8 *) InputSection + ((EFI_GUID_DEFINED_SECTION2 *) InputSection)->DataOffset,
+             SECTION2_SIZE (InputSection) - ((EFI_GUID_DEFINED_SECTION2 *) InputSection)->DataOffset,
+             *OutputBuffer,
+             ScratchBuffer
+             );
+  } else {
+    if (!CompareGuid (
+        &gLzmaChunkedCustomDecompressGuid,
+        &(((EFI_GUID_DEFINED_SECTION *) InputSection)->SectionDefinitionGuid))) {
+      return RETURN_INVALID_PARAMETER;
+    }
+
+    //
+    // Authentication is set to Zero, which may be ignored.
+    //
+    *AuthenticationStatus = 0;
+
+    return LzmaChunkedDecompress (
+             (UINT8 *) InputSection + ((EFI_GUID_DEFINED_SECTION *) InputSection)->DataOffset,
+             SECTION_SIZE (InputSection) - ((EFI_GUID_DEFINED_SECTION *) InputSection)->DataOffset,
+             *OutputBuffer,
+             ScratchBuffer
+             );
+  }
+}
@@ -0,0 +1,53 @@
+/** @file
+  Decodes the blocks of a chunked LZMA stream one after another on the
+  calling processor.
+
+  Copyright (c) 2009 - 2018, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "LzmaDecompressLibInternal.h"
+
+/**
+  Returns the number of processors that will decode the blocks of a chunked
+  Lzma stream. A scratch buffer is reserved for each of them.
+
+  @param  BlockCount  The number of blocks in the stream.
+
+  @return The number of workers, at least 1 and at most BlockCount.
+**/
+UINT32
+LzmaChunkedGetWorkerCount (
+  IN UINT32  BlockCount
+  )
+{
+  return 1;
+}
+
+/**
+  Decodes every block of a chunked Lzma stream.
+
+  @param  Context  The decode context. WorkerCount is the value that was
+                   returned by LzmaChunkedGetWorkerCount().
+
+  @retval RETURN_SUCCESS            All the blocks were decoded.
+  @retval RETURN_INVALID_PARAMETER  A block is corrupted.
+**/
+RETURN_STATUS
+LzmaChunkedDecodeBlocks (
+  IN LZMA_CHUNKED_CONTEXT  *Context
+  )
+{
+  UINT32         Index;
+  RETURN_STATUS  Status;
+
+  for (Index = 0; Index < Context->BlockCount; Index++) {
+    Status = LzmaChunkedDecodeBlock (Context, Index, Context->Scratch);
+    if (RETURN_ERROR (Status)) {
+      return Status;
+    }
+  }
+
+  return RETURN_SUCCESS;
+}
@@ -91,5 +91,160 @@ LzmaUefiDecompress (
   IN OUT VOID    *Scratch
   );
 
+///
+/// Describes one decode of an LZMA_CHUNKED_CUSTOM_DECOMPRESS_GUID buffer.
+/// It is shared by every processor that takes part in the decode.
+///
+typedef struct {
+  CONST UINT8             *Source;
+  UINT32                  SourceSize;
+  CONST UINT32            *BlockOffset;
+  UINT32                  BlockCount;
+  UINT32                  BlockSize;
+  UINT32                  OriginalSize;
+  UINT8                   *Destination;
+  UINT8                   *Scratch;
+  UINT32                  BlockScratchSize;
+  UINT32                  WorkerCount;
+  volatile UINT32         NextBlock;
+  volatile UINT32         NextWorker;
+  volatile RETURN_STATUS  Status;
+} LZMA_CHUNKED_CONTEXT;
+
+/**
+  Given a chunked Lzma compressed source buffer, this function retrieves the
+  size of the uncompressed buffer and the size of the scratch buffer required
+  to decompress the compressed source buffer.
+
+  Unlike LzmaUefiDecompressGetInfo(), the block table is validated in full
+  because every block header is available without a scratch buffer.
+
+  @param  Source          The source buffer containing the compressed data.
+  @param  SourceSize      The size, in bytes, of the source buffer.
+  @param  DestinationSize A pointer to the size, in bytes, of the uncompressed buffer.
+  @param  ScratchSize     A pointer to the size, in bytes, of the scratch buffer
+                          required by all the processors decoding blocks.
+
+  @retval RETURN_SUCCESS            The sizes were returned.
+  @retval RETURN_INVALID_PARAMETER  The source buffer is not a valid chunked stream.
+**/
+RETURN_STATUS
+EFIAPI
+LzmaChunkedDecompressGetInfo (
+  IN  CONST VOID  *Source,
+  IN  UINT32      SourceSize,
+  OUT UINT32      *DestinationSize,
+  OUT UINT32      *ScratchSize
+  );
+
+/**
+  Decompresses a chunked Lzma compressed source buffer.
+
+  @param  Source      The source buffer containing the compressed data.
+  @param  SourceSize  The size of source buffer.
+  @param  Destination The destination buffer to store the decompressed data.
+  @param  Scratch     A scratch buffer of the size returned by LzmaChunkedDecompressGetInfo().
+
+  @retval RETURN_SUCCESS            Decompression completed successfully.
+  @retval RETURN_INVALID_PARAMETER  The source buffer is corrupted.
+**/
+RETURN_STATUS
+EFIAPI
+LzmaChunkedDecompress (
+  IN CONST VOID  *Source,
+  IN UINTN       SourceSize,
+  IN OUT VOID    *Destination,
+  IN OUT VOID    *Scratch
+  );
+
+/**
+  Decodes a single block of a chunked Lzma stream into its place in the
+  destination buffer.
+
+  This function may run on an application processor, so it must not call
+  any service other than the decoder itself.
+
+  @param  Context     The decode context.
+  @param  BlockIndex  The index of the block to decode.
+  @param  Scratch     The scratch buffer reserved for the calling processor.
+
+  @retval RETURN_SUCCESS            The block was decoded.
+  @retval RETURN_INVALID_PARAMETER  The block is corrupted.
+**/
+RETURN_STATUS
+LzmaChunkedDecodeBlock (
+  IN LZMA_CHUNKED_CONTEXT  *Context,
+  IN UINT32                BlockIndex,
+  IN VOID                  *Scratch
+  );
+
+/**
+  Returns the number of processors that will decode the blocks of a chunked
+  Lzma stream. A scratch buffer is reserved for each of them.
+
+  @param  BlockCount  The number of blocks in the stream.
+
+  @return The number of workers, at least 1 and at most BlockCount.
+**/
+UINT32
+LzmaChunkedGetWorkerCount (
+  IN UINT32  BlockCount
+  );
+
+/**
+  Decodes every block of a chunked Lzma stream.
+
+  @param  Context  The decode context. WorkerCount is the value that was
+                   returned by LzmaChunkedGetWorkerCount().
+
+  @retval RETURN_SUCCESS            All the blocks were decoded.
+  @retval RETURN_INVALID_PARAMETER  A block is corrupted.
+**/
+RETURN_STATUS
+LzmaChunkedDecodeBlocks (
+  IN LZMA_CHUNKED_CONTEXT  *Context
+  );
+
+/**
+  Examines a chunked LZMA GUIDed section and returns the size of the decoded
+  buffer and the size of the scratch buffer required to decode it.
+
+  @param[in]  InputSection       A pointer to a GUIDed section of an FFS formatted file.
+  @param[out] OutputBufferSize   A pointer to the size, in bytes, of the decoded buffer.
+  @param[out] ScratchBufferSize  A pointer to the size, in bytes, of the scratch buffer.
+  @param[out] SectionAttribute   A pointer to the attributes of the GUIDed section.
+
+  @retval  RETURN_SUCCESS            The information about InputSection was returned.
+  @retval  RETURN_INVALID_PARAMETER  The information can not be retrieved from the section specified by InputSection.
+**/
+RETURN_STATUS
+EFIAPI
+LzmaChunkedGuidedSectionGetInfo (
+  IN  CONST VOID  *InputSection,
+  OUT UINT32      *OutputBufferSize,
+  OUT UINT32      *ScratchBufferSize,
+  OUT UINT16      *SectionAttribute
+  );
+
+/**
+  Decompress a chunked LZMA compressed GUIDed section into a caller allocated output buffer.
+
+  @param[in]  InputSection          A pointer to a GUIDed section of an FFS formatted file.
+  @param[out] OutputBuffer          A pointer to a buffer that contains the result of a decode operation.
+  @param[out] ScratchBuffer         A caller allocated scratch buffer.
+  @param[out] AuthenticationStatus  A pointer to the authentication status of the decoded output buffer.
+
+  @retval  RETURN_SUCCESS            The buffer specified by InputSection was decoded.
+  @retval  RETURN_INVALID_PARAMETER  The section specified by InputSection can not be decoded.
+**/
+RETURN_STATUS
+EFIAPI
+LzmaChunkedGuidedSectionExtraction (
+  IN CONST  VOID    *InputSection,
+  OUT       VOID    **OutputBuffer,
+  OUT       VOID    *ScratchBuffer,        OPTIONAL
+  OUT       UINT32  *AuthenticationStatus
+  );
+
 #endif
 
@@ -0,0 +1,158 @@
+/** @file
+  Decodes the blocks of a chunked LZMA stream on the application processors
+  through the PEI MP Services PPI, falling back to the boot processor when
+  no application processor is available.
+
+  Copyright (c) 2009 - 2018, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "LzmaDecompressLibInternal.h"
+#include <Ppi/MpServices.h>
+#include <Library/PeiServicesLib.h>
+#include <Library/PeiServicesTablePointerLib.h>
+#include <Library/SynchronizationLib.h>
+
+//
+// Each worker owns a scratch buffer for the whole decode, so cap the number
+// of workers to keep the scratch request small on large systems.
+//
+#define LZMA_CHUNKED_MAX_WORKERS  16
+
+/**
+  Returns the number of processors that will decode the blocks of a chunked
+  Lzma stream. A scratch buffer is reserved for each of them.
+
+  @param  BlockCount  The number of blocks in the stream.
+
+  @return The number of workers, at least 1 and at most BlockCount.
+**/
+UINT32
+LzmaChunkedGetWorkerCount (
+  IN UINT32  BlockCount
+  )
+{
+  EFI_STATUS               Status;
+  EFI_PEI_MP_SERVICES_PPI  *MpServices;
+  UINTN                    NumberOfProcessors;
+  UINTN                    NumberOfEnabledProcessors;
+  UINTN                    WorkerCount;
+
+  if (BlockCount <= 1) {
+    return 1;
+  }
+
+  Status = PeiServicesLocatePpi (&gEfiPeiMpServicesPpiGuid, 0, NULL, (VOID **) &MpServices);
+  if (EFI_ERROR (Status)) {
+    return 1;
+  }
+
+  Status = MpServices->GetNumberOfProcessors (
+                         GetPeiServicesTablePointer (),
+                         MpServices,
+                         &NumberOfProcessors,
+                         &NumberOfEnabledProcessors
+                         );
+  if (EFI_ERROR (Status) || NumberOfEnabledProcessors <= 1) {
+    return 1;
+  }
+
+  //
+  // StartupAllAPs() blocks the boot processor, so only the APs decode.
+  //
+  WorkerCount = MIN (NumberOfEnabledProcessors - 1, LZMA_CHUNKED_MAX_WORKERS);
+  return (UINT32) MIN (WorkerCount, BlockCount);
+}
+
+/**
+  Claims a scratch slot, then decodes blocks until none is left or one of
+  the workers has failed.
+
+  This runs on the application processors, so it only uses the decoder and
+  the interlocked primitives.
+
+  @param  Buffer  The LZMA_CHUNKED_CONTEXT of the decode.
+**/
+VOID
+EFIAPI
+LzmaChunkedWorker (
+  IN OUT VOID  *Buffer
+  )
+{
+  LZMA_CHUNKED_CONTEXT  *Context;
+  UINT32                Worker;
+  UINT32                Index;
+  UINT8                 *Scratch;
+  RETURN_STATUS         Status;
+
+  Context = (LZMA_CHUNKED_CONTEXT *) Buffer;
+
+  //
+  // More APs may be enabled than there are scratch slots.
+  //
+  Worker = InterlockedIncrement (&Context->NextWorker) - 1;
+  if (Worker >= Context->WorkerCount) {
+    return;
+  }
+
+  Scratch = Context->Scratch + (UINTN) Worker * Context->BlockScratchSize;
+  while (!RETURN_ERROR (Context->Status)) {
+    Index = InterlockedIncrement (&Context->NextBlock) - 1;
+    if (Index >= Context->BlockCount) {
+      break;
+    }
+
+    Status = LzmaChunkedDecodeBlock (Context, Index, Scratch);
+    if (RETURN_ERROR (Status)) {
+      Context->Status = Status;
+    }
+  }
+}
+
+/**
+  Decodes every block of a chunked Lzma stream.
+
+  @param  Context  The decode context. WorkerCount is the value that was
+                   returned by LzmaChunkedGetWorkerCount().
+
+  @retval RETURN_SUCCESS            All the blocks were decoded.
+  @retval RETURN_INVALID_PARAMETER  A block is corrupted.
+**/
+RETURN_STATUS
+LzmaChunkedDecodeBlocks (
+  IN LZMA_CHUNKED_CONTEXT  *Context
+  )
+{
+  EFI_STATUS               Status;
+  EFI_PEI_MP_SERVICES_PPI  *MpServices;
+
+  if (Context->WorkerCount > 1) {
+    Status = PeiServicesLocatePpi (&gEfiPeiMpServicesPpiGuid, 0, NULL, (VOID **) &MpServices);
+    if (!EFI_ERROR (Status)) {
+      Status = MpServices->StartupAllAPs (
+                             GetPeiServicesTablePointer (),
+                             MpServices,
+                             LzmaChunkedWorker,
+                             FALSE,
+                             0,
+                             Context
+                             );
+    }
+
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_INFO, "LzmaChunked: APs not available (%r), decoding on BSP\n", Status));
+    }
+  }
+
+  //
+  // The blocking StartupAllAPs() has returned, so every AP is idle again and
+  // the BSP can take over slot 0 for whatever blocks are left.
+  //
+  if (!RETURN_ERROR (Context->Status) && Context->NextBlock < Context->BlockCount) {
+    Context->NextWorker = 0;
+    LzmaChunkedWorker (Context);
+  }
+
+  return Context->Status;
+}
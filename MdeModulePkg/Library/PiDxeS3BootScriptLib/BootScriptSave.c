@@ -171,6 +171,157 @@ S3BootScriptInternalCloseTable (
   //
 }
 
+/**
+  Check whether a boot script entry can be appended to the preceding write
+  entry, so that both are executed as a single opcode.
+
+  Only MMIO and PCI configuration writes with a non FIFO/FILL width qualify,
+  and the second entry must continue exactly where the first one stops.
+
+  @param Last   The preceding write entry.
+  @param Entry  The entry that follows Last in the table.
+
+  @retval TRUE   Entry can be merged into Last.
+  @retval FALSE  Entry must be kept as a separate opcode.
+**/
+BOOLEAN
+S3BootScriptCanMergeWrite (
+  IN EFI_BOOT_SCRIPT_PCI_CONFIG2_WRITE  *Last,
+  IN EFI_BOOT_SCRIPT_PCI_CONFIG2_WRITE  *Entry
+  )
+{
+  UINT8     WidthInByte;
+  UINT16    Segment;
+
+  if (Entry->OpCode != Last->OpCode || Entry->Width != Last->Width) {
+    return FALSE;
+  }
+
+  WidthInByte = (UINT8) (0x01 << (Entry->Width & 0x03));
+  if (Last->Length + WidthInByte * Entry->Count > MAX_UINT8) {
+    return FALSE;
+  }
+
+  switch (Entry->OpCode) {
+  case EFI_BOOT_SCRIPT_MEM_WRITE_OPCODE:
+    if (Entry->Width > S3BootScriptWidthUint64) {
+      return FALSE;
+    }
+    return (BOOLEAN) (Last->Address + MultU64x32 (Last->Count, WidthInByte) == Entry->Address);
+
+  case EFI_BOOT_SCRIPT_PCI_CONFIG_WRITE_OPCODE:
+  case EFI_BOOT_SCRIPT_PCI_CONFIG2_WRITE_OPCODE:
+    if (Entry->Width > S3BootScriptWidthUint32) {
+      return FALSE;
+    }
+    Segment = 0;
+    if (Entry->OpCode == EFI_BOOT_SCRIPT_PCI_CONFIG2_WRITE_OPCODE) {
+      if (Entry->Segment != Last->Segment) {
+        return FALSE;
+      }
+      Segment = Entry->Segment;
+    }
+    //
+    // The interpreter steps through the encoded PCI Segment Library address.
+    //
+    return (BOOLEAN) (PCI_ADDRESS_ENCODE (Segment, Last->Address) + Last->Count * WidthInByte ==
+                      PCI_ADDRESS_ENCODE (Segment, Entry->Address));
+
+  default:
+    return FALSE;
+  }
+}
+
+/**
+  Merge adjacent MMIO and PCI configuration write opcodes of the boot script
+  that continue each other into single opcodes.
+
+  The merged opcodes perform the very same accesses in the very same order,
+  but S3 resume has fewer opcodes to dispatch. This is done only once, right
+  before the boot time table is locked, because it moves entries around:
+  nothing may refer to an entry by address at that point anymore.
+
+**/
+VOID
+S3BootScriptMergeWrites (
+  VOID
+  )
+{
+  UINT8                              *TableBase;
+  UINT32                             ReadOffset;
+  UINT32                             WriteOffset;
+  UINT32                             LastOffset;
+  UINT32                             HeaderSize;
+  UINT32                             DataSize;
+  EFI_BOOT_SCRIPT_GENERIC_HEADER     Header;
+  EFI_BOOT_SCRIPT_PCI_CONFIG2_WRITE  Last;
+  EFI_BOOT_SCRIPT_PCI_CONFIG2_WRITE  Entry;
+
+  TableBase = mS3BootScriptTablePtr->TableBase;
+  if (TableBase == NULL) {
+    return;
+  }
+
+  ZeroMem (&Last, sizeof (Last));
+  ZeroMem (&Entry, sizeof (Entry));
+  ReadOffset  = sizeof (EFI_BOOT_SCRIPT_TABLE_HEADER);
+  WriteOffset = ReadOffset;
+  LastOffset  = 0;
+  while (ReadOffset < mS3BootScriptTablePtr->TableLength) {
+    CopyMem (&Header, TableBase + ReadOffset, sizeof (Header));
+    if (Header.Length == 0) {
+      ASSERT (Header.Length != 0);
+      return;
+    }
+
+    switch (Header.OpCode) {
+    case EFI_BOOT_SCRIPT_MEM_WRITE_OPCODE:
+    case EFI_BOOT_SCRIPT_PCI_CONFIG_WRITE_OPCODE:
+      HeaderSize = sizeof (EFI_BOOT_SCRIPT_MEM_WRITE);
+      break;
+    case EFI_BOOT_SCRIPT_PCI_CONFIG2_WRITE_OPCODE:
+      HeaderSize = sizeof (EFI_BOOT_SCRIPT_PCI_CONFIG2_WRITE);
+      break;
+    default:
+      HeaderSize = 0;
+      break;
+    }
+
+    if (HeaderSize != 0) {
+      CopyMem (&Entry, TableBase + ReadOffset, HeaderSize);
+    }
+
+    if (HeaderSize != 0 && LastOffset != 0 && S3BootScriptCanMergeWrite (&Last, &Entry)) {
+      //
+      // Append the data of this entry to the previous one, which ends at
+      // WriteOffset.
+      //
+      DataSize = Header.Length - HeaderSize;
+      CopyMem (TableBase + WriteOffset, TableBase + ReadOffset + HeaderSize, DataSize);
+      Last.Count  += Entry.Count;
+      Last.Length  = (UINT8) (Last.Length + DataSize);
+      CopyMem (TableBase + LastOffset, &Last, HeaderSize);
+      WriteOffset += DataSize;
+    } else {
+      if (WriteOffset != ReadOffset) {
+        CopyMem (TableBase + WriteOffset, TableBase + ReadOffset, Header.Length);
+      }
+      LastOffset = 0;
+      if (HeaderSize != 0) {
+        CopyMem (&Last, &Entry, sizeof (Last));
+        LastOffset = WriteOffset;
+      }
+      WriteOffset += Header.Length;
+    }
+    ReadOffset += Header.Length;
+  }
+
+  if (WriteOffset != mS3BootScriptTablePtr->TableLength) {
+    DEBUG ((DEBUG_INFO, "%a: boot script shrunk from 0x%x to 0x%x bytes\n", __FUNCTION__, mS3BootScriptTablePtr->TableLength, WriteOffset));
+    mS3BootScriptTablePtr->TableLength = WriteOffset;
+  }
+}
+
 /**
   This function save boot script data to LockBox.
 
@@ -251,6 +402,7 @@ S3BootScriptEventCallBack (
     // or else, that will impact the performance. However, after SmmReadyToLock, we should append terminate
     // node on every add to boot script table.
     //
+    S3BootScriptMergeWrites ();
     S3BootScriptInternalCloseTable ();
     mS3BootScriptTablePtr->SmmLocked = TRUE;
 
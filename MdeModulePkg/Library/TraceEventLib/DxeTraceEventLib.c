@@ -0,0 +1,194 @@
+/** @file
+  DXE instance of the trace event library.
+
+  The first module that uses this instance allocates the trace event buffer
+  in reserved memory, appends the events recorded during PEI and installs the
+  buffer as an EFI configuration table for consumption by the OS. Later
+  modules find it through the configuration table. Events are dropped after
+  ExitBootServices(), as the buffer is not mapped for runtime use.
+
+  Copyright (c) 2021, EDK II contributors. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <PiDxe.h>
+
+#include <Library/HobLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/PcdLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Library/UefiLib.h>
+
+#include "TraceEventLibInternal.h"
+
+TRACE_EVENT_BUFFER_HEADER  *mTraceEventBuffer;
+UINT32                     mTraceEventRingCount;
+UINT32                     mTraceEventRingEntries;
+EFI_EVENT                  mTraceEventExitBootServicesEvent;
+
+/**
+  Allocate the trace event buffer, import the PEI events and install it as
+  a configuration table.
+
+  @return The trace event buffer, or NULL if it could not be created.
+**/
+STATIC
+TRACE_EVENT_BUFFER_HEADER *
+DxeTraceEventCreateBuffer (
+  VOID
+  )
+{
+  TRACE_EVENT_BUFFER_HEADER  *Buffer;
+  EFI_HOB_GUID_TYPE          *GuidHob;
+  UINT32                     RingCount;
+  UINT32                     RingEntries;
+  UINTN                      Pages;
+  EFI_STATUS                 Status;
+
+  RingCount   = GetPowerOfTwo32 (PcdGet32 (PcdTraceEventRingCount));
+  RingEntries = GetPowerOfTwo32 (PcdGet32 (PcdTraceEventRingEntries));
+  if ((RingCount == 0) || (RingEntries == 0)) {
+    return NULL;
+  }
+
+  Pages  = EFI_SIZE_TO_PAGES (TRACE_EVENT_BUFFER_SIZE (RingCount, RingEntries));
+  Buffer = AllocateReservedPages (Pages);
+  if (Buffer == NULL) {
+    return NULL;
+  }
+
+  TraceEventInitializeBuffer (Buffer, RingCount, RingEntries);
+
+  GuidHob = GetFirstGuidHob (&gEdkiiTraceEventRingGuid);
+  if (GuidHob != NULL) {
+    TraceEventImportBuffer (
+      Buffer,
+      RingCount,
+      RingEntries,
+      GET_GUID_HOB_DATA (GuidHob),
+      GET_GUID_HOB_DATA_SIZE (GuidHob)
+      );
+  }
+
+  Status = gBS->InstallConfigurationTable (&gEdkiiTraceEventRingGuid, Buffer);
+  if (EFI_ERROR (Status)) {
+    FreePages (Buffer, Pages);
+    return NULL;
+  }
+
+  return Buffer;
+}
+
+/**
+  Stop writing to the trace event buffer once boot services are gone.
+
+  @param[in]  Event     The ExitBootServices event.
+  @param[in]  Context   Unused.
+**/
+STATIC
+VOID
+EFIAPI
+DxeTraceEventExitBootServices (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  mTraceEventBuffer = NULL;
+}
+
+/**
+  Find or create the trace event buffer.
+
+  @param[in]  ImageHandle   The firmware allocated handle for the EFI image.
+  @param[in]  SystemTable   A pointer to the EFI System Table.
+
+  @retval EFI_SUCCESS       The constructor always returns EFI_SUCCESS; events
+                            are dropped if there is no buffer.
+**/
+EFI_STATUS
+EFIAPI
+DxeTraceEventLibConstructor (
+  IN EFI_HANDLE        ImageHandle,
+  IN EFI_SYSTEM_TABLE  *SystemTable
+  )
+{
+  TRACE_EVENT_BUFFER_HEADER  *Buffer;
+  EFI_STATUS                 Status;
+
+  Status = EfiGetSystemConfigurationTable (&gEdkiiTraceEventRingGuid, (VOID **)&Buffer);
+  if (EFI_ERROR (Status)) {
+    Buffer = DxeTraceEventCreateBuffer ();
+  }
+
+  if ((Buffer == NULL) || (Buffer->Signature != TRACE_EVENT_BUFFER_SIGNATURE) ||
+      (Buffer->RecordSize != sizeof (TRACE_EVENT_RECORD)))
+  {
+    return EFI_SUCCESS;
+  }
+
+  Status = gBS->CreateEvent (
+                  EVT_SIGNAL_EXIT_BOOT_SERVICES,
+                  TPL_NOTIFY,
+                  DxeTraceEventExitBootServices,
+                  NULL,
+                  &mTraceEventExitBootServicesEvent
+                  );
+  if (EFI_ERROR (Status)) {
+    return EFI_SUCCESS;
+  }
+
+  mTraceEventRingCount   = Buffer->RingCount;
+  mTraceEventRingEntries = Buffer->RingEntries;
+  mTraceEventBuffer      = Buffer;
+  return EFI_SUCCESS;
+}
+
+/**
+  Close the ExitBootServices event when the image is unloaded.
+
+  @param[in]  ImageHandle   The firmware allocated handle for the EFI image.
+  @param[in]  SystemTable   A pointer to the EFI System Table.
+
+  @retval EFI_SUCCESS       The destructor always returns EFI_SUCCESS.
+**/
+EFI_STATUS
+EFIAPI
+DxeTraceEventLibDestructor (
+  IN EFI_HANDLE        ImageHandle,
+  IN EFI_SYSTEM_TABLE  *SystemTable
+  )
+{
+  mTraceEventBuffer = NULL;
+  if (mTraceEventExitBootServicesEvent != NULL) {
+    gBS->CloseEvent (mTraceEventExitBootServicesEvent);
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Write a trace event.
+
+  The event is dropped if the trace buffer is not available in the current
+  phase.
+
+  @param[in]  Id      The event ID.
+  @param[in]  Data0   The first payload word.
+  @param[in]  Data1   The second payload word.
+**/
+VOID
+EFIAPI
+TraceEventWrite (
+  IN UINT32  Id,
+  IN UINT64  Data0,
+  IN UINT64  Data1
+  )
+{
+  TRACE_EVENT_BUFFER_HEADER  *Buffer;
+
+  Buffer = mTraceEventBuffer;
+  if (Buffer != NULL) {
+    TraceEventWriteRecord (Buffer, mTraceEventRingCount, mTraceEventRingEntries, Id, Data0, Data1);
+  }
+}
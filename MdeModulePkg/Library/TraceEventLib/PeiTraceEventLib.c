@@ -0,0 +1,87 @@
+/** @file
+  PEI instance of the trace event library.
+
+  The trace event buffer is kept in a GUIDed HOB with a single ring, so that
+  it moves with the HOB list when permanent memory is installed and is handed
+  to DXE with the rest of the HOBs. PEIMs cannot keep a pointer to it in a
+  global variable, so each event looks the HOB up again.
+
+  Copyright (c) 2021, EDK II contributors. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <PiPei.h>
+
+#include <Library/HobLib.h>
+#include <Library/PcdLib.h>
+
+#include "TraceEventLibInternal.h"
+
+/**
+  Return the trace event buffer HOB data, creating it if needed.
+
+  @return The trace event buffer, or NULL if it could not be created.
+**/
+STATIC
+TRACE_EVENT_BUFFER_HEADER *
+PeiTraceEventGetBuffer (
+  VOID
+  )
+{
+  EFI_HOB_GUID_TYPE          *GuidHob;
+  TRACE_EVENT_BUFFER_HEADER  *Buffer;
+  UINT32                     RingEntries;
+  UINTN                      Size;
+
+  GuidHob = GetFirstGuidHob (&gEdkiiTraceEventRingGuid);
+  if (GuidHob != NULL) {
+    return GET_GUID_HOB_DATA (GuidHob);
+  }
+
+  RingEntries = GetPowerOfTwo32 (PcdGet32 (PcdTraceEventPeiRingEntries));
+  if (RingEntries == 0) {
+    return NULL;
+  }
+
+  //
+  // A GUIDed HOB is limited to 64KB. Shrink the ring until it fits.
+  //
+  while (TRACE_EVENT_BUFFER_SIZE (1, RingEntries) > 0xFFF8 - sizeof (EFI_HOB_GUID_TYPE)) {
+    RingEntries >>= 1;
+  }
+
+  Size   = TRACE_EVENT_BUFFER_SIZE (1, RingEntries);
+  Buffer = BuildGuidHob (&gEdkiiTraceEventRingGuid, Size);
+  if (Buffer != NULL) {
+    TraceEventInitializeBuffer (Buffer, 1, RingEntries);
+  }
+
+  return Buffer;
+}
+
+/**
+  Write a trace event.
+
+  The event is dropped if the trace buffer is not available in the current
+  phase.
+
+  @param[in]  Id      The event ID.
+  @param[in]  Data0   The first payload word.
+  @param[in]  Data1   The second payload word.
+**/
+VOID
+EFIAPI
+TraceEventWrite (
+  IN UINT32  Id,
+  IN UINT64  Data0,
+  IN UINT64  Data1
+  )
+{
+  TRACE_EVENT_BUFFER_HEADER  *Buffer;
+
+  Buffer = PeiTraceEventGetBuffer ();
+  if (Buffer != NULL) {
+    TraceEventWriteRecord (Buffer, Buffer->RingCount, Buffer->RingEntries, Id, Data0, Data1);
+  }
+}
@@ -0,0 +1,96 @@
+/** @file
+  SMM instance of the trace event library.
+
+  SMM drivers write to the trace event buffer that a DXE driver published as
+  an EFI configuration table; if there is none when the driver is loaded, its
+  events are dropped. The buffer lies outside SMRAM and may be modified by
+  other software, so the ring geometry is captured in SMRAM when the driver
+  is loaded and only the ring heads are read from the buffer afterwards.
+
+  Copyright (c) 2021, EDK II contributors. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <PiSmm.h>
+
+#include <Library/SmmMemLib.h>
+#include <Library/UefiLib.h>
+
+#include "TraceEventLibInternal.h"
+
+TRACE_EVENT_BUFFER_HEADER  *mTraceEventBuffer;
+UINT32                     mTraceEventRingCount;
+UINT32                     mTraceEventRingEntries;
+
+/**
+  Find the trace event buffer.
+
+  @param[in]  ImageHandle   The firmware allocated handle for the EFI image.
+  @param[in]  SystemTable   A pointer to the EFI System Table.
+
+  @retval EFI_SUCCESS       The constructor always returns EFI_SUCCESS; events
+                            are dropped if there is no buffer.
+**/
+EFI_STATUS
+EFIAPI
+SmmTraceEventLibConstructor (
+  IN EFI_HANDLE        ImageHandle,
+  IN EFI_SYSTEM_TABLE  *SystemTable
+  )
+{
+  TRACE_EVENT_BUFFER_HEADER  *Buffer;
+  UINT32                     RingCount;
+  UINT32                     RingEntries;
+  EFI_STATUS                 Status;
+
+  Status = EfiGetSystemConfigurationTable (&gEdkiiTraceEventRingGuid, (VOID **)&Buffer);
+  if (EFI_ERROR (Status) || (Buffer == NULL) ||
+      !SmmIsBufferOutsideSmmValid ((EFI_PHYSICAL_ADDRESS)(UINTN)Buffer, sizeof (TRACE_EVENT_BUFFER_HEADER)))
+  {
+    return EFI_SUCCESS;
+  }
+
+  RingCount   = Buffer->RingCount;
+  RingEntries = Buffer->RingEntries;
+  if ((Buffer->Signature != TRACE_EVENT_BUFFER_SIGNATURE) ||
+      (Buffer->RecordSize != sizeof (TRACE_EVENT_RECORD)) ||
+      (RingCount == 0) || ((RingCount & (RingCount - 1)) != 0) ||
+      (RingEntries == 0) || ((RingEntries & (RingEntries - 1)) != 0) ||
+      (RingCount > 256) || (RingEntries > SIZE_64KB) ||
+      !SmmIsBufferOutsideSmmValid ((EFI_PHYSICAL_ADDRESS)(UINTN)Buffer, TRACE_EVENT_BUFFER_SIZE (RingCount, RingEntries)))
+  {
+    return EFI_SUCCESS;
+  }
+
+  mTraceEventRingCount   = RingCount;
+  mTraceEventRingEntries = RingEntries;
+  mTraceEventBuffer      = Buffer;
+  return EFI_SUCCESS;
+}
+
+/**
+  Write a trace event.
+
+  The event is dropped if the trace buffer is not available in the current
+  phase.
+
+  @param[in]  Id      The event ID.
+  @param[in]  Data0   The first payload word.
+  @param[in]  Data1   The second payload word.
+**/
+VOID
+EFIAPI
+TraceEventWrite (
+  IN UINT32  Id,
+  IN UINT64  Data0,
+  IN UINT64  Data1
+  )
+{
+  TRACE_EVENT_BUFFER_HEADER  *Buffer;
+
+  Buffer = mTraceEventBuffer;
+  if (Buffer != NULL) {
+    TraceEventWriteRecord (Buffer, mTraceEventRingCount, mTraceEventRingEntries, Id, Data0, Data1);
+  }
+}
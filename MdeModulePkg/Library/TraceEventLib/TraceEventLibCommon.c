@@ -0,0 +1,171 @@
+/** @file
+  Trace event ring buffer functions shared by the library instances.
+
+  Copyright (c) 2021, EDK II contributors. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "TraceEventLibInternal.h"
+
+/**
+  Initialize an empty trace event buffer.
+
+  @param[out] Buffer        The buffer, TRACE_EVENT_BUFFER_SIZE (RingCount,
+                            RingEntries) bytes in size.
+  @param[in]  RingCount     The number of rings, a power of two.
+  @param[in]  RingEntries   The number of records per ring, a power of two.
+**/
+VOID
+TraceEventInitializeBuffer (
+  OUT TRACE_EVENT_BUFFER_HEADER  *Buffer,
+  IN  UINT32                     RingCount,
+  IN  UINT32                     RingEntries
+  )
+{
+  ASSERT (RingCount != 0 && (RingCount & (RingCount - 1)) == 0);
+  ASSERT (RingEntries != 0 && (RingEntries & (RingEntries - 1)) == 0);
+
+  ZeroMem (Buffer, TRACE_EVENT_BUFFER_SIZE (RingCount, RingEntries));
+  Buffer->Signature   = TRACE_EVENT_BUFFER_SIGNATURE;
+  Buffer->Version     = TRACE_EVENT_BUFFER_VERSION;
+  Buffer->RecordSize  = sizeof (TRACE_EVENT_RECORD);
+  Buffer->RingCount   = RingCount;
+  Buffer->RingEntries = RingEntries;
+#if defined (MDE_CPU_IA32) || defined (MDE_CPU_X64)
+  Buffer->TimestampFrequency = 0;
+#else
+  Buffer->TimestampFrequency = GetPerformanceCounterProperties (NULL, NULL);
+#endif
+}
+
+/**
+  Claim the next slot of a ring.
+
+  @param[in]  Buffer        The trace event buffer.
+  @param[in]  RingCount     The number of rings in Buffer.
+  @param[in]  RingEntries   The number of records per ring in Buffer.
+  @param[in]  Ring          The ring, less than RingCount.
+
+  @return The record to fill in.
+**/
+STATIC
+TRACE_EVENT_RECORD *
+TraceEventClaimRecord (
+  IN TRACE_EVENT_BUFFER_HEADER  *Buffer,
+  IN UINT32                     RingCount,
+  IN UINT32                     RingEntries,
+  IN UINT32                     Ring
+  )
+{
+  TRACE_EVENT_RING_HEADER  *RingHeader;
+  TRACE_EVENT_RECORD       *Records;
+  UINT32                   Head;
+
+  RingHeader = TRACE_EVENT_RING (Buffer, Ring);
+  Records    = (TRACE_EVENT_RECORD *)TRACE_EVENT_RING (Buffer, RingCount);
+  Head       = InterlockedIncrement (&RingHeader->Head) - 1;
+
+  return &Records[(UINTN)Ring * RingEntries + (Head & (RingEntries - 1))];
+}
+
+/**
+  Write a record to the ring of the executing processor.
+
+  RingCount and RingEntries are passed by the caller rather than read from the
+  buffer so that a buffer header modified by other software cannot redirect
+  the write outside of the buffer.
+
+  @param[in]  Buffer        The trace event buffer.
+  @param[in]  RingCount     The number of rings in Buffer.
+  @param[in]  RingEntries   The number of records per ring in Buffer.
+  @param[in]  Id            The event ID.
+  @param[in]  Data0         The first payload word.
+  @param[in]  Data1         The second payload word.
+**/
+VOID
+TraceEventWriteRecord (
+  IN TRACE_EVENT_BUFFER_HEADER  *Buffer,
+  IN UINT32                     RingCount,
+  IN UINT32                     RingEntries,
+  IN UINT32                     Id,
+  IN UINT64                     Data0,
+  IN UINT64                     Data1
+  )
+{
+  TRACE_EVENT_RECORD  *Record;
+  UINT64              Timestamp;
+  UINT32              Cpu;
+
+#if defined (MDE_CPU_IA32) || defined (MDE_CPU_X64)
+  UINT32  RegEbx;
+
+  Timestamp = AsmReadTsc ();
+  AsmCpuid (1, NULL, &RegEbx, NULL, NULL);
+  Cpu = RegEbx >> 24;
+#else
+  Timestamp = GetPerformanceCounter ();
+  Cpu       = 0;
+#endif
+
+  Record = TraceEventClaimRecord (Buffer, RingCount, RingEntries, Cpu & (RingCount - 1));
+  Record->Timestamp = Timestamp;
+  Record->Id        = Id;
+  Record->Cpu       = Cpu;
+  Record->Data[0]   = Data0;
+  Record->Data[1]   = Data1;
+}
+
+/**
+  Append the records of another trace event buffer, oldest first, keeping
+  their timestamps. Ring N of Source goes to ring N modulo RingCount of
+  Buffer.
+
+  @param[in]  Buffer        The trace event buffer to append to.
+  @param[in]  RingCount     The number of rings in Buffer.
+  @param[in]  RingEntries   The number of records per ring in Buffer.
+  @param[in]  Source        The trace event buffer to copy from.
+  @param[in]  SourceSize    The size of Source in bytes.
+**/
+VOID
+TraceEventImportBuffer (
+  IN TRACE_EVENT_BUFFER_HEADER        *Buffer,
+  IN UINT32                           RingCount,
+  IN UINT32                           RingEntries,
+  IN CONST TRACE_EVENT_BUFFER_HEADER  *Source,
+  IN UINTN                            SourceSize
+  )
+{
+  CONST TRACE_EVENT_RECORD  *Records;
+  UINT32                    SourceEntries;
+  UINT32                    Ring;
+  UINT32                    Head;
+  UINT32                    Count;
+  UINT32                    Index;
+
+  if ((SourceSize < sizeof (TRACE_EVENT_BUFFER_HEADER)) ||
+      (Source->Signature != TRACE_EVENT_BUFFER_SIGNATURE) ||
+      (Source->RecordSize != sizeof (TRACE_EVENT_RECORD)) ||
+      (Source->RingCount == 0) || (Source->RingEntries == 0) ||
+      ((Source->RingEntries & (Source->RingEntries - 1)) != 0) ||
+      (Source->RingEntries > SourceSize / sizeof (TRACE_EVENT_RECORD)) ||
+      (Source->RingCount > (SourceSize - sizeof (TRACE_EVENT_BUFFER_HEADER)) /
+                           (sizeof (TRACE_EVENT_RING_HEADER) + Source->RingEntries * sizeof (TRACE_EVENT_RECORD))))
+  {
+    return;
+  }
+
+  SourceEntries = Source->RingEntries;
+  for (Ring = 0; Ring < Source->RingCount; Ring++) {
+    Head    = TRACE_EVENT_RING (Source, Ring)->Head;
+    Count   = MIN (Head, SourceEntries);
+    Records = TRACE_EVENT_RING_RECORDS (Source, Ring);
+    for (Index = Head - Count; Index != Head; Index++) {
+      CopyMem (
+        TraceEventClaimRecord (Buffer, RingCount, RingEntries, Ring & (RingCount - 1)),
+        &Records[Index & (SourceEntries - 1)],
+        sizeof (TRACE_EVENT_RECORD)
+        );
+    }
+  }
+}
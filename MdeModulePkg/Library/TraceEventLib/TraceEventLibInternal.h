@@ -0,0 +1,82 @@
+/** @file
+  Internal definitions shared by the trace event library instances.
+
+  Copyright (c) 2021, EDK II contributors. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef _TRACE_EVENT_LIB_INTERNAL_H_
+#define _TRACE_EVENT_LIB_INTERNAL_H_
+
+#include <Uefi.h>
+
+#include <Guid/TraceEventRing.h>
+
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/SynchronizationLib.h>
+#include <Library/TimerLib.h>
+#include <Library/TraceEventLib.h>
+
+/**
+  Initialize an empty trace event buffer.
+
+  @param[out] Buffer        The buffer, TRACE_EVENT_BUFFER_SIZE (RingCount,
+                            RingEntries) bytes in size.
+  @param[in]  RingCount     The number of rings, a power of two.
+  @param[in]  RingEntries   The number of records per ring, a power of two.
+**/
+VOID
+TraceEventInitializeBuffer (
+  OUT TRACE_EVENT_BUFFER_HEADER  *Buffer,
+  IN  UINT32                     RingCount,
+  IN  UINT32                     RingEntries
+  );
+
+/**
+  Write a record to the ring of the executing processor.
+
+  RingCount and RingEntries are passed by the caller rather than read from the
+  buffer so that a buffer header modified by other software cannot redirect
+  the write outside of the buffer.
+
+  @param[in]  Buffer        The trace event buffer.
+  @param[in]  RingCount     The number of rings in Buffer.
+  @param[in]  RingEntries   The number of records per ring in Buffer.
+  @param[in]  Id            The event ID.
+  @param[in]  Data0         The first payload word.
+  @param[in]  Data1         The second payload word.
+**/
+VOID
+TraceEventWriteRecord (
+  IN TRACE_EVENT_BUFFER_HEADER  *Buffer,
+  IN UINT32                     RingCount,
+  IN UINT32                     RingEntries,
+  IN UINT32                     Id,
+  IN UINT64                     Data0,
+  IN UINT64                     Data1
+  );
+
+/**
+  Append the records of another trace event buffer, oldest first, keeping
+  their timestamps. Ring N of Source goes to ring N modulo RingCount of
+  Buffer.
+
+  @param[in]  Buffer        The trace event buffer to append to.
+  @param[in]  RingCount     The number of rings in Buffer.
+  @param[in]  RingEntries   The number of records per ring in Buffer.
+  @param[in]  Source        The trace event buffer to copy from.
+  @param[in]  SourceSize    The size of Source in bytes.
+**/
+VOID
+TraceEventImportBuffer (
+  IN TRACE_EVENT_BUFFER_HEADER        *Buffer,
+  IN UINT32                           RingCount,
+  IN UINT32                           RingEntries,
+  IN CONST TRACE_EVENT_BUFFER_HEADER  *Source,
+  IN UINTN                            SourceSize
+  );
+
+#endif
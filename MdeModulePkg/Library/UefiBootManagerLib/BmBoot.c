@@ -1774,6 +1774,7 @@ EfiBootManagerBoot (
   UINTN                     OptionNumber;
   UINTN                     OriginalOptionNumber;
   EFI_DEVICE_PATH_PROTOCOL  *FilePath;
+  EFI_DEVICE_PATH_PROTOCOL  *HintPath;
   EFI_DEVICE_PATH_PROTOCOL  *RamDiskDevicePath;
   VOID                      *FileBuffer;
   UINTN                     FileSize;
@@ -1868,10 +1869,25 @@ EfiBootManagerBoot (
   ImageHandle       = NULL;
   RamDiskDevicePath = NULL;
   if (DevicePathType (BootOption->FilePath) != BBS_DEVICE_PATH) {
-    Status   = EFI_NOT_FOUND;
-    FilePath = NULL;
-    EfiBootManagerConnectDevicePath (BootOption->FilePath, NULL);
-    FileBuffer = BmGetNextLoadOptionBuffer (LoadOptionTypeBoot, BootOption->FilePath, &FilePath, &FileSize);
+    Status     = EFI_NOT_FOUND;
+    FilePath   = NULL;
+    FileBuffer = NULL;
+
+    //
+    // Try the full path the option was loaded from on the previous boot first,
+    // so that expanding a short-form device path doesn't connect all the
+    // controllers. Fall back to the expansion if the loader isn't there.
+    //
+    HintPath = BmGetBootHintFullPath (BootOption);
+    if (HintPath != NULL) {
+      FileBuffer = BmGetNextLoadOptionBuffer (LoadOptionTypeBoot, HintPath, &FilePath, &FileSize);
+      FreePool (HintPath);
+    }
+
+    if (FileBuffer == NULL) {
+      EfiBootManagerConnectDevicePath (BootOption->FilePath, NULL);
+      FileBuffer = BmGetNextLoadOptionBuffer (LoadOptionTypeBoot, BootOption->FilePath, &FilePath, &FileSize);
+    }
     if (FileBuffer != NULL) {
       RamDiskDevicePath = BmGetRamDiskDevicePath (FilePath);
 
@@ -1884,6 +1900,14 @@ EfiBootManagerBoot (
                       FileSize,
                       &ImageHandle
                       );
+      //
+      // A device path through a RAM disk created for this boot cannot be
+      // connected on the next boot.
+      //
+      if (!EFI_ERROR (Status) && (RamDiskDevicePath == NULL) &&
+          (BootOption->OptionNumber != LoadOptionNumberUnassigned)) {
+        BmSaveBootHint ((UINT16) BootOption->OptionNumber, FilePath);
+      }
     }
     if (FileBuffer != NULL) {
       FreePool (FileBuffer);
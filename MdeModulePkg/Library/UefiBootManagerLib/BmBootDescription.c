@@ -18,6 +18,7 @@ CONST UINT16 mBmUsbLangId    = 0x0409; // English
 CHAR16       mBmUefiPrefix[] = L"UEFI ";
 
 LIST_ENTRY mPlatformBootDescriptionHandlers = INITIALIZE_LIST_HEAD_VARIABLE (mPlatformBootDescriptionHandlers);
+LIST_ENTRY mBmBootDescriptionCache          = INITIALIZE_LIST_HEAD_VARIABLE (mBmBootDescriptionCache);
 
 /**
   For a bootable Device path, return its boot type.
@@ -755,6 +756,93 @@ BM_GET_BOOT_DESCRIPTION mBmBootDescriptionHandlers[] = {
   BmGetMiscDescription
 };
 
+/**
+  Return the core provided boot description cached for the controller.
+
+  The entry is only used while the controller handle still carries the same
+  device path instance, so a handle that was freed and reused for another
+  device isn't matched.
+
+  @param Handle                Controller handle.
+
+  @return  A copy of the cached description, or NULL if there is none.
+**/
+CHAR16 *
+BmGetCachedBootDescription (
+  IN EFI_HANDLE                      Handle
+  )
+{
+  LIST_ENTRY                         *Link;
+  BM_BOOT_DESCRIPTION_CACHE_ENTRY    *Entry;
+  EFI_DEVICE_PATH_PROTOCOL           *DevicePath;
+
+  DevicePath = DevicePathFromHandle (Handle);
+  if (DevicePath == NULL) {
+    return NULL;
+  }
+
+  for ( Link = GetFirstNode (&mBmBootDescriptionCache)
+      ; !IsNull (&mBmBootDescriptionCache, Link)
+      ; Link = GetNextNode (&mBmBootDescriptionCache, Link)
+      ) {
+    Entry = CR (Link, BM_BOOT_DESCRIPTION_CACHE_ENTRY, Link, BM_BOOT_DESCRIPTION_CACHE_ENTRY_SIGNATURE);
+    if (Entry->Handle == Handle) {
+      if (Entry->DevicePath == DevicePath) {
+        return AllocateCopyPool (StrSize (Entry->Description), Entry->Description);
+      }
+
+      //
+      // The handle now belongs to another device.
+      //
+      RemoveEntryList (&Entry->Link);
+      FreePool (Entry->Description);
+      FreePool (Entry);
+      return NULL;
+    }
+  }
+
+  return NULL;
+}
+
+/**
+  Cache the core provided boot description of the controller.
+
+  Failing to cache only means querying the device again next time.
+
+  @param Handle                Controller handle.
+  @param Description           The description to cache.
+**/
+VOID
+BmCacheBootDescription (
+  IN EFI_HANDLE                      Handle,
+  IN CHAR16                          *Description
+  )
+{
+  BM_BOOT_DESCRIPTION_CACHE_ENTRY    *Entry;
+  EFI_DEVICE_PATH_PROTOCOL           *DevicePath;
+
+  DevicePath = DevicePathFromHandle (Handle);
+  if (DevicePath == NULL) {
+    return;
+  }
+
+  Entry = AllocatePool (sizeof (BM_BOOT_DESCRIPTION_CACHE_ENTRY));
+  if (Entry == NULL) {
+    return;
+  }
+
+  Entry->Description = AllocateCopyPool (StrSize (Description), Description);
+  if (Entry->Description == NULL) {
+    FreePool (Entry);
+    return;
+  }
+
+  Entry->Signature  = BM_BOOT_DESCRIPTION_CACHE_ENTRY_SIGNATURE;
+  Entry->Handle     = Handle;
+  Entry->DevicePath = DevicePath;
+  InsertTailList (&mBmBootDescriptionCache, &Entry->Link);
+}
+
 /**
   Return the boot description for the controller.
 
@@ -775,10 +863,12 @@ BmGetBootDescription (
   UINTN                          Index;
 
   //
-  // Firstly get the default boot description
+  // Firstly get the default boot description. It only depends on the
+  // controller, so reuse the one found by an earlier enumeration instead of
+  // sending the identify commands or reading the USB strings again.
   //
-  DefaultDescription = NULL;
-  for (Index = 0; Index < ARRAY_SIZE (mBmBootDescriptionHandlers); Index++) {
+  DefaultDescription = BmGetCachedBootDescription (Handle);
+  for (Index = 0; (DefaultDescription == NULL) && (Index < ARRAY_SIZE (mBmBootDescriptionHandlers)); Index++) {
     DefaultDescription = mBmBootDescriptionHandlers[Index] (Handle);
     if (DefaultDescription != NULL) {
       //
@@ -791,6 +881,7 @@ BmGetBootDescription (
       StrCatS (Temp, (StrSize (DefaultDescription) + sizeof (mBmUefiPrefix)) / sizeof (CHAR16), DefaultDescription);
       FreePool (DefaultDescription);
       DefaultDescription = Temp;
+      BmCacheBootDescription (Handle, DefaultDescription);
       break;
     }
   }
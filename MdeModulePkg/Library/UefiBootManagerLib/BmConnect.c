@@ -8,6 +8,13 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #include "InternalBm.h"
 
+//
+// Set when EfiBootManagerConnectBootHint() connected the devices of the
+// previous boot, so that booting the same option can skip short-form
+// device path expansion.
+//
+BOOLEAN  mBmBootHintConnected = FALSE;
+
 /**
   Connect all the drivers to all the controllers.
 
@@ -86,6 +93,225 @@ EfiBootManagerConnectAll (
   EfiBootManagerConnectAllDefaultConsoles ();
 }
 
+/**
+  Remember the full device path a boot option was loaded from, so that the
+  next boot can connect only the devices along it.
+
+  @param OptionNumber  The number of the boot option.
+  @param FullPath      The full device path the boot option was loaded from.
+**/
+VOID
+BmSaveBootHint (
+  IN UINT16                             OptionNumber,
+  IN EFI_DEVICE_PATH_PROTOCOL           *FullPath
+  )
+{
+  UINT8                     *Hint;
+  UINTN                     HintSize;
+  UINT8                     *OldHint;
+  UINTN                     OldHintSize;
+
+  HintSize = sizeof (UINT16) + GetDevicePathSize (FullPath);
+
+  //
+  // Avoid wearing the flash when the same option boots from the same device.
+  //
+  GetVariable2 (BM_BOOT_HINT_VARIABLE_NAME, &mBmHardDriveBootVariableGuid, (VOID **) &OldHint, &OldHintSize);
+  if (OldHint != NULL) {
+    if ((OldHintSize == HintSize) &&
+        (ReadUnaligned16 ((UINT16 *) OldHint) == OptionNumber) &&
+        (CompareMem (OldHint + sizeof (UINT16), FullPath, HintSize - sizeof (UINT16)) == 0)) {
+      FreePool (OldHint);
+      return;
+    }
+    FreePool (OldHint);
+  }
+
+  Hint = AllocatePool (HintSize);
+  if (Hint == NULL) {
+    return;
+  }
+
+  WriteUnaligned16 ((UINT16 *) Hint, OptionNumber);
+  CopyMem (Hint + sizeof (UINT16), FullPath, HintSize - sizeof (UINT16));
+
+  //
+  // Failing to save only means connecting all the controllers next time
+  //
+  gRT->SetVariable (
+         BM_BOOT_HINT_VARIABLE_NAME,
+         &mBmHardDriveBootVariableGuid,
+         EFI_VARIABLE_BOOTSERVICE_ACCESS | EFI_VARIABLE_NON_VOLATILE,
+         HintSize,
+         Hint
+         );
+
+  FreePool (Hint);
+}
+
+/**
+  Connect the default consoles and the devices along the full device path
+  the first boot option in BootOrder was loaded from on the previous boot.
+
+  A platform can call this instead of EfiBootManagerConnectAll() on a fast
+  boot path, and fall back to EfiBootManagerConnectAll() when it fails.
+  Short-form boot options that cannot be resolved after this still get all
+  the controllers connected when they are booted.
+
+  @retval EFI_SUCCESS            The devices of the previous boot are connected.
+  @retval EFI_NOT_FOUND          No device path was recorded for the first boot
+                                 option, or it can no longer be connected.
+**/
+EFI_STATUS
+EFIAPI
+EfiBootManagerConnectBootHint (
+  VOID
+  )
+{
+  EFI_STATUS                Status;
+  UINT16                    *BootOrder;
+  UINTN                     BootOrderSize;
+  UINT8                     *Hint;
+  UINTN                     HintSize;
+  EFI_DEVICE_PATH_PROTOCOL  *DevicePath;
+  EFI_DEVICE_PATH_PROTOCOL  *RemainingDevicePath;
+  EFI_HANDLE                Handle;
+
+  EfiBootManagerConnectAllDefaultConsoles ();
+
+  GetEfiGlobalVariable2 (L"BootOrder", (VOID **) &BootOrder, &BootOrderSize);
+  GetVariable2 (BM_BOOT_HINT_VARIABLE_NAME, &mBmHardDriveBootVariableGuid, (VOID **) &Hint, &HintSize);
+
+  Status = EFI_NOT_FOUND;
+  if ((BootOrder != NULL) && (BootOrderSize >= sizeof (UINT16)) &&
+      (Hint != NULL) && (HintSize > sizeof (UINT16)) &&
+      (ReadUnaligned16 ((UINT16 *) Hint) == BootOrder[0])) {
+    DevicePath = (EFI_DEVICE_PATH_PROTOCOL *) (Hint + sizeof (UINT16));
+    if (IsDevicePathValid (DevicePath, HintSize - sizeof (UINT16))) {
+      EfiBootManagerConnectDevicePath (DevicePath, NULL);
+
+      //
+      // The connection is good enough if the file system or the load file
+      // instance the option was loaded from is back.
+      //
+      RemainingDevicePath = DevicePath;
+      Status = gBS->LocateDevicePath (&gEfiSimpleFileSystemProtocolGuid, &RemainingDevicePath, &Handle);
+      if (EFI_ERROR (Status)) {
+        RemainingDevicePath = DevicePath;
+        Status = gBS->LocateDevicePath (&gEfiLoadFileProtocolGuid, &RemainingDevicePath, &Handle);
+      }
+
+      if (EFI_ERROR (Status)) {
+        Status = EFI_NOT_FOUND;
+      }
+    }
+  }
+
+  if (BootOrder != NULL) {
+    FreePool (BootOrder);
+  }
+  if (Hint != NULL) {
+    FreePool (Hint);
+  }
+
+  mBmBootHintConnected = (BOOLEAN) !EFI_ERROR (Status);
+
+  DEBUG ((DEBUG_INFO, "[Bds]Connect boot hint - %r\n", Status));
+  return Status;
+}
+
+/**
+  Check whether Tail is the trailing part of DevicePath.
+
+  @param DevicePath  The full device path.
+  @param Tail        The device path to look for at the end of DevicePath.
+
+  @retval TRUE   DevicePath ends with Tail.
+  @retval FALSE  DevicePath doesn't end with Tail.
+**/
+BOOLEAN
+BmIsDevicePathTail (
+  IN EFI_DEVICE_PATH_PROTOCOL           *DevicePath,
+  IN EFI_DEVICE_PATH_PROTOCOL           *Tail
+  )
+{
+  UINTN                     Size;
+  UINTN                     TailSize;
+
+  Size     = GetDevicePathSize (DevicePath);
+  TailSize = GetDevicePathSize (Tail);
+  if (TailSize > Size) {
+    return FALSE;
+  }
+
+  return (BOOLEAN) (CompareMem ((UINT8 *) DevicePath + Size - TailSize, Tail, TailSize) == 0);
+}
+
+/**
+  Return the full device path recorded for a boot option on the previous
+  boot, if the devices along it were connected by
+  EfiBootManagerConnectBootHint() and it is an expansion of the boot option's
+  short-form device path.
+
+  Only hard drive and file path short forms are handled. Expanding them can
+  require connecting all the controllers, while the other forms are either
+  full device paths already or point to media that changes between boots.
+
+  @param BootOption  The boot option about to be booted.
+
+  @return The full device path to try first, or NULL. Caller is responsible
+          to free the memory.
+**/
+EFI_DEVICE_PATH_PROTOCOL *
+BmGetBootHintFullPath (
+  IN EFI_BOOT_MANAGER_LOAD_OPTION       *BootOption
+  )
+{
+  EFI_DEVICE_PATH_PROTOCOL  *FilePath;
+  EFI_DEVICE_PATH_PROTOCOL  *DevicePath;
+  EFI_DEVICE_PATH_PROTOCOL  *FullPath;
+  UINT8                     *Hint;
+  UINTN                     HintSize;
+  BOOLEAN                   Match;
+
+  if (!mBmBootHintConnected || (BootOption->OptionNumber == LoadOptionNumberUnassigned)) {
+    return NULL;
+  }
+
+  FilePath = BootOption->FilePath;
+  if ((DevicePathType (FilePath) != MEDIA_DEVICE_PATH) ||
+      ((DevicePathSubType (FilePath) != MEDIA_HARDDRIVE_DP) &&
+       (DevicePathSubType (FilePath) != MEDIA_FILEPATH_DP))) {
+    return NULL;
+  }
+
+  GetVariable2 (BM_BOOT_HINT_VARIABLE_NAME, &mBmHardDriveBootVariableGuid, (VOID **) &Hint, &HintSize);
+  if (Hint == NULL) {
+    return NULL;
+  }
+
+  FullPath = NULL;
+  if ((HintSize > sizeof (UINT16)) &&
+      (ReadUnaligned16 ((UINT16 *) Hint) == BootOption->OptionNumber)) {
+    DevicePath = (EFI_DEVICE_PATH_PROTOCOL *) (Hint + sizeof (UINT16));
+    if (IsDevicePathValid (DevicePath, HintSize - sizeof (UINT16))) {
+      if (DevicePathSubType (FilePath) == MEDIA_HARDDRIVE_DP) {
+        Match = BmMatchPartitionDevicePathNode (DevicePath, (HARDDRIVE_DEVICE_PATH *) FilePath) &&
+                BmIsDevicePathTail (DevicePath, NextDevicePathNode (FilePath));
+      } else {
+        Match = BmIsDevicePathTail (DevicePath, FilePath);
+      }
+
+      if (Match) {
+        FullPath = DuplicateDevicePath (DevicePath);
+      }
+    }
+  }
+
+  FreePool (Hint);
+  return FullPath;
+}
+
 /**
   This function will create all handles associate with every device
   path node. If the handle associate with one device path node can not
@@ -105,6 +105,18 @@ CHAR16 *
 #define BM_OPTION_NAME_LEN                          sizeof ("PlatformRecovery####")
 extern CHAR16  *mBmLoadOptionName[];
 
+//
+// Vendor GUID of the private variables of the library, like the HDDP cache
+// of partition device paths and the BootHint variable.
+//
+extern EFI_GUID mBmHardDriveBootVariableGuid;
+
+//
+// BootHint holds the UINT16 number of the boot option loaded on the previous
+// boot, followed by the full device path it was loaded from.
+//
+#define BM_BOOT_HINT_VARIABLE_NAME                  L"BootHint"
+
 //
 // Maximum number of reconnect retry to repair controller; it is to limit the
 // number of recursive call of BmRepairAllControllers.
@@ -146,6 +158,19 @@ typedef struct {
   EFI_BOOT_MANAGER_BOOT_DESCRIPTION_HANDLER Handler;
 } BM_BOOT_DESCRIPTION_ENTRY;
 
+//
+// Core provided boot description of a controller, kept for the rest of the
+// boot so that enumerating the boot options again doesn't query the device.
+//
+#define BM_BOOT_DESCRIPTION_CACHE_ENTRY_SIGNATURE SIGNATURE_32 ('b', 'm', 'd', 'c')
+typedef struct {
+  UINT32                                    Signature;
+  LIST_ENTRY                                Link;
+  EFI_HANDLE                                Handle;
+  EFI_DEVICE_PATH_PROTOCOL                  *DevicePath;
+  CHAR16                                    *Description;
+} BM_BOOT_DESCRIPTION_CACHE_ENTRY;
+
 /**
   Repair all the controllers according to the Driver Health status queried.
 
@@ -465,4 +490,33 @@ BmGetNextLoadOptionBuffer (
   OUT EFI_DEVICE_PATH_PROTOCOL          **FullPath,
   OUT UINTN                             *FileSize
   );
+
+/**
+  Remember the full device path a boot option was loaded from, so that the
+  next boot can connect only the devices along it.
+
+  @param OptionNumber  The number of the boot option.
+  @param FullPath      The full device path the boot option was loaded from.
+**/
+VOID
+BmSaveBootHint (
+  IN UINT16                             OptionNumber,
+  IN EFI_DEVICE_PATH_PROTOCOL           *FullPath
+  );
+
+/**
+  Return the full device path recorded for a boot option on the previous
+  boot, if the devices along it were connected by
+  EfiBootManagerConnectBootHint() and it is an expansion of the boot option's
+  short-form device path.
+
+  @param BootOption  The boot option about to be booted.
+
+  @return The full device path to try first, or NULL. Caller is responsible
+          to free the memory.
+**/
+EFI_DEVICE_PATH_PROTOCOL *
+BmGetBootHintFullPath (
+  IN EFI_BOOT_MANAGER_LOAD_OPTION       *BootOption
+  );
 #endif // _INTERNAL_BM_H_
@@ -0,0 +1,34 @@
+/** @file
+  Implements for functions declared in ZstdDecUefiSupport.h
+
+  The decoder context is placed in the caller's scratch buffer with
+  ZSTD_initStaticDCtx(), so zstd never allocates memory at run time.
+
+  Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+#include <ZstdDecUefiSupport.h>
+
+/**
+  Dummy malloc function for compiler.
+**/
+VOID *
+ZstdDummyMalloc (
+  IN size_t    Size
+  )
+{
+  ASSERT (FALSE);
+  return NULL;
+}
+
+/**
+  Dummy free function for compiler.
+**/
+VOID
+ZstdDummyFree (
+  IN VOID *    Ptr
+  )
+{
+  ASSERT (FALSE);
+}
@@ -0,0 +1,54 @@
+/** @file
+  ZSTD UEFI header file for definitions
+
+  Allows ZSTD code to build under UEFI (edk2) build environment
+
+  Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef __ZSTD_DECOMPRESS_UEFI_SUP_H__
+#define __ZSTD_DECOMPRESS_UEFI_SUP_H__
+
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+
+#define memcpy                      CopyMem
+#define memmove                     CopyMem
+#define memset(dest,ch,count)       SetMem(dest,(UINTN)(count),(UINT8)(ch))
+#define memcmp(a,b,count)           ((int)CompareMem(a,b,(UINTN)(count)))
+#define malloc                      ZstdDummyMalloc
+#define calloc(count,size)          ZstdDummyMalloc((count) * (size))
+#define free                        ZstdDummyFree
+
+#define CHAR_BIT                    8
+#define INT_MAX                     MAX_INT32
+#define UINT_MAX                    MAX_UINT32
+#define SIZE_MAX                    MAX_UINTN
+
+typedef INT8     int8_t;
+typedef INT16    int16_t;
+typedef INT32    int32_t;
+typedef INT64    int64_t;
+typedef UINT8    uint8_t;
+typedef UINT16   uint16_t;
+typedef UINT32   uint32_t;
+typedef UINT64   uint64_t;
+typedef UINTN    size_t;
+typedef INTN     ptrdiff_t;
+typedef INTN     intptr_t;
+typedef UINTN    uintptr_t;
+
+VOID *
+ZstdDummyMalloc (
+  IN size_t   Size
+  );
+
+VOID
+ZstdDummyFree (
+  IN VOID *   Ptr
+  );
+
+#endif
@@ -0,0 +1,112 @@
+/** @file
+  Zstd Decompress interfaces
+
+  Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+#include <ZstdDecompressLibInternal.h>
+
+/**
+  Given a Zstd compressed source buffer, this function retrieves the size of
+  the uncompressed buffer and the size of the scratch buffer required
+  to decompress the compressed source buffer.
+
+  Retrieves the size of the uncompressed buffer and the temporary scratch buffer
+  required to decompress the buffer specified by Source and SourceSize.
+  The decompressed size is the sum of the content sizes recorded in every
+  frame header, so frames written without their content size are rejected.
+  The scratch buffer holds a static decoder context; decompressing into a
+  flat output buffer needs no window buffer on top of it.
+
+  @param  Source          The source buffer containing the compressed data.
+  @param  SourceSize      The size, in bytes, of the source buffer.
+  @param  DestinationSize A pointer to the size, in bytes, of the uncompressed buffer
+                          that will be generated when the compressed buffer specified
+                          by Source and SourceSize is decompressed.
+  @param  ScratchSize     A pointer to the size, in bytes, of the scratch buffer that
+                          is required to decompress the compressed buffer specified
+                          by Source and SourceSize.
+
+  @retval RETURN_SUCCESS            The size of the uncompressed data was returned
+                                    in DestinationSize and the size of the scratch
+                                    buffer was returned in ScratchSize.
+  @retval RETURN_INVALID_PARAMETER  The frames do not record their decompressed size.
+  @retval RETURN_UNSUPPORTED        The decompressed size does not fit in a UINT32.
+**/
+RETURN_STATUS
+EFIAPI
+ZstdUefiDecompressGetInfo (
+  IN  CONST VOID  *Source,
+  IN  UINT32      SourceSize,
+  OUT UINT32      *DestinationSize,
+  OUT UINT32      *ScratchSize
+  )
+{
+  unsigned long long  DecodedSize;
+
+  DecodedSize = ZSTD_findDecompressedSize (Source, SourceSize);
+  if (DecodedSize == ZSTD_CONTENTSIZE_ERROR || DecodedSize == ZSTD_CONTENTSIZE_UNKNOWN) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  if (DecodedSize > MAX_UINT32) {
+    return RETURN_UNSUPPORTED;
+  }
+
+  *DestinationSize = (UINT32) DecodedSize;
+  *ScratchSize     = (UINT32) ZSTD_estimateDCtxSize ();
+  return RETURN_SUCCESS;
+}
+
+/**
+  Decompresses a Zstd compressed source buffer.
+
+  Extracts decompressed data to its original form.
+  If the compressed source data specified by Source is successfully decompressed
+  into Destination, then RETURN_SUCCESS is returned.  If the compressed source data
+  specified by Source is not in a valid compressed data format,
+  then RETURN_INVALID_PARAMETER is returned.
+
+  @param  Source      The source buffer containing the compressed data.
+  @param  SourceSize  The size of source buffer.
+  @param  Destination The destination buffer to store the decompressed data.
+  @param  Scratch     A temporary scratch buffer that is used to perform the decompression.
+
+  @retval RETURN_SUCCESS            Decompression completed successfully, and
+                                    the uncompressed buffer is returned in Destination.
+  @retval RETURN_INVALID_PARAMETER  The source buffer specified by Source is corrupted
+                                    (not in a valid compressed format).
+**/
+RETURN_STATUS
+EFIAPI
+ZstdUefiDecompress (
+  IN CONST VOID  *Source,
+  IN UINTN       SourceSize,
+  IN OUT VOID    *Destination,
+  IN OUT VOID    *Scratch
+  )
+{
+  ZSTD_DCtx           *DCtx;
+  unsigned long long  DecodedSize;
+  size_t              Result;
+
+  DecodedSize = ZSTD_findDecompressedSize (Source, SourceSize);
+  if (DecodedSize == ZSTD_CONTENTSIZE_ERROR ||
+      DecodedSize == ZSTD_CONTENTSIZE_UNKNOWN ||
+      DecodedSize > MAX_UINT32) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  DCtx = ZSTD_initStaticDCtx (Scratch, ZSTD_estimateDCtxSize ());
+  if (DCtx == NULL) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  Result = ZSTD_decompressDCtx (DCtx, Destination, (size_t) DecodedSize, Source, SourceSize);
+  if (ZSTD_isError (Result) || Result != DecodedSize) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  return RETURN_SUCCESS;
+}
@@ -0,0 +1,62 @@
+/** @file
+  ZSTD UEFI header file
+
+  Allows ZSTD code to build under UEFI (edk2) build environment
+
+  Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef __ZSTD_DECOMPRESS_INTERNAL_H__
+#define __ZSTD_DECOMPRESS_INTERNAL_H__
+
+#include <PiPei.h>
+#include <Library/ExtractGuidedSectionLib.h>
+#define ZSTD_STATIC_LINKING_ONLY
+#include <zstd/lib/zstd.h>
+
+/**
+  Given a Zstd compressed source buffer, this function retrieves the size of
+  the uncompressed buffer and the size of the scratch buffer required
+  to decompress the compressed source buffer.
+
+  @param  Source          The source buffer containing the compressed data.
+  @param  SourceSize      The size, in bytes, of the source buffer.
+  @param  DestinationSize A pointer to the size, in bytes, of the uncompressed buffer.
+  @param  ScratchSize     A pointer to the size, in bytes, of the scratch buffer.
+
+  @retval RETURN_SUCCESS            The sizes were returned.
+  @retval RETURN_INVALID_PARAMETER  The frames do not record their decompressed size.
+  @retval RETURN_UNSUPPORTED        The decompressed size does not fit in a UINT32.
+**/
+RETURN_STATUS
+EFIAPI
+ZstdUefiDecompressGetInfo (
+  IN  CONST VOID  *Source,
+  IN  UINT32      SourceSize,
+  OUT UINT32      *DestinationSize,
+  OUT UINT32      *ScratchSize
+  );
+
+/**
+  Decompresses a Zstd compressed source buffer.
+
+  @param  Source      The source buffer containing the compressed data.
+  @param  SourceSize  The size of source buffer.
+  @param  Destination The destination buffer to store the decompressed data.
+  @param  Scratch     A scratch buffer of the size returned by ZstdUefiDecompressGetInfo().
+
+  @retval RETURN_SUCCESS            Decompression completed successfully.
+  @retval RETURN_INVALID_PARAMETER  The source buffer is corrupted.
+**/
+RETURN_STATUS
+EFIAPI
+ZstdUefiDecompress (
+  IN CONST VOID  *Source,
+  IN UINTN       SourceSize,
+  IN OUT VOID    *Destination,
+  IN OUT VOID    *Scratch
+  );
+
+#endif
@@ -0,0 +1,9 @@
+/** @file
+  Include file to support building the third-party zstd.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <ZstdDecUefiSupport.h>
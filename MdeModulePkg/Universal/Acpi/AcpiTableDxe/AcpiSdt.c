@@ -758,6 +758,12 @@ SetOption (
   CopyMem (OrgData, Data, DataSize);
   AmlHandle->Modified = TRUE;
 
+  //
+  // The update may rename or resize objects, so parse the namespace again on
+  // the next FindPath ().
+  //
+  AmlInvalidateNamespaceIndex ();
+
   return EFI_SUCCESS;
 }
 
@@ -904,10 +910,12 @@ SdtFindPathFromRoot (
   OUT   EFI_ACPI_HANDLE *HandleOut
   )
 {
-  EFI_ACPI_HANDLE     ChildHandle;
-  EFI_AML_HANDLE      *AmlHandle;
-  EFI_STATUS          Status;
-  VOID                *Buffer;
+  EFI_AML_HANDLE            *AmlHandle;
+  EFI_AML_NAMESPACE_INDEX   *NamespaceIndex;
+  EFI_AML_NAMESPACE_OBJECT  *Object;
+  EFI_STATUS                Status;
+  VOID                      *Buffer;
+  UINTN                     Index;
 
   Buffer = NULL;
   AmlHandle = (EFI_AML_HANDLE *)HandleIn;
@@ -924,28 +932,17 @@ SdtFindPathFromRoot (
   }
 
   //
-  // Let children find it.
+  // Let children find it. The namespace of every child is parsed once and
+  // kept in the namespace index of the table.
   //
-  ChildHandle = NULL;
-  while (TRUE) {
-    Status = GetChild (HandleIn, &ChildHandle);
-    if (EFI_ERROR (Status)) {
-      return EFI_INVALID_PARAMETER;
-    }
-
-    if (ChildHandle == NULL) {
-      //
-      // Not found
-      //
-      *HandleOut = NULL;
-      return EFI_SUCCESS;
-    }
+  Status = AmlGetNamespaceIndex (AmlHandle, &NamespaceIndex);
+  if (EFI_ERROR (Status)) {
+    return EFI_INVALID_PARAMETER;
+  }
 
-    //
-    // More child
-    //
-    AmlHandle = (EFI_AML_HANDLE *)ChildHandle;
-    Status = AmlFindPath (AmlHandle, AmlPath, &Buffer, TRUE);
+  for (Index = 0; Index < NamespaceIndex->ObjectCount; Index++) {
+    Object = &NamespaceIndex->Objects[Index];
+    Status = AmlFindPathInNamespaceObject (Object, AmlPath, &Buffer, TRUE);
     if (EFI_ERROR (Status)) {
       return EFI_INVALID_PARAMETER;
     }
@@ -954,7 +951,7 @@ SdtFindPathFromRoot (
       //
       // Great! Find it, open
       //
-      Status = SdtOpenEx (Buffer, (UINTN)AmlHandle->Buffer + AmlHandle->Size - (UINTN)Buffer, HandleOut);
+      Status = SdtOpenEx (Buffer, (UINTN)Object->Buffer + Object->Size - (UINTN)Buffer, HandleOut);
       if (!EFI_ERROR (Status))  {
         return EFI_SUCCESS;
       }
@@ -964,9 +961,15 @@ SdtFindPathFromRoot (
     }
   }
 
+  if (NamespaceIndex->Incomplete) {
+    return EFI_INVALID_PARAMETER;
+  }
+
   //
-  // Should not run here
+  // Not found
   //
+  *HandleOut = NULL;
+  return EFI_SUCCESS;
 }
 
 /**
@@ -55,6 +55,8 @@ typedef struct _EFI_AML_NODE_LIST EFI_AML_NODE_LIST;
 //         This buffer should not be freed.
 //  Size is the total size of this ACPI node buffer.
 //  Children is the children linked list of this node.
+//  HashLink links the node into the (Parent, Name) hash of all nodes that
+//         have a parent.
 //
 #define AML_NAME_SEG_SIZE  4
 
@@ -67,12 +69,59 @@ struct _EFI_AML_NODE_LIST {
   LIST_ENTRY              Children;
   EFI_AML_NODE_LIST       *Parent;
   AML_BYTE_ENCODING       *AmlByteEncoding;
+  LIST_ENTRY              HashLink;
 };
 
 //
 // Containment record for AML Node linked list.
 //
 #define EFI_AML_NODE_LIST_FROM_LINK(_link)  CR (_link, EFI_AML_NODE_LIST, Link, EFI_AML_NODE_LIST_SIGNATURE)
+#define EFI_AML_NODE_LIST_FROM_HASH_LINK(_link)  CR (_link, EFI_AML_NODE_LIST, HashLink, EFI_AML_NODE_LIST_SIGNATURE)
+
+//
+// AML Namespace Object definition.
+//
+//  Buffer and Size describe one top level AML object that is searched on its own.
+//  RootNodeList is the namespace parsed from that object, or NULL if the object
+//         could not be parsed.
+//
+typedef struct {
+  UINT8                   *Buffer;
+  UINTN                   Size;
+  EFI_AML_NODE_LIST       *RootNodeList;
+} EFI_AML_NAMESPACE_OBJECT;
+
+//
+// AML Namespace Index Signature.
+//
+#define EFI_AML_NAMESPACE_INDEX_SIGNATURE SIGNATURE_32 ('E', 'A', 'N', 'I')
+
+//
+// AML Namespace Index definition.
+//
+//  Signature must be set to EFI_AML_NAMESPACE_INDEX_SIGNATURE
+//  Link is the linked list data.
+//  HandleSignature, Buffer and Size identify the AML handle the index was built for.
+//  Objects are the objects searched by FindPath (), in table order. For a root
+//         handle these are the top level objects of the table, otherwise the
+//         object of the handle itself.
+//  Incomplete is TRUE if the objects of the table could not all be enumerated.
+//
+typedef struct {
+  UINT32                    Signature;
+  LIST_ENTRY                Link;
+  UINT32                    HandleSignature;
+  UINT8                     *Buffer;
+  UINTN                     Size;
+  UINTN                     ObjectCount;
+  EFI_AML_NAMESPACE_OBJECT  *Objects;
+  BOOLEAN                   Incomplete;
+} EFI_AML_NAMESPACE_INDEX;
+
+//
+// Containment record for AML Namespace Index linked list.
+//
+#define EFI_AML_NAMESPACE_INDEX_FROM_LINK(_link)  CR (_link, EFI_AML_NAMESPACE_INDEX, Link, EFI_AML_NAMESPACE_INDEX_SIGNATURE)
 
 //
 // AML Handle Signature.
@@ -544,6 +593,51 @@ AmlFindPath (
   IN    BOOLEAN         FromRoot
   );
 
+/**
+  Return the namespace index of an AML handle, building it on first use.
+
+  @param[in]    AmlHandle       AML handle.
+  @param[out]   NamespaceIndex  On return, points to the namespace index of AmlHandle.
+
+  @retval EFI_SUCCESS           Success
+  @retval EFI_INVALID_PARAMETER AmlHandle does not refer to a valid ACPI object.
+**/
+EFI_STATUS
+AmlGetNamespaceIndex (
+  IN    EFI_AML_HANDLE           *AmlHandle,
+  OUT   EFI_AML_NAMESPACE_INDEX  **NamespaceIndex
+  );
+
+/**
+  Find an AML path in the namespace of one indexed AML object.
+
+  @param[in]    Object      Namespace object to search.
+  @param[in]    AmlPath     Points to the ACPI AML path.
+  @param[out]   Buffer      On return, points to the ACPI object which represents AmlPath,
+                            or NULL if it is not found.
+  @param[in]    FromRoot    TRUE means to find AML path from \ (Root) Node.
+                            FALSE means to find AML path from the object itself.
+
+  @retval EFI_SUCCESS           Success
+  @retval EFI_INVALID_PARAMETER Object could not be parsed.
+**/
+EFI_STATUS
+AmlFindPathInNamespaceObject (
+  IN    EFI_AML_NAMESPACE_OBJECT  *Object,
+  IN    UINT8                     *AmlPath,
+  OUT   VOID                      **Buffer,
+  IN    BOOLEAN                   FromRoot
+  );
+
+/**
+  Drop all namespace indexes. This must be called whenever AML may have been
+  changed or freed.
+**/
+VOID
+AmlInvalidateNamespaceIndex (
+  VOID
+  );
+
 /**
   Print AML NameString.
 
@@ -14,6 +14,7 @@
 
 #include <Protocol/AcpiTable.h>
 #include <Guid/Acpi.h>
+#include <Guid/AcpiTableCommit.h>
 #include <Protocol/AcpiSystemDescriptionTable.h>
 
 #include <Library/BaseLib.h>
@@ -113,6 +114,8 @@ typedef struct {
   EFI_ACPI_TABLE_PROTOCOL                       AcpiTableProtocol;
   EFI_ACPI_SDT_PROTOCOL                         AcpiSdtProtocol;
   LIST_ENTRY                                    NotifyList;
+  BOOLEAN                                       DeferPublish;           // Publish is deferred to a commit point
+  EFI_ACPI_TABLE_VERSION                        PendingPublishVersion;  // Versions waiting to be published
 } EFI_ACPI_TABLE_INSTANCE;
 
 //
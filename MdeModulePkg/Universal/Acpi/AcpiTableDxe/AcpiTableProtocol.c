@@ -178,6 +178,93 @@ PublishTables (
   return EFI_SUCCESS;
 }
 
+/**
+  Publish the specified versions of the ACPI tables now, or record them to be
+  published at the next commit point when publishing is deferred.
+
+  @param  AcpiTableInstance  Instance of the protocol.
+  @param  Version            Version(s) to publish.
+
+  @return EFI_SUCCESS  The tables were published or their publish was deferred.
+  @return EFI_ABORTED  The function could not complete successfully.
+
+**/
+EFI_STATUS
+RequestPublishTables (
+  IN EFI_ACPI_TABLE_INSTANCE              *AcpiTableInstance,
+  IN EFI_ACPI_TABLE_VERSION               Version
+  )
+{
+  if (AcpiTableInstance->DeferPublish) {
+    AcpiTableInstance->PendingPublishVersion |= Version;
+    return EFI_SUCCESS;
+  }
+
+  return PublishTables (AcpiTableInstance, Version);
+}
+
+/**
+  Checksum and publish the tables whose publish was deferred.
+
+  @param  AcpiTableInstance  Instance of the protocol.
+
+**/
+VOID
+CommitPendingTables (
+  IN EFI_ACPI_TABLE_INSTANCE              *AcpiTableInstance
+  )
+{
+  EFI_STATUS                Status;
+
+  if (AcpiTableInstance->PendingPublishVersion == 0) {
+    return;
+  }
+
+  Status = PublishTables (AcpiTableInstance, AcpiTableInstance->PendingPublishVersion);
+  ASSERT_EFI_ERROR (Status);
+  AcpiTableInstance->PendingPublishVersion = 0;
+}
+
+/**
+  Notification of the gEdkiiAcpiTableCommitGuid event group. Publish the
+  tables installed or uninstalled since the last commit.
+
+  @param  Event    Event whose notification function is being invoked.
+  @param  Context  Pointer to the ACPI table protocol instance.
+
+**/
+VOID
+EFIAPI
+AcpiTableCommitNotify (
+  IN EFI_EVENT                            Event,
+  IN VOID                                 *Context
+  )
+{
+  CommitPendingTables ((EFI_ACPI_TABLE_INSTANCE *) Context);
+}
+
+/**
+  Notification of ReadyToBoot. Publish the pending tables and stop deferring,
+  so that tables installed from now on are published immediately.
+
+  @param  Event    Event whose notification function is being invoked.
+  @param  Context  Pointer to the ACPI table protocol instance.
+
+**/
+VOID
+EFIAPI
+AcpiTableReadyToBootNotify (
+  IN EFI_EVENT                            Event,
+  IN VOID                                 *Context
+  )
+{
+  EFI_ACPI_TABLE_INSTANCE   *AcpiTableInstance;
+
+  AcpiTableInstance = (EFI_ACPI_TABLE_INSTANCE *) Context;
+  CommitPendingTables (AcpiTableInstance);
+  AcpiTableInstance->DeferPublish = FALSE;
+}
+
 
 /**
   Installs an ACPI table into the RSDT/XSDT.
@@ -241,7 +328,7 @@ InstallAcpiTable (
              TableKey
              );
   if (!EFI_ERROR (Status)) {
-    Status = PublishTables (
+    Status = RequestPublishTables (
                AcpiTableInstance,
                Version
                );
@@ -302,7 +389,7 @@ UninstallAcpiTable (
              TableKey
              );
   if (!EFI_ERROR (Status)) {
-    Status = PublishTables (
+    Status = RequestPublishTables (
                AcpiTableInstance,
                Version
                );
@@ -316,7 +403,7 @@ UninstallAcpiTable (
 }
 
 /**
-  If the number of APCI tables exceeds the preallocated max table number, enlarge the table buffer.
+  If the number of APCI tables exceeds the preallocated max table number, double the table buffer.
 
   @param  AcpiTableInstance       ACPI table protocol instance data structure.
 
@@ -339,9 +426,10 @@ ReallocateAcpiTableBuffer (
 
   CopyMem (&TempPrivateData, AcpiTableInstance, sizeof (EFI_ACPI_TABLE_INSTANCE));
   //
-  // Enlarge the max table number from mEfiAcpiMaxNumTables to mEfiAcpiMaxNumTables + EFI_ACPI_MAX_NUM_TABLES
+  // Double the max table number so that installing many tables copies the
+  // RSDT/XSDT a logarithmic rather than linear number of times.
   //
-  NewMaxTableNumber = mEfiAcpiMaxNumTables + EFI_ACPI_MAX_NUM_TABLES;
+  NewMaxTableNumber = mEfiAcpiMaxNumTables * 2;
   //
   // Create RSDT, XSDT structures and allocate buffers.
   //
@@ -1083,7 +1171,9 @@ AddTableToList (
     }
   }
 
-  ChecksumCommonTables (AcpiTableInstance);
+  if (!AcpiTableInstance->DeferPublish) {
+    ChecksumCommonTables (AcpiTableInstance);
+  }
   return EFI_SUCCESS;
 }
 
@@ -1497,6 +1587,13 @@ DeleteTable (
   // If no version is using this table anymore, remove and free list entry.
   //
   if (Table->Version == 0) {
+    //
+    // Namespace indexes may point into the table being freed.
+    //
+    if (FeaturePcdGet (PcdInstallAcpiSdtProtocol)) {
+      AmlInvalidateNamespaceIndex ();
+    }
+
     //
     // Free the Table
     //
@@ -1711,6 +1808,7 @@ AcpiTableAcpiTableConstructor (
   UINTN                 RsdpTableSize;
   UINT8                 *Pointer;
   EFI_PHYSICAL_ADDRESS  PageAddress;
+  EFI_EVENT             Event;
 
   //
   // Check for invalid input parameters
@@ -1733,6 +1831,31 @@ AcpiTableAcpiTableConstructor (
   AcpiTableInstance->AcpiTableProtocol.InstallAcpiTable   = InstallAcpiTable;
   AcpiTableInstance->AcpiTableProtocol.UninstallAcpiTable = UninstallAcpiTable;
 
+  //
+  // When publishing is deferred, the RSDT/XSDT checksums and the configuration
+  // table update are done once per commit instead of once per table.
+  //
+  if (FeaturePcdGet (PcdAcpiTableDeferredPublish)) {
+    Status = gBS->CreateEventEx (
+                    EVT_NOTIFY_SIGNAL,
+                    TPL_CALLBACK,
+                    AcpiTableCommitNotify,
+                    AcpiTableInstance,
+                    &gEdkiiAcpiTableCommitGuid,
+                    &Event
+                    );
+    if (!EFI_ERROR (Status)) {
+      Status = EfiCreateEventReadyToBootEx (
+                 TPL_CALLBACK,
+                 AcpiTableReadyToBootNotify,
+                 AcpiTableInstance,
+                 &Event
+                 );
+    }
+    ASSERT_EFI_ERROR (Status);
+    AcpiTableInstance->DeferPublish = !EFI_ERROR (Status);
+  }
+
   if (FeaturePcdGet (PcdInstallAcpiSdtProtocol)) {
     SdtAcpiTableAcpiSdtConstructor (AcpiTableInstance);
   }
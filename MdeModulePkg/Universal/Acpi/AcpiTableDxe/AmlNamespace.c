@@ -8,6 +8,22 @@
 
 #include "AcpiTable.h"
 
+//
+// All AML nodes that have a parent are hashed by parent and NameSeg, so each
+// NameSeg of a path is resolved with one bucket probe.
+//
+#define AML_NODE_HASH_BITS     8
+#define AML_NODE_HASH_BUCKETS  (1 << AML_NODE_HASH_BITS)
+
+LIST_ENTRY  mAmlNodeHash[AML_NODE_HASH_BUCKETS];
+BOOLEAN     mAmlNodeHashInitialized = FALSE;
+
+//
+// Namespace indexes built by AmlGetNamespaceIndex (), kept until the AML
+// changes.
+//
+LIST_ENTRY  mAmlNamespaceIndexList = INITIALIZE_LIST_HEAD_VARIABLE (mAmlNamespaceIndexList);
+
 /**
   Construct node list according to the AML handle.
 
@@ -25,6 +41,35 @@ AmlConstructNodeList (
   IN EFI_AML_NODE_LIST   *AmlParentNodeList
   );
 
+/**
+  Return the hash bucket of a node.
+
+  @param[in]    Parent               AML parent node list.
+  @param[in]    NameSeg              AML NameSeg.
+
+  @return       The bucket in mAmlNodeHash.
+**/
+LIST_ENTRY *
+AmlNodeHashBucket (
+  IN EFI_AML_NODE_LIST  *Parent,
+  IN UINT8              *NameSeg
+  )
+{
+  UINT32      Hash;
+  UINTN       Index;
+
+  if (!mAmlNodeHashInitialized) {
+    for (Index = 0; Index < AML_NODE_HASH_BUCKETS; Index++) {
+      InitializeListHead (&mAmlNodeHash[Index]);
+    }
+    mAmlNodeHashInitialized = TRUE;
+  }
+
+  Hash = (UINT32)((UINTN)Parent >> 4) ^ ReadUnaligned32 ((UINT32 *)NameSeg);
+  Hash = Hash * 0x9E3779B1;
+  return &mAmlNodeHash[Hash >> (32 - AML_NODE_HASH_BITS)];
+}
+
 /**
   Create AML Node.
 
@@ -54,6 +99,10 @@ AmlCreateNode (
   InitializeListHead (&AmlNodeList->Children);
   AmlNodeList->Parent = Parent;
   AmlNodeList->AmlByteEncoding = AmlByteEncoding;
+  InitializeListHead (&AmlNodeList->HashLink);
+  if (Parent != NULL) {
+    InsertTailList (AmlNodeHashBucket (Parent, NameSeg), &AmlNodeList->HashLink);
+  }
 
   return AmlNodeList;
 }
@@ -79,15 +128,16 @@ AmlFindNodeInThis (
   LIST_ENTRY             *StartLink;
   EFI_AML_NODE_LIST      *AmlNodeList;
 
-  StartLink   = &AmlParentNodeList->Children;
+  StartLink   = AmlNodeHashBucket (AmlParentNodeList, NameSeg);
   CurrentLink = StartLink->ForwardLink;
 
   while (CurrentLink != StartLink) {
-    CurrentAmlNodeList = EFI_AML_NODE_LIST_FROM_LINK (CurrentLink);
+    CurrentAmlNodeList = EFI_AML_NODE_LIST_FROM_HASH_LINK (CurrentLink);
     //
     // AML name is same as the one stored
     //
-    if (CompareMem (CurrentAmlNodeList->Name, NameSeg, AML_NAME_SEG_SIZE) == 0) {
+    if ((CurrentAmlNodeList->Parent == AmlParentNodeList) &&
+        (CompareMem (CurrentAmlNodeList->Name, NameSeg, AML_NAME_SEG_SIZE) == 0)) {
       //
       // Good! Found it
       //
@@ -453,6 +503,9 @@ AmlDestructNodeList (
   //
   // Done.
   //
+  if (AmlParentNodeList->Parent != NULL) {
+    RemoveEntryList (&AmlParentNodeList->HashLink);
+  }
   FreePool (AmlParentNodeList);
   return ;
 }
@@ -495,36 +548,20 @@ AmlDumpNodeInfo (
 }
 
 /**
-  Returns the handle of the ACPI object representing the specified ACPI AML path
+  Parse the namespace of an AML object.
 
-  @param[in]    AmlHandle   Points to the handle of the object representing the starting point for the path search.
-  @param[in]    AmlPath     Points to the ACPI AML path.
-  @param[out]   Buffer      On return, points to the ACPI object which represents AcpiPath, relative to
-                            HandleIn.
-  @param[in]    FromRoot    TRUE means to find AML path from \ (Root) Node.
-                            FALSE means to find AML path from this Node (The HandleIn).
+  @param[in]    AmlHandle   AML handle of the object.
 
-  @retval EFI_SUCCESS           Success
-  @retval EFI_INVALID_PARAMETER HandleIn does not refer to a valid ACPI object.
+  @return       Root of the namespace, or NULL if the object could not be parsed.
 **/
-EFI_STATUS
-AmlFindPath (
-  IN    EFI_AML_HANDLE  *AmlHandle,
-  IN    UINT8           *AmlPath,
-  OUT   VOID            **Buffer,
-  IN    BOOLEAN         FromRoot
+EFI_AML_NODE_LIST *
+AmlBuildNamespace (
+  IN EFI_AML_HANDLE      *AmlHandle
   )
 {
   EFI_AML_NODE_LIST   *AmlRootNodeList;
   EFI_STATUS          Status;
-  EFI_AML_NODE_LIST   *AmlNodeList;
   UINT8               RootNameSeg[AML_NAME_SEG_SIZE];
-  EFI_AML_NODE_LIST   *CurrentAmlNodeList;
-  LIST_ENTRY          *CurrentLink;
-
-  //
-  // 1. create tree
-  //
 
   //
   // Create root handle
@@ -539,7 +576,8 @@ AmlFindPath (
              AmlRootNodeList  // Parent
              );
   if (EFI_ERROR (Status)) {
-    return EFI_INVALID_PARAMETER;
+    AmlDestructNodeList (AmlRootNodeList);
+    return NULL;
   }
 
   DEBUG_CODE_BEGIN ();
@@ -547,9 +585,171 @@ AmlFindPath (
   AmlDumpNodeInfo (AmlRootNodeList, 0);
   DEBUG_CODE_END ();
 
-  //
-  // 2. Search the node in the tree
-  //
+  return AmlRootNodeList;
+}
+
+/**
+  Add an object to a namespace index and parse its namespace.
+
+  @param[in]    NamespaceIndex  Namespace index.
+  @param[in]    AmlHandle       AML handle of the object.
+**/
+VOID
+AmlAddNamespaceObject (
+  IN EFI_AML_NAMESPACE_INDEX  *NamespaceIndex,
+  IN EFI_AML_HANDLE           *AmlHandle
+  )
+{
+  EFI_AML_NAMESPACE_OBJECT  *Object;
+
+  NamespaceIndex->Objects = ReallocatePool (
+                              NamespaceIndex->ObjectCount * sizeof (EFI_AML_NAMESPACE_OBJECT),
+                              (NamespaceIndex->ObjectCount + 1) * sizeof (EFI_AML_NAMESPACE_OBJECT),
+                              NamespaceIndex->Objects
+                              );
+  ASSERT (NamespaceIndex->Objects != NULL);
+
+  Object               = &NamespaceIndex->Objects[NamespaceIndex->ObjectCount];
+  Object->Buffer       = AmlHandle->Buffer;
+  Object->Size         = AmlHandle->Size;
+  Object->RootNodeList = AmlBuildNamespace (AmlHandle);
+  NamespaceIndex->ObjectCount++;
+}
+
+/**
+  Return the namespace index of an AML handle, building it on first use.
+
+  For a root handle the index holds the namespace of every top level object
+  of the table. For any other handle it holds the namespace of the object of
+  the handle.
+
+  @param[in]    AmlHandle       AML handle.
+  @param[out]   NamespaceIndex  On return, points to the namespace index of AmlHandle.
+
+  @retval EFI_SUCCESS           Success
+  @retval EFI_INVALID_PARAMETER AmlHandle does not refer to a valid ACPI object.
+**/
+EFI_STATUS
+AmlGetNamespaceIndex (
+  IN    EFI_AML_HANDLE           *AmlHandle,
+  OUT   EFI_AML_NAMESPACE_INDEX  **NamespaceIndex
+  )
+{
+  EFI_AML_NAMESPACE_INDEX  *CurrentIndex;
+  LIST_ENTRY               *CurrentLink;
+  EFI_ACPI_HANDLE          ChildHandle;
+  EFI_ACPI_HANDLE          PreviousHandle;
+  EFI_STATUS               Status;
+
+  for (CurrentLink = mAmlNamespaceIndexList.ForwardLink;
+       CurrentLink != &mAmlNamespaceIndexList;
+       CurrentLink = CurrentLink->ForwardLink) {
+    CurrentIndex = EFI_AML_NAMESPACE_INDEX_FROM_LINK (CurrentLink);
+    if ((CurrentIndex->HandleSignature == AmlHandle->Signature) &&
+        (CurrentIndex->Buffer == AmlHandle->Buffer) &&
+        (CurrentIndex->Size == AmlHandle->Size)) {
+      *NamespaceIndex = CurrentIndex;
+      return EFI_SUCCESS;
+    }
+  }
+
+  CurrentIndex = AllocateZeroPool (sizeof (*CurrentIndex));
+  ASSERT (CurrentIndex != NULL);
+  if (CurrentIndex == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+  CurrentIndex->Signature       = EFI_AML_NAMESPACE_INDEX_SIGNATURE;
+  CurrentIndex->HandleSignature = AmlHandle->Signature;
+  CurrentIndex->Buffer          = AmlHandle->Buffer;
+  CurrentIndex->Size            = AmlHandle->Size;
+
+  if (AmlHandle->Signature == EFI_AML_ROOT_HANDLE_SIGNATURE) {
+    //
+    // Let children be indexed one by one, in table order.
+    //
+    ChildHandle = NULL;
+    while (TRUE) {
+      PreviousHandle = ChildHandle;
+      Status = GetChild ((EFI_ACPI_HANDLE)AmlHandle, &ChildHandle);
+      if (PreviousHandle != NULL) {
+        Close (PreviousHandle);
+      }
+      if (EFI_ERROR (Status)) {
+        CurrentIndex->Incomplete = TRUE;
+        break;
+      }
+      if (ChildHandle == NULL) {
+        break;
+      }
+      AmlAddNamespaceObject (CurrentIndex, (EFI_AML_HANDLE *)ChildHandle);
+    }
+  } else {
+    AmlAddNamespaceObject (CurrentIndex, AmlHandle);
+  }
+
+  InsertTailList (&mAmlNamespaceIndexList, &CurrentIndex->Link);
+  *NamespaceIndex = CurrentIndex;
+  return EFI_SUCCESS;
+}
+
+/**
+  Drop all namespace indexes. This must be called whenever AML may have been
+  changed or freed.
+**/
+VOID
+AmlInvalidateNamespaceIndex (
+  VOID
+  )
+{
+  EFI_AML_NAMESPACE_INDEX  *CurrentIndex;
+  UINTN                    Index;
+
+  while (!IsListEmpty (&mAmlNamespaceIndexList)) {
+    CurrentIndex = EFI_AML_NAMESPACE_INDEX_FROM_LINK (mAmlNamespaceIndexList.ForwardLink);
+    RemoveEntryList (&CurrentIndex->Link);
+    for (Index = 0; Index < CurrentIndex->ObjectCount; Index++) {
+      if (CurrentIndex->Objects[Index].RootNodeList != NULL) {
+        AmlDestructNodeList (CurrentIndex->Objects[Index].RootNodeList);
+      }
+    }
+    if (CurrentIndex->Objects != NULL) {
+      FreePool (CurrentIndex->Objects);
+    }
+    FreePool (CurrentIndex);
+  }
+}
+
+/**
+  Find an AML path in the namespace of one indexed AML object.
+
+  @param[in]    Object      Namespace object to search.
+  @param[in]    AmlPath     Points to the ACPI AML path.
+  @param[out]   Buffer      On return, points to the ACPI object which represents AmlPath,
+                            or NULL if it is not found.
+  @param[in]    FromRoot    TRUE means to find AML path from \ (Root) Node.
+                            FALSE means to find AML path from the object itself.
+
+  @retval EFI_SUCCESS           Success
+  @retval EFI_INVALID_PARAMETER Object could not be parsed.
+**/
+EFI_STATUS
+AmlFindPathInNamespaceObject (
+  IN    EFI_AML_NAMESPACE_OBJECT  *Object,
+  IN    UINT8                     *AmlPath,
+  OUT   VOID                      **Buffer,
+  IN    BOOLEAN                   FromRoot
+  )
+{
+  EFI_AML_NODE_LIST   *AmlRootNodeList;
+  EFI_AML_NODE_LIST   *AmlNodeList;
+  EFI_AML_NODE_LIST   *CurrentAmlNodeList;
+  LIST_ENTRY          *CurrentLink;
+
+  AmlRootNodeList = Object->RootNodeList;
+  if (AmlRootNodeList == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
   if (FromRoot) {
     //
     // Search from Root
@@ -594,15 +794,44 @@ AmlFindPath (
   }
 
   *Buffer = NULL;
-  Status = EFI_SUCCESS;
   if (AmlNodeList != NULL && AmlNodeList->Buffer != NULL) {
     *Buffer = AmlNodeList->Buffer;
   }
 
+  return EFI_SUCCESS;
+}
+
+/**
+  Returns the handle of the ACPI object representing the specified ACPI AML path
+
+  @param[in]    AmlHandle   Points to the handle of the object representing the starting point for the path search.
+  @param[in]    AmlPath     Points to the ACPI AML path.
+  @param[out]   Buffer      On return, points to the ACPI object which represents AcpiPath, relative to
+                            HandleIn.
+  @param[in]    FromRoot    TRUE means to find AML path from \ (Root) Node.
+                            FALSE means to find AML path from this Node (The HandleIn).
+
+  @retval EFI_SUCCESS           Success
+  @retval EFI_INVALID_PARAMETER HandleIn does not refer to a valid ACPI object.
+**/
+EFI_STATUS
+AmlFindPath (
+  IN    EFI_AML_HANDLE  *AmlHandle,
+  IN    UINT8           *AmlPath,
+  OUT   VOID            **Buffer,
+  IN    BOOLEAN         FromRoot
+  )
+{
+  EFI_AML_NAMESPACE_INDEX  *NamespaceIndex;
+  EFI_STATUS               Status;
+
   //
-  // 3. free the tree
+  // The namespace of AmlHandle is parsed once and kept in the namespace index.
   //
-  AmlDestructNodeList (AmlRootNodeList);
+  Status = AmlGetNamespaceIndex (AmlHandle, &NamespaceIndex);
+  if (EFI_ERROR (Status) || (NamespaceIndex->ObjectCount == 0)) {
+    return EFI_INVALID_PARAMETER;
+  }
 
-  return Status;
+  return AmlFindPathInNamespaceObject (&NamespaceIndex->Objects[0], AmlPath, Buffer, FromRoot);
 }
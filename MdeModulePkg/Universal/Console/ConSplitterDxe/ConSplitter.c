@@ -4618,8 +4618,7 @@ ConSplitterTextOutOutputString (
   EFI_STATUS                      ReturnStatus;
   UINTN                           MaxColumn;
   UINTN                           MaxRow;
-
-  This->SetAttribute (This, This->Mode->Attribute);
+  EFI_SIMPLE_TEXT_OUTPUT_PROTOCOL *TextOut;
 
   Private         = TEXT_OUT_SPLITTER_PRIVATE_DATA_FROM_THIS (This);
 
@@ -4627,6 +4626,16 @@ ConSplitterTextOutOutputString (
   // return the worst status met
   //
   for (Index = 0, ReturnStatus = EFI_SUCCESS; Index < Private->CurrentNumberOfConsoles; Index++) {
+    //
+    // Only resync the attribute of the consoles that lost it. Setting the
+    // same attribute again is not free: the graphics console redraws its
+    // cursor twice for it, for every string.
+    //
+    TextOut = Private->TextOutList[Index].TextOut;
+    if (TextOut->Mode->Attribute != This->Mode->Attribute) {
+      TextOut->SetAttribute (TextOut, This->Mode->Attribute);
+    }
+
     Status = Private->TextOutList[Index].TextOut->OutputString (
                                                     Private->TextOutList[Index].TextOut,
                                                     WString
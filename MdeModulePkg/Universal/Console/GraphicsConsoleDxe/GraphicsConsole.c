@@ -635,6 +635,10 @@ Error:
       FreePool (Private->LineBuffer);
     }
 
+    if (Private->ShadowBuffer != NULL) {
+      FreePool (Private->ShadowBuffer);
+    }
+
     if (Private->ModeData != NULL) {
       FreePool (Private->ModeData);
     }
@@ -723,6 +727,10 @@ GraphicsConsoleControllerDriverStop (
       FreePool (Private->LineBuffer);
     }
 
+    if (Private->ShadowBuffer != NULL) {
+      FreePool (Private->ShadowBuffer);
+    }
+
     if (Private->ModeData != NULL) {
       FreePool (Private->ModeData);
     }
@@ -954,6 +962,12 @@ GraphicsConsoleConOutOutputString (
   //
   GetTextColors (This, &Foreground, &Background);
 
+  //
+  // Updates of the shadow buffer, including those of the nested OutputString()
+  // calls below, are written to the screen once when the string is done.
+  //
+  Private->ShadowFlushDepth++;
+
   FlushCursor (This);
 
   Warning = FALSE;
@@ -997,7 +1011,19 @@ GraphicsConsoleConOutOutputString (
       // down one row.
       //
       if (This->Mode->CursorRow == (INT32) (MaxRow - 1)) {
-        if (GraphicsOutput != NULL) {
+        if (Private->ShadowBuffer != NULL) {
+          //
+          // Scroll the shadow buffer up one row and clear the last row, so that
+          // nothing has to be read back from the frame buffer.
+          //
+          CopyMem (
+            Private->ShadowBuffer,
+            Private->ShadowBuffer + Width * EFI_GLYPH_HEIGHT,
+            Delta * Height
+            );
+          GraphicsConsoleFillShadow (Private, Height, EFI_GLYPH_HEIGHT, &Background);
+          GraphicsConsoleMarkDirty (Private, 0, 0, Width, Height + EFI_GLYPH_HEIGHT);
+        } else if (GraphicsOutput != NULL) {
           //
           // Scroll Screen Up One Row
           //
@@ -1154,6 +1180,9 @@ GraphicsConsoleConOutOutputString (
 
   FlushCursor (This);
 
+  Private->ShadowFlushDepth--;
+  GraphicsConsoleFlushShadow (This);
+
   if (Warning) {
     Status = EFI_WARN_UNKNOWN_GLYPH;
   }
@@ -1353,6 +1382,11 @@ GraphicsConsoleConOutSetMode (
     FreePool (Private->LineBuffer);
   }
 
+  if (Private->ShadowBuffer != NULL) {
+    FreePool (Private->ShadowBuffer);
+    Private->ShadowBuffer = NULL;
+  }
+
   //
   // Attempt to allocate a line buffer for the requested mode number
   //
@@ -1372,6 +1406,21 @@ GraphicsConsoleConOutSetMode (
   //
   Private->LineBuffer = NewLineBuffer;
 
+  if (FeaturePcdGet (PcdGraphicsConsoleShadowBuffer) && (GraphicsOutput != NULL)) {
+    //
+    // The display is cleared to black below, which is what the zeroed shadow
+    // buffer holds. Without a shadow buffer the console draws to the screen
+    // directly.
+    //
+    Private->ShadowWidth  = ModeData->Columns * EFI_GLYPH_WIDTH;
+    Private->ShadowHeight = ModeData->Rows * EFI_GLYPH_HEIGHT;
+    Private->ShadowBuffer = AllocateZeroPool (
+                              sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL) * Private->ShadowWidth * Private->ShadowHeight
+                              );
+    Private->DirtyRight   = 0;
+    Private->DirtyBottom  = 0;
+  }
+
   if (GraphicsOutput != NULL) {
     if (ModeData->GopModeNumber != GraphicsOutput->Mode->Mode) {
       //
@@ -1559,6 +1608,16 @@ GraphicsConsoleConOutClearScreen (
   ModeData  = &(Private->ModeData[This->Mode->Mode]);
 
   GetTextColors (This, &Foreground, &Background);
+  if (Private->ShadowBuffer != NULL) {
+    //
+    // The whole screen is filled below, so the shadow buffer only has to be
+    // brought in line with it.
+    //
+    GraphicsConsoleFillShadow (Private, 0, Private->ShadowHeight, &Background);
+    Private->DirtyRight  = 0;
+    Private->DirtyBottom = 0;
+  }
+
   if (GraphicsOutput != NULL) {
     Status = GraphicsOutput->Blt (
                         GraphicsOutput,
@@ -1798,7 +1857,43 @@ DrawUnicodeWeightAtCursorN (
   //
   GetTextColors (This, &FontInfo->ForegroundColor, &FontInfo->BackgroundColor);
 
-  if (Private->GraphicsOutput != NULL) {
+  if (Private->ShadowBuffer != NULL) {
+    //
+    // Render the string into the shadow buffer. The caller writes the dirty
+    // region to the screen.
+    //
+    Blt->Width        = (UINT16) Private->ShadowWidth;
+    Blt->Height       = (UINT16) Private->ShadowHeight;
+    Blt->Image.Bitmap = Private->ShadowBuffer;
+
+    RowInfoArray     = NULL;
+    RowInfoArraySize = 0;
+    Status = mHiiFont->StringToImage (
+                          mHiiFont,
+                          EFI_HII_IGNORE_IF_NO_GLYPH | EFI_HII_IGNORE_LINE_BREAK,
+                          String,
+                          FontInfo,
+                          &Blt,
+                          This->Mode->CursorColumn * EFI_GLYPH_WIDTH,
+                          This->Mode->CursorRow * EFI_GLYPH_HEIGHT,
+                          &RowInfoArray,
+                          &RowInfoArraySize,
+                          NULL
+                          );
+    if (!EFI_ERROR (Status) && (RowInfoArraySize != 0)) {
+      GraphicsConsoleMarkDirty (
+        Private,
+        This->Mode->CursorColumn * EFI_GLYPH_WIDTH,
+        This->Mode->CursorRow * EFI_GLYPH_HEIGHT,
+        RowInfoArray[0].LineWidth,
+        RowInfoArray[0].LineHeight
+        );
+    }
+
+    if (RowInfoArray != NULL) {
+      FreePool (RowInfoArray);
+    }
+  } else if (Private->GraphicsOutput != NULL) {
     //
     // If Graphics Output protocol exists, using HII Font protocol to draw.
     //
@@ -1917,6 +2012,7 @@ FlushCursor (
   EFI_GRAPHICS_OUTPUT_BLT_PIXEL_UNION Foreground;
   EFI_GRAPHICS_OUTPUT_BLT_PIXEL_UNION Background;
   EFI_GRAPHICS_OUTPUT_BLT_PIXEL_UNION BltChar[EFI_GLYPH_HEIGHT][EFI_GLYPH_WIDTH];
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL_UNION *Pixel;
   UINTN                               PosX;
   UINTN                               PosY;
 
@@ -1930,6 +2026,36 @@ FlushCursor (
   GraphicsOutput = Private->GraphicsOutput;
   UgaDraw = Private->UgaDraw;
 
+  if (Private->ShadowBuffer != NULL) {
+    //
+    // OutputString() flushes the cursor once the cursor column has moved past
+    // the last column, which is outside of the shadow buffer. The cursor is
+    // toggled again before it is drawn anywhere else, so nothing is lost by
+    // skipping it.
+    //
+    GlyphX = CurrentMode->CursorColumn * EFI_GLYPH_WIDTH;
+    GlyphY = CurrentMode->CursorRow * EFI_GLYPH_HEIGHT;
+    if ((GlyphX < 0) || ((UINTN) GlyphX + EFI_GLYPH_WIDTH > Private->ShadowWidth) ||
+        (GlyphY < 0) || ((UINTN) GlyphY + EFI_GLYPH_HEIGHT > Private->ShadowHeight)) {
+      return EFI_SUCCESS;
+    }
+
+    GetTextColors (This, &Foreground.Pixel, &Background.Pixel);
+
+    Pixel = (EFI_GRAPHICS_OUTPUT_BLT_PIXEL_UNION *) Private->ShadowBuffer + GlyphY * Private->ShadowWidth + GlyphX;
+    for (PosY = 0; PosY < EFI_GLYPH_HEIGHT; PosY++, Pixel += Private->ShadowWidth) {
+      for (PosX = 0; PosX < EFI_GLYPH_WIDTH; PosX++) {
+        if ((mCursorGlyph.GlyphCol1[PosY] & (BIT0 << PosX)) != 0) {
+          Pixel[EFI_GLYPH_WIDTH - PosX - 1].Raw ^= Foreground.Raw;
+        }
+      }
+    }
+
+    GraphicsConsoleMarkDirty (Private, GlyphX, GlyphY, EFI_GLYPH_WIDTH, EFI_GLYPH_HEIGHT);
+    GraphicsConsoleFlushShadow (This);
+    return EFI_SUCCESS;
+  }
+
   //
   // In this driver, only narrow character was supported.
   //
@@ -2010,6 +2136,117 @@ FlushCursor (
   return EFI_SUCCESS;
 }
 
+/**
+  Fill whole rows of pixels of the shadow buffer with one color.
+
+  @param  Private               The Graphics Console device.
+  @param  Y                     The first row of pixels to fill.
+  @param  Height                The number of rows of pixels to fill.
+  @param  Color                 The color to fill with.
+
+**/
+VOID
+GraphicsConsoleFillShadow (
+  IN  GRAPHICS_CONSOLE_DEV           *Private,
+  IN  UINTN                          Y,
+  IN  UINTN                          Height,
+  IN  EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *Color
+  )
+{
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL_UNION  Fill;
+
+  Fill.Pixel = *Color;
+  SetMem32 (
+    Private->ShadowBuffer + Y * Private->ShadowWidth,
+    Height * Private->ShadowWidth * sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL),
+    Fill.Raw
+    );
+}
+
+/**
+  Add a rectangle of the shadow buffer to the region that must be written to
+  the screen by the next GraphicsConsoleFlushShadow().
+
+  @param  Private               The Graphics Console device.
+  @param  X                     The left edge of the rectangle in the text area.
+  @param  Y                     The top edge of the rectangle in the text area.
+  @param  Width                 The width of the rectangle.
+  @param  Height                The height of the rectangle.
+
+**/
+VOID
+GraphicsConsoleMarkDirty (
+  IN  GRAPHICS_CONSOLE_DEV  *Private,
+  IN  UINTN                 X,
+  IN  UINTN                 Y,
+  IN  UINTN                 Width,
+  IN  UINTN                 Height
+  )
+{
+  if ((Width == 0) || (Height == 0)) {
+    return;
+  }
+
+  if ((Private->DirtyRight == 0) || (Private->DirtyBottom == 0)) {
+    Private->DirtyLeft   = X;
+    Private->DirtyTop    = Y;
+    Private->DirtyRight  = X + Width;
+    Private->DirtyBottom = Y + Height;
+  } else {
+    Private->DirtyLeft   = MIN (Private->DirtyLeft, X);
+    Private->DirtyTop    = MIN (Private->DirtyTop, Y);
+    Private->DirtyRight  = MAX (Private->DirtyRight, X + Width);
+    Private->DirtyBottom = MAX (Private->DirtyBottom, Y + Height);
+  }
+
+  Private->DirtyRight  = MIN (Private->DirtyRight, Private->ShadowWidth);
+  Private->DirtyBottom = MIN (Private->DirtyBottom, Private->ShadowHeight);
+}
+
+/**
+  Write the dirty region of the shadow buffer to the screen in one BLT.
+
+  Nothing is written while a call that batches its output, such as
+  OutputString(), is in progress.
+
+  @param  This                  Protocol instance pointer.
+
+  @retval EFI_SUCCESS           The dirty region is written, or there is none.
+  @retval other                 The BLT to the Graphics Output device failed.
+
+**/
+EFI_STATUS
+GraphicsConsoleFlushShadow (
+  IN  EFI_SIMPLE_TEXT_OUTPUT_PROTOCOL  *This
+  )
+{
+  GRAPHICS_CONSOLE_DEV  *Private;
+  EFI_STATUS            Status;
+
+  Private = GRAPHICS_CONSOLE_CON_OUT_DEV_FROM_THIS (This);
+  if ((Private->ShadowBuffer == NULL) || (Private->ShadowFlushDepth != 0) ||
+      (Private->DirtyLeft >= Private->DirtyRight) || (Private->DirtyTop >= Private->DirtyBottom)) {
+    return EFI_SUCCESS;
+  }
+
+  Status = Private->GraphicsOutput->Blt (
+                                      Private->GraphicsOutput,
+                                      Private->ShadowBuffer,
+                                      EfiBltBufferToVideo,
+                                      Private->DirtyLeft,
+                                      Private->DirtyTop,
+                                      Private->DirtyLeft + Private->ModeData[This->Mode->Mode].DeltaX,
+                                      Private->DirtyTop + Private->ModeData[This->Mode->Mode].DeltaY,
+                                      Private->DirtyRight - Private->DirtyLeft,
+                                      Private->DirtyBottom - Private->DirtyTop,
+                                      Private->ShadowWidth * sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL)
+                                      );
+
+  Private->DirtyRight  = 0;
+  Private->DirtyBottom = 0;
+  return Status;
+}
+
 /**
   HII Database Protocol notification event handler.
 
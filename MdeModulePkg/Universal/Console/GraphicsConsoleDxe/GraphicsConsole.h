@@ -65,6 +65,20 @@ typedef struct {
   EFI_SIMPLE_TEXT_OUTPUT_MODE      SimpleTextOutputMode;
   GRAPHICS_CONSOLE_MODE_DATA       *ModeData;
   EFI_GRAPHICS_OUTPUT_BLT_PIXEL    *LineBuffer;
+  //
+  // Copy of the text area of the current mode, used when PcdGraphicsConsoleShadowBuffer
+  // is TRUE. The dirty rectangle [DirtyLeft, DirtyRight) x [DirtyTop, DirtyBottom) is
+  // in pixels relative to the text area, and is written to the GOP device in one BLT
+  // when ShadowFlushDepth drops to zero.
+  //
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL    *ShadowBuffer;
+  UINTN                            ShadowWidth;
+  UINTN                            ShadowHeight;
+  UINTN                            DirtyLeft;
+  UINTN                            DirtyTop;
+  UINTN                            DirtyRight;
+  UINTN                            DirtyBottom;
+  UINTN                            ShadowFlushDepth;
 } GRAPHICS_CONSOLE_DEV;
 
 #define GRAPHICS_CONSOLE_CON_OUT_DEV_FROM_THIS(a) \
@@ -564,6 +578,60 @@ FlushCursor (
   IN  EFI_SIMPLE_TEXT_OUTPUT_PROTOCOL  *This
   );
 
+/**
+  Fill whole rows of pixels of the shadow buffer with one color.
+
+  @param  Private               The Graphics Console device.
+  @param  Y                     The first row of pixels to fill.
+  @param  Height                The number of rows of pixels to fill.
+  @param  Color                 The color to fill with.
+
+**/
+VOID
+GraphicsConsoleFillShadow (
+  IN  GRAPHICS_CONSOLE_DEV           *Private,
+  IN  UINTN                          Y,
+  IN  UINTN                          Height,
+  IN  EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *Color
+  );
+
+/**
+  Add a rectangle of the shadow buffer to the region that must be written to
+  the screen by the next GraphicsConsoleFlushShadow().
+
+  @param  Private               The Graphics Console device.
+  @param  X                     The left edge of the rectangle in the text area.
+  @param  Y                     The top edge of the rectangle in the text area.
+  @param  Width                 The width of the rectangle.
+  @param  Height                The height of the rectangle.
+
+**/
+VOID
+GraphicsConsoleMarkDirty (
+  IN  GRAPHICS_CONSOLE_DEV  *Private,
+  IN  UINTN                 X,
+  IN  UINTN                 Y,
+  IN  UINTN                 Width,
+  IN  UINTN                 Height
+  );
+
+/**
+  Write the dirty region of the shadow buffer to the screen in one BLT.
+
+  Nothing is written while a call that batches its output, such as
+  OutputString(), is in progress.
+
+  @param  This                  Protocol instance pointer.
+
+  @retval EFI_SUCCESS           The dirty region is written, or there is none.
+  @retval other                 The BLT to the Graphics Output device failed.
+
+**/
+EFI_STATUS
+GraphicsConsoleFlushShadow (
+  IN  EFI_SIMPLE_TEXT_OUTPUT_PROTOCOL  *This
+  );
+
 /**
   Check if the current specific mode supported the user defined resolution
   for the Graphics Console device based on Graphics Output Protocol.
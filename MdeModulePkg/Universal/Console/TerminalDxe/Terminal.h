@@ -65,6 +65,13 @@ typedef struct {
 
 #define KEYBOARD_TIMER_INTERVAL         200000  // 0.02s
 
+//
+// Size of the buffer used by OutputString() to collect the converted
+// characters before handing them to the Serial I/O protocol in one write.
+// It must be able to hold at least one UTF-8 character plus a CR LF pair.
+//
+#define TERMINAL_OUTPUT_BUFFER_SIZE     256
+
 #define TERMINAL_DEV_SIGNATURE  SIGNATURE_32 ('t', 'm', 'n', 'l')
 
 #define TERMINAL_CONSOLE_IN_EX_NOTIFY_SIGNATURE SIGNATURE_32 ('t', 'm', 'e', 'n')
@@ -448,6 +455,28 @@ TerminalConOutOutputString (
   IN  CHAR16                            *WString
   );
 
+/**
+  Write the bytes collected by TerminalConOutOutputString() to the serial
+  device in a single Serial I/O write.
+
+  @param  TerminalDevice          The terminal device to write to.
+  @param  Buffer                  The bytes to write.
+  @param  Length                  On input, the number of bytes in Buffer.
+                                  On output, set to zero so that the caller
+                                  can start collecting bytes again.
+
+  @retval EFI_SUCCESS             The bytes are written, or there is nothing
+                                  to write.
+  @retval Others                  The serial device failed to write the bytes.
+
+**/
+EFI_STATUS
+TerminalConOutWriteBuffer (
+  IN     TERMINAL_DEV  *TerminalDevice,
+  IN     CHAR8         *Buffer,
+  IN OUT UINTN         *Length
+  );
+
 /**
   Implements EFI_SIMPLE_TEXT_OUTPUT_PROTOCOL.TestString().
   If one of the characters in the *Wstring is
@@ -148,6 +148,46 @@ TerminalConOutReset (
 }
 
 
+/**
+  Write the bytes collected by TerminalConOutOutputString() to the serial
+  device in a single Serial I/O write.
+
+  @param  TerminalDevice          The terminal device to write to.
+  @param  Buffer                  The bytes to write.
+  @param  Length                  On input, the number of bytes in Buffer.
+                                  On output, set to zero so that the caller
+                                  can start collecting bytes again.
+
+  @retval EFI_SUCCESS             The bytes are written, or there is nothing
+                                  to write.
+  @retval Others                  The serial device failed to write the bytes.
+
+**/
+EFI_STATUS
+TerminalConOutWriteBuffer (
+  IN     TERMINAL_DEV  *TerminalDevice,
+  IN     CHAR8         *Buffer,
+  IN OUT UINTN         *Length
+  )
+{
+  EFI_STATUS  Status;
+  UINTN       WriteLength;
+
+  if (*Length == 0) {
+    return EFI_SUCCESS;
+  }
+
+  WriteLength = *Length;
+  *Length     = 0;
+
+  Status = TerminalDevice->SerialIo->Write (
+                                      TerminalDevice->SerialIo,
+                                      &WriteLength,
+                                      Buffer
+                                      );
+  return Status;
+}
+
 /**
   Implements EFI_SIMPLE_TEXT_OUTPUT_PROTOCOL.OutputString().
 
@@ -176,22 +216,23 @@ TerminalConOutOutputString (
   EFI_SIMPLE_TEXT_OUTPUT_MODE *Mode;
   UINTN                       MaxColumn;
   UINTN                       MaxRow;
-  UINTN                       Length;
   UTF8_CHAR                   Utf8Char;
   CHAR8                       GraphicChar;
   CHAR8                       AsciiChar;
   EFI_STATUS                  Status;
   UINT8                       ValidBytes;
-  CHAR8                       CrLfStr[2];
+  CHAR8                       OutputBuffer[TERMINAL_OUTPUT_BUFFER_SIZE];
+  UINTN                       OutputLength;
   //
   //  flag used to indicate whether condition happens which will cause
   //  return EFI_WARN_UNKNOWN_GLYPH
   //
   BOOLEAN                     Warning;
 
-  ValidBytes  = 0;
-  Warning     = FALSE;
-  AsciiChar   = 0;
+  ValidBytes    = 0;
+  Warning       = FALSE;
+  AsciiChar     = 0;
+  OutputLength  = 0;
 
   //
   //  get Terminal device data structure pointer.
@@ -215,6 +256,17 @@ TerminalConOutOutputString (
           );
 
   for (; *WString != CHAR_NULL; WString++) {
+    //
+    // Flush the collected bytes when there might not be enough room left
+    // for the longest sequence one character can produce (a UTF-8
+    // character followed by the TtyTerm CR LF).
+    //
+    if (OutputLength > sizeof (OutputBuffer) - sizeof (UTF8_CHAR) - 2) {
+      Status = TerminalConOutWriteBuffer (TerminalDevice, OutputBuffer, &OutputLength);
+      if (EFI_ERROR (Status)) {
+        goto OutputError;
+      }
+    }
 
     switch (TerminalDevice->TerminalType) {
 
@@ -255,31 +307,13 @@ TerminalConOutOutputString (
         GraphicChar = AsciiChar;
       }
 
-      Length = 1;
-
-      Status = TerminalDevice->SerialIo->Write (
-                                          TerminalDevice->SerialIo,
-                                          &Length,
-                                          &GraphicChar
-                                          );
-
-      if (EFI_ERROR (Status)) {
-        goto OutputError;
-      }
-
+      OutputBuffer[OutputLength++] = GraphicChar;
       break;
 
     case TerminalTypeVtUtf8:
       UnicodeToUtf8 (*WString, &Utf8Char, &ValidBytes);
-      Length = ValidBytes;
-      Status = TerminalDevice->SerialIo->Write (
-                                          TerminalDevice->SerialIo,
-                                          &Length,
-                                          (UINT8 *) &Utf8Char
-                                          );
-      if (EFI_ERROR (Status)) {
-        goto OutputError;
-      }
+      CopyMem (&OutputBuffer[OutputLength], &Utf8Char, ValidBytes);
+      OutputLength += ValidBytes;
       break;
     }
     //
@@ -325,20 +359,8 @@ TerminalConOutOutputString (
           // the driver, but only if we're not in the middle of
           // printing an escape sequence.
           //
-          CrLfStr[0] = '\r';
-          CrLfStr[1] = '\n';
-
-          Length = sizeof(CrLfStr);
-
-          Status = TerminalDevice->SerialIo->Write (
-                                                TerminalDevice->SerialIo,
-                                                &Length,
-                                                CrLfStr
-                                                );
-
-          if (EFI_ERROR (Status)) {
-            goto OutputError;
-          }
+          OutputBuffer[OutputLength++] = '\r';
+          OutputBuffer[OutputLength++] = '\n';
         }
       }
       break;
@@ -347,6 +369,11 @@ TerminalConOutOutputString (
 
   }
 
+  Status = TerminalConOutWriteBuffer (TerminalDevice, OutputBuffer, &OutputLength);
+  if (EFI_ERROR (Status)) {
+    goto OutputError;
+  }
+
   if (Warning) {
     return EFI_WARN_UNKNOWN_GLYPH;
   }
@@ -157,6 +157,21 @@ DiskIoDriverBindingStart (
     gDiskIoPrivateDataTemplate.BlockIo2 = NULL;
   }
 
+  //
+  // Reads are served straight from memory if the media supports it.
+  //
+  Status = gBS->OpenProtocol (
+                  ControllerHandle,
+                  &gEdkiiBlockIoDirectAccessProtocolGuid,
+                  (VOID **) &gDiskIoPrivateDataTemplate.DirectAccess,
+                  This->DriverBindingHandle,
+                  ControllerHandle,
+                  EFI_OPEN_PROTOCOL_BY_DRIVER
+                  );
+  if (EFI_ERROR (Status)) {
+    gDiskIoPrivateDataTemplate.DirectAccess = NULL;
+  }
+
   //
   // Initialize the Disk IO device instance.
   //
@@ -216,6 +231,15 @@ ErrorExit:
       FreePool (Instance);
     }
 
+    if (gDiskIoPrivateDataTemplate.DirectAccess != NULL) {
+      gBS->CloseProtocol (
+             ControllerHandle,
+             &gEdkiiBlockIoDirectAccessProtocolGuid,
+             This->DriverBindingHandle,
+             ControllerHandle
+             );
+    }
+
     gBS->CloseProtocol (
            ControllerHandle,
            &gEfiBlockIoProtocolGuid,
@@ -337,6 +361,15 @@ DiskIoDriverBindingStop (
                       );
       ASSERT_EFI_ERROR (Status);
     }
+    if (Instance->DirectAccess != NULL) {
+      Status = gBS->CloseProtocol (
+                      ControllerHandle,
+                      &gEdkiiBlockIoDirectAccessProtocolGuid,
+                      This->DriverBindingHandle,
+                      ControllerHandle
+                      );
+      ASSERT_EFI_ERROR (Status);
+    }
 
     FreePool (Instance);
   }
@@ -782,6 +815,70 @@ DiskIo2RemoveCompletedTask (
   return QueueEmpty;
 }
 
+/**
+  Read the disk through the direct access protocol of the media, copying the
+  data straight into the caller's buffer without splitting the request into
+  block aligned pieces.
+
+  @param Instance    Pointer to the DISK_IO_PRIVATE_DATA.
+  @param MediaId     ID of the medium to read.
+  @param Offset      The starting byte offset on the logical block I/O device to read from.
+  @param BufferSize  The size in bytes of Buffer. The number of bytes to read from the device.
+  @param Buffer      A pointer to the destination buffer for the data.
+
+  @retval EFI_SUCCESS       The data was read correctly from the device.
+  @retval EFI_UNSUPPORTED   The request must go through the Block IO protocols;
+                            nothing was read.
+  @retval other             The status reported by the direct access protocol.
+**/
+EFI_STATUS
+DiskIoDirectReadDisk (
+  IN DISK_IO_PRIVATE_DATA     *Instance,
+  IN UINT32                   MediaId,
+  IN UINT64                   Offset,
+  IN UINTN                    BufferSize,
+  IN UINT8                    *Buffer
+  )
+{
+  EFI_STATUS                             Status;
+  EDKII_BLOCK_IO_DIRECT_ACCESS_PROTOCOL  *DirectAccess;
+  UINT32                                 BlockSize;
+  EFI_LBA                                Lba;
+  UINT32                                 Remainder;
+  UINTN                                  Length;
+  CONST UINT8                            *Address;
+
+  DirectAccess = Instance->DirectAccess;
+  BlockSize    = Instance->BlockIo->Media->BlockSize;
+
+  if (BufferSize == 0) {
+    return EFI_UNSUPPORTED;
+  }
+
+  Status = EFI_SUCCESS;
+  while (BufferSize > 0) {
+    Lba    = DivU64x32Remainder (Offset, BlockSize, &Remainder);
+    Length = MIN (BufferSize, MAX_UINTN - Remainder) + Remainder;
+    Status = DirectAccess->Map (DirectAccess, MediaId, Lba, &Length, (CONST VOID **) &Address);
+    if (EFI_ERROR (Status)) {
+      break;
+    }
+    if (Length <= Remainder) {
+      Status = EFI_INVALID_PARAMETER;
+      break;
+    }
+
+    Length = MIN (Length - Remainder, BufferSize);
+    CopyMem (Buffer, Address + Remainder, Length);
+
+    Buffer     += Length;
+    BufferSize -= Length;
+    Offset     += Length;
+  }
+
+  return Status;
+}
+
 /**
   Common routine to access the disk.
 
@@ -827,6 +924,34 @@ DiskIo2ReadWriteDisk (
   Status    = EFI_SUCCESS;
   Blocking  = (BOOLEAN) ((Token == NULL) || (Token->Event == NULL));
 
+  //
+  // Reads from memory backed media are copied in one go, once the requests
+  // queued before them have completed.
+  //
+  if (!Write && (Instance->DirectAccess != NULL)) {
+    if (Blocking) {
+      while (!DiskIo2RemoveCompletedTask (Instance));
+      Status = DiskIoDirectReadDisk (Instance, MediaId, Offset, BufferSize, Buffer);
+    } else if (DiskIo2RemoveCompletedTask (Instance)) {
+      Status = DiskIoDirectReadDisk (Instance, MediaId, Offset, BufferSize, Buffer);
+      if (!EFI_ERROR (Status)) {
+        Token->TransactionStatus = EFI_SUCCESS;
+        gBS->SignalEvent (Token->Event);
+      }
+    } else {
+      Status = EFI_UNSUPPORTED;
+    }
+
+    if (Status != EFI_UNSUPPORTED) {
+      return Status;
+    }
+    Status = EFI_SUCCESS;
+  }
+
+  if (Blocking && DiskIoCanPipelineRequest (Instance, Offset, BufferSize, Buffer)) {
+    return DiskIoPipelinedReadWriteDisk (Instance, Write, MediaId, Offset, BufferSize, Buffer);
+  }
+
   if (Blocking) {
     //
     // Wait till pending async task is completed.
@@ -983,6 +1108,202 @@ DiskIo2ReadWriteDisk (
   return Status;
 }
 
+/**
+  Check whether a blocking request should be split into several non-blocking
+  BlockIo2 requests which are kept in flight at the same time.
+
+  Only requests that produce more than one subtask benefit: those with an
+  unaligned head or tail, or with a buffer that does not meet the IoAlign
+  requirement of the device.
+
+  @param Instance    Pointer to the DISK_IO_PRIVATE_DATA.
+  @param Offset      The starting byte offset on the logical block I/O device to access.
+  @param BufferSize  The size in bytes of Buffer.
+  @param Buffer      A pointer to the buffer for the data.
+
+  @retval TRUE       The request should go through DiskIoPipelinedReadWriteDisk().
+  @retval FALSE      The request should be processed by DiskIo2ReadWriteDisk() directly.
+**/
+BOOLEAN
+DiskIoCanPipelineRequest (
+  IN DISK_IO_PRIVATE_DATA     *Instance,
+  IN UINT64                   Offset,
+  IN UINTN                    BufferSize,
+  IN UINT8                    *Buffer
+  )
+{
+  UINT32                      BlockSize;
+  UINT32                      IoAlign;
+  UINT32                      UnderRun;
+  UINTN                       HeadLength;
+  EFI_TPL                     OldTpl;
+
+  if ((Instance->BlockIo2 == NULL) || (PcdGet32 (PcdDiskIoBlockingQueueDepth) <= 1)) {
+    return FALSE;
+  }
+
+  BlockSize = Instance->BlockIo->Media->BlockSize;
+  IoAlign   = Instance->BlockIo->Media->IoAlign;
+  if (IoAlign == 0) {
+    IoAlign = 1;
+  }
+
+  if (BufferSize <= BlockSize) {
+    return FALSE;
+  }
+
+  //
+  // The subtasks complete from TPL_NOTIFY callbacks, so waiting for them
+  // is only possible below that level.
+  //
+  OldTpl = gBS->RaiseTPL (TPL_HIGH_LEVEL);
+  gBS->RestoreTPL (OldTpl);
+  if (OldTpl >= TPL_NOTIFY) {
+    return FALSE;
+  }
+
+  DivU64x32Remainder (Offset, BlockSize, &UnderRun);
+  HeadLength = (UnderRun == 0) ? 0 : (BlockSize - UnderRun);
+  if ((UnderRun != 0) || (((Offset + BufferSize) % BlockSize) != 0)) {
+    return TRUE;
+  }
+
+  return (BOOLEAN) (ALIGN_POINTER (Buffer + HeadLength, IoAlign) != Buffer + HeadLength);
+}
+
+/**
+  Process a blocking request as a pipeline of non-blocking DiskIo2 requests.
+
+  The request is cut into segments at block boundaries: a single segment
+  when the buffer meets the IoAlign requirement, so head, middle and tail are
+  issued concurrently; otherwise segments of PcdDiskIoDataBufferBlockNum blocks,
+  each with its own aligned working buffer. At most PcdDiskIoBlockingQueueDepth
+  segments are in flight at any time.
+
+  @param Instance    Pointer to the DISK_IO_PRIVATE_DATA.
+  @param Write       TRUE: Write operation; FALSE: Read operation.
+  @param MediaId     ID of the medium to access.
+  @param Offset      The starting byte offset on the logical block I/O device to access.
+  @param BufferSize  The size in bytes of Buffer.
+  @param Buffer      A pointer to the buffer for the data.
+
+  @retval EFI_SUCCESS           The data was read from or written to the device.
+  @retval EFI_OUT_OF_RESOURCES  The request could not be completed due to a lack of resources.
+  @return Others                The status of the first failed segment.
+**/
+EFI_STATUS
+DiskIoPipelinedReadWriteDisk (
+  IN DISK_IO_PRIVATE_DATA     *Instance,
+  IN BOOLEAN                  Write,
+  IN UINT32                   MediaId,
+  IN UINT64                   Offset,
+  IN UINTN                    BufferSize,
+  IN UINT8                    *Buffer
+  )
+{
+  EFI_STATUS                  Status;
+  EFI_STATUS                  SegmentStatus;
+  EFI_DISK_IO2_TOKEN          *Tokens;
+  BOOLEAN                     *Busy;
+  UINT32                      QueueDepth;
+  UINT32                      InFlight;
+  UINT32                      Index;
+  UINTN                       SegmentSize;
+  UINTN                       Length;
+  UINT32                      BlockSize;
+  UINT32                      IoAlign;
+  UINT32                      UnderRun;
+  UINTN                       HeadLength;
+
+  BlockSize  = Instance->BlockIo->Media->BlockSize;
+  IoAlign    = Instance->BlockIo->Media->IoAlign;
+  QueueDepth = PcdGet32 (PcdDiskIoBlockingQueueDepth);
+  if (IoAlign == 0) {
+    IoAlign = 1;
+  }
+
+  DivU64x32Remainder (Offset, BlockSize, &UnderRun);
+  HeadLength = (UnderRun == 0) ? 0 : (BlockSize - UnderRun);
+  if (ALIGN_POINTER (Buffer + HeadLength, IoAlign) == Buffer + HeadLength) {
+    SegmentSize = BufferSize;
+  } else {
+    SegmentSize = PcdGet32 (PcdDiskIoDataBufferBlockNum) * BlockSize;
+  }
+
+  Tokens = AllocateZeroPool (QueueDepth * (sizeof (EFI_DISK_IO2_TOKEN) + sizeof (BOOLEAN)));
+  if (Tokens == NULL) {
+    return DiskIo2ReadWriteDisk (Instance, Write, MediaId, Offset, NULL, BufferSize, Buffer);
+  }
+  Busy = (BOOLEAN *) (Tokens + QueueDepth);
+
+  Status = EFI_SUCCESS;
+  for (Index = 0; Index < QueueDepth; Index++) {
+    Status = gBS->CreateEvent (0, TPL_CALLBACK, NULL, NULL, &Tokens[Index].Event);
+    if (EFI_ERROR (Status)) {
+      break;
+    }
+  }
+
+  if (EFI_ERROR (Status)) {
+    while (Index-- > 0) {
+      gBS->CloseEvent (Tokens[Index].Event);
+    }
+    FreePool (Tokens);
+    return DiskIo2ReadWriteDisk (Instance, Write, MediaId, Offset, NULL, BufferSize, Buffer);
+  }
+
+  //
+  // Keep the ordering guarantee of blocking requests: wait till the pending
+  // async tasks are completed.
+  //
+  while (!DiskIo2RemoveCompletedTask (Instance));
+
+  InFlight = 0;
+  do {
+    for (Index = 0; Index < QueueDepth; Index++) {
+      if (Busy[Index] && (gBS->CheckEvent (Tokens[Index].Event) == EFI_SUCCESS)) {
+        Busy[Index] = FALSE;
+        InFlight--;
+        if (EFI_ERROR (Tokens[Index].TransactionStatus) && !EFI_ERROR (Status)) {
+          Status = Tokens[Index].TransactionStatus;
+        }
+      }
+
+      if (Busy[Index] || (BufferSize == 0) || EFI_ERROR (Status)) {
+        continue;
+      }
+
+      //
+      // Segments end on SegmentSize boundaries of the device offset, so all
+      // but the first and the last one are made of whole blocks.
+      //
+      Length = BufferSize;
+      if (SegmentSize < BufferSize) {
+        Length = MIN (BufferSize, SegmentSize - (UINTN) ModU64x32 (Offset, (UINT32) SegmentSize));
+      }
+
+      SegmentStatus = DiskIo2ReadWriteDisk (Instance, Write, MediaId, Offset, &Tokens[Index], Length, Buffer);
+      if (EFI_ERROR (SegmentStatus)) {
+        Status = SegmentStatus;
+        continue;
+      }
+
+      Busy[Index] = TRUE;
+      InFlight++;
+      Offset     += Length;
+      Buffer     += Length;
+      BufferSize -= Length;
+    }
+  } while ((InFlight > 0) || ((BufferSize > 0) && !EFI_ERROR (Status)));
+
+  for (Index = 0; Index < QueueDepth; Index++) {
+    gBS->CloseEvent (Tokens[Index].Event);
+  }
+  FreePool (Tokens);
+
+  return Status;
+}
+
 /**
   Reads a specified number of bytes from a device.
 
@@ -12,6 +12,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Uefi.h>
 #include <Protocol/BlockIo.h>
 #include <Protocol/BlockIo2.h>
+#include <Protocol/BlockIoDirectAccess.h>
 #include <Protocol/DiskIo2.h>
 #include <Protocol/ComponentName.h>
 #include <Protocol/DriverBinding.h>
@@ -23,6 +24,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Library/BaseMemoryLib.h>
 #include <Library/MemoryAllocationLib.h>
 #include <Library/UefiBootServicesTableLib.h>
+#include <Library/PcdLib.h>
 
 #define DISK_IO_PRIVATE_DATA_SIGNATURE  SIGNATURE_32 ('d', 's', 'k', 'I')
 typedef struct {
@@ -32,6 +34,7 @@ typedef struct {
   EFI_DISK_IO2_PROTOCOL           DiskIo2;
   EFI_BLOCK_IO_PROTOCOL           *BlockIo;
   EFI_BLOCK_IO2_PROTOCOL          *BlockIo2;
+  EDKII_BLOCK_IO_DIRECT_ACCESS_PROTOCOL *DirectAccess;
 
   UINT8                           *SharedWorkingBuffer;
 
@@ -231,6 +234,87 @@ DiskIoWriteDisk (
   );
 
 
+/**
+  Check whether a blocking request should be split into several non-blocking
+  BlockIo2 requests which are kept in flight at the same time.
+
+  @param Instance    Pointer to the DISK_IO_PRIVATE_DATA.
+  @param Offset      The starting byte offset on the logical block I/O device to access.
+  @param BufferSize  The size in bytes of Buffer.
+  @param Buffer      A pointer to the buffer for the data.
+
+  @retval TRUE       The request should go through DiskIoPipelinedReadWriteDisk().
+  @retval FALSE      The request should be processed by DiskIo2ReadWriteDisk() directly.
+**/
+BOOLEAN
+DiskIoCanPipelineRequest (
+  IN DISK_IO_PRIVATE_DATA     *Instance,
+  IN UINT64                   Offset,
+  IN UINTN                    BufferSize,
+  IN UINT8                    *Buffer
+  );
+
+/**
+  Process a blocking request as a pipeline of non-blocking DiskIo2 requests,
+  keeping at most PcdDiskIoBlockingQueueDepth of them in flight.
+
+  @param Instance    Pointer to the DISK_IO_PRIVATE_DATA.
+  @param Write       TRUE: Write operation; FALSE: Read operation.
+  @param MediaId     ID of the medium to access.
+  @param Offset      The starting byte offset on the logical block I/O device to access.
+  @param BufferSize  The size in bytes of Buffer.
+  @param Buffer      A pointer to the buffer for the data.
+
+  @retval EFI_SUCCESS           The data was read from or written to the device.
+  @retval EFI_OUT_OF_RESOURCES  The request could not be completed due to a lack of resources.
+  @return Others                The status of the first failed segment.
+**/
+EFI_STATUS
+DiskIoPipelinedReadWriteDisk (
+  IN DISK_IO_PRIVATE_DATA     *Instance,
+  IN BOOLEAN                  Write,
+  IN UINT32                   MediaId,
+  IN UINT64                   Offset,
+  IN UINTN                    BufferSize,
+  IN UINT8                    *Buffer
+  );
+
+/**
+  Common routine to access the disk.
+
+  @param Instance    Pointer to the DISK_IO_PRIVATE_DATA.
+  @param Write       TRUE: Write operation; FALSE: Read operation.
+  @param MediaId     ID of the medium to access.
+  @param Offset      The starting byte offset on the logical block I/O device to access.
+  @param Token       A pointer to the token associated with the transaction.
+                     If this field is NULL, synchronous/blocking IO is performed.
+  @param BufferSize  The size in bytes of Buffer.
+  @param Buffer      A pointer to the buffer for the data.
+**/
+EFI_STATUS
+DiskIo2ReadWriteDisk (
+  IN DISK_IO_PRIVATE_DATA     *Instance,
+  IN BOOLEAN                  Write,
+  IN UINT32                   MediaId,
+  IN UINT64                   Offset,
+  IN EFI_DISK_IO2_TOKEN       *Token,
+  IN UINTN                    BufferSize,
+  IN UINT8                    *Buffer
+  );
+
+/**
+  Remove the completed tasks from Instance->TaskQueue. Completed tasks are those who don't have any subtasks.
+
+  @param Instance    Pointer to the DISK_IO_PRIVATE_DATA.
+
+  @retval TRUE       The Instance->TaskQueue is empty after the completed tasks are removed.
+  @retval FALSE      The Instance->TaskQueue is not empty after the completed tasks are removed.
+**/
+BOOLEAN
+DiskIo2RemoveCompletedTask (
+  IN DISK_IO_PRIVATE_DATA     *Instance
+  );
+
 /**
   Terminate outstanding asynchronous requests to a device.
 
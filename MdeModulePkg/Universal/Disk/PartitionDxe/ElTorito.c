@@ -88,7 +88,7 @@ PartitionInstallElToritoChildHandles (
   for (VolDescriptorOffset = SIZE_32KB;
        VolDescriptorOffset <= MultU64x32 (Media->LastBlock, Media->BlockSize);
        VolDescriptorOffset += SIZE_2KB) {
-    Status = DiskIo->ReadDisk (
+    Status = PartitionReadDisk (
                        DiskIo,
                        Media->MediaId,
                        VolDescriptorOffset,
@@ -133,7 +133,7 @@ PartitionInstallElToritoChildHandles (
       continue;
     }
 
-    Status = DiskIo->ReadDisk (
+    Status = PartitionReadDisk (
                        DiskIo,
                        Media->MediaId,
                        MultU64x32 (Lba2KB, SIZE_2KB),
@@ -248,7 +248,7 @@ PartitionInstallGptChildHandles (
   //
   // Read the Protective MBR from LBA #0
   //
-  Status = DiskIo->ReadDisk (
+  Status = PartitionReadDisk (
                      DiskIo,
                      MediaId,
                      0,
@@ -332,7 +332,7 @@ PartitionInstallGptChildHandles (
     goto Done;
   }
 
-  Status = DiskIo->ReadDisk (
+  Status = PartitionReadDisk (
                      DiskIo,
                      MediaId,
                      MultU64x32(PrimaryHeader->PartitionEntryLBA, BlockSize),
@@ -488,7 +488,7 @@ PartitionValidGptTable (
   //
   // Read the EFI Partition Table Header
   //
-  Status = DiskIo->ReadDisk (
+  Status = PartitionReadDisk (
                      DiskIo,
                      MediaId,
                      MultU64x32 (Lba, BlockSize),
@@ -562,7 +562,7 @@ PartitionCheckGptEntryArrayCRC (
     return FALSE;
   }
 
-  Status = DiskIo->ReadDisk (
+  Status = PartitionReadDisk (
                     DiskIo,
                     BlockIo->Media->MediaId,
                     MultU64x32(PartHeader->PartitionEntryLBA, BlockIo->Media->BlockSize),
@@ -639,7 +639,7 @@ PartitionRestoreGptTable (
   PartHdr->PartitionEntryLBA  = PEntryLBA;
   PartitionSetCrc ((EFI_TABLE_HEADER *) PartHdr);
 
-  Status = DiskIo->WriteDisk (
+  Status = PartitionWriteDisk (
                      DiskIo,
                      MediaId,
                      MultU64x32 (PartHdr->MyLBA, (UINT32) BlockSize),
@@ -657,7 +657,7 @@ PartitionRestoreGptTable (
     goto Done;
   }
 
-  Status = DiskIo->ReadDisk (
+  Status = PartitionReadDisk (
                     DiskIo,
                     MediaId,
                     MultU64x32(PartHeader->PartitionEntryLBA, (UINT32) BlockSize),
@@ -668,7 +668,7 @@ PartitionRestoreGptTable (
     goto Done;
   }
 
-  Status = DiskIo->WriteDisk (
+  Status = PartitionWriteDisk (
                     DiskIo,
                     MediaId,
                     MultU64x32(PEntryLBA, (UINT32) BlockSize),
@@ -159,7 +159,7 @@ PartitionInstallMbrChildHandles (
     return Found;
   }
 
-  Status = DiskIo->ReadDisk (
+  Status = PartitionReadDisk (
                      DiskIo,
                      MediaId,
                      0,
@@ -269,7 +269,7 @@ PartitionInstallMbrChildHandles (
 
     do {
 
-      Status = DiskIo->ReadDisk (
+      Status = PartitionReadDisk (
                          DiskIo,
                          MediaId,
                          MultU64x32 (ExtMbrStartingLba, BlockSize),
@@ -51,6 +51,200 @@ PARTITION_DETECT_ROUTINE mPartitionDetectRoutineTable[] = {
   NULL
 };
 
+//
+// Probe cache of the device the detection routines are running on, NULL
+// outside PartitionDriverBindingStart().
+//
+PARTITION_PROBE_CACHE *mPartitionProbeCache = NULL;
+
+/**
+  Lay out the regions of the probe cache for a device. No data is read until
+  a detection routine asks for it.
+
+  @param[out] Cache       The probe cache to initialize.
+  @param[in]  DiskIo      Parent DiskIo interface.
+  @param[in]  Media       Media of the parent BlockIo interface.
+
+**/
+VOID
+PartitionInitProbeCache (
+  OUT PARTITION_PROBE_CACHE  *Cache,
+  IN  EFI_DISK_IO_PROTOCOL   *DiskIo,
+  IN  EFI_BLOCK_IO_MEDIA     *Media
+  )
+{
+  UINT64  DiskSize;
+  UINT64  HeadSize;
+  UINT64  TailSize;
+  UINTN   Index;
+
+  ZeroMem (Cache, sizeof (*Cache));
+  Cache->DiskIo  = DiskIo;
+  Cache->MediaId = Media->MediaId;
+  for (Index = 0; Index < PARTITION_PROBE_REGION_COUNT; Index++) {
+    Cache->Region[Index].State = ProbeRegionUnavailable;
+  }
+
+  if (Media->BlockSize == 0 || Media->LastBlock == MAX_UINT64) {
+    return;
+  }
+
+  DiskSize = MultU64x32 (Media->LastBlock + 1, Media->BlockSize);
+  HeadSize = MAX (MultU64x32 (PARTITION_PROBE_HEAD_BLOCKS, Media->BlockSize), PARTITION_PROBE_HEAD_MIN_SIZE);
+  HeadSize = MIN (HeadSize, DiskSize);
+  TailSize = MIN (MultU64x32 (PARTITION_PROBE_TAIL_BLOCKS, Media->BlockSize), DiskSize - HeadSize);
+
+  if (HeadSize != 0 && HeadSize <= MAX_UINT32) {
+    Cache->Region[0].Offset = 0;
+    Cache->Region[0].Size   = (UINTN) HeadSize;
+    Cache->Region[0].State  = ProbeRegionNotRead;
+  }
+  if (TailSize != 0 && TailSize <= MAX_UINT32) {
+    Cache->Region[1].Offset = DiskSize - TailSize;
+    Cache->Region[1].Size   = (UINTN) TailSize;
+    Cache->Region[1].State  = ProbeRegionNotRead;
+  }
+}
+
+/**
+  Free the buffers of a probe cache.
+
+  @param[in]  Cache       The probe cache to free.
+
+**/
+VOID
+PartitionFreeProbeCache (
+  IN PARTITION_PROBE_CACHE  *Cache
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < PARTITION_PROBE_REGION_COUNT; Index++) {
+    if (Cache->Region[Index].Buffer != NULL) {
+      FreePool (Cache->Region[Index].Buffer);
+      Cache->Region[Index].Buffer = NULL;
+    }
+    Cache->Region[Index].State = ProbeRegionUnavailable;
+  }
+}
+
+/**
+  Read data from the parent device while the partition detection routines
+  run. Requests that lie within a region of the probe cache are served from
+  memory; the region is read from the device the first time it is needed.
+  All other requests go to the device.
+
+  @param[in]  DiskIo      Parent DiskIo interface.
+  @param[in]  MediaId     Id of the media, changes every time the media is
+                          replaced.
+  @param[in]  Offset      The starting byte offset to read from.
+  @param[in]  BufferSize  Size of Buffer.
+  @param[out] Buffer      Buffer containing read data.
+
+  @retval EFI_SUCCESS     The data was read correctly from the device.
+  @retval other           The status returned by DiskIo->ReadDisk().
+
+**/
+EFI_STATUS
+PartitionReadDisk (
+  IN  EFI_DISK_IO_PROTOCOL  *DiskIo,
+  IN  UINT32                MediaId,
+  IN  UINT64                Offset,
+  IN  UINTN                 BufferSize,
+  OUT VOID                  *Buffer
+  )
+{
+  EFI_STATUS              Status;
+  PARTITION_PROBE_CACHE   *Cache;
+  PARTITION_PROBE_REGION  *Region;
+  UINTN                   Index;
+
+  Cache = mPartitionProbeCache;
+  if (Cache != NULL && Cache->DiskIo == DiskIo && Cache->MediaId == MediaId) {
+    for (Index = 0; Index < PARTITION_PROBE_REGION_COUNT; Index++) {
+      Region = &Cache->Region[Index];
+      if (Region->State == ProbeRegionUnavailable ||
+          Offset < Region->Offset ||
+          BufferSize > Region->Size ||
+          Offset - Region->Offset > Region->Size - BufferSize) {
+        continue;
+      }
+
+      if (Region->State == ProbeRegionNotRead) {
+        if (Region->Buffer == NULL) {
+          Region->Buffer = AllocatePool (Region->Size);
+        }
+        Status = EFI_OUT_OF_RESOURCES;
+        if (Region->Buffer != NULL) {
+          Status = DiskIo->ReadDisk (DiskIo, MediaId, Region->Offset, Region->Size, Region->Buffer);
+        }
+        if (EFI_ERROR (Status)) {
+          //
+          // Let the request go to the device so that the caller sees the
+          // same status it would have seen without the cache.
+          //
+          if (Region->Buffer != NULL) {
+            FreePool (Region->Buffer);
+            Region->Buffer = NULL;
+          }
+          Region->State = ProbeRegionUnavailable;
+          break;
+        }
+        Region->State = ProbeRegionValid;
+      }
+
+      CopyMem (Buffer, Region->Buffer + (UINTN) (Offset - Region->Offset), BufferSize);
+      return EFI_SUCCESS;
+    }
+  }
+
+  return DiskIo->ReadDisk (DiskIo, MediaId, Offset, BufferSize, Buffer);
+}
+
+/**
+  Write data to the parent device while the partition detection routines
+  run. The regions of the probe cache that overlap the written range are
+  dropped so that the next read gets the new data.
+
+  @param[in]  DiskIo      Parent DiskIo interface.
+  @param[in]  MediaId     Id of the media, changes every time the media is
+                          replaced.
+  @param[in]  Offset      The starting byte offset to write to.
+  @param[in]  BufferSize  Size of Buffer.
+  @param[in]  Buffer      Buffer containing the data to write.
+
+  @retval EFI_SUCCESS     The data was written correctly to the device.
+  @retval other           The status returned by DiskIo->WriteDisk().
+
+**/
+EFI_STATUS
+PartitionWriteDisk (
+  IN  EFI_DISK_IO_PROTOCOL  *DiskIo,
+  IN  UINT32                MediaId,
+  IN  UINT64                Offset,
+  IN  UINTN                 BufferSize,
+  IN  VOID                  *Buffer
+  )
+{
+  PARTITION_PROBE_CACHE   *Cache;
+  PARTITION_PROBE_REGION  *Region;
+  UINTN                   Index;
+
+  Cache = mPartitionProbeCache;
+  if (Cache != NULL && Cache->DiskIo == DiskIo) {
+    for (Index = 0; Index < PARTITION_PROBE_REGION_COUNT; Index++) {
+      Region = &Cache->Region[Index];
+      if (Region->State == ProbeRegionValid &&
+          Offset < Region->Offset + Region->Size &&
+          Offset + BufferSize > Region->Offset) {
+        Region->State = ProbeRegionNotRead;
+      }
+    }
+  }
+
+  return DiskIo->WriteDisk (DiskIo, MediaId, Offset, BufferSize, Buffer);
+}
+
 /**
   Test to see if this driver supports ControllerHandle. Any ControllerHandle
   than contains a BlockIo and DiskIo protocol or a BlockIo2 protocol can be
@@ -205,6 +399,8 @@ PartitionDriverBindingStart (
   PARTITION_DETECT_ROUTINE  *Routine;
   BOOLEAN                   MediaPresent;
   EFI_TPL                   OldTpl;
+  PARTITION_PROBE_CACHE     ProbeCache;
+  PARTITION_PROBE_CACHE     *SavedProbeCache;
 
   BlockIo2 = NULL;
   OldTpl = gBS->RaiseTPL (TPL_CALLBACK);
@@ -312,6 +508,13 @@ PartitionDriverBindingStart (
     // If the media supports a given partition type install child handles to
     // represent the partitions described by the media.
     //
+    // The routines share the sectors they look at through the probe cache.
+    // Save the cache of an outer Start(), in case a media change reenters it.
+    //
+    PartitionInitProbeCache (&ProbeCache, DiskIo, BlockIo->Media);
+    SavedProbeCache      = mPartitionProbeCache;
+    mPartitionProbeCache = &ProbeCache;
+
     Routine = &mPartitionDetectRoutineTable[0];
     while (*Routine != NULL) {
       Status = (*Routine) (
@@ -328,6 +531,9 @@ PartitionDriverBindingStart (
       }
       Routine++;
     }
+
+    mPartitionProbeCache = SavedProbeCache;
+    PartitionFreeProbeCache (&ProbeCache);
   }
   //
   // In the case that the driver is already started (OpenStatus == EFI_ALREADY_STARTED),
@@ -558,6 +764,13 @@ PartitionDriverBindingStop (
              EFI_OPEN_PROTOCOL_BY_CHILD_CONTROLLER
              );
     } else {
+      if (Private->ParentDirectAccess != NULL) {
+        gBS->UninstallProtocolInterface (
+               ChildHandleBuffer[Index],
+               &gEdkiiBlockIoDirectAccessProtocolGuid,
+               &Private->DirectAccess
+               );
+      }
       FreePool (Private->DevicePath);
       FreePool (Private);
     }
@@ -1099,6 +1312,77 @@ PartitionFlushBlocksEx (
 }
 
 
+/**
+  Return the address of the partition data starting at a logical block, by
+  using the direct access protocol of the parent device.
+
+  @param[in]      This            Protocol instance pointer.
+  @param[in]      MediaId         Id of the media, changes every time the media
+                                  is replaced.
+  @param[in]      Lba             The starting Logical Block Address.
+  @param[in, out] Length          On input, the number of bytes the caller
+                                  wants to access. On output, the number of
+                                  bytes available at Address, which does not
+                                  go past the end of the partition.
+  @param[out]     Address         The address of the data at Lba.
+
+  @retval EFI_SUCCESS             Address and Length were returned.
+  @retval EFI_INVALID_PARAMETER   Lba is not valid for the partition, or
+                                  Length or Address is NULL.
+  @retval other                   The status returned by the parent device.
+
+**/
+EFI_STATUS
+EFIAPI
+PartitionDirectAccessMap (
+  IN     EDKII_BLOCK_IO_DIRECT_ACCESS_PROTOCOL  *This,
+  IN     UINT32                                 MediaId,
+  IN     EFI_LBA                                Lba,
+  IN OUT UINTN                                  *Length,
+  OUT    CONST VOID                             **Address
+  )
+{
+  EFI_STATUS              Status;
+  PARTITION_PRIVATE_DATA  *Private;
+  UINT64                  Offset;
+  EFI_LBA                 ParentLba;
+  UINT32                  Remainder;
+  UINTN                   ParentLength;
+  CONST VOID              *ParentAddress;
+
+  Private = PARTITION_DEVICE_FROM_DIRECT_ACCESS_THIS (This);
+
+  if ((Length == NULL) || (Address == NULL) || (Lba > Private->Media.LastBlock)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Offset = MultU64x32 (Lba, Private->BlockSize) + Private->Start;
+  if (*Length > Private->End - Offset) {
+    *Length = (UINTN) (Private->End - Offset);
+  }
+
+  ParentLba = DivU64x32Remainder (Offset, Private->ParentBlockIo->Media->BlockSize, &Remainder);
+  ParentLength = MIN (*Length, MAX_UINTN - Remainder) + Remainder;
+  Status = Private->ParentDirectAccess->Map (
+                                          Private->ParentDirectAccess,
+                                          MediaId,
+                                          ParentLba,
+                                          &ParentLength,
+                                          &ParentAddress
+                                          );
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+  if (ParentLength <= Remainder) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  *Length  = ParentLength - Remainder;
+  *Address = (CONST UINT8 *) ParentAddress + Remainder;
+  return EFI_SUCCESS;
+}
+
+
 /**
   Create a child handle for a logical block device that represents the
   bytes Start to End of the Parent Block IO device.
@@ -1236,9 +1520,31 @@ PartitionInstallChildHandle (
   }
 
   //
-  // Create the new handle.
+  // Create the new handle. When the parent media can be accessed through
+  // memory, install the direct access protocol on the child first so that it
+  // is present when the child is connected.
   //
   Private->Handle = NULL;
+  Status = gBS->HandleProtocol (
+                  ParentHandle,
+                  &gEdkiiBlockIoDirectAccessProtocolGuid,
+                  (VOID **) &Private->ParentDirectAccess
+                  );
+  if (!EFI_ERROR (Status)) {
+    Private->DirectAccess.Revision = EDKII_BLOCK_IO_DIRECT_ACCESS_PROTOCOL_REVISION;
+    Private->DirectAccess.Map      = PartitionDirectAccessMap;
+    Status = gBS->InstallProtocolInterface (
+                    &Private->Handle,
+                    &gEdkiiBlockIoDirectAccessProtocolGuid,
+                    EFI_NATIVE_INTERFACE,
+                    &Private->DirectAccess
+                    );
+  }
+  if (EFI_ERROR (Status)) {
+    Private->ParentDirectAccess = NULL;
+    Private->Handle             = NULL;
+  }
+
   if (Private->DiskIo2 != NULL) {
     Status = gBS->InstallMultipleProtocolInterfaces (
                     &Private->Handle,
@@ -1282,6 +1588,13 @@ PartitionInstallChildHandle (
                     EFI_OPEN_PROTOCOL_BY_CHILD_CONTROLLER
                     );
   } else {
+    if (Private->ParentDirectAccess != NULL) {
+      gBS->UninstallProtocolInterface (
+             Private->Handle,
+             &gEdkiiBlockIoDirectAccessProtocolGuid,
+             &Private->DirectAccess
+             );
+    }
     FreePool (Private->DevicePath);
     FreePool (Private);
 
@@ -16,6 +16,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Uefi.h>
 #include <Protocol/BlockIo.h>
 #include <Protocol/BlockIo2.h>
+#include <Protocol/BlockIoDirectAccess.h>
 #include <Guid/Gpt.h>
 #include <Protocol/ComponentName.h>
 #include <Protocol/DevicePath.h>
@@ -50,11 +51,13 @@ typedef struct {
   EFI_BLOCK_IO_MEDIA           Media;
   EFI_BLOCK_IO_MEDIA           Media2;//For BlockIO2
   EFI_PARTITION_INFO_PROTOCOL  PartitionInfo;
+  EDKII_BLOCK_IO_DIRECT_ACCESS_PROTOCOL  DirectAccess;
 
   EFI_DISK_IO_PROTOCOL         *DiskIo;
   EFI_DISK_IO2_PROTOCOL        *DiskIo2;
   EFI_BLOCK_IO_PROTOCOL        *ParentBlockIo;
   EFI_BLOCK_IO2_PROTOCOL       *ParentBlockIo2;
+  EDKII_BLOCK_IO_DIRECT_ACCESS_PROTOCOL  *ParentDirectAccess;
   UINT64                       Start;
   UINT64                       End;
   UINT32                       BlockSize;
@@ -71,6 +74,7 @@ typedef struct {
 
 #define PARTITION_DEVICE_FROM_BLOCK_IO_THIS(a)  CR (a, PARTITION_PRIVATE_DATA, BlockIo, PARTITION_PRIVATE_DATA_SIGNATURE)
 #define PARTITION_DEVICE_FROM_BLOCK_IO2_THIS(a) CR (a, PARTITION_PRIVATE_DATA, BlockIo2, PARTITION_PRIVATE_DATA_SIGNATURE)
+#define PARTITION_DEVICE_FROM_DIRECT_ACCESS_THIS(a) CR (a, PARTITION_PRIVATE_DATA, DirectAccess, PARTITION_PRIVATE_DATA_SIGNATURE)
 
 //
 // Global Variables
@@ -105,6 +109,36 @@ typedef struct {
   BOOLEAN OsSpecific;
 } EFI_PARTITION_ENTRY_STATUS;
 
+//
+// Regions of the parent device shared by all the partition detection
+// routines while a device is probed. The head covers the protective MBR, the
+// primary GPT header and entry array, and the ISO-9660/UDF volume descriptors
+// starting at 32KB. The tail covers the backup GPT entry array and header.
+//
+#define PARTITION_PROBE_HEAD_BLOCKS     34
+#define PARTITION_PROBE_HEAD_MIN_SIZE   SIZE_64KB
+#define PARTITION_PROBE_TAIL_BLOCKS     33
+#define PARTITION_PROBE_REGION_COUNT    2
+
+typedef enum {
+  ProbeRegionNotRead,
+  ProbeRegionValid,
+  ProbeRegionUnavailable
+} PARTITION_PROBE_REGION_STATE;
+
+typedef struct {
+  UINT64                        Offset;
+  UINTN                         Size;
+  UINT8                         *Buffer;
+  PARTITION_PROBE_REGION_STATE  State;
+} PARTITION_PROBE_REGION;
+
+typedef struct {
+  EFI_DISK_IO_PROTOCOL          *DiskIo;
+  UINT32                        MediaId;
+  PARTITION_PROBE_REGION        Region[PARTITION_PROBE_REGION_COUNT];
+} PARTITION_PROBE_CACHE;
+
 //
 // Function Prototypes
 //
@@ -470,6 +504,57 @@ PartitionInstallUdfChildHandles (
   IN  EFI_DEVICE_PATH_PROTOCOL     *DevicePath
   );
 
+/**
+  Read data from the parent device while the partition detection routines
+  run. Requests that lie within a region of the probe cache are served from
+  memory; the region is read from the device the first time it is needed.
+  All other requests go to the device.
+
+  @param[in]  DiskIo      Parent DiskIo interface.
+  @param[in]  MediaId     Id of the media, changes every time the media is
+                          replaced.
+  @param[in]  Offset      The starting byte offset to read from.
+  @param[in]  BufferSize  Size of Buffer.
+  @param[out] Buffer      Buffer containing read data.
+
+  @retval EFI_SUCCESS     The data was read correctly from the device.
+  @retval other           The status returned by DiskIo->ReadDisk().
+
+**/
+EFI_STATUS
+PartitionReadDisk (
+  IN  EFI_DISK_IO_PROTOCOL  *DiskIo,
+  IN  UINT32                MediaId,
+  IN  UINT64                Offset,
+  IN  UINTN                 BufferSize,
+  OUT VOID                  *Buffer
+  );
+
+/**
+  Write data to the parent device while the partition detection routines
+  run. The regions of the probe cache that overlap the written range are
+  dropped so that the next read gets the new data.
+
+  @param[in]  DiskIo      Parent DiskIo interface.
+  @param[in]  MediaId     Id of the media, changes every time the media is
+                          replaced.
+  @param[in]  Offset      The starting byte offset to write to.
+  @param[in]  BufferSize  Size of Buffer.
+  @param[in]  Buffer      Buffer containing the data to write.
+
+  @retval EFI_SUCCESS     The data was written correctly to the device.
+  @retval other           The status returned by DiskIo->WriteDisk().
+
+**/
+EFI_STATUS
+PartitionWriteDisk (
+  IN  EFI_DISK_IO_PROTOCOL  *DiskIo,
+  IN  UINT32                MediaId,
+  IN  UINT64                Offset,
+  IN  UINTN                 BufferSize,
+  IN  VOID                  *Buffer
+  );
+
 typedef
 EFI_STATUS
 (*PARTITION_DETECT_ROUTINE) (
@@ -121,7 +121,7 @@ FindAnchorVolumeDescriptorPointer (
   //
   // Find AVDP at block 256
   //
-  Status = DiskIo->ReadDisk (
+  Status = PartitionReadDisk (
     DiskIo,
     BlockIo->Media->MediaId,
     MultU64x32 (256, BlockSize),
@@ -145,7 +145,7 @@ FindAnchorVolumeDescriptorPointer (
   //
   // Find AVDP at block N - 256
   //
-  Status = DiskIo->ReadDisk (
+  Status = PartitionReadDisk (
     DiskIo,
     BlockIo->Media->MediaId,
     MultU64x32 ((UINT64)EndLBA - 256, BlockSize),
@@ -176,7 +176,7 @@ FindAnchorVolumeDescriptorPointer (
   //
   // Find AVDP at block N
   //
-  Status = DiskIo->ReadDisk (
+  Status = PartitionReadDisk (
     DiskIo,
     BlockIo->Media->MediaId,
     MultU64x32 ((UINT64)EndLBA, BlockSize),
@@ -212,7 +212,7 @@ FindAnchorVolumeDescriptorPointer (
   //
   // Read consecutive MAX_CORRECTION_BLOCKS_NUM disk blocks
   //
-  Status = DiskIo->ReadDisk (
+  Status = PartitionReadDisk (
     DiskIo,
     BlockIo->Media->MediaId,
     MultU64x32 ((UINT64)EndLBA - MAX_CORRECTION_BLOCKS_NUM, BlockSize),
@@ -300,7 +300,7 @@ FindUdfVolumeIdentifiers (
     // Check if block device has a Volume Structure Descriptor and an Extended
     // Area.
     //
-    Status = DiskIo->ReadDisk (
+    Status = PartitionReadDisk (
       DiskIo,
       BlockIo->Media->MediaId,
       Offset,
@@ -335,7 +335,7 @@ FindUdfVolumeIdentifiers (
     return EFI_NOT_FOUND;
   }
 
-  Status = DiskIo->ReadDisk (
+  Status = PartitionReadDisk (
     DiskIo,
     BlockIo->Media->MediaId,
     Offset,
@@ -363,7 +363,7 @@ FindUdfVolumeIdentifiers (
     return EFI_NOT_FOUND;
   }
 
-  Status = DiskIo->ReadDisk (
+  Status = PartitionReadDisk (
     DiskIo,
     BlockIo->Media->MediaId,
     Offset,
@@ -33,9 +33,19 @@ EFI_BLOCK_IO2_PROTOCOL  mRamDiskBlockIo2Template = {
   RamDiskBlkIo2FlushBlocksEx
 };
 
+//
+// The EDKII_BLOCK_IO_DIRECT_ACCESS_PROTOCOL instances that is installed onto
+// the handle for newly registered RAM disks
+//
+EDKII_BLOCK_IO_DIRECT_ACCESS_PROTOCOL  mRamDiskDirectAccessTemplate = {
+  EDKII_BLOCK_IO_DIRECT_ACCESS_PROTOCOL_REVISION,
+  RamDiskDirectAccessMap
+};
+
 
 /**
-  Initialize the BlockIO & BlockIO2 protocol of a RAM disk device.
+  Initialize the BlockIO, BlockIO2 & direct access protocol of a RAM disk
+  device.
 
   @param[in] PrivateData     Points to RAM disk private data.
 
@@ -48,6 +58,7 @@ RamDiskInitBlockIo (
   EFI_BLOCK_IO_PROTOCOL           *BlockIo;
   EFI_BLOCK_IO2_PROTOCOL          *BlockIo2;
   EFI_BLOCK_IO_MEDIA              *Media;
+  UINT64                          DiskSize;
   UINT32                          Remainder;
 
   BlockIo  = &PrivateData->BlockIo;
@@ -56,6 +67,7 @@ RamDiskInitBlockIo (
 
   CopyMem (BlockIo, &mRamDiskBlockIoTemplate, sizeof (EFI_BLOCK_IO_PROTOCOL));
   CopyMem (BlockIo2, &mRamDiskBlockIo2Template, sizeof (EFI_BLOCK_IO2_PROTOCOL));
+  CopyMem (&PrivateData->DirectAccess, &mRamDiskDirectAccessTemplate, sizeof (EDKII_BLOCK_IO_DIRECT_ACCESS_PROTOCOL));
 
   BlockIo->Media          = Media;
   BlockIo2->Media         = Media;
@@ -65,10 +77,19 @@ RamDiskInitBlockIo (
   Media->ReadOnly         = FALSE;
   Media->WriteCaching     = FALSE;
 
+  //
+  // A compressed RAM disk image cannot be updated in place.
+  //
+  DiskSize = PrivateData->Size;
+  if (PrivateData->Compressed != NULL) {
+    DiskSize        = PrivateData->Compressed->DiskSize;
+    Media->ReadOnly = TRUE;
+  }
+
   for (Media->BlockSize = RAM_DISK_DEFAULT_BLOCK_SIZE;
        Media->BlockSize >= 1;
        Media->BlockSize = Media->BlockSize >> 1) {
-    Media->LastBlock = DivU64x32Remainder (PrivateData->Size, Media->BlockSize, &Remainder) - 1;
+    Media->LastBlock = DivU64x32Remainder (DiskSize, Media->BlockSize, &Remainder) - 1;
     if (Remainder == 0) {
       break;
     }
@@ -166,6 +187,15 @@ RamDiskBlkIoReadBlocks (
     return EFI_INVALID_PARAMETER;
   }
 
+  if (PrivateData->Compressed != NULL) {
+    return RamDiskCompressedRead (
+             PrivateData,
+             MultU64x32 (Lba, PrivateData->Media.BlockSize),
+             BufferSize,
+             Buffer
+             );
+  }
+
   CopyMem (
     Buffer,
     (VOID *)(UINTN)(PrivateData->StartingAddr + MultU64x32 (Lba, PrivateData->Media.BlockSize)),
@@ -485,3 +515,63 @@ RamDiskBlkIo2FlushBlocksEx (
 
   return EFI_SUCCESS;
 }
+
+
+/**
+  Return the address of the RAM disk data starting at a logical block.
+
+  @param[in]      This            Indicates a pointer to the calling context.
+  @param[in]      MediaId         The media ID that the request is for.
+  @param[in]      Lba             The starting logical block address.
+  @param[in, out] Length          On input, the number of bytes the caller
+                                  wants to access. On output, the number of
+                                  bytes available at Address.
+  @param[out]     Address         The address of the data at Lba.
+
+  @retval EFI_SUCCESS             Address and Length were returned.
+  @retval EFI_MEDIA_CHANGED       The MediaId is not for the current media.
+  @retval EFI_INVALID_PARAMETER   Lba is not valid, or Length or Address is
+                                  NULL.
+  @retval EFI_UNSUPPORTED         The RAM disk holds a compressed image.
+
+**/
+EFI_STATUS
+EFIAPI
+RamDiskDirectAccessMap (
+  IN     EDKII_BLOCK_IO_DIRECT_ACCESS_PROTOCOL  *This,
+  IN     UINT32                                 MediaId,
+  IN     EFI_LBA                                Lba,
+  IN OUT UINTN                                  *Length,
+  OUT    CONST VOID                             **Address
+  )
+{
+  RAM_DISK_PRIVATE_DATA           *PrivateData;
+  UINT64                          Offset;
+
+  PrivateData = RAM_DISK_PRIVATE_FROM_DIRECT_ACCESS (This);
+
+  if (MediaId != PrivateData->Media.MediaId) {
+    return EFI_MEDIA_CHANGED;
+  }
+
+  if ((Length == NULL) || (Address == NULL)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (PrivateData->Compressed != NULL) {
+    return EFI_UNSUPPORTED;
+  }
+
+  if (Lba > PrivateData->Media.LastBlock) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Offset = MultU64x32 (Lba, PrivateData->Media.BlockSize);
+  if (*Length > PrivateData->Size - Offset) {
+    *Length = (UINTN) (PrivateData->Size - Offset);
+  }
+
+  *Address = (CONST VOID *)(UINTN)(PrivateData->StartingAddr + Offset);
+
+  return EFI_SUCCESS;
+}
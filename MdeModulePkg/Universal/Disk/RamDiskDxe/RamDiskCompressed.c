@@ -0,0 +1,419 @@
+/** @file
+  Read support for RAM disks registered with a compressed RAM disk image.
+
+  The image is split in chunks that are stored, compressed or omitted when
+  they only hold zeros, see Include/Guid/CompressedRamDiskImage.h. A read
+  decompresses the chunks it covers; whole chunks are decompressed straight
+  into the caller's buffer while partially read chunks go through a small
+  cache of decompressed chunks.
+
+  Copyright (c) 2021, EDK II contributors. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "RamDiskImpl.h"
+
+/**
+  Return the number of disk bytes held by a chunk.
+
+  @param[in] Compressed      Points to the compressed RAM disk state.
+  @param[in] ChunkIndex      The index of the chunk.
+
+  @return The size of the chunk once decompressed.
+
+**/
+STATIC
+UINT32
+RamDiskChunkLength (
+  IN CONST RAM_DISK_COMPRESSED_DATA  *Compressed,
+  IN UINT64                          ChunkIndex
+  )
+{
+  UINT64                          ChunkStart;
+
+  ChunkStart = MultU64x32 (ChunkIndex, Compressed->ChunkSize);
+  if (Compressed->DiskSize - ChunkStart < Compressed->ChunkSize) {
+    return (UINT32) (Compressed->DiskSize - ChunkStart);
+  }
+
+  return Compressed->ChunkSize;
+}
+
+
+/**
+  Decompress a UEFI compressed chunk.
+
+  @param[in]  PrivateData    Points to RAM disk private data.
+  @param[in]  Chunk          The chunk table entry.
+  @param[out] Destination    The buffer receiving the chunk, at least the
+                             chunk length in size.
+
+  @retval EFI_SUCCESS        The chunk was decompressed.
+  @retval EFI_DEVICE_ERROR   The chunk data is corrupted.
+
+**/
+STATIC
+EFI_STATUS
+RamDiskDecompressChunk (
+  IN  RAM_DISK_PRIVATE_DATA                  *PrivateData,
+  IN  CONST EDKII_COMPRESSED_RAM_DISK_CHUNK  *Chunk,
+  OUT VOID                                   *Destination
+  )
+{
+  RETURN_STATUS                   Status;
+
+  Status = UefiDecompress (
+             (CONST VOID *)(UINTN)(PrivateData->StartingAddr + Chunk->Offset),
+             Destination,
+             PrivateData->Compressed->Scratch
+             );
+  if (RETURN_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "%a: chunk at 0x%lx failed to decompress - %r\n", __FUNCTION__, Chunk->Offset, Status));
+    return EFI_DEVICE_ERROR;
+  }
+
+  return EFI_SUCCESS;
+}
+
+
+/**
+  Look up a chunk in the cache of decompressed chunks.
+
+  @param[in] Compressed      Points to the compressed RAM disk state.
+  @param[in] ChunkIndex      The index of the chunk.
+
+  @return The cache entry holding the chunk, or NULL if it is not cached.
+
+**/
+STATIC
+RAM_DISK_CHUNK_CACHE_ENTRY *
+RamDiskFindCachedChunk (
+  IN RAM_DISK_COMPRESSED_DATA     *Compressed,
+  IN UINT64                       ChunkIndex
+  )
+{
+  UINTN                           Index;
+
+  for (Index = 0; Index < RAM_DISK_CHUNK_CACHE_SIZE; Index++) {
+    if (Compressed->Cache[Index].ChunkIndex == ChunkIndex) {
+      Compressed->Cache[Index].LastUse = ++Compressed->UseCounter;
+      return &Compressed->Cache[Index];
+    }
+  }
+
+  return NULL;
+}
+
+
+/**
+  Return the decompressed data of a UEFI compressed chunk, decompressing it
+  into the least recently used cache entry if it is not cached yet.
+
+  @param[in]  PrivateData    Points to RAM disk private data.
+  @param[in]  ChunkIndex     The index of the chunk.
+  @param[out] Data           The decompressed chunk.
+
+  @retval EFI_SUCCESS            The chunk is available in Data.
+  @retval EFI_OUT_OF_RESOURCES   No memory for the cache entry.
+  @retval EFI_DEVICE_ERROR       The chunk data is corrupted.
+
+**/
+STATIC
+EFI_STATUS
+RamDiskGetCachedChunk (
+  IN  RAM_DISK_PRIVATE_DATA       *PrivateData,
+  IN  UINT64                      ChunkIndex,
+  OUT CONST UINT8                 **Data
+  )
+{
+  EFI_STATUS                      Status;
+  RAM_DISK_COMPRESSED_DATA        *Compressed;
+  RAM_DISK_CHUNK_CACHE_ENTRY      *Entry;
+  UINTN                           Index;
+
+  Compressed = PrivateData->Compressed;
+
+  Entry = RamDiskFindCachedChunk (Compressed, ChunkIndex);
+  if (Entry != NULL) {
+    *Data = Entry->Data;
+    return EFI_SUCCESS;
+  }
+
+  Entry = &Compressed->Cache[0];
+  for (Index = 1; Index < RAM_DISK_CHUNK_CACHE_SIZE; Index++) {
+    if (Compressed->Cache[Index].LastUse < Entry->LastUse) {
+      Entry = &Compressed->Cache[Index];
+    }
+  }
+
+  if (Entry->Data == NULL) {
+    Entry->Data = AllocatePool (Compressed->ChunkSize);
+    if (Entry->Data == NULL) {
+      return EFI_OUT_OF_RESOURCES;
+    }
+  }
+
+  Entry->ChunkIndex = MAX_UINT64;
+  Status = RamDiskDecompressChunk (PrivateData, &Compressed->Chunks[ChunkIndex], Entry->Data);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Entry->ChunkIndex = ChunkIndex;
+  Entry->LastUse    = ++Compressed->UseCounter;
+  *Data             = Entry->Data;
+
+  return EFI_SUCCESS;
+}
+
+
+/**
+  Check whether a RAM disk holds a compressed RAM disk image and, if so,
+  prepare it to be read through RamDiskCompressedRead().
+
+  @param[in, out] PrivateData     Points to RAM disk private data.
+
+  @retval EFI_SUCCESS             The RAM disk holds a valid compressed image.
+  @retval EFI_NOT_FOUND           The RAM disk holds a plain image.
+  @retval EFI_INVALID_PARAMETER   The compressed image is corrupted.
+  @retval EFI_OUT_OF_RESOURCES    Not enough memory to read the image.
+
+**/
+EFI_STATUS
+RamDiskCompressedInit (
+  IN OUT RAM_DISK_PRIVATE_DATA    *PrivateData
+  )
+{
+  CONST EDKII_COMPRESSED_RAM_DISK_IMAGE_HEADER  *Header;
+  CONST EDKII_COMPRESSED_RAM_DISK_CHUNK         *Chunks;
+  RAM_DISK_COMPRESSED_DATA        *Compressed;
+  UINT64                          ImageSize;
+  UINT64                          ChunkIndex;
+  UINT32                          ChunkLength;
+  UINT32                          DestinationSize;
+  UINT32                          ScratchSize;
+  UINT32                          MaxScratchSize;
+  UINTN                           Index;
+  RETURN_STATUS                   Status;
+
+  ImageSize = PrivateData->Size;
+  Header    = (CONST EDKII_COMPRESSED_RAM_DISK_IMAGE_HEADER *)(UINTN) PrivateData->StartingAddr;
+
+  if ((ImageSize < sizeof (EDKII_COMPRESSED_RAM_DISK_IMAGE_HEADER)) ||
+      !CompareGuid (&Header->Signature, &gEdkiiCompressedRamDiskImageGuid)) {
+    return EFI_NOT_FOUND;
+  }
+
+  if ((Header->HeaderSize < sizeof (EDKII_COMPRESSED_RAM_DISK_IMAGE_HEADER)) ||
+      (Header->HeaderSize > ImageSize) ||
+      (Header->ChunkSize < RAM_DISK_DEFAULT_BLOCK_SIZE) ||
+      ((Header->ChunkSize & (Header->ChunkSize - 1)) != 0) ||
+      (Header->DiskSize == 0) ||
+      (Header->ChunkCount != DivU64x32 (Header->DiskSize - 1, Header->ChunkSize) + 1) ||
+      (Header->ChunkCount > DivU64x32 (ImageSize - Header->HeaderSize, sizeof (EDKII_COMPRESSED_RAM_DISK_CHUNK)))) {
+    DEBUG ((DEBUG_ERROR, "%a: invalid compressed RAM disk image header\n", __FUNCTION__));
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Chunks         = (CONST EDKII_COMPRESSED_RAM_DISK_CHUNK *)((CONST UINT8 *) Header + Header->HeaderSize);
+  MaxScratchSize = 0;
+
+  for (ChunkIndex = 0; ChunkIndex < Header->ChunkCount; ChunkIndex++) {
+    ChunkLength = Header->ChunkSize;
+    if (Header->DiskSize - MultU64x32 (ChunkIndex, Header->ChunkSize) < ChunkLength) {
+      ChunkLength = (UINT32) (Header->DiskSize - MultU64x32 (ChunkIndex, Header->ChunkSize));
+    }
+
+    if (Chunks[ChunkIndex].Type == EDKII_COMPRESSED_RAM_DISK_CHUNK_ZERO) {
+      continue;
+    }
+
+    if ((Chunks[ChunkIndex].Offset > ImageSize) ||
+        (Chunks[ChunkIndex].Size > ImageSize - Chunks[ChunkIndex].Offset)) {
+      break;
+    }
+
+    if (Chunks[ChunkIndex].Type == EDKII_COMPRESSED_RAM_DISK_CHUNK_STORED) {
+      if (Chunks[ChunkIndex].Size != ChunkLength) {
+        break;
+      }
+    } else if (Chunks[ChunkIndex].Type == EDKII_COMPRESSED_RAM_DISK_CHUNK_UEFI) {
+      Status = UefiDecompressGetInfo (
+                 (CONST VOID *)(UINTN)(PrivateData->StartingAddr + Chunks[ChunkIndex].Offset),
+                 Chunks[ChunkIndex].Size,
+                 &DestinationSize,
+                 &ScratchSize
+                 );
+      if (RETURN_ERROR (Status) || (DestinationSize != ChunkLength)) {
+        break;
+      }
+
+      MaxScratchSize = MAX (MaxScratchSize, ScratchSize);
+    } else {
+      break;
+    }
+  }
+
+  if (ChunkIndex < Header->ChunkCount) {
+    DEBUG ((DEBUG_ERROR, "%a: invalid compressed RAM disk chunk %ld\n", __FUNCTION__, ChunkIndex));
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Compressed = AllocateZeroPool (sizeof (RAM_DISK_COMPRESSED_DATA));
+  if (Compressed == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  if (MaxScratchSize != 0) {
+    Compressed->Scratch = AllocatePool (MaxScratchSize);
+    if (Compressed->Scratch == NULL) {
+      FreePool (Compressed);
+      return EFI_OUT_OF_RESOURCES;
+    }
+  }
+
+  Compressed->Header      = Header;
+  Compressed->Chunks      = Chunks;
+  Compressed->DiskSize    = Header->DiskSize;
+  Compressed->ChunkSize   = Header->ChunkSize;
+  Compressed->ChunkCount  = Header->ChunkCount;
+  Compressed->ScratchSize = MaxScratchSize;
+  for (Index = 0; Index < RAM_DISK_CHUNK_CACHE_SIZE; Index++) {
+    Compressed->Cache[Index].ChunkIndex = MAX_UINT64;
+  }
+
+  PrivateData->Compressed = Compressed;
+
+  return EFI_SUCCESS;
+}
+
+
+/**
+  Read data from a RAM disk holding a compressed RAM disk image.
+
+  @param[in]  PrivateData         Points to RAM disk private data.
+  @param[in]  Offset              The offset in the uncompressed disk.
+  @param[in]  BufferSize          The number of bytes to read.
+  @param[out] Buffer              The buffer receiving the data.
+
+  @retval EFI_SUCCESS             The data was read.
+  @retval EFI_DEVICE_ERROR        A chunk of the image could not be
+                                  decompressed.
+
+**/
+EFI_STATUS
+RamDiskCompressedRead (
+  IN  RAM_DISK_PRIVATE_DATA       *PrivateData,
+  IN  UINT64                      Offset,
+  IN  UINTN                       BufferSize,
+  OUT VOID                        *Buffer
+  )
+{
+  EFI_STATUS                      Status;
+  RAM_DISK_COMPRESSED_DATA        *Compressed;
+  CONST EDKII_COMPRESSED_RAM_DISK_CHUNK  *Chunk;
+  RAM_DISK_CHUNK_CACHE_ENTRY      *Entry;
+  CONST UINT8                     *Data;
+  UINT8                           *Destination;
+  UINT64                          ChunkIndex;
+  UINT32                          ChunkOffset;
+  UINT32                          ChunkLength;
+  UINTN                           Length;
+  EFI_TPL                         OldTpl;
+
+  Compressed  = PrivateData->Compressed;
+  Destination = Buffer;
+  Status      = EFI_SUCCESS;
+
+  //
+  // The scratch buffer and the chunk cache are shared by the Block IO and
+  // Block IO 2 callers of the RAM disk.
+  //
+  OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+
+  while (BufferSize > 0) {
+    ChunkIndex  = DivU64x32Remainder (Offset, Compressed->ChunkSize, &ChunkOffset);
+    ChunkLength = RamDiskChunkLength (Compressed, ChunkIndex);
+    Length      = MIN (BufferSize, ChunkLength - ChunkOffset);
+    Chunk       = &Compressed->Chunks[ChunkIndex];
+
+    switch (Chunk->Type) {
+    case EDKII_COMPRESSED_RAM_DISK_CHUNK_ZERO:
+      ZeroMem (Destination, Length);
+      break;
+
+    case EDKII_COMPRESSED_RAM_DISK_CHUNK_STORED:
+      CopyMem (
+        Destination,
+        (VOID *)(UINTN)(PrivateData->StartingAddr + Chunk->Offset + ChunkOffset),
+        Length
+        );
+      break;
+
+    default:
+      Entry = RamDiskFindCachedChunk (Compressed, ChunkIndex);
+      if (Entry != NULL) {
+        CopyMem (Destination, Entry->Data + ChunkOffset, Length);
+      } else if (Length == ChunkLength) {
+        //
+        // The whole chunk is read, no need to keep a copy of it.
+        //
+        Status = RamDiskDecompressChunk (PrivateData, Chunk, Destination);
+      } else {
+        Status = RamDiskGetCachedChunk (PrivateData, ChunkIndex, &Data);
+        if (!EFI_ERROR (Status)) {
+          CopyMem (Destination, Data + ChunkOffset, Length);
+        }
+      }
+      break;
+    }
+
+    if (EFI_ERROR (Status)) {
+      Status = EFI_DEVICE_ERROR;
+      break;
+    }
+
+    Destination += Length;
+    Offset      += Length;
+    BufferSize  -= Length;
+  }
+
+  gBS->RestoreTPL (OldTpl);
+
+  return Status;
+}
+
+
+/**
+  Free the resources allocated by RamDiskCompressedInit().
+
+  @param[in, out] PrivateData     Points to RAM disk private data.
+
+**/
+VOID
+RamDiskCompressedFree (
+  IN OUT RAM_DISK_PRIVATE_DATA    *PrivateData
+  )
+{
+  RAM_DISK_COMPRESSED_DATA        *Compressed;
+  UINTN                           Index;
+
+  Compressed = PrivateData->Compressed;
+  if (Compressed == NULL) {
+    return;
+  }
+
+  for (Index = 0; Index < RAM_DISK_CHUNK_CACHE_SIZE; Index++) {
+    if (Compressed->Cache[Index].Data != NULL) {
+      FreePool (Compressed->Cache[Index].Data);
+    }
+  }
+
+  if (Compressed->Scratch != NULL) {
+    FreePool (Compressed->Scratch);
+  }
+
+  FreePool (Compressed);
+  PrivateData->Compressed = NULL;
+}
@@ -175,6 +175,8 @@ UnregisterAllRamDisks (
              &PrivateData->BlockIo,
              &gEfiBlockIo2ProtocolGuid,
              &PrivateData->BlockIo2,
+             &gEdkiiBlockIoDirectAccessProtocolGuid,
+             &PrivateData->DirectAccess,
              &gEfiDevicePathProtocolGuid,
              (EFI_DEVICE_PATH_PROTOCOL *) PrivateData->DevicePath,
              NULL
@@ -191,6 +193,7 @@ UnregisterAllRamDisks (
         FreePool ((VOID *)(UINTN) PrivateData->StartingAddr);
       }
 
+      RamDiskCompressedFree (PrivateData);
       FreePool (PrivateData->DevicePath);
       FreePool (PrivateData);
     }
@@ -25,9 +25,11 @@
 #include <Library/PrintLib.h>
 #include <Library/PcdLib.h>
 #include <Library/DxeServicesLib.h>
+#include <Library/UefiDecompressLib.h>
 #include <Protocol/RamDisk.h>
 #include <Protocol/BlockIo.h>
 #include <Protocol/BlockIo2.h>
+#include <Protocol/BlockIoDirectAccess.h>
 #include <Protocol/HiiConfigAccess.h>
 #include <Protocol/SimpleFileSystem.h>
 #include <Protocol/AcpiTable.h>
@@ -35,6 +37,7 @@
 #include <Guid/MdeModuleHii.h>
 #include <Guid/RamDiskHii.h>
 #include <Guid/FileInfo.h>
+#include <Guid/CompressedRamDiskImage.h>
 #include <IndustryStandard/Acpi61.h>
 
 #include "RamDiskNVData.h"
@@ -67,6 +70,33 @@ typedef enum _RAM_DISK_CREATE_METHOD {
   RamDiskCreateHii
 } RAM_DISK_CREATE_METHOD;
 
+//
+// Number of decompressed chunks kept per compressed RAM disk, so that
+// consecutive partial reads of a chunk decompress it only once.
+//
+#define RAM_DISK_CHUNK_CACHE_SIZE   8
+
+typedef struct {
+  UINT64                          ChunkIndex; // MAX_UINT64 if unused
+  UINT8                           *Data;
+  UINT64                          LastUse;
+} RAM_DISK_CHUNK_CACHE_ENTRY;
+
+//
+// State of a RAM disk registered with a compressed RAM disk image.
+//
+typedef struct {
+  CONST EDKII_COMPRESSED_RAM_DISK_IMAGE_HEADER  *Header;
+  CONST EDKII_COMPRESSED_RAM_DISK_CHUNK         *Chunks;
+  UINT64                          DiskSize;
+  UINT32                          ChunkSize;
+  UINT64                          ChunkCount;
+  VOID                            *Scratch;
+  UINT32                          ScratchSize;
+  UINT64                          UseCounter;
+  RAM_DISK_CHUNK_CACHE_ENTRY      Cache[RAM_DISK_CHUNK_CACHE_SIZE];
+} RAM_DISK_COMPRESSED_DATA;
+
 //
 // RamDiskDxe driver maintains a list of registered RAM disks.
 // The struct contains the list entry and the information of each RAM
@@ -79,6 +109,7 @@ typedef struct {
 
   EFI_BLOCK_IO_PROTOCOL           BlockIo;
   EFI_BLOCK_IO2_PROTOCOL          BlockIo2;
+  EDKII_BLOCK_IO_DIRECT_ACCESS_PROTOCOL DirectAccess;
   EFI_BLOCK_IO_MEDIA              Media;
   EFI_DEVICE_PATH_PROTOCOL        *DevicePath;
 
@@ -91,12 +122,18 @@ typedef struct {
   EFI_QUESTION_ID                 CheckBoxId;
   BOOLEAN                         CheckBoxChecked;
 
+  //
+  // NULL unless the RAM disk holds a compressed RAM disk image.
+  //
+  RAM_DISK_COMPRESSED_DATA        *Compressed;
+
   LIST_ENTRY                      ThisInstance;
 } RAM_DISK_PRIVATE_DATA;
 
 #define RAM_DISK_PRIVATE_DATA_SIGNATURE     SIGNATURE_32 ('R', 'D', 'S', 'K')
 #define RAM_DISK_PRIVATE_FROM_BLKIO(a)      CR (a, RAM_DISK_PRIVATE_DATA, BlockIo, RAM_DISK_PRIVATE_DATA_SIGNATURE)
 #define RAM_DISK_PRIVATE_FROM_BLKIO2(a)     CR (a, RAM_DISK_PRIVATE_DATA, BlockIo2, RAM_DISK_PRIVATE_DATA_SIGNATURE)
+#define RAM_DISK_PRIVATE_FROM_DIRECT_ACCESS(a) CR (a, RAM_DISK_PRIVATE_DATA, DirectAccess, RAM_DISK_PRIVATE_DATA_SIGNATURE)
 #define RAM_DISK_PRIVATE_FROM_THIS(a)       CR (a, RAM_DISK_PRIVATE_DATA, ThisInstance, RAM_DISK_PRIVATE_DATA_SIGNATURE)
 
 ///
@@ -438,6 +475,33 @@ RamDiskBlkIo2FlushBlocksEx (
   IN OUT EFI_BLOCK_IO2_TOKEN      *Token
   );
 
+/**
+  Return the address of the RAM disk data starting at a logical block.
+
+  @param[in]      This            Indicates a pointer to the calling context.
+  @param[in]      MediaId         The media ID that the request is for.
+  @param[in]      Lba             The starting logical block address.
+  @param[in, out] Length          On input, the number of bytes the caller
+                                  wants to access. On output, the number of
+                                  bytes available at Address.
+  @param[out]     Address         The address of the data at Lba.
+
+  @retval EFI_SUCCESS             Address and Length were returned.
+  @retval EFI_MEDIA_CHANGED       The MediaId is not for the current media.
+  @retval EFI_INVALID_PARAMETER   Lba is not valid, or Length or Address is
+                                  NULL.
+
+**/
+EFI_STATUS
+EFIAPI
+RamDiskDirectAccessMap (
+  IN     EDKII_BLOCK_IO_DIRECT_ACCESS_PROTOCOL  *This,
+  IN     UINT32                                 MediaId,
+  IN     EFI_LBA                                Lba,
+  IN OUT UINTN                                  *Length,
+  OUT    CONST VOID                             **Address
+  );
+
 /**
   This function publish the RAM disk configuration Form.
 
@@ -601,4 +665,56 @@ RamDiskPublishNfit (
   IN RAM_DISK_PRIVATE_DATA        *PrivateData
   );
 
+
+/**
+  Check whether a RAM disk holds a compressed RAM disk image and, if so,
+  prepare it to be read through RamDiskCompressedRead().
+
+  @param[in, out] PrivateData     Points to RAM disk private data.
+
+  @retval EFI_SUCCESS             The RAM disk holds a valid compressed image.
+  @retval EFI_NOT_FOUND           The RAM disk holds a plain image.
+  @retval EFI_INVALID_PARAMETER   The compressed image is corrupted.
+  @retval EFI_OUT_OF_RESOURCES    Not enough memory to read the image.
+
+**/
+EFI_STATUS
+RamDiskCompressedInit (
+  IN OUT RAM_DISK_PRIVATE_DATA    *PrivateData
+  );
+
+
+/**
+  Read data from a RAM disk holding a compressed RAM disk image.
+
+  @param[in]  PrivateData         Points to RAM disk private data.
+  @param[in]  Offset              The offset in the uncompressed disk.
+  @param[in]  BufferSize          The number of bytes to read.
+  @param[out] Buffer              The buffer receiving the data.
+
+  @retval EFI_SUCCESS             The data was read.
+  @retval EFI_DEVICE_ERROR        A chunk of the image could not be
+                                  decompressed.
+
+**/
+EFI_STATUS
+RamDiskCompressedRead (
+  IN  RAM_DISK_PRIVATE_DATA       *PrivateData,
+  IN  UINT64                      Offset,
+  IN  UINTN                       BufferSize,
+  OUT VOID                        *Buffer
+  );
+
+
+/**
+  Free the resources allocated by RamDiskCompressedInit().
+
+  @param[in, out] PrivateData     Points to RAM disk private data.
+
+**/
+VOID
+RamDiskCompressedFree (
+  IN OUT RAM_DISK_PRIVATE_DATA    *PrivateData
+  );
+
 #endif
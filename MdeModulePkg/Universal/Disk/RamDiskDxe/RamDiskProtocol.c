@@ -631,6 +631,13 @@ RamDiskRegister (
   CopyGuid (&PrivateData->TypeGuid, RamDiskType);
   InitializeListHead (&PrivateData->ThisInstance);
 
+  if (FeaturePcdGet (PcdRamDiskCompressedImageSupport)) {
+    Status = RamDiskCompressedInit (PrivateData);
+    if (EFI_ERROR (Status) && (Status != EFI_NOT_FOUND)) {
+      goto ErrorExit;
+    }
+  }
+
   //
   // Generate device path information for the registered RAM disk
   //
@@ -696,6 +703,8 @@ RamDiskRegister (
                   &PrivateData->BlockIo,
                   &gEfiBlockIo2ProtocolGuid,
                   &PrivateData->BlockIo2,
+                  &gEdkiiBlockIoDirectAccessProtocolGuid,
+                  &PrivateData->DirectAccess,
                   &gEfiDevicePathProtocolGuid,
                   PrivateData->DevicePath,
                   NULL
@@ -713,7 +722,11 @@ RamDiskRegister (
 
   FreePool (RamDiskDevNode);
 
-  if ((mAcpiTableProtocol != NULL) && (mAcpiSdtProtocol != NULL)) {
+  //
+  // The OS would see the compressed image rather than the disk content.
+  //
+  if ((mAcpiTableProtocol != NULL) && (mAcpiSdtProtocol != NULL) &&
+      (PrivateData->Compressed == NULL)) {
     RamDiskPublishNfit (PrivateData);
   }
 
@@ -729,6 +742,7 @@ ErrorExit:
       FreePool (PrivateData->DevicePath);
     }
 
+    RamDiskCompressedFree (PrivateData);
     FreePool (PrivateData);
   }
 
@@ -824,6 +838,8 @@ RamDiskUnregister (
                &PrivateData->BlockIo,
                &gEfiBlockIo2ProtocolGuid,
                &PrivateData->BlockIo2,
+               &gEdkiiBlockIoDirectAccessProtocolGuid,
+               &PrivateData->DirectAccess,
                &gEfiDevicePathProtocolGuid,
                (EFI_DEVICE_PATH_PROTOCOL *) PrivateData->DevicePath,
                NULL
@@ -840,6 +856,7 @@ RamDiskUnregister (
           FreePool ((VOID *)(UINTN) PrivateData->StartingAddr);
         }
 
+        RamDiskCompressedFree (PrivateData);
         FreePool (PrivateData->DevicePath);
         FreePool (PrivateData);
         Found = TRUE;
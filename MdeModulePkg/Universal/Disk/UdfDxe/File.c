@@ -72,8 +72,10 @@ UdfOpenVolume (
   if (PrivFsData->OpenFiles == 0) {
     //
     // There is no more open files. Read volume information again since it was
-    // cleaned up on the last UdfClose() call.
+    // cleaned up on the last UdfClose() call. Directory indexes of the
+    // previous volume are stale as well.
     //
+    FreeDirectoryIndexes (&PrivFsData->Volume);
     Status = ReadUdfVolumeInformation (
       PrivFsData->BlockIo,
       PrivFsData->DiskIo,
@@ -523,6 +525,89 @@ Error_Invalid_Params:
   return Status;
 }
 
+/**
+  Read the whole contents of an open file into a caller provided buffer.
+
+  The file is read through its decoded extents, one DiskIo request per
+  extent straight into Buffer. The file position of File is not changed.
+
+  @param  This       The EDKII_FILE_BULK_READ_PROTOCOL instance of the volume.
+  @param  File       The file handle.
+  @param  BufferSize On input size of buffer, on output amount of data in
+                     buffer, or the size of the file if the buffer is too small.
+  @param  Buffer     The buffer in which data is read.
+
+  @retval EFI_SUCCESS           The file was read.
+  @retval EFI_BUFFER_TOO_SMALL  BufferSize is too small. BufferSize contains
+                                required size.
+  @retval EFI_INVALID_PARAMETER File is not a regular file of this volume.
+  @retval EFI_DEVICE_ERROR      The device reported an error.
+  @retval EFI_VOLUME_CORRUPTED  The file system structures are corrupted.
+
+**/
+EFI_STATUS
+EFIAPI
+UdfBulkReadFile (
+  IN      EDKII_FILE_BULK_READ_PROTOCOL  *This,
+  IN      EFI_FILE_PROTOCOL              *File,
+  IN OUT  UINTN                          *BufferSize,
+  OUT     VOID                           *Buffer
+  )
+{
+  EFI_TPL                     OldTpl;
+  EFI_STATUS                  Status;
+  PRIVATE_UDF_FILE_DATA       *PrivFileData;
+  PRIVATE_UDF_SIMPLE_FS_DATA  *PrivFsData;
+  UINT64                      FilePosition;
+  UINT64                      BufferSizeUint64;
+
+  if (This == NULL || File == NULL || BufferSize == NULL ||
+      (*BufferSize != 0 && Buffer == NULL)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  //
+  // Only files opened on this driver can be read.
+  //
+  if (File->Read != UdfRead) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  PrivFsData   = PRIVATE_UDF_SIMPLE_FS_DATA_FROM_BULK_READ (This);
+  PrivFileData = PRIVATE_UDF_FILE_DATA_FROM_THIS (File);
+  if (PrivFileData->SimpleFs != &PrivFsData->SimpleFs ||
+      !IS_FID_NORMAL_FILE (_FILE (PrivFileData)->FileIdentifierDesc)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (*BufferSize < PrivFileData->FileSize) {
+    *BufferSize = (UINTN)PrivFileData->FileSize;
+    return EFI_BUFFER_TOO_SMALL;
+  }
+
+  OldTpl = gBS->RaiseTPL (TPL_CALLBACK);
+
+  FilePosition     = 0;
+  BufferSizeUint64 = PrivFileData->FileSize;
+  Status = ReadFileData (
+    PrivFsData->BlockIo,
+    PrivFsData->DiskIo,
+    &PrivFsData->Volume,
+    _FILE (PrivFileData),
+    PrivFileData->FileSize,
+    &FilePosition,
+    Buffer,
+    &BufferSizeUint64
+    );
+  if (!EFI_ERROR (Status)) {
+    *BufferSize = (UINTN)BufferSizeUint64;
+  }
+
+  gBS->RestoreTPL (OldTpl);
+
+  return Status;
+}
+
 /**
   Close the file handle.
 
@@ -1398,6 +1398,365 @@ Error_Get_Aed:
   return Status;
 }
 
+/**
+  Compute the hash of a file name in a directory name index.
+
+  @param[in]  FileName            File name string.
+
+  @return The hash of FileName.
+
+**/
+STATIC
+UINT32
+HashDirectoryIndexName (
+  IN CONST CHAR16  *FileName
+  )
+{
+  UINT32  Hash;
+
+  //
+  // FNV-1a over the UCS-2 characters.
+  //
+  Hash = 2166136261U;
+  while (*FileName != L'\0') {
+    Hash = (Hash ^ *FileName++) * 16777619U;
+  }
+
+  return Hash;
+}
+
+/**
+  Unlink and free a directory name index.
+
+  @param[in]  DirectoryIndex      The directory name index.
+
+**/
+STATIC
+VOID
+FreeDirectoryIndex (
+  IN  UDF_DIRECTORY_INDEX  *DirectoryIndex
+  )
+{
+  RemoveEntryList (&DirectoryIndex->Link);
+
+  if (DirectoryIndex->DirectoryData != NULL) {
+    FreePool (DirectoryIndex->DirectoryData);
+  }
+
+  if (DirectoryIndex->Entries != NULL) {
+    FreePool (DirectoryIndex->Entries);
+  }
+
+  if (DirectoryIndex->Buckets != NULL) {
+    FreePool (DirectoryIndex->Buckets);
+  }
+
+  FreePool (DirectoryIndex);
+}
+
+/**
+  Free the directory name indexes of an UDF volume.
+
+  @param[in, out]  Volume  UDF volume information structure.
+
+**/
+VOID
+FreeDirectoryIndexes (
+  IN OUT  UDF_VOLUME_INFO  *Volume
+  )
+{
+  while (!IsListEmpty (&Volume->DirectoryIndexList)) {
+    FreeDirectoryIndex (
+      CR (
+        GetFirstNode (&Volume->DirectoryIndexList),
+        UDF_DIRECTORY_INDEX,
+        Link,
+        UDF_DIRECTORY_INDEX_SIGNATURE
+        )
+      );
+  }
+
+  Volume->DirectoryIndexCount = 0;
+}
+
+/**
+  Read the recorded data of a directory and hash the names of its FIDs.
+
+  Deleted FIDs are skipped, and so are FIDs whose name cannot be decoded, as
+  they could never match a lookup. A FID that does not fit in the directory
+  data ends the index.
+
+  @param[in]  BlockIo             BlockIo interface.
+  @param[in]  DiskIo              DiskIo interface.
+  @param[in]  Volume              Volume information pointer.
+  @param[in]  ParentIcb           ICB of the directory.
+  @param[in]  FileEntryData       FE/EFE of the directory.
+  @param[out] DirectoryIndex      The directory name index.
+
+  @retval EFI_SUCCESS             The directory name index was built.
+  @retval EFI_OUT_OF_RESOURCES    The directory name index was not built due
+                                  to lack of resources.
+  @retval other                   The directory data could not be read.
+
+**/
+STATIC
+EFI_STATUS
+BuildDirectoryIndex (
+  IN   EFI_BLOCK_IO_PROTOCOL           *BlockIo,
+  IN   EFI_DISK_IO_PROTOCOL            *DiskIo,
+  IN   UDF_VOLUME_INFO                 *Volume,
+  IN   UDF_LONG_ALLOCATION_DESCRIPTOR  *ParentIcb,
+  IN   VOID                            *FileEntryData,
+  OUT  UDF_DIRECTORY_INDEX             **DirectoryIndex
+  )
+{
+  EFI_STATUS                      Status;
+  UDF_READ_FILE_INFO              ReadFileInfo;
+  UDF_DIRECTORY_INDEX             *Index;
+  UDF_DIRECTORY_INDEX_ENTRY       *Entry;
+  UDF_FILE_IDENTIFIER_DESCRIPTOR  *FileIdentifierDesc;
+  UINT64                          FidOffset;
+  UINT64                          FidLength;
+  UINTN                           FidCount;
+  UINTN                           EntryCount;
+  UINTN                           Bucket;
+  CHAR16                          FileName[UDF_FILENAME_LENGTH];
+
+  Index = AllocateZeroPool (sizeof (UDF_DIRECTORY_INDEX));
+  if (Index == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Index->Signature       = UDF_DIRECTORY_INDEX_SIGNATURE;
+  Index->ParentFidOffset = MAX_UINT64;
+  CopyMem ((VOID *)&Index->Location, (VOID *)&ParentIcb->ExtentLocation,
+           sizeof (UDF_LB_ADDR));
+
+  ReadFileInfo.Flags = ReadFileAllocateAndRead;
+
+  Status = ReadFile (
+    BlockIo,
+    DiskIo,
+    Volume,
+    ParentIcb,
+    FileEntryData,
+    &ReadFileInfo
+    );
+  if (EFI_ERROR (Status)) {
+    goto Error_Read_Directory;
+  }
+
+  Index->DirectoryData   = ReadFileInfo.FileData;
+  Index->DirectoryLength = ReadFileInfo.ReadLength;
+
+  //
+  // Count the FIDs to size the hash table.
+  //
+  FidCount = 0;
+  for (FidOffset = 0;
+       FidOffset + OFFSET_OF (UDF_FILE_IDENTIFIER_DESCRIPTOR, Data[0]) <=
+       Index->DirectoryLength;
+       FidOffset += FidLength) {
+    FidLength = GetFidDescriptorLength (
+                  GET_FID_FROM_ADS (Index->DirectoryData, FidOffset)
+                  );
+    if (FidOffset + FidLength > Index->DirectoryLength) {
+      break;
+    }
+
+    FidCount++;
+  }
+
+  Index->BucketCount = UDF_DIRECTORY_INDEX_MIN_BUCKETS;
+  while (Index->BucketCount < FidCount) {
+    Index->BucketCount <<= 1;
+  }
+
+  Index->Buckets = AllocateZeroPool (Index->BucketCount * sizeof (UINT32));
+  if (Index->Buckets == NULL) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto Error_Alloc_Index;
+  }
+
+  if (FidCount > 0) {
+    Index->Entries = AllocatePool (FidCount * sizeof (UDF_DIRECTORY_INDEX_ENTRY));
+    if (Index->Entries == NULL) {
+      Status = EFI_OUT_OF_RESOURCES;
+      goto Error_Alloc_Index;
+    }
+  }
+
+  EntryCount = 0;
+  for (FidOffset = 0; FidCount > 0; FidCount--, FidOffset += FidLength) {
+    FileIdentifierDesc = GET_FID_FROM_ADS (Index->DirectoryData, FidOffset);
+    FidLength          = GetFidDescriptorLength (FileIdentifierDesc);
+
+    if (IS_FID_DELETED_FILE (FileIdentifierDesc)) {
+      continue;
+    }
+
+    if (IS_FID_PARENT_FILE (FileIdentifierDesc)) {
+      if (Index->ParentFidOffset == MAX_UINT64) {
+        Index->ParentFidOffset = FidOffset;
+      }
+
+      continue;
+    }
+
+    Status = GetFileNameFromFid (FileIdentifierDesc, ARRAY_SIZE (FileName),
+               FileName);
+    if (EFI_ERROR (Status)) {
+      continue;
+    }
+
+    Entry            = &Index->Entries[EntryCount];
+    Entry->Hash      = HashDirectoryIndexName (FileName);
+    Entry->FidOffset = FidOffset;
+
+    Bucket                 = Entry->Hash & (Index->BucketCount - 1);
+    Entry->Next            = Index->Buckets[Bucket];
+    Index->Buckets[Bucket] = (UINT32)++EntryCount;
+  }
+
+  *DirectoryIndex = Index;
+
+  return EFI_SUCCESS;
+
+Error_Alloc_Index:
+  if (Index->Buckets != NULL) {
+    FreePool (Index->Buckets);
+  }
+
+  if (Index->DirectoryData != NULL) {
+    FreePool (Index->DirectoryData);
+  }
+
+Error_Read_Directory:
+  FreePool (Index);
+
+  return Status;
+}
+
+/**
+  Look up a file name in the name index of a directory, building the index
+  the first time the directory is searched.
+
+  @param[in]  BlockIo             BlockIo interface.
+  @param[in]  DiskIo              DiskIo interface.
+  @param[in]  Volume              Volume information pointer.
+  @param[in]  ParentIcb           ICB of the directory.
+  @param[in]  FileEntryData       FE/EFE of the directory.
+  @param[in]  FileName            File name string. ".." and "\\" match the
+                                  FID of the parent directory.
+  @param[out] FoundFid            A copy of the matching FID.
+
+  @retval EFI_SUCCESS             The file name was found.
+  @retval EFI_NOT_FOUND           The file name was not found.
+  @retval EFI_OUT_OF_RESOURCES    The file name was not looked up due to lack
+                                  of resources.
+  @retval other                   The directory data could not be read.
+
+**/
+STATIC
+EFI_STATUS
+FindFidInDirectoryIndex (
+  IN   EFI_BLOCK_IO_PROTOCOL           *BlockIo,
+  IN   EFI_DISK_IO_PROTOCOL            *DiskIo,
+  IN   UDF_VOLUME_INFO                 *Volume,
+  IN   UDF_LONG_ALLOCATION_DESCRIPTOR  *ParentIcb,
+  IN   VOID                            *FileEntryData,
+  IN   CHAR16                          *FileName,
+  OUT  UDF_FILE_IDENTIFIER_DESCRIPTOR  **FoundFid
+  )
+{
+  EFI_STATUS                      Status;
+  LIST_ENTRY                      *Link;
+  UDF_DIRECTORY_INDEX             *Index;
+  UDF_DIRECTORY_INDEX_ENTRY       *Entry;
+  UDF_FILE_IDENTIFIER_DESCRIPTOR  *FileIdentifierDesc;
+  UINT64                          FidOffset;
+  UINT32                          EntryIndex;
+  UINT32                          Hash;
+  CHAR16                          FoundFileName[UDF_FILENAME_LENGTH];
+
+  Index = NULL;
+  for (Link = GetFirstNode (&Volume->DirectoryIndexList);
+       !IsNull (&Volume->DirectoryIndexList, Link);
+       Link = GetNextNode (&Volume->DirectoryIndexList, Link)) {
+    Index = CR (Link, UDF_DIRECTORY_INDEX, Link, UDF_DIRECTORY_INDEX_SIGNATURE);
+    if (CompareMem ((VOID *)&Index->Location,
+                    (VOID *)&ParentIcb->ExtentLocation,
+                    sizeof (UDF_LB_ADDR)) == 0) {
+      break;
+    }
+
+    Index = NULL;
+  }
+
+  if (Index == NULL) {
+    Status = BuildDirectoryIndex (BlockIo, DiskIo, Volume, ParentIcb,
+               FileEntryData, &Index);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+
+    if (Volume->DirectoryIndexCount >= UDF_DIRECTORY_INDEX_MAX_COUNT) {
+      FreeDirectoryIndex (
+        CR (
+          GetPreviousNode (&Volume->DirectoryIndexList,
+            &Volume->DirectoryIndexList),
+          UDF_DIRECTORY_INDEX,
+          Link,
+          UDF_DIRECTORY_INDEX_SIGNATURE
+          )
+        );
+      Volume->DirectoryIndexCount--;
+    }
+
+    Volume->DirectoryIndexCount++;
+  } else {
+    RemoveEntryList (&Index->Link);
+  }
+
+  InsertHeadList (&Volume->DirectoryIndexList, &Index->Link);
+
+  if (StrCmp (FileName, L"..") == 0 || StrCmp (FileName, L"\\") == 0) {
+    FidOffset = Index->ParentFidOffset;
+  } else {
+    FidOffset = MAX_UINT64;
+    Hash      = HashDirectoryIndexName (FileName);
+
+    for (EntryIndex = Index->Buckets[Hash & (Index->BucketCount - 1)];
+         EntryIndex != 0;
+         EntryIndex = Entry->Next) {
+      Entry = &Index->Entries[EntryIndex - 1];
+      if (Entry->Hash != Hash) {
+        continue;
+      }
+
+      FileIdentifierDesc = GET_FID_FROM_ADS (Index->DirectoryData,
+                                             Entry->FidOffset);
+      Status = GetFileNameFromFid (FileIdentifierDesc,
+                 ARRAY_SIZE (FoundFileName), FoundFileName);
+      if (!EFI_ERROR (Status) && StrCmp (FileName, FoundFileName) == 0) {
+        FidOffset = Entry->FidOffset;
+        break;
+      }
+    }
+  }
+
+  if (FidOffset == MAX_UINT64) {
+    return EFI_NOT_FOUND;
+  }
+
+  DuplicateFid (GET_FID_FROM_ADS (Index->DirectoryData, FidOffset), FoundFid);
+  if (*FoundFid == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  return EFI_SUCCESS;
+}
+
 /**
   Find a file by its filename from a given Parent file.
 
@@ -1427,11 +1786,11 @@ InternalFindFile (
 {
   EFI_STATUS                      Status;
   UDF_FILE_IDENTIFIER_DESCRIPTOR  *FileIdentifierDesc;
-  UDF_READ_DIRECTORY_INFO         ReadDirInfo;
   BOOLEAN                         Found;
-  CHAR16                          FoundFileName[UDF_FILENAME_LENGTH];
   VOID                            *CompareFileEntry;
 
+  File->ExtentCache = NULL;
+
   //
   // Check if both Parent->FileIdentifierDesc and Icb are NULL.
   //
@@ -1470,74 +1829,24 @@ InternalFindFile (
   }
 
   //
-  // Start directory listing.
+  // Look the name up in the directory's name index.
   //
-  ZeroMem ((VOID *)&ReadDirInfo, sizeof (UDF_READ_DIRECTORY_INFO));
-  Found = FALSE;
-
-  for (;;) {
-    Status = ReadDirectoryEntry (
-      BlockIo,
-      DiskIo,
-      Volume,
-      (Parent->FileIdentifierDesc != NULL) ?
-      &Parent->FileIdentifierDesc->Icb :
-      Icb,
-      Parent->FileEntry,
-      &ReadDirInfo,
-      &FileIdentifierDesc
-      );
-    if (EFI_ERROR (Status)) {
-      if (Status == EFI_DEVICE_ERROR) {
-        Status = EFI_NOT_FOUND;
-      }
-
-      break;
-    }
-    //
-    // After calling function ReadDirectoryEntry(), if 'FileIdentifierDesc' is
-    // NULL, then the 'Status' must be EFI_OUT_OF_RESOURCES. Hence, if the code
-    // reaches here, 'FileIdentifierDesc' must be not NULL.
-    //
-    // The ASSERT here is for addressing a false positive NULL pointer
-    // dereference issue raised from static analysis.
-    //
-    ASSERT (FileIdentifierDesc != NULL);
-
-    if (FileIdentifierDesc->FileCharacteristics & PARENT_FILE) {
-      //
-      // This FID contains the location (FE/EFE) of the parent directory of this
-      // directory (Parent), and if FileName is either ".." or "\\", then it's
-      // the expected FID.
-      //
-      if (StrCmp (FileName, L"..") == 0 || StrCmp (FileName, L"\\") == 0) {
-        Found = TRUE;
-        break;
-      }
-    } else {
-      Status = GetFileNameFromFid (FileIdentifierDesc, ARRAY_SIZE (FoundFileName), FoundFileName);
-      if (EFI_ERROR (Status)) {
-        break;
-      }
-
-      if (StrCmp (FileName, FoundFileName) == 0) {
-        //
-        // FID has been found. Prepare to find its respective FE/EFE.
-        //
-        Found = TRUE;
-        break;
-      }
-    }
-
-    FreePool ((VOID *)FileIdentifierDesc);
+  Status = FindFidInDirectoryIndex (
+    BlockIo,
+    DiskIo,
+    Volume,
+    (Parent->FileIdentifierDesc != NULL) ?
+    &Parent->FileIdentifierDesc->Icb :
+    Icb,
+    Parent->FileEntry,
+    FileName,
+    &FileIdentifierDesc
+    );
+  if (Status == EFI_DEVICE_ERROR) {
+    Status = EFI_NOT_FOUND;
   }
 
-  if (ReadDirInfo.DirectoryData != NULL) {
-    //
-    // Free all allocated resources for the directory listing.
-    //
-    FreePool (ReadDirInfo.DirectoryData);
-  }
+  Found = (BOOLEAN)!EFI_ERROR (Status);
 
   if (Found) {
     Status = EFI_SUCCESS;
@@ -1845,6 +2154,7 @@ FindFile (
         // its FE/EFE and FID descriptors.
         //
         Status = EFI_SUCCESS;
+        File->ExtentCache = NULL;
         DuplicateFe (BlockIo, Volume, Root->FileEntry, &File->FileEntry);
         if (File->FileEntry == NULL) {
           Status = EFI_OUT_OF_RESOURCES;
@@ -2350,6 +2660,15 @@ CleanupFileInformation (
   if (File->FileIdentifierDesc != NULL) {
     FreePool ((VOID *)File->FileIdentifierDesc);
   }
+  if (File->ExtentCache != NULL) {
+    if (File->ExtentCache->Extents != NULL) {
+      FreePool (File->ExtentCache->Extents);
+    }
+    if (File->ExtentCache->ReadAheadBuffer != NULL) {
+      FreePool (File->ExtentCache->ReadAheadBuffer);
+    }
+    FreePool (File->ExtentCache);
+  }
 
   ZeroMem ((VOID *)File, sizeof (UDF_FILE_INFO));
 }
@@ -2788,6 +3107,325 @@ Out_Free:
   return Status;
 }
 
+/**
+  Decode the Allocation Descriptors of a file, following its Allocation Extent
+  Descriptors, into a list of recorded extents.
+
+  Extents that are not recorded are skipped, as ReadFile() does.
+
+  @param[in]  BlockIo             BlockIo interface.
+  @param[in]  DiskIo              DiskIo interface.
+  @param[in]  Volume              Volume information pointer.
+  @param[in]  File                File information structure.
+  @param[out] ExtentCache         The decoded extents.
+
+  @retval EFI_SUCCESS             The extents were decoded.
+  @retval EFI_UNSUPPORTED         The file has no Short or Long Allocation
+                                  Descriptors.
+  @retval EFI_OUT_OF_RESOURCES    The extents were not decoded due to lack of
+                                  resources.
+  @retval other                   The extents were not decoded.
+
+**/
+STATIC
+EFI_STATUS
+BuildExtentCache (
+  IN   EFI_BLOCK_IO_PROTOCOL  *BlockIo,
+  IN   EFI_DISK_IO_PROTOCOL   *DiskIo,
+  IN   UDF_VOLUME_INFO        *Volume,
+  IN   UDF_FILE_INFO          *File,
+  OUT  UDF_EXTENT_CACHE       **ExtentCache
+  )
+{
+  EFI_STATUS              Status;
+  UDF_FE_RECORDING_FLAGS  RecordingFlags;
+  UDF_EXTENT_CACHE        *Cache;
+  UDF_EXTENT              *Extents;
+  UINTN                   ExtentMax;
+  VOID                    *Data;
+  VOID                    *DataBak;
+  BOOLEAN                 DoFreeAed;
+  UINT64                  Length;
+  UINT64                  AdOffset;
+  UINT64                  FileOffset;
+  UINT64                  Lsn;
+  VOID                    *Ad;
+  UINT32                  ExtentLength;
+
+  RecordingFlags = GET_FE_RECORDING_FLAGS (File->FileEntry);
+  if (RecordingFlags != LongAdsSequence && RecordingFlags != ShortAdsSequence) {
+    return EFI_UNSUPPORTED;
+  }
+
+  Status = GetAdsInformation (File->FileEntry, Volume->FileEntrySize, &Data, &Length);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Cache = AllocateZeroPool (sizeof (UDF_EXTENT_CACHE));
+  if (Cache == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  ExtentMax  = 0;
+  FileOffset = 0;
+  AdOffset   = 0;
+  DoFreeAed  = FALSE;
+
+  for (;;) {
+    Status = GetAllocationDescriptor (RecordingFlags, Data, &AdOffset, Length, &Ad);
+    if (Status == EFI_DEVICE_ERROR) {
+      Status = EFI_SUCCESS;
+      break;
+    }
+
+    //
+    // Check if AD is an indirect AD. If so, continue with the ADs of the
+    // Allocation Extent Descriptor.
+    //
+    if (GET_EXTENT_FLAGS (RecordingFlags, Ad) == ExtentIsNextExtent) {
+      DataBak = Data;
+      Status  = GetAedAdsData (
+                  BlockIo,
+                  DiskIo,
+                  Volume,
+                  &File->FileIdentifierDesc->Icb,
+                  RecordingFlags,
+                  Ad,
+                  &Data,
+                  &Length
+                  );
+      if (DoFreeAed) {
+        FreePool (DataBak);
+      }
+
+      DoFreeAed = TRUE;
+      if (EFI_ERROR (Status)) {
+        //
+        // GetAedAdsData() may fail after allocating the new buffer.
+        //
+        DoFreeAed = (BOOLEAN) (Data != NULL && Data != DataBak);
+        break;
+      }
+
+      AdOffset = 0;
+      continue;
+    }
+
+    ExtentLength = GET_EXTENT_LENGTH (RecordingFlags, Ad);
+    Status       = GetAllocationDescriptorLsn (
+                     RecordingFlags,
+                     Volume,
+                     &File->FileIdentifierDesc->Icb,
+                     Ad,
+                     &Lsn
+                     );
+    if (EFI_ERROR (Status)) {
+      break;
+    }
+
+    if (Cache->ExtentCount == ExtentMax) {
+      Extents = ReallocatePool (
+                  ExtentMax * sizeof (UDF_EXTENT),
+                  MAX (UDF_EXTENT_MIN_COUNT, ExtentMax * 2) * sizeof (UDF_EXTENT),
+                  Cache->Extents
+                  );
+      if (Extents == NULL) {
+        Status = EFI_OUT_OF_RESOURCES;
+        break;
+      }
+
+      Cache->Extents = Extents;
+      ExtentMax      = MAX (UDF_EXTENT_MIN_COUNT, ExtentMax * 2);
+    }
+
+    Cache->Extents[Cache->ExtentCount].FileOffset = FileOffset;
+    Cache->Extents[Cache->ExtentCount].DiskOffset =
+      MultU64x32 (Lsn, Volume->LogicalVolDesc.LogicalBlockSize);
+    Cache->Extents[Cache->ExtentCount].Length     = ExtentLength;
+    Cache->ExtentCount++;
+    FileOffset += ExtentLength;
+
+    AdOffset += AD_LENGTH (RecordingFlags);
+  }
+
+  if (DoFreeAed) {
+    FreePool (Data);
+  }
+
+  if (EFI_ERROR (Status)) {
+    if (Cache->Extents != NULL) {
+      FreePool (Cache->Extents);
+    }
+    FreePool (Cache);
+    return Status;
+  }
+
+  *ExtentCache = Cache;
+  return EFI_SUCCESS;
+}
+
+/**
+  Find the extent holding a file position.
+
+  @param[in]  Cache               The decoded extents of the file.
+  @param[in]  Position            The file position.
+
+  @return The extent, or NULL if Position is beyond the recorded extents.
+
+**/
+STATIC
+UDF_EXTENT *
+LookupExtent (
+  IN  UDF_EXTENT_CACHE  *Cache,
+  IN  UINT64            Position
+  )
+{
+  UINTN       Low;
+  UINTN       High;
+  UINTN       Middle;
+  UDF_EXTENT  *Extent;
+
+  Low  = 0;
+  High = Cache->ExtentCount;
+  while (Low < High) {
+    Middle = Low + (High - Low) / 2;
+    Extent = &Cache->Extents[Middle];
+    if (Position < Extent->FileOffset) {
+      High = Middle;
+    } else if (Position - Extent->FileOffset >= Extent->Length) {
+      Low = Middle + 1;
+    } else {
+      return Extent;
+    }
+  }
+
+  return NULL;
+}
+
+/**
+  Read file data through the extent cache of the file. Small reads that
+  continue the previous read are served from a readahead window.
+
+  @param[in]      BlockIo       BlockIo interface.
+  @param[in]      DiskIo        DiskIo interface.
+  @param[in]      Cache         The decoded extents of the file.
+  @param[in]      FileSize      Size of the file.
+  @param[in, out] FilePosition  File position.
+  @param[out]     Buffer        File data.
+  @param[in, out] BufferSize    Read size.
+
+  @retval EFI_SUCCESS          File data read.
+  @retval other                The device reported an error.
+
+**/
+STATIC
+EFI_STATUS
+ReadFileExtents (
+  IN      EFI_BLOCK_IO_PROTOCOL  *BlockIo,
+  IN      EFI_DISK_IO_PROTOCOL   *DiskIo,
+  IN      UDF_EXTENT_CACHE       *Cache,
+  IN      UINT64                 FileSize,
+  IN OUT  UINT64                 *FilePosition,
+  OUT     VOID                   *Buffer,
+  IN OUT  UINT64                 *BufferSize
+  )
+{
+  EFI_STATUS  Status;
+  UDF_EXTENT  *Extent;
+  UINT64      Position;
+  UINT64      BytesLeft;
+  UINT64      ExtentLeft;
+  UINTN       Chunk;
+  UINT8       *Destination;
+  BOOLEAN     Sequential;
+
+  Status      = EFI_SUCCESS;
+  Position    = *FilePosition;
+  BytesLeft   = MIN (*BufferSize, FileSize - Position);
+  Destination = Buffer;
+  Sequential  = (BOOLEAN) (Position == Cache->NextPosition && BytesLeft < UDF_READAHEAD_SIZE);
+
+  while (BytesLeft > 0) {
+    //
+    // Serve what we can from the readahead window.
+    //
+    if (Cache->ReadAheadLength > 0 &&
+        Position >= Cache->ReadAheadOffset &&
+        Position - Cache->ReadAheadOffset < Cache->ReadAheadLength) {
+      Chunk = (UINTN) MIN (
+                        BytesLeft,
+                        Cache->ReadAheadLength - (Position - Cache->ReadAheadOffset)
+                        );
+      CopyMem (
+        Destination,
+        Cache->ReadAheadBuffer + (UINTN) (Position - Cache->ReadAheadOffset),
+        Chunk
+        );
+    } else {
+      Extent = LookupExtent (Cache, Position);
+      if (Extent == NULL) {
+        //
+        // No more recorded extents.
+        //
+        break;
+      }
+
+      ExtentLeft = Extent->Length - (Position - Extent->FileOffset);
+      if (Sequential && Cache->ReadAheadBuffer == NULL) {
+        Cache->ReadAheadBuffer = AllocatePool (UDF_READAHEAD_SIZE);
+      }
+
+      if (Sequential && Cache->ReadAheadBuffer != NULL && BytesLeft < ExtentLeft) {
+        //
+        // Refill the readahead window from the current extent.
+        //
+        Cache->ReadAheadLength = 0;
+        Chunk                  = (UINTN) MIN (ExtentLeft, UDF_READAHEAD_SIZE);
+        Status = DiskIo->ReadDisk (
+          DiskIo,
+          BlockIo->Media->MediaId,
+          Extent->DiskOffset + (Position - Extent->FileOffset),
+          Chunk,
+          Cache->ReadAheadBuffer
+          );
+        if (EFI_ERROR (Status)) {
+          break;
+        }
+
+        Cache->ReadAheadOffset = Position;
+        Cache->ReadAheadLength = Chunk;
+        continue;
+      }
+
+      Chunk  = (UINTN) MIN (BytesLeft, ExtentLeft);
+      Status = DiskIo->ReadDisk (
+        DiskIo,
+        BlockIo->Media->MediaId,
+        Extent->DiskOffset + (Position - Extent->FileOffset),
+        Chunk,
+        Destination
+        );
+      if (EFI_ERROR (Status)) {
+        break;
+      }
+    }
+
+    Destination += Chunk;
+    Position    += Chunk;
+    BytesLeft   -= Chunk;
+  }
+
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  *BufferSize          = Position - *FilePosition;
+  *FilePosition        = Position;
+  Cache->NextPosition  = Position;
+  return EFI_SUCCESS;
+}
+
 /**
   Seek a file and read its data into memory on an UDF volume.
 
@@ -2824,6 +3462,29 @@ ReadFileData (
   EFI_STATUS          Status;
   UDF_READ_FILE_INFO  ReadFileInfo;
 
+  //
+  // Files made of Allocation Descriptors are read through their decoded
+  // extents, so the descriptors are only parsed once.
+  //
+  if (File->ExtentCache == NULL) {
+    Status = BuildExtentCache (BlockIo, DiskIo, Volume, File, &File->ExtentCache);
+    if (EFI_ERROR (Status) && Status != EFI_UNSUPPORTED) {
+      return Status;
+    }
+  }
+
+  if (File->ExtentCache != NULL) {
+    return ReadFileExtents (
+             BlockIo,
+             DiskIo,
+             File->ExtentCache,
+             FileSize,
+             FilePosition,
+             Buffer,
+             BufferSize
+             );
+  }
+
   ReadFileInfo.Flags         = ReadFileSeekAndRead;
   ReadFileInfo.FilePosition  = *FilePosition;
   ReadFileInfo.FileData      = Buffer;
@@ -175,12 +175,15 @@ UdfDriverBindingStart (
   PrivFsData->BlockIo   = BlockIo;
   PrivFsData->DiskIo    = DiskIo;
   PrivFsData->Handle    = ControllerHandle;
+  InitializeListHead (&PrivFsData->Volume.DirectoryIndexList);
 
   //
   // Set up SimpleFs protocol
   //
   CopyMem ((VOID *)&PrivFsData->SimpleFs, (VOID *)&gUdfSimpleFsTemplate,
            sizeof (EFI_SIMPLE_FILE_SYSTEM_PROTOCOL));
+  PrivFsData->BulkRead.Revision = EDKII_FILE_BULK_READ_PROTOCOL_REVISION;
+  PrivFsData->BulkRead.ReadFile = UdfBulkReadFile;
 
   //
   // Install child handle
@@ -189,6 +192,8 @@ UdfDriverBindingStart (
     &PrivFsData->Handle,
     &gEfiSimpleFileSystemProtocolGuid,
     &PrivFsData->SimpleFs,
+    &gEdkiiFileBulkReadProtocolGuid,
+    &PrivFsData->BulkRead,
     NULL
     );
 
@@ -267,9 +272,12 @@ UdfDriverBindingStop (
       PrivFsData->Handle,
       &gEfiSimpleFileSystemProtocolGuid,
       &PrivFsData->SimpleFs,
+      &gEdkiiFileBulkReadProtocolGuid,
+      &PrivFsData->BulkRead,
       NULL
       );
 
+    FreeDirectoryIndexes (&PrivFsData->Volume);
     FreePool ((VOID *)PrivFsData);
   }
 
@@ -18,6 +18,7 @@
 #include <Protocol/DevicePath.h>
 #include <Protocol/DriverBinding.h>
 #include <Protocol/DiskIo.h>
+#include <Protocol/FileBulkRead.h>
 #include <Protocol/SimpleFileSystem.h>
 
 #include <Guid/FileInfo.h>
@@ -114,6 +115,21 @@ typedef enum {
 #define UDF_FILENAME_LENGTH  128
 #define UDF_PATH_LENGTH      512
 
+//
+// Reads smaller than this that continue the previous read of a file are served
+// from a readahead window of this size
+//
+#define UDF_READAHEAD_SIZE   SIZE_128KB
+
+#define UDF_EXTENT_MIN_COUNT 16
+
+//
+// Number of directory name indexes kept per volume, and the smallest hash
+// table of an index
+//
+#define UDF_DIRECTORY_INDEX_MAX_COUNT    32
+#define UDF_DIRECTORY_INDEX_MIN_BUCKETS  16
+
 #define GET_FID_FROM_ADS(_Data, _Offs) \
   ((UDF_FILE_IDENTIFIER_DESCRIPTOR *)((UINT8 *)(_Data) + (_Offs)))
 
@@ -318,11 +334,61 @@ typedef struct {
   UDF_PARTITION_DESCRIPTOR       PartitionDesc;
   UDF_FILE_SET_DESCRIPTOR        FileSetDesc;
   UINTN                          FileEntrySize;
+  LIST_ENTRY                     DirectoryIndexList;   // Most recently used first
+  UINTN                          DirectoryIndexCount;
 } UDF_VOLUME_INFO;
 
+//
+// A named FID of a directory, chained into its hash bucket
+//
+typedef struct {
+  UINT32                          Hash;
+  UINT32                          Next;         // Entry index + 1, 0 ends the chain
+  UINT64                          FidOffset;    // Offset of the FID in DirectoryData
+} UDF_DIRECTORY_INDEX_ENTRY;
+
+#define UDF_DIRECTORY_INDEX_SIGNATURE SIGNATURE_32 ('U', 'd', 'f', 'i')
+
+//
+// Name index of a directory, built the first time a name is looked up in it
+//
+typedef struct {
+  UINTN                           Signature;
+  LIST_ENTRY                      Link;
+  UDF_LB_ADDR                     Location;         // ICB location of the directory
+  VOID                            *DirectoryData;
+  UINT64                          DirectoryLength;
+  UINT64                          ParentFidOffset;  // MAX_UINT64 if there is none
+  UDF_DIRECTORY_INDEX_ENTRY       *Entries;
+  UINT32                          *Buckets;         // Entry index + 1, 0 if empty
+  UINTN                           BucketCount;      // Power of two
+} UDF_DIRECTORY_INDEX;
+
+//
+// A recorded extent of a file, decoded from its Allocation Descriptors
+//
+typedef struct {
+  UINT64                          FileOffset;   // Offset of the extent in the file
+  UINT64                          DiskOffset;   // Byte offset of the extent on the disk
+  UINT32                          Length;       // Length of the extent in bytes
+} UDF_EXTENT;
+
+//
+// Decoded extents and readahead state of a file, built on its first read
+//
+typedef struct {
+  UDF_EXTENT                      *Extents;
+  UINTN                           ExtentCount;
+  UINT64                          NextPosition;     // File position following the last read
+  UINT8                           *ReadAheadBuffer;
+  UINT64                          ReadAheadOffset;  // File offset of the readahead window
+  UINTN                           ReadAheadLength;  // Valid bytes in the readahead window
+} UDF_EXTENT_CACHE;
+
 typedef struct {
   VOID                            *FileEntry;
   UDF_FILE_IDENTIFIER_DESCRIPTOR  *FileIdentifierDesc;
+  UDF_EXTENT_CACHE                *ExtentCache;
 } UDF_FILE_INFO;
 
 typedef struct {
@@ -365,11 +431,20 @@ typedef struct {
       PRIVATE_UDF_SIMPLE_FS_DATA_SIGNATURE \
       )
 
+#define PRIVATE_UDF_SIMPLE_FS_DATA_FROM_BULK_READ(a) \
+  CR ( \
+      a, \
+      PRIVATE_UDF_SIMPLE_FS_DATA, \
+      BulkRead, \
+      PRIVATE_UDF_SIMPLE_FS_DATA_SIGNATURE \
+      )
+
 typedef struct {
   UINTN                            Signature;
   EFI_BLOCK_IO_PROTOCOL            *BlockIo;
   EFI_DISK_IO_PROTOCOL             *DiskIo;
   EFI_SIMPLE_FILE_SYSTEM_PROTOCOL  SimpleFs;
+  EDKII_FILE_BULK_READ_PROTOCOL    BulkRead;
   UDF_VOLUME_INFO                  Volume;
   UDF_FILE_INFO                    Root;
   UINTN                            OpenFiles;
@@ -461,6 +536,32 @@ UdfRead (
   OUT     VOID               *Buffer
   );
 
+/**
+  Read the whole contents of an open file into a caller provided buffer.
+
+  @param  This       The EDKII_FILE_BULK_READ_PROTOCOL instance of the volume.
+  @param  File       The file handle.
+  @param  BufferSize On input size of buffer, on output amount of data in
+                     buffer, or the size of the file if the buffer is too small.
+  @param  Buffer     The buffer in which data is read.
+
+  @retval EFI_SUCCESS           The file was read.
+  @retval EFI_BUFFER_TOO_SMALL  BufferSize is too small. BufferSize contains
+                                required size.
+  @retval EFI_INVALID_PARAMETER File is not a regular file of this volume.
+  @retval EFI_DEVICE_ERROR      The device reported an error.
+  @retval EFI_VOLUME_CORRUPTED  The file system structures are corrupted.
+
+**/
+EFI_STATUS
+EFIAPI
+UdfBulkReadFile (
+  IN      EDKII_FILE_BULK_READ_PROTOCOL  *This,
+  IN      EFI_FILE_PROTOCOL              *File,
+  IN OUT  UINTN                          *BufferSize,
+  OUT     VOID                           *Buffer
+  );
+
 /**
   Close the file handle.
 
@@ -654,6 +755,17 @@ ReadUdfVolumeInformation (
   OUT  UDF_VOLUME_INFO        *Volume
   );
 
+/**
+  Free the directory name indexes of an UDF volume.
+
+  @param[in, out]  Volume  UDF volume information structure.
+
+**/
+VOID
+FreeDirectoryIndexes (
+  IN OUT  UDF_VOLUME_INFO  *Volume
+  );
+
 /**
   Find the root directory on an UDF volume.
 
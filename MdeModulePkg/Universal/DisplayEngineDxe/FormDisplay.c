@@ -104,6 +104,16 @@ DISPLAY_HIGHLIGHT_MENU_INFO   gHighligthMenuInfo = {0};
 BOOLEAN                       mIsFirstForm = TRUE;
 FORM_ENTRY_INFO               gOldFormEntry = {0};
 
+//
+// Paint info of the menus on screen, indexed by row. gMenuPaintCacheValid is
+// TRUE while the statement area shows exactly what was recorded, and
+// mMenuPaintCacheUsable allows DisplayOneMenu() to skip unchanged menus.
+//
+BOOLEAN                       gMenuPaintCacheValid = FALSE;
+BOOLEAN                       mMenuPaintCacheUsable = FALSE;
+UI_MENU_PAINT_CACHE           *mMenuPaintCache = NULL;
+UINTN                         mMenuPaintCacheCount = 0;
+
 //
 // Browser Global Strings
 //
@@ -2344,6 +2354,169 @@ FxConfirmPopup (
   return RetVal;
 }
 
+/**
+  Calculate the CRC32 of a string.
+
+  @param  String                   The string, may be NULL.
+
+  @return The CRC32 of the string, or 0 if String is NULL.
+
+**/
+UINT32
+GetStringCrc32 (
+  IN CHAR16                          *String
+  )
+{
+  UINT32                          Crc;
+
+  Crc = 0;
+  if (String != NULL) {
+    gBS->CalculateCrc32 (String, StrSize (String), &Crc);
+  }
+
+  return Crc;
+}
+
+/**
+  Collect the paint info of a menu option.
+
+  @param  MenuOption               The menu option to be painted.
+  @param  OptionString             The option string of the menu option.
+  @param  SkipWidth                The skip width between the left to the start of the prompt.
+  @param  BeginCol                 The begin column for one menu.
+  @param  SkipLine                 The skip line for this menu.
+  @param  BottomRow                The bottom row for this form.
+  @param  Highlight                Whether this menu will be highlight.
+  @param  PaintInfo                The paint info of the menu option.
+
+**/
+VOID
+GetMenuPaintInfo (
+  IN  UI_MENU_OPTION                 *MenuOption,
+  IN  CHAR16                         *OptionString,
+  IN  UINTN                          SkipWidth,
+  IN  UINTN                          BeginCol,
+  IN  UINTN                          SkipLine,
+  IN  UINTN                          BottomRow,
+  IN  BOOLEAN                        Highlight,
+  OUT UI_MENU_PAINT_INFO             *PaintInfo
+  )
+{
+  EFI_IFR_OP_HEADER               *OpCode;
+  CHAR16                          *StringPtr;
+
+  //
+  // Clear the padding too, paint infos are compared with CompareMem().
+  //
+  ZeroMem (PaintInfo, sizeof (UI_MENU_PAINT_INFO));
+
+  OpCode = MenuOption->ThisTag->OpCode;
+
+  PaintInfo->Row              = MenuOption->Row;
+  PaintInfo->Col              = MenuOption->Col;
+  PaintInfo->OptCol           = MenuOption->OptCol;
+  PaintInfo->Skip             = MenuOption->Skip;
+  PaintInfo->SkipWidth        = SkipWidth;
+  PaintInfo->BeginCol         = BeginCol;
+  PaintInfo->SkipLine         = SkipLine;
+  PaintInfo->BottomRow        = BottomRow;
+  PaintInfo->PromptBlockWidth = gPromptBlockWidth;
+  PaintInfo->OptionBlockWidth = gOptionBlockWidth;
+  PaintInfo->OpCode           = OpCode->OpCode;
+  PaintInfo->Highlight        = Highlight;
+  PaintInfo->GrayOut          = MenuOption->GrayOut;
+  PaintInfo->DescriptionCrc   = GetStringCrc32 (MenuOption->Description);
+  PaintInfo->OptionCrc        = GetStringCrc32 (OptionString);
+
+  if ((OpCode->OpCode == EFI_IFR_TEXT_OP) && (((EFI_IFR_TEXT *) OpCode)->TextTwo != 0)) {
+    StringPtr = GetToken (((EFI_IFR_TEXT *) OpCode)->TextTwo, gFormData->HiiHandle);
+    PaintInfo->TextTwoCrc = GetStringCrc32 (StringPtr);
+    FreePool (StringPtr);
+  }
+}
+
+/**
+  Mark the recorded paint info of some rows as invalid.
+
+  @param  Row                      The first row.
+  @param  Count                    The number of rows.
+
+**/
+VOID
+InvalidateMenuPaintCache (
+  IN UINTN                           Row,
+  IN UINTN                           Count
+  )
+{
+  while (Count > 0 && Row < mMenuPaintCacheCount) {
+    mMenuPaintCache[Row].Valid = FALSE;
+    Row++;
+    Count--;
+  }
+}
+
+/**
+  Check whether a menu option is shown on screen exactly as it would be painted.
+
+  If so, the number of lines of the menu option is restored from the time it
+  was painted.
+
+  @param  MenuOption               The menu option to be painted.
+  @param  PaintInfo                The paint info of the menu option.
+
+  @retval TRUE                     The menu option need not be painted.
+  @retval FALSE                    The menu option must be painted.
+
+**/
+BOOLEAN
+IsMenuPainted (
+  IN UI_MENU_OPTION                  *MenuOption,
+  IN UI_MENU_PAINT_INFO              *PaintInfo
+  )
+{
+  UI_MENU_PAINT_CACHE             *Cache;
+
+  if (!mMenuPaintCacheUsable || MenuOption->Row >= mMenuPaintCacheCount) {
+    return FALSE;
+  }
+
+  Cache = &mMenuPaintCache[MenuOption->Row];
+  if (!Cache->Valid || CompareMem (&Cache->PaintInfo, PaintInfo, sizeof (UI_MENU_PAINT_INFO)) != 0) {
+    return FALSE;
+  }
+
+  MenuOption->Skip = Cache->Skip;
+  return TRUE;
+}
+
+/**
+  Record what was painted for a menu option.
+
+  @param  MenuOption               The menu option which was painted.
+  @param  PaintInfo                The paint info of the menu option, or NULL
+                                   if it can not be recorded.
+
+**/
+VOID
+RecordMenuPaint (
+  IN UI_MENU_OPTION                  *MenuOption,
+  IN UI_MENU_PAINT_INFO              *PaintInfo  OPTIONAL
+  )
+{
+  UI_MENU_PAINT_CACHE             *Cache;
+
+  InvalidateMenuPaintCache (MenuOption->Row, MAX (MenuOption->Skip, 1));
+
+  if (PaintInfo == NULL || MenuOption->Row >= mMenuPaintCacheCount) {
+    return;
+  }
+
+  Cache = &mMenuPaintCache[MenuOption->Row];
+  CopyMem (&Cache->PaintInfo, PaintInfo, sizeof (UI_MENU_PAINT_INFO));
+  Cache->Skip  = MenuOption->Skip;
+  Cache->Valid = TRUE;
+}
+
 /**
   Print string for this menu option.
 
@@ -2388,6 +2561,8 @@ DisplayOneMenu (
   UINTN                           OptionLineNum;
   CHAR16                          AdjustValue;
   UINTN                           MaxRow;
+  UI_MENU_PAINT_INFO              PaintInfo;
+  BOOLEAN                         Cacheable;
 
   Statement = MenuOption->ThisTag;
   Temp      = SkipLine;
@@ -2412,6 +2587,22 @@ DisplayOneMenu (
     return Status;
   }
 
+  //
+  // Skip the menu if the screen already shows it as it would be painted.
+  // Date and time have three menu options on the same row, which are always
+  // painted.
+  //
+  Cacheable = (BOOLEAN) (Statement->OpCode->OpCode != EFI_IFR_DATE_OP && Statement->OpCode->OpCode != EFI_IFR_TIME_OP);
+  if (Cacheable) {
+    GetMenuPaintInfo (MenuOption, OptionString, SkipWidth, BeginCol, SkipLine, BottomRow, Highlight, &PaintInfo);
+    if (IsMenuPainted (MenuOption, &PaintInfo)) {
+      if (OptionString != NULL) {
+        FreePool (OptionString);
+      }
+      return EFI_SUCCESS;
+    }
+  }
+
   if (OptionString != NULL) {
     if (Statement->OpCode->OpCode == EFI_IFR_DATE_OP || Statement->OpCode->OpCode == EFI_IFR_TIME_OP) {
       //
@@ -2589,6 +2780,8 @@ DisplayOneMenu (
     }
   }
 
+  RecordMenuPaint (MenuOption, Cacheable ? &PaintInfo : NULL);
+
   return EFI_SUCCESS;
 }
 
@@ -2837,6 +3030,7 @@ UiDisplayMenu (
         //
         // 3. Menus in this form may not cover all form, clean the remain field.
         //
+        InvalidateMenuPaintCache (Row, BottomRow + 1 - Row);
         while (Row <= BottomRow) {
           if ((FormData->Attribute & HII_DISPLAY_MODAL) != 0) {
             PrintStringAtWithWidth(gStatementDimensions.LeftColumn + gModalSkipColumn, Row++, L"", gStatementDimensions.RightColumn - gStatementDimensions.LeftColumn - 2 * gModalSkipColumn);
@@ -2865,6 +3059,11 @@ UiDisplayMenu (
 
         MenuOption = NULL;
       }
+
+      //
+      // Only the first paint after entering the form may skip unchanged menus.
+      //
+      mMenuPaintCacheUsable = FALSE;
       break;
 
     case CfRefreshHighLight:
@@ -3145,6 +3344,7 @@ UiDisplayMenu (
     case CfPrepareToReadKey:
       ControlFlag = CfReadKey;
       ScreenOperation = UiNoOperation;
+      gMenuPaintCacheValid = TRUE;
       break;
 
     case CfReadKey:
@@ -3174,6 +3374,14 @@ UiDisplayMenu (
         break;
       }
 
+      //
+      // Only a refresh event leaves the form as painted, a key may show a
+      // popup or change the form.
+      //
+      if (EventType != UIEventDriver) {
+        gMenuPaintCacheValid = FALSE;
+      }
+
       if (EventType == UIEventDriver) {
         gMisMatch = TRUE;
         gUserInput->Action = BROWSER_ACTION_NONE;
@@ -4054,6 +4262,7 @@ FormDisplay (
     //
     // gFormData->BrowserStatus != BROWSER_SUCCESS, means only need to print the error info, return here.
     //
+    gMenuPaintCacheValid = FALSE;
     return EFI_SUCCESS;
   }
 
@@ -4089,6 +4298,27 @@ FormDisplay (
     mStatementLayoutIsChanged = FALSE;
   }
 
+  //
+  // When the same form is displayed again, e.g. after a refresh event, and
+  // nothing covered it meanwhile, only the menus which changed are painted.
+  //
+  if (mMenuPaintCacheCount <= gStatementDimensions.BottomRow) {
+    if (mMenuPaintCache != NULL) {
+      FreePool (mMenuPaintCache);
+    }
+    mMenuPaintCacheCount = 0;
+    gMenuPaintCacheValid = FALSE;
+    mMenuPaintCache = AllocateZeroPool ((gStatementDimensions.BottomRow + 1) * sizeof (UI_MENU_PAINT_CACHE));
+    if (mMenuPaintCache != NULL) {
+      mMenuPaintCacheCount = gStatementDimensions.BottomRow + 1;
+    }
+  }
+
+  mMenuPaintCacheUsable = (BOOLEAN) (gMenuPaintCacheValid &&
+                                     !mStatementLayoutIsChanged &&
+                                     ((FormData->Attribute & HII_DISPLAY_MODAL) == 0));
+  gMenuPaintCacheValid  = FALSE;
+
   Status = UiDisplayMenu(FormData);
 
   //
@@ -4255,5 +4485,9 @@ UnloadDisplayEngine (
     FreePool (gHighligthMenuInfo.TOSOpCode);
   }
 
+  if (mMenuPaintCache != NULL) {
+    FreePool (mMenuPaintCache);
+  }
+
   return EFI_SUCCESS;
 }
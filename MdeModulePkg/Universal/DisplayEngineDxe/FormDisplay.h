@@ -71,6 +71,7 @@ extern CHAR16            gOptionBlockWidth;
 extern CHAR16            gHelpBlockWidth;
 extern CHAR16            *mUnknownString;
 extern BOOLEAN           gMisMatch;
+extern BOOLEAN           gMenuPaintCacheValid;
 
 //
 // Screen definitions
@@ -279,6 +280,36 @@ typedef struct {
 
 #define MENU_OPTION_FROM_LINK(a)  CR (a, UI_MENU_OPTION, Link, UI_MENU_OPTION_SIGNATURE)
 
+//
+// What DisplayOneMenu() paints for a menu option. When a form is displayed
+// again after a refresh event, a menu whose paint info is unchanged is not
+// painted again.
+//
+typedef struct {
+  UINTN                   Row;
+  UINTN                   Col;
+  UINTN                   OptCol;
+  UINTN                   Skip;
+  UINTN                   SkipWidth;
+  UINTN                   BeginCol;
+  UINTN                   SkipLine;
+  UINTN                   BottomRow;
+  UINTN                   PromptBlockWidth;
+  UINTN                   OptionBlockWidth;
+  UINT8                   OpCode;
+  BOOLEAN                 Highlight;
+  BOOLEAN                 GrayOut;
+  UINT32                  DescriptionCrc;
+  UINT32                  OptionCrc;
+  UINT32                  TextTwoCrc;
+} UI_MENU_PAINT_INFO;
+
+typedef struct {
+  BOOLEAN                 Valid;
+  UI_MENU_PAINT_INFO      PaintInfo;
+  UINTN                   Skip;           // Number of lines after painting
+} UI_MENU_PAINT_CACHE;
+
 #define USER_SELECTABLE_OPTION_OK_WIDTH           StrLen (gOkOption)
 #define USER_SELECTABLE_OPTION_OK_CAL_WIDTH       (StrLen (gOkOption) + StrLen (gCancelOption))
 #define USER_SELECTABLE_OPTION_YES_NO_WIDTH       (StrLen (gYesOption) + StrLen (gNoOption))
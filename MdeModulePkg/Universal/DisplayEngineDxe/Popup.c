@@ -692,6 +692,11 @@ CreatePopup (
   ConOut->EnableCursor (ConOut, FALSE);
   ConOut->SetAttribute (ConOut, GetPopupColor ());
 
+  //
+  // The popup covers part of the form, so the form must be fully repainted.
+  //
+  gMenuPaintCacheValid = FALSE;
+
   CalculatePopupPosition (PopupType, &gPopupDimensions);
 
   Status = DrawMessageBox (PopupStyle);
@@ -1339,6 +1339,641 @@ CONST VM_TABLE_ENTRY           mVmOpcodeTable[] = {
 //
 CONST UINT8                    mJMPLen[] = { 2, 2, 6, 10 };
 
+//
+// The decode cache keeps one EBC_DECODED_INSTRUCTION per 2-byte slot of each
+// code page that has been executed, so the opcode table lookup and operand
+// decoding done by the Execute* functions is paid once per instruction
+// address rather than once per executed instruction. The common register-only
+// instruction forms get dedicated handlers that run entirely from the
+// pre-extracted fields; every other instruction goes through the generic
+// handler, which calls the regular Execute* function.
+//
+// The EBC debugger patches code and relies on the per-instruction hooks, so
+// it builds this module with EBC_DISABLE_DECODE_CACHE.
+//
+#ifdef EBC_DISABLE_DECODE_CACHE
+#define EBC_DECODE_CACHE_ENABLED  FALSE
+#else
+#define EBC_DECODE_CACHE_ENABLED  TRUE
+#endif
+
+#define EBC_DECODE_PAGE_SIZE      SIZE_4KB
+#define EBC_DECODE_PAGE_MASK      (EBC_DECODE_PAGE_SIZE - 1)
+#define EBC_DECODE_BUCKETS        64
+#define EBC_DECODE_MAX_PAGES      64
+
+//
+// Flags of a decoded instruction.
+//
+#define EBC_DECODED_SIGNED        0x01
+
+typedef struct _EBC_DECODED_INSTRUCTION EBC_DECODED_INSTRUCTION;
+
+typedef
+EFI_STATUS
+(*EBC_DECODED_HANDLER) (
+  IN VM_CONTEXT                     *VmPtr,
+  IN CONST EBC_DECODED_INSTRUCTION  *Instruction
+  );
+
+struct _EBC_DECODED_INSTRUCTION {
+  EBC_DECODED_HANDLER  Handler;     // NULL until the slot has been decoded
+  UINT8                Opcode;      // full opcode byte
+  UINT8                Operand1;    // R1 register number
+  UINT8                Operand2;    // R2 register number
+  UINT8                Length;      // instruction size in bytes
+  UINT8                Flags;
+  INT64                Immediate;   // pre-extracted immediate data or index
+};
+
+typedef struct _EBC_DECODE_PAGE EBC_DECODE_PAGE;
+struct _EBC_DECODE_PAGE {
+  EBC_DECODE_PAGE          *Next;
+  UINTN                    Base;
+  EBC_DECODED_INSTRUCTION  Instructions[EBC_DECODE_PAGE_SIZE / 2];
+};
+
+//
+// Hash buckets of decoded pages. Pages are only ever added to a bucket with
+// an atomic exchange, so a VM that is nested on top of another one (an EBC
+// event notification, for example) can safely fill the cache as well.
+//
+EBC_DECODE_PAGE        *mEbcDecodeBuckets[EBC_DECODE_BUCKETS];
+UINTN                  mEbcDecodePageCount   = 0;
+UINTN                  mEbcDecodeGeneration  = 0;
+//
+// Pages dropped by EbcFlushDecodeCache() while a VM was running. They are
+// freed when the outermost EbcExecute() returns.
+//
+EBC_DECODE_PAGE        *mEbcDecodeRetired    = NULL;
+UINTN                  mEbcExecuteDepth      = 0;
+
+/**
+  Execute a decoded instruction through the regular opcode dispatch table.
+
+  @param  VmPtr             A pointer to a VM context.
+  @param  Instruction       The decoded instruction at VmPtr->Ip.
+
+  @return The status returned by the execute function.
+
+**/
+EFI_STATUS
+EbcExecuteDecodedGeneric (
+  IN VM_CONTEXT                     *VmPtr,
+  IN CONST EBC_DECODED_INSTRUCTION  *Instruction
+  )
+{
+  EFI_STATUS  Status;
+
+  EbcDebuggerHookExecuteStart (VmPtr);
+
+  //
+  // The EBC VM is a strongly ordered processor, so perform a fence operation before
+  // and after each instruction is executed.
+  //
+  MemoryFence ();
+
+  Status = mVmOpcodeTable[Instruction->Opcode & OPCODE_M_OPCODE].ExecuteFunction (VmPtr);
+
+  MemoryFence ();
+
+  EbcDebuggerHookExecuteEnd (VmPtr);
+
+  return Status;
+}
+
+/**
+  Execute a decoded data manipulation instruction of the form
+  OP[32|64] R1, R2 {Immed16}.
+
+  @param  VmPtr             A pointer to a VM context.
+  @param  Instruction       The decoded instruction at VmPtr->Ip.
+
+  @retval EFI_SUCCESS       The instruction is executed successfully.
+
+**/
+EFI_STATUS
+EbcExecuteDecodedDataManip (
+  IN VM_CONTEXT                     *VmPtr,
+  IN CONST EBC_DECODED_INSTRUCTION  *Instruction
+  )
+{
+  UINT64  Op1;
+  UINT64  Op2;
+
+  Op1 = (UINT64) VmPtr->Gpr[Instruction->Operand1];
+  Op2 = (UINT64) VmPtr->Gpr[Instruction->Operand2] + Instruction->Immediate;
+  if ((Instruction->Opcode & DATAMANIP_M_64) == 0) {
+    if ((Instruction->Flags & EBC_DECODED_SIGNED) != 0) {
+      Op1 = (UINT64) (INT64) ((INT32) Op1);
+      Op2 = (UINT64) (INT64) ((INT32) Op2);
+    } else {
+      Op1 = (UINT64) ((UINT32) Op1);
+      Op2 = (UINT64) ((UINT32) Op2);
+    }
+  }
+
+  Op2 = mDataManipDispatchTable[(Instruction->Opcode & OPCODE_M_OPCODE) - OPCODE_NOT](VmPtr, Op1, Op2);
+
+  //
+  // Write back, clearing upper bits (as per the specification) if 32-bit
+  // operation.
+  //
+  if ((Instruction->Opcode & DATAMANIP_M_64) == 0) {
+    Op2 &= 0xFFFFFFFF;
+  }
+
+  VmPtr->Gpr[Instruction->Operand1] = Op2;
+  VmPtr->Ip += Instruction->Length;
+  return EFI_SUCCESS;
+}
+
+/**
+  Execute a decoded compare instruction of the form
+  CMP[32|64][eq|lte|gte|ulte|ugte] R1, R2 {Immed16}.
+
+  @param  VmPtr             A pointer to a VM context.
+  @param  Instruction       The decoded instruction at VmPtr->Ip.
+
+  @retval EFI_SUCCESS       The instruction is executed successfully.
+
+**/
+EFI_STATUS
+EbcExecuteDecodedCMP (
+  IN VM_CONTEXT                     *VmPtr,
+  IN CONST EBC_DECODED_INSTRUCTION  *Instruction
+  )
+{
+  INT64   Op1;
+  INT64   Op2;
+  BOOLEAN Flag;
+
+  Op1 = VmPtr->Gpr[Instruction->Operand1];
+  Op2 = VmPtr->Gpr[Instruction->Operand2] + Instruction->Immediate;
+  if ((Instruction->Opcode & OPCODE_M_64BIT) == 0) {
+    //
+    // 32-bit compares. Sign-extend for the signed compares and zero-extend
+    // for the unsigned ones so that the 64-bit compares below give the same
+    // result.
+    //
+    if ((Instruction->Opcode & OPCODE_M_OPCODE) >= OPCODE_CMPULTE) {
+      Op1 = (INT64) (UINT64) ((UINT32) Op1);
+      Op2 = (INT64) (UINT64) ((UINT32) Op2);
+    } else {
+      Op1 = (INT64) ((INT32) Op1);
+      Op2 = (INT64) ((INT32) Op2);
+    }
+  }
+
+  switch (Instruction->Opcode & OPCODE_M_OPCODE) {
+  case OPCODE_CMPEQ:
+    Flag = (BOOLEAN) (Op1 == Op2);
+    break;
+
+  case OPCODE_CMPLTE:
+    Flag = (BOOLEAN) (Op1 <= Op2);
+    break;
+
+  case OPCODE_CMPGTE:
+    Flag = (BOOLEAN) (Op1 >= Op2);
+    break;
+
+  case OPCODE_CMPULTE:
+    Flag = (BOOLEAN) ((UINT64) Op1 <= (UINT64) Op2);
+    break;
+
+  default:
+    Flag = (BOOLEAN) ((UINT64) Op1 >= (UINT64) Op2);
+    break;
+  }
+
+  if (Flag) {
+    VMFLAG_SET (VmPtr, VMFLAGS_CC);
+  } else {
+    VMFLAG_CLEAR (VmPtr, (UINT64)VMFLAGS_CC);
+  }
+
+  VmPtr->Ip += Instruction->Length;
+  return EFI_SUCCESS;
+}
+
+/**
+  Execute a decoded JMP8 instruction. The immediate data holds the distance
+  to the target, relative to the start of the instruction.
+
+  @param  VmPtr             A pointer to a VM context.
+  @param  Instruction       The decoded instruction at VmPtr->Ip.
+
+  @retval EFI_SUCCESS       The instruction is executed successfully.
+
+**/
+EFI_STATUS
+EbcExecuteDecodedJMP8 (
+  IN VM_CONTEXT                     *VmPtr,
+  IN CONST EBC_DECODED_INSTRUCTION  *Instruction
+  )
+{
+  if ((Instruction->Opcode & CONDITION_M_CONDITIONAL) != 0) {
+    if (((Instruction->Opcode & JMP_M_CS) != 0) != (VMFLAG_ISSET (VmPtr, VMFLAGS_CC) != 0)) {
+      VmPtr->Ip += Instruction->Length;
+      return EFI_SUCCESS;
+    }
+  }
+
+  VmPtr->Ip += Instruction->Immediate;
+  return EFI_SUCCESS;
+}
+
+/**
+  Execute a decoded MOVI[b|w|d|q][w|d|q] R1, ImmData16|32|64. The immediate
+  data was already masked to the move size when it was decoded.
+
+  @param  VmPtr             A pointer to a VM context.
+  @param  Instruction       The decoded instruction at VmPtr->Ip.
+
+  @retval EFI_SUCCESS       The instruction is executed successfully.
+
+**/
+EFI_STATUS
+EbcExecuteDecodedMOVI (
+  IN VM_CONTEXT                     *VmPtr,
+  IN CONST EBC_DECODED_INSTRUCTION  *Instruction
+  )
+{
+  VmPtr->Gpr[Instruction->Operand1] = Instruction->Immediate;
+  VmPtr->Ip += Instruction->Length;
+  return EFI_SUCCESS;
+}
+
+/**
+  Execute a decoded MOV[b|w|d|q|n]{w|d} R1, R2 {Index} or MOVqq R1, R2 {Index}.
+  The Flags field holds the move size in bytes.
+
+  @param  VmPtr             A pointer to a VM context.
+  @param  Instruction       The decoded instruction at VmPtr->Ip.
+
+  @retval EFI_SUCCESS       The instruction is executed successfully.
+
+**/
+EFI_STATUS
+EbcExecuteDecodedMOVxx (
+  IN VM_CONTEXT                     *VmPtr,
+  IN CONST EBC_DECODED_INSTRUCTION  *Instruction
+  )
+{
+  UINT64  Data64;
+
+  Data64 = (UINT64) (VmPtr->Gpr[Instruction->Operand2] + Instruction->Immediate);
+  if (Instruction->Flags < sizeof (UINT64)) {
+    Data64 &= LShiftU64 (1, Instruction->Flags * 8) - 1;
+  }
+
+  VmPtr->Gpr[Instruction->Operand1] = Data64;
+  VmPtr->Ip += Instruction->Length;
+  return EFI_SUCCESS;
+}
+
+/**
+  Decode the instruction at VmPtr->Ip into a decode cache slot.
+
+  Register-only forms of the data manipulation, compare, JMP8, MOVI and MOV
+  instructions are given a dedicated handler. Every other valid opcode is
+  routed to the generic handler, so the slot never changes the semantics of
+  the instruction.
+
+  @param  VmPtr             A pointer to a VM context.
+  @param  Instruction       The cache slot to fill.
+
+  @retval TRUE              The slot was filled.
+  @retval FALSE             The opcode is invalid; the caller must take the
+                            regular path, which raises the exception.
+
+**/
+BOOLEAN
+EbcDecodeInstruction (
+  IN  VM_CONTEXT               *VmPtr,
+  OUT EBC_DECODED_INSTRUCTION  *Instruction
+  )
+{
+  EBC_DECODED_HANDLER  Handler;
+  UINT8                Opcode;
+  UINT8                OpcMasked;
+  UINT8                Operands;
+  UINT8                Length;
+  UINT8                Flags;
+  INT64                Immediate;
+
+  Opcode    = GETOPCODE (VmPtr);
+  OpcMasked = (UINT8) (Opcode & OPCODE_M_OPCODE);
+  Operands  = GETOPERANDS (VmPtr);
+
+  if (mVmOpcodeTable[OpcMasked].ExecuteFunction == NULL) {
+    return FALSE;
+  }
+
+  Handler   = EbcExecuteDecodedGeneric;
+  Length    = 0;
+  Flags     = 0;
+  Immediate = 0;
+
+  if ((OpcMasked >= OPCODE_NOT) && (OpcMasked <= OPCODE_EXTNDD)) {
+    if (!OPERAND1_INDIRECT (Operands) && !OPERAND2_INDIRECT (Operands)) {
+      Length = 2;
+      if ((Opcode & DATAMANIP_M_IMMDATA) != 0) {
+        Immediate = VmReadImmed16 (VmPtr, 2);
+        Length    = 4;
+      }
+
+      if (mVmOpcodeTable[OpcMasked].ExecuteFunction == ExecuteSignedDataManip) {
+        Flags = EBC_DECODED_SIGNED;
+      }
+
+      Handler = EbcExecuteDecodedDataManip;
+    }
+  } else if ((OpcMasked >= OPCODE_CMPEQ) && (OpcMasked <= OPCODE_CMPUGTE)) {
+    if (!OPERAND2_INDIRECT (Operands)) {
+      Length = 2;
+      if ((Opcode & OPCODE_M_IMMDATA) != 0) {
+        Immediate = VmReadImmed16 (VmPtr, 2);
+        Length    = 4;
+      }
+
+      Handler = EbcExecuteDecodedCMP;
+    }
+  } else if (OpcMasked == OPCODE_JMP8) {
+    Length    = 2;
+    Immediate = VmReadImmed8 (VmPtr, 1) * 2 + 2;
+    Handler   = EbcExecuteDecodedJMP8;
+  } else if (OpcMasked == OPCODE_MOVI) {
+    if (!OPERAND1_INDIRECT (Operands) && ((Operands & MOVI_M_IMMDATA) == 0)) {
+      switch (Opcode & MOVI_M_DATAWIDTH) {
+      case MOVI_DATAWIDTH16:
+        Immediate = VmReadImmed16 (VmPtr, 2);
+        Length    = 4;
+        break;
+
+      case MOVI_DATAWIDTH32:
+        Immediate = VmReadImmed32 (VmPtr, 2);
+        Length    = 6;
+        break;
+
+      case MOVI_DATAWIDTH64:
+        Immediate = VmReadImmed64 (VmPtr, 2);
+        Length    = 10;
+        break;
+
+      default:
+        break;
+      }
+
+      if (Length != 0) {
+        switch (Operands & MOVI_M_MOVEWIDTH) {
+        case MOVI_MOVEWIDTH8:
+          Immediate &= 0x000000FF;
+          break;
+
+        case MOVI_MOVEWIDTH16:
+          Immediate &= 0x0000FFFF;
+          break;
+
+        case MOVI_MOVEWIDTH32:
+          Immediate &= 0x00000000FFFFFFFF;
+          break;
+
+        default:
+          break;
+        }
+
+        Handler = EbcExecuteDecodedMOVI;
+      }
+    }
+  } else if (((OpcMasked >= OPCODE_MOVBW) && (OpcMasked <= OPCODE_MOVQD)) ||
+             (OpcMasked == OPCODE_MOVQQ) ||
+             (OpcMasked == OPCODE_MOVNW) ||
+             (OpcMasked == OPCODE_MOVND)) {
+    if (!OPERAND1_INDIRECT (Operands) && !OPERAND2_INDIRECT (Operands) &&
+        ((Opcode & OPCODE_M_IMMED_OP1) == 0)) {
+      Length = 2;
+      if ((Opcode & OPCODE_M_IMMED_OP2) != 0) {
+        if ((OpcMasked <= OPCODE_MOVQW) || (OpcMasked == OPCODE_MOVNW)) {
+          Immediate = VmReadIndex16 (VmPtr, 2);
+          Length    = 4;
+        } else if (OpcMasked == OPCODE_MOVQQ) {
+          Immediate = VmReadIndex64 (VmPtr, 2);
+          Length    = 10;
+        } else {
+          Immediate = VmReadIndex32 (VmPtr, 2);
+          Length    = 6;
+        }
+      }
+
+      if ((OpcMasked == OPCODE_MOVBW) || (OpcMasked == OPCODE_MOVBD)) {
+        Flags = sizeof (UINT8);
+      } else if ((OpcMasked == OPCODE_MOVWW) || (OpcMasked == OPCODE_MOVWD)) {
+        Flags = sizeof (UINT16);
+      } else if ((OpcMasked == OPCODE_MOVDW) || (OpcMasked == OPCODE_MOVDD)) {
+        Flags = sizeof (UINT32);
+      } else if ((OpcMasked == OPCODE_MOVNW) || (OpcMasked == OPCODE_MOVND)) {
+        Flags = sizeof (UINTN);
+      } else {
+        Flags = sizeof (UINT64);
+      }
+
+      Handler = EbcExecuteDecodedMOVxx;
+    }
+  }
+
+  Instruction->Opcode    = Opcode;
+  Instruction->Operand1  = (UINT8) OPERAND1_REGNUM (Operands);
+  Instruction->Operand2  = (UINT8) OPERAND2_REGNUM (Operands);
+  Instruction->Length    = Length;
+  Instruction->Flags     = Flags;
+  Instruction->Immediate = Immediate;
+
+  //
+  // Publish the handler last. A nested VM decoding the same slot writes the
+  // same values, so a slot is never seen half filled in a harmful way.
+  //
+  MemoryFence ();
+  Instruction->Handler   = Handler;
+  return TRUE;
+}
+
+/**
+  Free the decode pages that were dropped while a VM was running, if the
+  current TPL allows it.
+
+**/
+VOID
+EbcFreeRetiredDecodePages (
+  VOID
+  )
+{
+  EFI_TPL          OldTpl;
+  EBC_DECODE_PAGE  *Page;
+  EBC_DECODE_PAGE  *NextPage;
+
+  OldTpl = gBS->RaiseTPL (TPL_HIGH_LEVEL);
+  if (OldTpl > TPL_NOTIFY) {
+    gBS->RestoreTPL (OldTpl);
+    return;
+  }
+
+  Page              = mEbcDecodeRetired;
+  mEbcDecodeRetired = NULL;
+  gBS->RestoreTPL (OldTpl);
+
+  while (Page != NULL) {
+    NextPage = Page->Next;
+    FreePool (Page);
+    Page = NextPage;
+  }
+}
+
+/**
+  Drop every decoded instruction. This must be called whenever EBC code the
+  VM may have executed is modified or unloaded.
+
+**/
+VOID
+EbcFlushDecodeCache (
+  VOID
+  )
+{
+  EFI_TPL          OldTpl;
+  UINTN            Index;
+  EBC_DECODE_PAGE  *Page;
+
+  OldTpl = gBS->RaiseTPL (TPL_HIGH_LEVEL);
+  for (Index = 0; Index < EBC_DECODE_BUCKETS; Index++) {
+    while (mEbcDecodeBuckets[Index] != NULL) {
+      Page                      = mEbcDecodeBuckets[Index];
+      mEbcDecodeBuckets[Index]  = Page->Next;
+      Page->Next                = mEbcDecodeRetired;
+      mEbcDecodeRetired         = Page;
+    }
+  }
+
+  mEbcDecodePageCount = 0;
+  mEbcDecodeGeneration++;
+  gBS->RestoreTPL (OldTpl);
+
+  if (mEbcExecuteDepth == 0) {
+    EbcFreeRetiredDecodePages ();
+  }
+}
+
+/**
+  Find the decode page for a code page, allocating it if needed.
+
+  @param  Base              Base address of the code page.
+
+  @return The decode page, or NULL if none is available.
+
+**/
+EBC_DECODE_PAGE *
+EbcFindDecodePage (
+  IN UINTN  Base
+  )
+{
+  EFI_TPL          OldTpl;
+  UINTN            Bucket;
+  EBC_DECODE_PAGE  *Head;
+  EBC_DECODE_PAGE  *Page;
+  EBC_DECODE_PAGE  *NewPage;
+
+  Bucket  = (Base / EBC_DECODE_PAGE_SIZE) % EBC_DECODE_BUCKETS;
+  NewPage = NULL;
+  do {
+    Head = mEbcDecodeBuckets[Bucket];
+    for (Page = Head; Page != NULL; Page = Page->Next) {
+      if (Page->Base == Base) {
+        if (NewPage != NULL) {
+          FreePool (NewPage);
+        }
+
+        return Page;
+      }
+    }
+
+    if (NewPage == NULL) {
+      //
+      // Pool can only be allocated at TPL_NOTIFY and below.
+      //
+      OldTpl = gBS->RaiseTPL (TPL_HIGH_LEVEL);
+      gBS->RestoreTPL (OldTpl);
+      if ((OldTpl > TPL_NOTIFY) || (mEbcDecodePageCount >= EBC_DECODE_MAX_PAGES)) {
+        return NULL;
+      }
+
+      NewPage = AllocateZeroPool (sizeof (EBC_DECODE_PAGE));
+      if (NewPage == NULL) {
+        return NULL;
+      }
+
+      NewPage->Base = Base;
+    }
+
+    NewPage->Next = Head;
+  } while (InterlockedCompareExchangePointer (
+             (VOID **) &mEbcDecodeBuckets[Bucket],
+             Head,
+             NewPage
+             ) != Head);
+
+  mEbcDecodePageCount++;
+  return NewPage;
+}
+
+/**
+  Return the decoded form of the instruction at VmPtr->Ip, decoding it on
+  first use.
+
+  @param  VmPtr             A pointer to a VM context.
+  @param  Page              The decode page used by the previous instruction,
+                            updated on return.
+  @param  Generation        The cache generation Page belongs to, updated on
+                            return.
+
+  @return The decoded instruction, or NULL if the instruction must be executed
+          through the regular path.
+
+**/
+CONST EBC_DECODED_INSTRUCTION *
+EbcGetDecodedInstruction (
+  IN     VM_CONTEXT       *VmPtr,
+  IN OUT EBC_DECODE_PAGE  **Page,
+  IN OUT UINTN            *Generation
+  )
+{
+  UINTN                    Ip;
+  EBC_DECODED_INSTRUCTION  *Instruction;
+
+  Ip = (UINTN) VmPtr->Ip;
+  if ((Ip & 1) != 0) {
+    return NULL;
+  }
+
+  if ((*Page == NULL) ||
+      (*Generation != mEbcDecodeGeneration) ||
+      ((*Page)->Base != (Ip & ~(UINTN) EBC_DECODE_PAGE_MASK))) {
+    *Generation = mEbcDecodeGeneration;
+    *Page       = EbcFindDecodePage (Ip & ~(UINTN) EBC_DECODE_PAGE_MASK);
+    if (*Page == NULL) {
+      return NULL;
+    }
+  }
+
+  Instruction = &(*Page)->Instructions[(Ip & EBC_DECODE_PAGE_MASK) / 2];
+  if (Instruction->Handler == NULL) {
+    if (!EbcDecodeInstruction (VmPtr, Instruction)) {
+      return NULL;
+    }
+  }
+
+  return Instruction;
+}
+
 /**
   Given a pointer to a new VM context, execute one or more instructions. This
   function is only used for test purposes via the EBC VM test protocol.
@@ -1422,11 +2057,18 @@ EbcExecute (
   UINT8                             StackCorrupted;
   EFI_STATUS                        Status;
   EFI_EBC_SIMPLE_DEBUGGER_PROTOCOL  *EbcSimpleDebugger;
+  BOOLEAN                           UseDecodeCache;
+  CONST EBC_DECODED_INSTRUCTION     *Instruction;
+  EBC_DECODE_PAGE                   *DecodePage;
+  UINTN                             DecodeGeneration;
 
   mVmPtr            = VmPtr;
   EbcSimpleDebugger = NULL;
   Status            = EFI_SUCCESS;
   StackCorrupted    = 0;
+  DecodePage        = NULL;
+  DecodeGeneration  = 0;
+  mEbcExecuteDepth++;
 
   //
   // Make sure the magic value has been put on the stack before we got here.
@@ -1451,6 +2093,12 @@ EbcExecute (
     }
   DEBUG_CODE_END ();
 
+  //
+  // The simple debugger is called before every instruction and may change
+  // anything, so only use the decode cache without it.
+  //
+  UseDecodeCache = (BOOLEAN) (EBC_DECODE_CACHE_ENABLED && (EbcSimpleDebugger == NULL));
+
   //
   // Save the start IP for debug. For example, if we take an exception we
   // can print out the location of the exception relative to the entry point,
@@ -1474,29 +2122,42 @@ EbcExecute (
     DEBUG_CODE_END ();
 
     //
-    // Use the opcode bits to index into the opcode dispatch table. If the
-    // function pointer is null then generate an exception.
+    // Run the instruction from the decode cache when possible. Its handler
+    // was picked when the instruction was first decoded.
     //
-    ExecFunc = (UINTN) mVmOpcodeTable[(*VmPtr->Ip & OPCODE_M_OPCODE)].ExecuteFunction;
-    if (ExecFunc == (UINTN) NULL) {
-      EbcDebugSignalException (EXCEPT_EBC_INVALID_OPCODE, EXCEPTION_FLAG_FATAL, VmPtr);
-      Status = EFI_UNSUPPORTED;
-      goto Done;
+    Instruction = NULL;
+    if (UseDecodeCache) {
+      Instruction = EbcGetDecodedInstruction (VmPtr, &DecodePage, &DecodeGeneration);
     }
 
-    EbcDebuggerHookExecuteStart (VmPtr);
+    if (Instruction != NULL) {
+      Instruction->Handler (VmPtr, Instruction);
+    } else {
+      //
+      // Use the opcode bits to index into the opcode dispatch table. If the
+      // function pointer is null then generate an exception.
+      //
+      ExecFunc = (UINTN) mVmOpcodeTable[(*VmPtr->Ip & OPCODE_M_OPCODE)].ExecuteFunction;
+      if (ExecFunc == (UINTN) NULL) {
+        EbcDebugSignalException (EXCEPT_EBC_INVALID_OPCODE, EXCEPTION_FLAG_FATAL, VmPtr);
+        Status = EFI_UNSUPPORTED;
+        goto Done;
+      }
+
+      EbcDebuggerHookExecuteStart (VmPtr);
 
-    //
-    // The EBC VM is a strongly ordered processor, so perform a fence operation before
-    // and after each instruction is executed.
-    //
-    MemoryFence ();
+      //
+      // The EBC VM is a strongly ordered processor, so perform a fence operation before
+      // and after each instruction is executed.
+      //
+      MemoryFence ();
 
-    mVmOpcodeTable[(*VmPtr->Ip & OPCODE_M_OPCODE)].ExecuteFunction (VmPtr);
+      mVmOpcodeTable[(*VmPtr->Ip & OPCODE_M_OPCODE)].ExecuteFunction (VmPtr);
 
-    MemoryFence ();
+      MemoryFence ();
 
-    EbcDebuggerHookExecuteEnd (VmPtr);
+      EbcDebuggerHookExecuteEnd (VmPtr);
+    }
 
     //
     // If the step flag is set, signal an exception and continue. We don't
@@ -1521,6 +2182,15 @@ EbcExecute (
 Done:
   mVmPtr          = NULL;
 
+  //
+  // Pages dropped from the decode cache while this VM ran can be freed once
+  // no VM uses them any more.
+  //
+  mEbcExecuteDepth--;
+  if ((mEbcExecuteDepth == 0) && (mEbcDecodeRetired != NULL)) {
+    EbcFreeRetiredDecodePages ();
+  }
+
   return Status;
 }
 
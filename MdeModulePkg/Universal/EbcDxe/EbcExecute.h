@@ -110,6 +110,16 @@ VmWriteMem64 (
   IN UINT64       Data
   );
 
+/**
+  Drop every decoded instruction. This must be called whenever EBC code the
+  VM may have executed is modified or unloaded.
+
+**/
+VOID
+EbcFlushDecodeCache (
+  VOID
+  );
+
 /**
   Given a pointer to a new VM context, execute one or more instructions. This
   function is only used for test purposes via the EBC VM test protocol.
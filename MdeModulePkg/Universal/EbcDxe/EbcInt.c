@@ -290,8 +290,10 @@ EbcDebugRegisterExceptionCallback (
   );
 
 /**
-  This EBC debugger protocol service is called by the debug agent.  Required
-  for DebugSupport compliance but is only stubbed out for EBC.
+  This EBC debugger protocol service is called by the debug agent after it
+  modified EBC code, for example to insert a breakpoint. There is no
+  instruction cache to invalidate for EBC, but the interpreter's decoded
+  instructions are dropped.
 
   @param  This                  A pointer to the EFI_DEBUG_SUPPORT_PROTOCOL
                                 instance.
@@ -827,6 +829,7 @@ EbcDebugInvalidateInstructionCache (
   IN UINT64                              Length
   )
 {
+  EbcFlushDecodeCache ();
   return EFI_SUCCESS;
 }
 
@@ -1205,6 +1208,11 @@ EbcUnloadImage (
   //
   FreePool (ImageList);
 
+  //
+  // The image's code may be replaced by another image at the same address.
+  //
+  EbcFlushDecodeCache ();
+
   EbcDebuggerHookEbcUnloadImage (ImageHandle);
 
   return EFI_SUCCESS;
@@ -323,7 +323,6 @@ FtwWrite (
   UINTN                               MyOffset;
   UINTN                               MyBufferSize;
   UINT8                               *MyBuffer;
-  UINTN                               SpareBufferSize;
   UINT8                               *SpareBuffer;
   UINTN                               Index;
   UINT8                               *Ptr;
@@ -490,39 +489,27 @@ FtwWrite (
   // Try to keep the content of spare block
   // Save spare block into a spare backup memory buffer (Sparebuffer)
   //
-  SpareBufferSize = FtwDevice->SpareAreaLength;
-  SpareBuffer     = AllocatePool (SpareBufferSize);
-  if (SpareBuffer == NULL) {
+  Status = FtwBackupSpareBlock (FtwDevice, &SpareBuffer);
+  if (EFI_ERROR (Status)) {
     FreePool (MyBuffer);
-    return EFI_OUT_OF_RESOURCES;
-  }
-
-  Ptr = SpareBuffer;
-  for (Index = 0; Index < FtwDevice->NumberOfSpareBlock; Index += 1) {
-    MyLength = FtwDevice->SpareBlockSize;
-    Status = FtwDevice->FtwBackupFvb->Read (
-                                        FtwDevice->FtwBackupFvb,
-                                        FtwDevice->FtwSpareLba + Index,
-                                        0,
-                                        &MyLength,
-                                        Ptr
-                                        );
-    if (EFI_ERROR (Status)) {
-      FreePool (MyBuffer);
-      FreePool (SpareBuffer);
-      return EFI_ABORTED;
-    }
-
-    Ptr += MyLength;
+    return Status;
   }
   //
   // Write the memory buffer to spare block
   // Do not assume Spare Block and Target Block have same block size
+  // A pre-erased spare area only needs the blocks left dirty by a failed
+  // write to be erased, which is usually none of them.
   //
-  Status  = FtwEraseSpareBlock (FtwDevice);
+  if (SpareBuffer == NULL) {
+    Status = FtwEraseDirtySpareBlock (FtwDevice);
+  } else {
+    Status = FtwEraseSpareBlock (FtwDevice);
+  }
   if (EFI_ERROR (Status)) {
     FreePool (MyBuffer);
-    FreePool (SpareBuffer);
+    if (SpareBuffer != NULL) {
+      FreePool (SpareBuffer);
+    }
     return EFI_ABORTED;
   }
   Ptr     = MyBuffer;
@@ -532,6 +519,7 @@ FtwWrite (
     } else {
       MyLength = MyBufferSize;
     }
+    FtwDevice->NumberOfDirtySpareBlock = Index + 1;
     Status = FtwDevice->FtwBackupFvb->Write (
                                         FtwDevice->FtwBackupFvb,
                                         FtwDevice->FtwSpareLba + Index,
@@ -541,10 +529,13 @@ FtwWrite (
                                         );
     if (EFI_ERROR (Status)) {
       FreePool (MyBuffer);
-      FreePool (SpareBuffer);
+      if (SpareBuffer != NULL) {
+        FreePool (SpareBuffer);
+      }
       return EFI_ABORTED;
     }
 
+    FtwDevice->FlashProgramBytes += MyLength;
     Ptr += MyLength;
     MyBufferSize -= MyLength;
   }
@@ -565,7 +556,9 @@ FtwWrite (
             SPARE_COMPLETED
             );
   if (EFI_ERROR (Status)) {
-    FreePool (SpareBuffer);
+    if (SpareBuffer != NULL) {
+      FreePool (SpareBuffer);
+    }
     return EFI_ABORTED;
   }
 
@@ -577,38 +570,23 @@ FtwWrite (
   //
   Status = FtwWriteRecord (This, Fvb, BlockSize);
   if (EFI_ERROR (Status)) {
-    FreePool (SpareBuffer);
+    if (SpareBuffer != NULL) {
+      FreePool (SpareBuffer);
+    }
     return EFI_ABORTED;
   }
   //
   // Restore spare backup buffer into spare block , if no failure happened during FtwWrite.
+  // Otherwise erase the staged blocks so that the spare area is pre-erased for the next write.
   //
-  Status  = FtwEraseSpareBlock (FtwDevice);
+  Status = FtwRestoreSpareBlock (FtwDevice, SpareBuffer);
   if (EFI_ERROR (Status)) {
-    FreePool (SpareBuffer);
-    return EFI_ABORTED;
-  }
-  Ptr     = SpareBuffer;
-  for (Index = 0; Index < FtwDevice->NumberOfSpareBlock; Index += 1) {
-    MyLength = FtwDevice->SpareBlockSize;
-    Status = FtwDevice->FtwBackupFvb->Write (
-                                        FtwDevice->FtwBackupFvb,
-                                        FtwDevice->FtwSpareLba + Index,
-                                        0,
-                                        &MyLength,
-                                        Ptr
-                                        );
-    if (EFI_ERROR (Status)) {
-      FreePool (SpareBuffer);
-      return EFI_ABORTED;
-    }
-
-    Ptr += MyLength;
+    return Status;
   }
   //
   // All success.
   //
-  FreePool (SpareBuffer);
+  FtwDevice->WriteRequestBytes += Length;
 
   DEBUG (
     (EFI_D_INFO,
@@ -617,6 +595,13 @@ FtwWrite (
     Offset,
     Length)
     );
+  DEBUG (
+    (EFI_D_INFO,
+    "Ftw: Write amplification - requested 0x%lx bytes, programmed 0x%lx bytes, erased 0x%lx blocks\n",
+    FtwDevice->WriteRequestBytes,
+    FtwDevice->FlashProgramBytes,
+    FtwDevice->FlashEraseBlocks)
+    );
 
   return EFI_SUCCESS;
 }
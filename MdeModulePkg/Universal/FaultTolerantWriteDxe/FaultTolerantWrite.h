@@ -76,6 +76,10 @@ typedef struct {
   EFI_LBA                                 FtwWorkSpaceLbaInSpare; // Start LBA of working space in spare block.
   UINTN                                   FtwWorkSpaceBaseInSpare;// Offset into the FtwWorkSpaceLbaInSpare block.
   UINT8                                   *FtwWorkSpace;      // Point to Work Space in memory buffer
+  UINTN                                   NumberOfDirtySpareBlock; // Number of leading spare blocks that may not be erased.
+  UINT64                                  WriteRequestBytes;  // Bytes requested through FtwWrite.
+  UINT64                                  FlashProgramBytes;  // Bytes programmed into spare and target blocks by FtwWrite.
+  UINT64                                  FlashEraseBlocks;   // Number of spare, target and working blocks erased.
   //
   // Following a buffer of FtwWorkSpace[FTW_WORK_SPACE_SIZE],
   // Allocated with EFI_FTW_DEVICE.
@@ -292,6 +296,62 @@ FtwEraseSpareBlock (
   IN EFI_FTW_DEVICE   *FtwDevice
   );
 
+/**
+  Erase the leading spare blocks that may hold data, so that the whole spare
+  area is erased again.
+
+  @param FtwDevice        The private data of FTW driver
+
+  @retval EFI_SUCCESS     The spare area is erased.
+  @retval Others          The erase request failed.
+
+**/
+EFI_STATUS
+FtwEraseDirtySpareBlock (
+  IN EFI_FTW_DEVICE   *FtwDevice
+  );
+
+/**
+  Save the content of spare area into a memory buffer, so that it can be
+  restored after the spare area is used to stage a write.
+
+  When PcdFtwPreErasedSpareArea is TRUE, the spare area is only used as
+  scratch space and there is nothing to save, so *SpareBuffer is set to NULL.
+
+  @param FtwDevice        The private data of FTW driver
+  @param SpareBuffer      Return the buffer holding the spare area content.
+
+  @retval EFI_SUCCESS           The spare area is saved.
+  @retval EFI_OUT_OF_RESOURCES  Allocate memory error.
+  @retval EFI_ABORTED           The spare area could not be read.
+
+**/
+EFI_STATUS
+FtwBackupSpareBlock (
+  IN  EFI_FTW_DEVICE  *FtwDevice,
+  OUT UINT8           **SpareBuffer
+  );
+
+/**
+  Restore the content of spare area saved by FtwBackupSpareBlock() and free
+  the backup buffer.
+
+  When SpareBuffer is NULL, the spare blocks used to stage the write are
+  erased instead, so that the next write finds the spare area pre-erased.
+
+  @param FtwDevice        The private data of FTW driver
+  @param SpareBuffer      The buffer returned by FtwBackupSpareBlock().
+
+  @retval EFI_SUCCESS     The spare area is restored.
+  @retval EFI_ABORTED     The spare area could not be erased or written.
+
+**/
+EFI_STATUS
+FtwRestoreSpareBlock (
+  IN EFI_FTW_DEVICE   *FtwDevice,
+  IN UINT8            *SpareBuffer
+  );
+
 /**
   Retrieve the proper FVB protocol interface by HANDLE.
 
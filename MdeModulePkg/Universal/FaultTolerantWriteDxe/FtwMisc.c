@@ -62,6 +62,7 @@ FtwEraseBlock (
   UINTN                               NumberOfBlocks
   )
 {
+  FtwDevice->FlashEraseBlocks += NumberOfBlocks;
   return FvBlock->EraseBlocks (
                     FvBlock,
                     Lba,
@@ -92,12 +93,173 @@ FtwEraseSpareBlock (
   IN EFI_FTW_DEVICE   *FtwDevice
   )
 {
-  return FtwDevice->FtwBackupFvb->EraseBlocks (
-                                    FtwDevice->FtwBackupFvb,
-                                    FtwDevice->FtwSpareLba,
-                                    FtwDevice->NumberOfSpareBlock,
-                                    EFI_LBA_LIST_TERMINATOR
-                                    );
+  EFI_STATUS  Status;
+
+  FtwDevice->FlashEraseBlocks += FtwDevice->NumberOfSpareBlock;
+  Status = FtwDevice->FtwBackupFvb->EraseBlocks (
+                                      FtwDevice->FtwBackupFvb,
+                                      FtwDevice->FtwSpareLba,
+                                      FtwDevice->NumberOfSpareBlock,
+                                      EFI_LBA_LIST_TERMINATOR
+                                      );
+  if (!EFI_ERROR (Status)) {
+    FtwDevice->NumberOfDirtySpareBlock = 0;
+  }
+
+  return Status;
+}
+
+/**
+  Erase the leading spare blocks that may hold data, so that the whole spare
+  area is erased again.
+
+  @param FtwDevice        The private data of FTW driver
+
+  @retval EFI_SUCCESS     The spare area is erased.
+  @retval Others          The erase request failed.
+
+**/
+EFI_STATUS
+FtwEraseDirtySpareBlock (
+  IN EFI_FTW_DEVICE   *FtwDevice
+  )
+{
+  EFI_STATUS  Status;
+
+  if (FtwDevice->NumberOfDirtySpareBlock == 0) {
+    return EFI_SUCCESS;
+  }
+
+  FtwDevice->FlashEraseBlocks += FtwDevice->NumberOfDirtySpareBlock;
+  Status = FtwDevice->FtwBackupFvb->EraseBlocks (
+                                      FtwDevice->FtwBackupFvb,
+                                      FtwDevice->FtwSpareLba,
+                                      FtwDevice->NumberOfDirtySpareBlock,
+                                      EFI_LBA_LIST_TERMINATOR
+                                      );
+  if (!EFI_ERROR (Status)) {
+    FtwDevice->NumberOfDirtySpareBlock = 0;
+  }
+
+  return Status;
+}
+
+/**
+  Save the content of spare area into a memory buffer, so that it can be
+  restored after the spare area is used to stage a write.
+
+  When PcdFtwPreErasedSpareArea is TRUE, the spare area is only used as
+  scratch space and there is nothing to save, so *SpareBuffer is set to NULL.
+
+  @param FtwDevice        The private data of FTW driver
+  @param SpareBuffer      Return the buffer holding the spare area content.
+
+  @retval EFI_SUCCESS           The spare area is saved.
+  @retval EFI_OUT_OF_RESOURCES  Allocate memory error.
+  @retval EFI_ABORTED           The spare area could not be read.
+
+**/
+EFI_STATUS
+FtwBackupSpareBlock (
+  IN  EFI_FTW_DEVICE  *FtwDevice,
+  OUT UINT8           **SpareBuffer
+  )
+{
+  EFI_STATUS  Status;
+  UINTN       Length;
+  UINT8       *Ptr;
+  UINTN       Index;
+
+  *SpareBuffer = NULL;
+  if (FeaturePcdGet (PcdFtwPreErasedSpareArea)) {
+    return EFI_SUCCESS;
+  }
+
+  Ptr = AllocatePool (FtwDevice->SpareAreaLength);
+  if (Ptr == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  *SpareBuffer = Ptr;
+  for (Index = 0; Index < FtwDevice->NumberOfSpareBlock; Index += 1) {
+    Length = FtwDevice->SpareBlockSize;
+    Status = FtwDevice->FtwBackupFvb->Read (
+                                        FtwDevice->FtwBackupFvb,
+                                        FtwDevice->FtwSpareLba + Index,
+                                        0,
+                                        &Length,
+                                        Ptr
+                                        );
+    if (EFI_ERROR (Status)) {
+      FreePool (*SpareBuffer);
+      *SpareBuffer = NULL;
+      return EFI_ABORTED;
+    }
+
+    Ptr += Length;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Restore the content of spare area saved by FtwBackupSpareBlock() and free
+  the backup buffer.
+
+  When SpareBuffer is NULL, the spare blocks used to stage the write are
+  erased instead, so that the next write finds the spare area pre-erased.
+
+  @param FtwDevice        The private data of FTW driver
+  @param SpareBuffer      The buffer returned by FtwBackupSpareBlock().
+
+  @retval EFI_SUCCESS     The spare area is restored.
+  @retval EFI_ABORTED     The spare area could not be erased or written.
+
+**/
+EFI_STATUS
+FtwRestoreSpareBlock (
+  IN EFI_FTW_DEVICE   *FtwDevice,
+  IN UINT8            *SpareBuffer
+  )
+{
+  EFI_STATUS  Status;
+  UINTN       Length;
+  UINT8       *Ptr;
+  UINTN       Index;
+
+  if (SpareBuffer == NULL) {
+    Status = FtwEraseDirtySpareBlock (FtwDevice);
+    return EFI_ERROR (Status) ? EFI_ABORTED : EFI_SUCCESS;
+  }
+
+  Status = FtwEraseSpareBlock (FtwDevice);
+  if (EFI_ERROR (Status)) {
+    FreePool (SpareBuffer);
+    return EFI_ABORTED;
+  }
+
+  Ptr = SpareBuffer;
+  for (Index = 0; Index < FtwDevice->NumberOfSpareBlock; Index += 1) {
+    Length = FtwDevice->SpareBlockSize;
+    FtwDevice->NumberOfDirtySpareBlock = Index + 1;
+    Status = FtwDevice->FtwBackupFvb->Write (
+                                        FtwDevice->FtwBackupFvb,
+                                        FtwDevice->FtwSpareLba + Index,
+                                        0,
+                                        &Length,
+                                        Ptr
+                                        );
+    if (EFI_ERROR (Status)) {
+      FreePool (SpareBuffer);
+      return EFI_ABORTED;
+    }
+
+    FtwDevice->FlashProgramBytes += Length;
+    Ptr += Length;
+  }
+
+  FreePool (SpareBuffer);
+  return EFI_SUCCESS;
 }
 
 /**
@@ -419,6 +581,7 @@ FlushSpareBlockToBootBlock (
   Ptr = Buffer;
   for (Index = 0; Index < FtwDevice->NumberOfSpareBlock; Index += 1) {
     Count = FtwDevice->SpareBlockSize;
+    FtwDevice->NumberOfDirtySpareBlock = Index + 1;
     Status = FtwDevice->FtwBackupFvb->Write (
                                         FtwDevice->FtwBackupFvb,
                                         FtwDevice->FtwSpareLba + Index,
@@ -531,6 +694,7 @@ FlushSpareBlockToTargetBlock (
       return Status;
     }
 
+    FtwDevice->FlashProgramBytes += Count;
     Ptr += Count;
   }
 
@@ -1135,6 +1299,10 @@ FindFvbForFtw (
           FtwDevice->SpareBlockSize     = BlockSize;
           FtwDevice->NumberOfSpareBlock = FtwDevice->SpareAreaLength / FtwDevice->SpareBlockSize;
           //
+          // Nothing is known about the spare content yet.
+          //
+          FtwDevice->NumberOfDirtySpareBlock = FtwDevice->NumberOfSpareBlock;
+          //
           // Check the range of spare area to make sure that it's in FV range
           //
           if ((FtwDevice->FtwSpareLba + FtwDevice->NumberOfSpareBlock) > NumberOfBlocks) {
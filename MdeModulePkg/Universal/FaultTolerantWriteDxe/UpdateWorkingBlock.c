@@ -363,7 +363,6 @@ FtwReclaimWorkSpace (
   EFI_FAULT_TOLERANT_WRITE_HEADER         *Header;
   UINT8                                   *TempBuffer;
   UINTN                                   TempBufferSize;
-  UINTN                                   SpareBufferSize;
   UINT8                                   *SpareBuffer;
   EFI_FAULT_TOLERANT_WORKING_BLOCK_HEADER *WorkingBlockHeader;
   UINTN                                   Index;
@@ -469,38 +468,24 @@ FtwReclaimWorkSpace (
   // Try to keep the content of spare block
   // Save spare block into a spare backup memory buffer (Sparebuffer)
   //
-  SpareBufferSize = FtwDevice->SpareAreaLength;
-  SpareBuffer     = AllocatePool (SpareBufferSize);
-  if (SpareBuffer == NULL) {
+  Status = FtwBackupSpareBlock (FtwDevice, &SpareBuffer);
+  if (EFI_ERROR (Status)) {
     FreePool (TempBuffer);
-    return EFI_OUT_OF_RESOURCES;
-  }
-
-  Ptr = SpareBuffer;
-  for (Index = 0; Index < FtwDevice->NumberOfSpareBlock; Index += 1) {
-    Length = FtwDevice->SpareBlockSize;
-    Status = FtwDevice->FtwBackupFvb->Read (
-                                        FtwDevice->FtwBackupFvb,
-                                        FtwDevice->FtwSpareLba + Index,
-                                        0,
-                                        &Length,
-                                        Ptr
-                                        );
-    if (EFI_ERROR (Status)) {
-      FreePool (TempBuffer);
-      FreePool (SpareBuffer);
-      return EFI_ABORTED;
-    }
-
-    Ptr += Length;
+    return Status;
   }
   //
   // Write the memory buffer to spare block
   //
-  Status  = FtwEraseSpareBlock (FtwDevice);
+  if (SpareBuffer == NULL) {
+    Status = FtwEraseDirtySpareBlock (FtwDevice);
+  } else {
+    Status = FtwEraseSpareBlock (FtwDevice);
+  }
   if (EFI_ERROR (Status)) {
     FreePool (TempBuffer);
-    FreePool (SpareBuffer);
+    if (SpareBuffer != NULL) {
+      FreePool (SpareBuffer);
+    }
     return EFI_ABORTED;
   }
   Ptr     = TempBuffer;
@@ -510,6 +495,7 @@ FtwReclaimWorkSpace (
     } else {
       Length = TempBufferSize;
     }
+    FtwDevice->NumberOfDirtySpareBlock = Index + 1;
     Status = FtwDevice->FtwBackupFvb->Write (
                                             FtwDevice->FtwBackupFvb,
                                             FtwDevice->FtwSpareLba + Index,
@@ -519,7 +505,9 @@ FtwReclaimWorkSpace (
                                             );
     if (EFI_ERROR (Status)) {
       FreePool (TempBuffer);
-      FreePool (SpareBuffer);
+      if (SpareBuffer != NULL) {
+        FreePool (SpareBuffer);
+      }
       return EFI_ABORTED;
     }
 
@@ -542,7 +530,9 @@ FtwReclaimWorkSpace (
             WORKING_BLOCK_VALID
             );
   if (EFI_ERROR (Status)) {
-    FreePool (SpareBuffer);
+    if (SpareBuffer != NULL) {
+      FreePool (SpareBuffer);
+    }
     return EFI_ABORTED;
   }
   //
@@ -559,7 +549,9 @@ FtwReclaimWorkSpace (
             WORKING_BLOCK_INVALID
             );
   if (EFI_ERROR (Status)) {
-    FreePool (SpareBuffer);
+    if (SpareBuffer != NULL) {
+      FreePool (SpareBuffer);
+    }
     return EFI_ABORTED;
   }
 
@@ -570,37 +562,20 @@ FtwReclaimWorkSpace (
   //
   Status = FlushSpareBlockToWorkingBlock (FtwDevice);
   if (EFI_ERROR (Status)) {
-    FreePool (SpareBuffer);
+    if (SpareBuffer != NULL) {
+      FreePool (SpareBuffer);
+    }
     return Status;
   }
   //
   // Restore spare backup buffer into spare block , if no failure happened during FtwWrite.
+  // Otherwise erase the staged blocks so that the spare area is pre-erased for the next write.
   //
-  Status  = FtwEraseSpareBlock (FtwDevice);
+  Status = FtwRestoreSpareBlock (FtwDevice, SpareBuffer);
   if (EFI_ERROR (Status)) {
-    FreePool (SpareBuffer);
-    return EFI_ABORTED;
-  }
-  Ptr     = SpareBuffer;
-  for (Index = 0; Index < FtwDevice->NumberOfSpareBlock; Index += 1) {
-    Length = FtwDevice->SpareBlockSize;
-    Status = FtwDevice->FtwBackupFvb->Write (
-                                        FtwDevice->FtwBackupFvb,
-                                        FtwDevice->FtwSpareLba + Index,
-                                        0,
-                                        &Length,
-                                        Ptr
-                                        );
-    if (EFI_ERROR (Status)) {
-      FreePool (SpareBuffer);
-      return EFI_ABORTED;
-    }
-
-    Ptr += Length;
+    return Status;
   }
 
-  FreePool (SpareBuffer);
-
   DEBUG ((EFI_D_INFO, "Ftw: reclaim work space successfully\n"));
 
   return EFI_SUCCESS;
@@ -99,6 +99,10 @@ FvFsFindExecutableSection (
 /**
   Get the size of the buffer that will be returned by FvFsReadFile.
 
+  The size is only determined the first time it is needed, as finding it may
+  require the section extraction (e.g. decompression) of the file. It is then
+  cached in FvFileInfo.
+
   @param  FvProtocol                  A pointer to the EFI_FIRMWARE_VOLUME2_PROTOCOL instance.
   @param  FvFileInfo                  A pointer to the FV_FILESYSTEM_FILE_INFO instance that is a struct
                                       representing a file's info.
@@ -120,6 +124,10 @@ FvFsGetFileSize (
   UINT8                          IgnoredByte;
   VOID                           *IgnoredPtr;
 
+  if (FvFileInfo->FileSizeValid) {
+    return EFI_SUCCESS;
+  }
+
   //
   // To get the size of a section, we pass 0 for BufferSize. But we can't pass
   // NULL for Buffer, as that will cause a return of INVALID_PARAMETER, and we
@@ -135,7 +143,7 @@ FvFsGetFileSize (
     //
     Status = FvFsFindExecutableSection (FvProtocol, FvFileInfo, (UINTN*)&FvFileInfo->FileInfo.FileSize, &IgnoredPtr);
     if (Status == EFI_WARN_BUFFER_TOO_SMALL) {
-      return EFI_SUCCESS;
+      Status = EFI_SUCCESS;
     }
   } else if (FvFileInfo->Type == EFI_FV_FILETYPE_FREEFORM) {
     //
@@ -151,13 +159,26 @@ FvFsGetFileSize (
                            &AuthenticationStatus
                            );
     if (Status == EFI_WARN_BUFFER_TOO_SMALL) {
-      return EFI_SUCCESS;
-    }
-    if (EFI_ERROR (Status)) {
+      Status = EFI_SUCCESS;
+    } else if (EFI_ERROR (Status)) {
       //
       // Didn't find a raw section, just return the whole file's size.
       //
-      return FvProtocol->ReadFile (
+      Status = FvProtocol->ReadFile (
+                             FvProtocol,
+                             &FvFileInfo->NameGuid,
+                             NULL,
+                             (UINTN*)&FvFileInfo->FileInfo.FileSize,
+                             &FoundType,
+                             &Attributes,
+                             &AuthenticationStatus
+                             );
+    }
+  } else {
+    //
+    // Get the size of the entire file
+    //
+    Status = FvProtocol->ReadFile (
                            FvProtocol,
                            &FvFileInfo->NameGuid,
                            NULL,
@@ -166,20 +187,11 @@ FvFsGetFileSize (
                            &Attributes,
                            &AuthenticationStatus
                            );
-    }
-  } else {
-    //
-    // Get the size of the entire file
-    //
-    return FvProtocol->ReadFile (
-                         FvProtocol,
-                         &FvFileInfo->NameGuid,
-                         NULL,
-                         (UINTN*)&FvFileInfo->FileInfo.FileSize,
-                         &FoundType,
-                         &Attributes,
-                         &AuthenticationStatus
-                         );
+  }
+
+  if (!EFI_ERROR (Status)) {
+    FvFileInfo->FileInfo.PhysicalSize = FvFileInfo->FileInfo.FileSize;
+    FvFileInfo->FileSizeValid         = TRUE;
   }
 
   return Status;
@@ -569,6 +581,8 @@ FvSimpleFileSystemOpen (
           break;
         }
       }
+
+      FreePool (FileNameWithExtension);
     }
   }
 
@@ -663,6 +677,11 @@ FvSimpleFileSystemRead (
       //
       // Directory read: populate Buffer with an EFI_FILE_INFO
       //
+      Status = FvFsGetFileSize (Instance->FvProtocol, File->DirReadNext);
+      if (EFI_ERROR (Status)) {
+        return EFI_DEVICE_ERROR;
+      }
+
       Status = FvFsGetFileInfo (File->DirReadNext, BufferSize, Buffer);
       if (!EFI_ERROR (Status)) {
         //
@@ -689,6 +708,11 @@ FvSimpleFileSystemRead (
       return EFI_SUCCESS;
     }
   } else {
+    Status = FvFsGetFileSize (Instance->FvProtocol, File->FvFileInfo);
+    if (EFI_ERROR (Status)) {
+      return EFI_DEVICE_ERROR;
+    }
+
     FileSize = (UINTN)File->FvFileInfo->FileInfo.FileSize;
 
     FileBuffer = AllocateZeroPool (FileSize);
@@ -826,6 +850,9 @@ FvSimpleFileSystemSetPosition (
       File->DirReadNext = FVFS_GET_FIRST_FILE_INFO (Instance);
     }
   } else if (Position == 0xFFFFFFFFFFFFFFFFull) {
+    if (EFI_ERROR (FvFsGetFileSize (Instance->FvProtocol, File->FvFileInfo))) {
+      return EFI_DEVICE_ERROR;
+    }
     File->Position = File->FvFileInfo->FileInfo.FileSize;
   } else {
     File->Position = Position;
@@ -951,6 +978,10 @@ FvSimpleFileSystemGetInfo (
     //
     // Return file info
     //
+    Status = FvFsGetFileSize (File->Instance->FvProtocol, File->FvFileInfo);
+    if (EFI_ERROR (Status)) {
+      return EFI_DEVICE_ERROR;
+    }
     return FvFsGetFileInfo (File->FvFileInfo, BufferSize, (EFI_FILE_INFO *) Buffer);
   } else if (CompareGuid (InformationType, &gEfiFileSystemVolumeLabelInfoIdGuid)) {
     //
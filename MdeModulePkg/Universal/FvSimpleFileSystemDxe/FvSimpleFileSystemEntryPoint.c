@@ -117,6 +117,7 @@ FvSimpleFileSystemOpenVolume (
     }
     Root->FvFileInfo->FileInfo.Size      = sizeof (EFI_FILE_INFO);
     Root->FvFileInfo->FileInfo.Attribute = EFI_FILE_DIRECTORY | EFI_FILE_READ_ONLY;
+    Root->FvFileInfo->FileSizeValid      = TRUE;
 
     //
     // Populate the instance's list of files. We consider anything a file that
@@ -200,11 +201,12 @@ FvSimpleFileSystemOpenVolume (
         ASSERT_EFI_ERROR (Status);
       }
 
-      FvFileInfo->FileInfo.Size     = sizeof (EFI_FILE_INFO) + NameLen - sizeof (CHAR16);
-      Status = FvFsGetFileSize (FvProtocol, FvFileInfo);
-      ASSERT_EFI_ERROR (Status);
-      FvFileInfo->FileInfo.PhysicalSize = FvFileInfo->FileInfo.FileSize;
-      FvFileInfo->FileInfo.Attribute    = EFI_FILE_READ_ONLY;
+      //
+      // The file size is only looked up when it is first needed, see
+      // FvFsGetFileSize().
+      //
+      FvFileInfo->FileInfo.Size      = sizeof (EFI_FILE_INFO) + NameLen - sizeof (CHAR16);
+      FvFileInfo->FileInfo.Attribute = EFI_FILE_READ_ONLY;
 
       InsertHeadList (&Instance->FileInfoHead, &FvFileInfo->Link);
 
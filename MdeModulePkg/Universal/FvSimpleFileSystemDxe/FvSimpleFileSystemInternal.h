@@ -74,6 +74,11 @@ struct _FV_FILESYSTEM_FILE_INFO {
   LIST_ENTRY                       Link;
   EFI_GUID                         NameGuid;
   EFI_FV_FILETYPE                  Type;
+  //
+  // FileInfo.FileSize and FileInfo.PhysicalSize are only valid once
+  // FileSizeValid is set. See FvFsGetFileSize().
+  //
+  BOOLEAN                          FileSizeValid;
   EFI_FILE_INFO                    FileInfo;
 };
 
@@ -469,6 +474,10 @@ FvSimpleFileSystemSetInfo (
 /**
   Get the size of the buffer that will be returned by FvFsReadFile.
 
+  The size is only determined the first time it is needed, as finding it may
+  require the section extraction (e.g. decompression) of the file. It is then
+  cached in FvFileInfo.
+
   @param  FvProtocol                  A pointer to the EFI_FIRMWARE_VOLUME2_PROTOCOL instance.
   @param  FvFileInfo                  A pointer to the FV_FILESYSTEM_FILE_INFO instance that is a struct
                                       representing a file's info.
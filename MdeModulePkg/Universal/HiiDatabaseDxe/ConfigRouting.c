@@ -525,55 +525,165 @@ Exit:
 }
 
 /**
- To find the BlockName in the string with same value.
+  Get the length of the <Number> of an "&OFFSET=<Number>".
+
+  @param  Number                 Pointer to the first character of <Number>.
+
+  @return The length of the <Number>, in characters.
+
+**/
+UINTN
+GetBlockOffsetLength (
+  IN  EFI_STRING   Number
+  )
+{
+  UINTN        Length;
+
+  for (Length = 0; Number[Length] != L'\0' && Number[Length] != L'&'; Length++) {
+  }
+
+  return Length;
+}
+
+/**
+  Compare the values of two "&OFFSET=<Number>".
+
+  Two <Number> are the same if they have the same length and the same hex
+  digits, regardless of the case.
+
+  @param  Offset1                The first <Number>.
+  @param  Offset2                The second <Number>.
+
+  @retval 0                      The two <Number> are the same.
+  @retval <0                     Offset1 is sorted before Offset2.
+  @retval >0                     Offset1 is sorted after Offset2.
+
+**/
+INTN
+CompareBlockOffset (
+  IN  IFR_BLOCK_OFFSET  *Offset1,
+  IN  IFR_BLOCK_OFFSET  *Offset2
+  )
+{
+  UINTN        Index;
+  CHAR16       Char1;
+  CHAR16       Char2;
+
+  if (Offset1->Length != Offset2->Length) {
+    return (Offset1->Length < Offset2->Length) ? -1 : 1;
+  }
+
+  for (Index = 0; Index < Offset1->Length; Index++) {
+    Char1 = CharToUpper (Offset1->Number[Index]);
+    Char2 = CharToUpper (Offset2->Number[Index]);
+    if (Char1 != Char2) {
+      return (Char1 < Char2) ? -1 : 1;
+    }
+  }
+
+  return 0;
+}
+
+/**
+  Collect the "&OFFSET=<Number>" of a string in a sorted array.
+
+  The blocks of a <ConfigAltResp> are usually in ascending offset order, so
+  the insertion sort runs in about linear time.
 
   @param  String                 Pointer to a Null-terminated Unicode string.
-  @param  BlockName              Pointer to a Null-terminated Unicode string to search for.
-  @param  Buffer                 Pointer to the value correspond to the BlockName.
-  @param  Found                  The Block whether has been found.
-  @param  BufferLen              The length of the buffer.
+  @param  OffsetArray            The sorted array of <Number>. Caller takes the
+                                 responsibility to free memory.
+  @param  OffsetCount            The number of entries in OffsetArray.
 
   @retval EFI_OUT_OF_RESOURCES   Insufficient resources to store necessary structures.
   @retval EFI_SUCCESS            The function finishes successfully.
 
 **/
 EFI_STATUS
-FindSameBlockElement(
-  IN  EFI_STRING   String,
-  IN  EFI_STRING   BlockName,
-  IN  UINT8        *Buffer,
-  OUT BOOLEAN      *Found,
-  IN  UINTN        BufferLen
+GetBlockOffsetArray (
+  IN  EFI_STRING         String,
+  OUT IFR_BLOCK_OFFSET   **OffsetArray,
+  OUT UINTN              *OffsetCount
   )
 {
-  EFI_STRING   BlockPtr;
-  UINTN        Length;
-  UINT8        *TempBuffer;
-  EFI_STATUS   Status;
+  EFI_STRING         BlockPtr;
+  IFR_BLOCK_OFFSET   *Array;
+  IFR_BLOCK_OFFSET   Offset;
+  UINTN              Count;
+  UINTN              Index;
 
-  TempBuffer = NULL;
-  *Found = FALSE;
-  BlockPtr = StrStr (String, BlockName);
+  *OffsetArray = NULL;
+  *OffsetCount = 0;
 
-  while (BlockPtr != NULL) {
-    BlockPtr += StrLen (BlockName);
-    Status = GetValueOfNumber (BlockPtr, &TempBuffer, &Length);
-    if (EFI_ERROR (Status)) {
-      return Status;
+  Count = 0;
+  for (BlockPtr = StrStr (String, L"&OFFSET="); BlockPtr != NULL; BlockPtr = StrStr (BlockPtr + 1, L"&OFFSET=")) {
+    Count++;
+  }
+
+  if (Count == 0) {
+    return EFI_SUCCESS;
+  }
+
+  Array = AllocatePool (Count * sizeof (IFR_BLOCK_OFFSET));
+  if (Array == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Count = 0;
+  for (BlockPtr = StrStr (String, L"&OFFSET="); BlockPtr != NULL; BlockPtr = StrStr (BlockPtr + 1, L"&OFFSET=")) {
+    Offset.Number = BlockPtr + StrLen (L"&OFFSET=");
+    Offset.Length = GetBlockOffsetLength (Offset.Number);
+
+    for (Index = Count; Index > 0 && CompareBlockOffset (&Array[Index - 1], &Offset) > 0; Index--) {
+      CopyMem (&Array[Index], &Array[Index - 1], sizeof (IFR_BLOCK_OFFSET));
     }
-    ASSERT (TempBuffer != NULL);
-    if ((BufferLen == Length) && (0 == CompareMem (Buffer, TempBuffer, Length))) {
-      *Found = TRUE;
-      FreePool (TempBuffer);
-      TempBuffer = NULL;
-      return EFI_SUCCESS;
+    CopyMem (&Array[Index], &Offset, sizeof (IFR_BLOCK_OFFSET));
+    Count++;
+  }
+
+  *OffsetArray = Array;
+  *OffsetCount = Count;
+  return EFI_SUCCESS;
+}
+
+/**
+  Binary search a "&OFFSET=<Number>" in a sorted array.
+
+  @param  OffsetArray            The sorted array of <Number>.
+  @param  OffsetCount            The number of entries in OffsetArray.
+  @param  Offset                 The <Number> to search for.
+
+  @retval TRUE                   The same <Number> is in the array.
+  @retval FALSE                  The <Number> is not in the array.
+
+**/
+BOOLEAN
+IsBlockOffsetInArray (
+  IN  IFR_BLOCK_OFFSET   *OffsetArray,
+  IN  UINTN              OffsetCount,
+  IN  IFR_BLOCK_OFFSET   *Offset
+  )
+{
+  UINTN        Low;
+  UINTN        High;
+  UINTN        Middle;
+  INTN         Result;
+
+  Low  = 0;
+  High = OffsetCount;
+  while (Low < High) {
+    Middle = Low + (High - Low) / 2;
+    Result = CompareBlockOffset (&OffsetArray[Middle], Offset);
+    if (Result == 0) {
+      return TRUE;
+    } else if (Result < 0) {
+      Low = Middle + 1;
     } else {
-      FreePool (TempBuffer);
-      TempBuffer = NULL;
-      BlockPtr = StrStr (BlockPtr + 1, BlockName);
+      High = Middle;
     }
   }
-  return EFI_SUCCESS;
+
+  return FALSE;
 }
 
 /**
@@ -601,20 +711,22 @@ CompareBlockElementDefault (
   IN OUT  BOOLEAN     *ConfigAltRespChanged
 )
 {
-  EFI_STATUS    Status;
-  EFI_STRING    BlockPtr;
-  EFI_STRING    BlockPtrStart;
-  EFI_STRING    StringPtr;
-  EFI_STRING    AppendString;
-  EFI_STRING    AltConfigHdrPtr;
-  UINT8         *TempBuffer;
-  UINTN         OffsetLength;
-  UINTN         AppendSize;
-  UINTN         TotalSize;
-  BOOLEAN       FoundOffset;
+  EFI_STATUS        Status;
+  EFI_STRING        BlockPtr;
+  EFI_STRING        BlockPtrStart;
+  EFI_STRING        StringPtr;
+  EFI_STRING        AppendString;
+  EFI_STRING        AltConfigHdrPtr;
+  IFR_BLOCK_OFFSET  *OffsetArray;
+  IFR_BLOCK_OFFSET  Offset;
+  UINTN             OffsetCount;
+  UINTN             AppendLength;
+  UINTN             BlockLength;
+  UINTN             TotalSize;
 
   AppendString = NULL;
-  TempBuffer   = NULL;
+  AppendLength = 0;
+  OffsetArray  = NULL;
   //
   // Make BlockPtr point to the first <BlockConfig> with AltConfigHdr in DefaultAltCfgResp.
   //
@@ -627,69 +739,66 @@ CompareBlockElementDefault (
   StringPtr = StrStr (*ConfigAltResp, AltConfigHdr);
   ASSERT (StringPtr != NULL);
 
+  //
+  // Sort the "&OFFSET=<Number>" blocks of ConfigAltResp once, then binary
+  // search each block of DefaultAltCfgResp, instead of scanning ConfigAltResp
+  // again for every block.
+  //
+  Status = GetBlockOffsetArray (StringPtr, &OffsetArray, &OffsetCount);
+  if (EFI_ERROR (Status)) {
+    goto Exit;
+  }
+
+  //
+  // The appended <BlockConfig> are all taken from the rest of DefaultAltCfgResp.
+  //
+  if (BlockPtr != NULL) {
+    AppendString = (EFI_STRING) AllocatePool (StrSize (BlockPtr));
+    if (AppendString == NULL) {
+      Status = EFI_OUT_OF_RESOURCES;
+      goto Exit;
+    }
+  }
+
   while (BlockPtr != NULL) {
     //
-    // Find the "&OFFSET=<Number>" block and get the value of the Number with AltConfigHdr in DefaultAltCfgResp.
+    // Find the "&OFFSET=<Number>" block and get the Number with AltConfigHdr in DefaultAltCfgResp.
     //
     BlockPtrStart = BlockPtr;
     BlockPtr += StrLen (L"&OFFSET=");
-    Status = GetValueOfNumber (BlockPtr, &TempBuffer, &OffsetLength);
-    if (EFI_ERROR (Status)) {
+    if (*BlockPtr == L'\0') {
       Status = EFI_OUT_OF_RESOURCES;
       goto Exit;
     }
+    Offset.Number = BlockPtr;
+    Offset.Length = GetBlockOffsetLength (BlockPtr);
+
+    //
+    // To find next "&OFFSET=<Number>" block with AltConfigHdr in DefaultAltCfgResp.
+    //
+    BlockPtr = StrStr (BlockPtr + 1, L"&OFFSET=");
+
     //
     // To find the same "&OFFSET=<Number>" block in ConfigAltResp.
     //
-    Status = FindSameBlockElement (StringPtr, L"&OFFSET=", TempBuffer, &FoundOffset, OffsetLength);
-    if (TempBuffer != NULL) {
-      FreePool (TempBuffer);
-      TempBuffer = NULL;
-    }
-    if (EFI_ERROR (Status)) {
-      Status = EFI_OUT_OF_RESOURCES;
-      goto Exit;
-    }
-    if (!FoundOffset) {
+    if (!IsBlockOffsetInArray (OffsetArray, OffsetCount, &Offset)) {
       //
       // Don't find the same "&OFFSET=<Number>" block in ConfigAltResp.
-      // Calculate the size of <BlockConfig>.
+      // Copy the <BlockConfig> to AppendString.
       // <BlockConfig>::='OFFSET='<Number>'&WIDTH='<Number>'&VALUE='<Number>.
       //
-      BlockPtr = StrStr (BlockPtr + 1, L"&OFFSET=");
       if (BlockPtr != NULL) {
-        AppendSize = (BlockPtr - BlockPtrStart) * sizeof (CHAR16);
+        BlockLength = BlockPtr - BlockPtrStart;
       } else {
-        AppendSize = StrSize (BlockPtrStart);
-      }
-      //
-      // Copy the <BlockConfig> to AppendString.
-      //
-      if (AppendString == NULL) {
-        AppendString = (EFI_STRING) AllocateZeroPool (AppendSize + sizeof (CHAR16));
-        StrnCatS (AppendString, AppendSize / sizeof (CHAR16) + 1, BlockPtrStart, AppendSize / sizeof (CHAR16));
-      } else {
-        TotalSize = StrSize (AppendString) + AppendSize + sizeof (CHAR16);
-        AppendString = (EFI_STRING) ReallocatePool (
-                                      StrSize (AppendString),
-                                      TotalSize,
-                                      AppendString
-                                      );
-        if (AppendString == NULL) {
-          Status = EFI_OUT_OF_RESOURCES;
-          goto Exit;
-        }
-        StrnCatS (AppendString, TotalSize / sizeof (CHAR16), BlockPtrStart, AppendSize / sizeof (CHAR16));
+        BlockLength = StrLen (BlockPtrStart);
       }
-    } else {
-      //
-      // To find next "&OFFSET=<Number>" block with AltConfigHdr in DefaultAltCfgResp.
-      //
-      BlockPtr = StrStr (BlockPtr + 1, L"&OFFSET=");
+      CopyMem (AppendString + AppendLength, BlockPtrStart, BlockLength * sizeof (CHAR16));
+      AppendLength += BlockLength;
     }
   }
 
-  if (AppendString != NULL) {
+  if (AppendLength != 0) {
+    AppendString[AppendLength] = L'\0';
     //
     // Reallocate ConfigAltResp to copy the AppendString.
     //
@@ -714,6 +823,10 @@ Exit:
     FreePool (AppendString);
   }
 
+  if (OffsetArray != NULL) {
+    FreePool (OffsetArray);
+  }
+
   return Status;
 }
 
@@ -1214,6 +1327,18 @@ InsertBlockData (
     return;
   }
 
+  //
+  // Questions and request elements mostly come in ascending offset order,
+  // so check the tail first to avoid walking the whole block array.
+  //
+  if (!IsListEmpty (BlockLink)) {
+    BlockArray = BASE_CR (BlockLink->BackLink, IFR_BLOCK_DATA, Entry);
+    if (BlockArray->Name == NULL && BlockArray->Offset < BlockSingleData->Offset) {
+      InsertTailList (BlockLink, &BlockSingleData->Entry);
+      return;
+    }
+  }
+
   //
   // Insert block data in its Offset and Width order.
   //
@@ -1506,22 +1631,34 @@ BlockArrayCheck (
   //
   // Check the input var is in the request block range.
   //
-  for (Link = RequestBlockArray->Entry.ForwardLink; Link != &RequestBlockArray->Entry; Link = Link->ForwardLink) {
-    BlockData = BASE_CR (Link, IFR_BLOCK_DATA, Entry);
-
-    if (IsNameValueType) {
-      Name = InternalGetString (HiiHandle, VarOffset);
-      ASSERT (Name != NULL);
+  if (IsNameValueType) {
+    Name = InternalGetString (HiiHandle, VarOffset);
+    ASSERT (Name != NULL);
 
+    for (Link = RequestBlockArray->Entry.ForwardLink; Link != &RequestBlockArray->Entry; Link = Link->ForwardLink) {
+      BlockData = BASE_CR (Link, IFR_BLOCK_DATA, Entry);
       if (StrnCmp (BlockData->Name, Name, StrLen (Name)) == 0) {
         FreePool (Name);
         return TRUE;
       }
-      FreePool (Name);
-    } else {
-      if ((VarOffset >= BlockData->Offset) && ((VarOffset + VarWidth) <= (BlockData->Offset + BlockData->Width))) {
-        return TRUE;
-      }
+    }
+
+    FreePool (Name);
+    return FALSE;
+  }
+
+  //
+  // The request block array is sorted by offset and its blocks are merged,
+  // so stop at the first block after VarOffset.
+  //
+  for (Link = RequestBlockArray->Entry.ForwardLink; Link != &RequestBlockArray->Entry; Link = Link->ForwardLink) {
+    BlockData = BASE_CR (Link, IFR_BLOCK_DATA, Entry);
+    if (BlockData->Offset > VarOffset) {
+      break;
+    }
+
+    if ((VarOffset + VarWidth) <= (BlockData->Offset + BlockData->Width)) {
+      return TRUE;
     }
   }
 
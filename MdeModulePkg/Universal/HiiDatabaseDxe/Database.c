@@ -1497,6 +1497,7 @@ AdjustStringPackage (
       *BlockPtr = EFI_HII_SIBT_END;
       FreePool (StringPackage->StringBlock);
       StringPackage->StringBlock = StringBlock;
+      InvalidateStringIndex (StringPackage);
       StringPackage->StringPkgHdr->Header.Length += Skip2BlockSize;
       PackageList->PackageListHdr.PackageLength += Skip2BlockSize;
       StringPackage->MaxStringId = MaxStringId;
@@ -1638,6 +1639,7 @@ RemoveStringPackages (
     PackageList->PackageListHdr.PackageLength -= Package->StringPkgHdr->Header.Length;
     FreePool (Package->StringBlock);
     FreePool (Package->StringPkgHdr);
+    InvalidateStringIndex (Package);
     //
     // Delete font information
     //
@@ -1925,6 +1927,13 @@ RemoveFontPackages (
 
   ListHead = &PackageList->FontPkgHdr;
 
+  if (!IsListEmpty (ListHead)) {
+    //
+    // The glyph cache refers to the global font info of the packages.
+    //
+    FlushGlyphCache (Private);
+  }
+
   while (!IsListEmpty (ListHead)) {
     Package = CR (
                 ListHead->ForwardLink,
@@ -2438,6 +2447,10 @@ RemoveSimpleFontPackages (
 
   ListHead = &PackageList->SimpleFontPkgHdr;
 
+  if (!IsListEmpty (ListHead)) {
+    FlushGlyphCache (Private);
+  }
+
   while (!IsListEmpty (ListHead)) {
     Package = CR (
                 ListHead->ForwardLink,
@@ -3088,6 +3101,10 @@ AddPackages (
       if (EFI_ERROR (Status)) {
         return Status;
       }
+      //
+      // Glyphs that were not found before may be in the new package.
+      //
+      FlushGlyphCache (Private);
       Status = InvokeRegisteredFunction (
                  Private,
                  NotifyType,
@@ -3124,6 +3141,7 @@ AddPackages (
       if (EFI_ERROR (Status)) {
         return Status;
       }
+      FlushGlyphCache (Private);
       Status = InvokeRegisteredFunction (
                  Private,
                  NotifyType,
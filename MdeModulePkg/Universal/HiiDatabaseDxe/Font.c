@@ -131,33 +131,30 @@ GetCell (
 
 
 /**
-  Convert the glyph for a single character into a bitmap.
+  Search the simple font packages of the database for the glyph of a character.
 
   This is a internal function.
 
   @param  Private                 HII database driver private data.
   @param  Char                    Character to retrieve.
-  @param  StringInfo              Points to the string font and color information
-                                  or NULL  if the string should use the default
-                                  system font and color.
   @param  GlyphBuffer             Buffer to store the retrieved bitmap data.
   @param  Cell                    Points to EFI_HII_GLYPH_INFO structure.
-  @param  Attributes              If not NULL, output the glyph attributes if any.
+  @param  Attributes              Output the glyph attributes.
+  @param  GlyphBufferLen          Output the length of GlyphBuffer.
 
   @retval EFI_SUCCESS             Glyph bitmap outputted.
   @retval EFI_OUT_OF_RESOURCES    Unable to allocate the output buffer GlyphBuffer.
   @retval EFI_NOT_FOUND           The glyph was unknown can not be found.
-  @retval EFI_INVALID_PARAMETER   Any input parameter is invalid.
 
 **/
 EFI_STATUS
-GetGlyphBuffer (
+FindSimpleFontGlyph (
   IN  HII_DATABASE_PRIVATE_DATA      *Private,
   IN  CHAR16                         Char,
-  IN  EFI_FONT_INFO                  *StringInfo,
   OUT UINT8                          **GlyphBuffer,
   OUT EFI_HII_GLYPH_INFO             *Cell,
-  OUT UINT8                          *Attributes OPTIONAL
+  OUT UINT8                          *Attributes,
+  OUT UINTN                          *GlyphBufferLen
   )
 {
   HII_DATABASE_RECORD                *Node;
@@ -167,11 +164,241 @@ GetGlyphBuffer (
   UINT16                             Index;
   EFI_NARROW_GLYPH                   Narrow;
   EFI_WIDE_GLYPH                     Wide;
-  HII_GLOBAL_FONT_INFO               *GlobalFont;
   UINTN                              HeaderSize;
   EFI_NARROW_GLYPH                   *NarrowPtr;
   EFI_WIDE_GLYPH                     *WidePtr;
 
+  HeaderSize = sizeof (EFI_HII_SIMPLE_FONT_PACKAGE_HDR);
+
+  for (Link = Private->DatabaseList.ForwardLink; Link != &Private->DatabaseList; Link = Link->ForwardLink) {
+    Node = CR (Link, HII_DATABASE_RECORD, DatabaseEntry, HII_DATABASE_RECORD_SIGNATURE);
+    for (Link1 = Node->PackageList->SimpleFontPkgHdr.ForwardLink;
+         Link1 != &Node->PackageList->SimpleFontPkgHdr;
+         Link1 = Link1->ForwardLink
+        ) {
+      SimpleFont = CR (Link1, HII_SIMPLE_FONT_PACKAGE_INSTANCE, SimpleFontEntry, HII_S_FONT_PACKAGE_SIGNATURE);
+      //
+      // Search the narrow glyph array
+      //
+      NarrowPtr = (EFI_NARROW_GLYPH *) ((UINT8 *) (SimpleFont->SimpleFontPkgHdr) + HeaderSize);
+      for (Index = 0; Index < SimpleFont->SimpleFontPkgHdr->NumberOfNarrowGlyphs; Index++) {
+        CopyMem (&Narrow, NarrowPtr + Index,sizeof (EFI_NARROW_GLYPH));
+        if (Narrow.UnicodeWeight == Char) {
+          *GlyphBuffer = (UINT8 *) AllocateZeroPool (EFI_GLYPH_HEIGHT);
+          if (*GlyphBuffer == NULL) {
+            return EFI_OUT_OF_RESOURCES;
+          }
+          Cell->Width    = EFI_GLYPH_WIDTH;
+          Cell->Height   = EFI_GLYPH_HEIGHT;
+          Cell->AdvanceX = Cell->Width;
+          CopyMem (*GlyphBuffer, Narrow.GlyphCol1, Cell->Height);
+          *Attributes     = (UINT8) (Narrow.Attributes | NARROW_GLYPH);
+          *GlyphBufferLen = EFI_GLYPH_HEIGHT;
+          return EFI_SUCCESS;
+        }
+      }
+      //
+      // Search the wide glyph array
+      //
+      WidePtr = (EFI_WIDE_GLYPH *) (NarrowPtr + SimpleFont->SimpleFontPkgHdr->NumberOfNarrowGlyphs);
+      for (Index = 0; Index < SimpleFont->SimpleFontPkgHdr->NumberOfWideGlyphs; Index++) {
+        CopyMem (&Wide, WidePtr + Index, sizeof (EFI_WIDE_GLYPH));
+        if (Wide.UnicodeWeight == Char) {
+          *GlyphBuffer    = (UINT8 *) AllocateZeroPool (EFI_GLYPH_HEIGHT * 2);
+          if (*GlyphBuffer == NULL) {
+            return EFI_OUT_OF_RESOURCES;
+          }
+          Cell->Width    = EFI_GLYPH_WIDTH * 2;
+          Cell->Height   = EFI_GLYPH_HEIGHT;
+          Cell->AdvanceX = Cell->Width;
+          CopyMem (*GlyphBuffer, Wide.GlyphCol1, EFI_GLYPH_HEIGHT);
+          CopyMem (*GlyphBuffer + EFI_GLYPH_HEIGHT, Wide.GlyphCol2, EFI_GLYPH_HEIGHT);
+          *Attributes     = (UINT8) (Wide.Attributes | EFI_GLYPH_WIDE);
+          *GlyphBufferLen = EFI_GLYPH_HEIGHT * 2;
+          return EFI_SUCCESS;
+        }
+      }
+    }
+  }
+
+  return EFI_NOT_FOUND;
+}
+
+/**
+  Remove one entry from the glyph cache and free it.
+
+  This is a internal function.
+
+  @param  Private                 HII database driver private data.
+  @param  Entry                   The entry to remove.
+
+**/
+VOID
+RemoveGlyphCacheEntry (
+  IN HII_DATABASE_PRIVATE_DATA       *Private,
+  IN HII_GLYPH_CACHE_ENTRY           *Entry
+  )
+{
+  RemoveEntryList (&Entry->HashEntry);
+  RemoveEntryList (&Entry->LruEntry);
+  Private->GlyphCacheCount--;
+  FreePool (Entry);
+}
+
+/**
+  Remove all entries from the glyph cache. It must be called whenever a font
+  or simple font package is added to or removed from the database.
+
+  This is a internal function.
+
+  @param  Private                 HII database driver private data.
+
+**/
+VOID
+FlushGlyphCache (
+  IN HII_DATABASE_PRIVATE_DATA       *Private
+  )
+{
+  while (!IsListEmpty (&Private->GlyphCacheLru)) {
+    RemoveGlyphCacheEntry (
+      Private,
+      CR (Private->GlyphCacheLru.ForwardLink, HII_GLYPH_CACHE_ENTRY, LruEntry, HII_GLYPH_CACHE_ENTRY_SIGNATURE)
+      );
+  }
+}
+
+/**
+  Look up the glyph of a character in the glyph cache, and mark it as the most
+  recently used one.
+
+  This is a internal function.
+
+  @param  Private                 HII database driver private data.
+  @param  GlobalFont              The font, or NULL for the simple fonts.
+  @param  Char                    Character to retrieve.
+
+  @return The cache entry, or NULL if the character is not cached.
+
+**/
+HII_GLYPH_CACHE_ENTRY *
+LookupGlyphCache (
+  IN HII_DATABASE_PRIVATE_DATA       *Private,
+  IN HII_GLOBAL_FONT_INFO            *GlobalFont,
+  IN CHAR16                          Char
+  )
+{
+  LIST_ENTRY                         *Bucket;
+  LIST_ENTRY                         *Link;
+  HII_GLYPH_CACHE_ENTRY              *Entry;
+
+  Bucket = &Private->GlyphCacheBuckets[Char % HII_GLYPH_CACHE_BUCKETS];
+  for (Link = Bucket->ForwardLink; Link != Bucket; Link = Link->ForwardLink) {
+    Entry = CR (Link, HII_GLYPH_CACHE_ENTRY, HashEntry, HII_GLYPH_CACHE_ENTRY_SIGNATURE);
+    if (Entry->Char == Char && Entry->GlobalFont == GlobalFont) {
+      RemoveEntryList (&Entry->LruEntry);
+      InsertHeadList (&Private->GlyphCacheLru, &Entry->LruEntry);
+      return Entry;
+    }
+  }
+
+  return NULL;
+}
+
+/**
+  Add the result of a glyph search to the glyph cache. The least recently used
+  entry is evicted when the cache is full. Nothing is cached if memory runs out.
+
+  This is a internal function.
+
+  @param  Private                 HII database driver private data.
+  @param  GlobalFont              The font, or NULL for the simple fonts.
+  @param  Char                    The character searched for.
+  @param  Status                  EFI_SUCCESS or EFI_NOT_FOUND.
+  @param  GlyphBuffer             The bitmap data of the glyph.
+  @param  GlyphBufferLen          The length of GlyphBuffer.
+  @param  Cell                    The cell information of the glyph.
+  @param  Attributes              The glyph attributes.
+
+**/
+VOID
+AddGlyphCache (
+  IN HII_DATABASE_PRIVATE_DATA       *Private,
+  IN HII_GLOBAL_FONT_INFO            *GlobalFont,
+  IN CHAR16                          Char,
+  IN EFI_STATUS                      Status,
+  IN UINT8                           *GlyphBuffer,
+  IN UINTN                           GlyphBufferLen,
+  IN EFI_HII_GLYPH_INFO              *Cell,
+  IN UINT8                           Attributes
+  )
+{
+  HII_GLYPH_CACHE_ENTRY              *Entry;
+
+  if (Private->GlyphCacheCount >= HII_GLYPH_CACHE_MAX_ENTRIES) {
+    RemoveGlyphCacheEntry (
+      Private,
+      CR (Private->GlyphCacheLru.BackLink, HII_GLYPH_CACHE_ENTRY, LruEntry, HII_GLYPH_CACHE_ENTRY_SIGNATURE)
+      );
+  }
+
+  Entry = AllocatePool (sizeof (HII_GLYPH_CACHE_ENTRY) + GlyphBufferLen);
+  if (Entry == NULL) {
+    return;
+  }
+
+  Entry->Signature      = HII_GLYPH_CACHE_ENTRY_SIGNATURE;
+  Entry->GlobalFont     = GlobalFont;
+  Entry->Char           = Char;
+  Entry->Status         = Status;
+  Entry->Attributes     = Attributes;
+  Entry->GlyphBufferLen = GlyphBufferLen;
+  Entry->GlyphBuffer    = (UINT8 *) (Entry + 1);
+  CopyMem (&Entry->Cell, Cell, sizeof (EFI_HII_GLYPH_INFO));
+  if (GlyphBufferLen > 0) {
+    CopyMem (Entry->GlyphBuffer, GlyphBuffer, GlyphBufferLen);
+  }
+
+  InsertHeadList (&Private->GlyphCacheBuckets[Char % HII_GLYPH_CACHE_BUCKETS], &Entry->HashEntry);
+  InsertHeadList (&Private->GlyphCacheLru, &Entry->LruEntry);
+  Private->GlyphCacheCount++;
+}
+
+/**
+  Convert the glyph for a single character into a bitmap.
+
+  This is a internal function.
+
+  @param  Private                 HII database driver private data.
+  @param  Char                    Character to retrieve.
+  @param  StringInfo              Points to the string font and color information
+                                  or NULL  if the string should use the default
+                                  system font and color.
+  @param  GlyphBuffer             Buffer to store the retrieved bitmap data.
+  @param  Cell                    Points to EFI_HII_GLYPH_INFO structure.
+  @param  Attributes              If not NULL, output the glyph attributes if any.
+
+  @retval EFI_SUCCESS             Glyph bitmap outputted.
+  @retval EFI_OUT_OF_RESOURCES    Unable to allocate the output buffer GlyphBuffer.
+  @retval EFI_NOT_FOUND           The glyph was unknown can not be found.
+  @retval EFI_INVALID_PARAMETER   Any input parameter is invalid.
+
+**/
+EFI_STATUS
+GetGlyphBuffer (
+  IN  HII_DATABASE_PRIVATE_DATA      *Private,
+  IN  CHAR16                         Char,
+  IN  EFI_FONT_INFO                  *StringInfo,
+  OUT UINT8                          **GlyphBuffer,
+  OUT EFI_HII_GLYPH_INFO             *Cell,
+  OUT UINT8                          *Attributes OPTIONAL
+  )
+{
+  EFI_STATUS                         Status;
+  HII_GLOBAL_FONT_INFO               *GlobalFont;
+  HII_GLYPH_CACHE_ENTRY              *Entry;
+  UINT8                              GlyphAttributes;
+  UINTN                              GlyphBufferLen;
+
   if (GlyphBuffer == NULL || Cell == NULL) {
     return EFI_INVALID_PARAMETER;
   }
@@ -187,72 +414,61 @@ GetGlyphBuffer (
   // If NULL, try to find the character in simplified font packages since
   // default system font is the fixed font (narrow or wide glyph).
   //
+  GlobalFont = NULL;
   if (StringInfo != NULL) {
     if(!IsFontInfoExisted (Private, StringInfo, NULL, NULL, &GlobalFont)) {
       return EFI_INVALID_PARAMETER;
     }
-    if (Attributes != NULL) {
-      *Attributes = PROPORTIONAL_GLYPH;
-    }
-    return FindGlyphBlock (GlobalFont->FontPackage, Char, GlyphBuffer, Cell, NULL);
-  } else {
-    HeaderSize = sizeof (EFI_HII_SIMPLE_FONT_PACKAGE_HDR);
-
-    for (Link = Private->DatabaseList.ForwardLink; Link != &Private->DatabaseList; Link = Link->ForwardLink) {
-      Node = CR (Link, HII_DATABASE_RECORD, DatabaseEntry, HII_DATABASE_RECORD_SIGNATURE);
-      for (Link1 = Node->PackageList->SimpleFontPkgHdr.ForwardLink;
-           Link1 != &Node->PackageList->SimpleFontPkgHdr;
-           Link1 = Link1->ForwardLink
-          ) {
-        SimpleFont = CR (Link1, HII_SIMPLE_FONT_PACKAGE_INSTANCE, SimpleFontEntry, HII_S_FONT_PACKAGE_SIGNATURE);
-        //
-        // Search the narrow glyph array
-        //
-        NarrowPtr = (EFI_NARROW_GLYPH *) ((UINT8 *) (SimpleFont->SimpleFontPkgHdr) + HeaderSize);
-        for (Index = 0; Index < SimpleFont->SimpleFontPkgHdr->NumberOfNarrowGlyphs; Index++) {
-          CopyMem (&Narrow, NarrowPtr + Index,sizeof (EFI_NARROW_GLYPH));
-          if (Narrow.UnicodeWeight == Char) {
-            *GlyphBuffer = (UINT8 *) AllocateZeroPool (EFI_GLYPH_HEIGHT);
-            if (*GlyphBuffer == NULL) {
-              return EFI_OUT_OF_RESOURCES;
-            }
-            Cell->Width    = EFI_GLYPH_WIDTH;
-            Cell->Height   = EFI_GLYPH_HEIGHT;
-            Cell->AdvanceX = Cell->Width;
-            CopyMem (*GlyphBuffer, Narrow.GlyphCol1, Cell->Height);
-            if (Attributes != NULL) {
-              *Attributes = (UINT8) (Narrow.Attributes | NARROW_GLYPH);
-            }
-            return EFI_SUCCESS;
-          }
-        }
-        //
-        // Search the wide glyph array
-        //
-        WidePtr = (EFI_WIDE_GLYPH *) (NarrowPtr + SimpleFont->SimpleFontPkgHdr->NumberOfNarrowGlyphs);
-        for (Index = 0; Index < SimpleFont->SimpleFontPkgHdr->NumberOfWideGlyphs; Index++) {
-          CopyMem (&Wide, WidePtr + Index, sizeof (EFI_WIDE_GLYPH));
-          if (Wide.UnicodeWeight == Char) {
-            *GlyphBuffer    = (UINT8 *) AllocateZeroPool (EFI_GLYPH_HEIGHT * 2);
-            if (*GlyphBuffer == NULL) {
-              return EFI_OUT_OF_RESOURCES;
-            }
-            Cell->Width    = EFI_GLYPH_WIDTH * 2;
-            Cell->Height   = EFI_GLYPH_HEIGHT;
-            Cell->AdvanceX = Cell->Width;
-            CopyMem (*GlyphBuffer, Wide.GlyphCol1, EFI_GLYPH_HEIGHT);
-            CopyMem (*GlyphBuffer + EFI_GLYPH_HEIGHT, Wide.GlyphCol2, EFI_GLYPH_HEIGHT);
-            if (Attributes != NULL) {
-              *Attributes = (UINT8) (Wide.Attributes | EFI_GLYPH_WIDE);
-            }
-            return EFI_SUCCESS;
-          }
+  }
+
+  //
+  // The same strings are drawn again and again, for instance by the setup
+  // browser, so the outcome of the search below is cached per font and character.
+  //
+  Entry = LookupGlyphCache (Private, GlobalFont, Char);
+  if (Entry != NULL) {
+    if (Entry->Status == EFI_SUCCESS) {
+      if (Entry->GlyphBufferLen > 0) {
+        *GlyphBuffer = (UINT8 *) AllocateCopyPool (Entry->GlyphBufferLen, Entry->GlyphBuffer);
+        if (*GlyphBuffer == NULL) {
+          return EFI_OUT_OF_RESOURCES;
         }
       }
+      CopyMem (Cell, &Entry->Cell, sizeof (EFI_HII_GLYPH_INFO));
+    }
+    if (Attributes != NULL && (GlobalFont != NULL || Entry->Status == EFI_SUCCESS)) {
+      *Attributes = Entry->Attributes;
     }
+    return Entry->Status;
   }
 
-  return EFI_NOT_FOUND;
+  GlyphAttributes = 0;
+  GlyphBufferLen  = 0;
+  if (GlobalFont != NULL) {
+    GlyphAttributes = PROPORTIONAL_GLYPH;
+    Status = FindGlyphBlock (GlobalFont->FontPackage, Char, GlyphBuffer, Cell, &GlyphBufferLen);
+  } else {
+    Status = FindSimpleFontGlyph (Private, Char, GlyphBuffer, Cell, &GlyphAttributes, &GlyphBufferLen);
+  }
+
+  if (Status == EFI_SUCCESS || Status == EFI_NOT_FOUND) {
+    AddGlyphCache (
+      Private,
+      GlobalFont,
+      Char,
+      Status,
+      (GlyphBufferLen > 0) ? *GlyphBuffer : NULL,
+      GlyphBufferLen,
+      Cell,
+      GlyphAttributes
+      );
+  }
+
+  if (Attributes != NULL && (GlobalFont != NULL || !EFI_ERROR (Status))) {
+    *Attributes = GlyphAttributes;
+  }
+
+  return Status;
 }
 
 /**
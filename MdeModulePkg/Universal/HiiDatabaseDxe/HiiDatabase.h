@@ -91,6 +91,14 @@ typedef struct {
   BOOLEAN             IsBitVar;
 } IFR_BLOCK_DATA;
 
+//
+// The <Number> of an "&OFFSET=<Number>" in a <ConfigAltResp> string.
+//
+typedef struct {
+  EFI_STRING          Number;
+  UINTN               Length;            // Length of the <Number>, in characters
+} IFR_BLOCK_OFFSET;
+
 //
 // Get default value from IFR data.
 //
@@ -151,6 +159,20 @@ typedef struct {
 //
 // String Package definitions
 //
+
+//
+// Location of the text of one string id in the string blocks, as found by
+// FindStringBlock(). BlockOffset is HII_STRING_INDEX_NONE for the ids that
+// have to be looked up by parsing the string blocks.
+//
+#define HII_STRING_INDEX_NONE           MAX_UINT32
+#define HII_STRING_INDEX_DUPLICATE      (MAX_UINT32 - 1)
+
+typedef struct {
+  UINT32                                BlockOffset;
+  UINT32                                TextOffset;
+} HII_STRING_INDEX_ENTRY;
+
 #define HII_STRING_PACKAGE_SIGNATURE    SIGNATURE_32 ('h','i','s','p')
 typedef struct _HII_STRING_PACKAGE_INSTANCE {
   UINTN                                 Signature;
@@ -160,6 +182,9 @@ typedef struct _HII_STRING_PACKAGE_INSTANCE {
   LIST_ENTRY                            FontInfoList;  // local font info list
   UINT8                                 FontId;
   EFI_STRING_ID                         MaxStringId;   // record StringId
+  HII_STRING_INDEX_ENTRY                *StringIndex;  // built on first lookup
+  EFI_STRING_ID                         StringIndexCount;
+  BOOLEAN                               StringIndexFailed;
 } HII_STRING_PACKAGE_INSTANCE;
 
 //
@@ -222,6 +247,27 @@ typedef struct _HII_GLOBAL_FONT_INFO {
   EFI_FONT_INFO                         *FontInfo;
 } HII_GLOBAL_FONT_INFO;
 
+//
+// Glyph cache definitions. GetGlyphBuffer() keeps the result of its font package
+// search for the most recently used characters, hashed by character.
+//
+#define HII_GLYPH_CACHE_BUCKETS         64
+#define HII_GLYPH_CACHE_MAX_ENTRIES     512
+
+#define HII_GLYPH_CACHE_ENTRY_SIGNATURE SIGNATURE_32 ('h','g','c','e')
+typedef struct _HII_GLYPH_CACHE_ENTRY {
+  UINTN                                 Signature;
+  LIST_ENTRY                            HashEntry;
+  LIST_ENTRY                            LruEntry;
+  HII_GLOBAL_FONT_INFO                  *GlobalFont;   // NULL for the simple fonts
+  CHAR16                                Char;
+  EFI_STATUS                            Status;        // EFI_SUCCESS or EFI_NOT_FOUND
+  EFI_HII_GLYPH_INFO                    Cell;
+  UINT8                                 Attributes;
+  UINTN                                 GlyphBufferLen;
+  UINT8                                 *GlyphBuffer;  // follows the entry
+} HII_GLYPH_CACHE_ENTRY;
+
 //
 // Image Package definitions
 //
@@ -321,6 +367,9 @@ typedef struct _HII_DATABASE_PRIVATE_DATA {
   UINTN                                 Attribute;     // default system color
   EFI_GUID                              CurrentLayoutGuid;
   EFI_HII_KEYBOARD_LAYOUT               *CurrentLayout;
+  LIST_ENTRY                            GlyphCacheBuckets[HII_GLYPH_CACHE_BUCKETS];
+  LIST_ENTRY                            GlyphCacheLru; // most recently used first
+  UINTN                                 GlyphCacheCount;
 } HII_DATABASE_PRIVATE_DATA;
 
 #define HII_FONT_DATABASE_PRIVATE_DATA_FROM_THIS(a) \
@@ -501,6 +550,20 @@ GetSystemFont (
   );
 
 
+/**
+  Discard the string id index of a string package. It must be called whenever
+  the string blocks of the package are changed.
+
+  This is a internal function.
+
+  @param  StringPackage           Hii string package instance.
+
+**/
+VOID
+InvalidateStringIndex (
+  IN HII_STRING_PACKAGE_INSTANCE      *StringPackage
+  );
+
 /**
   Parse all string blocks to find a String block specified by StringId.
   If StringId = (EFI_STRING_ID) (-1), find out all EFI_HII_SIBT_FONT blocks
@@ -570,6 +633,20 @@ FindGlyphBlock (
   OUT UINTN                          *GlyphBufferLen OPTIONAL
   );
 
+/**
+  Remove all entries from the glyph cache. It must be called whenever a font
+  or simple font package is added to or removed from the database.
+
+  This is a internal function.
+
+  @param  Private                 HII database driver private data.
+
+**/
+VOID
+FlushGlyphCache (
+  IN HII_DATABASE_PRIVATE_DATA       *Private
+  );
+
 /**
   This function exports Form packages to a buffer.
   This is a internal function.
@@ -171,6 +171,7 @@ InitializeHiiDatabase (
   EFI_STATUS                             Status;
   EFI_HANDLE                             Handle;
   EFI_EVENT                              ReadyToBootEvent;
+  UINTN                                  Index;
 
   //
   // There will be only one HII Database in the system
@@ -188,6 +189,10 @@ InitializeHiiDatabase (
   InitializeListHead (&mPrivate.DatabaseNotifyList);
   InitializeListHead (&mPrivate.HiiHandleList);
   InitializeListHead (&mPrivate.FontInfoList);
+  InitializeListHead (&mPrivate.GlyphCacheLru);
+  for (Index = 0; Index < HII_GLYPH_CACHE_BUCKETS; Index++) {
+    InitializeListHead (&mPrivate.GlyphCacheBuckets[Index]);
+  }
 
   //
   // Create a event with EFI_HII_SET_KEYBOARD_LAYOUT_EVENT_GUID group type.
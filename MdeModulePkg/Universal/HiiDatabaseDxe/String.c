@@ -227,6 +227,317 @@ GetStringFontInfo (
 }
 
 
+/**
+  Discard the string id index of a string package. It must be called whenever
+  the string blocks of the package are changed.
+
+  This is a internal function.
+
+  @param  StringPackage           Hii string package instance.
+
+**/
+VOID
+InvalidateStringIndex (
+  IN HII_STRING_PACKAGE_INSTANCE      *StringPackage
+  )
+{
+  if (StringPackage->StringIndex != NULL) {
+    FreePool (StringPackage->StringIndex);
+    StringPackage->StringIndex = NULL;
+  }
+  StringPackage->StringIndexCount  = 0;
+  StringPackage->StringIndexFailed = FALSE;
+}
+
+/**
+  Record the location of the text of one string id in the string id index.
+
+  This is a internal function.
+
+  @param  StringPackage           Hii string package instance.
+  @param  StringId                The string id.
+  @param  BlockOffset             The offset of the string block that holds the
+                                  string, or HII_STRING_INDEX_DUPLICATE.
+  @param  TextOffset              The offset of the string text from the block,
+                                  or the id duplicated by an EFI_HII_SIBT_DUPLICATE
+                                  block.
+
+  @retval TRUE                    The location is recorded.
+  @retval FALSE                   StringId is outside of the index.
+
+**/
+BOOLEAN
+SetStringIndexEntry (
+  IN HII_STRING_PACKAGE_INSTANCE      *StringPackage,
+  IN EFI_STRING_ID                    StringId,
+  IN UINTN                            BlockOffset,
+  IN UINTN                            TextOffset
+  )
+{
+  if (StringId == 0 || StringId > StringPackage->StringIndexCount) {
+    return FALSE;
+  }
+
+  StringPackage->StringIndex[StringId - 1].BlockOffset = (UINT32) BlockOffset;
+  StringPackage->StringIndex[StringId - 1].TextOffset  = (UINT32) TextOffset;
+  return TRUE;
+}
+
+/**
+  Build the string id index of a string package with one pass over its string
+  blocks. The index gives the block and text offsets that FindStringBlock()
+  finds for every string id that refers to a string. Ids in skip blocks are
+  left to the full parse.
+
+  This is a internal function.
+
+  @param  StringPackage           Hii string package instance.
+
+  @retval EFI_SUCCESS             The index is built.
+  @retval EFI_OUT_OF_RESOURCES    The index could not be allocated.
+  @retval EFI_UNSUPPORTED         The string blocks could not be indexed.
+
+**/
+EFI_STATUS
+BuildStringIndex (
+  IN HII_STRING_PACKAGE_INSTANCE      *StringPackage
+  )
+{
+  UINT8                                *BlockHdr;
+  UINT8                                *StringTextPtr;
+  UINTN                                BlockOffset;
+  UINTN                                BlockSize;
+  UINTN                                Offset;
+  UINTN                                StringSize;
+  UINTN                                Index;
+  UINTN                                Depth;
+  EFI_STRING_ID                        CurrentStringId;
+  EFI_STRING_ID                        Target;
+  UINT16                               StringCount;
+  UINT16                               SkipCount;
+  UINT8                                Length8;
+  UINT32                               Length32;
+  EFI_HII_SIBT_EXT2_BLOCK              Ext2;
+  HII_STRING_INDEX_ENTRY               *Entry;
+
+  StringPackage->StringIndexCount = StringPackage->MaxStringId;
+  if (StringPackage->StringIndexCount == 0) {
+    return EFI_UNSUPPORTED;
+  }
+
+  StringPackage->StringIndex = AllocatePool (StringPackage->StringIndexCount * sizeof (HII_STRING_INDEX_ENTRY));
+  if (StringPackage->StringIndex == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+  SetMem (
+    StringPackage->StringIndex,
+    StringPackage->StringIndexCount * sizeof (HII_STRING_INDEX_ENTRY),
+    0xFF
+    );
+
+  CurrentStringId = 1;
+  BlockOffset     = 0;
+  BlockHdr        = StringPackage->StringBlock;
+  while (*BlockHdr != EFI_HII_SIBT_END) {
+    BlockSize = 0;
+    switch (*BlockHdr) {
+    case EFI_HII_SIBT_STRING_SCSU:
+    case EFI_HII_SIBT_STRING_SCSU_FONT:
+      if (*BlockHdr == EFI_HII_SIBT_STRING_SCSU) {
+        Offset = sizeof (EFI_HII_STRING_BLOCK);
+      } else {
+        Offset = sizeof (EFI_HII_SIBT_STRING_SCSU_FONT_BLOCK) - sizeof (UINT8);
+      }
+      if (!SetStringIndexEntry (StringPackage, CurrentStringId, BlockOffset, Offset)) {
+        return EFI_UNSUPPORTED;
+      }
+      BlockSize = Offset + AsciiStrSize ((CHAR8 *) (BlockHdr + Offset));
+      CurrentStringId++;
+      break;
+
+    case EFI_HII_SIBT_STRINGS_SCSU:
+    case EFI_HII_SIBT_STRINGS_SCSU_FONT:
+      if (*BlockHdr == EFI_HII_SIBT_STRINGS_SCSU) {
+        CopyMem (&StringCount, BlockHdr + sizeof (EFI_HII_STRING_BLOCK), sizeof (UINT16));
+        StringTextPtr = BlockHdr + sizeof (EFI_HII_SIBT_STRINGS_SCSU_BLOCK) - sizeof (UINT8);
+      } else {
+        CopyMem (&StringCount, BlockHdr + sizeof (EFI_HII_STRING_BLOCK) + sizeof (UINT8), sizeof (UINT16));
+        StringTextPtr = BlockHdr + sizeof (EFI_HII_SIBT_STRINGS_SCSU_FONT_BLOCK) - sizeof (UINT8);
+      }
+      for (Index = 0; Index < StringCount; Index++) {
+        if (!SetStringIndexEntry (StringPackage, CurrentStringId, BlockOffset, StringTextPtr - BlockHdr)) {
+          return EFI_UNSUPPORTED;
+        }
+        StringTextPtr += AsciiStrSize ((CHAR8 *) StringTextPtr);
+        CurrentStringId++;
+      }
+      BlockSize = StringTextPtr - BlockHdr;
+      break;
+
+    case EFI_HII_SIBT_STRING_UCS2:
+    case EFI_HII_SIBT_STRING_UCS2_FONT:
+      if (*BlockHdr == EFI_HII_SIBT_STRING_UCS2) {
+        Offset = sizeof (EFI_HII_STRING_BLOCK);
+      } else {
+        Offset = sizeof (EFI_HII_SIBT_STRING_UCS2_FONT_BLOCK) - sizeof (CHAR16);
+      }
+      if (!SetStringIndexEntry (StringPackage, CurrentStringId, BlockOffset, Offset)) {
+        return EFI_UNSUPPORTED;
+      }
+      GetUnicodeStringTextOrSize (NULL, BlockHdr + Offset, &StringSize);
+      BlockSize = Offset + StringSize;
+      CurrentStringId++;
+      break;
+
+    case EFI_HII_SIBT_STRINGS_UCS2:
+    case EFI_HII_SIBT_STRINGS_UCS2_FONT:
+      if (*BlockHdr == EFI_HII_SIBT_STRINGS_UCS2) {
+        CopyMem (&StringCount, BlockHdr + sizeof (EFI_HII_STRING_BLOCK), sizeof (UINT16));
+        StringTextPtr = BlockHdr + sizeof (EFI_HII_SIBT_STRINGS_UCS2_BLOCK) - sizeof (CHAR16);
+      } else {
+        CopyMem (&StringCount, BlockHdr + sizeof (EFI_HII_STRING_BLOCK) + sizeof (UINT8), sizeof (UINT16));
+        StringTextPtr = BlockHdr + sizeof (EFI_HII_SIBT_STRINGS_UCS2_FONT_BLOCK) - sizeof (CHAR16);
+      }
+      for (Index = 0; Index < StringCount; Index++) {
+        if (!SetStringIndexEntry (StringPackage, CurrentStringId, BlockOffset, StringTextPtr - BlockHdr)) {
+          return EFI_UNSUPPORTED;
+        }
+        GetUnicodeStringTextOrSize (NULL, StringTextPtr, &StringSize);
+        StringTextPtr += StringSize;
+        CurrentStringId++;
+      }
+      BlockSize = StringTextPtr - BlockHdr;
+      break;
+
+    case EFI_HII_SIBT_DUPLICATE:
+      CopyMem (&Target, BlockHdr + sizeof (EFI_HII_STRING_BLOCK), sizeof (EFI_STRING_ID));
+      if (!SetStringIndexEntry (StringPackage, CurrentStringId, HII_STRING_INDEX_DUPLICATE, Target)) {
+        return EFI_UNSUPPORTED;
+      }
+      BlockSize = sizeof (EFI_HII_SIBT_DUPLICATE_BLOCK);
+      CurrentStringId++;
+      break;
+
+    case EFI_HII_SIBT_SKIP1:
+      SkipCount       = (UINT16) (*(BlockHdr + sizeof (EFI_HII_STRING_BLOCK)));
+      CurrentStringId = (UINT16) (CurrentStringId + SkipCount);
+      BlockSize       = sizeof (EFI_HII_SIBT_SKIP1_BLOCK);
+      break;
+
+    case EFI_HII_SIBT_SKIP2:
+      CopyMem (&SkipCount, BlockHdr + sizeof (EFI_HII_STRING_BLOCK), sizeof (UINT16));
+      CurrentStringId = (UINT16) (CurrentStringId + SkipCount);
+      BlockSize       = sizeof (EFI_HII_SIBT_SKIP2_BLOCK);
+      break;
+
+    case EFI_HII_SIBT_EXT1:
+      CopyMem (&Length8, BlockHdr + sizeof (EFI_HII_STRING_BLOCK) + sizeof (UINT8), sizeof (UINT8));
+      BlockSize = Length8;
+      break;
+
+    case EFI_HII_SIBT_EXT2:
+      CopyMem (&Ext2, BlockHdr, sizeof (EFI_HII_SIBT_EXT2_BLOCK));
+      BlockSize = Ext2.Length;
+      break;
+
+    case EFI_HII_SIBT_EXT4:
+      CopyMem (&Length32, BlockHdr + sizeof (EFI_HII_STRING_BLOCK) + sizeof (UINT8), sizeof (UINT32));
+      BlockSize = Length32;
+      break;
+
+    default:
+      break;
+    }
+
+    if (BlockSize == 0) {
+      return EFI_UNSUPPORTED;
+    }
+    BlockOffset += BlockSize;
+    BlockHdr     = StringPackage->StringBlock + BlockOffset;
+  }
+
+  //
+  // A duplicate string id is looked up as the id it duplicates.
+  //
+  for (Index = 0; Index < StringPackage->StringIndexCount; Index++) {
+    Entry = &StringPackage->StringIndex[Index];
+    for (Depth = 0; Entry->BlockOffset == HII_STRING_INDEX_DUPLICATE && Depth < StringPackage->StringIndexCount; Depth++) {
+      Target = (EFI_STRING_ID) Entry->TextOffset;
+      if (Target == 0 || Target > StringPackage->StringIndexCount) {
+        break;
+      }
+      Entry = &StringPackage->StringIndex[Target - 1];
+    }
+    if (Entry->BlockOffset == HII_STRING_INDEX_DUPLICATE) {
+      Entry = NULL;
+    }
+    if (Entry != &StringPackage->StringIndex[Index]) {
+      if (Entry == NULL || Entry->BlockOffset == HII_STRING_INDEX_NONE) {
+        StringPackage->StringIndex[Index].BlockOffset = HII_STRING_INDEX_NONE;
+      } else {
+        CopyMem (&StringPackage->StringIndex[Index], Entry, sizeof (HII_STRING_INDEX_ENTRY));
+      }
+    }
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Look up a string id in the string id index of a string package, building the
+  index first if needed.
+
+  This is a internal function.
+
+  @param  StringPackage           Hii string package instance.
+  @param  StringId                The string's id, which is unique within
+                                  PackageList.
+  @param  BlockType               Output the block type of found string block.
+  @param  StringBlockAddr         Output the block address of found string block.
+  @param  StringTextOffset        Offset, relative to the found block address, of
+                                  the  string text information.
+
+  @retval TRUE                    The string is found through the index.
+  @retval FALSE                   The string blocks have to be parsed.
+
+**/
+BOOLEAN
+LookupStringIndex (
+  IN  HII_STRING_PACKAGE_INSTANCE     *StringPackage,
+  IN  EFI_STRING_ID                   StringId,
+  OUT UINT8                           *BlockType,
+  OUT UINT8                           **StringBlockAddr,
+  OUT UINTN                           *StringTextOffset
+  )
+{
+  HII_STRING_INDEX_ENTRY              *Entry;
+
+  if (StringPackage->StringIndex == NULL) {
+    if (StringPackage->StringIndexFailed) {
+      return FALSE;
+    }
+    if (EFI_ERROR (BuildStringIndex (StringPackage))) {
+      InvalidateStringIndex (StringPackage);
+      StringPackage->StringIndexFailed = TRUE;
+      return FALSE;
+    }
+  }
+
+  if (StringId == 0 || StringId > StringPackage->StringIndexCount) {
+    return FALSE;
+  }
+
+  Entry = &StringPackage->StringIndex[StringId - 1];
+  if (Entry->BlockOffset == HII_STRING_INDEX_NONE) {
+    return FALSE;
+  }
+
+  *StringBlockAddr  = StringPackage->StringBlock + Entry->BlockOffset;
+  *BlockType        = **StringBlockAddr;
+  *StringTextOffset = Entry->TextOffset;
+  return TRUE;
+}
+
 /**
   Parse all string blocks to find a String block specified by StringId.
   If StringId = (EFI_STRING_ID) (-1), find out all EFI_HII_SIBT_FONT blocks
@@ -297,6 +608,13 @@ FindStringBlock (
     if (StringId > StringPackage->MaxStringId) {
       return EFI_NOT_FOUND;
     }
+    //
+    // Callers that need the first id of the found block still parse the blocks.
+    //
+    if (StartStringId == NULL &&
+        LookupStringIndex (StringPackage, StringId, BlockType, StringBlockAddr, StringTextOffset)) {
+      return EFI_SUCCESS;
+    }
   } else {
     ASSERT (Private != NULL && Private->Signature == HII_DATABASE_PRIVATE_DATA_SIGNATURE);
     if (StringId == 0 && LastStringId != NULL) {
@@ -841,6 +1159,7 @@ InsertLackStringBlock (
   }
   FreePool (StringPackage->StringBlock);
   StringPackage->StringBlock = StringBlock;
+  InvalidateStringIndex (StringPackage);
   StringPackage->StringPkgHdr->Header.Length += NewBlockSize - OldBlockSize;
 
   return EFI_SUCCESS;
@@ -1009,6 +1328,7 @@ SetStringWorker (
     ZeroMem (StringPackage->StringBlock, OldBlockSize);
     FreePool (StringPackage->StringBlock);
     StringPackage->StringBlock = Block;
+    InvalidateStringIndex (StringPackage);
     StringPackage->StringPkgHdr->Header.Length += (UINT32) (BlockSize - OldBlockSize);
     break;
 
@@ -1043,6 +1363,7 @@ SetStringWorker (
     ZeroMem (StringPackage->StringBlock, OldBlockSize);
     FreePool (StringPackage->StringBlock);
     StringPackage->StringBlock = Block;
+    InvalidateStringIndex (StringPackage);
     StringPackage->StringPkgHdr->Header.Length += (UINT32) (BlockSize - OldBlockSize);
     break;
 
@@ -1095,6 +1416,7 @@ SetStringWorker (
   ZeroMem (StringPackage->StringBlock, OldBlockSize);
   FreePool (StringPackage->StringBlock);
   StringPackage->StringBlock = Block;
+  InvalidateStringIndex (StringPackage);
   StringPackage->StringPkgHdr->Header.Length += Ext2.Length;
 
   return EFI_SUCCESS;
@@ -1281,6 +1603,7 @@ HiiNewString (
       ZeroMem (StringPackage->StringBlock, OldBlockSize);
       FreePool (StringPackage->StringBlock);
       StringPackage->StringBlock = StringBlock;
+      InvalidateStringIndex (StringPackage);
       StringPackage->StringPkgHdr->Header.Length += Ucs2BlockSize;
       PackageListNode->PackageListHdr.PackageLength += Ucs2BlockSize;
     }
@@ -1413,6 +1736,7 @@ HiiNewString (
     ZeroMem (StringPackage->StringBlock, OldBlockSize);
     FreePool (StringPackage->StringBlock);
     StringPackage->StringBlock = StringBlock;
+    InvalidateStringIndex (StringPackage);
     StringPackage->StringPkgHdr->Header.Length += Ucs2BlockSize;
     PackageListNode->PackageListHdr.PackageLength += Ucs2BlockSize;
 
@@ -1456,6 +1780,7 @@ HiiNewString (
       ZeroMem (StringPackage->StringBlock, OldBlockSize);
       FreePool (StringPackage->StringBlock);
       StringPackage->StringBlock = StringBlock;
+      InvalidateStringIndex (StringPackage);
       StringPackage->StringPkgHdr->Header.Length += Ucs2FontBlockSize;
       PackageListNode->PackageListHdr.PackageLength += Ucs2FontBlockSize;
 
@@ -1518,6 +1843,7 @@ HiiNewString (
       ZeroMem (StringPackage->StringBlock, OldBlockSize);
       FreePool (StringPackage->StringBlock);
       StringPackage->StringBlock = StringBlock;
+      InvalidateStringIndex (StringPackage);
       StringPackage->StringPkgHdr->Header.Length += FontBlockSize + Ucs2FontBlockSize;
       PackageListNode->PackageListHdr.PackageLength += FontBlockSize + Ucs2FontBlockSize;
 
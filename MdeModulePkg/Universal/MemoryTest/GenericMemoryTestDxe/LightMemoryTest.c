@@ -376,10 +376,8 @@ VerifyMemory (
 {
   EFI_PHYSICAL_ADDRESS            Address;
   INTN                            ErrorFound;
-  EFI_MEMORY_EXTENDED_ERROR_DATA  *ExtendedErrorData;
 
   Address           = Start;
-  ExtendedErrorData = NULL;
 
   //
   // Add 4G memory address check for IA32 platform
@@ -404,33 +402,217 @@ VerifyMemory (
       //
       // Report uncorrectable errors
       //
-      ExtendedErrorData = AllocateZeroPool (sizeof (EFI_MEMORY_EXTENDED_ERROR_DATA));
-      if (ExtendedErrorData == NULL) {
-        return EFI_OUT_OF_RESOURCES;
-      }
+      return ReportMemoryError (Address);
+    }
 
-      ExtendedErrorData->DataHeader.HeaderSize  = (UINT16) sizeof (EFI_STATUS_CODE_DATA);
-      ExtendedErrorData->DataHeader.Size        = (UINT16) (sizeof (EFI_MEMORY_EXTENDED_ERROR_DATA) - sizeof (EFI_STATUS_CODE_DATA));
-      ExtendedErrorData->Granularity            = EFI_MEMORY_ERROR_DEVICE;
-      ExtendedErrorData->Operation              = EFI_MEMORY_OPERATION_READ;
-      ExtendedErrorData->Syndrome               = 0x0;
-      ExtendedErrorData->Address                = Address;
-      ExtendedErrorData->Resolution             = 0x40;
+    Address += Private->CoverageSpan;
+  }
 
-      REPORT_STATUS_CODE_EX (
-          EFI_ERROR_CODE,
-          EFI_COMPUTING_UNIT_MEMORY | EFI_CU_MEMORY_EC_UNCORRECTABLE,
-          0,
-          &gEfiGenericMemTestProtocolGuid,
-          NULL,
-          (UINT8 *) ExtendedErrorData + sizeof (EFI_STATUS_CODE_DATA),
-          ExtendedErrorData->DataHeader.Size
-          );
+  return EFI_SUCCESS;
+}
+
+/**
+  Report an uncorrectable error found by the memory test.
+
+  @param[in] Address  The address of the mis-compare.
+
+  @retval EFI_DEVICE_ERROR     The error is reported.
+  @retval EFI_OUT_OF_RESOURCES Could not allocate the extended error data.
+
+**/
+EFI_STATUS
+ReportMemoryError (
+  IN  EFI_PHYSICAL_ADDRESS         Address
+  )
+{
+  EFI_MEMORY_EXTENDED_ERROR_DATA  *ExtendedErrorData;
+
+  ExtendedErrorData = AllocateZeroPool (sizeof (EFI_MEMORY_EXTENDED_ERROR_DATA));
+  if (ExtendedErrorData == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  ExtendedErrorData->DataHeader.HeaderSize  = (UINT16) sizeof (EFI_STATUS_CODE_DATA);
+  ExtendedErrorData->DataHeader.Size        = (UINT16) (sizeof (EFI_MEMORY_EXTENDED_ERROR_DATA) - sizeof (EFI_STATUS_CODE_DATA));
+  ExtendedErrorData->Granularity            = EFI_MEMORY_ERROR_DEVICE;
+  ExtendedErrorData->Operation              = EFI_MEMORY_OPERATION_READ;
+  ExtendedErrorData->Syndrome               = 0x0;
+  ExtendedErrorData->Address                = Address;
+  ExtendedErrorData->Resolution             = 0x40;
+
+  REPORT_STATUS_CODE_EX (
+      EFI_ERROR_CODE,
+      EFI_COMPUTING_UNIT_MEMORY | EFI_CU_MEMORY_EC_UNCORRECTABLE,
+      0,
+      &gEfiGenericMemTestProtocolGuid,
+      NULL,
+      (UINT8 *) ExtendedErrorData + sizeof (EFI_STATUS_CODE_DATA),
+      ExtendedErrorData->DataHeader.Size
+      );
+
+  FreePool (ExtendedErrorData);
+  return EFI_DEVICE_ERROR;
+}
 
-      return EFI_DEVICE_ERROR;
+/**
+  Write the memory test pattern into a range of physical memory, write it back
+  to memory, and verify it. This function can run on APs.
+
+  @param[in]  Private       Point to generic memory test driver's private data.
+  @param[in]  Start         The memory range's start address.
+  @param[in]  Size          The memory range's size.
+  @param[out] ErrorAddress  The address of the first mis-compare.
+
+  @retval TRUE   The range of memory passed the test.
+  @retval FALSE  The range of memory has errors.
+
+**/
+BOOLEAN
+TestMemorySlice (
+  IN  GENERIC_MEMORY_TEST_PRIVATE  *Private,
+  IN  EFI_PHYSICAL_ADDRESS         Start,
+  IN  UINT64                       Size,
+  OUT EFI_PHYSICAL_ADDRESS         *ErrorAddress
+  )
+{
+  EFI_PHYSICAL_ADDRESS  Address;
+
+  //
+  // The CPU arch protocol cannot be used on APs, so write back each pattern
+  // by cache line instead of flushing the whole cache. That also evicts the
+  // pattern, so the verify pass reads it back from memory.
+  //
+  for (Address = Start; Address < (Start + Size); Address += Private->CoverageSpan) {
+    CopyMem ((VOID *) (UINTN) Address, Private->MonoPattern, Private->MonoTestSize);
+    WriteBackInvalidateDataCacheRange ((VOID *) (UINTN) Address, Private->MonoTestSize);
+  }
+
+  for (Address = Start; Address < (Start + Size); Address += Private->CoverageSpan) {
+    if (CompareMemWithoutCheckArgument (
+          (VOID *) (UINTN) Address,
+          Private->MonoPattern,
+          Private->MonoTestSize
+          ) != 0) {
+      *ErrorAddress = Address;
+      return FALSE;
     }
+  }
 
-    Address += Private->CoverageSpan;
+  return TRUE;
+}
+
+/**
+  Test the slices of a memory test job until there is none left, or an error
+  is found. This function runs on the BSP and on all the enabled APs.
+
+  @param[in] Buffer   The MEMORY_TEST_JOB.
+
+**/
+VOID
+EFIAPI
+MemoryTestSliceWorker (
+  IN  VOID                         *Buffer
+  )
+{
+  MEMORY_TEST_JOB       *Job;
+  UINT32                Slice;
+  EFI_PHYSICAL_ADDRESS  Start;
+  UINT64                Size;
+  EFI_PHYSICAL_ADDRESS  ErrorAddress;
+
+  Job = (MEMORY_TEST_JOB *) Buffer;
+
+  while (Job->ErrorAddress == MEMORY_TEST_NO_ERROR) {
+    Slice = InterlockedIncrement (&Job->NextSlice) - 1;
+    if (Slice >= Job->SliceCount) {
+      break;
+    }
+
+    Start = Job->Start + MultU64x32 (TEST_BLOCK_SIZE, Slice);
+    Size  = MIN (TEST_BLOCK_SIZE, Job->Start + Job->Length - Start);
+    if (!TestMemorySlice (Job->Private, Start, Size, &ErrorAddress)) {
+      InterlockedCompareExchange64 (&Job->ErrorAddress, MEMORY_TEST_NO_ERROR, ErrorAddress);
+    }
+  }
+}
+
+/**
+  Write and verify a range of the memory on all the enabled processors.
+
+  @param[in] Private  Point to generic memory test driver's private data.
+  @param[in] Start    The memory range's start address.
+  @param[in] Size     The memory range's size.
+
+  @retval EFI_SUCCESS Successful verify the range of memory, no errors' location found.
+  @retval Others      The range of memory have errors contained.
+
+**/
+EFI_STATUS
+ParallelRangeTest (
+  IN  GENERIC_MEMORY_TEST_PRIVATE  *Private,
+  IN  EFI_PHYSICAL_ADDRESS         Start,
+  IN  UINT64                       Size
+  )
+{
+  EFI_STATUS       Status;
+  EFI_EVENT        WaitEvent;
+  MEMORY_TEST_JOB  Job;
+
+  if ((Private->MpServices == NULL) || (Size <= TEST_BLOCK_SIZE)) {
+    WriteMemory (Private, Start, Size);
+    return VerifyMemory (Private, Start, Size);
+  }
+
+  //
+  // Add 4G memory address check for IA32 platform
+  // NOTE: Without page table, there is no way to use memory above 4G.
+  //
+  if (Start + Size > MAX_ADDRESS) {
+    return EFI_SUCCESS;
+  }
+
+  //
+  // TEST_BLOCK_SIZE is a multiple of every CoverageSpan, so the slices cover
+  // exactly the addresses a single pass over the range would.
+  //
+  Job.Private      = Private;
+  Job.Start        = Start;
+  Job.Length       = Size;
+  Job.SliceCount   = (UINT32) DivU64x32 (Size + TEST_BLOCK_SIZE - 1, TEST_BLOCK_SIZE);
+  Job.NextSlice    = 0;
+  Job.ErrorAddress = MEMORY_TEST_NO_ERROR;
+
+  //
+  // Start the APs in non-blocking mode, so that the BSP tests slices too. If
+  // the APs cannot be started, the BSP tests all the slices.
+  //
+  Status = gBS->CreateEvent (0, TPL_CALLBACK, NULL, NULL, &WaitEvent);
+  if (!EFI_ERROR (Status)) {
+    Status = Private->MpServices->StartupAllAPs (
+                                    Private->MpServices,
+                                    MemoryTestSliceWorker,
+                                    FALSE,
+                                    WaitEvent,
+                                    0,
+                                    &Job,
+                                    NULL
+                                    );
+    if (EFI_ERROR (Status)) {
+      gBS->CloseEvent (WaitEvent);
+    }
+  }
+
+  MemoryTestSliceWorker (&Job);
+
+  if (!EFI_ERROR (Status)) {
+    while (gBS->CheckEvent (WaitEvent) == EFI_NOT_READY) {
+      CpuPause ();
+    }
+    gBS->CloseEvent (WaitEvent);
+  }
+
+  if (Job.ErrorAddress != MEMORY_TEST_NO_ERROR) {
+    return ReportMemoryError (Job.ErrorAddress);
   }
 
   return EFI_SUCCESS;
@@ -458,6 +640,7 @@ InitializeMemoryTest (
   EFI_STATUS                  Status;
   GENERIC_MEMORY_TEST_PRIVATE *Private;
   EFI_CPU_ARCH_PROTOCOL       *Cpu;
+  UINTN                       NumberOfProcessors;
 
   Private             = GENERIC_MEMORY_TEST_PRIVATE_FROM_THIS (This);
   *RequireSoftECCInit = FALSE;
@@ -492,6 +675,30 @@ InitializeMemoryTest (
   if (!EFI_ERROR (Status)) {
     Private->Cpu = Cpu;
   }
+
+  //
+  // Test one TEST_BLOCK_SIZE slice on every enabled processor each time BDS
+  // asks for a block, when the MP services are available
+  //
+  Private->MpServices                = NULL;
+  Private->NumberOfEnabledProcessors = 1;
+  Status = gBS->LocateProtocol (
+                  &gEfiMpServiceProtocolGuid,
+                  NULL,
+                  (VOID **) &Private->MpServices
+                  );
+  if (!EFI_ERROR (Status)) {
+    Status = Private->MpServices->GetNumberOfProcessors (
+                                    Private->MpServices,
+                                    &NumberOfProcessors,
+                                    &Private->NumberOfEnabledProcessors
+                                    );
+  }
+  if (EFI_ERROR (Status) || (Private->NumberOfEnabledProcessors <= 1)) {
+    Private->MpServices                = NULL;
+    Private->NumberOfEnabledProcessors = 1;
+  }
+  Private->BdsBlockSize = MultU64x32 (TEST_BLOCK_SIZE, (UINT32) Private->NumberOfEnabledProcessors);
   //
   // Create the CoverageSpan of the memory test base on the coverage level
   //
@@ -608,9 +815,7 @@ GenPerformMemoryTest (
       // The software memory test (R/W/V) perform here. It will detect the
       // memory mis-compare error.
       //
-      WriteMemory (Private, mCurrentAddress, BlockBoundary);
-
-      Status = VerifyMemory (Private, mCurrentAddress, BlockBoundary);
+      Status = ParallelRangeTest (Private, mCurrentAddress, BlockBoundary);
       if (EFI_ERROR (Status)) {
         //
         // If perform here, means there is mis-compare error, and no agent can
@@ -833,6 +1038,8 @@ GENERIC_MEMORY_TEST_PRIVATE mGenericMemoryTestPrivate = {
   EFI_GENERIC_MEMORY_TEST_PRIVATE_SIGNATURE,
   NULL,
   NULL,
+  NULL,
+  1,
   {
     InitializeMemoryTest,
     GenPerformMemoryTest,
@@ -13,6 +13,7 @@
 #include <Guid/StatusCodeDataTypeId.h>
 #include <Protocol/GenericMemoryTest.h>
 #include <Protocol/Cpu.h>
+#include <Protocol/MpService.h>
 
 #include <Library/DebugLib.h>
 #include <Library/UefiDriverEntryPoint.h>
@@ -21,6 +22,8 @@
 #include <Library/ReportStatusCodeLib.h>
 #include <Library/BaseLib.h>
 #include <Library/BaseMemoryLib.h>
+#include <Library/CacheMaintenanceLib.h>
+#include <Library/SynchronizationLib.h>
 #include <Library/MemoryAllocationLib.h>
 #include <Library/UefiBootServicesTableLib.h>
 
@@ -82,6 +85,12 @@ typedef struct {
   //
   EFI_CPU_ARCH_PROTOCOL             *Cpu;
 
+  //
+  // MP services protocol's pointer, NULL if the test runs on the BSP only
+  //
+  EFI_MP_SERVICES_PROTOCOL          *MpServices;
+  UINTN                             NumberOfEnabledProcessors;
+
   //
   // generic memory test driver's protocol
   //
@@ -120,6 +129,21 @@ typedef struct {
   EFI_GENERIC_MEMORY_TEST_PRIVATE_SIGNATURE \
   )
 
+//
+// One BDS block tested by all the enabled processors. The block is split in
+// TEST_BLOCK_SIZE slices that the processors take in turn.
+//
+typedef struct {
+  GENERIC_MEMORY_TEST_PRIVATE       *Private;
+  EFI_PHYSICAL_ADDRESS              Start;
+  UINT64                            Length;
+  UINT32                            SliceCount;
+  volatile UINT32                   NextSlice;
+  volatile UINT64                   ErrorAddress;
+} MEMORY_TEST_JOB;
+
+#define MEMORY_TEST_NO_ERROR        MAX_UINT64
+
 //
 // Function Prototypes
 //
@@ -234,6 +258,72 @@ VerifyMemory (
   IN  UINT64                       Size
   );
 
+/**
+  Report an uncorrectable error found by the memory test.
+
+  @param[in] Address  The address of the mis-compare.
+
+  @retval EFI_DEVICE_ERROR     The error is reported.
+  @retval EFI_OUT_OF_RESOURCES Could not allocate the extended error data.
+
+**/
+EFI_STATUS
+ReportMemoryError (
+  IN  EFI_PHYSICAL_ADDRESS         Address
+  );
+
+/**
+  Write the memory test pattern into a range of physical memory, write it back
+  to memory, and verify it. This function can run on APs.
+
+  @param[in]  Private       Point to generic memory test driver's private data.
+  @param[in]  Start         The memory range's start address.
+  @param[in]  Size          The memory range's size.
+  @param[out] ErrorAddress  The address of the first mis-compare.
+
+  @retval TRUE   The range of memory passed the test.
+  @retval FALSE  The range of memory has errors.
+
+**/
+BOOLEAN
+TestMemorySlice (
+  IN  GENERIC_MEMORY_TEST_PRIVATE  *Private,
+  IN  EFI_PHYSICAL_ADDRESS         Start,
+  IN  UINT64                       Size,
+  OUT EFI_PHYSICAL_ADDRESS         *ErrorAddress
+  );
+
+/**
+  Test the slices of a memory test job until there is none left, or an error
+  is found. This function runs on the BSP and on all the enabled APs.
+
+  @param[in] Buffer   The MEMORY_TEST_JOB.
+
+**/
+VOID
+EFIAPI
+MemoryTestSliceWorker (
+  IN  VOID                         *Buffer
+  );
+
+/**
+  Write and verify a range of the memory on all the enabled processors.
+
+  @param[in] Private  Point to generic memory test driver's private data.
+  @param[in] Start    The memory range's start address.
+  @param[in] Size     The memory range's size.
+
+  @retval EFI_SUCCESS Successful verify the range of memory, no errors' location found.
+  @retval Others      The range of memory have errors contained.
+
+**/
+EFI_STATUS
+ParallelRangeTest (
+  IN  GENERIC_MEMORY_TEST_PRIVATE  *Private,
+  IN  EFI_PHYSICAL_ADDRESS         Start,
+  IN  UINT64                       Size
+  );
+
 /**
   Test a range of the memory directly .
 
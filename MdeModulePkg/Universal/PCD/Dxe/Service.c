@@ -1547,6 +1547,54 @@ SetHiiVariable (
   return Status;
 }
 
+/**
+  Search the DynamicEx mapping table for a {token space guid: token number} pair.
+
+  The build tool sorts the mapping table by token space guid index and then by
+  DynamicEx token number, so the pair is located by a binary search.
+
+  @param ExMapTable      DynamicEx token number mapping table.
+  @param ExTokenCount    The number of entries in ExMapTable.
+  @param GuidTableIdx    Index of the token space guid in the guid table.
+  @param ExTokenNumber   Token number for dynamic-ex PCD.
+
+  @return Pointer to the matching mapping entry, or NULL if it is not found.
+
+**/
+DYNAMICEX_MAPPING *
+SearchExMapTable (
+  IN DYNAMICEX_MAPPING          *ExMapTable,
+  IN UINTN                      ExTokenCount,
+  IN UINTN                      GuidTableIdx,
+  IN UINTN                      ExTokenNumber
+  )
+{
+  UINTN               Low;
+  UINTN               High;
+  UINTN               Middle;
+
+  Low  = 0;
+  High = ExTokenCount;
+  while (Low < High) {
+    Middle = Low + (High - Low) / 2;
+    if ((ExMapTable[Middle].ExGuidIndex < GuidTableIdx) ||
+        ((ExMapTable[Middle].ExGuidIndex == GuidTableIdx) &&
+         (ExMapTable[Middle].ExTokenNumber < ExTokenNumber))) {
+      Low = Middle + 1;
+    } else {
+      High = Middle;
+    }
+  }
+
+  if ((Low < ExTokenCount) &&
+      (ExMapTable[Low].ExGuidIndex == GuidTableIdx) &&
+      (ExMapTable[Low].ExTokenNumber == ExTokenNumber)) {
+    return &ExMapTable[Low];
+  }
+
+  return NULL;
+}
+
 /**
   Get Token Number according to dynamic-ex PCD's {token space guid:token number}
 
@@ -1566,8 +1614,8 @@ GetExPcdTokenNumber (
   IN UINT32                     ExTokenNumber
   )
 {
-  UINT32              Index;
   DYNAMICEX_MAPPING   *ExMap;
+  DYNAMICEX_MAPPING   *Match;
   EFI_GUID            *GuidTable;
   EFI_GUID            *MatchGuid;
   UINTN               MatchGuidIdx;
@@ -1582,11 +1630,9 @@ GetExPcdTokenNumber (
 
       MatchGuidIdx = MatchGuid - GuidTable;
 
-      for (Index = 0; Index < mPcdDatabase.PeiDb->ExTokenCount; Index++) {
-        if ((ExTokenNumber == ExMap[Index].ExTokenNumber) &&
-            (MatchGuidIdx == ExMap[Index].ExGuidIndex)) {
-            return ExMap[Index].TokenNumber;
-        }
+      Match = SearchExMapTable (ExMap, mPcdDatabase.PeiDb->ExTokenCount, MatchGuidIdx, ExTokenNumber);
+      if (Match != NULL) {
+        return Match->TokenNumber;
       }
     }
   }
@@ -1603,11 +1649,9 @@ GetExPcdTokenNumber (
 
   MatchGuidIdx = MatchGuid - GuidTable;
 
-  for (Index = 0; Index < mPcdDatabase.DxeDb->ExTokenCount; Index++) {
-    if ((ExTokenNumber == ExMap[Index].ExTokenNumber) &&
-         (MatchGuidIdx == ExMap[Index].ExGuidIndex)) {
-        return ExMap[Index].TokenNumber;
-    }
+  Match = SearchExMapTable (ExMap, mPcdDatabase.DxeDb->ExTokenCount, MatchGuidIdx, ExTokenNumber);
+  if (Match != NULL) {
+    return Match->TokenNumber;
   }
 
   ASSERT (FALSE);
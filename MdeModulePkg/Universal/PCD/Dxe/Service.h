@@ -33,7 +33,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 // Please make sure the PCD Serivce DXE Version is consistent with
 // the version of the generated DXE PCD Database by build tool.
 //
-#define PCD_SERVICE_DXE_VERSION      7
+#define PCD_SERVICE_DXE_VERSION      8
 
 //
 // PCD_DXE_SERVICE_DRIVER_VERSION is defined in Autogen.h.
@@ -1055,6 +1055,28 @@ BuildPcdDxeDataBase (
   VOID
   );
 
+/**
+  Search the DynamicEx mapping table for a {token space guid: token number} pair.
+
+  The build tool sorts the mapping table by token space guid index and then by
+  DynamicEx token number, so the pair is located by a binary search.
+
+  @param ExMapTable      DynamicEx token number mapping table.
+  @param ExTokenCount    The number of entries in ExMapTable.
+  @param GuidTableIdx    Index of the token space guid in the guid table.
+  @param ExTokenNumber   Token number for dynamic-ex PCD.
+
+  @return Pointer to the matching mapping entry, or NULL if it is not found.
+
+**/
+DYNAMICEX_MAPPING *
+SearchExMapTable (
+  IN DYNAMICEX_MAPPING          *ExMapTable,
+  IN UINTN                      ExTokenCount,
+  IN UINTN                      GuidTableIdx,
+  IN UINTN                      ExTokenNumber
+  );
+
 /**
   Get Token Number according to dynamic-ex PCD's {token space guid:token number}
 
@@ -22,10 +22,159 @@ EFI_REGULAR_EXPRESSION_PROTOCOL mProtocolInstance = {
   RegularExpressionGetInfo
 };
 
-
+//
+// Compiled patterns of recent matches, replaced least recently used first.
+//
+STATIC REGEX_CACHE_ENTRY  mRegexCache[REGEX_CACHE_SIZE];
+STATIC UINT64             mRegexCacheTick;
 
 #define CHAR16_ENCODING ONIG_ENCODING_UTF16_LE
 
+/**
+  Look up a compiled pattern in the regex cache.
+
+  The returned entry is marked in use, so that it is neither handed out to
+  nor replaced by a nested match, until it is given back with
+  RegexCacheRelease().
+
+  @param Pattern        The pattern to look up.
+  @param Syntax         The Oniguruma syntax the pattern is compiled with.
+
+  @return The cache entry holding the compiled pattern, or NULL if the
+          pattern is not cached.
+
+**/
+STATIC
+REGEX_CACHE_ENTRY *
+RegexCacheLookup (
+  IN CHAR16          *Pattern,
+  IN OnigSyntaxType  *Syntax
+  )
+{
+  EFI_TPL            OldTpl;
+  UINTN              Index;
+  REGEX_CACHE_ENTRY  *Entry;
+
+  OldTpl = gBS->RaiseTPL (TPL_HIGH_LEVEL);
+
+  for (Index = 0; Index < ARRAY_SIZE (mRegexCache); Index++) {
+    Entry = &mRegexCache[Index];
+    if ((Entry->Regex != NULL) && !Entry->InUse && (Entry->Syntax == Syntax) &&
+        (StrCmp (Entry->Pattern, Pattern) == 0)) {
+      Entry->InUse    = TRUE;
+      Entry->LastUsed = ++mRegexCacheTick;
+      gBS->RestoreTPL (OldTpl);
+      return Entry;
+    }
+  }
+
+  gBS->RestoreTPL (OldTpl);
+  return NULL;
+}
+
+/**
+  Add a newly compiled pattern to the regex cache, replacing the least
+  recently used entry that is not in use.
+
+  On success the cache takes ownership of Regex, and the returned entry is
+  marked in use until it is given back with RegexCacheRelease().
+
+  @param Pattern        The pattern Regex is compiled from.
+  @param Syntax         The Oniguruma syntax Regex is compiled with.
+  @param Regex          The compiled pattern.
+
+  @return The cache entry now holding Regex, or NULL if the pattern is not
+          cached. The caller still owns Regex in that case.
+
+**/
+STATIC
+REGEX_CACHE_ENTRY *
+RegexCacheInsert (
+  IN CHAR16          *Pattern,
+  IN OnigSyntaxType  *Syntax,
+  IN regex_t         *Regex
+  )
+{
+  EFI_TPL            OldTpl;
+  UINTN              Index;
+  REGEX_CACHE_ENTRY  *Entry;
+  REGEX_CACHE_ENTRY  *Victim;
+  CHAR16             *PatternCopy;
+  CHAR16             *OldPattern;
+  regex_t            *OldRegex;
+
+  if (StrLen (Pattern) > REGEX_CACHE_MAX_PATTERN_LENGTH) {
+    return NULL;
+  }
+
+  PatternCopy = AllocateCopyPool (StrSize (Pattern), Pattern);
+  if (PatternCopy == NULL) {
+    return NULL;
+  }
+
+  OldTpl = gBS->RaiseTPL (TPL_HIGH_LEVEL);
+
+  Victim = NULL;
+  for (Index = 0; Index < ARRAY_SIZE (mRegexCache); Index++) {
+    Entry = &mRegexCache[Index];
+    if (Entry->InUse) {
+      continue;
+    }
+    if ((Victim == NULL) || (Entry->LastUsed < Victim->LastUsed)) {
+      Victim = Entry;
+    }
+  }
+
+  if (Victim == NULL) {
+    gBS->RestoreTPL (OldTpl);
+    FreePool (PatternCopy);
+    return NULL;
+  }
+
+  OldPattern       = Victim->Pattern;
+  OldRegex         = Victim->Regex;
+  Victim->Pattern  = PatternCopy;
+  Victim->Syntax   = Syntax;
+  Victim->Regex    = Regex;
+  Victim->InUse    = TRUE;
+  Victim->LastUsed = ++mRegexCacheTick;
+
+  gBS->RestoreTPL (OldTpl);
+
+  if (OldRegex != NULL) {
+    onig_free (OldRegex);
+  }
+  if (OldPattern != NULL) {
+    FreePool (OldPattern);
+  }
+
+  return Victim;
+}
+
+/**
+  Give back a compiled pattern after a match.
+
+  @param Entry          The cache entry holding Regex, or NULL if Regex is not
+                        cached.
+  @param Regex          The compiled pattern. It is freed if it is not cached.
+
+**/
+STATIC
+VOID
+RegexCacheRelease (
+  IN REGEX_CACHE_ENTRY  *Entry, OPTIONAL
+  IN regex_t            *Regex
+  )
+{
+  if (Entry == NULL) {
+    onig_free (Regex);
+    return;
+  }
+
+  ASSERT (Entry->Regex == Regex);
+  Entry->InUse = FALSE;
+}
+
 /**
   Call the Oniguruma regex match API.
 
@@ -77,8 +226,9 @@ OnigurumaMatch (
   OUT UINTN                 *CapturesCount
   )
 {
-  regex_t         *OnigRegex;
-  OnigSyntaxType  *OnigSyntax;
+  regex_t            *OnigRegex;
+  REGEX_CACHE_ENTRY  *CacheEntry;
+  OnigSyntaxType     *OnigSyntax;
   OnigRegion      *Region;
   INT32           OnigResult;
   OnigErrorInfo   ErrorInfo;
@@ -104,23 +254,30 @@ OnigurumaMatch (
   }
 
   //
-  // Compile pattern
+  // Compile pattern, unless it was compiled for a recent match
   //
-  Start = (OnigUChar*)Pattern;
-  OnigResult = onig_new (
-                 &OnigRegex,
-                 Start,
-                 Start + onigenc_str_bytelen_null (CHAR16_ENCODING, Start),
-                 ONIG_OPTION_DEFAULT,
-                 CHAR16_ENCODING,
-                 OnigSyntax,
-                 &ErrorInfo
-                 );
+  CacheEntry = RegexCacheLookup (Pattern, OnigSyntax);
+  if (CacheEntry != NULL) {
+    OnigRegex = CacheEntry->Regex;
+  } else {
+    Start = (OnigUChar*)Pattern;
+    OnigResult = onig_new (
+                   &OnigRegex,
+                   Start,
+                   Start + onigenc_str_bytelen_null (CHAR16_ENCODING, Start),
+                   ONIG_OPTION_DEFAULT,
+                   CHAR16_ENCODING,
+                   OnigSyntax,
+                   &ErrorInfo
+                   );
+
+    if (OnigResult != ONIG_NORMAL) {
+      onig_error_code_to_str (ErrorMessage, OnigResult, &ErrorInfo);
+      DEBUG ((DEBUG_ERROR, "Regex compilation failed: %a\n", ErrorMessage));
+      return EFI_DEVICE_ERROR;
+    }
 
-  if (OnigResult != ONIG_NORMAL) {
-    onig_error_code_to_str (ErrorMessage, OnigResult, &ErrorInfo);
-    DEBUG ((DEBUG_ERROR, "Regex compilation failed: %a\n", ErrorMessage));
-    return EFI_DEVICE_ERROR;
+    CacheEntry = RegexCacheInsert (Pattern, OnigSyntax, OnigRegex);
   }
 
   //
@@ -129,7 +286,7 @@ OnigurumaMatch (
   Start = (OnigUChar*)String;
   Region = onig_region_new ();
   if (Region == NULL) {
-    onig_free (OnigRegex);
+    RegexCacheRelease (CacheEntry, OnigRegex);
     return EFI_OUT_OF_RESOURCES;
   }
   OnigResult = onig_search (
@@ -150,7 +307,7 @@ OnigurumaMatch (
       onig_error_code_to_str (ErrorMessage, OnigResult);
       DEBUG ((DEBUG_ERROR, "Regex match failed: %a\n", ErrorMessage));
       onig_region_free (Region, 1);
-      onig_free (OnigRegex);
+      RegexCacheRelease (CacheEntry, OnigRegex);
       return EFI_DEVICE_ERROR;
     }
   }
@@ -189,7 +346,7 @@ OnigurumaMatch (
   }
 
   onig_region_free (Region, 1);
-  onig_free (OnigRegex);
+  RegexCacheRelease (CacheEntry, OnigRegex);
 
   return Status;
 }
@@ -21,6 +21,25 @@
 #include <Library/DebugLib.h>
 #include <Library/BaseLib.h>
 
+//
+// Number of compiled patterns kept by the regex cache, and the longest
+// pattern (in characters, excluding the terminator) that is cached.
+//
+#define REGEX_CACHE_SIZE                8
+#define REGEX_CACHE_MAX_PATTERN_LENGTH  256
+
+//
+// A compiled pattern kept for reuse by later matches with the same pattern
+// and syntax.
+//
+typedef struct {
+  CHAR16          *Pattern;
+  OnigSyntaxType  *Syntax;
+  regex_t         *Regex;
+  UINT64          LastUsed;
+  BOOLEAN         InUse;
+} REGEX_CACHE_ENTRY;
+
 /**
   Checks if the input string matches to the regular expression pattern.
 
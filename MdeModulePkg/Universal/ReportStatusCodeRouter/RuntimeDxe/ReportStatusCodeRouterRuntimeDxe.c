@@ -29,6 +29,10 @@ EFI_RSC_HANDLER_PROTOCOL  mRscHandlerProtocol = {
   Unregister
   };
 
+EDKII_RSC_HANDLER_FILTER_PROTOCOL  mRscHandlerFilterProtocol = {
+  SetFilter
+};
+
 /**
   Event callback function to invoke status code handler in list.
 
@@ -131,6 +135,7 @@ Register (
   CallbackEntry->Signature          = RSC_HANDLER_CALLBACK_ENTRY_SIGNATURE;
   CallbackEntry->RscHandlerCallback = Callback;
   CallbackEntry->Tpl                = Tpl;
+  CallbackEntry->CodeTypeMask       = EDKII_RSC_CODE_TYPE_ALL;
 
   //
   // If TPL of registered callback funtion is not TPL_HIGH_LEVEL, then event should be created
@@ -205,6 +210,43 @@ Unregister (
   return EFI_NOT_FOUND;
 }
 
+/**
+  Restrict the status code types a registered handler is called for.
+
+  @param[in]  Callback      A handler registered with Register().
+  @param[in]  CodeTypeMask  A set of EDKII_RSC_CODE_TYPE_BIT() bits; the
+                            handler is only called for status codes whose
+                            type bit is set, or whose type has no bit.
+
+  @retval EFI_SUCCESS             The filter was set.
+  @retval EFI_INVALID_PARAMETER   Callback is NULL.
+  @retval EFI_NOT_FOUND           Callback is not registered.
+**/
+EFI_STATUS
+EFIAPI
+SetFilter (
+  IN EFI_RSC_HANDLER_CALLBACK  Callback,
+  IN UINT32                    CodeTypeMask
+  )
+{
+  LIST_ENTRY                    *Link;
+  RSC_HANDLER_CALLBACK_ENTRY    *CallbackEntry;
+
+  if (Callback == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  for (Link = GetFirstNode (&mCallbackListHead); !IsNull (&mCallbackListHead, Link); Link = GetNextNode (&mCallbackListHead, Link)) {
+    CallbackEntry = CR (Link, RSC_HANDLER_CALLBACK_ENTRY, Node, RSC_HANDLER_CALLBACK_ENTRY_SIGNATURE);
+    if (CallbackEntry->RscHandlerCallback == Callback) {
+      CallbackEntry->CodeTypeMask = CodeTypeMask;
+      return EFI_SUCCESS;
+    }
+  }
+
+  return EFI_NOT_FOUND;
+}
+
 /**
   Provides an interface that a software module can call to report a status code.
 
@@ -239,6 +281,7 @@ ReportDispatcher (
   EFI_STATUS                    Status;
   VOID                          *NewBuffer;
   EFI_PHYSICAL_ADDRESS          FailSafeEndPointer;
+  UINT32                        CodeTypeBit;
 
   //
   // Use atom operation to avoid the reentant of report.
@@ -248,12 +291,21 @@ ReportDispatcher (
     return EFI_DEVICE_ERROR;
   }
 
+  CodeTypeBit = EDKII_RSC_CODE_TYPE_BIT (Type);
+
   for (Link = GetFirstNode (&mCallbackListHead); !IsNull (&mCallbackListHead, Link);) {
     CallbackEntry = CR (Link, RSC_HANDLER_CALLBACK_ENTRY, Node, RSC_HANDLER_CALLBACK_ENTRY_SIGNATURE);
     //
     // The handler may remove itself, so get the next handler in advance.
     //
     Link = GetNextNode (&mCallbackListHead, Link);
+    if ((CallbackEntry->CodeTypeMask & CodeTypeBit) != CodeTypeBit) {
+      //
+      // The handler is not interested in this code type.
+      //
+      continue;
+    }
+
     if ((CallbackEntry->Tpl == TPL_HIGH_LEVEL) || EfiAtRuntime ()) {
       CallbackEntry->RscHandlerCallback (
                        Type,
@@ -391,6 +443,8 @@ GenericStatusCodeRuntimeDxeEntry (
                   &mRscHandlerProtocol,
                   &gEfiStatusCodeRuntimeProtocolGuid,
                   &mStatusCodeProtocol,
+                  &gEdkiiRscHandlerFilterProtocolGuid,
+                  &mRscHandlerFilterProtocol,
                   NULL
                   );
   ASSERT_EFI_ERROR (Status);
@@ -11,6 +11,7 @@
 
 
 #include <Protocol/ReportStatusCodeHandler.h>
+#include <Protocol/RscHandlerFilter.h>
 #include <Protocol/StatusCode.h>
 
 #include <Guid/EventGroup.h>
@@ -32,6 +33,7 @@ typedef struct {
   UINTN                     Signature;
   EFI_RSC_HANDLER_CALLBACK  RscHandlerCallback;
   EFI_TPL                   Tpl;
+  UINT32                    CodeTypeMask;
   EFI_EVENT                 Event;
   EFI_PHYSICAL_ADDRESS      StatusCodeDataBuffer;
   UINTN                     BufferSize;
@@ -103,6 +105,25 @@ Unregister (
   IN EFI_RSC_HANDLER_CALLBACK Callback
   );
 
+/**
+  Restrict the status code types a registered handler is called for.
+
+  @param[in]  Callback      A handler registered with Register().
+  @param[in]  CodeTypeMask  A set of EDKII_RSC_CODE_TYPE_BIT() bits; the
+                            handler is only called for status codes whose
+                            type bit is set, or whose type has no bit.
+
+  @retval EFI_SUCCESS             The filter was set.
+  @retval EFI_INVALID_PARAMETER   Callback is NULL.
+  @retval EFI_NOT_FOUND           Callback is not registered.
+**/
+EFI_STATUS
+EFIAPI
+SetFilter (
+  IN EFI_RSC_HANDLER_CALLBACK  Callback,
+  IN UINT32                    CodeTypeMask
+  );
+
 /**
   Provides an interface that a software module can call to report a status code.
 
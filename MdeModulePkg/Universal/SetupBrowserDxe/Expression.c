@@ -899,6 +899,78 @@ IdToQuestion (
 }
 
 
+/**
+  Search the Question referenced by an expression opcode, using its
+  QuestionId or QuestionId2.
+
+  Question Ids are unique in a formset, so the Question found the first time
+  is cached in the opcode, together with the form which contains it. This
+  avoids searching the whole formset each time the expression is evaluated,
+  e.g. for every SuppressIf and GrayOutIf on each form refresh.
+
+  @param  FormSet                The formset which contains this form.
+  @param  Form                   The form which contains this expression.
+  @param  OpCode                 The expression opcode.
+  @param  Index                  0 for QuestionId, 1 for QuestionId2.
+
+  @retval Pointer                The Question.
+  @retval NULL                   Specified Question not found in the formset.
+
+**/
+STATIC
+FORM_BROWSER_STATEMENT *
+OpCodeIdToQuestion (
+  IN FORM_BROWSER_FORMSET  *FormSet,
+  IN FORM_BROWSER_FORM     *Form,
+  IN EXPRESSION_OPCODE     *OpCode,
+  IN UINTN                 Index
+  )
+{
+  LIST_ENTRY              *Link;
+  FORM_BROWSER_STATEMENT  *Question;
+  FORM_BROWSER_FORM       *QuestionForm;
+  EFI_QUESTION_ID         QuestionId;
+
+  ASSERT (Index < ARRAY_SIZE (OpCode->Question));
+
+  Question = OpCode->Question[Index];
+  if (Question == NULL) {
+    QuestionId = (Index == 0) ? OpCode->QuestionId : OpCode->QuestionId2;
+
+    //
+    // Search in the form scope first, then in the formset scope
+    //
+    QuestionForm = Form;
+    Question     = IdToQuestion2 (Form, QuestionId);
+    Link = GetFirstNode (&FormSet->FormListHead);
+    while (Question == NULL && !IsNull (&FormSet->FormListHead, Link)) {
+      QuestionForm = FORM_BROWSER_FORM_FROM_LINK (Link);
+      Question     = IdToQuestion2 (QuestionForm, QuestionId);
+      Link = GetNextNode (&FormSet->FormListHead, Link);
+    }
+
+    if (Question == NULL) {
+      return NULL;
+    }
+
+    OpCode->Question[Index]     = Question;
+    OpCode->QuestionForm[Index] = QuestionForm;
+  }
+
+  //
+  // As in IdToQuestion(), a Question from another form which uses EFI
+  // variable storage may be updated by Callback() asynchronous, so always
+  // reload its value.
+  //
+  if (OpCode->QuestionForm[Index] != Form &&
+      Question->Storage->Type == EFI_HII_VARSTORE_EFI_VARIABLE) {
+    GetQuestionValue (FormSet, OpCode->QuestionForm[Index], Question, GetSetValueWithHiiDriver);
+  }
+
+  return Question;
+}
+
+
 /**
   Get Expression given its RuleId.
 
@@ -2580,7 +2652,7 @@ EvaluateExpression (
     // Built-in functions
     //
     case EFI_IFR_EQ_ID_VAL_OP:
-      Question = IdToQuestion (FormSet, Form, OpCode->QuestionId);
+      Question = OpCodeIdToQuestion (FormSet, Form, OpCode, 0);
       if (Question == NULL) {
         Value->Type = EFI_IFR_TYPE_UNDEFINED;
         break;
@@ -2600,13 +2672,13 @@ EvaluateExpression (
       break;
 
     case EFI_IFR_EQ_ID_ID_OP:
-      Question = IdToQuestion (FormSet, Form, OpCode->QuestionId);
+      Question = OpCodeIdToQuestion (FormSet, Form, OpCode, 0);
       if (Question == NULL) {
         Value->Type = EFI_IFR_TYPE_UNDEFINED;
         break;
       }
 
-      Question2 = IdToQuestion (FormSet, Form, OpCode->QuestionId2);
+      Question2 = OpCodeIdToQuestion (FormSet, Form, OpCode, 1);
       if (Question2 == NULL) {
         Value->Type = EFI_IFR_TYPE_UNDEFINED;
         break;
@@ -2625,7 +2697,7 @@ EvaluateExpression (
       break;
 
     case EFI_IFR_EQ_ID_VAL_LIST_OP:
-      Question = IdToQuestion (FormSet, Form, OpCode->QuestionId);
+      Question = OpCodeIdToQuestion (FormSet, Form, OpCode, 0);
       if (Question == NULL) {
         Value->Type = EFI_IFR_TYPE_UNDEFINED;
         break;
@@ -2651,7 +2723,7 @@ EvaluateExpression (
 
     case EFI_IFR_QUESTION_REF1_OP:
     case EFI_IFR_THIS_OP:
-      Question = IdToQuestion (FormSet, Form, OpCode->QuestionId);
+      Question = OpCodeIdToQuestion (FormSet, Form, OpCode, 0);
       if (Question == NULL) {
         Status = EFI_NOT_FOUND;
         goto Done;
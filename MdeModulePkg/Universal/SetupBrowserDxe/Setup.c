@@ -5503,6 +5503,59 @@ ConfigRequestAdjust (
   return RetVal;
 }
 
+/**
+  Fill the edit copy of an EFI variable buffer storage from its EFI variable.
+
+  The settings of such a storage are the EFI variable itself, so it is read
+  directly instead of being converted to a <ConfigResp> string by the HII
+  Config Routing protocol and parsed back.
+
+  @param  Storage                Browser storage of type EFI_HII_VARSTORE_EFI_VARIABLE_BUFFER.
+
+  @retval EFI_SUCCESS            The edit copy is filled from the EFI variable.
+  @retval EFI_NOT_FOUND          The EFI variable does not exist, or is smaller than the storage.
+  @retval EFI_OUT_OF_RESOURCES   No enough memory to read the EFI variable.
+
+**/
+EFI_STATUS
+LoadEfiVarStoreStorage (
+  IN BROWSER_STORAGE         *Storage
+  )
+{
+  EFI_STATUS  Status;
+  UINTN       BufferSize;
+  UINT8       *VarStore;
+
+  ASSERT (Storage->Type == EFI_HII_VARSTORE_EFI_VARIABLE_BUFFER);
+
+  BufferSize = 0;
+  Status = gRT->GetVariable (Storage->Name, &Storage->Guid, NULL, &BufferSize, NULL);
+  if (Status != EFI_BUFFER_TOO_SMALL || BufferSize < Storage->Size) {
+    return EFI_NOT_FOUND;
+  }
+
+  if (BufferSize == Storage->Size) {
+    Status = gRT->GetVariable (Storage->Name, &Storage->Guid, NULL, &BufferSize, Storage->EditBuffer);
+    return EFI_ERROR (Status) ? EFI_NOT_FOUND : EFI_SUCCESS;
+  }
+
+  //
+  // The EFI variable is larger than the storage, only its beginning is used.
+  //
+  VarStore = AllocatePool (BufferSize);
+  if (VarStore == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Status = gRT->GetVariable (Storage->Name, &Storage->Guid, NULL, &BufferSize, VarStore);
+  if (!EFI_ERROR (Status)) {
+    CopyMem (Storage->EditBuffer, VarStore, Storage->Size);
+  }
+
+  FreePool (VarStore);
+  return EFI_ERROR (Status) ? EFI_NOT_FOUND : EFI_SUCCESS;
+}
+
 /**
   Fill storage's edit copy with settings requested from Configuration Driver.
 
@@ -5560,6 +5613,21 @@ LoadStorage (
       return;
   }
 
+  if (Storage->BrowserStorage->Type == EFI_HII_VARSTORE_EFI_VARIABLE_BUFFER) {
+    //
+    // Read the EFI variable directly, as HII Config Routing would do.
+    // If get value fail, extract default from IFR binary
+    //
+    Status = LoadEfiVarStoreStorage (Storage->BrowserStorage);
+    if (EFI_ERROR (Status)) {
+      ExtractDefault (FormSet, NULL, EFI_HII_DEFAULT_CLASS_STANDARD, FormSetLevel, GetDefaultForStorage, Storage->BrowserStorage, TRUE, TRUE);
+    }
+
+    Storage->BrowserStorage->ConfigRequest = AllocateCopyPool (StrSize (Storage->ConfigRequest), Storage->ConfigRequest);
+    SynchronizeStorage(Storage->BrowserStorage, NULL, TRUE);
+    return;
+  }
+
   if (Storage->BrowserStorage->Type != EFI_HII_VARSTORE_NAME_VALUE) {
     //
     // Create the config request string to get all fields for this storage.
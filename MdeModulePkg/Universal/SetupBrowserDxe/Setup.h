@@ -201,6 +201,9 @@ typedef struct {
   EFI_QUESTION_ID   QuestionId;  // For EFI_IFR_EQ_ID_ID, EFI_IFR_EQ_ID_VAL_LIST, EFI_IFR_QUESTION_REF1
   EFI_QUESTION_ID   QuestionId2;
 
+  struct _FORM_BROWSER_STATEMENT  *Question[2];     // Cached Questions of QuestionId and QuestionId2
+  struct _FORM_BROWSER_FORM       *QuestionForm[2]; // Forms which contain the cached Questions
+
   UINT16            ListLength;  // For EFI_IFR_EQ_ID_VAL_LIST
   UINT16            *ValueList;
 
@@ -397,7 +400,7 @@ typedef struct {
 #define FORM_BROWSER_FORM_SIGNATURE  SIGNATURE_32 ('F', 'F', 'R', 'M')
 #define STANDARD_MAP_FORM_TYPE 0x01
 
-typedef struct {
+typedef struct _FORM_BROWSER_FORM {
   UINTN                Signature;
   LIST_ENTRY           Link;
 
@@ -240,7 +240,7 @@ GetSmbiosStructureSize (
 
   Determin whether an SmbiosHandle has already in use.
 
-  @param Head        Pointer to the beginning of SMBIOS structure.
+  @param Private     The SMBIOS instance.
   @param Handle      A unique handle will be assigned to the SMBIOS record.
 
   @retval TRUE       Smbios handle already in use.
@@ -250,21 +250,98 @@ GetSmbiosStructureSize (
 BOOLEAN
 EFIAPI
 CheckSmbiosHandleExistance (
-  IN  LIST_ENTRY           *Head,
+  IN  SMBIOS_INSTANCE      *Private,
+  IN  EFI_SMBIOS_HANDLE    Handle
+  )
+{
+  return (BOOLEAN) ((Private->AllocatedHandleBitmap[Handle / 8] & (1 << (Handle % 8))) != 0);
+}
+
+/**
+
+  Find the SMBIOS entry of a handle.
+
+  @param Private     The SMBIOS instance.
+  @param Handle      The SMBIOS handle to look for.
+
+  @return The SMBIOS entry of Handle, or NULL if Handle is not in use.
+
+**/
+EFI_SMBIOS_ENTRY *
+SmbiosFindEntryByHandle (
+  IN  SMBIOS_INSTANCE      *Private,
   IN  EFI_SMBIOS_HANDLE    Handle
   )
 {
   LIST_ENTRY              *Link;
-  SMBIOS_HANDLE_ENTRY     *HandleEntry;
+  LIST_ENTRY              *Head;
+  EFI_SMBIOS_ENTRY        *SmbiosEntry;
+  EFI_SMBIOS_TABLE_HEADER *Record;
+
+  if (!CheckSmbiosHandleExistance (Private, Handle)) {
+    return NULL;
+  }
 
+  Head = &Private->HandleHashListHead[Handle % SMBIOS_HANDLE_HASH_SIZE];
   for (Link = Head->ForwardLink; Link != Head; Link = Link->ForwardLink) {
-    HandleEntry = SMBIOS_HANDLE_ENTRY_FROM_LINK(Link);
-    if (HandleEntry->SmbiosHandle == Handle) {
-      return TRUE;
+    SmbiosEntry = SMBIOS_ENTRY_FROM_HANDLE_LINK (Link);
+    Record = (EFI_SMBIOS_TABLE_HEADER*)(SmbiosEntry->RecordHeader + 1);
+    if (Record->Handle == Handle) {
+      return SmbiosEntry;
     }
   }
 
-  return FALSE;
+  return NULL;
+}
+
+/**
+
+  Link a new SMBIOS entry into the record list, the handle hash and the list
+  of its type, right after Previous or at the tail if Previous is NULL.
+
+  @param Private     The SMBIOS instance.
+  @param SmbiosEntry The SMBIOS entry to insert.
+  @param Previous    The SMBIOS entry that SmbiosEntry replaces, or NULL.
+
+**/
+VOID
+SmbiosInsertEntry (
+  IN  SMBIOS_INSTANCE      *Private,
+  IN  EFI_SMBIOS_ENTRY     *SmbiosEntry,
+  IN  EFI_SMBIOS_ENTRY     *Previous OPTIONAL
+  )
+{
+  EFI_SMBIOS_TABLE_HEADER *Record;
+
+  Record = (EFI_SMBIOS_TABLE_HEADER*)(SmbiosEntry->RecordHeader + 1);
+  if (Previous == NULL) {
+    SmbiosEntry->Sequence = Private->NextSequence++;
+    InsertTailList (&Private->DataListHead, &SmbiosEntry->Link);
+    InsertTailList (&Private->TypeListHead[Record->Type], &SmbiosEntry->TypeLink);
+  } else {
+    SmbiosEntry->Sequence = Previous->Sequence;
+    InsertTailList (Previous->Link.ForwardLink, &SmbiosEntry->Link);
+    InsertTailList (Previous->TypeLink.ForwardLink, &SmbiosEntry->TypeLink);
+  }
+  InsertTailList (&Private->HandleHashListHead[Record->Handle % SMBIOS_HANDLE_HASH_SIZE], &SmbiosEntry->HandleLink);
+}
+
+/**
+
+  Unlink an SMBIOS entry from the record list, the handle hash and the list of
+  its type.
+
+  @param SmbiosEntry The SMBIOS entry to remove.
+
+**/
+VOID
+SmbiosRemoveEntry (
+  IN  EFI_SMBIOS_ENTRY     *SmbiosEntry
+  )
+{
+  RemoveEntryList (&SmbiosEntry->Link);
+  RemoveEntryList (&SmbiosEntry->HandleLink);
+  RemoveEntryList (&SmbiosEntry->TypeLink);
 }
 
 /**
@@ -307,7 +384,6 @@ GetAvailableSmbiosHandle (
   IN OUT   EFI_SMBIOS_HANDLE     *Handle
   )
 {
-  LIST_ENTRY              *Head;
   SMBIOS_INSTANCE         *Private;
   EFI_SMBIOS_HANDLE       MaxSmbiosHandle;
   EFI_SMBIOS_HANDLE       AvailableHandle;
@@ -315,9 +391,15 @@ GetAvailableSmbiosHandle (
   GetMaxSmbiosHandle(This, &MaxSmbiosHandle);
 
   Private = SMBIOS_INSTANCE_FROM_THIS (This);
-  Head = &Private->AllocatedHandleListHead;
   for (AvailableHandle = 0; AvailableHandle < MaxSmbiosHandle; AvailableHandle++) {
-    if (!CheckSmbiosHandleExistance(Head, AvailableHandle)) {
+    //
+    // Skip fully allocated bytes of the bitmap.
+    //
+    if (((AvailableHandle % 8) == 0) && (Private->AllocatedHandleBitmap[AvailableHandle / 8] == 0xFF)) {
+      AvailableHandle += 7;
+      continue;
+    }
+    if (!CheckSmbiosHandleExistance(Private, AvailableHandle)) {
       *Handle = AvailableHandle;
       return EFI_SUCCESS;
     }
@@ -361,11 +443,9 @@ SmbiosAdd (
   UINTN                       StructureSize;
   UINTN                       NumberOfStrings;
   EFI_STATUS                  Status;
-  LIST_ENTRY                  *Head;
   SMBIOS_INSTANCE             *Private;
   EFI_SMBIOS_ENTRY            *SmbiosEntry;
   EFI_SMBIOS_HANDLE           MaxSmbiosHandle;
-  SMBIOS_HANDLE_ENTRY         *HandleEntry;
   EFI_SMBIOS_RECORD_HEADER    *InternalRecord;
   BOOLEAN                     Smbios32BitTable;
   BOOLEAN                     Smbios64BitTable;
@@ -378,8 +458,7 @@ SmbiosAdd (
   //
   // Check whether SmbiosHandle is already in use
   //
-  Head = &Private->AllocatedHandleListHead;
-  if (*SmbiosHandle != SMBIOS_HANDLE_PI_RESERVED && CheckSmbiosHandleExistance(Head, *SmbiosHandle)) {
+  if (*SmbiosHandle != SMBIOS_HANDLE_PI_RESERVED && CheckSmbiosHandleExistance(Private, *SmbiosHandle)) {
     return EFI_ALREADY_STARTED;
   }
 
@@ -470,18 +549,11 @@ SmbiosAdd (
     EfiReleaseLock (&Private->DataLock);
     return EFI_OUT_OF_RESOURCES;
   }
-  HandleEntry = AllocateZeroPool (sizeof(SMBIOS_HANDLE_ENTRY));
-  if (HandleEntry == NULL) {
-    EfiReleaseLock (&Private->DataLock);
-    return EFI_OUT_OF_RESOURCES;
-  }
 
   //
-  // Build Handle Entry and insert into linked list
+  // Mark the handle allocated
   //
-  HandleEntry->Signature     = SMBIOS_HANDLE_ENTRY_SIGNATURE;
-  HandleEntry->SmbiosHandle  = *SmbiosHandle;
-  InsertTailList(&Private->AllocatedHandleListHead, &HandleEntry->Link);
+  Private->AllocatedHandleBitmap[*SmbiosHandle / 8] |= (UINT8) (1 << (*SmbiosHandle % 8));
 
   InternalRecord  = (EFI_SMBIOS_RECORD_HEADER *) (SmbiosEntry + 1);
   Raw     = (VOID *) (InternalRecord + 1);
@@ -502,18 +574,19 @@ SmbiosAdd (
   SmbiosEntry->RecordSize   = TotalSize;
   SmbiosEntry->Smbios32BitTable = Smbios32BitTable;
   SmbiosEntry->Smbios64BitTable = Smbios64BitTable;
-  InsertTailList (&Private->DataListHead, &SmbiosEntry->Link);
 
   CopyMem (Raw, Record, StructureSize);
   ((EFI_SMBIOS_TABLE_HEADER*)Raw)->Handle = *SmbiosHandle;
 
+  SmbiosInsertEntry (Private, SmbiosEntry, NULL);
+
   //
   // Some UEFI drivers (such as network) need some information in SMBIOS table.
-  // Here we create SMBIOS table and publish it in
+  // Here we append the record to the SMBIOS table and publish it in
   // configuration table, so other UEFI drivers can get SMBIOS table from
   // configuration table without depending on PI SMBIOS protocol.
   //
-  SmbiosTableConstruction (Smbios32BitTable, Smbios64BitTable);
+  SmbiosTableAppend (SmbiosEntry);
 
   //
   // Leave critical section
@@ -552,12 +625,12 @@ SmbiosUpdateString (
   UINTN                     NewEntrySize;
   CHAR8                     *StrStart;
   VOID                      *Raw;
-  LIST_ENTRY                *Link;
-  LIST_ENTRY                *Head;
   EFI_STATUS                Status;
   SMBIOS_INSTANCE           *Private;
   EFI_SMBIOS_ENTRY          *SmbiosEntry;
   EFI_SMBIOS_ENTRY          *ResizedSmbiosEntry;
+  BOOLEAN                   Smbios32BitTable;
+  BOOLEAN                   Smbios64BitTable;
   EFI_SMBIOS_HANDLE         MaxSmbiosHandle;
   EFI_SMBIOS_TABLE_HEADER   *Record;
   EFI_SMBIOS_RECORD_HEADER  *InternalRecord;
@@ -614,164 +687,169 @@ SmbiosUpdateString (
     return Status;
   }
 
-  Head = &Private->DataListHead;
-  for (Link = Head->ForwardLink; Link != Head; Link = Link->ForwardLink) {
-    SmbiosEntry = SMBIOS_ENTRY_FROM_LINK(Link);
-    Record = (EFI_SMBIOS_TABLE_HEADER*)(SmbiosEntry->RecordHeader + 1);
-
-    if (Record->Handle == *SmbiosHandle) {
-      //
-      // Find out the specified SMBIOS record
-      //
-      if (*StringNumber > SmbiosEntry->RecordHeader->NumberOfStrings) {
-        EfiReleaseLock (&Private->DataLock);
-        return EFI_NOT_FOUND;
-      }
-      //
-      // Point to unformed string section
-      //
-      StrStart = (CHAR8 *) Record + Record->Length;
-
-      for (StrIndex = 1, TargetStrOffset = 0; StrIndex < *StringNumber; StrStart++, TargetStrOffset++) {
-        //
-        // A string ends in 00h
-        //
-        if (*StrStart == 0) {
-          StrIndex++;
-        }
+  SmbiosEntry = SmbiosFindEntryByHandle (Private, *SmbiosHandle);
+  if (SmbiosEntry == NULL) {
+    EfiReleaseLock (&Private->DataLock);
+    return EFI_INVALID_PARAMETER;
+  }
+  Record = (EFI_SMBIOS_TABLE_HEADER*)(SmbiosEntry->RecordHeader + 1);
 
-        //
-        // String section ends in double-null (0000h)
-        //
-        if (*StrStart == 0 && *(StrStart + 1) == 0) {
-          EfiReleaseLock (&Private->DataLock);
-          return EFI_NOT_FOUND;
-        }
-      }
+  //
+  // Find out the specified SMBIOS record
+  //
+  if (*StringNumber > SmbiosEntry->RecordHeader->NumberOfStrings) {
+    EfiReleaseLock (&Private->DataLock);
+    return EFI_NOT_FOUND;
+  }
+  //
+  // Point to unformed string section
+  //
+  StrStart = (CHAR8 *) Record + Record->Length;
 
-      if (*StrStart == 0) {
-        StrStart++;
-        TargetStrOffset++;
-      }
+  for (StrIndex = 1, TargetStrOffset = 0; StrIndex < *StringNumber; StrStart++, TargetStrOffset++) {
+    //
+    // A string ends in 00h
+    //
+    if (*StrStart == 0) {
+      StrIndex++;
+    }
 
-      //
-      // Now we get the string target
-      //
-      TargetStrLen = AsciiStrLen(StrStart);
-      if (InputStrLen == TargetStrLen) {
-        AsciiStrCpyS(StrStart, TargetStrLen + 1, String);
-        //
-        // Some UEFI drivers (such as network) need some information in SMBIOS table.
-        // Here we create SMBIOS table and publish it in
-        // configuration table, so other UEFI drivers can get SMBIOS table from
-        // configuration table without depending on PI SMBIOS protocol.
-        //
-        SmbiosTableConstruction (SmbiosEntry->Smbios32BitTable, SmbiosEntry->Smbios64BitTable);
-        EfiReleaseLock (&Private->DataLock);
-        return EFI_SUCCESS;
-      }
+    //
+    // String section ends in double-null (0000h)
+    //
+    if (*StrStart == 0 && *(StrStart + 1) == 0) {
+      EfiReleaseLock (&Private->DataLock);
+      return EFI_NOT_FOUND;
+    }
+  }
 
-      SmbiosEntry->Smbios32BitTable = FALSE;
-      SmbiosEntry->Smbios64BitTable = FALSE;
-      if ((This->MajorVersion < 0x3) ||
-          ((This->MajorVersion >= 0x3) && ((PcdGet32 (PcdSmbiosEntryPointProvideMethod) & BIT0) == BIT0))) {
-        //
-        // 32-bit table is produced, check the valid length.
-        //
-        if ((EntryPointStructure != NULL) &&
-            (EntryPointStructure->TableLength + InputStrLen - TargetStrLen > SMBIOS_TABLE_MAX_LENGTH)) {
-          //
-          // The length of the entire structure table (including all strings) must be reported
-          // in the Structure Table Length field of the SMBIOS Structure Table Entry Point,
-          // which is a WORD field limited to 65,535 bytes.
-          //
-          DEBUG ((EFI_D_INFO, "SmbiosUpdateString: Total length exceeds max 32-bit table length\n"));
-        } else {
-          DEBUG ((EFI_D_INFO, "SmbiosUpdateString: New smbios record add to 32-bit table\n"));
-          SmbiosEntry->Smbios32BitTable = TRUE;
-        }
-      }
+  if (*StrStart == 0) {
+    StrStart++;
+    TargetStrOffset++;
+  }
 
-      if ((This->MajorVersion >= 0x3) && ((PcdGet32 (PcdSmbiosEntryPointProvideMethod) & BIT1) == BIT1)) {
-        //
-        // 64-bit table is produced, check the valid length.
-        //
-        if ((Smbios30EntryPointStructure != NULL) &&
-            (Smbios30EntryPointStructure->TableMaximumSize + InputStrLen - TargetStrLen > SMBIOS_3_0_TABLE_MAX_LENGTH)) {
-          DEBUG ((EFI_D_INFO, "SmbiosUpdateString: Total length exceeds max 64-bit table length\n"));
-        } else {
-          DEBUG ((EFI_D_INFO, "SmbiosUpdateString: New smbios record add to 64-bit table\n"));
-          SmbiosEntry->Smbios64BitTable = TRUE;
-        }
-      }
+  //
+  // Now we get the string target
+  //
+  TargetStrLen = AsciiStrLen(StrStart);
+  if (InputStrLen == TargetStrLen) {
+    AsciiStrCpyS(StrStart, TargetStrLen + 1, String);
+    //
+    // Some UEFI drivers (such as network) need some information in SMBIOS table.
+    // Here we create SMBIOS table and publish it in
+    // configuration table, so other UEFI drivers can get SMBIOS table from
+    // configuration table without depending on PI SMBIOS protocol.
+    //
+    SmbiosTableConstruction (SmbiosEntry->Smbios32BitTable, SmbiosEntry->Smbios64BitTable);
+    EfiReleaseLock (&Private->DataLock);
+    return EFI_SUCCESS;
+  }
 
-      if ((!SmbiosEntry->Smbios32BitTable) && (!SmbiosEntry->Smbios64BitTable)) {
-        EfiReleaseLock (&Private->DataLock);
-        return EFI_UNSUPPORTED;
-      }
+  //
+  // Remember which tables held the record, they must be rebuilt as well.
+  //
+  Smbios32BitTable = SmbiosEntry->Smbios32BitTable;
+  Smbios64BitTable = SmbiosEntry->Smbios64BitTable;
 
+  SmbiosEntry->Smbios32BitTable = FALSE;
+  SmbiosEntry->Smbios64BitTable = FALSE;
+  if ((This->MajorVersion < 0x3) ||
+      ((This->MajorVersion >= 0x3) && ((PcdGet32 (PcdSmbiosEntryPointProvideMethod) & BIT0) == BIT0))) {
+    //
+    // 32-bit table is produced, check the valid length.
+    //
+    if ((EntryPointStructure != NULL) &&
+        (EntryPointStructure->TableLength + InputStrLen - TargetStrLen > SMBIOS_TABLE_MAX_LENGTH)) {
       //
-      // Original string buffer size is not exactly match input string length.
-      // Re-allocate buffer is needed.
+      // The length of the entire structure table (including all strings) must be reported
+      // in the Structure Table Length field of the SMBIOS Structure Table Entry Point,
+      // which is a WORD field limited to 65,535 bytes.
       //
-      NewEntrySize = SmbiosEntry->RecordSize + InputStrLen - TargetStrLen;
-      ResizedSmbiosEntry = AllocateZeroPool (NewEntrySize);
+      DEBUG ((EFI_D_INFO, "SmbiosUpdateString: Total length exceeds max 32-bit table length\n"));
+    } else {
+      DEBUG ((EFI_D_INFO, "SmbiosUpdateString: New smbios record add to 32-bit table\n"));
+      SmbiosEntry->Smbios32BitTable = TRUE;
+    }
+  }
 
-      if (ResizedSmbiosEntry == NULL) {
-        EfiReleaseLock (&Private->DataLock);
-        return EFI_OUT_OF_RESOURCES;
-      }
+  if ((This->MajorVersion >= 0x3) && ((PcdGet32 (PcdSmbiosEntryPointProvideMethod) & BIT1) == BIT1)) {
+    //
+    // 64-bit table is produced, check the valid length.
+    //
+    if ((Smbios30EntryPointStructure != NULL) &&
+        (Smbios30EntryPointStructure->TableMaximumSize + InputStrLen - TargetStrLen > SMBIOS_3_0_TABLE_MAX_LENGTH)) {
+      DEBUG ((EFI_D_INFO, "SmbiosUpdateString: Total length exceeds max 64-bit table length\n"));
+    } else {
+      DEBUG ((EFI_D_INFO, "SmbiosUpdateString: New smbios record add to 64-bit table\n"));
+      SmbiosEntry->Smbios64BitTable = TRUE;
+    }
+  }
 
-      InternalRecord  = (EFI_SMBIOS_RECORD_HEADER *) (ResizedSmbiosEntry + 1);
-      Raw     = (VOID *) (InternalRecord + 1);
+  if ((!SmbiosEntry->Smbios32BitTable) && (!SmbiosEntry->Smbios64BitTable)) {
+    EfiReleaseLock (&Private->DataLock);
+    return EFI_UNSUPPORTED;
+  }
 
-      //
-      // Build internal record Header
-      //
-      InternalRecord->Version     = EFI_SMBIOS_RECORD_HEADER_VERSION;
-      InternalRecord->HeaderSize  = (UINT16) sizeof (EFI_SMBIOS_RECORD_HEADER);
-      InternalRecord->RecordSize  = SmbiosEntry->RecordHeader->RecordSize + InputStrLen - TargetStrLen;
-      InternalRecord->ProducerHandle = SmbiosEntry->RecordHeader->ProducerHandle;
-      InternalRecord->NumberOfStrings = SmbiosEntry->RecordHeader->NumberOfStrings;
+  //
+  // Original string buffer size is not exactly match input string length.
+  // Re-allocate buffer is needed.
+  //
+  NewEntrySize = SmbiosEntry->RecordSize + InputStrLen - TargetStrLen;
+  ResizedSmbiosEntry = AllocateZeroPool (NewEntrySize);
 
-      //
-      // Copy SMBIOS structure and optional strings.
-      //
-      CopyMem (Raw, SmbiosEntry->RecordHeader + 1, Record->Length + TargetStrOffset);
-      CopyMem ((VOID*)((UINTN)Raw + Record->Length + TargetStrOffset), String, InputStrLen + 1);
-      CopyMem ((CHAR8*)((UINTN)Raw + Record->Length + TargetStrOffset + InputStrLen + 1),
-               (CHAR8*)Record + Record->Length + TargetStrOffset + TargetStrLen + 1,
-               SmbiosEntry->RecordHeader->RecordSize - sizeof (EFI_SMBIOS_RECORD_HEADER) - Record->Length - TargetStrOffset - TargetStrLen - 1);
+  if (ResizedSmbiosEntry == NULL) {
+    EfiReleaseLock (&Private->DataLock);
+    return EFI_OUT_OF_RESOURCES;
+  }
 
-      //
-      // Insert new record
-      //
-      ResizedSmbiosEntry->Signature    = EFI_SMBIOS_ENTRY_SIGNATURE;
-      ResizedSmbiosEntry->RecordHeader = InternalRecord;
-      ResizedSmbiosEntry->RecordSize   = NewEntrySize;
-      ResizedSmbiosEntry->Smbios32BitTable = SmbiosEntry->Smbios32BitTable;
-      ResizedSmbiosEntry->Smbios64BitTable = SmbiosEntry->Smbios64BitTable;
-      InsertTailList (Link->ForwardLink, &ResizedSmbiosEntry->Link);
+  InternalRecord  = (EFI_SMBIOS_RECORD_HEADER *) (ResizedSmbiosEntry + 1);
+  Raw     = (VOID *) (InternalRecord + 1);
 
-      //
-      // Remove old record
-      //
-      RemoveEntryList(Link);
-      FreePool(SmbiosEntry);
-      //
-      // Some UEFI drivers (such as network) need some information in SMBIOS table.
-      // Here we create SMBIOS table and publish it in
-      // configuration table, so other UEFI drivers can get SMBIOS table from
-      // configuration table without depending on PI SMBIOS protocol.
-      //
-      SmbiosTableConstruction (ResizedSmbiosEntry->Smbios32BitTable, ResizedSmbiosEntry->Smbios64BitTable);
-      EfiReleaseLock (&Private->DataLock);
-      return EFI_SUCCESS;
-    }
-  }
+  //
+  // Build internal record Header
+  //
+  InternalRecord->Version     = EFI_SMBIOS_RECORD_HEADER_VERSION;
+  InternalRecord->HeaderSize  = (UINT16) sizeof (EFI_SMBIOS_RECORD_HEADER);
+  InternalRecord->RecordSize  = SmbiosEntry->RecordHeader->RecordSize + InputStrLen - TargetStrLen;
+  InternalRecord->ProducerHandle = SmbiosEntry->RecordHeader->ProducerHandle;
+  InternalRecord->NumberOfStrings = SmbiosEntry->RecordHeader->NumberOfStrings;
+
+  //
+  // Copy SMBIOS structure and optional strings.
+  //
+  CopyMem (Raw, SmbiosEntry->RecordHeader + 1, Record->Length + TargetStrOffset);
+  CopyMem ((VOID*)((UINTN)Raw + Record->Length + TargetStrOffset), String, InputStrLen + 1);
+  CopyMem ((CHAR8*)((UINTN)Raw + Record->Length + TargetStrOffset + InputStrLen + 1),
+           (CHAR8*)Record + Record->Length + TargetStrOffset + TargetStrLen + 1,
+           SmbiosEntry->RecordHeader->RecordSize - sizeof (EFI_SMBIOS_RECORD_HEADER) - Record->Length - TargetStrOffset - TargetStrLen - 1);
+
+  //
+  // Insert new record
+  //
+  ResizedSmbiosEntry->Signature    = EFI_SMBIOS_ENTRY_SIGNATURE;
+  ResizedSmbiosEntry->RecordHeader = InternalRecord;
+  ResizedSmbiosEntry->RecordSize   = NewEntrySize;
+  ResizedSmbiosEntry->Smbios32BitTable = SmbiosEntry->Smbios32BitTable;
+  ResizedSmbiosEntry->Smbios64BitTable = SmbiosEntry->Smbios64BitTable;
+  SmbiosInsertEntry (Private, ResizedSmbiosEntry, SmbiosEntry);
 
+  //
+  // Remove old record
+  //
+  SmbiosRemoveEntry (SmbiosEntry);
+  FreePool(SmbiosEntry);
+  //
+  // Some UEFI drivers (such as network) need some information in SMBIOS table.
+  // Here we create SMBIOS table and publish it in
+  // configuration table, so other UEFI drivers can get SMBIOS table from
+  // configuration table without depending on PI SMBIOS protocol.
+  //
+  SmbiosTableConstruction (
+    (BOOLEAN) (Smbios32BitTable || ResizedSmbiosEntry->Smbios32BitTable),
+    (BOOLEAN) (Smbios64BitTable || ResizedSmbiosEntry->Smbios64BitTable)
+    );
   EfiReleaseLock (&Private->DataLock);
-  return EFI_INVALID_PARAMETER;
+  return EFI_SUCCESS;
 }
 
 /**
@@ -791,14 +869,10 @@ SmbiosRemove (
   IN EFI_SMBIOS_HANDLE           SmbiosHandle
   )
 {
-  LIST_ENTRY                 *Link;
-  LIST_ENTRY                 *Head;
   EFI_STATUS                 Status;
   EFI_SMBIOS_HANDLE          MaxSmbiosHandle;
   SMBIOS_INSTANCE            *Private;
   EFI_SMBIOS_ENTRY           *SmbiosEntry;
-  SMBIOS_HANDLE_ENTRY        *HandleEntry;
-  EFI_SMBIOS_TABLE_HEADER    *Record;
 
   //
   // Check args validity
@@ -818,55 +892,42 @@ SmbiosRemove (
     return Status;
   }
 
-  Head = &Private->DataListHead;
-  for (Link = Head->ForwardLink; Link != Head; Link = Link->ForwardLink) {
-    SmbiosEntry = SMBIOS_ENTRY_FROM_LINK(Link);
-    Record = (EFI_SMBIOS_TABLE_HEADER*)(SmbiosEntry->RecordHeader + 1);
-    if (Record->Handle == SmbiosHandle) {
-      //
-      // Remove specified smobios record from DataList
-      //
-      RemoveEntryList(Link);
-      //
-      // Remove this handle from AllocatedHandleList
-      //
-      Head = &Private->AllocatedHandleListHead;
-      for (Link = Head->ForwardLink; Link != Head; Link = Link->ForwardLink) {
-        HandleEntry = SMBIOS_HANDLE_ENTRY_FROM_LINK(Link);
-        if (HandleEntry->SmbiosHandle == SmbiosHandle) {
-          RemoveEntryList(Link);
-          FreePool(HandleEntry);
-          break;
-        }
-      }
-      //
-      // Some UEFI drivers (such as network) need some information in SMBIOS table.
-      // Here we create SMBIOS table and publish it in
-      // configuration table, so other UEFI drivers can get SMBIOS table from
-      // configuration table without depending on PI SMBIOS protocol.
-      //
-      if (SmbiosEntry->Smbios32BitTable) {
-        DEBUG ((EFI_D_INFO, "SmbiosRemove: remove from 32-bit table\n"));
-      }
-      if (SmbiosEntry->Smbios64BitTable) {
-        DEBUG ((EFI_D_INFO, "SmbiosRemove: remove from 64-bit table\n"));
-      }
-      //
-      // Update the whole SMBIOS table again based on which table the removed SMBIOS record is in.
-      //
-      SmbiosTableConstruction (SmbiosEntry->Smbios32BitTable, SmbiosEntry->Smbios64BitTable);
-      FreePool(SmbiosEntry);
-      EfiReleaseLock (&Private->DataLock);
-      return EFI_SUCCESS;
-    }
+  SmbiosEntry = SmbiosFindEntryByHandle (Private, SmbiosHandle);
+  if (SmbiosEntry == NULL) {
+    //
+    // Leave critical section
+    //
+    EfiReleaseLock (&Private->DataLock);
+    return EFI_INVALID_PARAMETER;
   }
 
   //
-  // Leave critical section
+  // Remove specified smobios record from DataList
+  //
+  SmbiosRemoveEntry (SmbiosEntry);
+  //
+  // Release this handle
+  //
+  Private->AllocatedHandleBitmap[SmbiosHandle / 8] &= (UINT8) ~(1 << (SmbiosHandle % 8));
+  //
+  // Some UEFI drivers (such as network) need some information in SMBIOS table.
+  // Here we create SMBIOS table and publish it in
+  // configuration table, so other UEFI drivers can get SMBIOS table from
+  // configuration table without depending on PI SMBIOS protocol.
   //
+  if (SmbiosEntry->Smbios32BitTable) {
+    DEBUG ((EFI_D_INFO, "SmbiosRemove: remove from 32-bit table\n"));
+  }
+  if (SmbiosEntry->Smbios64BitTable) {
+    DEBUG ((EFI_D_INFO, "SmbiosRemove: remove from 64-bit table\n"));
+  }
+  //
+  // Update the whole SMBIOS table again based on which table the removed SMBIOS record is in.
+  //
+  SmbiosTableConstruction (SmbiosEntry->Smbios32BitTable, SmbiosEntry->Smbios64BitTable);
+  FreePool(SmbiosEntry);
   EfiReleaseLock (&Private->DataLock);
-  return EFI_INVALID_PARAMETER;
-
+  return EFI_SUCCESS;
 }
 
 /**
@@ -897,61 +958,79 @@ SmbiosGetNext (
   OUT EFI_HANDLE                    *ProducerHandle OPTIONAL
   )
 {
-  BOOLEAN                  StartPointFound;
   LIST_ENTRY               *Link;
   LIST_ENTRY               *Head;
   SMBIOS_INSTANCE          *Private;
   EFI_SMBIOS_ENTRY         *SmbiosEntry;
+  EFI_SMBIOS_ENTRY         *StartEntry;
   EFI_SMBIOS_TABLE_HEADER  *SmbiosTableHeader;
 
   if (SmbiosHandle == NULL) {
     return EFI_INVALID_PARAMETER;
   }
 
-  StartPointFound = FALSE;
   Private = SMBIOS_INSTANCE_FROM_THIS (This);
-  Head = &Private->DataListHead;
-  for (Link = Head->ForwardLink; Link != Head; Link = Link->ForwardLink) {
-    SmbiosEntry = SMBIOS_ENTRY_FROM_LINK(Link);
-    SmbiosTableHeader = (EFI_SMBIOS_TABLE_HEADER*)(SmbiosEntry->RecordHeader + 1);
+  SmbiosEntry = NULL;
 
+  if (*SmbiosHandle == SMBIOS_HANDLE_PI_RESERVED) {
     //
     // If SmbiosHandle is 0xFFFE, the first matched SMBIOS record handle will be returned
     //
-    if (*SmbiosHandle == SMBIOS_HANDLE_PI_RESERVED) {
-      if ((Type != NULL) && (*Type != SmbiosTableHeader->Type)) {
-        continue;
+    if (Type != NULL) {
+      Head = &Private->TypeListHead[*Type];
+      if (!IsListEmpty (Head)) {
+        SmbiosEntry = SMBIOS_ENTRY_FROM_TYPE_LINK (Head->ForwardLink);
       }
-
-      *SmbiosHandle = SmbiosTableHeader->Handle;
-      *Record =SmbiosTableHeader;
-      if (ProducerHandle != NULL) {
-        *ProducerHandle = SmbiosEntry->RecordHeader->ProducerHandle;
+    } else {
+      Head = &Private->DataListHead;
+      if (!IsListEmpty (Head)) {
+        SmbiosEntry = SMBIOS_ENTRY_FROM_LINK (Head->ForwardLink);
       }
-      return EFI_SUCCESS;
     }
-
+  } else {
     //
     // Start this round search from the next SMBIOS handle
     //
-    if (!StartPointFound && (*SmbiosHandle == SmbiosTableHeader->Handle)) {
-      StartPointFound = TRUE;
-      continue;
-    }
-
-    if (StartPointFound) {
-      if ((Type != NULL) && (*Type != SmbiosTableHeader->Type)) {
-        continue;
-      }
-
-      *SmbiosHandle = SmbiosTableHeader->Handle;
-      *Record = SmbiosTableHeader;
-      if (ProducerHandle != NULL) {
-        *ProducerHandle = SmbiosEntry->RecordHeader->ProducerHandle;
+    StartEntry = SmbiosFindEntryByHandle (Private, *SmbiosHandle);
+    if (StartEntry != NULL) {
+      SmbiosTableHeader = (EFI_SMBIOS_TABLE_HEADER*)(StartEntry->RecordHeader + 1);
+      if (Type == NULL) {
+        Head = &Private->DataListHead;
+        Link = StartEntry->Link.ForwardLink;
+        if (Link != Head) {
+          SmbiosEntry = SMBIOS_ENTRY_FROM_LINK (Link);
+        }
+      } else if (*Type == SmbiosTableHeader->Type) {
+        Head = &Private->TypeListHead[*Type];
+        Link = StartEntry->TypeLink.ForwardLink;
+        if (Link != Head) {
+          SmbiosEntry = SMBIOS_ENTRY_FROM_TYPE_LINK (Link);
+        }
+      } else {
+        //
+        // The start record has another type, look for the first record of
+        // Type that follows it in the record list.
+        //
+        Head = &Private->TypeListHead[*Type];
+        for (Link = Head->ForwardLink; Link != Head; Link = Link->ForwardLink) {
+          SmbiosEntry = SMBIOS_ENTRY_FROM_TYPE_LINK (Link);
+          if (SmbiosEntry->Sequence > StartEntry->Sequence) {
+            break;
+          }
+          SmbiosEntry = NULL;
+        }
       }
+    }
+  }
 
-      return EFI_SUCCESS;
+  if (SmbiosEntry != NULL) {
+    SmbiosTableHeader = (EFI_SMBIOS_TABLE_HEADER*)(SmbiosEntry->RecordHeader + 1);
+    *SmbiosHandle = SmbiosTableHeader->Handle;
+    *Record = SmbiosTableHeader;
+    if (ProducerHandle != NULL) {
+      *ProducerHandle = SmbiosEntry->RecordHeader->ProducerHandle;
     }
+    return EFI_SUCCESS;
   }
 
   *SmbiosHandle = SMBIOS_HANDLE_PI_RESERVED;
@@ -1034,7 +1113,6 @@ SmbiosCreateTable (
 {
   UINT8                           *BufferPointer;
   UINTN                           RecordSize;
-  UINTN                           NumOfStr;
   EFI_STATUS                      Status;
   EFI_SMBIOS_HANDLE               SmbiosHandle;
   EFI_SMBIOS_PROTOCOL             *SmbiosProtocol;
@@ -1105,7 +1183,7 @@ SmbiosCreateTable (
     Status = GetNextSmbiosRecord (SmbiosProtocol, &CurrentSmbiosEntry, &SmbiosRecord);
 
     if ((Status == EFI_SUCCESS) && (CurrentSmbiosEntry->Smbios32BitTable)) {
-      GetSmbiosStructureSize(SmbiosProtocol, SmbiosRecord, &RecordSize, &NumOfStr);
+      RecordSize = CurrentSmbiosEntry->RecordHeader->RecordSize - sizeof (EFI_SMBIOS_RECORD_HEADER);
       //
       // Record NumberOfSmbiosStructures, TableLength and MaxStructureSize
       //
@@ -1155,7 +1233,7 @@ SmbiosCreateTable (
     Status = gBS->AllocatePages (
                     AllocateMaxAddress,
                     EfiRuntimeServicesData,
-                    EFI_SIZE_TO_PAGES (EntryPointStructure->TableLength),
+                    SMBIOS_TABLE_PAGES (EntryPointStructure->TableLength),
                     &PhysicalAddress
                     );
     if (EFI_ERROR (Status)) {
@@ -1164,7 +1242,7 @@ SmbiosCreateTable (
       return EFI_OUT_OF_RESOURCES;
     } else {
       EntryPointStructure->TableAddress = (UINT32) PhysicalAddress;
-      mPreAllocatedPages = EFI_SIZE_TO_PAGES (EntryPointStructure->TableLength);
+      mPreAllocatedPages = SMBIOS_TABLE_PAGES (EntryPointStructure->TableLength);
     }
   }
 
@@ -1178,7 +1256,7 @@ SmbiosCreateTable (
     Status = GetNextSmbiosRecord (SmbiosProtocol, &CurrentSmbiosEntry, &SmbiosRecord);
 
     if ((Status == EFI_SUCCESS) && (CurrentSmbiosEntry->Smbios32BitTable)) {
-      GetSmbiosStructureSize(SmbiosProtocol, SmbiosRecord, &RecordSize, &NumOfStr);
+      RecordSize = CurrentSmbiosEntry->RecordHeader->RecordSize - sizeof (EFI_SMBIOS_RECORD_HEADER);
       CopyMem (BufferPointer, SmbiosRecord, RecordSize);
       BufferPointer = BufferPointer + RecordSize;
     }
@@ -1226,7 +1304,6 @@ SmbiosCreate64BitTable (
 {
   UINT8                           *BufferPointer;
   UINTN                           RecordSize;
-  UINTN                           NumOfStr;
   EFI_STATUS                      Status;
   EFI_SMBIOS_HANDLE               SmbiosHandle;
   EFI_SMBIOS_PROTOCOL             *SmbiosProtocol;
@@ -1282,7 +1359,7 @@ SmbiosCreate64BitTable (
     Status = GetNextSmbiosRecord (SmbiosProtocol, &CurrentSmbiosEntry, &SmbiosRecord);
 
     if ((Status == EFI_SUCCESS) && (CurrentSmbiosEntry->Smbios64BitTable)) {
-      GetSmbiosStructureSize(SmbiosProtocol, SmbiosRecord, &RecordSize, &NumOfStr);
+      RecordSize = CurrentSmbiosEntry->RecordHeader->RecordSize - sizeof (EFI_SMBIOS_RECORD_HEADER);
       //
       // Record TableMaximumSize
       //
@@ -1323,7 +1400,7 @@ SmbiosCreate64BitTable (
     Status = gBS->AllocatePages (
                     AllocateAnyPages,
                     EfiRuntimeServicesData,
-                    EFI_SIZE_TO_PAGES (Smbios30EntryPointStructure->TableMaximumSize),
+                    SMBIOS_TABLE_PAGES (Smbios30EntryPointStructure->TableMaximumSize),
                     &PhysicalAddress
                     );
     if (EFI_ERROR (Status)) {
@@ -1332,7 +1409,7 @@ SmbiosCreate64BitTable (
       return EFI_OUT_OF_RESOURCES;
     } else {
       Smbios30EntryPointStructure->TableAddress = PhysicalAddress;
-      mPre64BitAllocatedPages = EFI_SIZE_TO_PAGES (Smbios30EntryPointStructure->TableMaximumSize);
+      mPre64BitAllocatedPages = SMBIOS_TABLE_PAGES (Smbios30EntryPointStructure->TableMaximumSize);
     }
   }
 
@@ -1349,7 +1426,7 @@ SmbiosCreate64BitTable (
       //
       // This record can be added to 64-bit table
       //
-      GetSmbiosStructureSize(SmbiosProtocol, SmbiosRecord, &RecordSize, &NumOfStr);
+      RecordSize = CurrentSmbiosEntry->RecordHeader->RecordSize - sizeof (EFI_SMBIOS_RECORD_HEADER);
       CopyMem (BufferPointer, SmbiosRecord, RecordSize);
       BufferPointer = BufferPointer + RecordSize;
     }
@@ -1408,6 +1485,95 @@ SmbiosTableConstruction (
   }
 }
 
+/**
+  Append a newly added SMBIOS record to the published tables it belongs to.
+
+  The record is copied over the End-Of-Table structure when the pages
+  already allocated for a table can hold it, otherwise that table is
+  rebuilt from the record list.
+
+  @param  SmbiosEntry         The SMBIOS entry that was just added.
+
+**/
+VOID
+EFIAPI
+SmbiosTableAppend (
+  IN EFI_SMBIOS_ENTRY  *SmbiosEntry
+  )
+{
+  UINT8                           *BufferPointer;
+  UINTN                           RecordSize;
+  UINT32                          TableLength;
+  EFI_SMBIOS_TABLE_END_STRUCTURE  EndStructure;
+  BOOLEAN                         Rebuild32BitTable;
+  BOOLEAN                         Rebuild64BitTable;
+
+  RecordSize        = SmbiosEntry->RecordHeader->RecordSize - sizeof (EFI_SMBIOS_RECORD_HEADER);
+  Rebuild32BitTable = SmbiosEntry->Smbios32BitTable;
+  Rebuild64BitTable = SmbiosEntry->Smbios64BitTable;
+
+  if (Rebuild32BitTable &&
+      (EntryPointStructure != NULL) &&
+      (EntryPointStructure->TableAddress != 0)) {
+    TableLength = (UINT32) (EntryPointStructure->TableLength + RecordSize);
+    if (EFI_SIZE_TO_PAGES (TableLength) <= mPreAllocatedPages) {
+      //
+      // Overwrite the End-Of-Table structure with the record and put it
+      // back behind the record.
+      //
+      BufferPointer = (UINT8 *) (UINTN) EntryPointStructure->TableAddress +
+                      EntryPointStructure->TableLength - sizeof (EndStructure);
+      CopyMem (&EndStructure, BufferPointer, sizeof (EndStructure));
+      CopyMem (BufferPointer, SmbiosEntry->RecordHeader + 1, RecordSize);
+      CopyMem (BufferPointer + RecordSize, &EndStructure, sizeof (EndStructure));
+
+      EntryPointStructure->NumberOfSmbiosStructures++;
+      EntryPointStructure->TableLength = (UINT16) TableLength;
+      if (RecordSize > EntryPointStructure->MaxStructureSize) {
+        EntryPointStructure->MaxStructureSize = (UINT16) RecordSize;
+      }
+
+      EntryPointStructure->IntermediateChecksum = 0;
+      EntryPointStructure->EntryPointStructureChecksum = 0;
+      EntryPointStructure->IntermediateChecksum =
+        CalculateCheckSum8 ((UINT8 *) EntryPointStructure + 0x10, EntryPointStructure->EntryPointLength - 0x10);
+      EntryPointStructure->EntryPointStructureChecksum =
+        CalculateCheckSum8 ((UINT8 *) EntryPointStructure, EntryPointStructure->EntryPointLength);
+
+      gBS->InstallConfigurationTable (&gEfiSmbiosTableGuid, EntryPointStructure);
+      Rebuild32BitTable = FALSE;
+    }
+  }
+
+  if (Rebuild64BitTable &&
+      (Smbios30EntryPointStructure != NULL) &&
+      (Smbios30EntryPointStructure->TableAddress != 0)) {
+    TableLength = (UINT32) (Smbios30EntryPointStructure->TableMaximumSize + RecordSize);
+    if (EFI_SIZE_TO_PAGES (TableLength) <= mPre64BitAllocatedPages) {
+      BufferPointer = (UINT8 *) (UINTN) Smbios30EntryPointStructure->TableAddress +
+                      Smbios30EntryPointStructure->TableMaximumSize - sizeof (EndStructure);
+      CopyMem (&EndStructure, BufferPointer, sizeof (EndStructure));
+      CopyMem (BufferPointer, SmbiosEntry->RecordHeader + 1, RecordSize);
+      CopyMem (BufferPointer + RecordSize, &EndStructure, sizeof (EndStructure));
+
+      Smbios30EntryPointStructure->TableMaximumSize = TableLength;
+
+      Smbios30EntryPointStructure->EntryPointStructureChecksum = 0;
+      Smbios30EntryPointStructure->EntryPointStructureChecksum =
+        CalculateCheckSum8 ((UINT8 *) Smbios30EntryPointStructure, Smbios30EntryPointStructure->EntryPointLength);
+
+      gBS->InstallConfigurationTable (&gEfiSmbios3TableGuid, Smbios30EntryPointStructure);
+      Rebuild64BitTable = FALSE;
+    }
+  }
+
+  //
+  // Fall back to a full rebuild for tables that were not published yet or
+  // have outgrown their pages.
+  //
+  SmbiosTableConstruction (Rebuild32BitTable, Rebuild64BitTable);
+}
+
 /**
 
   Driver to produce Smbios protocol and pre-allocate 1 page for the final SMBIOS table.
@@ -1427,6 +1593,7 @@ SmbiosDriverEntryPoint (
   )
 {
   EFI_STATUS            Status;
+  UINTN                 Index;
 
   mPrivateData.Signature                = SMBIOS_INSTANCE_SIGNATURE;
   mPrivateData.Smbios.Add               = SmbiosAdd;
@@ -1437,7 +1604,12 @@ SmbiosDriverEntryPoint (
   mPrivateData.Smbios.MinorVersion      = (UINT8) (PcdGet16 (PcdSmbiosVersion) & 0x00ff);
 
   InitializeListHead (&mPrivateData.DataListHead);
-  InitializeListHead (&mPrivateData.AllocatedHandleListHead);
+  for (Index = 0; Index < SMBIOS_HANDLE_HASH_SIZE; Index++) {
+    InitializeListHead (&mPrivateData.HandleHashListHead[Index]);
+  }
+  for (Index = 0; Index < SMBIOS_TYPE_COUNT; Index++) {
+    InitializeListHead (&mPrivateData.TypeListHead[Index]);
+  }
   EfiInitializeLock (&mPrivateData.DataLock, TPL_NOTIFY);
 
   //
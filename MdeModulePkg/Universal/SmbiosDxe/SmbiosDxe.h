@@ -25,6 +25,23 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Library/UefiBootServicesTableLib.h>
 #include <Library/PcdLib.h>
 
+//
+// Number of buckets of the SMBIOS handle hash. Records are hashed by the low
+// byte of their handle.
+//
+#define SMBIOS_HANDLE_HASH_SIZE  256
+
+//
+// Number of SMBIOS structure types, one record list per type.
+//
+#define SMBIOS_TYPE_COUNT        256
+
+//
+// Pages allocated for a table of Length bytes. Half the length again is kept
+// as slack so that records added later can be appended in place.
+//
+#define SMBIOS_TABLE_PAGES(Length)  EFI_SIZE_TO_PAGES ((UINTN) (Length) + (UINTN) (Length) / 2)
+
 #define SMBIOS_INSTANCE_SIGNATURE SIGNATURE_32 ('S', 'B', 'i', 's')
 typedef struct {
   UINT32                Signature;
@@ -42,9 +59,21 @@ typedef struct {
   //
   LIST_ENTRY            DataListHead;
   //
-  // List of allocated SMBIOS handle.
+  // Bitmap of allocated SMBIOS handles.
+  //
+  UINT8                 AllocatedHandleBitmap[(MAX_UINT16 + 1) / 8];
   //
-  LIST_ENTRY            AllocatedHandleListHead;
+  // EFI_SMBIOS_ENTRY structures hashed by SMBIOS handle.
+  //
+  LIST_ENTRY            HandleHashListHead[SMBIOS_HANDLE_HASH_SIZE];
+  //
+  // EFI_SMBIOS_ENTRY structures of each SMBIOS type, in DataListHead order.
+  //
+  LIST_ENTRY            TypeListHead[SMBIOS_TYPE_COUNT];
+  //
+  // Sequence number given to the next record added to DataListHead.
+  //
+  UINTN                 NextSequence;
 } SMBIOS_INSTANCE;
 
 #define SMBIOS_INSTANCE_FROM_THIS(this)  CR (this, SMBIOS_INSTANCE, Smbios, SMBIOS_INSTANCE_SIGNATURE)
@@ -81,26 +110,20 @@ typedef struct {
   //
   BOOLEAN                   Smbios32BitTable;
   BOOLEAN                   Smbios64BitTable;
-} EFI_SMBIOS_ENTRY;
-
-#define SMBIOS_ENTRY_FROM_LINK(link)  CR (link, EFI_SMBIOS_ENTRY, Link, EFI_SMBIOS_ENTRY_SIGNATURE)
-
-//
-// Private data to contain the Smbios handle that already allocated.
-//
-#define SMBIOS_HANDLE_ENTRY_SIGNATURE  SIGNATURE_32 ('S', 'h', 'r', 'd')
-
-typedef struct {
-  UINT32               Signature;
-  LIST_ENTRY           Link;
   //
-  // Filter driver will register what record guid filter should be used.
+  // Links into the handle hash and into the list of records of the same type.
   //
-  EFI_SMBIOS_HANDLE    SmbiosHandle;
-
-} SMBIOS_HANDLE_ENTRY;
+  LIST_ENTRY                HandleLink;
+  LIST_ENTRY                TypeLink;
+  //
+  // Position of the record in DataListHead, increasing along the list.
+  //
+  UINTN                     Sequence;
+} EFI_SMBIOS_ENTRY;
 
-#define SMBIOS_HANDLE_ENTRY_FROM_LINK(link)  CR (link, SMBIOS_HANDLE_ENTRY, Link, SMBIOS_HANDLE_ENTRY_SIGNATURE)
+#define SMBIOS_ENTRY_FROM_LINK(link)  CR (link, EFI_SMBIOS_ENTRY, Link, EFI_SMBIOS_ENTRY_SIGNATURE)
+#define SMBIOS_ENTRY_FROM_HANDLE_LINK(link)  CR (link, EFI_SMBIOS_ENTRY, HandleLink, EFI_SMBIOS_ENTRY_SIGNATURE)
+#define SMBIOS_ENTRY_FROM_TYPE_LINK(link)  CR (link, EFI_SMBIOS_ENTRY, TypeLink, EFI_SMBIOS_ENTRY_SIGNATURE)
 
 typedef struct {
   EFI_SMBIOS_TABLE_HEADER  Header;
@@ -121,4 +144,20 @@ SmbiosTableConstruction (
   BOOLEAN     Smbios64BitTable
   );
 
+/**
+  Append a newly added SMBIOS record to the published tables it belongs to.
+
+  The record is copied over the End-Of-Table structure when the pages
+  already allocated for a table can hold it, otherwise that table is
+  rebuilt from the record list.
+
+  @param  SmbiosEntry         The SMBIOS entry that was just added.
+
+**/
+VOID
+EFIAPI
+SmbiosTableAppend (
+  IN EFI_SMBIOS_ENTRY  *SmbiosEntry
+  );
+
 #endif
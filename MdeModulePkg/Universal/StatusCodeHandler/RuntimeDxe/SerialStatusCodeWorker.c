@@ -8,6 +8,229 @@
 
 #include "StatusCodeHandlerRuntimeDxe.h"
 
+//
+// Formatted status codes waiting to be sent to the serial port, kept in a
+// circular buffer when PcdStatusCodeSerialBufferSize is not zero. The buffer
+// is drained from a periodic timer and from the idle loop, a burst at a time
+// and only while the serial port can take it without waiting.
+//
+#define SERIAL_STATUS_CODE_DRAIN_INTERVAL  10000     // 1ms in 100ns units
+#define SERIAL_STATUS_CODE_DRAIN_BURST     16
+
+UINT8      *mSerialStatusCodeBuffer     = NULL;
+UINTN      mSerialStatusCodeBufferSize  = 0;
+UINTN      mSerialStatusCodeBufferHead  = 0;
+UINTN      mSerialStatusCodeBufferCount = 0;
+EFI_EVENT  mSerialStatusCodeTimerEvent  = NULL;
+EFI_EVENT  mSerialStatusCodeIdleEvent   = NULL;
+
+/**
+  Send the oldest buffered bytes to the serial port.
+
+  The caller must be at TPL_HIGH_LEVEL.
+
+  @param  Length           The maximum number of bytes to send.
+
+**/
+VOID
+SerialStatusCodeSendBuffered (
+  IN UINTN  Length
+  )
+{
+  UINTN  Chunk;
+
+  Length = MIN (Length, mSerialStatusCodeBufferCount);
+  while (Length > 0) {
+    Chunk = MIN (Length, mSerialStatusCodeBufferSize - mSerialStatusCodeBufferHead);
+    SerialPortWrite (&mSerialStatusCodeBuffer[mSerialStatusCodeBufferHead], Chunk);
+    mSerialStatusCodeBufferHead += Chunk;
+    if (mSerialStatusCodeBufferHead == mSerialStatusCodeBufferSize) {
+      mSerialStatusCodeBufferHead = 0;
+    }
+
+    mSerialStatusCodeBufferCount -= Chunk;
+    Length                       -= Chunk;
+  }
+}
+
+/**
+  Send buffered status codes while the serial port can accept them without
+  waiting.
+
+  @param  Event         Event whose notification function is being invoked.
+  @param  Context       Pointer to the notification function's context, which is
+                        always zero in current implementation.
+
+**/
+VOID
+EFIAPI
+SerialStatusCodeDrain (
+  IN EFI_EVENT        Event,
+  IN VOID             *Context
+  )
+{
+  EFI_TPL     OldTpl;
+  EFI_STATUS  Status;
+  UINT32      Control;
+
+  OldTpl = gBS->RaiseTPL (TPL_HIGH_LEVEL);
+  while (mSerialStatusCodeBufferCount > 0) {
+    Status = SerialPortGetControl (&Control);
+    if (!EFI_ERROR (Status) && ((Control & EFI_SERIAL_OUTPUT_BUFFER_EMPTY) == 0)) {
+      break;
+    }
+
+    SerialStatusCodeSendBuffered (SERIAL_STATUS_CODE_DRAIN_BURST);
+
+    if (EFI_ERROR (Status)) {
+      //
+      // The serial port cannot tell whether it is ready, so send a single
+      // burst per call rather than risk waiting on it here.
+      //
+      break;
+    }
+  }
+
+  gBS->RestoreTPL (OldTpl);
+}
+
+/**
+  Send all buffered status codes to the serial port, waiting for it as needed.
+
+**/
+VOID
+SerialStatusCodeFlush (
+  VOID
+  )
+{
+  EFI_TPL  OldTpl;
+
+  if (mSerialStatusCodeBufferCount == 0) {
+    return;
+  }
+
+  OldTpl = gBS->RaiseTPL (TPL_HIGH_LEVEL);
+  SerialStatusCodeSendBuffered (mSerialStatusCodeBufferCount);
+  gBS->RestoreTPL (OldTpl);
+}
+
+/**
+  Allocate the serial status code buffer and start draining it, if
+  PcdStatusCodeSerialBufferSize is not zero. Status codes are sent to the
+  serial port synchronously if the buffer cannot be set up.
+
+**/
+VOID
+SerialStatusCodeInitializeBuffer (
+  VOID
+  )
+{
+  EFI_STATUS  Status;
+  UINTN       Size;
+
+  Size = PcdGet32 (PcdStatusCodeSerialBufferSize);
+  if (Size == 0) {
+    return;
+  }
+
+  mSerialStatusCodeBuffer = AllocatePool (Size);
+  if (mSerialStatusCodeBuffer == NULL) {
+    return;
+  }
+
+  Status = gBS->CreateEvent (
+                  EVT_TIMER | EVT_NOTIFY_SIGNAL,
+                  TPL_CALLBACK,
+                  SerialStatusCodeDrain,
+                  NULL,
+                  &mSerialStatusCodeTimerEvent
+                  );
+  if (!EFI_ERROR (Status)) {
+    Status = gBS->SetTimer (
+                    mSerialStatusCodeTimerEvent,
+                    TimerPeriodic,
+                    SERIAL_STATUS_CODE_DRAIN_INTERVAL
+                    );
+  }
+
+  if (EFI_ERROR (Status)) {
+    if (mSerialStatusCodeTimerEvent != NULL) {
+      gBS->CloseEvent (mSerialStatusCodeTimerEvent);
+      mSerialStatusCodeTimerEvent = NULL;
+    }
+
+    FreePool (mSerialStatusCodeBuffer);
+    mSerialStatusCodeBuffer = NULL;
+    return;
+  }
+
+  //
+  // The idle loop drains the buffer whenever the CPU would otherwise wait.
+  // The timer alone is enough if the event cannot be created.
+  //
+  gBS->CreateEventEx (
+         EVT_NOTIFY_SIGNAL,
+         TPL_CALLBACK,
+         SerialStatusCodeDrain,
+         NULL,
+         &gIdleLoopEventGuid,
+         &mSerialStatusCodeIdleEvent
+         );
+
+  mSerialStatusCodeBufferSize = Size;
+}
+
+/**
+  Send a formatted status code to the serial port, or queue it in the serial
+  status code buffer.
+
+  @param  Buffer           The formatted status code.
+  @param  Length           The length of Buffer in bytes.
+  @param  Immediate        TRUE to send the status code, and everything queued
+                           before it, before returning.
+
+**/
+VOID
+SerialStatusCodeWrite (
+  IN UINT8    *Buffer,
+  IN UINTN    Length,
+  IN BOOLEAN  Immediate
+  )
+{
+  EFI_TPL  OldTpl;
+  UINTN    Tail;
+  UINTN    Chunk;
+
+  if ((mSerialStatusCodeBufferSize == 0) || EfiAtRuntime ()) {
+    SerialPortWrite (Buffer, Length);
+    return;
+  }
+
+  OldTpl = gBS->RaiseTPL (TPL_HIGH_LEVEL);
+
+  if (Immediate || (Length > mSerialStatusCodeBufferSize)) {
+    SerialStatusCodeSendBuffered (mSerialStatusCodeBufferCount);
+    SerialPortWrite (Buffer, Length);
+    gBS->RestoreTPL (OldTpl);
+    return;
+  }
+
+  //
+  // Make room by sending the oldest status codes if the buffer is full.
+  //
+  if (Length > mSerialStatusCodeBufferSize - mSerialStatusCodeBufferCount) {
+    SerialStatusCodeSendBuffered (Length - (mSerialStatusCodeBufferSize - mSerialStatusCodeBufferCount));
+  }
+
+  Tail = (mSerialStatusCodeBufferHead + mSerialStatusCodeBufferCount) % mSerialStatusCodeBufferSize;
+  Chunk = MIN (Length, mSerialStatusCodeBufferSize - Tail);
+  CopyMem (&mSerialStatusCodeBuffer[Tail], Buffer, Chunk);
+  CopyMem (mSerialStatusCodeBuffer, Buffer + Chunk, Length - Chunk);
+  mSerialStatusCodeBufferCount += Length;
+
+  gBS->RestoreTPL (OldTpl);
+}
+
 /**
   Convert status code value and extended data to readable ASCII string, send string to serial I/O device.
 
@@ -45,8 +268,28 @@ SerialStatusCodeReportWorker (
   UINT32          LineNumber;
   UINTN           CharCount;
   BASE_LIST       Marker;
+  BOOLEAN         ExitBootServices;
+  BOOLEAN         Immediate;
+
+  ExitBootServices = (BOOLEAN) ((CodeType & EFI_STATUS_CODE_TYPE_MASK) == EFI_PROGRESS_CODE &&
+                                Value == (EFI_SOFTWARE_EFI_BOOT_SERVICE | EFI_SW_BS_PC_EXIT_BOOT_SERVICES));
+
+  if ((PcdGet32 (PcdStatusCodeSerialCodeTypeMask) & EDKII_RSC_CODE_TYPE_BIT (CodeType)) !=
+      EDKII_RSC_CODE_TYPE_BIT (CodeType)) {
+    if (ExitBootServices) {
+      SerialStatusCodeFlush ();
+      UnregisterSerialBootTimeHandlers ();
+    }
+    return EFI_SUCCESS;
+  }
 
   Buffer[0] = '\0';
+  //
+  // Errors and ASSERT()s go out before returning, as the system may not get
+  // far enough to drain the buffer, and nothing drains it once boot services
+  // are gone.
+  //
+  Immediate = (BOOLEAN) ((CodeType & EFI_STATUS_CODE_TYPE_MASK) == EFI_ERROR_CODE || ExitBootServices);
 
   if (Data != NULL &&
       ReportStatusCodeExtractAssertInfo (CodeType, Value, Data, &Filename, &Description, &LineNumber)) {
@@ -149,15 +392,14 @@ SerialStatusCodeReportWorker (
   //
   // Call SerialPort Lib function to do print.
   //
-  SerialPortWrite ((UINT8 *) Buffer, CharCount);
+  SerialStatusCodeWrite ((UINT8 *) Buffer, CharCount, Immediate);
 
   //
   // If register an unregister function of gEfiEventExitBootServicesGuid,
   // then some log called in ExitBootServices() will be lost,
   // so unregister the handler after receive the value of exit boot service.
   //
-  if ((CodeType & EFI_STATUS_CODE_TYPE_MASK) == EFI_PROGRESS_CODE &&
-      Value == (EFI_SOFTWARE_EFI_BOOT_SERVICE | EFI_SW_BS_PC_EXIT_BOOT_SERVICES)) {
+  if (ExitBootServices) {
     UnregisterSerialBootTimeHandlers();
   }
 
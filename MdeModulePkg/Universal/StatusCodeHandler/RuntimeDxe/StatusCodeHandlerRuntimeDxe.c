@@ -80,6 +80,8 @@ InitializationDispatcherWorker (
     //
     Status = SerialPortInitialize ();
     ASSERT_EFI_ERROR (Status);
+
+    SerialStatusCodeInitializeBuffer ();
   }
   if (PcdGetBool (PcdStatusCodeUseMemory)) {
     Status = RtMemoryStatusCodeInitializeWorker ();
@@ -151,7 +153,8 @@ StatusCodeHandlerRuntimeDxeEntry (
   IN EFI_SYSTEM_TABLE   *SystemTable
   )
 {
-  EFI_STATUS                Status;
+  EFI_STATUS                         Status;
+  EDKII_RSC_HANDLER_FILTER_PROTOCOL  *RscHandlerFilter;
 
   Status = gBS->LocateProtocol (
                   &gEfiRscHandlerProtocolGuid,
@@ -167,6 +170,24 @@ StatusCodeHandlerRuntimeDxeEntry (
 
   if (PcdGetBool (PcdStatusCodeUseSerial)) {
     mRscHandlerProtocol->Register (SerialStatusCodeReportWorker, TPL_HIGH_LEVEL);
+
+    //
+    // Let the router skip the code types the serial handler discards. Progress
+    // codes are always needed to see ExitBootServices().
+    //
+    if (PcdGet32 (PcdStatusCodeSerialCodeTypeMask) != EDKII_RSC_CODE_TYPE_ALL) {
+      Status = gBS->LocateProtocol (
+                      &gEdkiiRscHandlerFilterProtocolGuid,
+                      NULL,
+                      (VOID **) &RscHandlerFilter
+                      );
+      if (!EFI_ERROR (Status)) {
+        RscHandlerFilter->SetFilter (
+                            SerialStatusCodeReportWorker,
+                            PcdGet32 (PcdStatusCodeSerialCodeTypeMask) | EDKII_RSC_CODE_TYPE_BIT (EFI_PROGRESS_CODE)
+                            );
+      }
+    }
   }
   if (PcdGetBool (PcdStatusCodeUseMemory)) {
     mRscHandlerProtocol->Register (RtMemoryStatusCodeReportWorker, TPL_HIGH_LEVEL);
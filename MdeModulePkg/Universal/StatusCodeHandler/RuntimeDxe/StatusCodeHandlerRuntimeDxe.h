@@ -11,11 +11,13 @@
 #define __STATUS_CODE_HANDLER_RUNTIME_DXE_H__
 
 #include <Protocol/ReportStatusCodeHandler.h>
+#include <Protocol/RscHandlerFilter.h>
 
 #include <Guid/MemoryStatusCodeRecord.h>
 #include <Guid/StatusCodeDataTypeId.h>
 #include <Guid/StatusCodeDataTypeDebug.h>
 #include <Guid/EventGroup.h>
+#include <Guid/IdleLoopEvent.h>
 
 #include <Library/SynchronizationLib.h>
 #include <Library/BaseMemoryLib.h>
@@ -49,6 +51,26 @@ EfiSerialStatusCodeInitializeWorker (
   );
 
 
+/**
+  Allocate the serial status code buffer and start draining it, if
+  PcdStatusCodeSerialBufferSize is not zero. Status codes are sent to the
+  serial port synchronously if the buffer cannot be set up.
+
+**/
+VOID
+SerialStatusCodeInitializeBuffer (
+  VOID
+  );
+
+/**
+  Send all buffered status codes to the serial port, waiting for it as needed.
+
+**/
+VOID
+SerialStatusCodeFlush (
+  VOID
+  );
+
 /**
   Convert status code value and extended data to readable ASCII string, send string to serial I/O device.
 
@@ -775,6 +775,12 @@ Reclaim (
   }
 
 Done:
+  //
+  // The variables of the store have been moved, index the store again on the next lookup.
+  //
+  InvalidateVariableStoreIndex ((VARIABLE_STORE_HEADER *) (UINTN) VariableBase);
+  InvalidateVariableStoreIndex (mNvVariableCache);
+
   DoneStatus = EFI_SUCCESS;
   if (IsVolatile || mVariableModuleGlobal->VariableGlobal.EmuNvMode) {
     DoneStatus = SynchronizeRuntimeVariableCache (
@@ -3124,7 +3130,81 @@ ReclaimForOS(
             0
             );
     ASSERT_EFI_ERROR (Status);
+  } else {
+    ReclaimOnThreshold ();
+  }
+}
+
+/**
+  This function reclaims the non-volatile variable storage ahead of time if the
+  deleted variables in it take more than PcdVariableReclaimThreshold percent of
+  the storage, so that a later SetVariable () rarely has to reclaim it inline.
+
+  It is meant to be called where the latency of a reclaim does not matter, like
+  an idle boot loop, ReadyToBoot or ExitBootServices. It does nothing at runtime.
+
+  Caution: This function may be invoked at SMM mode.
+  Care must be taken to make sure not security issue.
+
+**/
+VOID
+ReclaimOnThreshold (
+  VOID
+  )
+{
+  EFI_STATUS                     Status;
+  VARIABLE_HEADER                *Variable;
+  VARIABLE_HEADER                *NextVariable;
+  UINTN                          DeletedVariableSize;
+  UINT32                         Threshold;
+  STATIC UINTN                   CheckedOffset;
+
+  Threshold = PcdGet32 (PcdVariableReclaimThreshold);
+  if (Threshold == 0 || AtRuntime ()) {
+    return;
+  }
+
+  if (mVariableModuleGlobal->FvbInstance == NULL && !mVariableModuleGlobal->VariableGlobal.EmuNvMode) {
+    //
+    // The non-volatile variable storage is not writable yet.
+    //
+    return;
+  }
+
+  //
+  // Only parse the storage again after variables have been written to it.
+  //
+  if (mVariableModuleGlobal->NonVolatileLastVariableOffset == CheckedOffset) {
+    return;
+  }
+
+  DeletedVariableSize = 0;
+  Variable = GetStartPointer (mNvVariableCache);
+  while (IsValidVariableHeader (Variable, GetEndPointer (mNvVariableCache))) {
+    NextVariable = GetNextVariablePtr (Variable, mVariableModuleGlobal->VariableGlobal.AuthFormat);
+    if (Variable->State != VAR_ADDED && Variable->State != (VAR_IN_DELETED_TRANSITION & VAR_ADDED)) {
+      DeletedVariableSize += (UINTN) NextVariable - (UINTN) Variable;
+    }
+
+    Variable = NextVariable;
+  }
+
+  if (DeletedVariableSize * 100 > (UINTN) Threshold * mNvVariableCache->Size) {
+    DEBUG ((DEBUG_INFO, "Variable driver: reclaim 0x%x bytes of deleted variables ahead of time.\n", DeletedVariableSize));
+    Status = Reclaim (
+               mVariableModuleGlobal->VariableGlobal.NonVolatileVariableBase,
+               &mVariableModuleGlobal->NonVolatileLastVariableOffset,
+               FALSE,
+               NULL,
+               NULL,
+               0
+               );
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_ERROR, "Variable driver: reclaim ahead of time failed - %r\n", Status));
+    }
   }
+
+  CheckedOffset = mVariableModuleGlobal->NonVolatileLastVariableOffset;
 }
 
 /**
@@ -3268,6 +3348,7 @@ FlushHobVariableToFlash (
       if (mVariableModuleGlobal->VariableGlobal.VariableRuntimeCacheContext.HobFlushComplete != NULL) {
         *(mVariableModuleGlobal->VariableGlobal.VariableRuntimeCacheContext.HobFlushComplete) = TRUE;
       }
+      DestroyVariableStoreIndex (VariableStoreHeader);
       if (!AtRuntime ()) {
         FreePool ((VOID *) VariableStoreHeader);
       }
@@ -3658,6 +3739,13 @@ VariableCommonInitialize (
   VolatileVariableStore->Reserved    = 0;
   VolatileVariableStore->Reserved1   = 0;
 
+  //
+  // The variable stores are only rewritten by Reclaim (), which invalidates their indexes.
+  //
+  CreateVariableStoreIndex (VolatileVariableStore, TRUE);
+  CreateVariableStoreIndex ((VARIABLE_STORE_HEADER *) (UINTN) mVariableModuleGlobal->VariableGlobal.HobVariableBase, TRUE);
+  CreateVariableStoreIndex (mNvVariableCache, TRUE);
+
   return EFI_SUCCESS;
 }
 
@@ -383,6 +383,17 @@ ReclaimForOS(
   VOID
   );
 
+/**
+  This function reclaims the non-volatile variable storage ahead of time if the
+  deleted variables in it take more than PcdVariableReclaimThreshold percent of
+  the storage. It does nothing at runtime.
+
+**/
+VOID
+ReclaimOnThreshold (
+  VOID
+  );
+
 /**
   Get maximum variable size, covering both non-volatile and volatile variables.
 
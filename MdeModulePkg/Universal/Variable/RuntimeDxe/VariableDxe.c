@@ -11,7 +11,9 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 **/
 
 #include "Variable.h"
+#include "VariableParsing.h"
 
+#include <Guid/IdleLoopEvent.h>
 #include <Protocol/VariablePolicy.h>
 #include <Library/VariablePolicyLib.h>
 
@@ -266,6 +268,13 @@ VariableClassAddressChangeEvent (
   EfiConvertPointer (0x0, (VOID **) &mNvVariableCache);
   EfiConvertPointer (0x0, (VOID **) &mNvFvHeaderCache);
 
+  for (Index = 0; Index < ARRAY_SIZE (mVariableStoreIndex); Index++) {
+    if (mVariableStoreIndex[Index] != NULL) {
+      EfiConvertPointer (0x0, (VOID **) &mVariableStoreIndex[Index]->StartPtr);
+      EfiConvertPointer (0x0, (VOID **) &mVariableStoreIndex[Index]);
+    }
+  }
+
   if (mAuthContextOut.AddressPointer != NULL) {
     for (Index = 0; Index < mAuthContextOut.AddressPointerCount; Index++) {
       EfiConvertPointer (0x0, (VOID **) mAuthContextOut.AddressPointer[Index]);
@@ -362,6 +371,28 @@ OnEndOfDxe (
   gBS->CloseEvent (Event);
 }
 
+/**
+  Notification function of the idle loop event group.
+
+  Reclaims the non-volatile variable storage while the system waits for an event,
+  if enough of it is taken by deleted variables.
+
+  @param  Event        Event whose notification function is being invoked.
+  @param  Context      Pointer to the notification function's context.
+
+**/
+VOID
+EFIAPI
+OnIdleLoop (
+  EFI_EVENT                               Event,
+  VOID                                    *Context
+  )
+{
+  AcquireLockOnlyAtBootTime (&mVariableModuleGlobal->VariableGlobal.VariableServicesLock);
+  ReclaimOnThreshold ();
+  ReleaseLockOnlyAtBootTime (&mVariableModuleGlobal->VariableGlobal.VariableServicesLock);
+}
+
 /**
   Initializes variable write service for DXE.
 
@@ -535,6 +566,7 @@ VariableServiceInitialize (
   EFI_STATUS                            Status;
   EFI_EVENT                             ReadyToBootEvent;
   EFI_EVENT                             EndOfDxeEvent;
+  EFI_EVENT                             IdleLoopEvent;
 
   Status = VariableCommonInitialize ();
   ASSERT_EFI_ERROR (Status);
@@ -623,6 +655,21 @@ VariableServiceInitialize (
                   );
   ASSERT_EFI_ERROR (Status);
 
+  if (PcdGet32 (PcdVariableReclaimThreshold) != 0) {
+    //
+    // Register the event handling function to reclaim variable space while the system is idle.
+    //
+    Status = gBS->CreateEventEx (
+                    EVT_NOTIFY_SIGNAL,
+                    TPL_CALLBACK,
+                    OnIdleLoop,
+                    NULL,
+                    &gIdleLoopEventGuid,
+                    &IdleLoopEvent
+                    );
+    ASSERT_EFI_ERROR (Status);
+  }
+
   // Register and initialize the VariablePolicy engine.
   Status = InitVariablePolicyLib (VariableServiceGetVariable);
   ASSERT_EFI_ERROR (Status);
@@ -9,6 +9,8 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #include "VariableParsing.h"
 
+VARIABLE_STORE_INDEX  *mVariableStoreIndex[VariableStoreTypeMax];
+
 /**
 
   This code checks if variable header is valid or not.
@@ -437,9 +439,302 @@ VariableCompareTimeStampInternal (
   return (BOOLEAN) (FirstTime->Second <= SecondTime->Second);
 }
 
+/**
+  Compute the hash the variable store index uses for a variable name and vendor GUID.
+
+  @param[in]  Name          Pointer to the variable name.
+  @param[in]  NameLength    Maximum number of characters of Name to hash. The hash stops
+                            at the first NULL character.
+  @param[in]  Guid          Pointer to the vendor GUID.
+
+  @return The hash of Name and Guid.
+
+**/
+STATIC
+UINT32
+VariableStoreIndexHash (
+  IN CONST CHAR16           *Name,
+  IN UINTN                  NameLength,
+  IN CONST EFI_GUID         *Guid
+  )
+{
+  UINT32                    Hash;
+  UINTN                     Index;
+
+  Hash = ReadUnaligned32 ((CONST UINT32 *) Guid) ^ ReadUnaligned32 ((CONST UINT32 *) Guid + 1) ^
+         ReadUnaligned32 ((CONST UINT32 *) Guid + 2) ^ ReadUnaligned32 ((CONST UINT32 *) Guid + 3);
+  for (Index = 0; Index < NameLength && Name[Index] != 0; Index++) {
+    Hash = (Hash ^ Name[Index]) * 0x01000193;
+  }
+
+  return Hash;
+}
+
+#define VARIABLE_STORE_INDEX_BUCKET(Hash)  (((Hash) ^ ((Hash) >> 16)) & (VARIABLE_STORE_INDEX_BUCKETS - 1))
+#define VARIABLE_STORE_INDEX_TAG(Hash)     ((UINT16) ((Hash) >> 16))
+
+/**
+  Get the index of the variable store whose variables start at StartPtr.
+
+  @param[in]  StartPtr      Start of the variables of the variable store.
+
+  @return The index of the variable store, or NULL if the store is not indexed.
+
+**/
+STATIC
+VARIABLE_STORE_INDEX *
+GetVariableStoreIndex (
+  IN VARIABLE_HEADER        *StartPtr
+  )
+{
+  UINTN                     Index;
+
+  for (Index = 0; Index < ARRAY_SIZE (mVariableStoreIndex); Index++) {
+    if (mVariableStoreIndex[Index] != NULL && mVariableStoreIndex[Index]->StartPtr == StartPtr) {
+      return mVariableStoreIndex[Index];
+    }
+  }
+
+  return NULL;
+}
+
+/**
+  Empty a variable store index, so that the next lookup indexes the store from its start.
+
+  @param[in, out]  StoreIndex  Pointer to the variable store index.
+
+**/
+STATIC
+VOID
+ResetVariableStoreIndex (
+  IN OUT VARIABLE_STORE_INDEX  *StoreIndex
+  )
+{
+  StoreIndex->IndexedSize = 0;
+  StoreIndex->Count       = 0;
+  ZeroMem (StoreIndex->Head, sizeof (StoreIndex->Head));
+  ZeroMem (StoreIndex->Tail, sizeof (StoreIndex->Tail));
+}
+
+/**
+  Add the variables written to a variable store since it was last indexed to its index.
+
+  Variables are only ever appended to a variable store and their state only moves from
+  VAR_ADDED towards VAR_DELETED until the store is reclaimed. So the scan indexes every
+  VAR_ADDED or VAR_IN_DELETED_TRANSITION variable, skips deleted ones, and stops at the
+  first variable that may still become VAR_ADDED, or when the index is full.
+
+  @param[in, out]  StoreIndex  Pointer to the variable store index.
+  @param[in]       EndPtr      End of the variable store.
+  @param[in]       AuthFormat  TRUE indicates authenticated variables are used.
+                               FALSE indicates authenticated variables are not used.
+
+**/
+STATIC
+VOID
+UpdateVariableStoreIndex (
+  IN OUT VARIABLE_STORE_INDEX  *StoreIndex,
+  IN     VARIABLE_HEADER       *EndPtr,
+  IN     BOOLEAN               AuthFormat
+  )
+{
+  VARIABLE_STORE_INDEX_ENTRY   *Entries;
+  VARIABLE_HEADER              *Variable;
+  UINT32                       Hash;
+  UINTN                        Bucket;
+
+  Entries  = VARIABLE_STORE_INDEX_ENTRIES (StoreIndex);
+  Variable = (VARIABLE_HEADER *) ((UINTN) StoreIndex->StartPtr + StoreIndex->IndexedSize);
+  while (IsValidVariableHeader (Variable, EndPtr)) {
+    if (Variable->State == VAR_ADDED || Variable->State == (VAR_IN_DELETED_TRANSITION & VAR_ADDED)) {
+      if (StoreIndex->Count == StoreIndex->MaxCount) {
+        break;
+      }
+
+      Hash   = VariableStoreIndexHash (
+                 GetVariableNamePtr (Variable, AuthFormat),
+                 NameSizeOfVariable (Variable, AuthFormat) / sizeof (CHAR16),
+                 GetVendorGuidPtr (Variable, AuthFormat)
+                 );
+      Bucket = VARIABLE_STORE_INDEX_BUCKET (Hash);
+
+      Entries[StoreIndex->Count].Offset = (UINT32) ((UINTN) Variable - (UINTN) StoreIndex->StartPtr);
+      Entries[StoreIndex->Count].Hash   = VARIABLE_STORE_INDEX_TAG (Hash);
+      Entries[StoreIndex->Count].Next   = 0;
+      if (StoreIndex->Tail[Bucket] == 0) {
+        StoreIndex->Head[Bucket] = (UINT16) (StoreIndex->Count + 1);
+      } else {
+        Entries[StoreIndex->Tail[Bucket] - 1].Next = (UINT16) (StoreIndex->Count + 1);
+      }
+      StoreIndex->Tail[Bucket] = (UINT16) (StoreIndex->Count + 1);
+      StoreIndex->Count++;
+    } else if ((Variable->State & (UINT8) (~VAR_DELETED)) != 0) {
+      //
+      // Neither added nor deleted, the variable is still being written.
+      //
+      break;
+    }
+
+    Variable = GetNextVariablePtr (Variable, AuthFormat);
+  }
+
+  StoreIndex->IndexedSize = (UINTN) Variable - (UINTN) StoreIndex->StartPtr;
+}
+
+/**
+  Create the hash index FindVariableEx () uses to look up variables by name and
+  vendor GUID in the given variable store.
+
+  The index is filled lazily by the lookups. If it cannot be created, FindVariableEx ()
+  keeps walking the variable store.
+
+  @param[in]  VariableStoreHeader  Pointer to the variable store to index.
+  @param[in]  Authoritative        TRUE if the caller calls InvalidateVariableStoreIndex ()
+                                   whenever the layout of the variable store is rewritten.
+                                   FALSE if the store may be rewritten behind the index.
+
+**/
+VOID
+CreateVariableStoreIndex (
+  IN  VARIABLE_STORE_HEADER   *VariableStoreHeader,
+  IN  BOOLEAN                 Authoritative
+  )
+{
+  VARIABLE_STORE_INDEX        *StoreIndex;
+  UINTN                       MaxCount;
+  UINTN                       Index;
+
+  if (!FeaturePcdGet (PcdVariableStoreIndex) || VariableStoreHeader == NULL ||
+      GetVariableStoreIndex (GetStartPointer (VariableStoreHeader)) != NULL) {
+    return;
+  }
+
+  for (Index = 0; Index < ARRAY_SIZE (mVariableStoreIndex); Index++) {
+    if (mVariableStoreIndex[Index] == NULL) {
+      break;
+    }
+  }
+  if (Index == ARRAY_SIZE (mVariableStoreIndex)) {
+    return;
+  }
+
+  MaxCount   = MIN (VariableStoreHeader->Size / VARIABLE_STORE_INDEX_AVERAGE_VARIABLE_SIZE, MAX_UINT16);
+  StoreIndex = AllocateRuntimeZeroPool (sizeof (VARIABLE_STORE_INDEX) + MaxCount * sizeof (VARIABLE_STORE_INDEX_ENTRY));
+  if (StoreIndex == NULL) {
+    return;
+  }
+
+  StoreIndex->StartPtr      = GetStartPointer (VariableStoreHeader);
+  StoreIndex->Authoritative = Authoritative;
+  StoreIndex->MaxCount      = MaxCount;
+  mVariableStoreIndex[Index] = StoreIndex;
+}
+
+/**
+  Drop the contents of the index of the given variable store after the variables in
+  the store were moved, e.g. by a reclaim.
+
+  @param[in]  VariableStoreHeader  Pointer to the variable store.
+
+**/
+VOID
+InvalidateVariableStoreIndex (
+  IN  VARIABLE_STORE_HEADER   *VariableStoreHeader
+  )
+{
+  VARIABLE_STORE_INDEX        *StoreIndex;
+
+  if (VariableStoreHeader == NULL) {
+    return;
+  }
+
+  StoreIndex = GetVariableStoreIndex (GetStartPointer (VariableStoreHeader));
+  if (StoreIndex != NULL) {
+    ResetVariableStoreIndex (StoreIndex);
+  }
+}
+
+/**
+  Remove the index of the given variable store before the store is freed.
+
+  @param[in]  VariableStoreHeader  Pointer to the variable store.
+
+**/
+VOID
+DestroyVariableStoreIndex (
+  IN  VARIABLE_STORE_HEADER   *VariableStoreHeader
+  )
+{
+  UINTN                       Index;
+
+  if (VariableStoreHeader == NULL) {
+    return;
+  }
+
+  for (Index = 0; Index < ARRAY_SIZE (mVariableStoreIndex); Index++) {
+    if (mVariableStoreIndex[Index] != NULL &&
+        mVariableStoreIndex[Index]->StartPtr == GetStartPointer (VariableStoreHeader)) {
+      if (!AtRuntime ()) {
+        FreePool (mVariableStoreIndex[Index]);
+      }
+      mVariableStoreIndex[Index] = NULL;
+    }
+  }
+}
+
+/**
+  Check whether a variable is a valid variable with the given name and vendor GUID.
+
+  @param[in]  VariableName        Name of the variable to be found. An empty name
+                                  matches any variable.
+  @param[in]  VendorGuid          Vendor GUID to be found.
+  @param[in]  IgnoreRtCheck       Ignore EFI_VARIABLE_RUNTIME_ACCESS attribute
+                                  check at runtime when searching variable.
+  @param[in]  Variable            Pointer to the variable header.
+  @param[in]  AuthFormat          TRUE indicates authenticated variables are used.
+                                  FALSE indicates authenticated variables are not used.
+
+  @retval TRUE                    The variable is VAR_ADDED or VAR_IN_DELETED_TRANSITION
+                                  and matches VariableName and VendorGuid.
+  @retval FALSE                   The variable does not match.
+
+**/
+STATIC
+BOOLEAN
+IsMatchingVariable (
+  IN CHAR16                  *VariableName,
+  IN EFI_GUID                *VendorGuid,
+  IN BOOLEAN                 IgnoreRtCheck,
+  IN VARIABLE_HEADER         *Variable,
+  IN BOOLEAN                 AuthFormat
+  )
+{
+  if (Variable->State != VAR_ADDED && Variable->State != (VAR_IN_DELETED_TRANSITION & VAR_ADDED)) {
+    return FALSE;
+  }
+
+  if (!IgnoreRtCheck && AtRuntime () && ((Variable->Attributes & EFI_VARIABLE_RUNTIME_ACCESS) == 0)) {
+    return FALSE;
+  }
+
+  if (VariableName[0] == 0) {
+    return TRUE;
+  }
+
+  if (!CompareGuid (VendorGuid, GetVendorGuidPtr (Variable, AuthFormat))) {
+    return FALSE;
+  }
+
+  ASSERT (NameSizeOfVariable (Variable, AuthFormat) != 0);
+  return (BOOLEAN) (CompareMem (VariableName, GetVariableNamePtr (Variable, AuthFormat), NameSizeOfVariable (Variable, AuthFormat)) == 0);
+}
+
 /**
   Find the variable in the specified variable store.
 
+  If the variable store is indexed, only the variables with the same name and vendor
+  GUID hash and the variables written after the store was last indexed are checked.
+
   @param[in]       VariableName        Name of the variable to be found
   @param[in]       VendorGuid          Vendor GUID to be found.
   @param[in]       IgnoreRtCheck       Ignore EFI_VARIABLE_RUNTIME_ACCESS attribute
@@ -461,7 +756,11 @@ FindVariableEx (
   )
 {
   VARIABLE_HEADER                *InDeletedVariable;
-  VOID                           *Point;
+  VARIABLE_STORE_INDEX           *StoreIndex;
+  VARIABLE_STORE_INDEX_ENTRY     *Entries;
+  UINT32                         Hash;
+  UINT16                         Entry;
+  BOOLEAN                        Rebuilt;
 
   PtrTrack->InDeletedTransitionPtr = NULL;
 
@@ -469,38 +768,76 @@ FindVariableEx (
   // Find the variable by walk through HOB, volatile and non-volatile variable store.
   //
   InDeletedVariable  = NULL;
+  PtrTrack->CurrPtr  = PtrTrack->StartPtr;
 
-  for ( PtrTrack->CurrPtr = PtrTrack->StartPtr
-      ; IsValidVariableHeader (PtrTrack->CurrPtr, PtrTrack->EndPtr)
-      ; PtrTrack->CurrPtr = GetNextVariablePtr (PtrTrack->CurrPtr, AuthFormat)
-      ) {
-    if (PtrTrack->CurrPtr->State == VAR_ADDED ||
-        PtrTrack->CurrPtr->State == (VAR_IN_DELETED_TRANSITION & VAR_ADDED)
-       ) {
-      if (IgnoreRtCheck || !AtRuntime () || ((PtrTrack->CurrPtr->Attributes & EFI_VARIABLE_RUNTIME_ACCESS) != 0)) {
-        if (VariableName[0] == 0) {
+  StoreIndex = NULL;
+  if (VariableName[0] != 0) {
+    StoreIndex = GetVariableStoreIndex (PtrTrack->StartPtr);
+  }
+
+  if (StoreIndex != NULL) {
+    if (StoreIndex->Authoritative) {
+      UpdateVariableStoreIndex (StoreIndex, PtrTrack->EndPtr, AuthFormat);
+    }
+
+    Hash    = VariableStoreIndexHash (VariableName, MAX_UINTN, VendorGuid);
+    Entries = VARIABLE_STORE_INDEX_ENTRIES (StoreIndex);
+    Rebuilt = FALSE;
+    while (TRUE) {
+      for ( Entry = StoreIndex->Head[VARIABLE_STORE_INDEX_BUCKET (Hash)]
+          ; Entry != 0
+          ; Entry = Entries[Entry - 1].Next
+          ) {
+        if (Entries[Entry - 1].Hash != VARIABLE_STORE_INDEX_TAG (Hash)) {
+          continue;
+        }
+
+        PtrTrack->CurrPtr = (VARIABLE_HEADER *) ((UINTN) PtrTrack->StartPtr + Entries[Entry - 1].Offset);
+        if (!IsValidVariableHeader (PtrTrack->CurrPtr, PtrTrack->EndPtr) ||
+            (UINTN) GetNextVariablePtr (PtrTrack->CurrPtr, AuthFormat) > (UINTN) PtrTrack->EndPtr) {
+          continue;
+        }
+
+        if (IsMatchingVariable (VariableName, VendorGuid, IgnoreRtCheck, PtrTrack->CurrPtr, AuthFormat)) {
           if (PtrTrack->CurrPtr->State == (VAR_IN_DELETED_TRANSITION & VAR_ADDED)) {
-            InDeletedVariable   = PtrTrack->CurrPtr;
+            InDeletedVariable     = PtrTrack->CurrPtr;
           } else {
             PtrTrack->InDeletedTransitionPtr = InDeletedVariable;
             return EFI_SUCCESS;
           }
-        } else {
-          if (CompareGuid (VendorGuid, GetVendorGuidPtr (PtrTrack->CurrPtr, AuthFormat))) {
-            Point = (VOID *) GetVariableNamePtr (PtrTrack->CurrPtr, AuthFormat);
-
-            ASSERT (NameSizeOfVariable (PtrTrack->CurrPtr, AuthFormat) != 0);
-            if (CompareMem (VariableName, Point, NameSizeOfVariable (PtrTrack->CurrPtr, AuthFormat)) == 0) {
-              if (PtrTrack->CurrPtr->State == (VAR_IN_DELETED_TRANSITION & VAR_ADDED)) {
-                InDeletedVariable     = PtrTrack->CurrPtr;
-              } else {
-                PtrTrack->InDeletedTransitionPtr = InDeletedVariable;
-                return EFI_SUCCESS;
-              }
-            }
-          }
         }
       }
+
+      if (StoreIndex->Authoritative || Rebuilt) {
+        break;
+      }
+
+      //
+      // The store may have been rewritten since it was indexed, so a miss in the index
+      // of a store owned by someone else is only trusted after reindexing the store.
+      //
+      ResetVariableStoreIndex (StoreIndex);
+      UpdateVariableStoreIndex (StoreIndex, PtrTrack->EndPtr, AuthFormat);
+      InDeletedVariable = NULL;
+      Rebuilt           = TRUE;
+    }
+
+    //
+    // Only the variables the index does not cover are left to be walked.
+    //
+    PtrTrack->CurrPtr = (VARIABLE_HEADER *) ((UINTN) PtrTrack->StartPtr + StoreIndex->IndexedSize);
+  }
+
+  for ( ; IsValidVariableHeader (PtrTrack->CurrPtr, PtrTrack->EndPtr)
+      ; PtrTrack->CurrPtr = GetNextVariablePtr (PtrTrack->CurrPtr, AuthFormat)
+      ) {
+    if (IsMatchingVariable (VariableName, VendorGuid, IgnoreRtCheck, PtrTrack->CurrPtr, AuthFormat)) {
+      if (PtrTrack->CurrPtr->State == (VAR_IN_DELETED_TRANSITION & VAR_ADDED)) {
+        InDeletedVariable   = PtrTrack->CurrPtr;
+      } else {
+        PtrTrack->InDeletedTransitionPtr = InDeletedVariable;
+        return EFI_SUCCESS;
+      }
     }
   }
 
@@ -13,6 +13,67 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Guid/ImageAuthentication.h>
 #include "Variable.h"
 
+//
+// Number of hash buckets of a variable store index. It must be a power of two.
+//
+#define VARIABLE_STORE_INDEX_BUCKETS                256
+
+//
+// Average variable size the number of entries of a variable store index is sized for.
+// Variables beyond the capacity of the index are still found by walking the store.
+//
+#define VARIABLE_STORE_INDEX_AVERAGE_VARIABLE_SIZE  64
+
+typedef struct {
+  ///
+  /// Offset of the variable header from the start of the variable store.
+  ///
+  UINT32                    Offset;
+  ///
+  /// Upper 16 bits of the hash of the variable name and vendor GUID.
+  ///
+  UINT16                    Hash;
+  ///
+  /// Index + 1 of the next entry in the same bucket, 0 ends the chain.
+  ///
+  UINT16                    Next;
+} VARIABLE_STORE_INDEX_ENTRY;
+
+///
+/// Hash index of the variables of one variable store, keyed by variable name and vendor
+/// GUID. The entries follow this structure in the same allocation, in store order.
+///
+typedef struct {
+  ///
+  /// Start of the variables of the indexed store.
+  ///
+  VARIABLE_HEADER           *StartPtr;
+  ///
+  /// TRUE if the owner of the store invalidates the index whenever the store is rewritten,
+  /// so that a variable missing from the index is known not to exist. FALSE if the store
+  /// is rewritten behind the index and index entries may only be used as hints.
+  ///
+  BOOLEAN                   Authoritative;
+  ///
+  /// Number of bytes from StartPtr whose live variables are all in the index.
+  ///
+  UINTN                     IndexedSize;
+  UINTN                     Count;
+  UINTN                     MaxCount;
+  ///
+  /// Index + 1 of the first and last entries of each bucket, 0 for an empty bucket.
+  ///
+  UINT16                    Head[VARIABLE_STORE_INDEX_BUCKETS];
+  UINT16                    Tail[VARIABLE_STORE_INDEX_BUCKETS];
+} VARIABLE_STORE_INDEX;
+
+#define VARIABLE_STORE_INDEX_ENTRIES(StoreIndex)  ((VARIABLE_STORE_INDEX_ENTRY *) ((StoreIndex) + 1))
+
+//
+// Indexes of the variable stores of the module, not NULL entries are in use.
+//
+extern VARIABLE_STORE_INDEX  *mVariableStoreIndex[VariableStoreTypeMax];
+
 /**
 
   This code checks if variable header is valid or not.
@@ -280,6 +341,48 @@ FindVariableEx (
   IN     BOOLEAN                 AuthFormat
   );
 
+/**
+  Create the hash index FindVariableEx () uses to look up variables by name and
+  vendor GUID in the given variable store.
+
+  The index is filled lazily by the lookups. If it cannot be created, FindVariableEx ()
+  keeps walking the variable store.
+
+  @param[in]  VariableStoreHeader  Pointer to the variable store to index.
+  @param[in]  Authoritative        TRUE if the caller calls InvalidateVariableStoreIndex ()
+                                   whenever the layout of the variable store is rewritten.
+                                   FALSE if the store may be rewritten behind the index.
+
+**/
+VOID
+CreateVariableStoreIndex (
+  IN  VARIABLE_STORE_HEADER   *VariableStoreHeader,
+  IN  BOOLEAN                 Authoritative
+  );
+
+/**
+  Drop the contents of the index of the given variable store after the variables in
+  the store were moved, e.g. by a reclaim.
+
+  @param[in]  VariableStoreHeader  Pointer to the variable store.
+
+**/
+VOID
+InvalidateVariableStoreIndex (
+  IN  VARIABLE_STORE_HEADER   *VariableStoreHeader
+  );
+
+/**
+  Remove the index of the given variable store before the store is freed.
+
+  @param[in]  VariableStoreHeader  Pointer to the variable store.
+
+**/
+VOID
+DestroyVariableStoreIndex (
+  IN  VARIABLE_STORE_HEADER   *VariableStoreHeader
+  );
+
 /**
   This code finds the next available variable.
 
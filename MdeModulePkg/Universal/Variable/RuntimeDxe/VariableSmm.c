@@ -425,6 +425,89 @@ SmmVariableGetStatistics (
   return EFI_SUCCESS;
 }
 
+/**
+  Set the variables of a SetVariable batch one by one.
+
+  Caution: This function may receive untrusted input.
+  The batch is a copy of the communicate buffer in SMRAM, and each record is
+  checked against BatchSize before it is used.
+
+  @param[in]  Batch             Pointer to the batch in SMRAM.
+  @param[in]  BatchSize         Size of the batch in bytes.
+  @param[out] ProcessedCount    Returns the number of records set successfully.
+
+  @retval EFI_SUCCESS           All records were set.
+  @retval EFI_ACCESS_DENIED     A record is malformed or does not fit in the batch.
+  @retval Others                The status of the first record that failed to be set.
+
+**/
+EFI_STATUS
+SmmSetVariableBatch (
+  IN  SMM_VARIABLE_COMMUNICATE_SET_VARIABLE_BATCH   *Batch,
+  IN  UINTN                                         BatchSize,
+  OUT UINTN                                         *ProcessedCount
+  )
+{
+  EFI_STATUS                                        Status;
+  SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE          *SmmVariableHeader;
+  UINTN                                             Offset;
+  UINTN                                             InfoSize;
+  UINTN                                             Index;
+
+  *ProcessedCount = 0;
+  Offset          = OFFSET_OF (SMM_VARIABLE_COMMUNICATE_SET_VARIABLE_BATCH, Data);
+  for (Index = 0; Index < Batch->Count; Index++) {
+    if (Offset > BatchSize || BatchSize - Offset < OFFSET_OF (SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE, Name)) {
+      DEBUG ((EFI_D_ERROR, "SetVariableBatch: SMM communication buffer size invalid!\n"));
+      return EFI_ACCESS_DENIED;
+    }
+
+    SmmVariableHeader = (SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE *) ((UINT8 *) Batch + Offset);
+    if (((UINTN)(~0) - SmmVariableHeader->DataSize < OFFSET_OF(SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE, Name)) ||
+       ((UINTN)(~0) - SmmVariableHeader->NameSize < OFFSET_OF(SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE, Name) + SmmVariableHeader->DataSize)) {
+      //
+      // Prevent InfoSize overflow happen
+      //
+      return EFI_ACCESS_DENIED;
+    }
+    InfoSize = OFFSET_OF(SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE, Name)
+               + SmmVariableHeader->DataSize + SmmVariableHeader->NameSize;
+    if (InfoSize > BatchSize - Offset) {
+      DEBUG ((EFI_D_ERROR, "SetVariableBatch: Data size exceed communication buffer size limit!\n"));
+      return EFI_ACCESS_DENIED;
+    }
+
+    //
+    // The VariableSpeculationBarrier() call here is to ensure the previous
+    // range/content checks for the record have been completed before the
+    // subsequent consumption of the record content.
+    //
+    VariableSpeculationBarrier ();
+    if (SmmVariableHeader->NameSize < sizeof (CHAR16) || SmmVariableHeader->Name[SmmVariableHeader->NameSize/sizeof (CHAR16) - 1] != L'\0') {
+      //
+      // Make sure VariableName is A Null-terminated string.
+      //
+      return EFI_ACCESS_DENIED;
+    }
+
+    Status = VariableServiceSetVariable (
+               SmmVariableHeader->Name,
+               &SmmVariableHeader->Guid,
+               SmmVariableHeader->Attributes,
+               SmmVariableHeader->DataSize,
+               (UINT8 *)SmmVariableHeader->Name + SmmVariableHeader->NameSize
+               );
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+
+    *ProcessedCount = Index + 1;
+    Offset         += ALIGN_VALUE (InfoSize, sizeof (UINTN));
+  }
+
+  return EFI_SUCCESS;
+}
+
 
 /**
   Communication service SMI Handler entry.
@@ -464,6 +547,7 @@ SmmVariableHandler (
   EFI_STATUS                                              Status;
   SMM_VARIABLE_COMMUNICATE_HEADER                         *SmmVariableFunctionHeader;
   SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE                *SmmVariableHeader;
+  SMM_VARIABLE_COMMUNICATE_SET_VARIABLE_BATCH             *SetVariableBatch;
   SMM_VARIABLE_COMMUNICATE_GET_NEXT_VARIABLE_NAME         *GetNextVariableName;
   SMM_VARIABLE_COMMUNICATE_QUERY_VARIABLE_INFO            *QueryVariableInfo;
   SMM_VARIABLE_COMMUNICATE_GET_PAYLOAD_SIZE               *GetPayloadSize;
@@ -658,6 +742,21 @@ SmmVariableHandler (
                  );
       break;
 
+    case SMM_VARIABLE_FUNCTION_SET_VARIABLE_BATCH:
+      if (CommBufferPayloadSize < OFFSET_OF (SMM_VARIABLE_COMMUNICATE_SET_VARIABLE_BATCH, Data)) {
+        DEBUG ((EFI_D_ERROR, "SetVariableBatch: SMM communication buffer size invalid!\n"));
+        return EFI_SUCCESS;
+      }
+      //
+      // Copy the input communicate buffer payload to pre-allocated SMM variable buffer payload.
+      //
+      CopyMem (mVariableBufferPayload, SmmVariableFunctionHeader->Data, CommBufferPayloadSize);
+      SetVariableBatch = (SMM_VARIABLE_COMMUNICATE_SET_VARIABLE_BATCH *) mVariableBufferPayload;
+
+      Status = SmmSetVariableBatch (SetVariableBatch, CommBufferPayloadSize, &SetVariableBatch->ProcessedCount);
+      ((SMM_VARIABLE_COMMUNICATE_SET_VARIABLE_BATCH *) SmmVariableFunctionHeader->Data)->ProcessedCount = SetVariableBatch->ProcessedCount;
+      break;
+
     case SMM_VARIABLE_FUNCTION_QUERY_VARIABLE_INFO:
       if (CommBufferPayloadSize < sizeof (SMM_VARIABLE_COMMUNICATE_QUERY_VARIABLE_INFO)) {
         DEBUG ((EFI_D_ERROR, "QueryVariableInfo: SMM communication buffer size invalid!\n"));
@@ -704,6 +803,10 @@ SmmVariableHandler (
       break;
 
     case SMM_VARIABLE_FUNCTION_EXIT_BOOT_SERVICE:
+      //
+      // Last chance to reclaim before runtime, where the variable storage is never reclaimed.
+      //
+      ReclaimOnThreshold ();
       mAtRuntime = TRUE;
       Status = EFI_SUCCESS;
       break;
@@ -25,6 +25,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Protocol/SmmVariable.h>
 #include <Protocol/VariableLock.h>
 #include <Protocol/VarCheck.h>
+#include <Protocol/VariableBatch.h>
 
 #include <Library/UefiBootServicesTableLib.h>
 #include <Library/UefiRuntimeServicesTableLib.h>
@@ -65,6 +66,7 @@ BOOLEAN                          mHobFlushComplete;
 EFI_LOCK                         mVariableServicesLock;
 EDKII_VARIABLE_LOCK_PROTOCOL     mVariableLock;
 EDKII_VAR_CHECK_PROTOCOL         mVarCheck;
+EDKII_VARIABLE_BATCH_PROTOCOL    mVariableBatch;
 
 /**
   The logic to initialize the VariablePolicy engine is in its own file.
@@ -573,6 +575,7 @@ CheckForRuntimeCacheSync (
   // The HOB variable data may have finished being flushed in the runtime cache sync update
   //
   if (mHobFlushComplete && mVariableRuntimeHobCacheBuffer != NULL) {
+    DestroyVariableStoreIndex (mVariableRuntimeHobCacheBuffer);
     if (!EfiAtRuntime ()) {
       FreePages (mVariableRuntimeHobCacheBuffer, EFI_SIZE_TO_PAGES (mVariableRuntimeHobCacheBufferSize));
     }
@@ -1175,6 +1178,154 @@ Done:
   return Status;
 }
 
+/**
+  Set or delete a batch of variables through as few SMIs as possible.
+
+  The entries are packed into the communicate buffer until it is full, and each
+  buffer is sent to SMM in one SMI, where the entries are set in order.
+
+  Caution: This function may receive untrusted input.
+  The data size and data are external input, so this function will validate them
+  carefully to avoid buffer overflow.
+
+  @param[in]  This            The EDKII_VARIABLE_BATCH_PROTOCOL instance.
+  @param[in]  Count           Number of entries in Entries.
+  @param[in]  Entries         The SetVariable () requests to apply.
+  @param[out] ProcessedCount  Optional, returns the number of entries applied successfully.
+
+  @retval EFI_SUCCESS            All entries were applied.
+  @retval EFI_INVALID_PARAMETER  Entries is NULL while Count is not 0, or an entry has
+                                 invalid parameters or does not fit in the communicate
+                                 buffer. No entry was applied.
+  @retval Others                 The status SetVariable () returned for the first entry
+                                 that failed.
+
+**/
+EFI_STATUS
+EFIAPI
+VariableBatchSetVariables (
+  IN CONST EDKII_VARIABLE_BATCH_PROTOCOL    *This,
+  IN       UINTN                            Count,
+  IN       EDKII_VARIABLE_BATCH_ENTRY       *Entries,
+  OUT      UINTN                            *ProcessedCount OPTIONAL
+  )
+{
+  EFI_STATUS                                  Status;
+  SMM_VARIABLE_COMMUNICATE_SET_VARIABLE_BATCH *SetVariableBatch;
+  SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE    *SmmVariableHeader;
+  UINTN                                       PayloadSize;
+  UINTN                                       InfoSize;
+  UINTN                                       VariableNameSize;
+  UINTN                                       Index;
+  UINTN                                       Processed;
+  UINTN                                       BatchCount;
+
+  if (ProcessedCount != NULL) {
+    *ProcessedCount = 0;
+  }
+
+  if (Count == 0) {
+    return EFI_SUCCESS;
+  }
+
+  if (Entries == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  //
+  // Check all entries before any of them is applied.
+  //
+  for (Index = 0; Index < Count; Index++) {
+    if (Entries[Index].VariableName == NULL || Entries[Index].VariableName[0] == 0 || Entries[Index].VendorGuid == NULL) {
+      return EFI_INVALID_PARAMETER;
+    }
+
+    if (Entries[Index].DataSize != 0 && Entries[Index].Data == NULL) {
+      return EFI_INVALID_PARAMETER;
+    }
+
+    //
+    // Every entry must fit in a batch on its own.
+    //
+    VariableNameSize = StrSize (Entries[Index].VariableName);
+    if ((VariableNameSize > mVariableBufferPayloadSize - OFFSET_OF (SMM_VARIABLE_COMMUNICATE_SET_VARIABLE_BATCH, Data) - OFFSET_OF (SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE, Name)) ||
+        (Entries[Index].DataSize > mVariableBufferPayloadSize - OFFSET_OF (SMM_VARIABLE_COMMUNICATE_SET_VARIABLE_BATCH, Data) - OFFSET_OF (SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE, Name) - VariableNameSize)) {
+      return EFI_INVALID_PARAMETER;
+    }
+  }
+
+  AcquireLockOnlyAtBootTime(&mVariableServicesLock);
+
+  Status    = EFI_SUCCESS;
+  Processed = 0;
+  while (Processed < Count) {
+    Status = InitCommunicateBuffer ((VOID **) &SetVariableBatch, OFFSET_OF (SMM_VARIABLE_COMMUNICATE_SET_VARIABLE_BATCH, Data), SMM_VARIABLE_FUNCTION_SET_VARIABLE_BATCH);
+    if (EFI_ERROR (Status)) {
+      break;
+    }
+    ASSERT (SetVariableBatch != NULL);
+
+    //
+    // Pack as many of the remaining entries as fit into the communicate buffer.
+    //
+    PayloadSize = OFFSET_OF (SMM_VARIABLE_COMMUNICATE_SET_VARIABLE_BATCH, Data);
+    for (BatchCount = 0; Processed + BatchCount < Count; BatchCount++) {
+      Index            = Processed + BatchCount;
+      VariableNameSize = StrSize (Entries[Index].VariableName);
+      InfoSize         = OFFSET_OF (SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE, Name) + VariableNameSize + Entries[Index].DataSize;
+      if (InfoSize > mVariableBufferPayloadSize - PayloadSize) {
+        break;
+      }
+
+      SmmVariableHeader = (SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE *) ((UINT8 *) SetVariableBatch + PayloadSize);
+      CopyGuid ((EFI_GUID *) &SmmVariableHeader->Guid, Entries[Index].VendorGuid);
+      SmmVariableHeader->DataSize   = Entries[Index].DataSize;
+      SmmVariableHeader->NameSize   = VariableNameSize;
+      SmmVariableHeader->Attributes = Entries[Index].Attributes;
+      CopyMem (SmmVariableHeader->Name, Entries[Index].VariableName, SmmVariableHeader->NameSize);
+      CopyMem ((UINT8 *) SmmVariableHeader->Name + SmmVariableHeader->NameSize, Entries[Index].Data, Entries[Index].DataSize);
+
+      PayloadSize = MIN (ALIGN_VALUE (PayloadSize + InfoSize, sizeof (UINTN)), mVariableBufferPayloadSize);
+    }
+    ASSERT (BatchCount != 0);
+
+    SetVariableBatch->Count          = BatchCount;
+    SetVariableBatch->ProcessedCount = 0;
+    Status = InitCommunicateBuffer (NULL, PayloadSize, SMM_VARIABLE_FUNCTION_SET_VARIABLE_BATCH);
+    if (EFI_ERROR (Status)) {
+      break;
+    }
+
+    //
+    // Send data to SMM.
+    //
+    Status = SendCommunicateBuffer (PayloadSize);
+
+    Processed += MIN (SetVariableBatch->ProcessedCount, BatchCount);
+
+    if (EFI_ERROR (Status)) {
+      break;
+    }
+  }
+
+  ReleaseLockOnlyAtBootTime (&mVariableServicesLock);
+
+  if (!EfiAtRuntime ()) {
+    for (Index = 0; Index < Processed; Index++) {
+      SecureBootHook (
+        Entries[Index].VariableName,
+        Entries[Index].VendorGuid
+        );
+    }
+  }
+
+  if (ProcessedCount != NULL) {
+    *ProcessedCount = Processed;
+  }
+
+  return Status;
+}
+
 
 /**
   This code returns information about the EFI variables.
@@ -1336,11 +1487,20 @@ VariableAddressChangeEvent (
   IN VOID                                   *Context
   )
 {
+  UINTN                                     Index;
+
   EfiConvertPointer (0x0, (VOID **) &mVariableBuffer);
   EfiConvertPointer (0x0, (VOID **) &mMmCommunication2);
   EfiConvertPointer (EFI_OPTIONAL_PTR, (VOID **) &mVariableRuntimeHobCacheBuffer);
   EfiConvertPointer (EFI_OPTIONAL_PTR, (VOID **) &mVariableRuntimeNvCacheBuffer);
   EfiConvertPointer (EFI_OPTIONAL_PTR, (VOID **) &mVariableRuntimeVolatileCacheBuffer);
+
+  for (Index = 0; Index < ARRAY_SIZE (mVariableStoreIndex); Index++) {
+    if (mVariableStoreIndex[Index] != NULL) {
+      EfiConvertPointer (0x0, (VOID **) &mVariableStoreIndex[Index]->StartPtr);
+      EfiConvertPointer (0x0, (VOID **) &mVariableStoreIndex[Index]);
+    }
+  }
 }
 
 /**
@@ -1657,6 +1817,13 @@ SmmVariableReady (
             Status = SendRuntimeVariableCacheContextToSmm ();
             if (!EFI_ERROR (Status)) {
               SyncRuntimeCache ();
+              //
+              // The runtime caches are rewritten by SMM, including by reclaims, so their
+              // indexes are only used as hints.
+              //
+              CreateVariableStoreIndex (mVariableRuntimeHobCacheBuffer, FALSE);
+              CreateVariableStoreIndex (mVariableRuntimeNvCacheBuffer, FALSE);
+              CreateVariableStoreIndex (mVariableRuntimeVolatileCacheBuffer, FALSE);
             }
           }
         }
@@ -1751,6 +1918,15 @@ SmmVariableWriteReady (
                   );
   ASSERT_EFI_ERROR (Status);
 
+  mVariableBatch.SetVariables = VariableBatchSetVariables;
+  Status = gBS->InstallMultipleProtocolInterfaces (
+                  &mHandle,
+                  &gEdkiiVariableBatchProtocolGuid,
+                  &mVariableBatch,
+                  NULL
+                  );
+  ASSERT_EFI_ERROR (Status);
+
   gBS->CloseEvent (Event);
 }
 
@@ -92,6 +92,7 @@
 #define DHCP4_TAG_STTALK             75   /// StreetTalk Server
 #define DHCP4_TAG_STDA               76   /// StreetTalk Directory Assistance Server
 #define DHCP4_TAG_USER_CLASS_ID      77   /// User class identifier
+#define DHCP4_TAG_RAPID_COMMIT       80   /// Rapid Commit, RFC 4039
 #define DHCP4_TAG_ARCH               93   /// Client System Architecture Type, RFC 4578
 #define DHCP4_TAG_UNDI               94   /// Client Network Interface Identifier, RFC 4578
 #define DHCP4_TAG_UUID               97   /// Client Machine Identifier, RFC 4578
@@ -76,6 +76,23 @@
 ///
 #define HTTP_HEADER_ACCEPT_RANGES      "Accept-Ranges"
 
+///
+/// Range Request Header
+/// The Range request-header field allows the client to request
+/// only one or more sub-ranges of the selected representation.
+///
+#define HTTP_HEADER_RANGE              "Range"
+
+///
+/// Connection General Header
+/// The Connection general-header field allows the sender to specify
+/// options that are desired for that particular connection, such as
+/// "close" to signal that the connection will be closed after the
+/// current request/response is complete.
+///
+#define HTTP_HEADER_CONNECTION         "Connection"
+#define HTTP_HEADER_CONNECTION_CLOSE   "close"
+
 
 ///
 /// Accept-Encoding Request Header
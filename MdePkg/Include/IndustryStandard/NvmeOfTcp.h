@@ -0,0 +1,234 @@
+/** @file
+  Definitions of the NVMe over Fabrics command set and of the NVMe/TCP
+  transport binding.
+
+  Copyright (c) 2021, EDK II contributors. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+  @par Specification Reference:
+  NVM Express over Fabrics Revision 1.1
+  NVM Express TCP Transport Specification (TP 8000)
+
+**/
+
+#ifndef __NVME_OF_TCP_H__
+#define __NVME_OF_TCP_H__
+
+#include <IndustryStandard/Nvme.h>
+
+//
+// TCP ports assigned for NVMe/TCP I/O controllers and discovery controllers.
+//
+#define NVME_TCP_DEFAULT_PORT            4420
+#define NVME_TCP_DISCOVERY_PORT          8009
+
+//
+// NVMe Qualified Name length and the well-known discovery subsystem NQN.
+//
+#define NVME_NQN_MAX_LEN                 223
+#define NVME_DISCOVERY_NQN               "nqn.2014-08.org.nvmexpress.discovery"
+
+//
+// Fabrics command opcode, and the Fabrics command types in FCTYPE.
+//
+#define NVME_FABRICS_OPC                 0x7F
+
+#define NVME_FABRICS_PROPERTY_SET        0x00
+#define NVME_FABRICS_CONNECT             0x01
+#define NVME_FABRICS_PROPERTY_GET        0x04
+#define NVME_FABRICS_AUTH_SEND           0x05
+#define NVME_FABRICS_AUTH_RECEIVE        0x06
+#define NVME_FABRICS_DISCONNECT          0x08
+
+//
+// Size of the property in the ATTRIB field of Property Get and Property Set.
+//
+#define NVME_FABRICS_PROPERTY_SIZE_4     0x00
+#define NVME_FABRICS_PROPERTY_SIZE_8     0x01
+
+//
+// SGL descriptor identifiers used by NVMe/TCP: data carried in the command
+// capsule, or data moved by H2CData/C2HData PDUs.
+//
+#define NVME_SGL_ID_IN_CAPSULE_DATA      0x01
+#define NVME_SGL_ID_TRANSPORT_DATA       0x5A
+
+//
+// NVMe/TCP PDU types.
+//
+#define NVME_TCP_PDU_ICREQ               0x00
+#define NVME_TCP_PDU_ICRESP              0x01
+#define NVME_TCP_PDU_H2C_TERM_REQ        0x02
+#define NVME_TCP_PDU_C2H_TERM_REQ        0x03
+#define NVME_TCP_PDU_CAPSULE_CMD         0x04
+#define NVME_TCP_PDU_CAPSULE_RESP        0x05
+#define NVME_TCP_PDU_H2C_DATA            0x06
+#define NVME_TCP_PDU_C2H_DATA            0x07
+#define NVME_TCP_PDU_R2T                 0x09
+
+//
+// Flags in the common header of a PDU.
+//
+#define NVME_TCP_FLAG_HDGSTF             BIT0
+#define NVME_TCP_FLAG_DDGSTF             BIT1
+#define NVME_TCP_FLAG_LAST_PDU           BIT2
+#define NVME_TCP_FLAG_SUCCESS            BIT3
+
+//
+// Digest enable bits in the DGST field of ICReq and ICResp.
+//
+#define NVME_TCP_DGST_HDGST_ENABLE       BIT0
+#define NVME_TCP_DGST_DDGST_ENABLE       BIT1
+
+#define NVME_TCP_PFV_1_0                 0x0000
+#define NVME_TCP_DIGEST_LEN              4
+
+#pragma pack(1)
+
+//
+// Fabrics 2.3.1: SGL descriptor.
+//
+typedef struct {
+  UINT64 Address;
+  UINT32 Length;
+  UINT8  Rsvd[3];
+  UINT8  Identifier;       // SGL descriptor type (bits 7:4) and sub type (bits 3:0)
+} NVME_SGL_DESCRIPTOR;
+
+//
+// Fabrics 3.3: Connect command, submission queue entry.
+//
+typedef struct {
+  UINT8               Opc;             // NVME_FABRICS_OPC
+  UINT8               Psdt;
+  UINT16              Cid;
+  UINT8               FcType;          // NVME_FABRICS_CONNECT
+  UINT8               Rsvd1[19];
+  NVME_SGL_DESCRIPTOR Sgl1;            // Describes the NVME_FABRICS_CONNECT_DATA
+  UINT16              RecFmt;          // Record Format, 0
+  UINT16              QId;             // 0 for the admin queue
+  UINT16              SqSize;          // 0's based submission queue size
+  UINT8               CAttr;           // Connect Attributes
+  UINT8               Rsvd2;
+  UINT32              Kato;            // Keep Alive Timeout in milliseconds
+  UINT8               Rsvd3[12];
+} NVME_FABRICS_CONNECT_CMD;
+
+//
+// Fabrics 3.3: Connect command data.
+//
+typedef struct {
+  UINT8               HostId[16];
+  UINT16              CntlId;          // 0xFFFF for the dynamic controller model
+  UINT8               Rsvd1[238];
+  CHAR8               SubNqn[256];
+  CHAR8               HostNqn[256];
+  UINT8               Rsvd2[256];
+} NVME_FABRICS_CONNECT_DATA;
+
+//
+// Fabrics 3.4 and 3.5: Property Get and Property Set commands.
+//
+typedef struct {
+  UINT8               Opc;             // NVME_FABRICS_OPC
+  UINT8               Psdt;
+  UINT16              Cid;
+  UINT8               FcType;          // NVME_FABRICS_PROPERTY_GET or _SET
+  UINT8               Rsvd1[35];
+  UINT8               Attrib;          // NVME_FABRICS_PROPERTY_SIZE_x
+  UINT8               Rsvd2[3];
+  UINT32              Ofst;            // Property offset, as the NVME_xxx_OFFSET registers
+  UINT64              Value;           // Property Set only
+  UINT8               Rsvd3[8];
+} NVME_FABRICS_PROPERTY_CMD;
+
+//
+// NVMe/TCP 3.6.1: PDU common header.
+//
+typedef struct {
+  UINT8  PduType;
+  UINT8  Flags;
+  UINT8  HLen;             // Length of the PDU header, in bytes
+  UINT8  Pdo;              // Offset of the PDU data from the start of the PDU
+  UINT32 PLen;             // Length of the whole PDU, in bytes
+} NVME_TCP_COMMON_HEADER;
+
+//
+// NVMe/TCP 3.6.2.2 and 3.6.2.3: Initialize Connection Request and Response.
+//
+typedef struct {
+  NVME_TCP_COMMON_HEADER Ch;
+  UINT16                 Pfv;          // PDU Format Version
+  UINT8                  Hpda;         // Host PDU Data Alignment
+  UINT8                  Dgst;         // NVME_TCP_DGST_xxx
+  UINT32                 MaxR2T;       // 0's based maximum outstanding R2T per command
+  UINT8                  Rsvd[112];
+} NVME_TCP_ICREQ_PDU;
+
+typedef struct {
+  NVME_TCP_COMMON_HEADER Ch;
+  UINT16                 Pfv;
+  UINT8                  Cpda;         // Controller PDU Data Alignment
+  UINT8                  Dgst;
+  UINT32                 MaxH2CData;   // Maximum data bytes in one H2CData PDU
+  UINT8                  Rsvd[112];
+} NVME_TCP_ICRESP_PDU;
+
+//
+// NVMe/TCP 3.6.2.4 and 3.6.2.5: Connection Termination Requests.
+//
+typedef struct {
+  NVME_TCP_COMMON_HEADER Ch;
+  UINT16                 Fes;          // Fatal Error Status
+  UINT32                 Fei;          // Fatal Error Information
+  UINT8                  Rsvd[10];
+} NVME_TCP_TERM_REQ_PDU;
+
+//
+// NVMe/TCP 3.6.2.6 and 3.6.2.7: Command Capsule and Response Capsule. The
+// command capsule is followed by the in-capsule data, if any.
+//
+typedef struct {
+  NVME_TCP_COMMON_HEADER Ch;
+  NVME_SQ                Sqe;
+} NVME_TCP_CAPSULE_CMD_PDU;
+
+typedef struct {
+  NVME_TCP_COMMON_HEADER Ch;
+  NVME_CQ                Cqe;
+} NVME_TCP_CAPSULE_RESP_PDU;
+
+//
+// NVMe/TCP 3.6.2.8, 3.6.2.9 and 3.6.2.10: Host to Controller Data, Controller
+// to Host Data and Ready to Transfer.
+//
+typedef struct {
+  NVME_TCP_COMMON_HEADER Ch;
+  UINT16                 CccId;        // Command Capsule CID
+  UINT16                 TTag;         // Transfer Tag from the R2T
+  UINT32                 DataO;        // Data offset in the command's buffer
+  UINT32                 DataL;        // Data length of this PDU
+  UINT8                  Rsvd[4];
+} NVME_TCP_H2C_DATA_PDU;
+
+typedef struct {
+  NVME_TCP_COMMON_HEADER Ch;
+  UINT16                 CccId;
+  UINT8                  Rsvd1[2];
+  UINT32                 DataO;
+  UINT32                 DataL;
+  UINT8                  Rsvd2[4];
+} NVME_TCP_C2H_DATA_PDU;
+
+typedef struct {
+  NVME_TCP_COMMON_HEADER Ch;
+  UINT16                 CccId;
+  UINT16                 TTag;
+  UINT32                 R2TO;         // Offset of the requested data
+  UINT32                 R2TL;         // Length of the requested data
+  UINT8                  Rsvd[4];
+} NVME_TCP_R2T_PDU;
+
+#pragma pack()
+
+#endif
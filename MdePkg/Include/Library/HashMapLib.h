@@ -0,0 +1,319 @@
+/** @file
+  A hash map library interface.
+
+  The library class provides a set of APIs to manage an unordered collection
+  of user structures that are looked up by an embedded key.
+
+  Copyright (c) 2021, EDK II contributors. All rights reserved.<BR>
+
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+**/
+
+#ifndef __HASH_MAP_LIB__
+#define __HASH_MAP_LIB__
+
+#include <Base.h>
+
+//
+// Opaque structure for a hash map.
+//
+// The hash map does not take ownership of the user structures, it only links
+// them. The same user structure can therefore be linked into several hash
+// maps, and the caller is responsible for releasing the user structures.
+//
+typedef struct HASH_MAP HASH_MAP;
+
+//
+// Altering the key of an in-map user structure (ie. the data that
+// HASH_MAP_GET_KEY points to) is not allowed in-place. The caller is
+// responsible for bracketing the key change with the deletion and the
+// reinsertion of the user structure.
+//
+
+/**
+  Return the key embedded in a user structure.
+
+  @param[in] UserStruct  Pointer to the user structure.
+
+  @return  Pointer to the key of UserStruct. The key is passed to
+           HASH_MAP_KEY_HASH and HASH_MAP_KEY_COMPARE.
+**/
+typedef
+CONST VOID *
+(EFIAPI *HASH_MAP_GET_KEY)(
+  IN CONST VOID *UserStruct
+  );
+
+/**
+  Hash function type for keys.
+
+  Keys that compare equal with HASH_MAP_KEY_COMPARE must produce the same hash
+  value. The hash map mixes the returned value before use, so a hash that is
+  only weak in its low bits (for example a pointer) is acceptable.
+
+  @param[in] Key  Pointer to the key to hash.
+
+  @return  The hash value of Key.
+**/
+typedef
+UINTN
+(EFIAPI *HASH_MAP_KEY_HASH)(
+  IN CONST VOID *Key
+  );
+
+/**
+  Comparator function type for two keys.
+
+  @param[in] Key1  Pointer to the first key.
+
+  @param[in] Key2  Pointer to the second key.
+
+  @retval TRUE   Key1 is equal to Key2.
+
+  @retval FALSE  Key1 is not equal to Key2.
+**/
+typedef
+BOOLEAN
+(EFIAPI *HASH_MAP_KEY_COMPARE)(
+  IN CONST VOID *Key1,
+  IN CONST VOID *Key2
+  );
+
+
+//
+// Some functions below are read-only, while others are read-write. If any
+// write operation is expected to run concurrently with any other operation on
+// the same hash map, then the caller is responsible for implementing locking
+// for the whole hash map.
+//
+// Only HashMapInit(), HashMapReserve() and HashMapInsert() allocate memory.
+// HashMapInsert() only does so when the hash map has to grow, which the
+// caller can avoid by reserving room with HashMapReserve() up front.
+//
+
+/**
+  Allocate and initialize the HASH_MAP structure.
+
+  @param[in]  GetKey           This caller-provided function returns the key
+                               embedded in a user structure.
+
+  @param[in]  KeyHash          This caller-provided function hashes a key.
+
+  @param[in]  KeyCompare       This caller-provided function checks two keys
+                               for equality.
+
+  @param[in]  InitialCapacity  The number of user structures that can be
+                               linked into the hash map before it grows. Zero
+                               selects a small default.
+
+  @retval NULL  If allocation failed.
+
+  @return       Pointer to the allocated, initialized HASH_MAP structure,
+                otherwise.
+**/
+HASH_MAP *
+EFIAPI
+HashMapInit (
+  IN HASH_MAP_GET_KEY     GetKey,
+  IN HASH_MAP_KEY_HASH    KeyHash,
+  IN HASH_MAP_KEY_COMPARE KeyCompare,
+  IN UINTN                InitialCapacity
+  );
+
+
+/**
+  Uninitialize and release a HASH_MAP structure.
+
+  Read-write operation.
+
+  The user structures that are still linked into the hash map are not
+  touched; releasing them remains the caller's responsibility.
+
+  @param[in] Map  The hash map to uninitialize and release.
+**/
+VOID
+EFIAPI
+HashMapUninit (
+  IN HASH_MAP *Map
+  );
+
+
+/**
+  Return the number of user structures linked into the hash map.
+
+  Read-only operation.
+
+  @param[in] Map  The hash map to count the user structures of.
+
+  @return  The number of user structures linked into Map.
+**/
+UINTN
+EFIAPI
+HashMapCount (
+  IN CONST HASH_MAP *Map
+  );
+
+
+/**
+  Make sure that the hash map can hold the specified number of user structures
+  without allocating memory in HashMapInsert().
+
+  Read-write operation.
+
+  @param[in,out] Map    The hash map to reserve room in.
+
+  @param[in]     Count  The total number of user structures the hash map
+                        should be able to hold.
+
+  @retval RETURN_SUCCESS           Room for Count user structures is available.
+
+  @retval RETURN_OUT_OF_RESOURCES  The function failed to allocate memory. The
+                                   hash map has not been changed.
+**/
+RETURN_STATUS
+EFIAPI
+HashMapReserve (
+  IN OUT HASH_MAP *Map,
+  IN     UINTN    Count
+  );
+
+
+/**
+  Look up the user structure that matches the specified standalone key.
+
+  Read-only operation.
+
+  @param[in] Map            The hash map to search for StandaloneKey.
+
+  @param[in] StandaloneKey  The key to locate among the user structures
+                            linked into Map.
+
+  @retval NULL  StandaloneKey could not be found.
+
+  @return       The user structure matching StandaloneKey, otherwise.
+**/
+VOID *
+EFIAPI
+HashMapFind (
+  IN CONST HASH_MAP *Map,
+  IN CONST VOID     *StandaloneKey
+  );
+
+
+/**
+  Insert (link) a user structure into the hash map.
+
+  Read-write operation.
+
+  When the hash map is full, a table of twice the size is allocated, and the
+  user structures are moved over to it a few at a time by the following
+  HashMapInsert() and HashMapDelete() calls, so no single call has to rehash
+  the whole map.
+
+  @param[in,out] Map         The hash map to insert UserStruct into.
+
+  @param[in]     UserStruct  The user structure to link into the hash map. It
+                             must not be NULL.
+
+  @param[out]    Existing    If the key of UserStruct collides with a user
+                             structure that is already linked into Map, and
+                             the caller provides this optional output-only
+                             parameter, then it is set on output to the
+                             colliding user structure. This enables
+                             "find-or-insert" in one function call.
+
+  @retval RETURN_SUCCESS           UserStruct has been linked into Map.
+
+  @retval RETURN_ALREADY_STARTED   A user structure with the same key is
+                                   already linked into Map. Map has not been
+                                   changed.
+
+  @retval RETURN_OUT_OF_RESOURCES  The function failed to allocate memory for
+                                   growing the hash map. Map has not been
+                                   changed.
+**/
+RETURN_STATUS
+EFIAPI
+HashMapInsert (
+  IN OUT HASH_MAP *Map,
+  IN     VOID     *UserStruct,
+  OUT    VOID     **Existing   OPTIONAL
+  );
+
+
+/**
+  Delete (unlink) the user structure that matches the specified standalone key
+  from the hash map.
+
+  Read-write operation.
+
+  @param[in,out] Map            The hash map to delete StandaloneKey from.
+
+  @param[in]     StandaloneKey  The key of the user structure to unlink.
+
+  @param[out]    UserStruct     If the caller provides this optional
+                                output-only parameter, then on output it is
+                                set to the user structure that has been
+                                unlinked.
+
+  @retval RETURN_SUCCESS    The user structure has been unlinked from Map.
+
+  @retval RETURN_NOT_FOUND  StandaloneKey could not be found.
+**/
+RETURN_STATUS
+EFIAPI
+HashMapDelete (
+  IN OUT HASH_MAP   *Map,
+  IN     CONST VOID *StandaloneKey,
+  OUT    VOID       **UserStruct   OPTIONAL
+  );
+
+
+/**
+  Iterate over the user structures linked into the hash map, in no particular
+  order.
+
+  Read-only operation.
+
+  The iteration is invalidated by HashMapInsert(), HashMapDelete() and
+  HashMapReserve(). A hash map can be emptied by deleting the user structure
+  returned for a zero Iterator until NULL is returned.
+
+  @param[in]     Map       The hash map to iterate over.
+
+  @param[in,out] Iterator  On input, zero to start the iteration, or the value
+                           returned by the previous call. On output, the
+                           position to continue the iteration from.
+
+  @retval NULL  All user structures have been returned.
+
+  @return       The next user structure linked into Map, otherwise.
+**/
+VOID *
+EFIAPI
+HashMapNext (
+  IN     CONST HASH_MAP *Map,
+  IN OUT UINTN          *Iterator
+  );
+
+
+/**
+  Hash a buffer of bytes.
+
+  This is a convenience for HASH_MAP_KEY_HASH implementations, for example for
+  GUID or string keys.
+
+  @param[in] Buffer  Pointer to the bytes to hash.
+
+  @param[in] Length  The number of bytes in Buffer.
+
+  @return  The hash value of the bytes in Buffer.
+**/
+UINTN
+EFIAPI
+HashMapHashBuffer (
+  IN CONST VOID *Buffer,
+  IN UINTN      Length
+  );
+
+#endif
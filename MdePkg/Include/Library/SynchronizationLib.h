@@ -14,6 +14,37 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 ///
 typedef volatile UINTN              SPIN_LOCK;
 
+///
+/// Definitions for TICKET_LOCK
+///
+/// A ticket lock hands the lock out in the order it was requested. Waiters
+/// only read NowServing, so a release invalidates a single cache line
+/// instead of letting all waiters race on it.
+///
+typedef struct {
+  volatile UINT32                   NextTicket;
+  volatile UINT32                   NowServing;
+} TICKET_LOCK;
+
+///
+/// Definitions for MCS_LOCK
+///
+/// An MCS lock queues waiters in a list of MCS_LOCK_NODE structures that
+/// are provided by the callers. Every waiter spins on its own node, so
+/// the lock scales to large processor counts. The node must remain valid
+/// from the acquire until the matching release.
+///
+typedef struct _MCS_LOCK_NODE MCS_LOCK_NODE;
+
+struct _MCS_LOCK_NODE {
+  MCS_LOCK_NODE * volatile          Next;
+  volatile UINT32                   Locked;
+};
+
+typedef struct {
+  MCS_LOCK_NODE * volatile          Tail;
+} MCS_LOCK;
+
 
 /**
   Retrieves the architecture-specific spin lock alignment requirements for
@@ -282,6 +313,169 @@ InterlockedCompareExchangePointer (
   IN      VOID                      *ExchangeValue
   );
 
+
+/**
+  Performs an atomic addition on a 64-bit unsigned integer.
+
+  Performs an atomic addition of Addend to the 64-bit unsigned integer
+  specified by Value and returns the original value. The addition operation
+  must be performed using MP safe mechanisms.
+
+  If Value is NULL, then ASSERT().
+
+  @param  Value   A pointer to the 64-bit value to add to.
+  @param  Addend  64-bit value to add.
+
+  @return The original *Value before the addition.
+
+**/
+UINT64
+EFIAPI
+InterlockedFetchAdd64 (
+  IN OUT  volatile UINT64           *Value,
+  IN      UINT64                    Addend
+  );
+
+
+/**
+  Initializes a ticket lock to the released state and returns the ticket lock.
+
+  If TicketLock is NULL, then ASSERT().
+
+  @param  TicketLock  A pointer to the ticket lock to initialize.
+
+  @return TicketLock in release state.
+
+**/
+TICKET_LOCK *
+EFIAPI
+InitializeTicketLock (
+  OUT     TICKET_LOCK               *TicketLock
+  );
+
+
+/**
+  Waits until a ticket lock can be placed in the acquired state.
+
+  The callers are granted the lock in the order in which they called this
+  function. Unlike AcquireSpinLock(), PcdSpinLockTimeout is not honored,
+  because a waiter can not give up its place in the queue.
+
+  If TicketLock is NULL, then ASSERT().
+
+  @param  TicketLock  A pointer to the ticket lock to place in the acquired
+                      state.
+
+  @return TicketLock acquired the lock.
+
+**/
+TICKET_LOCK *
+EFIAPI
+AcquireTicketLock (
+  IN OUT  TICKET_LOCK               *TicketLock
+  );
+
+
+/**
+  Attempts to place a ticket lock in the acquired state.
+
+  The lock is only taken if it is released and no other caller is waiting
+  for it.
+
+  If TicketLock is NULL, then ASSERT().
+
+  @param  TicketLock  A pointer to the ticket lock to place in the acquired
+                      state.
+
+  @retval TRUE  TicketLock was placed in the acquired state.
+  @retval FALSE TicketLock could not be acquired.
+
+**/
+BOOLEAN
+EFIAPI
+AcquireTicketLockOrFail (
+  IN OUT  TICKET_LOCK               *TicketLock
+  );
+
+
+/**
+  Releases a ticket lock, and grants it to the next waiter, if any.
+
+  If TicketLock is NULL, then ASSERT().
+
+  @param  TicketLock  A pointer to the ticket lock to release.
+
+  @return TicketLock released the lock.
+
+**/
+TICKET_LOCK *
+EFIAPI
+ReleaseTicketLock (
+  IN OUT  TICKET_LOCK               *TicketLock
+  );
+
+
+/**
+  Initializes an MCS lock to the released state and returns the MCS lock.
+
+  If McsLock is NULL, then ASSERT().
+
+  @param  McsLock  A pointer to the MCS lock to initialize.
+
+  @return McsLock in release state.
+
+**/
+MCS_LOCK *
+EFIAPI
+InitializeMcsLock (
+  OUT     MCS_LOCK                  *McsLock
+  );
+
+
+/**
+  Waits until an MCS lock can be placed in the acquired state.
+
+  Node is queued behind the current waiters, and the caller spins on Node
+  only. The callers are granted the lock in the order in which they were
+  queued. Node must not be used for anything else until ReleaseMcsLock() is
+  called with it.
+
+  If McsLock is NULL, then ASSERT().
+  If Node is NULL, then ASSERT().
+
+  @param  McsLock  A pointer to the MCS lock to place in the acquired state.
+  @param  Node     A pointer to the queue node of the caller.
+
+  @return McsLock acquired the lock.
+
+**/
+MCS_LOCK *
+EFIAPI
+AcquireMcsLock (
+  IN OUT  MCS_LOCK                  *McsLock,
+  OUT     MCS_LOCK_NODE             *Node
+  );
+
+
+/**
+  Releases an MCS lock, and grants it to the next queued waiter, if any.
+
+  If McsLock is NULL, then ASSERT().
+  If Node is NULL, then ASSERT().
+
+  @param  McsLock  A pointer to the MCS lock to release.
+  @param  Node     The queue node that was passed to AcquireMcsLock().
+
+  @return McsLock released the lock.
+
+**/
+MCS_LOCK *
+EFIAPI
+ReleaseMcsLock (
+  IN OUT  MCS_LOCK                  *McsLock,
+  IN OUT  MCS_LOCK_NODE             *Node
+  );
+
 #endif
 
 
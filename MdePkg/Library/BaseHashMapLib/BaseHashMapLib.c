@@ -0,0 +1,787 @@
+/** @file
+  A HashMapLib instance that provides an open addressing hash table with
+  linear probing, and allocates and releases the tables with
+  MemoryAllocationLib.
+
+  The slots of a table are an array of {hash, user structure} pairs, so a
+  lookup usually touches a single cache line, and the key comparator is only
+  called when the stored hash matches. Deletion shifts the following entries
+  of the probe sequence back instead of leaving tombstones.
+
+  When a table gets three quarters full, a table of twice the size is
+  allocated and the entries are moved over a few probe clusters at a time by
+  the following insertions and deletions. While moving, lookups search both
+  tables.
+
+  Copyright (c) 2021, EDK II contributors. All rights reserved.<BR>
+
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+**/
+
+#include <Library/HashMapLib.h>
+#include <Library/BaseLib.h>
+#include <Library/DebugLib.h>
+#include <Library/MemoryAllocationLib.h>
+
+//
+// The smallest table, in slots.
+//
+#define HASH_MAP_MIN_CAPACITY       8
+
+//
+// The number of old table slots moved to the new table by each insertion or
+// deletion while the hash map grows.
+//
+#define HASH_MAP_MIGRATE_SLOTS      16
+
+//
+// Fibonacci hashing multiplier, 2^32 divided by the golden ratio.
+//
+#define HASH_MAP_GOLDEN_RATIO_32    0x9E3779B9U
+
+typedef struct {
+  UINT32                Hash;
+  VOID                  *UserStruct;
+} HASH_MAP_SLOT;
+
+typedef struct {
+  HASH_MAP_SLOT         *Slots;
+  UINTN                 Capacity;
+  UINTN                 Shift;
+  UINTN                 Count;
+} HASH_MAP_TABLE;
+
+struct HASH_MAP {
+  HASH_MAP_GET_KEY      GetKey;
+  HASH_MAP_KEY_HASH     KeyHash;
+  HASH_MAP_KEY_COMPARE  KeyCompare;
+  //
+  // The table new entries are inserted into.
+  //
+  HASH_MAP_TABLE        Table;
+  //
+  // The table being moved into Table, if Old.Slots is not NULL. Old only has
+  // whole probe clusters left, so it is searched the same way as Table.
+  //
+  HASH_MAP_TABLE        Old;
+  UINTN                 MigrateIndex;
+  UINTN                 MigrateRemaining;
+};
+
+
+/**
+  Fold the hash value returned by the caller to 32 bits.
+
+  @param[in] Map  The hash map.
+  @param[in] Key  The key to hash.
+
+  @return  The folded hash value of Key.
+**/
+STATIC
+UINT32
+HashMapGetHash (
+  IN CONST HASH_MAP *Map,
+  IN CONST VOID     *Key
+  )
+{
+  UINT64  Hash;
+
+  Hash = Map->KeyHash (Key);
+  return (UINT32) Hash ^ (UINT32) RShiftU64 (Hash, 32);
+}
+
+/**
+  Return the home slot of a hash value in a table.
+
+  @param[in] Table  The table.
+  @param[in] Hash   The folded hash value.
+
+  @return  The index of the first slot probed for Hash.
+**/
+STATIC
+UINTN
+HashMapHomeSlot (
+  IN CONST HASH_MAP_TABLE *Table,
+  IN UINT32               Hash
+  )
+{
+  return (UINT32) (Hash * HASH_MAP_GOLDEN_RATIO_32) >> Table->Shift;
+}
+
+/**
+  Allocate the slots of a table.
+
+  @param[out] Table     The table to initialize.
+  @param[in]  Capacity  The number of slots, a power of two.
+
+  @retval RETURN_SUCCESS           Table has been initialized.
+  @retval RETURN_OUT_OF_RESOURCES  The slots could not be allocated.
+**/
+STATIC
+RETURN_STATUS
+HashMapAllocateTable (
+  OUT HASH_MAP_TABLE *Table,
+  IN  UINTN          Capacity
+  )
+{
+  ASSERT ((Capacity & (Capacity - 1)) == 0);
+
+  Table->Slots = AllocateZeroPool (Capacity * sizeof (HASH_MAP_SLOT));
+  if (Table->Slots == NULL) {
+    return RETURN_OUT_OF_RESOURCES;
+  }
+
+  Table->Capacity = Capacity;
+  Table->Shift    = 32 - HighBitSet32 ((UINT32) Capacity);
+  Table->Count    = 0;
+  return RETURN_SUCCESS;
+}
+
+/**
+  Return the table capacity needed to hold a number of user structures.
+
+  @param[in] Count  The number of user structures.
+
+  @retval 0      Count is too large.
+  @return        The smallest power of two capacity that keeps the table at
+                 most three quarters full, otherwise.
+**/
+STATIC
+UINTN
+HashMapCapacityFor (
+  IN UINTN Count
+  )
+{
+  UINTN  Capacity;
+
+  Capacity = HASH_MAP_MIN_CAPACITY;
+  while (Capacity / 4 * 3 < Count) {
+    if (Capacity >= BIT30) {
+      return 0;
+    }
+    Capacity <<= 1;
+  }
+
+  return Capacity;
+}
+
+/**
+  Look up the slot that holds a key in a table.
+
+  @param[in] Map    The hash map.
+  @param[in] Table  The table to search.
+  @param[in] Key    The key to locate.
+  @param[in] Hash   The folded hash value of Key.
+
+  @retval NULL  Key could not be found in Table.
+  @return       The slot that holds Key, otherwise.
+**/
+STATIC
+HASH_MAP_SLOT *
+HashMapFindSlot (
+  IN CONST HASH_MAP       *Map,
+  IN CONST HASH_MAP_TABLE *Table,
+  IN CONST VOID           *Key,
+  IN UINT32               Hash
+  )
+{
+  HASH_MAP_SLOT  *Slot;
+  UINTN          Index;
+  UINTN          Mask;
+
+  if (Table->Slots == NULL || Table->Count == 0) {
+    return NULL;
+  }
+
+  Mask  = Table->Capacity - 1;
+  Index = HashMapHomeSlot (Table, Hash);
+  for (Slot = &Table->Slots[Index]; Slot->UserStruct != NULL; Slot = &Table->Slots[Index]) {
+    if (Slot->Hash == Hash && Map->KeyCompare (Key, Map->GetKey (Slot->UserStruct))) {
+      return Slot;
+    }
+    Index = (Index + 1) & Mask;
+  }
+
+  return NULL;
+}
+
+/**
+  Store an entry in the first free slot of its probe sequence. The caller is
+  responsible for making sure that the key is not in the table yet, and that
+  the table has a free slot.
+
+  @param[in,out] Table       The table.
+  @param[in]     Hash        The folded hash value of the key of UserStruct.
+  @param[in]     UserStruct  The user structure.
+**/
+STATIC
+VOID
+HashMapStoreSlot (
+  IN OUT HASH_MAP_TABLE *Table,
+  IN     UINT32         Hash,
+  IN     VOID           *UserStruct
+  )
+{
+  UINTN  Index;
+  UINTN  Mask;
+
+  ASSERT (Table->Count < Table->Capacity - 1);
+
+  Mask  = Table->Capacity - 1;
+  Index = HashMapHomeSlot (Table, Hash);
+  while (Table->Slots[Index].UserStruct != NULL) {
+    Index = (Index + 1) & Mask;
+  }
+
+  Table->Slots[Index].Hash       = Hash;
+  Table->Slots[Index].UserStruct = UserStruct;
+  Table->Count++;
+}
+
+/**
+  Empty a slot, and move the following entries of the probe cluster back so
+  that no probe sequence is interrupted.
+
+  @param[in,out] Table  The table.
+  @param[in]     Slot   The slot to empty.
+**/
+STATIC
+VOID
+HashMapClearSlot (
+  IN OUT HASH_MAP_TABLE *Table,
+  IN     HASH_MAP_SLOT  *Slot
+  )
+{
+  UINTN  Hole;
+  UINTN  Index;
+  UINTN  Home;
+  UINTN  Mask;
+
+  Mask  = Table->Capacity - 1;
+  Hole  = Slot - Table->Slots;
+  Index = Hole;
+  for (;;) {
+    Index = (Index + 1) & Mask;
+    if (Table->Slots[Index].UserStruct == NULL) {
+      break;
+    }
+
+    //
+    // The entry at Index can fill the hole unless its home slot lies
+    // cyclically in (Hole, Index].
+    //
+    Home = HashMapHomeSlot (Table, Table->Slots[Index].Hash);
+    if (((Index - Home) & Mask) >= ((Index - Hole) & Mask)) {
+      Table->Slots[Hole] = Table->Slots[Index];
+      Hole               = Index;
+    }
+  }
+
+  Table->Slots[Hole].Hash       = 0;
+  Table->Slots[Hole].UserStruct = NULL;
+  Table->Count--;
+}
+
+/**
+  Move entries from the old table to the current one.
+
+  Whole probe clusters are moved, so the entries left in the old table can
+  still be found with a regular probe.
+
+  @param[in,out] Map        The hash map.
+  @param[in]     SlotCount  The number of old slots to visit at least, or
+                            MAX_UINTN to finish the move.
+**/
+STATIC
+VOID
+HashMapMigrate (
+  IN OUT HASH_MAP *Map,
+  IN     UINTN    SlotCount
+  )
+{
+  HASH_MAP_TABLE  *Old;
+  HASH_MAP_SLOT   *Slot;
+
+  Old = &Map->Old;
+  if (Old->Slots == NULL) {
+    return;
+  }
+
+  while (Map->MigrateRemaining > 0 && Old->Count > 0) {
+    Slot = &Old->Slots[Map->MigrateIndex];
+    if (Slot->UserStruct == NULL) {
+      if (SlotCount == 0) {
+        break;
+      }
+    } else {
+      HashMapStoreSlot (&Map->Table, Slot->Hash, Slot->UserStruct);
+      Slot->UserStruct = NULL;
+      Old->Count--;
+    }
+
+    Map->MigrateIndex = (Map->MigrateIndex + 1) & (Old->Capacity - 1);
+    Map->MigrateRemaining--;
+    if (SlotCount > 0) {
+      SlotCount--;
+    }
+  }
+
+  if (Map->MigrateRemaining == 0 || Old->Count == 0) {
+    ASSERT (Old->Count == 0);
+    FreePool (Old->Slots);
+    Old->Slots = NULL;
+  }
+}
+
+/**
+  Replace the current table with a larger one, and start moving the entries
+  over to it.
+
+  @param[in,out] Map       The hash map.
+  @param[in]     Capacity  The capacity of the new table.
+
+  @retval RETURN_SUCCESS           The new table is in place.
+  @retval RETURN_OUT_OF_RESOURCES  The new table could not be allocated.
+**/
+STATIC
+RETURN_STATUS
+HashMapGrow (
+  IN OUT HASH_MAP *Map,
+  IN     UINTN    Capacity
+  )
+{
+  HASH_MAP_TABLE  Table;
+  RETURN_STATUS   Status;
+  UINTN           Index;
+
+  //
+  // Only one move can be in progress.
+  //
+  HashMapMigrate (Map, MAX_UINTN);
+
+  Status = HashMapAllocateTable (&Table, Capacity);
+  if (RETURN_ERROR (Status)) {
+    return Status;
+  }
+
+  if (Map->Table.Count == 0) {
+    FreePool (Map->Table.Slots);
+    Map->Table = Table;
+    return RETURN_SUCCESS;
+  }
+
+  //
+  // Start the move right after an empty slot, that is, at the start of a
+  // probe cluster. The table is never full, so there is one.
+  //
+  for (Index = 0; Map->Table.Slots[Index].UserStruct != NULL; Index++) {
+  }
+
+  Map->Old              = Map->Table;
+  Map->Table            = Table;
+  Map->MigrateIndex     = (Index + 1) & (Map->Old.Capacity - 1);
+  Map->MigrateRemaining = Map->Old.Capacity;
+  return RETURN_SUCCESS;
+}
+
+/**
+  Allocate and initialize the HASH_MAP structure.
+
+  @param[in]  GetKey           This caller-provided function returns the key
+                               embedded in a user structure.
+
+  @param[in]  KeyHash          This caller-provided function hashes a key.
+
+  @param[in]  KeyCompare       This caller-provided function checks two keys
+                               for equality.
+
+  @param[in]  InitialCapacity  The number of user structures that can be
+                               linked into the hash map before it grows. Zero
+                               selects a small default.
+
+  @retval NULL  If allocation failed.
+
+  @return       Pointer to the allocated, initialized HASH_MAP structure,
+                otherwise.
+**/
+HASH_MAP *
+EFIAPI
+HashMapInit (
+  IN HASH_MAP_GET_KEY     GetKey,
+  IN HASH_MAP_KEY_HASH    KeyHash,
+  IN HASH_MAP_KEY_COMPARE KeyCompare,
+  IN UINTN                InitialCapacity
+  )
+{
+  HASH_MAP  *Map;
+  UINTN     Capacity;
+
+  Capacity = HashMapCapacityFor (InitialCapacity);
+  if (Capacity == 0) {
+    return NULL;
+  }
+
+  Map = AllocateZeroPool (sizeof (*Map));
+  if (Map == NULL) {
+    return NULL;
+  }
+
+  if (RETURN_ERROR (HashMapAllocateTable (&Map->Table, Capacity))) {
+    FreePool (Map);
+    return NULL;
+  }
+
+  Map->GetKey     = GetKey;
+  Map->KeyHash    = KeyHash;
+  Map->KeyCompare = KeyCompare;
+  return Map;
+}
+
+/**
+  Uninitialize and release a HASH_MAP structure.
+
+  Read-write operation.
+
+  The user structures that are still linked into the hash map are not
+  touched; releasing them remains the caller's responsibility.
+
+  @param[in] Map  The hash map to uninitialize and release.
+**/
+VOID
+EFIAPI
+HashMapUninit (
+  IN HASH_MAP *Map
+  )
+{
+  if (Map->Old.Slots != NULL) {
+    FreePool (Map->Old.Slots);
+  }
+  FreePool (Map->Table.Slots);
+  FreePool (Map);
+}
+
+/**
+  Return the number of user structures linked into the hash map.
+
+  Read-only operation.
+
+  @param[in] Map  The hash map to count the user structures of.
+
+  @return  The number of user structures linked into Map.
+**/
+UINTN
+EFIAPI
+HashMapCount (
+  IN CONST HASH_MAP *Map
+  )
+{
+  return Map->Table.Count + Map->Old.Count;
+}
+
+/**
+  Make sure that the hash map can hold the specified number of user structures
+  without allocating memory in HashMapInsert().
+
+  Read-write operation.
+
+  @param[in,out] Map    The hash map to reserve room in.
+
+  @param[in]     Count  The total number of user structures the hash map
+                        should be able to hold.
+
+  @retval RETURN_SUCCESS           Room for Count user structures is available.
+
+  @retval RETURN_OUT_OF_RESOURCES  The function failed to allocate memory. The
+                                   hash map has not been changed.
+**/
+RETURN_STATUS
+EFIAPI
+HashMapReserve (
+  IN OUT HASH_MAP *Map,
+  IN     UINTN    Count
+  )
+{
+  UINTN  Capacity;
+
+  Capacity = HashMapCapacityFor (Count);
+  if (Capacity == 0) {
+    return RETURN_OUT_OF_RESOURCES;
+  }
+
+  if (Capacity <= Map->Table.Capacity) {
+    return RETURN_SUCCESS;
+  }
+
+  //
+  // Finish the move here, so that no later insertion has to grow the map.
+  //
+  if (RETURN_ERROR (HashMapGrow (Map, Capacity))) {
+    return RETURN_OUT_OF_RESOURCES;
+  }
+  HashMapMigrate (Map, MAX_UINTN);
+  return RETURN_SUCCESS;
+}
+
+/**
+  Look up the user structure that matches the specified standalone key.
+
+  Read-only operation.
+
+  @param[in] Map            The hash map to search for StandaloneKey.
+
+  @param[in] StandaloneKey  The key to locate among the user structures
+                            linked into Map.
+
+  @retval NULL  StandaloneKey could not be found.
+
+  @return       The user structure matching StandaloneKey, otherwise.
+**/
+VOID *
+EFIAPI
+HashMapFind (
+  IN CONST HASH_MAP *Map,
+  IN CONST VOID     *StandaloneKey
+  )
+{
+  HASH_MAP_SLOT  *Slot;
+  UINT32         Hash;
+
+  Hash = HashMapGetHash (Map, StandaloneKey);
+  Slot = HashMapFindSlot (Map, &Map->Table, StandaloneKey, Hash);
+  if (Slot == NULL) {
+    Slot = HashMapFindSlot (Map, &Map->Old, StandaloneKey, Hash);
+    if (Slot == NULL) {
+      return NULL;
+    }
+  }
+
+  return Slot->UserStruct;
+}
+
+/**
+  Insert (link) a user structure into the hash map.
+
+  Read-write operation.
+
+  When the hash map is full, a table of twice the size is allocated, and the
+  user structures are moved over to it a few at a time by the following
+  HashMapInsert() and HashMapDelete() calls, so no single call has to rehash
+  the whole map.
+
+  @param[in,out] Map         The hash map to insert UserStruct into.
+
+  @param[in]     UserStruct  The user structure to link into the hash map. It
+                             must not be NULL.
+
+  @param[out]    Existing    If the key of UserStruct collides with a user
+                             structure that is already linked into Map, and
+                             the caller provides this optional output-only
+                             parameter, then it is set on output to the
+                             colliding user structure. This enables
+                             "find-or-insert" in one function call.
+
+  @retval RETURN_SUCCESS           UserStruct has been linked into Map.
+
+  @retval RETURN_ALREADY_STARTED   A user structure with the same key is
+                                   already linked into Map. Map has not been
+                                   changed.
+
+  @retval RETURN_OUT_OF_RESOURCES  The function failed to allocate memory for
+                                   growing the hash map. Map has not been
+                                   changed.
+**/
+RETURN_STATUS
+EFIAPI
+HashMapInsert (
+  IN OUT HASH_MAP *Map,
+  IN     VOID     *UserStruct,
+  OUT    VOID     **Existing   OPTIONAL
+  )
+{
+  CONST VOID     *Key;
+  HASH_MAP_SLOT  *Slot;
+  UINT32         Hash;
+  UINTN          Capacity;
+  RETURN_STATUS  Status;
+
+  ASSERT (UserStruct != NULL);
+
+  HashMapMigrate (Map, HASH_MAP_MIGRATE_SLOTS);
+
+  Key  = Map->GetKey (UserStruct);
+  Hash = HashMapGetHash (Map, Key);
+  Slot = HashMapFindSlot (Map, &Map->Table, Key, Hash);
+  if (Slot == NULL) {
+    Slot = HashMapFindSlot (Map, &Map->Old, Key, Hash);
+  }
+  if (Slot != NULL) {
+    if (Existing != NULL) {
+      *Existing = Slot->UserStruct;
+    }
+    return RETURN_ALREADY_STARTED;
+  }
+
+  if (Map->Table.Capacity / 4 * 3 < HashMapCount (Map) + 1) {
+    Capacity = Map->Table.Capacity * 2;
+    Status   = RETURN_OUT_OF_RESOURCES;
+    if (Capacity <= BIT30) {
+      Status = HashMapGrow (Map, Capacity);
+    }
+
+    //
+    // Keep going on an overfull table as long as it has a free slot besides
+    // the one that terminates the probe sequences.
+    //
+    if (RETURN_ERROR (Status) && Map->Table.Count + 2 >= Map->Table.Capacity) {
+      return Status;
+    }
+  }
+
+  HashMapStoreSlot (&Map->Table, Hash, UserStruct);
+  return RETURN_SUCCESS;
+}
+
+/**
+  Delete (unlink) the user structure that matches the specified standalone key
+  from the hash map.
+
+  Read-write operation.
+
+  @param[in,out] Map            The hash map to delete StandaloneKey from.
+
+  @param[in]     StandaloneKey  The key of the user structure to unlink.
+
+  @param[out]    UserStruct     If the caller provides this optional
+                                output-only parameter, then on output it is
+                                set to the user structure that has been
+                                unlinked.
+
+  @retval RETURN_SUCCESS    The user structure has been unlinked from Map.
+
+  @retval RETURN_NOT_FOUND  StandaloneKey could not be found.
+**/
+RETURN_STATUS
+EFIAPI
+HashMapDelete (
+  IN OUT HASH_MAP   *Map,
+  IN     CONST VOID *StandaloneKey,
+  OUT    VOID       **UserStruct   OPTIONAL
+  )
+{
+  HASH_MAP_TABLE  *Table;
+  HASH_MAP_SLOT   *Slot;
+  UINT32          Hash;
+
+  HashMapMigrate (Map, HASH_MAP_MIGRATE_SLOTS);
+
+  Hash  = HashMapGetHash (Map, StandaloneKey);
+  Table = &Map->Table;
+  Slot  = HashMapFindSlot (Map, Table, StandaloneKey, Hash);
+  if (Slot == NULL) {
+    Table = &Map->Old;
+    Slot  = HashMapFindSlot (Map, Table, StandaloneKey, Hash);
+    if (Slot == NULL) {
+      return RETURN_NOT_FOUND;
+    }
+  }
+
+  if (UserStruct != NULL) {
+    *UserStruct = Slot->UserStruct;
+  }
+
+  //
+  // The old table only has whole probe clusters left, and the move never
+  // restarts in the middle of one, so shifting entries back within a cluster
+  // is safe in the old table too.
+  //
+  HashMapClearSlot (Table, Slot);
+  return RETURN_SUCCESS;
+}
+
+/**
+  Iterate over the user structures linked into the hash map, in no particular
+  order.
+
+  Read-only operation.
+
+  The iteration is invalidated by HashMapInsert(), HashMapDelete() and
+  HashMapReserve(). A hash map can be emptied by deleting the user structure
+  returned for a zero Iterator until NULL is returned.
+
+  @param[in]     Map       The hash map to iterate over.
+
+  @param[in,out] Iterator  On input, zero to start the iteration, or the value
+                           returned by the previous call. On output, the
+                           position to continue the iteration from.
+
+  @retval NULL  All user structures have been returned.
+
+  @return       The next user structure linked into Map, otherwise.
+**/
+VOID *
+EFIAPI
+HashMapNext (
+  IN     CONST HASH_MAP *Map,
+  IN OUT UINTN          *Iterator
+  )
+{
+  CONST HASH_MAP_TABLE  *Table;
+  UINTN                 Index;
+  UINTN                 Base;
+
+  //
+  // The iterator runs over the slots of the current table first, then over
+  // those of the old table.
+  //
+  Index = *Iterator;
+  Base  = 0;
+  Table = &Map->Table;
+  for (;;) {
+    if (Index - Base >= Table->Capacity) {
+      if (Table == &Map->Old || Map->Old.Slots == NULL) {
+        *Iterator = Index;
+        return NULL;
+      }
+      Base  += Table->Capacity;
+      Table  = &Map->Old;
+      continue;
+    }
+
+    if (Table->Slots[Index - Base].UserStruct != NULL) {
+      *Iterator = Index + 1;
+      return Table->Slots[Index - Base].UserStruct;
+    }
+    Index++;
+  }
+}
+
+/**
+  Hash a buffer of bytes.
+
+  This is a convenience for HASH_MAP_KEY_HASH implementations, for example for
+  GUID or string keys. The 32-bit FNV-1a hash is used.
+
+  @param[in] Buffer  Pointer to the bytes to hash.
+
+  @param[in] Length  The number of bytes in Buffer.
+
+  @return  The hash value of the bytes in Buffer.
+**/
+UINTN
+EFIAPI
+HashMapHashBuffer (
+  IN CONST VOID *Buffer,
+  IN UINTN      Length
+  )
+{
+  CONST UINT8  *Bytes;
+  UINT32       Hash;
+
+  Bytes = Buffer;
+  Hash  = 0x811C9DC5;
+  while (Length-- > 0) {
+    Hash = (Hash ^ *Bytes++) * 0x01000193;
+  }
+
+  return Hash;
+}
@@ -0,0 +1,72 @@
+/** @file
+  CRC32 computation with the ARMv8 CRC32 instructions when the processor
+  supports them.
+
+  Copyright (c) 2021, EDK II contributors. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "BaseLibInternals.h"
+
+//
+// ID_AA64ISAR0_EL1.CRC32, bits [19:16]
+//
+#define ID_AA64ISAR0_CRC32_SHIFT  16
+#define ID_AA64ISAR0_CRC32_MASK   0xF
+
+/**
+  Reads the ID_AA64ISAR0_EL1 register.
+
+  @return The value of ID_AA64ISAR0_EL1.
+
+**/
+UINT64
+EFIAPI
+InternalArmReadIdAa64Isar0 (
+  VOID
+  );
+
+/**
+  Updates a CRC32 register with the CRC32 instructions.
+
+  @param  Crc     The running CRC register, without the final inversion.
+  @param  Buffer  The data to update the CRC with.
+  @param  Length  The number of bytes in Buffer.
+
+  @return The updated CRC register.
+
+**/
+UINT32
+EFIAPI
+InternalCrc32ArmCrc (
+  IN UINT32       Crc,
+  IN CONST UINT8  *Buffer,
+  IN UINTN        Length
+  );
+
+/**
+  Updates a CRC32 register over a data buffer with processor instructions,
+  if the processor supports them.
+
+  @param[in, out]  Crc     The running CRC register, without the final inversion.
+  @param[in]       Buffer  The data to update the CRC with.
+  @param[in]       Length  The number of bytes in Buffer.
+
+  @return The number of leading bytes of Buffer that have been processed.
+
+**/
+UINTN
+InternalCalculateCrc32Accel (
+  IN OUT UINT32       *Crc,
+  IN     CONST UINT8  *Buffer,
+  IN     UINTN        Length
+  )
+{
+  if (((InternalArmReadIdAa64Isar0 () >> ID_AA64ISAR0_CRC32_SHIFT) & ID_AA64ISAR0_CRC32_MASK) == 0) {
+    return 0;
+  }
+
+  *Crc = InternalCrc32ArmCrc (*Crc, Buffer, Length);
+  return Length;
+}
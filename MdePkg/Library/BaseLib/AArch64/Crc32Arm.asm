@@ -0,0 +1,82 @@
+;------------------------------------------------------------------------------
+;
+; CRC32 (ITU-T V.42) computation with the ARMv8 CRC32 instructions
+;
+; Copyright (c) 2021, EDK II contributors. All rights reserved.<BR>
+;
+; SPDX-License-Identifier: BSD-2-Clause-Patent
+;
+;------------------------------------------------------------------------------
+
+  EXPORT InternalArmReadIdAa64Isar0
+  EXPORT InternalCrc32ArmCrc
+  AREA BaseLib_LowLevel, CODE, READONLY
+
+;/**
+;  Reads the ID_AA64ISAR0_EL1 register.
+;
+;  @return The value of ID_AA64ISAR0_EL1.
+;
+;**/
+;UINT64
+;EFIAPI
+;InternalArmReadIdAa64Isar0 (
+;  VOID
+;  );
+;
+InternalArmReadIdAa64Isar0
+    mrs     x0, id_aa64isar0_el1
+    ret
+
+;/**
+;  Updates a CRC32 register with the CRC32 instructions.
+;
+;  The caller must check ID_AA64ISAR0_EL1.CRC32 before calling this function.
+;
+;  @param  Crc     The running CRC register, without the final inversion.
+;  @param  Buffer  The data to update the CRC with.
+;  @param  Length  The number of bytes in Buffer.
+;
+;  @return The updated CRC register.
+;
+;**/
+;UINT32
+;EFIAPI
+;InternalCrc32ArmCrc (
+;  IN UINT32       Crc,
+;  IN CONST UINT8  *Buffer,
+;  IN UINTN        Length
+;  );
+;
+InternalCrc32ArmCrc
+    ; Consume the leading bytes until Buffer is 8-byte aligned
+Crc32AlignLoop
+    tst     x1, #7
+    b.eq    Crc32QuadStart
+    cbz     x2, Crc32Done
+    ldrb    w3, [x1], #1
+    crc32b  w0, w0, w3
+    sub     x2, x2, #1
+    b       Crc32AlignLoop
+
+Crc32QuadStart
+    cmp     x2, #8
+    b.lo    Crc32ByteLoop
+Crc32QuadLoop
+    ldr     x3, [x1], #8
+    crc32x  w0, w0, x3
+    sub     x2, x2, #8
+    cmp     x2, #8
+    b.hs    Crc32QuadLoop
+
+Crc32ByteLoop
+    cbz     x2, Crc32Done
+    ldrb    w3, [x1], #1
+    crc32b  w0, w0, w3
+    sub     x2, x2, #1
+    b       Crc32ByteLoop
+
+Crc32Done
+    ret
+
+  END
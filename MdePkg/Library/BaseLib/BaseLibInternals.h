@@ -564,6 +564,29 @@ InternalAsciiHexCharToUintn (
   IN      CHAR8                    Char
   );
 
+/**
+  Updates a CRC32 register over a data buffer with processor instructions,
+  if the processor supports them.
+
+  The CRC32 is the ITU-T V.42 one computed by CalculateCrc32(). Crc holds the
+  running register value, without the final inversion. The function may
+  process only a leading part of the buffer, or nothing at all, and the
+  caller handles the remaining bytes.
+
+  @param[in, out]  Crc     The running CRC register, without the final inversion.
+  @param[in]       Buffer  The data to update the CRC with.
+  @param[in]       Length  The number of bytes in Buffer.
+
+  @return The number of leading bytes of Buffer that have been processed.
+
+**/
+UINTN
+InternalCalculateCrc32Accel (
+  IN OUT UINT32       *Crc,
+  IN     CONST UINT8  *Buffer,
+  IN     UINTN        Length
+  );
+
 
 //
 // Ia32 and x64 specific functions
@@ -0,0 +1,31 @@
+/** @file
+  CRC32 computation with processor instructions - NULL instance for
+  architectures without a fast path.
+
+  Copyright (c) 2021, EDK II contributors. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "BaseLibInternals.h"
+
+/**
+  Updates a CRC32 register over a data buffer with processor instructions,
+  if the processor supports them.
+
+  @param[in, out]  Crc     The running CRC register, without the final inversion.
+  @param[in]       Buffer  The data to update the CRC with.
+  @param[in]       Length  The number of bytes in Buffer.
+
+  @return The number of leading bytes of Buffer that have been processed.
+
+**/
+UINTN
+InternalCalculateCrc32Accel (
+  IN OUT UINT32       *Crc,
+  IN     CONST UINT8  *Buffer,
+  IN     UINTN        Length
+  )
+{
+  return 0;
+}
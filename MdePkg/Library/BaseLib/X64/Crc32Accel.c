@@ -0,0 +1,68 @@
+/** @file
+  CRC32 computation with carry-less multiplication when the processor
+  supports it.
+
+  Copyright (c) 2021, EDK II contributors. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "BaseLibInternals.h"
+#include <Register/Intel/Cpuid.h>
+
+//
+// Shorter buffers are not worth the CPUID and the final reduction.
+//
+#define CRC32_PCLMUL_MIN_LENGTH  256
+
+/**
+  Updates a CRC32 register with the PCLMULQDQ instruction.
+
+  @param  Crc     The running CRC register, without the final inversion.
+  @param  Buffer  The data to update the CRC with.
+  @param  Length  The number of bytes in Buffer, a multiple of 16 and at least 64.
+
+  @return The updated CRC register.
+
+**/
+UINT32
+EFIAPI
+InternalCrc32Pclmul (
+  IN UINT32       Crc,
+  IN CONST UINT8  *Buffer,
+  IN UINTN        Length
+  );
+
+/**
+  Updates a CRC32 register over a data buffer with processor instructions,
+  if the processor supports them.
+
+  @param[in, out]  Crc     The running CRC register, without the final inversion.
+  @param[in]       Buffer  The data to update the CRC with.
+  @param[in]       Length  The number of bytes in Buffer.
+
+  @return The number of leading bytes of Buffer that have been processed.
+
+**/
+UINTN
+InternalCalculateCrc32Accel (
+  IN OUT UINT32       *Crc,
+  IN     CONST UINT8  *Buffer,
+  IN     UINTN        Length
+  )
+{
+  CPUID_VERSION_INFO_ECX  VersionInfoEcx;
+
+  if (Length < CRC32_PCLMUL_MIN_LENGTH) {
+    return 0;
+  }
+
+  AsmCpuid (CPUID_VERSION_INFO, NULL, NULL, &VersionInfoEcx.Uint32, NULL);
+  if ((VersionInfoEcx.Bits.PCLMULQDQ == 0) || (VersionInfoEcx.Bits.SSE4_1 == 0)) {
+    return 0;
+  }
+
+  Length &= ~(UINTN) 0xF;
+  *Crc = InternalCrc32Pclmul (*Crc, Buffer, Length);
+  return Length;
+}
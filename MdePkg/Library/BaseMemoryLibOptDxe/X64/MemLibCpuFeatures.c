@@ -0,0 +1,90 @@
+/** @file
+  Processor feature detection for the x64 string routines.
+
+  Copyright (c) 2021, EDK II contributors. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "MemLibInternals.h"
+#include <Register/Intel/Cpuid.h>
+
+//
+// Must match the definitions in MemLibCpuFeatures.inc.
+//
+#define MEM_LIB_CPU_DETECTED  BIT0
+#define MEM_LIB_CPU_ERMS      BIT1
+#define MEM_LIB_CPU_FSRM      BIT2
+#define MEM_LIB_CPU_AVX2      BIT3
+
+//
+// CPUID.(EAX=07H, ECX=0):EDX[4], Fast Short REP MOVSB.
+//
+#define CPUID_EDX_FSRM        BIT4
+
+//
+// XCR0 bits that must be enabled by the firmware before AVX instructions
+// can be executed.
+//
+#define XCR0_SSE_AVX_STATE    (BIT1 | BIT2)
+
+//
+// The string routines used by this processor, detected on first use.
+// Zero means that InternalMemDetectCpuFeatures() has not been called yet.
+//
+UINT32  mMemLibCpuFeatures = 0;
+
+/**
+  Detects the processor features the string routines can use, and records
+  them in mMemLibCpuFeatures.
+
+  AVX2 is only reported if the firmware has enabled the AVX state in XCR0,
+  since the instructions raise #UD otherwise.
+
+  @return The value stored in mMemLibCpuFeatures.
+
+**/
+UINT32
+EFIAPI
+InternalMemDetectCpuFeatures (
+  VOID
+  )
+{
+  UINT32                                       Features;
+  UINT32                                       MaxLeaf;
+  CPUID_VERSION_INFO_ECX                       VersionInfoEcx;
+  CPUID_STRUCTURED_EXTENDED_FEATURE_FLAGS_EBX  ExtendedEbx;
+  UINT32                                       ExtendedEdx;
+
+  Features = MEM_LIB_CPU_DETECTED;
+
+  AsmCpuid (CPUID_SIGNATURE, &MaxLeaf, NULL, NULL, NULL);
+  if (MaxLeaf >= CPUID_STRUCTURED_EXTENDED_FEATURE_FLAGS) {
+    AsmCpuid (CPUID_VERSION_INFO, NULL, NULL, &VersionInfoEcx.Uint32, NULL);
+    AsmCpuidEx (
+      CPUID_STRUCTURED_EXTENDED_FEATURE_FLAGS,
+      CPUID_STRUCTURED_EXTENDED_FEATURE_FLAGS_SUB_LEAF_INFO,
+      NULL,
+      &ExtendedEbx.Uint32,
+      NULL,
+      &ExtendedEdx
+      );
+
+    if (ExtendedEbx.Bits.EnhancedRepMovsbStosb != 0) {
+      Features |= MEM_LIB_CPU_ERMS;
+      if ((ExtendedEdx & CPUID_EDX_FSRM) != 0) {
+        Features |= MEM_LIB_CPU_FSRM;
+      }
+    }
+
+    if ((ExtendedEbx.Bits.AVX2 != 0) &&
+        (VersionInfoEcx.Bits.AVX != 0) &&
+        (VersionInfoEcx.Bits.OSXSAVE != 0) &&
+        ((AsmXGetBv (0) & XCR0_SSE_AVX_STATE) == XCR0_SSE_AVX_STATE)) {
+      Features |= MEM_LIB_CPU_AVX2;
+    }
+  }
+
+  mMemLibCpuFeatures = Features;
+  return Features;
+}
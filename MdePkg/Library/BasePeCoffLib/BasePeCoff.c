@@ -912,6 +912,7 @@ PeCoffLoaderRelocateImage (
   PHYSICAL_ADDRESS                      BaseAddress;
   UINT32                                NumberOfRvaAndSizes;
   UINT32                                TeStrippedOffset;
+  BOOLEAN                               PageInImage;
 
   ASSERT (ImageContext != NULL);
 
@@ -1043,14 +1044,24 @@ PeCoffLoaderRelocateImage (
         return RETURN_LOAD_ERROR;
       }
 
+      //
+      // When the whole page of this block is inside the image, none of its
+      // entries can point outside of the image, so they need no address check.
+      //
+      PageInImage = (BOOLEAN) ((UINT64) RelocBase->VirtualAddress + 0xFFF < (UINT64) ImageContext->ImageSize + TeStrippedOffset);
+
       //
       // Run this relocation record
       //
       while ((UINTN) Reloc < (UINTN) RelocEnd) {
-        Fixup = PeCoffLoaderImageAddress (ImageContext, RelocBase->VirtualAddress + (*Reloc & 0xFFF), TeStrippedOffset);
-        if (Fixup == NULL) {
-          ImageContext->ImageError = IMAGE_ERROR_FAILED_RELOCATION;
-          return RETURN_LOAD_ERROR;
+        if (PageInImage) {
+          Fixup = FixupBase + (*Reloc & 0xFFF);
+        } else {
+          Fixup = PeCoffLoaderImageAddress (ImageContext, RelocBase->VirtualAddress + (*Reloc & 0xFFF), TeStrippedOffset);
+          if (Fixup == NULL) {
+            ImageContext->ImageError = IMAGE_ERROR_FAILED_RELOCATION;
+            return RETURN_LOAD_ERROR;
+          }
         }
         switch ((*Reloc) >> 12) {
         case EFI_IMAGE_REL_BASED_ABSOLUTE:
@@ -1085,6 +1096,20 @@ PeCoffLoaderRelocateImage (
           break;
 
         case EFI_IMAGE_REL_BASED_DIR64:
+          if ((FixupData == NULL) && PageInImage) {
+            //
+            // 64-bit images are almost only made of DIR64 fixups, so apply
+            // the whole run of them in a tight loop that only decodes the
+            // offsets, without going through the switch for each entry.
+            //
+            do {
+              Fixup64  = (UINT64 *) (FixupBase + (*Reloc & 0xFFF));
+              *Fixup64 = *Fixup64 + (UINT64) Adjust;
+              Reloc   += 1;
+            } while (((UINTN) Reloc < (UINTN) RelocEnd) && (((*Reloc) >> 12) == EFI_IMAGE_REL_BASED_DIR64));
+            continue;
+          }
+
           Fixup64 = (UINT64 *) Fixup;
           *Fixup64 = *Fixup64 + (UINT64) Adjust;
           if (FixupData != NULL) {
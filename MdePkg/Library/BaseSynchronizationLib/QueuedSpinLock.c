@@ -0,0 +1,305 @@
+/** @file
+  Implementation of fair spin locks and of 64-bit fetch-add.
+
+  The ticket and MCS locks are built on top of the architecture specific
+  interlocked primitives of this library, so this file is shared by all
+  architectures.
+
+  Copyright (c) 2021, EDK II contributors. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "BaseSynchronizationLibInternals.h"
+
+/**
+  Performs an atomic addition on a 64-bit unsigned integer.
+
+  Performs an atomic addition of Addend to the 64-bit unsigned integer
+  specified by Value and returns the original value. The addition operation
+  must be performed using MP safe mechanisms.
+
+  If Value is NULL, then ASSERT().
+
+  @param  Value   A pointer to the 64-bit value to add to.
+  @param  Addend  64-bit value to add.
+
+  @return The original *Value before the addition.
+
+**/
+UINT64
+EFIAPI
+InterlockedFetchAdd64 (
+  IN OUT  volatile UINT64           *Value,
+  IN      UINT64                    Addend
+  )
+{
+  UINT64  Original;
+
+  ASSERT (Value != NULL);
+
+  //
+  // A torn read of *Value on 32-bit processors is caught by the compare
+  // exchange, which then simply retries.
+  //
+  do {
+    Original = *Value;
+  } while (InterlockedCompareExchange64 (Value, Original, Original + Addend) != Original);
+
+  return Original;
+}
+
+/**
+  Initializes a ticket lock to the released state and returns the ticket lock.
+
+  If TicketLock is NULL, then ASSERT().
+
+  @param  TicketLock  A pointer to the ticket lock to initialize.
+
+  @return TicketLock in release state.
+
+**/
+TICKET_LOCK *
+EFIAPI
+InitializeTicketLock (
+  OUT     TICKET_LOCK               *TicketLock
+  )
+{
+  ASSERT (TicketLock != NULL);
+
+  TicketLock->NextTicket = 0;
+  TicketLock->NowServing = 0;
+  MemoryFence ();
+
+  return TicketLock;
+}
+
+/**
+  Waits until a ticket lock can be placed in the acquired state.
+
+  The callers are granted the lock in the order in which they called this
+  function. Unlike AcquireSpinLock(), PcdSpinLockTimeout is not honored,
+  because a waiter can not give up its place in the queue.
+
+  If TicketLock is NULL, then ASSERT().
+
+  @param  TicketLock  A pointer to the ticket lock to place in the acquired
+                      state.
+
+  @return TicketLock acquired the lock.
+
+**/
+TICKET_LOCK *
+EFIAPI
+AcquireTicketLock (
+  IN OUT  TICKET_LOCK               *TicketLock
+  )
+{
+  UINT32  Ticket;
+
+  ASSERT (TicketLock != NULL);
+
+  Ticket = InterlockedIncrement (&TicketLock->NextTicket) - 1;
+  while (TicketLock->NowServing != Ticket) {
+    CpuPause ();
+  }
+  MemoryFence ();
+
+  return TicketLock;
+}
+
+/**
+  Attempts to place a ticket lock in the acquired state.
+
+  The lock is only taken if it is released and no other caller is waiting
+  for it.
+
+  If TicketLock is NULL, then ASSERT().
+
+  @param  TicketLock  A pointer to the ticket lock to place in the acquired
+                      state.
+
+  @retval TRUE  TicketLock was placed in the acquired state.
+  @retval FALSE TicketLock could not be acquired.
+
+**/
+BOOLEAN
+EFIAPI
+AcquireTicketLockOrFail (
+  IN OUT  TICKET_LOCK               *TicketLock
+  )
+{
+  UINT32  Ticket;
+
+  ASSERT (TicketLock != NULL);
+
+  Ticket = TicketLock->NowServing;
+  if (TicketLock->NextTicket != Ticket) {
+    return FALSE;
+  }
+
+  //
+  // Draw the ticket that is being served right now, which only succeeds if
+  // nobody else drew a ticket in the meantime.
+  //
+  return (BOOLEAN) (InterlockedCompareExchange32 (
+                      &TicketLock->NextTicket,
+                      Ticket,
+                      Ticket + 1
+                      ) == Ticket);
+}
+
+/**
+  Releases a ticket lock, and grants it to the next waiter, if any.
+
+  If TicketLock is NULL, then ASSERT().
+
+  @param  TicketLock  A pointer to the ticket lock to release.
+
+  @return TicketLock released the lock.
+
+**/
+TICKET_LOCK *
+EFIAPI
+ReleaseTicketLock (
+  IN OUT  TICKET_LOCK               *TicketLock
+  )
+{
+  ASSERT (TicketLock != NULL);
+  ASSERT (TicketLock->NowServing != TicketLock->NextTicket);
+
+  //
+  // Only the owner updates NowServing; the interlocked operation orders the
+  // stores of the critical section before the hand-over.
+  //
+  InterlockedIncrement (&TicketLock->NowServing);
+
+  return TicketLock;
+}
+
+/**
+  Initializes an MCS lock to the released state and returns the MCS lock.
+
+  If McsLock is NULL, then ASSERT().
+
+  @param  McsLock  A pointer to the MCS lock to initialize.
+
+  @return McsLock in release state.
+
+**/
+MCS_LOCK *
+EFIAPI
+InitializeMcsLock (
+  OUT     MCS_LOCK                  *McsLock
+  )
+{
+  ASSERT (McsLock != NULL);
+
+  McsLock->Tail = NULL;
+  MemoryFence ();
+
+  return McsLock;
+}
+
+/**
+  Waits until an MCS lock can be placed in the acquired state.
+
+  Node is queued behind the current waiters, and the caller spins on Node
+  only. The callers are granted the lock in the order in which they were
+  queued. Node must not be used for anything else until ReleaseMcsLock() is
+  called with it.
+
+  If McsLock is NULL, then ASSERT().
+  If Node is NULL, then ASSERT().
+
+  @param  McsLock  A pointer to the MCS lock to place in the acquired state.
+  @param  Node     A pointer to the queue node of the caller.
+
+  @return McsLock acquired the lock.
+
+**/
+MCS_LOCK *
+EFIAPI
+AcquireMcsLock (
+  IN OUT  MCS_LOCK                  *McsLock,
+  OUT     MCS_LOCK_NODE             *Node
+  )
+{
+  MCS_LOCK_NODE  *Predecessor;
+
+  ASSERT (McsLock != NULL);
+  ASSERT (Node != NULL);
+
+  Node->Next   = NULL;
+  Node->Locked = 1;
+
+  //
+  // Append Node to the queue.
+  //
+  do {
+    Predecessor = McsLock->Tail;
+  } while (InterlockedCompareExchangePointer (
+             (VOID **) &McsLock->Tail,
+             Predecessor,
+             Node
+             ) != Predecessor);
+
+  if (Predecessor != NULL) {
+    //
+    // Let the predecessor find Node at release time, then wait for the
+    // hand-over.
+    //
+    Predecessor->Next = Node;
+    while (Node->Locked != 0) {
+      CpuPause ();
+    }
+  }
+  MemoryFence ();
+
+  return McsLock;
+}
+
+/**
+  Releases an MCS lock, and grants it to the next queued waiter, if any.
+
+  If McsLock is NULL, then ASSERT().
+  If Node is NULL, then ASSERT().
+
+  @param  McsLock  A pointer to the MCS lock to release.
+  @param  Node     The queue node that was passed to AcquireMcsLock().
+
+  @return McsLock released the lock.
+
+**/
+MCS_LOCK *
+EFIAPI
+ReleaseMcsLock (
+  IN OUT  MCS_LOCK                  *McsLock,
+  IN OUT  MCS_LOCK_NODE             *Node
+  )
+{
+  ASSERT (McsLock != NULL);
+  ASSERT (Node != NULL);
+
+  if (Node->Next == NULL) {
+    //
+    // No successor is known. If Node is still the tail, the queue becomes
+    // empty; otherwise a successor is linking itself in right now.
+    //
+    if (InterlockedCompareExchangePointer (
+          (VOID **) &McsLock->Tail,
+          Node,
+          NULL
+          ) == Node) {
+      return McsLock;
+    }
+    while (Node->Next == NULL) {
+      CpuPause ();
+    }
+  }
+
+  MemoryFence ();
+  Node->Next->Locked = 0;
+
+  return McsLock;
+}
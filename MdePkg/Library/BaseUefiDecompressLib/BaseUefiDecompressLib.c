@@ -24,45 +24,34 @@ FillBuf (
   IN  UINT16        NumOfBits
   )
 {
-  //
-  // Left shift NumOfBits of bits in advance
-  //
-  Sd->mBitBuf = (UINT32) LShiftU64 (((UINT64)Sd->mBitBuf), NumOfBits);
+  if (NumOfBits == 0) {
+    return;
+  }
 
   //
-  // Copy data needed in bytes into mSbuBitBuf
+  // Refill mSubBitBuf a whole 64-bit word at a time, so that most calls
+  // only shift instead of fetching source bytes one by one.
   //
-  while (NumOfBits > Sd->mBitCount) {
-    NumOfBits = (UINT16) (NumOfBits - Sd->mBitCount);
-    Sd->mBitBuf |= (UINT32) LShiftU64 (((UINT64)Sd->mSubBitBuf), NumOfBits);
-
-    if (Sd->mCompSize > 0) {
-      //
-      // Get 1 byte into SubBitBuf
-      //
-      Sd->mCompSize--;
-      Sd->mSubBitBuf  = Sd->mSrcBase[Sd->mInBuf++];
-      Sd->mBitCount   = 8;
-
-    } else {
+  if (NumOfBits > Sd->mBitCount) {
+    while (Sd->mBitCount <= 64 - 8) {
+      if (Sd->mCompSize > 0) {
+        Sd->mCompSize--;
+        Sd->mSubBitBuf |= LShiftU64 (Sd->mSrcBase[Sd->mInBuf++], 64 - 8 - Sd->mBitCount);
+      }
       //
       // No more bits from the source, just pad zero bit.
       //
-      Sd->mSubBitBuf  = 0;
-      Sd->mBitCount   = 8;
-
+      Sd->mBitCount = (UINT16) (Sd->mBitCount + 8);
     }
   }
 
   //
-  // Calculate additional bit count read to update mBitCount
-  //
-  Sd->mBitCount = (UINT16) (Sd->mBitCount - NumOfBits);
-
-  //
-  // Copy NumOfBits of bits from mSubBitBuf into mBitBuf
+  // Shift NumOfBits of bits from mSubBitBuf into mBitBuf
   //
-  Sd->mBitBuf |= Sd->mSubBitBuf >> Sd->mBitCount;
+  Sd->mBitBuf = (UINT32) LShiftU64 (((UINT64)Sd->mBitBuf), NumOfBits) |
+                (UINT32) RShiftU64 (Sd->mSubBitBuf, 64 - NumOfBits);
+  Sd->mSubBitBuf = LShiftU64 (Sd->mSubBitBuf, NumOfBits);
+  Sd->mBitCount  = (UINT16) (Sd->mBitCount - NumOfBits);
 }
 
 /**
@@ -569,6 +558,9 @@ Decode (
   UINT16  BytesRemain;
   UINT32  DataIdx;
   UINT16  CharC;
+  UINT32  Count;
+  UINT32  Index;
+  UINT8   *Dst;
 
   BytesRemain = (UINT16) (-1);
 
@@ -613,22 +605,35 @@ Decode (
       DataIdx     = Sd->mOutBuf - DecodeP (Sd) - 1;
 
       //
-      // Write BytesRemain of bytes into mDstBase
+      // Write BytesRemain of bytes into mDstBase, stopping at the end of
+      // the output. The string must lie within the output buffer.
       //
-      BytesRemain--;
+      if (Sd->mOutBuf >= Sd->mOrigSize) {
+        goto Done;
+      }
+      Count = MIN ((UINT32) BytesRemain, Sd->mOrigSize - Sd->mOutBuf);
+      if (DataIdx >= Sd->mOrigSize || Count > Sd->mOrigSize - DataIdx) {
+        Sd->mBadTableFlag = (UINT16) BAD_TABLE;
+        goto Done;
+      }
 
-      while ((INT16) (BytesRemain) >= 0) {
-        if (Sd->mOutBuf >= Sd->mOrigSize) {
-          goto Done;
-        }
-        if (DataIdx >= Sd->mOrigSize) {
-          Sd->mBadTableFlag = (UINT16) BAD_TABLE;
-          goto Done;
+      Dst = Sd->mDstBase + Sd->mOutBuf;
+      if (DataIdx + Count <= Sd->mOutBuf) {
+        //
+        // The string does not overlap the bytes being written, so let the
+        // BaseMemoryLib instance copy it with its widest moves.
+        //
+        CopyMem (Dst, Sd->mDstBase + DataIdx, Count);
+      } else {
+        //
+        // An overlapping string repeats its own output, so it has to be
+        // copied a byte at a time.
+        //
+        for (Index = 0; Index < Count; Index++) {
+          Dst[Index] = Sd->mDstBase[DataIdx + Index];
         }
-        Sd->mDstBase[Sd->mOutBuf++] = Sd->mDstBase[DataIdx++];
-
-        BytesRemain--;
       }
+      Sd->mOutBuf += Count;
       //
       // Once mOutBuf is fully filled, directly return
       //
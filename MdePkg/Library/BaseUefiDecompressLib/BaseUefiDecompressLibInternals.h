@@ -44,9 +44,9 @@ typedef struct {
   UINT32  mOutBuf;
   UINT32  mInBuf;
 
-  UINT16  mBitCount;
+  UINT16  mBitCount;   // The number of valid bits in mSubBitBuf
   UINT32  mBitBuf;
-  UINT32  mSubBitBuf;
+  UINT64  mSubBitBuf;  // Bits read ahead from source, most significant bit first
   UINT16  mBlockSize;
   UINT32  mCompSize;
   UINT32  mOrigSize;
@@ -143,15 +143,29 @@ GetNextGuidHob (
   )
 {
   EFI_PEI_HOB_POINTERS  GuidHob;
+  UINT64                Name[2];
+
+  ASSERT (Guid != NULL);
+  ASSERT (HobStart != NULL);
+
+  //
+  // Don't use GetNextHob () and CompareGuid () per HOB here for performance
+  // reasons, large HOB lists are searched many times during PEI. HOBs are
+  // 8-byte aligned, so the GUID name of each GUID HOB can be compared as two
+  // UINT64 values against an aligned copy of the input GUID.
+  //
+  CopyMem (Name, Guid, sizeof (Name));
 
   GuidHob.Raw = (UINT8 *) HobStart;
-  while ((GuidHob.Raw = GetNextHob (EFI_HOB_TYPE_GUID_EXTENSION, GuidHob.Raw)) != NULL) {
-    if (CompareGuid (Guid, &GuidHob.Guid->Name)) {
-      break;
+  while (!END_OF_HOB_LIST (GuidHob)) {
+    if ((GuidHob.Header->HobType == EFI_HOB_TYPE_GUID_EXTENSION) &&
+        (((UINT64 *) &GuidHob.Guid->Name)[0] == Name[0]) &&
+        (((UINT64 *) &GuidHob.Guid->Name)[1] == Name[1])) {
+      return GuidHob.Raw;
     }
     GuidHob.Raw = GET_NEXT_HOB (GuidHob);
   }
-  return GuidHob.Raw;
+  return NULL;
 }
 
 /**
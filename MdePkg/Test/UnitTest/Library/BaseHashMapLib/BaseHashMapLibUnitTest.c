@@ -0,0 +1,585 @@
+/** @file
+  Unit tests and micro-benchmarks of BaseHashMapLib.
+
+  The functional tests check the hash map against a plain array that records
+  which user structures are linked, including while the hash map is growing
+  and with a hash function that sends every key to a handful of slots. The
+  benchmark logs the number of time stamp counter ticks a lookup takes, next
+  to the linked list scan the hash map is meant to replace.
+
+  Copyright (c) 2021, EDK II contributors. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/HashMapLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/UnitTestLib.h>
+
+#define UNIT_TEST_APP_NAME     "BaseHashMapLib Unit Test Application"
+#define UNIT_TEST_APP_VERSION  "1.0"
+
+//
+// Number of user structures used by the tests.
+//
+#define TEST_ITEM_COUNT        4096
+
+//
+// Number of random operations run by the randomized test.
+//
+#define TEST_OPERATION_COUNT   200000
+
+//
+// Number of lookups timed for each map size.
+//
+#define BENCHMARK_ITERATIONS   1000
+
+#define TEST_ITEM_SIGNATURE    SIGNATURE_32 ('H', 'M', 'T', 'I')
+
+typedef struct {
+  UINT32      Signature;
+  LIST_ENTRY  Link;
+  UINT64      Key;
+  BOOLEAN     Linked;
+} TEST_ITEM;
+
+typedef struct {
+  TEST_ITEM   *Items;
+  HASH_MAP    *Map;
+} TEST_CONTEXT;
+
+STATIC CONST UINTN  mBenchmarkSizes[] = { 16, 64, 256, 1024, TEST_ITEM_COUNT };
+
+STATIC TEST_CONTEXT  mGoodHashContext;
+STATIC TEST_CONTEXT  mBadHashContext;
+
+STATIC UINT32  mRandomState = 1;
+
+/**
+  Return a pseudo random number, so that the tests are reproducible.
+
+  @return A 31-bit pseudo random number.
+
+**/
+STATIC
+UINTN
+TestRandom (
+  VOID
+  )
+{
+  mRandomState = mRandomState * 1103515245 + 12345;
+  return (mRandomState >> 1) & 0x7FFFFFFF;
+}
+
+/**
+  HASH_MAP_GET_KEY callback of the tests.
+
+  @param  UserStruct  Pointer to a TEST_ITEM.
+
+  @return Pointer to the key of the TEST_ITEM.
+
+**/
+STATIC
+CONST VOID *
+EFIAPI
+TestGetKey (
+  IN CONST VOID  *UserStruct
+  )
+{
+  return &((CONST TEST_ITEM *) UserStruct)->Key;
+}
+
+/**
+  HASH_MAP_KEY_HASH callback of the tests.
+
+  @param  Key  Pointer to a UINT64 key.
+
+  @return The hash value of Key.
+
+**/
+STATIC
+UINTN
+EFIAPI
+TestGoodHash (
+  IN CONST VOID  *Key
+  )
+{
+  return HashMapHashBuffer (Key, sizeof (UINT64));
+}
+
+/**
+  HASH_MAP_KEY_HASH callback of the tests that only produces 256 distinct
+  values, so that long probe clusters are exercised.
+
+  @param  Key  Pointer to a UINT64 key.
+
+  @return The hash value of Key.
+
+**/
+STATIC
+UINTN
+EFIAPI
+TestBadHash (
+  IN CONST VOID  *Key
+  )
+{
+  return (UINTN) (*(CONST UINT64 *) Key & 0xFF);
+}
+
+/**
+  HASH_MAP_KEY_COMPARE callback of the tests.
+
+  @param  Key1  Pointer to the first UINT64 key.
+  @param  Key2  Pointer to the second UINT64 key.
+
+  @retval TRUE   The keys are equal.
+  @retval FALSE  The keys differ.
+
+**/
+STATIC
+BOOLEAN
+EFIAPI
+TestKeyCompare (
+  IN CONST VOID  *Key1,
+  IN CONST VOID  *Key2
+  )
+{
+  return (BOOLEAN) (*(CONST UINT64 *) Key1 == *(CONST UINT64 *) Key2);
+}
+
+/**
+  Allocates the user structures and an empty hash map.
+
+  @param  Context  The TEST_CONTEXT to set up. The hash function is selected
+                   by which of the global contexts it is.
+
+  @retval UNIT_TEST_PASSED                      The context has been set up.
+  @retval UNIT_TEST_ERROR_PREREQUISITE_NOT_MET  Out of memory.
+
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+SetupTestContext (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT  *TestContext;
+  UINTN         Index;
+
+  TestContext        = (TEST_CONTEXT *) Context;
+  TestContext->Items = AllocateZeroPool (TEST_ITEM_COUNT * sizeof (TEST_ITEM));
+  if (TestContext->Items == NULL) {
+    return UNIT_TEST_ERROR_PREREQUISITE_NOT_MET;
+  }
+
+  for (Index = 0; Index < TEST_ITEM_COUNT; Index++) {
+    TestContext->Items[Index].Signature = TEST_ITEM_SIGNATURE;
+    TestContext->Items[Index].Key       = LShiftU64 (Index, 20) | (Index * 7919);
+  }
+
+  TestContext->Map = HashMapInit (
+                       TestGetKey,
+                       (TestContext == &mBadHashContext) ? TestBadHash : TestGoodHash,
+                       TestKeyCompare,
+                       0
+                       );
+  if (TestContext->Map == NULL) {
+    FreePool (TestContext->Items);
+    TestContext->Items = NULL;
+    return UNIT_TEST_ERROR_PREREQUISITE_NOT_MET;
+  }
+
+  mRandomState = 1;
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Frees the user structures and the hash map.
+
+  @param  Context  The TEST_CONTEXT to clean up.
+
+**/
+STATIC
+VOID
+EFIAPI
+CleanupTestContext (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT  *TestContext;
+
+  TestContext = (TEST_CONTEXT *) Context;
+  if (TestContext->Map != NULL) {
+    HashMapUninit (TestContext->Map);
+    TestContext->Map = NULL;
+  }
+
+  if (TestContext->Items != NULL) {
+    FreePool (TestContext->Items);
+    TestContext->Items = NULL;
+  }
+}
+
+/**
+  Checks that the hash map links exactly the user structures that are
+  recorded as linked.
+
+  @param  TestContext  The TEST_CONTEXT to check.
+
+  @retval UNIT_TEST_PASSED              The hash map matches the records.
+  @retval UNIT_TEST_ERROR_TEST_FAILED   The hash map differs from the records.
+
+**/
+STATIC
+UNIT_TEST_STATUS
+CheckMapContents (
+  IN TEST_CONTEXT  *TestContext
+  )
+{
+  TEST_ITEM  *Item;
+  UINTN      Index;
+  UINTN      Count;
+  UINTN      Iterator;
+
+  Count = 0;
+  for (Index = 0; Index < TEST_ITEM_COUNT; Index++) {
+    Item = &TestContext->Items[Index];
+    if (Item->Linked) {
+      UT_ASSERT_EQUAL ((UINTN) HashMapFind (TestContext->Map, &Item->Key), (UINTN) Item);
+      Count++;
+    } else {
+      UT_ASSERT_EQUAL ((UINTN) HashMapFind (TestContext->Map, &Item->Key), (UINTN) NULL);
+    }
+  }
+
+  UT_ASSERT_EQUAL (HashMapCount (TestContext->Map), Count);
+
+  Iterator = 0;
+  while ((Item = HashMapNext (TestContext->Map, &Iterator)) != NULL) {
+    UT_ASSERT_EQUAL (Item->Signature, TEST_ITEM_SIGNATURE);
+    UT_ASSERT_TRUE (Item->Linked);
+    Count--;
+  }
+
+  UT_ASSERT_EQUAL (Count, 0);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Checks insertion, duplicate detection, lookup and deletion of all user
+  structures, in order.
+
+  @param  Context  The TEST_CONTEXT to test with.
+
+  @retval UNIT_TEST_PASSED              All checks passed.
+  @retval UNIT_TEST_ERROR_TEST_FAILED   A check failed.
+
+**/
+UNIT_TEST_STATUS
+EFIAPI
+InsertFindDeleteTest (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT  *TestContext;
+  TEST_ITEM     *Item;
+  TEST_ITEM     Duplicate;
+  VOID          *Existing;
+  VOID          *UserStruct;
+  UINTN         Index;
+
+  TestContext = (TEST_CONTEXT *) Context;
+
+  for (Index = 0; Index < TEST_ITEM_COUNT; Index++) {
+    Item = &TestContext->Items[Index];
+    UT_ASSERT_NOT_EFI_ERROR (HashMapInsert (TestContext->Map, Item, NULL));
+    Item->Linked = TRUE;
+
+    CopyMem (&Duplicate, Item, sizeof (Duplicate));
+    Existing = NULL;
+    UT_ASSERT_STATUS_EQUAL (HashMapInsert (TestContext->Map, &Duplicate, &Existing), RETURN_ALREADY_STARTED);
+    UT_ASSERT_EQUAL ((UINTN) Existing, (UINTN) Item);
+  }
+
+  UT_ASSERT_STATUS_EQUAL (CheckMapContents (TestContext), UNIT_TEST_PASSED);
+
+  for (Index = 0; Index < TEST_ITEM_COUNT; Index += 2) {
+    Item       = &TestContext->Items[Index];
+    UserStruct = NULL;
+    UT_ASSERT_NOT_EFI_ERROR (HashMapDelete (TestContext->Map, &Item->Key, &UserStruct));
+    UT_ASSERT_EQUAL ((UINTN) UserStruct, (UINTN) Item);
+    UT_ASSERT_STATUS_EQUAL (HashMapDelete (TestContext->Map, &Item->Key, NULL), RETURN_NOT_FOUND);
+    Item->Linked = FALSE;
+  }
+
+  UT_ASSERT_STATUS_EQUAL (CheckMapContents (TestContext), UNIT_TEST_PASSED);
+
+  //
+  // Empty the map the way the library class documents.
+  //
+  for (;;) {
+    Index = 0;
+    Item  = HashMapNext (TestContext->Map, &Index);
+    if (Item == NULL) {
+      break;
+    }
+    UT_ASSERT_NOT_EFI_ERROR (HashMapDelete (TestContext->Map, &Item->Key, NULL));
+    Item->Linked = FALSE;
+  }
+
+  UT_ASSERT_EQUAL (HashMapCount (TestContext->Map), 0);
+  return CheckMapContents (TestContext);
+}
+
+/**
+  Checks the hash map against the records after random insertions and
+  deletions, which also interleave with the incremental growth.
+
+  @param  Context  The TEST_CONTEXT to test with.
+
+  @retval UNIT_TEST_PASSED              All checks passed.
+  @retval UNIT_TEST_ERROR_TEST_FAILED   A check failed.
+
+**/
+UNIT_TEST_STATUS
+EFIAPI
+RandomOperationTest (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT   *TestContext;
+  TEST_ITEM      *Item;
+  UINTN          Operation;
+  RETURN_STATUS  Status;
+
+  TestContext = (TEST_CONTEXT *) Context;
+
+  for (Operation = 0; Operation < TEST_OPERATION_COUNT; Operation++) {
+    Item = &TestContext->Items[TestRandom () % TEST_ITEM_COUNT];
+    if (TestRandom () % 3 != 0) {
+      Status = HashMapInsert (TestContext->Map, Item, NULL);
+      UT_ASSERT_STATUS_EQUAL (Status, Item->Linked ? RETURN_ALREADY_STARTED : RETURN_SUCCESS);
+      Item->Linked = TRUE;
+    } else {
+      Status = HashMapDelete (TestContext->Map, &Item->Key, NULL);
+      UT_ASSERT_STATUS_EQUAL (Status, Item->Linked ? RETURN_SUCCESS : RETURN_NOT_FOUND);
+      Item->Linked = FALSE;
+    }
+
+    if (Operation % 997 == 0) {
+      UT_ASSERT_STATUS_EQUAL (CheckMapContents (TestContext), UNIT_TEST_PASSED);
+    }
+  }
+
+  return CheckMapContents (TestContext);
+}
+
+/**
+  Checks that HashMapReserve() makes room for the requested number of user
+  structures.
+
+  @param  Context  The TEST_CONTEXT to test with.
+
+  @retval UNIT_TEST_PASSED              All checks passed.
+  @retval UNIT_TEST_ERROR_TEST_FAILED   A check failed.
+
+**/
+UNIT_TEST_STATUS
+EFIAPI
+ReserveTest (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT  *TestContext;
+  UINTN         Index;
+
+  TestContext = (TEST_CONTEXT *) Context;
+
+  for (Index = 0; Index < TEST_ITEM_COUNT / 2; Index++) {
+    UT_ASSERT_NOT_EFI_ERROR (HashMapInsert (TestContext->Map, &TestContext->Items[Index], NULL));
+    TestContext->Items[Index].Linked = TRUE;
+  }
+
+  UT_ASSERT_NOT_EFI_ERROR (HashMapReserve (TestContext->Map, TEST_ITEM_COUNT));
+  UT_ASSERT_STATUS_EQUAL (CheckMapContents (TestContext), UNIT_TEST_PASSED);
+
+  for ( ; Index < TEST_ITEM_COUNT; Index++) {
+    UT_ASSERT_NOT_EFI_ERROR (HashMapInsert (TestContext->Map, &TestContext->Items[Index], NULL));
+    TestContext->Items[Index].Linked = TRUE;
+  }
+
+  return CheckMapContents (TestContext);
+}
+
+/**
+  Logs the time a hash map lookup takes, next to a linked list scan, for
+  several numbers of user structures.
+
+  @param  Context  The TEST_CONTEXT to test with.
+
+  @retval UNIT_TEST_PASSED              All checks passed.
+  @retval UNIT_TEST_ERROR_TEST_FAILED   A lookup returned a wrong result.
+
+**/
+UNIT_TEST_STATUS
+EFIAPI
+LookupBenchmark (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT  *TestContext;
+  TEST_ITEM     *Item;
+  TEST_ITEM     *Found;
+  LIST_ENTRY    List;
+  LIST_ENTRY    *Link;
+  UINTN         SizeIndex;
+  UINTN         Size;
+  UINTN         Index;
+  UINTN         Iteration;
+  UINT64        Start;
+  UINT64        MapTicks;
+  UINT64        ListTicks;
+
+  TestContext = (TEST_CONTEXT *) Context;
+  InitializeListHead (&List);
+
+  Index = 0;
+  for (SizeIndex = 0; SizeIndex < ARRAY_SIZE (mBenchmarkSizes); SizeIndex++) {
+    Size = mBenchmarkSizes[SizeIndex];
+    for ( ; Index < Size; Index++) {
+      Item = &TestContext->Items[Index];
+      UT_ASSERT_NOT_EFI_ERROR (HashMapInsert (TestContext->Map, Item, NULL));
+      InsertTailList (&List, &Item->Link);
+    }
+
+    Found = NULL;
+    Start = AsmReadTsc ();
+    for (Iteration = 0; Iteration < BENCHMARK_ITERATIONS; Iteration++) {
+      Item  = &TestContext->Items[(Iteration * 7) % Size];
+      Found = HashMapFind (TestContext->Map, &Item->Key);
+      if (Found != Item) {
+        break;
+      }
+    }
+    MapTicks = AsmReadTsc () - Start;
+    UT_ASSERT_EQUAL ((UINTN) Found, (UINTN) Item);
+
+    Found = NULL;
+    Start = AsmReadTsc ();
+    for (Iteration = 0; Iteration < BENCHMARK_ITERATIONS; Iteration++) {
+      Item  = &TestContext->Items[(Iteration * 7) % Size];
+      Found = NULL;
+      for (Link = GetFirstNode (&List); !IsNull (&List, Link); Link = GetNextNode (&List, Link)) {
+        if (BASE_CR (Link, TEST_ITEM, Link)->Key == Item->Key) {
+          Found = BASE_CR (Link, TEST_ITEM, Link);
+          break;
+        }
+      }
+      if (Found != Item) {
+        break;
+      }
+    }
+    ListTicks = AsmReadTsc () - Start;
+    UT_ASSERT_EQUAL ((UINTN) Found, (UINTN) Item);
+
+    UT_LOG_INFO (
+      "HashMapFind %6d entries: %8ld ticks, linked list %8ld ticks\n",
+      (UINT32) Size,
+      DivU64x32 (MapTicks, BENCHMARK_ITERATIONS),
+      DivU64x32 (ListTicks, BENCHMARK_ITERATIONS)
+      );
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Initialize the unit test framework, suite, and unit tests for
+  BaseHashMapLib and run the unit tests.
+
+  @retval  EFI_SUCCESS           All test cases were dispatched.
+  @retval  EFI_OUT_OF_RESOURCES  There are not enough resources available to
+                                 initialize the unit tests.
+**/
+EFI_STATUS
+EFIAPI
+UnitTestingEntry (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Fw;
+  UNIT_TEST_SUITE_HANDLE      HashMapTests;
+  UNIT_TEST_SUITE_HANDLE      BenchmarkTests;
+
+  Fw = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_APP_NAME, UNIT_TEST_APP_VERSION));
+
+  //
+  // Start setting up the test framework for running the tests.
+  //
+  Status = InitUnitTestFramework (&Fw, UNIT_TEST_APP_NAME, gEfiCallerBaseName, UNIT_TEST_APP_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  //
+  // Populate the functional Unit Test Suite.
+  //
+  Status = CreateUnitTestSuite (&HashMapTests, Fw, "BaseHashMapLib functional tests", "BaseHashMapLib.Functional", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for HashMapTests\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  // --------------Suite---------Description----------------------------Class Name-------------Function---------------Pre---------------Post----------------Context-----------
+  AddTestCase (HashMapTests, "Insert, find and delete", "InsertFindDelete", InsertFindDeleteTest, SetupTestContext, CleanupTestContext, &mGoodHashContext);
+  AddTestCase (HashMapTests, "Insert, find and delete, bad hash", "InsertFindDeleteBadHash", InsertFindDeleteTest, SetupTestContext, CleanupTestContext, &mBadHashContext);
+  AddTestCase (HashMapTests, "Random operations", "RandomOperation", RandomOperationTest, SetupTestContext, CleanupTestContext, &mGoodHashContext);
+  AddTestCase (HashMapTests, "Random operations, bad hash", "RandomOperationBadHash", RandomOperationTest, SetupTestContext, CleanupTestContext, &mBadHashContext);
+  AddTestCase (HashMapTests, "Reserve", "Reserve", ReserveTest, SetupTestContext, CleanupTestContext, &mGoodHashContext);
+
+  //
+  // Populate the benchmark Unit Test Suite.
+  //
+  Status = CreateUnitTestSuite (&BenchmarkTests, Fw, "BaseHashMapLib benchmarks", "BaseHashMapLib.Benchmark", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for BenchmarkTests\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  AddTestCase (BenchmarkTests, "HashMapFind versus linked list scan", "Lookup", LookupBenchmark, SetupTestContext, CleanupTestContext, &mGoodHashContext);
+
+  //
+  // Execute the tests.
+  //
+  Status = RunAllTestSuites (Fw);
+
+EXIT:
+  if (Fw) {
+    FreeUnitTestFramework (Fw);
+  }
+
+  return Status;
+}
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+**/
+int
+main (
+  int argc,
+  char *argv[]
+  )
+{
+  return UnitTestingEntry ();
+}
@@ -0,0 +1,542 @@
+/** @file
+  Unit tests and micro-benchmarks of the BaseMemoryLib scan and compare
+  functions.
+
+  Each test checks the library function against a plain C reference
+  implementation on buffers of several sizes, and logs the number of time
+  stamp counter ticks both of them take, so that the gain of an optimized
+  BaseMemoryLib instance can be compared with the generic code.
+
+  Copyright (c) 2021, EDK II contributors. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/UnitTestLib.h>
+
+#define UNIT_TEST_APP_NAME     "BaseMemoryLib Benchmark Application"
+#define UNIT_TEST_APP_VERSION  "1.0"
+
+//
+// Number of calls timed for each buffer size.
+//
+#define BENCHMARK_ITERATIONS   1000
+
+//
+// Size of the largest buffer, in bytes.
+//
+#define BENCHMARK_MAX_SIZE     SIZE_64KB
+
+STATIC CONST UINTN  mBenchmarkSizes[] = { 16, 100, 256, SIZE_4KB, BENCHMARK_MAX_SIZE };
+
+STATIC VOID  *mBenchmarkBuffer = NULL;
+
+STATIC CONST EFI_GUID  mTargetGuid = {
+  0x5c8b1e0a, 0x3f2d, 0x4e7b, { 0x9a, 0x61, 0x0d, 0x4c, 0x2b, 0x8e, 0x7f, 0x13 }
+};
+
+//
+// Reference implementations.
+//
+
+/**
+  Reference implementation of IsZeroBuffer().
+
+  @param  Buffer  The pointer to the buffer to be checked.
+  @param  Length  The size of the buffer (in bytes) to be checked.
+
+  @retval TRUE    Buffer is all zero.
+  @retval FALSE   Buffer is not all zero.
+
+**/
+STATIC
+BOOLEAN
+ReferenceIsZeroBuffer (
+  IN CONST VOID  *Buffer,
+  IN UINTN       Length
+  )
+{
+  CONST UINT8  *Pointer;
+
+  for (Pointer = Buffer; Length > 0; Pointer++, Length--) {
+    if (*Pointer != 0) {
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
+/**
+  Reference implementation of ScanMem8/16/32/64().
+
+  @param  Buffer     The pointer to the buffer to scan.
+  @param  Length     The number of bytes in Buffer to scan.
+  @param  Value      The value to search for in the target buffer.
+  @param  ValueSize  The size of Value, in bytes.
+
+  @return A pointer to the matching element, or NULL if not found.
+
+**/
+STATIC
+CONST VOID *
+ReferenceScanMem (
+  IN CONST VOID  *Buffer,
+  IN UINTN       Length,
+  IN UINT64      Value,
+  IN UINTN       ValueSize
+  )
+{
+  CONST UINT8  *Pointer;
+  UINT64       Element;
+
+  for (Pointer = Buffer; Length >= ValueSize; Pointer += ValueSize, Length -= ValueSize) {
+    switch (ValueSize) {
+      case sizeof (UINT8):
+        Element = *Pointer;
+        break;
+      case sizeof (UINT16):
+        Element = *(CONST UINT16 *) Pointer;
+        break;
+      case sizeof (UINT32):
+        Element = *(CONST UINT32 *) Pointer;
+        break;
+      default:
+        Element = *(CONST UINT64 *) Pointer;
+        break;
+    }
+
+    if (Element == Value) {
+      return Pointer;
+    }
+  }
+
+  return NULL;
+}
+
+/**
+  Calls the BaseMemoryLib ScanMem function for ValueSize.
+
+  @param  Buffer     The pointer to the buffer to scan.
+  @param  Length     The number of bytes in Buffer to scan.
+  @param  Value      The value to search for in the target buffer.
+  @param  ValueSize  The size of Value, in bytes.
+
+  @return A pointer to the matching element, or NULL if not found.
+
+**/
+STATIC
+CONST VOID *
+LibraryScanMem (
+  IN CONST VOID  *Buffer,
+  IN UINTN       Length,
+  IN UINT64      Value,
+  IN UINTN       ValueSize
+  )
+{
+  switch (ValueSize) {
+    case sizeof (UINT8):
+      return ScanMem8 (Buffer, Length, (UINT8) Value);
+    case sizeof (UINT16):
+      return ScanMem16 (Buffer, Length, (UINT16) Value);
+    case sizeof (UINT32):
+      return ScanMem32 (Buffer, Length, (UINT32) Value);
+    default:
+      return ScanMem64 (Buffer, Length, Value);
+  }
+}
+
+/**
+  Reference implementation of ScanGuid().
+
+  @param  Buffer  The pointer to the buffer to scan.
+  @param  Length  The number of bytes in Buffer to scan.
+  @param  Guid    The value to search for in the target buffer.
+
+  @return A pointer to the matching Guid in the target buffer, or NULL.
+
+**/
+STATIC
+CONST VOID *
+ReferenceScanGuid (
+  IN CONST VOID      *Buffer,
+  IN UINTN           Length,
+  IN CONST EFI_GUID  *Guid
+  )
+{
+  CONST UINT8  *Pointer;
+  CONST UINT8  *GuidBytes;
+  UINTN        Index;
+
+  GuidBytes = (CONST UINT8 *) Guid;
+  for (Pointer = Buffer; Length >= sizeof (EFI_GUID); Pointer += sizeof (EFI_GUID), Length -= sizeof (EFI_GUID)) {
+    for (Index = 0; Index < sizeof (EFI_GUID); Index++) {
+      if (Pointer[Index] != GuidBytes[Index]) {
+        break;
+      }
+    }
+
+    if (Index == sizeof (EFI_GUID)) {
+      return Pointer;
+    }
+  }
+
+  return NULL;
+}
+
+//
+// Tests.
+//
+
+/**
+  Allocates the buffer used by the tests.
+
+  @param  Context  Receives the buffer.
+
+  @retval UNIT_TEST_PASSED                    The buffer has been allocated.
+  @retval UNIT_TEST_ERROR_PREREQUISITE_NOT_MET  Out of memory.
+
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+AllocateBenchmarkBuffer (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  VOID  **Buffer;
+
+  Buffer  = (VOID **) Context;
+  *Buffer = AllocateZeroPool (BENCHMARK_MAX_SIZE);
+  if (*Buffer == NULL) {
+    return UNIT_TEST_ERROR_PREREQUISITE_NOT_MET;
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Frees the buffer used by the tests.
+
+  @param  Context  The buffer.
+
+**/
+STATIC
+VOID
+EFIAPI
+FreeBenchmarkBuffer (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  VOID  **Buffer;
+
+  Buffer = (VOID **) Context;
+  if (*Buffer != NULL) {
+    FreePool (*Buffer);
+    *Buffer = NULL;
+  }
+}
+
+/**
+  Checks IsZeroBuffer() against the reference implementation, with a
+  non-zero byte at every position of small buffers and at the end of
+  large ones, and logs the time both of them take on zero buffers.
+
+  @param  Context  The test buffer.
+
+  @retval UNIT_TEST_PASSED              All checks passed.
+  @retval UNIT_TEST_ERROR_TEST_FAILED   A result differs from the reference.
+
+**/
+UNIT_TEST_STATUS
+EFIAPI
+IsZeroBufferBenchmark (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINT8    *Buffer;
+  UINTN    SizeIndex;
+  UINTN    Size;
+  UINTN    Index;
+  UINTN    Iteration;
+  UINT64   Start;
+  UINT64   LibraryTicks;
+  UINT64   ReferenceTicks;
+  BOOLEAN  Result;
+
+  Buffer = *(UINT8 **) Context;
+
+  for (Size = 0; Size <= 130; Size++) {
+    UT_ASSERT_TRUE (IsZeroBuffer (Buffer, Size));
+    for (Index = 0; Index < Size; Index++) {
+      Buffer[Index] = 0x80;
+      UT_ASSERT_FALSE (IsZeroBuffer (Buffer, Size));
+      Buffer[Index] = 0;
+    }
+  }
+
+  for (SizeIndex = 0; SizeIndex < ARRAY_SIZE (mBenchmarkSizes); SizeIndex++) {
+    Size = mBenchmarkSizes[SizeIndex];
+    Buffer[Size - 1] = 1;
+    UT_ASSERT_EQUAL (IsZeroBuffer (Buffer, Size), ReferenceIsZeroBuffer (Buffer, Size));
+    Buffer[Size - 1] = 0;
+
+    Result = TRUE;
+    Start  = AsmReadTsc ();
+    for (Iteration = 0; Iteration < BENCHMARK_ITERATIONS; Iteration++) {
+      Result &= IsZeroBuffer (Buffer, Size);
+    }
+    LibraryTicks = AsmReadTsc () - Start;
+
+    Start = AsmReadTsc ();
+    for (Iteration = 0; Iteration < BENCHMARK_ITERATIONS; Iteration++) {
+      Result &= ReferenceIsZeroBuffer (Buffer, Size);
+    }
+    ReferenceTicks = AsmReadTsc () - Start;
+
+    UT_ASSERT_TRUE (Result);
+    UT_LOG_INFO (
+      "IsZeroBuffer %6d bytes: %8ld ticks, reference %8ld ticks\n",
+      (UINT32) Size,
+      DivU64x32 (LibraryTicks, BENCHMARK_ITERATIONS),
+      DivU64x32 (ReferenceTicks, BENCHMARK_ITERATIONS)
+      );
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Checks ScanMem8/16/32/64() against the reference implementation, with
+  the value at every position of small buffers and at the end of large
+  ones, and logs the time both of them take when the value is last.
+
+  @param  Context  The test buffer.
+
+  @retval UNIT_TEST_PASSED              All checks passed.
+  @retval UNIT_TEST_ERROR_TEST_FAILED   A result differs from the reference.
+
+**/
+UNIT_TEST_STATUS
+EFIAPI
+ScanMemBenchmark (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINT8       *Buffer;
+  UINTN       ValueSize;
+  UINTN       SizeIndex;
+  UINTN       Size;
+  UINTN       Index;
+  UINTN       Iteration;
+  UINT64      Value;
+  UINT64      Start;
+  UINT64      LibraryTicks;
+  UINT64      ReferenceTicks;
+  CONST VOID  *Result;
+
+  Buffer = *(UINT8 **) Context;
+  Value  = 0xA5A5A5A5A5A5A5A5ULL;
+
+  for (ValueSize = sizeof (UINT8); ValueSize <= sizeof (UINT64); ValueSize *= 2) {
+    for (Size = ValueSize; Size <= 130; Size += ValueSize) {
+      UT_ASSERT_EQUAL ((UINTN) LibraryScanMem (Buffer, Size, Value, ValueSize), (UINTN) NULL);
+      for (Index = 0; Index < Size; Index += ValueSize) {
+        CopyMem (Buffer + Index, &Value, ValueSize);
+        UT_ASSERT_EQUAL ((UINTN) LibraryScanMem (Buffer, Size, Value, ValueSize), (UINTN) (Buffer + Index));
+        ZeroMem (Buffer + Index, ValueSize);
+      }
+    }
+
+    for (SizeIndex = 0; SizeIndex < ARRAY_SIZE (mBenchmarkSizes); SizeIndex++) {
+      Size = mBenchmarkSizes[SizeIndex] & ~(ValueSize - 1);
+      CopyMem (Buffer + Size - ValueSize, &Value, ValueSize);
+      UT_ASSERT_EQUAL (
+        (UINTN) LibraryScanMem (Buffer, Size, Value, ValueSize),
+        (UINTN) ReferenceScanMem (Buffer, Size, Value, ValueSize)
+        );
+
+      Result = NULL;
+      Start  = AsmReadTsc ();
+      for (Iteration = 0; Iteration < BENCHMARK_ITERATIONS; Iteration++) {
+        Result = LibraryScanMem (Buffer, Size, Value, ValueSize);
+      }
+      LibraryTicks = AsmReadTsc () - Start;
+      UT_ASSERT_NOT_NULL ((VOID *) Result);
+
+      Result = NULL;
+      Start  = AsmReadTsc ();
+      for (Iteration = 0; Iteration < BENCHMARK_ITERATIONS; Iteration++) {
+        Result = ReferenceScanMem (Buffer, Size, Value, ValueSize);
+      }
+      ReferenceTicks = AsmReadTsc () - Start;
+      UT_ASSERT_NOT_NULL ((VOID *) Result);
+
+      ZeroMem (Buffer + Size - ValueSize, ValueSize);
+      UT_LOG_INFO (
+        "ScanMem%-2d %6d bytes: %8ld ticks, reference %8ld ticks\n",
+        (UINT32) (ValueSize * 8),
+        (UINT32) Size,
+        DivU64x32 (LibraryTicks, BENCHMARK_ITERATIONS),
+        DivU64x32 (ReferenceTicks, BENCHMARK_ITERATIONS)
+        );
+    }
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Checks CompareGuid() and ScanGuid() against the reference implementation
+  and logs the time both of them take to find a GUID at the end of a buffer
+  of GUIDs.
+
+  @param  Context  The test buffer.
+
+  @retval UNIT_TEST_PASSED              All checks passed.
+  @retval UNIT_TEST_ERROR_TEST_FAILED   A result differs from the reference.
+
+**/
+UNIT_TEST_STATUS
+EFIAPI
+ScanGuidBenchmark (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINT8       *Buffer;
+  EFI_GUID    Guid;
+  UINTN       SizeIndex;
+  UINTN       Size;
+  UINTN       Index;
+  UINTN       Iteration;
+  UINT64      Start;
+  UINT64      LibraryTicks;
+  UINT64      ReferenceTicks;
+  CONST VOID  *Result;
+
+  Buffer = *(UINT8 **) Context;
+
+  CopyGuid (&Guid, &mTargetGuid);
+  UT_ASSERT_TRUE (CompareGuid (&Guid, &mTargetGuid));
+  for (Index = 0; Index < sizeof (EFI_GUID); Index++) {
+    ((UINT8 *) &Guid)[Index] ^= 1;
+    UT_ASSERT_FALSE (CompareGuid (&Guid, &mTargetGuid));
+    ((UINT8 *) &Guid)[Index] ^= 1;
+  }
+
+  for (SizeIndex = 0; SizeIndex < ARRAY_SIZE (mBenchmarkSizes); SizeIndex++) {
+    Size = mBenchmarkSizes[SizeIndex] & ~(sizeof (EFI_GUID) - 1);
+    if (Size == 0) {
+      continue;
+    }
+
+    UT_ASSERT_EQUAL ((UINTN) ScanGuid (Buffer, Size, &mTargetGuid), (UINTN) NULL);
+    CopyGuid ((EFI_GUID *) (Buffer + Size - sizeof (EFI_GUID)), &mTargetGuid);
+    UT_ASSERT_EQUAL (
+      (UINTN) ScanGuid (Buffer, Size, &mTargetGuid),
+      (UINTN) ReferenceScanGuid (Buffer, Size, &mTargetGuid)
+      );
+
+    Result = NULL;
+    Start  = AsmReadTsc ();
+    for (Iteration = 0; Iteration < BENCHMARK_ITERATIONS; Iteration++) {
+      Result = ScanGuid (Buffer, Size, &mTargetGuid);
+    }
+    LibraryTicks = AsmReadTsc () - Start;
+    UT_ASSERT_NOT_NULL ((VOID *) Result);
+
+    Result = NULL;
+    Start  = AsmReadTsc ();
+    for (Iteration = 0; Iteration < BENCHMARK_ITERATIONS; Iteration++) {
+      Result = ReferenceScanGuid (Buffer, Size, &mTargetGuid);
+    }
+    ReferenceTicks = AsmReadTsc () - Start;
+    UT_ASSERT_NOT_NULL ((VOID *) Result);
+
+    ZeroMem (Buffer + Size - sizeof (EFI_GUID), sizeof (EFI_GUID));
+    UT_LOG_INFO (
+      "ScanGuid %6d bytes: %8ld ticks, reference %8ld ticks\n",
+      (UINT32) Size,
+      DivU64x32 (LibraryTicks, BENCHMARK_ITERATIONS),
+      DivU64x32 (ReferenceTicks, BENCHMARK_ITERATIONS)
+      );
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Initialize the unit test framework, suite, and unit tests for the
+  BaseMemoryLib benchmarks and run the unit tests.
+
+  @retval  EFI_SUCCESS           All test cases were dispatched.
+  @retval  EFI_OUT_OF_RESOURCES  There are not enough resources available to
+                                 initialize the unit tests.
+**/
+EFI_STATUS
+EFIAPI
+UnitTestingEntry (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Fw;
+  UNIT_TEST_SUITE_HANDLE      BenchmarkTests;
+
+  Fw = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_APP_NAME, UNIT_TEST_APP_VERSION));
+
+  //
+  // Start setting up the test framework for running the tests.
+  //
+  Status = InitUnitTestFramework (&Fw, UNIT_TEST_APP_NAME, gEfiCallerBaseName, UNIT_TEST_APP_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  //
+  // Populate the benchmark Unit Test Suite.
+  //
+  Status = CreateUnitTestSuite (&BenchmarkTests, Fw, "BaseMemoryLib scan and compare benchmarks", "BaseMemoryLib.Benchmark", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for BenchmarkTests\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  // --------------Suite-----------Description--------------Class Name----------Function--------Pre---Post-------------------Context-----------
+  AddTestCase (BenchmarkTests, "IsZeroBuffer", "IsZeroBuffer", IsZeroBufferBenchmark, AllocateBenchmarkBuffer, FreeBenchmarkBuffer, &mBenchmarkBuffer);
+  AddTestCase (BenchmarkTests, "ScanMem8/16/32/64", "ScanMem", ScanMemBenchmark, AllocateBenchmarkBuffer, FreeBenchmarkBuffer, &mBenchmarkBuffer);
+  AddTestCase (BenchmarkTests, "CompareGuid and ScanGuid", "ScanGuid", ScanGuidBenchmark, AllocateBenchmarkBuffer, FreeBenchmarkBuffer, &mBenchmarkBuffer);
+
+  //
+  // Execute the tests.
+  //
+  Status = RunAllTestSuites (Fw);
+
+EXIT:
+  if (Fw) {
+    FreeUnitTestFramework (Fw);
+  }
+
+  return Status;
+}
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+**/
+int
+main (
+  int argc,
+  char *argv[]
+  )
+{
+  return UnitTestingEntry ();
+}
@@ -114,6 +114,7 @@ struct _DHCP_SERVICE {
   DHCP_PROTOCOL                 *ActiveChild;
   EFI_DHCP4_CONFIG_DATA         ActiveConfig;
   UINT32                        UserOptionLen;
+  BOOLEAN                       RapidCommit;  // The user offers DHCP4_TAG_RAPID_COMMIT
 
   //
   // Timer event and various timer
@@ -595,6 +595,63 @@ DhcpEndSession (
 }
 
 
+/**
+  Accept a DHCP ACK received in select state in reply to a discover
+  with the Rapid Commit option, RFC 4039. The ACK is used as the
+  selected packet, and the lease is recorded without sending a request.
+
+  @param[in]  DhcpSb                The DHCP service instance
+  @param[in]  Packet                The DHCP ACK received, with the Rapid
+                                    Commit option.
+
+  @retval EFI_SUCCESS           The ACK is accepted, or ignored on the user's
+                                request.
+  @retval Others                Some error occurred.
+
+**/
+EFI_STATUS
+DhcpHandleRapidCommit (
+  IN DHCP_SERVICE           *DhcpSb,
+  IN EFI_DHCP4_PACKET       *Packet
+  )
+{
+  EFI_STATUS                Status;
+
+  //
+  // If the user denies the lease, keep waiting for offers from servers
+  // that don't do Rapid Commit, unless the user aborts.
+  //
+  Status = DhcpCallUser (DhcpSb, Dhcp4RcvdAck, Packet, NULL);
+
+  if (EFI_ERROR (Status)) {
+    FreePool (Packet);
+    return (Status == EFI_ABORTED) ? Status : EFI_SUCCESS;
+  }
+
+  if (DhcpSb->LastOffer != NULL) {
+    FreePool (DhcpSb->LastOffer);
+    DhcpSb->LastOffer = NULL;
+  }
+
+  DhcpSb->Selected  = Packet;
+  DhcpSb->Para      = NULL;
+  DhcpValidateOptions (Packet, &DhcpSb->Para);
+
+  //
+  // Record the lease, transit to BOUND state, then notify the user
+  //
+  Status = DhcpLeaseAcquired (DhcpSb);
+
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  DhcpSb->IoStatus = EFI_SUCCESS;
+  DhcpNotifyUser (DhcpSb, DHCP_NOTIFY_COMPLETION);
+  return EFI_SUCCESS;
+}
+
+
 /**
   Handle packets in DHCP select state.
 
@@ -618,6 +675,17 @@ DhcpHandleSelect (
 
   Status = EFI_SUCCESS;
 
+  //
+  // If the user asked for Rapid Commit, a server may answer the discover
+  // with an ACK carrying the Rapid Commit option. The lease is committed
+  // by the server already, so skip the offer/request round trip.
+  //
+  if (DhcpSb->RapidCommit && !DHCP_IS_BOOTP (Para) &&
+      (Para->DhcpType == DHCP_MSG_ACK) && Para->RapidCommit && (Para->ServerId != 0)
+      ) {
+    return DhcpHandleRapidCommit (DhcpSb, Packet);
+  }
+
   //
   // First validate the message:
   // 1. the offer is a unicast
@@ -1289,6 +1357,14 @@ DhcpSendMessage (
         continue;
       }
 
+      //
+      // Rapid Commit is only meaningful in a DHCP discover, RFC 4039.
+      //
+      if ((Type != DHCP_MSG_DISCOVER) &&
+          (Config->OptionList[Index]->OpCode == DHCP4_TAG_RAPID_COMMIT)) {
+        continue;
+      }
+
       Buf = DhcpAppendOption (
               Buf,
               Config->OptionList[Index]->OpCode,
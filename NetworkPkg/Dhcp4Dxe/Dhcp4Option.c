@@ -97,6 +97,7 @@ DHCP_OPTION_FORMAT DhcpOptionFormats[] = {
   {DHCP4_TAG_IRC,            DHCP_OPTION_IP,     1, -1 , FALSE},
   {DHCP4_TAG_STTALK,         DHCP_OPTION_IP,     1, -1 , FALSE},
   {DHCP4_TAG_STDA,           DHCP_OPTION_IP,     1, -1 , FALSE},
+  {DHCP4_TAG_RAPID_COMMIT,   DHCP_OPTION_INT8,   0, 0  , TRUE},
 
   {DHCP4_TAG_CLASSLESS_ROUTE,DHCP_OPTION_INT8,   5, -1 , FALSE},
 };
@@ -284,6 +285,10 @@ DhcpGetParameter (
   case DHCP4_TAG_T2:
     Para->T2 = NetGetUint32 (Data);
     break;
+
+  case DHCP4_TAG_RAPID_COMMIT:
+    Para->RapidCommit = TRUE;
+    break;
   }
 
   return EFI_SUCCESS;
@@ -720,7 +725,9 @@ ON_EXIT:
 
 /**
   Append an option to the memory, if the option is longer than
-  255 bytes, splits it into several options.
+  255 bytes, splits it into several options. An option without
+  data, such as DHCP4_TAG_RAPID_COMMIT, is appended as the tag
+  followed by a zero length.
 
   @param[out] Buf                    The buffer to append the option to
   @param[in]  Tag                    The option's tag
@@ -741,7 +748,11 @@ DhcpAppendOption (
   INTN                      Index;
   INTN                      Len;
 
-  ASSERT (DataLen != 0);
+  if (DataLen == 0) {
+    *(Buf++) = Tag;
+    *(Buf++) = 0;
+    return Buf;
+  }
 
   for (Index = 0; Index < (DataLen + 254) / 255; Index++) {
     Len      = MIN (255, DataLen - Index * 255);
@@ -76,6 +76,7 @@ typedef struct {
   UINT32                    Lease;    // DHCP4_TAG_LEASE
   UINT32                    T1;       // DHCP4_TAG_T1
   UINT32                    T2;       // DHCP4_TAG_T2
+  BOOLEAN                   RapidCommit; // DHCP4_TAG_RAPID_COMMIT
 } DHCP_PARAMETER;
 
 ///
@@ -28,25 +28,87 @@ EFI_DPC_PROTOCOL mDpc = {
 };
 
 //
-// Global variables used to measure the DPC Queue Depths
+// Global variables used to measure the DPC Queue Depths.  mDpcQueueDepth is
+// also read without raising the TPL to skip dispatching when nothing is queued.
 //
-UINTN  mDpcQueueDepth = 0;
-UINTN  mMaxDpcQueueDepth = 0;
+volatile UINTN  mDpcQueueDepth = 0;
+UINTN           mMaxDpcQueueDepth = 0;
 
 //
-// Free list of DPC entries.  As DPCs are queued, entries are removed from this
-// free list.  As DPC entries are dispatched, DPC entries are added to the free list.
-// If the free list is empty and a DPC is queued, the free list is grown by allocating
-// an additional set of DPC entries.
+// An array of DPC queues.  A DPC queue is a ring buffer for every level EFI_TPL
+// value.  As DPCs are queued, they are added at the tail of the ring buffer.
+// As DPCs are dispatched, they are removed from the head of the ring buffer.
+// If a ring buffer is full when a DPC is queued, it is grown by allocating
+// a ring buffer twice as large.
 //
-LIST_ENTRY      mDpcEntryFreeList = INITIALIZE_LIST_HEAD_VARIABLE(mDpcEntryFreeList);
+DPC_QUEUE       mDpcQueue[TPL_HIGH_LEVEL + 1];
 
-//
-// An array of DPC queues.  A DPC queue is allocated for every level EFI_TPL value.
-// As DPCs are queued, they are added to the end of the linked list.
-// As DPCs are dispatched, they are removed from the beginning of the linked list.
-//
-LIST_ENTRY      mDpcQueue[TPL_HIGH_LEVEL + 1];
+/**
+  Grow the ring buffer of a DPC queue.
+
+  The caller must be running at TPL_NOTIFY or below, so that memory can be
+  allocated.
+
+  @param  Queue  The DPC queue to grow.
+
+  @retval EFI_SUCCESS           The DPC queue has more room.
+  @retval EFI_OUT_OF_RESOURCES  There are not enough resources available to
+                                grow the DPC queue.
+
+**/
+EFI_STATUS
+DpcGrowQueue (
+  IN DPC_QUEUE  *Queue
+  )
+{
+  EFI_TPL    OriginalTpl;
+  DPC_ENTRY  *Entries;
+  DPC_ENTRY  *OldEntries;
+  UINTN      Size;
+  UINTN      Index;
+
+  Size = (Queue->Size == 0) ? DPC_QUEUE_INITIAL_SIZE : Queue->Size * 2;
+
+  Entries = AllocatePool (Size * sizeof (DPC_ENTRY));
+  if (Entries == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  //
+  // Raise the TPL level to TPL_HIGH_LEVEL for DPC queue operations
+  //
+  OriginalTpl = gBS->RaiseTPL (TPL_HIGH_LEVEL);
+
+  //
+  // The queue may have been grown while the TPL was lowered for the allocation
+  //
+  if (Size <= Queue->Size) {
+    gBS->RestoreTPL (OriginalTpl);
+    FreePool (Entries);
+    return EFI_SUCCESS;
+  }
+
+  //
+  // Move the queued DPCs in order to the start of the new ring buffer
+  //
+  for (Index = 0; Queue->Head + Index != Queue->Tail; Index++) {
+    Entries[Index] = Queue->Entries[(Queue->Head + Index) & (Queue->Size - 1)];
+  }
+
+  OldEntries     = Queue->Entries;
+  Queue->Entries = Entries;
+  Queue->Size    = Size;
+  Queue->Head    = 0;
+  Queue->Tail    = Index;
+
+  gBS->RestoreTPL (OriginalTpl);
+
+  if (OldEntries != NULL) {
+    FreePool (OldEntries);
+  }
+
+  return EFI_SUCCESS;
+}
 
 /**
   Add a Deferred Procedure Call to the end of the DPC queue.
@@ -75,8 +137,8 @@ DpcQueueDpc (
 {
   EFI_STATUS  ReturnStatus;
   EFI_TPL     OriginalTpl;
+  DPC_QUEUE   *Queue;
   DPC_ENTRY   *DpcEntry;
-  UINTN       Index;
 
   //
   // Make sure DpcTpl is valid
@@ -96,20 +158,21 @@ DpcQueueDpc (
   // Assume this function will succeed
   //
   ReturnStatus = EFI_SUCCESS;
+  Queue        = &mDpcQueue[DpcTpl];
 
   //
-  // Raise the TPL level to TPL_HIGH_LEVEL for DPC list operation and save the
+  // Raise the TPL level to TPL_HIGH_LEVEL for DPC queue operation and save the
   // current TPL value so it can be restored when this function returns.
   //
   OriginalTpl = gBS->RaiseTPL (TPL_HIGH_LEVEL);
 
   //
-  // Check to see if there are any entries in the DPC free list
+  // Check to see if there is room left in the DPC queue
   //
-  if (IsListEmpty (&mDpcEntryFreeList)) {
+  while (Queue->Tail - Queue->Head == Queue->Size) {
     //
     // If the current TPL is greater than TPL_NOTIFY, then memory allocations
-    // can not be performed, so the free list can not be expanded.  In this case
+    // can not be performed, so the DPC queue can not be grown.  In this case
     // return EFI_OUT_OF_RESOURCES.
     //
     if (OriginalTpl > TPL_NOTIFY) {
@@ -118,62 +181,30 @@ DpcQueueDpc (
     }
 
     //
-    // Add 64 DPC entries to the free list
+    // Lower the TPL level to perform a memory allocation
     //
-    for (Index = 0; Index < 64; Index++) {
-      //
-      // Lower the TPL level to perform a memory allocation
-      //
-      gBS->RestoreTPL (OriginalTpl);
+    gBS->RestoreTPL (OriginalTpl);
 
-      //
-      // Allocate a new DPC entry
-      //
-      DpcEntry = AllocatePool (sizeof (DPC_ENTRY));
-
-      //
-      // Raise the TPL level back to TPL_HIGH_LEVEL for DPC list operations
-      //
-      gBS->RaiseTPL (TPL_HIGH_LEVEL);
+    ReturnStatus = DpcGrowQueue (Queue);
 
-      //
-      // If the allocation of a DPC entry fails, and the free list is empty,
-      // then return EFI_OUT_OF_RESOURCES.
-      //
-      if (DpcEntry == NULL) {
-        if (IsListEmpty (&mDpcEntryFreeList)) {
-          ReturnStatus = EFI_OUT_OF_RESOURCES;
-          goto Done;
-        }
-      }
+    //
+    // Raise the TPL level back to TPL_HIGH_LEVEL for DPC queue operations
+    //
+    gBS->RaiseTPL (TPL_HIGH_LEVEL);
 
-      //
-      // Add the newly allocated DPC entry to the DPC free list
-      //
-      InsertTailList (&mDpcEntryFreeList, &DpcEntry->ListEntry);
+    if (EFI_ERROR (ReturnStatus)) {
+      goto Done;
     }
   }
 
   //
-  // Retrieve the first node from the free list of DPCs
-  //
-  DpcEntry = (DPC_ENTRY *)(GetFirstNode (&mDpcEntryFreeList));
-
-  //
-  // Remove the first node from the free list of DPCs
-  //
-  RemoveEntryList (&DpcEntry->ListEntry);
-
-  //
-  // Fill in the DPC entry with the DpcProcedure and DpcContext
+  // Fill in the DPC entry at the tail of the queue for the specified DpcTpl
+  // with the DpcProcedure and DpcContext
   //
+  DpcEntry               = &Queue->Entries[Queue->Tail & (Queue->Size - 1)];
   DpcEntry->DpcProcedure = DpcProcedure;
   DpcEntry->DpcContext   = DpcContext;
-
-  //
-  // Add the DPC entry to the end of the list for the specified DplTpl.
-  //
-  InsertTailList (&mDpcQueue[DpcTpl], &DpcEntry->ListEntry);
+  Queue->Tail++;
 
   //
   // Increment the measured DPC queue depth across all TPLs
@@ -217,7 +248,18 @@ DpcDispatchDpc (
   EFI_STATUS  ReturnStatus;
   EFI_TPL     OriginalTpl;
   EFI_TPL     Tpl;
-  DPC_ENTRY   *DpcEntry;
+  DPC_QUEUE   *Queue;
+  DPC_ENTRY   DpcEntry;
+
+  //
+  // Drivers poll this function far more often than DPCs are queued.  With no
+  // DPC queued at all, return without raising the TPL; a DPC queued right
+  // after the check is left for the next dispatch, as it would be if it had
+  // been queued right after this function returned.
+  //
+  if (mDpcQueueDepth == 0) {
+    return EFI_NOT_FOUND;
+  }
 
   //
   // Assume that no DPCs will be invoked
@@ -225,63 +267,52 @@ DpcDispatchDpc (
   ReturnStatus = EFI_NOT_FOUND;
 
   //
-  // Raise the TPL level to TPL_HIGH_LEVEL for DPC list operation and save the
+  // Raise the TPL level to TPL_HIGH_LEVEL for DPC queue operation and save the
   // current TPL value so it can be restored when this function returns.
   //
   OriginalTpl = gBS->RaiseTPL (TPL_HIGH_LEVEL);
 
   //
-  // Check to see if there are 1 or more DPCs currently queued
+  // Loop from TPL_HIGH_LEVEL down to the current TPL value
   //
-  if (mDpcQueueDepth > 0) {
+  for (Tpl = TPL_HIGH_LEVEL; Tpl >= OriginalTpl; Tpl--) {
+    Queue = &mDpcQueue[Tpl];
+
     //
-    // Loop from TPL_HIGH_LEVEL down to the current TPL value
+    // Check to see if the DPC queue is empty
     //
-    for (Tpl = TPL_HIGH_LEVEL; Tpl >= OriginalTpl; Tpl--) {
+    while (Queue->Head != Queue->Tail) {
+      //
+      // Take a copy of the DPC entry at the head of the DPC queue specified by
+      // Tpl, so that its slot can be reused as soon as it is removed
+      //
+      DpcEntry = Queue->Entries[Queue->Head & (Queue->Size - 1)];
+      Queue->Head++;
+
+      //
+      // Decrement the measured DPC Queue Depth across all TPLs
+      //
+      mDpcQueueDepth--;
+
+      //
+      // Lower the TPL to TPL value of the current DPC queue
       //
-      // Check to see if the DPC queue is empty
+      gBS->RestoreTPL (Tpl);
+
+      //
+      // Invoke the DPC passing in its context
+      //
+      (DpcEntry.DpcProcedure) (DpcEntry.DpcContext);
+
+      //
+      // At least one DPC has been invoked, so set the return status to EFI_SUCCESS
       //
-      while (!IsListEmpty (&mDpcQueue[Tpl])) {
-        //
-        // Retrieve the first DPC entry from the DPC queue specified by Tpl
-        //
-        DpcEntry = (DPC_ENTRY *)(GetFirstNode (&mDpcQueue[Tpl]));
-
-        //
-        // Remove the first DPC entry from the DPC queue specified by Tpl
-        //
-        RemoveEntryList (&DpcEntry->ListEntry);
-
-        //
-        // Decrement the measured DPC Queue Depth across all TPLs
-        //
-        mDpcQueueDepth--;
-
-        //
-        // Lower the TPL to TPL value of the current DPC queue
-        //
-        gBS->RestoreTPL (Tpl);
-
-        //
-        // Invoke the DPC passing in its context
-        //
-        (DpcEntry->DpcProcedure) (DpcEntry->DpcContext);
-
-        //
-        // At least one DPC has been invoked, so set the return status to EFI_SUCCESS
-        //
-        ReturnStatus = EFI_SUCCESS;
-
-        //
-        // Raise the TPL level back to TPL_HIGH_LEVEL for DPC list operations
-        //
-        gBS->RaiseTPL (TPL_HIGH_LEVEL);
-
-        //
-        // Add the invoked DPC entry to the DPC free list
-        //
-        InsertTailList (&mDpcEntryFreeList, &DpcEntry->ListEntry);
-      }
+      ReturnStatus = EFI_SUCCESS;
+
+      //
+      // Raise the TPL level back to TPL_HIGH_LEVEL for DPC queue operations
+      //
+      gBS->RaiseTPL (TPL_HIGH_LEVEL);
     }
   }
 
@@ -312,7 +343,6 @@ DpcDriverEntryPoint (
   )
 {
   EFI_STATUS  Status;
-  UINTN       Index;
 
   //
   // ASSERT() if the EFI_DPC_PROTOCOL is already present in the handle database
@@ -320,11 +350,13 @@ DpcDriverEntryPoint (
   ASSERT_PROTOCOL_ALREADY_INSTALLED (NULL, &gEfiDpcProtocolGuid);
 
   //
-  // Initialize the DPC queue for all possible TPL values
+  // Pre-allocate the DPC queues for the TPL values network drivers use, so the
+  // receive and transmit paths never allocate.  The DPC queues of the other
+  // TPL values are allocated when the first DPC is queued, and a failure here
+  // only defers the allocation in the same way.
   //
-  for (Index = 0; Index <= TPL_HIGH_LEVEL; Index++) {
-    InitializeListHead (&mDpcQueue[Index]);
-  }
+  DpcGrowQueue (&mDpcQueue[TPL_CALLBACK]);
+  DpcGrowQueue (&mDpcQueue[TPL_NOTIFY]);
 
   //
   // Install the EFI_DPC_PROTOCOL instance onto a new handle
@@ -24,15 +24,32 @@ Abstract:
 #include <Protocol/Dpc.h>
 
 //
-// Internal data structure for managing DPCs.  A DPC entry is either on the free
-// list or on a DPC queue at a specific EFI_TPL.
+// Number of entries pre-allocated for the DPC queues of the TPLs that network
+// drivers use.  Must be a power of 2.
+//
+#define DPC_QUEUE_INITIAL_SIZE  64
+
+//
+// Internal data structure for a queued DPC.  Entries are stored by value in the
+// ring buffer of the DPC queue at a specific EFI_TPL.
 //
 typedef struct {
-  LIST_ENTRY             ListEntry;
   EFI_DPC_PROCEDURE  DpcProcedure;
   VOID               *DpcContext;
 } DPC_ENTRY;
 
+//
+// Ring buffer of DPC entries for one EFI_TPL.  Head and Tail are free running
+// counters, Tail - Head is the number of queued DPCs, and Size is a power of 2
+// so that the counters are reduced to indexes with a mask.
+//
+typedef struct {
+  DPC_ENTRY          *Entries;
+  UINTN              Size;
+  UINTN              Head;
+  UINTN              Tail;
+} DPC_QUEUE;
+
 /**
   Add a Deferred Procedure Call to the end of the DPC queue.
 
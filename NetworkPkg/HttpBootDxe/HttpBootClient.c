@@ -580,21 +580,24 @@ HttpBootHttpIoCallback (
 }
 
 /**
-  Create a HttpIo instance for the file download.
+  Create and configure a HttpIo instance on the boot NIC.
 
   @param[in]    Private        The pointer to the driver's private data.
+  @param[in]    Callback       The HttpIo callback, or NULL.
+  @param[out]   HttpIo         The HttpIo instance to initialize.
 
   @retval EFI_SUCCESS          Successfully created.
   @retval Others               Failed to create HttpIo.
 
 **/
 EFI_STATUS
-HttpBootCreateHttpIo (
-  IN     HTTP_BOOT_PRIVATE_DATA       *Private
+HttpBootOpenHttpIo (
+  IN     HTTP_BOOT_PRIVATE_DATA       *Private,
+  IN     HTTP_IO_CALLBACK             Callback,
+     OUT HTTP_IO                      *HttpIo
   )
 {
   HTTP_IO_CONFIG_DATA          ConfigData;
-  EFI_STATUS                   Status;
   EFI_HANDLE                   ImageHandle;
 
   ASSERT (Private != NULL);
@@ -613,15 +616,36 @@ HttpBootCreateHttpIo (
     ImageHandle = Private->Ip6Nic->ImageHandle;
   }
 
-  Status = HttpIoCreateIo (
-             ImageHandle,
-             Private->Controller,
-             Private->UsingIpv6 ? IP_VERSION_6 : IP_VERSION_4,
-             &ConfigData,
-             HttpBootHttpIoCallback,
-             (VOID *) Private,
-             &Private->HttpIo
-             );
+  return HttpIoCreateIo (
+           ImageHandle,
+           Private->Controller,
+           Private->UsingIpv6 ? IP_VERSION_6 : IP_VERSION_4,
+           &ConfigData,
+           Callback,
+           (VOID *) Private,
+           HttpIo
+           );
+}
+
+/**
+  Create a HttpIo instance for the file download.
+
+  @param[in]    Private        The pointer to the driver's private data.
+
+  @retval EFI_SUCCESS          Successfully created.
+  @retval Others               Failed to create HttpIo.
+
+**/
+EFI_STATUS
+HttpBootCreateHttpIo (
+  IN     HTTP_BOOT_PRIVATE_DATA       *Private
+  )
+{
+  EFI_STATUS                   Status;
+
+  ASSERT (Private != NULL);
+
+  Status = HttpBootOpenHttpIo (Private, HttpBootHttpIoCallback, &Private->HttpIo);
   if (EFI_ERROR (Status)) {
     return Status;
   }
@@ -870,6 +894,522 @@ HttpBootGetBootFileCallback (
   return EFI_SUCCESS;
 }
 
+/**
+  Check whether the server accepts byte ranges for the requested resource.
+
+  @param[in]    HeaderCount        Number of HTTP header structures in Headers.
+  @param[in]    Headers            Array containing list of HTTP headers.
+
+  @retval TRUE                     The server sent "Accept-Ranges: bytes".
+  @retval FALSE                    Byte ranges are not supported.
+
+**/
+BOOLEAN
+HttpBootIsRangeSupported (
+  IN UINTN                     HeaderCount,
+  IN EFI_HTTP_HEADER           *Headers
+  )
+{
+  EFI_HTTP_HEADER              *Header;
+
+  Header = HttpFindHeader (HeaderCount, Headers, HTTP_HEADER_ACCEPT_RANGES);
+  if ((Header == NULL) || (Header->FieldValue == NULL)) {
+    return FALSE;
+  }
+
+  return (BOOLEAN) (AsciiStriCmp (Header->FieldValue, "bytes") == 0);
+}
+
+/**
+  Queue a response token on a ranged download connection and start its
+  timeout timer.
+
+  @param[in]    Worker             The connection.
+  @param[in]    Body               Where to receive the message body, or NULL to
+                                   receive the response header.
+  @param[in]    BodyLength         Length in bytes of Body.
+
+  @retval EFI_SUCCESS              The token is queued.
+  @retval Others                   Failed to queue the token.
+
+**/
+EFI_STATUS
+HttpBootRangeQueueResponse (
+  IN HTTP_BOOT_RANGE_WORKER    *Worker,
+  IN UINT8                     *Body,
+  IN UINTN                     BodyLength
+  )
+{
+  HTTP_IO                      *HttpIo;
+  EFI_STATUS                   Status;
+
+  HttpIo = &Worker->HttpIo;
+
+  HttpIo->RspToken.Status                 = EFI_NOT_READY;
+  HttpIo->RspToken.Message->Data.Response = (Body == NULL) ? &Worker->Response : NULL;
+  HttpIo->RspToken.Message->HeaderCount   = 0;
+  HttpIo->RspToken.Message->Headers       = NULL;
+  HttpIo->RspToken.Message->BodyLength    = BodyLength;
+  HttpIo->RspToken.Message->Body          = Body;
+  HttpIo->IsRxDone                        = FALSE;
+
+  Status = gBS->SetTimer (HttpIo->TimeoutEvent, TimerRelative, HttpIo->Timeout * TICKS_PER_MS);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Status = HttpIo->Http->Response (HttpIo->Http, &HttpIo->RspToken);
+  if (EFI_ERROR (Status)) {
+    gBS->SetTimer (HttpIo->TimeoutEvent, TimerCancel, 0);
+  }
+
+  return Status;
+}
+
+/**
+  Assign a range to an idle connection and send the range request.
+
+  @param[in]    Worker             The idle connection.
+  @param[in]    Chunk              The range to download.
+  @param[in]    HostName           The value of the Host header.
+  @param[in]    Url                The URL of the boot file.
+
+  @retval EFI_SUCCESS              The request is queued.
+  @retval Others                   Failed to queue the request.
+
+**/
+EFI_STATUS
+HttpBootRangeSendRequest (
+  IN HTTP_BOOT_RANGE_WORKER    *Worker,
+  IN HTTP_BOOT_RANGE_CHUNK     *Chunk,
+  IN CHAR8                     *HostName,
+  IN CHAR16                    *Url
+  )
+{
+  HTTP_IO                      *HttpIo;
+  EFI_STATUS                   Status;
+  CHAR8                        Range[48];
+
+  HttpIo           = &Worker->HttpIo;
+  Worker->Chunk    = Chunk;
+  Worker->Received = 0;
+  Chunk->Busy      = TRUE;
+
+  if (Worker->Header != NULL) {
+    HttpIoFreeHeader (Worker->Header);
+  }
+
+  Worker->Header = HttpIoCreateHeader (4);
+  if (Worker->Header == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  AsciiSPrint (
+    Range,
+    sizeof (Range),
+    "bytes=%Lu-%Lu",
+    (UINT64) Chunk->Offset,
+    (UINT64) (Chunk->Offset + Chunk->Length - 1)
+    );
+
+  Status = HttpIoSetHeader (Worker->Header, HTTP_HEADER_HOST, HostName);
+  if (!EFI_ERROR (Status)) {
+    Status = HttpIoSetHeader (Worker->Header, HTTP_HEADER_ACCEPT, "*/*");
+  }
+  if (!EFI_ERROR (Status)) {
+    Status = HttpIoSetHeader (Worker->Header, HTTP_HEADER_USER_AGENT, HTTP_USER_AGENT_EFI_HTTP_BOOT);
+  }
+  if (!EFI_ERROR (Status)) {
+    Status = HttpIoSetHeader (Worker->Header, HTTP_HEADER_RANGE, Range);
+  }
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Worker->RequestData.Method = HttpMethodGet;
+  Worker->RequestData.Url    = Url;
+
+  HttpIo->ReqToken.Status                = EFI_NOT_READY;
+  HttpIo->ReqToken.Message->Data.Request = &Worker->RequestData;
+  HttpIo->ReqToken.Message->HeaderCount  = Worker->Header->HeaderCount;
+  HttpIo->ReqToken.Message->Headers      = Worker->Header->Headers;
+  HttpIo->ReqToken.Message->BodyLength   = 0;
+  HttpIo->ReqToken.Message->Body         = NULL;
+  HttpIo->IsTxDone                       = FALSE;
+
+  //
+  // The connection to the server is set up by the first request, so the
+  // request is bounded by the timer as well.
+  //
+  Status = gBS->SetTimer (HttpIo->TimeoutEvent, TimerRelative, HttpIo->Timeout * TICKS_PER_MS);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Status = HttpIo->Http->Request (HttpIo->Http, &HttpIo->ReqToken);
+  if (EFI_ERROR (Status)) {
+    gBS->SetTimer (HttpIo->TimeoutEvent, TimerCancel, 0);
+    return Status;
+  }
+
+  Worker->State = HttpBootRangeSend;
+  return EFI_SUCCESS;
+}
+
+/**
+  Tear down the HTTP instance of a ranged download connection.
+
+  @param[in]    Worker             The connection.
+
+**/
+VOID
+HttpBootRangeCloseWorker (
+  IN HTTP_BOOT_RANGE_WORKER    *Worker
+  )
+{
+  if (Worker->HttpCreated) {
+    //
+    // Flush the token notifications before the HTTP instance and its
+    // events go away.
+    //
+    gBS->SetTimer (Worker->HttpIo.TimeoutEvent, TimerCancel, 0);
+    Worker->HttpIo.Http->Cancel (Worker->HttpIo.Http, NULL);
+    DispatchDpc ();
+    HttpIoDestroyIo (&Worker->HttpIo);
+    Worker->HttpCreated = FALSE;
+  }
+
+  if (Worker->Header != NULL) {
+    HttpIoFreeHeader (Worker->Header);
+    Worker->Header = NULL;
+  }
+}
+
+/**
+  Handle a failure on a ranged download connection. The range goes back to
+  the queue unless it ran out of retries, and the connection is recreated
+  since its HTTP state is unknown.
+
+  @param[in]    Private            The pointer to the driver's private data.
+  @param[in]    Worker             The failed connection.
+  @param[in]    Failure            The error that occurred.
+
+  @retval EFI_SUCCESS              The range will be retried.
+  @retval Others                   The range failed too often, the download
+                                   should be aborted.
+
+**/
+EFI_STATUS
+HttpBootRangeFail (
+  IN HTTP_BOOT_PRIVATE_DATA    *Private,
+  IN HTTP_BOOT_RANGE_WORKER    *Worker,
+  IN EFI_STATUS                Failure
+  )
+{
+  HTTP_BOOT_RANGE_CHUNK        *Chunk;
+  EFI_STATUS                   Status;
+
+  Chunk = Worker->Chunk;
+  DEBUG ((
+    DEBUG_WARN,
+    "HttpBootRangeFail: range at 0x%lx failed - %r\n",
+    (UINT64) ((Chunk != NULL) ? Chunk->Offset : 0),
+    Failure
+    ));
+
+  HttpBootRangeCloseWorker (Worker);
+  Worker->State = HttpBootRangeDead;
+  Worker->Chunk = NULL;
+
+  if (Chunk != NULL) {
+    Chunk->Busy = FALSE;
+    Chunk->Retries++;
+    if (Chunk->Retries > HTTP_BOOT_RANGE_MAX_RETRY) {
+      return Failure;
+    }
+  }
+
+  Status = HttpBootOpenHttpIo (Private, NULL, &Worker->HttpIo);
+  if (!EFI_ERROR (Status)) {
+    Worker->HttpCreated = TRUE;
+    Worker->State       = HttpBootRangeIdle;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Advance the state of a ranged download connection.
+
+  @param[in]    Private            The pointer to the driver's private data.
+  @param[in]    Worker             The connection.
+  @param[in]    Buffer             The buffer the boot file is downloaded to.
+  @param[out]   ImageType          The image type of the downloaded file.
+
+  @retval EFI_SUCCESS              The connection progressed normally or is waiting.
+  @retval EFI_UNSUPPORTED          The server ignored the range request.
+  @retval EFI_DEVICE_ERROR         The connection failed.
+  @retval EFI_TIMEOUT              The server didn't answer in time.
+  @retval Others                   Other errors as indicated.
+
+**/
+EFI_STATUS
+HttpBootRangeProcess (
+  IN     HTTP_BOOT_PRIVATE_DATA    *Private,
+  IN     HTTP_BOOT_RANGE_WORKER    *Worker,
+  IN     UINT8                     *Buffer,
+     OUT HTTP_BOOT_IMAGE_TYPE      *ImageType
+  )
+{
+  HTTP_IO                      *HttpIo;
+  HTTP_BOOT_RANGE_CHUNK        *Chunk;
+  EFI_HTTP_MESSAGE             *Message;
+  EFI_STATUS                   Status;
+  UINTN                        ContentLength;
+
+  HttpIo = &Worker->HttpIo;
+  Chunk  = Worker->Chunk;
+
+  HttpIo->Http->Poll (HttpIo->Http);
+
+  if (((Worker->State == HttpBootRangeSend) && !HttpIo->IsTxDone) ||
+      ((Worker->State != HttpBootRangeSend) && !HttpIo->IsRxDone)) {
+    if (!EFI_ERROR (gBS->CheckEvent (HttpIo->TimeoutEvent))) {
+      return EFI_TIMEOUT;
+    }
+    return EFI_SUCCESS;
+  }
+
+  gBS->SetTimer (HttpIo->TimeoutEvent, TimerCancel, 0);
+  Message = HttpIo->RspToken.Message;
+
+  switch (Worker->State) {
+  case HttpBootRangeSend:
+    if (EFI_ERROR (HttpIo->ReqToken.Status)) {
+      return HttpIo->ReqToken.Status;
+    }
+
+    Worker->State = HttpBootRangeHeader;
+    return HttpBootRangeQueueResponse (Worker, NULL, 0);
+
+  case HttpBootRangeHeader:
+    if (EFI_ERROR (HttpIo->RspToken.Status) && (HttpIo->RspToken.Status != EFI_HTTP_ERROR)) {
+      return HttpIo->RspToken.Status;
+    }
+
+    if (Worker->Response.StatusCode != HTTP_STATUS_206_PARTIAL_CONTENT) {
+      Status = (Worker->Response.StatusCode == HTTP_STATUS_200_OK) ? EFI_UNSUPPORTED : EFI_DEVICE_ERROR;
+    } else {
+      //
+      // Make sure the server sends exactly the requested range.
+      //
+      Status = HttpIoGetContentLength (Message->HeaderCount, Message->Headers, &ContentLength);
+      if (EFI_ERROR (Status) || (ContentLength != Chunk->Length)) {
+        Status = EFI_DEVICE_ERROR;
+      } else {
+        Status = HttpBootCheckImageType (
+                   Private->BootFileUri,
+                   Private->BootFileUriParser,
+                   Message->HeaderCount,
+                   Message->Headers,
+                   ImageType
+                   );
+      }
+    }
+
+    if (Message->Headers != NULL) {
+      HttpFreeHeaderFields (Message->Headers, Message->HeaderCount);
+      Message->Headers = NULL;
+    }
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+
+    Worker->State = HttpBootRangeBody;
+    return HttpBootRangeQueueResponse (
+             Worker,
+             Buffer + Chunk->Offset,
+             Chunk->Length
+             );
+
+  case HttpBootRangeBody:
+    if (EFI_ERROR (HttpIo->RspToken.Status)) {
+      return HttpIo->RspToken.Status;
+    }
+
+    if (Private->HttpBootCallback != NULL) {
+      Status = Private->HttpBootCallback->Callback (
+                 Private->HttpBootCallback,
+                 HttpBootHttpEntityBody,
+                 TRUE,
+                 (UINT32) Message->BodyLength,
+                 Message->Body
+                 );
+      if (EFI_ERROR (Status)) {
+        return Status;
+      }
+    }
+
+    Worker->Received += Message->BodyLength;
+    if (Worker->Received < Chunk->Length) {
+      return HttpBootRangeQueueResponse (
+               Worker,
+               Buffer + Chunk->Offset + Worker->Received,
+               Chunk->Length - Worker->Received
+               );
+    }
+
+    Chunk->Busy   = FALSE;
+    Chunk->Done   = TRUE;
+    Worker->Chunk = NULL;
+    Worker->State = HttpBootRangeIdle;
+    return EFI_SUCCESS;
+
+  default:
+    return EFI_SUCCESS;
+  }
+}
+
+/**
+  Download the boot file in ranges over several concurrent HTTP connections,
+  straight into the caller's buffer. Each range is retried on another
+  request when its connection fails.
+
+  @param[in]       Private         The pointer to the driver's private data.
+  @param[in]       Url             The URL of the boot file.
+  @param[in]       ContentLength   The size of the boot file.
+  @param[out]      Buffer          The memory buffer to transfer the file to, at
+                                   least ContentLength bytes.
+  @param[out]      ImageType       The image type of the downloaded file.
+
+  @retval EFI_SUCCESS              The file was loaded.
+  @retval EFI_UNSUPPORTED          The server ignored the range requests, the file
+                                   should be downloaded over a single connection.
+  @retval EFI_OUT_OF_RESOURCES     Could not allocate needed resources.
+  @retval Others                   Unexpected error happened.
+
+**/
+EFI_STATUS
+HttpBootGetBootFileRanged (
+  IN     HTTP_BOOT_PRIVATE_DATA   *Private,
+  IN     CHAR16                   *Url,
+  IN     UINTN                    ContentLength,
+     OUT UINT8                    *Buffer,
+     OUT HTTP_BOOT_IMAGE_TYPE     *ImageType
+  )
+{
+  EFI_STATUS                 Status;
+  CHAR8                      *HostName;
+  HTTP_BOOT_RANGE_CHUNK      *Chunks;
+  HTTP_BOOT_RANGE_WORKER     *Workers;
+  HTTP_BOOT_RANGE_WORKER     *Worker;
+  UINTN                      ChunkSize;
+  UINTN                      ChunkCount;
+  UINTN                      WorkerCount;
+  UINTN                      Completed;
+  UINTN                      Next;
+  UINTN                      Alive;
+  UINTN                      Index;
+
+  ChunkSize   = PcdGet32 (PcdHttpBootRangeChunkSize);
+  ChunkCount  = (ContentLength + ChunkSize - 1) / ChunkSize;
+  WorkerCount = MIN (PcdGet8 (PcdHttpBootRangeConnections), ChunkCount);
+
+  HostName = NULL;
+  Status = HttpUrlGetHostName (
+             Private->BootFileUri,
+             Private->BootFileUriParser,
+             &HostName
+             );
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Chunks  = AllocateZeroPool (ChunkCount * sizeof (HTTP_BOOT_RANGE_CHUNK));
+  Workers = AllocateZeroPool (WorkerCount * sizeof (HTTP_BOOT_RANGE_WORKER));
+  if ((Chunks == NULL) || (Workers == NULL)) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto ON_EXIT;
+  }
+
+  for (Index = 0; Index < ChunkCount; Index++) {
+    Chunks[Index].Offset = Index * ChunkSize;
+    Chunks[Index].Length = MIN (ChunkSize, ContentLength - Chunks[Index].Offset);
+  }
+
+  for (Index = 0; Index < WorkerCount; Index++) {
+    Status = HttpBootOpenHttpIo (Private, NULL, &Workers[Index].HttpIo);
+    if (EFI_ERROR (Status)) {
+      goto ON_EXIT;
+    }
+    Workers[Index].HttpCreated = TRUE;
+    Workers[Index].State       = HttpBootRangeIdle;
+  }
+
+  Completed = 0;
+  Next      = 0;
+  Status    = EFI_SUCCESS;
+  while (Completed < ChunkCount) {
+    Alive = 0;
+    for (Index = 0; (Index < WorkerCount) && !EFI_ERROR (Status); Index++) {
+      Worker = &Workers[Index];
+      if (Worker->State == HttpBootRangeDead) {
+        continue;
+      }
+      Alive++;
+
+      if (Worker->State == HttpBootRangeIdle) {
+        //
+        // Pick the next range nobody is working on, failed ranges
+        // are picked up again when the scan wraps around.
+        //
+        for (Next = 0; Next < ChunkCount; Next++) {
+          if (!Chunks[Next].Done && !Chunks[Next].Busy) {
+            break;
+          }
+        }
+        if (Next == ChunkCount) {
+          continue;
+        }
+
+        Status = HttpBootRangeSendRequest (Worker, &Chunks[Next], HostName, Url);
+      } else {
+        Status = HttpBootRangeProcess (Private, Worker, Buffer, ImageType);
+        if ((Status == EFI_SUCCESS) && (Worker->State == HttpBootRangeIdle)) {
+          Completed++;
+        }
+      }
+
+      if (EFI_ERROR (Status) && (Status != EFI_UNSUPPORTED)) {
+        Status = HttpBootRangeFail (Private, Worker, Status);
+      }
+    }
+
+    if (EFI_ERROR (Status)) {
+      goto ON_EXIT;
+    }
+
+    if (Alive == 0) {
+      Status = EFI_DEVICE_ERROR;
+      goto ON_EXIT;
+    }
+  }
+
+ON_EXIT:
+  if (Workers != NULL) {
+    for (Index = 0; Index < WorkerCount; Index++) {
+      HttpBootRangeCloseWorker (&Workers[Index]);
+    }
+    FreePool (Workers);
+  }
+  if (Chunks != NULL) {
+    FreePool (Chunks);
+  }
+  FreePool (HostName);
+
+  return Status;
+}
+
 /**
   This function download the boot file by using UEFI HTTP protocol.
 
@@ -950,8 +1490,32 @@ HttpBootGetBootFile (
   }
 
   //
-  // Not found in cache, try to download it through HTTP.
+  // Not found in cache, try to download it through HTTP. Large files go over
+  // several connections in ranges when the server accepts them.
   //
+  if (!HeaderOnly && (Buffer != NULL) && Private->AcceptRanges &&
+      (PcdGet8 (PcdHttpBootRangeConnections) > 1) &&
+      (PcdGet32 (PcdHttpBootRangeChunkSize) != 0) &&
+      (Private->BootFileSize > PcdGet32 (PcdHttpBootRangeChunkSize)) &&
+      (*BufferSize >= Private->BootFileSize)) {
+    Status = HttpBootGetBootFileRanged (
+               Private,
+               Url,
+               Private->BootFileSize,
+               Buffer,
+               ImageType
+               );
+    if (Status != EFI_UNSUPPORTED) {
+      if (!EFI_ERROR (Status)) {
+        *BufferSize = Private->BootFileSize;
+      }
+      FreePool (Url);
+      return Status;
+    }
+
+    DEBUG ((DEBUG_INFO, "HttpBootGetBootFile: ranges ignored by server, using one connection\n"));
+    Private->AcceptRanges = FALSE;
+  }
 
   //
   // 1. Create a temp cache item for the requested URI if caller doesn't provide buffer.
@@ -1103,6 +1667,11 @@ HttpBootGetBootFile (
     goto ERROR_5;
   }
 
+  Private->AcceptRanges = HttpBootIsRangeSupported (
+                            ResponseData->HeaderCount,
+                            ResponseData->Headers
+                            );
+
   //
   // 3.2 Cache the response header.
   //
@@ -13,6 +13,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #define HTTP_BOOT_REQUEST_TIMEOUT            5000      // 5 seconds in uints of millisecond.
 #define HTTP_BOOT_RESPONSE_TIMEOUT           5000      // 5 seconds in uints of millisecond.
 #define HTTP_BOOT_BLOCK_SIZE                 1500
+#define HTTP_BOOT_RANGE_MAX_RETRY            3
 
 
 
@@ -62,6 +63,39 @@ typedef struct {
   HTTP_BOOT_PRIVATE_DATA     *Private;
 } HTTP_BOOT_CALLBACK_DATA;
 
+//
+// One range of the boot file in a ranged download.
+//
+typedef struct {
+  UINTN                      Offset;
+  UINTN                      Length;
+  UINTN                      Retries;
+  BOOLEAN                    Busy;        // A connection is downloading it.
+  BOOLEAN                    Done;
+} HTTP_BOOT_RANGE_CHUNK;
+
+typedef enum {
+  HttpBootRangeIdle,                      // No range assigned.
+  HttpBootRangeSend,                      // Waiting for the request to be sent.
+  HttpBootRangeHeader,                    // Waiting for the response header.
+  HttpBootRangeBody,                      // Receiving the message body.
+  HttpBootRangeDead                       // The connection couldn't be recreated.
+} HTTP_BOOT_RANGE_STATE;
+
+//
+// One of the concurrent connections of a ranged download.
+//
+typedef struct {
+  HTTP_IO                    HttpIo;
+  BOOLEAN                    HttpCreated;
+  HTTP_BOOT_RANGE_STATE      State;
+  HTTP_BOOT_RANGE_CHUNK      *Chunk;
+  UINTN                      Received;    // Bytes of Chunk received so far.
+  EFI_HTTP_REQUEST_DATA      RequestData;
+  HTTP_IO_HEADER             *Header;
+  EFI_HTTP_RESPONSE_DATA     Response;
+} HTTP_BOOT_RANGE_WORKER;
+
 /**
   Discover all the boot information for boot file.
 
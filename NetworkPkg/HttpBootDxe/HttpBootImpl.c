@@ -455,6 +455,7 @@ HttpBootStop (
   Private->BootFileUri = NULL;
   Private->BootFileUriParser = NULL;
   Private->BootFileSize = 0;
+  Private->AcceptRanges = FALSE;
   Private->SelectIndex = 0;
   Private->SelectProxyType = HttpOfferTypeMax;
 
@@ -8,9 +8,184 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #include "HttpDriver.h"
 
+//
+// The maximum number of DNS servers queried in parallel. Each query runs on
+// its own DNS child configured with a single server, so an unreachable server
+// only delays the answer if no other server replies.
+//
+#define HTTP_DNS_MAX_PARALLEL_QUERIES  4
+
+typedef struct {
+  EFI_HANDLE                      Handle;
+  EFI_DNS4_PROTOCOL               *Dns4;
+  EFI_DNS4_COMPLETION_TOKEN       Token;
+  BOOLEAN                         IsDone;
+} HTTP_DNS4_QUERY;
+
+typedef struct {
+  EFI_HANDLE                      Handle;
+  EFI_DNS6_PROTOCOL               *Dns6;
+  EFI_DNS6_COMPLETION_TOKEN       Token;
+  BOOLEAN                         IsDone;
+} HTTP_DNS6_QUERY;
+
+/**
+  Create a DNS4 child, configure it with one DNS server and start resolving
+  HostName on it.
+
+  On failure, the caller still has to release the query with
+  HttpDns4StopQuery().
+
+  @param[in]  HttpInstance        Pointer to HTTP_PROTOCOL instance.
+  @param[in]  HostName            Pointer to buffer containing hostname.
+  @param[in]  DnsServer           The DNS server to query, or NULL to let the
+                                  DNS4 driver use its default server list.
+  @param[out] Query               The query to start.
+
+  @retval EFI_SUCCESS             The name resolution has been started.
+  @retval Others                  Failed to start the name resolution.
+
+**/
+STATIC
+EFI_STATUS
+HttpDns4StartQuery (
+  IN     HTTP_PROTOCOL            *HttpInstance,
+  IN     CHAR16                   *HostName,
+  IN     EFI_IPv4_ADDRESS         *DnsServer OPTIONAL,
+     OUT HTTP_DNS4_QUERY          *Query
+  )
+{
+  EFI_STATUS                      Status;
+  HTTP_SERVICE                    *Service;
+  EFI_DNS4_CONFIG_DATA            DnsCfgData;
+
+  Service = HttpInstance->Service;
+
+  //
+  // Create a DNS4 child instance and get the protocol.
+  //
+  Status = NetLibCreateServiceChild (
+             Service->ControllerHandle,
+             Service->Ip4DriverBindingHandle,
+             &gEfiDns4ServiceBindingProtocolGuid,
+             &Query->Handle
+             );
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Status = gBS->OpenProtocol (
+                  Query->Handle,
+                  &gEfiDns4ProtocolGuid,
+                  (VOID **) &Query->Dns4,
+                  Service->Ip4DriverBindingHandle,
+                  Service->ControllerHandle,
+                  EFI_OPEN_PROTOCOL_BY_DRIVER
+                  );
+  if (EFI_ERROR (Status)) {
+    Query->Dns4 = NULL;
+    return Status;
+  }
+
+  //
+  // Configure DNS4 instance for the DNS server address and protocol.
+  //
+  ZeroMem (&DnsCfgData, sizeof (DnsCfgData));
+  DnsCfgData.DnsServerListCount = (DnsServer == NULL) ? 0 : 1;
+  DnsCfgData.DnsServerList      = DnsServer;
+  DnsCfgData.UseDefaultSetting  = HttpInstance->IPv4Node.UseDefaultAddress;
+  if (!DnsCfgData.UseDefaultSetting) {
+    IP4_COPY_ADDRESS (&DnsCfgData.StationIp, &HttpInstance->IPv4Node.LocalAddress);
+    IP4_COPY_ADDRESS (&DnsCfgData.SubnetMask, &HttpInstance->IPv4Node.LocalSubnet);
+  }
+  DnsCfgData.EnableDnsCache     = TRUE;
+  DnsCfgData.Protocol           = EFI_IP_PROTO_UDP;
+  Status = Query->Dns4->Configure (Query->Dns4, &DnsCfgData);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  //
+  // Create event to set the IsDone flag when name resolution is finished.
+  //
+  Query->IsDone = FALSE;
+  Status = gBS->CreateEvent (
+                  EVT_NOTIFY_SIGNAL,
+                  TPL_NOTIFY,
+                  HttpCommonNotify,
+                  &Query->IsDone,
+                  &Query->Token.Event
+                  );
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  //
+  // Start asynchronous name resolution.
+  //
+  Query->Token.Status = EFI_NOT_READY;
+  return Query->Dns4->HostNameToIp (Query->Dns4, HostName, &Query->Token);
+}
+
+/**
+  Abort the query if it is still running, and release its resources.
+
+  @param[in]       HttpInstance   Pointer to HTTP_PROTOCOL instance.
+  @param[in, out]  Query          The query to stop.
+
+**/
+STATIC
+VOID
+HttpDns4StopQuery (
+  IN     HTTP_PROTOCOL            *HttpInstance,
+  IN OUT HTTP_DNS4_QUERY          *Query
+  )
+{
+  HTTP_SERVICE                    *Service;
+
+  Service = HttpInstance->Service;
+
+  if (Query->Dns4 != NULL && Query->Token.Event != NULL && !Query->IsDone) {
+    Query->Dns4->Cancel (Query->Dns4, &Query->Token);
+  }
+
+  if (Query->Token.Event != NULL) {
+    gBS->CloseEvent (Query->Token.Event);
+  }
+  if (Query->Token.RspData.H2AData != NULL) {
+    if (Query->Token.RspData.H2AData->IpList != NULL) {
+      FreePool (Query->Token.RspData.H2AData->IpList);
+    }
+    FreePool (Query->Token.RspData.H2AData);
+  }
+
+  if (Query->Dns4 != NULL) {
+    Query->Dns4->Configure (Query->Dns4, NULL);
+
+    gBS->CloseProtocol (
+           Query->Handle,
+           &gEfiDns4ProtocolGuid,
+           Service->Ip4DriverBindingHandle,
+           Service->ControllerHandle
+           );
+  }
+
+  if (Query->Handle != NULL) {
+    NetLibDestroyServiceChild (
+      Service->ControllerHandle,
+      Service->Ip4DriverBindingHandle,
+      &gEfiDns4ServiceBindingProtocolGuid,
+      Query->Handle
+      );
+  }
+}
+
 /**
   Retrieve the host address using the EFI_DNS4_PROTOCOL.
 
+  The configured DNS servers, up to HTTP_DNS_MAX_PARALLEL_QUERIES of them, are
+  queried in parallel, and the first valid answer is used.
+
   @param[in]  HttpInstance        Pointer to HTTP_PROTOCOL instance.
   @param[in]  HostName            Pointer to buffer containing hostname.
   @param[out] IpAddress           On output, pointer to buffer containing IPv4 address.
@@ -29,16 +204,17 @@ HttpDns4 (
   )
 {
   EFI_STATUS                      Status;
-  EFI_DNS4_PROTOCOL               *Dns4;
-  EFI_DNS4_CONFIG_DATA            Dns4CfgData;
-  EFI_DNS4_COMPLETION_TOKEN       Token;
-  BOOLEAN                         IsDone;
   HTTP_SERVICE                    *Service;
-  EFI_HANDLE                      Dns4Handle;
   EFI_IP4_CONFIG2_PROTOCOL        *Ip4Config2;
   UINTN                           DnsServerListCount;
   EFI_IPv4_ADDRESS                *DnsServerList;
   UINTN                           DataSize;
+  HTTP_DNS4_QUERY                 *Queries;
+  HTTP_DNS4_QUERY                 *Query;
+  HTTP_DNS4_QUERY                 *Answer;
+  UINTN                           QueryCount;
+  UINTN                           Pending;
+  UINTN                           Index;
 
 
   Service = HttpInstance->Service;
@@ -46,7 +222,6 @@ HttpDns4 (
 
   DnsServerList      = NULL;
   DnsServerListCount = 0;
-  ZeroMem (&Token, sizeof (EFI_DNS4_COMPLETION_TOKEN));
 
   //
   // Get DNS server list from EFI IPv4 Configuration II protocol.
@@ -74,146 +249,242 @@ HttpDns4 (
     }
   }
 
-  Dns4Handle = NULL;
-  Dns4       = NULL;
+  //
+  // Without a configured server list, a single query lets the DNS4 driver
+  // fall back to its default servers.
+  //
+  QueryCount = MAX (1, MIN (DnsServerListCount, HTTP_DNS_MAX_PARALLEL_QUERIES));
+  Queries    = AllocateZeroPool (QueryCount * sizeof (HTTP_DNS4_QUERY));
+  if (Queries == NULL) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto Exit;
+  }
+
+  Pending = 0;
+  for (Index = 0; Index < QueryCount; Index++) {
+    Query  = &Queries[Index];
+    Status = HttpDns4StartQuery (
+               HttpInstance,
+               HostName,
+               (DnsServerList == NULL) ? NULL : &DnsServerList[Index],
+               Query
+               );
+    if (EFI_ERROR (Status)) {
+      Query->Token.Status = Status;
+      Query->IsDone       = TRUE;
+    } else {
+      Pending++;
+    }
+  }
+
+  //
+  // Poll all the queries until one of them returns a valid answer, or all of
+  // them are done.
+  //
+  Answer = NULL;
+  while (Answer == NULL && Pending > 0) {
+    Pending = 0;
+    for (Index = 0; Index < QueryCount && Answer == NULL; Index++) {
+      Query = &Queries[Index];
+      if (!Query->IsDone) {
+        Query->Dns4->Poll (Query->Dns4);
+        if (!Query->IsDone) {
+          Pending++;
+          continue;
+        }
+      }
+
+      if (!EFI_ERROR (Query->Token.Status) &&
+          Query->Token.RspData.H2AData != NULL &&
+          Query->Token.RspData.H2AData->IpCount != 0 &&
+          Query->Token.RspData.H2AData->IpList != NULL) {
+        Answer = Query;
+      }
+    }
+  }
+
+  if (Answer != NULL) {
+    //
+    // We just return the first IPv4 address from DNS protocol.
+    //
+    IP4_COPY_ADDRESS (IpAddress, Answer->Token.RspData.H2AData->IpList);
+    Status = EFI_SUCCESS;
+  } else {
+    //
+    // Report the outcome of the query to the preferred (first) server.
+    //
+    Status = Queries[0].Token.Status;
+    if (!EFI_ERROR (Status)) {
+      Status = EFI_DEVICE_ERROR;
+    }
+  }
+
+  for (Index = 0; Index < QueryCount; Index++) {
+    HttpDns4StopQuery (HttpInstance, &Queries[Index]);
+  }
+  FreePool (Queries);
+
+Exit:
+  if (DnsServerList != NULL) {
+    FreePool (DnsServerList);
+  }
+
+  return Status;
+}
+
+/**
+  Create a DNS6 child, configure it with one DNS server and start resolving
+  HostName on it.
+
+  On failure, the caller still has to release the query with
+  HttpDns6StopQuery().
+
+  @param[in]  HttpInstance        Pointer to HTTP_PROTOCOL instance.
+  @param[in]  HostName            Pointer to buffer containing hostname.
+  @param[in]  DnsServer           The DNS server to query, or NULL to let the
+                                  DNS6 driver use its default server list.
+  @param[out] Query               The query to start.
+
+  @retval EFI_SUCCESS             The name resolution has been started.
+  @retval Others                  Failed to start the name resolution.
+
+**/
+STATIC
+EFI_STATUS
+HttpDns6StartQuery (
+  IN     HTTP_PROTOCOL            *HttpInstance,
+  IN     CHAR16                   *HostName,
+  IN     EFI_IPv6_ADDRESS         *DnsServer OPTIONAL,
+     OUT HTTP_DNS6_QUERY          *Query
+  )
+{
+  EFI_STATUS                      Status;
+  HTTP_SERVICE                    *Service;
+  EFI_DNS6_CONFIG_DATA            DnsCfgData;
+
+  Service = HttpInstance->Service;
 
   //
-  // Create a DNS child instance and get the protocol.
+  // Create a DNSv6 child instance and get the protocol.
   //
   Status = NetLibCreateServiceChild (
              Service->ControllerHandle,
-             Service->Ip4DriverBindingHandle,
-             &gEfiDns4ServiceBindingProtocolGuid,
-             &Dns4Handle
+             Service->Ip6DriverBindingHandle,
+             &gEfiDns6ServiceBindingProtocolGuid,
+             &Query->Handle
              );
   if (EFI_ERROR (Status)) {
-    goto Exit;
+    return Status;
   }
 
   Status = gBS->OpenProtocol (
-                  Dns4Handle,
-                  &gEfiDns4ProtocolGuid,
-                  (VOID **) &Dns4,
-                  Service->Ip4DriverBindingHandle,
+                  Query->Handle,
+                  &gEfiDns6ProtocolGuid,
+                  (VOID **) &Query->Dns6,
+                  Service->Ip6DriverBindingHandle,
                   Service->ControllerHandle,
                   EFI_OPEN_PROTOCOL_BY_DRIVER
                   );
   if (EFI_ERROR (Status)) {
-    goto Exit;
+    Query->Dns6 = NULL;
+    return Status;
   }
 
   //
-  // Configure DNS4 instance for the DNS server address and protocol.
+  // Configure DNSv6 instance for the DNS server address and protocol.
   //
-  ZeroMem (&Dns4CfgData, sizeof (Dns4CfgData));
-  Dns4CfgData.DnsServerListCount = DnsServerListCount;
-  Dns4CfgData.DnsServerList      = DnsServerList;
-  Dns4CfgData.UseDefaultSetting  = HttpInstance->IPv4Node.UseDefaultAddress;
-  if (!Dns4CfgData.UseDefaultSetting) {
-    IP4_COPY_ADDRESS (&Dns4CfgData.StationIp, &HttpInstance->IPv4Node.LocalAddress);
-    IP4_COPY_ADDRESS (&Dns4CfgData.SubnetMask, &HttpInstance->IPv4Node.LocalSubnet);
-  }
-  Dns4CfgData.EnableDnsCache     = TRUE;
-  Dns4CfgData.Protocol           = EFI_IP_PROTO_UDP;
-  Status = Dns4->Configure (
-                   Dns4,
-                   &Dns4CfgData
-                   );
+  ZeroMem (&DnsCfgData, sizeof (DnsCfgData));
+  DnsCfgData.DnsServerCount = (DnsServer == NULL) ? 0 : 1;
+  DnsCfgData.DnsServerList  = DnsServer;
+  DnsCfgData.EnableDnsCache = TRUE;
+  DnsCfgData.Protocol       = EFI_IP_PROTO_UDP;
+  IP6_COPY_ADDRESS (&DnsCfgData.StationIp, &HttpInstance->Ipv6Node.LocalAddress);
+  Status = Query->Dns6->Configure (Query->Dns6, &DnsCfgData);
   if (EFI_ERROR (Status)) {
-    goto Exit;
+    return Status;
   }
 
   //
-  // Create event to set the is done flag when name resolution is finished.
+  // Create event to set the IsDone flag when name resolution is finished.
   //
-  ZeroMem (&Token, sizeof (Token));
+  Query->IsDone = FALSE;
   Status = gBS->CreateEvent (
                   EVT_NOTIFY_SIGNAL,
                   TPL_NOTIFY,
                   HttpCommonNotify,
-                  &IsDone,
-                  &Token.Event
+                  &Query->IsDone,
+                  &Query->Token.Event
                   );
   if (EFI_ERROR (Status)) {
-    goto Exit;
+    return Status;
   }
 
   //
   // Start asynchronous name resolution.
   //
-  Token.Status = EFI_NOT_READY;
-  IsDone       = FALSE;
-  Status = Dns4->HostNameToIp (Dns4, HostName, &Token);
-  if (EFI_ERROR (Status)) {
-    goto Exit;
-  }
+  Query->Token.Status = EFI_NOT_READY;
+  return Query->Dns6->HostNameToIp (Query->Dns6, HostName, &Query->Token);
+}
 
-  while (!IsDone) {
-    Dns4->Poll (Dns4);
-  }
+/**
+  Abort the query if it is still running, and release its resources.
 
-  //
-  // Name resolution is done, check result.
-  //
-  Status = Token.Status;
-  if (!EFI_ERROR (Status)) {
-    if (Token.RspData.H2AData == NULL) {
-      Status = EFI_DEVICE_ERROR;
-      goto Exit;
-    }
-    if (Token.RspData.H2AData->IpCount == 0 || Token.RspData.H2AData->IpList == NULL) {
-      Status = EFI_DEVICE_ERROR;
-      goto Exit;
-    }
-    //
-    // We just return the first IP address from DNS protocol.
-    //
-    IP4_COPY_ADDRESS (IpAddress, Token.RspData.H2AData->IpList);
-    Status = EFI_SUCCESS;
-  }
+  @param[in]       HttpInstance   Pointer to HTTP_PROTOCOL instance.
+  @param[in, out]  Query          The query to stop.
 
-Exit:
+**/
+STATIC
+VOID
+HttpDns6StopQuery (
+  IN     HTTP_PROTOCOL            *HttpInstance,
+  IN OUT HTTP_DNS6_QUERY          *Query
+  )
+{
+  HTTP_SERVICE                    *Service;
 
-  if (Token.Event != NULL) {
-    gBS->CloseEvent (Token.Event);
+  Service = HttpInstance->Service;
+
+  if (Query->Dns6 != NULL && Query->Token.Event != NULL && !Query->IsDone) {
+    Query->Dns6->Cancel (Query->Dns6, &Query->Token);
+  }
+
+  if (Query->Token.Event != NULL) {
+    gBS->CloseEvent (Query->Token.Event);
   }
-  if (Token.RspData.H2AData != NULL) {
-    if (Token.RspData.H2AData->IpList != NULL) {
-      FreePool (Token.RspData.H2AData->IpList);
+  if (Query->Token.RspData.H2AData != NULL) {
+    if (Query->Token.RspData.H2AData->IpList != NULL) {
+      FreePool (Query->Token.RspData.H2AData->IpList);
     }
-    FreePool (Token.RspData.H2AData);
+    FreePool (Query->Token.RspData.H2AData);
   }
 
-  if (Dns4 != NULL) {
-    Dns4->Configure (Dns4, NULL);
+  if (Query->Dns6 != NULL) {
+    Query->Dns6->Configure (Query->Dns6, NULL);
 
     gBS->CloseProtocol (
-           Dns4Handle,
-           &gEfiDns4ProtocolGuid,
-           Service->Ip4DriverBindingHandle,
+           Query->Handle,
+           &gEfiDns6ProtocolGuid,
+           Service->Ip6DriverBindingHandle,
            Service->ControllerHandle
            );
   }
 
-  if (Dns4Handle != NULL) {
+  if (Query->Handle != NULL) {
     NetLibDestroyServiceChild (
       Service->ControllerHandle,
-      Service->Ip4DriverBindingHandle,
-      &gEfiDns4ServiceBindingProtocolGuid,
-      Dns4Handle
+      Service->Ip6DriverBindingHandle,
+      &gEfiDns6ServiceBindingProtocolGuid,
+      Query->Handle
       );
   }
-
-  if (DnsServerList != NULL) {
-    FreePool (DnsServerList);
-  }
-
-  return Status;
 }
 
 /**
   Retrieve the host address using the EFI_DNS6_PROTOCOL.
 
+  The configured DNS servers, up to HTTP_DNS_MAX_PARALLEL_QUERIES of them, are
+  queried in parallel, and the first valid answer is used.
+
   @param[in]  HttpInstance        Pointer to HTTP_PROTOCOL instance.
   @param[in]  HostName            Pointer to buffer containing hostname.
   @param[out] IpAddress           On output, pointer to buffer containing IPv6 address.
@@ -233,25 +504,23 @@ HttpDns6 (
 {
   EFI_STATUS                      Status;
   HTTP_SERVICE                    *Service;
-  EFI_DNS6_PROTOCOL               *Dns6;
-  EFI_DNS6_CONFIG_DATA            Dns6ConfigData;
-  EFI_DNS6_COMPLETION_TOKEN       Token;
-  EFI_HANDLE                      Dns6Handle;
   EFI_IP6_CONFIG_PROTOCOL         *Ip6Config;
-  EFI_IPv6_ADDRESS                *DnsServerList;
   UINTN                           DnsServerListCount;
+  EFI_IPv6_ADDRESS                *DnsServerList;
   UINTN                           DataSize;
-  BOOLEAN                         IsDone;
+  HTTP_DNS6_QUERY                 *Queries;
+  HTTP_DNS6_QUERY                 *Query;
+  HTTP_DNS6_QUERY                 *Answer;
+  UINTN                           QueryCount;
+  UINTN                           Pending;
+  UINTN                           Index;
 
 
   Service = HttpInstance->Service;
   ASSERT (Service != NULL);
 
-  DnsServerList       = NULL;
-  DnsServerListCount  = 0;
-  Dns6                = NULL;
-  Dns6Handle          = NULL;
-  ZeroMem (&Token, sizeof (EFI_DNS6_COMPLETION_TOKEN));
+  DnsServerList      = NULL;
+  DnsServerListCount = 0;
 
   //
   // Get DNS server list from EFI IPv6 Configuration protocol.
@@ -280,127 +549,81 @@ HttpDns6 (
   }
 
   //
-  // Create a DNSv6 child instance and get the protocol.
-  //
-  Status = NetLibCreateServiceChild (
-             Service->ControllerHandle,
-             Service->Ip6DriverBindingHandle,
-             &gEfiDns6ServiceBindingProtocolGuid,
-             &Dns6Handle
-             );
-  if (EFI_ERROR (Status)) {
-    goto Exit;
-  }
-
-  Status = gBS->OpenProtocol (
-                  Dns6Handle,
-                  &gEfiDns6ProtocolGuid,
-                  (VOID **) &Dns6,
-                  Service->Ip6DriverBindingHandle,
-                  Service->ControllerHandle,
-                  EFI_OPEN_PROTOCOL_BY_DRIVER
-                  );
-  if (EFI_ERROR (Status)) {
-    goto Exit;
-  }
-
-  //
-  // Configure DNS6 instance for the DNS server address and protocol.
+  // Without a configured server list, a single query lets the DNS6 driver
+  // fall back to its default servers.
   //
-  ZeroMem (&Dns6ConfigData, sizeof (EFI_DNS6_CONFIG_DATA));
-  Dns6ConfigData.DnsServerCount = (UINT32)DnsServerListCount;
-  Dns6ConfigData.DnsServerList  = DnsServerList;
-  Dns6ConfigData.EnableDnsCache = TRUE;
-  Dns6ConfigData.Protocol       = EFI_IP_PROTO_UDP;
-  IP6_COPY_ADDRESS (&Dns6ConfigData.StationIp, &HttpInstance->Ipv6Node.LocalAddress);
-  Status = Dns6->Configure (
-                   Dns6,
-                   &Dns6ConfigData
-                   );
-  if (EFI_ERROR (Status)) {
+  QueryCount = MAX (1, MIN (DnsServerListCount, HTTP_DNS_MAX_PARALLEL_QUERIES));
+  Queries    = AllocateZeroPool (QueryCount * sizeof (HTTP_DNS6_QUERY));
+  if (Queries == NULL) {
+    Status = EFI_OUT_OF_RESOURCES;
     goto Exit;
   }
 
-  Token.Status = EFI_NOT_READY;
-  IsDone       = FALSE;
-  //
-  // Create event to set the  IsDone flag when name resolution is finished.
-  //
-  Status = gBS->CreateEvent (
-                  EVT_NOTIFY_SIGNAL,
-                  TPL_NOTIFY,
-                  HttpCommonNotify,
-                  &IsDone,
-                  &Token.Event
-                  );
-  if (EFI_ERROR (Status)) {
-    goto Exit;
+  Pending = 0;
+  for (Index = 0; Index < QueryCount; Index++) {
+    Query  = &Queries[Index];
+    Status = HttpDns6StartQuery (
+               HttpInstance,
+               HostName,
+               (DnsServerList == NULL) ? NULL : &DnsServerList[Index],
+               Query
+               );
+    if (EFI_ERROR (Status)) {
+      Query->Token.Status = Status;
+      Query->IsDone       = TRUE;
+    } else {
+      Pending++;
+    }
   }
 
   //
-  // Start asynchronous name resolution.
+  // Poll all the queries until one of them returns a valid answer, or all of
+  // them are done.
   //
-  Status = Dns6->HostNameToIp (Dns6, HostName, &Token);
-  if (EFI_ERROR (Status)) {
-    goto Exit;
-  }
+  Answer = NULL;
+  while (Answer == NULL && Pending > 0) {
+    Pending = 0;
+    for (Index = 0; Index < QueryCount && Answer == NULL; Index++) {
+      Query = &Queries[Index];
+      if (!Query->IsDone) {
+        Query->Dns6->Poll (Query->Dns6);
+        if (!Query->IsDone) {
+          Pending++;
+          continue;
+        }
+      }
 
-  while (!IsDone) {
-    Dns6->Poll (Dns6);
+      if (!EFI_ERROR (Query->Token.Status) &&
+          Query->Token.RspData.H2AData != NULL &&
+          Query->Token.RspData.H2AData->IpCount != 0 &&
+          Query->Token.RspData.H2AData->IpList != NULL) {
+        Answer = Query;
+      }
+    }
   }
 
-  //
-  // Name resolution is done, check result.
-  //
-  Status = Token.Status;
-  if (!EFI_ERROR (Status)) {
-    if (Token.RspData.H2AData == NULL) {
-      Status = EFI_DEVICE_ERROR;
-      goto Exit;
-    }
-    if (Token.RspData.H2AData->IpCount == 0 || Token.RspData.H2AData->IpList == NULL) {
-      Status = EFI_DEVICE_ERROR;
-      goto Exit;
-    }
+  if (Answer != NULL) {
     //
     // We just return the first IPv6 address from DNS protocol.
     //
-    IP6_COPY_ADDRESS (IpAddress, Token.RspData.H2AData->IpList);
+    IP6_COPY_ADDRESS (IpAddress, Answer->Token.RspData.H2AData->IpList);
     Status = EFI_SUCCESS;
-  }
-
-Exit:
-
-  if (Token.Event != NULL) {
-    gBS->CloseEvent (Token.Event);
-  }
-  if (Token.RspData.H2AData != NULL) {
-    if (Token.RspData.H2AData->IpList != NULL) {
-      FreePool (Token.RspData.H2AData->IpList);
+  } else {
+    //
+    // Report the outcome of the query to the preferred (first) server.
+    //
+    Status = Queries[0].Token.Status;
+    if (!EFI_ERROR (Status)) {
+      Status = EFI_DEVICE_ERROR;
     }
-    FreePool (Token.RspData.H2AData);
-  }
-
-  if (Dns6 != NULL) {
-    Dns6->Configure (Dns6, NULL);
-
-    gBS->CloseProtocol (
-           Dns6Handle,
-           &gEfiDns6ProtocolGuid,
-           Service->Ip6DriverBindingHandle,
-           Service->ControllerHandle
-           );
   }
 
-  if (Dns6Handle != NULL) {
-    NetLibDestroyServiceChild (
-      Service->ControllerHandle,
-      Service->Ip6DriverBindingHandle,
-      &gEfiDns6ServiceBindingProtocolGuid,
-      Dns6Handle
-      );
+  for (Index = 0; Index < QueryCount; Index++) {
+    HttpDns6StopQuery (HttpInstance, &Queries[Index]);
   }
+  FreePool (Queries);
 
+Exit:
   if (DnsServerList != NULL) {
     FreePool (DnsServerList);
   }
@@ -438,6 +438,21 @@ EfiHttpRequest (
       // Request() is called the first time.
       //
       ReConfigure = FALSE;
+
+      //
+      // Reuse a kept-alive connection to the same host left by another
+      // HTTP instance, which skips the DNS lookup, TCP and TLS handshakes.
+      //
+      Status = HttpAdoptConnection (HttpInstance, HostName, RemotePort);
+      if (!EFI_ERROR (Status)) {
+        HttpInstance->RemotePort = RemotePort;
+        HttpInstance->RemoteHost = HostName;
+        HostName     = NULL;
+        Configure    = FALSE;
+        TlsConfigure = FALSE;
+      } else if (Status != EFI_NOT_FOUND) {
+        goto Error1;
+      }
     } else {
       if ((HttpInstance->RemotePort == RemotePort) &&
           (AsciiStrCmp (HttpInstance->RemoteHost, HostName) == 0) &&
@@ -983,6 +998,7 @@ HttpResponseWorker (
   HTTP_TOKEN_WRAP               *ValueInItem;
   UINTN                         HdrLen;
   NET_FRAGMENT                  Fragment;
+  EFI_HTTP_HEADER               *Header;
 
   if (Wrap == NULL || Wrap->HttpInstance == NULL) {
     return EFI_INVALID_PARAMETER;
@@ -1185,6 +1201,15 @@ HttpResponseWorker (
       FreePool (HttpHeaders);
       HttpHeaders = NULL;
 
+      //
+      // A server closing the connection after this response must not have
+      // it handed to another instance.
+      //
+      Header = HttpFindHeader (HttpMsg->HeaderCount, HttpMsg->Headers, HTTP_HEADER_CONNECTION);
+      if ((Header != NULL) && (AsciiStriCmp (Header->FieldValue, HTTP_HEADER_CONNECTION_CLOSE) == 0)) {
+        HttpInstance->ConnectionClose = TRUE;
+      }
+
 
       //
       // Init message-body parser by header information.
@@ -835,6 +835,12 @@ HttpCleanProtocol (
   IN  HTTP_PROTOCOL          *HttpInstance
   )
 {
+  //
+  // Keep a reusable connection for the next instance talking to the same
+  // host, this leaves nothing for HttpCloseConnection() to close.
+  //
+  HttpPoolConnection (HttpInstance);
+
   HttpCloseConnection (HttpInstance);
 
   HttpCloseTcpConnCloseEvent (HttpInstance);
@@ -994,7 +1000,8 @@ HttpCreateConnection (
   }
 
   if (!EFI_ERROR (Status)) {
-    HttpInstance->State = HTTP_STATE_TCP_CONNECTED;
+    HttpInstance->State           = HTTP_STATE_TCP_CONNECTED;
+    HttpInstance->ConnectionClose = FALSE;
   }
 
   return Status;
@@ -1049,6 +1056,435 @@ HttpCloseConnection (
   return EFI_SUCCESS;
 }
 
+/**
+  Close a pooled connection and release its resources.
+
+  @param[in]  HttpService        The HTTP service owning the connection.
+  @param[in]  Connection         The pooled connection, already removed from
+                                 the pool.
+
+**/
+VOID
+HttpFreePooledConnection (
+  IN  HTTP_SERVICE            *HttpService,
+  IN  HTTP_POOLED_CONNECTION  *Connection
+  )
+{
+  if ((Connection->TlsSb != NULL) && (Connection->TlsChildHandle != NULL)) {
+    Connection->TlsSb->DestroyChild (Connection->TlsSb, Connection->TlsChildHandle);
+  }
+
+  //
+  // Resetting the configuration aborts the connection.
+  //
+  if (!Connection->LocalAddressIsIPv6) {
+    Connection->Tcp4->Configure (Connection->Tcp4, NULL);
+
+    gBS->CloseProtocol (
+           Connection->TcpChildHandle,
+           &gEfiTcp4ProtocolGuid,
+           HttpService->Ip4DriverBindingHandle,
+           HttpService->ControllerHandle
+           );
+
+    NetLibDestroyServiceChild (
+      HttpService->ControllerHandle,
+      HttpService->Ip4DriverBindingHandle,
+      &gEfiTcp4ServiceBindingProtocolGuid,
+      Connection->TcpChildHandle
+      );
+  } else {
+    Connection->Tcp6->Configure (Connection->Tcp6, NULL);
+
+    gBS->CloseProtocol (
+           Connection->TcpChildHandle,
+           &gEfiTcp6ProtocolGuid,
+           HttpService->Ip6DriverBindingHandle,
+           HttpService->ControllerHandle
+           );
+
+    NetLibDestroyServiceChild (
+      HttpService->ControllerHandle,
+      HttpService->Ip6DriverBindingHandle,
+      &gEfiTcp6ServiceBindingProtocolGuid,
+      Connection->TcpChildHandle
+      );
+  }
+
+  FreePool (Connection->RemoteHost);
+  FreePool (Connection);
+}
+
+/**
+  Check whether the TCP connection of a HTTP instance or a pooled connection
+  is still established.
+
+  @param[in]  UsingIpv6          TRUE if Tcp6 is used, FALSE if Tcp4 is used.
+  @param[in]  Tcp4               The TCP4 protocol of the connection.
+  @param[in]  Tcp6               The TCP6 protocol of the connection.
+
+  @retval TRUE                   The connection is established.
+  @retval FALSE                  The connection is closing or closed.
+
+**/
+BOOLEAN
+HttpIsTcpEstablished (
+  IN  BOOLEAN              UsingIpv6,
+  IN  EFI_TCP4_PROTOCOL    *Tcp4,
+  IN  EFI_TCP6_PROTOCOL    *Tcp6
+  )
+{
+  EFI_STATUS                Status;
+  EFI_TCP4_CONNECTION_STATE Tcp4State;
+  EFI_TCP6_CONNECTION_STATE Tcp6State;
+
+  if (!UsingIpv6) {
+    Status = Tcp4->GetModeData (Tcp4, &Tcp4State, NULL, NULL, NULL, NULL);
+    return (BOOLEAN) (!EFI_ERROR (Status) && (Tcp4State == Tcp4StateEstablished));
+  }
+
+  Status = Tcp6->GetModeData (Tcp6, &Tcp6State, NULL, NULL, NULL, NULL);
+  return (BOOLEAN) (!EFI_ERROR (Status) && (Tcp6State == Tcp6StateEstablished));
+}
+
+/**
+  Move the idle connection of a HTTP instance to the connection pool of its
+  service, so a later instance requesting the same host can reuse it. The
+  connection is left alone if it is not reusable.
+
+  @param[in]  HttpInstance       The HTTP instance private data.
+
+**/
+VOID
+HttpPoolConnection (
+  IN  HTTP_PROTOCOL        *HttpInstance
+  )
+{
+  HTTP_SERVICE             *HttpService;
+  HTTP_POOLED_CONNECTION   *Connection;
+  HTTP_POOLED_CONNECTION   *Oldest;
+  EFI_STATUS               Status;
+
+  HttpService = HttpInstance->Service;
+
+  //
+  // Only a connection with no request in flight and no unread response
+  // data can be handed to another instance.
+  //
+  if ((HttpInstance->State != HTTP_STATE_TCP_CONNECTED) ||
+      (HttpInstance->RemoteHost == NULL) ||
+      HttpInstance->ConnectionClose ||
+      (HttpInstance->MsgParser != NULL) ||
+      (HttpInstance->CacheBody != NULL) ||
+      (NetMapGetCount (&HttpInstance->TxTokens) != 0) ||
+      (NetMapGetCount (&HttpInstance->RxTokens) != 0)) {
+    return;
+  }
+
+  if (HttpInstance->UseHttps &&
+      ((HttpInstance->TlsChildHandle == NULL) ||
+       (HttpInstance->TlsSessionState != EfiTlsSessionDataTransferring))) {
+    return;
+  }
+
+  if (!HttpIsTcpEstablished (HttpInstance->LocalAddressIsIPv6, HttpInstance->Tcp4, HttpInstance->Tcp6)) {
+    return;
+  }
+
+  Connection = AllocateZeroPool (sizeof (HTTP_POOLED_CONNECTION));
+  if (Connection == NULL) {
+    return;
+  }
+
+  Connection->RemoteHost = AllocateCopyPool (AsciiStrSize (HttpInstance->RemoteHost), HttpInstance->RemoteHost);
+  if (Connection->RemoteHost == NULL) {
+    FreePool (Connection);
+    return;
+  }
+
+  //
+  // Make room by closing the connection idle for the longest time.
+  //
+  if (HttpService->PooledNumber >= HTTP_POOL_MAX_CONNECTIONS) {
+    Oldest = NET_LIST_HEAD (&HttpService->ConnectionPool, HTTP_POOLED_CONNECTION, Link);
+    RemoveEntryList (&Oldest->Link);
+    HttpService->PooledNumber--;
+    HttpFreePooledConnection (HttpService, Oldest);
+  }
+
+  Connection->RemotePort         = HttpInstance->RemotePort;
+  Connection->UseHttps           = HttpInstance->UseHttps;
+  Connection->LocalAddressIsIPv6 = HttpInstance->LocalAddressIsIPv6;
+  CopyMem (&Connection->IPv4Node, &HttpInstance->IPv4Node, sizeof (Connection->IPv4Node));
+  CopyMem (&Connection->Ipv6Node, &HttpInstance->Ipv6Node, sizeof (Connection->Ipv6Node));
+
+  if (!HttpInstance->LocalAddressIsIPv6) {
+    Connection->TcpChildHandle = HttpInstance->Tcp4ChildHandle;
+    Connection->Tcp4           = HttpInstance->Tcp4;
+    CopyMem (&Connection->Tcp4CfgData, &HttpInstance->Tcp4CfgData, sizeof (EFI_TCP4_CONFIG_DATA));
+    CopyMem (&Connection->Tcp4Option, &HttpInstance->Tcp4Option, sizeof (EFI_TCP4_OPTION));
+    IP4_COPY_ADDRESS (&Connection->RemoteAddr, &HttpInstance->RemoteAddr);
+
+    //
+    // The TCP child stays opened by the driver; only the instance lets go.
+    //
+    Status = gBS->CloseProtocol (
+                    HttpInstance->Tcp4ChildHandle,
+                    &gEfiTcp4ProtocolGuid,
+                    HttpService->Ip4DriverBindingHandle,
+                    HttpInstance->Handle
+                    );
+    HttpInstance->Tcp4ChildHandle = NULL;
+    HttpInstance->Tcp4            = NULL;
+  } else {
+    Connection->TcpChildHandle = HttpInstance->Tcp6ChildHandle;
+    Connection->Tcp6           = HttpInstance->Tcp6;
+    CopyMem (&Connection->Tcp6CfgData, &HttpInstance->Tcp6CfgData, sizeof (EFI_TCP6_CONFIG_DATA));
+    CopyMem (&Connection->Tcp6Option, &HttpInstance->Tcp6Option, sizeof (EFI_TCP6_OPTION));
+    IP6_COPY_ADDRESS (&Connection->RemoteIpv6Addr, &HttpInstance->RemoteIpv6Addr);
+
+    Status = gBS->CloseProtocol (
+                    HttpInstance->Tcp6ChildHandle,
+                    &gEfiTcp6ProtocolGuid,
+                    HttpService->Ip6DriverBindingHandle,
+                    HttpInstance->Handle
+                    );
+    HttpInstance->Tcp6ChildHandle = NULL;
+    HttpInstance->Tcp6            = NULL;
+  }
+
+  ASSERT_EFI_ERROR (Status);
+
+  if (HttpInstance->UseHttps) {
+    Connection->TlsSb            = HttpInstance->TlsSb;
+    Connection->TlsChildHandle   = HttpInstance->TlsChildHandle;
+    Connection->Tls              = HttpInstance->Tls;
+    Connection->TlsConfiguration = HttpInstance->TlsConfiguration;
+    CopyMem (&Connection->TlsConfigData, &HttpInstance->TlsConfigData, sizeof (TLS_CONFIG_DATA));
+    HttpInstance->TlsChildHandle = NULL;
+  }
+
+  HttpInstance->State = HTTP_STATE_TCP_UNCONFIGED;
+
+  InsertTailList (&HttpService->ConnectionPool, &Connection->Link);
+  HttpService->PooledNumber++;
+}
+
+/**
+  Take over a pooled connection to the given host for a HTTP instance that
+  has not connected yet.
+
+  @param[in]  HttpInstance       The HTTP instance private data.
+  @param[in]  HostName           The remote host of the request.
+  @param[in]  RemotePort         The remote port of the request.
+
+  @retval EFI_SUCCESS            A pooled connection is now used by HttpInstance.
+  @retval EFI_NOT_FOUND          No usable connection to the host is pooled.
+  @retval Others                 Other error as indicated.
+
+**/
+EFI_STATUS
+HttpAdoptConnection (
+  IN  HTTP_PROTOCOL        *HttpInstance,
+  IN  CHAR8                *HostName,
+  IN  UINT16               RemotePort
+  )
+{
+  HTTP_SERVICE             *HttpService;
+  HTTP_POOLED_CONNECTION   *Connection;
+  LIST_ENTRY               *Entry;
+  LIST_ENTRY               *Next;
+  EFI_STATUS               Status;
+
+  HttpService = HttpInstance->Service;
+  Connection  = NULL;
+
+  NET_LIST_FOR_EACH_SAFE (Entry, Next, &HttpService->ConnectionPool) {
+    Connection = NET_LIST_USER_STRUCT (Entry, HTTP_POOLED_CONNECTION, Link);
+    if ((Connection->RemotePort != RemotePort) ||
+        (Connection->UseHttps != HttpInstance->UseHttps) ||
+        (Connection->LocalAddressIsIPv6 != HttpInstance->LocalAddressIsIPv6) ||
+        (AsciiStrCmp (Connection->RemoteHost, HostName) != 0) ||
+        (!Connection->LocalAddressIsIPv6 &&
+         (CompareMem (&Connection->IPv4Node, &HttpInstance->IPv4Node, sizeof (Connection->IPv4Node)) != 0)) ||
+        (Connection->LocalAddressIsIPv6 &&
+         (CompareMem (&Connection->Ipv6Node, &HttpInstance->Ipv6Node, sizeof (Connection->Ipv6Node)) != 0))) {
+      Connection = NULL;
+      continue;
+    }
+
+    RemoveEntryList (&Connection->Link);
+    HttpService->PooledNumber--;
+
+    //
+    // The server may have closed the connection while it was idle.
+    //
+    if (HttpIsTcpEstablished (Connection->LocalAddressIsIPv6, Connection->Tcp4, Connection->Tcp6)) {
+      break;
+    }
+
+    HttpFreePooledConnection (HttpService, Connection);
+    Connection = NULL;
+  }
+
+  if (Connection == NULL) {
+    return EFI_NOT_FOUND;
+  }
+
+  //
+  // Replace the unused TCP child created when the instance was configured.
+  //
+  if (!HttpInstance->LocalAddressIsIPv6) {
+    gBS->CloseProtocol (
+           HttpInstance->Tcp4ChildHandle,
+           &gEfiTcp4ProtocolGuid,
+           HttpService->Ip4DriverBindingHandle,
+           HttpService->ControllerHandle
+           );
+
+    gBS->CloseProtocol (
+           HttpInstance->Tcp4ChildHandle,
+           &gEfiTcp4ProtocolGuid,
+           HttpService->Ip4DriverBindingHandle,
+           HttpInstance->Handle
+           );
+
+    NetLibDestroyServiceChild (
+      HttpService->ControllerHandle,
+      HttpService->Ip4DriverBindingHandle,
+      &gEfiTcp4ServiceBindingProtocolGuid,
+      HttpInstance->Tcp4ChildHandle
+      );
+
+    HttpInstance->Tcp4ChildHandle = Connection->TcpChildHandle;
+    Status = gBS->OpenProtocol (
+                    HttpInstance->Tcp4ChildHandle,
+                    &gEfiTcp4ProtocolGuid,
+                    (VOID **) &HttpInstance->Tcp4,
+                    HttpService->Ip4DriverBindingHandle,
+                    HttpInstance->Handle,
+                    EFI_OPEN_PROTOCOL_BY_CHILD_CONTROLLER
+                    );
+
+    CopyMem (&HttpInstance->Tcp4CfgData, &Connection->Tcp4CfgData, sizeof (EFI_TCP4_CONFIG_DATA));
+    CopyMem (&HttpInstance->Tcp4Option, &Connection->Tcp4Option, sizeof (EFI_TCP4_OPTION));
+    HttpInstance->Tcp4CfgData.ControlOption = &HttpInstance->Tcp4Option;
+    IP4_COPY_ADDRESS (&HttpInstance->RemoteAddr, &Connection->RemoteAddr);
+  } else {
+    gBS->CloseProtocol (
+           HttpInstance->Tcp6ChildHandle,
+           &gEfiTcp6ProtocolGuid,
+           HttpService->Ip6DriverBindingHandle,
+           HttpService->ControllerHandle
+           );
+
+    gBS->CloseProtocol (
+           HttpInstance->Tcp6ChildHandle,
+           &gEfiTcp6ProtocolGuid,
+           HttpService->Ip6DriverBindingHandle,
+           HttpInstance->Handle
+           );
+
+    NetLibDestroyServiceChild (
+      HttpService->ControllerHandle,
+      HttpService->Ip6DriverBindingHandle,
+      &gEfiTcp6ServiceBindingProtocolGuid,
+      HttpInstance->Tcp6ChildHandle
+      );
+
+    HttpInstance->Tcp6ChildHandle = Connection->TcpChildHandle;
+    Status = gBS->OpenProtocol (
+                    HttpInstance->Tcp6ChildHandle,
+                    &gEfiTcp6ProtocolGuid,
+                    (VOID **) &HttpInstance->Tcp6,
+                    HttpService->Ip6DriverBindingHandle,
+                    HttpInstance->Handle,
+                    EFI_OPEN_PROTOCOL_BY_CHILD_CONTROLLER
+                    );
+
+    CopyMem (&HttpInstance->Tcp6CfgData, &Connection->Tcp6CfgData, sizeof (EFI_TCP6_CONFIG_DATA));
+    CopyMem (&HttpInstance->Tcp6Option, &Connection->Tcp6Option, sizeof (EFI_TCP6_OPTION));
+    HttpInstance->Tcp6CfgData.ControlOption = &HttpInstance->Tcp6Option;
+    IP6_COPY_ADDRESS (&HttpInstance->RemoteIpv6Addr, &Connection->RemoteIpv6Addr);
+  }
+
+  if (EFI_ERROR (Status)) {
+    //
+    // The TCP child is still opened by the driver, keep it in a pooled
+    // connection record so that it is released with the service.
+    //
+    HttpInstance->Tcp4ChildHandle = NULL;
+    HttpInstance->Tcp4            = NULL;
+    HttpInstance->Tcp6ChildHandle = NULL;
+    HttpInstance->Tcp6            = NULL;
+    HttpFreePooledConnection (HttpService, Connection);
+    return Status;
+  }
+
+  if (HttpInstance->UseHttps) {
+    //
+    // Drop the TLS child created for this request, the pooled session
+    // is already through its handshake.
+    //
+    if (HttpInstance->TlsChildHandle != NULL) {
+      HttpInstance->TlsSb->DestroyChild (HttpInstance->TlsSb, HttpInstance->TlsChildHandle);
+    }
+
+    HttpInstance->TlsSb            = Connection->TlsSb;
+    HttpInstance->TlsChildHandle   = Connection->TlsChildHandle;
+    HttpInstance->Tls              = Connection->Tls;
+    HttpInstance->TlsConfiguration = Connection->TlsConfiguration;
+    CopyMem (&HttpInstance->TlsConfigData, &Connection->TlsConfigData, sizeof (TLS_CONFIG_DATA));
+    HttpInstance->TlsSessionState  = EfiTlsSessionDataTransferring;
+    Connection->TlsChildHandle     = NULL;
+  }
+
+  FreePool (Connection->RemoteHost);
+  FreePool (Connection);
+
+  Status = HttpCreateTcpConnCloseEvent (HttpInstance);
+  if (!EFI_ERROR (Status) && HttpInstance->UseHttps) {
+    Status = TlsCreateTxRxEvent (HttpInstance);
+  }
+
+  //
+  // Even on failure the instance owns the connection now, it is released
+  // with the instance.
+  //
+  HttpInstance->ConnectionClose = FALSE;
+  HttpInstance->State           = HTTP_STATE_TCP_CONNECTED;
+
+  return Status;
+}
+
+/**
+  Close the pooled connections of a HTTP service.
+
+  @param[in]  HttpService        The HTTP service.
+  @param[in]  UsingIpv6          TRUE to close the TCP6 connections, FALSE to
+                                 close the TCP4 connections.
+
+**/
+VOID
+HttpFlushConnectionPool (
+  IN  HTTP_SERVICE         *HttpService,
+  IN  BOOLEAN              UsingIpv6
+  )
+{
+  HTTP_POOLED_CONNECTION   *Connection;
+  LIST_ENTRY               *Entry;
+  LIST_ENTRY               *Next;
+
+  NET_LIST_FOR_EACH_SAFE (Entry, Next, &HttpService->ConnectionPool) {
+    Connection = NET_LIST_USER_STRUCT (Entry, HTTP_POOLED_CONNECTION, Link);
+    if (Connection->LocalAddressIsIPv6 == UsingIpv6) {
+      RemoveEntryList (&Connection->Link);
+      HttpService->PooledNumber--;
+      HttpFreePooledConnection (HttpService, Connection);
+    }
+  }
+}
+
 /**
   Configure TCP4 protocol child.
 
@@ -1103,6 +1539,8 @@ HttpConfigureTcp4 (
   Tcp4Option->KeepAliveTime          = HTTP_KEEP_ALIVE_TIME;
   Tcp4Option->KeepAliveInterval      = HTTP_KEEP_ALIVE_INTERVAL;
   Tcp4Option->EnableNagle            = TRUE;
+  Tcp4Option->EnableWindowScaling    = TRUE;
+  Tcp4Option->EnableSelectiveAck     = TRUE;
   Tcp4CfgData->ControlOption         = Tcp4Option;
 
   Status = HttpInstance->Tcp4->Configure (HttpInstance->Tcp4, Tcp4CfgData);
@@ -1174,6 +1612,8 @@ HttpConfigureTcp6 (
   Tcp6Option->KeepAliveTime      = HTTP_KEEP_ALIVE_TIME;
   Tcp6Option->KeepAliveInterval  = HTTP_KEEP_ALIVE_INTERVAL;
   Tcp6Option->EnableNagle        = TRUE;
+  Tcp6Option->EnableWindowScaling = TRUE;
+  Tcp6Option->EnableSelectiveAck = TRUE;
 
   Status = HttpInstance->Tcp6->Configure (HttpInstance->Tcp6, Tcp6CfgData);
   if (EFI_ERROR (Status)) {
@@ -50,6 +50,12 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #define HTTP_URL_BUFFER_LEN          4096
 
+//
+// Maximum number of idle connections a HTTP service keeps for reuse by
+// later instances.
+//
+#define HTTP_POOL_MAX_CONNECTIONS    4
+
 typedef struct _HTTP_SERVICE {
   UINT32                        Signature;
   EFI_SERVICE_BINDING_PROTOCOL  ServiceBinding;
@@ -61,6 +67,8 @@ typedef struct _HTTP_SERVICE {
   LIST_ENTRY                    ChildrenList;
   UINTN                         ChildrenNumber;
   INTN                          State;
+  LIST_ENTRY                    ConnectionPool;  // Idle HTTP_POOLED_CONNECTION
+  UINTN                         PooledNumber;
 } HTTP_SERVICE;
 
 typedef struct {
@@ -121,6 +129,7 @@ typedef struct _HTTP_PROTOCOL {
   CHAR8                         *RemoteHost;
   UINT16                        RemotePort;
   EFI_IPv4_ADDRESS              RemoteAddr;
+  BOOLEAN                       ConnectionClose;  // Server sent "Connection: close".
 
   EFI_HANDLE                    Tcp6ChildHandle;
   EFI_TCP6_PROTOCOL             *Tcp6;
@@ -204,6 +213,37 @@ typedef struct {
   HTTP_TCP_TOKEN_WRAP           TcpWrap;
 } HTTP_TOKEN_WRAP;
 
+//
+// An established connection, with its TLS session for HTTPS, left idle by
+// a HTTP instance. The next instance requesting the same host picks it up
+// instead of connecting again.
+//
+typedef struct {
+  LIST_ENTRY                       Link;   // Link to ConnectionPool of the service.
+  CHAR8                            *RemoteHost;
+  UINT16                           RemotePort;
+  BOOLEAN                          UseHttps;
+  BOOLEAN                          LocalAddressIsIPv6;
+  EFI_HTTPv4_ACCESS_POINT          IPv4Node;
+  EFI_HTTPv6_ACCESS_POINT          Ipv6Node;
+
+  EFI_HANDLE                       TcpChildHandle;
+  EFI_TCP4_PROTOCOL                *Tcp4;
+  EFI_TCP4_CONFIG_DATA             Tcp4CfgData;
+  EFI_TCP4_OPTION                  Tcp4Option;
+  EFI_IPv4_ADDRESS                 RemoteAddr;
+  EFI_TCP6_PROTOCOL                *Tcp6;
+  EFI_TCP6_CONFIG_DATA             Tcp6CfgData;
+  EFI_TCP6_OPTION                  Tcp6Option;
+  EFI_IPv6_ADDRESS                 RemoteIpv6Addr;
+
+  EFI_SERVICE_BINDING_PROTOCOL     *TlsSb;
+  EFI_HANDLE                       TlsChildHandle;
+  TLS_CONFIG_DATA                  TlsConfigData;
+  EFI_TLS_PROTOCOL                 *Tls;
+  EFI_TLS_CONFIGURATION_PROTOCOL   *TlsConfiguration;
+} HTTP_POOLED_CONNECTION;
+
 
 #define HTTP_PROTOCOL_SIGNATURE  SIGNATURE_32('H', 't', 't', 'P')
 
@@ -348,6 +388,53 @@ HttpCreateConnection (
   IN  HTTP_PROTOCOL        *HttpInstance
   );
 
+/**
+  Move the idle connection of a HTTP instance to the connection pool of its
+  service, so a later instance requesting the same host can reuse it. The
+  connection is left alone if it is not reusable.
+
+  @param[in]  HttpInstance       The HTTP instance private data.
+
+**/
+VOID
+HttpPoolConnection (
+  IN  HTTP_PROTOCOL        *HttpInstance
+  );
+
+/**
+  Take over a pooled connection to the given host for a HTTP instance that
+  has not connected yet.
+
+  @param[in]  HttpInstance       The HTTP instance private data.
+  @param[in]  HostName           The remote host of the request.
+  @param[in]  RemotePort         The remote port of the request.
+
+  @retval EFI_SUCCESS            A pooled connection is now used by HttpInstance.
+  @retval EFI_NOT_FOUND          No usable connection to the host is pooled.
+  @retval Others                 Other error as indicated.
+
+**/
+EFI_STATUS
+HttpAdoptConnection (
+  IN  HTTP_PROTOCOL        *HttpInstance,
+  IN  CHAR8                *HostName,
+  IN  UINT16               RemotePort
+  );
+
+/**
+  Close the pooled connections of a HTTP service.
+
+  @param[in]  HttpService        The HTTP service.
+  @param[in]  UsingIpv6          TRUE to close the TCP6 connections, FALSE to
+                                 close the TCP4 connections.
+
+**/
+VOID
+HttpFlushConnectionPool (
+  IN  HTTP_SERVICE         *HttpService,
+  IN  BOOLEAN              UsingIpv6
+  );
+
 /**
   Close existing TCP connection.
 
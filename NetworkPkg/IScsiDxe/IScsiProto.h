@@ -28,9 +28,16 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #define ISCSI_MAX_CONNS_PER_SESSION             1
 
 #define DEFAULT_MAX_RECV_DATA_SEG_LEN           8192
-#define MAX_RECV_DATA_SEG_LEN_IN_FFP            65536
+#define MAX_RECV_DATA_SEG_LEN_IN_FFP            262144
 #define DEFAULT_MAX_OUTSTANDING_R2T             1
 
+//
+// Values offered in the operational parameter negotiation. Larger bursts and
+// several outstanding R2Ts cut the round trips spent on each large write.
+//
+#define ISCSI_MAX_BURST_LENGTH                  1048576
+#define ISCSI_MAX_OUTSTANDING_R2T               4
+
 #define ISCSI_VERSION_MAX                       0x00
 #define ISCSI_VERSION_MIN                       0x00
 
@@ -1680,6 +1680,18 @@ typedef struct {
 #define NET_BUF_SIZE(BlockOpNum)  \
   (sizeof (NET_BUF) + ((BlockOpNum) - 1) * sizeof (NET_BLOCK_OP))
 
+//
+// Counters of the NET_BUF and NET_VECTOR free lists kept by each module.
+//
+typedef struct {
+  UINT64              NetbufHit;     // NET_BUF allocations served from the free lists
+  UINT64              NetbufMiss;    // NET_BUF allocations passed to the memory services
+  UINT64              VectorHit;     // NET_VECTOR allocations served from the free lists
+  UINT64              VectorMiss;    // NET_VECTOR allocations passed to the memory services
+  UINT32              NetbufCached;  // NET_BUF currently held on the free lists
+  UINT32              VectorCached;  // NET_VECTOR currently held on the free lists
+} NET_BUF_POOL_STATISTICS;
+
 #define NET_HEADSPACE(BlockOp)  \
   ((UINTN)((BlockOp)->Head) - (UINTN)((BlockOp)->BlockHead))
 
@@ -1720,6 +1732,24 @@ NetbufFree (
   IN NET_BUF                *Nbuf
   );
 
+/**
+  Retrieve the hit and occupancy counters of the NET_BUF and NET_VECTOR
+  free lists of the calling module.
+
+  NET_BUF and NET_VECTOR structures released by NetbufFree() are kept on
+  per-size free lists, up to PcdNetBufPoolHighWaterMark of each size, and
+  reused by NetbufAlloc(), NetbufClone(), NetbufGetFragment() and
+  NetbufFromExt().
+
+  @param[out]  Statistics    Pointer to the buffer to receive the counters.
+
+**/
+VOID
+EFIAPI
+NetbufGetPoolStatistics (
+  OUT NET_BUF_POOL_STATISTICS  *Statistics
+  );
+
 /**
   Get the index of NET_BLOCK_OP that contains the byte at Offset in the net
   buffer.
@@ -533,6 +533,7 @@ Ip4CreateInterface (
   Interface->HwaddrLen    = SnpMode.HwAddressSize;
 
   InitializeListHead (&Interface->IpInstances);
+  InitializeListHead (&Interface->RxInstances);
   Interface->PromiscRecv = FALSE;
 
   return Interface;
@@ -768,6 +769,7 @@ Ip4FreeInterface (
   Ip4CancelReceive (Interface);
 
   ASSERT (IsListEmpty (&Interface->IpInstances));
+  ASSERT (IsListEmpty (&Interface->RxInstances));
   ASSERT (IsListEmpty (&Interface->ArpQues));
   ASSERT (IsListEmpty (&Interface->SentFrames));
 
@@ -179,6 +179,14 @@ struct _IP4_INTERFACE {
   // promiscuous receive, PromiscRecv is true.
   //
   LIST_ENTRY                    IpInstances;
+
+  //
+  // The subset of IpInstances that receive packets, linked through
+  // RxLink. Instances configured with ReceiveTimeout == -1 (such as the
+  // per-connection children of TCP) only send, and are left out so the
+  // receive path doesn't walk them for every packet.
+  //
+  LIST_ENTRY                    RxInstances;
   BOOLEAN                       PromiscRecv;
 };
 
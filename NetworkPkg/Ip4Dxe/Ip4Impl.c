@@ -553,11 +553,36 @@ Ip4InitProtocol (
   InitializeListHead (&IpInstance->Received);
   InitializeListHead (&IpInstance->Delivered);
   InitializeListHead (&IpInstance->AddrLink);
+  InitializeListHead (&IpInstance->RxLink);
 
   EfiInitializeLock (&IpInstance->RecycleLock, TPL_NOTIFY);
 }
 
 
+/**
+  Link the IP4 child into its interface's list of receiving instances, or
+  unlink it, according to its current ReceiveTimeout.
+
+  @param[in, out]  IpInstance         The IP4 child, linked to an interface.
+
+**/
+STATIC
+VOID
+Ip4UpdateRxLink (
+  IN OUT IP4_PROTOCOL       *IpInstance
+  )
+{
+  if (!IsListEmpty (&IpInstance->RxLink)) {
+    RemoveEntryList (&IpInstance->RxLink);
+    InitializeListHead (&IpInstance->RxLink);
+  }
+
+  if (IpInstance->ConfigData.ReceiveTimeout != (UINT32)(-1)) {
+    InsertTailList (&IpInstance->Interface->RxInstances, &IpInstance->RxLink);
+  }
+}
+
+
 /**
   Configure the IP4 child. If the child is already configured,
   change the configuration parameter. Otherwise configure it
@@ -612,6 +637,7 @@ Ip4ConfigProtocol (
     }
 
     CopyMem (&IpInstance->ConfigData, Config, sizeof (IpInstance->ConfigData));
+    Ip4UpdateRxLink (IpInstance);
     return EFI_SUCCESS;
   }
 
@@ -732,6 +758,7 @@ Ip4ConfigProtocol (
   InsertTailList (&IpIf->IpInstances, &IpInstance->AddrLink);
 
   CopyMem (&IpInstance->ConfigData, Config, sizeof (IpInstance->ConfigData));
+  Ip4UpdateRxLink (IpInstance);
   IpInstance->State       = IP4_STATE_CONFIGED;
 
   //
@@ -785,6 +812,10 @@ Ip4CleanProtocol (
 
   if (IpInstance->Interface != NULL) {
     RemoveEntryList (&IpInstance->AddrLink);
+    if (!IsListEmpty (&IpInstance->RxLink)) {
+      RemoveEntryList (&IpInstance->RxLink);
+      InitializeListHead (&IpInstance->RxLink);
+    }
     if (IpInstance->Interface->Arp != NULL) {
       gBS->CloseProtocol (
              IpInstance->Interface->ArpHandle,
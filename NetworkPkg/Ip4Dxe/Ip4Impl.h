@@ -149,6 +149,7 @@ struct _IP4_PROTOCOL {
   //
   IP4_INTERFACE             *Interface;
   LIST_ENTRY                AddrLink;   // Ip instances with the same IP address.
+  LIST_ENTRY                RxLink;     // Receiving ip instances with the same IP address.
   IP4_ROUTE_TABLE           *RouteTable;
 
   EFI_IP4_ROUTE_TABLE       *EfiRouteTable;
@@ -1431,7 +1431,7 @@ Ip4InterfaceEnquePacket (
   }
 
   //
-  // Iterate through the ip instances on the interface, enqueue
+  // Iterate through the receiving ip instances on the interface, enqueue
   // the packet if filter passed. Save the original cast type,
   // and pass the local cast type to the IP children on the
   // interface. The global cast type will be restored later.
@@ -1441,8 +1441,8 @@ Ip4InterfaceEnquePacket (
 
   Enqueued        = 0;
 
-  NET_LIST_FOR_EACH (Entry, &IpIf->IpInstances) {
-    IpInstance = NET_LIST_USER_STRUCT (Entry, IP4_PROTOCOL, AddrLink);
+  NET_LIST_FOR_EACH (Entry, &IpIf->RxInstances) {
+    IpInstance = NET_LIST_USER_STRUCT (Entry, IP4_PROTOCOL, RxLink);
     NET_CHECK_SIGNATURE (IpInstance, IP4_PROTOCOL_SIGNATURE);
 
     //
@@ -1480,8 +1480,8 @@ Ip4InterfaceDeliverPacket (
   IP4_PROTOCOL              *Ip4Instance;
   LIST_ENTRY                *Entry;
 
-  NET_LIST_FOR_EACH (Entry, &IpIf->IpInstances) {
-    Ip4Instance = NET_LIST_USER_STRUCT (Entry, IP4_PROTOCOL, AddrLink);
+  NET_LIST_FOR_EACH (Entry, &IpIf->RxInstances) {
+    Ip4Instance = NET_LIST_USER_STRUCT (Entry, IP4_PROTOCOL, RxLink);
     Ip4InstanceDeliverPacket (Ip4Instance);
   }
 
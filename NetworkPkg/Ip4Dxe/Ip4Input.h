@@ -15,7 +15,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 ///
 #define IP4_MAX_IPSEC_HEADLEN  54
 
-#define IP4_ASSEMLE_HASH_SIZE  31
+#define IP4_ASSEMLE_HASH_SIZE  127
 #define IP4_FRAGMENT_LIFE      120
 #define IP4_MAX_PACKET_SIZE    65535
 
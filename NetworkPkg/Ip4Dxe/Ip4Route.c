@@ -142,6 +142,8 @@ Ip4InitRouteCache (
   for (Index = 0; Index < IP4_ROUTE_CACHE_HASH_VALUE; Index++) {
     InitializeListHead (&(RtCache->CacheBucket[Index]));
   }
+
+  RtCache->LastHit = NULL;
 }
 
 
@@ -170,6 +172,8 @@ Ip4CleanRouteCache (
       Ip4FreeRouteCacheEntry (RtCacheEntry);
     }
   }
+
+  RtCache->LastHit = NULL;
 }
 
 
@@ -278,6 +282,10 @@ Ip4PurgeRouteCache (
       RtCacheEntry = NET_LIST_USER_STRUCT (Entry, IP4_ROUTE_CACHE_ENTRY, Link);
 
       if (RtCacheEntry->Tag == Tag) {
+        if (RtCache->LastHit == RtCacheEntry) {
+          RtCache->LastHit = NULL;
+        }
+
         RemoveEntryList (Entry);
         Ip4FreeRouteCacheEntry (RtCacheEntry);
       }
@@ -518,6 +526,16 @@ Ip4Route (
 
   ASSERT (RtTable != NULL);
 
+  //
+  // Consecutive packets usually go to the same destination, check the
+  // last hit first.
+  //
+  RtCacheEntry = RtTable->Cache.LastHit;
+  if ((RtCacheEntry != NULL) && (RtCacheEntry->Dest == Dest) && (RtCacheEntry->Src == Src)) {
+    NET_GET_REF (RtCacheEntry);
+    return RtCacheEntry;
+  }
+
   Head          = &RtTable->Cache.CacheBucket[IP4_ROUTE_CACHE_HASH (Dest, Src)];
   RtCacheEntry  = Ip4FindRouteCache (RtTable, Dest, Src);
 
@@ -527,6 +545,7 @@ Ip4Route (
   if (RtCacheEntry != NULL) {
     RemoveEntryList (&RtCacheEntry->Link);
     InsertHeadList (Head, &RtCacheEntry->Link);
+    RtTable->Cache.LastHit = RtCacheEntry;
     return RtCacheEntry;
   }
 
@@ -575,6 +594,7 @@ Ip4Route (
 
   InsertHeadList (Head, &RtCacheEntry->Link);
   NET_GET_REF (RtCacheEntry);
+  RtTable->Cache.LastHit = RtCacheEntry;
 
   //
   // Each bucket of route cache can contain at most 64 entries.
@@ -588,6 +608,9 @@ Ip4Route (
     }
 
     Cache = NET_LIST_USER_STRUCT (Entry, IP4_ROUTE_CACHE_ENTRY, Link);
+    if (RtTable->Cache.LastHit == Cache) {
+      RtTable->Cache.LastHit = NULL;
+    }
 
     RemoveEntryList (Entry);
     Ip4FreeRouteCacheEntry (Cache);
@@ -62,6 +62,13 @@ typedef struct {
 ///
 typedef struct {
   LIST_ENTRY                CacheBucket[IP4_ROUTE_CACHE_HASH_VALUE];
+
+  //
+  // The entry returned by the latest Ip4Route() call, checked before the
+  // hash buckets. It holds no reference of its own; it is reset whenever
+  // the entry leaves the cache.
+  //
+  IP4_ROUTE_CACHE_ENTRY     *LastHit;
 } IP4_ROUTE_CACHE;
 
 ///
@@ -13,6 +13,248 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Library/BaseMemoryLib.h>
 #include <Library/UefiBootServicesTableLib.h>
 #include <Library/MemoryAllocationLib.h>
+#include <Library/PcdLib.h>
+
+//
+// NET_BUF and NET_VECTOR structures with up to NET_BUF_POOL_CLASSES
+// NET_BLOCK_OP or NET_BLOCK are recycled through per-size free lists
+// instead of going back to the memory services on every packet.
+//
+#define NET_BUF_POOL_CLASSES  4
+
+typedef struct _NET_POOL_ENTRY NET_POOL_ENTRY;
+
+//
+// A cached structure is linked through its first bytes, which also
+// wipes its signature while it sits on the free list.
+//
+struct _NET_POOL_ENTRY {
+  NET_POOL_ENTRY            *Next;
+};
+
+typedef struct {
+  NET_POOL_ENTRY            *Head;
+  UINT32                    Count;  // Number of entries on the free list
+  UINT64                    Hit;    // Allocations served from the free list
+  UINT64                    Miss;   // Allocations passed to the memory services
+} NET_POOL;
+
+//
+// Entry N caches the structures with N + 1 blocks.
+//
+NET_POOL  mNetbufPool[NET_BUF_POOL_CLASSES];
+NET_POOL  mNetVectorPool[NET_BUF_POOL_CLASSES];
+
+/**
+  Allocate a NET_BUF or NET_VECTOR structure, from the free list of its size
+  class if one is available.
+
+  @param[in]  Pool           The free lists of the structure type.
+  @param[in]  Num            The number of blocks in the structure.
+  @param[in]  Size           The size of the structure in bytes.
+
+  @return                    Pointer to the structure, or NULL if the allocation
+                             failed due to resource limit. The content is not
+                             initialized.
+
+**/
+VOID *
+NetbufPoolAllocate (
+  IN NET_POOL               *Pool,
+  IN UINT32                 Num,
+  IN UINTN                  Size
+  )
+{
+  NET_POOL_ENTRY            *Entry;
+  EFI_TPL                   OldTpl;
+
+  if ((Num == 0) || (Num > NET_BUF_POOL_CLASSES)) {
+    return AllocatePool (Size);
+  }
+
+  Pool   = &Pool[Num - 1];
+  OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+
+  Entry = Pool->Head;
+
+  if (Entry != NULL) {
+    Pool->Head = Entry->Next;
+    Pool->Count--;
+    Pool->Hit++;
+  } else {
+    Pool->Miss++;
+  }
+
+  gBS->RestoreTPL (OldTpl);
+
+  if (Entry == NULL) {
+    return AllocatePool (Size);
+  }
+
+  return Entry;
+}
+
+/**
+  Release a NET_BUF or NET_VECTOR structure. It is kept on the free list of
+  its size class unless the list has reached PcdNetBufPoolHighWaterMark.
+
+  @param[in]  Pool           The free lists of the structure type.
+  @param[in]  Num            The number of blocks in the structure.
+  @param[in]  Buffer         The structure to release.
+
+**/
+VOID
+NetbufPoolFree (
+  IN NET_POOL               *Pool,
+  IN UINT32                 Num,
+  IN VOID                   *Buffer
+  )
+{
+  NET_POOL_ENTRY            *Entry;
+  EFI_TPL                   OldTpl;
+
+  if ((Num != 0) && (Num <= NET_BUF_POOL_CLASSES)) {
+    Pool   = &Pool[Num - 1];
+    OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+
+    if (Pool->Count < PcdGet32 (PcdNetBufPoolHighWaterMark)) {
+      Entry       = (NET_POOL_ENTRY *) Buffer;
+      Entry->Next = Pool->Head;
+      Pool->Head  = Entry;
+      Pool->Count++;
+      Buffer      = NULL;
+    }
+
+    gBS->RestoreTPL (OldTpl);
+  }
+
+  if (Buffer != NULL) {
+    FreePool (Buffer);
+  }
+}
+
+/**
+  Free all the structures cached on the free lists.
+
+  @param[in]  Pool           The free lists of the structure type.
+
+**/
+VOID
+NetbufPoolDrain (
+  IN NET_POOL               *Pool
+  )
+{
+  NET_POOL_ENTRY            *Entry;
+  UINT32                    Index;
+
+  for (Index = 0; Index < NET_BUF_POOL_CLASSES; Index++) {
+    while (Pool[Index].Head != NULL) {
+      Entry             = Pool[Index].Head;
+      Pool[Index].Head  = Entry->Next;
+      FreePool (Entry);
+    }
+
+    Pool[Index].Count = 0;
+  }
+}
+
+/**
+  Release a NET_BUF structure, the associated vector isn't touched.
+
+  @param[in]  Nbuf           Pointer to the NET_BUF to release.
+
+**/
+VOID
+NetbufReleaseStruct (
+  IN NET_BUF                *Nbuf
+  )
+{
+  NetbufPoolFree (mNetbufPool, Nbuf->BlockOpNum, Nbuf);
+}
+
+/**
+  Release a NET_VECTOR structure, the blocks it refers to aren't touched.
+
+  @param[in]  Vector         Pointer to the NET_VECTOR to release.
+
+**/
+VOID
+NetbufReleaseVector (
+  IN NET_VECTOR             *Vector
+  )
+{
+  NetbufPoolFree (mNetVectorPool, Vector->BlockNum, Vector);
+}
+
+/**
+  Retrieve the hit and occupancy counters of the NET_BUF and NET_VECTOR
+  free lists of the calling module.
+
+  @param[out]  Statistics    Pointer to the buffer to receive the counters.
+
+**/
+VOID
+EFIAPI
+NetbufGetPoolStatistics (
+  OUT NET_BUF_POOL_STATISTICS  *Statistics
+  )
+{
+  EFI_TPL                   OldTpl;
+  UINT32                    Index;
+
+  ASSERT (Statistics != NULL);
+
+  ZeroMem (Statistics, sizeof (NET_BUF_POOL_STATISTICS));
+
+  OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+
+  for (Index = 0; Index < NET_BUF_POOL_CLASSES; Index++) {
+    Statistics->NetbufHit     += mNetbufPool[Index].Hit;
+    Statistics->NetbufMiss    += mNetbufPool[Index].Miss;
+    Statistics->NetbufCached  += mNetbufPool[Index].Count;
+    Statistics->VectorHit     += mNetVectorPool[Index].Hit;
+    Statistics->VectorMiss    += mNetVectorPool[Index].Miss;
+    Statistics->VectorCached  += mNetVectorPool[Index].Count;
+  }
+
+  gBS->RestoreTPL (OldTpl);
+}
+
+/**
+  The destructor releases the NET_BUF and NET_VECTOR structures that are
+  still cached when the module is unloaded.
+
+  @param[in]  ImageHandle    The firmware allocated handle for the EFI image.
+  @param[in]  SystemTable    A pointer to the EFI System Table.
+
+  @retval EFI_SUCCESS        The destructor always returns EFI_SUCCESS.
+
+**/
+EFI_STATUS
+EFIAPI
+NetbufPoolDestructor (
+  IN EFI_HANDLE             ImageHandle,
+  IN EFI_SYSTEM_TABLE       *SystemTable
+  )
+{
+  NET_BUF_POOL_STATISTICS   Statistics;
+
+  NetbufGetPoolStatistics (&Statistics);
+
+  DEBUG ((
+    DEBUG_INFO,
+    "NetbufPool: NET_BUF hit %ld miss %ld, NET_VECTOR hit %ld miss %ld\n",
+    Statistics.NetbufHit,
+    Statistics.NetbufMiss,
+    Statistics.VectorHit,
+    Statistics.VectorMiss
+    ));
+
+  NetbufPoolDrain (mNetbufPool);
+  NetbufPoolDrain (mNetVectorPool);
+
+  return EFI_SUCCESS;
+}
 
 
 /**
@@ -43,24 +285,28 @@ NetbufAllocStruct (
   //
   // Allocate three memory blocks.
   //
-  Nbuf = AllocateZeroPool (NET_BUF_SIZE (BlockOpNum));
+  Nbuf = NetbufPoolAllocate (mNetbufPool, BlockOpNum, NET_BUF_SIZE (BlockOpNum));
 
   if (Nbuf == NULL) {
     return NULL;
   }
 
+  ZeroMem (Nbuf, NET_BUF_SIZE (BlockOpNum));
+
   Nbuf->Signature           = NET_BUF_SIGNATURE;
   Nbuf->RefCnt              = 1;
   Nbuf->BlockOpNum          = BlockOpNum;
   InitializeListHead (&Nbuf->List);
 
   if (BlockNum != 0) {
-    Vector = AllocateZeroPool (NET_VECTOR_SIZE (BlockNum));
+    Vector = NetbufPoolAllocate (mNetVectorPool, BlockNum, NET_VECTOR_SIZE (BlockNum));
 
     if (Vector == NULL) {
       goto FreeNbuf;
     }
 
+    ZeroMem (Vector, NET_VECTOR_SIZE (BlockNum));
+
     Vector->Signature = NET_VECTOR_SIGNATURE;
     Vector->RefCnt    = 1;
     Vector->BlockNum  = BlockNum;
@@ -71,7 +317,7 @@ NetbufAllocStruct (
 
 FreeNbuf:
 
-  FreePool (Nbuf);
+  NetbufReleaseStruct (Nbuf);
   return NULL;
 }
 
@@ -126,7 +372,8 @@ NetbufAlloc (
   return Nbuf;
 
 FreeNBuf:
-  FreePool (Nbuf);
+  NetbufReleaseVector (Nbuf->Vector);
+  NetbufReleaseStruct (Nbuf);
   return NULL;
 }
 
@@ -178,7 +425,7 @@ NetbufFreeVector (
     }
   }
 
-  FreePool (Vector);
+  NetbufReleaseVector (Vector);
 }
 
 
@@ -212,7 +459,7 @@ NetbufFree (
     // all the sharing of Nbuf increse Vector's RefCnt by one
     //
     NetbufFreeVector (Nbuf->Vector);
-    FreePool (Nbuf);
+    NetbufReleaseStruct (Nbuf);
   }
 }
 
@@ -239,7 +486,7 @@ NetbufClone (
 
   NET_CHECK_SIGNATURE (Nbuf, NET_BUF_SIGNATURE);
 
-  Clone = AllocatePool (NET_BUF_SIZE (Nbuf->BlockOpNum));
+  Clone = NetbufPoolAllocate (mNetbufPool, Nbuf->BlockOpNum, NET_BUF_SIZE (Nbuf->BlockOpNum));
 
   if (Clone == NULL) {
     return NULL;
@@ -679,7 +926,8 @@ NetbufGetFragment (
 
 FreeChild:
 
-  FreePool (Child);
+  NetbufReleaseVector (Child->Vector);
+  NetbufReleaseStruct (Child);
   return NULL;
 }
 
@@ -1640,50 +1888,130 @@ NetbufQueFlush (
 
 
 /**
-  Compute the checksum for a bulk of data.
+  Sum a 16-bit aligned bulk of data into a 64-bit accumulator.
 
-  @param[in]   Bulk                  Pointer to the data.
+  The data is summed 32 bits at a time, four words per iteration, once the
+  pointer is 32-bit aligned. A 64-bit accumulator can't overflow for any
+  UINT32 length, so the end-around carries are deferred to the final fold.
+
+  @param[in]   Bulk                  Pointer to the data, 16-bit aligned.
   @param[in]   Len                   Length of the data, in bytes.
 
-  @return    The computed checksum.
+  @return    The unfolded sum of the data.
 
 **/
-UINT16
-EFIAPI
-NetblockChecksum (
+UINT64
+NetblockSum (
   IN UINT8                  *Bulk,
   IN UINT32                 Len
   )
 {
-  register UINT32           Sum;
+  UINT64                    Sum;
+  UINT32                    *Word;
+
+  ASSERT ((Len == 0) || (((UINTN) Bulk & 0x01) == 0));
 
   Sum = 0;
 
-  //
-  // Add left-over byte, if any
-  //
-  if (Len % 2 != 0) {
-    Sum += *(Bulk + Len - 1);
+  if ((((UINTN) Bulk & 0x02) != 0) && (Len >= 2)) {
+    Sum  += *(UINT16 *) Bulk;
+    Bulk += 2;
+    Len  -= 2;
+  }
+
+  Word = (UINT32 *) Bulk;
+
+  while (Len >= 16) {
+    Sum  += Word[0];
+    Sum  += Word[1];
+    Sum  += Word[2];
+    Sum  += Word[3];
+    Word += 4;
+    Len  -= 16;
+  }
+
+  while (Len >= 4) {
+    Sum += *Word;
+    Word++;
+    Len -= 4;
   }
 
-  while (Len > 1) {
-    Sum += *(UINT16 *) Bulk;
+  Bulk = (UINT8 *) Word;
+
+  if (Len >= 2) {
+    Sum  += *(UINT16 *) Bulk;
     Bulk += 2;
-    Len -= 2;
+    Len  -= 2;
   }
 
   //
-  // Fold 32-bit sum to 16 bits
+  // Add left-over byte, if any
   //
-  while ((Sum >> 16) != 0) {
-    Sum = (Sum & 0xffff) + (Sum >> 16);
+  if (Len != 0) {
+    Sum += *Bulk;
+  }
+
+  return Sum;
+}
+
+
+/**
+  Fold a 64-bit sum to a 16-bit ones' complement sum.
+
+  @param[in]   Sum                   The sum to fold.
+
+  @return    The folded sum.
 
+**/
+UINT16
+NetFoldChecksum (
+  IN UINT64                 Sum
+  )
+{
+  Sum = (Sum & 0xffffffff) + RShiftU64 (Sum, 32);
+  Sum = (Sum & 0xffffffff) + RShiftU64 (Sum, 32);
+
+  while (((UINT32) Sum >> 16) != 0) {
+    Sum = ((UINT32) Sum & 0xffff) + ((UINT32) Sum >> 16);
   }
 
   return (UINT16) Sum;
 }
 
 
+/**
+  Compute the checksum for a bulk of data.
+
+  @param[in]   Bulk                  Pointer to the data.
+  @param[in]   Len                   Length of the data, in bytes.
+
+  @return    The computed checksum.
+
+**/
+UINT16
+EFIAPI
+NetblockChecksum (
+  IN UINT8                  *Bulk,
+  IN UINT32                 Len
+  )
+{
+  UINT16                    Sum;
+
+  if ((((UINTN) Bulk & 0x01) == 0) || (Len == 0)) {
+    return NetFoldChecksum (NetblockSum (Bulk, Len));
+  }
+
+  //
+  // Sum from the next 16-bit boundary. The bytes after the first one
+  // land in the opposite halves of the 16-bit words, so swap that sum
+  // back before adding the first byte.
+  //
+  Sum = SwapBytes16 (NetFoldChecksum (NetblockSum (Bulk + 1, Len - 1)));
+
+  return NetAddChecksum (Sum, *Bulk);
+}
+
+
 /**
   Add two checksums.
 
@@ -1883,8 +2211,8 @@ NetIpSecNetbufFree (
     if ((Nbuf->Vector->Flag & NET_VECTOR_OWN_FIRST) != 0) {
       FreePool (Nbuf->Vector->Block[0].Bulk);
     }
-    FreePool (Nbuf->Vector);
-    FreePool (Nbuf);
+    NetbufReleaseVector (Nbuf->Vector);
+    NetbufReleaseStruct (Nbuf);
   }
 }
 
@@ -69,6 +69,12 @@ typedef struct {
 
   EFI_EVENT                     PollTimer;
   BOOLEAN                       EnableSystemPoll;
+  //
+  // The poll timer runs at MNP_SYS_POLL_FAST_INTERVAL while packets arrive,
+  // and at MNP_SYS_POLL_INTERVAL after MNP_SYS_POLL_IDLE_LIMIT idle polls.
+  //
+  BOOLEAN                       FastSystemPoll;
+  UINT32                        IdleSystemPollCount;
 
   EFI_EVENT                     TimeoutCheckTimer;
   EFI_EVENT                     MediaDetectTimer;
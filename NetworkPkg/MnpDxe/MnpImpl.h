@@ -14,6 +14,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #define NET_ETHER_FCS_SIZE            4
 
 #define MNP_SYS_POLL_INTERVAL         (10 * TICKS_PER_MS)   // 10 milliseconds
+#define MNP_SYS_POLL_FAST_INTERVAL    (1 * TICKS_PER_MS)    // 1 millisecond
 #define MNP_TIMEOUT_CHECK_INTERVAL    (50 * TICKS_PER_MS)   // 50 milliseconds
 #define MNP_MEDIA_DETECT_INTERVAL     (500 * TICKS_PER_MS)  // 500 milliseconds
 #define MNP_TX_TIMEOUT_TIME           (500 * TICKS_PER_MS)  // 500 milliseconds
@@ -25,6 +26,14 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #define MNP_MAX_RCVD_PACKET_QUE_SIZE  256
 
+//
+// The maximum number of frames drained from the SNP in one poll, and the
+// number of consecutive idle system polls after which the poll timer falls
+// back from MNP_SYS_POLL_FAST_INTERVAL to MNP_SYS_POLL_INTERVAL.
+//
+#define MNP_RX_POLL_BUDGET            32
+#define MNP_SYS_POLL_IDLE_LIMIT       10
+
 #define MNP_RECEIVE_UNICAST           0x01
 #define MNP_RECEIVE_BROADCAST         0x02
 
@@ -430,6 +439,24 @@ MnpReceivePacket (
   IN OUT MNP_DEVICE_DATA   *MnpDeviceData
   );
 
+/**
+  Receive and deliver up to MNP_RX_POLL_BUDGET packets, stopping as soon as
+  the SNP has no more packets.
+
+  @param[in, out]  MnpDeviceData        Pointer to the mnp device context data.
+  @param[out]      Received             The number of packets received.
+
+  @retval EFI_SUCCESS           At least one packet was received.
+  @retval Others                The status of the first MnpReceivePacket()
+                                call, which did not receive a packet.
+
+**/
+EFI_STATUS
+MnpReceivePackets (
+  IN OUT MNP_DEVICE_DATA   *MnpDeviceData,
+     OUT UINTN             *Received
+  );
+
 /**
   Allocate a free NET_BUF from MnpDeviceData->FreeNbufQue. If there is none
   in the queue, first try to allocate some and add them into the queue, then
@@ -1001,6 +1001,39 @@ EXIT:
 }
 
 
+/**
+  Receive and deliver up to MNP_RX_POLL_BUDGET packets, stopping as soon as
+  the SNP has no more packets.
+
+  @param[in, out]  MnpDeviceData        Pointer to the mnp device context data.
+  @param[out]      Received             The number of packets received.
+
+  @retval EFI_SUCCESS           At least one packet was received.
+  @retval Others                The status of the first MnpReceivePacket()
+                                call, which did not receive a packet.
+
+**/
+EFI_STATUS
+MnpReceivePackets (
+  IN OUT MNP_DEVICE_DATA   *MnpDeviceData,
+     OUT UINTN             *Received
+  )
+{
+  EFI_STATUS  Status;
+
+  *Received = 0;
+  do {
+    Status = MnpReceivePacket (MnpDeviceData);
+    if (EFI_ERROR (Status)) {
+      break;
+    }
+    (*Received)++;
+  } while (*Received < MNP_RX_POLL_BUDGET);
+
+  return (*Received > 0) ? EFI_SUCCESS : Status;
+}
+
+
 /**
   Remove the received packets if timeout occurs.
 
@@ -1117,6 +1150,7 @@ MnpSystemPoll (
   )
 {
   MNP_DEVICE_DATA  *MnpDeviceData;
+  UINTN            Received;
 
   MnpDeviceData = (MNP_DEVICE_DATA *) Context;
   NET_CHECK_SIGNATURE (MnpDeviceData, MNP_DEVICE_DATA_SIGNATURE);
@@ -1124,7 +1158,25 @@ MnpSystemPoll (
   //
   // Try to receive packets from Snp.
   //
-  MnpReceivePacket (MnpDeviceData);
+  MnpReceivePackets (MnpDeviceData, &Received);
+
+  //
+  // Poll faster while packets keep arriving, and slow down again once the
+  // link has been idle for a while.
+  //
+  if (Received > 0) {
+    MnpDeviceData->IdleSystemPollCount = 0;
+    if (!MnpDeviceData->FastSystemPoll &&
+        !EFI_ERROR (gBS->SetTimer (MnpDeviceData->PollTimer, TimerPeriodic, MNP_SYS_POLL_FAST_INTERVAL))) {
+      MnpDeviceData->FastSystemPoll = TRUE;
+    }
+  } else if (MnpDeviceData->FastSystemPoll &&
+             ++MnpDeviceData->IdleSystemPollCount >= MNP_SYS_POLL_IDLE_LIMIT) {
+    if (!EFI_ERROR (gBS->SetTimer (MnpDeviceData->PollTimer, TimerPeriodic, MNP_SYS_POLL_INTERVAL))) {
+      MnpDeviceData->FastSystemPoll = FALSE;
+    }
+    MnpDeviceData->IdleSystemPollCount = 0;
+  }
 
   //
   // Dispatch the DPC queued by the NotifyFunction of rx token's events.
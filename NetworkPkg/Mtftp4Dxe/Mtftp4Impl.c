@@ -77,6 +77,7 @@ Mtftp4CleanOperation (
   Instance->WindowSize    = 1;
   Instance->TotalBlock    = 0;
   Instance->AckedBlock    = 0;
+  Instance->OutOfOrderBlocks = 0;
   Instance->LastBlock     = 0;
   Instance->ServerIp      = 0;
   Instance->ListeningPort = 0;
@@ -129,6 +129,11 @@ struct _MTFTP4_PROTOCOL {
   //
   UINT64                        AckedBlock;
 
+  //
+  // Record the out-of-order blocks received since the last in-order one.
+  //
+  UINT64                        OutOfOrderBlocks;
+
   //
   // The server's communication end point: IP and two ports. one for
   // initial request, one for its selected port.
@@ -86,6 +86,11 @@ struct _MTFTP6_INSTANCE {
   //
   UINT64                        AckedBlock;
 
+  //
+  // Record the out-of-order blocks received since the last in-order one.
+  //
+  UINT64                        OutOfOrderBlocks;
+
   EFI_IPv6_ADDRESS              ServerIp;
   UINT16                        ServerCmdPort;
   UINT16                        ServerDataPort;
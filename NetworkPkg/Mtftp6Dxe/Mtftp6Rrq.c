@@ -237,6 +237,11 @@ Mtftp6RrqHandleData (
   // the ACK for the block we received, then restart receiving the
   // expected one. If we are passive (Slave), save the block.
   //
+  // With a window, the blocks following a lost one arrive out of order as
+  // well. Only the first of each window's worth of them is acknowledged,
+  // one ACK is enough for the server to resend from the lost block, and
+  // a duplicate ACK per block would make it restart the window repeatedly.
+  //
   if (Instance->IsMaster && (Expected != BlockNum)) {
     //
     // Free the received packet before send new packet in ReceiveNotify,
@@ -245,6 +250,10 @@ Mtftp6RrqHandleData (
     NetbufFree (*UdpPacket);
     *UdpPacket = NULL;
 
+    if ((Instance->OutOfOrderBlocks++ % Instance->WindowSize) != 0) {
+      return EFI_SUCCESS;
+    }
+
     //
     // If Expected is 0, (UINT16) (Expected - 1) is also the expected Ack number (65535).
     //
@@ -257,6 +266,8 @@ Mtftp6RrqHandleData (
     return Status;
   }
 
+  Instance->OutOfOrderBlocks = 0;
+
   //
   // Record the total received and saved block number.
   //
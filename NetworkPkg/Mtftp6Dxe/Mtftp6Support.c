@@ -977,6 +977,7 @@ Mtftp6OperationClean (
   Instance->WindowSize     = 1;
   Instance->TotalBlock     = 0;
   Instance->AckedBlock     = 0;
+  Instance->OutOfOrderBlocks = 0;
   Instance->LastBlk        = 0;
   Instance->PacketToLive   = 0;
   Instance->MaxRetry       = 0;
@@ -378,6 +378,86 @@ TcpTrimInWnd (
   return TcpTrimSegment (Nbuf, Tcb->RcvNxt, Tcb->RcvWl2 + Tcb->RcvWnd);
 }
 
+/**
+  Record duplicate data to report in a D-SACK block of the next ACK, as
+  specified in RFC2883.
+
+  @param[in, out]  Tcb      Pointer to the TCP_CB of this TCP instance.
+  @param[in]       Left     The start sequence of the duplicate data.
+  @param[in]       Right    The end sequence of the duplicate data.
+
+**/
+VOID
+TcpSetDSack (
+  IN OUT TCP_CB    *Tcb,
+  IN     TCP_SEQNO Left,
+  IN     TCP_SEQNO Right
+  )
+{
+  if (!TCP_FLG_ON (Tcb->CtrlFlag, TCP_CTRL_SND_SACK) || TCP_SEQ_LEQ (Right, Left)) {
+    return;
+  }
+
+  Tcb->DSackSeq = Left;
+  Tcb->DSackEnd = Right;
+  TCP_SET_FLG (Tcb->CtrlFlag, TCP_CTRL_SND_DSACK);
+  TCP_SET_FLG (Tcb->CtrlFlag, TCP_CTRL_ACK_NOW);
+}
+
+/**
+  Grow the receive buffer when the peer has filled the advertised
+  window while the application keeps up with the received data.
+
+  The receive buffer size configured by the application is the initial
+  size, it is doubled up to TCP_RCV_BUF_SIZE, or up to what the window
+  scale negotiated can advertise. The buffer is a limit rather than an
+  allocation, so a larger size costs nothing as long as the data is
+  consumed.
+
+  @param[in, out]  Tcb      Pointer to the TCP_CB of this TCP instance.
+  @param[in]       Seg      Pointer to the segment just received, trimmed
+                            to the receive window.
+
+**/
+VOID
+TcpTuneRcvBuffer (
+  IN OUT TCP_CB  *Tcb,
+  IN     TCP_SEG *Seg
+  )
+{
+  SOCKET  *Sk;
+  UINT32  BufSize;
+  UINT32  MaxSize;
+
+  Sk = Tcb->Sk;
+
+  if (!TCP_FLG_ON (Tcb->CtrlFlag, TCP_CTRL_RCVD_WS) ||
+      TCP_SEQ_LT (Seg->End, Tcb->RcvWl2 + Tcb->RcvWnd)) {
+    return;
+  }
+
+  BufSize = GET_RCV_BUFFSIZE (Sk);
+  MaxSize = MIN (TCP_RCV_BUF_SIZE, (UINT32) TCP_OPTION_MAX_WIN << Tcb->RcvWndScale);
+
+  if ((BufSize >= MaxSize) || (GET_RCV_DATASIZE (Sk) > BufSize / 2)) {
+    return;
+  }
+
+  SET_RCV_BUFFSIZE (Sk, MIN (BufSize * 2, MaxSize));
+
+  //
+  // Open the window right away, the peer is waiting for it.
+  //
+  TCP_SET_FLG (Tcb->CtrlFlag, TCP_CTRL_ACK_NOW);
+
+  DEBUG (
+    (EFI_D_NET,
+    "TcpTuneRcvBuffer: receive buffer of TCB %p grows to %d\n",
+    Tcb,
+    GET_RCV_BUFFSIZE (Sk))
+    );
+}
+
 /**
   Process the data and FIN flag, and check whether to deliver
   data to the socket layer.
@@ -593,6 +673,10 @@ TcpQueueData (
   Seg   = TCPSEG_NETBUF (Nbuf);
   Head  = &Tcb->RcvQue;
 
+  if (TCP_SEQ_GT (Seg->Seq, Tcb->RcvNxt)) {
+    Tcb->SackRecent = Seg->Seq;
+  }
+
   //
   // Fast path to process normal case. That is,
   // no out-of-order segments are received.
@@ -627,6 +711,7 @@ TcpQueueData (
     if (TCP_SEQ_LT (Seg->Seq, TCPSEG_NETBUF (Node)->End)) {
 
       if (TCP_SEQ_LEQ (Seg->End, TCPSEG_NETBUF (Node)->End)) {
+        TcpSetDSack (Tcb, Seg->Seq, Seg->End);
         return 1;
       }
 
@@ -1076,6 +1161,13 @@ TcpInput (
       );
 
     if (!TCP_FLG_ON (Seg->Flag, TCP_FLG_RST)) {
+      //
+      // Report the retransmitted data that has been received already.
+      //
+      if ((Seg->End != Seg->Seq) && TCP_SEQ_LEQ (Seg->End, Tcb->RcvNxt)) {
+        TcpSetDSack (Tcb, Seg->Seq, Seg->End);
+      }
+
       TcpSendAck (Tcb);
     }
 
@@ -1122,8 +1214,14 @@ TcpInput (
   }
 
   //
-  // Trim the data and flags.
+  // Report the duplicate head of a partially retransmitted segment,
+  // then trim the data and flags.
   //
+  if ((Seg->End != Seg->Seq) && TCP_SEQ_LT (Seg->Seq, Tcb->RcvNxt) &&
+      !TCP_FLG_ON (Seg->Flag, TCP_FLG_SYN)) {
+    TcpSetDSack (Tcb, Seg->Seq, Tcb->RcvNxt);
+  }
+
   if (TcpTrimInWnd (Tcb, Nbuf) == 0) {
     DEBUG (
       (EFI_D_ERROR,
@@ -1563,6 +1661,8 @@ StepSix:
       goto RESET_THEN_DROP;
     }
 
+    TcpTuneRcvBuffer (Tcb, Seg);
+
     if (!IsListEmpty (&Tcb->RcvQue)) {
       TCP_SET_FLG (Tcb->CtrlFlag, TCP_CTRL_ACK_NOW);
     }
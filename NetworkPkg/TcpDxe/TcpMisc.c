@@ -81,6 +81,7 @@ TcpInitTcbLocal (
   //
   Tcb->RcvWndScale  = 0;
   Tcb->RetxmitSeqMax = 0;
+  TCP_CLEAR_FLG (Tcb->CtrlFlag, TCP_CTRL_SND_SACK | TCP_CTRL_SND_DSACK);
 
   Tcb->ProbeTimerOn = FALSE;
 }
@@ -151,6 +152,12 @@ TcpInitTcbPeer (
     Tcb->RcvWndScale = 0;
   }
 
+  if (TCP_FLG_ON (Opt->Flag, TCP_OPTION_RCVD_SACK_PERM) && !TCP_FLG_ON (Tcb->CtrlFlag, TCP_CTRL_NO_SACK)) {
+
+    TCP_SET_FLG (Tcb->CtrlFlag, TCP_CTRL_SND_SACK);
+    Tcb->SackRecent = Tcb->RcvNxt;
+  }
+
   if (TCP_FLG_ON (Opt->Flag, TCP_OPTION_RCVD_TS) && !TCP_FLG_ON (Tcb->CtrlFlag, TCP_CTRL_NO_TS)) {
 
     TCP_SET_FLG (Tcb->CtrlFlag, TCP_CTRL_SND_TS);
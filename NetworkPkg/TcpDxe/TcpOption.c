@@ -80,7 +80,11 @@ TcpComputeScale (
 
   ASSERT ((Tcb != NULL) && (Tcb->Sk != NULL));
 
-  BufSize = GET_RCV_BUFFSIZE (Tcb->Sk);
+  //
+  // Leave room for the receive buffer to grow up to TCP_RCV_BUF_SIZE,
+  // the scale can't be changed once the connection is established.
+  //
+  BufSize = MAX (GET_RCV_BUFFSIZE (Tcb->Sk), TCP_RCV_BUF_SIZE);
 
   Scale   = 0;
   while ((Scale < TCP_OPTION_MAX_WS) && ((UINT32) (TCP_OPTION_MAX_WIN << Scale) < BufSize)) {
@@ -159,6 +163,27 @@ TcpSynBuildOption (
     TcpPutUint32 (Data, TCP_OPTION_WS_FAST | TcpComputeScale (Tcb));
   }
 
+  //
+  // Build SACK permitted option, under the same rule
+  // as the window scale option.
+  //
+  if (!TCP_FLG_ON (Tcb->CtrlFlag, TCP_CTRL_NO_SACK) &&
+      (!TCP_FLG_ON (TCPSEG_NETBUF (Nbuf)->Flag, TCP_FLG_ACK) ||
+        TCP_FLG_ON (Tcb->CtrlFlag, TCP_CTRL_SND_SACK))
+      ) {
+
+    Data = NetbufAllocSpace (
+             Nbuf,
+             TCP_OPTION_SACK_PERM_ALIGNED_LEN,
+             NET_BUF_HEAD
+             );
+
+    ASSERT (Data != NULL);
+
+    Len += TCP_OPTION_SACK_PERM_ALIGNED_LEN;
+    TcpPutUint32 (Data, TCP_OPTION_SACK_PERM_FAST);
+  }
+
   //
   // Build the MSS option.
   //
@@ -171,6 +196,128 @@ TcpSynBuildOption (
   return Len;
 }
 
+/**
+  Build the SACK option to report the out-of-order data in the reassemble
+  queue, preceded by the duplicate data to report if any.
+
+  Per RFC2883, the D-SACK block goes first. Per RFC2018, the next block
+  contains the latest out-of-order segment received, and the other blocks
+  follow in sequence order.
+
+  @param[in, out]  Tcb       Pointer to the TCP_CB of this TCP instance.
+  @param[in]       Nbuf      Pointer to the buffer to store the option.
+  @param[in]       MaxBlock  The maximum number of blocks that fit in the header.
+
+  @return             The length of the SACK option field, 0 if nothing to report.
+
+**/
+UINT16
+TcpBuildSackOption (
+  IN OUT TCP_CB  *Tcb,
+  IN     NET_BUF *Nbuf,
+  IN     UINT8   MaxBlock
+  )
+{
+  TCP_SEQNO   Left[TCP_OPTION_MAX_SACK_BLOCK];
+  TCP_SEQNO   Right[TCP_OPTION_MAX_SACK_BLOCK];
+  TCP_SEQNO   Seq;
+  TCP_SEQNO   End;
+  LIST_ENTRY  *Entry;
+  TCP_SEG     *Seg;
+  UINT8       *Data;
+  UINT8       Count;
+  UINT8       First;
+  UINT8       Recent;
+  UINT8       Index;
+
+  MaxBlock = MIN (MaxBlock, TCP_OPTION_MAX_SACK_BLOCK);
+  Count    = 0;
+  Recent   = MaxBlock;
+
+  if ((MaxBlock > 0) && TCP_FLG_ON (Tcb->CtrlFlag, TCP_CTRL_SND_DSACK)) {
+    Left[0]  = Tcb->DSackSeq;
+    Right[0] = Tcb->DSackEnd;
+    Count    = 1;
+    TCP_CLEAR_FLG (Tcb->CtrlFlag, TCP_CTRL_SND_DSACK);
+  }
+
+  First = Count;
+
+  //
+  // Merge the contiguous segments in the reassemble queue into blocks.
+  // When the blocks don't all fit, keep replacing the last one until
+  // the block of the latest segment is found.
+  //
+  for (Entry = Tcb->RcvQue.ForwardLink; Entry != &Tcb->RcvQue; Entry = Entry->ForwardLink) {
+    Seg = TCPSEG_NETBUF (NET_LIST_USER_STRUCT (Entry, NET_BUF, List));
+
+    if (TCP_SEQ_LEQ (Seg->End, Tcb->RcvNxt)) {
+      continue;
+    }
+
+    if ((Count > First) && TCP_SEQ_LEQ (Seg->Seq, Right[Count - 1])) {
+      if (TCP_SEQ_GT (Seg->End, Right[Count - 1])) {
+        Right[Count - 1] = Seg->End;
+      }
+    } else {
+      if (Count == MaxBlock) {
+        if ((Recent < MaxBlock) || (Count == First)) {
+          break;
+        }
+
+        Count--;
+      }
+
+      Left[Count]  = Seg->Seq;
+      Right[Count] = Seg->End;
+      Count++;
+    }
+
+    if ((Recent == MaxBlock) &&
+        TCP_SEQ_LEQ (Left[Count - 1], Tcb->SackRecent) &&
+        TCP_SEQ_LT (Tcb->SackRecent, Right[Count - 1])) {
+      Recent = (UINT8) (Count - 1);
+    }
+  }
+
+  if (Count == 0) {
+    return 0;
+  }
+
+  //
+  // Move the block of the latest segment to the front.
+  //
+  if ((Recent < Count) && (Recent > First)) {
+    Seq = Left[Recent];
+    End = Right[Recent];
+
+    for (Index = Recent; Index > First; Index--) {
+      Left[Index]  = Left[Index - 1];
+      Right[Index] = Right[Index - 1];
+    }
+
+    Left[First]  = Seq;
+    Right[First] = End;
+  }
+
+  Data = NetbufAllocSpace (
+           Nbuf,
+           (UINT32) (TCP_OPTION_SACK_ALIGNED_LEN + Count * TCP_OPTION_SACK_BLOCK_LEN),
+           NET_BUF_HEAD
+           );
+
+  ASSERT (Data != NULL);
+
+  TcpPutUint32 (Data, TCP_OPTION_SACK_FAST | (2 + Count * TCP_OPTION_SACK_BLOCK_LEN));
+
+  for (Index = 0; Index < Count; Index++) {
+    TcpPutUint32 (Data + TCP_OPTION_SACK_ALIGNED_LEN + Index * TCP_OPTION_SACK_BLOCK_LEN, Left[Index]);
+    TcpPutUint32 (Data + TCP_OPTION_SACK_ALIGNED_LEN + Index * TCP_OPTION_SACK_BLOCK_LEN + 4, Right[Index]);
+  }
+
+  return (UINT16) (TCP_OPTION_SACK_ALIGNED_LEN + Count * TCP_OPTION_SACK_BLOCK_LEN);
+}
+
 /**
   Build the TCP option in synchronized states.
 
@@ -188,9 +335,11 @@ TcpBuildOption (
 {
   UINT8   *Data;
   UINT16  Len;
+  UINT32  DataLen;
 
   ASSERT ((Tcb != NULL) && (Nbuf != NULL) && (Nbuf->Tcp == NULL));
-  Len = 0;
+  Len     = 0;
+  DataLen = Nbuf->TotalSize;
 
   //
   // Build the Timestamp option.
@@ -213,6 +362,22 @@ TcpBuildOption (
     TcpPutUint32 (Data + 8, Tcb->TsRecent);
   }
 
+  //
+  // Build the SACK option. Only pure ACKs carry it, so that
+  // it never cuts into the segment size.
+  //
+  if (TCP_FLG_ON (Tcb->CtrlFlag, TCP_CTRL_SND_SACK) &&
+      (DataLen == 0) &&
+      !TCP_FLG_ON (TCPSEG_NETBUF (Nbuf)->Flag, TCP_FLG_RST)
+      ) {
+
+    Len = (UINT16) (Len + TcpBuildSackOption (
+                            Tcb,
+                            Nbuf,
+                            (UINT8) ((TCP_OPTION_MAX_LEN - Len - TCP_OPTION_SACK_ALIGNED_LEN) / TCP_OPTION_SACK_BLOCK_LEN)
+                            ));
+  }
+
   return Len;
 }
 
@@ -298,6 +463,19 @@ TcpParseOption (
       Cur += TCP_OPTION_WS_LEN;
       break;
 
+    case TCP_OPTION_SACK_PERM:
+      Len = Head[Cur + 1];
+
+      if ((Len != TCP_OPTION_SACK_PERM_LEN) || (TotalLen - Cur < TCP_OPTION_SACK_PERM_LEN)) {
+
+        return -1;
+      }
+
+      TCP_SET_FLG (Option->Flag, TCP_OPTION_RCVD_SACK_PERM);
+
+      Cur += TCP_OPTION_SACK_PERM_LEN;
+      break;
+
     case TCP_OPTION_TS:
       Len = Head[Cur + 1];
 
@@ -72,6 +72,9 @@
 #define TCP_CTRL_TIMER_ON        0x1000 ///< At least one of the timer is on.
 #define TCP_CTRL_RTT_ON          0x2000 ///< The RTT measurement is on.
 #define TCP_CTRL_ACK_NOW         0x4000 ///< Send the ACK now, don't delay.
+#define TCP_CTRL_NO_SACK         0x8000 ///< Disable SACK option.
+#define TCP_CTRL_SND_SACK        0x10000 ///< Both ends agreed on SACK, send SACK blocks.
+#define TCP_CTRL_SND_DSACK       0x20000 ///< Report duplicate data in a D-SACK block.
 
 //
 // Timer related values
@@ -109,7 +112,8 @@
 #define TCP_MAX_HEAD             192
 
 //
-// Value ranges for some control option
+// Value ranges for some control option. TCP_RCV_BUF_SIZE is also the size
+// up to which the receive buffer grows when the peer is window limited.
 //
 #define TCP_RCV_BUF_SIZE         (2 * 1024 * 1024)
 #define TCP_RCV_BUF_SIZE_MIN     (8 * 1024)
@@ -315,6 +319,14 @@ struct _TCP_CONTROL_BLOCK {
   //
   TCP_SEQNO         RetxmitSeqMax;       ///< Max Seq number in previous retransmission.
 
+  //
+  // RFC2018 and RFC2883, about selective acknowledgment
+  // of the received data.
+  //
+  TCP_SEQNO         SackRecent;   ///< Seq of the latest out-of-order segment.
+  TCP_SEQNO         DSackSeq;     ///< Start of the duplicate data to report.
+  TCP_SEQNO         DSackEnd;     ///< End of the duplicate data to report.
+
   //
   // configuration parameters, for EFI_TCP4_PROTOCOL specification
   //
@@ -30,6 +30,8 @@ AmdSevDxeEntryPoint (
   EFI_GCD_MEMORY_SPACE_DESCRIPTOR  *AllDescMap;
   UINTN                            NumEntries;
   UINTN                            Index;
+  MEM_ENCRYPT_SEV_RANGE            *Ranges;
+  UINTN                            RangeCount;
 
   //
   // Do nothing when SEV is not enabled
@@ -39,27 +41,36 @@ AmdSevDxeEntryPoint (
   }
 
   //
-  // Iterate through the GCD map and clear the C-bit from MMIO and NonExistent
-  // memory space. The NonExistent memory space will be used for mapping the
-  // MMIO space added later (eg PciRootBridge). By clearing both known MMIO and
-  // NonExistent memory space can gurantee that current and furture MMIO adds
-  // will have C-bit cleared.
+  // Iterate through the GCD map and collect the MMIO and NonExistent memory
+  // space, for clearing the C-bit. The NonExistent memory space will be used
+  // for mapping the MMIO space added later (eg PciRootBridge). By clearing
+  // both known MMIO and NonExistent memory space can gurantee that current and
+  // furture MMIO adds will have C-bit cleared.
   //
+  // The ranges are updated in one batch; since the GCD map is sorted, adjacent
+  // MMIO and NonExistent entries are merged, and the large pages covering them
+  // need not be split.
+  //
+  Ranges     = NULL;
+  RangeCount = 0;
   Status = gDS->GetMemorySpaceMap (&NumEntries, &AllDescMap);
   if (!EFI_ERROR (Status)) {
-    for (Index = 0; Index < NumEntries; Index++) {
-      CONST EFI_GCD_MEMORY_SPACE_DESCRIPTOR *Desc;
-
-      Desc = &AllDescMap[Index];
-      if (Desc->GcdMemoryType == EfiGcdMemoryTypeMemoryMappedIo ||
-          Desc->GcdMemoryType == EfiGcdMemoryTypeNonExistent) {
-        Status = MemEncryptSevClearPageEncMask (
-                   0,
-                   Desc->BaseAddress,
-                   EFI_SIZE_TO_PAGES (Desc->Length),
-                   FALSE
-                   );
-        ASSERT_EFI_ERROR (Status);
+    //
+    // Reserve one extra element for the MMCONFIG area below.
+    //
+    Ranges = AllocatePool ((NumEntries + 1) * sizeof *Ranges);
+    ASSERT (Ranges != NULL);
+    if (Ranges != NULL) {
+      for (Index = 0; Index < NumEntries; Index++) {
+        CONST EFI_GCD_MEMORY_SPACE_DESCRIPTOR *Desc;
+
+        Desc = &AllDescMap[Index];
+        if (Desc->GcdMemoryType == EfiGcdMemoryTypeMemoryMappedIo ||
+            Desc->GcdMemoryType == EfiGcdMemoryTypeNonExistent) {
+          Ranges[RangeCount].BaseAddress = Desc->BaseAddress;
+          Ranges[RangeCount].NumPages    = EFI_SIZE_TO_PAGES (Desc->Length);
+          RangeCount++;
+        }
       }
     }
 
@@ -73,15 +84,34 @@ AmdSevDxeEntryPoint (
   // the range.
   //
   if (PcdGet16 (PcdOvmfHostBridgePciDevId) == INTEL_Q35_MCH_DEVICE_ID) {
-    Status = MemEncryptSevClearPageEncMask (
+    if (Ranges != NULL) {
+      Ranges[RangeCount].BaseAddress = FixedPcdGet64 (PcdPciExpressBaseAddress);
+      Ranges[RangeCount].NumPages    = EFI_SIZE_TO_PAGES (SIZE_256MB);
+      RangeCount++;
+    } else {
+      Status = MemEncryptSevClearPageEncMask (
+                 0,
+                 FixedPcdGet64 (PcdPciExpressBaseAddress),
+                 EFI_SIZE_TO_PAGES (SIZE_256MB),
+                 FALSE
+                 );
+
+      ASSERT_EFI_ERROR (Status);
+    }
+  }
+
+  if (RangeCount > 0) {
+    Status = MemEncryptSevClearPageEncMaskRanges (
                0,
-               FixedPcdGet64 (PcdPciExpressBaseAddress),
-               EFI_SIZE_TO_PAGES (SIZE_256MB),
+               Ranges,
+               RangeCount,
                FALSE
                );
-
     ASSERT_EFI_ERROR (Status);
   }
+  if (Ranges != NULL) {
+    FreePool (Ranges);
+  }
 
   //
   // When SMM is enabled, clear the C-bit from SMM Saved State Area
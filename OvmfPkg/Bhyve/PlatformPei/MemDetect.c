@@ -511,22 +511,29 @@ QemuInitializeRam (
     SetMem (&MtrrSettings.Fixed, sizeof MtrrSettings.Fixed, 0x06);
     ZeroMem (&MtrrSettings.Variables, sizeof MtrrSettings.Variables);
     MtrrSettings.MtrrDefType |= BIT11 | BIT10 | 6;
-    MtrrSetAllMtrrs (&MtrrSettings);
 
     //
     // Set memory range from 640KB to 1MB to uncacheable
     //
-    Status = MtrrSetMemoryAttribute (BASE_512KB + BASE_128KB,
-               BASE_1MB - (BASE_512KB + BASE_128KB), CacheUncacheable);
+    Status = MtrrSetMemoryAttributeInMtrrSettings (&MtrrSettings,
+               BASE_512KB + BASE_128KB, BASE_1MB - (BASE_512KB + BASE_128KB),
+               CacheUncacheable);
     ASSERT_EFI_ERROR (Status);
 
     //
     // Set memory range from the "top of lower RAM" (RAM below 4GB) to 4GB as
     // uncacheable
     //
-    Status = MtrrSetMemoryAttribute (LowerMemorySize,
-               SIZE_4GB - LowerMemorySize, CacheUncacheable);
+    Status = MtrrSetMemoryAttributeInMtrrSettings (&MtrrSettings,
+               LowerMemorySize, SIZE_4GB - LowerMemorySize, CacheUncacheable);
     ASSERT_EFI_ERROR (Status);
+
+    //
+    // The ranges above were calculated on top of the WB default in the
+    // settings buffer; program the processor only once, so that caching is
+    // disabled for a single MTRR update instead of one per range.
+    //
+    MtrrSetAllMtrrs (&MtrrSettings);
   }
 }
 
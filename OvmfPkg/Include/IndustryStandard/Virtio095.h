@@ -101,7 +101,7 @@ typedef struct {
   volatile UINT16 *Idx;
 
   volatile UINT16 *Ring;      // QueueSize elements
-  volatile UINT16 *UsedEvent; // unused as per negotiation
+  volatile UINT16 *UsedEvent; // VIRTIO_F_RING_EVENT_IDX only
 } VRING_AVAIL;
 
 
@@ -121,7 +121,7 @@ typedef struct {
   volatile UINT16          *Flags;
   volatile UINT16          *Idx;
   volatile VRING_USED_ELEM *UsedElem;   // QueueSize elements
-  volatile UINT16          *AvailEvent; // unused as per negotiation
+  volatile UINT16          *AvailEvent; // VIRTIO_F_RING_EVENT_IDX only
 } VRING_USED;
 
 
@@ -130,7 +130,7 @@ typedef struct {
 //
 #define VRING_DESC_F_NEXT     BIT0 // more descriptors in this request
 #define VRING_DESC_F_WRITE    BIT1 // buffer to be written *by the host*
-#define VRING_DESC_F_INDIRECT BIT2 // unused
+#define VRING_DESC_F_INDIRECT BIT2
 
 #pragma pack(1)
 typedef struct {
@@ -141,13 +141,58 @@ typedef struct {
 } VRING_DESC;
 #pragma pack()
 
+//
+// virtio-1.1, 2.7 Packed Virtqueues (VIRTIO_F_RING_PACKED). The descriptor
+// ring takes the place of all of the descriptor table, the available ring and
+// the used ring. VRING_DESC_F_NEXT, VRING_DESC_F_WRITE and
+// VRING_DESC_F_INDIRECT keep their values.
+//
+#define VRING_PACKED_DESC_F_AVAIL BIT7
+#define VRING_PACKED_DESC_F_USED  BIT15
+
+#pragma pack(1)
+typedef struct {
+  UINT64 Addr;
+  UINT32 Len;
+  UINT16 Id;
+  UINT16 Flags;
+} VRING_PACKED_DESC;
+#pragma pack()
+
+//
+// virtio-1.1, 2.7.14 Event Suppression Structure Format
+//
+#define VRING_PACKED_EVENT_FLAG_ENABLE  0x0
+#define VRING_PACKED_EVENT_FLAG_DISABLE 0x1
+#define VRING_PACKED_EVENT_FLAG_DESC    0x2
+
+#pragma pack(1)
+typedef struct {
+  UINT16 DescEventOffWrap;
+  UINT16 DescEventFlags;
+} VRING_PACKED_EVENT;
+#pragma pack()
+
 typedef struct {
-  UINTN               NumPages;
-  VOID                *Base;     // deallocate only this field
-  volatile VRING_DESC *Desc;     // QueueSize elements
-  VRING_AVAIL         Avail;
-  VRING_USED          Used;
-  UINT16              QueueSize;
+  UINTN                       NumPages;
+  VOID                        *Base;     // deallocate only this field
+  volatile VRING_DESC         *Desc;     // QueueSize elements
+  VRING_AVAIL                 Avail;
+  VRING_USED                  Used;
+  UINT16                      QueueSize;
+  //
+  // The following fields are set up by VirtioRingInitEx(), according to the
+  // negotiated features. With Packed set, Desc, Avail and Used are unused;
+  // PackedDesc, DriverEvent and DeviceEvent are used instead, and NextIdx and
+  // WrapCounter track the position of the next descriptor in the ring.
+  //
+  BOOLEAN                     Packed;
+  BOOLEAN                     EventIdx;
+  volatile VRING_PACKED_DESC  *PackedDesc;  // QueueSize elements
+  volatile VRING_PACKED_EVENT *DriverEvent;
+  volatile VRING_PACKED_EVENT *DeviceEvent;
+  UINT16                      NextIdx;
+  BOOLEAN                     WrapCounter;
 } VRING;
 
 //
@@ -80,5 +80,6 @@ typedef struct {
 //
 #define VIRTIO_F_VERSION_1      BIT32
 #define VIRTIO_F_IOMMU_PLATFORM BIT33
+#define VIRTIO_F_RING_PACKED    BIT34 // virtio-1.1
 
 #endif // _VIRTIO_1_0_H_
@@ -56,6 +56,14 @@ typedef struct _SEC_SEV_ES_WORK_AREA {
   UINT64   EncryptionMask;
 } SEC_SEV_ES_WORK_AREA;
 
+//
+// A memory region passed to the batched encryption mask functions.
+//
+typedef struct {
+  PHYSICAL_ADDRESS  BaseAddress;
+  UINTN             NumPages;
+} MEM_ENCRYPT_SEV_RANGE;
+
 //
 // Memory encryption address range states.
 //
@@ -146,6 +154,67 @@ MemEncryptSevSetPageEncMask (
   IN BOOLEAN                  Flush
   );
 
+/**
+  This function clears memory encryption bit for the memory regions specified
+  by Ranges and RangeCount from the current page table context.
+
+  All regions are updated with a single page table walk setup and a single TLB
+  flush. Regions that start where the previous region ends are merged, so that
+  large pages spanning them are not split needlessly.
+
+  @param[in]  Cr3BaseAddress          Cr3 Base Address (if zero then use
+                                      current CR3)
+  @param[in]  Ranges                  The memory regions to update.
+  @param[in]  RangeCount              The number of elements in Ranges.
+  @param[in]  Flush                   Flush the caches before clearing the bit
+                                      (mostly TRUE except MMIO addresses)
+
+  @retval RETURN_SUCCESS              The attributes were cleared for the
+                                      memory regions.
+  @retval RETURN_INVALID_PARAMETER    RangeCount or the number of pages in a
+                                      region is zero.
+  @retval RETURN_UNSUPPORTED          Clearing the memory encryption attribute
+                                      is not supported
+**/
+RETURN_STATUS
+EFIAPI
+MemEncryptSevClearPageEncMaskRanges (
+  IN PHYSICAL_ADDRESS             Cr3BaseAddress,
+  IN CONST MEM_ENCRYPT_SEV_RANGE  *Ranges,
+  IN UINTN                        RangeCount,
+  IN BOOLEAN                      Flush
+  );
+
+/**
+  This function sets memory encryption bit for the memory regions specified by
+  Ranges and RangeCount from the current page table context.
+
+  All regions are updated with a single page table walk setup and a single TLB
+  flush. Regions that start where the previous region ends are merged, so that
+  large pages spanning them are not split needlessly.
+
+  @param[in]  Cr3BaseAddress          Cr3 Base Address (if zero then use
+                                      current CR3)
+  @param[in]  Ranges                  The memory regions to update.
+  @param[in]  RangeCount              The number of elements in Ranges.
+  @param[in]  Flush                   Flush the caches before setting the bit
+                                      (mostly TRUE except MMIO addresses)
+
+  @retval RETURN_SUCCESS              The attributes were set for the memory
+                                      regions.
+  @retval RETURN_INVALID_PARAMETER    RangeCount or the number of pages in a
+                                      region is zero.
+  @retval RETURN_UNSUPPORTED          Setting the memory encryption attribute
+                                      is not supported
+**/
+RETURN_STATUS
+EFIAPI
+MemEncryptSevSetPageEncMaskRanges (
+  IN PHYSICAL_ADDRESS             Cr3BaseAddress,
+  IN CONST MEM_ENCRYPT_SEV_RANGE  *Ranges,
+  IN UINTN                        RangeCount,
+  IN BOOLEAN                      Flush
+  );
 
 /**
   Locate the page range that covers the initial (pre-SMBASE-relocation) SMRAM
@@ -53,6 +53,48 @@ VirtioRingInit (
   );
 
 
+/**
+
+  Configure a virtio ring according to the negotiated ring features.
+
+  With VIRTIO_F_RING_PACKED present in Features, a packed virtqueue is laid out
+  (virtio-1.1, 2.7 Packed Virtqueues); otherwise a split virtqueue is laid out,
+  exactly as VirtioRingInit() does. With VIRTIO_F_RING_EVENT_IDX present in
+  Features, VirtioFlush() only notifies the host when the host asks for it.
+
+  Only drivers that access the ring through VirtioPrepare(),
+  VirtioAppendDesc() and VirtioFlush() exclusively may offer
+  VIRTIO_F_RING_PACKED to the device.
+
+  @param[in]  VirtIo            The virtio device which will use the ring.
+
+  @param[in]  QueueSize         The number of descriptors to allocate for the
+                                virtio ring, as requested by the host.
+
+  @param[in]  Features          The feature bits that the device has accepted.
+                                Only VIRTIO_F_RING_PACKED and
+                                VIRTIO_F_RING_EVENT_IDX are considered.
+
+  @param[out] Ring              The virtio ring to set up.
+
+  @return                       Status codes propagated from
+                                VirtIo->AllocateSharedPages().
+
+  @retval EFI_SUCCESS           Allocation and setup successful. Ring->Base
+                                (and nothing else) is responsible for
+                                deallocation.
+
+**/
+EFI_STATUS
+EFIAPI
+VirtioRingInitEx (
+  IN  VIRTIO_DEVICE_PROTOCOL *VirtIo,
+  IN  UINT16                 QueueSize,
+  IN  UINT64                 Features,
+  OUT VRING                  *Ring
+  );
+
+
 /**
 
   Map the ring buffer so that it can be accessed equally by both guest
@@ -201,6 +243,9 @@ VirtioAppendDesc (
                           from device-specific request structures linked by the
                           descriptor chain.
 
+  With VIRTIO_F_RING_EVENT_IDX, or with a packed ring, the host is notified
+  only if it has not suppressed notifications.
+
   @return              Error code from VirtIo->SetQueueNotify() if it fails.
 
   @retval EFI_SUCCESS  Otherwise, the host processed all descriptors.
@@ -24,6 +24,7 @@ typedef struct {
   UINTN                                     NumberOfPages;
   EFI_PHYSICAL_ADDRESS                      CryptedAddress;
   EFI_PHYSICAL_ADDRESS                      PlainTextAddress;
+  BOOLEAN                                   Pooled;
 } MAP_INFO;
 
 //
@@ -33,6 +34,18 @@ typedef struct {
 //
 STATIC LIST_ENTRY mMapInfos = INITIALIZE_LIST_HEAD_VARIABLE (mMapInfos);
 
+//
+// Number of pages in the bounce pool. The pool is allocated below 4GB once,
+// and its encryption mask is cleared once, so that BusMasterRead[64] and
+// BusMasterWrite[64] mappings that fit into it need neither a page allocation
+// nor a page table update (with the accompanying TLB flush). Each bit of
+// mBouncePoolBitmap tracks one page; the page count is limited accordingly.
+//
+#define BOUNCE_POOL_PAGES 64
+
+STATIC EFI_PHYSICAL_ADDRESS mBouncePoolBase;
+STATIC UINT64               mBouncePoolBitmap;
+
 #define COMMON_BUFFER_SIG SIGNATURE_64 ('C', 'M', 'N', 'B', 'U', 'F', 'F', 'R')
 
 //
@@ -72,6 +85,69 @@ typedef struct {
 } COMMON_BUFFER_HEADER;
 #pragma pack ()
 
+/**
+  Take a contiguous run of pages from the bounce pool.
+
+  @param[in]  Pages             The number of pages to take.
+  @param[out] PlainTextAddress  The address of the first page taken.
+
+  @retval TRUE   The pages have been taken; they are shared (plaintext).
+  @retval FALSE  The pool does not exist, or it has no free run of Pages
+                 pages.
+**/
+STATIC
+BOOLEAN
+BouncePoolAllocate (
+  IN  UINTN                 Pages,
+  OUT EFI_PHYSICAL_ADDRESS  *PlainTextAddress
+  )
+{
+  UINT64 Mask;
+  UINTN  Index;
+
+  if (mBouncePoolBase == 0 || Pages == 0 || Pages > BOUNCE_POOL_PAGES) {
+    return FALSE;
+  }
+
+  Mask = (Pages == 64) ? MAX_UINT64 : LShiftU64 (1, Pages) - 1;
+  for (Index = 0; Index + Pages <= BOUNCE_POOL_PAGES; Index++) {
+    if ((mBouncePoolBitmap & LShiftU64 (Mask, Index)) == 0) {
+      mBouncePoolBitmap |= LShiftU64 (Mask, Index);
+      *PlainTextAddress = mBouncePoolBase + EFI_PAGES_TO_SIZE (Index);
+      return TRUE;
+    }
+  }
+  return FALSE;
+}
+
+/**
+  Return pages taken with BouncePoolAllocate() to the bounce pool.
+
+  The pages are zeroed first, as they remain shared with the hypervisor.
+
+  @param[in] PlainTextAddress  The address returned by BouncePoolAllocate().
+  @param[in] Pages             The number of pages passed to
+                               BouncePoolAllocate().
+**/
+STATIC
+VOID
+BouncePoolFree (
+  IN EFI_PHYSICAL_ADDRESS  PlainTextAddress,
+  IN UINTN                 Pages
+  )
+{
+  UINT64 Mask;
+  UINTN  Index;
+
+  ZeroMem ((VOID *)(UINTN)PlainTextAddress, EFI_PAGES_TO_SIZE (Pages));
+
+  Index = (UINTN)EFI_SIZE_TO_PAGES (PlainTextAddress - mBouncePoolBase);
+  Mask  = (Pages == 64) ? MAX_UINT64 : LShiftU64 (1, Pages) - 1;
+  ASSERT ((mBouncePoolBitmap & LShiftU64 (Mask, Index)) ==
+          LShiftU64 (Mask, Index));
+  mBouncePoolBitmap &= ~LShiftU64 (Mask, Index);
+}
+
 /**
   Provides the controller-specific addresses required to access system memory
   from a DMA bus master. On SEV guest, the DMA operations must be performed on
@@ -155,6 +231,7 @@ IoMmuMap (
   MapInfo->NumberOfBytes     = *NumberOfBytes;
   MapInfo->NumberOfPages     = EFI_SIZE_TO_PAGES (MapInfo->NumberOfBytes);
   MapInfo->CryptedAddress    = (UINTN)HostAddress;
+  MapInfo->Pooled            = FALSE;
 
   //
   // In the switch statement below, we point "MapInfo->PlainTextAddress" to the
@@ -180,7 +257,17 @@ IoMmuMap (
   case EdkiiIoMmuOperationBusMasterRead64:
   case EdkiiIoMmuOperationBusMasterWrite64:
     //
-    // Allocate the implicit plaintext bounce buffer.
+    // Prefer the bounce pool, which lives below 4GB and is shared already.
+    //
+    if (BouncePoolAllocate (
+          MapInfo->NumberOfPages,
+          &MapInfo->PlainTextAddress
+          )) {
+      MapInfo->Pooled = TRUE;
+      break;
+    }
+    //
+    // Otherwise allocate the implicit plaintext bounce buffer.
     //
     Status = gBS->AllocatePages (
                     AllocateType,
@@ -247,17 +334,20 @@ IoMmuMap (
   }
 
   //
-  // Clear the memory encryption mask on the plaintext buffer.
+  // Clear the memory encryption mask on the plaintext buffer, unless it comes
+  // from the bounce pool.
   //
-  Status = MemEncryptSevClearPageEncMask (
-             0,
-             MapInfo->PlainTextAddress,
-             MapInfo->NumberOfPages,
-             TRUE
-             );
-  ASSERT_EFI_ERROR (Status);
-  if (EFI_ERROR (Status)) {
-    CpuDeadLoop ();
+  if (!MapInfo->Pooled) {
+    Status = MemEncryptSevClearPageEncMask (
+               0,
+               MapInfo->PlainTextAddress,
+               MapInfo->NumberOfPages,
+               TRUE
+               );
+    ASSERT_EFI_ERROR (Status);
+    if (EFI_ERROR (Status)) {
+      CpuDeadLoop ();
+    }
   }
 
   //
@@ -400,6 +490,19 @@ IoMmuUnmapWorker (
     break;
   }
 
+  //
+  // Pages from the bounce pool stay shared; zero them and return them to the
+  // pool.
+  //
+  if (MapInfo->Pooled) {
+    BouncePoolFree (MapInfo->PlainTextAddress, MapInfo->NumberOfPages);
+    RemoveEntryList (&MapInfo->Link);
+    if (!MemoryMapLocked) {
+      FreePool (MapInfo);
+    }
+    return EFI_SUCCESS;
+  }
+
   //
   // Restore the memory encryption mask on the area we used to hold the
   // plaintext.
@@ -825,6 +928,7 @@ AmdSevUnmapAllMappings (
   LIST_ENTRY *Node;
   LIST_ENTRY *NextNode;
   MAP_INFO   *MapInfo;
+  EFI_STATUS Status;
 
   DEBUG ((DEBUG_VERBOSE, "%a\n", __FUNCTION__));
 
@@ -841,6 +945,66 @@ AmdSevUnmapAllMappings (
       TRUE      // MemoryMapLocked
       );
   }
+
+  //
+  // Re-encrypt the (now zeroed) bounce pool, so that no shared pages are
+  // handed over to the OS. The pool itself cannot be freed at this point.
+  //
+  if (mBouncePoolBase != 0) {
+    ASSERT (mBouncePoolBitmap == 0);
+    Status = MemEncryptSevSetPageEncMask (
+               0,
+               mBouncePoolBase,
+               BOUNCE_POOL_PAGES,
+               TRUE
+               );
+    ASSERT_EFI_ERROR (Status);
+    if (EFI_ERROR (Status)) {
+      CpuDeadLoop ();
+    }
+    mBouncePoolBase = 0;
+  }
+}
+
+/**
+  Allocate the bounce pool below 4GB and clear its memory encryption mask.
+
+  Failure is not fatal; mappings then allocate their bounce buffers one by one.
+**/
+STATIC
+VOID
+BouncePoolInit (
+  VOID
+  )
+{
+  EFI_STATUS           Status;
+  EFI_PHYSICAL_ADDRESS PoolBase;
+
+  PoolBase = BASE_4GB - 1;
+  Status = gBS->AllocatePages (
+                  AllocateMaxAddress,
+                  EfiBootServicesData,
+                  BOUNCE_POOL_PAGES,
+                  &PoolBase
+                  );
+  if (EFI_ERROR (Status)) {
+    return;
+  }
+
+  Status = MemEncryptSevClearPageEncMask (
+             0,
+             PoolBase,
+             BOUNCE_POOL_PAGES,
+             TRUE
+             );
+  if (EFI_ERROR (Status)) {
+    gBS->FreePages (PoolBase, BOUNCE_POOL_PAGES);
+    return;
+  }
+
+  ZeroMem ((VOID *)(UINTN)PoolBase, EFI_PAGES_TO_SIZE (BOUNCE_POOL_PAGES));
+  mBouncePoolBase   = PoolBase;
+  mBouncePoolBitmap = 0;
 }
 
 /**
@@ -898,6 +1062,8 @@ AmdSevInstallIoMmuProtocol (
     goto CloseExitBootEvent;
   }
 
+  BouncePoolInit ();
+
   return EFI_SUCCESS;
 
 CloseExitBootEvent:
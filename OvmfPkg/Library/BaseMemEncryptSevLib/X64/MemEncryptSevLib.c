@@ -89,6 +89,76 @@ MemEncryptSevSetPageEncMask (
            );
 }
 
+/**
+  This function clears memory encryption bit for the memory regions specified
+  by Ranges and RangeCount from the current page table context.
+
+  @param[in]  Cr3BaseAddress          Cr3 Base Address (if zero then use
+                                      current CR3)
+  @param[in]  Ranges                  The memory regions to update.
+  @param[in]  RangeCount              The number of elements in Ranges.
+  @param[in]  Flush                   Flush the caches before clearing the bit
+                                      (mostly TRUE except MMIO addresses)
+
+  @retval RETURN_SUCCESS              The attributes were cleared for the
+                                      memory regions.
+  @retval RETURN_INVALID_PARAMETER    RangeCount or the number of pages in a
+                                      region is zero.
+  @retval RETURN_UNSUPPORTED          Clearing the memory encryption attribute
+                                      is not supported
+**/
+RETURN_STATUS
+EFIAPI
+MemEncryptSevClearPageEncMaskRanges (
+  IN PHYSICAL_ADDRESS             Cr3BaseAddress,
+  IN CONST MEM_ENCRYPT_SEV_RANGE  *Ranges,
+  IN UINTN                        RangeCount,
+  IN BOOLEAN                      Flush
+  )
+{
+  return InternalMemEncryptSevSetMemoryRangesDecrypted (
+           Cr3BaseAddress,
+           Ranges,
+           RangeCount,
+           Flush
+           );
+}
+
+/**
+  This function sets memory encryption bit for the memory regions specified by
+  Ranges and RangeCount from the current page table context.
+
+  @param[in]  Cr3BaseAddress          Cr3 Base Address (if zero then use
+                                      current CR3)
+  @param[in]  Ranges                  The memory regions to update.
+  @param[in]  RangeCount              The number of elements in Ranges.
+  @param[in]  Flush                   Flush the caches before setting the bit
+                                      (mostly TRUE except MMIO addresses)
+
+  @retval RETURN_SUCCESS              The attributes were set for the memory
+                                      regions.
+  @retval RETURN_INVALID_PARAMETER    RangeCount or the number of pages in a
+                                      region is zero.
+  @retval RETURN_UNSUPPORTED          Setting the memory encryption attribute
+                                      is not supported
+**/
+RETURN_STATUS
+EFIAPI
+MemEncryptSevSetPageEncMaskRanges (
+  IN PHYSICAL_ADDRESS             Cr3BaseAddress,
+  IN CONST MEM_ENCRYPT_SEV_RANGE  *Ranges,
+  IN UINTN                        RangeCount,
+  IN BOOLEAN                      Flush
+  )
+{
+  return InternalMemEncryptSevSetMemoryRangesEncrypted (
+           Cr3BaseAddress,
+           Ranges,
+           RangeCount,
+           Flush
+           );
+}
+
 /**
   Returns the encryption state of the specified virtual address range.
 
@@ -538,9 +538,8 @@ EnableReadOnlyPageWriteProtect (
 
 
 /**
-  This function either sets or clears memory encryption bit for the memory
-  region specified by PhysicalAddress and Length from the current page table
-  context.
+  Set or clear the memory encryption bit in the page table entries that map
+  the memory region specified by PhysicalAddress and Length.
 
   The function iterates through the PhysicalAddress one page at a time, and set
   or clears the memory encryption mask in the page table. If it encounters
@@ -549,93 +548,53 @@ EnableReadOnlyPageWriteProtect (
   large pages into smaller (e.g 2M page into 4K pages) and then try to set or
   clear the encryption bit on the smallest page size.
 
-  @param[in]  Cr3BaseAddress          Cr3 Base Address (if zero then use
+  The caller is responsible for making the page table writeable beforehand,
+  and for flushing the TLB afterwards.
+
+  @param[in]      Cr3BaseAddress      Cr3 Base Address (if zero then use
                                       current CR3)
-  @param[in]  PhysicalAddress         The physical address that is the start
+  @param[in]      PhysicalAddress     The physical address that is the start
                                       address of a memory region.
-  @param[in]  Length                  The length of memory region
-  @param[in]  Mode                    Set or Clear mode
-  @param[in]  CacheFlush              Flush the caches before applying the
-                                      encryption mask
+  @param[in]      Length              The length of memory region
+  @param[in]      Mode                Set or Clear mode
+  @param[out]     LastPageMapLevel4Entry
+                                      The last PML4 entry that was looked up.
 
-  @retval RETURN_SUCCESS              The attributes were cleared for the
+  @retval RETURN_SUCCESS              The attributes were updated for the
                                       memory region.
-  @retval RETURN_INVALID_PARAMETER    Number of pages is zero.
-  @retval RETURN_UNSUPPORTED          Setting the memory encyrption attribute
-                                      is not supported
+  @retval RETURN_NO_MAPPING           Part of the memory region is not mapped.
 **/
 STATIC
 RETURN_STATUS
-EFIAPI
-SetMemoryEncDec (
-  IN    PHYSICAL_ADDRESS         Cr3BaseAddress,
-  IN    PHYSICAL_ADDRESS         PhysicalAddress,
-  IN    UINTN                    Length,
-  IN    MAP_RANGE_MODE           Mode,
-  IN    BOOLEAN                  CacheFlush
+UpdateMemoryEncDec (
+  IN     PHYSICAL_ADDRESS                Cr3BaseAddress,
+  IN     PHYSICAL_ADDRESS                PhysicalAddress,
+  IN     UINTN                           Length,
+  IN     MAP_RANGE_MODE                  Mode,
+  OUT    PAGE_MAP_AND_DIRECTORY_POINTER  **LastPageMapLevel4Entry
   )
 {
   PAGE_MAP_AND_DIRECTORY_POINTER *PageMapLevel4Entry;
+  PAGE_TABLE_1G_ENTRY            *PageDirectory1GEntry;
   PAGE_MAP_AND_DIRECTORY_POINTER *PageUpperDirectoryPointerEntry;
   PAGE_MAP_AND_DIRECTORY_POINTER *PageDirectoryPointerEntry;
-  PAGE_TABLE_1G_ENTRY            *PageDirectory1GEntry;
   PAGE_TABLE_ENTRY               *PageDirectory2MEntry;
   PAGE_TABLE_4K_ENTRY            *PageTableEntry;
   UINT64                         PgTableMask;
-  UINT64                         AddressEncMask;
-  BOOLEAN                        IsWpEnabled;
-  RETURN_STATUS                  Status;
 
-  //
-  // Set PageMapLevel4Entry to suppress incorrect compiler/analyzer warnings.
-  //
-  PageMapLevel4Entry = NULL;
+  PgTableMask = InternalGetMemEncryptionAddressMask () | EFI_PAGE_MASK;
 
   DEBUG ((
     DEBUG_VERBOSE,
-    "%a:%a: Cr3Base=0x%Lx Physical=0x%Lx Length=0x%Lx Mode=%a CacheFlush=%u\n",
+    "%a:%a: Cr3Base=0x%Lx Physical=0x%Lx Length=0x%Lx Mode=%a\n",
     gEfiCallerBaseName,
     __FUNCTION__,
     Cr3BaseAddress,
     PhysicalAddress,
     (UINT64)Length,
-    (Mode == SetCBit) ? "Encrypt" : "Decrypt",
-    (UINT32)CacheFlush
+    (Mode == SetCBit) ? "Encrypt" : "Decrypt"
     ));
 
-  //
-  // Check if we have a valid memory encryption mask
-  //
-  AddressEncMask = InternalGetMemEncryptionAddressMask ();
-  if (!AddressEncMask) {
-    return RETURN_ACCESS_DENIED;
-  }
-
-  PgTableMask = AddressEncMask | EFI_PAGE_MASK;
-
-  if (Length == 0) {
-    return RETURN_INVALID_PARAMETER;
-  }
-
-  //
-  // We are going to change the memory encryption attribute from C=0 -> C=1 or
-  // vice versa Flush the caches to ensure that data is written into memory
-  // with correct C-bit
-  //
-  if (CacheFlush) {
-    WriteBackInvalidateDataCacheRange((VOID*) (UINTN)PhysicalAddress, Length);
-  }
-
-  //
-  // Make sure that the page table is changeable.
-  //
-  IsWpEnabled = IsReadOnlyPageWriteProtected ();
-  if (IsWpEnabled) {
-    DisableReadOnlyPageWriteProtect ();
-  }
-
-  Status = EFI_SUCCESS;
-
   while (Length != 0)
   {
     //
@@ -647,6 +606,7 @@ SetMemoryEncDec (
 
     PageMapLevel4Entry = (VOID*) (Cr3BaseAddress & ~PgTableMask);
     PageMapLevel4Entry += PML4_OFFSET(PhysicalAddress);
+    *LastPageMapLevel4Entry = PageMapLevel4Entry;
     if (!PageMapLevel4Entry->Bits.Present) {
       DEBUG ((
         DEBUG_ERROR,
@@ -655,8 +615,7 @@ SetMemoryEncDec (
         __FUNCTION__,
         PhysicalAddress
         ));
-      Status = RETURN_NO_MAPPING;
-      goto Done;
+      return RETURN_NO_MAPPING;
     }
 
     PageDirectory1GEntry = (VOID *)(
@@ -672,8 +631,7 @@ SetMemoryEncDec (
         __FUNCTION__,
         PhysicalAddress
         ));
-      Status = RETURN_NO_MAPPING;
-      goto Done;
+      return RETURN_NO_MAPPING;
     }
 
     //
@@ -734,8 +692,7 @@ SetMemoryEncDec (
           __FUNCTION__,
           PhysicalAddress
           ));
-        Status = RETURN_NO_MAPPING;
-        goto Done;
+        return RETURN_NO_MAPPING;
       }
       //
       // If the MustBe1 bit is not a 1, it's not a 2MB entry
@@ -785,8 +742,7 @@ SetMemoryEncDec (
             __FUNCTION__,
             PhysicalAddress
             ));
-          Status = RETURN_NO_MAPPING;
-          goto Done;
+          return RETURN_NO_MAPPING;
         }
         SetOrClearCBit (&PageTableEntry->Uint64, Mode);
         PhysicalAddress += EFI_PAGE_SIZE;
@@ -795,6 +751,125 @@ SetMemoryEncDec (
     }
   }
 
+
+  return RETURN_SUCCESS;
+}
+
+/**
+  This function either sets or clears memory encryption bit for the memory
+  regions specified by Ranges and RangeCount from the current page table
+  context.
+
+  Ranges that start where the previous range ends are processed together, so
+  that large pages covering both are updated at one go rather than split.
+  The page table write protection is lifted once, and the TLB is flushed once,
+  for all ranges.
+
+  @param[in]  Cr3BaseAddress          Cr3 Base Address (if zero then use
+                                      current CR3)
+  @param[in]  Ranges                  The memory regions to update.
+  @param[in]  RangeCount              The number of elements in Ranges.
+  @param[in]  Mode                    Set or Clear mode
+  @param[in]  CacheFlush              Flush the caches before applying the
+                                      encryption mask
+
+  @retval RETURN_SUCCESS              The attributes were updated for the
+                                      memory regions.
+  @retval RETURN_INVALID_PARAMETER    RangeCount or the number of pages in a
+                                      range is zero.
+  @retval RETURN_ACCESS_DENIED        The memory encryption mask is not
+                                      available.
+  @retval RETURN_NO_MAPPING           Part of a memory region is not mapped.
+**/
+STATIC
+RETURN_STATUS
+SetMemoryEncDecRanges (
+  IN    PHYSICAL_ADDRESS             Cr3BaseAddress,
+  IN    CONST MEM_ENCRYPT_SEV_RANGE  *Ranges,
+  IN    UINTN                        RangeCount,
+  IN    MAP_RANGE_MODE               Mode,
+  IN    BOOLEAN                      CacheFlush
+  )
+{
+  PAGE_MAP_AND_DIRECTORY_POINTER *PageMapLevel4Entry;
+  PHYSICAL_ADDRESS               PhysicalAddress;
+  UINTN                          Length;
+  UINTN                          Index;
+  BOOLEAN                        IsWpEnabled;
+  RETURN_STATUS                  Status;
+
+  //
+  // Set PageMapLevel4Entry to suppress incorrect compiler/analyzer warnings.
+  //
+  PageMapLevel4Entry = NULL;
+
+  //
+  // Check if we have a valid memory encryption mask
+  //
+  if (!InternalGetMemEncryptionAddressMask ()) {
+    return RETURN_ACCESS_DENIED;
+  }
+
+  if (Ranges == NULL || RangeCount == 0) {
+    return RETURN_INVALID_PARAMETER;
+  }
+  for (Index = 0; Index < RangeCount; Index++) {
+    if (Ranges[Index].NumPages == 0) {
+      return RETURN_INVALID_PARAMETER;
+    }
+  }
+
+  //
+  // We are going to change the memory encryption attribute from C=0 -> C=1 or
+  // vice versa Flush the caches to ensure that data is written into memory
+  // with correct C-bit
+  //
+  if (CacheFlush) {
+    for (Index = 0; Index < RangeCount; Index++) {
+      WriteBackInvalidateDataCacheRange (
+        (VOID *)(UINTN)Ranges[Index].BaseAddress,
+        EFI_PAGES_TO_SIZE (Ranges[Index].NumPages)
+        );
+    }
+  }
+
+  //
+  // Make sure that the page table is changeable.
+  //
+  IsWpEnabled = IsReadOnlyPageWriteProtected ();
+  if (IsWpEnabled) {
+    DisableReadOnlyPageWriteProtect ();
+  }
+
+  Status = RETURN_SUCCESS;
+
+  Index = 0;
+  while (Index < RangeCount) {
+    PhysicalAddress = Ranges[Index].BaseAddress;
+    Length          = EFI_PAGES_TO_SIZE (Ranges[Index].NumPages);
+    Index++;
+
+    //
+    // Merge the ranges that continue the current one.
+    //
+    while (Index < RangeCount &&
+           Ranges[Index].BaseAddress == PhysicalAddress + Length) {
+      Length += EFI_PAGES_TO_SIZE (Ranges[Index].NumPages);
+      Index++;
+    }
+
+    Status = UpdateMemoryEncDec (
+               Cr3BaseAddress,
+               PhysicalAddress,
+               Length,
+               Mode,
+               &PageMapLevel4Entry
+               );
+    if (RETURN_ERROR (Status)) {
+      goto Done;
+    }
+  }
+
   //
   // Protect the page table by marking the memory used for page table to be
   // read-only.
@@ -819,6 +894,44 @@ Done:
   return Status;
 }
 
+/**
+  This function either sets or clears memory encryption bit for the memory
+  region specified by PhysicalAddress and Length from the current page table
+  context.
+
+  @param[in]  Cr3BaseAddress          Cr3 Base Address (if zero then use
+                                      current CR3)
+  @param[in]  PhysicalAddress         The physical address that is the start
+                                      address of a memory region.
+  @param[in]  Length                  The length of memory region
+  @param[in]  Mode                    Set or Clear mode
+  @param[in]  CacheFlush              Flush the caches before applying the
+                                      encryption mask
+
+  @retval RETURN_SUCCESS              The attributes were cleared for the
+                                      memory region.
+  @retval RETURN_INVALID_PARAMETER    Number of pages is zero.
+  @retval RETURN_UNSUPPORTED          Setting the memory encyrption attribute
+                                      is not supported
+**/
+STATIC
+RETURN_STATUS
+EFIAPI
+SetMemoryEncDec (
+  IN    PHYSICAL_ADDRESS         Cr3BaseAddress,
+  IN    PHYSICAL_ADDRESS         PhysicalAddress,
+  IN    UINTN                    Length,
+  IN    MAP_RANGE_MODE           Mode,
+  IN    BOOLEAN                  CacheFlush
+  )
+{
+  MEM_ENCRYPT_SEV_RANGE          Range;
+
+  Range.BaseAddress = PhysicalAddress;
+  Range.NumPages    = EFI_SIZE_TO_PAGES (Length);
+  return SetMemoryEncDecRanges (Cr3BaseAddress, &Range, 1, Mode, CacheFlush);
+}
+
 /**
   This function clears memory encryption bit for the memory region specified by
   PhysicalAddress and Length from the current page table context.
@@ -891,3 +1004,75 @@ InternalMemEncryptSevSetMemoryEncrypted (
            Flush
            );
 }
+
+/**
+  This function clears memory encryption bit for the memory regions specified
+  by Ranges and RangeCount from the current page table context.
+
+  @param[in]  Cr3BaseAddress          Cr3 Base Address (if zero then use
+                                      current CR3)
+  @param[in]  Ranges                  The memory regions to update.
+  @param[in]  RangeCount              The number of elements in Ranges.
+  @param[in]  Flush                   Flush the caches before applying the
+                                      encryption mask
+
+  @retval RETURN_SUCCESS              The attributes were cleared for the
+                                      memory regions.
+  @retval RETURN_INVALID_PARAMETER    RangeCount or the number of pages in a
+                                      range is zero.
+  @retval RETURN_UNSUPPORTED          Clearing the memory encyrption attribute
+                                      is not supported
+**/
+RETURN_STATUS
+EFIAPI
+InternalMemEncryptSevSetMemoryRangesDecrypted (
+  IN  PHYSICAL_ADDRESS             Cr3BaseAddress,
+  IN  CONST MEM_ENCRYPT_SEV_RANGE  *Ranges,
+  IN  UINTN                        RangeCount,
+  IN  BOOLEAN                      Flush
+  )
+{
+  return SetMemoryEncDecRanges (
+           Cr3BaseAddress,
+           Ranges,
+           RangeCount,
+           ClearCBit,
+           Flush
+           );
+}
+
+/**
+  This function sets memory encryption bit for the memory regions specified by
+  Ranges and RangeCount from the current page table context.
+
+  @param[in]  Cr3BaseAddress          Cr3 Base Address (if zero then use
+                                      current CR3)
+  @param[in]  Ranges                  The memory regions to update.
+  @param[in]  RangeCount              The number of elements in Ranges.
+  @param[in]  Flush                   Flush the caches before applying the
+                                      encryption mask
+
+  @retval RETURN_SUCCESS              The attributes were set for the memory
+                                      regions.
+  @retval RETURN_INVALID_PARAMETER    RangeCount or the number of pages in a
+                                      range is zero.
+  @retval RETURN_UNSUPPORTED          Setting the memory encyrption attribute
+                                      is not supported
+**/
+RETURN_STATUS
+EFIAPI
+InternalMemEncryptSevSetMemoryRangesEncrypted (
+  IN  PHYSICAL_ADDRESS             Cr3BaseAddress,
+  IN  CONST MEM_ENCRYPT_SEV_RANGE  *Ranges,
+  IN  UINTN                        RangeCount,
+  IN  BOOLEAN                      Flush
+  )
+{
+  return SetMemoryEncDecRanges (
+           Cr3BaseAddress,
+           Ranges,
+           RangeCount,
+           SetCBit,
+           Flush
+           );
+}
@@ -28,6 +28,14 @@ STATIC BOOLEAN mQemuFwCfgDmaSupported;
 
 STATIC EDKII_IOMMU_PROTOCOL        *mIoMmuProtocol;
 
+//
+// When SEV is enabled, the data of a DMA transfer goes through a bounce buffer
+// of the same size, mapped with the IOMMU protocol. Larger transfers are split
+// so that the bounce buffer stays small. Without SEV, the data is transferred
+// straight into the caller's buffer, in one go.
+//
+#define FW_CFG_SEV_DMA_CHUNK_SIZE   SIZE_1MB
+
 /**
   Returns a boolean indicating if the firmware configuration interface
   is available or not.
@@ -365,6 +373,19 @@ InternalQemuFwCfgDmaBytes (
     return;
   }
 
+  if (Size > FW_CFG_SEV_DMA_CHUNK_SIZE && Control != FW_CFG_DMA_CTL_SKIP &&
+      MemEncryptSevIsEnabled ()) {
+    UINT32 Chunk;
+
+    while (Size > 0) {
+      Chunk = MIN (Size, FW_CFG_SEV_DMA_CHUNK_SIZE);
+      InternalQemuFwCfgDmaBytes (Chunk, Buffer, Control);
+      Buffer = (UINT8 *)Buffer + Chunk;
+      Size -= Chunk;
+    }
+    return;
+  }
+
   Access = &LocalAccess;
   AccessMapping = NULL;
   DataMapping = NULL;
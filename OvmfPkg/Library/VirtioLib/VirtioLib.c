@@ -52,11 +52,135 @@ VirtioRingInit (
   IN  UINT16                 QueueSize,
   OUT VRING                  *Ring
   )
+{
+  return VirtioRingInitEx (VirtIo, QueueSize, 0, Ring);
+}
+
+
+/**
+
+  Lay out a packed virtqueue (virtio-1.1, 2.7 Packed Virtqueues): the
+  descriptor ring, followed by the driver and the device event suppression
+  structures.
+
+  @param[in]  VirtIo            The virtio device which will use the ring.
+
+  @param[in]  QueueSize         The number of descriptors to allocate for the
+                                virtio ring, as requested by the host.
+
+  @param[out] Ring              The virtio ring to set up.
+
+  @return                       Status codes propagated from
+                                VirtIo->AllocateSharedPages().
+
+  @retval EFI_SUCCESS           Allocation and setup successful.
+
+**/
+STATIC
+EFI_STATUS
+VirtioRingInitPacked (
+  IN  VIRTIO_DEVICE_PROTOCOL *VirtIo,
+  IN  UINT16                 QueueSize,
+  OUT VRING                  *Ring
+  )
+{
+  EFI_STATUS     Status;
+  UINTN          RingSize;
+  volatile UINT8 *RingPagesPtr;
+
+  RingSize = ALIGN_VALUE (
+               sizeof *Ring->PackedDesc      * QueueSize +
+               sizeof *Ring->DriverEvent                 +
+               sizeof *Ring->DeviceEvent,
+               EFI_PAGE_SIZE);
+
+  Ring->NumPages = EFI_SIZE_TO_PAGES (RingSize);
+  Status = VirtIo->AllocateSharedPages (
+                     VirtIo,
+                     Ring->NumPages,
+                     &Ring->Base
+                     );
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+  SetMem (Ring->Base, RingSize, 0x00);
+  RingPagesPtr = Ring->Base;
+
+  Ring->PackedDesc = (volatile VOID *) RingPagesPtr;
+  RingPagesPtr += sizeof *Ring->PackedDesc * QueueSize;
+
+  Ring->DriverEvent = (volatile VOID *) RingPagesPtr;
+  RingPagesPtr += sizeof *Ring->DriverEvent;
+
+  Ring->DeviceEvent = (volatile VOID *) RingPagesPtr;
+  RingPagesPtr += sizeof *Ring->DeviceEvent;
+
+  Ring->Desc = NULL;
+  SetMem (&Ring->Avail, sizeof Ring->Avail, 0x00);
+  SetMem (&Ring->Used, sizeof Ring->Used, 0x00);
+
+  //
+  // virtio-1.1, 2.7.1 Driver and Device Ring Wrap Counters: both start at 1.
+  //
+  Ring->QueueSize   = QueueSize;
+  Ring->Packed      = TRUE;
+  Ring->NextIdx     = 0;
+  Ring->WrapCounter = TRUE;
+  return EFI_SUCCESS;
+}
+
+
+/**
+
+  Configure a virtio ring according to the negotiated ring features.
+
+  With VIRTIO_F_RING_PACKED present in Features, a packed virtqueue is laid out
+  (virtio-1.1, 2.7 Packed Virtqueues); otherwise a split virtqueue is laid out,
+  exactly as VirtioRingInit() does. With VIRTIO_F_RING_EVENT_IDX present in
+  Features, VirtioFlush() only notifies the host when the host asks for it.
+
+  Only drivers that access the ring through VirtioPrepare(),
+  VirtioAppendDesc() and VirtioFlush() exclusively may offer
+  VIRTIO_F_RING_PACKED to the device.
+
+  @param[in]  VirtIo            The virtio device which will use the ring.
+
+  @param[in]  QueueSize         The number of descriptors to allocate for the
+                                virtio ring, as requested by the host.
+
+  @param[in]  Features          The feature bits that the device has accepted.
+                                Only VIRTIO_F_RING_PACKED and
+                                VIRTIO_F_RING_EVENT_IDX are considered.
+
+  @param[out] Ring              The virtio ring to set up.
+
+  @return                       Status codes propagated from
+                                VirtIo->AllocateSharedPages().
+
+  @retval EFI_SUCCESS           Allocation and setup successful. Ring->Base
+                                (and nothing else) is responsible for
+                                deallocation.
+
+**/
+EFI_STATUS
+EFIAPI
+VirtioRingInitEx (
+  IN  VIRTIO_DEVICE_PROTOCOL *VirtIo,
+  IN  UINT16                 QueueSize,
+  IN  UINT64                 Features,
+  OUT VRING                  *Ring
+  )
 {
   EFI_STATUS     Status;
   UINTN          RingSize;
   volatile UINT8 *RingPagesPtr;
 
+  Ring->EventIdx = (BOOLEAN) ((Features & VIRTIO_F_RING_EVENT_IDX) != 0);
+
+  if ((Features & VIRTIO_F_RING_PACKED) != 0) {
+    return VirtioRingInitPacked (VirtIo, QueueSize, Ring);
+  }
+
   RingSize = ALIGN_VALUE (
                sizeof *Ring->Desc            * QueueSize +
                sizeof *Ring->Avail.Flags                 +
@@ -118,7 +242,14 @@ VirtioRingInit (
   Ring->Used.AvailEvent = (volatile VOID *) RingPagesPtr;
   RingPagesPtr += sizeof *Ring->Used.AvailEvent;
 
-  Ring->QueueSize = QueueSize;
+  Ring->PackedDesc  = NULL;
+  Ring->DriverEvent = NULL;
+  Ring->DeviceEvent = NULL;
+
+  Ring->QueueSize   = QueueSize;
+  Ring->Packed      = FALSE;
+  Ring->NextIdx     = 0;
+  Ring->WrapCounter = FALSE;
   return EFI_SUCCESS;
 }
 
@@ -167,11 +298,33 @@ VirtioPrepare (
   OUT    DESC_INDICES *Indices
   )
 {
+  if (Ring->Packed) {
+    //
+    // virtio-1.1, 2.7.10 Driver Event Suppression: we're going to poll the
+    // answer, the host should not send an interrupt.
+    //
+    Ring->DriverEvent->DescEventFlags = VRING_PACKED_EVENT_FLAG_DISABLE;
+
+    //
+    // Due to the lock-step progress, the chain can always be built at the
+    // position where the previous chain ended.
+    //
+    Indices->HeadDescIdx = Ring->NextIdx;
+    Indices->NextDescIdx = Indices->HeadDescIdx;
+    return;
+  }
+
   //
   // Prepare for virtio-0.9.5, 2.4.2 Receiving Used Buffers From the Device.
   // We're going to poll the answer, the host should not send an interrupt.
+  // With VIRTIO_F_RING_EVENT_IDX the host ignores Avail.Flags; place the used
+  // event index just behind the used index, so that the host would only
+  // interrupt after wrapping around.
   //
   *Ring->Avail.Flags = (UINT16) VRING_AVAIL_F_NO_INTERRUPT;
+  if (Ring->EventIdx) {
+    *Ring->Avail.UsedEvent = (UINT16) (*Ring->Used.Idx - 1);
+  }
 
   //
   // Prepare for virtio-0.9.5, 2.4.1 Supplying Buffers to the Device.
@@ -231,7 +384,44 @@ VirtioAppendDesc (
   IN OUT DESC_INDICES *Indices
   )
 {
-  volatile VRING_DESC *Desc;
+  volatile VRING_DESC        *Desc;
+  volatile VRING_PACKED_DESC *PackedDesc;
+  BOOLEAN                    WrapCounter;
+
+  if (Ring->Packed) {
+    //
+    // virtio-1.1, 2.7.13.1 Placing Available Buffers Into The Descriptor Ring.
+    // Indices->NextDescIdx runs from Indices->HeadDescIdx (less than
+    // QueueSize) for at most QueueSize descriptors, so the wrap counter
+    // toggles at most once within the chain.
+    //
+    WrapCounter = Ring->WrapCounter;
+    if (Indices->NextDescIdx >= Ring->QueueSize) {
+      WrapCounter = !WrapCounter;
+    }
+
+    PackedDesc       = &Ring->PackedDesc[Indices->NextDescIdx % Ring->QueueSize];
+    PackedDesc->Addr = BufferDeviceAddress;
+    PackedDesc->Len  = BufferSize;
+    PackedDesc->Id   = Indices->HeadDescIdx;
+
+    //
+    // The head descriptor makes the entire chain available, so it is marked
+    // available only in VirtioFlush(). Until then, it looks like a descriptor
+    // that the device used on the previous lap.
+    //
+    if (Indices->NextDescIdx == Indices->HeadDescIdx) {
+      Flags |= WrapCounter ? 0 :
+               VRING_PACKED_DESC_F_AVAIL | VRING_PACKED_DESC_F_USED;
+    } else {
+      Flags |= WrapCounter ? VRING_PACKED_DESC_F_AVAIL :
+               VRING_PACKED_DESC_F_USED;
+    }
+    PackedDesc->Flags = Flags;
+
+    Indices->NextDescIdx++;
+    return;
+  }
 
   Desc        = &Ring->Desc[Indices->NextDescIdx++ % Ring->QueueSize];
   Desc->Addr  = BufferDeviceAddress;
@@ -241,6 +431,179 @@ VirtioAppendDesc (
 }
 
 
+/**
+
+  Decide whether the host asked to be notified about the available ring
+  entries (or packed ring descriptors) in [OldIdx, NewIdx), modulo 2^16.
+
+  This is vring_need_event() from virtio-1.0, 2.4.7.2 Notifying The Device.
+
+  @param[in] EventIdx  The index that the host wants to be notified about.
+
+  @param[in] NewIdx    The index one past the last entry just made available.
+
+  @param[in] OldIdx    The index of the first entry just made available.
+
+  @retval TRUE   The host has to be notified.
+
+  @retval FALSE  The host asked not to be notified.
+
+**/
+STATIC
+BOOLEAN
+VirtioNeedEvent (
+  IN UINT16 EventIdx,
+  IN UINT16 NewIdx,
+  IN UINT16 OldIdx
+  )
+{
+  return (BOOLEAN) ((UINT16) (NewIdx - EventIdx - 1) <
+                    (UINT16) (NewIdx - OldIdx));
+}
+
+
+/**
+
+  Packed virtqueue counterpart of VirtioFlush().
+
+  @param[in] VirtIo       The target virtio device to notify.
+
+  @param[in] VirtQueueId  Identifies the queue for the target device.
+
+  @param[in,out] Ring     The packed virtio ring with descriptors to submit.
+
+  @param[in] Indices      The descriptor chain built with VirtioPrepare() and
+                          VirtioAppendDesc().
+
+  @param[out] UsedLen     On success, the number of bytes that the host wrote.
+                          May be NULL.
+
+  @return              Error code from VirtIo->SetQueueNotify() if it fails.
+
+  @retval EFI_SUCCESS  Otherwise, the host processed all descriptors.
+
+**/
+STATIC
+EFI_STATUS
+VirtioFlushPacked (
+  IN     VIRTIO_DEVICE_PROTOCOL *VirtIo,
+  IN     UINT16                 VirtQueueId,
+  IN OUT VRING                  *Ring,
+  IN     DESC_INDICES           *Indices,
+  OUT    UINT32                 *UsedLen    OPTIONAL
+  )
+{
+  volatile VRING_PACKED_DESC *HeadDesc;
+  UINT16                     NumDesc;
+  BOOLEAN                    WrapCounter;
+  UINT16                     HeadFlags;
+  UINT16                     UsedFlags;
+  UINT16                     OffWrap;
+  UINT16                     EventIdx;
+  BOOLEAN                    Notify;
+  EFI_STATUS                 Status;
+  UINTN                      PollPeriodUsecs;
+
+  HeadDesc    = &Ring->PackedDesc[Indices->HeadDescIdx];
+  NumDesc     = (UINT16) (Indices->NextDescIdx - Indices->HeadDescIdx);
+  WrapCounter = Ring->WrapCounter;
+  ASSERT (NumDesc > 0 && NumDesc <= Ring->QueueSize);
+
+  //
+  // Advance the driver's position past the chain. Due to our lock-step
+  // progress, the device will have consumed the chain, and moved past it, by
+  // the time we return.
+  //
+  Ring->NextIdx = Indices->NextDescIdx;
+  if (Ring->NextIdx >= Ring->QueueSize) {
+    Ring->NextIdx     -= Ring->QueueSize;
+    Ring->WrapCounter  = !Ring->WrapCounter;
+  }
+
+  //
+  // virtio-1.1, 2.7.13.2 Updating flags: flipping the head descriptor makes
+  // the entire chain available at once.
+  //
+  HeadFlags = HeadDesc->Flags &
+              (UINT16) ~(VRING_PACKED_DESC_F_AVAIL | VRING_PACKED_DESC_F_USED);
+  HeadFlags |= WrapCounter ? VRING_PACKED_DESC_F_AVAIL :
+               VRING_PACKED_DESC_F_USED;
+  MemoryFence();
+  HeadDesc->Flags = HeadFlags;
+
+  //
+  // virtio-1.1, 2.7.13.3 Sending Available Buffer Notifications, according to
+  // the Device Event Suppression structure.
+  //
+  MemoryFence();
+  switch (Ring->DeviceEvent->DescEventFlags & 0x3) {
+  case VRING_PACKED_EVENT_FLAG_DISABLE:
+    Notify = FALSE;
+    break;
+
+  case VRING_PACKED_EVENT_FLAG_DESC:
+    if (!Ring->EventIdx) {
+      Notify = TRUE;
+      break;
+    }
+    OffWrap  = Ring->DeviceEvent->DescEventOffWrap;
+    EventIdx = OffWrap & (UINT16) ~BIT15;
+    if (((OffWrap & BIT15) != 0) != Ring->WrapCounter) {
+      EventIdx -= Ring->QueueSize;
+    }
+    Notify = VirtioNeedEvent (
+               EventIdx,
+               Ring->NextIdx,
+               (UINT16) (Ring->NextIdx - NumDesc)
+               );
+    break;
+
+  default:
+    Notify = TRUE;
+    break;
+  }
+
+  if (Notify) {
+    Status = VirtIo->SetQueueNotify (VirtIo, VirtQueueId);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+  }
+
+  //
+  // virtio-1.1, 2.7.14 Receiving Used Buffers From the Device. Due to our
+  // lock-step progress, the device writes the used descriptor over the head
+  // descriptor, with both the AVAIL and the USED flags matching the wrap
+  // counter that was current for the head.
+  //
+  // Keep slowing down until we reach a poll period of slightly above 1 ms.
+  //
+  UsedFlags = WrapCounter ?
+              VRING_PACKED_DESC_F_AVAIL | VRING_PACKED_DESC_F_USED :
+              0;
+  PollPeriodUsecs = 1;
+  MemoryFence();
+  while ((HeadDesc->Flags &
+          (VRING_PACKED_DESC_F_AVAIL | VRING_PACKED_DESC_F_USED)) != UsedFlags) {
+    gBS->Stall (PollPeriodUsecs); // calls AcpiTimerLib::MicroSecondDelay
+
+    if (PollPeriodUsecs < 1024) {
+      PollPeriodUsecs *= 2;
+    }
+    MemoryFence();
+  }
+
+  MemoryFence();
+
+  if (UsedLen != NULL) {
+    ASSERT (HeadDesc->Id == Indices->HeadDescIdx);
+    *UsedLen = HeadDesc->Len;
+  }
+
+  return EFI_SUCCESS;
+}
+
+
 /**
 
   Notify the host about the descriptor chain just built, and wait until the
@@ -283,6 +646,10 @@ VirtioFlush (
   EFI_STATUS Status;
   UINTN      PollPeriodUsecs;
 
+  if (Ring->Packed) {
+    return VirtioFlushPacked (VirtIo, VirtQueueId, Ring, Indices, UsedLen);
+  }
+
   //
   // virtio-0.9.5, 2.4.1.2 Updating the Available Ring
   //
@@ -307,12 +674,16 @@ VirtioFlush (
 
   //
   // virtio-0.9.5, 2.4.1.4 Notifying the Device -- gratuitous notifications are
-  // OK.
+  // OK. With VIRTIO_F_RING_EVENT_IDX, skip the notification if the host is
+  // not waiting for the entry just added.
   //
   MemoryFence();
-  Status = VirtIo->SetQueueNotify (VirtIo, VirtQueueId);
-  if (EFI_ERROR (Status)) {
-    return Status;
+  if (!Ring->EventIdx ||
+      VirtioNeedEvent (*Ring->Used.AvailEvent, NextAvailIdx, LastUsedIdx)) {
+    Status = VirtIo->SetQueueNotify (VirtIo, VirtQueueId);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
   }
 
   //
@@ -47,7 +47,12 @@ typedef struct {
   // It seems to be sufficient for all I/O requests sent through
   // EFI_SCSI_PASS_THRU_PROTOCOL.PassThru() for common boot scenarios.
   //
-  UINT8                           Data[0x2000];
+  // Larger requests are rejected with the maximum transfer length, which
+  // makes ScsiDiskDxe split reads and writes into requests of this size, so
+  // 64KB (as in LsiScsiDxe) keeps the number of round trips to the device
+  // down when loading large files.
+  //
+  UINT8                           Data[SIZE_64KB];
 } MPT_SCSI_DMA_BUFFER;
 
 #define MPT_SCSI_DEV_SIGNATURE SIGNATURE_32 ('M','P','T','S')
@@ -791,22 +791,29 @@ QemuInitializeRam (
     SetMem (&MtrrSettings.Fixed, sizeof MtrrSettings.Fixed, 0x06);
     ZeroMem (&MtrrSettings.Variables, sizeof MtrrSettings.Variables);
     MtrrSettings.MtrrDefType |= BIT11 | BIT10 | 6;
-    MtrrSetAllMtrrs (&MtrrSettings);
 
     //
     // Set memory range from 640KB to 1MB to uncacheable
     //
-    Status = MtrrSetMemoryAttribute (BASE_512KB + BASE_128KB,
-               BASE_1MB - (BASE_512KB + BASE_128KB), CacheUncacheable);
+    Status = MtrrSetMemoryAttributeInMtrrSettings (&MtrrSettings,
+               BASE_512KB + BASE_128KB, BASE_1MB - (BASE_512KB + BASE_128KB),
+               CacheUncacheable);
     ASSERT_EFI_ERROR (Status);
 
     //
     // Set the memory range from the start of the 32-bit MMIO area (32-bit PCI
     // MMIO aperture on i440fx, PCIEXBAR on q35) to 4GB as uncacheable.
     //
-    Status = MtrrSetMemoryAttribute (mQemuUc32Base, SIZE_4GB - mQemuUc32Base,
-               CacheUncacheable);
+    Status = MtrrSetMemoryAttributeInMtrrSettings (&MtrrSettings,
+               mQemuUc32Base, SIZE_4GB - mQemuUc32Base, CacheUncacheable);
     ASSERT_EFI_ERROR (Status);
+
+    //
+    // The ranges above were calculated on top of the WB default in the
+    // settings buffer; program the processor only once, so that caching is
+    // disabled for a single MTRR update instead of one per range.
+    //
+    MtrrSetAllMtrrs (&MtrrSettings);
   }
 }
 
@@ -64,6 +64,19 @@ STATIC KERNEL_BLOB mKernelBlob[KernelBlobTypeMax] = {
 
 STATIC UINT64 mTotalBlobBytes;
 
+STATIC
+VOID
+ReadBlobData (
+  IN  CONST KERNEL_BLOB *Blob,
+  OUT UINT8             *Buffer
+  );
+
+STATIC
+EFI_STATUS
+FetchBlob (
+  IN OUT KERNEL_BLOB *Blob
+  );
+
 //
 // Device path for the handle that incorporates our "EFI stub filesystem".
 //
@@ -352,8 +365,9 @@ StubFileRead (
   )
 {
   STUB_FILE         *StubFile;
-  CONST KERNEL_BLOB *Blob;
+  KERNEL_BLOB       *Blob;
   UINT64            Left;
+  EFI_STATUS        Status;
 
   StubFile = STUB_FILE_FROM_FILE (This);
 
@@ -361,8 +375,6 @@ StubFileRead (
   // Scanning the root directory?
   //
   if (StubFile->BlobType == KernelBlobTypeMax) {
-    EFI_STATUS Status;
-
     if (StubFile->Position == KernelBlobTypeMax) {
       //
       // Scanning complete.
@@ -391,6 +403,16 @@ StubFileRead (
     return EFI_DEVICE_ERROR;
   }
 
+  //
+  // The initrd is only downloaded when it is first needed.
+  //
+  if (Blob->Data == NULL && Blob->Size > 0) {
+    Status = FetchBlob (Blob);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+  }
+
   Left = Blob->Size - StubFile->Position;
   if (*BufferSize > Left) {
     *BufferSize = (UINTN)Left;
@@ -893,7 +915,15 @@ InitrdLoadFile2 (
     return EFI_BUFFER_TOO_SMALL;
   }
 
-  CopyMem (Buffer, InitrdBlob->Data, InitrdBlob->Size);
+  //
+  // Unless the initrd has already been downloaded for the SimpleFileSystem,
+  // transfer it from fw_cfg straight into the buffer of the caller.
+  //
+  if (InitrdBlob->Data != NULL) {
+    CopyMem (Buffer, InitrdBlob->Data, InitrdBlob->Size);
+  } else {
+    ReadBlobData (InitrdBlob, Buffer);
+  }
 
   *BufferSize = InitrdBlob->Size;
   return EFI_SUCCESS;
@@ -908,30 +938,19 @@ STATIC CONST EFI_LOAD_FILE2_PROTOCOL     mInitrdLoadFile2 = {
 //
 
 /**
-  Populate a blob in mKernelBlob.
+  Read the size of a blob in mKernelBlob from fw_cfg.
 
-  param[in,out] Blob  Pointer to the KERNEL_BLOB element in mKernelBlob that is
-                      to be filled from fw_cfg.
-
-  @retval EFI_SUCCESS           Blob has been populated. If fw_cfg reported a
-                                size of zero for the blob, then Blob->Data has
-                                been left unchanged.
-
-  @retval EFI_OUT_OF_RESOURCES  Failed to allocate memory for Blob->Data.
+  param[in,out] Blob  Pointer to the KERNEL_BLOB element in mKernelBlob whose
+                      Size fields are to be filled from fw_cfg.
 **/
 STATIC
-EFI_STATUS
-FetchBlob (
+VOID
+FetchBlobSize (
   IN OUT KERNEL_BLOB *Blob
   )
 {
-  UINT32 Left;
   UINTN  Idx;
-  UINT8  *ChunkData;
 
-  //
-  // Read blob size.
-  //
   Blob->Size = 0;
   for (Idx = 0; Idx < ARRAY_SIZE (Blob->FwCfgItem); Idx++) {
     if (Blob->FwCfgItem[Idx].SizeKey == 0) {
@@ -941,44 +960,78 @@ FetchBlob (
     Blob->FwCfgItem[Idx].Size = QemuFwCfgRead32 ();
     Blob->Size += Blob->FwCfgItem[Idx].Size;
   }
-  if (Blob->Size == 0) {
-    return EFI_SUCCESS;
-  }
+}
 
-  //
-  // Read blob.
-  //
-  Blob->Data = AllocatePages (EFI_SIZE_TO_PAGES ((UINTN)Blob->Size));
-  if (Blob->Data == NULL) {
-    DEBUG ((DEBUG_ERROR, "%a: failed to allocate %Ld bytes for \"%s\"\n",
-      __FUNCTION__, (INT64)Blob->Size, Blob->Name));
-    return EFI_OUT_OF_RESOURCES;
-  }
+/**
+  Transfer the contents of a blob in mKernelBlob from fw_cfg.
+
+  param[in]  Blob     Pointer to the KERNEL_BLOB element in mKernelBlob, whose
+                      size has been read with FetchBlobSize().
+
+  param[out] Buffer   The buffer to fill. It must be at least Blob->Size bytes
+                      in size.
+**/
+STATIC
+VOID
+ReadBlobData (
+  IN  CONST KERNEL_BLOB *Blob,
+  OUT UINT8             *Buffer
+  )
+{
+  UINTN  Idx;
+  UINT8  *ChunkData;
 
   DEBUG ((DEBUG_INFO, "%a: loading %Ld bytes for \"%s\"\n", __FUNCTION__,
     (INT64)Blob->Size, Blob->Name));
 
-  ChunkData = Blob->Data;
+  ChunkData = Buffer;
   for (Idx = 0; Idx < ARRAY_SIZE (Blob->FwCfgItem); Idx++) {
     if (Blob->FwCfgItem[Idx].DataKey == 0) {
       break;
     }
     QemuFwCfgSelectItem (Blob->FwCfgItem[Idx].DataKey);
 
-    Left = Blob->FwCfgItem[Idx].Size;
-    while (Left > 0) {
-      UINT32 Chunk;
-
-      Chunk = (Left < SIZE_1MB) ? Left : SIZE_1MB;
-      QemuFwCfgReadBytes (Chunk, ChunkData + Blob->FwCfgItem[Idx].Size - Left);
-      Left -= Chunk;
-      DEBUG ((DEBUG_VERBOSE, "%a: %Ld bytes remaining for \"%s\" (%d)\n",
-        __FUNCTION__, (INT64)Left, Blob->Name, (INT32)Idx));
-    }
+    //
+    // Transfer the whole item at once; QemuFwCfgLib bounds the size of the
+    // individual DMA transfers itself if it needs bounce buffers.
+    //
+    QemuFwCfgReadBytes (Blob->FwCfgItem[Idx].Size, ChunkData);
 
     ChunkData += Blob->FwCfgItem[Idx].Size;
   }
+}
+
+/**
+  Populate a blob in mKernelBlob, whose size has been read with
+  FetchBlobSize().
+
+  param[in,out] Blob  Pointer to the KERNEL_BLOB element in mKernelBlob that is
+                      to be filled from fw_cfg.
+
+  @retval EFI_SUCCESS           Blob has been populated. If fw_cfg reported a
+                                size of zero for the blob, then Blob->Data has
+                                been left unchanged.
+
+  @retval EFI_OUT_OF_RESOURCES  Failed to allocate memory for Blob->Data.
+**/
+STATIC
+EFI_STATUS
+FetchBlob (
+  IN OUT KERNEL_BLOB *Blob
+  )
+{
+  if (Blob->Size == 0) {
+    return EFI_SUCCESS;
+  }
 
+  Blob->Data = AllocatePages (EFI_SIZE_TO_PAGES ((UINTN)Blob->Size));
+  if (Blob->Data == NULL) {
+    DEBUG ((DEBUG_ERROR, "%a: failed to allocate %Ld bytes for \"%s\"\n",
+      __FUNCTION__, (INT64)Blob->Size, Blob->Name));
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  ReadBlobData (Blob, Blob->Data);
   return EFI_SUCCESS;
 }
 
@@ -1025,13 +1078,18 @@ QemuKernelLoaderFsDxeEntrypoint (
   }
 
   //
-  // Fetch all blobs.
+  // Fetch the kernel, and the sizes of all blobs. The initrd is downloaded
+  // only when it is first read: through LoadFile2, it is transferred straight
+  // into the buffer that the kernel's EFI stub allocates for it.
   //
   for (BlobType = 0; BlobType < KernelBlobTypeMax; ++BlobType) {
     CurrentBlob = &mKernelBlob[BlobType];
-    Status = FetchBlob (CurrentBlob);
-    if (EFI_ERROR (Status)) {
-      goto FreeBlobs;
+    FetchBlobSize (CurrentBlob);
+    if (BlobType == KernelBlobTypeKernel) {
+      Status = FetchBlob (CurrentBlob);
+      if (EFI_ERROR (Status)) {
+        goto FreeBlobs;
+      }
     }
     mTotalBlobBytes += CurrentBlob->Size;
   }
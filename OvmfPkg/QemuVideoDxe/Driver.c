@@ -358,6 +358,13 @@ QemuVideoControllerDriverStart (
     }
   }
 
+  //
+  // Optionally map the framebuffer write-combining.
+  //
+  if (FeaturePcdGet (PcdQemuVideoWriteCombining)) {
+    QemuVideoSetFrameBufferWriteCombining (Private);
+  }
+
   //
   // Get ParentDevicePath
   //
@@ -483,6 +490,7 @@ FreeGopDevicePath:
   FreePool (Private->GopDevicePath);
 
 RestoreAttributes:
+  QemuVideoRestoreFrameBufferAttributes (Private);
   Private->PciIo->Attributes (Private->PciIo, EfiPciIoAttributeOperationSet,
                     Private->OriginalPciAttributes, NULL);
 
@@ -577,6 +585,8 @@ QemuVideoControllerDriverStop (
     return Status;
   }
 
+  QemuVideoRestoreFrameBufferAttributes (Private);
+
   //
   // Restore original PCI attributes
   //
@@ -607,6 +617,113 @@ QemuVideoControllerDriverStop (
   return EFI_SUCCESS;
 }
 
+/**
+  Map the framebuffer BAR write-combining in the GCD memory space map.
+
+  CpuDxe translates the GCD attribute change into MTRR programming. The BAR is
+  naturally aligned and sized to a power of two, so it fits a single variable
+  MTRR. Failure is not fatal; the framebuffer simply stays uncached.
+
+  @param[in,out] Private  The device context. On success the original memory
+                          space attributes are saved for
+                          QemuVideoRestoreFrameBufferAttributes().
+**/
+VOID
+QemuVideoSetFrameBufferWriteCombining (
+  IN OUT QEMU_VIDEO_PRIVATE_DATA  *Private
+  )
+{
+  EFI_STATUS                        Status;
+  EFI_ACPI_ADDRESS_SPACE_DESCRIPTOR *FrameBufDesc;
+  EFI_GCD_MEMORY_SPACE_DESCRIPTOR   GcdDescriptor;
+  EFI_PHYSICAL_ADDRESS              Base;
+  UINT64                            Size;
+
+  Status = Private->PciIo->GetBarAttributes (
+                             Private->PciIo,
+                             Private->FrameBufferVramBarIndex,
+                             NULL,
+                             (VOID**) &FrameBufDesc
+                             );
+  if (EFI_ERROR (Status)) {
+    return;
+  }
+  Base = FrameBufDesc->AddrRangeMin;
+  Size = FrameBufDesc->AddrLen;
+  FreePool (FrameBufDesc);
+
+  if (Size == 0) {
+    return;
+  }
+
+  //
+  // The whole BAR must be covered by a single GCD memory space descriptor for
+  // the attribute change to be applied uniformly.
+  //
+  Status = gDS->GetMemorySpaceDescriptor (Base, &GcdDescriptor);
+  if (EFI_ERROR (Status) ||
+      GcdDescriptor.GcdMemoryType != EfiGcdMemoryTypeMemoryMappedIo ||
+      GcdDescriptor.BaseAddress + GcdDescriptor.Length < Base + Size) {
+    DEBUG ((DEBUG_WARN, "%a: no suitable GCD entry for 0x%Lx+0x%Lx\n",
+      __FUNCTION__, Base, Size));
+    return;
+  }
+
+  if ((GcdDescriptor.Capabilities & EFI_MEMORY_WC) == 0) {
+    Status = gDS->SetMemorySpaceCapabilities (
+                    GcdDescriptor.BaseAddress,
+                    GcdDescriptor.Length,
+                    GcdDescriptor.Capabilities | EFI_MEMORY_WC
+                    );
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_WARN, "%a: SetMemorySpaceCapabilities(): %r\n",
+        __FUNCTION__, Status));
+      return;
+    }
+  }
+
+  Status = gDS->SetMemorySpaceAttributes (
+                  Base,
+                  Size,
+                  (GcdDescriptor.Attributes & ~EFI_CACHE_ATTRIBUTE_MASK) |
+                  EFI_MEMORY_WC
+                  );
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_WARN, "%a: SetMemorySpaceAttributes(): %r\n",
+      __FUNCTION__, Status));
+    return;
+  }
+
+  DEBUG ((DEBUG_INFO, "QemuVideo: framebuffer 0x%Lx+0x%Lx mapped WC\n",
+    Base, Size));
+  Private->FrameBufferBase               = Base;
+  Private->FrameBufferSize               = Size;
+  Private->FrameBufferOriginalAttributes = GcdDescriptor.Attributes;
+  Private->FrameBufferWriteCombining     = TRUE;
+}
+
+/**
+  Undo QemuVideoSetFrameBufferWriteCombining(), if it took effect.
+
+  @param[in,out] Private  The device context.
+**/
+VOID
+QemuVideoRestoreFrameBufferAttributes (
+  IN OUT QEMU_VIDEO_PRIVATE_DATA  *Private
+  )
+{
+  if (!Private->FrameBufferWriteCombining) {
+    return;
+  }
+
+  gDS->SetMemorySpaceAttributes (
+         Private->FrameBufferBase,
+         Private->FrameBufferSize,
+         Private->FrameBufferOriginalAttributes
+         );
+  Private->FrameBufferWriteCombining = FALSE;
+}
+
 /**
   TODO: Add function description
 
@@ -14,7 +14,7 @@
 #define _QEMU_H_
 
 
-#include <Uefi.h>
+#include <PiDxe.h>
 #include <Protocol/GraphicsOutput.h>
 #include <Protocol/PciIo.h>
 #include <Protocol/DriverSupportedEfiVersion.h>
@@ -26,6 +26,7 @@
 #include <Library/PcdLib.h>
 #include <Library/MemoryAllocationLib.h>
 #include <Library/UefiBootServicesTableLib.h>
+#include <Library/DxeServicesTableLib.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/DevicePathLib.h>
 #include <Library/TimerLib.h>
@@ -116,6 +117,15 @@ typedef struct {
   FRAME_BUFFER_CONFIGURE                *FrameBufferBltConfigure;
   UINTN                                 FrameBufferBltConfigureSize;
   UINT8                                 FrameBufferVramBarIndex;
+
+  //
+  // Set when the framebuffer BAR has been remapped write-combining; the
+  // original GCD memory space attributes are restored on Stop().
+  //
+  BOOLEAN                               FrameBufferWriteCombining;
+  EFI_PHYSICAL_ADDRESS                  FrameBufferBase;
+  UINT64                                FrameBufferSize;
+  UINT64                                FrameBufferOriginalAttributes;
 } QEMU_VIDEO_PRIVATE_DATA;
 
 ///
@@ -498,6 +508,16 @@ QemuVideoBochsModeSetup (
   BOOLEAN                  IsQxl
   );
 
+VOID
+QemuVideoSetFrameBufferWriteCombining (
+  IN OUT QEMU_VIDEO_PRIVATE_DATA  *Private
+  );
+
+VOID
+QemuVideoRestoreFrameBufferAttributes (
+  IN OUT QEMU_VIDEO_PRIVATE_DATA  *Private
+  );
+
 VOID
 InstallVbeShim (
   IN CONST CHAR16         *CardName,
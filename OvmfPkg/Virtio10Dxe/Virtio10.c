@@ -455,7 +455,11 @@ Virtio10SetQueueAddress (
 
   Dev = VIRTIO_1_0_FROM_VIRTIO_DEVICE (This);
 
-  Address = (UINTN)Ring->Desc;
+  //
+  // For a packed ring, the descriptor area holds the descriptor ring, while
+  // the driver and device areas hold the event suppression structures.
+  //
+  Address = Ring->Packed ? (UINTN)Ring->PackedDesc : (UINTN)Ring->Desc;
   Address += RingBaseShift;
   Status = Virtio10Transfer (Dev->PciIo, &Dev->CommonConfig, TRUE,
              OFFSET_OF (VIRTIO_PCI_COMMON_CFG, QueueDesc),
@@ -464,7 +468,7 @@ Virtio10SetQueueAddress (
     return Status;
   }
 
-  Address = (UINTN)Ring->Avail.Flags;
+  Address = Ring->Packed ? (UINTN)Ring->DriverEvent : (UINTN)Ring->Avail.Flags;
   Address += RingBaseShift;
   Status = Virtio10Transfer (Dev->PciIo, &Dev->CommonConfig, TRUE,
              OFFSET_OF (VIRTIO_PCI_COMMON_CFG, QueueAvail),
@@ -473,7 +477,7 @@ Virtio10SetQueueAddress (
     return Status;
   }
 
-  Address = (UINTN)Ring->Used.Flags;
+  Address = Ring->Packed ? (UINTN)Ring->DeviceEvent : (UINTN)Ring->Used.Flags;
   Address += RingBaseShift;
   Status = Virtio10Transfer (Dev->PciIo, &Dev->CommonConfig, TRUE,
              OFFSET_OF (VIRTIO_PCI_COMMON_CFG, QueueUsed),
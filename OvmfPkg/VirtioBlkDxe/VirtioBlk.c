@@ -6,9 +6,10 @@
 
   - No attach/detach (ie. removable media).
 
-  - Although the non-blocking interfaces of EFI_BLOCK_IO2_PROTOCOL could be a
-    good match for multiple in-flight virtio-blk requests, we stick to
-    synchronous requests and EFI_BLOCK_IO_PROTOCOL for now.
+  - Up to VBLK_MAX_REQUESTS virtio-blk requests are kept in flight on the
+    virtqueue, for EFI_BLOCK_IO2_PROTOCOL callers, and for blocking requests
+    that must be split because of the host's segment limits. Completions are
+    polled; host interrupts are not used.
 
   Copyright (C) 2012, Red Hat, Inc.
   Copyright (c) 2012 - 2018, Intel Corporation. All rights reserved.<BR>
@@ -18,7 +19,6 @@
 
 **/
 
-#include <IndustryStandard/VirtioBlk.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/DebugLib.h>
 #include <Library/MemoryAllocationLib.h>
@@ -178,8 +178,435 @@ VerifyReadWriteRequest (
 
 /**
 
-  Format a read / write / flush request as three consecutive virtio
-  descriptors, push them to the host, and poll for the response.
+  Complete a request slot whose head descriptor the host has returned in the
+  used ring.
+
+  The data buffer is unmapped and the host status is translated. Slots of
+  EFI_BLOCK_IO2_PROTOCOL requests are released here, and the token is signaled
+  when the last virtio-blk request carrying it completes. Slots of blocking
+  requests are released by their submitter.
+
+  Must be called at TPL_NOTIFY.
+
+  @param[in out] Dev      The virtio-blk device.
+
+  @param[in]     SlotIdx  The slot to complete.
+
+**/
+
+STATIC
+VOID
+VirtioBlkCompleteSlot (
+  IN OUT VBLK_DEV *Dev,
+  IN     UINT16   SlotIdx
+  )
+{
+  VBLK_SLOT        *Slot;
+  VBLK_IO2_REQUEST *Io2Request;
+  EFI_STATUS       Status;
+  EFI_STATUS       UnmapStatus;
+
+  Slot   = &Dev->Slots[SlotIdx];
+  Status = (Dev->SharedReq[SlotIdx].HostStatus == VIRTIO_BLK_S_OK) ?
+           EFI_SUCCESS : EFI_DEVICE_ERROR;
+
+  if (Slot->BufferSize > 0) {
+    UnmapStatus = Dev->VirtIo->UnmapSharedBuffer (Dev->VirtIo,
+                                 Slot->BufferMapping);
+    if (EFI_ERROR (UnmapStatus) && !Slot->RequestIsWrite &&
+        !EFI_ERROR (Status)) {
+      //
+      // Data from the bus master may not reach the caller; fail the request.
+      //
+      Status = EFI_DEVICE_ERROR;
+    }
+  }
+
+  Slot->Status = Status;
+  Slot->Done   = TRUE;
+
+  Io2Request = Slot->Io2Request;
+  if (Io2Request == NULL) {
+    return;
+  }
+
+  Slot->InUse = FALSE;
+  if (EFI_ERROR (Status)) {
+    Io2Request->Token->TransactionStatus = Status;
+  }
+  if (--Io2Request->Pending == 0 && Io2Request->Submitted) {
+    gBS->SignalEvent (Io2Request->Token->Event);
+    FreePool (Io2Request);
+  }
+}
+
+
+/**
+
+  Walk the used ring and complete the request slots the host has processed.
+
+  Must be called at TPL_NOTIFY.
+
+  @param[in out] Dev  The virtio-blk device.
+
+**/
+
+STATIC
+VOID
+VirtioBlkReapCompletions (
+  IN OUT VBLK_DEV *Dev
+  )
+{
+  volatile CONST VRING_USED_ELEM *UsedElem;
+  UINT16                         SlotIdx;
+
+  MemoryFence ();
+  while (Dev->LastUsedIdx != *Dev->Ring.Used.Idx) {
+    MemoryFence ();
+    UsedElem = &Dev->Ring.Used.UsedElem[Dev->LastUsedIdx % Dev->Ring.QueueSize];
+    SlotIdx  = (UINT16) (UsedElem->Id / Dev->DescPerSlot);
+    Dev->LastUsedIdx++;
+
+    ASSERT (SlotIdx < Dev->NumSlots);
+    ASSERT (Dev->Slots[SlotIdx].InUse);
+    VirtioBlkCompleteSlot (Dev, SlotIdx);
+  }
+}
+
+
+/**
+
+  Timer notification function that reaps completed requests on behalf of
+  EFI_BLOCK_IO2_PROTOCOL callers.
+
+  @param[in] Event    Event whose notification function is being invoked.
+
+  @param[in] Context  Pointer to the VBLK_DEV structure.
+
+**/
+
+STATIC
+VOID
+EFIAPI
+VirtioBlkCompletionTimer (
+  IN  EFI_EVENT Event,
+  IN  VOID      *Context
+  )
+{
+  VirtioBlkReapCompletions (Context);
+}
+
+
+/**
+
+  Find a free request slot.
+
+  Must be called at TPL_NOTIFY.
+
+  @param[in out] Dev      The virtio-blk device.
+
+  @param[out]    SlotIdx  The free slot, marked in use.
+
+  @retval TRUE   A slot has been allocated.
+
+  @retval FALSE  All slots are in flight.
+
+**/
+
+STATIC
+BOOLEAN
+VirtioBlkAllocateSlot (
+  IN OUT VBLK_DEV *Dev,
+  OUT    UINT16   *SlotIdx
+  )
+{
+  UINT16 Idx;
+
+  for (Idx = 0; Idx < Dev->NumSlots; Idx++) {
+    if (!Dev->Slots[Idx].InUse) {
+      ZeroMem (&Dev->Slots[Idx], sizeof Dev->Slots[Idx]);
+      Dev->Slots[Idx].InUse = TRUE;
+      *SlotIdx = Idx;
+      return TRUE;
+    }
+  }
+  return FALSE;
+}
+
+
+/**
+
+  Format a read / write / flush request in a request slot, push it to the
+  host, and return without waiting for the response.
+
+  The virtio-blk header and the host status live in the slot's part of
+  Dev->SharedReq. When indirect descriptors have been negotiated, the request
+  occupies a single descriptor of the ring, pointing to the slot's indirect
+  table which may carry up to Dev->MaxSegments data descriptors. Otherwise the
+  request occupies the slot's three consecutive ring descriptors, as in
+  virtio-0.9.5, Appendix D.
+
+  Must be called at TPL_NOTIFY, with BufferSize not exceeding
+  Dev->MaxTransferSize.
+
+  @param[in out] Dev             The virtio-blk device.
+
+  @param[in]     SlotIdx         A slot returned by VirtioBlkAllocateSlot().
+
+  @param[in]     Lba             See SynchronousRequest().
+
+  @param[in]     BufferSize      See SynchronousRequest().
+
+  @param[in out] Buffer          See SynchronousRequest().
+
+  @param[in]     RequestIsWrite  See SynchronousRequest().
+
+  @param[in]     Io2Request      The EFI_BLOCK_IO2_PROTOCOL request the slot
+                                 belongs to, or NULL for blocking requests.
+
+  @retval EFI_SUCCESS       The request has been queued.
+
+  @retval EFI_DEVICE_ERROR  Failed to map Buffer for a bus master operation,
+                            or to notify the host. The slot has been released.
+
+**/
+
+STATIC
+EFI_STATUS
+VirtioBlkSubmitSlot (
+  IN OUT          VBLK_DEV         *Dev,
+  IN              UINT16           SlotIdx,
+  IN              EFI_LBA          Lba,
+  IN              UINTN            BufferSize,
+  IN OUT volatile VOID             *Buffer,
+  IN              BOOLEAN          RequestIsWrite,
+  IN              VBLK_IO2_REQUEST *Io2Request     OPTIONAL
+  )
+{
+  VBLK_SLOT            *Slot;
+  VBLK_SHARED_REQ      *Shared;
+  EFI_PHYSICAL_ADDRESS SharedDeviceAddress;
+  EFI_PHYSICAL_ADDRESS BufferDeviceAddress;
+  DESC_INDICES         Indices;
+  UINT16               DataFlags;
+  UINT16               Head;
+  UINT16               NumDesc;
+  UINT32               SegmentSize;
+  UINTN                Remaining;
+  EFI_STATUS           Status;
+
+  Slot                = &Dev->Slots[SlotIdx];
+  Shared              = &Dev->SharedReq[SlotIdx];
+  SharedDeviceAddress = Dev->SharedReqDeviceAddress +
+                        SlotIdx * sizeof (VBLK_SHARED_REQ);
+  BufferDeviceAddress = 0;
+
+  ASSERT (BufferSize <= Dev->MaxTransferSize);
+
+  Slot->RequestIsWrite = RequestIsWrite;
+  Slot->BufferSize     = BufferSize;
+  Slot->Io2Request     = Io2Request;
+
+  //
+  // Prepare virtio-blk request header, setting zero size for flush.
+  // IO Priority is homogeneously 0.
+  //
+  Shared->Header.Type   = RequestIsWrite ?
+                          (BufferSize == 0 ? VIRTIO_BLK_T_FLUSH : VIRTIO_BLK_T_OUT) :
+                          VIRTIO_BLK_T_IN;
+  Shared->Header.IoPrio = 0;
+  Shared->Header.Sector = MultU64x32 (Lba, Dev->BlockIoMedia.BlockSize / 512);
+
+  //
+  // preset a host status for ourselves that we do not accept as success
+  //
+  Shared->HostStatus = VIRTIO_BLK_S_IOERR;
+
+  //
+  // Map data buffer
+  //
+  if (BufferSize > 0) {
+    Status = VirtioMapAllBytesInSharedBuffer (
+               Dev->VirtIo,
+               (RequestIsWrite ?
+                VirtioOperationBusMasterRead :
+                VirtioOperationBusMasterWrite),
+               (VOID *) Buffer,
+               BufferSize,
+               &BufferDeviceAddress,
+               &Slot->BufferMapping
+               );
+    if (EFI_ERROR (Status)) {
+      Slot->InUse = FALSE;
+      return EFI_DEVICE_ERROR;
+    }
+  }
+
+  //
+  // VRING_DESC_F_WRITE is interpreted from the host's point of view.
+  //
+  DataFlags = VRING_DESC_F_NEXT | (RequestIsWrite ? 0 : VRING_DESC_F_WRITE);
+  Head      = (UINT16) (SlotIdx * Dev->DescPerSlot);
+
+  if (Dev->IndirectDesc) {
+    //
+    // virtio-1.0, 2.4.5.3 Indirect Descriptors: the table is laid out like a
+    // descriptor chain of its own, indexed from zero.
+    //
+    NumDesc = 0;
+    Shared->Indirect[NumDesc].Addr  = SharedDeviceAddress +
+                                      OFFSET_OF (VBLK_SHARED_REQ, Header);
+    Shared->Indirect[NumDesc].Len   = sizeof Shared->Header;
+    Shared->Indirect[NumDesc].Flags = VRING_DESC_F_NEXT;
+    Shared->Indirect[NumDesc].Next  = NumDesc + 1;
+    NumDesc++;
+
+    for (Remaining = BufferSize; Remaining > 0; Remaining -= SegmentSize) {
+      ASSERT (NumDesc <= Dev->MaxSegments);
+      SegmentSize = (UINT32) MIN (Remaining, Dev->MaxSegmentSize);
+      Shared->Indirect[NumDesc].Addr  = BufferDeviceAddress;
+      Shared->Indirect[NumDesc].Len   = SegmentSize;
+      Shared->Indirect[NumDesc].Flags = DataFlags;
+      Shared->Indirect[NumDesc].Next  = NumDesc + 1;
+      NumDesc++;
+      BufferDeviceAddress += SegmentSize;
+    }
+
+    Shared->Indirect[NumDesc].Addr  = SharedDeviceAddress +
+                                      OFFSET_OF (VBLK_SHARED_REQ, HostStatus);
+    Shared->Indirect[NumDesc].Len   = sizeof Shared->HostStatus;
+    Shared->Indirect[NumDesc].Flags = VRING_DESC_F_WRITE;
+    Shared->Indirect[NumDesc].Next  = 0;
+    NumDesc++;
+
+    Dev->Ring.Desc[Head].Addr  = SharedDeviceAddress +
+                                 OFFSET_OF (VBLK_SHARED_REQ, Indirect);
+    Dev->Ring.Desc[Head].Len   = NumDesc * sizeof (VRING_DESC);
+    Dev->Ring.Desc[Head].Flags = VRING_DESC_F_INDIRECT;
+    Dev->Ring.Desc[Head].Next  = 0;
+  } else {
+    Indices.HeadDescIdx = Head;
+    Indices.NextDescIdx = Head;
+
+    //
+    // virtio-blk header in first desc
+    //
+    VirtioAppendDesc (
+      &Dev->Ring,
+      SharedDeviceAddress + OFFSET_OF (VBLK_SHARED_REQ, Header),
+      sizeof Shared->Header,
+      VRING_DESC_F_NEXT,
+      &Indices
+      );
+
+    //
+    // data buffer for read/write in second desc; Dev->MaxTransferSize equals
+    // Dev->MaxSegmentSize without indirect descriptors
+    //
+    if (BufferSize > 0) {
+      VirtioAppendDesc (
+        &Dev->Ring,
+        BufferDeviceAddress,
+        (UINT32) BufferSize,
+        DataFlags,
+        &Indices
+        );
+    }
+
+    //
+    // host status in last (second or third) desc
+    //
+    VirtioAppendDesc (
+      &Dev->Ring,
+      SharedDeviceAddress + OFFSET_OF (VBLK_SHARED_REQ, HostStatus),
+      sizeof Shared->HostStatus,
+      VRING_DESC_F_WRITE,
+      &Indices
+      );
+  }
+
+  //
+  // virtio-0.9.5, 2.4.1.2 Updating the Available Ring, and 2.4.1.3 Updating
+  // the Index Field
+  //
+  Dev->Ring.Avail.Ring[Dev->NextAvailIdx++ % Dev->Ring.QueueSize] = Head;
+  MemoryFence ();
+  *Dev->Ring.Avail.Idx = Dev->NextAvailIdx;
+
+  //
+  // virtio-0.9.5, 2.4.1.4 Notifying the Device. virtio-blk's only virtqueue
+  // is #0, called "requestq" (see Appendix D).
+  //
+  // Each notification is a trap to the host, which is particularly costly on
+  // MMIO transports. With VIRTIO_F_RING_EVENT_IDX, the host publishes the
+  // available index it wants to be notified at (virtio-1.0, 2.4.7.2); while
+  // it is still working through earlier requests, it picks up this one
+  // without a notification. A single entry has been made available, so
+  // vring_need_event() reduces to checking whether the host waits for exactly
+  // that entry.
+  //
+  MemoryFence ();
+  Status = EFI_SUCCESS;
+  if (!Dev->EventIdx ||
+      (*Dev->Ring.Used.AvailEvent == (UINT16) (Dev->NextAvailIdx - 1))) {
+    Status = Dev->VirtIo->SetQueueNotify (Dev->VirtIo, 0);
+  }
+  if (EFI_ERROR (Status)) {
+    if (BufferSize > 0) {
+      Dev->VirtIo->UnmapSharedBuffer (Dev->VirtIo, Slot->BufferMapping);
+    }
+    Slot->InUse = FALSE;
+    return EFI_DEVICE_ERROR;
+  }
+
+  return EFI_SUCCESS;
+}
+
+
+/**
+
+  Wait until the host has processed every request in flight.
+
+  @param[in out] Dev  The virtio-blk device.
+
+**/
+
+STATIC
+VOID
+VirtioBlkWaitIdle (
+  IN OUT VBLK_DEV *Dev
+  )
+{
+  EFI_TPL OldTpl;
+  BOOLEAN Busy;
+  UINT16  Idx;
+  UINTN   PollPeriodUsecs;
+
+  PollPeriodUsecs = 1;
+  for (;;) {
+    OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+    VirtioBlkReapCompletions (Dev);
+    Busy = FALSE;
+    for (Idx = 0; Idx < Dev->NumSlots; Idx++) {
+      Busy |= Dev->Slots[Idx].InUse;
+    }
+    gBS->RestoreTPL (OldTpl);
+
+    if (!Busy) {
+      return;
+    }
+
+    gBS->Stall (PollPeriodUsecs);
+    if (PollPeriodUsecs < 1024) {
+      PollPeriodUsecs *= 2;
+    }
+  }
+}
+
+
+/**
+
+  Process a read / write / flush request synchronously.
 
   This is the main workhorse function. Two use cases are supported, read/write
   and flush. The function may only be called after the request parameters have
@@ -187,6 +614,11 @@ VerifyReadWriteRequest (
   - specific checks in ReadBlocks() / WriteBlocks() / FlushBlocks(), and
   - VerifyReadWriteRequest() (for read/write only).
 
+  Requests queued earlier through EFI_BLOCK_IO2_PROTOCOL are waited for first.
+  A read/write request larger than Dev->MaxTransferSize is then split into
+  several virtio-blk requests, all of which are kept in flight at the same
+  time as far as the request slots allow.
+
   Parameters handled commonly:
 
     @param[in] Dev             The virtio-blk device the request is targeted
@@ -242,29 +674,19 @@ SynchronousRequest (
   IN              BOOLEAN  RequestIsWrite
   )
 {
-  UINT32                  BlockSize;
-  volatile VIRTIO_BLK_REQ Request;
-  volatile UINT8          *HostStatus;
-  VOID                    *HostStatusBuffer;
-  DESC_INDICES            Indices;
-  VOID                    *RequestMapping;
-  VOID                    *StatusMapping;
-  VOID                    *BufferMapping;
-  EFI_PHYSICAL_ADDRESS    BufferDeviceAddress;
-  EFI_PHYSICAL_ADDRESS    HostStatusDeviceAddress;
-  EFI_PHYSICAL_ADDRESS    RequestDeviceAddress;
-  EFI_STATUS              Status;
-  EFI_STATUS              UnmapStatus;
+  UINT32     BlockSize;
+  UINT32     Owned;
+  UINT16     SlotIdx;
+  UINTN      Count;
+  UINTN      PollPeriodUsecs;
+  BOOLEAN    AllSubmitted;
+  BOOLEAN    Progress;
+  EFI_STATUS Status;
+  EFI_STATUS SlotStatus;
+  EFI_TPL    OldTpl;
 
   BlockSize = Dev->BlockIoMedia.BlockSize;
 
-  //
-  // Set BufferMapping and BufferDeviceAddress to suppress incorrect
-  // compiler/analyzer warnings.
-  //
-  BufferMapping       = NULL;
-  BufferDeviceAddress = 0;
-
   //
   // ensured by VirtioBlkInit()
   //
@@ -275,181 +697,181 @@ SynchronousRequest (
   // ensured by contract above, plus VerifyReadWriteRequest()
   //
   ASSERT (BufferSize % BlockSize == 0);
+  ASSERT (BufferSize <= SIZE_1GB);
+
+  VirtioBlkWaitIdle (Dev);
+
+  Status          = EFI_SUCCESS;
+  Owned           = 0;
+  AllSubmitted    = FALSE;
+  PollPeriodUsecs = 1;
+
+  while (Owned != 0 || (!AllSubmitted && !EFI_ERROR (Status))) {
+    Progress = FALSE;
+    OldTpl   = gBS->RaiseTPL (TPL_NOTIFY);
+
+    while (!AllSubmitted && !EFI_ERROR (Status) &&
+           VirtioBlkAllocateSlot (Dev, &SlotIdx)) {
+      Count = MIN (BufferSize, Dev->MaxTransferSize);
+      Status = VirtioBlkSubmitSlot (Dev, SlotIdx, Lba, Count, Buffer,
+                 RequestIsWrite, NULL);
+      if (EFI_ERROR (Status)) {
+        break;
+      }
+
+      Owned       |= (UINT32) 1 << SlotIdx;
+      Lba         += Count / BlockSize;
+      Buffer       = (volatile UINT8 *) Buffer + Count;
+      BufferSize  -= Count;
+      AllSubmitted = (BOOLEAN) (BufferSize == 0);
+      Progress     = TRUE;
+    }
 
-  //
-  // Prepare virtio-blk request header, setting zero size for flush.
-  // IO Priority is homogeneously 0.
-  //
-  Request.Type   = RequestIsWrite ?
-                   (BufferSize == 0 ? VIRTIO_BLK_T_FLUSH : VIRTIO_BLK_T_OUT) :
-                   VIRTIO_BLK_T_IN;
-  Request.IoPrio = 0;
-  Request.Sector = MultU64x32(Lba, BlockSize / 512);
+    VirtioBlkReapCompletions (Dev);
+
+    for (SlotIdx = 0; SlotIdx < Dev->NumSlots; SlotIdx++) {
+      if ((Owned & ((UINT32) 1 << SlotIdx)) == 0 ||
+          !Dev->Slots[SlotIdx].Done) {
+        continue;
+      }
+      SlotStatus = Dev->Slots[SlotIdx].Status;
+      if (EFI_ERROR (SlotStatus) && !EFI_ERROR (Status)) {
+        Status = SlotStatus;
+      }
+      Dev->Slots[SlotIdx].InUse = FALSE;
+      Owned   &= ~((UINT32) 1 << SlotIdx);
+      Progress = TRUE;
+    }
 
-  //
-  // Host status is bi-directional (we preset with a value and expect the
-  // device to update it). Allocate a host status buffer which can be mapped
-  // to access equally by both processor and the device.
-  //
-  Status = Dev->VirtIo->AllocateSharedPages (
-                          Dev->VirtIo,
-                          EFI_SIZE_TO_PAGES (sizeof *HostStatus),
-                          &HostStatusBuffer
-                          );
-  if (EFI_ERROR (Status)) {
-    return EFI_DEVICE_ERROR;
+    gBS->RestoreTPL (OldTpl);
+
+    //
+    // Keep slowing down until we reach a poll period of slightly above 1 ms,
+    // as long as the host does not complete anything.
+    //
+    if (Progress) {
+      PollPeriodUsecs = 1;
+    } else {
+      gBS->Stall (PollPeriodUsecs);
+      if (PollPeriodUsecs < 1024) {
+        PollPeriodUsecs *= 2;
+      }
+    }
   }
 
-  HostStatus = HostStatusBuffer;
+  return Status;
+}
 
-  //
-  // Map virtio-blk request header (must be done after request header is
-  // populated)
-  //
-  Status = VirtioMapAllBytesInSharedBuffer (
-             Dev->VirtIo,
-             VirtioOperationBusMasterRead,
-             (VOID *) &Request,
-             sizeof Request,
-             &RequestDeviceAddress,
-             &RequestMapping
-             );
-  if (EFI_ERROR (Status)) {
-    Status = EFI_DEVICE_ERROR;
-    goto FreeHostStatusBuffer;
-  }
 
-  //
-  // Map data buffer
-  //
-  if (BufferSize > 0) {
-    Status = VirtioMapAllBytesInSharedBuffer (
-               Dev->VirtIo,
-               (RequestIsWrite ?
-                VirtioOperationBusMasterRead :
-                VirtioOperationBusMasterWrite),
-               (VOID *) Buffer,
-               BufferSize,
-               &BufferDeviceAddress,
-               &BufferMapping
-               );
-    if (EFI_ERROR (Status)) {
-      Status = EFI_DEVICE_ERROR;
-      goto UnmapRequestBuffer;
-    }
-  }
+/**
 
-  //
-  // preset a host status for ourselves that we do not accept as success
-  //
-  *HostStatus = VIRTIO_BLK_S_IOERR;
+  Queue a read / write request for an EFI_BLOCK_IO2_PROTOCOL caller, split into
+  as many virtio-blk requests as Dev->MaxTransferSize requires.
 
-  //
-  // Map the Status Buffer with VirtioOperationBusMasterCommonBuffer so that
-  // both processor and device can access it.
-  //
-  Status = VirtioMapAllBytesInSharedBuffer (
-             Dev->VirtIo,
-             VirtioOperationBusMasterCommonBuffer,
-             HostStatusBuffer,
-             sizeof *HostStatus,
-             &HostStatusDeviceAddress,
-             &StatusMapping
-             );
-  if (EFI_ERROR (Status)) {
-    Status = EFI_DEVICE_ERROR;
-    goto UnmapDataBuffer;
-  }
+  When all request slots are in flight, the function waits for some to complete
+  before queuing the rest, so it returns only once every virtio-blk request has
+  been pushed to the host. Token->Event is signaled when the last of them
+  completes.
 
-  VirtioPrepare (&Dev->Ring, &Indices);
+  @param[in] Dev             The virtio-blk device.
 
-  //
-  // ensured by VirtioBlkInit() -- this predicate, in combination with the
-  // lock-step progress, ensures we don't have to track free descriptors.
-  //
-  ASSERT (Dev->Ring.QueueSize >= 3);
+  @param[in] Lba             See SynchronousRequest().
 
-  //
-  // virtio-blk header in first desc
-  //
-  VirtioAppendDesc (
-    &Dev->Ring,
-    RequestDeviceAddress,
-    sizeof Request,
-    VRING_DESC_F_NEXT,
-    &Indices
-    );
+  @param[in] BufferSize      See SynchronousRequest(). Must be positive.
 
-  //
-  // data buffer for read/write in second desc
-  //
-  if (BufferSize > 0) {
-    //
-    // From virtio-0.9.5, 2.3.2 Descriptor Table:
-    // "no descriptor chain may be more than 2^32 bytes long in total".
-    //
-    // The predicate is ensured by the call contract above (for flush), or
-    // VerifyReadWriteRequest() (for read/write). It also implies that
-    // converting BufferSize to UINT32 will not truncate it.
-    //
-    ASSERT (BufferSize <= SIZE_1GB);
+  @param[in out] Buffer      See SynchronousRequest().
 
-    //
-    // VRING_DESC_F_WRITE is interpreted from the host's point of view.
-    //
-    VirtioAppendDesc (
-      &Dev->Ring,
-      BufferDeviceAddress,
-      (UINT32) BufferSize,
-      VRING_DESC_F_NEXT | (RequestIsWrite ? 0 : VRING_DESC_F_WRITE),
-      &Indices
-      );
-  }
+  @param[in] RequestIsWrite  See SynchronousRequest().
 
-  //
-  // host status in last (second or third) desc
-  //
-  VirtioAppendDesc (
-    &Dev->Ring,
-    HostStatusDeviceAddress,
-    sizeof *HostStatus,
-    VRING_DESC_F_WRITE,
-    &Indices
-    );
+  @param[in out] Token       The token to signal.
 
-  //
-  // virtio-blk's only virtqueue is #0, called "requestq" (see Appendix D).
-  //
-  if (VirtioFlush (Dev->VirtIo, 0, &Dev->Ring, &Indices,
-        NULL) == EFI_SUCCESS &&
-      *HostStatus == VIRTIO_BLK_S_OK) {
-    Status = EFI_SUCCESS;
-  } else {
-    Status = EFI_DEVICE_ERROR;
-  }
+  @retval EFI_SUCCESS           At least one virtio-blk request has been
+                                queued. A failure of any of them is reported
+                                in Token->TransactionStatus.
 
-  Dev->VirtIo->UnmapSharedBuffer (Dev->VirtIo, StatusMapping);
+  @retval EFI_OUT_OF_RESOURCES  The request could not be tracked.
 
-UnmapDataBuffer:
-  if (BufferSize > 0) {
-    UnmapStatus = Dev->VirtIo->UnmapSharedBuffer (Dev->VirtIo, BufferMapping);
-    if (EFI_ERROR (UnmapStatus) && !RequestIsWrite && !EFI_ERROR (Status)) {
-      //
-      // Data from the bus master may not reach the caller; fail the request.
-      //
-      Status = EFI_DEVICE_ERROR;
-    }
+  @retval EFI_DEVICE_ERROR      Nothing could be queued. Token->Event will not
+                                be signaled.
+
+**/
+
+STATIC
+EFI_STATUS
+AsynchronousRequest (
+  IN              VBLK_DEV            *Dev,
+  IN              EFI_LBA             Lba,
+  IN              UINTN               BufferSize,
+  IN OUT volatile VOID                *Buffer,
+  IN              BOOLEAN             RequestIsWrite,
+  IN OUT          EFI_BLOCK_IO2_TOKEN *Token
+  )
+{
+  VBLK_IO2_REQUEST *Io2Request;
+  UINT32           BlockSize;
+  UINT16           SlotIdx;
+  UINTN            Count;
+  UINTN            Queued;
+  EFI_STATUS       Status;
+  EFI_TPL          OldTpl;
+
+  ASSERT (BufferSize > 0);
+
+  Io2Request = AllocateZeroPool (sizeof *Io2Request);
+  if (Io2Request == NULL) {
+    return EFI_OUT_OF_RESOURCES;
   }
+  Io2Request->Token        = Token;
+  Token->TransactionStatus = EFI_SUCCESS;
+  BlockSize                = Dev->BlockIoMedia.BlockSize;
+  Status                   = EFI_SUCCESS;
+  Queued                   = 0;
+
+  OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+  while (BufferSize > 0) {
+    if (!VirtioBlkAllocateSlot (Dev, &SlotIdx)) {
+      gBS->RestoreTPL (OldTpl);
+      gBS->Stall (1);
+      OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+      VirtioBlkReapCompletions (Dev);
+      continue;
+    }
 
-UnmapRequestBuffer:
-  Dev->VirtIo->UnmapSharedBuffer (Dev->VirtIo, RequestMapping);
+    Count = MIN (BufferSize, Dev->MaxTransferSize);
+    Status = VirtioBlkSubmitSlot (Dev, SlotIdx, Lba, Count, Buffer,
+               RequestIsWrite, Io2Request);
+    if (EFI_ERROR (Status)) {
+      break;
+    }
 
-FreeHostStatusBuffer:
-  Dev->VirtIo->FreeSharedPages (
-                 Dev->VirtIo,
-                 EFI_SIZE_TO_PAGES (sizeof *HostStatus),
-                 HostStatusBuffer
-                 );
+    Io2Request->Pending++;
+    Queued++;
+    Lba        += Count / BlockSize;
+    Buffer      = (volatile UINT8 *) Buffer + Count;
+    BufferSize -= Count;
+  }
+
+  Io2Request->Submitted = TRUE;
+  if (Queued == 0) {
+    //
+    // Nothing was queued; report the failure synchronously.
+    //
+    FreePool (Io2Request);
+  } else {
+    if (EFI_ERROR (Status)) {
+      Token->TransactionStatus = Status;
+      Status = EFI_SUCCESS;
+    }
+    //
+    // All virtio-blk requests may have completed while we were waiting for a
+    // free slot.
+    //
+    if (Io2Request->Pending == 0) {
+      gBS->SignalEvent (Token->Event);
+      FreePool (Io2Request);
+    }
+  }
+  gBS->RestoreTPL (OldTpl);
 
   return Status;
 }
@@ -604,6 +1026,198 @@ VirtioBlkFlushBlocks (
 }
 
 
+//
+// UEFI Spec 2.3.1 + Errata C, 12.9 EFI Block I/O 2 Protocol
+// Driver Writer's Guide for UEFI 2.3.1 v1.01,
+//   24.2 Block I/O Protocol Implementations
+//
+EFI_STATUS
+EFIAPI
+VirtioBlkResetEx (
+  IN EFI_BLOCK_IO2_PROTOCOL *This,
+  IN BOOLEAN                ExtendedVerification
+  )
+{
+  //
+  // Let the queued requests finish; see VirtioBlkReset() for the rest.
+  //
+  VirtioBlkWaitIdle (VIRTIO_BLK_FROM_BLOCK_IO2 (This));
+  return EFI_SUCCESS;
+}
+
+/**
+
+  Common part of ReadBlocksEx() and WriteBlocksEx().
+
+  @param[in] This            The EFI_BLOCK_IO2_PROTOCOL instance.
+
+  @param[in] Lba             See SynchronousRequest().
+
+  @param[in out] Token       The caller's token, possibly NULL.
+
+  @param[in] BufferSize      Size of buffer to transfer, in bytes.
+
+  @param[in out] Buffer      See SynchronousRequest().
+
+  @param[in] RequestIsWrite  See SynchronousRequest().
+
+  @return  Validation result from VerifyReadWriteRequest(), or the result of
+           SynchronousRequest() / AsynchronousRequest().
+
+**/
+
+STATIC
+EFI_STATUS
+VirtioBlkReadWriteBlocksEx (
+  IN     EFI_BLOCK_IO2_PROTOCOL *This,
+  IN     EFI_LBA                Lba,
+  IN OUT EFI_BLOCK_IO2_TOKEN    *Token,
+  IN     UINTN                  BufferSize,
+  IN OUT VOID                   *Buffer,
+  IN     BOOLEAN                RequestIsWrite
+  )
+{
+  VBLK_DEV   *Dev;
+  EFI_STATUS Status;
+  BOOLEAN    Blocking;
+
+  Dev      = VIRTIO_BLK_FROM_BLOCK_IO2 (This);
+  Blocking = (BOOLEAN) (Token == NULL || Token->Event == NULL);
+
+  if (BufferSize == 0) {
+    if (!Blocking) {
+      Token->TransactionStatus = EFI_SUCCESS;
+      gBS->SignalEvent (Token->Event);
+    }
+    return EFI_SUCCESS;
+  }
+
+  Status = VerifyReadWriteRequest (
+             &Dev->BlockIoMedia,
+             Lba,
+             BufferSize,
+             RequestIsWrite
+             );
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  if (Blocking) {
+    return SynchronousRequest (Dev, Lba, BufferSize, Buffer, RequestIsWrite);
+  }
+  return AsynchronousRequest (Dev, Lba, BufferSize, Buffer, RequestIsWrite,
+           Token);
+}
+
+/**
+
+  ReadBlocksEx() operation for virtio-blk.
+
+  See
+  - UEFI Spec 2.3.1 + Errata C, 12.9 EFI Block I/O 2 Protocol,
+    EFI_BLOCK_IO2_PROTOCOL.ReadBlocksEx().
+  - Driver Writer's Guide for UEFI 2.3.1 v1.01, 24.2.2. ReadBlocks() and
+    ReadBlocksEx() Implementation.
+
+  If Token is NULL or Token->Event is NULL, the request is processed
+  synchronously, as in ReadBlocks(). Otherwise the request is queued to the
+  virtqueue and Token->Event is signaled from the completion timer.
+
+**/
+
+EFI_STATUS
+EFIAPI
+VirtioBlkReadBlocksEx (
+  IN     EFI_BLOCK_IO2_PROTOCOL *This,
+  IN     UINT32                 MediaId,
+  IN     EFI_LBA                Lba,
+  IN OUT EFI_BLOCK_IO2_TOKEN    *Token,
+  IN     UINTN                  BufferSize,
+     OUT VOID                   *Buffer
+  )
+{
+  return VirtioBlkReadWriteBlocksEx (
+           This,
+           Lba,
+           Token,
+           BufferSize,
+           Buffer,
+           FALSE       // RequestIsWrite
+           );
+}
+
+/**
+
+  WriteBlocksEx() operation for virtio-blk.
+
+  See
+  - UEFI Spec 2.3.1 + Errata C, 12.9 EFI Block I/O 2 Protocol,
+    EFI_BLOCK_IO2_PROTOCOL.WriteBlocksEx().
+  - Driver Writer's Guide for UEFI 2.3.1 v1.01, 24.2.3 WriteBlocks() and
+    WriteBlockEx() Implementation.
+
+  If Token is NULL or Token->Event is NULL, the request is processed
+  synchronously, as in WriteBlocks(). Otherwise the request is queued to the
+  virtqueue and Token->Event is signaled from the completion timer.
+
+**/
+
+EFI_STATUS
+EFIAPI
+VirtioBlkWriteBlocksEx (
+  IN     EFI_BLOCK_IO2_PROTOCOL *This,
+  IN     UINT32                 MediaId,
+  IN     EFI_LBA                Lba,
+  IN OUT EFI_BLOCK_IO2_TOKEN    *Token,
+  IN     UINTN                  BufferSize,
+  IN     VOID                   *Buffer
+  )
+{
+  return VirtioBlkReadWriteBlocksEx (
+           This,
+           Lba,
+           Token,
+           BufferSize,
+           Buffer,
+           TRUE        // RequestIsWrite
+           );
+}
+
+/**
+
+  FlushBlocksEx() operation for virtio-blk.
+
+  See
+  - UEFI Spec 2.3.1 + Errata C, 12.9 EFI Block I/O 2 Protocol,
+    EFI_BLOCK_IO2_PROTOCOL.FlushBlocksEx().
+  - Driver Writer's Guide for UEFI 2.3.1 v1.01, 24.2.4 FlushBlocks() and
+    FlushBlocksEx() Implementation.
+
+  The flush waits for all queued requests first, and is always carried out
+  synchronously; Token->Event, if any, is signaled before returning.
+
+**/
+
+EFI_STATUS
+EFIAPI
+VirtioBlkFlushBlocksEx (
+  IN     EFI_BLOCK_IO2_PROTOCOL *This,
+  IN OUT EFI_BLOCK_IO2_TOKEN    *Token
+  )
+{
+  VBLK_DEV   *Dev;
+  EFI_STATUS Status;
+
+  Dev    = VIRTIO_BLK_FROM_BLOCK_IO2 (This);
+  Status = VirtioBlkFlushBlocks (&Dev->BlockIo);
+  if (Token != NULL && Token->Event != NULL) {
+    Token->TransactionStatus = Status;
+    gBS->SignalEvent (Token->Event);
+  }
+  return Status;
+}
+
+
 /**
 
   Device probe function for this driver.
@@ -721,12 +1335,16 @@ VirtioBlkInit (
   UINT8      PhysicalBlockExp;
   UINT8      AlignmentOffset;
   UINT32     OptIoSize;
+  UINT32     SizeMax;
+  UINT32     SegMax;
   UINT16     QueueSize;
   UINT64     RingBaseShift;
 
   PhysicalBlockExp = 0;
   AlignmentOffset = 0;
   OptIoSize = 0;
+  SizeMax = 0;
+  SegMax = 0;
 
   //
   // Execute virtio-0.9.5, 2.2.1 Device Initialization Sequence.
@@ -815,8 +1433,31 @@ VirtioBlkInit (
     }
   }
 
+  if (Features & VIRTIO_BLK_F_SIZE_MAX) {
+    Status = VIRTIO_CFG_READ (Dev, SizeMax, &SizeMax);
+    if (EFI_ERROR (Status)) {
+      goto Failed;
+    }
+    if (SizeMax < BlockSize) {
+      //
+      // We could not fit even a single logical block into a segment.
+      //
+      Status = EFI_UNSUPPORTED;
+      goto Failed;
+    }
+  }
+
+  if (Features & VIRTIO_BLK_F_SEG_MAX) {
+    Status = VIRTIO_CFG_READ (Dev, SegMax, &SegMax);
+    if (EFI_ERROR (Status)) {
+      goto Failed;
+    }
+  }
+
   Features &= VIRTIO_BLK_F_BLK_SIZE | VIRTIO_BLK_F_TOPOLOGY | VIRTIO_BLK_F_RO |
-              VIRTIO_BLK_F_FLUSH | VIRTIO_F_VERSION_1 |
+              VIRTIO_BLK_F_FLUSH | VIRTIO_BLK_F_SIZE_MAX |
+              VIRTIO_BLK_F_SEG_MAX | VIRTIO_F_RING_INDIRECT_DESC |
+              VIRTIO_F_RING_EVENT_IDX | VIRTIO_F_VERSION_1 |
               VIRTIO_F_IOMMU_PLATFORM;
 
   //
@@ -841,11 +1482,35 @@ VirtioBlkInit (
   if (EFI_ERROR (Status)) {
     goto Failed;
   }
-  if (QueueSize < 3) { // SynchronousRequest() uses at most three descriptors
+  if (QueueSize < 3) { // VirtioBlkSubmitSlot() uses at most three descriptors
     Status = EFI_UNSUPPORTED;
     goto Failed;
   }
 
+  //
+  // With indirect descriptors, a request takes a single descriptor of the
+  // ring and may carry up to SegMax data segments in its indirect table.
+  // Otherwise a request takes three descriptors with a single data segment.
+  // Either way, a segment may not exceed SizeMax bytes.
+  //
+  Dev->IndirectDesc   = (BOOLEAN) ((Features & VIRTIO_F_RING_INDIRECT_DESC) != 0);
+  Dev->EventIdx       = (BOOLEAN) ((Features & VIRTIO_F_RING_EVENT_IDX) != 0);
+  Dev->DescPerSlot    = Dev->IndirectDesc ? 1 : 3;
+  Dev->NumSlots       = (UINT16) MIN (VBLK_MAX_REQUESTS,
+                                   QueueSize / Dev->DescPerSlot);
+  Dev->MaxSegmentSize = (Features & VIRTIO_BLK_F_SIZE_MAX) ?
+                        MIN (SizeMax, SIZE_1GB) : SIZE_1GB;
+  Dev->MaxSegments    = 1;
+  if (Dev->IndirectDesc && (Features & VIRTIO_BLK_F_SEG_MAX) && SegMax > 1) {
+    Dev->MaxSegments = MIN (SegMax, VBLK_MAX_SEGMENTS);
+  }
+  Dev->MaxTransferSize = (UINT32) MIN (
+                                    MultU64x32 (Dev->MaxSegmentSize,
+                                      Dev->MaxSegments),
+                                    SIZE_1GB
+                                    );
+  Dev->MaxTransferSize -= Dev->MaxTransferSize % BlockSize;
+
   Status = VirtioRingInit (Dev->VirtIo, QueueSize, &Dev->Ring);
   if (EFI_ERROR (Status)) {
     goto Failed;
@@ -864,18 +1529,59 @@ VirtioBlkInit (
     goto ReleaseQueue;
   }
 
+  //
+  // Allocate the host-visible part of the request slots. If anything fails
+  // from here on, we must release it.
+  //
+  Dev->SharedReqPages = EFI_SIZE_TO_PAGES (Dev->NumSlots *
+                                           sizeof (VBLK_SHARED_REQ));
+  Status = Dev->VirtIo->AllocateSharedPages (
+                          Dev->VirtIo,
+                          Dev->SharedReqPages,
+                          (VOID **) &Dev->SharedReq
+                          );
+  if (EFI_ERROR (Status)) {
+    goto UnmapQueue;
+  }
+  ZeroMem (Dev->SharedReq, EFI_PAGES_TO_SIZE (Dev->SharedReqPages));
+
+  Status = VirtioMapAllBytesInSharedBuffer (
+             Dev->VirtIo,
+             VirtioOperationBusMasterCommonBuffer,
+             Dev->SharedReq,
+             EFI_PAGES_TO_SIZE (Dev->SharedReqPages),
+             &Dev->SharedReqDeviceAddress,
+             &Dev->SharedReqMap
+             );
+  if (EFI_ERROR (Status)) {
+    goto FreeSharedReq;
+  }
+
+  //
+  // Completions are polled; see virtio-0.9.5, 2.4.2 Receiving Used Buffers
+  // From the Device. With VIRTIO_F_RING_EVENT_IDX the host ignores
+  // Avail.Flags; place the used event index just behind the used index, so
+  // that the host would only interrupt after wrapping around.
+  //
+  *Dev->Ring.Avail.Flags = (UINT16) VRING_AVAIL_F_NO_INTERRUPT;
+  Dev->NextAvailIdx      = *Dev->Ring.Avail.Idx;
+  Dev->LastUsedIdx       = *Dev->Ring.Used.Idx;
+  if (Dev->EventIdx) {
+    *Dev->Ring.Avail.UsedEvent = (UINT16) (Dev->LastUsedIdx - 1);
+  }
+
   //
   // Additional steps for MMIO: align the queue appropriately, and set the
   // size. If anything fails from here on, we must unmap the ring resources.
   //
   Status = Dev->VirtIo->SetQueueNum (Dev->VirtIo, QueueSize);
   if (EFI_ERROR (Status)) {
-    goto UnmapQueue;
+    goto UnmapSharedReq;
   }
 
   Status = Dev->VirtIo->SetQueueAlign (Dev->VirtIo, EFI_PAGE_SIZE);
   if (EFI_ERROR (Status)) {
-    goto UnmapQueue;
+    goto UnmapSharedReq;
   }
 
   //
@@ -887,7 +1593,7 @@ VirtioBlkInit (
                           RingBaseShift
                           );
   if (EFI_ERROR (Status)) {
-    goto UnmapQueue;
+    goto UnmapSharedReq;
   }
 
 
@@ -898,7 +1604,7 @@ VirtioBlkInit (
     Features &= ~(UINT64)(VIRTIO_F_VERSION_1 | VIRTIO_F_IOMMU_PLATFORM);
     Status = Dev->VirtIo->SetGuestFeatures (Dev->VirtIo, Features);
     if (EFI_ERROR (Status)) {
-      goto UnmapQueue;
+      goto UnmapSharedReq;
     }
   }
 
@@ -908,7 +1614,7 @@ VirtioBlkInit (
   NextDevStat |= VSTAT_DRIVER_OK;
   Status = Dev->VirtIo->SetDeviceStatus (Dev->VirtIo, NextDevStat);
   if (EFI_ERROR (Status)) {
-    goto UnmapQueue;
+    goto UnmapSharedReq;
   }
 
   //
@@ -932,9 +1638,18 @@ VirtioBlkInit (
   Dev->BlockIoMedia.LastBlock        = DivU64x32 (NumSectors,
                                          BlockSize / 512) - 1;
 
+  Dev->BlockIo2.Media                = &Dev->BlockIoMedia;
+  Dev->BlockIo2.Reset                = &VirtioBlkResetEx;
+  Dev->BlockIo2.ReadBlocksEx         = &VirtioBlkReadBlocksEx;
+  Dev->BlockIo2.WriteBlocksEx        = &VirtioBlkWriteBlocksEx;
+  Dev->BlockIo2.FlushBlocksEx        = &VirtioBlkFlushBlocksEx;
+
   DEBUG ((DEBUG_INFO, "%a: LbaSize=0x%x[B] NumBlocks=0x%Lx[Lba]\n",
     __FUNCTION__, Dev->BlockIoMedia.BlockSize,
     Dev->BlockIoMedia.LastBlock + 1));
+  DEBUG ((DEBUG_INFO, "%a: Requests=%d Indirect=%d Segments=%d "
+    "MaxTransfer=0x%x[B]\n", __FUNCTION__, Dev->NumSlots, Dev->IndirectDesc,
+    Dev->MaxSegments, Dev->MaxTransferSize));
 
   if (Features & VIRTIO_BLK_F_TOPOLOGY) {
     Dev->BlockIo.Revision = EFI_BLOCK_IO_PROTOCOL_REVISION3;
@@ -951,6 +1666,13 @@ VirtioBlkInit (
   }
   return EFI_SUCCESS;
 
+UnmapSharedReq:
+  Dev->VirtIo->UnmapSharedBuffer (Dev->VirtIo, Dev->SharedReqMap);
+
+FreeSharedReq:
+  Dev->VirtIo->FreeSharedPages (Dev->VirtIo, Dev->SharedReqPages,
+                 Dev->SharedReq);
+
 UnmapQueue:
   Dev->VirtIo->UnmapSharedBuffer (Dev->VirtIo, Dev->RingMap);
 
@@ -985,6 +1707,9 @@ VirtioBlkUninit (
   IN OUT VBLK_DEV *Dev
   )
 {
+  EFI_TPL OldTpl;
+  UINT16  Idx;
+
   //
   // Reset the virtual device -- see virtio-0.9.5, 2.2.2.1 Device Status. When
   // VIRTIO_CFG_WRITE() returns, the host will have learned to stay away from
@@ -992,10 +1717,28 @@ VirtioBlkUninit (
   //
   Dev->VirtIo->SetDeviceStatus (Dev->VirtIo, 0);
 
+  //
+  // Complete what the host has finished, and fail whatever it has not.
+  //
+  OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+  VirtioBlkReapCompletions (Dev);
+  for (Idx = 0; Idx < Dev->NumSlots; Idx++) {
+    if (Dev->Slots[Idx].InUse && !Dev->Slots[Idx].Done) {
+      Dev->SharedReq[Idx].HostStatus = VIRTIO_BLK_S_IOERR;
+      VirtioBlkCompleteSlot (Dev, Idx);
+    }
+  }
+  gBS->RestoreTPL (OldTpl);
+
+  Dev->VirtIo->UnmapSharedBuffer (Dev->VirtIo, Dev->SharedReqMap);
+  Dev->VirtIo->FreeSharedPages (Dev->VirtIo, Dev->SharedReqPages,
+                 Dev->SharedReq);
+
   Dev->VirtIo->UnmapSharedBuffer (Dev->VirtIo, Dev->RingMap);
   VirtioRingUninit (Dev->VirtIo, &Dev->Ring);
 
   SetMem (&Dev->BlockIo,      sizeof Dev->BlockIo,      0x00);
+  SetMem (&Dev->BlockIo2,     sizeof Dev->BlockIo2,     0x00);
   SetMem (&Dev->BlockIoMedia, sizeof Dev->BlockIoMedia, 0x00);
 }
 
@@ -1098,19 +1841,36 @@ VirtioBlkDriverBindingStart (
     goto UninitDev;
   }
 
+  Status = gBS->CreateEvent (EVT_TIMER | EVT_NOTIFY_SIGNAL, TPL_NOTIFY,
+                  &VirtioBlkCompletionTimer, Dev, &Dev->CompletionTimer);
+  if (EFI_ERROR (Status)) {
+    goto CloseExitBoot;
+  }
+
+  Status = gBS->SetTimer (Dev->CompletionTimer, TimerPeriodic,
+                  VBLK_COMPLETION_PERIOD);
+  if (EFI_ERROR (Status)) {
+    goto CloseCompletionTimer;
+  }
+
   //
-  // Setup complete, attempt to export the driver instance's BlockIo interface.
+  // Setup complete, attempt to export the driver instance's BlockIo and
+  // BlockIo2 interfaces.
   //
   Dev->Signature = VBLK_SIG;
-  Status = gBS->InstallProtocolInterface (&DeviceHandle,
-                  &gEfiBlockIoProtocolGuid, EFI_NATIVE_INTERFACE,
-                  &Dev->BlockIo);
+  Status = gBS->InstallMultipleProtocolInterfaces (&DeviceHandle,
+                  &gEfiBlockIoProtocolGuid, &Dev->BlockIo,
+                  &gEfiBlockIo2ProtocolGuid, &Dev->BlockIo2,
+                  NULL);
   if (EFI_ERROR (Status)) {
-    goto CloseExitBoot;
+    goto CloseCompletionTimer;
   }
 
   return EFI_SUCCESS;
 
+CloseCompletionTimer:
+  gBS->CloseEvent (Dev->CompletionTimer);
+
 CloseExitBoot:
   gBS->CloseEvent (Dev->ExitBoot);
 
@@ -1181,12 +1941,15 @@ VirtioBlkDriverBindingStop (
   //
   // Handle Stop() requests for in-use driver instances gracefully.
   //
-  Status = gBS->UninstallProtocolInterface (DeviceHandle,
-                  &gEfiBlockIoProtocolGuid, &Dev->BlockIo);
+  Status = gBS->UninstallMultipleProtocolInterfaces (DeviceHandle,
+                  &gEfiBlockIoProtocolGuid, &Dev->BlockIo,
+                  &gEfiBlockIo2ProtocolGuid, &Dev->BlockIo2,
+                  NULL);
   if (EFI_ERROR (Status)) {
     return Status;
   }
 
+  gBS->CloseEvent (Dev->CompletionTimer);
   gBS->CloseEvent (Dev->ExitBoot);
 
   VirtioBlkUninit (Dev);
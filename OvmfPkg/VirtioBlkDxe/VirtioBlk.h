@@ -13,14 +13,66 @@
 #define _VIRTIO_BLK_DXE_H_
 
 #include <Protocol/BlockIo.h>
+#include <Protocol/BlockIo2.h>
 #include <Protocol/ComponentName.h>
 #include <Protocol/DriverBinding.h>
 
 #include <IndustryStandard/Virtio.h>
+#include <IndustryStandard/VirtioBlk.h>
 
 
 #define VBLK_SIG SIGNATURE_32 ('V', 'B', 'L', 'K')
 
+//
+// Number of virtio-blk requests that may be in flight on the virtqueue at the
+// same time, and number of data descriptors a single request may carry in its
+// indirect descriptor table.
+//
+#define VBLK_MAX_REQUESTS       32
+#define VBLK_MAX_SEGMENTS       64
+
+//
+// Period of the timer that reaps completed requests on behalf of
+// EFI_BLOCK_IO2_PROTOCOL callers.
+//
+#define VBLK_COMPLETION_PERIOD  EFI_TIMER_PERIOD_MILLISECONDS (1)
+
+//
+// The part of a request slot that the host accesses. One array of these is
+// allocated and mapped as a common buffer for the lifetime of the device.
+//
+#pragma pack(1)
+typedef struct {
+  VIRTIO_BLK_REQ Header;
+  UINT8          HostStatus;
+  UINT8          Reserved[15];
+  VRING_DESC     Indirect[VBLK_MAX_SEGMENTS + 2]; // header, data, status
+} VBLK_SHARED_REQ;
+#pragma pack()
+
+//
+// EFI_BLOCK_IO2_PROTOCOL request, possibly carried by several virtio-blk
+// requests.
+//
+typedef struct {
+  EFI_BLOCK_IO2_TOKEN *Token;
+  UINTN               Pending;   // virtio-blk requests not completed yet
+  BOOLEAN             Submitted; // all virtio-blk requests have been queued
+} VBLK_IO2_REQUEST;
+
+//
+// Guest-only bookkeeping of a request slot.
+//
+typedef struct {
+  BOOLEAN          InUse;
+  BOOLEAN          Done;
+  BOOLEAN          RequestIsWrite;
+  EFI_STATUS       Status;
+  UINTN            BufferSize;
+  VOID             *BufferMapping;
+  VBLK_IO2_REQUEST *Io2Request;     // NULL for blocking requests
+} VBLK_SLOT;
+
 typedef struct {
   //
   // Parts of this structure are initialized / torn down in various functions
@@ -36,11 +88,30 @@ typedef struct {
   EFI_BLOCK_IO_PROTOCOL  BlockIo;              // VirtioBlkInit       1
   EFI_BLOCK_IO_MEDIA     BlockIoMedia;         // VirtioBlkInit       1
   VOID                   *RingMap;             // VirtioRingMap       2
+  EFI_BLOCK_IO2_PROTOCOL BlockIo2;             // VirtioBlkInit       1
+  EFI_EVENT              CompletionTimer;      // DriverBindingStart  0
+  BOOLEAN                IndirectDesc;         // VirtioBlkInit       1
+  BOOLEAN                EventIdx;             // VirtioBlkInit       1
+  UINT32                 MaxSegments;          // VirtioBlkInit       1
+  UINT32                 MaxSegmentSize;       // VirtioBlkInit       1
+  UINT32                 MaxTransferSize;      // VirtioBlkInit       1
+  UINT16                 NumSlots;             // VirtioBlkInit       1
+  UINT16                 DescPerSlot;          // VirtioBlkInit       1
+  UINT16                 NextAvailIdx;         // VirtioBlkInit       1
+  UINT16                 LastUsedIdx;          // VirtioBlkInit       1
+  VBLK_SHARED_REQ        *SharedReq;           // VirtioBlkInit       1
+  UINTN                  SharedReqPages;       // VirtioBlkInit       1
+  EFI_PHYSICAL_ADDRESS   SharedReqDeviceAddress; // VirtioBlkInit     1
+  VOID                   *SharedReqMap;        // VirtioBlkInit       1
+  VBLK_SLOT              Slots[VBLK_MAX_REQUESTS]; // VirtioBlkInit   1
 } VBLK_DEV;
 
 #define VIRTIO_BLK_FROM_BLOCK_IO(BlockIoPointer) \
         CR (BlockIoPointer, VBLK_DEV, BlockIo, VBLK_SIG)
 
+#define VIRTIO_BLK_FROM_BLOCK_IO2(BlockIo2Pointer) \
+        CR (BlockIo2Pointer, VBLK_DEV, BlockIo2, VBLK_SIG)
+
 
 /**
 
@@ -253,6 +324,98 @@ VirtioBlkFlushBlocks (
   );
 
 
+//
+// UEFI Spec 2.3.1 + Errata C, 12.9 EFI Block I/O 2 Protocol
+// Driver Writer's Guide for UEFI 2.3.1 v1.01,
+//   24.2 Block I/O Protocol Implementations
+//
+EFI_STATUS
+EFIAPI
+VirtioBlkResetEx (
+  IN EFI_BLOCK_IO2_PROTOCOL *This,
+  IN BOOLEAN                ExtendedVerification
+  );
+
+
+/**
+
+  ReadBlocksEx() operation for virtio-blk.
+
+  See
+  - UEFI Spec 2.3.1 + Errata C, 12.9 EFI Block I/O 2 Protocol,
+    EFI_BLOCK_IO2_PROTOCOL.ReadBlocksEx().
+  - Driver Writer's Guide for UEFI 2.3.1 v1.01, 24.2.2. ReadBlocks() and
+    ReadBlocksEx() Implementation.
+
+  If Token is NULL or Token->Event is NULL, the request is processed
+  synchronously, as in ReadBlocks(). Otherwise the request is queued to the
+  virtqueue and Token->Event is signaled from the completion timer.
+
+**/
+
+EFI_STATUS
+EFIAPI
+VirtioBlkReadBlocksEx (
+  IN     EFI_BLOCK_IO2_PROTOCOL *This,
+  IN     UINT32                 MediaId,
+  IN     EFI_LBA                Lba,
+  IN OUT EFI_BLOCK_IO2_TOKEN    *Token,
+  IN     UINTN                  BufferSize,
+     OUT VOID                   *Buffer
+  );
+
+
+/**
+
+  WriteBlocksEx() operation for virtio-blk.
+
+  See
+  - UEFI Spec 2.3.1 + Errata C, 12.9 EFI Block I/O 2 Protocol,
+    EFI_BLOCK_IO2_PROTOCOL.WriteBlocksEx().
+  - Driver Writer's Guide for UEFI 2.3.1 v1.01, 24.2.3 WriteBlocks() and
+    WriteBlockEx() Implementation.
+
+  If Token is NULL or Token->Event is NULL, the request is processed
+  synchronously, as in WriteBlocks(). Otherwise the request is queued to the
+  virtqueue and Token->Event is signaled from the completion timer.
+
+**/
+
+EFI_STATUS
+EFIAPI
+VirtioBlkWriteBlocksEx (
+  IN     EFI_BLOCK_IO2_PROTOCOL *This,
+  IN     UINT32                 MediaId,
+  IN     EFI_LBA                Lba,
+  IN OUT EFI_BLOCK_IO2_TOKEN    *Token,
+  IN     UINTN                  BufferSize,
+  IN     VOID                   *Buffer
+  );
+
+
+/**
+
+  FlushBlocksEx() operation for virtio-blk.
+
+  See
+  - UEFI Spec 2.3.1 + Errata C, 12.9 EFI Block I/O 2 Protocol,
+    EFI_BLOCK_IO2_PROTOCOL.FlushBlocksEx().
+  - Driver Writer's Guide for UEFI 2.3.1 v1.01, 24.2.4 FlushBlocks() and
+    FlushBlocksEx() Implementation.
+
+  The flush waits for all queued requests first, and is always carried out
+  synchronously; Token->Event, if any, is signaled before returning.
+
+**/
+
+EFI_STATUS
+EFIAPI
+VirtioBlkFlushBlocksEx (
+  IN     EFI_BLOCK_IO2_PROTOCOL *This,
+  IN OUT EFI_BLOCK_IO2_TOKEN    *Token
+  );
+
+
 //
 // The purpose of the following scaffolding (EFI_COMPONENT_NAME_PROTOCOL and
 // EFI_COMPONENT_NAME2_PROTOCOL implementation) is to format the driver's name
@@ -132,9 +132,11 @@ VirtioFsInit (
   //
   // No device-specific feature bits have been defined in file "virtio-fs.tex"
   // of the virtio spec at <https://github.com/oasis-tcs/virtio-spec.git>, as
-  // of commit 87fa6b5d8155.
+  // of commit 87fa6b5d8155. The request queue is only accessed through
+  // VirtioLib, so any ring layout it supports will do.
   //
-  Features &= VIRTIO_F_VERSION_1 | VIRTIO_F_IOMMU_PLATFORM;
+  Features &= VIRTIO_F_VERSION_1 | VIRTIO_F_IOMMU_PLATFORM |
+              VIRTIO_F_RING_PACKED | VIRTIO_F_RING_EVENT_IDX;
 
   //
   // ... and write the subset of feature bits understood by the [...] driver to
@@ -202,7 +204,7 @@ VirtioFsInit (
   //
   // 7.d. [...] population of virtqueues [...]
   //
-  Status = VirtioRingInit (VirtioFs->Virtio, VirtioFs->QueueSize,
+  Status = VirtioRingInitEx (VirtioFs->Virtio, VirtioFs->QueueSize, Features,
              &VirtioFs->Ring);
   if (EFI_ERROR (Status)) {
     goto Failed;
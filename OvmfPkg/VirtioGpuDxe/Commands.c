@@ -9,6 +9,7 @@
 
 **/
 
+#include <Library/UefiBootServicesTableLib.h>
 #include <Library/VirtioLib.h>
 
 #include "VirtioGpu.h"
@@ -82,9 +83,11 @@ VirtioGpuInit (
     goto Failed;
   }
   //
-  // We only want the most basic 2D features.
+  // We only want the most basic 2D features. The control queue is only
+  // accessed through VirtioLib, so any ring layout it supports will do.
   //
-  Features &= VIRTIO_F_VERSION_1 | VIRTIO_F_IOMMU_PLATFORM;
+  Features &= VIRTIO_F_VERSION_1 | VIRTIO_F_IOMMU_PLATFORM |
+              VIRTIO_F_RING_PACKED | VIRTIO_F_RING_EVENT_IDX;
 
   //
   // ... and write the subset of feature bits understood by the [...] driver to
@@ -123,7 +126,8 @@ VirtioGpuInit (
   //
   // [...] population of virtqueues [...]
   //
-  Status = VirtioRingInit (VgpuDev->VirtIo, QueueSize, &VgpuDev->Ring);
+  Status = VirtioRingInitEx (VgpuDev->VirtIo, QueueSize, Features,
+             &VgpuDev->Ring);
   if (EFI_ERROR (Status)) {
     goto Failed;
   }
@@ -349,6 +353,14 @@ VirtioGpuExitBoot (
 
   DEBUG ((DEBUG_VERBOSE, "%a: Context=0x%p\n", __FUNCTION__, Context));
   VgpuDev = Context;
+
+  //
+  // Stop submitting Gop.Blt() damage to the device that is being reset.
+  //
+  if (VgpuDev->Child != NULL) {
+    gBS->SetTimer (VgpuDev->Child->FlushTimer, TimerCancel, 0);
+  }
+
   VgpuDev->VirtIo->SetDeviceStatus (VgpuDev->VirtIo, 0);
 }
 
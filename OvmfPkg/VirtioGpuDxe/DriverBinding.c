@@ -348,6 +348,21 @@ InitVgpuGop (
     goto CloseVirtIoByChild;
   }
 
+  //
+  // Gop.Blt() only renders to the backing store; the timer submits the
+  // modified area to the host periodically.
+  //
+  Status = gBS->CreateEvent (EVT_TIMER | EVT_NOTIFY_SIGNAL, TPL_CALLBACK,
+                  GopFlushDamage, VgpuGop, &VgpuGop->FlushTimer);
+  if (EFI_ERROR (Status)) {
+    goto UninitGop;
+  }
+  Status = gBS->SetTimer (VgpuGop->FlushTimer, TimerPeriodic,
+                  VGPU_GOP_FLUSH_PERIOD);
+  if (EFI_ERROR (Status)) {
+    goto CloseFlushTimer;
+  }
+
   //
   // Install the Graphics Output Protocol on the child handle.
   //
@@ -355,7 +370,7 @@ InitVgpuGop (
                   &gEfiGraphicsOutputProtocolGuid, EFI_NATIVE_INTERFACE,
                   &VgpuGop->Gop);
   if (EFI_ERROR (Status)) {
-    goto UninitGop;
+    goto CloseFlushTimer;
   }
 
   //
@@ -365,6 +380,9 @@ InitVgpuGop (
   ParentBus->Child = VgpuGop;
   return EFI_SUCCESS;
 
+CloseFlushTimer:
+  gBS->CloseEvent (VgpuGop->FlushTimer);
+
 UninitGop:
   ReleaseGopResources (VgpuGop, TRUE /* DisableHead */);
 
@@ -426,8 +444,12 @@ UninitVgpuGop (
   ASSERT_EFI_ERROR (Status);
 
   //
-  // Uninitialize VgpuGop->Gop.
+  // Uninitialize VgpuGop->Gop. Any damage not submitted to the host yet is
+  // dropped along with the resource.
   //
+  Status = gBS->CloseEvent (VgpuGop->FlushTimer);
+  ASSERT_EFI_ERROR (Status);
+
   ReleaseGopResources (VgpuGop, TRUE /* DisableHead */);
 
   Status = gBS->CloseProtocol (ParentBusController, &gVirtioDeviceProtocolGuid,
@@ -9,6 +9,7 @@
 **/
 
 #include <Library/MemoryAllocationLib.h>
+#include <Library/UefiBootServicesTableLib.h>
 
 #include "VirtioGpu.h"
 
@@ -237,6 +238,7 @@ GopSetMode (
   VOID                 *NewBackingStore;
   EFI_PHYSICAL_ADDRESS NewBackingStoreDeviceAddress;
   VOID                 *NewBackingStoreMap;
+  EFI_TPL              OldTpl;
 
   EFI_STATUS Status;
   EFI_STATUS Status2;
@@ -246,6 +248,7 @@ GopSetMode (
   }
 
   VgpuGop = VGPU_GOP_FROM_GOP (This);
+  VgpuGop->SettingMode = TRUE;
 
   //
   // Distinguish the first (internal) call from the other (protocol consumer)
@@ -292,6 +295,7 @@ GopSetMode (
              mGopResolutions[ModeNumber].Height // Height
              );
   if (EFI_ERROR (Status)) {
+    VgpuGop->SettingMode = FALSE;
     return Status;
   }
 
@@ -406,6 +410,16 @@ GopSetMode (
                                              mGopResolutions[ModeNumber].Width;
   VgpuGop->GopModeInfo.VerticalResolution = mGopResolutions[ModeNumber].Height;
   VgpuGop->GopModeInfo.PixelsPerScanLine = mGopResolutions[ModeNumber].Width;
+
+  //
+  // The damage collected so far refers to the old resource, which is gone;
+  // the new one has been flushed in full above.
+  //
+  OldTpl = gBS->RaiseTPL (TPL_HIGH_LEVEL);
+  VgpuGop->Damaged = FALSE;
+  gBS->RestoreTPL (OldTpl);
+
+  VgpuGop->SettingMode = FALSE;
   return EFI_SUCCESS;
 
 DetachBackingStore:
@@ -430,6 +444,7 @@ DestroyHostResource:
     CpuDeadLoop ();
   }
 
+  VgpuGop->SettingMode = FALSE;
   return Status;
 }
 
@@ -454,8 +469,7 @@ GopBlt (
   UINT32     CurrentVertical;
   UINTN      SegmentSize;
   UINTN      Y;
-  UINTN      ResourceOffset;
-  EFI_STATUS Status;
+  EFI_TPL    OldTpl;
 
   VgpuGop = VGPU_GOP_FROM_GOP (This);
   CurrentHorizontal = VgpuGop->GopModeInfo.HorizontalResolution;
@@ -613,22 +627,95 @@ GopBlt (
   }
 
   //
-  // For operations that wrote to the display, submit the updated area to the
-  // host -- update the host resource from guest memory.
+  // For operations that wrote to the display, add the updated area to the
+  // damage that FlushTimer will submit to the host.
   //
-  ResourceOffset = sizeof (UINT32) * (DestinationY * CurrentHorizontal +
-                                      DestinationX);
+  if (Width == 0 || Height == 0) {
+    return EFI_SUCCESS;
+  }
+
+  OldTpl = gBS->RaiseTPL (TPL_HIGH_LEVEL);
+  if (!VgpuGop->Damaged) {
+    VgpuGop->DamageX1 = (UINT32)DestinationX;
+    VgpuGop->DamageY1 = (UINT32)DestinationY;
+    VgpuGop->DamageX2 = (UINT32)(DestinationX + Width);
+    VgpuGop->DamageY2 = (UINT32)(DestinationY + Height);
+    VgpuGop->Damaged  = TRUE;
+  } else {
+    VgpuGop->DamageX1 = MIN (VgpuGop->DamageX1, (UINT32)DestinationX);
+    VgpuGop->DamageY1 = MIN (VgpuGop->DamageY1, (UINT32)DestinationY);
+    VgpuGop->DamageX2 = MAX (VgpuGop->DamageX2, (UINT32)(DestinationX + Width));
+    VgpuGop->DamageY2 = MAX (VgpuGop->DamageY2, (UINT32)(DestinationY + Height));
+  }
+  gBS->RestoreTPL (OldTpl);
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Submit the display area that Gop.Blt() modified since the last call to the
+  host, and flush it to the display.
+
+  This is the notification function of VGPU_GOP.FlushTimer.
+
+  @param[in] Event    Event whose notification function is being invoked.
+
+  @param[in] Context  Pointer to the VGPU_GOP object.
+**/
+VOID
+EFIAPI
+GopFlushDamage (
+  IN EFI_EVENT Event,
+  IN VOID      *Context
+  )
+{
+  VGPU_GOP   *VgpuGop;
+  EFI_TPL    OldTpl;
+  UINT32     X;
+  UINT32     Y;
+  UINT32     Width;
+  UINT32     Height;
+  UINT64     ResourceOffset;
+  EFI_STATUS Status;
+
+  VgpuGop = Context;
+
+  //
+  // Gop.SetMode() is using the virtio ring; try again in the next period.
+  //
+  if (VgpuGop->SettingMode) {
+    return;
+  }
+
+  OldTpl = gBS->RaiseTPL (TPL_HIGH_LEVEL);
+  if (!VgpuGop->Damaged) {
+    gBS->RestoreTPL (OldTpl);
+    return;
+  }
+  X      = VgpuGop->DamageX1;
+  Y      = VgpuGop->DamageY1;
+  Width  = VgpuGop->DamageX2 - VgpuGop->DamageX1;
+  Height = VgpuGop->DamageY2 - VgpuGop->DamageY1;
+  VgpuGop->Damaged = FALSE;
+  gBS->RestoreTPL (OldTpl);
+
+  //
+  // Update the host resource from guest memory.
+  //
+  ResourceOffset = sizeof (UINT32) *
+                   ((UINT64)Y * VgpuGop->GopModeInfo.HorizontalResolution + X);
   Status = VirtioGpuTransferToHost2d (
              VgpuGop->ParentBus,   // VgpuDev
-             (UINT32)DestinationX, // X
-             (UINT32)DestinationY, // Y
-             (UINT32)Width,        // Width
-             (UINT32)Height,       // Height
+             X,                    // X
+             Y,                    // Y
+             Width,                // Width
+             Height,               // Height
              ResourceOffset,       // Offset
              VgpuGop->ResourceId   // ResourceId
              );
   if (EFI_ERROR (Status)) {
-    return Status;
+    DEBUG ((DEBUG_ERROR, "%a: TransferToHost2d: %r\n", __FUNCTION__, Status));
+    return;
   }
 
   //
@@ -636,13 +723,15 @@ GopBlt (
   //
   Status = VirtioGpuResourceFlush (
              VgpuGop->ParentBus,   // VgpuDev
-             (UINT32)DestinationX, // X
-             (UINT32)DestinationY, // Y
-             (UINT32)Width,        // Width
-             (UINT32)Height,       // Height
+             X,                    // X
+             Y,                    // Y
+             Width,                // Width
+             Height,               // Height
              VgpuGop->ResourceId   // ResourceId
              );
-  return Status;
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "%a: ResourceFlush: %r\n", __FUNCTION__, Status));
+  }
 }
 
 //
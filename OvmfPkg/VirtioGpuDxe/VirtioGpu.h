@@ -151,8 +151,38 @@ struct VGPU_GOP_STRUCT {
   // BackingStore is non-NULL.
   //
   VOID                                 *BackingStoreMap;
+
+  //
+  // Bounding rectangle, with exclusive right and bottom edges, of the display
+  // area that Gop.Blt() modified since the area was last submitted to the
+  // host. Damaged is FALSE if there is no such area. These fields are only
+  // accessed at TPL_HIGH_LEVEL.
+  //
+  BOOLEAN                              Damaged;
+  UINT32                               DamageX1;
+  UINT32                               DamageY1;
+  UINT32                               DamageX2;
+  UINT32                               DamageY2;
+
+  //
+  // Periodic timer that submits the damaged area to the host, so that a
+  // series of Gop.Blt() calls (e.g. scrolling the console) costs at most one
+  // transfer and one flush per period.
+  //
+  EFI_EVENT                            FlushTimer;
+
+  //
+  // Set while Gop.SetMode() sends commands to the device. FlushTimer skips
+  // its period then, so that the two don't use the virtio ring at once.
+  //
+  BOOLEAN                              SettingMode;
 };
 
+//
+// Period of VGPU_GOP.FlushTimer.
+//
+#define VGPU_GOP_FLUSH_PERIOD EFI_TIMER_PERIOD_MILLISECONDS (20)
+
 //
 // VirtIo GPU initialization, and commands (primitives) for the GPU device.
 //
@@ -394,6 +424,23 @@ ReleaseGopResources (
   IN     BOOLEAN  DisableHead
   );
 
+/**
+  Submit the display area that Gop.Blt() modified since the last call to the
+  host, and flush it to the display.
+
+  This is the notification function of VGPU_GOP.FlushTimer.
+
+  @param[in] Event    Event whose notification function is being invoked.
+
+  @param[in] Context  Pointer to the VGPU_GOP object.
+**/
+VOID
+EFIAPI
+GopFlushDamage (
+  IN EFI_EVENT Event,
+  IN VOID      *Context
+  );
+
 //
 // Template for initializing VGPU_GOP.Gop.
 //
@@ -14,6 +14,7 @@
 #include <Library/BaseLib.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/MemoryAllocationLib.h>
+#include <Library/PcdLib.h>
 #include <Library/UefiBootServicesTableLib.h>
 
 #include "VirtioNet.h"
@@ -210,13 +211,7 @@ VirtioNetInitTx (
   Dev->TxSharedReq = TxSharedReqBuffer;
 
 
-  //
-  // In VirtIo 1.0, the NumBuffers field is mandatory. In 0.9.5, it depends on
-  // VIRTIO_NET_F_MRG_RXBUF, which we never negotiate.
-  //
-  TxSharedReqSize = (Dev->VirtIo->Revision < VIRTIO_SPEC_REVISION (1, 0, 0)) ?
-                    sizeof (Dev->TxSharedReq->V0_9_5) :
-                    sizeof *Dev->TxSharedReq;
+  TxSharedReqSize = Dev->VirtioNetReqSize;
 
   for (PktIdx = 0; PktIdx < Dev->TxMaxPending; ++PktIdx) {
     UINT16 DescIdx;
@@ -247,7 +242,8 @@ VirtioNetInitTx (
   Dev->TxSharedReq->V0_9_5.GsoType = VIRTIO_NET_HDR_GSO_NONE;
 
   //
-  // For VirtIo 1.0 only -- the field exists, but it is unused
+  // For VirtIo 1.0 or VIRTIO_NET_F_MRG_RXBUF only -- the field exists, but it
+  // is unused for transmission
   //
   Dev->TxSharedReq->NumBuffers = 0;
 
@@ -259,9 +255,12 @@ VirtioNetInitTx (
   ASSERT (Dev->TxLastUsed == 0);
 
   //
-  // want no interrupt when a transmit completes
+  // want no interrupt when a transmit completes; with VIRTIO_F_RING_EVENT_IDX,
+  // the host ignores the flag, so also place the used event index as far
+  // behind as possible
   //
-  *Dev->TxRing.Avail.Flags = (UINT16) VRING_AVAIL_F_NO_INTERRUPT;
+  *Dev->TxRing.Avail.Flags     = (UINT16) VRING_AVAIL_F_NO_INTERRUPT;
+  *Dev->TxRing.Avail.UsedEvent = (UINT16) (Dev->TxLastUsed - 1);
 
   return EFI_SUCCESS;
 
@@ -322,13 +321,7 @@ VirtioNetInitRx (
   EFI_PHYSICAL_ADDRESS  RxBufDeviceAddress;
   VOID                  *RxBuffer;
 
-  //
-  // In VirtIo 1.0, the NumBuffers field is mandatory. In 0.9.5, it depends on
-  // VIRTIO_NET_F_MRG_RXBUF, which we never negotiate.
-  //
-  VirtioNetReqSize = (Dev->VirtIo->Revision < VIRTIO_SPEC_REVISION (1, 0, 0)) ?
-                     sizeof (VIRTIO_NET_REQ) :
-                     sizeof (VIRTIO_1_0_NET_REQ);
+  VirtioNetReqSize = Dev->VirtioNetReqSize;
 
   //
   // For each incoming packet we must supply two descriptors:
@@ -343,7 +336,11 @@ VirtioNetInitRx (
   // Limit the number of pending RX packets if the queue is big. The division
   // by two is due to the above "two descriptors per packet" trait.
   //
-  RxAlwaysPending = (UINT16) MIN (Dev->RxRing.QueueSize / 2, VNET_MAX_PENDING);
+  RxAlwaysPending = (UINT16) MIN (Dev->RxRing.QueueSize / 2,
+                                  PcdGet16 (PcdVirtioNetRxMaxPending));
+  if (RxAlwaysPending == 0) {
+    RxAlwaysPending = 1;
+  }
 
   //
   // The RxBuf is shared between guest and hypervisor, use
@@ -390,7 +387,8 @@ VirtioNetInitRx (
   // the host should not send interrupts, we'll poll in VirtioNetReceive()
   // and VirtioNetIsPacketAvailable().
   //
-  *Dev->RxRing.Avail.Flags = (UINT16) VRING_AVAIL_F_NO_INTERRUPT;
+  *Dev->RxRing.Avail.Flags     = (UINT16) VRING_AVAIL_F_NO_INTERRUPT;
+  *Dev->RxRing.Avail.UsedEvent = (UINT16) (Dev->RxLastUsed - 1);
 
   //
   // now set up a separate, two-part descriptor chain for each RX packet, and
@@ -556,8 +554,28 @@ VirtioNetInitialize (
   ASSERT (Dev->Snm.MediaPresentSupported ==
     !!(Features & VIRTIO_NET_F_STATUS));
 
+  //
+  // VIRTIO_NET_F_MRG_RXBUF lets the host spread a frame over several receive
+  // buffers; VirtioNetReceive() merges them again. It is the layout that
+  // vhost-net serves fastest. Checksum and segmentation offloads are not
+  // negotiated, as EFI_SIMPLE_NETWORK_PROTOCOL has no way to pass them to the
+  // network stack.
+  //
   Features &= VIRTIO_NET_F_MAC | VIRTIO_NET_F_STATUS | VIRTIO_F_VERSION_1 |
-              VIRTIO_F_IOMMU_PLATFORM;
+              VIRTIO_F_IOMMU_PLATFORM | VIRTIO_NET_F_MRG_RXBUF |
+              VIRTIO_F_RING_EVENT_IDX;
+  Dev->MergeRxBuf = (BOOLEAN) ((Features & VIRTIO_NET_F_MRG_RXBUF) != 0);
+  Dev->EventIdx   = (BOOLEAN) ((Features & VIRTIO_F_RING_EVENT_IDX) != 0);
+
+  //
+  // In VirtIo 1.0, the NumBuffers field is mandatory. In 0.9.5, it depends on
+  // VIRTIO_NET_F_MRG_RXBUF.
+  //
+  Dev->VirtioNetReqSize =
+    (Dev->VirtIo->Revision < VIRTIO_SPEC_REVISION (1, 0, 0) &&
+     !Dev->MergeRxBuf) ?
+    sizeof (VIRTIO_NET_REQ) :
+    sizeof (VIRTIO_1_0_NET_REQ);
 
   //
   // In virtio-1.0, feature negotiation is expected to complete before queue
@@ -75,8 +75,13 @@ VirtioNetReceive (
   UINTN      OrigBufferSize;
   UINT8      *RxPtr;
   UINT16     AvailIdx;
+  UINT16     OldAvailIdx;
   EFI_STATUS NotifyStatus;
   UINTN      RxBufOffset;
+  UINT16     NumBuffers;
+  UINT16     BufIdx;
+  UINT32     BufDescIdx;
+  UINT32     BufLen;
 
   if (This == NULL || BufferSize == NULL || Buffer == NULL) {
     return EFI_INVALID_PARAMETER;
@@ -116,10 +121,38 @@ VirtioNetReceive (
   //
   ASSERT (RxLen >= Dev->RxRing.Desc[DescIdx].Len);
   RxLen -= Dev->RxRing.Desc[DescIdx].Len;
+
   //
-  // the host must not have filled in more data than requested
+  // With VIRTIO_NET_F_MRG_RXBUF, the frame continues in the next NumBuffers-1
+  // used elements. Each descriptor chain we post covers a contiguous area of
+  // RxBuf, so the host is free to fill the request header area of any further
+  // chain with network data too.
   //
-  ASSERT (RxLen <= Dev->RxRing.Desc[DescIdx + 1].Len);
+  NumBuffers = 1;
+  if (Dev->MergeRxBuf) {
+    RxBufOffset = (UINTN)(Dev->RxRing.Desc[DescIdx].Addr -
+                          Dev->RxBufDeviceBase);
+    NumBuffers  = ((VIRTIO_1_0_NET_REQ *)(Dev->RxBuf + RxBufOffset))->NumBuffers;
+    if (NumBuffers == 0) {
+      NumBuffers = 1;
+      Status = EFI_DEVICE_ERROR;
+      goto RecycleDesc; // drop malformed packet
+    }
+    if (NumBuffers > (UINT16) (RxCurUsed - Dev->RxLastUsed)) {
+      Status = EFI_NOT_READY;
+      goto Exit;
+    }
+    for (BufIdx = 1; BufIdx < NumBuffers; ++BufIdx) {
+      UsedElemIdx = (UINT16) (Dev->RxLastUsed + BufIdx) %
+                    Dev->RxRing.QueueSize;
+      RxLen += Dev->RxRing.Used.UsedElem[UsedElemIdx].Len;
+    }
+  } else {
+    //
+    // the host must not have filled in more data than requested
+    //
+    ASSERT (RxLen <= Dev->RxRing.Desc[DescIdx + 1].Len);
+  }
 
   OrigBufferSize = *BufferSize;
   *BufferSize = RxLen;
@@ -138,11 +171,22 @@ VirtioNetReceive (
     *HeaderSize = Dev->Snm.MediaHeaderSize;
   }
 
-  RxBufOffset = (UINTN)(Dev->RxRing.Desc[DescIdx + 1].Addr -
-                        Dev->RxBufDeviceBase);
-  RxPtr = Dev->RxBuf + RxBufOffset;
-  CopyMem (Buffer, RxPtr, RxLen);
+  RxPtr = Buffer;
+  for (BufIdx = 0; BufIdx < NumBuffers; ++BufIdx) {
+    UsedElemIdx = (UINT16) (Dev->RxLastUsed + BufIdx) % Dev->RxRing.QueueSize;
+    BufDescIdx  = Dev->RxRing.Used.UsedElem[UsedElemIdx].Id;
+    BufLen      = Dev->RxRing.Used.UsedElem[UsedElemIdx].Len;
+    RxBufOffset = (UINTN)(Dev->RxRing.Desc[BufDescIdx].Addr -
+                          Dev->RxBufDeviceBase);
+    if (BufIdx == 0) {
+      RxBufOffset += Dev->RxRing.Desc[BufDescIdx].Len;
+      BufLen      -= Dev->RxRing.Desc[BufDescIdx].Len;
+    }
+    CopyMem (RxPtr, Dev->RxBuf + RxBufOffset, BufLen);
+    RxPtr += BufLen;
+  }
 
+  RxPtr = Buffer;
   if (DestAddr != NULL) {
     CopyMem (DestAddr, RxPtr, SIZE_OF_VNET (Mac));
   }
@@ -161,20 +205,27 @@ VirtioNetReceive (
   Status = EFI_SUCCESS;
 
 RecycleDesc:
-  ++Dev->RxLastUsed;
-
   //
   // virtio-0.9.5, 2.4.1 Supplying Buffers to The Device
   //
-  AvailIdx = *Dev->RxRing.Avail.Idx;
-  Dev->RxRing.Avail.Ring[AvailIdx++ % Dev->RxRing.QueueSize] =
-    (UINT16) DescIdx;
+  OldAvailIdx = *Dev->RxRing.Avail.Idx;
+  AvailIdx    = OldAvailIdx;
+  for (BufIdx = 0; BufIdx < NumBuffers; ++BufIdx) {
+    UsedElemIdx = Dev->RxLastUsed++ % Dev->RxRing.QueueSize;
+    Dev->RxRing.Avail.Ring[AvailIdx++ % Dev->RxRing.QueueSize] =
+      (UINT16) Dev->RxRing.Used.UsedElem[UsedElemIdx].Id;
+  }
 
   MemoryFence ();
   *Dev->RxRing.Avail.Idx = AvailIdx;
 
-  MemoryFence ();
-  NotifyStatus = Dev->VirtIo->SetQueueNotify (Dev->VirtIo, VIRTIO_NET_Q_RX);
+  NotifyStatus = VirtioNetNotify (
+                   Dev,
+                   &Dev->RxRing,
+                   VIRTIO_NET_Q_RX,
+                   OldAvailIdx,
+                   AvailIdx
+                   );
   if (!EFI_ERROR (Status)) { // earlier error takes precedence
     Status = NotifyStatus;
   }
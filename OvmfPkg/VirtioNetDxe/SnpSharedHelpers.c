@@ -8,6 +8,7 @@
 
 **/
 
+#include <Library/BaseLib.h>
 #include <Library/MemoryAllocationLib.h>
 
 #include "VirtioNet.h"
@@ -104,6 +105,54 @@ VirtioNetUninitRing (
 }
 
 
+/**
+  Notify the host about the available ring entries [OldAvailIdx, NewAvailIdx),
+  unless the host has suppressed notifications for them.
+
+  Skipping redundant notifications saves a VM exit per packet while the host
+  is busy processing the queue anyway.
+
+  @param[in] Dev          The VNET_DEV driver instance that owns Ring.
+  @param[in] Ring         The RX or TX virtio ring just updated.
+  @param[in] Selector     Identifies the queue of Ring.
+  @param[in] OldAvailIdx  The available index before the update.
+  @param[in] NewAvailIdx  The available index after the update.
+
+  @return                 Status codes from VirtIo->SetQueueNotify().
+  @retval EFI_SUCCESS     The host has been notified, or it did not ask to be.
+*/
+EFI_STATUS
+EFIAPI
+VirtioNetNotify (
+  IN VNET_DEV *Dev,
+  IN VRING    *Ring,
+  IN UINT16   Selector,
+  IN UINT16   OldAvailIdx,
+  IN UINT16   NewAvailIdx
+  )
+{
+  BOOLEAN Notify;
+
+  //
+  // virtio-1.0, 2.4.7.2 Notifying The Device: with VIRTIO_F_RING_EVENT_IDX,
+  // the host publishes the available index it wants to be notified at;
+  // otherwise it may set VRING_USED_F_NO_NOTIFY.
+  //
+  MemoryFence ();
+  if (Dev->EventIdx) {
+    Notify = (BOOLEAN) ((UINT16) (NewAvailIdx - *Ring->Used.AvailEvent - 1) <
+                        (UINT16) (NewAvailIdx - OldAvailIdx));
+  } else {
+    Notify = (BOOLEAN) ((*Ring->Used.Flags & VRING_USED_F_NO_NOTIFY) == 0);
+  }
+
+  if (!Notify) {
+    return EFI_SUCCESS;
+  }
+  return Dev->VirtIo->SetQueueNotify (Dev->VirtIo, Selector);
+}
+
+
 /**
   Map Caller-supplied TxBuf buffer to the device-mapped address
 
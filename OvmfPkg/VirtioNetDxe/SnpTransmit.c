@@ -164,13 +164,22 @@ VirtioNetTransmit (
   // without a barrier
   //
   AvailIdx = *Dev->TxRing.Avail.Idx;
-  Dev->TxRing.Avail.Ring[AvailIdx++ % Dev->TxRing.QueueSize] = DescIdx;
+  Dev->TxRing.Avail.Ring[AvailIdx % Dev->TxRing.QueueSize] = DescIdx;
 
   MemoryFence ();
-  *Dev->TxRing.Avail.Idx = AvailIdx;
+  *Dev->TxRing.Avail.Idx = (UINT16) (AvailIdx + 1);
 
-  MemoryFence ();
-  Status = Dev->VirtIo->SetQueueNotify (Dev->VirtIo, VIRTIO_NET_Q_TX);
+  //
+  // While the host is still draining the TX queue, it suppresses
+  // notifications, and back-to-back packets are picked up without a kick.
+  //
+  Status = VirtioNetNotify (
+             Dev,
+             &Dev->TxRing,
+             VIRTIO_NET_Q_TX,
+             AvailIdx,
+             (UINT16) (AvailIdx + 1)
+             );
 
 Exit:
   gBS->RestoreTPL (OldTpl);
@@ -25,7 +25,8 @@
 #define VNET_SIG SIGNATURE_32 ('V', 'N', 'E', 'T')
 
 //
-// maximum number of pending packets, separately for each direction
+// maximum number of pending TX packets; the maximum number of pending RX
+// packets is PcdVirtioNetRxMaxPending
 //
 #define VNET_MAX_PENDING 64
 
@@ -77,6 +78,10 @@ typedef struct {
   EFI_DEVICE_PATH_PROTOCOL    *MacDevicePath;    // VirtioNetDriverBindingStart
   EFI_HANDLE                  MacHandle;         // VirtioNetDriverBindingStart
 
+  BOOLEAN                     MergeRxBuf;        // VirtioNetInitialize
+  BOOLEAN                     EventIdx;          // VirtioNetInitialize
+  UINTN                       VirtioNetReqSize;  // VirtioNetInitialize
+
   VRING                       RxRing;            // VirtioNetInitRing
   VOID                        *RxRingMap;        // VirtioRingMap and
                                                  // VirtioNetInitRing
@@ -268,6 +273,16 @@ VirtioNetShutdownTx (
   IN OUT VNET_DEV *Dev
   );
 
+EFI_STATUS
+EFIAPI
+VirtioNetNotify (
+  IN VNET_DEV *Dev,
+  IN VRING    *Ring,
+  IN UINT16   Selector,
+  IN UINT16   OldAvailIdx,
+  IN UINT16   NewAvailIdx
+  );
+
 VOID
 EFIAPI
 VirtioNetUninitRing (
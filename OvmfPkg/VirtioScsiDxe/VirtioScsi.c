@@ -7,16 +7,20 @@
 
   - No hotplug / hot-unplug.
 
-  - Although EFI_EXT_SCSI_PASS_THRU_PROTOCOL.PassThru() could be a good match
-    for multiple in-flight virtio-scsi requests, we stick to synchronous
-    requests for now.
+  - EFI_EXT_SCSI_PASS_THRU_PROTOCOL.PassThru() keeps up to VSCSI_MAX_REQUESTS
+    virtio-scsi requests in flight. Blocking requests are polled for in
+    PassThru(); non-blocking requests are completed by a timer, or by any
+    later PassThru() call. Indirect descriptors are used when the host offers
+    them.
 
   - Timeouts are not supported for EFI_EXT_SCSI_PASS_THRU_PROTOCOL.PassThru().
 
   - Only one channel is supported. (At the time of this writing, host-side
     virtio-scsi supports a single channel too.)
 
-  - Only one request queue is used (for the one synchronous request).
+  - Only one request queue is used, even if the host offers more. Requests are
+    polled for from a single thread of execution, so more queues would not add
+    concurrency.
 
   - The ResetChannel() and ResetTargetLun() functions of
     EFI_EXT_SCSI_PASS_THRU_PROTOCOL are not supported (which is allowed by the
@@ -413,6 +417,180 @@ ReportHostAdapterError (
 }
 
 
+/**
+
+  Release the data buffer mappings of a request slot, and the intermediate
+  input buffer, if any.
+
+  @param[in]     Dev  The VSCSI_DEV structure that Req belongs to.
+
+  @param[in,out] Req  The request slot whose data buffers should be released.
+                      The slot itself is not released.
+
+**/
+STATIC
+VOID
+VirtioScsiUnmapReq (
+  IN     VSCSI_DEV *Dev,
+  IN OUT VSCSI_REQ *Req
+  )
+{
+  if (Req->OutDataMapping != NULL) {
+    Dev->VirtIo->UnmapSharedBuffer (Dev->VirtIo, Req->OutDataMapping);
+    Req->OutDataMapping = NULL;
+  }
+
+  if (Req->InDataMapping != NULL) {
+    Dev->VirtIo->UnmapSharedBuffer (Dev->VirtIo, Req->InDataMapping);
+    Req->InDataMapping = NULL;
+  }
+
+  if (Req->InDataBuffer != NULL) {
+    Dev->VirtIo->FreeSharedPages (
+                   Dev->VirtIo,
+                   Req->InDataNumPages,
+                   Req->InDataBuffer
+                   );
+    Req->InDataBuffer = NULL;
+  }
+}
+
+
+/**
+
+  Finish a request that the host has returned in the used ring.
+
+  The Packet of the request is updated from the virtio-scsi response. A
+  non-blocking request releases its slot and signals its event; a blocking
+  request only marks its slot done, and VirtioScsiPassThru() releases the slot
+  once it has fetched the status.
+
+  The caller is responsible for running at TPL_NOTIFY.
+
+  @param[in,out] Dev     The VSCSI_DEV structure that the request belongs to.
+
+  @param[in]     ReqIdx  The index of the request slot to complete.
+
+**/
+STATIC
+VOID
+VirtioScsiCompleteReq (
+  IN OUT VSCSI_DEV *Dev,
+  IN     UINT16    ReqIdx
+  )
+{
+  VSCSI_REQ *Req;
+  EFI_EVENT Event;
+
+  Req = &Dev->Requests[ReqIdx];
+
+  //
+  // A request without a packet has been abandoned by VirtioScsiPassThru().
+  //
+  if (Req->Packet != NULL) {
+    Req->Status = ParseResponse (Req->Packet, &Dev->SharedReq[ReqIdx].Response);
+
+    //
+    // If it was a CPU read request then we have used an intermediate buffer.
+    // Copy the data from intermediate buffer to the final buffer.
+    //
+    if (Req->InDataBuffer != NULL) {
+      CopyMem (
+        Req->Packet->InDataBuffer,
+        Req->InDataBuffer,
+        Req->Packet->InTransferLength
+        );
+    }
+  }
+
+  VirtioScsiUnmapReq (Dev, Req);
+
+  ASSERT (Dev->InFlight > 0);
+  if (--Dev->InFlight == 0) {
+    gBS->SetTimer (Dev->PollTimer, TimerCancel, 0);
+  }
+
+  if (Req->Packet != NULL && Req->Event == NULL) {
+    Req->Done = TRUE;
+    return;
+  }
+
+  Event      = Req->Event;
+  Req->InUse = FALSE;
+  if (Event != NULL) {
+    gBS->SignalEvent (Event);
+  }
+}
+
+
+/**
+
+  Collect all requests that the host has returned in the used ring since the
+  last call.
+
+  The caller is responsible for running at TPL_NOTIFY.
+
+  @param[in,out] Dev  The VSCSI_DEV structure whose request queue should be
+                      checked.
+
+**/
+STATIC
+VOID
+VirtioScsiReapReqs (
+  IN OUT VSCSI_DEV *Dev
+  )
+{
+  UINT16 UsedIdx;
+  UINT32 DescIdx;
+  UINT32 ReqIdx;
+
+  //
+  // virtio-0.9.5, 2.4.2 Receiving Used Buffers From the Device
+  //
+  MemoryFence ();
+  UsedIdx = *Dev->Ring.Used.Idx;
+  MemoryFence ();
+
+  while (Dev->LastUsedIdx != UsedIdx) {
+    DescIdx = Dev->Ring.Used.UsedElem[Dev->LastUsedIdx % Dev->Ring.QueueSize].Id;
+    Dev->LastUsedIdx++;
+    ReqIdx  = Dev->IndirectDesc ? DescIdx : DescIdx / VSCSI_DESC_PER_REQUEST;
+
+    if ((!Dev->IndirectDesc && DescIdx % VSCSI_DESC_PER_REQUEST != 0) ||
+        ReqIdx >= Dev->NumRequests ||
+        !Dev->Requests[ReqIdx].InUse ||
+        Dev->Requests[ReqIdx].Done) {
+      DEBUG ((DEBUG_ERROR, "%a: unexpected used descriptor %u\n",
+        __FUNCTION__, DescIdx));
+      continue;
+    }
+
+    VirtioScsiCompleteReq (Dev, (UINT16)ReqIdx);
+  }
+}
+
+
+/**
+
+  Timer notification function that completes non-blocking requests.
+
+  @param[in] Event    The poll timer of the device.
+
+  @param[in] Context  Pointer to the VSCSI_DEV structure.
+
+**/
+STATIC
+VOID
+EFIAPI
+VirtioScsiPollReqs (
+  IN EFI_EVENT Event,
+  IN VOID      *Context
+  )
+{
+  VirtioScsiReapReqs (Context);
+}
+
+
 //
 // The next seven functions implement EFI_EXT_SCSI_PASS_THRU_PROTOCOL
 // for the virtio-scsi HBA. Refer to UEFI Spec 2.3.1 + Errata C, sections
@@ -433,59 +611,93 @@ VirtioScsiPassThru (
   VSCSI_DEV                 *Dev;
   UINT16                    TargetValue;
   EFI_STATUS                Status;
-  volatile VIRTIO_SCSI_REQ  Request;
-  volatile VIRTIO_SCSI_RESP *Response;
-  VOID                      *ResponseBuffer;
-  DESC_INDICES              Indices;
-  VOID                      *RequestMapping;
-  VOID                      *ResponseMapping;
-  VOID                      *InDataMapping;
-  VOID                      *OutDataMapping;
-  EFI_PHYSICAL_ADDRESS      RequestDeviceAddress;
-  EFI_PHYSICAL_ADDRESS      ResponseDeviceAddress;
+  VIRTIO_SCSI_REQ           Request;
+  EFI_TPL                   OldTpl;
+  UINTN                     PollPeriodUsecs;
+  UINT16                    ReqIdx;
+  VSCSI_REQ                 *Req;
+  volatile VSCSI_SHARED_REQ *Shared;
+  EFI_PHYSICAL_ADDRESS      SharedDeviceAddress;
   EFI_PHYSICAL_ADDRESS      InDataDeviceAddress;
   EFI_PHYSICAL_ADDRESS      OutDataDeviceAddress;
-  VOID                      *InDataBuffer;
-  UINTN                     InDataNumPages;
-  BOOLEAN                   OutDataBufferIsMapped;
+  VRING                     IndirectRing;
+  VRING                     *DescRing;
+  DESC_INDICES              Indices;
+  UINT16                    AvailIdx;
 
   //
-  // Set InDataMapping,OutDataMapping,InDataDeviceAddress and OutDataDeviceAddress to
-  // suppress incorrect compiler/analyzer warnings.
+  // Set InDataDeviceAddress and OutDataDeviceAddress to suppress incorrect
+  // compiler/analyzer warnings.
   //
-  InDataMapping        = NULL;
-  OutDataMapping       = NULL;
   InDataDeviceAddress  = 0;
   OutDataDeviceAddress = 0;
 
-  ZeroMem ((VOID*) &Request, sizeof (Request));
+  ZeroMem (&Request, sizeof (Request));
 
   Dev = VIRTIO_SCSI_FROM_PASS_THRU (This);
   CopyMem (&TargetValue, Target, sizeof TargetValue);
 
-  InDataBuffer = NULL;
-  OutDataBufferIsMapped = FALSE;
-  InDataNumPages = 0;
-
   Status = PopulateRequest (Dev, TargetValue, Lun, Packet, &Request);
   if (EFI_ERROR (Status)) {
     return Status;
   }
 
   //
-  // Map the virtio-scsi Request header buffer
+  // Grab a free request slot. If all slots are in flight, a non-blocking
+  // caller is asked to retry, while a blocking caller waits for the host to
+  // return a slot. Keep slowing down until we reach a poll period of slightly
+  // above 1 ms.
   //
-  Status = VirtioMapAllBytesInSharedBuffer (
-             Dev->VirtIo,
-             VirtioOperationBusMasterRead,
-             (VOID *) &Request,
-             sizeof Request,
-             &RequestDeviceAddress,
-             &RequestMapping);
-  if (EFI_ERROR (Status)) {
-    return ReportHostAdapterError (Packet);
+  PollPeriodUsecs = 1;
+  for (;;) {
+    OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+    VirtioScsiReapReqs (Dev);
+    for (ReqIdx = 0; ReqIdx < Dev->NumRequests; ++ReqIdx) {
+      if (!Dev->Requests[ReqIdx].InUse) {
+        break;
+      }
+    }
+    if (ReqIdx < Dev->NumRequests) {
+      Dev->Requests[ReqIdx].InUse = TRUE;
+      gBS->RestoreTPL (OldTpl);
+      break;
+    }
+    gBS->RestoreTPL (OldTpl);
+
+    if (Event != NULL) {
+      return EFI_NOT_READY;
+    }
+    gBS->Stall (PollPeriodUsecs);
+    if (PollPeriodUsecs < 1024) {
+      PollPeriodUsecs *= 2;
+    }
   }
 
+  Req                 = &Dev->Requests[ReqIdx];
+  Req->Done           = FALSE;
+  Req->Packet         = Packet;
+  Req->Event          = Event;
+  Req->InDataBuffer   = NULL;
+  Req->InDataNumPages = 0;
+  Req->InDataMapping  = NULL;
+  Req->OutDataMapping = NULL;
+
+  //
+  // The request header, the response header and the indirect descriptor
+  // table of the slot have been mapped as a common buffer in
+  // VirtioScsiInitReq().
+  //
+  Shared              = &Dev->SharedReq[ReqIdx];
+  SharedDeviceAddress = Dev->SharedReqBase +
+                        ReqIdx * sizeof (VSCSI_SHARED_REQ);
+  CopyMem ((VOID *)&Shared->Request, &Request, sizeof Request);
+  ZeroMem ((VOID *)&Shared->Response, sizeof Shared->Response);
+
+  //
+  // preset a host status for ourselves that we do not accept as success
+  //
+  Shared->Response.Response = VIRTIO_SCSI_S_FAILURE;
+
   //
   // Map the input buffer
   //
@@ -505,30 +717,32 @@ VirtioScsiPassThru (
     // the Virtio request is successful then we copy the data from temporary
     // buffer into Packet->InDataBuffer.
     //
-    InDataNumPages = EFI_SIZE_TO_PAGES ((UINTN)Packet->InTransferLength);
+    Req->InDataNumPages = EFI_SIZE_TO_PAGES ((UINTN)Packet->InTransferLength);
     Status = Dev->VirtIo->AllocateSharedPages (
                             Dev->VirtIo,
-                            InDataNumPages,
-                            &InDataBuffer
+                            Req->InDataNumPages,
+                            &Req->InDataBuffer
                             );
     if (EFI_ERROR (Status)) {
+      Req->InDataBuffer = NULL;
       Status = ReportHostAdapterError (Packet);
-      goto UnmapRequestBuffer;
+      goto ReleaseReq;
     }
 
-    ZeroMem (InDataBuffer, Packet->InTransferLength);
+    ZeroMem (Req->InDataBuffer, Packet->InTransferLength);
 
     Status = VirtioMapAllBytesInSharedBuffer (
                Dev->VirtIo,
                VirtioOperationBusMasterCommonBuffer,
-               InDataBuffer,
+               Req->InDataBuffer,
                Packet->InTransferLength,
                &InDataDeviceAddress,
-               &InDataMapping
+               &Req->InDataMapping
                );
     if (EFI_ERROR (Status)) {
+      Req->InDataMapping = NULL;
       Status = ReportHostAdapterError (Packet);
-      goto FreeInDataBuffer;
+      goto ReleaseReq;
     }
   }
 
@@ -542,72 +756,40 @@ VirtioScsiPassThru (
                Packet->OutDataBuffer,
                Packet->OutTransferLength,
                &OutDataDeviceAddress,
-               &OutDataMapping
+               &Req->OutDataMapping
                );
     if (EFI_ERROR (Status)) {
+      Req->OutDataMapping = NULL;
       Status = ReportHostAdapterError (Packet);
-      goto UnmapInDataBuffer;
+      goto ReleaseReq;
     }
-
-    OutDataBufferIsMapped = TRUE;
-  }
-
-  //
-  // Response header is bi-direction (we preset with host status and expect
-  // the device to update it). Allocate a response buffer which can be mapped
-  // to access equally by both processor and device.
-  //
-  Status = Dev->VirtIo->AllocateSharedPages (
-                          Dev->VirtIo,
-                          EFI_SIZE_TO_PAGES (sizeof *Response),
-                          &ResponseBuffer
-                          );
-  if (EFI_ERROR (Status)) {
-    Status = ReportHostAdapterError (Packet);
-    goto UnmapOutDataBuffer;
   }
 
-  Response = ResponseBuffer;
-
-  ZeroMem ((VOID *)Response, sizeof (*Response));
-
-  //
-  // preset a host status for ourselves that we do not accept as success
-  //
-  Response->Response = VIRTIO_SCSI_S_FAILURE;
-
   //
-  // Map the response buffer with BusMasterCommonBuffer so that response
-  // buffer can be accessed by both host and device.
+  // Build the descriptor chain either in the indirect table of the slot, or
+  // in the ring descriptors that the slot owns. This, in combination with
+  // VirtioScsiInit() ensuring Dev->Ring.QueueSize >= 4, means that we don't
+  // have to track free descriptors beyond the request slots.
   //
-  Status = VirtioMapAllBytesInSharedBuffer (
-             Dev->VirtIo,
-             VirtioOperationBusMasterCommonBuffer,
-             ResponseBuffer,
-             sizeof (*Response),
-             &ResponseDeviceAddress,
-             &ResponseMapping
-             );
-  if (EFI_ERROR (Status)) {
-    Status = ReportHostAdapterError (Packet);
-    goto FreeResponseBuffer;
+  if (Dev->IndirectDesc) {
+    ZeroMem (&IndirectRing, sizeof IndirectRing);
+    IndirectRing.Desc      = Shared->Indirect;
+    IndirectRing.QueueSize = VSCSI_DESC_PER_REQUEST;
+    DescRing               = &IndirectRing;
+    Indices.HeadDescIdx    = 0;
+  } else {
+    DescRing               = &Dev->Ring;
+    Indices.HeadDescIdx    = (UINT16)(ReqIdx * VSCSI_DESC_PER_REQUEST);
   }
-
-  VirtioPrepare (&Dev->Ring, &Indices);
-
-  //
-  // ensured by VirtioScsiInit() -- this predicate, in combination with the
-  // lock-step progress, ensures we don't have to track free descriptors.
-  //
-  ASSERT (Dev->Ring.QueueSize >= 4);
+  Indices.NextDescIdx = Indices.HeadDescIdx;
 
   //
   // enqueue Request
   //
   VirtioAppendDesc (
-    &Dev->Ring,
-    RequestDeviceAddress,
-    sizeof Request,
+    DescRing,
+    SharedDeviceAddress + OFFSET_OF (VSCSI_SHARED_REQ, Request),
+    sizeof Shared->Request,
     VRING_DESC_F_NEXT,
     &Indices
     );
@@ -617,7 +799,7 @@ VirtioScsiPassThru (
   //
   if (Packet->OutTransferLength > 0) {
     VirtioAppendDesc (
-      &Dev->Ring,
+      DescRing,
       OutDataDeviceAddress,
       Packet->OutTransferLength,
       VRING_DESC_F_NEXT,
@@ -629,9 +811,9 @@ VirtioScsiPassThru (
   // enqueue Response, to be written by the host
   //
   VirtioAppendDesc (
-    &Dev->Ring,
-    ResponseDeviceAddress,
-    sizeof *Response,
+    DescRing,
+    SharedDeviceAddress + OFFSET_OF (VSCSI_SHARED_REQ, Response),
+    sizeof Shared->Response,
     VRING_DESC_F_WRITE | (Packet->InTransferLength > 0 ? VRING_DESC_F_NEXT : 0),
     &Indices
     );
@@ -641,7 +823,7 @@ VirtioScsiPassThru (
   //
   if (Packet->InTransferLength > 0) {
     VirtioAppendDesc (
-      &Dev->Ring,
+      DescRing,
       InDataDeviceAddress,
       Packet->InTransferLength,
       VRING_DESC_F_WRITE,
@@ -649,55 +831,87 @@ VirtioScsiPassThru (
       );
   }
 
-  // If kicking the host fails, we must fake a host adapter error.
-  // EFI_NOT_READY would save us the effort, but it would also suggest that the
-  // caller retry.
   //
-  if (VirtioFlush (Dev->VirtIo, VIRTIO_SCSI_REQUEST_QUEUE, &Dev->Ring,
-        &Indices, NULL) != EFI_SUCCESS) {
-    Status = ReportHostAdapterError (Packet);
-    goto UnmapResponseBuffer;
+  // With indirect descriptors, the ring descriptor owned by the slot only
+  // points at the table built above.
+  //
+  if (Dev->IndirectDesc) {
+    Dev->Ring.Desc[ReqIdx].Addr  = SharedDeviceAddress +
+                                   OFFSET_OF (VSCSI_SHARED_REQ, Indirect);
+    Dev->Ring.Desc[ReqIdx].Len   = Indices.NextDescIdx * sizeof (VRING_DESC);
+    Dev->Ring.Desc[ReqIdx].Flags = VRING_DESC_F_INDIRECT;
+    Dev->Ring.Desc[ReqIdx].Next  = 0;
+    Indices.HeadDescIdx          = ReqIdx;
   }
 
-  Status = ParseResponse (Packet, Response);
+  OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
 
   //
-  // If virtio request was successful and it was a CPU read request then we
-  // have used an intermediate buffer. Copy the data from intermediate buffer
-  // to the final buffer.
+  // virtio-0.9.5, 2.4.1.2 Updating the Available Ring
   //
-  if (InDataBuffer != NULL) {
-    CopyMem (Packet->InDataBuffer, InDataBuffer, Packet->InTransferLength);
-  }
-
-UnmapResponseBuffer:
-  Dev->VirtIo->UnmapSharedBuffer (Dev->VirtIo, ResponseMapping);
+  AvailIdx = *Dev->Ring.Avail.Idx;
+  Dev->Ring.Avail.Ring[AvailIdx++ % Dev->Ring.QueueSize] = Indices.HeadDescIdx;
 
-FreeResponseBuffer:
-  Dev->VirtIo->FreeSharedPages (
-                 Dev->VirtIo,
-                 EFI_SIZE_TO_PAGES (sizeof *Response),
-                 ResponseBuffer
-                 );
+  //
+  // virtio-0.9.5, 2.4.1.3 Updating the Index Field
+  //
+  MemoryFence ();
+  *Dev->Ring.Avail.Idx = AvailIdx;
 
-UnmapOutDataBuffer:
-  if (OutDataBufferIsMapped) {
-    Dev->VirtIo->UnmapSharedBuffer (Dev->VirtIo, OutDataMapping);
+  if (Dev->InFlight++ == 0) {
+    gBS->SetTimer (Dev->PollTimer, TimerPeriodic, VSCSI_POLL_PERIOD);
   }
 
-UnmapInDataBuffer:
-  if (InDataBuffer != NULL) {
-    Dev->VirtIo->UnmapSharedBuffer (Dev->VirtIo, InDataMapping);
+  //
+  // virtio-0.9.5, 2.4.1.4 Notifying the Device -- gratuitous notifications are
+  // OK.
+  //
+  // If kicking the host fails, we must fake a host adapter error.
+  // EFI_NOT_READY would save us the effort, but it would also suggest that the
+  // caller retry. The request is visible to the host by now, so the slot and
+  // its buffers are abandoned to VirtioScsiCompleteReq() rather than released
+  // here.
+  //
+  MemoryFence ();
+  Status = Dev->VirtIo->SetQueueNotify (Dev->VirtIo, VIRTIO_SCSI_REQUEST_QUEUE);
+  if (EFI_ERROR (Status)) {
+    Req->Packet = NULL;
+    Req->Event  = NULL;
+    gBS->RestoreTPL (OldTpl);
+    return ReportHostAdapterError (Packet);
   }
+  gBS->RestoreTPL (OldTpl);
 
-FreeInDataBuffer:
-  if (InDataBuffer != NULL) {
-    Dev->VirtIo->FreeSharedPages (Dev->VirtIo, InDataNumPages, InDataBuffer);
+  //
+  // A non-blocking request is completed from the poll timer, or from any later
+  // VirtioScsiPassThru() call, whichever comes first.
+  //
+  if (Event != NULL) {
+    return EFI_SUCCESS;
   }
 
-UnmapRequestBuffer:
-  Dev->VirtIo->UnmapSharedBuffer (Dev->VirtIo, RequestMapping);
+  PollPeriodUsecs = 1;
+  for (;;) {
+    OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+    VirtioScsiReapReqs (Dev);
+    if (Req->Done) {
+      Status     = Req->Status;
+      Req->Done  = FALSE;
+      Req->InUse = FALSE;
+      gBS->RestoreTPL (OldTpl);
+      return Status;
+    }
+    gBS->RestoreTPL (OldTpl);
+
+    gBS->Stall (PollPeriodUsecs);
+    if (PollPeriodUsecs < 1024) {
+      PollPeriodUsecs *= 2;
+    }
+  }
 
+ReleaseReq:
+  VirtioScsiUnmapReq (Dev, Req);
+  Req->InUse = FALSE;
   return Status;
 }
 
@@ -916,6 +1130,136 @@ VirtioScsiGetNextTarget (
 }
 
 
+/**
+
+  Set up the request slots of the device, after the request queue has been
+  allocated and mapped.
+
+  @param[in,out] Dev  The VSCSI_DEV structure whose request slots should be
+                      set up.
+
+  @retval EFI_SUCCESS  The request slots are ready for VirtioScsiPassThru().
+
+  @return              Status codes from AllocateSharedPages(),
+                       VirtioMapAllBytesInSharedBuffer() and CreateEvent().
+
+**/
+STATIC
+EFI_STATUS
+VirtioScsiInitReq (
+  IN OUT VSCSI_DEV *Dev
+  )
+{
+  EFI_STATUS Status;
+  UINTN      NumPages;
+  VOID       *Buffer;
+
+  if (Dev->IndirectDesc) {
+    Dev->NumRequests = Dev->Ring.QueueSize;
+  } else {
+    Dev->NumRequests = Dev->Ring.QueueSize / VSCSI_DESC_PER_REQUEST;
+  }
+  if (Dev->NumRequests > VSCSI_MAX_REQUESTS) {
+    Dev->NumRequests = VSCSI_MAX_REQUESTS;
+  }
+  Dev->InFlight    = 0;
+  Dev->LastUsedIdx = 0;
+  ZeroMem (Dev->Requests, sizeof Dev->Requests);
+
+  //
+  // Prepare for virtio-0.9.5, 2.4.2 Receiving Used Buffers From the Device.
+  // We're going to poll the answers, the host should not send interrupts.
+  //
+  *Dev->Ring.Avail.Flags = (UINT16) VRING_AVAIL_F_NO_INTERRUPT;
+
+  NumPages = EFI_SIZE_TO_PAGES (Dev->NumRequests * sizeof (VSCSI_SHARED_REQ));
+  Status = Dev->VirtIo->AllocateSharedPages (Dev->VirtIo, NumPages, &Buffer);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+  ZeroMem (Buffer, EFI_PAGES_TO_SIZE (NumPages));
+
+  Status = VirtioMapAllBytesInSharedBuffer (
+             Dev->VirtIo,
+             VirtioOperationBusMasterCommonBuffer,
+             Buffer,
+             EFI_PAGES_TO_SIZE (NumPages),
+             &Dev->SharedReqBase,
+             &Dev->SharedReqMap
+             );
+  if (EFI_ERROR (Status)) {
+    goto FreeSharedReq;
+  }
+
+  Status = gBS->CreateEvent (EVT_TIMER | EVT_NOTIFY_SIGNAL, TPL_NOTIFY,
+                  &VirtioScsiPollReqs, Dev, &Dev->PollTimer);
+  if (EFI_ERROR (Status)) {
+    goto UnmapSharedReq;
+  }
+
+  Dev->SharedReq = Buffer;
+  return EFI_SUCCESS;
+
+UnmapSharedReq:
+  Dev->VirtIo->UnmapSharedBuffer (Dev->VirtIo, Dev->SharedReqMap);
+
+FreeSharedReq:
+  Dev->VirtIo->FreeSharedPages (Dev->VirtIo, NumPages, Buffer);
+
+  return Status;
+}
+
+
+/**
+
+  Tear down the request slots of the device. The caller is responsible for
+  having reset the device first, so that the host no longer accesses the
+  slots.
+
+  Non-blocking requests still in flight are completed with a host adapter
+  error.
+
+  @param[in,out] Dev  The VSCSI_DEV structure whose request slots should be
+                      torn down.
+
+**/
+STATIC
+VOID
+VirtioScsiUninitReq (
+  IN OUT VSCSI_DEV *Dev
+  )
+{
+  UINT16    ReqIdx;
+  VSCSI_REQ *Req;
+
+  gBS->CloseEvent (Dev->PollTimer);
+
+  for (ReqIdx = 0; ReqIdx < Dev->NumRequests; ++ReqIdx) {
+    Req = &Dev->Requests[ReqIdx];
+    if (!Req->InUse) {
+      continue;
+    }
+
+    VirtioScsiUnmapReq (Dev, Req);
+    if (Req->Packet != NULL && Req->Event != NULL) {
+      ReportHostAdapterError (Req->Packet);
+      gBS->SignalEvent (Req->Event);
+    }
+    Req->InUse = FALSE;
+  }
+  Dev->InFlight = 0;
+
+  Dev->VirtIo->UnmapSharedBuffer (Dev->VirtIo, Dev->SharedReqMap);
+  Dev->VirtIo->FreeSharedPages (
+                 Dev->VirtIo,
+                 EFI_SIZE_TO_PAGES (Dev->NumRequests * sizeof (VSCSI_SHARED_REQ)),
+                 Dev->SharedReq
+                 );
+  Dev->SharedReq   = NULL;
+  Dev->NumRequests = 0;
+}
+
+
 STATIC
 EFI_STATUS
 EFIAPI
@@ -928,7 +1272,7 @@ VirtioScsiInit (
   UINT64     RingBaseShift;
   UINT64     Features;
   UINT16     MaxChannel; // for validation only
-  UINT32     NumQueues;  // for validation only
+  UINT32     NumQueues;
   UINT16     QueueSize;
 
   //
@@ -989,6 +1333,13 @@ VirtioScsiInit (
     Status = EFI_UNSUPPORTED;
     goto Failed;
   }
+  //
+  // All requests are polled from a single thread of execution, so additional
+  // request queues would not add any concurrency beyond what the in-flight
+  // request slots on the first request queue already provide.
+  //
+  DEBUG ((DEBUG_VERBOSE, "%a: NumQueues=%u, using the first request queue\n",
+    __FUNCTION__, NumQueues));
 
   Status = VIRTIO_CFG_READ (Dev, MaxTarget, &Dev->MaxTarget);
   if (EFI_ERROR (Status)) {
@@ -1020,7 +1371,8 @@ VirtioScsiInit (
   }
 
   Features &= VIRTIO_SCSI_F_INOUT | VIRTIO_F_VERSION_1 |
-              VIRTIO_F_IOMMU_PLATFORM;
+              VIRTIO_F_IOMMU_PLATFORM | VIRTIO_F_RING_INDIRECT_DESC;
+  Dev->IndirectDesc = (BOOLEAN) ((Features & VIRTIO_F_RING_INDIRECT_DESC) != 0);
 
   //
   // In virtio-1.0, feature negotiation is expected to complete before queue
@@ -1070,18 +1422,24 @@ VirtioScsiInit (
     goto ReleaseQueue;
   }
 
+  Status = VirtioScsiInitReq (Dev);
+  if (EFI_ERROR (Status)) {
+    goto UnmapQueue;
+  }
+
   //
   // Additional steps for MMIO: align the queue appropriately, and set the
-  // size. If anything fails from here on, we must unmap the ring resources.
+  // size. If anything fails from here on, we must tear down the request slots
+  // and unmap the ring resources.
   //
   Status = Dev->VirtIo->SetQueueNum (Dev->VirtIo, QueueSize);
   if (EFI_ERROR (Status)) {
-    goto UnmapQueue;
+    goto UninitReq;
   }
 
   Status = Dev->VirtIo->SetQueueAlign (Dev->VirtIo, EFI_PAGE_SIZE);
   if (EFI_ERROR (Status)) {
-    goto UnmapQueue;
+    goto UninitReq;
   }
 
   //
@@ -1093,7 +1451,7 @@ VirtioScsiInit (
                           RingBaseShift
                           );
   if (EFI_ERROR (Status)) {
-    goto UnmapQueue;
+    goto UninitReq;
   }
 
   //
@@ -1103,7 +1461,7 @@ VirtioScsiInit (
     Features &= ~(UINT64)(VIRTIO_F_VERSION_1 | VIRTIO_F_IOMMU_PLATFORM);
     Status = Dev->VirtIo->SetGuestFeatures (Dev->VirtIo, Features);
     if (EFI_ERROR (Status)) {
-      goto UnmapQueue;
+      goto UninitReq;
     }
   }
 
@@ -1113,11 +1471,11 @@ VirtioScsiInit (
   //
   Status = VIRTIO_CFG_WRITE (Dev, CdbSize, VIRTIO_SCSI_CDB_SIZE);
   if (EFI_ERROR (Status)) {
-    goto UnmapQueue;
+    goto UninitReq;
   }
   Status = VIRTIO_CFG_WRITE (Dev, SenseSize, VIRTIO_SCSI_SENSE_SIZE);
   if (EFI_ERROR (Status)) {
-    goto UnmapQueue;
+    goto UninitReq;
   }
 
   //
@@ -1126,7 +1484,7 @@ VirtioScsiInit (
   NextDevStat |= VSTAT_DRIVER_OK;
   Status = Dev->VirtIo->SetDeviceStatus (Dev->VirtIo, NextDevStat);
   if (EFI_ERROR (Status)) {
-    goto UnmapQueue;
+    goto UninitReq;
   }
 
   //
@@ -1150,10 +1508,11 @@ VirtioScsiInit (
   //
   // Set both physical and logical attributes for non-RAID SCSI channel. See
   // Driver Writer's Guide for UEFI 2.3.1 v1.01, 20.1.5 Implementing Extended
-  // SCSI Pass Thru Protocol.
+  // SCSI Pass Thru Protocol. The request slots allow for non-blocking I/O.
   //
   Dev->PassThruMode.Attributes = EFI_EXT_SCSI_PASS_THRU_ATTRIBUTES_PHYSICAL |
-                                 EFI_EXT_SCSI_PASS_THRU_ATTRIBUTES_LOGICAL;
+                                 EFI_EXT_SCSI_PASS_THRU_ATTRIBUTES_LOGICAL |
+                                 EFI_EXT_SCSI_PASS_THRU_ATTRIBUTES_NONBLOCKIO;
 
   //
   // no restriction on transfer buffer alignment
@@ -1162,6 +1521,9 @@ VirtioScsiInit (
 
   return EFI_SUCCESS;
 
+UninitReq:
+  VirtioScsiUninitReq (Dev);
+
 UnmapQueue:
   Dev->VirtIo->UnmapSharedBuffer (Dev->VirtIo, Dev->RingMap);
 
@@ -1177,6 +1539,7 @@ Failed:
   Dev->VirtIo->SetDeviceStatus (Dev->VirtIo, NextDevStat);
 
   Dev->InOutSupported = FALSE;
+  Dev->IndirectDesc   = FALSE;
   Dev->MaxTarget      = 0;
   Dev->MaxLun         = 0;
   Dev->MaxSectors     = 0;
@@ -1199,7 +1562,10 @@ VirtioScsiUninit (
   //
   Dev->VirtIo->SetDeviceStatus (Dev->VirtIo, 0);
 
+  VirtioScsiUninitReq (Dev);
+
   Dev->InOutSupported = FALSE;
+  Dev->IndirectDesc   = FALSE;
   Dev->MaxTarget      = 0;
   Dev->MaxLun         = 0;
   Dev->MaxSectors     = 0;
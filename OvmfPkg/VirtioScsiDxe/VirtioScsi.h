@@ -17,6 +17,7 @@
 #include <Protocol/ScsiPassThruExt.h>
 
 #include <IndustryStandard/Virtio.h>
+#include <IndustryStandard/VirtioScsi.h>
 
 
 //
@@ -34,6 +35,56 @@
 #endif
 
 
+//
+// The maximum number of virtio-scsi requests that VirtioScsiPassThru() keeps
+// in flight on the request queue at the same time. The actual limit is also
+// bounded by the queue size that the host offers.
+//
+#define VSCSI_MAX_REQUESTS 32
+
+//
+// A request consists of at most four descriptors: request header, "dataout",
+// response header, "datain". Without VIRTIO_F_RING_INDIRECT_DESC, request
+// slot #N owns the ring descriptors [N * 4, N * 4 + 3]; with indirect
+// descriptors, request slot #N owns ring descriptor #N only, which points to
+// the slot's own descriptor table.
+//
+#define VSCSI_DESC_PER_REQUEST 4
+
+//
+// Period of the timer that reaps completed non-blocking requests.
+//
+#define VSCSI_POLL_PERIOD EFI_TIMER_PERIOD_MILLISECONDS (1)
+
+//
+// The part of a request slot that the host accesses. An array of
+// VSCSI_MAX_REQUESTS such structures is allocated and mapped once, as a
+// common buffer, in VirtioScsiInitReq().
+//
+#pragma pack (1)
+typedef struct {
+  VRING_DESC       Indirect[VSCSI_DESC_PER_REQUEST];
+  VIRTIO_SCSI_REQ  Request;
+  VIRTIO_SCSI_RESP Response;
+} VSCSI_SHARED_REQ;
+#pragma pack ()
+
+//
+// The part of a request slot that only the driver accesses.
+//
+typedef struct {
+  BOOLEAN                                    InUse;
+  BOOLEAN                                    Done;
+  EFI_STATUS                                 Status;
+  EFI_EXT_SCSI_PASS_THRU_SCSI_REQUEST_PACKET *Packet;
+  EFI_EVENT                                  Event;
+  VOID                                       *InDataBuffer;
+  UINTN                                      InDataNumPages;
+  UINT32                                     InDataLength;
+  VOID                                       *InDataMapping;
+  VOID                                       *OutDataMapping;
+} VSCSI_REQ;
+
 #define VSCSI_SIG SIGNATURE_32 ('V', 'S', 'C', 'S')
 
 typedef struct {
@@ -48,6 +99,7 @@ typedef struct {
   VIRTIO_DEVICE_PROTOCOL          *VirtIo;        // DriverBindingStart  0
   EFI_EVENT                       ExitBoot;       // DriverBindingStart  0
   BOOLEAN                         InOutSupported; // VirtioScsiInit      1
+  BOOLEAN                         IndirectDesc;   // VirtioScsiInit      1
   UINT16                          MaxTarget;      // VirtioScsiInit      1
   UINT32                          MaxLun;         // VirtioScsiInit      1
   UINT32                          MaxSectors;     // VirtioScsiInit      1
@@ -55,6 +107,15 @@ typedef struct {
   EFI_EXT_SCSI_PASS_THRU_PROTOCOL PassThru;       // VirtioScsiInit      1
   EFI_EXT_SCSI_PASS_THRU_MODE     PassThruMode;   // VirtioScsiInit      1
   VOID                            *RingMap;       // VirtioRingMap       2
+  UINT16                          LastUsedIdx;    // VirtioScsiInitReq   2
+  UINT16                          NumRequests;    // VirtioScsiInitReq   2
+  UINT16                          InFlight;       // VirtioScsiInitReq   2
+  EFI_EVENT                       PollTimer;      // VirtioScsiInitReq   2
+  VSCSI_SHARED_REQ                *SharedReq;     // VirtioScsiInitReq   2
+  EFI_PHYSICAL_ADDRESS            SharedReqBase;  // VirtioScsiInitReq   2
+  VOID                            *SharedReqMap;  // VirtioScsiInitReq   2
+  VSCSI_REQ                       Requests[VSCSI_MAX_REQUESTS];
+                                                  // VirtioScsiInitReq   2
 } VSCSI_DEV;
 
 #define VIRTIO_SCSI_FROM_PASS_THRU(PassThruPointer) \
@@ -57,6 +57,37 @@ XenBusReadUint64 (
   return Status;
 }
 
+/**
+  End the access of the backend to the persistently granted pages and free
+  them.
+
+  @param Dev  A XEN_BLOCK_FRONT_DEVICE instance.
+**/
+STATIC
+VOID
+XenPvBlockFreeGrants (
+  IN XEN_BLOCK_FRONT_DEVICE *Dev
+  )
+{
+  XENBUS_PROTOCOL *XenBusIo = Dev->XenBusIo;
+  UINT32 Index;
+
+  if (Dev->Grants != NULL) {
+    for (Index = 0; Index < XEN_BLOCK_FRONT_GRANT_PAGES; Index++) {
+      if (Dev->Grants[Index].Ref != 0) {
+        XenBusIo->GrantEndAccess (XenBusIo, Dev->Grants[Index].Ref);
+      }
+    }
+    FreePool (Dev->Grants);
+    Dev->Grants = NULL;
+  }
+  if (Dev->GrantPages != NULL) {
+    FreePages (Dev->GrantPages, XEN_BLOCK_FRONT_GRANT_PAGES);
+    Dev->GrantPages = NULL;
+  }
+  Dev->FreeGrantCount = 0;
+}
+
 /**
   Free an instance of XEN_BLOCK_FRONT_DEVICE.
 
@@ -70,6 +101,7 @@ XenPvBlockFree (
 {
   XENBUS_PROTOCOL *XenBusIo = Dev->XenBusIo;
 
+  XenPvBlockFreeGrants (Dev);
   if (Dev->RingRef != 0) {
     XenBusIo->GrantEndAccess (XenBusIo, Dev->RingRef);
   }
@@ -82,6 +114,48 @@ XenPvBlockFree (
   FreePool (Dev);
 }
 
+/**
+  Grant the pool of bounce pages to the backend once, for the lifetime of the
+  device, so that requests don't need grant table operations.
+
+  @param Dev  A XEN_BLOCK_FRONT_DEVICE instance.
+
+  @retval EFI_SUCCESS           The pages are granted.
+  @retval EFI_OUT_OF_RESOURCES  The pages could not be allocated or granted.
+**/
+STATIC
+EFI_STATUS
+XenPvBlockInitGrants (
+  IN XEN_BLOCK_FRONT_DEVICE *Dev
+  )
+{
+  XENBUS_PROTOCOL *XenBusIo = Dev->XenBusIo;
+  UINT32 Index;
+  UINTN Page;
+  EFI_STATUS Status;
+
+  Dev->GrantPages = AllocatePages (XEN_BLOCK_FRONT_GRANT_PAGES);
+  Dev->Grants = AllocateZeroPool (XEN_BLOCK_FRONT_GRANT_PAGES * sizeof (XEN_BLOCK_FRONT_GRANT));
+  if (Dev->GrantPages == NULL || Dev->Grants == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  for (Index = 0; Index < XEN_BLOCK_FRONT_GRANT_PAGES; Index++) {
+    Page = (UINTN) Dev->GrantPages + Index * EFI_PAGE_SIZE;
+    Status = XenBusIo->GrantAccess (XenBusIo, Dev->DomainId,
+                                    Page >> EFI_PAGE_SHIFT, FALSE,
+                                    &Dev->Grants[Index].Ref);
+    if (EFI_ERROR (Status)) {
+      return EFI_OUT_OF_RESOURCES;
+    }
+    Dev->Grants[Index].Page = (VOID *) Page;
+    Dev->FreeGrants[Index] = (UINT16) Index;
+  }
+  Dev->FreeGrantCount = XEN_BLOCK_FRONT_GRANT_PAGES;
+
+  return EFI_SUCCESS;
+}
+
 /**
   Wait until until the backend has reached the ExpectedState.
 
@@ -204,6 +278,14 @@ XenPvBlockFrontInitialization (
                          FALSE,
                          &Dev->RingRef);
 
+  if (EFI_ERROR (XenPvBlockInitGrants (Dev))) {
+    //
+    // Fall back to granting the buffer of each request.
+    //
+    DEBUG ((DEBUG_WARN, "XenPvBlk: Failed to set up persistent grants\n"));
+    XenPvBlockFreeGrants (Dev);
+  }
+
 Again:
   Status = XenBusIo->XsTransactionStart (XenBusIo, &Transaction);
   if (Status != XENSTORE_STATUS_SUCCESS) {
@@ -229,6 +311,14 @@ Again:
     DEBUG ((DEBUG_ERROR, "XenPvBlk: Failed to write protocol.\n"));
     goto AbortTransaction;
   }
+  if (Dev->Grants != NULL) {
+    Status = XenBusIo->XsPrintf (XenBusIo, &Transaction, NodeName,
+                                 "feature-persistent", "%d", 1);
+    if (Status != XENSTORE_STATUS_SUCCESS) {
+      DEBUG ((DEBUG_ERROR, "XenPvBlk: Failed to write feature-persistent.\n"));
+      goto AbortTransaction;
+    }
+  }
 
   Status = XenBusIo->SetState (XenBusIo, &Transaction, XenbusStateConnected);
   if (Status != XENSTORE_STATUS_SUCCESS) {
@@ -302,8 +392,36 @@ Again:
     Dev->MediaInfo.FeatureFlushCache = FALSE;
   }
 
+  // Default value
+  Value = 0;
+  XenBusReadUint64 (XenBusIo, "feature-persistent", TRUE, &Value);
+  if (Value == 1) {
+    Dev->MediaInfo.FeaturePersistent = TRUE;
+  } else {
+    Dev->MediaInfo.FeaturePersistent = FALSE;
+  }
+
+  // Default value
+  Value = 0;
+  XenBusReadUint64 (XenBusIo, "feature-max-indirect-segments", TRUE, &Value);
+  Dev->MediaInfo.MaxIndirectSegments = (UINT32)MIN (Value, MAX_UINT32);
+
+  //
+  // Indirect requests are only built from the persistently granted pages.
+  //
+  Dev->MaxSegments = BLKIF_MAX_SEGMENTS_PER_REQUEST;
+  if (Dev->Grants != NULL &&
+      Dev->MediaInfo.MaxIndirectSegments > BLKIF_MAX_SEGMENTS_PER_REQUEST) {
+    Dev->MaxSegments = MIN (Dev->MediaInfo.MaxIndirectSegments,
+                            XEN_BLOCK_FRONT_MAX_SEGMENTS);
+  }
+
   DEBUG ((DEBUG_INFO, "XenPvBlk: New disk with %ld sectors of %d bytes\n",
           Dev->MediaInfo.Sectors, Dev->MediaInfo.SectorSize));
+  DEBUG ((DEBUG_INFO, "XenPvBlk: persistent grants %a, backend %a, %d segments per request\n",
+          Dev->Grants != NULL ? "on" : "off",
+          Dev->MediaInfo.FeaturePersistent ? "persistent" : "non-persistent",
+          Dev->MaxSegments));
 
   *DevPtr = Dev;
   return EFI_SUCCESS;
@@ -313,6 +431,7 @@ Error2:
   XenBusIo->XsRemove (XenBusIo, XST_NIL, "ring-ref");
   XenBusIo->XsRemove (XenBusIo, XST_NIL, "event-channel");
   XenBusIo->XsRemove (XenBusIo, XST_NIL, "protocol");
+  XenBusIo->XsRemove (XenBusIo, XST_NIL, "feature-persistent");
   goto Error;
 AbortTransaction:
   XenBusIo->XsTransactionEnd (XenBusIo, &Transaction, TRUE);
@@ -394,6 +513,7 @@ Close:
   XenBusIo->XsRemove (XenBusIo, XST_NIL, "ring-ref");
   XenBusIo->XsRemove (XenBusIo, XST_NIL, "event-channel");
   XenBusIo->XsRemove (XenBusIo, XST_NIL, "protocol");
+  XenBusIo->XsRemove (XenBusIo, XST_NIL, "feature-persistent");
 
   XenPvBlockFree (Dev);
 }
@@ -416,6 +536,89 @@ XenPvBlockWaitSlot (
   }
 }
 
+/**
+  Wait until enough persistently granted pages are free.
+
+  @param Dev    A XEN_BLOCK_FRONT_DEVICE instance.
+  @param Count  The number of pages needed.
+**/
+STATIC
+VOID
+XenPvBlockWaitGrants (
+  IN XEN_BLOCK_FRONT_DEVICE *Dev,
+  IN UINT32                 Count
+  )
+{
+  while (Dev->FreeGrantCount < Count) {
+    XenPvBlockAsyncIoPoll (Dev);
+  }
+}
+
+/**
+  Copy the part of the request buffer covered by one segment to or from the
+  persistently granted page backing it, at the same offset within the page.
+
+  @param IoData  The request.
+  @param Index   The segment index.
+  @param ToPage  TRUE to copy the buffer to the page, FALSE for the reverse.
+**/
+STATIC
+VOID
+XenPvBlockCopySegment (
+  IN XEN_BLOCK_FRONT_IO *IoData,
+  IN INT32              Index,
+  IN BOOLEAN            ToPage
+  )
+{
+  UINTN PageStart, Low, High;
+  UINT8 *Page;
+
+  PageStart = ((UINTN) IoData->Buffer & ~EFI_PAGE_MASK) + Index * EFI_PAGE_SIZE;
+  Low = MAX (PageStart, (UINTN) IoData->Buffer);
+  High = MIN (PageStart + EFI_PAGE_SIZE, (UINTN) IoData->Buffer + IoData->Size);
+  Page = (UINT8 *) IoData->Dev->Grants[IoData->GrantPage[Index]].Page +
+         (Low - PageStart);
+
+  if (ToPage) {
+    CopyMem (Page, (VOID *) Low, High - Low);
+  } else {
+    CopyMem ((VOID *) Low, Page, High - Low);
+  }
+}
+
+/**
+  Release the grants of a completed read or write request. With persistent
+  grants the data read is copied back and the pages return to the pool.
+
+  @param IoData  The completed request.
+**/
+STATIC
+VOID
+XenPvBlockEndIoGrants (
+  IN XEN_BLOCK_FRONT_IO *IoData
+  )
+{
+  XEN_BLOCK_FRONT_DEVICE *Dev = IoData->Dev;
+  INT32 Index;
+
+  if (Dev->Grants == NULL) {
+    for (Index = 0; Index < IoData->NumRef; Index++) {
+      Dev->XenBusIo->GrantEndAccess (Dev->XenBusIo, IoData->GrantRef[Index]);
+    }
+    return;
+  }
+
+  for (Index = 0; Index < IoData->NumRef; Index++) {
+    if (!IoData->IsWrite) {
+      XenPvBlockCopySegment (IoData, Index, FALSE);
+    }
+    Dev->FreeGrants[Dev->FreeGrantCount++] = IoData->GrantPage[Index];
+  }
+  if (IoData->Indirect) {
+    Dev->FreeGrants[Dev->FreeGrantCount++] = IoData->IndirectPage;
+  }
+}
+
 VOID
 XenPvBlockAsyncIo (
   IN OUT XEN_BLOCK_FRONT_IO *IoData,
@@ -425,6 +628,8 @@ XenPvBlockAsyncIo (
   XEN_BLOCK_FRONT_DEVICE *Dev = IoData->Dev;
   XENBUS_PROTOCOL *XenBusIo = Dev->XenBusIo;
   blkif_request_t *Request;
+  blkif_request_indirect_t *IndirectRequest;
+  struct blkif_request_segment *Segments;
   RING_IDX RingIndex;
   BOOLEAN Notify;
   INT32 NumSegments, Index;
@@ -440,32 +645,63 @@ XenPvBlockAsyncIo (
   Start = (UINTN) IoData->Buffer & ~EFI_PAGE_MASK;
   End = ((UINTN) IoData->Buffer + IoData->Size + EFI_PAGE_SIZE - 1) & ~EFI_PAGE_MASK;
   IoData->NumRef = NumSegments = (INT32)((End - Start) / EFI_PAGE_SIZE);
+  IoData->IsWrite = IsWrite;
+  IoData->Indirect = (BOOLEAN)(NumSegments > BLKIF_MAX_SEGMENTS_PER_REQUEST);
 
-  ASSERT (NumSegments <= BLKIF_MAX_SEGMENTS_PER_REQUEST);
+  ASSERT (NumSegments <= (INT32) Dev->MaxSegments);
 
   XenPvBlockWaitSlot (Dev);
+  if (Dev->Grants != NULL) {
+    XenPvBlockWaitGrants (Dev, NumSegments + (IoData->Indirect ? 1 : 0));
+  }
   RingIndex = Dev->Ring.req_prod_pvt;
   Request = RING_GET_REQUEST (&Dev->Ring, RingIndex);
 
-  Request->operation = IsWrite ? BLKIF_OP_WRITE : BLKIF_OP_READ;
-  Request->nr_segments = (UINT8)NumSegments;
-  Request->handle = Dev->DeviceId;
-  Request->id = (UINTN) IoData;
-  Request->sector_number = IoData->Sector;
+  if (IoData->Indirect) {
+    //
+    // The segments go in a persistently granted page referenced by the
+    // request, which is large enough for XEN_BLOCK_FRONT_MAX_SEGMENTS.
+    //
+    IoData->IndirectPage = Dev->FreeGrants[--Dev->FreeGrantCount];
+    IndirectRequest = (blkif_request_indirect_t *) Request;
+    IndirectRequest->operation = BLKIF_OP_INDIRECT;
+    IndirectRequest->indirect_op = IsWrite ? BLKIF_OP_WRITE : BLKIF_OP_READ;
+    IndirectRequest->nr_segments = (UINT16)NumSegments;
+    IndirectRequest->handle = Dev->DeviceId;
+    IndirectRequest->id = (UINTN) IoData;
+    IndirectRequest->sector_number = IoData->Sector;
+    IndirectRequest->indirect_grefs[0] = Dev->Grants[IoData->IndirectPage].Ref;
+    Segments = Dev->Grants[IoData->IndirectPage].Page;
+  } else {
+    Request->operation = IsWrite ? BLKIF_OP_WRITE : BLKIF_OP_READ;
+    Request->nr_segments = (UINT8)NumSegments;
+    Request->handle = Dev->DeviceId;
+    Request->id = (UINTN) IoData;
+    Request->sector_number = IoData->Sector;
+    Segments = Request->seg;
+  }
 
   for (Index = 0; Index < NumSegments; Index++) {
-    Request->seg[Index].first_sect = 0;
-    Request->seg[Index].last_sect = EFI_PAGE_SIZE / 512 - 1;
+    Segments[Index].first_sect = 0;
+    Segments[Index].last_sect = EFI_PAGE_SIZE / 512 - 1;
   }
-  Request->seg[0].first_sect = (UINT8)(((UINTN) IoData->Buffer & EFI_PAGE_MASK) / 512);
-  Request->seg[NumSegments - 1].last_sect =
+  Segments[0].first_sect = (UINT8)(((UINTN) IoData->Buffer & EFI_PAGE_MASK) / 512);
+  Segments[NumSegments - 1].last_sect =
       (UINT8)((((UINTN) IoData->Buffer + IoData->Size - 1) & EFI_PAGE_MASK) / 512);
   for (Index = 0; Index < NumSegments; Index++) {
-    UINTN Data = Start + Index * EFI_PAGE_SIZE;
-    XenBusIo->GrantAccess (XenBusIo, Dev->DomainId,
-                           Data >> EFI_PAGE_SHIFT, IsWrite,
-                           &Request->seg[Index].gref);
-    IoData->GrantRef[Index] = Request->seg[Index].gref;
+    if (Dev->Grants != NULL) {
+      IoData->GrantPage[Index] = Dev->FreeGrants[--Dev->FreeGrantCount];
+      Segments[Index].gref = Dev->Grants[IoData->GrantPage[Index]].Ref;
+      if (IsWrite) {
+        XenPvBlockCopySegment (IoData, Index, TRUE);
+      }
+    } else {
+      UINTN Data = Start + Index * EFI_PAGE_SIZE;
+      XenBusIo->GrantAccess (XenBusIo, Dev->DomainId,
+                             Data >> EFI_PAGE_SHIFT, IsWrite,
+                             &Segments[Index].gref);
+      IoData->GrantRef[Index] = Segments[Index].gref;
+    }
   }
 
   Dev->Ring.req_prod_pvt = RingIndex + 1;
@@ -590,26 +826,20 @@ XenPvBlockAsyncIoPoll (
       switch (Response->operation) {
       case BLKIF_OP_READ:
       case BLKIF_OP_WRITE:
-        {
-          INT32 Index;
-
-          if (Status != BLKIF_RSP_OKAY) {
-            DEBUG ((DEBUG_ERROR,
-                    "XenPvBlk: "
-                    "%a error %d on %a at sector %Lx, num bytes %Lx\n",
-                    Response->operation == BLKIF_OP_READ ? "read" : "write",
-                    Status, IoData->Dev->NodeName,
-                    (UINT64)IoData->Sector,
-                    (UINT64)IoData->Size));
-          }
-
-          for (Index = 0; Index < IoData->NumRef; Index++) {
-            Dev->XenBusIo->GrantEndAccess (Dev->XenBusIo, IoData->GrantRef[Index]);
-          }
-
-          break;
+      case BLKIF_OP_INDIRECT:
+        if (Status != BLKIF_RSP_OKAY) {
+          DEBUG ((DEBUG_ERROR,
+                  "XenPvBlk: "
+                  "%a error %d on %a at sector %Lx, num bytes %Lx\n",
+                  IoData->IsWrite ? "write" : "read",
+                  Status, IoData->Dev->NodeName,
+                  (UINT64)IoData->Sector,
+                  (UINT64)IoData->Size));
         }
 
+        XenPvBlockEndIoGrants (IoData);
+        break;
+
       case BLKIF_OP_WRITE_BARRIER:
         if (Status != BLKIF_RSP_OKAY) {
           DEBUG ((DEBUG_ERROR, "XenPvBlk: write barrier error %d\n", Status));
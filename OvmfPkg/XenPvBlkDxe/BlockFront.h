@@ -14,15 +14,33 @@
 typedef struct _XEN_BLOCK_FRONT_DEVICE XEN_BLOCK_FRONT_DEVICE;
 typedef struct _XEN_BLOCK_FRONT_IO XEN_BLOCK_FRONT_IO;
 
+//
+// Maximum number of segments of a single request when the backend accepts
+// indirect segments, all of them fit in one indirect page.
+//
+#define XEN_BLOCK_FRONT_MAX_SEGMENTS  256
+#define XEN_BLOCK_FRONT_SEGMENTS_PER_INDIRECT_PAGE \
+  (EFI_PAGE_SIZE / sizeof (struct blkif_request_segment))
+
+//
+// Pages granted to the backend once and reused as bounce buffers for every
+// request: the data segments of one request plus its indirect page.
+//
+#define XEN_BLOCK_FRONT_GRANT_PAGES   (XEN_BLOCK_FRONT_MAX_SEGMENTS + 1)
+
 struct _XEN_BLOCK_FRONT_IO
 {
   XEN_BLOCK_FRONT_DEVICE  *Dev;
   UINT8                   *Buffer;
   UINTN                   Size;
   UINTN                   Sector; ///< 512 bytes sector.
+  BOOLEAN                 IsWrite;
 
-  grant_ref_t             GrantRef[BLKIF_MAX_SEGMENTS_PER_REQUEST];
+  grant_ref_t             GrantRef[XEN_BLOCK_FRONT_MAX_SEGMENTS];
+  UINT16                  GrantPage[XEN_BLOCK_FRONT_MAX_SEGMENTS];
   INT32                   NumRef;
+  BOOLEAN                 Indirect;
+  UINT16                  IndirectPage;
 
   EFI_STATUS              Status;
 };
@@ -36,8 +54,15 @@ typedef struct
   BOOLEAN   CdRom;
   BOOLEAN   FeatureBarrier;
   BOOLEAN   FeatureFlushCache;
+  BOOLEAN   FeaturePersistent;
+  UINT32    MaxIndirectSegments;
 } XEN_BLOCK_FRONT_MEDIA_INFO;
 
+typedef struct {
+  VOID          *Page;
+  grant_ref_t   Ref;
+} XEN_BLOCK_FRONT_GRANT;
+
 #define XEN_BLOCK_FRONT_SIGNATURE SIGNATURE_32 ('X', 'p', 'v', 'B')
 struct _XEN_BLOCK_FRONT_DEVICE {
   UINT32                      Signature;
@@ -54,6 +79,16 @@ struct _XEN_BLOCK_FRONT_DEVICE {
 
   VOID                        *StateWatchToken;
 
+  //
+  // Persistently granted bounce pages, NULL if they could not be set up and
+  // every request grants its own buffer instead.
+  //
+  XEN_BLOCK_FRONT_GRANT       *Grants;
+  VOID                        *GrantPages;
+  UINT16                      FreeGrants[XEN_BLOCK_FRONT_GRANT_PAGES];
+  UINT32                      FreeGrantCount;
+  UINT32                      MaxSegments;
+
   XENBUS_PROTOCOL             *XenBusIo;
 };
 
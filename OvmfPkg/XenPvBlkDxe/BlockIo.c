@@ -136,10 +136,10 @@ XenPvBlkDxeBlockIoReadWriteBlocks (
 
   while (BufferSize > 0) {
     if (((UINTN)Buffer & EFI_PAGE_MASK) == 0) {
-      IoData.Size = MIN (BLKIF_MAX_SEGMENTS_PER_REQUEST * EFI_PAGE_SIZE,
+      IoData.Size = MIN (IoData.Dev->MaxSegments * EFI_PAGE_SIZE,
                          BufferSize);
     } else {
-      IoData.Size = MIN ((BLKIF_MAX_SEGMENTS_PER_REQUEST - 1) * EFI_PAGE_SIZE,
+      IoData.Size = MIN ((IoData.Dev->MaxSegments - 1) * EFI_PAGE_SIZE,
                          BufferSize);
     }
 
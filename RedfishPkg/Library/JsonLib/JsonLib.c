@@ -600,17 +600,15 @@ JsonObjectGetKeys (
     return NULL;
   }
 
-  Index = 0;
-  json_object_foreach(JsonObj, Key, Value) {
-    Index++;
-  }
-  if (Index == 0) {
-    *KeyCount = 0;
+  //
+  // The object keeps track of its size, no need to walk it twice.
+  //
+  *KeyCount = json_object_size ((json_t *) JsonObj);
+  if (*KeyCount == 0) {
     return NULL;
   }
 
-  *KeyCount = Index;
-  KeyArray = (CONST CHAR8 **) AllocateZeroPool (*KeyCount * sizeof (CHAR8 *));
+  KeyArray = (CONST CHAR8 **) AllocatePool (*KeyCount * sizeof (CHAR8 *));
   if (KeyArray == NULL) {
     return NULL;
   }
@@ -324,10 +324,11 @@ ReSendRequest:;
           ResponseMessage->BodyLength != 0) {
         IsGetChunkedTransfer = TRUE;
         //
-        // Copy data to Message body.
+        // Copy data to Message body. The chunks fill the whole body, so it
+        // does not need to be zeroed first.
         //
         CopyChunkData = TRUE;
-        ResponseMessage->Body = AllocateZeroPool (ResponseMessage->BodyLength);
+        ResponseMessage->Body = AllocatePool (ResponseMessage->BodyLength);
         if (ResponseMessage->Body == NULL) {
           Status = EFI_OUT_OF_RESOURCES;
           CopyChunkData = FALSE;
@@ -356,7 +357,11 @@ ReSendRequest:;
     ResponseData->HeaderCount = 0;
     ResponseData->Headers = NULL;
 
-    ResponseMessage->Body = AllocateZeroPool (ResponseMessage->BodyLength);
+    //
+    // The receive loop below fills the whole body, so it does not need to be
+    // zeroed first. Redfish payloads can be hundreds of KB.
+    //
+    ResponseMessage->Body = AllocatePool (ResponseMessage->BodyLength);
     if (ResponseMessage->Body == NULL) {
       Status = EFI_OUT_OF_RESOURCES;
       goto ON_EXIT;
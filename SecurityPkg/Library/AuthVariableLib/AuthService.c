@@ -36,6 +36,13 @@ CONST UINT8 mRsaE[] = { 0x01, 0x00, 0x01 };
 
 CONST UINT8 mSha256OidValue[] = { 0x60, 0x86, 0x48, 0x01, 0x65, 0x03, 0x04, 0x02, 0x01 };
 
+//
+// SHA256 digest of the KEK certificate that verified the last update signed with KEK.
+// Consecutive db/dbx/dbt updates are usually signed by the same KEK, so it is tried first.
+//
+UINT8   mLastKekCertDigest[SHA256_DIGEST_SIZE];
+BOOLEAN mLastKekCertDigestValid = FALSE;
+
 //
 // Requirement for different signature type which have been defined in UEFI spec.
 // These data are used to perform SignatureList format check while setting PK/KEK variable.
@@ -1034,6 +1041,60 @@ FilterSignatureList (
   return EFI_SUCCESS;
 }
 
+/**
+  Find the certificate in the KEK database which verified the last update signed with KEK.
+
+  @param[in]  KekData             Pointer to the KEK database.
+  @param[in]  KekDataSize         Size of the KEK database.
+  @param[out] TrustedCert         Pointer to the certificate data.
+  @param[out] TrustedCertSize     Size of the certificate data.
+
+  @retval TRUE                    The certificate is found.
+  @retval FALSE                   The certificate is not found.
+
+**/
+BOOLEAN
+FindLastKekCert (
+  IN  UINT8                 *KekData,
+  IN  UINTN                 KekDataSize,
+  OUT UINT8                 **TrustedCert,
+  OUT UINTN                 *TrustedCertSize
+  )
+{
+  EFI_SIGNATURE_LIST        *CertList;
+  EFI_SIGNATURE_DATA        *Cert;
+  UINTN                     Index;
+  UINTN                     CertCount;
+  UINTN                     CertSize;
+  UINT8                     Digest[SHA256_DIGEST_SIZE];
+
+  if (!mLastKekCertDigestValid) {
+    return FALSE;
+  }
+
+  CertList = (EFI_SIGNATURE_LIST *) KekData;
+  while ((KekDataSize > 0) && (KekDataSize >= CertList->SignatureListSize)) {
+    if (CompareGuid (&CertList->SignatureType, &gEfiCertX509Guid)) {
+      Cert      = (EFI_SIGNATURE_DATA *) ((UINT8 *) CertList + sizeof (EFI_SIGNATURE_LIST) + CertList->SignatureHeaderSize);
+      CertCount = (CertList->SignatureListSize - sizeof (EFI_SIGNATURE_LIST) - CertList->SignatureHeaderSize) / CertList->SignatureSize;
+      CertSize  = CertList->SignatureSize - (sizeof (EFI_SIGNATURE_DATA) - 1);
+      for (Index = 0; Index < CertCount; Index++) {
+        if (Sha256HashAll (Cert->SignatureData, CertSize, Digest) &&
+            (CompareMem (Digest, mLastKekCertDigest, SHA256_DIGEST_SIZE) == 0)) {
+          *TrustedCert     = Cert->SignatureData;
+          *TrustedCertSize = CertSize;
+          return TRUE;
+        }
+        Cert = (EFI_SIGNATURE_DATA *) ((UINT8 *) Cert + CertList->SignatureSize);
+      }
+    }
+    KekDataSize -= CertList->SignatureListSize;
+    CertList = (EFI_SIGNATURE_LIST *) ((UINT8 *) CertList + CertList->SignatureListSize);
+  }
+
+  return FALSE;
+}
+
 /**
   Compare two EFI_TIME data.
 
@@ -1828,6 +1889,8 @@ VerifyTimeBasedPayload (
   UINTN                            TopLevelCertSize;
   UINT8                            *TrustedCert;
   UINTN                            TrustedCertSize;
+  UINT8                            *LastKekCert;
+  UINTN                            LastKekCertSize;
   UINT8                            *SignerCerts;
   UINTN                            CertStackSize;
   UINT8                            *CertsInCertDb;
@@ -2040,6 +2103,25 @@ VerifyTimeBasedPayload (
       return Status;
     }
 
+    //
+    // Every Pkcs7Verify() call parses the SignedData and hashes the whole payload again,
+    // so first try the KEK certificate which verified the last update.
+    //
+    LastKekCert = NULL;
+    if (FindLastKekCert (Data, DataSize, &LastKekCert, &LastKekCertSize)) {
+      VerifyStatus = Pkcs7Verify (
+                       SigData,
+                       SigDataSize,
+                       LastKekCert,
+                       LastKekCertSize,
+                       NewData,
+                       NewDataSize
+                       );
+      if (VerifyStatus) {
+        goto Exit;
+      }
+    }
+
     //
     // Ready to verify Pkcs7 SignedData. Go through KEK Signature Database to find out X.509 CertList.
     //
@@ -2055,6 +2137,13 @@ VerifyTimeBasedPayload (
           //
           TrustedCert      = Cert->SignatureData;
           TrustedCertSize  = CertList->SignatureSize - (sizeof (EFI_SIGNATURE_DATA) - 1);
+          if (TrustedCert == LastKekCert) {
+            //
+            // Already tried.
+            //
+            Cert = (EFI_SIGNATURE_DATA *) ((UINT8 *) Cert + CertList->SignatureSize);
+            continue;
+          }
 
           //
           // Verify Pkcs7 SignedData via Pkcs7Verify library.
@@ -2068,6 +2157,7 @@ VerifyTimeBasedPayload (
                            NewDataSize
                            );
           if (VerifyStatus) {
+            mLastKekCertDigestValid = Sha256HashAll (TrustedCert, TrustedCertSize, mLastKekCertDigest);
             goto Exit;
           }
           Cert = (EFI_SIGNATURE_DATA *) ((UINT8 *) Cert + CertList->SignatureSize);
@@ -984,6 +984,16 @@ IsSignatureFoundInDatabase (
   UINTN               Index;
   UINTN               CertCount;
 
+  //
+  // SHA-256 image hashes in dbx are looked up in the sorted set when it is available.
+  //
+  if ((StrCmp (VariableName, EFI_IMAGE_SECURITY_DATABASE1) == 0) &&
+      CompareGuid (CertType, &gEfiCertSha256Guid) &&
+      (SignatureSize == SHA256_DIGEST_SIZE) &&
+      IsHashFoundInDbxSet (Signature, IsFound)) {
+    return EFI_SUCCESS;
+  }
+
   //
   // Read signature database variable.
   //
@@ -1737,6 +1747,11 @@ DxeImageVerificationHandler (
   }
   FreePool (SecureBoot);
 
+  //
+  // Drop the cached verification results if db, dbx or dbt has changed.
+  //
+  RefreshImageVerificationCache ();
+
   //
   // Read the Dos header.
   //
@@ -1852,6 +1867,14 @@ DxeImageVerificationHandler (
     goto Failed;
   }
 
+  //
+  // Skip the signature verification if this image already passed it against the current databases.
+  //
+  if (IsImageInVerificationCache (FileBuffer, FileSize)) {
+    DEBUG ((DEBUG_INFO, "DxeImageVerificationLib: Image is found in the verification cache.\n"));
+    return EFI_SUCCESS;
+  }
+
   //
   // Verify the signature of the image, multiple signatures are allowed as per PE/COFF Section 4.7
   // "Attribute Certificate Table".
@@ -1970,6 +1993,7 @@ DxeImageVerificationHandler (
   }
 
   if (IsVerified) {
+    AddImageToVerificationCache ();
     return EFI_SUCCESS;
   }
   if (Action == EFI_IMAGE_EXECUTION_AUTH_SIG_FAILED || Action == EFI_IMAGE_EXECUTION_AUTH_SIG_FOUND) {
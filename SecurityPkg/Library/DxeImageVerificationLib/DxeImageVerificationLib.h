@@ -198,4 +198,64 @@ typedef struct {
   HASH_FINAL               HashFinal;
 } HASH_TABLE;
 
+/**
+  Make sure the cached data matches the current db, dbx and dbt.
+
+  The databases are read and hashed. If the digest differs from the one the
+  cache was built from, all cached verification results are dropped and the
+  sorted dbx hash set is rebuilt.
+
+**/
+VOID
+RefreshImageVerificationCache (
+  VOID
+  );
+
+/**
+  Check whether a SHA-256 image hash is listed in dbx, using the sorted set
+  built by RefreshImageVerificationCache().
+
+  @param[in]  Digest      The SHA-256 image hash.
+  @param[out] IsFound     Search result. Only valid if TRUE returned.
+
+  @retval TRUE            The set is valid and has been searched.
+  @retval FALSE           The set is not available, dbx must be searched directly.
+
+**/
+BOOLEAN
+IsHashFoundInDbxSet (
+  IN  UINT8    *Digest,
+  OUT BOOLEAN  *IsFound
+  );
+
+/**
+  Check whether the same image already passed signature verification against
+  the current databases.
+
+  On a miss, the image is remembered so that AddImageToVerificationCache()
+  can record it once its verification succeeds.
+
+  @param[in]  FileBuffer  The image buffer.
+  @param[in]  FileSize    The size of FileBuffer.
+
+  @retval TRUE            The image has been verified before.
+  @retval FALSE           The image must be verified.
+
+**/
+BOOLEAN
+IsImageInVerificationCache (
+  IN VOID   *FileBuffer,
+  IN UINTN  FileSize
+  );
+
+/**
+  Record the image last looked up by IsImageInVerificationCache() as verified.
+  The oldest entry is replaced when the cache is full.
+
+**/
+VOID
+AddImageToVerificationCache (
+  VOID
+  );
+
 #endif
@@ -0,0 +1,373 @@
+/** @file
+  Cache of verification results for secure boot image verification.
+
+  Caution: This file requires additional review when modified.
+  This library will have external input - PE/COFF image and signature databases.
+  This external input must be validated carefully to avoid security issue like
+  buffer overflow, integer overflow.
+
+  Verifying the Authenticode signature of an image is a deterministic function
+  of the image content and of the db, dbx and dbt databases. The results are
+  only cached in memory for the current boot, and they are dropped as soon as
+  any of the three databases changes.
+
+  RefreshImageVerificationCache() will parse dbx, it validates the signature
+  list sizes before use.
+
+Copyright (c) 2021, EDK II contributors. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "DxeImageVerificationLib.h"
+
+typedef struct {
+  UINT8   Digest[SHA256_DIGEST_SIZE];
+  UINTN   ImageSize;
+} VERIFIED_IMAGE_ENTRY;
+
+//
+// SHA-256 digest of db, dbx and dbt that the cached data was derived from.
+//
+BOOLEAN               mSecurityDatabaseDigestValid = FALSE;
+UINT8                 mSecurityDatabaseDigest[SHA256_DIGEST_SIZE];
+
+//
+// Images that passed signature verification against the databases above.
+//
+VERIFIED_IMAGE_ENTRY  *mVerifiedImageCache     = NULL;
+UINTN                 mVerifiedImageCount      = 0;
+UINTN                 mVerifiedImageNext       = 0;
+VERIFIED_IMAGE_ENTRY  mPendingImage;
+BOOLEAN               mPendingImageValid       = FALSE;
+
+//
+// Sorted SHA-256 image hashes of dbx.
+//
+UINT8                 *mDbxSha256Set           = NULL;
+UINTN                 mDbxSha256Count          = 0;
+BOOLEAN               mDbxSha256SetValid       = FALSE;
+
+CHAR16                *mSecurityDatabaseName[] = {
+  EFI_IMAGE_SECURITY_DATABASE,
+  EFI_IMAGE_SECURITY_DATABASE1,
+  EFI_IMAGE_SECURITY_DATABASE2
+};
+
+/**
+  Drop all the cached data.
+
+**/
+VOID
+FlushImageVerificationCache (
+  VOID
+  )
+{
+  mSecurityDatabaseDigestValid = FALSE;
+  mVerifiedImageCount          = 0;
+  mVerifiedImageNext           = 0;
+  mPendingImageValid           = FALSE;
+  mDbxSha256SetValid           = FALSE;
+  mDbxSha256Count              = 0;
+  if (mDbxSha256Set != NULL) {
+    FreePool (mDbxSha256Set);
+    mDbxSha256Set = NULL;
+  }
+}
+
+/**
+  Build the sorted set of SHA-256 image hashes listed in dbx.
+
+  @param[in]  Data      The content of dbx, or NULL if dbx does not exist.
+  @param[in]  DataSize  The size of Data.
+
+  @retval TRUE   The set is built.
+  @retval FALSE  dbx is malformed or memory allocation failed.
+
+**/
+BOOLEAN
+BuildDbxSha256Set (
+  IN UINT8  *Data,
+  IN UINTN  DataSize
+  )
+{
+  EFI_SIGNATURE_LIST  *CertList;
+  EFI_SIGNATURE_DATA  *Cert;
+  UINTN               Size;
+  UINTN               CertCount;
+  UINTN               Count;
+  UINTN               Index;
+  UINTN               Slot;
+  UINT8               *Digest;
+
+  //
+  // First pass validates the lists and counts the SHA-256 entries.
+  //
+  Count    = 0;
+  Size     = DataSize;
+  CertList = (EFI_SIGNATURE_LIST *) Data;
+  while (Size > 0) {
+    if ((Size < sizeof (EFI_SIGNATURE_LIST)) ||
+        (CertList->SignatureListSize < sizeof (EFI_SIGNATURE_LIST)) ||
+        (CertList->SignatureListSize > Size) ||
+        (CertList->SignatureSize == 0) ||
+        (CertList->SignatureHeaderSize > CertList->SignatureListSize - sizeof (EFI_SIGNATURE_LIST))) {
+      return FALSE;
+    }
+    if (CompareGuid (&CertList->SignatureType, &gEfiCertSha256Guid) &&
+        (CertList->SignatureSize == sizeof (EFI_SIGNATURE_DATA) - 1 + SHA256_DIGEST_SIZE)) {
+      Count += (CertList->SignatureListSize - sizeof (EFI_SIGNATURE_LIST) - CertList->SignatureHeaderSize) / CertList->SignatureSize;
+    }
+    Size    -= CertList->SignatureListSize;
+    CertList = (EFI_SIGNATURE_LIST *) ((UINT8 *) CertList + CertList->SignatureListSize);
+  }
+
+  if (Count != 0) {
+    mDbxSha256Set = AllocatePool (Count * SHA256_DIGEST_SIZE);
+    if (mDbxSha256Set == NULL) {
+      return FALSE;
+    }
+  }
+
+  //
+  // Second pass inserts the hashes in ascending order. dbx is only
+  // parsed again when it changes, so an insertion sort is good enough.
+  //
+  mDbxSha256Count = 0;
+  Size            = DataSize;
+  CertList        = (EFI_SIGNATURE_LIST *) Data;
+  while (Size > 0) {
+    if (CompareGuid (&CertList->SignatureType, &gEfiCertSha256Guid) &&
+        (CertList->SignatureSize == sizeof (EFI_SIGNATURE_DATA) - 1 + SHA256_DIGEST_SIZE)) {
+      CertCount = (CertList->SignatureListSize - sizeof (EFI_SIGNATURE_LIST) - CertList->SignatureHeaderSize) / CertList->SignatureSize;
+      Cert      = (EFI_SIGNATURE_DATA *) ((UINT8 *) CertList + sizeof (EFI_SIGNATURE_LIST) + CertList->SignatureHeaderSize);
+      for (Index = 0; Index < CertCount; Index++) {
+        for (Slot = mDbxSha256Count; Slot > 0; Slot--) {
+          Digest = mDbxSha256Set + (Slot - 1) * SHA256_DIGEST_SIZE;
+          if (CompareMem (Digest, Cert->SignatureData, SHA256_DIGEST_SIZE) <= 0) {
+            break;
+          }
+          CopyMem (Digest + SHA256_DIGEST_SIZE, Digest, SHA256_DIGEST_SIZE);
+        }
+        CopyMem (mDbxSha256Set + Slot * SHA256_DIGEST_SIZE, Cert->SignatureData, SHA256_DIGEST_SIZE);
+        mDbxSha256Count++;
+        Cert = (EFI_SIGNATURE_DATA *) ((UINT8 *) Cert + CertList->SignatureSize);
+      }
+    }
+    Size    -= CertList->SignatureListSize;
+    CertList = (EFI_SIGNATURE_LIST *) ((UINT8 *) CertList + CertList->SignatureListSize);
+  }
+
+  return TRUE;
+}
+
+/**
+  Make sure the cached data matches the current db, dbx and dbt.
+
+  The databases are read and hashed. If the digest differs from the one the
+  cache was built from, all cached verification results are dropped and the
+  sorted dbx hash set is rebuilt.
+
+**/
+VOID
+RefreshImageVerificationCache (
+  VOID
+  )
+{
+  EFI_STATUS  Status;
+  VOID        *HashCtx;
+  UINT8       *Data[ARRAY_SIZE (mSecurityDatabaseName)];
+  UINTN       DataSize[ARRAY_SIZE (mSecurityDatabaseName)];
+  UINT64      Size;
+  UINT8       Digest[SHA256_DIGEST_SIZE];
+  UINTN       Index;
+  BOOLEAN     Success;
+
+  mPendingImageValid = FALSE;
+
+  ZeroMem (Data, sizeof (Data));
+  ZeroMem (DataSize, sizeof (DataSize));
+  Success = FALSE;
+  HashCtx = AllocatePool (Sha256GetContextSize ());
+  if ((HashCtx == NULL) || !Sha256Init (HashCtx)) {
+    goto Done;
+  }
+
+  for (Index = 0; Index < ARRAY_SIZE (mSecurityDatabaseName); Index++) {
+    Status = GetVariable2 (
+               mSecurityDatabaseName[Index],
+               &gEfiImageSecurityDatabaseGuid,
+               (VOID **) &Data[Index],
+               &DataSize[Index]
+               );
+    if (Status == EFI_NOT_FOUND) {
+      Data[Index]     = NULL;
+      DataSize[Index] = 0;
+    } else if (EFI_ERROR (Status)) {
+      goto Done;
+    }
+
+    //
+    // Hash the size in front of each database so that moving data from one
+    // database to the next one changes the digest.
+    //
+    Size = DataSize[Index];
+    if (!Sha256Update (HashCtx, &Size, sizeof (Size)) ||
+        ((Data[Index] != NULL) && !Sha256Update (HashCtx, Data[Index], DataSize[Index]))) {
+      goto Done;
+    }
+  }
+
+  if (!Sha256Final (HashCtx, Digest)) {
+    goto Done;
+  }
+
+  if (mSecurityDatabaseDigestValid &&
+      (CompareMem (Digest, mSecurityDatabaseDigest, SHA256_DIGEST_SIZE) == 0)) {
+    Success = TRUE;
+    goto Done;
+  }
+
+  FlushImageVerificationCache ();
+  //
+  // mSecurityDatabaseName[1] is dbx.
+  //
+  mDbxSha256SetValid = BuildDbxSha256Set (Data[1], DataSize[1]);
+  CopyMem (mSecurityDatabaseDigest, Digest, SHA256_DIGEST_SIZE);
+  mSecurityDatabaseDigestValid = TRUE;
+  Success = TRUE;
+
+Done:
+  if (!Success) {
+    FlushImageVerificationCache ();
+  }
+  for (Index = 0; Index < ARRAY_SIZE (mSecurityDatabaseName); Index++) {
+    if (Data[Index] != NULL) {
+      FreePool (Data[Index]);
+    }
+  }
+  if (HashCtx != NULL) {
+    FreePool (HashCtx);
+  }
+}
+
+/**
+  Check whether a SHA-256 image hash is listed in dbx, using the sorted set
+  built by RefreshImageVerificationCache().
+
+  @param[in]  Digest      The SHA-256 image hash.
+  @param[out] IsFound     Search result. Only valid if TRUE returned.
+
+  @retval TRUE            The set is valid and has been searched.
+  @retval FALSE           The set is not available, dbx must be searched directly.
+
+**/
+BOOLEAN
+IsHashFoundInDbxSet (
+  IN  UINT8    *Digest,
+  OUT BOOLEAN  *IsFound
+  )
+{
+  UINTN  Low;
+  UINTN  High;
+  UINTN  Middle;
+  INTN   Result;
+
+  if (!mDbxSha256SetValid) {
+    return FALSE;
+  }
+
+  *IsFound = FALSE;
+  Low      = 0;
+  High     = mDbxSha256Count;
+  while (Low < High) {
+    Middle = Low + (High - Low) / 2;
+    Result = CompareMem (mDbxSha256Set + Middle * SHA256_DIGEST_SIZE, Digest, SHA256_DIGEST_SIZE);
+    if (Result == 0) {
+      *IsFound = TRUE;
+      break;
+    }
+    if (Result < 0) {
+      Low = Middle + 1;
+    } else {
+      High = Middle;
+    }
+  }
+
+  return TRUE;
+}
+
+/**
+  Check whether the same image already passed signature verification against
+  the current databases.
+
+  On a miss, the image is remembered so that AddImageToVerificationCache()
+  can record it once its verification succeeds.
+
+  @param[in]  FileBuffer  The image buffer.
+  @param[in]  FileSize    The size of FileBuffer.
+
+  @retval TRUE            The image has been verified before.
+  @retval FALSE           The image must be verified.
+
+**/
+BOOLEAN
+IsImageInVerificationCache (
+  IN VOID   *FileBuffer,
+  IN UINTN  FileSize
+  )
+{
+  UINTN  Index;
+
+  mPendingImageValid = FALSE;
+  if ((PcdGet32 (PcdImageVerificationCacheSize) == 0) || !mSecurityDatabaseDigestValid) {
+    return FALSE;
+  }
+
+  if (!Sha256HashAll (FileBuffer, FileSize, mPendingImage.Digest)) {
+    return FALSE;
+  }
+  mPendingImage.ImageSize = FileSize;
+
+  for (Index = 0; Index < mVerifiedImageCount; Index++) {
+    if ((mVerifiedImageCache[Index].ImageSize == FileSize) &&
+        (CompareMem (mVerifiedImageCache[Index].Digest, mPendingImage.Digest, SHA256_DIGEST_SIZE) == 0)) {
+      return TRUE;
+    }
+  }
+
+  mPendingImageValid = TRUE;
+  return FALSE;
+}
+
+/**
+  Record the image last looked up by IsImageInVerificationCache() as verified.
+  The oldest entry is replaced when the cache is full.
+
+**/
+VOID
+AddImageToVerificationCache (
+  VOID
+  )
+{
+  UINTN  CacheSize;
+
+  if (!mPendingImageValid) {
+    return;
+  }
+  mPendingImageValid = FALSE;
+
+  CacheSize = PcdGet32 (PcdImageVerificationCacheSize);
+  if (mVerifiedImageCache == NULL) {
+    mVerifiedImageCache = AllocateZeroPool (CacheSize * sizeof (VERIFIED_IMAGE_ENTRY));
+    if (mVerifiedImageCache == NULL) {
+      return;
+    }
+  }
+
+  CopyMem (&mVerifiedImageCache[mVerifiedImageNext], &mPendingImage, sizeof (VERIFIED_IMAGE_ENTRY));
+  mVerifiedImageNext = (mVerifiedImageNext + 1) % CacheSize;
+  if (mVerifiedImageCount < CacheSize) {
+    mVerifiedImageCount++;
+  }
+}
@@ -2,6 +2,8 @@
   This library is BaseCrypto router. It will redirect hash request to each individual
   hash handler registered, such as SHA1, SHA256.
   Platform can use PcdTpm2HashMask to mask some hash engines.
+  Large updates are hashed by the active engines in parallel on the
+  application processors when the MP services are available.
 
 Copyright (c) 2013 - 2018, Intel Corporation. All rights reserved. <BR>
 SPDX-License-Identifier: BSD-2-Clause-Patent
@@ -16,15 +18,43 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Library/MemoryAllocationLib.h>
 #include <Library/PcdLib.h>
 #include <Library/HashLib.h>
+#include <Library/SynchronizationLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Protocol/MpService.h>
+#include <Protocol/SmmBase2.h>
+#include <Guid/EventGroup.h>
 
 #include "HashLibBaseCryptoRouterCommon.h"
 
+//
+// HashUpdate() calls at least this large run the registered hash engines
+// on the application processors in parallel, one engine per processor.
+//
+#define HASH_PARALLEL_MIN_SIZE  SIZE_256KB
+
+typedef struct {
+  HASH_HANDLE      *HashCtx;
+  VOID             *DataToHash;
+  UINTN            DataToHashLen;
+  UINTN            ActiveIndex[HASH_COUNT];
+  UINTN            ActiveCount;
+  volatile UINT32  NextIndex;
+} HASH_PARALLEL_CONTEXT;
+
 HASH_INTERFACE   mHashInterface[HASH_COUNT] = {{{0}, NULL, NULL, NULL}};
 UINTN            mHashInterfaceCount = 0;
 
 UINT32           mSupportedHashMaskLast = 0;
 UINT32           mSupportedHashMaskCurrent = 0;
 
+//
+// The MP services are only used while boot services are available and never
+// from SMM.
+//
+BOOLEAN                   mHashParallelAllowed = FALSE;
+EFI_MP_SERVICES_PROTOCOL  *mHashMpServices = NULL;
+EFI_EVENT                 mHashExitBootServicesEvent = NULL;
+
 /**
   Check mismatch of supported HashMask between modules
   that may link different HashInstanceLib instances.
@@ -46,6 +76,79 @@ CheckSupportedHashMaskMismatch (
   }
 }
 
+/**
+  Return the MP services protocol if the hash engines may run in parallel.
+
+  @return The MP services protocol, or NULL.
+**/
+EFI_MP_SERVICES_PROTOCOL *
+GetHashMpServices (
+  VOID
+  )
+{
+  EFI_STATUS  Status;
+
+  if (!mHashParallelAllowed) {
+    return NULL;
+  }
+
+  if (mHashMpServices == NULL) {
+    Status = gBS->LocateProtocol (&gEfiMpServiceProtocolGuid, NULL, (VOID **)&mHashMpServices);
+    if (EFI_ERROR (Status)) {
+      mHashMpServices = NULL;
+    }
+  }
+
+  return mHashMpServices;
+}
+
+/**
+  Run the hash engines of a parallel HashUpdate() until none is left.
+
+  Each caller claims the next engine that has not been started yet, so this
+  runs on the application processors and then on the BSP, which picks up any
+  engine no application processor took.
+
+  @param Buffer  Pointer to the HASH_PARALLEL_CONTEXT.
+**/
+VOID
+EFIAPI
+HashParallelUpdateWorker (
+  IN OUT VOID  *Buffer
+  )
+{
+  HASH_PARALLEL_CONTEXT  *Context;
+  UINTN                  Index;
+
+  Context = (HASH_PARALLEL_CONTEXT *)Buffer;
+  while (TRUE) {
+    Index = InterlockedIncrement (&Context->NextIndex) - 1;
+    if (Index >= Context->ActiveCount) {
+      break;
+    }
+
+    Index = Context->ActiveIndex[Index];
+    mHashInterface[Index].HashUpdate (Context->HashCtx[Index], Context->DataToHash, Context->DataToHashLen);
+  }
+}
+
+/**
+  Notification of ExitBootServices. The MP services can no longer be used.
+
+  @param Event    Event whose notification function is being invoked.
+  @param Context  Pointer to the notification function's context.
+**/
+VOID
+EFIAPI
+HashLibBaseCryptoRouterExitBootServices (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  mHashParallelAllowed = FALSE;
+  mHashMpServices      = NULL;
+}
+
 /**
   Start hash sequence.
 
@@ -102,9 +205,11 @@ HashUpdate (
   IN UINTN          DataToHashLen
   )
 {
-  HASH_HANDLE  *HashCtx;
-  UINTN        Index;
-  UINT32       HashMask;
+  HASH_HANDLE               *HashCtx;
+  UINTN                     Index;
+  UINT32                    HashMask;
+  EFI_MP_SERVICES_PROTOCOL  *MpServices;
+  HASH_PARALLEL_CONTEXT     Context;
 
   if (mHashInterfaceCount == 0) {
     return EFI_UNSUPPORTED;
@@ -114,6 +219,45 @@ HashUpdate (
 
   HashCtx = (HASH_HANDLE *)HashHandle;
 
+  //
+  // Large updates, such as PE/COFF image sections, are hashed by all active
+  // engines at the same time. The result does not depend on which processor
+  // ran an engine.
+  //
+  if ((DataToHashLen >= HASH_PARALLEL_MIN_SIZE) && (mHashInterfaceCount > 1)) {
+    MpServices = GetHashMpServices ();
+    if (MpServices != NULL) {
+      ZeroMem (&Context, sizeof (Context));
+      Context.HashCtx       = HashCtx;
+      Context.DataToHash    = DataToHash;
+      Context.DataToHashLen = DataToHashLen;
+      for (Index = 0; Index < mHashInterfaceCount; Index++) {
+        HashMask = Tpm2GetHashMaskFromAlgo (&mHashInterface[Index].HashGuid);
+        if ((HashMask & PcdGet32 (PcdTpm2HashMask)) != 0) {
+          Context.ActiveIndex[Context.ActiveCount++] = Index;
+        }
+      }
+
+      if (Context.ActiveCount > 1) {
+        //
+        // Whatever the application processors did not take, for example
+        // because none is enabled, is done on the BSP.
+        //
+        MpServices->StartupAllAPs (
+                      MpServices,
+                      HashParallelUpdateWorker,
+                      FALSE,
+                      NULL,
+                      0,
+                      &Context,
+                      NULL
+                      );
+        HashParallelUpdateWorker (&Context);
+        return EFI_SUCCESS;
+      }
+    }
+  }
+
   for (Index = 0; Index < mHashInterfaceCount; Index++) {
     HashMask = Tpm2GetHashMaskFromAlgo (&mHashInterface[Index].HashGuid);
     if ((HashMask & PcdGet32 (PcdTpm2HashMask)) != 0) {
@@ -283,7 +427,9 @@ HashLibBaseCryptoRouterDxeConstructor (
   IN EFI_SYSTEM_TABLE  *SystemTable
   )
 {
-  EFI_STATUS    Status;
+  EFI_STATUS              Status;
+  EFI_SMM_BASE2_PROTOCOL  *SmmBase2;
+  BOOLEAN                 InSmm;
 
   //
   // Record hash algorithm bitmap of LAST module which also consumes HashLib.
@@ -296,5 +442,56 @@ HashLibBaseCryptoRouterDxeConstructor (
   Status = PcdSet32S (PcdTcg2HashAlgorithmBitmap, 0);
   ASSERT_EFI_ERROR (Status);
 
+  //
+  // Hash in parallel only from modules that run outside of SMM, and only
+  // until ExitBootServices.
+  //
+  InSmm  = FALSE;
+  Status = gBS->LocateProtocol (&gEfiSmmBase2ProtocolGuid, NULL, (VOID **)&SmmBase2);
+  if (!EFI_ERROR (Status)) {
+    SmmBase2->InSmm (SmmBase2, &InSmm);
+  }
+
+  if (!InSmm) {
+    Status = gBS->CreateEventEx (
+                    EVT_NOTIFY_SIGNAL,
+                    TPL_NOTIFY,
+                    HashLibBaseCryptoRouterExitBootServices,
+                    NULL,
+                    &gEfiEventExitBootServicesGuid,
+                    &mHashExitBootServicesEvent
+                    );
+    if (!EFI_ERROR (Status)) {
+      mHashParallelAllowed = TRUE;
+    }
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  The destructor function of HashLibBaseCryptoRouterDxe.
+
+  @param  ImageHandle   The firmware allocated handle for the EFI image.
+  @param  SystemTable   A pointer to the EFI System Table.
+
+  @retval EFI_SUCCESS   The destructor executed correctly.
+
+**/
+EFI_STATUS
+EFIAPI
+HashLibBaseCryptoRouterDxeDestructor (
+  IN EFI_HANDLE        ImageHandle,
+  IN EFI_SYSTEM_TABLE  *SystemTable
+  )
+{
+  if (mHashExitBootServicesEvent != NULL) {
+    gBS->CloseEvent (mHashExitBootServicesEvent);
+    mHashExitBootServicesEvent = NULL;
+  }
+
+  mHashParallelAllowed = FALSE;
+  mHashMpServices      = NULL;
+
   return EFI_SUCCESS;
 }
@@ -0,0 +1,776 @@
+/** @file
+  Block device benchmark application.
+
+  Runs a stream of sequential or random reads or writes against a block
+  device through EFI_BLOCK_IO_PROTOCOL, EFI_BLOCK_IO2_PROTOCOL or
+  EFI_DISK_IO2_PROTOCOL, and reports IOPS, throughput and latency
+  percentiles. The asynchronous protocols keep up to the requested queue
+  depth of requests in flight.
+
+  Copyright (c) 2021, EDK II contributors. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+**/
+
+#include <Uefi.h>
+
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/DevicePathLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/ShellLib.h>
+#include <Library/SortLib.h>
+#include <Library/TimerLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Library/UefiLib.h>
+
+#include <Protocol/BlockIo.h>
+#include <Protocol/BlockIo2.h>
+#include <Protocol/DiskIo2.h>
+
+//
+// String token ID of help message text.
+// Shell supports to find help message in the resource section of an application image if
+// .MAN file is not found. This global variable is added to make build tool recognizes
+// that the help string is consumed by user and then build tool will add the string into
+// the resource section. Thus the application can use '-?' option to show help message in
+// Shell.
+//
+GLOBAL_REMOVE_IF_UNREFERENCED EFI_STRING_ID mStringHelpTokenId = STRING_TOKEN (STR_GET_HELP_BLKBENCH);
+
+#define BLK_BENCH_DEFAULT_IO_SIZE       SIZE_4KB
+#define BLK_BENCH_DEFAULT_COUNT         1000
+#define BLK_BENCH_MAX_QUEUE_DEPTH       256
+
+typedef enum {
+  BlkBenchBlockIo,
+  BlkBenchBlockIo2,
+  BlkBenchDiskIo2
+} BLK_BENCH_INTERFACE;
+
+typedef struct {
+  BLK_BENCH_INTERFACE       Interface;
+  BOOLEAN                   Write;
+  BOOLEAN                   Random;
+  UINTN                     IoSize;
+  UINTN                     QueueDepth;
+  UINTN                     Count;
+  UINT64                    RegionSize;
+  UINT64                    Seed;
+} BLK_BENCH_CONFIG;
+
+typedef struct {
+  EFI_BLOCK_IO_PROTOCOL     *BlockIo;
+  EFI_BLOCK_IO2_PROTOCOL    *BlockIo2;
+  EFI_DISK_IO2_PROTOCOL     *DiskIo2;
+  UINT32                    MediaId;
+  UINT32                    BlockSize;
+  UINT64                    RegionUnits;  // Number of IoSize units in the region
+  UINT64                    RandomState;
+  UINT64                    *Latency;     // Nanoseconds, one per request
+} BLK_BENCH_CONTEXT;
+
+//
+// One request slot of the asynchronous queue.
+//
+typedef struct {
+  EFI_BLOCK_IO2_TOKEN       BlockIo2Token;
+  EFI_DISK_IO2_TOKEN        DiskIo2Token;
+  EFI_EVENT                 Event;
+  VOID                      *Buffer;
+  UINT64                    StartTicks;
+  BOOLEAN                   Busy;
+} BLK_BENCH_SLOT;
+
+STATIC CONST SHELL_PARAM_ITEM mParamList[] = {
+  {L"-i",    TypeValue},
+  {L"-rw",   TypeValue},
+  {L"-bs",   TypeValue},
+  {L"-qd",   TypeValue},
+  {L"-n",    TypeValue},
+  {L"-size", TypeValue},
+  {L"-seed", TypeValue},
+  {NULL,     TypeMax}
+};
+
+STATIC UINT64 mTicksStart;
+STATIC UINT64 mTicksEnd;
+
+/**
+  Return the number of performance counter ticks between two readings.
+
+  @param[in] Begin  The earlier reading of the performance counter.
+  @param[in] End    The later reading of the performance counter.
+
+  @return The elapsed ticks, accounting for the count direction and for one
+          rollover of the counter.
+**/
+STATIC
+UINT64
+ElapsedTicks (
+  IN UINT64  Begin,
+  IN UINT64  End
+  )
+{
+  if (mTicksEnd >= mTicksStart) {
+    if (End >= Begin) {
+      return End - Begin;
+    }
+    return (mTicksEnd - Begin) + (End - mTicksStart) + 1;
+  }
+
+  if (Begin >= End) {
+    return Begin - End;
+  }
+  return (Begin - mTicksEnd) + (mTicksStart - End) + 1;
+}
+
+/**
+  Return the byte offset of the next request.
+
+  @param[in,out] Context  The benchmark context.
+  @param[in]     Config   The benchmark configuration.
+  @param[in]     Index    The index of the request.
+
+  @return The byte offset of the request in the device.
+**/
+STATIC
+UINT64
+NextOffset (
+  IN OUT BLK_BENCH_CONTEXT       *Context,
+  IN     CONST BLK_BENCH_CONFIG  *Config,
+  IN     UINTN                   Index
+  )
+{
+  UINT64  Unit;
+
+  if (Config->Random) {
+    //
+    // xorshift64
+    //
+    Context->RandomState ^= LShiftU64 (Context->RandomState, 13);
+    Context->RandomState ^= RShiftU64 (Context->RandomState, 7);
+    Context->RandomState ^= LShiftU64 (Context->RandomState, 17);
+    DivU64x64Remainder (Context->RandomState, Context->RegionUnits, &Unit);
+  } else {
+    DivU64x64Remainder (Index, Context->RegionUnits, &Unit);
+  }
+
+  return MultU64x64 (Unit, Config->IoSize);
+}
+
+/**
+  Compare two latencies for PerformQuickSort().
+
+  @param[in] Buffer1  Pointer to the first UINT64.
+  @param[in] Buffer2  Pointer to the second UINT64.
+
+  @retval <0  The first latency is the smaller one.
+  @retval 0   Both latencies are equal.
+  @retval >0  The first latency is the larger one.
+**/
+STATIC
+INTN
+EFIAPI
+CompareLatency (
+  IN CONST VOID  *Buffer1,
+  IN CONST VOID  *Buffer2
+  )
+{
+  UINT64  Latency1;
+  UINT64  Latency2;
+
+  Latency1 = *(CONST UINT64 *)Buffer1;
+  Latency2 = *(CONST UINT64 *)Buffer2;
+  if (Latency1 < Latency2) {
+    return -1;
+  }
+  return (Latency1 > Latency2) ? 1 : 0;
+}
+
+/**
+  Run the benchmark with synchronous EFI_BLOCK_IO_PROTOCOL requests.
+
+  @param[in,out] Context  The benchmark context.
+  @param[in]     Config   The benchmark configuration.
+  @param[in]     Buffer   The data buffer, IoSize bytes.
+
+  @retval EFI_SUCCESS   All the requests have completed.
+  @return               The status of the first failed request.
+**/
+STATIC
+EFI_STATUS
+RunBlockIo (
+  IN OUT BLK_BENCH_CONTEXT       *Context,
+  IN     CONST BLK_BENCH_CONFIG  *Config,
+  IN     VOID                    *Buffer
+  )
+{
+  EFI_STATUS  Status;
+  UINTN       Index;
+  EFI_LBA     Lba;
+  UINT64      StartTicks;
+
+  for (Index = 0; Index < Config->Count; Index++) {
+    Lba = DivU64x32 (NextOffset (Context, Config, Index), Context->BlockSize);
+
+    StartTicks = GetPerformanceCounter ();
+    if (Config->Write) {
+      Status = Context->BlockIo->WriteBlocks (Context->BlockIo,
+                                   Context->MediaId, Lba, Config->IoSize,
+                                   Buffer);
+    } else {
+      Status = Context->BlockIo->ReadBlocks (Context->BlockIo,
+                                   Context->MediaId, Lba, Config->IoSize,
+                                   Buffer);
+    }
+    Context->Latency[Index] = GetTimeInNanoSecond (
+                                ElapsedTicks (StartTicks,
+                                  GetPerformanceCounter ())
+                                );
+    if (EFI_ERROR (Status)) {
+      Print (L"Request %Lu at LBA 0x%Lx failed: %r\n", (UINT64)Index, Lba,
+        Status);
+      return Status;
+    }
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Submit one asynchronous request on a free slot.
+
+  @param[in,out] Context  The benchmark context.
+  @param[in]     Config   The benchmark configuration.
+  @param[in,out] Slot     The slot to submit the request on.
+  @param[in]     Index    The index of the request.
+
+  @return  The status returned by the protocol.
+**/
+STATIC
+EFI_STATUS
+SubmitRequest (
+  IN OUT BLK_BENCH_CONTEXT       *Context,
+  IN     CONST BLK_BENCH_CONFIG  *Config,
+  IN OUT BLK_BENCH_SLOT          *Slot,
+  IN     UINTN                   Index
+  )
+{
+  UINT64  Offset;
+
+  Offset           = NextOffset (Context, Config, Index);
+  Slot->StartTicks = GetPerformanceCounter ();
+
+  if (Config->Interface == BlkBenchBlockIo2) {
+    Slot->BlockIo2Token.Event              = Slot->Event;
+    Slot->BlockIo2Token.TransactionStatus  = EFI_NOT_READY;
+    if (Config->Write) {
+      return Context->BlockIo2->WriteBlocksEx (Context->BlockIo2,
+                                  Context->MediaId,
+                                  DivU64x32 (Offset, Context->BlockSize),
+                                  &Slot->BlockIo2Token, Config->IoSize,
+                                  Slot->Buffer);
+    }
+    return Context->BlockIo2->ReadBlocksEx (Context->BlockIo2,
+                                Context->MediaId,
+                                DivU64x32 (Offset, Context->BlockSize),
+                                &Slot->BlockIo2Token, Config->IoSize,
+                                Slot->Buffer);
+  }
+
+  Slot->DiskIo2Token.Event             = Slot->Event;
+  Slot->DiskIo2Token.TransactionStatus = EFI_NOT_READY;
+  if (Config->Write) {
+    return Context->DiskIo2->WriteDiskEx (Context->DiskIo2, Context->MediaId,
+                               Offset, &Slot->DiskIo2Token, Config->IoSize,
+                               Slot->Buffer);
+  }
+  return Context->DiskIo2->ReadDiskEx (Context->DiskIo2, Context->MediaId,
+                             Offset, &Slot->DiskIo2Token, Config->IoSize,
+                             Slot->Buffer);
+}
+
+/**
+  Run the benchmark with asynchronous EFI_BLOCK_IO2_PROTOCOL or
+  EFI_DISK_IO2_PROTOCOL requests, keeping up to QueueDepth of them in flight.
+
+  The completion of the requests is polled, so the latencies include the
+  polling delay.
+
+  @param[in,out] Context  The benchmark context.
+  @param[in]     Config   The benchmark configuration.
+  @param[in]     Slots    The QueueDepth request slots.
+
+  @retval EFI_SUCCESS   All the requests have completed.
+  @return               The status of the first failed request.
+**/
+STATIC
+EFI_STATUS
+RunAsync (
+  IN OUT BLK_BENCH_CONTEXT       *Context,
+  IN     CONST BLK_BENCH_CONFIG  *Config,
+  IN     BLK_BENCH_SLOT          *Slots
+  )
+{
+  EFI_STATUS      Status;
+  EFI_STATUS      RequestStatus;
+  UINTN           Submitted;
+  UINTN           Completed;
+  UINTN           InFlight;
+  UINTN           Index;
+  BLK_BENCH_SLOT  *Slot;
+
+  Status    = EFI_SUCCESS;
+  Submitted = 0;
+  Completed = 0;
+  InFlight  = 0;
+
+  while (Completed < Submitted || (Submitted < Config->Count && !EFI_ERROR (Status))) {
+    for (Index = 0; Index < Config->QueueDepth; Index++) {
+      Slot = &Slots[Index];
+
+      if (Slot->Busy && gBS->CheckEvent (Slot->Event) == EFI_SUCCESS) {
+        Context->Latency[Completed] = GetTimeInNanoSecond (
+                                        ElapsedTicks (Slot->StartTicks,
+                                          GetPerformanceCounter ())
+                                        );
+        RequestStatus = (Config->Interface == BlkBenchBlockIo2) ?
+                        Slot->BlockIo2Token.TransactionStatus :
+                        Slot->DiskIo2Token.TransactionStatus;
+        if (EFI_ERROR (RequestStatus) && !EFI_ERROR (Status)) {
+          Print (L"Request failed: %r\n", RequestStatus);
+          Status = RequestStatus;
+        }
+        Slot->Busy = FALSE;
+        InFlight--;
+        Completed++;
+      }
+
+      if (!Slot->Busy && Submitted < Config->Count && !EFI_ERROR (Status)) {
+        RequestStatus = SubmitRequest (Context, Config, Slot, Submitted);
+        if (EFI_ERROR (RequestStatus)) {
+          Print (L"Request %Lu could not be submitted: %r\n",
+            (UINT64)Submitted, RequestStatus);
+          Status = RequestStatus;
+          continue;
+        }
+        Slot->Busy = TRUE;
+        InFlight++;
+        Submitted++;
+      }
+    }
+  }
+
+  ASSERT (InFlight == 0);
+  return Status;
+}
+
+/**
+  Print the results of a benchmark run.
+
+  @param[in]     Config       The benchmark configuration.
+  @param[in,out] Latency      The latencies of the Count requests. The array is
+                              sorted on output.
+  @param[in]     Count        The number of completed requests.
+  @param[in]     ElapsedNs    The wall clock time of the run, in nanoseconds.
+**/
+STATIC
+VOID
+PrintResults (
+  IN     CONST BLK_BENCH_CONFIG  *Config,
+  IN OUT UINT64                  *Latency,
+  IN     UINTN                   Count,
+  IN     UINT64                  ElapsedNs
+  )
+{
+  STATIC CONST UINT32  Permille[] = { 500, 900, 990, 999 };
+  UINT64               Bytes;
+  UINT64               Sum;
+  UINTN                Index;
+  UINTN                Rank;
+
+  if (Count == 0 || ElapsedNs == 0) {
+    return;
+  }
+
+  PerformQuickSort (Latency, Count, sizeof (UINT64), CompareLatency);
+
+  Sum = 0;
+  for (Index = 0; Index < Count; Index++) {
+    Sum += Latency[Index];
+  }
+
+  Bytes = MultU64x64 (Count, Config->IoSize);
+  Print (L"  requests : %Lu in %Lu.%03Lu ms\n", (UINT64)Count,
+    DivU64x32 (ElapsedNs, 1000000), ModU64x32 (DivU64x32 (ElapsedNs, 1000), 1000));
+  Print (L"  IOPS     : %Lu\n",
+    DivU64x64Remainder (MultU64x32 (Count, 1000000000), ElapsedNs, NULL));
+  Print (L"  MB/s     : %Lu.%02Lu\n",
+    DivU64x64Remainder (MultU64x32 (Bytes, 1000), ElapsedNs, NULL),
+    ModU64x32 (DivU64x64Remainder (MultU64x32 (Bytes, 100000), ElapsedNs, NULL),
+      100));
+  Print (L"  latency  : min %Lu us, avg %Lu us, max %Lu us\n",
+    DivU64x32 (Latency[0], 1000),
+    DivU64x32 (DivU64x64Remainder (Sum, Count, NULL), 1000),
+    DivU64x32 (Latency[Count - 1], 1000));
+
+  for (Index = 0; Index < ARRAY_SIZE (Permille); Index++) {
+    Rank = (UINTN)DivU64x32 (MultU64x32 (Count, Permille[Index]), 1000);
+    if (Rank >= Count) {
+      Rank = Count - 1;
+    }
+    Print (L"  p%u.%u    : %Lu us\n", Permille[Index] / 10,
+      Permille[Index] % 10, DivU64x32 (Latency[Rank], 1000));
+  }
+}
+
+/**
+  Parse an unsigned numeric option.
+
+  @param[in]  Package   The parsed command line.
+  @param[in]  Name      The name of the option.
+  @param[in]  Default   The value to return when the option is absent.
+  @param[out] Value     The value of the option.
+
+  @retval EFI_SUCCESS             Value is set.
+  @retval EFI_INVALID_PARAMETER   The option is not a number.
+**/
+STATIC
+EFI_STATUS
+GetNumericOption (
+  IN  LIST_ENTRY    *Package,
+  IN  CHAR16        *Name,
+  IN  UINT64        Default,
+  OUT UINT64        *Value
+  )
+{
+  CONST CHAR16  *String;
+
+  String = ShellCommandLineGetValue (Package, Name);
+  if (String == NULL) {
+    *Value = Default;
+    return EFI_SUCCESS;
+  }
+
+  if (EFI_ERROR (ShellConvertStringToUint64 (String, Value, FALSE, TRUE))) {
+    Print (L"Invalid value '%s' for %s\n", String, Name);
+    return EFI_INVALID_PARAMETER;
+  }
+  return EFI_SUCCESS;
+}
+
+/**
+  Parse the command line into the benchmark configuration.
+
+  @param[in]  Package   The parsed command line.
+  @param[out] Config    The benchmark configuration.
+
+  @retval EFI_SUCCESS             Config is set.
+  @retval EFI_INVALID_PARAMETER   An option is invalid.
+**/
+STATIC
+EFI_STATUS
+ParseConfig (
+  IN  LIST_ENTRY        *Package,
+  OUT BLK_BENCH_CONFIG  *Config
+  )
+{
+  CONST CHAR16  *String;
+  UINT64        Value;
+
+  String = ShellCommandLineGetValue (Package, L"-i");
+  if (String == NULL || StrCmp (String, L"blockio") == 0) {
+    Config->Interface = BlkBenchBlockIo;
+  } else if (StrCmp (String, L"blockio2") == 0) {
+    Config->Interface = BlkBenchBlockIo2;
+  } else if (StrCmp (String, L"diskio2") == 0) {
+    Config->Interface = BlkBenchDiskIo2;
+  } else {
+    Print (L"Invalid interface '%s'\n", String);
+    return EFI_INVALID_PARAMETER;
+  }
+
+  String = ShellCommandLineGetValue (Package, L"-rw");
+  if (String == NULL || StrCmp (String, L"read") == 0) {
+    Config->Write  = FALSE;
+    Config->Random = FALSE;
+  } else if (StrCmp (String, L"randread") == 0) {
+    Config->Write  = FALSE;
+    Config->Random = TRUE;
+  } else if (StrCmp (String, L"write") == 0) {
+    Config->Write  = TRUE;
+    Config->Random = FALSE;
+  } else if (StrCmp (String, L"randwrite") == 0) {
+    Config->Write  = TRUE;
+    Config->Random = TRUE;
+  } else {
+    Print (L"Invalid pattern '%s'\n", String);
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (EFI_ERROR (GetNumericOption (Package, L"-bs", BLK_BENCH_DEFAULT_IO_SIZE, &Value)) ||
+      Value == 0 || Value > MAX_UINT32) {
+    return EFI_INVALID_PARAMETER;
+  }
+  Config->IoSize = (UINTN)Value;
+
+  if (EFI_ERROR (GetNumericOption (Package, L"-qd", 1, &Value)) ||
+      Value == 0 || Value > BLK_BENCH_MAX_QUEUE_DEPTH) {
+    return EFI_INVALID_PARAMETER;
+  }
+  Config->QueueDepth = (UINTN)Value;
+  if (Config->Interface == BlkBenchBlockIo && Config->QueueDepth != 1) {
+    Print (L"EFI_BLOCK_IO_PROTOCOL only supports a queue depth of 1\n");
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (EFI_ERROR (GetNumericOption (Package, L"-n", BLK_BENCH_DEFAULT_COUNT, &Value)) ||
+      Value == 0 || Value > MAX_UINTN / sizeof (UINT64)) {
+    return EFI_INVALID_PARAMETER;
+  }
+  Config->Count = (UINTN)Value;
+
+  if (EFI_ERROR (GetNumericOption (Package, L"-size", 0, &Config->RegionSize))) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (EFI_ERROR (GetNumericOption (Package, L"-seed", 0x2545F4914F6CDD1DULL, &Config->Seed)) ||
+      Config->Seed == 0) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Locate the protocols of the block device mapped to a shell name.
+
+  @param[in]  MapName   The shell mapping of the device, such as "blk0:".
+  @param[out] Context   Receives the protocols of the device.
+
+  @retval EFI_SUCCESS     The device has an EFI_BLOCK_IO_PROTOCOL.
+  @retval EFI_NOT_FOUND   No block device is mapped to MapName.
+**/
+STATIC
+EFI_STATUS
+OpenDevice (
+  IN  CONST CHAR16       *MapName,
+  OUT BLK_BENCH_CONTEXT  *Context
+  )
+{
+  EFI_STATUS                      Status;
+  CHAR16                          *Name;
+  CONST EFI_DEVICE_PATH_PROTOCOL  *MapDevicePath;
+  EFI_DEVICE_PATH_PROTOCOL        *DevicePath;
+  EFI_HANDLE                      Handle;
+
+  if (MapName[StrLen (MapName) - 1] == L':') {
+    Name = AllocateCopyPool (StrSize (MapName), MapName);
+  } else {
+    Name = CatSPrint (NULL, L"%s:", MapName);
+  }
+  if (Name == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  MapDevicePath = gEfiShellProtocol->GetDevicePathFromMap (Name);
+  FreePool (Name);
+  if (MapDevicePath == NULL) {
+    return EFI_NOT_FOUND;
+  }
+
+  DevicePath = (EFI_DEVICE_PATH_PROTOCOL *)MapDevicePath;
+  Status = gBS->LocateDevicePath (&gEfiBlockIoProtocolGuid, &DevicePath,
+                  &Handle);
+  if (EFI_ERROR (Status) || !IsDevicePathEnd (DevicePath)) {
+    return EFI_NOT_FOUND;
+  }
+
+  Status = gBS->HandleProtocol (Handle, &gEfiBlockIoProtocolGuid,
+                  (VOID **)&Context->BlockIo);
+  if (EFI_ERROR (Status)) {
+    return EFI_NOT_FOUND;
+  }
+
+  if (EFI_ERROR (gBS->HandleProtocol (Handle, &gEfiBlockIo2ProtocolGuid,
+                        (VOID **)&Context->BlockIo2))) {
+    Context->BlockIo2 = NULL;
+  }
+  if (EFI_ERROR (gBS->HandleProtocol (Handle, &gEfiDiskIo2ProtocolGuid,
+                        (VOID **)&Context->DiskIo2))) {
+    Context->DiskIo2 = NULL;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Application entry point.
+
+  @param[in] ImageHandle  The image handle of the application.
+  @param[in] SystemTable  The system table.
+
+  @retval EFI_SUCCESS     The benchmark has completed.
+  @return                 An error occurred.
+**/
+EFI_STATUS
+EFIAPI
+BlkBenchAppMain (
+  IN EFI_HANDLE        ImageHandle,
+  IN EFI_SYSTEM_TABLE  *SystemTable
+  )
+{
+  EFI_STATUS          Status;
+  LIST_ENTRY          *Package;
+  CHAR16              *ProblemParam;
+  CONST CHAR16        *MapName;
+  BLK_BENCH_CONFIG    Config;
+  BLK_BENCH_CONTEXT   Context;
+  EFI_BLOCK_IO_MEDIA  *Media;
+  BLK_BENCH_SLOT      *Slots;
+  UINTN               SlotCount;
+  UINTN               Pages;
+  UINTN               Alignment;
+  UINTN               Index;
+  UINT64              DeviceSize;
+  UINT64              Begin;
+  UINT64              ElapsedNs;
+
+  Package = NULL;
+  Slots   = NULL;
+  Pages   = 0;
+  ZeroMem (&Context, sizeof Context);
+
+  Status = ShellCommandLineParse (mParamList, &Package, &ProblemParam, TRUE);
+  if (EFI_ERROR (Status)) {
+    if (Status == EFI_VOLUME_CORRUPTED && ProblemParam != NULL) {
+      Print (L"Invalid argument '%s'\n", ProblemParam);
+      FreePool (ProblemParam);
+    }
+    return EFI_INVALID_PARAMETER;
+  }
+
+  MapName = ShellCommandLineGetRawValue (Package, 1);
+  if (MapName == NULL || ShellCommandLineGetCount (Package) != 2) {
+    Print (L"Usage: BlkBenchApp <device> [options], see -? for details\n");
+    Status = EFI_INVALID_PARAMETER;
+    goto Exit;
+  }
+
+  Status = ParseConfig (Package, &Config);
+  if (EFI_ERROR (Status)) {
+    goto Exit;
+  }
+
+  Status = OpenDevice (MapName, &Context);
+  if (EFI_ERROR (Status)) {
+    Print (L"No block device is mapped to '%s'\n", MapName);
+    goto Exit;
+  }
+
+  if ((Config.Interface == BlkBenchBlockIo2 && Context.BlockIo2 == NULL) ||
+      (Config.Interface == BlkBenchDiskIo2 && Context.DiskIo2 == NULL)) {
+    Print (L"The device does not support the requested interface\n");
+    Status = EFI_UNSUPPORTED;
+    goto Exit;
+  }
+
+  Media = Context.BlockIo->Media;
+  if (!Media->MediaPresent) {
+    Status = EFI_NO_MEDIA;
+    goto Exit;
+  }
+  if (Config.Write && Media->ReadOnly) {
+    Status = EFI_WRITE_PROTECTED;
+    goto Exit;
+  }
+  if (Config.Interface != BlkBenchDiskIo2 &&
+      Config.IoSize % Media->BlockSize != 0) {
+    Print (L"The request size must be a multiple of the block size (%u)\n",
+      Media->BlockSize);
+    Status = EFI_INVALID_PARAMETER;
+    goto Exit;
+  }
+
+  Context.MediaId     = Media->MediaId;
+  Context.BlockSize   = Media->BlockSize;
+  Context.RandomState = Config.Seed;
+
+  DeviceSize = MultU64x32 (Media->LastBlock + 1, Media->BlockSize);
+  if (Config.RegionSize == 0 || Config.RegionSize > DeviceSize) {
+    Config.RegionSize = DeviceSize;
+  }
+  Context.RegionUnits = DivU64x64Remainder (Config.RegionSize, Config.IoSize,
+                          NULL);
+  if (Context.RegionUnits == 0) {
+    Status = EFI_INVALID_PARAMETER;
+    goto Exit;
+  }
+
+  Context.Latency = AllocatePool (Config.Count * sizeof (UINT64));
+  SlotCount       = Config.QueueDepth;
+  Slots           = AllocateZeroPool (SlotCount * sizeof (BLK_BENCH_SLOT));
+  if (Context.Latency == NULL || Slots == NULL) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto Exit;
+  }
+
+  Pages     = EFI_SIZE_TO_PAGES (Config.IoSize);
+  Alignment = MAX (Media->IoAlign, EFI_PAGE_SIZE);
+  for (Index = 0; Index < SlotCount; Index++) {
+    Slots[Index].Buffer = AllocateAlignedPages (Pages, Alignment);
+    if (Slots[Index].Buffer == NULL) {
+      Status = EFI_OUT_OF_RESOURCES;
+      goto Exit;
+    }
+    SetMem (Slots[Index].Buffer, Config.IoSize, 0x5A);
+
+    if (Config.Interface != BlkBenchBlockIo) {
+      Status = gBS->CreateEvent (0, TPL_CALLBACK, NULL, NULL,
+                      &Slots[Index].Event);
+      if (EFI_ERROR (Status)) {
+        goto Exit;
+      }
+    }
+  }
+
+  GetPerformanceCounterProperties (&mTicksStart, &mTicksEnd);
+
+  Print (L"%s: %a %Lu x %Lu bytes, queue depth %Lu, region %Lu bytes\n",
+    MapName, Config.Random ? (Config.Write ? "randwrite" : "randread") :
+                             (Config.Write ? "write" : "read"),
+    (UINT64)Config.Count, (UINT64)Config.IoSize, (UINT64)Config.QueueDepth,
+    Config.RegionSize);
+
+  Begin = GetPerformanceCounter ();
+  if (Config.Interface == BlkBenchBlockIo) {
+    Status = RunBlockIo (&Context, &Config, Slots[0].Buffer);
+  } else {
+    Status = RunAsync (&Context, &Config, Slots);
+  }
+  ElapsedNs = GetTimeInNanoSecond (ElapsedTicks (Begin,
+                                     GetPerformanceCounter ()));
+
+  if (!EFI_ERROR (Status)) {
+    PrintResults (&Config, Context.Latency, Config.Count, ElapsedNs);
+  }
+
+Exit:
+  if (Slots != NULL) {
+    for (Index = 0; Index < SlotCount; Index++) {
+      if (Slots[Index].Event != NULL) {
+        gBS->CloseEvent (Slots[Index].Event);
+      }
+      if (Slots[Index].Buffer != NULL) {
+        FreeAlignedPages (Slots[Index].Buffer, Pages);
+      }
+    }
+    FreePool (Slots);
+  }
+  if (Context.Latency != NULL) {
+    FreePool (Context.Latency);
+  }
+  ShellCommandLineFreeVarList (Package);
+  return Status;
+}
@@ -69,6 +69,12 @@ CONST CHAR16 mNoNestingEnvVarName[]         = L"nonesting";
 CONST CHAR16 mNoNestingTrue[]               = L"True";
 CONST CHAR16 mNoNestingFalse[]              = L"False";
 
+//
+// Scripts that have been read, most recently used first.
+//
+STATIC LIST_ENTRY mScriptCache      = INITIALIZE_LIST_HEAD_VARIABLE (mScriptCache);
+STATIC UINTN      mScriptCacheCount = 0;
+
 /**
   Cleans off leading and trailing spaces and tabs.
 
@@ -702,6 +708,7 @@ FreeResources:
   }
 
   ShellFreeEnvVarList ();
+  FreeScriptCache (MAX_UINTN);
 
   if (ShellCommandGetExit()) {
     return ((EFI_STATUS)ShellCommandGetExitCode());
@@ -2765,6 +2772,192 @@ RunCommand(
   return (RunShellCommand(CmdLine, NULL));
 }
 
+/**
+  Free a list of script commands and the command lines they hold.
+
+  @param[in] CommandList  The list of SCRIPT_COMMAND_LIST objects to free.
+**/
+STATIC
+VOID
+FreeScriptCommandList (
+  IN LIST_ENTRY  *CommandList
+  )
+{
+  SCRIPT_COMMAND_LIST *Command;
+
+  while (!IsListEmpty (CommandList)) {
+    Command = (SCRIPT_COMMAND_LIST *)GetFirstNode (CommandList);
+    RemoveEntryList (&Command->Link);
+    SHELL_FREE_NON_NULL (Command->Cl);
+    SHELL_FREE_NON_NULL (Command->Data);
+    FreePool (Command);
+  }
+}
+
+/**
+  Append copies of the command lines in one list of script commands to
+  another.
+
+  On failure nothing is appended to Destination.
+
+  @param[in] Source           The list of SCRIPT_COMMAND_LIST objects to copy.
+  @param[in, out] Destination The list to append the copies to.
+
+  @retval EFI_SUCCESS           The commands were copied.
+  @retval EFI_OUT_OF_RESOURCES  A memory allocation failed.
+**/
+STATIC
+EFI_STATUS
+CopyScriptCommandList (
+  IN     LIST_ENTRY  *Source,
+  IN OUT LIST_ENTRY  *Destination
+  )
+{
+  LIST_ENTRY          Copies;
+  SCRIPT_COMMAND_LIST *Command;
+  SCRIPT_COMMAND_LIST *Copy;
+
+  InitializeListHead (&Copies);
+  for ( Command = (SCRIPT_COMMAND_LIST *)GetFirstNode (Source)
+      ; !IsNull (Source, &Command->Link)
+      ; Command = (SCRIPT_COMMAND_LIST *)GetNextNode (Source, &Command->Link)
+      ) {
+    Copy = AllocateZeroPool (sizeof (SCRIPT_COMMAND_LIST));
+    if (Copy == NULL) {
+      FreeScriptCommandList (&Copies);
+      return EFI_OUT_OF_RESOURCES;
+    }
+    Copy->Cl   = AllocateCopyPool (StrSize (Command->Cl), Command->Cl);
+    Copy->Line = Command->Line;
+    if (Copy->Cl == NULL) {
+      FreePool (Copy);
+      FreeScriptCommandList (&Copies);
+      return EFI_OUT_OF_RESOURCES;
+    }
+    InsertTailList (&Copies, &Copy->Link);
+  }
+
+  while (!IsListEmpty (&Copies)) {
+    Copy = (SCRIPT_COMMAND_LIST *)GetFirstNode (&Copies);
+    RemoveEntryList (&Copy->Link);
+    InsertTailList (Destination, &Copy->Link);
+  }
+  return EFI_SUCCESS;
+}
+
+/**
+  Find a script in the script cache.
+
+  A cached script only matches if the file still has the same size and
+  modification time as when it was cached.  A match becomes the most recently
+  used entry.
+
+  @param[in] Name       The full path of the script file.
+  @param[in] FileInfo   The current information of the script file.
+
+  @retval NULL          The script is not cached, or has changed since.
+  @return               The cache entry of the script.
+**/
+STATIC
+SCRIPT_CACHE_ENTRY *
+FindCachedScript (
+  IN CONST CHAR16         *Name,
+  IN CONST EFI_FILE_INFO  *FileInfo
+  )
+{
+  SCRIPT_CACHE_ENTRY  *Entry;
+
+  for ( Entry = (SCRIPT_CACHE_ENTRY *)GetFirstNode (&mScriptCache)
+      ; !IsNull (&mScriptCache, &Entry->Link)
+      ; Entry = (SCRIPT_CACHE_ENTRY *)GetNextNode (&mScriptCache, &Entry->Link)
+      ) {
+    if (StrCmp (Entry->Name, Name) != 0) {
+      continue;
+    }
+    if (Entry->FileSize != FileInfo->FileSize ||
+        CompareMem (&Entry->ModificationTime, &FileInfo->ModificationTime, sizeof (EFI_TIME)) != 0) {
+      //
+      // The script has been changed; drop the stale copy.
+      //
+      RemoveEntryList (&Entry->Link);
+      mScriptCacheCount--;
+      FreeScriptCommandList (&Entry->CommandList);
+      FreePool (Entry->Name);
+      FreePool (Entry);
+      return NULL;
+    }
+    RemoveEntryList (&Entry->Link);
+    InsertHeadList (&mScriptCache, &Entry->Link);
+    return Entry;
+  }
+  return NULL;
+}
+
+/**
+  Add the command list of a script that was just read to the script cache,
+  evicting the least recently used entry when the cache is full.
+
+  Failures are ignored; the script is simply read again next time.
+
+  @param[in] Name         The full path of the script file.
+  @param[in] FileInfo     The information of the script file.
+  @param[in] CommandList  The commands read from the script file.
+**/
+STATIC
+VOID
+AddCachedScript (
+  IN CONST CHAR16         *Name,
+  IN CONST EFI_FILE_INFO  *FileInfo,
+  IN LIST_ENTRY           *CommandList
+  )
+{
+  SCRIPT_CACHE_ENTRY  *Entry;
+
+  Entry = AllocateZeroPool (sizeof (SCRIPT_CACHE_ENTRY));
+  if (Entry == NULL) {
+    return;
+  }
+  InitializeListHead (&Entry->CommandList);
+  Entry->Name = AllocateCopyPool (StrSize (Name), Name);
+  if (Entry->Name == NULL ||
+      EFI_ERROR (CopyScriptCommandList (CommandList, &Entry->CommandList))) {
+    SHELL_FREE_NON_NULL (Entry->Name);
+    FreePool (Entry);
+    return;
+  }
+  Entry->FileSize = FileInfo->FileSize;
+  CopyMem (&Entry->ModificationTime, &FileInfo->ModificationTime, sizeof (EFI_TIME));
+
+  if (mScriptCacheCount == SCRIPT_CACHE_MAX_ENTRIES) {
+    FreeScriptCache (1);
+  }
+  InsertHeadList (&mScriptCache, &Entry->Link);
+  mScriptCacheCount++;
+}
+
+/**
+  Free entries of the script cache, least recently used first.
+
+  @param[in] Count    The number of entries to free, or MAX_UINTN to empty
+                      the cache.
+**/
+VOID
+FreeScriptCache (
+  IN UINTN  Count
+  )
+{
+  SCRIPT_CACHE_ENTRY  *Entry;
+
+  while (Count-- > 0 && !IsListEmpty (&mScriptCache)) {
+    Entry = (SCRIPT_CACHE_ENTRY *)GetPreviousNode (&mScriptCache, &mScriptCache);
+    RemoveEntryList (&Entry->Link);
+    mScriptCacheCount--;
+    FreeScriptCommandList (&Entry->CommandList);
+    FreePool (Entry->Name);
+    FreePool (Entry);
+  }
+}
+
 /**
   Function to process a NSH script file via SHELL_FILE_HANDLE.
 
@@ -2794,6 +2987,8 @@ RunScriptFileHandle (
   UINTN               LineCount;
   CHAR16              LeString[50];
   LIST_ENTRY          OldBufferList;
+  EFI_FILE_INFO       *FileInfo;
+  SCRIPT_CACHE_ENTRY  *CachedScript;
 
   ASSERT(!ShellCommandGetScriptExit());
 
@@ -2846,29 +3041,43 @@ RunScriptFileHandle (
   InitializeListHead(&NewScriptFile->SubstList);
 
   //
-  // Now build the list of all script commands.
+  // Now build the list of all script commands, from the script cache when the
+  // file has not changed since it was last read.
   //
-  LineCount = 0;
-  while(!ShellFileHandleEof(Handle)) {
-    CommandLine = ShellFileHandleReturnLine(Handle, &Ascii);
-    LineCount++;
-    if (CommandLine == NULL || StrLen(CommandLine) == 0 || CommandLine[0] == '#') {
-      SHELL_FREE_NON_NULL(CommandLine);
-      continue;
-    }
-    NewScriptFile->CurrentCommand = AllocateZeroPool(sizeof(SCRIPT_COMMAND_LIST));
-    if (NewScriptFile->CurrentCommand == NULL) {
-      SHELL_FREE_NON_NULL(CommandLine);
-      DeleteScriptFileStruct(NewScriptFile);
-      return (EFI_OUT_OF_RESOURCES);
-    }
+  FileInfo     = ShellGetFileInfo(Handle);
+  CachedScript = NULL;
+  if (FileInfo != NULL) {
+    CachedScript = FindCachedScript(Name, FileInfo);
+  }
+  if (CachedScript == NULL ||
+      EFI_ERROR (CopyScriptCommandList(&CachedScript->CommandList, &NewScriptFile->CommandList))) {
+    LineCount = 0;
+    while(!ShellFileHandleEof(Handle)) {
+      CommandLine = ShellFileHandleReturnLine(Handle, &Ascii);
+      LineCount++;
+      if (CommandLine == NULL || StrLen(CommandLine) == 0 || CommandLine[0] == '#') {
+        SHELL_FREE_NON_NULL(CommandLine);
+        continue;
+      }
+      NewScriptFile->CurrentCommand = AllocateZeroPool(sizeof(SCRIPT_COMMAND_LIST));
+      if (NewScriptFile->CurrentCommand == NULL) {
+        SHELL_FREE_NON_NULL(CommandLine);
+        SHELL_FREE_NON_NULL(FileInfo);
+        DeleteScriptFileStruct(NewScriptFile);
+        return (EFI_OUT_OF_RESOURCES);
+      }
 
-    NewScriptFile->CurrentCommand->Cl   = CommandLine;
-    NewScriptFile->CurrentCommand->Data = NULL;
-    NewScriptFile->CurrentCommand->Line = LineCount;
+      NewScriptFile->CurrentCommand->Cl   = CommandLine;
+      NewScriptFile->CurrentCommand->Data = NULL;
+      NewScriptFile->CurrentCommand->Line = LineCount;
 
-    InsertTailList(&NewScriptFile->CommandList, &NewScriptFile->CurrentCommand->Link);
+      InsertTailList(&NewScriptFile->CommandList, &NewScriptFile->CurrentCommand->Link);
+    }
+    if (FileInfo != NULL && CachedScript == NULL) {
+      AddCachedScript(Name, FileInfo, &NewScriptFile->CommandList);
+    }
   }
+  SHELL_FREE_NON_NULL(FileInfo);
 
   //
   // Add this as the topmost script file
@@ -122,6 +122,19 @@ typedef struct {
   BOOLEAN                       HaltOutput;           ///< TRUE to start a CTRL-S halt.
 } SHELL_INFO;
 
+///
+/// The maximum number of scripts kept in the script cache.
+///
+#define SCRIPT_CACHE_MAX_ENTRIES  8
+
+typedef struct {
+  LIST_ENTRY  Link;             ///< Standard linked list handler.
+  CHAR16      *Name;            ///< The full path of the script file.
+  UINT64      FileSize;         ///< The size of the file when it was read.
+  EFI_TIME    ModificationTime; ///< The modification time of the file when it was read.
+  LIST_ENTRY  CommandList;      ///< The SCRIPT_COMMAND_LIST objects read from the file.
+} SCRIPT_CACHE_ENTRY;
+
 #pragma pack(1)
 ///
 /// HII specific Vendor Device Path definition.
@@ -318,6 +331,17 @@ RunScriptFileHandle (
   IN CONST CHAR16       *Name
   );
 
+/**
+  Free entries of the script cache, least recently used first.
+
+  @param[in] Count    The number of entries to free, or MAX_UINTN to empty
+                      the cache.
+**/
+VOID
+FreeScriptCache (
+  IN UINTN  Count
+  );
+
 /**
   Function to process a NSH script file.
 
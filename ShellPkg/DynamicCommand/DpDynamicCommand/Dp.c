@@ -84,6 +84,8 @@ STATIC CONST SHELL_PARAM_ITEM ParamList[] = {
   {L"-c", TypeValue},  // -c   Display cumulative data.
   {L"-n", TypeValue},  // -n # Number of records to display for A and R
   {L"-t", TypeValue},  // -t # Threshold of interest
+  {L"-o", TypeValue},  // -o   Export nested spans to a file
+  {L"-f", TypeFlag},   // -f   Export in folded-stack format
   {NULL, TypeMax}
   };
 
@@ -641,6 +643,10 @@ RunDp (
   SHELL_STATUS              ShellStatus;
   TIMER_INFO                TimerInfo;
   UINT64                    Intermediate;
+  CONST CHAR16              *ExportFileName;
+  BOOLEAN                   FoldedStack;
+  UINT64                    ExportThreshold;
+  UINTN                     ExportCount;
 
   StringPtr   = NULL;
   SummaryMode = FALSE;
@@ -650,6 +656,8 @@ RunDp (
   ExcludeMode = FALSE;
   CumulativeMode = FALSE;
   CustomCumulativeData = NULL;
+  ExportFileName = NULL;
+  ExportThreshold = 0;
   ShellStatus = SHELL_SUCCESS;
 
   //
@@ -680,6 +688,7 @@ RunDp (
   ExcludeMode = ShellCommandLineGetFlag (ParamPackage, L"-x");
   mShowId     = ShellCommandLineGetFlag (ParamPackage, L"-i");
   CumulativeMode = ShellCommandLineGetFlag (ParamPackage, L"-c");
+  FoldedStack = ShellCommandLineGetFlag (ParamPackage, L"-f");
 
   if (AllMode && RawMode) {
     ShellPrintHiiEx (-1, -1, NULL, STRING_TOKEN (STR_DP_CONFLICT_ARG), mDpHiiHandle, L"-A", L"-R");
@@ -725,6 +734,7 @@ RunDp (
         return SHELL_INVALID_PARAMETER;
       } else {
         mInterestThreshold = Intermediate;
+        ExportThreshold = Intermediate;
       }
     }
   } else {
@@ -756,6 +766,19 @@ RunDp (
     }
   }
 
+  if (ShellCommandLineGetFlag (ParamPackage, L"-o")) {
+    ExportFileName = ShellCommandLineGetValue (ParamPackage, L"-o");
+    if (ExportFileName == NULL) {
+      ShellPrintHiiEx (-1, -1, NULL, STRING_TOKEN (STR_DP_TOO_FEW), mDpHiiHandle);
+      ShellStatus = SHELL_INVALID_PARAMETER;
+      goto Done;
+    }
+  } else if (FoldedStack) {
+    ShellPrintHiiEx (-1, -1, NULL, STRING_TOKEN (STR_DP_NO_EXPORT), mDpHiiHandle);
+    ShellStatus = SHELL_INVALID_PARAMETER;
+    goto Done;
+  }
+
   //
   // DP dump performance data by parsing FPDT table in ACPI table.
   // Folloing 3 steps are to get the measurement form the FPDT table.
@@ -851,10 +874,22 @@ RunDp (
 ****    A All         --  R and S options are ignored
 ****    R Raw         --  S option is ignored
 ****    s Summary     --  Modifies "Cooked" output only
+****    o Export      --  Writes spans to a file instead of any display mode
 ****    Cooked (Default)
 ****************************************************************************/
   GatherStatistics (CustomCumulativeData);
-  if (CumulativeMode) {
+  if (ExportFileName != NULL) {
+    Status = DumpTraceExport (ExportFileName, FoldedStack, ExportThreshold, &ExportCount);
+    if (Status == EFI_ABORTED) {
+      ShellStatus = SHELL_ABORTED;
+      goto Done;
+    } else if (EFI_ERROR (Status)) {
+      ShellPrintHiiEx (-1, -1, NULL, STRING_TOKEN (STR_DP_EXPORT_FAIL), mDpHiiHandle, ExportFileName, Status);
+      ShellStatus = SHELL_DEVICE_ERROR;
+      goto Done;
+    }
+    ShellPrintHiiEx (-1, -1, NULL, STRING_TOKEN (STR_DP_EXPORT_DONE), mDpHiiHandle, ExportCount, ExportFileName);
+  } else if (CumulativeMode) {
     ProcessCumulative (CustomCumulativeData);
   } else if (AllMode) {
     Status = DumpAllTrace( Number2Display, ExcludeMode);
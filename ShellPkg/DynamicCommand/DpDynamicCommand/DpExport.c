@@ -0,0 +1,364 @@
+/** @file
+  Trace export for the Dp utility.
+
+  Writes the measurement records as nested timing spans, either in the
+  Chrome trace-event JSON format or in the folded-stack format consumed by
+  flame graph tools, so boot timing can be compared between builds offline.
+
+  Copyright (c) 2009 - 2018, Intel Corporation. All rights reserved.
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+**/
+
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/DebugLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Library/PrintLib.h>
+
+#include "Dp.h"
+#include "Literals.h"
+#include "DpInternal.h"
+
+#define DP_EXPORT_NAME_LENGTH     (DP_GAUGE_STRING_LENGTH + DXE_PERFORMANCE_STRING_SIZE + 2)
+#define DP_EXPORT_LINE_LENGTH     512
+
+///
+/// One open span while the records are walked in start time order.
+///
+typedef struct {
+  MEASUREMENT_RECORD    *Measurement;
+  UINT64                ChildTime;        ///< Time covered by direct children, in ns.
+  UINTN                 PathLength;       ///< Length of the folded stack up to and including this span.
+} DP_EXPORT_FRAME;
+
+CHAR8  mExportPath[DP_EXPORT_LINE_LENGTH];
+
+/**
+  Format a line and append it to the export file.
+
+  @param[in]  FileHandle   The file to write to.
+  @param[in]  Format       ASCII format string.
+  @param[in]  ...          Arguments for Format.
+
+  @retval EFI_SUCCESS      The line was written.
+  @return Others           From ShellWriteFile().
+**/
+EFI_STATUS
+DpExportPrint (
+  IN SHELL_FILE_HANDLE  FileHandle,
+  IN CONST CHAR8        *Format,
+  ...
+  )
+{
+  CHAR8    Line[DP_EXPORT_LINE_LENGTH];
+  VA_LIST  Marker;
+  UINTN    Size;
+
+  VA_START (Marker, Format);
+  Size = AsciiVSPrint (Line, sizeof (Line), Format, Marker);
+  VA_END (Marker);
+
+  return ShellWriteFile (FileHandle, &Size, Line);
+}
+
+/**
+  Compare two measurement records by start time for sorting.
+
+  Records that start at the same time are ordered longest first, so that an
+  enclosing span is always visited before the spans it contains.
+
+  @param[in]  Buffer1   Pointer to the first MEASUREMENT_RECORD pointer.
+  @param[in]  Buffer2   Pointer to the second MEASUREMENT_RECORD pointer.
+
+  @retval <0            Buffer1 sorts before Buffer2.
+  @retval 0             Both records are equivalent.
+  @retval >0            Buffer1 sorts after Buffer2.
+**/
+INTN
+EFIAPI
+DpCompareMeasurementStart (
+  IN CONST VOID  *Buffer1,
+  IN CONST VOID  *Buffer2
+  )
+{
+  CONST MEASUREMENT_RECORD  *Record1;
+  CONST MEASUREMENT_RECORD  *Record2;
+
+  Record1 = *(MEASUREMENT_RECORD * CONST *) Buffer1;
+  Record2 = *(MEASUREMENT_RECORD * CONST *) Buffer2;
+
+  if (Record1->StartTimeStamp != Record2->StartTimeStamp) {
+    return (Record1->StartTimeStamp < Record2->StartTimeStamp) ? -1 : 1;
+  }
+  if (Record1->EndTimeStamp != Record2->EndTimeStamp) {
+    return (Record1->EndTimeStamp > Record2->EndTimeStamp) ? -1 : 1;
+  }
+  return 0;
+}
+
+/**
+  Get the exported name of a measurement.
+
+  The name is built the same way as in the "All" display: the driver name
+  for records with an image handle, the instance GUID for PEIMs and the
+  module string otherwise, followed by the token. Characters that delimit
+  fields in the JSON or folded-stack output are replaced.
+
+  @param[in]  Measurement   The measurement to name.
+  @param[in]  HandleBuffer  All handles in the system, or NULL.
+  @param[in]  HandleCount   Number of handles in HandleBuffer.
+  @param[out] Name          Buffer of DP_EXPORT_NAME_LENGTH characters for the name.
+**/
+VOID
+DpGetExportName (
+  IN  MEASUREMENT_RECORD  *Measurement,
+  IN  EFI_HANDLE          *HandleBuffer,
+  IN  UINTN               HandleCount,
+  OUT CHAR8               *Name
+  )
+{
+  UINTN   Index;
+  CHAR8   *Char;
+
+  AsciiStrToUnicodeStrS (Measurement->Module, mGaugeString, ARRAY_SIZE (mGaugeString));
+  if (Measurement->Handle != NULL) {
+    for (Index = 0; Index < HandleCount; Index++) {
+      if (Measurement->Handle == HandleBuffer[Index]) {
+        DpGetNameFromHandle (HandleBuffer[Index]);
+        break;
+      }
+    }
+  }
+
+  if (AsciiStrCmp (Measurement->Token, ALit_PEIM) == 0) {
+    UnicodeSPrint (mGaugeString, sizeof (mGaugeString), L"%g", Measurement->Handle);
+  }
+  mGaugeString[DP_GAUGE_STRING_LENGTH] = 0;
+
+  if (mGaugeString[0] == 0) {
+    AsciiSPrint (Name, DP_EXPORT_NAME_LENGTH, "%a", Measurement->Token);
+  } else {
+    AsciiSPrint (Name, DP_EXPORT_NAME_LENGTH, "%s(%a)", mGaugeString, Measurement->Token);
+  }
+
+  for (Char = Name; *Char != '\0'; Char++) {
+    if ((*Char == ';') || (*Char == '"') || (*Char == '\\') || (*Char < ' ')) {
+      *Char = '_';
+    }
+  }
+}
+
+/**
+  Write the record on top of the span stack and pop it.
+
+  For the Chrome trace-event format a complete event is written. For the
+  folded-stack format the line carries the time spent in the span itself,
+  excluding its children, so that the flame graph widths add up.
+
+  @param[in]      FileHandle   The file to write to.
+  @param[in]      FoldedStack  TRUE for folded-stack output, FALSE for JSON.
+  @param[in, out] Stack        The span stack.
+  @param[in, out] Depth        The number of spans on the stack.
+  @param[in, out] EventCount   The number of events written so far.
+
+  @retval EFI_SUCCESS      The span was written.
+  @return Others           From ShellWriteFile().
+**/
+EFI_STATUS
+DpExportPopFrame (
+  IN     SHELL_FILE_HANDLE  FileHandle,
+  IN     BOOLEAN            FoldedStack,
+  IN OUT DP_EXPORT_FRAME    *Stack,
+  IN OUT UINTN              *Depth,
+  IN OUT UINTN              *EventCount
+  )
+{
+  DP_EXPORT_FRAME  *Frame;
+  UINT64           Duration;
+  UINT64           SelfTime;
+  EFI_STATUS       Status;
+
+  ASSERT (*Depth > 0);
+  Frame    = &Stack[*Depth - 1];
+  Duration = GetDuration (Frame->Measurement);
+
+  if (FoldedStack) {
+    SelfTime = (Duration > Frame->ChildTime) ? (Duration - Frame->ChildTime) : 0;
+    mExportPath[Frame->PathLength] = '\0';
+    Status = DpExportPrint (FileHandle, "%a %Ld\n", mExportPath, DurationInMicroSeconds (SelfTime));
+  } else {
+    mExportPath[Frame->PathLength] = '\0';
+    Status = DpExportPrint (
+               FileHandle,
+               "%a\n{\"name\":\"%a\",\"cat\":\"%a\",\"ph\":\"X\",\"ts\":%Ld.%03d,\"dur\":%Ld.%03d,\"pid\":1,\"tid\":1,"
+               "\"args\":{\"handle\":\"0x%p\",\"id\":%d}}",
+               (*EventCount == 0) ? "" : ",",
+               (*Depth > 1) ? mExportPath + Stack[*Depth - 2].PathLength + 1 : mExportPath,
+               Frame->Measurement->Token,
+               DivU64x32 (Frame->Measurement->StartTimeStamp, 1000),
+               (UINT32) ModU64x32 (Frame->Measurement->StartTimeStamp, 1000),
+               DivU64x32 (Duration, 1000),
+               (UINT32) ModU64x32 (Duration, 1000),
+               Frame->Measurement->Handle,
+               Frame->Measurement->Identifier
+               );
+  }
+
+  *EventCount += 1;
+  *Depth      -= 1;
+  if (*Depth > 0) {
+    Stack[*Depth - 1].ChildTime += Duration;
+    mExportPath[Stack[*Depth - 1].PathLength] = '\0';
+  }
+
+  return Status;
+}
+
+/**
+  Export all complete Trace Records as nested timing spans.
+
+  Records are sorted by start time and nested by containment: a record is a
+  child of the innermost earlier record whose time range fully covers it.
+  Each span is written as soon as it is closed, so the whole output is never
+  held in memory.
+
+  @param[in]  FileName      The file to write, e.g. on the ESP.
+  @param[in]  FoldedStack   TRUE to write folded stacks, FALSE for Chrome trace-event JSON.
+  @param[in]  Threshold     Spans shorter than this many microseconds are not written.
+  @param[out] EventCount    The number of spans written.
+
+  @retval EFI_SUCCESS           The trace was written.
+  @retval EFI_OUT_OF_RESOURCES  Memory could not be allocated.
+  @return Others                From opening or writing the file.
+**/
+EFI_STATUS
+DumpTraceExport (
+  IN  CONST CHAR16  *FileName,
+  IN  BOOLEAN       FoldedStack,
+  IN  UINT64        Threshold,
+  OUT UINTN         *EventCount
+  )
+{
+  SHELL_FILE_HANDLE   FileHandle;
+  MEASUREMENT_RECORD  **SortedList;
+  DP_EXPORT_FRAME     *Stack;
+  MEASUREMENT_RECORD  *Measurement;
+  EFI_HANDLE          *HandleBuffer;
+  UINTN               HandleCount;
+  UINTN               SortedCount;
+  UINTN               Depth;
+  UINTN               Index;
+  UINTN               PathLength;
+  CHAR8               Name[DP_EXPORT_NAME_LENGTH];
+  EFI_STATUS          Status;
+
+  *EventCount  = 0;
+  SortedList   = NULL;
+  Stack        = NULL;
+  HandleBuffer = NULL;
+  HandleCount  = 0;
+
+  //
+  // Replace any existing file.
+  //
+  Status = ShellOpenFileByName (FileName, &FileHandle, EFI_FILE_MODE_READ | EFI_FILE_MODE_WRITE, 0);
+  if (!EFI_ERROR (Status)) {
+    ShellDeleteFile (&FileHandle);
+  }
+  Status = ShellOpenFileByName (FileName, &FileHandle, EFI_FILE_MODE_READ | EFI_FILE_MODE_WRITE | EFI_FILE_MODE_CREATE, 0);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  SortedList = AllocatePool ((mMeasurementNum + 1) * sizeof (MEASUREMENT_RECORD *));
+  Stack      = AllocatePool ((mMeasurementNum + 1) * sizeof (DP_EXPORT_FRAME));
+  if ((SortedList == NULL) || (Stack == NULL)) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto Done;
+  }
+
+  SortedCount = 0;
+  for (Index = 0; Index < mMeasurementNum; Index++) {
+    Measurement = &mMeasurementList[Index];
+    if (Measurement->EndTimeStamp == 0) {
+      continue;
+    }
+    if (DurationInMicroSeconds (GetDuration (Measurement)) < Threshold) {
+      continue;
+    }
+    SortedList[SortedCount++] = Measurement;
+  }
+  PerformQuickSort (SortedList, SortedCount, sizeof (MEASUREMENT_RECORD *), DpCompareMeasurementStart);
+
+  //
+  // Handle names are looked up the same way as in the "All" display.
+  //
+  gBS->LocateHandleBuffer (AllHandles, NULL, NULL, &HandleCount, &HandleBuffer);
+
+  if (!FoldedStack) {
+    Status = DpExportPrint (FileHandle, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    if (EFI_ERROR (Status)) {
+      goto Done;
+    }
+  }
+
+  Depth = 0;
+  for (Index = 0; Index < SortedCount; Index++) {
+    Measurement = SortedList[Index];
+
+    //
+    // Close every span that does not fully cover this one.
+    //
+    while ((Depth > 0) &&
+           ((Stack[Depth - 1].Measurement->EndTimeStamp <= Measurement->StartTimeStamp) ||
+            (Stack[Depth - 1].Measurement->EndTimeStamp < Measurement->EndTimeStamp))) {
+      Status = DpExportPopFrame (FileHandle, FoldedStack, Stack, &Depth, EventCount);
+      if (EFI_ERROR (Status)) {
+        goto Done;
+      }
+    }
+
+    DpGetExportName (Measurement, HandleBuffer, HandleCount, Name);
+    PathLength = (Depth > 0) ? Stack[Depth - 1].PathLength : 0;
+    if (PathLength + AsciiStrLen (Name) + 2 > sizeof (mExportPath)) {
+      //
+      // Too deep to name; fold it into its parent.
+      //
+      continue;
+    }
+    if (Depth > 0) {
+      mExportPath[PathLength++] = ';';
+    }
+    AsciiStrCpyS (mExportPath + PathLength, sizeof (mExportPath) - PathLength, Name);
+
+    Stack[Depth].Measurement = Measurement;
+    Stack[Depth].ChildTime   = 0;
+    Stack[Depth].PathLength  = PathLength + AsciiStrLen (Name);
+    Depth++;
+
+    if (ShellGetExecutionBreakFlag ()) {
+      Status = EFI_ABORTED;
+      goto Done;
+    }
+  }
+
+  while (Depth > 0) {
+    Status = DpExportPopFrame (FileHandle, FoldedStack, Stack, &Depth, EventCount);
+    if (EFI_ERROR (Status)) {
+      goto Done;
+    }
+  }
+
+  if (!FoldedStack) {
+    Status = DpExportPrint (FileHandle, "\n]}\n");
+  }
+
+Done:
+  ShellCloseFile (&FileHandle);
+  SHELL_FREE_NON_NULL (HandleBuffer);
+  SHELL_FREE_NON_NULL (SortedList);
+  SHELL_FREE_NON_NULL (Stack);
+
+  return Status;
+}
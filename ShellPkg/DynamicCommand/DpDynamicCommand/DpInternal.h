@@ -4,7 +4,7 @@
   Declarations of data and functions which are private to the Dp application.
   This file should never be referenced by anything other than components of the
   Dp application.  In addition to global data, function declarations for
-  DpUtilities.c, DpTrace.c, and DpProfile.c are included here.
+  DpUtilities.c, DpTrace.c, DpExport.c and DpProfile.c are included here.
 
   Copyright (c) 2009 - 2018, Intel Corporation. All rights reserved.
   (C) Copyright 2015-2016 Hewlett Packard Enterprise Development LP<BR>
@@ -312,4 +312,29 @@ ProcessCumulative(
   IN PERF_CUM_DATA                  *CustomCumulativeData OPTIONAL
   );
 
+/**
+  Export all complete Trace Records as nested timing spans.
+
+  Records are sorted by start time and nested by containment: a record is a
+  child of the innermost earlier record whose time range fully covers it.
+  Each span is written as soon as it is closed, so the whole output is never
+  held in memory.
+
+  @param[in]  FileName      The file to write, e.g. on the ESP.
+  @param[in]  FoldedStack   TRUE to write folded stacks, FALSE for Chrome trace-event JSON.
+  @param[in]  Threshold     Spans shorter than this many microseconds are not written.
+  @param[out] EventCount    The number of spans written.
+
+  @retval EFI_SUCCESS           The trace was written.
+  @retval EFI_OUT_OF_RESOURCES  Memory could not be allocated.
+  @return Others                From opening or writing the file.
+**/
+EFI_STATUS
+DumpTraceExport (
+  IN  CONST CHAR16  *FileName,
+  IN  BOOLEAN       FoldedStack,
+  IN  UINT64        Threshold,
+  OUT UINTN         *EventCount
+  );
+
 #endif
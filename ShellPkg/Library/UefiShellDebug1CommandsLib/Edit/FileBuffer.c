@@ -679,10 +679,12 @@ FileBufferCreateLine (
 
   //
   // initial buffer of the line is "\0"
+  // this is called once per line when a file is read, so allocate the
+  // empty string directly rather than formatting it
   //
-  ASSERT(CHAR_NULL == CHAR_NULL);
-  Line->Buffer = CatSPrint (NULL, L"\0");
+  Line->Buffer = AllocateZeroPool (sizeof (CHAR16));
   if (Line->Buffer == NULL) {
+    FreePool (Line);
     return NULL;
   }
 
@@ -893,8 +895,9 @@ FileBufferRead (
   if (!CreateFile) {
     //
     // allocate buffer to read file
+    // it is fully overwritten by the read, so no need to zero it
     //
-    Buffer = AllocateZeroPool (FileSize);
+    Buffer = AllocatePool (FileSize);
     if (Buffer == NULL) {
       return EFI_OUT_OF_RESOURCES;
     }
@@ -1073,7 +1076,7 @@ FileBufferRead (
       // Unicode and one CHAR_NULL
       //
       SHELL_FREE_NON_NULL (Line->Buffer);
-      Line->Buffer = AllocateZeroPool (LineSize * 2 + 2);
+      Line->Buffer = AllocatePool (LineSize * 2 + 2);
 
       if (Line->Buffer == NULL) {
         RemoveEntryList (&Line->Link);
@@ -1081,16 +1084,17 @@ FileBufferRead (
       }
       //
       // copy this line to Line->Buffer
+      // every character and the terminating CHAR_NULL is written below
       //
-      for (LoopVar2 = 0; LoopVar2 < LineSize; LoopVar2++) {
-        if (FileBuffer.FileType == FileTypeAscii) {
-          Line->Buffer[LoopVar2] = (CHAR16) AsciiBuffer[LoopVar1];
-        } else {
-          Line->Buffer[LoopVar2] = UnicodeBuffer[LoopVar1];
+      if (FileBuffer.FileType == FileTypeAscii) {
+        for (LoopVar2 = 0; LoopVar2 < LineSize; LoopVar2++) {
+          Line->Buffer[LoopVar2] = (CHAR16) AsciiBuffer[LoopVar1 + LoopVar2];
         }
-
-        LoopVar1++;
+      } else {
+        CopyMem (Line->Buffer, &UnicodeBuffer[LoopVar1], LineSize * sizeof (CHAR16));
       }
+
+      LoopVar1 += LineSize;
       //
       // LoopVar1 now points to where CHAR_CARRIAGE_RETURN or CHAR_LINEFEED;
       //
@@ -204,7 +204,7 @@ HDiskImageRead (
   }
 
   Bytes   = BlkIo->Media->BlockSize * Size;
-  Buffer  = AllocateZeroPool (Bytes);
+  Buffer  = AllocatePool (Bytes);
 
   if (Buffer == NULL) {
     StatusBarSetStatusString (L"Read Disk Failed");
@@ -309,6 +309,84 @@ HDiskImageRead (
   return EFI_SUCCESS;
 }
 
+/**
+  Write the blocks of a buffer that differ from the disk.
+
+  The range is read back from the disk, and only the runs of blocks
+  that were modified are written. If the range can not be read back,
+  the whole buffer is written.
+
+  @param[in] BlkIo        The block IO protocol of the disk.
+  @param[in] Offset       The first block of the range.
+  @param[in] Buffer       The new content of the range.
+  @param[in] Bytes        The size of Buffer, a multiple of the block size.
+
+  @retval EFI_SUCCESS     The modified blocks were written.
+  @return                 The error returned by WriteBlocks().
+**/
+STATIC
+EFI_STATUS
+HDiskImageWriteModifiedBlocks (
+  IN EFI_BLOCK_IO_PROTOCOL  *BlkIo,
+  IN UINTN                  Offset,
+  IN UINT8                  *Buffer,
+  IN UINTN                  Bytes
+  )
+{
+  EFI_STATUS  Status;
+  UINT8       *DiskBuffer;
+  UINTN       BlockSize;
+  UINTN       Block;
+  UINTN       FirstBlock;
+  UINTN       NumBlocks;
+
+  BlockSize  = BlkIo->Media->BlockSize;
+  NumBlocks  = Bytes / BlockSize;
+
+  DiskBuffer = AllocatePool (Bytes);
+  if (DiskBuffer == NULL) {
+    return BlkIo->WriteBlocks (BlkIo, BlkIo->Media->MediaId, Offset, Bytes, Buffer);
+  }
+
+  Status = BlkIo->ReadBlocks (BlkIo, BlkIo->Media->MediaId, Offset, Bytes, DiskBuffer);
+  if (EFI_ERROR (Status)) {
+    FreePool (DiskBuffer);
+    return BlkIo->WriteBlocks (BlkIo, BlkIo->Media->MediaId, Offset, Bytes, Buffer);
+  }
+
+  Status = EFI_SUCCESS;
+  Block  = 0;
+  while (Block < NumBlocks && !EFI_ERROR (Status)) {
+    //
+    // skip the unmodified blocks
+    //
+    if (CompareMem (Buffer + Block * BlockSize, DiskBuffer + Block * BlockSize, BlockSize) == 0) {
+      Block++;
+      continue;
+    }
+
+    //
+    // write the run of modified blocks in one request
+    //
+    FirstBlock = Block;
+    do {
+      Block++;
+    } while (Block < NumBlocks &&
+             CompareMem (Buffer + Block * BlockSize, DiskBuffer + Block * BlockSize, BlockSize) != 0);
+
+    Status = BlkIo->WriteBlocks (
+                      BlkIo,
+                      BlkIo->Media->MediaId,
+                      Offset + FirstBlock,
+                      (Block - FirstBlock) * BlockSize,
+                      Buffer + FirstBlock * BlockSize
+                      );
+  }
+
+  FreePool (DiskBuffer);
+  return Status;
+}
+
 /**
   Save lines in HBufferImage to disk.
   NOT ALLOW TO WRITE TO ANOTHER DISK!!!!!!!!!
@@ -387,15 +465,9 @@ HDiskImageSave (
   }
 
   //
-  // write the buffer to disk
+  // write the modified blocks of the buffer to disk
   //
-  Status = BlkIo->WriteBlocks (
-                    BlkIo,
-                    BlkIo->Media->MediaId,
-                    Offset,
-                    Bytes,
-                    Buffer
-                    );
+  Status = HDiskImageWriteModifiedBlocks (BlkIo, Offset, Buffer, Bytes);
 
   FreePool (Buffer);
 
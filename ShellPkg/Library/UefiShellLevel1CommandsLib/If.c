@@ -713,6 +713,7 @@ MoveToTagSpecial (
   CHAR16              *CommandName;
   CHAR16              *CommandWalker;
   CHAR16              *TempLocation;
+  UINTN               Length;
 
   TargetCount         = 1;
   Found               = FALSE;
@@ -726,6 +727,14 @@ MoveToTagSpecial (
     ;  CommandNode = (SCRIPT_COMMAND_LIST *)GetNextNode(&ScriptFile->CommandList, &CommandNode->Link)
    ){
 
+    //
+    // Lines that cannot be "if", "else" or "endif" need not be copied.
+    //
+    Length = GetCommandNameLength (CommandNode->Cl);
+    if (Length != StrLen (L"if") && Length != StrLen (L"else") && Length != StrLen (L"endif")) {
+      continue;
+    }
+
     //
     // get just the first part of the command line...
     //
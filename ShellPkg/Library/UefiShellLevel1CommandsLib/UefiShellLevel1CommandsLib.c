@@ -91,6 +91,32 @@ ShellLevel1CommandsLibDestructor (
   return (EFI_SUCCESS);
 }
 
+/**
+  Get the length of the command name of a script line.
+
+  The command name is the first word of the line, after any leading spaces and
+  tabs, up to the next space.  Comparing its length with the length of a tag
+  lets the tag searches skip most lines without copying them.
+
+  @param[in] CommandLine       The script line.
+
+  @return The number of characters in the command name.
+**/
+UINTN
+GetCommandNameLength (
+  IN CONST CHAR16               *CommandLine
+  )
+{
+  CONST CHAR16  *Walker;
+
+  while ((CommandLine[0] == L' ') || (CommandLine[0] == L'\t')) {
+    CommandLine++;
+  }
+  for (Walker = CommandLine; *Walker != CHAR_NULL && *Walker != L' '; Walker++) {
+  }
+  return (UINTN)(Walker - CommandLine);
+}
+
 /**
   Test a node to see if meets the criterion.
 
@@ -131,9 +157,21 @@ TestNodeForMove (
   CHAR16              *CommandName;
   CHAR16              *CommandNameWalker;
   CHAR16              *TempLocation;
+  UINTN               Length;
 
   Found = FALSE;
 
+  //
+  // A line whose command name has a different length than every tag cannot
+  // match, and leaves the count alone.
+  //
+  Length = GetCommandNameLength (CommandNode->Cl);
+  if (Length != StrLen (IncrementerTag) &&
+      Length != StrLen (DecrementerTag) &&
+      (Label == NULL || Length != StrLen (Label))) {
+    return (FALSE);
+  }
+
   //
   // get just the first part of the command line...
   //
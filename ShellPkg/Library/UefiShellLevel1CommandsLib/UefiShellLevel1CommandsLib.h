@@ -164,6 +164,22 @@ LIST_ENTRY *
   IN CONST LIST_ENTRY *Node
   );
 
+/**
+  Get the length of the command name of a script line.
+
+  The command name is the first word of the line, after any leading spaces and
+  tabs, up to the next space.  Comparing its length with the length of a tag
+  lets the tag searches skip most lines without copying them.
+
+  @param[in] CommandLine       The script line.
+
+  @return The number of characters in the command name.
+**/
+UINTN
+GetCommandNameLength (
+  IN CONST CHAR16               *CommandLine
+  );
+
 /**
   Move the script pointer from 1 tag (line) to another.
 
@@ -37,6 +37,259 @@ ValidateAndCopyFiles(
   IN VOID                       **Resp
   );
 
+/**
+  Wait for an asynchronous file I/O request to complete.
+
+  @param[in] Token    The token of the request.
+
+  @return The completion status of the request.
+**/
+STATIC
+EFI_STATUS
+CopyWaitForToken (
+  IN EFI_FILE_IO_TOKEN  *Token
+  )
+{
+  EFI_STATUS  Status;
+  UINTN       Index;
+
+  Status = gBS->WaitForEvent (1, &Token->Event, &Index);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+  return Token->Status;
+}
+
+/**
+  Copy the contents of one open file to another with overlapped reads and
+  writes.
+
+  Two buffers are used: while one buffer is being written to the destination,
+  the next block of the source is read into the other.  Both files must
+  support EFI_FILE_PROTOCOL.ReadEx() and WriteEx().  File systems without
+  asynchronous support may complete each request before returning, in which
+  case the copy simply runs sequentially.
+
+  @param[in] SourceFile   The source file, positioned at its start.
+  @param[in] DestFile     The destination file, positioned at its start.
+  @param[in] Buffers      Two buffers of BufferSize bytes each.
+  @param[in] BufferSize   The size of each buffer.
+  @param[out] ReadFailed  TRUE if the error came from the source file.
+
+  @retval EFI_SUCCESS       The file was copied.
+  @retval EFI_UNSUPPORTED   The first read could not be started asynchronously;
+                            no data has been transferred.
+  @retval other             The copy failed.
+**/
+STATIC
+EFI_STATUS
+CopyFileDataAsync (
+  IN  EFI_FILE_PROTOCOL  *SourceFile,
+  IN  EFI_FILE_PROTOCOL  *DestFile,
+  IN  UINT8              *Buffers[2],
+  IN  UINTN              BufferSize,
+  OUT BOOLEAN            *ReadFailed
+  )
+{
+  EFI_STATUS         Status;
+  EFI_STATUS         WriteStatus;
+  EFI_FILE_IO_TOKEN  ReadToken;
+  EFI_FILE_IO_TOKEN  WriteToken;
+  BOOLEAN            ReadPending;
+  BOOLEAN            WritePending;
+  BOOLEAN            Started;
+  UINTN              Current;
+
+  ZeroMem (&ReadToken, sizeof (ReadToken));
+  ZeroMem (&WriteToken, sizeof (WriteToken));
+  ReadPending  = FALSE;
+  WritePending = FALSE;
+  Started      = FALSE;
+  Current      = 0;
+  *ReadFailed  = FALSE;
+
+  Status = gBS->CreateEvent (0, TPL_CALLBACK, NULL, NULL, &ReadToken.Event);
+  if (EFI_ERROR (Status)) {
+    return EFI_UNSUPPORTED;
+  }
+  Status = gBS->CreateEvent (0, TPL_CALLBACK, NULL, NULL, &WriteToken.Event);
+  if (EFI_ERROR (Status)) {
+    gBS->CloseEvent (ReadToken.Event);
+    return EFI_UNSUPPORTED;
+  }
+
+  ReadToken.Buffer     = Buffers[Current];
+  ReadToken.BufferSize = BufferSize;
+  Status = SourceFile->ReadEx (SourceFile, &ReadToken);
+  if (EFI_ERROR (Status)) {
+    Status = EFI_UNSUPPORTED;
+    goto Done;
+  }
+  ReadPending = TRUE;
+
+  for (;;) {
+    //
+    // Wait for the block in Buffers[Current].
+    //
+    Status      = CopyWaitForToken (&ReadToken);
+    ReadPending = FALSE;
+    if (EFI_ERROR (Status)) {
+      *ReadFailed = TRUE;
+      break;
+    }
+    Started = TRUE;
+
+    //
+    // The previous write used the other buffer; it must be finished before
+    // that buffer is read into again.
+    //
+    if (WritePending) {
+      Status       = CopyWaitForToken (&WriteToken);
+      WritePending = FALSE;
+      if (EFI_ERROR (Status)) {
+        break;
+      }
+    }
+
+    if (ReadToken.BufferSize == 0) {
+      break;
+    }
+
+    WriteToken.Buffer     = Buffers[Current];
+    WriteToken.BufferSize = ReadToken.BufferSize;
+    Status = DestFile->WriteEx (DestFile, &WriteToken);
+    if (EFI_ERROR (Status)) {
+      break;
+    }
+    WritePending = TRUE;
+
+    if (ReadToken.BufferSize < BufferSize) {
+      //
+      // That was the end of the source file.
+      //
+      break;
+    }
+
+    Current              = 1 - Current;
+    ReadToken.Buffer     = Buffers[Current];
+    ReadToken.BufferSize = BufferSize;
+    Status = SourceFile->ReadEx (SourceFile, &ReadToken);
+    if (EFI_ERROR (Status)) {
+      *ReadFailed = TRUE;
+      break;
+    }
+    ReadPending = TRUE;
+  }
+
+Done:
+  //
+  // Never release the buffers or events while a request may still use them.
+  //
+  if (ReadPending) {
+    CopyWaitForToken (&ReadToken);
+  }
+  if (WritePending) {
+    WriteStatus = CopyWaitForToken (&WriteToken);
+    if (!EFI_ERROR (Status) && EFI_ERROR (WriteStatus)) {
+      Status = WriteStatus;
+    }
+  }
+  gBS->CloseEvent (ReadToken.Event);
+  gBS->CloseEvent (WriteToken.Event);
+
+  if (Status == EFI_UNSUPPORTED && Started) {
+    //
+    // Data has already been transferred, so this cannot be retried
+    // synchronously.
+    //
+    Status = EFI_DEVICE_ERROR;
+  }
+  return Status;
+}
+
+/**
+  Copy the contents of one open file to another.
+
+  The copy is double-buffered with ReadEx()/WriteEx() when both files support
+  revision 2 of EFI_FILE_PROTOCOL, and falls back to ShellReadFile() and
+  ShellWriteFile() otherwise.  The buffers are page aligned and hold
+  PcdShellFileOperationSize bytes, rounded up to whole pages.
+
+  @param[in] SourceHandle   The source file, positioned at its start.
+  @param[in] DestHandle     The destination file, positioned at its start.
+  @param[in] Source         The source file name, for error messages.
+  @param[in] Dest           The destination file name, for error messages.
+  @param[in] CmdName        The command name, for error messages.
+
+  @retval SHELL_SUCCESS   The source file was copied to the destination.
+  @retval other           The copy failed; an error message has been printed.
+**/
+STATIC
+SHELL_STATUS
+CopyFileData (
+  IN SHELL_FILE_HANDLE  SourceHandle,
+  IN SHELL_FILE_HANDLE  DestHandle,
+  IN CONST CHAR16       *Source,
+  IN CONST CHAR16       *Dest,
+  IN CONST CHAR16       *CmdName
+  )
+{
+  EFI_STATUS         Status;
+  EFI_FILE_PROTOCOL  *SourceFile;
+  EFI_FILE_PROTOCOL  *DestFile;
+  UINT8              *Buffers[2];
+  UINTN              Pages;
+  UINTN              BufferSize;
+  UINTN              ReadSize;
+  BOOLEAN            ReadFailed;
+
+  Pages      = EFI_SIZE_TO_PAGES (PcdGet32 (PcdShellFileOperationSize));
+  BufferSize = EFI_PAGES_TO_SIZE (Pages);
+  Buffers[0] = AllocatePages (Pages * 2);
+  if (Buffers[0] == NULL) {
+    ShellPrintHiiEx (-1, -1, NULL, STRING_TOKEN (STR_GEN_OUT_MEM), gShellLevel2HiiHandle, CmdName);
+    return SHELL_OUT_OF_RESOURCES;
+  }
+  Buffers[1] = Buffers[0] + BufferSize;
+
+  ReadFailed = FALSE;
+  Status     = EFI_UNSUPPORTED;
+  SourceFile = ConvertShellHandleToEfiFileProtocol (SourceHandle);
+  DestFile   = ConvertShellHandleToEfiFileProtocol (DestHandle);
+  if (SourceFile != NULL && SourceFile->Revision >= EFI_FILE_PROTOCOL_REVISION2 &&
+      DestFile != NULL && DestFile->Revision >= EFI_FILE_PROTOCOL_REVISION2) {
+    Status = CopyFileDataAsync (SourceFile, DestFile, Buffers, BufferSize, &ReadFailed);
+  }
+
+  if (Status == EFI_UNSUPPORTED) {
+    ReadSize = BufferSize;
+    Status   = EFI_SUCCESS;
+    while (ReadSize == BufferSize) {
+      Status = ShellReadFile (SourceHandle, &ReadSize, Buffers[0]);
+      if (EFI_ERROR (Status)) {
+        ReadFailed = TRUE;
+        break;
+      }
+      Status = ShellWriteFile (DestHandle, &ReadSize, Buffers[0]);
+      if (EFI_ERROR (Status)) {
+        break;
+      }
+    }
+  }
+
+  FreePages (Buffers[0], Pages * 2);
+
+  if (EFI_ERROR (Status)) {
+    if (ReadFailed) {
+      ShellPrintHiiEx (-1, -1, NULL, STRING_TOKEN (STR_GEN_CPY_READ_ERROR), gShellLevel2HiiHandle, CmdName, Source);
+    } else {
+      ShellPrintHiiEx (-1, -1, NULL, STRING_TOKEN (STR_GEN_CPY_WRITE_ERROR), gShellLevel2HiiHandle, CmdName, Dest);
+    }
+    return (SHELL_STATUS) (Status & (~MAX_BIT));
+  }
+  return SHELL_SUCCESS;
+}
+
 /**
   Function to Copy one file to another location
 
@@ -60,11 +313,9 @@ CopySingleFile(
   )
 {
   VOID                  *Response;
-  UINTN                 ReadSize;
   SHELL_FILE_HANDLE     SourceHandle;
   SHELL_FILE_HANDLE     DestHandle;
   EFI_STATUS            Status;
-  VOID                  *Buffer;
   CHAR16                *TempName;
   UINTN                 Size;
   EFI_SHELL_FILE_INFO   *List;
@@ -84,7 +335,6 @@ CopySingleFile(
   DestVolumeInfo  = NULL;
   ShellStatus     = SHELL_SUCCESS;
 
-  ReadSize = PcdGet32(PcdShellFileOperationSize);
   // Why bother copying a file to itself
   if (StrCmp(Source, Dest) == 0) {
     return (SHELL_SUCCESS);
@@ -141,7 +391,7 @@ CopySingleFile(
     StrnCatGrow(&TempName, &Size, Source, 0);
     StrnCatGrow(&TempName, &Size, L"\\*", 0);
     if (TempName != NULL) {
-      ShellOpenFileMetaArg((CHAR16*)TempName, EFI_FILE_MODE_READ, &List);
+      ShellLevel2FindFilesMetaArg(TempName, &List);
       *TempName = CHAR_NULL;
       StrnCatGrow(&TempName, &Size, Dest, 0);
       StrnCatGrow(&TempName, &Size, L"\\", 0);
@@ -223,26 +473,7 @@ CopySingleFile(
       //
       // copy data between files
       //
-      Buffer = AllocateZeroPool(ReadSize);
-      if (Buffer == NULL) {
-        ShellPrintHiiEx (-1, -1, NULL, STRING_TOKEN (STR_GEN_OUT_MEM), gShellLevel2HiiHandle, CmdName);
-        return SHELL_OUT_OF_RESOURCES;
-      }
-      while (ReadSize == PcdGet32(PcdShellFileOperationSize) && !EFI_ERROR(Status)) {
-        Status = ShellReadFile(SourceHandle, &ReadSize, Buffer);
-        if (!EFI_ERROR(Status)) {
-          Status = ShellWriteFile(DestHandle, &ReadSize, Buffer);
-          if (EFI_ERROR(Status)) {
-            ShellStatus = (SHELL_STATUS) (Status & (~MAX_BIT));
-            ShellPrintHiiEx(-1, -1, NULL, STRING_TOKEN (STR_GEN_CPY_WRITE_ERROR), gShellLevel2HiiHandle, CmdName, Dest);
-            break;
-          }
-        } else {
-          ShellStatus = (SHELL_STATUS) (Status & (~MAX_BIT));
-          ShellPrintHiiEx(-1, -1, NULL, STRING_TOKEN (STR_GEN_CPY_READ_ERROR), gShellLevel2HiiHandle, CmdName, Source);
-          break;
-        }
-      }
+      ShellStatus = CopyFileData (SourceHandle, DestHandle, Source, Dest, CmdName);
     }
     SHELL_FREE_NON_NULL(DestVolumeInfo);
   }
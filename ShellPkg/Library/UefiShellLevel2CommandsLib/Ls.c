@@ -478,7 +478,10 @@ PrintLsOutput(
 
   PathCleanUpDirectories(CorrectedPath);
 
-  Status = ShellOpenFileMetaArg((CHAR16*)CorrectedPath, EFI_FILE_MODE_READ, &ListHead);
+  //
+  // Only the file information is printed, so do not open every file.
+  //
+  Status = ShellLevel2FindFilesMetaArg(CorrectedPath, &ListHead);
   if (!EFI_ERROR(Status)) {
     if (ListHead == NULL || IsListEmpty(&ListHead->Link)) {
       SHELL_FREE_NON_NULL(CorrectedPath);
@@ -592,7 +595,7 @@ PrintLsOutput(
       CorrectedPath = StrnCatGrow(&CorrectedPath, &LongestPath, L"\\",     0);
     }
     CorrectedPath = StrnCatGrow(&CorrectedPath, &LongestPath, L"*",     0);
-    Status = ShellOpenFileMetaArg((CHAR16*)CorrectedPath, EFI_FILE_MODE_READ, &ListHead);
+    Status = ShellLevel2FindFilesMetaArg(CorrectedPath, &ListHead);
 
     if (!EFI_ERROR(Status)) {
       for ( Node = (EFI_SHELL_FILE_INFO *)GetFirstNode(&ListHead->Link)
@@ -341,4 +341,83 @@ ShellLevel2StripQuotes (
   return EFI_SUCCESS;
 }
 
+/**
+  Find the files that match a path, without opening them.
+
+  This returns the same list as ShellOpenFileMetaArg(), including the
+  EFI_FILE_INFO of every match, but leaves the Handle of each entry NULL.
+  Listing a directory this way costs one directory read per entry instead of
+  a full path resolution and open per entry, which matters on large
+  directories.
+
+  @param[in] Arg            The path, which may contain wildcards and quotes.
+  @param[in, out] ListHead  On input, NULL or an existing list to append to.
+                            On output, the list of matching files.  Free it
+                            with ShellCloseFileMetaArg().
+
+  @retval EFI_SUCCESS       At least one file was found.
+  @retval EFI_NOT_FOUND     No file matched; *ListHead is NULL if it was NULL
+                            on input.
+  @return other             The search failed.
+**/
+EFI_STATUS
+ShellLevel2FindFilesMetaArg (
+  IN CONST CHAR16             *Arg,
+  IN OUT EFI_SHELL_FILE_INFO  **ListHead
+  )
+{
+  EFI_STATUS    Status;
+  CHAR16        *CleanFilePathStr;
+  CHAR16        *Path;
+  CHAR16        *Walker;
+  UINTN         Size;
+
+  Status = ShellLevel2StripQuotes (Arg, &CleanFilePathStr);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  //
+  // EFI_SHELL_PROTOCOL.FindFiles() requires a path that starts with a map.
+  //
+  Path   = NULL;
+  Size   = 0;
+  Walker = CleanFilePathStr;
+  if (StrStr (Walker, L":") == NULL) {
+    if (*Walker == L'.' && *(Walker + 1) == L'\\') {
+      Walker += 2;
+    }
+    StrnCatGrow (&Path, &Size, gEfiShellProtocol->GetCurDir (NULL), 0);
+    StrnCatGrow (&Path, &Size, L"\\", 0);
+    if (*Walker == L'\\' && Path != NULL) {
+      Walker++;
+      while (PathRemoveLastItem (Path)) ;
+    }
+  }
+  StrnCatGrow (&Path, &Size, Walker, 0);
+  FreePool (CleanFilePathStr);
+  if (Path == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+  PathCleanUpDirectories (Path);
+
+  Status = gEfiShellProtocol->FindFiles (Path, ListHead);
+  FreePool (Path);
+
+  if (*ListHead != NULL) {
+    if (!EFI_ERROR (Status)) {
+      Status = gEfiShellProtocol->RemoveDupInFileList (ListHead);
+    }
+    if (IsListEmpty (&(*ListHead)->Link)) {
+      FreePool (*ListHead);
+      *ListHead = NULL;
+      Status    = EFI_NOT_FOUND;
+    }
+  } else if (!EFI_ERROR (Status)) {
+    Status = EFI_NOT_FOUND;
+  }
+
+  return Status;
+}
+
 
@@ -307,6 +307,25 @@ ShellLevel2StripQuotes (
   OUT CHAR16           **CleanString
   );
 
+/**
+  Find the files that match a path, without opening them.
+
+  @param[in] Arg            The path, which may contain wildcards and quotes.
+  @param[in, out] ListHead  On input, NULL or an existing list to append to.
+                            On output, the list of matching files, with a
+                            NULL Handle in every entry.  Free it with
+                            ShellCloseFileMetaArg().
+
+  @retval EFI_SUCCESS       At least one file was found.
+  @retval EFI_NOT_FOUND     No file matched.
+  @return other             The search failed.
+**/
+EFI_STATUS
+ShellLevel2FindFilesMetaArg (
+  IN CONST CHAR16             *Arg,
+  IN OUT EFI_SHELL_FILE_INFO  **ListHead
+  );
+
 /**
   Function for 'Vol' command.
 
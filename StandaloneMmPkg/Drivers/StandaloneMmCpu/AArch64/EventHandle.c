@@ -161,10 +161,18 @@ PiMmStandaloneArmTfCpuDriverEntry (
 
   mMmEntryPoint (&MmEntryPointContext);
 
-  // Free the memory allocation done earlier and reset the per-cpu context
+  // Copy the response back to the normal world. A handler that replies with
+  // less data than it received reports so through MessageLength, in which
+  // case there is no need to copy the rest of a large request back.
   ASSERT (GuidedEventContext);
+  if (GuidedEventContext->MessageLength <
+      NsCommBufferSize - sizeof (EFI_MM_COMMUNICATE_HEADER)) {
+    NsCommBufferSize = GuidedEventContext->MessageLength +
+      sizeof (EFI_MM_COMMUNICATE_HEADER);
+  }
   CopyMem ((VOID *)NsCommBufferAddr, (CONST VOID *) GuidedEventContext, NsCommBufferSize);
 
+  // Free the memory allocation done earlier and reset the per-cpu context
   Status = mMmst->MmFreePool ((VOID *) GuidedEventContext);
   if (Status != EFI_SUCCESS) {
     return EFI_OUT_OF_RESOURCES;
@@ -384,6 +384,7 @@ CpuSetMemoryAttributes (
   EFI_STATUS                MpStatus;
   EFI_MP_SERVICES_PROTOCOL  *MpService;
   MTRR_SETTINGS             MtrrSettings;
+  MTRR_SETTINGS             OriginalMtrrSettings;
   UINT64                    CacheAttributes;
   UINT64                    MemoryAttributes;
   MTRR_MEMORY_CACHE_TYPE    CurrentCacheType;
@@ -453,15 +454,25 @@ CpuSetMemoryAttributes (
     CurrentCacheType = MtrrGetMemoryAttribute(BaseAddress);
     if (CurrentCacheType != CacheType) {
       //
-      // call MTRR library function
+      // Calculate the new MTRR settings once, in a buffer, and then program
+      // the BSP and all APs from that buffer. Every processor disables its
+      // cache only once, and nothing is programmed if the calculation does
+      // not change the MTRRs.
       //
-      Status = MtrrSetMemoryAttribute (
+      ZeroMem (&OriginalMtrrSettings, sizeof (OriginalMtrrSettings));
+      MtrrGetAllMtrrs (&OriginalMtrrSettings);
+      CopyMem (&MtrrSettings, &OriginalMtrrSettings, sizeof (MtrrSettings));
+      Status = MtrrSetMemoryAttributeInMtrrSettings (
+                 &MtrrSettings,
                  BaseAddress,
                  Length,
                  CacheType
                  );
 
-      if (!RETURN_ERROR (Status)) {
+      if (!RETURN_ERROR (Status) &&
+          CompareMem (&MtrrSettings, &OriginalMtrrSettings, sizeof (MtrrSettings)) != 0) {
+        MtrrSetAllMtrrs (&MtrrSettings);
+
         MpStatus = gBS->LocateProtocol (
                           &gEfiMpServiceProtocolGuid,
                           NULL,
@@ -471,7 +482,6 @@ CpuSetMemoryAttributes (
         // Synchronize the update with all APs
         //
         if (!EFI_ERROR (MpStatus)) {
-          MtrrGetAllMtrrs (&MtrrSettings);
           MpStatus = MpService->StartupAllAPs (
                                   MpService,          // This
                                   SetMtrrsFromBuffer, // Procedure
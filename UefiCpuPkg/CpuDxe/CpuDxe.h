@@ -36,6 +36,7 @@
 #include <Library/MpInitLib.h>
 #include <Library/TimerLib.h>
 
+#include <Guid/EventGroup.h>
 #include <Guid/IdleLoopEvent.h>
 #include <Guid/VectorHandoffTable.h>
 
@@ -87,6 +87,11 @@ PAGE_ATTRIBUTE_TABLE mPageAttributeTable[] = {
 
 PAGE_TABLE_POOL                   *mPageTablePool = NULL;
 BOOLEAN                           mPageTablePoolLock = FALSE;
+//
+// Pages of page tables freed by merging them back into large pages, linked
+// through their first entry, for AllocatePageTableMemory() to reuse.
+//
+VOID                              *mPageTableFreeList = NULL;
 PAGE_TABLE_LIB_PAGING_CONTEXT     mPagingContext;
 EFI_SMM_BASE2_PROTOCOL            *mSmmBase2 = NULL;
 
@@ -353,6 +358,74 @@ GetPageTableEntry (
   return &L1PageTable[Index1];
 }
 
+/**
+  Return the page directory entry, or the page directory pointer table entry,
+  that maps or points to the page table of the 2M or 1G region containing the
+  address.
+
+  @param[in]  PagingContext     The paging context.
+  @param[in]  Address           The address to be checked.
+  @param[in]  PageAttribute     Page2M for the page directory entry, Page1G
+                                for the page directory pointer table entry.
+
+  @return The entry, or NULL if the region is not mapped at that level.
+**/
+UINT64 *
+GetPageDirectoryEntry (
+  IN  PAGE_TABLE_LIB_PAGING_CONTEXT     *PagingContext,
+  IN  PHYSICAL_ADDRESS                  Address,
+  IN  PAGE_ATTRIBUTE                    PageAttribute
+  )
+{
+  UINTN                 Index2;
+  UINTN                 Index3;
+  UINTN                 Index4;
+  UINTN                 Index5;
+  UINT64                *L2PageTable;
+  UINT64                *L3PageTable;
+  UINT64                *L4PageTable;
+  UINT64                *L5PageTable;
+  UINT64                AddressEncMask;
+
+  ASSERT (PageAttribute == Page2M || PageAttribute == Page1G);
+
+  Index5 = ((UINTN)RShiftU64 (Address, 48)) & PAGING_PAE_INDEX_MASK;
+  Index4 = ((UINTN)RShiftU64 (Address, 39)) & PAGING_PAE_INDEX_MASK;
+  Index3 = ((UINTN)Address >> 30) & PAGING_PAE_INDEX_MASK;
+  Index2 = ((UINTN)Address >> 21) & PAGING_PAE_INDEX_MASK;
+
+  AddressEncMask = PcdGet64 (PcdPteMemoryEncryptionAddressOrMask) & PAGING_1G_ADDRESS_MASK_64;
+
+  if (PagingContext->MachineType == IMAGE_FILE_MACHINE_X64) {
+    if ((PagingContext->ContextData.X64.Attributes & PAGE_TABLE_LIB_PAGING_CONTEXT_IA32_X64_ATTRIBUTES_5_LEVEL) != 0) {
+      L5PageTable = (UINT64 *)(UINTN)PagingContext->ContextData.X64.PageTableBase;
+      if (L5PageTable[Index5] == 0) {
+        return NULL;
+      }
+
+      L4PageTable = (UINT64 *)(UINTN)(L5PageTable[Index5] & ~AddressEncMask & PAGING_4K_ADDRESS_MASK_64);
+    } else {
+      L4PageTable = (UINT64 *)(UINTN)PagingContext->ContextData.X64.PageTableBase;
+    }
+    if (L4PageTable[Index4] == 0) {
+      return NULL;
+    }
+
+    L3PageTable = (UINT64 *)(UINTN)(L4PageTable[Index4] & ~AddressEncMask & PAGING_4K_ADDRESS_MASK_64);
+  } else {
+    L3PageTable = (UINT64 *)(UINTN)PagingContext->ContextData.Ia32.PageTableBase;
+  }
+  if (PageAttribute == Page1G) {
+    return &L3PageTable[Index3];
+  }
+  if ((L3PageTable[Index3] == 0) || ((L3PageTable[Index3] & IA32_PG_PS) != 0)) {
+    return NULL;
+  }
+
+  L2PageTable = (UINT64 *)(UINTN)(L3PageTable[Index3] & ~AddressEncMask & PAGING_4K_ADDRESS_MASK_64);
+  return &L2PageTable[Index2];
+}
+
 /**
   Return memory attributes of page entry.
 
@@ -590,6 +663,296 @@ SplitPage (
   }
 }
 
+/**
+  This function merges the page table an entry points to back into one large
+  page, if all the entries of the table are present leaf entries mapping
+  contiguous memory with the same attributes. It is the reverse of SplitPage().
+
+  The entry must belong to the page table of the current CPU context. The TLB
+  is flushed before the page of the merged table is given away.
+
+  @param[in]  PageEntry         The page entry pointing to the page table.
+  @param[in]  PageAttribute     The page attribute the merged entry maps as,
+                                Page2M or Page1G.
+
+  @retval TRUE    The page table is merged into a large page.
+  @retval FALSE   The page table cannot be merged.
+**/
+BOOLEAN
+MergePage (
+  IN  UINT64                            *PageEntry,
+  IN  PAGE_ATTRIBUTE                    PageAttribute
+  )
+{
+  UINT64   AddressEncMask;
+  UINT64   *PageTable;
+  UINT64   ChildLength;
+  UINT64   ChildAddressMask;
+  UINT64   BaseAddress;
+  UINT64   Attributes;
+  UINT64   NewPageEntry;
+  UINTN    Index;
+
+  ASSERT (PageAttribute == Page2M || PageAttribute == Page1G);
+
+  if (((*PageEntry & IA32_PG_P) == 0) || ((*PageEntry & IA32_PG_PS) != 0)) {
+    return FALSE;
+  }
+
+  AddressEncMask = PcdGet64 (PcdPteMemoryEncryptionAddressOrMask) & PAGING_1G_ADDRESS_MASK_64;
+  PageTable      = (UINT64 *)(UINTN)(*PageEntry & ~AddressEncMask & PAGING_4K_ADDRESS_MASK_64);
+
+  if (PageAttribute == Page2M) {
+    ChildLength      = SIZE_4KB;
+    ChildAddressMask = PAGING_4K_ADDRESS_MASK_64;
+  } else {
+    //
+    // A table of 4K entries has to be merged into 2M pages first.
+    //
+    if ((PageTable[0] & IA32_PG_PS) == 0) {
+      return FALSE;
+    }
+    ChildLength      = SIZE_2MB;
+    ChildAddressMask = PAGING_2M_ADDRESS_MASK_64;
+  }
+
+  if ((PageTable[0] & IA32_PG_P) == 0) {
+    return FALSE;
+  }
+  BaseAddress = PageTable[0] & ~AddressEncMask & ChildAddressMask;
+  Attributes  = PageTable[0] & ~AddressEncMask & ~ChildAddressMask;
+  if ((BaseAddress & (PageAttributeToLength (PageAttribute) - 1)) != 0) {
+    return FALSE;
+  }
+
+  for (Index = 1; Index < SIZE_4KB / sizeof(UINT64); Index++) {
+    if (((PageTable[Index] & ~AddressEncMask & ChildAddressMask) != BaseAddress + ChildLength * Index) ||
+        ((PageTable[Index] & ~AddressEncMask & ~ChildAddressMask) != Attributes)) {
+      return FALSE;
+    }
+  }
+
+  if (PageAttribute == Page2M) {
+    //
+    // The PAT bit of a 4K entry is where the PS bit of a 2M entry is.
+    //
+    NewPageEntry = BaseAddress | AddressEncMask | IA32_PG_PS | (Attributes & ~IA32_PG_PAT_4K);
+    if ((Attributes & IA32_PG_PAT_4K) != 0) {
+      NewPageEntry |= IA32_PG_PAT_2M;
+    }
+  } else {
+    NewPageEntry = BaseAddress | AddressEncMask | Attributes;
+  }
+
+  DEBUG ((DEBUG_VERBOSE, "Merge - 0x%x\n", PageTable));
+  *PageEntry = NewPageEntry;
+
+  //
+  // The processor may still walk the old page table until the TLB is flushed.
+  //
+  CpuFlushTlb ();
+
+  *(VOID **)PageTable = mPageTableFreeList;
+  mPageTableFreeList  = PageTable;
+
+  return TRUE;
+}
+
+/**
+  This function merges the page tables that map a memory region back into
+  2M and 1G pages wherever possible.
+
+  @param[in]  PagingContext     The paging context of the current CPU context.
+  @param[in]  BaseAddress       The physical address that is the start address of a memory region.
+  @param[in]  Length            The size in bytes of the memory region.
+
+  @retval TRUE    At least one page table is merged.
+  @retval FALSE   No page table is merged.
+**/
+BOOLEAN
+MergePagesInRange (
+  IN  PAGE_TABLE_LIB_PAGING_CONTEXT     *PagingContext,
+  IN  PHYSICAL_ADDRESS                  BaseAddress,
+  IN  UINT64                            Length
+  )
+{
+  PHYSICAL_ADDRESS      Address;
+  UINT64                *PageEntry;
+  BOOLEAN               IsMerged;
+
+  IsMerged = FALSE;
+
+  for (Address = BaseAddress & ~(UINT64)PAGING_2M_MASK;
+       Address < BaseAddress + Length;
+       Address += SIZE_2MB) {
+    PageEntry = GetPageDirectoryEntry (PagingContext, Address, Page2M);
+    if ((PageEntry != NULL) && MergePage (PageEntry, Page2M)) {
+      IsMerged = TRUE;
+    }
+  }
+
+  //
+  // Only 64-bit paging can map 1G pages.
+  //
+  if ((PagingContext->MachineType == IMAGE_FILE_MACHINE_X64) &&
+      ((PagingContext->ContextData.X64.Attributes & PAGE_TABLE_LIB_PAGING_CONTEXT_IA32_X64_ATTRIBUTES_PAGE_1G_SUPPORT) != 0)) {
+    for (Address = BaseAddress & ~(UINT64)PAGING_1G_MASK;
+         Address < BaseAddress + Length;
+         Address += SIZE_1GB) {
+      PageEntry = GetPageDirectoryEntry (PagingContext, Address, Page1G);
+      if ((PageEntry != NULL) && MergePage (PageEntry, Page1G)) {
+        IsMerged = TRUE;
+      }
+    }
+  }
+
+  return IsMerged;
+}
+
+/**
+  Count the page tables and the leaf entries of each page size below a page
+  table.
+
+  @param[in]      PageTable     The page table.
+  @param[in]      EntryCount    The number of entries in the page table.
+  @param[in]      Level         The paging level of the page table, 1 for a
+                                page table of 4K entries.
+  @param[in]      Is1GSupported TRUE if entries at level 3 can be 1G pages.
+  @param[in, out] Statistics    Number of page table pages, then number of 4K,
+                                2M and 1G pages.
+**/
+VOID
+CountPageTable (
+  IN     UINT64                         *PageTable,
+  IN     UINTN                          EntryCount,
+  IN     UINTN                          Level,
+  IN     BOOLEAN                        Is1GSupported,
+  IN OUT UINTN                          Statistics[4]
+  )
+{
+  UINT64                AddressEncMask;
+  UINTN                 Index;
+
+  AddressEncMask = PcdGet64 (PcdPteMemoryEncryptionAddressOrMask) & PAGING_1G_ADDRESS_MASK_64;
+
+  Statistics[0]++;
+  for (Index = 0; Index < EntryCount; Index++) {
+    if ((PageTable[Index] & IA32_PG_P) == 0) {
+      continue;
+    }
+    if (Level == 1) {
+      Statistics[1]++;
+    } else if ((Level == 2) && ((PageTable[Index] & IA32_PG_PS) != 0)) {
+      Statistics[2]++;
+    } else if ((Level == 3) && Is1GSupported && ((PageTable[Index] & IA32_PG_PS) != 0)) {
+      Statistics[3]++;
+    } else {
+      CountPageTable (
+        (UINT64 *)(UINTN)(PageTable[Index] & ~AddressEncMask & PAGING_4K_ADDRESS_MASK_64),
+        SIZE_4KB / sizeof(UINT64),
+        Level - 1,
+        Is1GSupported,
+        Statistics
+        );
+    }
+  }
+}
+
+/**
+  Dump the size of the page tables of the current CPU context, and how many
+  pages of each size they map.
+**/
+VOID
+DumpPageTableStatistics (
+  VOID
+  )
+{
+  PAGE_TABLE_LIB_PAGING_CONTEXT     PagingContext;
+  UINTN                             Statistics[4];
+
+  GetCurrentPagingContext (&PagingContext);
+
+  ZeroMem (Statistics, sizeof (Statistics));
+  if (PagingContext.MachineType == IMAGE_FILE_MACHINE_X64) {
+    if (PagingContext.ContextData.X64.PageTableBase == 0) {
+      return;
+    }
+    CountPageTable (
+      (UINT64 *)(UINTN)PagingContext.ContextData.X64.PageTableBase,
+      SIZE_4KB / sizeof(UINT64),
+      ((PagingContext.ContextData.X64.Attributes & PAGE_TABLE_LIB_PAGING_CONTEXT_IA32_X64_ATTRIBUTES_5_LEVEL) != 0) ? 5 : 4,
+      (PagingContext.ContextData.X64.Attributes & PAGE_TABLE_LIB_PAGING_CONTEXT_IA32_X64_ATTRIBUTES_PAGE_1G_SUPPORT) != 0,
+      Statistics
+      );
+  } else {
+    if ((PagingContext.ContextData.Ia32.PageTableBase == 0) ||
+        ((PagingContext.ContextData.Ia32.Attributes & PAGE_TABLE_LIB_PAGING_CONTEXT_IA32_X64_ATTRIBUTES_PAE) == 0)) {
+      return;
+    }
+    //
+    // The PAE page directory pointer table has 4 entries.
+    //
+    CountPageTable (
+      (UINT64 *)(UINTN)PagingContext.ContextData.Ia32.PageTableBase,
+      4,
+      3,
+      FALSE,
+      Statistics
+      );
+  }
+
+  DEBUG ((
+    DEBUG_INFO,
+    "Paging: %lu page table pages, %lu 4K pages, %lu 2M pages, %lu 1G pages\n",
+    (UINT64)Statistics[0],
+    (UINT64)Statistics[1],
+    (UINT64)Statistics[2],
+    (UINT64)Statistics[3]
+    ));
+}
+
+/**
+  Notification function of EndOfDxe event group, to dump the page table
+  statistics once the memory protection of all the images is in place.
+
+  @param[in]  Event     Event whose notification function is being invoked.
+  @param[in]  Context   Pointer to the notification function's context.
+**/
+VOID
+EFIAPI
+PageTableStatisticsOnEndOfDxe (
+  IN EFI_EVENT                          Event,
+  IN VOID                               *Context
+  )
+{
+  gBS->CloseEvent (Event);
+  DumpPageTableStatistics ();
+}
+
+/**
+  Dump the page table statistics now, and again at EndOfDxe.
+**/
+VOID
+InitializePageTableStatistics (
+  VOID
+  )
+{
+  EFI_STATUS                        Status;
+  EFI_EVENT                         Event;
+
+  DumpPageTableStatistics ();
+
+  Status = gBS->CreateEventEx (
+                  EVT_NOTIFY_SIGNAL,
+                  TPL_CALLBACK,
+                  PageTableStatisticsOnEndOfDxe,
+                  NULL,
+                  &gEfiEndOfDxeEventGroupGuid,
+                  &Event
+                  );
+  ASSERT_EFI_ERROR (Status);
+}
+
 /**
  Check the WP status in CR0 register. This bit is used to lock or unlock write
  access to pages marked as read-only.
@@ -703,6 +1066,8 @@ ConvertMemoryPageAttributes (
   RETURN_STATUS                     Status;
   BOOLEAN                           IsEntryModified;
   BOOLEAN                           IsWpEnabled;
+  PHYSICAL_ADDRESS                  OriginalBaseAddress;
+  UINT64                            OriginalLength;
 
   if ((BaseAddress & (SIZE_4KB - 1)) != 0) {
     DEBUG ((DEBUG_ERROR, "BaseAddress(0x%lx) is not aligned!\n", BaseAddress));
@@ -767,6 +1132,9 @@ ConvertMemoryPageAttributes (
     AllocatePagesFunc = AllocatePageTableMemory;
   }
 
+  OriginalBaseAddress = BaseAddress;
+  OriginalLength      = Length;
+
   //
   // Make sure that the page table is changeable.
   //
@@ -822,6 +1190,18 @@ ConvertMemoryPageAttributes (
     }
   }
 
+  //
+  // Attribute changes can make all the entries of a page table alike again,
+  // like when guard pages or image sections are changed back. Re-promote such
+  // page tables to large pages to keep the tables and the TLB footprint small.
+  //
+  if ((PagingContext == NULL) &&
+      MergePagesInRange (&CurrentPagingContext, OriginalBaseAddress, OriginalLength)) {
+    if (IsModified != NULL) {
+      *IsModified = TRUE;
+    }
+  }
+
 Done:
   //
   // Restore page table write protection, if any.
@@ -1166,6 +1546,15 @@ AllocatePageTableMemory (
     return NULL;
   }
 
+  //
+  // Reuse the page of a merged page table first.
+  //
+  if ((Pages == 1) && (mPageTableFreeList != NULL)) {
+    Buffer             = mPageTableFreeList;
+    mPageTableFreeList = *(VOID **)Buffer;
+    return Buffer;
+  }
+
   //
   // Renew the pool if necessary.
   //
@@ -1377,6 +1766,10 @@ InitializePageTableLib (
   DEBUG ((DEBUG_INFO, "  PageTableBase - 0x%Lx\n", (UINT64)*PageTableBase));
   DEBUG ((DEBUG_INFO, "  Attributes    - 0x%x\n", *Attributes));
 
+  DEBUG_CODE (
+    InitializePageTableStatistics ();
+  );
+
   return ;
 }
 
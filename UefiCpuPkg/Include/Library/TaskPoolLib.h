@@ -0,0 +1,150 @@
+/** @file
+  Header file for the Task Pool Library.
+
+  The library runs short tasks on all the enabled processors through
+  EFI_MP_SERVICES_PROTOCOL. Each processor owns a deque of tasks: it runs the
+  newest task of its own deque first, and steals the oldest task of another
+  processor's deque when its own one is empty.
+
+  Tasks run on APs, so they must only call services that are safe to call on
+  an AP. In particular, they must not call UEFI boot services or allocate
+  memory.
+
+  Copyright (c) 2021, EDK II contributors. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef _TASK_POOL_LIB_H_
+#define _TASK_POOL_LIB_H_
+
+typedef struct _TASK_POOL  TASK_POOL;
+
+/**
+  Prototype of a task submitted to a task pool.
+
+  @param[in]  Context     The Context passed to TaskPoolSubmit().
+**/
+typedef
+VOID
+(EFIAPI *TASK_POOL_PROCEDURE) (
+  IN VOID                   *Context
+  );
+
+/**
+  Prototype of the loop body run by TaskPoolParallelFor().
+
+  @param[in]  Context     The Context passed to TaskPoolParallelFor().
+  @param[in]  Index       The loop index, from 0 to Count - 1.
+**/
+typedef
+VOID
+(EFIAPI *TASK_POOL_FOR_PROCEDURE) (
+  IN VOID                   *Context,
+  IN UINTN                  Index
+  );
+
+/**
+  Create a task pool.
+
+  When there is no EFI_MP_SERVICES_PROTOCOL in the system, the pool runs all
+  the tasks on the BSP.
+
+  This function must be called on the BSP.
+
+  @param[in]  MaxTasksPerProcessor  The number of pending tasks each processor
+                                    can hold.
+  @param[out] Pool                  Returns the new task pool.
+
+  @retval EFI_SUCCESS               The task pool is created.
+  @retval EFI_INVALID_PARAMETER     MaxTasksPerProcessor is 0, or Pool is NULL.
+  @retval EFI_OUT_OF_RESOURCES      Required resources could not be allocated.
+**/
+EFI_STATUS
+EFIAPI
+TaskPoolCreate (
+  IN  UINTN                 MaxTasksPerProcessor,
+  OUT TASK_POOL             **Pool
+  );
+
+/**
+  Free a task pool that has no pending task.
+
+  This function must be called on the BSP.
+
+  @param[in]  Pool          The task pool to free.
+**/
+VOID
+EFIAPI
+TaskPoolFree (
+  IN TASK_POOL              *Pool
+  );
+
+/**
+  Submit a task to a task pool.
+
+  Called from a running task, the new task is queued on the deque of the
+  calling processor. Otherwise the tasks are spread over the deques of all
+  the processors. If there is no room left in the deque, Procedure is run
+  before this function returns.
+
+  @param[in]  Pool          The task pool.
+  @param[in]  Procedure     The task to run.
+  @param[in]  Context       The parameter passed to Procedure.
+
+  @retval EFI_SUCCESS               The task is queued, or has been run.
+  @retval EFI_INVALID_PARAMETER     Pool or Procedure is NULL.
+**/
+EFI_STATUS
+EFIAPI
+TaskPoolSubmit (
+  IN TASK_POOL              *Pool,
+  IN TASK_POOL_PROCEDURE    Procedure,
+  IN VOID                   *Context
+  );
+
+/**
+  Run all the tasks in a task pool on all the enabled processors, including
+  the tasks submitted by running tasks, and wait for all of them to finish.
+
+  When the APs are busy, all the tasks are run on the BSP.
+
+  This function must be called on the BSP at a TPL lower than TPL_NOTIFY.
+
+  @param[in]  Pool          The task pool.
+
+  @retval EFI_SUCCESS               All the tasks have finished.
+  @retval EFI_INVALID_PARAMETER     Pool is NULL.
+**/
+EFI_STATUS
+EFIAPI
+TaskPoolRun (
+  IN TASK_POOL              *Pool
+  );
+
+/**
+  Run Procedure for each index from 0 to Count - 1 on all the enabled
+  processors, and wait for all of them to finish.
+
+  The index range is split into a few contiguous chunks per processor, so
+  that processors running ahead can steal the chunks of the slower ones.
+
+  This function must be called on the BSP at a TPL lower than TPL_NOTIFY.
+
+  @param[in]  Count         The number of loop iterations.
+  @param[in]  Procedure     The loop body.
+  @param[in]  Context       The parameter passed to Procedure.
+
+  @retval EFI_SUCCESS               All the iterations have finished.
+  @retval EFI_INVALID_PARAMETER     Procedure is NULL.
+  @retval EFI_OUT_OF_RESOURCES      Required resources could not be allocated.
+**/
+EFI_STATUS
+EFIAPI
+TaskPoolParallelFor (
+  IN UINTN                    Count,
+  IN TASK_POOL_FOR_PROCEDURE  Procedure,
+  IN VOID                     *Context
+  );
+
+#endif
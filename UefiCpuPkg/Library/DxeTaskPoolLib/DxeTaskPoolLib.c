@@ -0,0 +1,526 @@
+/** @file
+  Work-stealing task pool on top of EFI_MP_SERVICES_PROTOCOL.
+
+  Copyright (c) 2021, EDK II contributors. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <PiDxe.h>
+#include <Protocol/MpService.h>
+#include <Library/BaseLib.h>
+#include <Library/DebugLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/SynchronizationLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Library/TaskPoolLib.h>
+
+//
+// Number of chunks TaskPoolParallelFor() splits the index range into for
+// each enabled processor.
+//
+#define TASK_POOL_CHUNKS_PER_PROCESSOR  4
+
+typedef struct {
+  TASK_POOL_PROCEDURE       Procedure;
+  VOID                      *Context;
+} TASK_POOL_TASK;
+
+//
+// Tasks of one processor. The owner pushes and pops at Tail, other
+// processors steal at Head. Head and Tail only grow; the slot of a task is
+// its position modulo the capacity of the pool.
+//
+typedef struct {
+  SPIN_LOCK                 Lock;
+  UINTN                     Head;
+  UINTN                     Tail;
+  TASK_POOL_TASK            *Tasks;
+} TASK_POOL_DEQUE;
+
+struct _TASK_POOL {
+  EFI_MP_SERVICES_PROTOCOL  *MpServices;
+  UINTN                     NumberOfProcessors;
+  UINTN                     NumberOfEnabledProcessors;
+  UINTN                     Capacity;
+  TASK_POOL_DEQUE           *Deques;
+  UINTN                     NextDeque;
+  volatile UINT32           PendingTasks;
+  volatile BOOLEAN          Running;
+};
+
+typedef struct {
+  TASK_POOL_FOR_PROCEDURE   Procedure;
+  VOID                      *Context;
+  UINTN                     Start;
+  UINTN                     End;
+} TASK_POOL_FOR_CHUNK;
+
+/**
+  Get the number of the calling processor.
+
+  @param[in]  Pool          The task pool.
+
+  @return The processor number of the calling processor.
+**/
+UINTN
+TaskPoolWhoAmI (
+  IN TASK_POOL              *Pool
+  )
+{
+  EFI_STATUS                Status;
+  UINTN                     ProcessorNumber;
+
+  if (Pool->MpServices == NULL) {
+    return 0;
+  }
+
+  Status = Pool->MpServices->WhoAmI (Pool->MpServices, &ProcessorNumber);
+  if (EFI_ERROR (Status) || (ProcessorNumber >= Pool->NumberOfProcessors)) {
+    ASSERT_EFI_ERROR (Status);
+    return 0;
+  }
+
+  return ProcessorNumber;
+}
+
+/**
+  Queue a task at the tail of a deque.
+
+  @param[in]  Pool          The task pool.
+  @param[in]  Deque         The deque.
+  @param[in]  Task          The task to queue.
+
+  @retval TRUE              The task is queued.
+  @retval FALSE             The deque is full.
+**/
+BOOLEAN
+TaskPoolPushTask (
+  IN TASK_POOL              *Pool,
+  IN TASK_POOL_DEQUE        *Deque,
+  IN TASK_POOL_TASK         *Task
+  )
+{
+  BOOLEAN                   Pushed;
+
+  Pushed = FALSE;
+  AcquireSpinLock (&Deque->Lock);
+  if (Deque->Tail - Deque->Head < Pool->Capacity) {
+    //
+    // Count the task before it can be taken, so that the pending count never
+    // drops to zero while there is still work queued.
+    //
+    InterlockedIncrement (&Pool->PendingTasks);
+    Deque->Tasks[Deque->Tail % Pool->Capacity] = *Task;
+    Deque->Tail++;
+    Pushed = TRUE;
+  }
+  ReleaseSpinLock (&Deque->Lock);
+
+  return Pushed;
+}
+
+/**
+  Take a task from a deque: the newest one for the owner of the deque, the
+  oldest one for a thief.
+
+  @param[in]  Pool          The task pool.
+  @param[in]  Deque         The deque.
+  @param[in]  Steal         TRUE if the caller does not own the deque.
+  @param[out] Task          Returns the task taken.
+
+  @retval TRUE              A task is returned.
+  @retval FALSE             The deque is empty.
+**/
+BOOLEAN
+TaskPoolTakeTask (
+  IN  TASK_POOL             *Pool,
+  IN  TASK_POOL_DEQUE       *Deque,
+  IN  BOOLEAN               Steal,
+  OUT TASK_POOL_TASK        *Task
+  )
+{
+  BOOLEAN                   Taken;
+
+  //
+  // Cheap check without the lock, to keep idle thieves off the lock of the
+  // owner.
+  //
+  if (*(volatile UINTN *)&Deque->Head == *(volatile UINTN *)&Deque->Tail) {
+    return FALSE;
+  }
+
+  Taken = FALSE;
+  AcquireSpinLock (&Deque->Lock);
+  if (Deque->Head != Deque->Tail) {
+    if (Steal) {
+      *Task = Deque->Tasks[Deque->Head % Pool->Capacity];
+      Deque->Head++;
+    } else {
+      Deque->Tail--;
+      *Task = Deque->Tasks[Deque->Tail % Pool->Capacity];
+    }
+    Taken = TRUE;
+  }
+  ReleaseSpinLock (&Deque->Lock);
+
+  return Taken;
+}
+
+/**
+  Run the tasks of a task pool on the calling processor until no task is
+  pending on any processor.
+
+  @param[in]  Buffer        The task pool.
+**/
+VOID
+EFIAPI
+TaskPoolWorker (
+  IN VOID                   *Buffer
+  )
+{
+  TASK_POOL                 *Pool;
+  TASK_POOL_TASK            Task;
+  UINTN                     Self;
+  UINTN                     Victim;
+  UINTN                     Index;
+  BOOLEAN                   Found;
+
+  Pool = (TASK_POOL *) Buffer;
+  Self = TaskPoolWhoAmI (Pool);
+
+  while (Pool->PendingTasks != 0) {
+    Found = TaskPoolTakeTask (Pool, &Pool->Deques[Self], FALSE, &Task);
+    for (Index = 1; !Found && Index < Pool->NumberOfProcessors; Index++) {
+      Victim = (Self + Index) % Pool->NumberOfProcessors;
+      Found  = TaskPoolTakeTask (Pool, &Pool->Deques[Victim], TRUE, &Task);
+    }
+
+    if (!Found) {
+      CpuPause ();
+      continue;
+    }
+
+    Task.Procedure (Task.Context);
+    InterlockedDecrement (&Pool->PendingTasks);
+  }
+}
+
+/**
+  Create a task pool.
+
+  When there is no EFI_MP_SERVICES_PROTOCOL in the system, the pool runs all
+  the tasks on the BSP.
+
+  This function must be called on the BSP.
+
+  @param[in]  MaxTasksPerProcessor  The number of pending tasks each processor
+                                    can hold.
+  @param[out] Pool                  Returns the new task pool.
+
+  @retval EFI_SUCCESS               The task pool is created.
+  @retval EFI_INVALID_PARAMETER     MaxTasksPerProcessor is 0, or Pool is NULL.
+  @retval EFI_OUT_OF_RESOURCES      Required resources could not be allocated.
+**/
+EFI_STATUS
+EFIAPI
+TaskPoolCreate (
+  IN  UINTN                 MaxTasksPerProcessor,
+  OUT TASK_POOL             **Pool
+  )
+{
+  EFI_STATUS                Status;
+  TASK_POOL                 *NewPool;
+  TASK_POOL_TASK            *Tasks;
+  UINTN                     Index;
+
+  if ((MaxTasksPerProcessor == 0) || (Pool == NULL)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  NewPool = AllocateZeroPool (sizeof (TASK_POOL));
+  if (NewPool == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  NewPool->NumberOfProcessors        = 1;
+  NewPool->NumberOfEnabledProcessors = 1;
+  Status = gBS->LocateProtocol (&gEfiMpServiceProtocolGuid, NULL, (VOID **) &NewPool->MpServices);
+  if (!EFI_ERROR (Status)) {
+    Status = NewPool->MpServices->GetNumberOfProcessors (
+                                    NewPool->MpServices,
+                                    &NewPool->NumberOfProcessors,
+                                    &NewPool->NumberOfEnabledProcessors
+                                    );
+  }
+  if (EFI_ERROR (Status)) {
+    NewPool->MpServices                = NULL;
+    NewPool->NumberOfProcessors        = 1;
+    NewPool->NumberOfEnabledProcessors = 1;
+  }
+
+  NewPool->Capacity = MaxTasksPerProcessor;
+  NewPool->Deques   = AllocateZeroPool (NewPool->NumberOfProcessors * sizeof (TASK_POOL_DEQUE));
+  Tasks             = AllocatePool (NewPool->NumberOfProcessors * MaxTasksPerProcessor * sizeof (TASK_POOL_TASK));
+  if ((NewPool->Deques == NULL) || (Tasks == NULL)) {
+    if (NewPool->Deques != NULL) {
+      FreePool (NewPool->Deques);
+    }
+    if (Tasks != NULL) {
+      FreePool (Tasks);
+    }
+    FreePool (NewPool);
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  for (Index = 0; Index < NewPool->NumberOfProcessors; Index++) {
+    InitializeSpinLock (&NewPool->Deques[Index].Lock);
+    NewPool->Deques[Index].Tasks = Tasks + Index * MaxTasksPerProcessor;
+  }
+
+  *Pool = NewPool;
+  return EFI_SUCCESS;
+}
+
+/**
+  Free a task pool that has no pending task.
+
+  This function must be called on the BSP.
+
+  @param[in]  Pool          The task pool to free.
+**/
+VOID
+EFIAPI
+TaskPoolFree (
+  IN TASK_POOL              *Pool
+  )
+{
+  if (Pool == NULL) {
+    return;
+  }
+
+  ASSERT (Pool->PendingTasks == 0);
+
+  //
+  // The tasks of all the deques are one allocation, starting at the first one.
+  //
+  FreePool (Pool->Deques[0].Tasks);
+  FreePool (Pool->Deques);
+  FreePool (Pool);
+}
+
+/**
+  Submit a task to a task pool.
+
+  Called from a running task, the new task is queued on the deque of the
+  calling processor. Otherwise the tasks are spread over the deques of all
+  the processors. If there is no room left in the deque, Procedure is run
+  before this function returns.
+
+  @param[in]  Pool          The task pool.
+  @param[in]  Procedure     The task to run.
+  @param[in]  Context       The parameter passed to Procedure.
+
+  @retval EFI_SUCCESS               The task is queued, or has been run.
+  @retval EFI_INVALID_PARAMETER     Pool or Procedure is NULL.
+**/
+EFI_STATUS
+EFIAPI
+TaskPoolSubmit (
+  IN TASK_POOL              *Pool,
+  IN TASK_POOL_PROCEDURE    Procedure,
+  IN VOID                   *Context
+  )
+{
+  TASK_POOL_TASK            Task;
+  UINTN                     Index;
+  BOOLEAN                   Pushed;
+
+  if ((Pool == NULL) || (Procedure == NULL)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Task.Procedure = Procedure;
+  Task.Context   = Context;
+
+  if (Pool->Running) {
+    Pushed = TaskPoolPushTask (Pool, &Pool->Deques[TaskPoolWhoAmI (Pool)], &Task);
+  } else {
+    Pushed = FALSE;
+    for (Index = 0; !Pushed && Index < Pool->NumberOfProcessors; Index++) {
+      Pushed = TaskPoolPushTask (Pool, &Pool->Deques[Pool->NextDeque], &Task);
+      Pool->NextDeque = (Pool->NextDeque + 1) % Pool->NumberOfProcessors;
+    }
+  }
+
+  if (!Pushed) {
+    Procedure (Context);
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Run all the tasks in a task pool on all the enabled processors, including
+  the tasks submitted by running tasks, and wait for all of them to finish.
+
+  When the APs are busy, all the tasks are run on the BSP.
+
+  This function must be called on the BSP at a TPL lower than TPL_NOTIFY.
+
+  @param[in]  Pool          The task pool.
+
+  @retval EFI_SUCCESS               All the tasks have finished.
+  @retval EFI_INVALID_PARAMETER     Pool is NULL.
+**/
+EFI_STATUS
+EFIAPI
+TaskPoolRun (
+  IN TASK_POOL              *Pool
+  )
+{
+  EFI_STATUS                Status;
+  EFI_EVENT                 WaitEvent;
+
+  if (Pool == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (Pool->PendingTasks == 0) {
+    return EFI_SUCCESS;
+  }
+
+  Pool->Running = TRUE;
+
+  //
+  // Start the APs in non-blocking mode, so that the BSP works on the tasks
+  // too instead of only waiting for the APs.
+  //
+  WaitEvent = NULL;
+  Status    = EFI_NOT_STARTED;
+  if ((Pool->MpServices != NULL) && (Pool->NumberOfEnabledProcessors > 1)) {
+    Status = gBS->CreateEvent (0, TPL_CALLBACK, NULL, NULL, &WaitEvent);
+    if (!EFI_ERROR (Status)) {
+      Status = Pool->MpServices->StartupAllAPs (
+                                   Pool->MpServices,
+                                   TaskPoolWorker,
+                                   FALSE,
+                                   WaitEvent,
+                                   0,
+                                   Pool,
+                                   NULL
+                                   );
+    }
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_VERBOSE, "%a: Running tasks on the BSP only - %r\n", __FUNCTION__, Status));
+    }
+  }
+
+  TaskPoolWorker (Pool);
+
+  if (!EFI_ERROR (Status)) {
+    //
+    // All the tasks have finished, but the APs may still be on the way out of
+    // TaskPoolWorker(). Wait for them before the pool can be reused or freed.
+    //
+    while (gBS->CheckEvent (WaitEvent) == EFI_NOT_READY) {
+      CpuPause ();
+    }
+  }
+
+  if (WaitEvent != NULL) {
+    gBS->CloseEvent (WaitEvent);
+  }
+
+  Pool->Running = FALSE;
+  return EFI_SUCCESS;
+}
+
+/**
+  Run the loop body for a chunk of the index range of TaskPoolParallelFor().
+
+  @param[in]  Context       The TASK_POOL_FOR_CHUNK to run.
+**/
+VOID
+EFIAPI
+TaskPoolRunForChunk (
+  IN VOID                   *Context
+  )
+{
+  TASK_POOL_FOR_CHUNK       *Chunk;
+  UINTN                     Index;
+
+  Chunk = (TASK_POOL_FOR_CHUNK *) Context;
+  for (Index = Chunk->Start; Index < Chunk->End; Index++) {
+    Chunk->Procedure (Chunk->Context, Index);
+  }
+}
+
+/**
+  Run Procedure for each index from 0 to Count - 1 on all the enabled
+  processors, and wait for all of them to finish.
+
+  The index range is split into a few contiguous chunks per processor, so
+  that processors running ahead can steal the chunks of the slower ones.
+
+  This function must be called on the BSP at a TPL lower than TPL_NOTIFY.
+
+  @param[in]  Count         The number of loop iterations.
+  @param[in]  Procedure     The loop body.
+  @param[in]  Context       The parameter passed to Procedure.
+
+  @retval EFI_SUCCESS               All the iterations have finished.
+  @retval EFI_INVALID_PARAMETER     Procedure is NULL.
+  @retval EFI_OUT_OF_RESOURCES      Required resources could not be allocated.
+**/
+EFI_STATUS
+EFIAPI
+TaskPoolParallelFor (
+  IN UINTN                    Count,
+  IN TASK_POOL_FOR_PROCEDURE  Procedure,
+  IN VOID                     *Context
+  )
+{
+  EFI_STATUS                Status;
+  TASK_POOL                 *Pool;
+  TASK_POOL_FOR_CHUNK       *Chunks;
+  UINTN                     ChunkCount;
+  UINTN                     ChunkSize;
+  UINTN                     Index;
+
+  if (Procedure == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (Count == 0) {
+    return EFI_SUCCESS;
+  }
+
+  Status = TaskPoolCreate (TASK_POOL_CHUNKS_PER_PROCESSOR, &Pool);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  ChunkCount = MIN (Count, Pool->NumberOfEnabledProcessors * TASK_POOL_CHUNKS_PER_PROCESSOR);
+  ChunkSize  = (Count + ChunkCount - 1) / ChunkCount;
+  ChunkCount = (Count + ChunkSize - 1) / ChunkSize;
+  Chunks     = AllocatePool (ChunkCount * sizeof (TASK_POOL_FOR_CHUNK));
+  if (Chunks == NULL) {
+    TaskPoolFree (Pool);
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  for (Index = 0; Index < ChunkCount; Index++) {
+    Chunks[Index].Procedure = Procedure;
+    Chunks[Index].Context   = Context;
+    Chunks[Index].Start     = Index * ChunkSize;
+    Chunks[Index].End       = MIN (Count, Chunks[Index].Start + ChunkSize);
+    TaskPoolSubmit (Pool, TaskPoolRunForChunk, &Chunks[Index]);
+  }
+
+  TaskPoolRun (Pool);
+
+  FreePool (Chunks);
+  TaskPoolFree (Pool);
+  return EFI_SUCCESS;
+}
@@ -26,6 +26,81 @@ GetCurrentMicrocodeSignature (
   return BiosSignIdMsr.Bits.MicrocodeUpdateSignature;
 }
 
+/**
+  Look up the microcode patch found for a processor signature and platform ID
+  by an earlier lookup on any processor.
+
+  @param[in]   CpuMpData            The pointer to CPU MP Data structure.
+  @param[in]   ProcessorSignature   The processor signature.
+  @param[in]   PlatformId           The platform ID of the processor.
+  @param[out]  MicrocodeEntryAddr   The address of the microcode patch header,
+                                    or 0 if there is no matching patch.
+
+  @retval TRUE     The result of an earlier lookup is returned.
+  @retval FALSE    No processor has looked the pair up yet.
+**/
+BOOLEAN
+FindMicrocodePatchIndex (
+  IN  CPU_MP_DATA             *CpuMpData,
+  IN  UINT32                  ProcessorSignature,
+  IN  UINT8                   PlatformId,
+  OUT UINT64                  *MicrocodeEntryAddr
+  )
+{
+  UINT32                      Count;
+  UINT32                      Index;
+
+  //
+  // Entries are filled in before the count is increased, so the first Count
+  // entries are complete without taking the lock.
+  //
+  Count = CpuMpData->MicrocodePatchIndexCount;
+  MemoryFence ();
+  for (Index = 0; Index < Count; Index++) {
+    if ((CpuMpData->MicrocodePatchIndex[Index].ProcessorSignature == ProcessorSignature) &&
+        (CpuMpData->MicrocodePatchIndex[Index].PlatformId == PlatformId)) {
+      *MicrocodeEntryAddr = CpuMpData->MicrocodePatchIndex[Index].MicrocodeEntryAddr;
+      return TRUE;
+    }
+  }
+
+  return FALSE;
+}
+
+/**
+  Record the microcode patch found for a processor signature and platform ID,
+  so that other processors of the same kind skip scanning the microcode region.
+
+  @param[in]  CpuMpData            The pointer to CPU MP Data structure.
+  @param[in]  ProcessorSignature   The processor signature.
+  @param[in]  PlatformId           The platform ID of the processor.
+  @param[in]  MicrocodeEntryAddr   The address of the microcode patch header,
+                                   or 0 if there is no matching patch.
+**/
+VOID
+AddMicrocodePatchIndex (
+  IN CPU_MP_DATA              *CpuMpData,
+  IN UINT32                   ProcessorSignature,
+  IN UINT8                    PlatformId,
+  IN UINT64                   MicrocodeEntryAddr
+  )
+{
+  UINT64                      ExistingEntryAddr;
+  UINT32                      Count;
+
+  AcquireSpinLock (&CpuMpData->MpLock);
+  Count = CpuMpData->MicrocodePatchIndexCount;
+  if ((Count < MAX_MICROCODE_PATCH_INDEX_NUM) &&
+      !FindMicrocodePatchIndex (CpuMpData, ProcessorSignature, PlatformId, &ExistingEntryAddr)) {
+    CpuMpData->MicrocodePatchIndex[Count].ProcessorSignature = ProcessorSignature;
+    CpuMpData->MicrocodePatchIndex[Count].PlatformId         = PlatformId;
+    CpuMpData->MicrocodePatchIndex[Count].MicrocodeEntryAddr = MicrocodeEntryAddr;
+    MemoryFence ();
+    CpuMpData->MicrocodePatchIndexCount = Count + 1;
+  }
+  ReleaseSpinLock (&CpuMpData->MpLock);
+}
+
 /**
   Detect whether specified processor can find matching microcode patch and load it.
 
@@ -85,7 +160,6 @@ MicrocodeDetect (
   UINTN                                   Index;
   UINT8                                   PlatformId;
   CPUID_VERSION_INFO_EAX                  Eax;
-  CPU_AP_DATA                             *CpuData;
   UINT32                                  CurrentRevision;
   UINT32                                  LatestRevision;
   UINTN                                   TotalSize;
@@ -95,7 +169,7 @@ MicrocodeDetect (
   VOID                                    *MicrocodeData;
   MSR_IA32_PLATFORM_ID_REGISTER           PlatformIdMsr;
   UINT32                                  ThreadId;
-  BOOLEAN                                 IsBspCallIn;
+  UINT64                                  MicrocodeEntryAddr;
 
   if (CpuMpData->MicrocodePatchRegionSize == 0) {
     //
@@ -105,7 +179,6 @@ MicrocodeDetect (
   }
 
   CurrentRevision = GetCurrentMicrocodeSignature ();
-  IsBspCallIn     = (ProcessorNumber == (UINTN)CpuMpData->BspNumber) ? TRUE : FALSE;
 
   GetProcessorLocationByApicId (GetInitialApicId (), NULL, NULL, &ThreadId);
   if (ThreadId != 0) {
@@ -130,22 +203,17 @@ MicrocodeDetect (
 
 
   //
-  // Check whether AP has same processor with BSP.
-  // If yes, direct use microcode info saved by BSP.
+  // Check whether a processor of the same kind, usually the BSP, has already
+  // scanned the microcode region. If yes, directly use the patch it found.
   //
-  if (!IsBspCallIn) {
-    //
-    // Get the CPU data for BSP
-    //
-    CpuData = &(CpuMpData->CpuData[CpuMpData->BspNumber]);
-    if ((CpuData->ProcessorSignature == Eax.Uint32) &&
-        (CpuData->PlatformId == PlatformId) &&
-        (CpuData->MicrocodeEntryAddr != 0)) {
-      MicrocodeEntryPoint = (CPU_MICROCODE_HEADER *)(UINTN) CpuData->MicrocodeEntryAddr;
-      MicrocodeData       = (VOID *) (MicrocodeEntryPoint + 1);
-      LatestRevision      = MicrocodeEntryPoint->UpdateRevision;
-      goto Done;
+  if (FindMicrocodePatchIndex (CpuMpData, Eax.Uint32, PlatformId, &MicrocodeEntryAddr)) {
+    if (MicrocodeEntryAddr == 0) {
+      return;
     }
+    MicrocodeEntryPoint = (CPU_MICROCODE_HEADER *)(UINTN) MicrocodeEntryAddr;
+    MicrocodeData       = (VOID *) (MicrocodeEntryPoint + 1);
+    LatestRevision      = MicrocodeEntryPoint->UpdateRevision;
+    goto Done;
   }
 
   LatestRevision = 0;
@@ -292,6 +360,13 @@ MicrocodeDetect (
     MicrocodeEntryPoint = (CPU_MICROCODE_HEADER *) (((UINTN) MicrocodeEntryPoint) + TotalSize);
   } while (((UINTN) MicrocodeEntryPoint < MicrocodeEnd));
 
+  AddMicrocodePatchIndex (
+    CpuMpData,
+    Eax.Uint32,
+    PlatformId,
+    (LatestRevision != 0) ? (UINTN) MicrocodeData - sizeof (CPU_MICROCODE_HEADER) : 0
+    );
+
 Done:
   if (LatestRevision != 0) {
     //
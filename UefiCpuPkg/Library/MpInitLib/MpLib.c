@@ -1648,6 +1648,8 @@ TimedWaitForApFinish (
   IN UINT32                    TimeLimit
   )
 {
+  UINTN                        Spin;
+
   //
   // CalculateTimeout() and CheckTimeout() consider a TimeLimit of 0
   // "infinity", so check for (TimeLimit == 0) explicitly.
@@ -1661,13 +1663,25 @@ TimedWaitForApFinish (
                               TimeLimit,
                               &CpuMpData->CurrentTime
                               );
-  while (CpuMpData->FinishedCount < FinishedApLimit &&
-         !CheckTimeout (
-            &CpuMpData->CurrentTime,
-            &CpuMpData->TotalTime,
-            CpuMpData->ExpectedTime
-            )) {
-    CpuPause ();
+  while (CpuMpData->FinishedCount < FinishedApLimit) {
+    //
+    // Reading the performance counter costs far more than reading the
+    // finished AP count, so spin on the count and only check the timeout
+    // once every TIMED_WAIT_SPIN_COUNT pauses.
+    //
+    for (Spin = 0;
+         Spin < TIMED_WAIT_SPIN_COUNT && CpuMpData->FinishedCount < FinishedApLimit;
+         Spin++) {
+      CpuPause ();
+    }
+
+    if (CheckTimeout (
+          &CpuMpData->CurrentTime,
+          &CpuMpData->TotalTime,
+          CpuMpData->ExpectedTime
+          )) {
+      break;
+    }
   }
 
   if (CpuMpData->FinishedCount >= FinishedApLimit) {
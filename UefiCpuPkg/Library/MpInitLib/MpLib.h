@@ -49,6 +49,11 @@
 #define CPU_SWITCH_STATE_STORED 1
 #define CPU_SWITCH_STATE_LOADED 2
 
+//
+// Number of CpuPause() calls between two timeout checks when waiting for APs
+//
+#define TIMED_WAIT_SPIN_COUNT   64
+
 //
 // Default maximum number of entries to store the microcode patches information
 //
@@ -62,6 +67,22 @@ typedef struct {
   UINTN    Size;
 } MICROCODE_PATCH_INFO;
 
+//
+// Maximum number of distinct processor signature and platform ID pairs whose
+// microcode patch lookup result is shared by all the processors
+//
+#define MAX_MICROCODE_PATCH_INDEX_NUM   8
+
+//
+// Result of one microcode patch lookup. MicrocodeEntryAddr is 0 if no patch
+// in the microcode region matches the processor.
+//
+typedef struct {
+  UINT32   ProcessorSignature;
+  UINT8    PlatformId;
+  UINT64   MicrocodeEntryAddr;
+} MICROCODE_PATCH_INDEX;
+
 //
 // CPU exchange information for switch BSP
 //
@@ -274,6 +295,8 @@ struct _CPU_MP_DATA {
   BOOLEAN                        TimerInterruptState;
   UINT64                         MicrocodePatchAddress;
   UINT64                         MicrocodePatchRegionSize;
+  MICROCODE_PATCH_INDEX          MicrocodePatchIndex[MAX_MICROCODE_PATCH_INDEX_NUM];
+  volatile UINT32                MicrocodePatchIndexCount;
 
   //
   // Whether need to use Init-Sipi-Sipi to wake up the APs.
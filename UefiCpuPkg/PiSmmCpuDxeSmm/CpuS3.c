@@ -953,6 +953,10 @@ InitSmmS3ResumeState (
 /**
   Copy register table from non-SMRAM into SMRAM.
 
+  Processors of the same model usually get identical register tables. Such
+  tables share a single copy of their entries in SMRAM, which is only read
+  during S3 resume.
+
   @param[in] DestinationRegisterTableList  Points to destination register table.
   @param[in] SourceRegisterTableList       Points to source register table.
   @param[in] NumberOfCpus                  Number of CPUs.
@@ -966,20 +970,51 @@ CopyRegisterTable (
   )
 {
   UINTN                      Index;
+  UINTN                      SharedIndex;
+  UINTN                      *UniqueTables;
+  UINTN                      UniqueCount;
   CPU_REGISTER_TABLE_ENTRY   *RegisterTableEntry;
 
+  //
+  // Indices of the tables whose entries were copied, and may be shared.
+  //
+  UniqueTables = AllocatePool (NumberOfCpus * sizeof (UINTN));
+  ASSERT (UniqueTables != NULL);
+  UniqueCount = 0;
+
   CopyMem (DestinationRegisterTableList, SourceRegisterTableList, NumberOfCpus * sizeof (CPU_REGISTER_TABLE));
   for (Index = 0; Index < NumberOfCpus; Index++) {
     if (DestinationRegisterTableList[Index].TableLength != 0) {
       DestinationRegisterTableList[Index].AllocatedSize = DestinationRegisterTableList[Index].TableLength * sizeof (CPU_REGISTER_TABLE_ENTRY);
+
+      for (SharedIndex = 0; SharedIndex < UniqueCount; SharedIndex++) {
+        if (SourceRegisterTableList[UniqueTables[SharedIndex]].TableLength == SourceRegisterTableList[Index].TableLength &&
+            CompareMem (
+              (VOID *)(UINTN)SourceRegisterTableList[UniqueTables[SharedIndex]].RegisterTableEntry,
+              (VOID *)(UINTN)SourceRegisterTableList[Index].RegisterTableEntry,
+              DestinationRegisterTableList[Index].AllocatedSize
+              ) == 0) {
+          break;
+        }
+      }
+
+      if (SharedIndex < UniqueCount) {
+        DestinationRegisterTableList[Index].RegisterTableEntry = DestinationRegisterTableList[UniqueTables[SharedIndex]].RegisterTableEntry;
+        continue;
+      }
+
       RegisterTableEntry = AllocateCopyPool (
         DestinationRegisterTableList[Index].AllocatedSize,
         (VOID *)(UINTN)SourceRegisterTableList[Index].RegisterTableEntry
         );
       ASSERT (RegisterTableEntry != NULL);
       DestinationRegisterTableList[Index].RegisterTableEntry = (EFI_PHYSICAL_ADDRESS)(UINTN)RegisterTableEntry;
+      UniqueTables[UniqueCount++] = Index;
     }
   }
+
+  DEBUG ((DEBUG_INFO, "%a: %d unique register table(s) for %d CPU(s)\n", __FUNCTION__, (UINT32)UniqueCount, NumberOfCpus));
+  FreePool (UniqueTables);
 }
 
 /**
@@ -116,6 +116,11 @@ LockdownSemaphore (
 /**
   Wait all APs to performs an atomic compare exchange operation to release semaphore.
 
+  The APs release the arrival counter of their package rather than a single
+  semaphore of the BSP, so that the APs of different packages signal the BSP
+  through different cache lines. The BSP takes all the signals available in
+  a counter at once.
+
   @param   NumberOfAPs      AP number
 
 **/
@@ -124,11 +129,26 @@ WaitForAllAPs (
   IN      UINTN                     NumberOfAPs
   )
 {
-  UINTN                             BspIndex;
-
-  BspIndex = mSmmMpSyncData->BspIndex;
-  while (NumberOfAPs-- > 0) {
-    WaitForSemaphore (mSmmMpSyncData->CpuData[BspIndex].Run);
+  UINTN                             Index;
+  UINT32                            Value;
+  UINT32                            Taken;
+  volatile UINT32                   *Arrival;
+
+  while (NumberOfAPs > 0) {
+    for (Index = 0; Index < mSmmMpSyncData->ArrivalCount && NumberOfAPs > 0; Index++) {
+      Arrival = (UINT32 *)((UINTN)mSmmCpuSemaphores.SemaphoreCpu.Arrival + mSemaphoreSize * Index);
+      Value   = *Arrival;
+      if (Value == 0) {
+        continue;
+      }
+      Taken = (UINT32)MIN (Value, NumberOfAPs);
+      if (InterlockedCompareExchange32 ((UINT32 *)Arrival, Value, Value - Taken) == Value) {
+        NumberOfAPs -= Taken;
+      }
+    }
+    if (NumberOfAPs > 0) {
+      CpuPause ();
+    }
   }
 }
 
@@ -464,9 +484,17 @@ BSPHandler (
   UINTN                             ApCount;
   BOOLEAN                           ClearTopLevelSmiResult;
   UINTN                             PresentCount;
+  UINT64                            Timer;
+  UINT64                            EntryTime;
 
   ASSERT (CpuIndex == mSmmMpSyncData->BspIndex);
   ApCount = 0;
+  Timer = 0;
+  EntryTime = 0;
+
+  if (FeaturePcdGet (PcdCpuSmmRendezvousTimeReport)) {
+    Timer = StartSyncTimer ();
+  }
 
   //
   // Flag BSP's presence
@@ -557,6 +585,10 @@ BSPHandler (
     }
   }
 
+  if (FeaturePcdGet (PcdCpuSmmRendezvousTimeReport)) {
+    EntryTime = GetSyncTimerElapsedTime (Timer);
+  }
+
   //
   // The BUSY lock is initialized to Acquired state
   //
@@ -610,6 +642,10 @@ BSPHandler (
     }
   }
 
+  if (FeaturePcdGet (PcdCpuSmmRendezvousTimeReport)) {
+    Timer = StartSyncTimer ();
+  }
+
   //
   // Notify all APs to exit
   //
@@ -666,6 +702,16 @@ BSPHandler (
   //
   WaitForAllAPs (ApCount);
 
+  if (FeaturePcdGet (PcdCpuSmmRendezvousTimeReport)) {
+    DEBUG ((
+      DEBUG_INFO,
+      "SmiRendezvous: %d APs, entry %ld ns, exit %ld ns\n",
+      ApCount,
+      EntryTime,
+      GetSyncTimerElapsedTime (Timer)
+      ));
+  }
+
   //
   // Reset the tokens buffer.
   //
@@ -772,7 +818,7 @@ APHandler (
     //
     // Notify BSP of arrival at this point
     //
-    ReleaseSemaphore (mSmmMpSyncData->CpuData[BspIndex].Run);
+    ReleaseSemaphore (mSmmMpSyncData->CpuData[CpuIndex].Arrival);
   }
 
   if (SmmCpuFeaturesNeedConfigureMtrrs()) {
@@ -789,7 +835,7 @@ APHandler (
     //
     // Signal BSP the completion of this AP
     //
-    ReleaseSemaphore (mSmmMpSyncData->CpuData[BspIndex].Run);
+    ReleaseSemaphore (mSmmMpSyncData->CpuData[CpuIndex].Arrival);
 
     //
     // Wait for BSP's signal to program MTRRs
@@ -804,7 +850,7 @@ APHandler (
     //
     // Signal BSP the completion of this AP
     //
-    ReleaseSemaphore (mSmmMpSyncData->CpuData[BspIndex].Run);
+    ReleaseSemaphore (mSmmMpSyncData->CpuData[CpuIndex].Arrival);
   }
 
   while (TRUE) {
@@ -851,7 +897,7 @@ APHandler (
     //
     // Notify BSP the readiness of this AP to program MTRRs
     //
-    ReleaseSemaphore (mSmmMpSyncData->CpuData[BspIndex].Run);
+    ReleaseSemaphore (mSmmMpSyncData->CpuData[CpuIndex].Arrival);
 
     //
     // Wait for the signal from BSP to program MTRRs
@@ -868,7 +914,7 @@ APHandler (
   //
   // Notify BSP the readiness of this AP to Reset states/semaphore for this processor
   //
-  ReleaseSemaphore (mSmmMpSyncData->CpuData[BspIndex].Run);
+  ReleaseSemaphore (mSmmMpSyncData->CpuData[CpuIndex].Arrival);
 
   //
   // Wait for the signal from BSP to Reset states/semaphore for this processor
@@ -883,7 +929,7 @@ APHandler (
   //
   // Notify BSP the readiness of this AP to exit SMM
   //
-  ReleaseSemaphore (mSmmMpSyncData->CpuData[BspIndex].Run);
+  ReleaseSemaphore (mSmmMpSyncData->CpuData[CpuIndex].Arrival);
 
 }
 
@@ -1814,6 +1860,8 @@ InitializeSmmCpuSemaphores (
   mSmmCpuSemaphores.SemaphoreCpu.Run     = (UINT32 *)SemaphoreAddr;
   SemaphoreAddr += ProcessorCount * SemaphoreSize;
   mSmmCpuSemaphores.SemaphoreCpu.Present = (BOOLEAN *)SemaphoreAddr;
+  SemaphoreAddr += ProcessorCount * SemaphoreSize;
+  mSmmCpuSemaphores.SemaphoreCpu.Arrival = (UINT32 *)SemaphoreAddr;
 
   mPFLock                       = mSmmCpuSemaphores.SemaphoreGlobal.PFLock;
   mConfigSmmCodeAccessCheckLock = mSmmCpuSemaphores.SemaphoreGlobal.CodeAccessCheckLock;
@@ -1868,7 +1916,43 @@ InitializeMpSyncData (
       *(mSmmMpSyncData->CpuData[CpuIndex].Busy)    = 0;
       *(mSmmMpSyncData->CpuData[CpuIndex].Run)     = 0;
       *(mSmmMpSyncData->CpuData[CpuIndex].Present) = FALSE;
+      *(UINT32 *)((UINTN)mSmmCpuSemaphores.SemaphoreCpu.Arrival + mSemaphoreSize * CpuIndex) = 0;
     }
+
+    for (CpuIndex = 0; CpuIndex < gSmmCpuPrivate->SmmCoreEntryContext.NumberOfCpus; CpuIndex ++) {
+      SetCpuArrivalCounter (CpuIndex);
+    }
+  }
+}
+
+/**
+  Select the arrival counter a processor signals the BSP with, from the
+  package of the processor.
+
+  @param CpuIndex   The processor index.
+
+**/
+VOID
+SetCpuArrivalCounter (
+  IN      UINTN                     CpuIndex
+  )
+{
+  UINTN                      Slot;
+
+  //
+  // There are as many arrival counters as processors. The package number
+  // is used as is, as packages are usually numbered from 0.
+  //
+  Slot = 0;
+  if (gSmmCpuPrivate->ProcessorInfo[CpuIndex].ProcessorId != INVALID_APIC_ID) {
+    Slot = gSmmCpuPrivate->ProcessorInfo[CpuIndex].Location.Package %
+           gSmmCpuPrivate->SmmCoreEntryContext.NumberOfCpus;
+  }
+
+  mSmmMpSyncData->CpuData[CpuIndex].Arrival =
+    (UINT32 *)((UINTN)mSmmCpuSemaphores.SemaphoreCpu.Arrival + mSemaphoreSize * Slot);
+  if (Slot >= mSmmMpSyncData->ArrivalCount) {
+    mSmmMpSyncData->ArrivalCount = (UINT32)Slot + 1;
   }
 }
 
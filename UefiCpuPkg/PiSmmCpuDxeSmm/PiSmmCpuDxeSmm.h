@@ -407,6 +407,11 @@ typedef struct {
   volatile BOOLEAN                  *Present;
   PROCEDURE_TOKEN                   *Token;
   EFI_STATUS                        *Status;
+  //
+  // Arrival counter shared by the processors of the same package, which
+  // the processor releases to signal the BSP
+  //
+  volatile UINT32                   *Arrival;
 } SMM_CPU_DATA_BLOCK;
 
 typedef enum {
@@ -430,6 +435,7 @@ typedef struct {
   volatile BOOLEAN              *CandidateBsp;
   EFI_AP_PROCEDURE              StartupProcedure;
   VOID                          *StartupProcArgs;
+  volatile UINT32               ArrivalCount;   // Number of arrival counters in use
 } SMM_DISPATCHER_MP_SYNC_DATA;
 
 #define SMM_PSD_OFFSET              0xfb00
@@ -453,6 +459,7 @@ typedef struct {
   volatile UINT32                   *Run;
   volatile BOOLEAN                  *Present;
   SPIN_LOCK                         *Token;
+  volatile UINT32                   *Arrival;
 } SMM_CPU_SEMAPHORE_CPU;
 
 ///
@@ -547,6 +554,31 @@ IsSyncTimerTimeout (
   IN      UINT64                    Timer
   );
 
+/**
+  Get the time elapsed since the SMM AP Sync timer was started.
+
+  @param Timer  The start timer from the begin.
+
+  @return The elapsed time in nanoseconds.
+
+**/
+UINT64
+GetSyncTimerElapsedTime (
+  IN      UINT64                    Timer
+  );
+
+/**
+  Select the arrival counter a processor signals the BSP with, from the
+  package of the processor.
+
+  @param CpuIndex   The processor index.
+
+**/
+VOID
+SetCpuArrivalCounter (
+  IN      UINTN                     CpuIndex
+  );
+
 /**
   Initialize IDT for SMM Stack Guard.
 
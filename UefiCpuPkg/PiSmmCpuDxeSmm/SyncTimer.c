@@ -60,14 +60,15 @@ StartSyncTimer (
 
 
 /**
-  Check if the SMM AP Sync timer is timeout.
+  Get the number of ticks elapsed since the SMM AP Sync timer was started.
 
   @param Timer  The start timer from the begin.
 
+  @return The elapsed ticks.
+
 **/
-BOOLEAN
-EFIAPI
-IsSyncTimerTimeout (
+UINT64
+GetSyncTimerDelta (
   IN      UINT64                    Timer
   )
 {
@@ -106,5 +107,36 @@ IsSyncTimerTimeout (
     }
   }
 
-  return (BOOLEAN) (Delta >= mTimeoutTicker);
+  return Delta;
+}
+
+/**
+  Get the time elapsed since the SMM AP Sync timer was started.
+
+  @param Timer  The start timer from the begin.
+
+  @return The elapsed time in nanoseconds.
+
+**/
+UINT64
+GetSyncTimerElapsedTime (
+  IN      UINT64                    Timer
+  )
+{
+  return GetTimeInNanoSecond (GetSyncTimerDelta (Timer));
+}
+
+/**
+  Check if the SMM AP Sync timer is timeout.
+
+  @param Timer  The start timer from the begin.
+
+**/
+BOOLEAN
+EFIAPI
+IsSyncTimerTimeout (
+  IN      UINT64                    Timer
+  )
+{
+  return (BOOLEAN) (GetSyncTimerDelta (Timer) >= mTimeoutTicker);
 }
@@ -8,19 +8,15 @@
 #include "UefiPayloadEntry.h"
 
 /**
-   Callback function to build resource descriptor HOB
+   Build resource descriptor HOB
 
    This function build a HOB based on the memory map entry info.
 
    @param MemoryMapEntry         Memory map entry info got from bootloader.
-   @param Params                 Not used for now.
-
-  @retval RETURN_SUCCESS        Successfully build a HOB.
 **/
-EFI_STATUS
-MemInfoCallback (
-  IN MEMROY_MAP_ENTRY          *MemoryMapEntry,
-  IN VOID                      *Params
+VOID
+BuildMemInfoHob (
+  IN MEMROY_MAP_ENTRY          *MemoryMapEntry
   )
 {
   EFI_PHYSICAL_ADDRESS         Base;
@@ -47,6 +43,44 @@ MemInfoCallback (
 
   BuildResourceDescriptorHob (Type, Attribue, (EFI_PHYSICAL_ADDRESS)Base, Size);
   DEBUG ((DEBUG_INFO , "buildhob: base = 0x%lx, size = 0x%lx, type = 0x%x\n", Base, Size, Type));
+}
+
+/**
+   Callback function to build resource descriptor HOB
+
+   Bootloaders report memory in many small contiguous entries. Contiguous
+   entries which result in the same resource type and attributes are merged,
+   so DXE core has fewer resource descriptor HOBs to add to the GCD memory
+   map. The merged entry is kept in Params until an entry can not be merged,
+   the last one must be built by the caller of ParseMemoryInfo().
+
+   @param MemoryMapEntry         Memory map entry info got from bootloader.
+   @param Params                 The memory map entry whose HOB is not built yet.
+
+  @retval RETURN_SUCCESS        Successfully merged the entry or built a HOB.
+**/
+EFI_STATUS
+MemInfoCallback (
+  IN MEMROY_MAP_ENTRY          *MemoryMapEntry,
+  IN VOID                      *Params
+  )
+{
+  MEMROY_MAP_ENTRY             *PendingEntry;
+
+  PendingEntry = (MEMROY_MAP_ENTRY *) Params;
+
+  if ((PendingEntry->Size != 0) &&
+      (PendingEntry->Base + PendingEntry->Size == MemoryMapEntry->Base) &&
+      ((PendingEntry->Type == 1) == (MemoryMapEntry->Type == 1)) &&
+      ((PendingEntry->Base >= BASE_4GB) == (MemoryMapEntry->Base >= BASE_4GB))) {
+    PendingEntry->Size += MemoryMapEntry->Size;
+    return RETURN_SUCCESS;
+  }
+
+  if (PendingEntry->Size != 0) {
+    BuildMemInfoHob (PendingEntry);
+  }
+  CopyMem (PendingEntry, MemoryMapEntry, sizeof (MEMROY_MAP_ENTRY));
 
   return RETURN_SUCCESS;
 }
@@ -234,14 +268,19 @@ BuildHobFromBl (
   EFI_PEI_GRAPHICS_INFO_HOB        *NewGfxInfo;
   EFI_PEI_GRAPHICS_DEVICE_INFO_HOB GfxDeviceInfo;
   EFI_PEI_GRAPHICS_DEVICE_INFO_HOB *NewGfxDeviceInfo;
+  MEMROY_MAP_ENTRY                 PendingMemInfo;
 
   //
   // Parse memory info and build memory HOBs
   //
-  Status = ParseMemoryInfo (MemInfoCallback, NULL);
+  ZeroMem (&PendingMemInfo, sizeof (PendingMemInfo));
+  Status = ParseMemoryInfo (MemInfoCallback, &PendingMemInfo);
   if (EFI_ERROR(Status)) {
     return Status;
   }
+  if (PendingMemInfo.Size != 0) {
+    BuildMemInfoHob (&PendingMemInfo);
+  }
 
   //
   // Create guid hob for frame buffer information